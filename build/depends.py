@@ -56,7 +56,8 @@ class PortMIDI(Dependence):
             raise Exception("Did not find PortMidi or its development headers.")
 
     def sources(self, build):
-        return ['controllers/midi/portmidienumerator.cpp', 'controllers/midi/portmidicontroller.cpp']
+        return ['controllers/midi/portmidienumerator.cpp', 'controllers/midi/portmidicontroller.cpp',
+                'controllers/midi/portmidiinputthread.cpp']
 
 
 class OpenGL(Dependence):
@@ -543,7 +544,8 @@ class SoundTouch(Dependence):
 
 class RubberBand(Dependence):
     def sources(self, build):
-        sources = ['engine/enginebufferscalerubberband.cpp', ]
+        sources = ['engine/enginebufferscalerubberband.cpp',
+                   'engine/enginebufferscalerubberbandthreaded.cpp', ]
         return sources
 
     def configure(self, build, conf, env=None):
@@ -651,8 +653,10 @@ class MixxxCore(Feature):
         sources = ["control/control.cpp",
                    "control/controlaudiotaperpot.cpp",
                    "control/controlbehavior.cpp",
+                   "control/controlcoalescer.cpp",
                    "control/controleffectknob.cpp",
                    "control/controlindicator.cpp",
+                   "control/controlinputtime.cpp",
                    "control/controllinpotmeter.cpp",
                    "control/controllogpotmeter.cpp",
                    "control/controlmodel.cpp",
@@ -662,6 +666,7 @@ class MixxxCore(Feature):
                    "control/controlproxy.cpp",
                    "control/controlpushbutton.cpp",
                    "control/controlttrotary.cpp",
+                   "control/internedconfigkey.cpp",
 
                    "controllers/dlgcontrollerlearning.cpp",
                    "controllers/dlgprefcontroller.cpp",
@@ -669,6 +674,7 @@ class MixxxCore(Feature):
                    "dialog/dlgabout.cpp",
                    "dialog/dlgdevelopertools.cpp",
 
+                   "preferences/configfilewriter.cpp",
                    "preferences/configobject.cpp",
                    "preferences/dialog/dlgprefautodj.cpp",
                    "preferences/dialog/dlgprefdeck.cpp",
@@ -702,12 +708,15 @@ class MixxxCore(Feature):
 
                    "effects/effectrack.cpp",
                    "effects/effectchainslot.cpp",
+                   "effects/stagedeffectchain.cpp",
                    "effects/effectslot.cpp",
                    "effects/effectparameterslotbase.cpp",
                    "effects/effectparameterslot.cpp",
                    "effects/effectbuttonparameterslot.cpp",
 
                    "effects/effectsmanager.cpp",
+                   "effects/effectsrequestpool.cpp",
+                   "effects/delaylinepool.cpp",
                    "effects/effectchainmanager.cpp",
                    "effects/effectsbackend.cpp",
 
@@ -743,10 +752,12 @@ class MixxxCore(Feature):
                    "engine/sync/internalclock.cpp",
 
                    "engine/engineworker.cpp",
+                   "engine/engineworkerpool.cpp",
                    "engine/engineworkerscheduler.cpp",
                    "engine/enginebuffer.cpp",
                    "engine/enginebufferscale.cpp",
                    "engine/enginebufferscalelinear.cpp",
+                   "engine/enginebufferscalesinc.cpp",
                    "engine/enginefilterbiquad1.cpp",
                    "engine/enginefiltermoogladder4.cpp",
                    "engine/enginefilterbessel4.cpp",
@@ -757,24 +768,33 @@ class MixxxCore(Feature):
                    "engine/enginefilterlinkwitzriley4.cpp",
                    "engine/enginefilterlinkwitzriley8.cpp",
                    "engine/enginefilter.cpp",
+                   "engine/enginefiltercoefficientcache.cpp",
                    "engine/engineobject.cpp",
                    "engine/enginepregain.cpp",
                    "engine/enginechannel.cpp",
+                   "engine/enginechannelthreadpool.cpp",
+                   "engine/callbackprofiler.cpp",
                    "engine/enginemaster.cpp",
+                   "engine/engineofflinerenderer.cpp",
                    "engine/enginedelay.cpp",
+                   "engine/enginedelaycompensation.cpp",
                    "engine/enginevumeter.cpp",
                    "engine/enginesidechaincompressor.cpp",
                    "engine/sidechain/enginesidechain.cpp",
                    "engine/sidechain/networkoutputstreamworker.cpp",
                    "engine/sidechain/networkinputstreamworker.cpp",
+                   "engine/sidechain/networkaudiopacket.cpp",
+                   "engine/sidechain/networkaudiosender.cpp",
+                   "engine/sidechain/networkjitterbuffer.cpp",
                    "engine/enginexfader.cpp",
                    "engine/enginemicrophone.cpp",
                    "engine/enginedeck.cpp",
                    "engine/engineaux.cpp",
-                   "engine/channelmixer_autogen.cpp",
+                   "engine/channelmixer.cpp",
 
                    "engine/enginecontrol.cpp",
                    "engine/ratecontrol.cpp",
+                   "engine/vinylpitchchannel.cpp",
                    "engine/positionscratchcontroller.cpp",
                    "engine/loopingcontrol.cpp",
                    "engine/bpmcontrol.cpp",
@@ -783,19 +803,29 @@ class MixxxCore(Feature):
                    "engine/quantizecontrol.cpp",
                    "engine/clockcontrol.cpp",
                    "engine/readaheadmanager.cpp",
+                   "engine/jumptargetbuffers.cpp",
                    "engine/enginetalkoverducking.cpp",
                    "engine/cachingreader.cpp",
                    "engine/cachingreaderchunk.cpp",
+                   "engine/cachingreaderpreload.cpp",
+                   "engine/cachingreaderdiskcache.cpp",
                    "engine/cachingreaderworker.cpp",
 
+                   "analyzer/analysiscache.cpp",
+                   "analyzer/analyzerbatch.cpp",
+                   "analyzer/analyzerdecimator.cpp",
+                   "analyzer/analyzerpipeline.cpp",
                    "analyzer/analyzerqueue.cpp",
+                   "analyzer/analyzerthrottle.cpp",
                    "analyzer/analyzerwaveform.cpp",
-                   "analyzer/analyzergain.cpp",
-                   "analyzer/analyzerebur128.cpp",
+                   "analyzer/analyzerloudness.cpp",
 
                    "controllers/controller.cpp",
+                   "controllers/controlleroutputwriter.cpp",
+                   "controllers/controllerscreen.cpp",
                    "controllers/controllerdebug.cpp",
                    "controllers/controllerengine.cpp",
+                   "controllers/controllerlatency.cpp",
                    "controllers/controllerenumerator.cpp",
                    "controllers/controllerlearningeventfilter.cpp",
                    "controllers/controllermanager.cpp",
@@ -816,8 +846,10 @@ class MixxxCore(Feature):
                    "controllers/midi/midiutils.cpp",
                    "controllers/midi/midicontroller.cpp",
                    "controllers/midi/midicontrollerpresetfilehandler.cpp",
+                   "controllers/midi/midiinputmappingtable.cpp",
                    "controllers/midi/midienumerator.cpp",
                    "controllers/midi/midioutputhandler.cpp",
+                   "controllers/midi/midioutputscheduler.cpp",
                    "controllers/softtakeover.cpp",
                    "controllers/keyboard/keyboardeventfilter.cpp",
 
@@ -827,10 +859,13 @@ class MixxxCore(Feature):
                    "errordialoghandler.cpp",
 
                    "sources/audiosource.cpp",
+                   "sources/audiosourceresampler.cpp",
                    "sources/audiosourcestereoproxy.cpp",
                    "sources/metadatasourcetaglib.cpp",
+                   "sources/mp3seekframecache.cpp",
                    "sources/soundsource.cpp",
                    "sources/soundsourceplugin.cpp",
+                   "sources/soundsourceplugincache.cpp",
                    "sources/soundsourcepluginlibrary.cpp",
                    "sources/soundsourceproviderregistry.cpp",
                    "sources/soundsourceproxy.cpp",
@@ -865,6 +900,7 @@ class MixxxCore(Feature):
                    "widget/wsearchlineedit.cpp",
                    "widget/wpixmapstore.cpp",
                    "widget/paintable.cpp",
+                   "widget/svgrastercache.cpp",
                    "widget/wimagestore.cpp",
                    "widget/hexspinbox.cpp",
                    "widget/wtrackproperty.cpp",
@@ -909,12 +945,20 @@ class MixxxCore(Feature):
                    "database/schemamanager.cpp",
 
                    "library/trackcollection.cpp",
+                   "library/trackmetadataexportqueue.cpp",
                    "library/basesqltablemodel.cpp",
+                   "library/sqlselectthread.cpp",
                    "library/basetrackcache.cpp",
                    "library/columncache.cpp",
+                   "library/columnartrackinfo.cpp",
                    "library/librarytablemodel.cpp",
                    "library/searchquery.cpp",
                    "library/searchqueryparser.cpp",
+                   "library/tracksearchindex.cpp",
+                   "library/tracksortindex.cpp",
+                   "library/trackkeyindex.cpp",
+                   "library/trackidset.cpp",
+                   "library/textfilterresultcache.cpp",
                    "library/analysislibrarytablemodel.cpp",
                    "library/missingtablemodel.cpp",
                    "library/hiddentablemodel.cpp",
@@ -922,6 +966,7 @@ class MixxxCore(Feature):
                    "library/coverart.cpp",
                    "library/coverartcache.cpp",
                    "library/coverartutils.cpp",
+                   "library/coverthumbnailcache.cpp",
 
                    "library/crate/cratestorage.cpp",
                    "library/crate/cratefeature.cpp",
@@ -960,6 +1005,7 @@ class MixxxCore(Feature):
                    "library/recording/dlgrecording.cpp",
                    "recording/recordingmanager.cpp",
                    "engine/sidechain/enginerecord.cpp",
+                   "engine/sidechain/recordingfilewriter.cpp",
 
                    # External Library Features
                    "library/baseexternallibraryfeature.cpp",
@@ -982,6 +1028,7 @@ class MixxxCore(Feature):
                    "library/scanner/scannertask.cpp",
                    "library/scanner/importfilestask.cpp",
                    "library/scanner/recursivescandirectorytask.cpp",
+                   "library/scanner/librarywatcher.cpp",
 
                    "library/dao/cuedao.cpp",
                    "library/dao/cue.cpp",
@@ -1000,6 +1047,7 @@ class MixxxCore(Feature):
                    "library/bpmdelegate.cpp",
                    "library/previewbuttondelegate.cpp",
                    "library/coverartdelegate.cpp",
+                   "library/cellpixmapcache.cpp",
 
                    "library/treeitemmodel.cpp",
                    "library/treeitem.cpp",
@@ -1030,6 +1078,7 @@ class MixxxCore(Feature):
                    "waveform/renderers/waveformrendererfilteredsignal.cpp",
                    "waveform/renderers/waveformrendererhsv.cpp",
                    "waveform/renderers/waveformrendererrgb.cpp",
+                   "waveform/renderers/rasterwaveformrendererrgb.cpp",
                    "waveform/renderers/qtwaveformrendererfilteredsignal.cpp",
                    "waveform/renderers/qtwaveformrenderersimplesignal.cpp",
 
@@ -1041,9 +1090,11 @@ class MixxxCore(Feature):
                    "waveform/renderers/waveformmarkset.cpp",
                    "waveform/renderers/waveformmarkrange.cpp",
                    "waveform/renderers/glwaveformrenderersimplesignal.cpp",
+                   "waveform/renderers/gllinebatch.cpp",
                    "waveform/renderers/glwaveformrendererrgb.cpp",
                    "waveform/renderers/glwaveformrendererfilteredsignal.cpp",
                    "waveform/renderers/glslwaveformrenderersignal.cpp",
+                   "waveform/renderers/glslwaveformtexture.cpp",
                    "waveform/renderers/glvsynctestrenderer.cpp",
 
                    "waveform/widgets/waveformwidgetabstract.cpp",
@@ -1051,6 +1102,7 @@ class MixxxCore(Feature):
                    "waveform/widgets/softwarewaveformwidget.cpp",
                    "waveform/widgets/hsvwaveformwidget.cpp",
                    "waveform/widgets/rgbwaveformwidget.cpp",
+                   "waveform/widgets/rasterrgbwaveformwidget.cpp",
                    "waveform/widgets/qtwaveformwidget.cpp",
                    "waveform/widgets/qtsimplewaveformwidget.cpp",
                    "waveform/widgets/glwaveformwidget.cpp",
@@ -1069,6 +1121,7 @@ class MixxxCore(Feature):
                    "skin/colorschemeparser.cpp",
                    "skin/tooltips.cpp",
                    "skin/skincontext.cpp",
+                   "skin/skindocumentcache.cpp",
                    "skin/svgparser.cpp",
                    "skin/pixmapsource.cpp",
                    "skin/launchimage.cpp",
@@ -1079,6 +1132,7 @@ class MixxxCore(Feature):
                    "track/beatutils.cpp",
                    "track/beats.cpp",
                    "track/bpm.cpp",
+                   "track/cueindex.cpp",
                    "track/keyfactory.cpp",
                    "track/keys.cpp",
                    "track/keyutils.cpp",
@@ -1105,6 +1159,7 @@ class MixxxCore(Feature):
                    "mixer/sampler.cpp",
                    "mixer/samplerbank.cpp",
 
+                   "soundio/driftresampler.cpp",
                    "soundio/sounddevice.cpp",
                    "soundio/sounddevicenetwork.cpp",
                    "engine/sidechain/enginenetworkstream.cpp",
@@ -1113,6 +1168,7 @@ class MixxxCore(Feature):
                    "soundio/soundmanagerutil.cpp",
 
                    "encoder/encoder.cpp",
+                   "encoder/encodedpacket.cpp",
                    "encoder/encodermp3.cpp",
                    "encoder/encodervorbis.cpp",
                    "encoder/encoderwave.cpp",
@@ -1125,6 +1181,13 @@ class MixxxCore(Feature):
 
                    "util/sleepableqthread.cpp",
                    "util/statsmanager.cpp",
+                   "util/statsmetrics.cpp",
+                   "util/flightrecorder.cpp",
+                   "util/lockprofiler.cpp",
+                   "util/eventloopprofiler.cpp",
+                   "util/memoryaccounting.cpp",
+                   "util/realtimesafety.cpp",
+                   "util/fifowakeup.cpp",
                    "util/stat.cpp",
                    "util/statmodel.cpp",
                    "util/duration.cpp",
@@ -1134,10 +1197,12 @@ class MixxxCore(Feature):
                    "util/threadcputimer.cpp",
                    "util/version.cpp",
                    "util/rlimit.cpp",
+                   "util/threadroles.cpp",
                    "util/battery/battery.cpp",
                    "util/valuetransformer.cpp",
                    "util/sandbox.cpp",
                    "util/file.cpp",
+                   "util/fileprefetcher.cpp",
                    "util/mac.cpp",
                    "util/task.cpp",
                    "util/experiment.cpp",
@@ -1150,24 +1215,32 @@ class MixxxCore(Feature):
                    "util/db/dbconnectionpooler.cpp",
                    "util/db/dbconnectionpooled.cpp",
                    "util/db/dbid.cpp",
+                   "util/db/cachedsqlquery.cpp",
                    "util/db/fwdsqlquery.cpp",
                    "util/db/fwdsqlqueryselectresult.cpp",
                    "util/db/sqllikewildcardescaper.cpp",
                    "util/db/sqlqueryfinisher.cpp",
+                   "util/db/sqlqueryprofiler.cpp",
                    "util/db/sqlstringformatter.cpp",
                    "util/db/sqltransaction.cpp",
                    "util/sample.cpp",
+                   "util/samplekernels_sse2.cpp",
+                   "util/samplekernels_avx2.cpp",
+                   "util/samplekernels_neon.cpp",
                    "util/samplebuffer.cpp",
+                   "util/rampedparameter.cpp",
                    "util/readaheadsamplebuffer.cpp",
                    "util/rotary.cpp",
                    "util/logger.cpp",
                    "util/logging.cpp",
                    "util/cmdlineargs.cpp",
+                   "util/startupbenchmark.cpp",
                    "util/audiosignal.cpp",
                    "util/widgethider.cpp",
                    "util/autohidpi.cpp",
                    "util/screensaver.cpp",
                    "util/indexrange.cpp",
+                   "util/timerwheel.cpp",
 
                    '#res/mixxx.qrc'
                    ]
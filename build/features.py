@@ -359,6 +359,7 @@ class VinylControl(Feature):
                    'vinylcontrol/vinylcontrolmanager.cpp',
                    'vinylcontrol/vinylcontrolprocessor.cpp',
                    'vinylcontrol/steadypitch.cpp',
+                   'vinylcontrol/timecodelookupcache.cpp',
                    'engine/vinylcontrolcontrol.cpp', ]
         if build.platform_is_windows:
             sources.append("#lib/xwax/timecoder_win32.cpp")
@@ -416,6 +417,7 @@ class Vamp(Feature):
     def sources(self, build):
         sources = ['analyzer/vamp/vampanalyzer.cpp',
                    'analyzer/vamp/vamppluginloader.cpp',
+                   'analyzer/vamp/vamppluginpool.cpp',
                    'analyzer/analyzerbeats.cpp',
                    'analyzer/analyzerkey.cpp',
                    'preferences/dialog/dlgprefbeats.cpp',
@@ -588,6 +590,36 @@ class Sanitizers(Feature):
         build.env.Append(LINKFLAGS="-fsanitize=%s" % ','.join(sanitizers))
 
 
+class RealtimeSafety(Feature):
+    def description(self):
+        return "Real-time safety checks of the audio callback thread"
+
+    def enabled(self, build):
+        build.flags['rtsafety'] = util.get_flags(build.env, 'rtsafety', 0)
+        if int(build.flags['rtsafety']):
+            return True
+        return False
+
+    def add_options(self, build, vars):
+        vars.Add('rtsafety',
+                 '(DEVELOPER) Set to 1 to intercept the allocations and the blocking calls of the audio callback thread for --realtimeSafety.', 0)
+
+    def configure(self, build, conf):
+        if not self.enabled(build):
+            return
+
+        if build.platform_is_windows:
+            self.status = "Only allocations of C++ code are seen"
+        # Both replace malloc() and free()
+        if int(util.get_flags(build.env, 'perftools', 0)) or \
+                int(util.get_flags(build.env, 'asan', 0)):
+            raise Exception('rtsafety can not be combined with perftools or asan.')
+
+        build.env.Append(CPPDEFINES='MIXXX_REALTIME_SAFETY_HOOKS')
+        if build.platform_is_linux or build.platform_is_bsd:
+            conf.CheckLib(['dl', 'libdl'])
+
+
 class PerfTools(Feature):
     def description(self):
         return "Google PerfTools"
@@ -769,7 +801,8 @@ class TestSuite(Feature):
 
     def enabled(self, build):
         build.flags['test'] = util.get_flags(build.env, 'test', 0) or \
-            'test' in SCons.BUILD_TARGETS
+            'test' in SCons.BUILD_TARGETS or \
+            'benchmark' in SCons.BUILD_TARGETS
         if int(build.flags['test']):
             return True
         return False
@@ -854,6 +887,7 @@ class LiveBroadcasting(Feature):
         depends.Qt.uic(build)('preferences/dialog/dlgprefbroadcastdlg.ui')
         return ['preferences/dialog/dlgprefbroadcast.cpp',
                 'broadcast/broadcastmanager.cpp',
+                'broadcast/sharedencoder.cpp',
                 'engine/sidechain/shoutconnection.cpp']
 
 
@@ -900,6 +934,51 @@ class Opus(Feature):
         return ['sources/soundsourceopus.cpp']
 
 
+class Jack(Feature):
+    def description(self):
+        return "Native JACK sound device"
+
+    def default(self, build):
+        return 1 if build.platform_is_linux else 0
+
+    def enabled(self, build):
+        # Default JACK to on on Linux but only throw an error if it was
+        # explicitly requested.
+        if 'jack' in build.flags:
+            return int(build.flags['jack']) > 0
+        build.flags['jack'] = util.get_flags(
+            build.env, 'jack', self.default(build))
+        if int(build.flags['jack']):
+            return True
+        return False
+
+    def add_options(self, build, vars):
+        vars.Add('jack', 'Set to 1 to enable the native JACK sound device, \
+                          which bypasses PortAudio.', self.default(build))
+
+    def configure(self, build, conf):
+        if not self.enabled(build):
+            return
+
+        # Only block the configure if jack was explicitly requested.
+        explicit = 'jack' in SCons.ARGUMENTS
+
+        if not conf.CheckLib('jack') or not conf.CheckHeader('jack/jack.h'):
+            if explicit:
+                raise Exception('Could not find libjack or its development headers.')
+            else:
+                build.flags['jack'] = 0
+            return
+
+        build.env.Append(CPPDEFINES='__JACK__')
+
+        if build.platform_is_linux or build.platform_is_bsd:
+            build.env.ParseConfig('pkg-config jack --silence-errors --cflags --libs')
+
+    def sources(self, build):
+        return ['soundio/sounddevicejack.cpp']
+
+
 class FFMPEG(Feature):
     def description(self):
         return "FFmpeg/Avconv support"
@@ -20,6 +20,10 @@
 #ifndef LUT_H
 #define LUT_H
 
+/* The number of bits to form the hash, see lut.c */
+
+#define LUT_HASH_BITS 16
+
 typedef unsigned int slot_no_t;
 
 struct slot {
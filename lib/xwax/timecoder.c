@@ -228,12 +228,13 @@ static int build_lookup(struct timecode_def *def)
 }
 
 /*
- * Find a timecode definition by name
+ * Find a timecode definition by name, without building its lookup
+ * table
  *
  * Return: pointer to timecode definition, or NULL if not found
  */
 
-struct timecode_def* timecoder_find_definition(const char *name)
+struct timecode_def* timecoder_get_definition_by_name(const char *name)
 {
     struct timecode_def *def, *end;
 
@@ -250,12 +251,77 @@ struct timecode_def* timecoder_find_definition(const char *name)
             return NULL;
     }
 
+    return def;
+}
+
+/*
+ * Find a timecode definition by name
+ *
+ * Return: pointer to timecode definition, or NULL if not found
+ */
+
+struct timecode_def* timecoder_find_definition(const char *name)
+{
+    struct timecode_def *def;
+
+    def = timecoder_get_definition_by_name(name);
+    if (def == NULL)
+        return NULL;
+
     if (build_lookup(def) == -1)
         return NULL;
 
     return def;
 }
 
+/*
+ * Build the lookup table of a definition, if it has none yet
+ *
+ * Return: -1 if not enough memory could be allocated, otherwise 0
+ */
+
+int timecoder_build_lookup(struct timecode_def *def)
+{
+    return build_lookup(def);
+}
+
+/*
+ * Use a lookup table that has been built before, e.g. loaded from a
+ * file. The memory is owned by the caller and must stay valid until
+ * the lookup is cleared.
+ */
+
+void timecoder_set_lookup(struct timecode_def *def,
+                          struct slot *slot, slot_no_t *table)
+{
+    dassert(!def->lookup);
+
+    def->lut.slot = slot;
+    def->lut.table = table;
+    def->lut.avail = def->length;
+    def->lookup = true;
+    def->lookup_external = true;
+}
+
+/*
+ * Free the lookup table of a definition when it is no longer needed,
+ * after all timecoders that use it have been cleared
+ */
+
+void timecoder_clear_lookup(struct timecode_def *def)
+{
+    if (!def->lookup)
+        return;
+
+    if (!def->lookup_external)
+        lut_clear(&def->lut);
+
+    def->lut.slot = NULL;
+    def->lut.table = NULL;
+    def->lookup = false;
+    def->lookup_external = false;
+}
+
 /*
  * Free the timecoder lookup tables when they are no longer needed
  */
@@ -267,8 +333,7 @@ void timecoder_free_lookup(void) {
     end = def + ARRAY_SIZE(timecodes);
 
     while (def < end) {
-        if (def->lookup)
-            lut_clear(&def->lut);
+        timecoder_clear_lookup(def);
         def++;
     }
 }
@@ -602,6 +667,56 @@ void timecoder_submit(struct timecoder *tc, signed short *pcm, size_t npcm)
     }
 }
 
+/*
+ * Scale a float sample to the full range of a signed int, like a
+ * signed short sample that has been shifted
+ */
+
+static inline signed int scale_float_sample(float v, float gain)
+{
+    float s;
+
+    s = v * gain * SHRT_MAX;
+    if (s > SHRT_MAX)
+        s = SHRT_MAX;
+    else if (s < SHRT_MIN)
+        s = SHRT_MIN;
+
+    return (signed int)s * (1 << 16);
+}
+
+/*
+ * Submit and decode a block of float PCM audio in the range -1.0 to
+ * 1.0 before the gain is applied, e.g. the native samples of an audio
+ * engine. The result is the same as for timecoder_submit() with the
+ * samples converted to signed short, without converting the whole
+ * block first.
+ */
+
+void timecoder_submit_float(struct timecoder *tc, const float *pcm,
+                            size_t npcm, float gain)
+{
+    while (npcm--) {
+	signed int left, right, primary, secondary;
+
+        left = scale_float_sample(pcm[0], gain);
+        right = scale_float_sample(pcm[1], gain);
+
+        if (tc->def->flags & SWITCH_PRIMARY) {
+            primary = left;
+            secondary = right;
+        } else {
+            primary = right;
+            secondary = left;
+        }
+
+	process_sample(tc, primary, secondary);
+        update_monitor(tc, left, right);
+
+        pcm += TIMECODER_CHANNELS;
+    }
+}
+
 /*
  * Get the last-known position of the timecode
  *
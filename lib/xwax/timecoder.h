@@ -46,6 +46,7 @@ struct timecode_def {
         safe; /* last 'safe' timecode number (for auto disconnect) */
     bool lookup; /* true if lut has been generated */
     struct lut lut;
+    bool lookup_external; /* true if the memory of lut is not owned */
 };
 
 struct timecoder_channel {
@@ -84,7 +85,12 @@ struct timecoder {
     int mon_size, mon_counter;
 };
 
+struct timecode_def* timecoder_get_definition_by_name(const char *name);
 struct timecode_def* timecoder_find_definition(const char *name);
+int timecoder_build_lookup(struct timecode_def *def);
+void timecoder_set_lookup(struct timecode_def *def,
+                          struct slot *slot, slot_no_t *table);
+void timecoder_clear_lookup(struct timecode_def *def);
 void timecoder_free_lookup(void);
 
 void timecoder_init(struct timecoder *tc, struct timecode_def *def,
@@ -96,6 +102,8 @@ void timecoder_monitor_clear(struct timecoder *tc);
 
 void timecoder_cycle_definition(struct timecoder *tc);
 void timecoder_submit(struct timecoder *tc, signed short *pcm, size_t npcm);
+void timecoder_submit_float(struct timecoder *tc, const float *pcm,
+                            size_t npcm, float gain);
 signed int timecoder_get_position(struct timecoder *tc, double *when);
 
 /*
@@ -0,0 +1,282 @@
+#include "analyzer/analysiscache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+#include <vector>
+
+#include "library/dao/analysisdao.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "track/beatfactory.h"
+#include "track/keyfactory.h"
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/sample.h"
+#include "util/samplebuffer.h"
+#include "waveform/waveformfactory.h"
+
+namespace {
+
+const mixxx::Logger kLogger("AnalysisCache");
+
+// Must be changed whenever the layout of the cache files changes
+const quint32 kMagic = 0x4d584143; // "MXAC"
+const quint32 kFormatVersion = 1;
+
+const QString kFileSuffix = QStringLiteral(".analysis");
+
+const SINT kFramesPerBlock = 4096;
+
+// Set once on startup before any track is analyzed
+QString s_directory;
+
+struct StoredAnalysis {
+    QString version;
+    QString subVersion;
+    QByteArray data;
+
+    bool isEmpty() const {
+        return data.isEmpty();
+    }
+};
+
+struct Entry {
+    Entry()
+            : replayGainRatio(mixxx::ReplayGain::kRatioUndefined),
+              replayGainPeak(mixxx::ReplayGain::kPeakUndefined) {
+    }
+
+    StoredAnalysis beats;
+    StoredAnalysis keys;
+    double replayGainRatio;
+    float replayGainPeak;
+    // The sub version is the description of the waveform
+    StoredAnalysis waveform;
+    StoredAnalysis waveformSummary;
+};
+
+QDataStream& operator<<(QDataStream& out, const StoredAnalysis& analysis) {
+    return out << analysis.version << analysis.subVersion << analysis.data;
+}
+
+QDataStream& operator>>(QDataStream& in, StoredAnalysis& analysis) {
+    return in >> analysis.version >> analysis.subVersion >> analysis.data;
+}
+
+bool readEntry(const QString& filePath, Entry* pEntry) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = qUncompress(file.readAll());
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint32 formatVersion = 0;
+    in >> magic >> formatVersion;
+    if (magic != kMagic || formatVersion != kFormatVersion) {
+        kLogger.warning() << "Invalid cache file" << filePath;
+        return false;
+    }
+    in >> pEntry->beats >> pEntry->keys
+            >> pEntry->replayGainRatio >> pEntry->replayGainPeak
+            >> pEntry->waveform >> pEntry->waveformSummary;
+    if (in.status() != QDataStream::Ok) {
+        kLogger.warning() << "Failed to read" << filePath;
+        return false;
+    }
+    return true;
+}
+
+void writeEntry(const QString& filePath, const Entry& entry) {
+    QByteArray data;
+    {
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_0);
+        out << kMagic << kFormatVersion
+                << entry.beats << entry.keys
+                << entry.replayGainRatio << entry.replayGainPeak
+                << entry.waveform << entry.waveformSummary;
+    }
+    // Written to a temporary file that replaces the entry on commit
+    QSaveFile file(filePath);
+    const QByteArray compressed = qCompress(data);
+    if (!file.open(QIODevice::WriteOnly) ||
+            file.write(compressed) != compressed.size() ||
+            !file.commit()) {
+        kLogger.warning() << "Failed to write" << filePath
+                << file.errorString();
+    }
+}
+
+ConstWaveformPointer waveformFromStoredAnalysis(
+        const StoredAnalysis& analysis) {
+    AnalysisDao::AnalysisInfo info;
+    info.version = analysis.version;
+    info.description = analysis.subVersion;
+    info.data = analysis.data;
+    Waveform* pWaveform = WaveformFactory::loadWaveformFromAnalysis(info);
+    // Saved to the database of this library with the track
+    pWaveform->setSaveState(Waveform::SaveState::SavePending);
+    return ConstWaveformPointer(pWaveform);
+}
+
+StoredAnalysis storedAnalysisFromWaveform(const ConstWaveformPointer& pWaveform) {
+    StoredAnalysis analysis;
+    analysis.version = pWaveform->getVersion();
+    analysis.subVersion = pWaveform->getDescription();
+    analysis.data = pWaveform->toByteArray();
+    return analysis;
+}
+
+} // anonymous namespace
+
+// 10 seconds at 44.1 kHz, decoded in a few milliseconds
+const SINT AnalysisCache::kFingerprintFrames = 441000;
+
+//static
+void AnalysisCache::setDirectory(const QString& directory) {
+    s_directory = directory;
+    if (!s_directory.isEmpty() && !QDir().mkpath(s_directory)) {
+        kLogger.warning() << "Failed to create" << s_directory;
+        s_directory.clear();
+    }
+}
+
+//static
+bool AnalysisCache::isEnabled() {
+    return !s_directory.isEmpty();
+}
+
+//static
+QString AnalysisCache::filePathForFingerprint(const QString& fingerprint) {
+    return QDir(s_directory).filePath(fingerprint + kFileSuffix);
+}
+
+//static
+QString AnalysisCache::fingerprint(const mixxx::AudioSourcePointer& pAudioSource) {
+    mixxx::AudioSourceStereoProxy audioSourceProxy(
+            pAudioSource, kFramesPerBlock);
+    mixxx::SampleBuffer sampleBuffer(
+            kFramesPerBlock * audioSourceProxy.channelCount());
+    std::vector<SAMPLE> convertedSamples(sampleBuffer.size());
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const qint64 header[] = {
+            pAudioSource->sampleRate(),
+            pAudioSource->frameLength() };
+    hash.addData(reinterpret_cast<const char*>(header), sizeof(header));
+
+    mixxx::IndexRange remainingFrames = pAudioSource->frameIndexRange();
+    remainingFrames = remainingFrames.splitAndShrinkFront(
+            math_min(kFingerprintFrames, remainingFrames.length()));
+    while (!remainingFrames.empty()) {
+        const auto inputFrameIndexRange =
+                remainingFrames.splitAndShrinkFront(
+                        math_min(kFramesPerBlock, remainingFrames.length()));
+        const auto readableSampleFrames =
+                audioSourceProxy.readSampleFrames(
+                        mixxx::WritableSampleFrames(
+                                inputFrameIndexRange,
+                                mixxx::SampleBuffer::WritableSlice(sampleBuffer)));
+        if (readableSampleFrames.frameIndexRange() != inputFrameIndexRange) {
+            kLogger.warning()
+                    << "Failed to read the fingerprint of"
+                    << pAudioSource->getUrlString();
+            return QString();
+        }
+        // The integer samples don't depend on the rounding of the decoder
+        SampleUtil::convertFloat32ToS16(convertedSamples.data(),
+                readableSampleFrames.readableData(),
+                readableSampleFrames.readableLength());
+        hash.addData(reinterpret_cast<const char*>(convertedSamples.data()),
+                readableSampleFrames.readableLength() * sizeof(SAMPLE));
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+//static
+bool AnalysisCache::load(const QString& fingerprint, Track* pTrack) {
+    if (!isEnabled()) {
+        return false;
+    }
+    Entry entry;
+    if (!readEntry(filePathForFingerprint(fingerprint), &entry)) {
+        return false;
+    }
+
+    if (!entry.beats.isEmpty() && !pTrack->getBeats()) {
+        BeatsPointer pBeats = BeatFactory::loadBeatsFromByteArray(*pTrack,
+                entry.beats.version, entry.beats.subVersion, entry.beats.data);
+        if (pBeats) {
+            pTrack->setBeats(pBeats);
+        }
+    }
+    if (!entry.keys.isEmpty() && !pTrack->getKeys().isValid()) {
+        const Keys keys = KeyFactory::loadKeysFromByteArray(
+                entry.keys.version, entry.keys.subVersion, &entry.keys.data);
+        if (keys.isValid()) {
+            pTrack->setKeys(keys);
+        }
+    }
+    if (mixxx::ReplayGain::isValidRatio(entry.replayGainRatio) &&
+            !pTrack->getReplayGain().hasRatio()) {
+        pTrack->setReplayGain(mixxx::ReplayGain(
+                entry.replayGainRatio, entry.replayGainPeak));
+    }
+    // Both waveforms are needed, otherwise they are analyzed anyway
+    if (!entry.waveform.isEmpty() && !entry.waveformSummary.isEmpty() &&
+            WaveformFactory::waveformVersionToVersionClass(
+                    entry.waveform.version) == WaveformFactory::VC_USE &&
+            WaveformFactory::waveformSummaryVersionToVersionClass(
+                    entry.waveformSummary.version) == WaveformFactory::VC_USE &&
+            !pTrack->getWaveform() && !pTrack->getWaveformSummary()) {
+        pTrack->setWaveform(waveformFromStoredAnalysis(entry.waveform));
+        pTrack->setWaveformSummary(
+                waveformFromStoredAnalysis(entry.waveformSummary));
+    }
+    kLogger.debug() << "Loaded the cached analysis of" << pTrack->getLocation();
+    return true;
+}
+
+//static
+void AnalysisCache::store(const QString& fingerprint, const Track& track) {
+    if (!isEnabled()) {
+        return;
+    }
+    const QString filePath = filePathForFingerprint(fingerprint);
+    // Results that the track doesn't have, e.g. the waveforms that are
+    // not analyzed by every queue, are kept
+    Entry entry;
+    if (!readEntry(filePath, &entry)) {
+        entry = Entry();
+    }
+
+    const BeatsPointer pBeats = track.getBeats();
+    if (pBeats) {
+        entry.beats.version = pBeats->getVersion();
+        entry.beats.subVersion = pBeats->getSubVersion();
+        entry.beats.data = pBeats->toByteArray();
+    }
+    const Keys keys = track.getKeys();
+    if (keys.isValid()) {
+        entry.keys.version = keys.getVersion();
+        entry.keys.subVersion = keys.getSubVersion();
+        entry.keys.data = keys.toByteArray();
+    }
+    const mixxx::ReplayGain replayGain = track.getReplayGain();
+    if (replayGain.hasRatio()) {
+        entry.replayGainRatio = replayGain.getRatio();
+        entry.replayGainPeak = replayGain.getPeak();
+    }
+    const ConstWaveformPointer pWaveform = track.getWaveform();
+    const ConstWaveformPointer pWaveformSummary = track.getWaveformSummary();
+    if (pWaveform && pWaveformSummary) {
+        entry.waveform = storedAnalysisFromWaveform(pWaveform);
+        entry.waveformSummary = storedAnalysisFromWaveform(pWaveformSummary);
+    }
+    writeEntry(filePath, entry);
+}
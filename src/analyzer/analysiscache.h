@@ -0,0 +1,49 @@
+#ifndef ANALYZER_ANALYSISCACHE_H
+#define ANALYZER_ANALYSISCACHE_H
+
+#include <QString>
+
+#include "sources/audiosource.h"
+#include "track/track.h"
+#include "util/types.h"
+
+// A cache of the analysis results that is keyed by a fingerprint of the
+// decoded audio instead of the library track, so copies of a file, files
+// that have been moved or imported again and the same files in the library
+// of another machine reuse the results of the first analysis. Each entry
+// holds the beats, the keys, the ReplayGain and the waveforms of a track
+// in a small file named by the fingerprint. The directory may be shared
+// by several installations, e.g. synchronized between machines with the
+// same library. The cache is disabled until a directory has been set.
+//
+// The fingerprint is a hash of the first kFingerprintFrames frames of the
+// audio, converted to 16 bit integers, and of the length and sample rate.
+// Files with the same decoded audio share the fingerprint, but files that
+// have been encoded again usually don't.
+//
+// The functions may be called from any thread. An entry is replaced
+// atomically.
+class AnalysisCache {
+  public:
+    static const SINT kFingerprintFrames;
+
+    // An empty directory disables the cache
+    static void setDirectory(const QString& directory);
+    static bool isEnabled();
+
+    // Reads the beginning of the audio source. Returns an empty string
+    // if it cannot be read.
+    static QString fingerprint(const mixxx::AudioSourcePointer& pAudioSource);
+
+    // Sets those results of the entry that the track is missing. Returns
+    // false if there is no entry for the fingerprint.
+    static bool load(const QString& fingerprint, Track* pTrack);
+
+    // Adds the results of the track to the entry of the fingerprint
+    static void store(const QString& fingerprint, const Track& track);
+
+  private:
+    static QString filePathForFingerprint(const QString& fingerprint);
+};
+
+#endif // ANALYZER_ANALYSISCACHE_H
@@ -15,11 +15,33 @@
 
 class Analyzer {
   public:
+    // The samples that are passed to process(). They are converted once
+    // per block and shared by all analyzers with the same format.
+    enum class InputFormat {
+        // Interleaved stereo samples at the sample rate of the track
+        Stereo,
+        // The average of both channels
+        Mono,
+        // The average of both channels and of each pair of frames, at
+        // half the sample rate of the track
+        MonoHalfRate,
+        // The average of both channels, low pass filtered and decimated to
+        // a quarter of the sample rate of the track, see AnalyzerDecimator
+        MonoQuarterRate,
+    };
+
+    // The sample rate and the total number of samples are always those
+    // of the interleaved stereo track, independent of inputFormat()
     virtual bool initialize(TrackPointer tio, int sampleRate, int totalSamples) = 0;
     virtual bool isDisabledOrLoadStoredSuccess(TrackPointer tio) const = 0;
+    // May be called from another thread than the other functions, but
+    // never concurrently with initialize(), cleanup() or finalize()
     virtual void process(const CSAMPLE* pIn, const int iLen) = 0;
     virtual void cleanup(TrackPointer tio) = 0;
     virtual void finalize(TrackPointer tio) = 0;
+    virtual InputFormat inputFormat() const {
+        return InputFormat::Stereo;
+    }
     virtual ~Analyzer() {}
 };
 
@@ -0,0 +1,217 @@
+#include "analyzer/analyzerbatch.h"
+
+#include <QDir>
+#include <QSqlQuery>
+#include <QSqlRecord>
+
+#include <stdio.h>
+
+#include "analyzer/analysiscache.h"
+#include "database/mixxxdb.h"
+#include "library/dao/analysisdao.h"
+#include "library/dao/trackschema.h"
+#include "library/queryutil.h"
+#include "sources/mp3seekframecache.h"
+#include "util/db/dbconnectionpooled.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/db/sqllikewildcardescaper.h"
+#include "util/db/sqllikewildcards.h"
+#include "util/db/sqlstringformatter.h"
+#include "util/logger.h"
+#include "util/sandbox.h"
+#include "util/threadroles.h"
+
+namespace {
+
+mixxx::Logger kLogger("AnalyzerBatch");
+
+const ConfigKey kBpmDetectionEnabledKey("[BPM]", "BPMDetectionEnabled");
+
+AnalyzerQueue::Mode analyzerQueueMode(const UserSettingsPointer& pConfig) {
+    if (pConfig->getValue(ConfigKey("[Library]", "EnableWaveformGenerationWithAnalysis"), true)) {
+        return AnalyzerQueue::Mode::Default;
+    } else {
+        return AnalyzerQueue::Mode::WithoutWaveform;
+    }
+}
+
+} // anonymous namespace
+
+AnalyzerBatch::AnalyzerBatch(
+        UserSettingsPointer pConfig,
+        const QString& mode,
+        const QString& pathPrefix)
+        : m_pConfig(pConfig),
+          m_bUnanalyzedOnly(mode != "all"),
+          m_pathPrefix(pathPrefix),
+          m_bAllQueued(false),
+          m_numQueued(0),
+          m_numFinished(0),
+          m_numAnalyzed(0),
+          m_analyzedSeconds(0.0) {
+}
+
+AnalyzerBatch::~AnalyzerBatch() {
+}
+
+void AnalyzerBatch::onEvictingTrackFromCache(TrackCacheLocker* pCacheLocker, Track* pTrack) {
+    m_pTrackCollection->saveTrack(pCacheLocker, pTrack);
+}
+
+int AnalyzerBatch::run() {
+    Sandbox::initialize(QDir(m_pConfig->getSettingsPath()).filePath("sandbox.cfg"));
+    mixxx::ThreadRoles::configure(m_pConfig);
+    if (m_pConfig->getValue(ConfigKey("[SoundSourceMP3]", "seek_frame_cache"), 1) > 0) {
+        mixxx::Mp3SeekFrameCache::setDirectory(
+                QDir(m_pConfig->getSettingsPath()).filePath("mp3seekcache"));
+    }
+    if (m_pConfig->getValue(ConfigKey("[Library]", "AnalysisCache"), 1) > 0) {
+        AnalysisCache::setDirectory(m_pConfig->getValue(
+                ConfigKey("[Library]", "AnalysisCacheDirectory"),
+                QDir(m_pConfig->getSettingsPath()).filePath("analysiscache")));
+    }
+
+    m_pDbConnectionPool = MixxxDb(m_pConfig).connectionPool();
+    if (!m_pDbConnectionPool) {
+        return -1;
+    }
+    int result = 0;
+    {
+        const mixxx::DbConnectionPooler dbConnectionPooler(m_pDbConnectionPool);
+        QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
+        if (!dbConnection.isOpen()) {
+            kLogger.critical() << "Unable to open the database";
+            return -1;
+        }
+        if (!MixxxDb::initDatabaseSchema(dbConnection)) {
+            return -1;
+        }
+        m_pTrackCollection = std::make_unique<TrackCollection>(m_pConfig);
+        m_pTrackCollection->connectDatabase(dbConnection);
+        TrackCache::createInstance(this);
+
+        // The analysis view forces the beat detection on in the same way
+        const QString oldBpmDetectionEnabled =
+                m_pConfig->getValueString(kBpmDetectionEnabledKey);
+        m_pConfig->set(kBpmDetectionEnabledKey, ConfigValue(1));
+
+        const QList<TrackId> trackIds = selectTrackIds(dbConnection);
+        fprintf(stdout, "Analyzing %d tracks\n", trackIds.size());
+        fflush(stdout);
+
+        m_pAnalyzerQueue = std::make_unique<AnalyzerQueue>(
+                m_pDbConnectionPool,
+                m_pConfig,
+                analyzerQueueMode(m_pConfig),
+                AnalyzerQueue::numWorkersForBatchAnalysis(m_pConfig));
+        connect(m_pAnalyzerQueue.get(), SIGNAL(trackDone(TrackPointer)),
+                this, SLOT(slotTrackDone(TrackPointer)));
+        connect(m_pAnalyzerQueue.get(), SIGNAL(trackFinished(int)),
+                this, SLOT(slotTrackFinished(int)));
+        connect(m_pAnalyzerQueue.get(), SIGNAL(queueEmpty()),
+                this, SLOT(slotQueueEmpty()));
+
+        m_timer.start();
+        for (const auto& trackId : trackIds) {
+            TrackPointer pTrack = m_pTrackCollection->getTrackDAO().getTrack(trackId);
+            if (pTrack) {
+                m_pAnalyzerQueue->queueAnalyseTrack(pTrack);
+                ++m_numQueued;
+            }
+        }
+        m_bAllQueued = true;
+        if (m_numQueued > 0) {
+            m_eventLoop.exec();
+        }
+        printStats();
+
+        m_pAnalyzerQueue->stop();
+        m_pAnalyzerQueue.reset();
+        m_pConfig->set(kBpmDetectionEnabledKey, ConfigValue(oldBpmDetectionEnabled));
+
+        // Saves the results of all tracks
+        TrackCache::instance().evictAll();
+        TrackCache::destroyInstance();
+        m_pTrackCollection->disconnectDatabase();
+        m_pTrackCollection.reset();
+        if (m_numFinished < m_numQueued) {
+            result = 1;
+        }
+    }
+    m_pDbConnectionPool.reset();
+    return result;
+}
+
+QList<TrackId> AnalyzerBatch::selectTrackIds(const QSqlDatabase& database) const {
+    QString where = QString("library.%1=0 AND track_locations.%2=0").arg(
+            LIBRARYTABLE_MIXXXDELETED, TRACKLOCATIONSTABLE_FSDELETED);
+    if (!m_pathPrefix.isEmpty()) {
+        // The prefix needs to end in a slash otherwise we might match
+        // other directories
+        const QString dirPath = QDir(m_pathPrefix).absolutePath();
+        const QString likeClause = SqlLikeWildcardEscaper::apply(
+                dirPath + "/", kSqlLikeMatchAll) + kSqlLikeMatchAll;
+        where += QString(" AND track_locations.location LIKE %1 ESCAPE '%2'").arg(
+                SqlStringFormatter::format(database, likeClause), kSqlLikeMatchAll);
+    }
+    if (m_bUnanalyzedOnly) {
+        QString missing = "library.beats IS NULL OR library.keys IS NULL";
+        if (analyzerQueueMode(m_pConfig) == AnalyzerQueue::Mode::Default) {
+            missing += QString(" OR library.id NOT IN "
+                    "(SELECT track_id FROM track_analysis WHERE type=%1)").arg(
+                            AnalysisDao::TYPE_WAVEFORM);
+        }
+        where += QString(" AND (%1)").arg(missing);
+    }
+
+    QSqlQuery query(database);
+    query.prepare(QString("SELECT library.id FROM library INNER JOIN track_locations "
+                          "ON library.location = track_locations.id WHERE %1").arg(where));
+    QList<TrackId> trackIds;
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query) << "could not select the tracks to analyze";
+        return trackIds;
+    }
+    const int idColumn = query.record().indexOf("id");
+    while (query.next()) {
+        trackIds.append(TrackId(query.value(idColumn)));
+    }
+    return trackIds;
+}
+
+void AnalyzerBatch::slotTrackDone(TrackPointer pTrack) {
+    ++m_numAnalyzed;
+    m_analyzedSeconds += pTrack->getDuration();
+}
+
+void AnalyzerBatch::slotTrackFinished(int queueSize) {
+    ++m_numFinished;
+    fprintf(stdout, "Finished %d of %d tracks, %d waiting\n",
+            m_numFinished, m_numQueued, queueSize);
+    fflush(stdout);
+}
+
+void AnalyzerBatch::slotQueueEmpty() {
+    // Also emitted when the queue runs empty while the tracks are queued
+    if (!m_bAllQueued || !m_pAnalyzerQueue->isEmpty()) {
+        return;
+    }
+    // Passes the progress that is still pending
+    m_pAnalyzerQueue->slotUpdateProgress();
+    m_eventLoop.quit();
+}
+
+void AnalyzerBatch::printStats() const {
+    const double elapsedSeconds = m_timer.elapsed().toDoubleSeconds();
+    fprintf(stdout, "Analyzed %d and skipped %d of %d tracks in %.1f s\n",
+            m_numAnalyzed, m_numFinished - m_numAnalyzed, m_numQueued,
+            elapsedSeconds);
+    if (elapsedSeconds > 0.0) {
+        fprintf(stdout, "%.1f tracks per minute, %.1f min of audio, "
+                "%.1f times real time\n",
+                m_numFinished * 60.0 / elapsedSeconds,
+                m_analyzedSeconds / 60.0,
+                m_analyzedSeconds / elapsedSeconds);
+    }
+    fflush(stdout);
+}
@@ -0,0 +1,66 @@
+#ifndef ANALYZER_ANALYZERBATCH_H
+#define ANALYZER_ANALYZERBATCH_H
+
+#include <QEventLoop>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include "analyzer/analyzerqueue.h"
+#include "library/trackcollection.h"
+#include "preferences/usersettings.h"
+#include "track/trackcache.h"
+#include "util/db/dbconnectionpool.h"
+#include "util/memory.h"
+#include "util/performancetimer.h"
+
+// Analyzes a selection of the library from the command line without any
+// windows, skins, controllers or sound devices, see --analyze. The
+// tracks are analyzed by the workers of an AnalyzerQueue as in the
+// analysis view, and the results are saved into the library when the
+// tracks are evicted from the cache.
+class AnalyzerBatch : public QObject,
+    public virtual /*implements*/ TrackCacheEvictor {
+    Q_OBJECT
+
+  public:
+    // mode is "all" or "unanalyzed". Only the tracks below pathPrefix
+    // are analyzed if it is not empty.
+    AnalyzerBatch(
+            UserSettingsPointer pConfig,
+            const QString& mode,
+            const QString& pathPrefix);
+    ~AnalyzerBatch() override;
+
+    void onEvictingTrackFromCache(TrackCacheLocker* pCacheLocker, Track* pTrack) override;
+
+    // Returns the exit code of the application
+    int run();
+
+  private slots:
+    void slotTrackDone(TrackPointer pTrack);
+    void slotTrackFinished(int queueSize);
+    void slotQueueEmpty();
+
+  private:
+    QList<TrackId> selectTrackIds(const QSqlDatabase& database) const;
+    void printStats() const;
+
+    const UserSettingsPointer m_pConfig;
+    const bool m_bUnanalyzedOnly;
+    const QString m_pathPrefix;
+
+    mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+    std::unique_ptr<TrackCollection> m_pTrackCollection;
+    std::unique_ptr<AnalyzerQueue> m_pAnalyzerQueue;
+
+    QEventLoop m_eventLoop;
+    PerformanceTimer m_timer;
+    bool m_bAllQueued;
+    int m_numQueued;
+    int m_numFinished;
+    int m_numAnalyzed;
+    double m_analyzedSeconds;
+};
+
+#endif // ANALYZER_ANALYZERBATCH_H
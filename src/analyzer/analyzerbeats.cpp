@@ -16,10 +16,22 @@
 #include "track/beatmap.h"
 #include "track/beatutils.h"
 #include "track/track.h"
+#include "util/math.h"
+
+namespace {
+
+// The length of the beginning of a track that the quick analysis covers
+const int kQuickAnalysisSeconds = 60;
+
+const QString kProvisionalSubVersionFragment = QStringLiteral("provisional=1");
+
+} // anonymous namespace
 
 AnalyzerBeats::AnalyzerBeats(UserSettingsPointer pConfig)
         : m_pConfig(pConfig),
           m_pVamp(NULL),
+          m_pQuickVamp(NULL),
+          m_iQuickSamplesRemaining(0),
           m_bPreferencesReanalyzeOldBpm(false),
           m_bPreferencesFixedTempo(true),
           m_bPreferencesOffsetCorrection(false),
@@ -31,6 +43,8 @@ AnalyzerBeats::AnalyzerBeats(UserSettingsPointer pConfig)
 }
 
 AnalyzerBeats::~AnalyzerBeats() {
+    delete m_pVamp;
+    delete m_pQuickVamp;
 }
 
 bool AnalyzerBeats::initialize(TrackPointer tio, int sampleRate, int totalSamples) {
@@ -84,14 +98,32 @@ bool AnalyzerBeats::initialize(TrackPointer tio, int sampleRate, int totalSample
 
     if (bShouldAnalyze) {
         m_pVamp = new VampAnalyzer();
-        bShouldAnalyze = m_pVamp->Init(library, pluginID, m_iSampleRate, totalSamples,
-                                       m_bPreferencesFastAnalysis);
+        // The input is mono, see inputFormat()
+        bShouldAnalyze = m_pVamp->Init(library, pluginID, m_iSampleRate, totalSamples / 2,
+                                       m_bPreferencesFastAnalysis, 1, &m_pluginPool);
         if (!bShouldAnalyze) {
             delete m_pVamp;
             m_pVamp = NULL;
         }
     }
 
+    // Only a fixed tempo grid from the beginning covers the whole track,
+    // and the quick analysis only pays off for tracks that are much longer
+    // than the beginning
+    const int quickSamples = kQuickAnalysisSeconds * sampleRate;
+    if (bShouldAnalyze && m_bPreferencesFixedTempo && !tio->getBeats() &&
+            totalSamples / 2 > 2 * quickSamples) {
+        m_pQuickVamp = new VampAnalyzer();
+        if (m_pQuickVamp->Init(library, pluginID, m_iSampleRate, quickSamples,
+                    false, 1, &m_pluginPool)) {
+            m_iQuickSamplesRemaining = quickSamples;
+            m_pTrack = tio;
+        } else {
+            delete m_pQuickVamp;
+            m_pQuickVamp = NULL;
+        }
+    }
+
     if (bShouldAnalyze) {
         qDebug() << "Beat calculation started with plugin" << pluginID;
     } else {
@@ -139,6 +171,10 @@ bool AnalyzerBeats::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
     if (pBeats) {
         QString version = pBeats->getVersion();
         QString subVersion = pBeats->getSubVersion();
+        if (isProvisional(subVersion)) {
+            // The full analysis has not been finished
+            return false;
+        }
 
         QHash<QString, QString> extraVersionInfo = getExtraVersionInfo(
             pluginID, m_bPreferencesFastAnalysis);
@@ -173,6 +209,19 @@ bool AnalyzerBeats::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
 }
 
 void AnalyzerBeats::process(const CSAMPLE *pIn, const int iLen) {
+    if (m_pQuickVamp != NULL) {
+        const int quickLen = math_min(iLen, m_iQuickSamplesRemaining);
+        if (m_pQuickVamp->Process(pIn, quickLen)) {
+            m_iQuickSamplesRemaining -= quickLen;
+            if (m_iQuickSamplesRemaining <= 0) {
+                publishProvisionalBeats();
+            }
+        } else {
+            delete m_pQuickVamp;
+            m_pQuickVamp = NULL;
+            m_pTrack.reset();
+        }
+    }
     if (m_pVamp == NULL)
         return;
     bool success = m_pVamp->Process(pIn, iLen);
@@ -182,13 +231,46 @@ void AnalyzerBeats::process(const CSAMPLE *pIn, const int iLen) {
     }
 }
 
+void AnalyzerBeats::publishProvisionalBeats() {
+    m_pQuickVamp->End();
+    QVector<double> beats = m_pQuickVamp->GetInitFramesVector();
+    delete m_pQuickVamp;
+    m_pQuickVamp = NULL;
+    TrackPointer pTrack = m_pTrack;
+    m_pTrack.reset();
+
+    // The user may have set a grid in the meantime
+    if (beats.isEmpty() || pTrack->getBeats() || pTrack->isBpmLocked()) {
+        return;
+    }
+
+    QHash<QString, QString> extraVersionInfo = getExtraVersionInfo(
+        m_pluginId, m_bPreferencesFastAnalysis, true);
+    BeatsPointer pBeats = BeatFactory::makePreferredBeats(
+        *pTrack, beats, extraVersionInfo,
+        m_bPreferencesFixedTempo, m_bPreferencesOffsetCorrection,
+        m_iSampleRate, m_iTotalSamples,
+        m_iMinBpm, m_iMaxBpm);
+    qDebug() << "Provisional beats from the first" << kQuickAnalysisSeconds
+             << "seconds:" << pBeats->getBpm() << "BPM";
+    pTrack->setBeats(pBeats);
+}
+
 void AnalyzerBeats::cleanup(TrackPointer tio) {
     Q_UNUSED(tio);
     delete m_pVamp;
     m_pVamp = NULL;
+    delete m_pQuickVamp;
+    m_pQuickVamp = NULL;
+    m_pTrack.reset();
 }
 
 void AnalyzerBeats::finalize(TrackPointer tio) {
+    // Superseded by the full analysis
+    delete m_pQuickVamp;
+    m_pQuickVamp = NULL;
+    m_pTrack.reset();
+
     if (m_pVamp == NULL) {
         return;
     }
@@ -231,10 +313,11 @@ void AnalyzerBeats::finalize(TrackPointer tio) {
         return;
     }
 
-    // If the user prefers to replace old beatgrids with newly generated ones or
-    // the old beatgrid has 0-bpm then we replace it.
+    // If the user prefers to replace old beatgrids with newly generated ones,
+    // the old beatgrid has 0-bpm or it is provisional then we replace it.
     bool zeroCurrentBpm = pCurrentBeats->getBpm() == 0.0;
-    if (m_bPreferencesReanalyzeOldBpm || zeroCurrentBpm) {
+    if (m_bPreferencesReanalyzeOldBpm || zeroCurrentBpm ||
+            isProvisional(pCurrentBeats->getSubVersion())) {
         if (zeroCurrentBpm) {
             qDebug() << "Replacing 0-BPM beatgrid with a" << pBeats->getBpm()
                      << "beatgrid.";
@@ -254,11 +337,19 @@ void AnalyzerBeats::finalize(TrackPointer tio) {
 
 // static
 QHash<QString, QString> AnalyzerBeats::getExtraVersionInfo(
-    QString pluginId, bool bPreferencesFastAnalysis) {
+    QString pluginId, bool bPreferencesFastAnalysis, bool bProvisional) {
     QHash<QString, QString> extraVersionInfo;
     extraVersionInfo["vamp_plugin_id"] = pluginId;
     if (bPreferencesFastAnalysis) {
         extraVersionInfo["fast_analysis"] = "1";
     }
+    if (bProvisional) {
+        extraVersionInfo["provisional"] = "1";
+    }
     return extraVersionInfo;
 }
+
+// static
+bool AnalyzerBeats::isProvisional(const QString& subVersion) {
+    return subVersion.split('|').contains(kProvisionalSubVersionFragment);
+}
@@ -22,16 +22,31 @@ class AnalyzerBeats: public Analyzer {
     bool initialize(TrackPointer tio, int sampleRate, int totalSamples) override;
     bool isDisabledOrLoadStoredSuccess(TrackPointer tio) const override;
     void process(const CSAMPLE *pIn, const int iLen) override;
+    InputFormat inputFormat() const override {
+        return InputFormat::Mono;
+    }
     void cleanup(TrackPointer tio) override;
     void finalize(TrackPointer tio) override;
 
   private:
     static QHash<QString, QString> getExtraVersionInfo(
-        QString pluginId, bool bPreferencesFastAnalysis);
+        QString pluginId, bool bPreferencesFastAnalysis,
+        bool bProvisional = false);
+    // Beats from the quick analysis of the beginning of a track that are
+    // replaced by those of the full analysis
+    static bool isProvisional(const QString& subVersion);
     QVector<double> correctedBeats(QVector<double> rawbeats);
+    void publishProvisionalBeats();
 
     UserSettingsPointer m_pConfig;
+    // Keeps the plugins of this worker's analyzers for the next track
+    mixxx::VampPluginPool m_pluginPool;
     VampAnalyzer* m_pVamp;
+    // Analyzes the beginning of a track without beats, so it gets a
+    // provisional grid long before the full analysis is done
+    VampAnalyzer* m_pQuickVamp;
+    int m_iQuickSamplesRemaining;
+    TrackPointer m_pTrack;
     QString m_pluginId;
     bool m_bPreferencesReanalyzeOldBpm;
     bool m_bPreferencesFixedTempo;
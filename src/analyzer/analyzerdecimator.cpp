@@ -0,0 +1,69 @@
+#include "analyzer/analyzerdecimator.h"
+
+#include <algorithm>
+
+#include "util/math.h"
+
+AnalyzerDecimator::AnalyzerDecimator()
+        : m_samples(kTaps - 1, CSAMPLE_ZERO),
+          m_phase(0) {
+    // Blackman windowed sinc with the cutoff at the new Nyquist frequency
+    const double cutoff = 0.5 / kFactor;
+    const double center = (kTaps - 1) / 2.0;
+    double sum = 0.0;
+    double coefficients[kTaps];
+    for (int i = 0; i < kTaps; ++i) {
+        const double x = i - center;
+        const double sinc = 2 * M_PI * cutoff * x;
+        const double window = 0.42 -
+                0.5 * cos(2 * M_PI * i / (kTaps - 1)) +
+                0.08 * cos(4 * M_PI * i / (kTaps - 1));
+        coefficients[i] = window * sin(sinc) / sinc;
+        sum += coefficients[i];
+    }
+    // Unity gain at DC
+    for (int i = 0; i < kTaps; ++i) {
+        m_coefficients[i] = static_cast<CSAMPLE>(coefficients[i] / sum);
+    }
+}
+
+SINT AnalyzerDecimator::numOutputSamples(SINT numStereoSamples) const {
+    const SINT numFrames = numStereoSamples / 2;
+    if (numFrames <= m_phase) {
+        return 0;
+    }
+    return (numFrames - m_phase - 1) / kFactor + 1;
+}
+
+void AnalyzerDecimator::process(
+        CSAMPLE* pOut, const CSAMPLE* pIn, SINT numStereoSamples) {
+    const SINT numFrames = numStereoSamples / 2;
+    m_samples.resize(kTaps - 1 + numFrames);
+    CSAMPLE* pMono = &m_samples[kTaps - 1];
+    for (SINT i = 0; i < numFrames; ++i) {
+        pMono[i] = (pIn[2 * i] + pIn[2 * i + 1]) * CSAMPLE(0.5);
+    }
+
+    // Only the frames that are kept are filtered
+    SINT frame = m_phase;
+    for (; frame < numFrames; frame += kFactor) {
+        // The oldest sample first, the filter is symmetric
+        const CSAMPLE* pFirst = pMono + frame - (kTaps - 1);
+        CSAMPLE sum = CSAMPLE_ZERO;
+        for (int j = 0; j < kTaps; ++j) {
+            sum += m_coefficients[j] * pFirst[j];
+        }
+        *pOut++ = sum;
+    }
+    m_phase = frame - numFrames;
+
+    // Keeps the history for the next block
+    std::copy(m_samples.end() - (kTaps - 1), m_samples.end(),
+            m_samples.begin());
+    m_samples.resize(kTaps - 1);
+}
+
+void AnalyzerDecimator::reset() {
+    m_samples.assign(kTaps - 1, CSAMPLE_ZERO);
+    m_phase = 0;
+}
@@ -0,0 +1,40 @@
+#ifndef ANALYZER_ANALYZERDECIMATOR_H
+#define ANALYZER_ANALYZERDECIMATOR_H
+
+#include <vector>
+
+#include "util/types.h"
+
+// Converts interleaved stereo samples to the average of both channels at
+// a quarter of the sample rate, e.g. 11025 Hz for 44.1 kHz. The signal is
+// low pass filtered before it is decimated, so frequencies above the new
+// Nyquist frequency don't alias into the band that is analyzed. The
+// filter keeps its history across blocks until reset() is called.
+class AnalyzerDecimator {
+  public:
+    static const int kFactor = 4;
+
+    AnalyzerDecimator();
+
+    // The number of samples that process() writes for the next block
+    SINT numOutputSamples(SINT numStereoSamples) const;
+
+    void process(CSAMPLE* pOut, const CSAMPLE* pIn, SINT numStereoSamples);
+
+    // Starts a new track
+    void reset();
+
+  private:
+    // A windowed sinc filter with a stop band from about 0.18 of the
+    // input sample rate
+    static const int kTaps = 48;
+
+    CSAMPLE m_coefficients[kTaps];
+    // The mono samples of the block, preceded by the last kTaps - 1
+    // samples of the previous blocks
+    std::vector<CSAMPLE> m_samples;
+    // The index of the next output frame within the next block
+    SINT m_phase;
+};
+
+#endif // ANALYZER_ANALYZERDECIMATOR_H
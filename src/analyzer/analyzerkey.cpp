@@ -3,16 +3,29 @@
 #include <QtDebug>
 #include <QVector>
 
+#include "analyzer/analyzerdecimator.h"
 #include "proto/keys.pb.h"
 #include "track/key_preferences.h"
 #include "track/keyfactory.h"
+#include "util/math.h"
 
 using mixxx::track::io::key::ChromaticKey;
 using mixxx::track::io::key::ChromaticKey_IsValid;
 
+namespace {
+
+// The length of the beginning of a track that the quick analysis covers
+const int kQuickAnalysisSeconds = 60;
+
+const QString kProvisionalSubVersionFragment = QStringLiteral("provisional=1");
+
+} // anonymous namespace
+
 AnalyzerKey::AnalyzerKey(UserSettingsPointer pConfig)
         : m_pConfig(pConfig),
           m_pVamp(NULL),
+          m_pQuickVamp(NULL),
+          m_iQuickSamplesRemaining(0),
           m_iSampleRate(0),
           m_iTotalSamples(0),
           m_bPreferencesKeyDetectionEnabled(true),
@@ -22,6 +35,7 @@ AnalyzerKey::AnalyzerKey(UserSettingsPointer pConfig)
 
 AnalyzerKey::~AnalyzerKey() {
     delete m_pVamp;
+    delete m_pQuickVamp;
 }
 
 bool AnalyzerKey::initialize(TrackPointer tio, int sampleRate, int totalSamples) {
@@ -56,17 +70,36 @@ bool AnalyzerKey::initialize(TrackPointer tio, int sampleRate, int totalSamples)
     // if we can't load a stored track reanalyze it
     bool bShouldAnalyze = !isDisabledOrLoadStoredSuccess(tio);
 
+    // The input is mono at a quarter of the sample rate, see inputFormat()
+    const int inputSampleRate = sampleRate / AnalyzerDecimator::kFactor;
     if (bShouldAnalyze) {
         m_pVamp = new VampAnalyzer();
         bShouldAnalyze = m_pVamp->Init(
-            library, m_pluginId, sampleRate, totalSamples,
-            m_bPreferencesFastAnalysisEnabled);
+            library, m_pluginId, inputSampleRate,
+            totalSamples / (2 * AnalyzerDecimator::kFactor),
+            m_bPreferencesFastAnalysisEnabled, 1, &m_pluginPool);
         if (!bShouldAnalyze) {
             delete m_pVamp;
             m_pVamp = NULL;
         }
     }
 
+    // The quick analysis only pays off for tracks that are much longer
+    // than the beginning
+    const int quickSamples = kQuickAnalysisSeconds * inputSampleRate;
+    if (bShouldAnalyze && !tio->getKeys().isValid() &&
+            totalSamples / 2 > 2 * kQuickAnalysisSeconds * sampleRate) {
+        m_pQuickVamp = new VampAnalyzer();
+        if (m_pQuickVamp->Init(library, m_pluginId, inputSampleRate, quickSamples,
+                    false, 1, &m_pluginPool)) {
+            m_iQuickSamplesRemaining = quickSamples;
+            m_pTrack = tio;
+        } else {
+            delete m_pQuickVamp;
+            m_pQuickVamp = NULL;
+        }
+    }
+
     if (bShouldAnalyze) {
         qDebug() << "Key calculation started with plugin" << m_pluginId;
     } else {
@@ -97,6 +130,10 @@ bool AnalyzerKey::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
     if (keys.isValid()) {
         QString version = keys.getVersion();
         QString subVersion = keys.getSubVersion();
+        if (isProvisional(subVersion)) {
+            // The full analysis has not been finished
+            return false;
+        }
 
         QHash<QString, QString> extraVersionInfo = getExtraVersionInfo(
             pluginID, bPreferencesFastAnalysisEnabled);
@@ -123,6 +160,19 @@ bool AnalyzerKey::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
 }
 
 void AnalyzerKey::process(const CSAMPLE *pIn, const int iLen) {
+    if (m_pQuickVamp != NULL) {
+        const int quickLen = math_min(iLen, m_iQuickSamplesRemaining);
+        if (m_pQuickVamp->Process(pIn, quickLen)) {
+            m_iQuickSamplesRemaining -= quickLen;
+            if (m_iQuickSamplesRemaining <= 0) {
+                publishProvisionalKeys();
+            }
+        } else {
+            delete m_pQuickVamp;
+            m_pQuickVamp = NULL;
+            m_pTrack.reset();
+        }
+    }
     if (m_pVamp == NULL)
         return;
     bool success = m_pVamp->Process(pIn, iLen);
@@ -132,54 +182,96 @@ void AnalyzerKey::process(const CSAMPLE *pIn, const int iLen) {
     }
 }
 
+void AnalyzerKey::publishProvisionalKeys() {
+    VampAnalyzer* pQuickVamp = m_pQuickVamp;
+    m_pQuickVamp = NULL;
+    TrackPointer pTrack = m_pTrack;
+    m_pTrack.reset();
+
+    Keys keys;
+    // The user may have set a key in the meantime
+    if (takeKeys(pQuickVamp, true, &keys) && !pTrack->getKeys().isValid()) {
+        qDebug() << "Provisional key from the first" << kQuickAnalysisSeconds
+                 << "seconds";
+        pTrack->setKeys(keys);
+    }
+}
+
 void AnalyzerKey::cleanup(TrackPointer tio) {
     Q_UNUSED(tio);
     delete m_pVamp;
     m_pVamp = NULL;
+    delete m_pQuickVamp;
+    m_pQuickVamp = NULL;
+    m_pTrack.reset();
 }
 
 void AnalyzerKey::finalize(TrackPointer tio) {
+    // Superseded by the full analysis
+    delete m_pQuickVamp;
+    m_pQuickVamp = NULL;
+    m_pTrack.reset();
+
     if (m_pVamp == NULL) {
         return;
     }
 
-    bool success = m_pVamp->End();
+    VampAnalyzer* pVamp = m_pVamp;
+    m_pVamp = NULL;
+    Keys track_keys;
+    if (takeKeys(pVamp, false, &track_keys)) {
+        tio->setKeys(track_keys);
+    }
+}
+
+bool AnalyzerKey::takeKeys(VampAnalyzer* pVamp, bool bProvisional,
+        Keys* pKeys) const {
+    bool success = pVamp->End();
     qDebug() << "Key Detection" << (success ? "complete" : "failed");
 
-    QVector<double> frames = m_pVamp->GetInitFramesVector();
-    QVector<double> keys = m_pVamp->GetLastValuesVector();
-    delete m_pVamp;
-    m_pVamp = NULL;
+    QVector<double> frames = pVamp->GetInitFramesVector();
+    QVector<double> keys = pVamp->GetLastValuesVector();
+    delete pVamp;
 
     if (frames.size() == 0 || frames.size() != keys.size()) {
         qWarning() << "AnalyzerKey: Key sequence and list of times do not match.";
-        return;
+        return false;
     }
 
     KeyChangeList key_changes;
     for (int i = 0; i < keys.size(); ++i) {
         if (ChromaticKey_IsValid(keys[i])) {
+            // The frames of the decimated input
             key_changes.push_back(qMakePair(
                 // int() intermediate cast required by MSVC.
-                static_cast<ChromaticKey>(int(keys[i])), frames[i]));
+                static_cast<ChromaticKey>(int(keys[i])),
+                frames[i] * AnalyzerDecimator::kFactor));
         }
     }
 
     QHash<QString, QString> extraVersionInfo = getExtraVersionInfo(
-        m_pluginId, m_bPreferencesFastAnalysisEnabled);
-    Keys track_keys = KeyFactory::makePreferredKeys(
+        m_pluginId, m_bPreferencesFastAnalysisEnabled, bProvisional);
+    *pKeys = KeyFactory::makePreferredKeys(
         key_changes, extraVersionInfo,
         m_iSampleRate, m_iTotalSamples);
-    tio->setKeys(track_keys);
+    return true;
 }
 
 // static
 QHash<QString, QString> AnalyzerKey::getExtraVersionInfo(
-    QString pluginId, bool bPreferencesFastAnalysis) {
+    QString pluginId, bool bPreferencesFastAnalysis, bool bProvisional) {
     QHash<QString, QString> extraVersionInfo;
     extraVersionInfo["vamp_plugin_id"] = pluginId;
     if (bPreferencesFastAnalysis) {
         extraVersionInfo["fast_analysis"] = "1";
     }
+    if (bProvisional) {
+        extraVersionInfo["provisional"] = "1";
+    }
     return extraVersionInfo;
 }
+
+// static
+bool AnalyzerKey::isProvisional(const QString& subVersion) {
+    return subVersion.split('|').contains(kProvisionalSubVersionFragment);
+}
@@ -17,15 +17,34 @@ class AnalyzerKey : public Analyzer {
     bool initialize(TrackPointer tio, int sampleRate, int totalSamples) override;
     bool isDisabledOrLoadStoredSuccess(TrackPointer tio) const override;
     void process(const CSAMPLE *pIn, const int iLen) override;
+    // The key is detected from the frequencies below 2.1 kHz
+    InputFormat inputFormat() const override {
+        return InputFormat::MonoQuarterRate;
+    }
     void finalize(TrackPointer tio) override;
     void cleanup(TrackPointer tio) override;
 
   private:
     static QHash<QString, QString> getExtraVersionInfo(
-        QString pluginId, bool bPreferencesFastAnalysis);
+        QString pluginId, bool bPreferencesFastAnalysis,
+        bool bProvisional = false);
+    // Keys from the quick analysis of the beginning of a track that are
+    // replaced by those of the full analysis
+    static bool isProvisional(const QString& subVersion);
+    // Ends the analysis of pVamp and deletes it. Returns false if no
+    // keys have been detected.
+    bool takeKeys(VampAnalyzer* pVamp, bool bProvisional, Keys* pKeys) const;
+    void publishProvisionalKeys();
 
     UserSettingsPointer m_pConfig;
+    // Keeps the plugins of this worker's analyzers for the next track
+    mixxx::VampPluginPool m_pluginPool;
     VampAnalyzer* m_pVamp;
+    // Analyzes the beginning of a track without keys, so it gets a
+    // provisional key long before the full analysis is done
+    VampAnalyzer* m_pQuickVamp;
+    int m_iQuickSamplesRemaining;
+    TrackPointer m_pTrack;
     QString m_pluginId;
     int m_iSampleRate;
     int m_iTotalSamples;
@@ -0,0 +1,164 @@
+#include "analyzer/analyzerloudness.h"
+
+#include <QtDebug>
+#include <replaygain.h>
+
+#include "track/track.h"
+#include "util/math.h"
+#include "util/sample.h"
+#include "util/timer.h"
+
+namespace {
+const double kReplayGain2ReferenceLUFS = -18;
+} // anonymous namespace
+
+AnalyzerLoudness::AnalyzerLoudness(UserSettingsPointer pConfig)
+        : m_rgSettings(pConfig),
+          m_version(0),
+          m_peakLeft(CSAMPLE_ZERO),
+          m_peakRight(CSAMPLE_ZERO),
+          m_pReplayGain(new ReplayGain()),
+          m_pLeftTempBuffer(nullptr),
+          m_pRightTempBuffer(nullptr),
+          m_iBufferSize(0),
+          m_pState(nullptr) {
+}
+
+AnalyzerLoudness::~AnalyzerLoudness() {
+    cleanup(); // ...to prevent memory leaks
+    delete [] m_pLeftTempBuffer;
+    delete [] m_pRightTempBuffer;
+    delete m_pReplayGain;
+}
+
+bool AnalyzerLoudness::initialize(TrackPointer tio,
+        int sampleRate, int totalSamples) {
+    if (isDisabledOrLoadStoredSuccess(tio) || totalSamples == 0) {
+        return false;
+    }
+    cleanup();
+    const int version = m_rgSettings.getReplayGainAnalyzerVersion();
+    if (version == 1) {
+        if (!m_pReplayGain->initialise(static_cast<long>(sampleRate), 2)) {
+            return false;
+        }
+    } else {
+        m_pState = ebur128_init(2u,
+                static_cast<unsigned long>(sampleRate),
+                EBUR128_MODE_I);
+        if (!m_pState) {
+            return false;
+        }
+    }
+    m_version = version;
+    m_peakLeft = CSAMPLE_ZERO;
+    m_peakRight = CSAMPLE_ZERO;
+    return true;
+}
+
+bool AnalyzerLoudness::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
+    // Only the version that is selected in the preferences is enabled
+    return m_rgSettings.isAnalyzerDisabled(
+            m_rgSettings.getReplayGainAnalyzerVersion(), tio);
+}
+
+void AnalyzerLoudness::cleanup() {
+    if (m_pState) {
+        ebur128_destroy(&m_pState);
+        // ebur128_destroy clears the pointer but let's not rely on that.
+        m_pState = nullptr;
+    }
+    m_version = 0;
+}
+
+void AnalyzerLoudness::cleanup(TrackPointer tio) {
+    Q_UNUSED(tio);
+    cleanup();
+}
+
+void AnalyzerLoudness::process(const CSAMPLE *pIn, const int iLen) {
+    if (m_version == 0) {
+        return;
+    }
+    ScopedTimer t("AnalyzerLoudness::process()");
+    SampleUtil::maxAbsPerChannel(&m_peakLeft, &m_peakRight, pIn, iLen);
+    if (m_version == 1) {
+        processReplayGain1(pIn, iLen);
+    } else {
+        processReplayGain2(pIn, iLen);
+    }
+}
+
+void AnalyzerLoudness::processReplayGain1(const CSAMPLE* pIn, int iLen) {
+    int halfLength = static_cast<int>(iLen / 2);
+    if (halfLength > m_iBufferSize) {
+        delete [] m_pLeftTempBuffer;
+        delete [] m_pRightTempBuffer;
+        m_pLeftTempBuffer = new CSAMPLE[halfLength];
+        m_pRightTempBuffer = new CSAMPLE[halfLength];
+        m_iBufferSize = halfLength;
+    }
+    SampleUtil::deinterleaveBuffer(m_pLeftTempBuffer, m_pRightTempBuffer, pIn, halfLength);
+    SampleUtil::applyGain(m_pLeftTempBuffer, 32767, halfLength);
+    SampleUtil::applyGain(m_pRightTempBuffer, 32767, halfLength);
+    if (!m_pReplayGain->process(m_pLeftTempBuffer, m_pRightTempBuffer, halfLength)) {
+        cleanup();
+    }
+}
+
+void AnalyzerLoudness::processReplayGain2(const CSAMPLE* pIn, int iLen) {
+    size_t frames = iLen / 2;
+    int e = ebur128_add_frames_float(m_pState, pIn, frames);
+    VERIFY_OR_DEBUG_ASSERT(e == EBUR128_SUCCESS) {
+        qWarning() << "AnalyzerLoudness::process() failed with" << e;
+        return;
+    }
+}
+
+bool AnalyzerLoudness::endReplayGain1(double* pGain) {
+    float fReplayGainOutput = m_pReplayGain->end();
+    if (fReplayGainOutput == GAIN_NOT_ENOUGH_SAMPLES) {
+        qDebug() << "ReplayGain 1.0 analysis failed";
+        return false;
+    }
+    *pGain = fReplayGainOutput;
+    return true;
+}
+
+bool AnalyzerLoudness::endReplayGain2(double* pGain) {
+    double averageLufs;
+    int e = ebur128_loudness_global(m_pState, &averageLufs);
+    VERIFY_OR_DEBUG_ASSERT(e == EBUR128_SUCCESS) {
+        qWarning() << "AnalyzerLoudness::finalize() failed with" << e;
+        return false;
+    }
+    if (averageLufs == -HUGE_VAL || averageLufs == 0.0) {
+        qWarning() << "AnalyzerLoudness::finalize() averageLufs invalid:"
+                 << averageLufs;
+        return false;
+    }
+    *pGain = kReplayGain2ReferenceLUFS - averageLufs;
+    return true;
+}
+
+void AnalyzerLoudness::finalize(TrackPointer tio) {
+    const int version = m_version;
+    if (version == 0) {
+        return;
+    }
+    double gain;
+    const bool success = version == 1
+            ? endReplayGain1(&gain) : endReplayGain2(&gain);
+    cleanup();
+    if (!success) {
+        return;
+    }
+
+    mixxx::ReplayGain replayGain(tio->getReplayGain());
+    replayGain.setRatio(db2ratio(gain));
+    replayGain.setPeak(math_max(m_peakLeft, m_peakRight));
+    tio->setReplayGain(replayGain);
+    qDebug() << "ReplayGain" << version << "result is" << gain
+             << "dB with a peak of" << replayGain.getPeak()
+             << "for" << tio->getLocation();
+}
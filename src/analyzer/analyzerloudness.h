@@ -0,0 +1,51 @@
+#ifndef ANALYZER_ANALYZERLOUDNESS_H
+#define ANALYZER_ANALYZERLOUDNESS_H
+
+#include <ebur128.h>
+
+#include "analyzer/analyzer.h"
+#include "preferences/replaygainsettings.h"
+
+class ReplayGain;
+
+// Measures the loudness of a track for the ReplayGain version that is
+// selected in the preferences, with the equal-loudness filter of
+// lib/replaygain for ReplayGain 1.0 or the K-weighting of libebur128 for
+// ReplayGain 2.0. The sample peak of the track is measured in the same
+// pass, and both are stored in the ReplayGain of the track.
+class AnalyzerLoudness : public Analyzer {
+  public:
+    AnalyzerLoudness(UserSettingsPointer pConfig);
+    virtual ~AnalyzerLoudness();
+
+    bool initialize(TrackPointer tio, int sampleRate, int totalSamples) override;
+    bool isDisabledOrLoadStoredSuccess(TrackPointer tio) const override;
+    void process(const CSAMPLE* pIn, const int iLen) override;
+    void cleanup(TrackPointer tio) override;
+    void finalize(TrackPointer tio) override;
+
+  private:
+    void cleanup();
+    void processReplayGain1(const CSAMPLE* pIn, int iLen);
+    void processReplayGain2(const CSAMPLE* pIn, int iLen);
+    // Returns the gain in dB or false if the track is too short
+    bool endReplayGain1(double* pGain);
+    bool endReplayGain2(double* pGain);
+
+    ReplayGainSettings m_rgSettings;
+    // The ReplayGain version of the analysis, 0 if there is none
+    int m_version;
+    CSAMPLE m_peakLeft;
+    CSAMPLE m_peakRight;
+
+    // ReplayGain 1.0
+    ReplayGain* m_pReplayGain;
+    CSAMPLE* m_pLeftTempBuffer;
+    CSAMPLE* m_pRightTempBuffer;
+    int m_iBufferSize;
+
+    // ReplayGain 2.0
+    ebur128_state* m_pState;
+};
+
+#endif /* ANALYZER_ANALYZERLOUDNESS_H */
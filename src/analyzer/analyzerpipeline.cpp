@@ -0,0 +1,181 @@
+#include "analyzer/analyzerpipeline.h"
+
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "util/sample.h"
+#include "util/threadroles.h"
+
+namespace {
+
+const int kNumInputFormats = 4;
+
+} // anonymous namespace
+
+// The thread that passes the queued blocks to one analyzer
+class AnalyzerPipeline::Stage : public QThread {
+  public:
+    explicit Stage(Analyzer* pAnalyzer)
+            : m_pAnalyzer(pAnalyzer),
+              m_busy(false),
+              m_stop(false) {
+    }
+    ~Stage() override {
+        {
+            QMutexLocker locked(&m_mutex);
+            m_stop = true;
+            m_blocksQueued.wakeAll();
+        }
+        wait();
+    }
+
+    Analyzer::InputFormat inputFormat() const {
+        return m_pAnalyzer->inputFormat();
+    }
+
+    void push(AnalyzerBlockPointer pBlock) {
+        QMutexLocker locked(&m_mutex);
+        while (m_blocks.size() >= kMaxQueuedBlocks) {
+            m_blocksTaken.wait(&m_mutex);
+        }
+        m_blocks.enqueue(std::move(pBlock));
+        m_blocksQueued.wakeOne();
+    }
+
+    void drain() {
+        QMutexLocker locked(&m_mutex);
+        while (m_busy || !m_blocks.isEmpty()) {
+            m_blocksTaken.wait(&m_mutex);
+        }
+    }
+
+    void cancel() {
+        QMutexLocker locked(&m_mutex);
+        m_blocks.clear();
+        while (m_busy) {
+            m_blocksTaken.wait(&m_mutex);
+        }
+    }
+
+  protected:
+    void run() override {
+        setObjectName("AnalyzerPipeline stage");
+        mixxx::ThreadRoles::applyToCurrentThread(mixxx::ThreadRole::Analyzer);
+
+        QMutexLocker locked(&m_mutex);
+        while (!m_stop) {
+            if (m_blocks.isEmpty()) {
+                m_blocksQueued.wait(&m_mutex);
+                continue;
+            }
+            AnalyzerBlockPointer pBlock = m_blocks.dequeue();
+            m_busy = true;
+            locked.unlock();
+            m_pAnalyzer->process(pBlock->data(), pBlock->size());
+            // The block is freed here if it was the last stage to
+            // process it
+            pBlock.reset();
+            locked.relock();
+            m_busy = false;
+            m_blocksTaken.wakeAll();
+        }
+    }
+
+  private:
+    Analyzer* const m_pAnalyzer;
+
+    QMutex m_mutex;
+    // Signaled when a block is queued or the stage is stopped
+    QWaitCondition m_blocksQueued;
+    // Signaled after a block is processed
+    QWaitCondition m_blocksTaken;
+    QQueue<AnalyzerBlockPointer> m_blocks;
+    bool m_busy;
+    bool m_stop;
+};
+
+AnalyzerPipeline::AnalyzerPipeline(const std::vector<Analyzer*>& analyzers) {
+    for (Analyzer* pAnalyzer : analyzers) {
+        m_stages.push_back(std::make_unique<Stage>(pAnalyzer));
+    }
+    for (const auto& pStage : m_stages) {
+        pStage->start(QThread::LowPriority);
+    }
+}
+
+AnalyzerPipeline::~AnalyzerPipeline() {
+    // Stops and joins the stages
+    m_stages.clear();
+}
+
+void AnalyzerPipeline::process(const CSAMPLE* pIn, SINT numSamples) {
+    // Each format is converted only once and only if it is needed
+    AnalyzerBlockPointer blocks[kNumInputFormats];
+    for (const auto& pStage : m_stages) {
+        const Analyzer::InputFormat format = pStage->inputFormat();
+        AnalyzerBlockPointer& pBlock = blocks[static_cast<int>(format)];
+        if (!pBlock) {
+            pBlock = convert(format, pIn, numSamples);
+        }
+        pStage->push(pBlock);
+    }
+}
+
+void AnalyzerPipeline::drain() {
+    for (const auto& pStage : m_stages) {
+        pStage->drain();
+    }
+    m_decimator.reset();
+}
+
+void AnalyzerPipeline::cancel() {
+    for (const auto& pStage : m_stages) {
+        pStage->cancel();
+    }
+    m_decimator.reset();
+}
+
+AnalyzerBlockPointer AnalyzerPipeline::convert(
+        Analyzer::InputFormat format,
+        const CSAMPLE* pIn,
+        SINT numSamples) {
+    SINT numOutputSamples;
+    switch (format) {
+    case Analyzer::InputFormat::Mono:
+        numOutputSamples = numSamples / 2;
+        break;
+    case Analyzer::InputFormat::MonoHalfRate:
+        numOutputSamples = numSamples / 4;
+        break;
+    case Analyzer::InputFormat::MonoQuarterRate:
+        numOutputSamples = m_decimator.numOutputSamples(numSamples);
+        break;
+    default:
+        numOutputSamples = numSamples;
+        break;
+    }
+    auto pBlock = std::make_shared<AnalyzerBlock>(numOutputSamples);
+    CSAMPLE* pOut = pBlock->data();
+    switch (format) {
+    case Analyzer::InputFormat::Mono:
+        for (SINT i = 0; i < pBlock->size(); ++i) {
+            pOut[i] = (pIn[2 * i] + pIn[2 * i + 1]) * CSAMPLE(0.5);
+        }
+        break;
+    case Analyzer::InputFormat::MonoHalfRate:
+        for (SINT i = 0; i < pBlock->size(); ++i) {
+            pOut[i] = (pIn[4 * i] + pIn[4 * i + 1] +
+                    pIn[4 * i + 2] + pIn[4 * i + 3]) * CSAMPLE(0.25);
+        }
+        break;
+    case Analyzer::InputFormat::MonoQuarterRate:
+        m_decimator.process(pOut, pIn, numSamples);
+        break;
+    default:
+        SampleUtil::copy(pOut, pIn, numSamples);
+        break;
+    }
+    return pBlock;
+}
@@ -0,0 +1,78 @@
+#ifndef ANALYZER_ANALYZERPIPELINE_H
+#define ANALYZER_ANALYZERPIPELINE_H
+
+#include <vector>
+
+#include "analyzer/analyzer.h"
+#include "analyzer/analyzerdecimator.h"
+#include "util/memory.h"
+#include "util/samplebuffer.h"
+
+// A block of samples in the input format of one or more analyzers. The
+// block is shared by the stages of these analyzers and freed after the
+// last of them has processed it.
+class AnalyzerBlock {
+  public:
+    explicit AnalyzerBlock(SINT numSamples)
+            : m_samples(numSamples) {
+    }
+
+    CSAMPLE* data() {
+        return m_samples.data();
+    }
+    const CSAMPLE* data() const {
+        return m_samples.data();
+    }
+    SINT size() const {
+        return m_samples.size();
+    }
+
+  private:
+    mixxx::SampleBuffer m_samples;
+};
+
+typedef std::shared_ptr<const AnalyzerBlock> AnalyzerBlockPointer;
+
+// Passes the decoded blocks of a track to a set of analyzers that process
+// them concurrently, each in its own stage thread with a bounded queue.
+// Every block is converted once for each input format that is requested
+// by the analyzers. The decoding thread waits while the queue of the
+// slowest analyzer is full. The blocks of a track must be passed to
+// process() in order, followed by drain() or cancel() before the next
+// track starts.
+//
+// Only process() of the analyzers is called by the stage threads. The
+// owner calls all other functions of the analyzers, but only after
+// drain() or cancel() has returned.
+class AnalyzerPipeline {
+  public:
+    // The number of blocks that an analyzer may fall behind
+    static const int kMaxQueuedBlocks = 16;
+
+    // The analyzers must outlive the pipeline
+    explicit AnalyzerPipeline(const std::vector<Analyzer*>& analyzers);
+    virtual ~AnalyzerPipeline();
+
+    // Queues a block of interleaved stereo samples for all analyzers
+    void process(const CSAMPLE* pIn, SINT numSamples);
+
+    // Waits until all queued blocks have been processed
+    void drain();
+
+    // Drops the queued blocks and waits for those that are processed
+    // right now
+    void cancel();
+
+  private:
+    class Stage;
+
+    AnalyzerBlockPointer convert(Analyzer::InputFormat format,
+            const CSAMPLE* pIn, SINT numSamples);
+
+    std::vector<std::unique_ptr<Stage>> m_stages;
+
+    // Shared by all analyzers that need the decimated signal
+    AnalyzerDecimator m_decimator;
+};
+
+#endif // ANALYZER_ANALYZERPIPELINE_H
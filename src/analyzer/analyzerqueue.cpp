@@ -1,11 +1,15 @@
 #include "analyzer/analyzerqueue.h"
 
+#include <QThread>
+#include <QTime>
+
 #ifdef __VAMP__
 #include "analyzer/analyzerbeats.h"
 #include "analyzer/analyzerkey.h"
 #endif
-#include "analyzer/analyzergain.h"
-#include "analyzer/analyzerebur128.h"
+#include "analyzer/analysiscache.h"
+#include "analyzer/analyzerloudness.h"
+#include "analyzer/analyzerpipeline.h"
 #include "analyzer/analyzerwaveform.h"
 #include "library/dao/analysisdao.h"
 #include "engine/engine.h"
@@ -17,9 +21,11 @@
 #include "util/db/dbconnectionpooler.h"
 #include "util/db/dbconnectionpooled.h"
 #include "util/event.h"
+#include "util/threadroles.h"
 #include "util/timer.h"
 #include "util/trace.h"
 #include "util/logger.h"
+#include "util/math.h"
 
 // Measured in 0.1%,
 // 0 for no progress during finalize
@@ -42,44 +48,134 @@ const SINT kAnalysisSamplesPerBlock =
 
 QAtomicInt s_instanceCounter(0);
 
+// The default for batch analysis leaves one core to the engine and the GUI
+const int kMaxDefaultWorkers = 8;
+
+const QString kConfigGroup = QStringLiteral("[Library]");
+
 } // anonymous namespace
 
+// A thread with its own analyzers that takes tracks from the queue
+// and analyzes them one at a time
+class AnalyzerQueue::Worker : public QThread {
+  public:
+    Worker(AnalyzerQueue* pQueue,
+            int index,
+            const UserSettingsPointer& pConfig,
+            Mode mode)
+            : m_pQueue(pQueue),
+              m_index(index),
+              m_sampleBuffer(kAnalysisSamplesPerBlock) {
+        if (mode != Mode::WithoutWaveform) {
+            m_pAnalysisDao = std::make_unique<AnalysisDao>(pConfig);
+            m_pAnalyzers.push_back(std::make_unique<AnalyzerWaveform>(m_pAnalysisDao.get()));
+        }
+        m_pAnalyzers.push_back(std::make_unique<AnalyzerLoudness>(pConfig));
+#ifdef __VAMP__
+        m_pAnalyzers.push_back(std::make_unique<AnalyzerBeats>(pConfig));
+        m_pAnalyzers.push_back(std::make_unique<AnalyzerKey>(pConfig));
+#endif
+        std::vector<Analyzer*> analyzers;
+        for (const auto& pAnalyzer : m_pAnalyzers) {
+            analyzers.push_back(pAnalyzer.get());
+        }
+        m_pPipeline = std::make_unique<AnalyzerPipeline>(analyzers);
+    }
+
+    int index() const {
+        return m_index;
+    }
+
+    // Loads the stored analyses of a track, returns false if the
+    // track needs to be analyzed
+    bool isDisabledOrLoadStoredSuccess(TrackPointer pTrack) const {
+        bool processTrack = false;
+        for (auto const& pAnalyzer: m_pAnalyzers) {
+            if (!pAnalyzer->isDisabledOrLoadStoredSuccess(pTrack)) {
+                processTrack = true;
+            }
+        }
+        return !processTrack;
+    }
+
+  protected:
+    void run() override;
+
+  private:
+    void execThread();
+    void analyzeTrack(TrackPointer pTrack);
+    bool doAnalysis(TrackPointer tio, mixxx::AudioSourcePointer pAudioSource,
+            bool loadedTrack);
+    void throttle(mixxx::Duration blockDuration, bool loadedTrack);
+
+    AnalyzerQueue* const m_pQueue;
+    const int m_index;
+
+    std::unique_ptr<AnalysisDao> m_pAnalysisDao;
+
+    typedef std::unique_ptr<Analyzer> AnalyzerPtr;
+    std::vector<AnalyzerPtr> m_pAnalyzers;
+
+    // Runs the analyzers concurrently on the decoded blocks
+    std::unique_ptr<AnalyzerPipeline> m_pPipeline;
+
+    mixxx::SampleBuffer m_sampleBuffer;
+};
+
 AnalyzerQueue::AnalyzerQueue(
         mixxx::DbConnectionPoolPtr pDbConnectionPool,
         const UserSettingsPointer& pConfig,
-        Mode mode)
+        Mode mode,
+        int numWorkers)
         : m_pDbConnectionPool(std::move(pDbConnectionPool)),
           m_exit(false),
           m_aiCheckPriorities(false),
-          m_sampleBuffer(kAnalysisSamplesPerBlock),
-          m_queue_size(0) {
-
-    if (mode != Mode::WithoutWaveform) {
-        m_pAnalysisDao = std::make_unique<AnalysisDao>(pConfig);
-        m_pAnalyzers.push_back(std::make_unique<AnalyzerWaveform>(m_pAnalysisDao.get()));
+          m_throttle(pConfig),
+          m_runningWorkers(0),
+          m_idleWorkers(0),
+          m_lastProgress(0),
+          m_progressUpdatePending(0) {
+    numWorkers = math_clamp(numWorkers, 1, kMaxWorkers);
+    m_workerProgress.fill(-1, numWorkers);
+    for (int i = 0; i < numWorkers; ++i) {
+        m_workers.push_back(std::make_unique<Worker>(this, i, pConfig, mode));
     }
-    m_pAnalyzers.push_back(std::make_unique<AnalyzerGain>(pConfig));
-    m_pAnalyzers.push_back(std::make_unique<AnalyzerEbur128>(pConfig));
-#ifdef __VAMP__
-    m_pAnalyzers.push_back(std::make_unique<AnalyzerBeats>(pConfig));
-    m_pAnalyzers.push_back(std::make_unique<AnalyzerKey>(pConfig));
-#endif
 
     connect(this, SIGNAL(updateProgress()),
             this, SLOT(slotUpdateProgress()));
 
-    start(QThread::LowPriority);
+    m_runningWorkers = numWorkers;
+    for (const auto& pWorker : m_workers) {
+        pWorker->start(QThread::LowPriority);
+    }
 }
 
 AnalyzerQueue::~AnalyzerQueue() {
     stop();
-    m_progressInfo.sema.release();
-    wait(); //Wait until thread has actually stopped before proceeding.
+    for (const auto& pWorker : m_workers) {
+        pWorker->wait(); //Wait until thread has actually stopped before proceeding.
+    }
+}
+
+// static
+int AnalyzerQueue::numWorkersForBatchAnalysis(
+        const UserSettingsPointer& pConfig) {
+    const int defaultValue =
+            math_clamp(QThread::idealThreadCount() - 1, 1, kMaxDefaultWorkers);
+    if (!pConfig) {
+        return defaultValue;
+    }
+    return math_clamp(pConfig->getValue(
+            ConfigKey(kConfigGroup, "AnalysisWorkers"), defaultValue),
+            1, kMaxWorkers);
 }
 
-// This is called from the AnalyzerQueue thread
-bool AnalyzerQueue::isLoadedTrackWaiting(TrackPointer analysingTrack) {
-    const PlayerInfo& info = PlayerInfo::instance();
+// This is called from the worker threads
+bool AnalyzerQueue::isLoadedTrackWaiting(
+        const Worker* pWorker,
+        TrackPointer analysingTrack) {
+    const PlayerInfo::LoadedTracksPointer pLoadedTracks =
+            PlayerInfo::instance().getLoadedTracksSnapshot();
     TrackPointer pTrack;
     bool trackWaiting = false;
     QList<TrackPointer> progress100List;
@@ -94,7 +190,7 @@ bool AnalyzerQueue::isLoadedTrackWaiting(TrackPointer analysingTrack) {
             continue;
         }
         if (!trackWaiting) {
-            trackWaiting = info.isTrackLoaded(pTrack);
+            trackWaiting = pLoadedTracks->contains(pTrack);
         }
         // try to load waveforms for all new tracks first
         // and remove them from queue if already analysed
@@ -102,13 +198,7 @@ bool AnalyzerQueue::isLoadedTrackWaiting(TrackPointer analysingTrack) {
         int progress = pTrack->getAnalyzerProgress();
         if (progress < 0) {
             // Load stored analysis
-            bool processTrack = false;
-            for (auto const& pAnalyzer: m_pAnalyzers) {
-                if (!pAnalyzer->isDisabledOrLoadStoredSuccess(pTrack)) {
-                    processTrack = true;
-                }
-            }
-            if (!processTrack) {
+            if (pWorker->isDisabledOrLoadStoredSuccess(pTrack)) {
                 progress100List.append(pTrack);
                 it.remove(); // since pTrack is a reference it is invalid now.
             } else {
@@ -118,67 +208,93 @@ bool AnalyzerQueue::isLoadedTrackWaiting(TrackPointer analysingTrack) {
             it.remove();
         }
     }
+    // An idle worker takes the loaded track right away
+    const bool idleWorkers = m_idleWorkers > 0;
 
     locked.unlock();
 
     // update progress after unlock to avoid a deadlock
     foreach (TrackPointer pTrack, progress100List) {
-        emitUpdateProgress(pTrack, 1000);
+        emitUpdateProgress(-1, pTrack, 1000);
     }
     foreach (TrackPointer pTrack, progress0List) {
-        emitUpdateProgress(pTrack, 0);
+        emitUpdateProgress(-1, pTrack, 0);
     }
 
-    if (info.isTrackLoaded(analysingTrack)) {
+    if (idleWorkers || pLoadedTracks->contains(analysingTrack)) {
         return false;
     }
     return trackWaiting;
 }
 
-// This is called from the AnalyzerQueue thread
-// The returned track might be NULL, up to the caller to check.
+// This is called from the worker threads
+// Returns a null track only when the queue is stopped.
 TrackPointer AnalyzerQueue::dequeueNextBlocking() {
     QMutexLocker locked(&m_qm);
-    if (m_queuedTracks.isEmpty()) {
+    while (!m_exit) {
+        const PlayerInfo::LoadedTracksPointer pLoadedTracks =
+                PlayerInfo::instance().getLoadedTracksSnapshot();
+        TrackPointer pLoadTrack;
+        QMutableListIterator<TrackPointer> it(m_queuedTracks);
+        while (it.hasNext()) {
+            TrackPointer& pTrack = it.next();
+            if (!pTrack) {
+                it.remove();
+                continue;
+            }
+            if (m_activeTracks.contains(pTrack)) {
+                // Queued again while another worker analyzes it
+                continue;
+            }
+            // Prioritize tracks that are loaded.
+            if (pLoadedTracks->contains(pTrack)) {
+                kLogger.debug() << "Prioritizing" << pTrack->getTitle() << pTrack->getLocation();
+                pLoadTrack = pTrack;
+                break;
+            }
+            if (!pLoadTrack) {
+                // no prioritized track found so far, use the first one
+                pLoadTrack = pTrack;
+            }
+        }
+        if (pLoadTrack) {
+            m_queuedTracks.removeOne(pLoadTrack);
+            m_activeTracks.append(pLoadTrack);
+            return pLoadTrack;
+        }
+
+        ++m_idleWorkers;
         Event::end("AnalyzerQueue process");
         m_qwait.wait(&m_qm);
         Event::start("AnalyzerQueue process");
-
-        if (m_exit) {
-            return TrackPointer();
-        }
+        --m_idleWorkers;
     }
+    return TrackPointer();
+}
 
-    const PlayerInfo& info = PlayerInfo::instance();
-    TrackPointer pLoadTrack;
-    QMutableListIterator<TrackPointer> it(m_queuedTracks);
-    while (it.hasNext()) {
-        TrackPointer& pTrack = it.next();
-        DEBUG_ASSERT(pTrack);
-        // Prioritize tracks that are loaded.
-        if (info.isTrackLoaded(pTrack)) {
-            kLogger.debug() << "Prioritizing" << pTrack->getTitle() << pTrack->getLocation();
-            pLoadTrack = pTrack;
-            it.remove();
-            break;
+// This is called from the worker threads
+void AnalyzerQueue::finishTrack(int workerIndex, TrackPointer pTrack) {
+    {
+        QMutexLocker locked(&m_qm);
+        m_activeTracks.removeOne(pTrack);
+        if (m_queuedTracks.contains(pTrack)) {
+            // Queued again while it was analyzed
+            m_qwait.wakeAll();
         }
     }
-
-    if (!pLoadTrack && !m_queuedTracks.isEmpty()) {
-        // no prioritized track found, use head track
-        pLoadTrack = m_queuedTracks.dequeue();
-    }
-
-    return pLoadTrack;
+    QMutexLocker locked(&m_progressMutex);
+    m_workerProgress[workerIndex] = -1;
 }
 
-// This is called from the AnalyzerQueue thread
-bool AnalyzerQueue::doAnalysis(
+// This is called from the worker threads
+bool AnalyzerQueue::Worker::doAnalysis(
         TrackPointer pTrack,
-        mixxx::AudioSourcePointer pAudioSource) {
+        mixxx::AudioSourcePointer pAudioSource,
+        bool loadedTrack) {
 
     QTime progressUpdateInhibitTimer;
     progressUpdateInhibitTimer.start(); // Inhibit Updates for 60 milliseconds
+    int lastProgressPromille = 0;
 
     mixxx::AudioSourceStereoProxy audioSourceProxy(
             pAudioSource,
@@ -188,8 +304,15 @@ bool AnalyzerQueue::doAnalysis(
     mixxx::IndexRange remainingFrames = pAudioSource->frameIndexRange();
     bool dieflag = false;
     bool cancelled = false;
+    mixxx::Duration blockDuration;
+    PerformanceTimer blockTimer;
     while (!dieflag && !remainingFrames.empty()) {
+        // Yields to the engine depending on the previous block, outside
+        // of the timed section
+        throttle(blockDuration, loadedTrack);
+
         ScopedTimer t("AnalyzerQueue::doAnalysis block");
+        blockTimer.start();
 
         const auto inputFrameIndexRange =
                 remainingFrames.splitAndShrinkFront(
@@ -204,11 +327,9 @@ bool AnalyzerQueue::doAnalysis(
         // the full block size.
         if (readableSampleFrames.frameLength() == kAnalysisFramesPerBlock) {
             // Complete analysis block of audio samples has been read.
-            for (auto const& pAnalyzer: m_pAnalyzers) {
-                pAnalyzer->process(
-                        readableSampleFrames.readableData(),
-                        readableSampleFrames.readableLength());
-            }
+            m_pPipeline->process(
+                    readableSampleFrames.readableData(),
+                    readableSampleFrames.readableLength());
         } else {
             // Partial analysis block of audio samples has been read.
             // This should only happen at the end of an audio stream,
@@ -224,6 +345,7 @@ bool AnalyzerQueue::doAnalysis(
                 cancelled = false; // completed, no retry
             }
         }
+        blockDuration = blockTimer.elapsed();
 
         // emit progress updates
         // During the doAnalysis function it goes only to 100% - FINALIZE_PERCENT
@@ -234,10 +356,11 @@ bool AnalyzerQueue::doAnalysis(
                 double(pAudioSource->frameLength());
         int progressPromille = frameProgress * (1000 - FINALIZE_PROMILLE);
 
-        if (m_progressInfo.track_progress != progressPromille) {
+        if (lastProgressPromille != progressPromille) {
             if (progressUpdateInhibitTimer.elapsed() > 60) {
                 // Inhibit Updates for 60 milliseconds
-                emitUpdateProgress(pTrack, progressPromille);
+                m_pQueue->emitUpdateProgress(m_index, pTrack, progressPromille);
+                lastProgressPromille = progressPromille;
                 progressUpdateInhibitTimer.start();
             }
         }
@@ -249,16 +372,17 @@ bool AnalyzerQueue::doAnalysis(
         //QThread::yieldCurrentThread();
         //QThread::usleep(10);
 
-        // has something new entered the queue?
-        if (m_aiCheckPriorities.fetchAndStoreAcquire(false)) {
-            if (isLoadedTrackWaiting(pTrack)) {
+        // has something new entered the queue? Only one of the workers
+        // takes the request.
+        if (m_pQueue->m_aiCheckPriorities.fetchAndStoreAcquire(false)) {
+            if (m_pQueue->isLoadedTrackWaiting(this, pTrack)) {
                 kLogger.debug() << "Interrupting analysis to give preference to a loaded track.";
                 dieflag = true;
                 cancelled = true;
             }
         }
 
-        if (m_exit) {
+        if (m_pQueue->m_exit) {
             dieflag = true;
             cancelled = true;
         }
@@ -269,32 +393,60 @@ bool AnalyzerQueue::doAnalysis(
         }
     }
 
+    // The analyzers must not be finalized or cleaned up while they are
+    // still processing
+    if (cancelled) {
+        m_pPipeline->cancel();
+    } else {
+        m_pPipeline->drain();
+    }
+
     return !cancelled; //don't return !dieflag or we might reanalyze over and over
 }
 
+// This is called from the worker threads
+void AnalyzerQueue::Worker::throttle(
+        mixxx::Duration blockDuration,
+        bool loadedTrack) {
+    mixxx::Duration delay =
+            m_pQueue->m_throttle.delayAfterBlock(blockDuration, loadedTrack);
+    while (delay > mixxx::Duration() && !m_pQueue->m_exit) {
+        Stat::track("AnalyzerQueue throttled ms", Stat::COUNTER,
+                Stat::experimentFlags(Stat::COUNT | Stat::SUM),
+                delay.toDoubleMillis());
+        QThread::usleep(delay.toIntegerMicros());
+        if (m_pQueue->m_aiCheckPriorities.load()) {
+            // A loaded track may be waiting
+            break;
+        }
+        delay = m_pQueue->m_throttle.delayAfterBlock(
+                mixxx::Duration(), loadedTrack);
+    }
+}
+
 void AnalyzerQueue::stop() {
     m_exit = true;
     QMutexLocker locked(&m_qm);
     m_qwait.wakeAll();
 }
 
-void AnalyzerQueue::run() {
+void AnalyzerQueue::Worker::run() {
     // If there are no analyzers, don't waste time running.
-    if (m_pAnalyzers.empty()) {
-        return;
-    }
+    if (!m_pAnalyzers.empty()) {
+        const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
+        QThread::currentThread()->setObjectName(QString("AnalyzerQueue %1").arg(instanceId));
+        mixxx::ThreadRoles::applyToCurrentThread(mixxx::ThreadRole::Analyzer);
 
-    const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
-    QThread::currentThread()->setObjectName(QString("AnalyzerQueue %1").arg(instanceId));
+        kLogger.debug() << "Entering thread";
 
-    kLogger.debug() << "Entering thread";
+        execThread();
 
-    execThread();
-
-    kLogger.debug() << "Exiting thread";
+        kLogger.debug() << "Exiting thread";
+    }
+    m_pQueue->workerExited();
 }
 
-void AnalyzerQueue::execThread() {
+void AnalyzerQueue::Worker::execThread() {
     // The thread-local database connection for waveform analysis must not
     // be closed before returning from this function. Therefore the
     // DbConnectionPooler is defined at this outer function scope,
@@ -304,150 +456,212 @@ void AnalyzerQueue::execThread() {
     // m_pAnalysisDao remains null if no analyzer needs database access.
     // Currently only waveform analyses makes use of it.
     if (m_pAnalysisDao) {
-        dbConnectionPooler = mixxx::DbConnectionPooler(m_pDbConnectionPool); // move assignment
+        dbConnectionPooler = mixxx::DbConnectionPooler(m_pQueue->m_pDbConnectionPool); // move assignment
         if (!dbConnectionPooler.isPooling()) {
             kLogger.warning()
                     << "Failed to obtain database connection for analyzer queue thread";
             return;
         }
         // Obtain and use the newly created database connection within this thread
-        QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
+        QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pQueue->m_pDbConnectionPool);
         DEBUG_ASSERT(dbConnection.isOpen());
         m_pAnalysisDao->initialize(dbConnection);
     }
 
-    m_progressInfo.current_track.reset();
-    m_progressInfo.track_progress = 0;
-    m_progressInfo.queue_size = 0;
-    m_progressInfo.sema.release(); // Initialize with one
-
-    while (!m_exit) {
-        TrackPointer nextTrack = dequeueNextBlocking();
+    while (!m_pQueue->m_exit) {
+        TrackPointer nextTrack = m_pQueue->dequeueNextBlocking();
 
         // It's important to check for m_exit here in case we decided to exit
         // while blocking for a new track.
-        if (m_exit) {
+        if (m_pQueue->m_exit || !nextTrack) {
             break;
         }
 
-        // If the track is NULL, try to get the next one.
-        // Could happen if the track was queued but then deleted.
-        // Or if dequeueNextBlocking is unblocked by exit == true
-        if (!nextTrack) {
-            emptyCheck();
-            continue;
-        }
+        analyzeTrack(nextTrack);
+        m_pQueue->finishTrack(m_index, nextTrack);
+        m_pQueue->emptyCheck();
+    }
 
-        kLogger.debug() << "Analyzing" << nextTrack->getTitle() << nextTrack->getLocation();
+    if (m_pAnalysisDao) {
+        // Invalidate reference to the thread-local database connection
+        // that will be closed soon. Not necessary, just in case ;)
+        m_pAnalysisDao->initialize(QSqlDatabase());
+    }
+}
 
-        Trace trace("AnalyzerQueue analyzing track");
+void AnalyzerQueue::Worker::analyzeTrack(TrackPointer nextTrack) {
+    kLogger.debug() << "Analyzing" << nextTrack->getTitle() << nextTrack->getLocation();
 
-        // Get the audio
-        mixxx::AudioSource::OpenParams openParams;
-        openParams.setChannelCount(kAnalysisChannels);
-        auto pAudioSource = SoundSourceProxy(nextTrack).openAudioSource(openParams);
-        if (!pAudioSource) {
-            kLogger.warning()
-                    << "Failed to open file for analyzing:"
-                    << nextTrack->getLocation();
-            emptyCheck();
-            continue;
+    Trace trace("AnalyzerQueue analyzing track");
+
+    // Get the audio
+    mixxx::AudioSource::OpenParams openParams;
+    openParams.setChannelCount(kAnalysisChannels);
+    openParams.setSequentialAccess(true);
+    auto pAudioSource = SoundSourceProxy(nextTrack).openAudioSource(openParams);
+    if (!pAudioSource) {
+        kLogger.warning()
+                << "Failed to open file for analyzing:"
+                << nextTrack->getLocation();
+        return;
+    }
+
+    // The results of the same audio in another file are loaded first, the
+    // analyzers only process the track if some results are still missing
+    QString fingerprint;
+    bool cached = false;
+    if (AnalysisCache::isEnabled()) {
+        fingerprint = AnalysisCache::fingerprint(pAudioSource);
+        if (!fingerprint.isEmpty()) {
+            cached = AnalysisCache::load(fingerprint, nextTrack.get());
         }
+    }
 
-        bool processTrack = false;
-        for (auto const& pAnalyzer: m_pAnalyzers) {
-            // Make sure not to short-circuit initialize(...)
-            if (pAnalyzer->initialize(
-                    nextTrack,
-                    pAudioSource->sampleRate(),
-                    pAudioSource->frameLength() * kAnalysisChannels)) {
-                processTrack = true;
-            }
+    bool processTrack = false;
+    for (auto const& pAnalyzer: m_pAnalyzers) {
+        // Make sure not to short-circuit initialize(...)
+        if (pAnalyzer->initialize(
+                nextTrack,
+                pAudioSource->sampleRate(),
+                pAudioSource->frameLength() * kAnalysisChannels)) {
+            processTrack = true;
         }
+    }
 
-        updateSize();
-
-        if (processTrack) {
-            emitUpdateProgress(nextTrack, 0);
-            bool completed = doAnalysis(nextTrack, pAudioSource);
-            if (!completed) {
-                // This track was cancelled
-                for (auto const& pAnalyzer: m_pAnalyzers) {
-                    pAnalyzer->cleanup(nextTrack);
-                }
-                queueAnalyseTrack(nextTrack);
-                emitUpdateProgress(nextTrack, 0);
-            } else {
-                // 100% - FINALIZE_PERCENT finished
-                emitUpdateProgress(nextTrack, 1000 - FINALIZE_PROMILLE);
-                // This takes around 3 sec on a Atom Netbook
-                for (auto const& pAnalyzer: m_pAnalyzers) {
-                    pAnalyzer->finalize(nextTrack);
-                }
-                emit(trackDone(nextTrack));
-                emitUpdateProgress(nextTrack, 1000); // 100%
+    if (processTrack) {
+        m_pQueue->emitUpdateProgress(m_index, nextTrack, 0);
+        const bool loadedTrack = PlayerInfo::instance().isTrackLoaded(nextTrack);
+        if (loadedTrack) {
+            AnalyzerThrottle::beginLoadedTrack();
+        }
+        bool completed = doAnalysis(nextTrack, pAudioSource, loadedTrack);
+        if (loadedTrack) {
+            AnalyzerThrottle::endLoadedTrack();
+        }
+        if (!completed) {
+            // This track was cancelled
+            for (auto const& pAnalyzer: m_pAnalyzers) {
+                pAnalyzer->cleanup(nextTrack);
             }
+            m_pQueue->queueAnalyseTrack(nextTrack);
+            m_pQueue->emitUpdateProgress(m_index, nextTrack, 0);
         } else {
-            emitUpdateProgress(nextTrack, 1000); // 100%
-            kLogger.debug() << "Skipping track analysis because no analyzer initialized.";
+            // 100% - FINALIZE_PERCENT finished
+            m_pQueue->emitUpdateProgress(m_index, nextTrack, 1000 - FINALIZE_PROMILLE);
+            // This takes around 3 sec on a Atom Netbook
+            for (auto const& pAnalyzer: m_pAnalyzers) {
+                pAnalyzer->finalize(nextTrack);
+            }
+            if (!fingerprint.isEmpty()) {
+                AnalysisCache::store(fingerprint, *nextTrack);
+            }
+            emit(m_pQueue->trackDone(nextTrack));
+            m_pQueue->emitUpdateProgress(m_index, nextTrack, 1000); // 100%
         }
-        emptyCheck();
-    }
-
-    if (m_pAnalysisDao) {
-        // Invalidate reference to the thread-local database connection
-        // that will be closed soon. Not necessary, just in case ;)
-        m_pAnalysisDao->initialize(QSqlDatabase());
+    } else {
+        if (!fingerprint.isEmpty() && !cached) {
+            // Analyzed before the cache has been enabled
+            AnalysisCache::store(fingerprint, *nextTrack);
+        }
+        m_pQueue->emitUpdateProgress(m_index, nextTrack, 1000); // 100%
+        kLogger.debug() << "Skipping track analysis because no analyzer initialized.";
     }
+}
 
-    emit(queueEmpty()); // emit in case of exit;
+bool AnalyzerQueue::isEmpty() {
+    QMutexLocker locked(&m_qm);
+    return m_queuedTracks.isEmpty() && m_activeTracks.isEmpty();
 }
 
+// This is called from the worker threads
 void AnalyzerQueue::emptyCheck() {
-    updateSize();
-    if (m_queue_size == 0) {
+    if (isEmpty()) {
         emit(queueEmpty()); // emit asynchrony for no deadlock
     }
 }
 
-void AnalyzerQueue::updateSize() {
-    QMutexLocker locked(&m_qm);
-    m_queue_size = m_queuedTracks.size();
+// This is called from the worker threads
+void AnalyzerQueue::workerExited() {
+    if (m_runningWorkers.fetchAndAddOrdered(-1) == 1) {
+        emit(queueEmpty()); // emit in case of exit;
+    }
 }
 
-// This is called from the AnalyzerQueue thread
-void AnalyzerQueue::emitUpdateProgress(TrackPointer track, int progress) {
-    if (!m_exit) {
-        // First tryAcqire will have always success because sema is initialized with on
-        // The following tries will success if the previous signal was processed in the GUI Thread
-        // This prevent the AnalysisQueue from filling up the GUI Thread event Queue
-        // 100 % is emitted in any case
-        if (progress < 1000 - FINALIZE_PROMILLE && progress > 0) {
-            // Signals during processing are not required in any case
-            if (!m_progressInfo.sema.tryAcquire()) {
-               return;
+// This is called from the worker threads, with a worker index of -1 for
+// tracks that are not analyzed by a worker
+void AnalyzerQueue::emitUpdateProgress(int workerIndex, TrackPointer track, int progress) {
+    if (m_exit) {
+        return;
+    }
+    int queueSize = 0;
+    if (progress == 1000) {
+        // The tracks that are left, not counting this one
+        QMutexLocker locked(&m_qm);
+        queueSize = m_queuedTracks.size() + m_activeTracks.size();
+        if (m_activeTracks.contains(track)) {
+            --queueSize;
+        }
+    }
+    {
+        QMutexLocker locked(&m_progressMutex);
+        if (workerIndex >= 0) {
+            m_workerProgress[workerIndex] = progress < 1000 ? progress : -1;
+        }
+        // Only the latest progress of each track is passed on
+        bool pending = false;
+        for (TrackProgress& trackProgress : m_pendingTrackProgress) {
+            if (trackProgress.track == track) {
+                trackProgress.progress = progress;
+                pending = true;
+                break;
             }
-        } else {
-            m_progressInfo.sema.acquire();
         }
-        m_progressInfo.current_track = track;
-        m_progressInfo.track_progress = progress;
-        m_progressInfo.queue_size = m_queue_size;
+        if (!pending) {
+            m_pendingTrackProgress.append(TrackProgress{track, progress});
+        }
+        m_lastProgress = progress;
+        if (progress == 1000) {
+            m_pendingFinishedQueueSizes.append(queueSize);
+        }
+    }
+    // This prevents the AnalysisQueue from filling up the GUI Thread event
+    // Queue, the next signal is only emitted after the GUI thread has taken
+    // the pending progress
+    if (m_progressUpdatePending.testAndSetOrdered(0, 1)) {
         emit(updateProgress());
     }
 }
 
 //slot
 void AnalyzerQueue::slotUpdateProgress() {
-    if (m_progressInfo.current_track) {
-        m_progressInfo.current_track->setAnalyzerProgress(m_progressInfo.track_progress);
-        m_progressInfo.current_track.reset();
+    // Cleared first, progress that is stored while this slot runs
+    // signals again
+    m_progressUpdatePending.storeRelease(0);
+    QList<TrackProgress> pendingTrackProgress;
+    QList<int> pendingFinishedQueueSizes;
+    int progress = 0;
+    {
+        QMutexLocker locked(&m_progressMutex);
+        pendingTrackProgress.swap(m_pendingTrackProgress);
+        pendingFinishedQueueSizes.swap(m_pendingFinishedQueueSizes);
+        // The average of the tracks that are analyzed right now
+        int sum = 0;
+        int count = 0;
+        for (int workerProgress : m_workerProgress) {
+            if (workerProgress >= 0) {
+                sum += workerProgress;
+                ++count;
+            }
+        }
+        progress = count > 0 ? sum / count : m_lastProgress;
+    }
+    for (const TrackProgress& trackProgress : pendingTrackProgress) {
+        trackProgress.track->setAnalyzerProgress(trackProgress.progress);
     }
-    emit(trackProgress(m_progressInfo.track_progress / 10));
-    if (m_progressInfo.track_progress == 1000) {
-        emit(trackFinished(m_progressInfo.queue_size));
+    emit(trackProgress(progress / 10));
+    for (int queueSize : pendingFinishedQueueSizes) {
+        emit(trackFinished(queueSize));
     }
-    m_progressInfo.sema.release();
 }
 
 void AnalyzerQueue::slotAnalyseTrack(TrackPointer pTrack) {
@@ -456,7 +670,7 @@ void AnalyzerQueue::slotAnalyseTrack(TrackPointer pTrack) {
     m_aiCheckPriorities = true;
 }
 
-// This is called from the GUI and from the AnalyzerQueue thread
+// This is called from the GUI and from the worker threads
 void AnalyzerQueue::queueAnalyseTrack(TrackPointer pTrack) {
     if (pTrack) {
         QMutexLocker locked(&m_qm);
@@ -1,13 +1,17 @@
 #ifndef ANALYZER_ANALYZERQUEUE_H
 #define ANALYZER_ANALYZERQUEUE_H
 
-#include <QThread>
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QObject>
 #include <QQueue>
+#include <QVector>
 #include <QWaitCondition>
-#include <QSemaphore>
 
 #include <vector>
 
+#include "analyzer/analyzerthrottle.h"
 #include "preferences/usersettings.h"
 #include "sources/audiosource.h"
 #include "track/track.h"
@@ -18,7 +22,13 @@
 class Analyzer;
 class AnalysisDao;
 
-class AnalyzerQueue : public QThread {
+// Analyzes the queued tracks in one or more worker threads. Each worker
+// has its own decoder and its own set of analyzers and analyzes one track
+// at a time, so with several workers the tracks of a batch are analyzed
+// in parallel. The analyzers of a worker process the decoded blocks
+// concurrently, see AnalyzerPipeline. While the engine is busy the
+// analysis yields to it, see AnalyzerThrottle.
+class AnalyzerQueue : public QObject {
     Q_OBJECT
 
   public:
@@ -27,65 +37,86 @@ class AnalyzerQueue : public QThread {
         WithoutWaveform,
     };
 
+    // The maximum number of workers of a queue
+    static const int kMaxWorkers = 32;
+
     AnalyzerQueue(
             mixxx::DbConnectionPoolPtr pDbConnectionPool,
             const UserSettingsPointer& pConfig,
-            Mode mode = Mode::Default);
+            Mode mode = Mode::Default,
+            int numWorkers = 1);
     ~AnalyzerQueue() override;
 
+    // The number of workers for batch analysis from
+    // [Library],AnalysisWorkers. Defaults to all cores but one.
+    static int numWorkersForBatchAnalysis(const UserSettingsPointer& pConfig);
+
     void stop();
     void queueAnalyseTrack(TrackPointer tio);
 
+    // Whether all queued tracks are done
+    bool isEmpty();
+
   public slots:
     void slotAnalyseTrack(TrackPointer tio);
     void slotUpdateProgress();
 
   signals:
+    // The progress of the tracks that are analyzed in percent, averaged
+    // over all workers
     void trackProgress(int progress);
     void trackDone(TrackPointer track);
     void trackFinished(int size);
-    // Signals from AnalyzerQueue Thread:
+    // Signals from the worker threads:
+    // Emitted when all queued tracks are done, or once all workers have
+    // stopped
     void queueEmpty();
     void updateProgress();
 
-  protected:
-    void run();
-
   private:
-    struct progress_info {
-        TrackPointer current_track;
-        int track_progress; // in 0.1 %
-        int queue_size;
-        QSemaphore sema;
+    class Worker;
+
+    struct TrackProgress {
+        TrackPointer track;
+        int progress; // in 0.1 %
     };
 
     mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
 
-    std::unique_ptr<AnalysisDao> m_pAnalysisDao;
-
-    typedef std::unique_ptr<Analyzer> AnalyzerPtr;
-    std::vector<AnalyzerPtr> m_pAnalyzers;
-
-    void execThread();
-
-    bool isLoadedTrackWaiting(TrackPointer analysingTrack);
+    // Called from the worker threads
+    bool isLoadedTrackWaiting(const Worker* pWorker, TrackPointer analysingTrack);
     TrackPointer dequeueNextBlocking();
-    bool doAnalysis(TrackPointer tio, mixxx::AudioSourcePointer pAudioSource);
-    void emitUpdateProgress(TrackPointer tio, int progress);
+    void finishTrack(int workerIndex, TrackPointer pTrack);
+    void emitUpdateProgress(int workerIndex, TrackPointer tio, int progress);
     void emptyCheck();
-    void updateSize();
+    void workerExited();
 
-    bool m_exit;
+    volatile bool m_exit;
     QAtomicInt m_aiCheckPriorities;
 
-    mixxx::SampleBuffer m_sampleBuffer;
+    const AnalyzerThrottle m_throttle;
 
-    // The processing queue and associated mutex
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    QAtomicInt m_runningWorkers;
+
+    // The processing queue and associated mutex. The tracks that are
+    // analyzed by a worker are not handed out to another worker until they
+    // are done.
     QQueue<TrackPointer> m_queuedTracks;
+    QList<TrackPointer> m_activeTracks;
+    int m_idleWorkers;
     QMutex m_qm;
     QWaitCondition m_qwait;
-    struct progress_info m_progressInfo;
-    int m_queue_size;
+
+    // The progress that has not been passed to the GUI thread yet and the
+    // current progress of each worker. The GUI thread is only signaled if
+    // it has processed the previous update.
+    QMutex m_progressMutex;
+    QList<TrackProgress> m_pendingTrackProgress;
+    QVector<int> m_workerProgress; // in 0.1 %, -1 while idle
+    QList<int> m_pendingFinishedQueueSizes;
+    int m_lastProgress;
+    QAtomicInt m_progressUpdatePending;
 };
 
 #endif /* ANALYZER_ANALYZERQUEUE_H */
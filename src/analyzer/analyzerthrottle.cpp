@@ -0,0 +1,75 @@
+#include "analyzer/analyzerthrottle.h"
+
+#include <QAtomicInt>
+
+#include "mixer/playerinfo.h"
+#include "util/math.h"
+
+namespace {
+
+const QString kConfigGroup = QStringLiteral("[Library]");
+
+// In percent of the time budget of the audio callback
+const int kDefaultPauseUsagePercent = 60;
+
+// How long a paused worker sleeps before it checks the load again
+const mixxx::Duration kPauseDuration = mixxx::Duration::fromMillis(50);
+
+// At the pause threshold the analysis of a loaded track spends this
+// many times the duration of each block waiting
+const double kMaxSlowDownFactor = 3.0;
+
+QAtomicInt s_loadedTracks(0);
+
+} // anonymous namespace
+
+AnalyzerThrottle::AnalyzerThrottle(const UserSettingsPointer& pConfig)
+        : m_pAudioLatencyUsage(std::make_unique<ControlProxy>(
+                  "[Master]", "audio_latency_usage")),
+          m_pAudioLatencyOverload(std::make_unique<ControlProxy>(
+                  "[Master]", "audio_latency_overload")) {
+    int pauseUsagePercent = kDefaultPauseUsagePercent;
+    if (pConfig) {
+        pauseUsagePercent = pConfig->getValue(
+                ConfigKey(kConfigGroup, "AnalysisMaxEngineLoad"),
+                kDefaultPauseUsagePercent);
+    }
+    m_pauseUsage = math_clamp(pauseUsagePercent, 1, 100) / 100.0;
+    m_slowDownUsage = m_pauseUsage / 2;
+}
+
+// static
+void AnalyzerThrottle::beginLoadedTrack() {
+    s_loadedTracks.fetchAndAddOrdered(1);
+}
+
+// static
+void AnalyzerThrottle::endLoadedTrack() {
+    s_loadedTracks.fetchAndAddOrdered(-1);
+}
+
+mixxx::Duration AnalyzerThrottle::delayAfterBlock(
+        mixxx::Duration blockDuration,
+        bool loadedTrack) const {
+    if (!loadedTrack && s_loadedTracks.load() > 0) {
+        // The loaded track is needed first
+        return kPauseDuration;
+    }
+    if (PlayerInfo::instance().getCurrentPlayingDeck() < 0) {
+        // Nothing to compete with
+        return mixxx::Duration();
+    }
+    const double usage = m_pAudioLatencyUsage->get();
+    const bool overload = m_pAudioLatencyOverload->get() > 0.0;
+    if (!overload && usage <= m_slowDownUsage) {
+        return mixxx::Duration();
+    }
+    if (!loadedTrack && (overload || usage >= m_pauseUsage)) {
+        return kPauseDuration;
+    }
+    const double slowDownFactor = overload ? kMaxSlowDownFactor :
+            kMaxSlowDownFactor * math_min(1.0,
+                    (usage - m_slowDownUsage) / (m_pauseUsage - m_slowDownUsage));
+    return mixxx::Duration::fromNanos(
+            static_cast<qint64>(blockDuration.toIntegerNanos() * slowDownFactor));
+}
@@ -0,0 +1,43 @@
+#ifndef ANALYZER_ANALYZERTHROTTLE_H
+#define ANALYZER_ANALYZERTHROTTLE_H
+
+#include "control/controlproxy.h"
+#include "preferences/usersettings.h"
+#include "util/duration.h"
+#include "util/memory.h"
+
+// Slows down or pauses the analysis while a deck plays and the audio
+// callback needs most of its time budget. The load of the engine is taken
+// from [Master],audio_latency_usage that the sound devices update from the
+// timing of the callback. While no deck plays, the analysis runs at full
+// speed.
+//
+// The analysis of a track that is loaded into a deck is only slowed down,
+// and the backlog of all queues pauses while such a track is analyzed.
+class AnalyzerThrottle {
+  public:
+    explicit AnalyzerThrottle(const UserSettingsPointer& pConfig);
+
+    // Counts the loaded tracks that are analyzed by any queue
+    static void beginLoadedTrack();
+    static void endLoadedTrack();
+
+    // How long a worker should wait after it has spent blockDuration
+    // analyzing a block. The wait is repeated with a zero
+    // blockDuration until it returns zero, so a paused worker polls
+    // the load.
+    mixxx::Duration delayAfterBlock(
+            mixxx::Duration blockDuration,
+            bool loadedTrack) const;
+
+  private:
+    // The usage of the callback above which the analysis slows down and
+    // the one at which the backlog pauses
+    double m_slowDownUsage;
+    double m_pauseUsage;
+
+    std::unique_ptr<ControlProxy> m_pAudioLatencyUsage;
+    std::unique_ptr<ControlProxy> m_pAudioLatencyOverload;
+};
+
+#endif // ANALYZER_ANALYZERTHROTTLE_H
@@ -1,5 +1,12 @@
 #include "analyzer/analyzerwaveform.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
 #include "engine/engineobject.h"
 #include "engine/enginefilterbutterworth8.h"
 #include "engine/enginefilterbessel4.h"
@@ -8,13 +15,77 @@
 #include "track/track.h"
 #include "waveform/waveformfactory.h"
 #include "util/logger.h"
+#include "util/sample.h"
 
 namespace {
 
 mixxx::Logger kLogger("AnalyzerWaveform");
 
+// The workers of the AnalyzerQueue access the analyses through their own
+// database connections. Their writes are serialized to not run into
+// locking timeouts of the database.
+QMutex s_analysisDaoMutex;
+
+unsigned char scaleHighSignalToByteReference(CSAMPLE invalue) {
+    return static_cast<unsigned char>(math_min(255.0,
+            255.0f * scaleSignal(invalue, High) + 0.5));
+}
+
+// The smallest values that are scaled to each byte value from 1 to 255.
+// They are calculated from the inverse of the curve and then adjusted to
+// the results of the reference implementation, so the lookup is exact.
+class HighSignalScale {
+  public:
+    HighSignalScale() {
+        for (int value = 1; value <= 255; ++value) {
+            float threshold = static_cast<float>(
+                    std::pow((value - 0.5) / 255.0, 1.0 / (2.0 * 0.316)));
+            while (scaleHighSignalToByteReference(threshold) < value) {
+                threshold = std::nextafter(threshold, HUGE_VALF);
+            }
+            while (threshold > 0.0f && scaleHighSignalToByteReference(
+                    std::nextafter(threshold, 0.0f)) >= value) {
+                threshold = std::nextafter(threshold, 0.0f);
+            }
+            m_thresholds[value - 1] = threshold;
+        }
+    }
+
+    unsigned char toByte(CSAMPLE invalue) const {
+        // The number of thresholds that are reached
+        return static_cast<unsigned char>(std::upper_bound(
+                m_thresholds, m_thresholds + 255, invalue) - m_thresholds);
+    }
+
+  private:
+    float m_thresholds[255];
+};
+
+// The first position after position at which a stride of the given length
+// ends. These are the positions with fmod(position, length) < 1, which is
+// only evaluated near the multiples of the length.
+int nextStrideEnd(int position, double length) {
+    if (length <= 0) {
+        return INT_MAX;
+    }
+    if (std::fmod(position + 1, length) < 1) {
+        return position + 1;
+    }
+    const double nextMultiple = (std::floor(position / length) + 1) * length;
+    int end = math_max(position + 2, static_cast<int>(nextMultiple) - 1);
+    while (std::fmod(end, length) >= 1) {
+        ++end;
+    }
+    return end;
+}
+
 } // anonymous
 
+unsigned char scaleHighSignalToByte(CSAMPLE invalue) {
+    static const HighSignalScale s_scale;
+    return s_scale.toByte(invalue);
+}
+
 AnalyzerWaveform::AnalyzerWaveform(
         AnalysisDao* pAnalysisDao) :
         m_pAnalysisDao(pAnalysisDao),
@@ -23,11 +94,13 @@ AnalyzerWaveform::AnalyzerWaveform(
         m_waveformSummaryData(nullptr),
         m_stride(0, 0),
         m_currentStride(0),
-        m_currentSummaryStride(0) {
+        m_currentSummaryStride(0),
+        m_nextStrideEnd(0),
+        m_nextSummaryStrideEnd(0),
+        m_pLowFilter(nullptr),
+        m_pMidFilter(nullptr),
+        m_pHighFilter(nullptr) {
     DEBUG_ASSERT(m_pAnalysisDao); // mandatory
-    m_filter[0] = 0;
-    m_filter[1] = 0;
-    m_filter[2] = 0;
 }
 
 AnalyzerWaveform::~AnalyzerWaveform() {
@@ -78,6 +151,8 @@ bool AnalyzerWaveform::initialize(TrackPointer tio, int sampleRate, int totalSam
 
         m_currentStride = 0;
         m_currentSummaryStride = 0;
+        m_nextStrideEnd = nextStrideEnd(0, m_stride.m_length);
+        m_nextSummaryStrideEnd = nextStrideEnd(0, m_stride.m_averageLength);
 
         //debug
         //m_waveform->dump();
@@ -91,6 +166,23 @@ bool AnalyzerWaveform::initialize(TrackPointer tio, int sampleRate, int totalSam
     return !m_skipProcessing;
 }
 
+ConstWaveformPointer AnalyzerWaveform::loadStoredWaveform(
+        const AnalysisDao::AnalysisInfo& analysis) const {
+    WaveformPointer pWaveform(
+            WaveformFactory::loadWaveformFromAnalysis(analysis));
+    if (!pWaveform->isValid()) {
+        m_pAnalysisDao->deleteAnalysis(analysis.analysisId);
+        return ConstWaveformPointer();
+    }
+    if (analysis.mappedFileName.isEmpty()) {
+        // Migrates the compressed format, so the waveform is mapped the
+        // next time it is loaded
+        AnalysisDao::AnalysisInfo migrated = analysis;
+        m_pAnalysisDao->saveMappedWaveform(&migrated, *pWaveform);
+    }
+    return pWaveform;
+}
+
 bool AnalyzerWaveform::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
     ConstWaveformPointer pTrackWaveform = tio->getWaveform();
     ConstWaveformPointer pTrackWaveformSummary = tio->getWaveformSummary();
@@ -102,6 +194,7 @@ bool AnalyzerWaveform::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
     bool missingWavesummary = pTrackWaveformSummary.isNull();
 
     if (trackId.isValid() && (missingWaveform || missingWavesummary)) {
+        const QMutexLocker locked(&s_analysisDaoMutex);
         QList<AnalysisDao::AnalysisInfo> analyses =
                 m_pAnalysisDao->getAnalysesForTrack(trackId);
 
@@ -113,9 +206,8 @@ bool AnalyzerWaveform::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
             if (analysis.type == AnalysisDao::TYPE_WAVEFORM) {
                 vc = WaveformFactory::waveformVersionToVersionClass(analysis.version);
                 if (missingWaveform && vc == WaveformFactory::VC_USE) {
-                    pLoadedTrackWaveform = ConstWaveformPointer(
-                            WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWaveform = false;
+                    pLoadedTrackWaveform = loadStoredWaveform(analysis);
+                    missingWaveform = pLoadedTrackWaveform.isNull();
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
                     m_pAnalysisDao->deleteAnalysis(analysis.analysisId);
@@ -123,9 +215,8 @@ bool AnalyzerWaveform::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
             } if (analysis.type == AnalysisDao::TYPE_WAVESUMMARY) {
                 vc = WaveformFactory::waveformSummaryVersionToVersionClass(analysis.version);
                 if (missingWavesummary && vc == WaveformFactory::VC_USE) {
-                    pLoadedTrackWaveformSummary = ConstWaveformPointer(
-                            WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWavesummary = false;
+                    pLoadedTrackWaveformSummary = loadStoredWaveform(analysis);
+                    missingWavesummary = pLoadedTrackWaveformSummary.isNull();
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
                     m_pAnalysisDao->deleteAnalysis(analysis.analysisId);
@@ -152,22 +243,22 @@ void AnalyzerWaveform::createFilters(int sampleRate) {
     // m_filter[Low] = new EngineFilterButterworth8(FILTER_LOWPASS, sampleRate, 200);
     // m_filter[Mid] = new EngineFilterButterworth8(FILTER_BANDPASS, sampleRate, 200, 2000);
     // m_filter[High] = new EngineFilterButterworth8(FILTER_HIGHPASS, sampleRate, 2000);
-    m_filter[Low] = new EngineFilterBessel4Low(sampleRate, 600);
-    m_filter[Mid] = new EngineFilterBessel4Band(sampleRate, 600, 4000);
-    m_filter[High] = new EngineFilterBessel4High(sampleRate, 4000);
+    m_pLowFilter = new EngineFilterBessel4Low(sampleRate, 600);
+    m_pMidFilter = new EngineFilterBessel4Band(sampleRate, 600, 4000);
+    m_pHighFilter = new EngineFilterBessel4High(sampleRate, 4000);
     // settle filters for silence in preroll to avoids ramping (Bug #1406389)
-    for (int i = 0; i < FilterCount; ++i) {
-        m_filter[i]->assumeSettled();
-    }
+    m_pLowFilter->assumeSettled();
+    m_pMidFilter->assumeSettled();
+    m_pHighFilter->assumeSettled();
 }
 
 void AnalyzerWaveform::destroyFilters() {
-    for (int i = 0; i < FilterCount; ++i) {
-        if (m_filter[i]) {
-            delete m_filter[i];
-            m_filter[i] = 0;
-        }
-    }
+    delete m_pLowFilter;
+    m_pLowFilter = nullptr;
+    delete m_pMidFilter;
+    m_pMidFilter = nullptr;
+    delete m_pHighFilter;
+    m_pHighFilter = nullptr;
 }
 
 void AnalyzerWaveform::process(const CSAMPLE* buffer, const int bufferLength) {
@@ -181,44 +272,36 @@ void AnalyzerWaveform::process(const CSAMPLE* buffer, const int bufferLength) {
         m_buffers[High].resize(bufferLength);
     }
 
-    m_filter[Low]->process(buffer, &m_buffers[Low][0], bufferLength);
-    m_filter[Mid]->process(buffer, &m_buffers[Mid][0], bufferLength);
-    m_filter[High]->process(buffer, &m_buffers[High][0], bufferLength);
+    // All bands in a single pass
+    m_pLowFilter->processTriple(buffer, &m_buffers[Low][0],
+            m_pMidFilter, &m_buffers[Mid][0],
+            m_pHighFilter, &m_buffers[High][0],
+            bufferLength);
 
     m_waveform->setSaveState(Waveform::SaveState::NotSaved);
     m_waveformSummary->setSaveState(Waveform::SaveState::NotSaved);
 
-    for (int i = 0; i < bufferLength; i+=2) {
-        // Take max value, not average of data
-        CSAMPLE cover[2] = { fabs(buffer[i]), fabs(buffer[i + 1]) };
-        CSAMPLE clow[2] =  { fabs(m_buffers[Low][i]), fabs(m_buffers[Low][i + 1]) };
-        CSAMPLE cmid[2] =  { fabs(m_buffers[Mid][i]), fabs(m_buffers[Mid][i + 1]) };
-        CSAMPLE chigh[2] = { fabs(m_buffers[High][i]), fabs(m_buffers[High][i + 1]) };
-
-        // This is for if you want to experiment with averaging instead of
-        // maxing.
-        // m_stride.m_overallData[Right] += buffer[i]*buffer[i];
-        // m_stride.m_overallData[Left] += buffer[i + 1]*buffer[i + 1];
-        // m_stride.m_filteredData[Right][Low] += m_buffers[Low][i]*m_buffers[Low][i];
-        // m_stride.m_filteredData[Left][Low] += m_buffers[Low][i + 1]*m_buffers[Low][i + 1];
-        // m_stride.m_filteredData[Right][Mid] += m_buffers[Mid][i]*m_buffers[Mid][i];
-        // m_stride.m_filteredData[Left][Mid] += m_buffers[Mid][i + 1]*m_buffers[Mid][i + 1];
-        // m_stride.m_filteredData[Right][High] += m_buffers[High][i]*m_buffers[High][i];
-        // m_stride.m_filteredData[Left][High] += m_buffers[High][i + 1]*m_buffers[High][i + 1];
+    // Take max value, not average of data. The frames up to the end of the
+    // next stride are accumulated at once.
+    int i = 0;
+    while (i < bufferLength) {
+        const int strideEnd = math_min(m_nextStrideEnd, m_nextSummaryStrideEnd);
+        const int runLength = math_min(bufferLength - i,
+                (strideEnd - m_stride.m_position) * 2);
 
         // Record the max across this stride.
-        storeIfGreater(&m_stride.m_overallData[Left], cover[Left]);
-        storeIfGreater(&m_stride.m_overallData[Right], cover[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][Low], clow[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][Low], clow[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][Mid], cmid[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][Mid], cmid[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][High], chigh[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][High], chigh[Right]);
-
-        m_stride.m_position++;
-
-        if (fmod(m_stride.m_position, m_stride.m_length) < 1) {
+        SampleUtil::maxAbsPerChannel(&m_stride.m_overallData[Left],
+                &m_stride.m_overallData[Right], buffer + i, runLength);
+        for (int f = 0; f < FilterCount; ++f) {
+            SampleUtil::maxAbsPerChannel(&m_stride.m_filteredData[Left][f],
+                    &m_stride.m_filteredData[Right][f], &m_buffers[f][i],
+                    runLength);
+        }
+
+        m_stride.m_position += runLength / 2;
+        i += runLength;
+
+        if (m_stride.m_position == m_nextStrideEnd) {
             if (m_currentStride + ChannelCount > m_waveform->getDataSize()) {
                 qWarning() << "AnalyzerWaveform::process - currentStride >= waveform size";
                 return;
@@ -226,9 +309,10 @@ void AnalyzerWaveform::process(const CSAMPLE* buffer, const int bufferLength) {
             m_stride.store(m_waveformData + m_currentStride);
             m_currentStride += 2;
             m_waveform->setCompletion(m_currentStride);
+            m_nextStrideEnd = nextStrideEnd(m_stride.m_position, m_stride.m_length);
         }
 
-        if (fmod(m_stride.m_position, m_stride.m_averageLength) < 1) {
+        if (m_stride.m_position == m_nextSummaryStrideEnd) {
             if (m_currentSummaryStride + ChannelCount > m_waveformSummary->getDataSize()) {
                 qWarning() << "AnalyzerWaveform::process - current summary stride >= waveform summary size";
                 return;
@@ -236,6 +320,8 @@ void AnalyzerWaveform::process(const CSAMPLE* buffer, const int bufferLength) {
             m_stride.averageStore(m_waveformSummaryData + m_currentSummaryStride);
             m_currentSummaryStride += 2;
             m_waveformSummary->setCompletion(m_currentSummaryStride);
+            m_nextSummaryStrideEnd = nextStrideEnd(
+                    m_stride.m_position, m_stride.m_averageLength);
 
 #ifdef TEST_HEAT_MAP
                 QPointF point(m_stride.m_filteredData[Right][High],
@@ -282,6 +368,7 @@ void AnalyzerWaveform::finalize(TrackPointer tio) {
     if (m_waveform) {
         m_waveform->setSaveState(Waveform::SaveState::SavePending);
         m_waveform->setCompletion(m_waveform->getDataSize());
+        m_waveform->buildLevels();
         m_waveform->setVersion(WaveformFactory::currentWaveformVersion());
         m_waveform->setDescription(WaveformFactory::currentWaveformDescription());
         // Since clear() could delete the waveform, clear our pointer to the
@@ -294,6 +381,7 @@ void AnalyzerWaveform::finalize(TrackPointer tio) {
     if (m_waveformSummary) {
         m_waveformSummary->setSaveState(Waveform::SaveState::SavePending);
         m_waveformSummary->setCompletion(m_waveformSummary->getDataSize());
+        m_waveformSummary->buildLevels();
         m_waveformSummary->setVersion(WaveformFactory::currentWaveformSummaryVersion());
         m_waveformSummary->setDescription(WaveformFactory::currentWaveformSummaryDescription());
         // Since clear() could delete the waveform, clear our pointer to the
@@ -310,14 +398,11 @@ void AnalyzerWaveform::finalize(TrackPointer tio) {
     // waveforms (i.e. if the config setting was disabled in a previous scan)
     // and then it is not called. The other analyzers have signals which control
     // the update of their data.
-    m_pAnalysisDao->saveTrackAnalyses(*tio);
+    {
+        const QMutexLocker locked(&s_analysisDaoMutex);
+        m_pAnalysisDao->saveTrackAnalyses(*tio);
+    }
 
     kLogger.debug() << "Waveform generation for track" << tio->getId() << "done"
              << m_timer.elapsed().debugSecondsWithUnit();
 }
-
-void AnalyzerWaveform::storeIfGreater(float* pDest, float source) {
-    if (*pDest < source) {
-        *pDest = source;
-    }
-}
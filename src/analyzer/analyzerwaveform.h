@@ -6,6 +6,7 @@
 #include <limits>
 
 #include "analyzer/analyzer.h"
+#include "library/dao/analysisdao.h"
 #include "waveform/waveform.h"
 #include "util/math.h"
 #include "util/performancetimer.h"
@@ -13,8 +14,9 @@
 //NOTS vrince some test to segment sound, to apply color in the waveform
 //#define TEST_HEAT_MAP
 
-class EngineFilterIIRBase;
-class AnalysisDao;
+class EngineFilterBessel4Low;
+class EngineFilterBessel4Band;
+class EngineFilterBessel4High;
 
 inline CSAMPLE scaleSignal(CSAMPLE invalue, FilterIndex index = FilterCount) {
     if (invalue == 0.0) {
@@ -27,6 +29,11 @@ inline CSAMPLE scaleSignal(CSAMPLE invalue, FilterIndex index = FilterCount) {
     }
 }
 
+// The same as math_min(255.0, 255 * scaleSignal(invalue, High) + 0.5) for
+// the non-negative peaks of the waveform, but the result is looked up in
+// a table of the values at which it steps instead of calling pow()
+unsigned char scaleHighSignalToByte(CSAMPLE invalue);
+
 struct WaveformStride {
     WaveformStride(double samples, double averageSamples)
             : m_position(0),
@@ -68,8 +75,7 @@ struct WaveformStride {
                     m_postScaleConversion * scaleSignal(m_filteredData[i][Low], Low) + 0.5));
             datum.filtered.mid = static_cast<unsigned char>(math_min(255.0,
                     m_postScaleConversion * scaleSignal(m_filteredData[i][Mid], Mid) + 0.5));
-            datum.filtered.high = static_cast<unsigned char>(math_min(255.0,
-                    m_postScaleConversion * scaleSignal(m_filteredData[i][High], High) + 0.5));
+            datum.filtered.high = scaleHighSignalToByte(m_filteredData[i][High]);
         }
         m_averageDivisor++;
         for (int i = 0; i < ChannelCount; ++i) {
@@ -92,8 +98,8 @@ struct WaveformStride {
                         m_postScaleConversion * scaleSignal(m_averageFilteredData[i][Low] / m_averageDivisor, Low) + 0.5));
                 datum.filtered.mid = static_cast<unsigned char>(math_min(255.0,
                         m_postScaleConversion * scaleSignal(m_averageFilteredData[i][Mid] / m_averageDivisor, Mid) + 0.5));
-                datum.filtered.high = static_cast<unsigned char>(math_min(255.0,
-                        m_postScaleConversion * scaleSignal(m_averageFilteredData[i][High] / m_averageDivisor, High) + 0.5));
+                datum.filtered.high = scaleHighSignalToByte(
+                        m_averageFilteredData[i][High] / m_averageDivisor);
             }
         } else {
             // This is the case if The Overview Waveform has more samples than the detailed waveform
@@ -105,8 +111,7 @@ struct WaveformStride {
                         m_postScaleConversion * scaleSignal(m_filteredData[i][Low], Low) + 0.5));
                 datum.filtered.mid = static_cast<unsigned char>(math_min(255.0,
                         m_postScaleConversion * scaleSignal(m_filteredData[i][Mid], Mid) + 0.5));
-                datum.filtered.high = static_cast<unsigned char>(math_min(255.0,
-                        m_postScaleConversion * scaleSignal(m_filteredData[i][High], High) + 0.5));
+                datum.filtered.high = scaleHighSignalToByte(m_filteredData[i][High]);
             }
         }
 
@@ -147,12 +152,15 @@ class AnalyzerWaveform : public Analyzer {
     void finalize(TrackPointer tio) override;
 
   private:
+    // Returns null if the stored waveform is damaged
+    ConstWaveformPointer loadStoredWaveform(
+            const AnalysisDao::AnalysisInfo& analysis) const;
+
     void storeCurentStridePower();
     void resetCurrentStride();
 
     void createFilters(int sampleRate);
     void destroyFilters();
-    void storeIfGreater(float* pDest, float source);
 
     AnalysisDao* m_pAnalysisDao;
 
@@ -167,8 +175,14 @@ class AnalyzerWaveform : public Analyzer {
 
     int m_currentStride;
     int m_currentSummaryStride;
-
-    EngineFilterIIRBase* m_filter[FilterCount];
+    // The positions of m_stride at which the next waveform and summary
+    // data are stored
+    int m_nextStrideEnd;
+    int m_nextSummaryStrideEnd;
+
+    EngineFilterBessel4Low* m_pLowFilter;
+    EngineFilterBessel4Band* m_pMidFilter;
+    EngineFilterBessel4High* m_pHighFilter;
     std::vector<float> m_buffers[FilterCount];
 
     PerformanceTimer m_timer;
@@ -16,23 +16,56 @@ VampAnalyzer::VampAnalyzer()
       m_iStepSize(0),
       m_rate(0),
       m_iOutput(0),
+      m_iChannels(2),
       m_pluginbuf(new CSAMPLE*[2]),
       m_plugin(NULL),
+      m_bPluginInitialised(false),
+      m_pPluginPool(NULL),
       m_bDoNotAnalyseMoreSamples(false),
       m_FastAnalysisEnabled(false),
       m_iMaxSamplesToAnalyse(0) {
+    m_pluginbuf[0] = NULL;
+    m_pluginbuf[1] = NULL;
 }
 
 VampAnalyzer::~VampAnalyzer() {
+    for (int i = 0; i < 2; i++) {
+        delete [] m_pluginbuf[i];
+    }
     delete[] m_pluginbuf;
-    delete m_plugin;
+    releasePlugin();
+}
+
+void VampAnalyzer::releasePlugin() {
+    if (m_plugin != NULL && m_bPluginInitialised && m_pPluginPool != NULL) {
+        m_pPluginPool->release(m_key, m_rate, m_iChannels,
+                m_iStepSize, m_iBlockSize, m_plugin);
+    } else {
+        delete m_plugin;
+    }
+    m_plugin = NULL;
+    m_bPluginInitialised = false;
 }
 
 bool VampAnalyzer::Init(const QString pluginlibrary, const QString pluginid,
-                        const int samplerate, const int TotalSamples, bool bFastAnalysis) {
+                        const int samplerate, const int TotalSamples, bool bFastAnalysis,
+                        const int channelCount,
+                        mixxx::VampPluginPool* pPluginPool) {
+    if (m_plugin != NULL) {
+        releasePlugin();
+        qDebug() << "VampAnalyzer: kill plugin";
+    }
+    m_pPluginPool = pPluginPool;
+
     m_iRemainingSamples = TotalSamples;
     m_rate = samplerate;
 
+    if (channelCount < 1 || channelCount > 2) {
+        qDebug() << "VampAnalyzer: Unsupported channel count" << channelCount;
+        return false;
+    }
+    m_iChannels = channelCount;
+
     if (samplerate <= 0.0) {
         qDebug() << "VampAnalyzer: Track has non-positive samplerate";
         return false;
@@ -43,12 +76,6 @@ bool VampAnalyzer::Init(const QString pluginlibrary, const QString pluginid,
         return false;
     }
 
-    if (m_plugin != NULL) {
-        delete m_plugin;
-        m_plugin = NULL;
-        qDebug() << "VampAnalyzer: kill plugin";
-    }
-
     QStringList pluginlist = pluginid.split(":");
     if (pluginlist.size() != 2) {
         qDebug() << "VampAnalyzer: got malformed pluginid: " << pluginid;
@@ -66,6 +93,32 @@ bool VampAnalyzer::Init(const QString pluginlibrary, const QString pluginid,
     mixxx::VampPluginLoader pluginLoader;
     m_key = pluginLoader.composePluginKey(pluginlibrary.toStdString(),
                                      plugin.toStdString());
+    if (m_pPluginPool != NULL) {
+        m_plugin = m_pPluginPool->acquire(m_key, m_rate, m_iChannels,
+                &m_iStepSize, &m_iBlockSize);
+    }
+    if (m_plugin != NULL) {
+        m_bPluginInitialised = true;
+        SelectOutput(outputnumber);
+    } else if (!loadAndInitialisePlugin(outputnumber)) {
+        return false;
+    }
+
+    // Here we are using m_iBlockSize: it cannot be 0
+    for (int i = 0; i < 2; i++) {
+        delete [] m_pluginbuf[i];
+        m_pluginbuf[i] = i < m_iChannels ? new CSAMPLE[m_iBlockSize] : NULL;
+    }
+    m_FastAnalysisEnabled = bFastAnalysis;
+    if (m_FastAnalysisEnabled) {
+        qDebug() << "Using fast analysis methods for BPM and Replay Gain.";
+        m_iMaxSamplesToAnalyse = 120 * m_rate; //only consider the first minute
+    }
+    return true;
+}
+
+bool VampAnalyzer::loadAndInitialisePlugin(const int outputnumber) {
+    mixxx::VampPluginLoader pluginLoader;
     m_plugin = pluginLoader.loadPlugin(m_key, m_rate,
                                   Vamp::HostExt::PluginLoader::ADAPT_ALL_SAFE);
 
@@ -109,18 +162,11 @@ bool VampAnalyzer::Init(const QString pluginlibrary, const QString pluginid,
         qDebug() << "Vampanalyzer: setting m_iStepSize to" << m_iStepSize;
     }
 
-    if (!m_plugin->initialise(2, m_iStepSize, m_iBlockSize)) {
+    if (!m_plugin->initialise(m_iChannels, m_iStepSize, m_iBlockSize)) {
         qDebug() << "VampAnalyzer: Cannot initialize plugin";
         return false;
     }
-    // Here we are using m_iBlockSize: it cannot be 0
-    m_pluginbuf[0] = new CSAMPLE[m_iBlockSize];
-    m_pluginbuf[1] = new CSAMPLE[m_iBlockSize];
-    m_FastAnalysisEnabled = bFastAnalysis;
-    if (m_FastAnalysisEnabled) {
-        qDebug() << "Using fast analysis methods for BPM and Replay Gain.";
-        m_iMaxSamplesToAnalyse = 120 * m_rate; //only consider the first minute
-    }
+    m_bPluginInitialised = true;
     return true;
 }
 
@@ -130,7 +176,7 @@ bool VampAnalyzer::Process(const CSAMPLE *pIn, const int iLen) {
         return false;
     }
 
-    if (m_pluginbuf[0] == NULL || m_pluginbuf[1] == NULL) {
+    if (m_pluginbuf[0] == NULL || (m_iChannels == 2 && m_pluginbuf[1] == NULL)) {
         qDebug() << "VampAnalyzer: Buffer points to NULL";
         return false;
     }
@@ -143,9 +189,11 @@ bool VampAnalyzer::Process(const CSAMPLE *pIn, const int iLen) {
     bool lastsamples = false;
     m_iRemainingSamples -= iLen;
 
-    while (iIN < iLen / 2) { //4096
-        m_pluginbuf[0][m_iOUT] = pIn[2 * iIN]; //* 32767;
-        m_pluginbuf[1][m_iOUT] = pIn[2 * iIN + 1]; //* 32767;
+    const int iFrames = iLen / m_iChannels;
+    while (iIN < iFrames) { //4096
+        for (int i = 0; i < m_iChannels; i++) {
+            m_pluginbuf[i][m_iOUT] = pIn[m_iChannels * iIN + i]; //* 32767;
+        }
 
         m_iOUT++;
         iIN++;
@@ -161,12 +209,13 @@ bool VampAnalyzer::Process(const CSAMPLE *pIn, const int iLen) {
          * If the total number of samples is incorrect
          * VampAnalyzer:End() handles it.
          */
-        if (m_iRemainingSamples <= 0 && iIN == iLen / 2) {
+        if (m_iRemainingSamples <= 0 && iIN == iFrames) {
             lastsamples = true;
             //qDebug() << "LastSample reached";
             while (m_iOUT < m_iBlockSize) {
-                m_pluginbuf[0][m_iOUT] = 0;
-                m_pluginbuf[1][m_iOUT] = 0;
+                for (int i = 0; i < m_iChannels; i++) {
+                    m_pluginbuf[i][m_iOUT] = 0;
+                }
                 m_iOUT++;
             }
         }
@@ -197,10 +246,9 @@ bool VampAnalyzer::Process(const CSAMPLE *pIn, const int iLen) {
             // move (m_iBlockSize - m_iStepSize) samples from m_iStepSize'th
             // position to 0.
             while (m_iOUT < (m_iBlockSize - m_iStepSize)) {
-                CSAMPLE lframe = m_pluginbuf[0][m_iOUT + m_iStepSize];
-                CSAMPLE rframe = m_pluginbuf[1][m_iOUT + m_iStepSize];
-                m_pluginbuf[0][m_iOUT] = lframe;
-                m_pluginbuf[1][m_iOUT] = rframe;
+                for (int i = 0; i < m_iChannels; i++) {
+                    m_pluginbuf[i][m_iOUT] = m_pluginbuf[i][m_iOUT + m_iStepSize];
+                }
                 m_iOUT++;
             }
 
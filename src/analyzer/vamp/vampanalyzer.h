@@ -14,6 +14,7 @@
 
 #include <vamp-hostsdk/vamp-hostsdk.h>
 
+#include "analyzer/vamp/vamppluginpool.h"
 #include "preferences/usersettings.h"
 #include "util/sample.h"
 
@@ -22,8 +23,13 @@ class VampAnalyzer {
     VampAnalyzer();
     virtual ~VampAnalyzer();
 
+    // The samples are interleaved with channelCount channels, which may
+    // be 1 or 2. The plugin is taken from and returned to pPluginPool
+    // if one is given.
     bool Init(const QString pluginlibrary, const QString pluginid,
-              const int samplerate, const int TotalSamples, bool bFastAnalysis);
+              const int samplerate, const int TotalSamples, bool bFastAnalysis,
+              const int channelCount = 2,
+              mixxx::VampPluginPool* pPluginPool = NULL);
     bool Process(const CSAMPLE *pIn, const int iLen);
     bool End();
     bool SetParameter(const QString parameter, const double value);
@@ -37,11 +43,17 @@ class VampAnalyzer {
     void SelectOutput(const int outputnumber);
 
   private:
+    // Returns an initialised plugin to the pool or deletes it
+    bool loadAndInitialisePlugin(const int outputnumber);
+    void releasePlugin();
+
     Vamp::HostExt::PluginLoader::PluginKey m_key;
     int m_iSampleCount, m_iOUT, m_iRemainingSamples,
-        m_iBlockSize, m_iStepSize, m_rate, m_iOutput;
+        m_iBlockSize, m_iStepSize, m_rate, m_iOutput, m_iChannels;
     CSAMPLE ** m_pluginbuf;
     Vamp::Plugin *m_plugin;
+    bool m_bPluginInitialised;
+    mixxx::VampPluginPool* m_pPluginPool;
     Vamp::Plugin::ParameterList mParameters;
     Vamp::Plugin::FeatureList m_Results;
 
@@ -1,19 +1,35 @@
 #include "analyzer/vamp/vamppluginloader.h"
 
+#include <memory>
 #include <mutex>
 
 #include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDesktopServices>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLibrary>
+#include <QMap>
+#include <QSaveFile>
 #include <QStringBuilder>
+#include <QStringList>
+
+#include <vamp/vamp.h>
 
 #include "util/logger.h"
 
 #ifdef __WINDOWS__
     #include <windows.h>
     #define ENV_PATH_LIST_SEPARATOR ";"
+    #define PLUGIN_LIBRARY_NAME_FILTER "*.dll"
+#elif __APPLE__
+    #define ENV_PATH_LIST_SEPARATOR ":"
+    #define PLUGIN_LIBRARY_NAME_FILTER "*.dylib"
 #else
     #define ENV_PATH_LIST_SEPARATOR ":"
+    #define PLUGIN_LIBRARY_NAME_FILTER "*.so"
 #endif
 
 
@@ -27,6 +43,151 @@ Vamp::HostExt::PluginLoader* s_pPluginLoader = nullptr;
 
 std::once_flag s_initPluginLoaderOnceFlag;
 
+// The plugin loader is not thread-safe, but the analyzers of several
+// AnalyzerQueue workers load their plugins concurrently
+std::mutex s_pluginLoaderMutex;
+
+// Must be changed whenever the layout of the cache file changes
+const quint32 kCacheMagic = 0x4d585650; // "MXVP"
+const quint32 kCacheVersion = 1;
+
+// The plugins are instantiated with some rate only to list their outputs
+const float kListingSampleRate = 48000;
+
+struct LibraryEntry {
+    LibraryEntry()
+            : size(-1),
+              lastModified(0) {
+    }
+
+    qint64 size;
+    qint64 lastModified;
+    VampPluginLoader::PluginOutputList outputs;
+};
+
+// Guarded by s_pluginLoaderMutex
+QString s_cacheFilePath;
+// Keyed by the absolute path of the library
+QMap<QString, LibraryEntry> s_libraryEntries;
+bool s_libraryEntriesLoaded = false;
+
+QDataStream& operator<<(QDataStream& out,
+        const VampPluginLoader::PluginOutput& output) {
+    return out << QString::fromStdString(output.key)
+            << output.pluginIdentifier << output.pluginName
+            << qint32(output.outputIndex);
+}
+
+QDataStream& operator>>(QDataStream& in,
+        VampPluginLoader::PluginOutput& output) {
+    QString key;
+    qint32 outputIndex;
+    in >> key >> output.pluginIdentifier >> output.pluginName >> outputIndex;
+    output.key = key.toStdString();
+    output.outputIndex = outputIndex;
+    return in;
+}
+
+QDataStream& operator<<(QDataStream& out, const LibraryEntry& entry) {
+    out << entry.size << entry.lastModified << qint32(entry.outputs.size());
+    for (const auto& output : entry.outputs) {
+        out << output;
+    }
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, LibraryEntry& entry) {
+    qint32 outputCount = 0;
+    in >> entry.size >> entry.lastModified >> outputCount;
+    entry.outputs.clear();
+    for (qint32 i = 0; i < outputCount && in.status() == QDataStream::Ok; ++i) {
+        VampPluginLoader::PluginOutput output;
+        in >> output;
+        entry.outputs.append(output);
+    }
+    return in;
+}
+
+qint64 lastModifiedOf(const QFileInfo& fileInfo) {
+    return fileInfo.lastModified().toMSecsSinceEpoch();
+}
+
+void loadCacheFile() {
+    if (s_cacheFilePath.isEmpty()) {
+        return;
+    }
+    QFile file(s_cacheFilePath);
+    if (!file.exists()) {
+        return;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        kLogger.warning() << "Failed to open cache file" << file.fileName()
+                << file.errorString();
+        return;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != kCacheMagic || version != kCacheVersion) {
+        kLogger.info() << "Ignoring outdated cache file" << file.fileName();
+        return;
+    }
+    QMap<QString, LibraryEntry> libraryEntries;
+    in >> libraryEntries;
+    if (in.status() != QDataStream::Ok) {
+        kLogger.warning() << "Ignoring damaged cache file" << file.fileName();
+        return;
+    }
+    s_libraryEntries = libraryEntries;
+}
+
+void saveCacheFile() {
+    if (s_cacheFilePath.isEmpty()) {
+        return;
+    }
+    QSaveFile file(s_cacheFilePath);
+    if (file.open(QIODevice::WriteOnly)) {
+        QDataStream out(&file);
+        out << kCacheMagic << kCacheVersion << s_libraryEntries;
+    }
+    if (!file.commit()) {
+        kLogger.warning() << "Failed to write cache file" << file.fileName()
+                << file.errorString();
+    }
+}
+
+QFileInfoList findPluginLibraries() {
+    QFileInfoList libraries;
+    for (const auto& path : Vamp::PluginHostAdapter::getPluginPath()) {
+        libraries.append(QDir(QString::fromStdString(path)).entryInfoList(
+                QStringList(PLUGIN_LIBRARY_NAME_FILTER), QDir::Files));
+    }
+    return libraries;
+}
+
+// Reads the identifiers of the plugins from the descriptors in the library,
+// without instantiating them
+QStringList listPluginIdentifiers(const QFileInfo& libraryFile) {
+    typedef const VampPluginDescriptor* (*GetDescriptorFunction)(
+            unsigned int, unsigned int);
+    QStringList identifiers;
+    QLibrary library(libraryFile.absoluteFilePath());
+    auto getDescriptor = reinterpret_cast<GetDescriptorFunction>(
+            library.resolve("vampGetPluginDescriptor"));
+    if (!getDescriptor) {
+        kLogger.warning() << "Ignoring library without Vamp plugins"
+                << libraryFile.absoluteFilePath() << library.errorString();
+        return identifiers;
+    }
+    const VampPluginDescriptor* pDescriptor;
+    for (unsigned int index = 0;
+            (pDescriptor = getDescriptor(VAMP_API_VERSION, index)); ++index) {
+        identifiers.append(QString::fromUtf8(pDescriptor->identifier));
+    }
+    return identifiers;
+}
+
 inline
 QString toNativeEnvPath(const QDir& dir) {
     return QDir::toNativeSeparators(dir.absolutePath());
@@ -144,28 +305,108 @@ void initPluginLoader() {
 
 } // anonymous namespace
 
+// static
+void VampPluginLoader::setCacheFile(const QString& filePath) {
+    std::lock_guard<std::mutex> locked(s_pluginLoaderMutex);
+    s_cacheFilePath = filePath;
+    s_libraryEntriesLoaded = false;
+}
+
 VampPluginLoader::VampPluginLoader() {
     std::call_once(s_initPluginLoaderOnceFlag, initPluginLoader);
 }
 
+VampPluginLoader::PluginOutputList VampPluginLoader::listPluginOutputs() {
+    std::lock_guard<std::mutex> locked(s_pluginLoaderMutex);
+    if (!s_libraryEntriesLoaded) {
+        loadCacheFile();
+        s_libraryEntriesLoaded = true;
+    }
+
+    QMap<QString, LibraryEntry> libraryEntries;
+    int listedLibraries = 0;
+    for (const auto& libraryFile : findPluginLibraries()) {
+        const QString libraryPath = libraryFile.absoluteFilePath();
+        if (libraryEntries.contains(libraryPath)) {
+            // Listed twice in VAMP_PATH
+            continue;
+        }
+        const auto it = s_libraryEntries.constFind(libraryPath);
+        if (it != s_libraryEntries.constEnd() &&
+                it->size == libraryFile.size() &&
+                it->lastModified == lastModifiedOf(libraryFile)) {
+            libraryEntries.insert(libraryPath, it.value());
+            continue;
+        }
+        LibraryEntry entry;
+        entry.size = libraryFile.size();
+        entry.lastModified = lastModifiedOf(libraryFile);
+        for (const auto& identifier : listPluginIdentifiers(libraryFile)) {
+            const Vamp::HostExt::PluginLoader::PluginKey key =
+                    s_pPluginLoader->composePluginKey(
+                            libraryFile.fileName().toStdString(),
+                            identifier.toStdString());
+            std::unique_ptr<Vamp::Plugin> pPlugin(
+                    s_pPluginLoader->loadPlugin(key, kListingSampleRate));
+            if (!pPlugin) {
+                continue;
+            }
+            const Vamp::Plugin::OutputList outputs =
+                    pPlugin->getOutputDescriptors();
+            for (unsigned int i = 0; i < outputs.size(); ++i) {
+                PluginOutput output;
+                output.key = key;
+                output.pluginIdentifier =
+                        QString::fromStdString(pPlugin->getIdentifier());
+                output.pluginName = QString::fromStdString(pPlugin->getName());
+                output.outputIndex = i;
+                entry.outputs.append(output);
+            }
+        }
+        libraryEntries.insert(libraryPath, entry);
+        ++listedLibraries;
+    }
+    if (listedLibraries > 0) {
+        kLogger.info() << "Listed the plugins of" << listedLibraries
+                << "new or modified libraries";
+    }
+
+    const bool changed = listedLibraries > 0 ||
+            libraryEntries.size() != s_libraryEntries.size();
+    s_libraryEntries = libraryEntries;
+    if (changed) {
+        saveCacheFile();
+    }
+
+    PluginOutputList outputs;
+    for (const auto& entry : s_libraryEntries) {
+        outputs.append(entry.outputs);
+    }
+    return outputs;
+}
+
 Vamp::HostExt::PluginLoader::PluginKey VampPluginLoader::composePluginKey(
     std::string libraryName, std::string identifier) {
+    std::lock_guard<std::mutex> locked(s_pluginLoaderMutex);
     return s_pPluginLoader->composePluginKey(
         libraryName, identifier);
 }
 
 Vamp::HostExt::PluginLoader::PluginCategoryHierarchy VampPluginLoader::getPluginCategory(
     Vamp::HostExt::PluginLoader::PluginKey plugin) {
+    std::lock_guard<std::mutex> locked(s_pluginLoaderMutex);
     return s_pPluginLoader->getPluginCategory(plugin);
 }
 
 Vamp::HostExt::PluginLoader::PluginKeyList VampPluginLoader::listPlugins() {
+    std::lock_guard<std::mutex> locked(s_pluginLoaderMutex);
     return s_pPluginLoader->listPlugins();
 }
 
 Vamp::Plugin* VampPluginLoader::loadPlugin(
     Vamp::HostExt::PluginLoader::PluginKey key,
     float inputSampleRate, int adapterFlags) {
+    std::lock_guard<std::mutex> locked(s_pluginLoaderMutex);
     return s_pPluginLoader->loadPlugin(
         key, inputSampleRate, adapterFlags);
 }
@@ -1,6 +1,9 @@
 #ifndef MIXXX_VAMPPLUGINLOADER_H
 #define MIXXX_VAMPPLUGINLOADER_H
 
+#include <QList>
+#include <QString>
+
 #include <vamp-hostsdk/vamp-hostsdk.h>
 
 
@@ -8,8 +11,31 @@ namespace mixxx {
 
 class VampPluginLoader final {
   public:
+    // An output of an installed plugin
+    struct PluginOutput {
+        PluginOutput()
+                : outputIndex(0) {
+        }
+
+        Vamp::HostExt::PluginLoader::PluginKey key;
+        QString pluginIdentifier;
+        QString pluginName;
+        int outputIndex;
+    };
+    typedef QList<PluginOutput> PluginOutputList;
+
+    // The file where the outputs of the plugins in each library are kept
+    // between runs. Without a file the libraries are loaded every time
+    // the outputs are listed.
+    static void setCacheFile(const QString& filePath);
+
     VampPluginLoader();
 
+    // Lists the outputs of all installed plugins. Only the libraries that
+    // have been added or modified since they have last been listed are
+    // loaded, the others are described by the cache file.
+    PluginOutputList listPluginOutputs();
+
     Vamp::HostExt::PluginLoader::PluginKeyList listPlugins();
     Vamp::Plugin *loadPlugin(Vamp::HostExt::PluginLoader::PluginKey,
                              float inputSampleRate, int adapterFlags = 0);
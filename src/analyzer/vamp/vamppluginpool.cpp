@@ -0,0 +1,74 @@
+#include "analyzer/vamp/vamppluginpool.h"
+
+#include <iterator>
+
+#include <QMutexLocker>
+
+#include "util/logger.h"
+
+
+namespace mixxx {
+
+namespace {
+
+Logger kLogger("VampPluginPool");
+
+} // anonymous namespace
+
+VampPluginPool::~VampPluginPool() {
+    for (const auto& entry : m_entries) {
+        delete entry.pPlugin;
+    }
+}
+
+Vamp::Plugin* VampPluginPool::acquire(
+        const Vamp::HostExt::PluginLoader::PluginKey& key,
+        int sampleRate, int channelCount,
+        int* pStepSize, int* pBlockSize) {
+    QMutexLocker locked(&m_mutex);
+    for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+        if (it->key == key && it->sampleRate == sampleRate &&
+                it->channelCount == channelCount) {
+            Vamp::Plugin* pPlugin = it->pPlugin;
+            *pStepSize = it->stepSize;
+            *pBlockSize = it->blockSize;
+            m_entries.erase(std::next(it).base());
+            locked.unlock();
+            // Restores the state after initialise()
+            pPlugin->reset();
+            kLogger.debug() << "Reusing plugin"
+                    << QString::fromStdString(key);
+            return pPlugin;
+        }
+    }
+    return NULL;
+}
+
+void VampPluginPool::release(
+        const Vamp::HostExt::PluginLoader::PluginKey& key,
+        int sampleRate, int channelCount,
+        int stepSize, int blockSize,
+        Vamp::Plugin* pPlugin) {
+    if (!pPlugin) {
+        return;
+    }
+    Vamp::Plugin* pEvicted = NULL;
+    {
+        QMutexLocker locked(&m_mutex);
+        if (static_cast<int>(m_entries.size()) >= kMaxPlugins) {
+            pEvicted = m_entries.front().pPlugin;
+            m_entries.erase(m_entries.begin());
+        }
+        Entry entry;
+        entry.key = key;
+        entry.sampleRate = sampleRate;
+        entry.channelCount = channelCount;
+        entry.stepSize = stepSize;
+        entry.blockSize = blockSize;
+        entry.pPlugin = pPlugin;
+        m_entries.push_back(entry);
+    }
+    delete pEvicted;
+}
+
+} // namespace mixxx
@@ -0,0 +1,59 @@
+#ifndef MIXXX_VAMPPLUGINPOOL_H
+#define MIXXX_VAMPPLUGINPOOL_H
+
+#include <vector>
+
+#include <QMutex>
+
+#include <vamp-hostsdk/vamp-hostsdk.h>
+
+
+namespace mixxx {
+
+// Keeps the plugins that the VampAnalyzers of one analyzer have initialised,
+// so the following tracks reuse them after a reset() instead of loading and
+// initialising them again. A plugin is only reused with the same sample rate
+// and channel count, which also determine its step and block size.
+class VampPluginPool final {
+  public:
+    VampPluginPool() = default;
+    ~VampPluginPool();
+
+    // Takes an initialised plugin out of the pool and resets it. Returns
+    // NULL if the pool has none for this configuration.
+    Vamp::Plugin* acquire(
+            const Vamp::HostExt::PluginLoader::PluginKey& key,
+            int sampleRate, int channelCount,
+            int* pStepSize, int* pBlockSize);
+
+    // Passes the ownership of a plugin that has been initialised with the
+    // given configuration to the pool
+    void release(
+            const Vamp::HostExt::PluginLoader::PluginKey& key,
+            int sampleRate, int channelCount,
+            int stepSize, int blockSize,
+            Vamp::Plugin* pPlugin);
+
+  private:
+    // The quick and the full analysis of a track need two instances, and
+    // the pool keeps at most two more when the preferences change
+    static const int kMaxPlugins = 4;
+
+    struct Entry {
+        Vamp::HostExt::PluginLoader::PluginKey key;
+        int sampleRate;
+        int channelCount;
+        int stepSize;
+        int blockSize;
+        Vamp::Plugin* pPlugin;
+    };
+
+    QMutex m_mutex;
+    // The most recently released plugin is at the back
+    std::vector<Entry> m_entries;
+};
+
+} // namespace mixxx
+
+
+#endif // MIXXX_VAMPPLUGINPOOL_H
@@ -24,7 +24,8 @@ BroadcastManager::BroadcastManager(SettingsManager* pSettingsManager,
                                    SoundManager* pSoundManager)
         : m_pConfig(pSettingsManager->settings()),
           m_pBroadcastSettings(pSettingsManager->broadcastSettings()),
-          m_pNetworkStream(pSoundManager->getNetworkStream()) {
+          m_pNetworkStream(pSoundManager->getNetworkStream()),
+          m_pEncoderPool(new SharedEncoderPool()) {
     const bool persist = true;
     m_pBroadcastEnabled = new ControlPushButton(
             ConfigKey(BROADCAST_PREF_KEY,"enabled"), persist);
@@ -132,7 +133,7 @@ void BroadcastManager::slotProfileRemoved(BroadcastProfilePtr profile) {
 void BroadcastManager::slotProfilesChanged() {
     QVector<NetworkOutputStreamWorkerPtr> workers = m_pNetworkStream->outputWorkers();
     for(NetworkOutputStreamWorkerPtr pWorker : workers) {
-        ShoutConnectionPtr connection = qSharedPointerCast<ShoutConnection>(pWorker);
+        ShoutConnectionPtr connection = qSharedPointerDynamicCast<ShoutConnection>(pWorker);
         if(connection) {
             BroadcastProfilePtr profile = connection->profile();
             if(profile->connectionStatus() == BroadcastProfile::STATUS_FAILURE
@@ -152,7 +153,7 @@ bool BroadcastManager::addConnection(BroadcastProfilePtr profile) {
         return false;
     }
 
-    ShoutConnectionPtr connection(new ShoutConnection(profile, m_pConfig));
+    ShoutConnectionPtr connection(new ShoutConnection(profile, m_pConfig, m_pEncoderPool));
     m_pNetworkStream->addOutputWorker(connection);
 
     connect(profile.data(), SIGNAL(connectionStatusChanged(int)),
@@ -187,7 +188,7 @@ bool BroadcastManager::removeConnection(BroadcastProfilePtr profile) {
 ShoutConnectionPtr BroadcastManager::findConnectionForProfile(BroadcastProfilePtr profile) {
     QVector<NetworkOutputStreamWorkerPtr> workers = m_pNetworkStream->outputWorkers();
     for(NetworkOutputStreamWorkerPtr pWorker : workers) {
-        ShoutConnectionPtr connection = qSharedPointerCast<ShoutConnection>(pWorker);
+        ShoutConnectionPtr connection = qSharedPointerDynamicCast<ShoutConnection>(pWorker);
         if(connection.isNull())
             continue;
 
@@ -3,6 +3,7 @@
 
 #include <QObject>
 
+#include "broadcast/sharedencoder.h"
 #include "preferences/settingsmanager.h"
 #include "preferences/usersettings.h"
 #include "engine/sidechain/enginenetworkstream.h"
@@ -52,6 +53,8 @@ class BroadcastManager : public QObject {
     UserSettingsPointer m_pConfig;
     BroadcastSettingsPointer m_pBroadcastSettings;
     QSharedPointer<EngineNetworkStream> m_pNetworkStream;
+    // The MP3 encoders that are shared by the connections
+    SharedEncoderPoolPointer m_pEncoderPool;
 
     ControlPushButton* m_pBroadcastEnabled;
     ControlObject* m_pStatusCO;
@@ -0,0 +1,98 @@
+#include "broadcast/sharedencoder.h"
+
+#include <QMutexLocker>
+
+#include "util/assert.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SharedEncoder");
+
+} // anonymous namespace
+
+SharedEncoder::SharedEncoder(const QString& key)
+        : m_key(key),
+          m_pFeeder(nullptr) {
+}
+
+SharedEncoder::~SharedEncoder() {
+    DEBUG_ASSERT(m_subscribers.isEmpty());
+    // The encoder may write its remaining packets, which are dropped
+    m_pEncoder.reset();
+}
+
+void SharedEncoder::setEncoder(EncoderPointer pEncoder) {
+    QMutexLocker locker(&m_mutex);
+    m_pEncoder = pEncoder;
+}
+
+void SharedEncoder::subscribe(SharedEncoderSubscriber* pSubscriber) {
+    QMutexLocker locker(&m_mutex);
+    DEBUG_ASSERT(!m_subscribers.contains(pSubscriber));
+    m_subscribers.append(pSubscriber);
+    kLogger.debug() << m_key << "has" << m_subscribers.size() << "subscribers";
+}
+
+void SharedEncoder::unsubscribe(SharedEncoderSubscriber* pSubscriber) {
+    QMutexLocker locker(&m_mutex);
+    m_subscribers.removeOne(pSubscriber);
+    if (m_pFeeder == pSubscriber) {
+        // The next subscriber that encodes takes over
+        m_pFeeder = nullptr;
+    }
+}
+
+void SharedEncoder::encodeBuffer(SharedEncoderSubscriber* pSubscriber,
+        const CSAMPLE* pBuffer, int iBufferSize) {
+    QMutexLocker locker(&m_mutex);
+    if (!m_pEncoder) {
+        return;
+    }
+    if (!m_pFeeder) {
+        m_pFeeder = pSubscriber;
+    } else if (m_pFeeder != pSubscriber) {
+        return;
+    }
+    // The packets are received by write()
+    m_pEncoder->encodeBuffer(pBuffer, iBufferSize);
+}
+
+void SharedEncoder::write(const unsigned char* header, const unsigned char* body,
+                          int headerLen, int bodyLen) {
+    // Called by the encoder while m_mutex is locked
+    if (m_subscribers.isEmpty() || headerLen + bodyLen <= 0) {
+        return;
+    }
+    writePacket(EncodedPacketPool::instance()->copy(
+            header, body, headerLen, bodyLen));
+}
+
+void SharedEncoder::writePacket(const EncodedPacketPointer& pPacket) {
+    // Called by the encoder while m_mutex is locked
+    if (m_subscribers.isEmpty() || pPacket->size() <= 0) {
+        return;
+    }
+    for (SharedEncoderSubscriber* pSubscriber : m_subscribers) {
+        pSubscriber->receivePacket(pPacket);
+    }
+}
+
+SharedEncoderPointer SharedEncoderPool::subscribe(const QString& key,
+        SharedEncoderSubscriber* pSubscriber,
+        const std::function<EncoderPointer(EncoderCallback*)>& createEncoder) {
+    QMutexLocker locker(&m_mutex);
+    SharedEncoderPointer pSharedEncoder = m_encoders.value(key).toStrongRef();
+    if (!pSharedEncoder) {
+        pSharedEncoder = SharedEncoderPointer::create(key);
+        EncoderPointer pEncoder = createEncoder(pSharedEncoder.data());
+        if (!pEncoder) {
+            return SharedEncoderPointer();
+        }
+        pSharedEncoder->setEncoder(pEncoder);
+        m_encoders.insert(key, pSharedEncoder);
+        kLogger.debug() << "Created encoder" << key;
+    }
+    pSharedEncoder->subscribe(pSubscriber);
+    return pSharedEncoder;
+}
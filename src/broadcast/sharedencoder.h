@@ -0,0 +1,110 @@
+#ifndef BROADCAST_SHAREDENCODER_H
+#define BROADCAST_SHAREDENCODER_H
+
+#include <functional>
+
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+#include <QWeakPointer>
+
+#include "encoder/encodedpacket.h"
+#include "encoder/encoder.h"
+#include "encoder/encodercallback.h"
+#include "util/class.h"
+#include "util/types.h"
+
+// Receives the encoded packets of a SharedEncoder. The packets are
+// reference counted, so every subscriber holds a reference to the same
+// data and the packet returns to its pool when the last one has sent it.
+class SharedEncoderSubscriber {
+  public:
+    virtual ~SharedEncoderSubscriber() {}
+    // Called from the thread that feeds the encoder
+    virtual void receivePacket(const EncodedPacketPointer& pPacket) = 0;
+};
+
+// One encoder for the broadcast connections that stream the master mix with
+// the same codec settings. Each connection receives the mix from its own
+// FIFO, but only the samples of one subscriber are encoded: The first one
+// that passes its samples feeds the encoder until it unsubscribes. Then the
+// next one takes over.
+//
+// This only works for formats whose stream can be joined at any packet,
+// i.e. MP3. An Ogg stream starts with header packets that a connection
+// could miss.
+class SharedEncoder : public EncoderCallback {
+  public:
+    explicit SharedEncoder(const QString& key);
+    ~SharedEncoder() override;
+
+    const QString& key() const {
+        return m_key;
+    }
+
+    // Takes the ownership of an initialized encoder that writes to this
+    void setEncoder(EncoderPointer pEncoder);
+
+    void subscribe(SharedEncoderSubscriber* pSubscriber);
+    void unsubscribe(SharedEncoderSubscriber* pSubscriber);
+
+    // Encodes the samples if the subscriber feeds the encoder or if there
+    // is no feeder yet, otherwise ignores them. The packets are passed to
+    // all subscribers before this returns.
+    void encodeBuffer(SharedEncoderSubscriber* pSubscriber,
+            const CSAMPLE* pBuffer, int iBufferSize);
+
+    // Copies the data into a packet for encoders that do not write packets
+    void write(const unsigned char* header, const unsigned char* body,
+               int headerLen, int bodyLen) override;
+    void writePacket(const EncodedPacketPointer& pPacket) override;
+    // The stream position is not used for streaming
+    int tell() override {
+        return -1;
+    }
+    void seek(int pos) override {
+        Q_UNUSED(pos);
+    }
+    int filelen() override {
+        return 0;
+    }
+
+  private:
+    const QString m_key;
+    // Guards the subscribers and serializes the encoding
+    QMutex m_mutex;
+    QVector<SharedEncoderSubscriber*> m_subscribers;
+    SharedEncoderSubscriber* m_pFeeder;
+    EncoderPointer m_pEncoder;
+
+    DISALLOW_COPY_AND_ASSIGN(SharedEncoder);
+};
+
+typedef QSharedPointer<SharedEncoder> SharedEncoderPointer;
+
+// The shared encoders of the broadcast connections by their codec settings.
+// An encoder is deleted when the last connection has released it.
+//
+// The functions may be called from the threads of all connections.
+class SharedEncoderPool {
+  public:
+    SharedEncoderPool() {}
+
+    // Returns the encoder for the key and subscribes to it. A new encoder
+    // is created by createEncoder, which returns a null pointer if the
+    // encoder could not be initialized.
+    SharedEncoderPointer subscribe(const QString& key,
+            SharedEncoderSubscriber* pSubscriber,
+            const std::function<EncoderPointer(EncoderCallback*)>& createEncoder);
+
+  private:
+    QMutex m_mutex;
+    QHash<QString, QWeakPointer<SharedEncoder>> m_encoders;
+
+    DISALLOW_COPY_AND_ASSIGN(SharedEncoderPool);
+};
+
+typedef QSharedPointer<SharedEncoderPool> SharedEncoderPoolPointer;
+
+#endif // BROADCAST_SHAREDENCODER_H
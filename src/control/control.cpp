@@ -3,18 +3,37 @@
 
 #include "control/control.h"
 
+#include "control/controlcoalescer.h"
+#include "util/compatibility.h"
 #include "util/stat.h"
 
 // Static member variable definition
 UserSettingsPointer ControlDoublePrivate::s_pUserConfig;
 
-QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> > ControlDoublePrivate::s_qCOHash
+QHash<InternedConfigKey, QWeakPointer<ControlDoublePrivate> > ControlDoublePrivate::s_qCOHash
 GUARDED_BY(ControlDoublePrivate::s_qCOHashMutex);
 
 QHash<ConfigKey, ConfigKey> ControlDoublePrivate::s_qCOAliasHash
 GUARDED_BY(ControlDoublePrivate::s_qCOHashMutex);
 
-MMutex ControlDoublePrivate::s_qCOHashMutex;
+QHash<InternedConfigKey, ControlHandle> ControlDoublePrivate::s_qCOHandleHash
+GUARDED_BY(ControlDoublePrivate::s_qCOHashMutex);
+
+int ControlDoublePrivate::s_iNextHandle
+GUARDED_BY(ControlDoublePrivate::s_qCOHashMutex) = 0;
+
+MMutex ControlDoublePrivate::s_qCOHashMutex("ControlDoublePrivate hash");
+
+const int ControlDoublePrivate::kMaxHandles;
+
+QAtomicPointer<ControlDoublePrivate>
+ControlDoublePrivate::s_controlsByHandle[ControlDoublePrivate::kMaxHandles];
+
+ControlValueAtomic<double>
+ControlDoublePrivate::s_valuesByHandle[ControlDoublePrivate::kMaxHandles];
+
+bool ControlDoublePrivate::s_valueSlotInUse[ControlDoublePrivate::kMaxHandles]
+GUARDED_BY(ControlDoublePrivate::s_qCOHashMutex);
 
 /*
 ControlDoublePrivate::ControlDoublePrivate()
@@ -28,11 +47,14 @@ ControlDoublePrivate::ControlDoublePrivate()
 }
 */
 
-ControlDoublePrivate::ControlDoublePrivate(ConfigKey key,
+ControlDoublePrivate::ControlDoublePrivate(InternedConfigKey key,
+                                           ControlHandle handle,
+                                           ControlValueAtomic<double>* pValue,
                                            ControlObject* pCreatorCO,
                                            bool bIgnoreNops, bool bTrack,
                                            bool bPersist, double defaultValue)
         : m_key(key),
+          m_handle(handle),
           m_bPersistInConfiguration(bPersist),
           m_bIgnoreNops(bIgnoreNops),
           m_bTrack(bTrack),
@@ -40,7 +62,12 @@ ControlDoublePrivate::ControlDoublePrivate(ConfigKey key,
           m_trackFlags(Stat::COUNT | Stat::SUM | Stat::AVERAGE |
                        Stat::SAMPLE_VARIANCE | Stat::MIN | Stat::MAX),
           m_confirmRequired(false),
+          m_pValue(pValue),
           m_pCreatorCO(pCreatorCO) {
+    if (!m_pValue) {
+        m_pOwnValue = std::make_unique<ControlValueAtomic<double>>();
+        m_pValue = m_pOwnValue.get();
+    }
     initialize(defaultValue);
 }
 
@@ -49,43 +76,56 @@ void ControlDoublePrivate::initialize(double defaultValue) {
     if (m_bPersistInConfiguration) {
         UserSettingsPointer pConfig = ControlDoublePrivate::s_pUserConfig;
         if (pConfig != nullptr) {
-            value = pConfig->getValue(m_key, defaultValue);
+            value = pConfig->getValue(m_key.key(), defaultValue);
         }
     }
     m_defaultValue.setValue(defaultValue);
-    m_value.setValue(value);
+    m_pValue->setValue(value);
 
-    //qDebug() << "Creating:" << m_trackKey << "at" << &m_value << sizeof(m_value);
+    //qDebug() << "Creating:" << m_trackKey << "at" << m_pValue << sizeof(*m_pValue);
 
     if (m_bTrack) {
         // TODO(rryan): Make configurable.
-        m_trackKey = "control " + m_key.group + "," + m_key.item;
+        m_trackKey = "control " + m_key.key().group + "," + m_key.key().item;
         Stat::track(m_trackKey, static_cast<Stat::StatType>(m_trackType),
                     static_cast<Stat::ComputeFlags>(m_trackFlags),
-                    m_value.getValue());
+                    m_pValue->getValue());
     }
 }
 
 ControlDoublePrivate::~ControlDoublePrivate() {
     s_qCOHashMutex.lock();
-    //qDebug() << "ControlDoublePrivate::s_qCOHash.remove(" << m_key.group << "," << m_key.item << ")";
+    //qDebug() << "ControlDoublePrivate::s_qCOHash.remove(" << m_key << ")";
     s_qCOHash.remove(m_key);
+    // A new control for the key may have been published already
+    if (m_handle.valid()) {
+        s_controlsByHandle[m_handle.handle()].testAndSetOrdered(this, NULL);
+    }
+    foreach (const ControlHandle& aliasHandle, m_aliasHandles) {
+        s_controlsByHandle[aliasHandle.handle()].testAndSetOrdered(this, NULL);
+    }
+    const double value = get();
+    if (!m_pOwnValue) {
+        s_valueSlotInUse[m_handle.handle()] = false;
+    }
     s_qCOHashMutex.unlock();
 
     if (m_bPersistInConfiguration) {
         UserSettingsPointer pConfig = ControlDoublePrivate::s_pUserConfig;
         if (pConfig != NULL) {
-            pConfig->set(m_key, QString::number(get()));
+            pConfig->set(m_key.key(), QString::number(value));
         }
     }
 }
 
 // static
 void ControlDoublePrivate::insertAlias(const ConfigKey& alias, const ConfigKey& key) {
+    const InternedConfigKey internedAlias(alias);
+    const InternedConfigKey internedKey(key);
     MMutexLocker locker(&s_qCOHashMutex);
 
-    QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> >::const_iterator it =
-            s_qCOHash.find(key);
+    QHash<InternedConfigKey, QWeakPointer<ControlDoublePrivate> >::const_iterator it =
+            s_qCOHash.find(internedKey);
     if (it == s_qCOHash.end()) {
         qWarning() << "WARNING: ControlDoublePrivate::insertAlias called for null control" << key;
         return;
@@ -98,14 +138,80 @@ void ControlDoublePrivate::insertAlias(const ConfigKey& alias, const ConfigKey&
     }
 
     s_qCOAliasHash.insert(key, alias);
-    s_qCOHash.insert(alias, pControl);
+    s_qCOHash.insert(internedAlias, pControl);
+
+    publishHandleLocked(getOrCreateHandleLocked(internedAlias), internedAlias,
+                        pControl.data());
+}
+
+// static
+ControlHandle ControlDoublePrivate::getHandle(const InternedConfigKey& key) {
+    if (key.key().isEmpty()) {
+        return ControlHandle();
+    }
+    MMutexLocker locker(&s_qCOHashMutex);
+    ControlHandle handle = getOrCreateHandleLocked(key);
+    if (handle.valid() && !s_controlsByHandle[handle.handle()].load()) {
+        // The handle is new or its control has been deleted, publish the
+        // control of the key if there is one.
+        QHash<InternedConfigKey, QWeakPointer<ControlDoublePrivate> >::const_iterator it =
+                s_qCOHash.find(key);
+        if (it != s_qCOHash.end()) {
+            QSharedPointer<ControlDoublePrivate> pControl = it.value();
+            if (pControl) {
+                publishHandleLocked(handle, key, pControl.data());
+            }
+        }
+    }
+    return handle;
+}
+
+// static
+ControlHandle ControlDoublePrivate::getOrCreateHandleLocked(const InternedConfigKey& key) {
+    QHash<InternedConfigKey, ControlHandle>::const_iterator it =
+            s_qCOHandleHash.find(key);
+    if (it != s_qCOHandleHash.end()) {
+        return it.value();
+    }
+    if (s_iNextHandle >= kMaxHandles) {
+        qWarning() << "ControlDoublePrivate::getHandle out of handles for" << key;
+        return ControlHandle();
+    }
+    ControlHandle handle(s_iNextHandle++);
+    s_qCOHandleHash.insert(key, handle);
+    return handle;
+}
+
+// static
+ControlValueAtomic<double>* ControlDoublePrivate::claimValueLocked(
+        const ControlHandle& handle) {
+    if (!handle.valid() || s_valueSlotInUse[handle.handle()]) {
+        return NULL;
+    }
+    s_valueSlotInUse[handle.handle()] = true;
+    return &s_valuesByHandle[handle.handle()];
+}
+
+// static
+void ControlDoublePrivate::publishHandleLocked(const ControlHandle& handle,
+                                               const InternedConfigKey& key,
+                                               ControlDoublePrivate* pControl) {
+    if (!handle.valid()) {
+        return;
+    }
+    // Remember the handles of aliases so that they are cleared when the
+    // control is deleted.
+    if (pControl->m_key != key && !pControl->m_aliasHandles.contains(handle)) {
+        pControl->m_aliasHandles.append(handle);
+    }
+    s_controlsByHandle[handle.handle()].storeRelease(pControl);
 }
 
 // static
 QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
-        const ConfigKey& key, bool warn, ControlObject* pCreatorCO,
+        const InternedConfigKey& key, bool warn, ControlObject* pCreatorCO,
         bool bIgnoreNops, bool bTrack, bool bPersist, double defaultValue) {
-    if (key.isEmpty()) {
+    if (key.key().isEmpty()) {
         if (warn) {
             qWarning() << "ControlDoublePrivate::getControl returning NULL"
                        << "for empty ConfigKey.";
@@ -118,12 +224,12 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
     // Scope for MMutexLocker.
     {
         MMutexLocker locker(&s_qCOHashMutex);
-        QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> >::const_iterator it = s_qCOHash.find(key);
+        QHash<InternedConfigKey, QWeakPointer<ControlDoublePrivate> >::const_iterator it = s_qCOHash.find(key);
 
         if (it != s_qCOHash.end()) {
             if (pCreatorCO) {
                 if (warn) {
-                    qDebug() << "ControlObject" << key.group << key.item << "already created";
+                    qDebug() << "ControlObject" << key << "already created";
                 }
             } else {
                 pControl = it.value();
@@ -133,15 +239,26 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
 
     if (pControl == NULL) {
         if (pCreatorCO) {
+            ControlHandle handle;
+            ControlValueAtomic<double>* pValue;
+            {
+                MMutexLocker locker(&s_qCOHashMutex);
+                handle = getOrCreateHandleLocked(key);
+                pValue = claimValueLocked(handle);
+            }
+            // The value may be loaded from the configuration, so the control
+            // is created without holding the mutex.
             pControl = QSharedPointer<ControlDoublePrivate>(
-                    new ControlDoublePrivate(key, pCreatorCO, bIgnoreNops,
+                    new ControlDoublePrivate(key, handle, pValue,
+                                             pCreatorCO, bIgnoreNops,
                                              bTrack, bPersist, defaultValue));
             MMutexLocker locker(&s_qCOHashMutex);
-            //qDebug() << "ControlDoublePrivate::s_qCOHash.insert(" << key.group << "," << key.item << ")";
+            //qDebug() << "ControlDoublePrivate::s_qCOHash.insert(" << key << ")";
             s_qCOHash.insert(key, pControl);
+            publishHandleLocked(handle, key, pControl.data());
         } else if (warn) {
             qWarning() << "ControlDoublePrivate::getControl returning NULL for ("
-                       << key.group << "," << key.item << ")";
+                       << key << ")";
         }
     }
     return pControl;
@@ -152,7 +269,7 @@ void ControlDoublePrivate::getControls(
         QList<QSharedPointer<ControlDoublePrivate> >* pControlList) {
     s_qCOHashMutex.lock();
     pControlList->clear();
-    for (QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> >::const_iterator it = s_qCOHash.begin();
+    for (QHash<InternedConfigKey, QWeakPointer<ControlDoublePrivate> >::const_iterator it = s_qCOHash.begin();
              it != s_qCOHash.end(); ++it) {
         QSharedPointer<ControlDoublePrivate> pControl = it.value();
         if (!pControl.isNull()) {
@@ -197,7 +314,11 @@ void ControlDoublePrivate::setInner(double value, QObject* pSender) {
     if (m_bIgnoreNops && get() == value) {
         return;
     }
-    m_value.setValue(value);
+    m_pValue->setValue(value);
+    if (load_atomic(m_coalescedConnections) > 0) {
+        m_pLastCoalescedSender.storeRelease(pSender);
+        ControlCoalescer::markDirty(m_handle);
+    }
     emit(valueChanged(value, pSender));
 
     if (m_bTrack) {
@@ -7,8 +7,11 @@
 #include <QAtomicPointer>
 
 #include "control/controlbehavior.h"
+#include "control/controlhandle.h"
 #include "control/controlvalue.h"
+#include "control/internedconfigkey.h"
 #include "preferences/usersettings.h"
+#include "util/memory.h"
 #include "util/mutex.h"
 
 class ControlObject;
@@ -16,6 +19,9 @@ class ControlObject;
 class ControlDoublePrivate : public QObject {
     Q_OBJECT
   public:
+    // The maximum number of handles that are assigned
+    static const int kMaxHandles = 65536;
+
     virtual ~ControlDoublePrivate();
 
     // Used to implement control persistence. All controls that are marked
@@ -34,9 +40,35 @@ class ControlDoublePrivate : public QObject {
     // is non-NULL, allocates a new ControlDoublePrivate for the ConfigKey if
     // one does not exist.
     static QSharedPointer<ControlDoublePrivate> getControl(
-            const ConfigKey& key, bool warn = true,
+            const InternedConfigKey& key, bool warn = true,
             ControlObject* pCreatorCO = NULL, bool bIgnoreNops = true, bool bTrack = false,
             bool bPersist = false, double defaultValue = 0.0);
+    static QSharedPointer<ControlDoublePrivate> getControl(
+            const ConfigKey& key, bool warn = true,
+            ControlObject* pCreatorCO = NULL, bool bIgnoreNops = true, bool bTrack = false,
+            bool bPersist = false, double defaultValue = 0.0) {
+        return getControl(InternedConfigKey(key), warn, pCreatorCO,
+                          bIgnoreNops, bTrack, bPersist, defaultValue);
+    }
+
+    // Returns the handle of the given ConfigKey, assigning a new one if the
+    // key has none yet. Returns an invalid handle for an empty ConfigKey or
+    // if all kMaxHandles handles have been assigned.
+    static ControlHandle getHandle(const InternedConfigKey& key);
+    static ControlHandle getHandle(const ConfigKey& key) {
+        return getHandle(InternedConfigKey(key));
+    }
+
+    // Returns the control that currently exists for the handle or NULL. This
+    // does not lock and can be called from any thread. Like the ControlObject
+    // returned by ControlObject::getControl(), the control is only valid as
+    // long as it is not deleted.
+    static ControlDoublePrivate* getControlByHandle(const ControlHandle& handle) {
+        if (!handle.valid()) {
+            return NULL;
+        }
+        return s_controlsByHandle[handle.handle()].loadAcquire();
+    }
 
     // Adds all ControlDoublePrivate that currently exist to pControlList
     static void getControls(QList<QSharedPointer<ControlDoublePrivate> >* pControlsList);
@@ -66,7 +98,7 @@ class ControlDoublePrivate : public QObject {
     void setAndConfirm(double value, QObject* pSender);
     // Gets the control value.
     inline double get() const {
-        return m_value.getValue();
+        return m_pValue->getValue();
     }
     // Resets the control value to its default.
     void reset();
@@ -105,10 +137,33 @@ class ControlDoublePrivate : public QObject {
         m_pCreatorCO = NULL;
     }
 
-    inline ConfigKey getKey() {
+    inline ConfigKey getKey() const {
+        return m_key.key();
+    }
+
+    inline const InternedConfigKey& getInternedKey() const {
         return m_key;
     }
 
+    inline const ControlHandle& getHandle() const {
+        return m_handle;
+    }
+
+    // Counts the ControlProxys that receive the value changes through the
+    // ControlCoalescer instead of valueChanged().
+    void addCoalescedConnection() {
+        m_coalescedConnections.ref();
+    }
+    void removeCoalescedConnection() {
+        m_coalescedConnections.deref();
+    }
+
+    // The sender of the last change that has been passed to the
+    // ControlCoalescer.
+    QObject* lastCoalescedSender() const {
+        return m_pLastCoalescedSender.loadAcquire();
+    }
+
     // Connects a slot to the ValueChange request for CO validation. All change
     // requests issued by set are routed though the connected slot. This can
     // decide with its own thread safe solution if the requested value can be
@@ -125,13 +180,28 @@ class ControlDoublePrivate : public QObject {
     void valueChangeRequest(double value);
 
   private:
-    ControlDoublePrivate(ConfigKey key, ControlObject* pCreatorCO,
+    ControlDoublePrivate(InternedConfigKey key, ControlHandle handle,
+                         ControlValueAtomic<double>* pValue,
+                         ControlObject* pCreatorCO,
                          bool bIgnoreNops, bool bTrack, bool bPersist,
                          double defaultValue);
     void initialize(double defaultValue);
     void setInner(double value, QObject* pSender);
 
-    ConfigKey m_key;
+    // All must be called with s_qCOHashMutex held.
+    static ControlHandle getOrCreateHandleLocked(const InternedConfigKey& key);
+    // Returns the value slot of the handle if no other control uses it
+    static ControlValueAtomic<double>* claimValueLocked(const ControlHandle& handle);
+    // Makes pControl the control of the handle of key, which is either the
+    // key of pControl or one of its aliases.
+    static void publishHandleLocked(const ControlHandle& handle,
+                                    const InternedConfigKey& key,
+                                    ControlDoublePrivate* pControl);
+
+    InternedConfigKey m_key;
+    ControlHandle m_handle;
+    // The handles of the aliases of this control
+    QList<ControlHandle> m_aliasHandles;
 
     // Whether the control should persist in the Mixxx user configuration. The
     // value is loaded from configuration when the control is created and
@@ -154,8 +224,14 @@ class ControlDoublePrivate : public QObject {
     int m_trackFlags;
     bool m_confirmRequired;
 
-    // The control value.
-    ControlValueAtomic<double> m_value;
+    QAtomicInt m_coalescedConnections;
+    QAtomicPointer<QObject> m_pLastCoalescedSender;
+
+    // The control value. Points into s_valuesByHandle or to m_pOwnValue, if
+    // the control has no handle or another control with the same key still
+    // exists.
+    ControlValueAtomic<double>* m_pValue;
+    std::unique_ptr<ControlValueAtomic<double>> m_pOwnValue;
     // The default control value.
     ControlValueAtomic<double> m_defaultValue;
 
@@ -172,13 +248,27 @@ class ControlDoublePrivate : public QObject {
     static UserSettingsPointer s_pUserConfig;
 
     // Hash of ControlDoublePrivate instantiations.
-    static QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> > s_qCOHash;
+    static QHash<InternedConfigKey, QWeakPointer<ControlDoublePrivate> > s_qCOHash;
     // Hash of aliases between ConfigKeys. Solely used for looking up the first
     // alias associated with a key.
     static QHash<ConfigKey, ConfigKey> s_qCOAliasHash;
 
-    // Mutex guarding access to s_qCOHash and s_qCOAliasHash.
+    // The handle of each ConfigKey that has ever been looked up by handle,
+    // registered or aliased.
+    static QHash<InternedConfigKey, ControlHandle> s_qCOHandleHash;
+    static int s_iNextHandle;
+
+    // Mutex guarding access to s_qCOHash, s_qCOAliasHash, s_qCOHandleHash,
+    // s_valueSlotInUse and writes to s_controlsByHandle.
     static MMutex s_qCOHashMutex;
+
+    // The control of each handle, indexed by ControlHandle::handle()
+    static QAtomicPointer<ControlDoublePrivate> s_controlsByHandle[kMaxHandles];
+    // The values of the controls, indexed by ControlHandle::handle(). The
+    // controls of a deck or an effect are created together and get adjacent
+    // handles, so the engine reads their values from a few cache lines.
+    static ControlValueAtomic<double> s_valuesByHandle[kMaxHandles];
+    static bool s_valueSlotInUse[kMaxHandles];
 };
 
 
@@ -0,0 +1,98 @@
+#include "control/controlcoalescer.h"
+
+#include <QThread>
+
+#include "control/controlproxy.h"
+#include "util/assert.h"
+
+ControlCoalescer* ControlCoalescer::s_pInstance = NULL;
+
+const int ControlCoalescer::kEndOfList;
+QAtomicInt ControlCoalescer::s_dirtyHead(ControlCoalescer::kEndOfList);
+QAtomicInt ControlCoalescer::s_dirty[ControlDoublePrivate::kMaxHandles];
+int ControlCoalescer::s_nextDirty[ControlDoublePrivate::kMaxHandles];
+
+ControlCoalescer::ControlCoalescer(QObject* pParent)
+        : QObject(pParent) {
+    DEBUG_ASSERT(s_pInstance == NULL);
+    s_pInstance = this;
+    m_pGuiTickTime = new ControlProxy("[Master]", "guiTickTime", this);
+    // guiTickTime is set by the VSyncThread, so this is a queued connection
+    // that delivers the values in the main thread.
+    m_pGuiTickTime->connectValueChanged(SLOT(slotGuiTick(double)));
+}
+
+ControlCoalescer::~ControlCoalescer() {
+    s_pInstance = NULL;
+}
+
+// static
+void ControlCoalescer::markDirty(const ControlHandle& handle) {
+    if (!handle.valid()) {
+        return;
+    }
+    const int iHandle = handle.handle();
+    if (!s_dirty[iHandle].testAndSetAcquire(0, 1)) {
+        // Already in the list
+        return;
+    }
+    int head;
+    do {
+        head = s_dirtyHead.load();
+        s_nextDirty[iHandle] = head;
+    } while (!s_dirtyHead.testAndSetRelease(head, iHandle));
+}
+
+void ControlCoalescer::addProxy(ControlProxy* pProxy,
+                                const ControlHandle& handle) {
+    DEBUG_ASSERT(QThread::currentThread() == thread());
+    m_proxiesByHandle[handle.handle()].append(pProxy);
+}
+
+void ControlCoalescer::removeProxy(ControlProxy* pProxy,
+                                   const ControlHandle& handle) {
+    DEBUG_ASSERT(QThread::currentThread() == thread());
+    QHash<int, QList<ControlProxy*> >::iterator it =
+            m_proxiesByHandle.find(handle.handle());
+    if (it == m_proxiesByHandle.end()) {
+        return;
+    }
+    it.value().removeAll(pProxy);
+    if (it.value().isEmpty()) {
+        m_proxiesByHandle.erase(it);
+    }
+}
+
+void ControlCoalescer::slotGuiTick(double) {
+    flush();
+}
+
+void ControlCoalescer::flush() {
+    int iHandle = s_dirtyHead.fetchAndStoreAcquire(kEndOfList);
+    while (iHandle != kEndOfList) {
+        // Read the link before the handle can be pushed again
+        const int iNextHandle = s_nextDirty[iHandle];
+        s_dirty[iHandle].storeRelease(0);
+
+        QHash<int, QList<ControlProxy*> >::const_iterator it =
+                m_proxiesByHandle.constFind(iHandle);
+        if (it != m_proxiesByHandle.constEnd()) {
+            // A proxy may disconnect itself while handling the change
+            const QList<ControlProxy*> proxies = it.value();
+            QObject* pSender = NULL;
+            ControlDoublePrivate* pControl =
+                    ControlDoublePrivate::getControlByHandle(
+                            proxies.first()->getHandle());
+            if (pControl) {
+                pSender = pControl->lastCoalescedSender();
+            }
+            foreach (ControlProxy* pProxy, proxies) {
+                if (pProxy != pSender &&
+                        m_proxiesByHandle.value(iHandle).contains(pProxy)) {
+                    pProxy->emitValueChanged();
+                }
+            }
+        }
+        iHandle = iNextHandle;
+    }
+}
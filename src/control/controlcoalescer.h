@@ -0,0 +1,67 @@
+#ifndef CONTROLCOALESCER_H
+#define CONTROLCOALESCER_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QObject>
+
+#include "control/control.h"
+#include "util/class.h"
+
+class ControlProxy;
+
+// Delivers the value changes of controls to ControlProxys that have been
+// connected with ControlProxy::connectValueChangedCoalesced() at most once
+// per GUI frame. When a control that has such connections is set, its handle
+// is pushed to a lock-free list of dirty controls, which is cheap enough to
+// do from the engine. Once per frame (on [Master],guiTickTime) the list is
+// taken in the main thread and each connected proxy emits the latest value,
+// no matter how often the control has been set in between.
+//
+// There is a single instance, created by MixxxMainWindow. Without it,
+// coalesced connections fall back to regular connections.
+class ControlCoalescer : public QObject {
+    Q_OBJECT
+  public:
+    ControlCoalescer(QObject* pParent = NULL);
+    ~ControlCoalescer() override;
+
+    static ControlCoalescer* instance() {
+        return s_pInstance;
+    }
+
+    // Called from ControlDoublePrivate whenever a control with coalesced
+    // connections has been set. May be called from any thread, does not lock
+    // or allocate.
+    static void markDirty(const ControlHandle& handle);
+
+    // Must be called from the main thread.
+    void addProxy(ControlProxy* pProxy, const ControlHandle& handle);
+    void removeProxy(ControlProxy* pProxy, const ControlHandle& handle);
+
+  public slots:
+    // Delivers the latest value of every control that has been set since
+    // the last call.
+    void flush();
+
+  private slots:
+    void slotGuiTick(double);
+
+  private:
+    static ControlCoalescer* s_pInstance;
+
+    static const int kEndOfList = -1;
+    static QAtomicInt s_dirtyHead;
+    // Set while a handle is in the dirty list, so it is only pushed once
+    static QAtomicInt s_dirty[ControlDoublePrivate::kMaxHandles];
+    // The next handle of the dirty list for each handle in the list
+    static int s_nextDirty[ControlDoublePrivate::kMaxHandles];
+
+    QHash<int, QList<ControlProxy*> > m_proxiesByHandle;
+    ControlProxy* m_pGuiTickTime;
+
+    DISALLOW_COPY_AND_ASSIGN(ControlCoalescer);
+};
+
+#endif /* CONTROLCOALESCER_H */
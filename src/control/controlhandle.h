@@ -0,0 +1,58 @@
+#ifndef CONTROLHANDLE_H
+#define CONTROLHANDLE_H
+// ControlHandle is a stable identifier for the control of a ConfigKey. Looking
+// up a control by its ConfigKey hashes both strings of the key and takes the
+// global control mutex. Code that accesses the same controls repeatedly, e.g.
+// when dispatching controller messages, can instead resolve the ConfigKey to
+// a ControlHandle once and then get the control for it in O(1) without
+// locking.
+//
+// Handles are numbered densely starting at 0. A ConfigKey keeps its handle
+// for the lifetime of the process, even if its control is deleted and created
+// again, and a handle can be obtained before the control exists.
+
+#include <QtDebug>
+#include <QHash>
+
+// A wrapper around an integer handle, see ControlDoublePrivate::getHandle().
+class ControlHandle {
+  public:
+    ControlHandle() : m_iHandle(-1) {
+    }
+
+    inline bool valid() const {
+        return m_iHandle >= 0;
+    }
+
+    inline int handle() const {
+        return m_iHandle;
+    }
+
+  private:
+    explicit ControlHandle(int iHandle)
+            : m_iHandle(iHandle) {
+    }
+
+    int m_iHandle;
+
+    friend class ControlDoublePrivate;
+};
+
+inline bool operator==(const ControlHandle& h1, const ControlHandle& h2) {
+    return h1.handle() == h2.handle();
+}
+
+inline bool operator!=(const ControlHandle& h1, const ControlHandle& h2) {
+    return h1.handle() != h2.handle();
+}
+
+inline QDebug operator<<(QDebug stream, const ControlHandle& h) {
+    stream << "ControlHandle(" << h.handle() << ")";
+    return stream;
+}
+
+inline uint qHash(const ControlHandle& handle) {
+    return qHash(handle.handle());
+}
+
+#endif /* CONTROLHANDLE_H */
@@ -0,0 +1,62 @@
+#include "control/controlinputtime.h"
+
+#include <QThreadStorage>
+
+#include "util/math.h"
+#include "util/time.h"
+
+namespace {
+
+// The arrival time of the input that the thread handles, 0 if none
+QThreadStorage<qint64> s_inputNanos;
+
+} // anonymous namespace
+
+//static
+QAtomicInteger<qint64> ControlInputTime::s_previousCallbackNanos(0);
+QAtomicInteger<qint64> ControlInputTime::s_currentCallbackNanos(0);
+
+ControlInputTime::Scope::Scope(mixxx::Duration timestamp)
+        : m_previousNanos(s_inputNanos.localData()) {
+    const qint64 nowNanos = mixxx::Time::elapsed().toIntegerNanos();
+    qint64 inputNanos = timestamp.toIntegerNanos();
+    if (inputNanos <= 0 || inputNanos > nowNanos) {
+        inputNanos = nowNanos;
+    }
+    s_inputNanos.setLocalData(inputNanos);
+}
+
+ControlInputTime::Scope::~Scope() {
+    s_inputNanos.setLocalData(m_previousNanos);
+}
+
+//static
+qint64 ControlInputTime::currentNanos() {
+    if (!s_inputNanos.hasLocalData()) {
+        return 0;
+    }
+    return s_inputNanos.localData();
+}
+
+//static
+void ControlInputTime::engineCallbackStarted(mixxx::Duration now) {
+    s_previousCallbackNanos.store(s_currentCallbackNanos.load());
+    s_currentCallbackNanos.store(now.toIntegerNanos());
+}
+
+//static
+SINT ControlInputTime::frameOffsetInCallback(qint64 inputNanos,
+        SINT bufferFrames) {
+    const qint64 previousNanos = s_previousCallbackNanos.load();
+    const qint64 currentNanos = s_currentCallbackNanos.load();
+    if (inputNanos <= 0 || previousNanos <= 0 || bufferFrames <= 0 ||
+            inputNanos < previousNanos || inputNanos >= currentNanos) {
+        return 0;
+    }
+    // The length of each period varies with the scheduling of the sound
+    // device, so the input is placed relative to the measured period
+    const qint64 periodNanos = currentNanos - previousNanos;
+    const SINT frame = static_cast<SINT>(
+            (inputNanos - previousNanos) * bufferFrames / periodNanos);
+    return math_clamp<SINT>(frame, 0, bufferFrames - 1);
+}
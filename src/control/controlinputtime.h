@@ -0,0 +1,57 @@
+#ifndef CONTROLINPUTTIME_H
+#define CONTROLINPUTTIME_H
+
+#include <QAtomicInteger>
+
+#include "util/class.h"
+#include "util/duration.h"
+#include "util/types.h"
+
+// Carries the arrival time of controller input along with the controls that
+// the input sets, so the engine can place a trigger at the frame within the
+// callback that corresponds to its arrival instead of at the buffer start.
+//
+// The controller thread opens a Scope while it handles a message. Slots that
+// are connected directly to the controls run within the scope and can pick
+// up the arrival time with currentNanos(), e.g. to queue it with a seek.
+//
+// Input that arrives during one callback period is picked up by the next
+// callback. Delaying it by the same fraction of the period into that
+// callback turns the jitter of up to a whole buffer into a constant latency
+// of one buffer.
+class ControlInputTime {
+  public:
+    // Sets the arrival time of the input that is handled on this thread
+    // while the scope exists. Timestamps that are not on the clock of
+    // mixxx::Time are replaced by the current time.
+    class Scope {
+      public:
+        explicit Scope(mixxx::Duration timestamp);
+        ~Scope();
+
+      private:
+        qint64 m_previousNanos;
+
+        DISALLOW_COPY_AND_ASSIGN(Scope);
+    };
+
+    // Returns the arrival time of the input that is handled on the calling
+    // thread in nanoseconds of mixxx::Time, or 0 outside of a Scope
+    static qint64 currentNanos();
+
+    // Called by the engine at the start of each callback
+    static void engineCallbackStarted(mixxx::Duration now);
+
+    // Returns the frame of the current callback with bufferFrames frames at
+    // which input that arrived at inputNanos takes effect. Returns 0 for
+    // input without an arrival time and for input that did not arrive during
+    // the previous callback period.
+    static SINT frameOffsetInCallback(qint64 inputNanos, SINT bufferFrames);
+
+  private:
+    // The start of the previous and of the current callback
+    static QAtomicInteger<qint64> s_previousCallbackNanos;
+    static QAtomicInteger<qint64> s_currentCallbackNanos;
+};
+
+#endif // CONTROLINPUTTIME_H
@@ -52,6 +52,8 @@ void ControlObject::initialize(ConfigKey key, bool bIgnoreNops, bool bTrack,
 
     // getControl can fail and return a NULL control even with the create flag.
     if (m_pControl) {
+        // Share the interned group and item of the control
+        m_key = m_pControl->getKey();
         connect(m_pControl.data(), SIGNAL(valueChanged(double, QObject*)),
                 this, SLOT(privateValueChanged(double, QObject*)),
                 Qt::DirectConnection);
@@ -71,6 +73,10 @@ void ControlObject::privateValueChanged(double dValue, QObject* pSender) {
 // static
 ControlObject* ControlObject::getControl(const ConfigKey& key, bool warn) {
     //qDebug() << "ControlObject::getControl for (" << key.group << "," << key.item << ")";
+    return getControl(InternedConfigKey(key), warn);
+}
+
+ControlObject* ControlObject::getControl(const InternedConfigKey& key, bool warn) {
     QSharedPointer<ControlDoublePrivate> pCDP = ControlDoublePrivate::getControl(key, warn);
     if (pCDP) {
         return pCDP->getCreatorCO();
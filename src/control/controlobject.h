@@ -43,6 +43,7 @@ class ControlObject : public QObject {
 
     // Returns a pointer to the ControlObject matching the given ConfigKey
     static ControlObject* getControl(const ConfigKey& key, bool warn = true);
+    static ControlObject* getControl(const InternedConfigKey& key, bool warn = true);
     static inline ControlObject* getControl(const QString& group, const QString& item, bool warn = true) {
         ConfigKey key(group, item);
         return getControl(key, warn);
@@ -51,6 +52,19 @@ class ControlObject : public QObject {
         ConfigKey key(group, item);
         return getControl(key, warn);
     }
+    // Returns a pointer to the ControlObject of the given handle in O(1)
+    // without locking. See ControlDoublePrivate::getHandle().
+    static inline ControlObject* getControl(const ControlHandle& handle) {
+        ControlDoublePrivate* pControl =
+                ControlDoublePrivate::getControlByHandle(handle);
+        return pControl ? pControl->getCreatorCO() : NULL;
+    }
+    static inline ControlHandle getHandle(const ConfigKey& key) {
+        return ControlDoublePrivate::getHandle(key);
+    }
+    static inline ControlHandle getHandle(const InternedConfigKey& key) {
+        return ControlDoublePrivate::getHandle(key);
+    }
 
     QString name() const {
         return m_pControl ?  m_pControl->name() : QString();
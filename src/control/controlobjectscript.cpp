@@ -2,20 +2,25 @@
 
 #include "control/controlobjectscript.h"
 
-ControlObjectScript::ControlObjectScript(const ConfigKey& key, QObject* pParent)
-        : ControlProxy(key, pParent) {
+ControlObjectScript::ControlObjectScript(const ConfigKey& key,
+        QSharedPointer<ScriptConnectionQueue> pQueue, QObject* pParent)
+        : ControlProxy(key, pParent),
+          m_pQueue(pQueue) {
 }
 
 bool ControlObjectScript::addScriptConnection(const ScriptConnection& conn) {
     if (m_scriptConnections.isEmpty()) {
-        // Only connect the slots when they are actually needed
-        // by script connections.
-        connect(m_pControl.data(), SIGNAL(valueChanged(double, QObject*)),
-                this, SLOT(slotValueChanged(double,QObject*)),
-                Qt::QueuedConnection);
-        connect(this, SIGNAL(trigger(double, QObject*)),
-                this, SLOT(slotValueChanged(double,QObject*)),
-                Qt::QueuedConnection);
+        // Only connect the signal when it is actually needed by script
+        // connections. The queue is called directly from the thread that
+        // changes the control. It is captured instead of this, because the
+        // signal may still be delivered while this object is deleted.
+        QSharedPointer<ScriptConnectionQueue> pQueue = m_pQueue;
+        const ConfigKey key = getKey();
+        m_valueChangedConnection = connect(
+                m_pControl.data(), &ControlDoublePrivate::valueChanged,
+                this, [pQueue, key](double, QObject*) {
+                    pQueue->enqueue(key);
+                }, Qt::DirectConnection);
     }
 
     for (const auto& priorConnection: m_scriptConnections) {
@@ -48,10 +53,7 @@ void ControlObjectScript::removeScriptConnection(const ScriptConnection& conn) {
     }
     if (m_scriptConnections.isEmpty()) {
         // no ScriptConnections left, so disconnect signals
-        disconnect(m_pControl.data(), SIGNAL(valueChanged(double, QObject*)),
-                this, SLOT(slotValueChanged(double,QObject*)));
-        disconnect(this, SIGNAL(trigger(double, QObject*)),
-                this, SLOT(slotValueChanged(double,QObject*)));
+        disconnect(m_valueChangedConnection);
     }
 }
 
@@ -65,13 +67,8 @@ void ControlObjectScript::disconnectAllConnectionsToFunction(const QScriptValue&
     }
 }
 
-void ControlObjectScript::slotValueChanged(double value, QObject*) {
-    // Make a local copy of m_connectedScriptFunctions first.
-    // This allows a script to disconnect a callback from inside the
-    // the callback. Otherwise the this may crash since the disconnect call
-    // happens during conn.function.call() in the middle of the loop below.
-    QList<ScriptConnection> connections = m_scriptConnections;
-    for (auto&& conn: connections) {
-        conn.executeCallback(value);
+void ControlObjectScript::emitValueChanged() {
+    if (!m_scriptConnections.isEmpty()) {
+        m_pQueue->enqueue(getKey());
     }
 }
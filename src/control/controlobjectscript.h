@@ -1,6 +1,8 @@
 #ifndef CONTROLOBJECTSCRIPT_H
 #define CONTROLOBJECTSCRIPT_H
 
+#include <QSharedPointer>
+
 #include "controllers/controllerengine.h"
 #include "controllers/controllerdebug.h"
 #include "control/controlproxy.h"
@@ -9,12 +11,18 @@
 class ControlObjectScript : public ControlProxy {
     Q_OBJECT
   public:
-    explicit ControlObjectScript(const ConfigKey& key, QObject* pParent = nullptr);
+    ControlObjectScript(const ConfigKey& key,
+                        QSharedPointer<ScriptConnectionQueue> pQueue,
+                        QObject* pParent = nullptr);
 
     bool addScriptConnection(const ScriptConnection& conn);
 
     void removeScriptConnection(const ScriptConnection& conn);
 
+    const QList<ScriptConnection>& scriptConnections() const {
+        return m_scriptConnections;
+    }
+
     // Required for legacy behavior of ControllerEngine::connectControl
     inline int countConnections() {
             return m_scriptConnections.size(); };
@@ -23,20 +31,14 @@ class ControlObjectScript : public ControlProxy {
     void disconnectAllConnectionsToFunction(const QScriptValue& function);
 
     // Called from update();
-    void emitValueChanged() override {
-        emit(trigger(get(), this));
-    }
-
-  signals:
-    // It will connect to the slotValueChanged as well
-    void trigger(double, QObject*);
-
-  protected slots:
-    // Receives the value from the master control by a unique queued connection
-    void slotValueChanged(double v, QObject*);
+    void emitValueChanged() override;
 
   private:
     QList<ScriptConnection> m_scriptConnections;
+    // Collects the changes of the control from the thread that changes it
+    // until the controller thread calls the script connections
+    const QSharedPointer<ScriptConnectionQueue> m_pQueue;
+    QMetaObject::Connection m_valueChangedConnection;
 };
 
 #endif // CONTROLOBJECTSCRIPT_H
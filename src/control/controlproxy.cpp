@@ -2,37 +2,64 @@
 
 #include "control/controlproxy.h"
 #include "control/control.h"
+#include "control/controlcoalescer.h"
 
 ControlProxy::ControlProxy(QObject* pParent)
         : QObject(pParent),
-          m_pControl(NULL) {
+          m_pControl(NULL),
+          m_bCoalesced(false) {
 }
 
 ControlProxy::ControlProxy(const QString& g, const QString& i, QObject* pParent)
-        : QObject(pParent) {
+        : QObject(pParent),
+          m_bCoalesced(false) {
     initialize(ConfigKey(g, i));
 }
 
 ControlProxy::ControlProxy(const char* g, const char* i, QObject* pParent)
-        : QObject(pParent) {
+        : QObject(pParent),
+          m_bCoalesced(false) {
     initialize(ConfigKey(g, i));
 }
 
 ControlProxy::ControlProxy(const ConfigKey& key, QObject* pParent)
-        : QObject(pParent) {
+        : QObject(pParent),
+          m_bCoalesced(false) {
+    initialize(key);
+}
+
+ControlProxy::ControlProxy(const InternedConfigKey& key, QObject* pParent)
+        : QObject(pParent),
+          m_bCoalesced(false) {
     initialize(key);
 }
 
 void ControlProxy::initialize(const ConfigKey& key) {
-    m_key = key;
     // Don't bother looking up the control if key is NULL. Prevents log spew.
-    if (!key.isNull()) {
+    if (key.isNull()) {
+        m_key = key;
+        return;
+    }
+    initialize(InternedConfigKey(key));
+}
+
+void ControlProxy::initialize(const InternedConfigKey& key) {
+    // The interned key shares its strings with the key of the control
+    m_key = key.key();
+    if (!m_key.isNull()) {
         m_pControl = ControlDoublePrivate::getControl(key);
     }
 }
 
 ControlProxy::~ControlProxy() {
     //qDebug() << "ControlProxy::~ControlProxy()";
+    if (m_bCoalesced) {
+        m_pControl->removeCoalescedConnection();
+        ControlCoalescer* pCoalescer = ControlCoalescer::instance();
+        if (pCoalescer) {
+            pCoalescer->removeProxy(this, m_pControl->getHandle());
+        }
+    }
 }
 
 bool ControlProxy::connectValueChanged(const QObject* receiver,
@@ -104,3 +131,34 @@ bool ControlProxy::connectValueChanged(
     DEBUG_ASSERT(parent() != NULL);
     return connectValueChanged(parent(), method, type);
 }
+
+bool ControlProxy::connectValueChangedCoalesced(const QObject* receiver,
+        const char* method) {
+    if (!m_pControl) {
+        return false;
+    }
+
+    ControlCoalescer* pCoalescer = ControlCoalescer::instance();
+    if (pCoalescer == NULL || !m_pControl->getHandle().valid()) {
+        return connectValueChanged(receiver, method);
+    }
+
+    if (!connect((QObject*)this, SIGNAL(valueChanged(double)),
+                 receiver, method, Qt::AutoConnection)) {
+        return false;
+    }
+
+    // Register only once, the coalescer emits valueChanged() of this proxy
+    // for all receivers.
+    if (!m_bCoalesced) {
+        m_bCoalesced = true;
+        m_pControl->addCoalescedConnection();
+        pCoalescer->addProxy(this, m_pControl->getHandle());
+    }
+    return true;
+}
+
+bool ControlProxy::connectValueChangedCoalesced(const char* method) {
+    DEBUG_ASSERT(parent() != NULL);
+    return connectValueChangedCoalesced(parent(), method);
+}
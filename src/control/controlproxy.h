@@ -22,19 +22,37 @@ class ControlProxy : public QObject {
     ControlProxy(const QString& g, const QString& i, QObject* pParent = NULL);
     ControlProxy(const char* g, const char* i, QObject* pParent = NULL);
     ControlProxy(const ConfigKey& key, QObject* pParent = NULL);
+    // Saves hashing the key for code that creates many proxies for the
+    // same keys
+    ControlProxy(const InternedConfigKey& key, QObject* pParent = NULL);
     virtual ~ControlProxy();
 
     void initialize(const ConfigKey& key);
+    void initialize(const InternedConfigKey& key);
 
     const ConfigKey& getKey() const {
         return m_key;
     }
 
+    // The handle of the control, which is the one of the aliased control if
+    // the key is an alias.
+    ControlHandle getHandle() const {
+        return m_pControl ? m_pControl->getHandle() : ControlHandle();
+    }
+
     bool connectValueChanged(const QObject* receiver,
             const char* method, Qt::ConnectionType type = Qt::AutoConnection);
     bool connectValueChanged(
             const char* method, Qt::ConnectionType type = Qt::AutoConnection);
 
+    // Like connectValueChanged(), but valueChanged() is emitted at most once
+    // per GUI frame with the latest value, skipping the values in between.
+    // For receivers in the main thread that only display the value. Falls
+    // back to connectValueChanged() if there is no ControlCoalescer.
+    bool connectValueChangedCoalesced(const QObject* receiver,
+            const char* method);
+    bool connectValueChangedCoalesced(const char* method);
+
     // Called from update();
     virtual void emitValueChanged() {
         emit(valueChanged(get()));
@@ -98,7 +116,8 @@ class ControlProxy : public QObject {
 
   signals:
     // This signal must not connected by connect(). Use connectValueChanged()
-    // instead. It will connect to the base ControlDoublePrivate as well.
+    // or connectValueChangedCoalesced() instead. They will connect to the
+    // base ControlDoublePrivate or the ControlCoalescer as well.
     void valueChanged(double);
 
   protected slots:
@@ -130,6 +149,10 @@ class ControlProxy : public QObject {
     ConfigKey m_key;
     // Pointer to connected control.
     QSharedPointer<ControlDoublePrivate> m_pControl;
+
+  private:
+    // Whether this is registered with the ControlCoalescer
+    bool m_bCoalesced;
 };
 
 #endif // CONTROLPROXY_H
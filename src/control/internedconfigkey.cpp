@@ -0,0 +1,63 @@
+#include "control/internedconfigkey.h"
+
+#include <QReadWriteLock>
+#include <QSet>
+
+namespace {
+
+const ConfigKey kNullKey;
+
+QString internName(QSet<QString>* pNames, const QString& name) {
+    QSet<QString>::const_iterator it = pNames->constFind(name);
+    if (it != pNames->constEnd()) {
+        return *it;
+    }
+    pNames->insert(name);
+    return name;
+}
+
+} // anonymous namespace
+
+InternedConfigKey::InternedConfigKey(const ConfigKey& key)
+        : m_pEntry(intern(key)) {
+}
+
+InternedConfigKey::InternedConfigKey(const ConfigKeyLiteral& key)
+        : m_pEntry(intern(ConfigKey(QString::fromLatin1(key.group),
+                                    QString::fromLatin1(key.item)))) {
+}
+
+const ConfigKey& InternedConfigKey::key() const {
+    return m_pEntry ? m_pEntry->key : kNullKey;
+}
+
+// static
+const InternedConfigKey::Entry* InternedConfigKey::intern(const ConfigKey& key) {
+    // Function statics, keys may be interned during static initialization
+    static QReadWriteLock s_lock;
+    static QHash<ConfigKey, const Entry*> s_entries;
+    static QSet<QString> s_names;
+
+    {
+        QReadLocker locker(&s_lock);
+        QHash<ConfigKey, const Entry*>::const_iterator it =
+                s_entries.constFind(key);
+        if (it != s_entries.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QWriteLocker locker(&s_lock);
+    // Another thread may have interned the key in the meantime
+    QHash<ConfigKey, const Entry*>::const_iterator it =
+            s_entries.constFind(key);
+    if (it != s_entries.constEnd()) {
+        return it.value();
+    }
+    Entry* pEntry = new Entry;
+    pEntry->key = ConfigKey(internName(&s_names, key.group),
+                            internName(&s_names, key.item));
+    pEntry->hash = qHash(pEntry->key);
+    s_entries.insert(pEntry->key, pEntry);
+    return pEntry;
+}
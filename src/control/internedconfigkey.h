@@ -0,0 +1,87 @@
+#ifndef INTERNEDCONFIGKEY_H
+#define INTERNEDCONFIGKEY_H
+
+#include <QHash>
+#include <QtDebug>
+
+#include "preferences/configobject.h"
+
+// A ConfigKey that is known at compile time. It only holds the two string
+// literals, so it can be constructed without any static initialization:
+//
+//   constexpr ConfigKeyLiteral kPlayKey("[Channel1]", "play");
+struct ConfigKeyLiteral {
+    constexpr ConfigKeyLiteral(const char* g, const char* i)
+            : group(g),
+              item(i) {
+    }
+
+    const char* group;
+    const char* item;
+};
+
+// InternedConfigKey refers to the one copy of a ConfigKey that is shared by
+// all equal keys. Interning hashes and compares the strings of the key once,
+// afterwards InternedConfigKeys are compared by pointer and hashed with the
+// hash that was computed when the key was interned. The strings of the
+// interned key are shared as well, so all keys of a group like [Channel1]
+// refer to the same group string.
+//
+// The control registry is keyed by InternedConfigKey. Code that looks up the
+// same keys repeatedly, for example when loading skins or controller
+// presets, can intern them once and save hashing both strings for every
+// lookup. Interned keys are never freed, there are only as many as there
+// are distinct ConfigKeys of controls.
+class InternedConfigKey {
+  public:
+    InternedConfigKey()
+            : m_pEntry(nullptr) {
+    }
+    // Interns the key, thread-safe.
+    explicit InternedConfigKey(const ConfigKey& key);
+    explicit InternedConfigKey(const ConfigKeyLiteral& key);
+
+    inline bool isNull() const {
+        return m_pEntry == nullptr;
+    }
+
+    // The shared ConfigKey, or a null ConfigKey if this is null
+    const ConfigKey& key() const;
+
+    inline uint hash() const {
+        return m_pEntry ? m_pEntry->hash : 0;
+    }
+
+    friend inline bool operator==(const InternedConfigKey& lhs,
+                                  const InternedConfigKey& rhs) {
+        return lhs.m_pEntry == rhs.m_pEntry;
+    }
+
+    friend inline bool operator!=(const InternedConfigKey& lhs,
+                                  const InternedConfigKey& rhs) {
+        return lhs.m_pEntry != rhs.m_pEntry;
+    }
+
+  private:
+    struct Entry {
+        ConfigKey key;
+        uint hash;
+    };
+
+    static const Entry* intern(const ConfigKey& key);
+
+    const Entry* m_pEntry;
+};
+
+Q_DECLARE_TYPEINFO(InternedConfigKey, Q_PRIMITIVE_TYPE);
+
+inline uint qHash(const InternedConfigKey& key) {
+    return key.hash();
+}
+
+inline QDebug operator<<(QDebug stream, const InternedConfigKey& key) {
+    stream << key.key();
+    return stream;
+}
+
+#endif /* INTERNEDCONFIGKEY_H */
@@ -70,6 +70,31 @@ static QString get_string(libusb_device_handle *handle, u_int8_t id) {
 }
 
 
+BulkWriter::BulkWriter(libusb_device_handle* handle, unsigned char out_epaddr,
+                       const QString& deviceName)
+        : m_phandle(handle),
+          m_out_epaddr(out_epaddr),
+          m_deviceName(deviceName) {
+}
+
+BulkWriter::~BulkWriter() {
+    stop();
+}
+
+void BulkWriter::write(const QByteArray& data) {
+    int transferred;
+
+    // XXX: don't get drunk again.
+    int ret = libusb_bulk_transfer(m_phandle, m_out_epaddr,
+                                   (unsigned char *)data.constData(), data.size(),
+                                   &transferred, 0);
+    if (ret < 0) {
+        qWarning() << "Unable to send data to" << m_deviceName;
+    } else {
+        controllerDebug(transferred << "bytes sent to" << m_deviceName);
+    }
+}
+
 BulkController::BulkController(libusb_context* context,
                                libusb_device_handle *handle,
                                struct libusb_device_descriptor *desc)
@@ -92,6 +117,7 @@ BulkController::BulkController(libusb_context* context,
     setInputDevice(true);
     setOutputDevice(true);
     m_pReader = NULL;
+    m_pWriter = NULL;
 }
 
 BulkController::~BulkController() {
@@ -177,6 +203,11 @@ int BulkController::open() {
         return -1;
     }
 
+    // The scripts send their first packets when the engine starts
+    m_pWriter = new BulkWriter(m_phandle, out_epaddr, getName());
+    m_pWriter->setObjectName(QString("BulkWriter %1").arg(getName()));
+    m_pWriter->start(QThread::HighPriority);
+
     setOpen(true);
     startEngine();
 
@@ -223,6 +254,17 @@ int BulkController::close() {
     // closed incase it has any final parting messages
     stopEngine();
 
+    // Renders the final frames
+    qDeleteAll(m_screens);
+    m_screens.clear();
+
+    // Writes the final packets
+    if (m_pWriter != NULL) {
+        controllerDebug("  Waiting on writer to finish");
+        delete m_pWriter;
+        m_pWriter = NULL;
+    }
+
     // Close device
     controllerDebug("  Closing device");
     libusb_close(m_phandle);
@@ -242,18 +284,33 @@ void BulkController::send(QList<int> data, unsigned int length) {
 }
 
 void BulkController::send(QByteArray data) {
-    int ret;
-    int transferred;
+    if (m_pWriter == NULL) {
+        qWarning() << "USB Bulk device" << getName() << "not open for output!";
+        return;
+    }
+    // The packets of the supported devices start with their command
+    const int key = data.isEmpty() ? 0 : static_cast<unsigned char>(data.at(0));
+    m_pWriter->enqueue(key, data);
+    latency()->outputSent();
+}
 
-    // XXX: don't get drunk again.
-    ret = libusb_bulk_transfer(m_phandle, out_epaddr,
-                               (unsigned char *)data.constData(), data.size(),
-                               &transferred, 0);
-    if (ret < 0) {
-        qWarning() << "Unable to send data to" << getName()
-                   << "serial #" << m_sUID;
-    } else {
-        controllerDebug(ret << "bytes sent to" << getName()
-                 << "serial #" << m_sUID);
+QObject* BulkController::createScreen(int width, int height,
+                                      QString pixelFormat, int framesPerSecond) {
+    if (m_pWriter == NULL) {
+        qWarning() << "USB Bulk device" << getName() << "not open for output!";
+        return NULL;
+    }
+    ControllerScreen::PixelFormat format;
+    if (width <= 0 || height <= 0 ||
+            !ControllerScreen::pixelFormatFromName(pixelFormat, &format)) {
+        qWarning() << "USB Bulk device" << getName()
+                   << "invalid screen" << width << height << pixelFormat;
+        return NULL;
     }
+    // The keys of the tiles follow the keys of the packets
+    const int keyBase = (m_screens.size() + 1) << 16;
+    ControllerScreen* pScreen = new ControllerScreen(
+            m_pWriter, keyBase, width, height, format, framesPerSecond);
+    m_screens.append(pScreen);
+    return pScreen;
 }
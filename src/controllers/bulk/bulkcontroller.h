@@ -11,6 +11,8 @@
 #include <QAtomicInt>
 
 #include "controllers/controller.h"
+#include "controllers/controlleroutputwriter.h"
+#include "controllers/controllerscreen.h"
 #include "controllers/hid/hidcontrollerpreset.h"
 #include "controllers/hid/hidcontrollerpresetfilehandler.h"
 #include "util/duration.h"
@@ -39,6 +41,22 @@ class BulkReader : public QThread {
     unsigned char m_in_epaddr;
 };
 
+class BulkWriter : public ControllerOutputWriter {
+    Q_OBJECT
+  public:
+    BulkWriter(libusb_device_handle* handle, unsigned char out_epaddr,
+               const QString& deviceName);
+    ~BulkWriter() override;
+
+  protected:
+    void write(const QByteArray& data) override;
+
+  private:
+    libusb_device_handle* m_phandle;
+    unsigned char m_out_epaddr;
+    const QString m_deviceName;
+};
+
 class BulkController : public Controller {
     Q_OBJECT
   public:
@@ -73,6 +91,12 @@ class BulkController : public Controller {
 
   protected:
     Q_INVOKABLE void send(QList<int> data, unsigned int length);
+    // Creates a screen that sends the changed tiles of its frames to the
+    // device, see ControllerScreen. The pixel format is "rgb565le",
+    // "rgb565be" or "rgb888". The screens are deleted when the device is
+    // closed.
+    Q_INVOKABLE QObject* createScreen(int width, int height,
+                                      QString pixelFormat, int framesPerSecond);
 
   private slots:
     int open() override;
@@ -105,6 +129,8 @@ class BulkController : public Controller {
 
     QString m_sUID;
     BulkReader* m_pReader;
+    BulkWriter* m_pWriter;
+    QList<ControllerScreen*> m_screens;
     HidControllerPreset m_preset;
 };
 
@@ -9,6 +9,7 @@
 #include <QScriptValue>
 
 #include "controllers/controller.h"
+#include "control/controlinputtime.h"
 #include "controllers/controllerdebug.h"
 #include "controllers/defs_controllers.h"
 #include "util/screensaver.h"
@@ -114,6 +115,8 @@ void Controller::receive(const QByteArray data, mixxx::Duration timestamp) {
         return;
     }
     triggerActivity();
+    m_latency.inputReceived(m_sDeviceName, timestamp);
+    ControlInputTime::Scope inputTime(timestamp);
 
     int length = data.size();
     if (ControllerDebug::enabled()) {
@@ -141,4 +144,5 @@ void Controller::receive(const QByteArray data, mixxx::Duration timestamp) {
             qWarning() << "Controller: Invalid script function" << function;
         }
     }
+    m_latency.inputHandled();
 }
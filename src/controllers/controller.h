@@ -13,6 +13,7 @@
 #define CONTROLLER_H
 
 #include "controllers/controllerengine.h"
+#include "controllers/controllerlatency.h"
 #include "controllers/controllervisitor.h"
 #include "controllers/controllerpreset.h"
 #include "controllers/controllerpresetinfo.h"
@@ -66,6 +67,13 @@ class Controller : public QObject, ConstControllerPresetVisitor {
 
     virtual bool matchPreset(const PresetInfo& preset) = 0;
 
+    // Limits the rate of the output messages of the controllers that
+    // coalesce them
+    virtual void setOutputRateLimit(int framesPerSecond, int bytesPerSecond) {
+        Q_UNUSED(framesPerSecond);
+        Q_UNUSED(bytesPerSecond);
+    }
+
   signals:
     // Emitted when a new preset is loaded. pPreset is a /clone/ of the loaded
     // preset, not a pointer to the preset itself.
@@ -108,6 +116,10 @@ class Controller : public QObject, ConstControllerPresetVisitor {
     inline ControllerEngine* getEngine() const {
         return m_pEngine;
     }
+    // Sub-classes report the stages of their input and output to it
+    inline ControllerLatency* latency() {
+        return &m_latency;
+    }
     inline void setDeviceName(QString deviceName) {
         m_sDeviceName = deviceName;
     }
@@ -161,6 +173,7 @@ class Controller : public QObject, ConstControllerPresetVisitor {
     bool m_bIsOpen;
     bool m_bLearning;
     QTime m_userActivityInhibitTimer;
+    ControllerLatency m_latency;
 
     // accesses lots of our stuff, but in the same thread
     friend class ControllerManager;
@@ -22,6 +22,10 @@
 // (closure compatible version of connectControl)
 #include <QUuid>
 
+#include <QCryptographicHash>
+#include <QMutex>
+#include <QMutexLocker>
+
 const int kDecks = 16;
 
 // Use 1ms for the Alpha-Beta dt. We're assuming the OS actually gives us a 1ms
@@ -29,10 +33,74 @@ const int kDecks = 16;
 const int kScratchTimerMs = 1;
 const double kAlphaBetaDt = kScratchTimerMs / 1000.0;
 
+// The resolution of script timers. All of them are driven by a single
+// timer with this interval.
+const int kTimerWheelTickMs = 5;
+
+namespace {
+
+// The programs of the script files by their file name. They are shared by
+// the engines of all controllers and kept when a preset is loaded again, so
+// that unchanged files are not checked again. The hash of the code tells if
+// the file has changed.
+struct CachedScriptProgram {
+    QByteArray hash;
+    QScriptProgram program;
+};
+QMutex s_scriptProgramCacheMutex;
+QHash<QString, CachedScriptProgram> s_scriptProgramCache;
+
+// Calls a batch of script connections. An exception of a callback does not
+// stop the others, it is returned with the index of the connection.
+const QString kScriptConnectionDispatcherCode = QStringLiteral(
+        "(function (callbacks, contexts, values, groups, items, count) {"
+        "    var errors = [];"
+        "    for (var i = 0; i < count; ++i) {"
+        "        try {"
+        "            callbacks[i].call(contexts[i], values[i], groups[i], items[i]);"
+        "        } catch (e) {"
+        "            errors.push([i, String(e)]);"
+        "        }"
+        "    }"
+        "    return errors;"
+        "})");
+
+} // anonymous namespace
+
+void ScriptConnectionQueue::enqueue(const ConfigKey& key) {
+    QMutexLocker locker(&m_mutex);
+    if (m_pEngine == nullptr || m_queuedKeys.contains(key)) {
+        return;
+    }
+    if (m_keys.isEmpty()) {
+        QMetaObject::invokeMethod(m_pEngine, "slotDispatchScriptConnections",
+                                  Qt::QueuedConnection);
+    }
+    m_keys.append(key);
+    m_queuedKeys.insert(key);
+}
+
+QList<ConfigKey> ScriptConnectionQueue::takeAll() {
+    QMutexLocker locker(&m_mutex);
+    m_queuedKeys.clear();
+    QList<ConfigKey> keys;
+    keys.swap(m_keys);
+    return keys;
+}
+
+void ScriptConnectionQueue::detach() {
+    QMutexLocker locker(&m_mutex);
+    m_pEngine = nullptr;
+    m_keys.clear();
+    m_queuedKeys.clear();
+}
+
 ControllerEngine::ControllerEngine(Controller* controller)
         : m_pEngine(nullptr),
           m_pController(controller),
           m_bPopups(false),
+          m_pScriptConnectionQueue(new ScriptConnectionQueue(this)),
+          m_timerWheelTickId(0),
           m_pBaClass(nullptr) {
     // Handle error dialog buttons
     qRegisterMetaType<QMessageBox::StandardButton>("QMessageBox::StandardButton");
@@ -58,6 +126,8 @@ ControllerEngine::ControllerEngine(Controller* controller)
 }
 
 ControllerEngine::~ControllerEngine() {
+    m_pScriptConnectionQueue->detach();
+
     // Clean up
     for (int i = 0; i < kDecks; ++i) {
         delete m_scratchFilters[i];
@@ -119,20 +189,60 @@ QScriptValue ControllerEngine::wrapFunctionCode(const QString& codeSnippet,
     if (i != m_scriptWrappedFunctionCache.end()) {
         wrappedFunction = i.value();
     } else {
-        QStringList wrapperArgList;
-        for (int i = 1; i <= numberOfArgs; i++) {
-            wrapperArgList << QString("arg%1").arg(i);
-        }
-        QString wrapperArgs = wrapperArgList.join(",");
-        QString wrappedCode = "(function (" + wrapperArgs + ") { (" +
-                                codeSnippet + ")(" + wrapperArgs + "); })";
-        wrappedFunction = m_pEngine->evaluate(wrappedCode);
+        wrappedFunction = m_pEngine->evaluate(wrapperCode(codeSnippet, numberOfArgs));
         checkException();
         m_scriptWrappedFunctionCache[codeSnippet] = wrappedFunction;
     }
     return wrappedFunction;
 }
 
+// static
+QString ControllerEngine::wrapperCode(const QString& codeSnippet,
+                                      int numberOfArgs) {
+    QStringList wrapperArgList;
+    for (int i = 1; i <= numberOfArgs; i++) {
+        wrapperArgList << QString("arg%1").arg(i);
+    }
+    QString wrapperArgs = wrapperArgList.join(",");
+    return "(function (" + wrapperArgs + ") { (" +
+            codeSnippet + ")(" + wrapperArgs + "); })";
+}
+
+void ControllerEngine::wrapFunctionCodes(const QStringList& codeSnippets,
+                                         int numberOfArgs) {
+    if (m_pEngine == nullptr) {
+        return;
+    }
+    QStringList snippets;
+    QStringList wrappedCodes;
+    for (const auto& codeSnippet : codeSnippets) {
+        if (!m_scriptWrappedFunctionCache.contains(codeSnippet) &&
+                !snippets.contains(codeSnippet)) {
+            snippets.append(codeSnippet);
+            wrappedCodes.append(wrapperCode(codeSnippet, numberOfArgs));
+        }
+    }
+    if (snippets.isEmpty()) {
+        return;
+    }
+    // The snippets are only referenced by the wrappers, so only a syntax
+    // error fails the whole array
+    QScriptValue wrappedFunctions =
+            m_pEngine->evaluate("[" + wrappedCodes.join(",\n") + "]");
+    if (m_pEngine->hasUncaughtException()) {
+        m_pEngine->clearExceptions();
+        // Reports the errors of the individual snippets
+        for (const auto& codeSnippet : snippets) {
+            wrapFunctionCode(codeSnippet, numberOfArgs);
+        }
+        return;
+    }
+    for (int i = 0; i < snippets.size(); ++i) {
+        m_scriptWrappedFunctionCache.insert(snippets[i],
+                wrappedFunctions.property(static_cast<quint32>(i)));
+    }
+}
+
 QScriptValue ControllerEngine::getThisObjectInFunctionCall() {
     QScriptContext *ctxt = m_pEngine->currentContext();
     // Our current context is a function call. We want to grab the 'this'
@@ -175,6 +285,8 @@ void ControllerEngine::gracefulShutdown() {
 
     // Clear the cache of function wrappers
     m_scriptWrappedFunctionCache.clear();
+    m_scriptControlKeys.clear();
+    m_dispatchedConnections.clear();
 
     // Free all the ControlObjectScripts
     QList<ConfigKey> keys = m_controlCache.keys();
@@ -216,6 +328,14 @@ void ControllerEngine::initializeScriptEngine() {
 
     m_pBaClass = new ByteArrayClass(m_pEngine);
     engineGlobalObject.setProperty("ByteArray", m_pBaClass->constructor());
+
+    m_scriptConnectionDispatcher =
+            m_pEngine->evaluate(kScriptConnectionDispatcherCode);
+    m_dispatchCallbacks = m_pEngine->newArray();
+    m_dispatchContexts = m_pEngine->newArray();
+    m_dispatchValues = m_pEngine->newArray();
+    m_dispatchGroups = m_pEngine->newArray();
+    m_dispatchItems = m_pEngine->newArray();
 }
 
 /* -------- ------------------------------------------------------
@@ -538,7 +658,7 @@ ControlObjectScript* ControllerEngine::getControlObjectScript(const QString& gro
     ControlObjectScript* coScript = m_controlCache.value(key, nullptr);
     if (coScript == nullptr) {
         // create COT
-        coScript = new ControlObjectScript(key, this);
+        coScript = new ControlObjectScript(key, m_pScriptConnectionQueue, this);
         if (coScript->valid()) {
             m_controlCache.insert(key, coScript);
         } else {
@@ -578,7 +698,7 @@ void ControllerEngine::setValue(QString group, QString name, double newValue) {
     ControlObjectScript* coScript = getControlObjectScript(group, name);
 
     if (coScript != nullptr) {
-        ControlObject* pControl = ControlObject::getControl(coScript->getKey());
+        ControlObject* pControl = ControlObject::getControl(coScript->getHandle());
         if (pControl && !m_st.ignore(pControl, coScript->getParameterForValue(newValue))) {
             coScript->slotSet(newValue);
         }
@@ -615,7 +735,7 @@ void ControllerEngine::setParameter(QString group, QString name, double newParam
     ControlObjectScript* coScript = getControlObjectScript(group, name);
 
     if (coScript != nullptr) {
-        ControlObject* pControl = ControlObject::getControl(coScript->getKey());
+        ControlObject* pControl = ControlObject::getControl(coScript->getHandle());
         if (pControl && !m_st.ignore(pControl, newParameter)) {
           coScript->setParameter(newParameter);
         }
@@ -758,6 +878,71 @@ void ScriptConnection::executeCallback(double value) const {
     }
 }
 
+void ControllerEngine::slotDispatchScriptConnections() {
+    const QList<ConfigKey> keys = m_pScriptConnectionQueue->takeAll();
+    if (m_pEngine == nullptr || !m_scriptConnectionDispatcher.isFunction()) {
+        return;
+    }
+
+    // Copies the connections first, so that a callback can disconnect
+    // connections of the batch
+    m_dispatchedConnections.resize(0);
+    quint32 count = 0;
+    for (const auto& key : keys) {
+        ControlObjectScript* coScript = m_controlCache.value(key, nullptr);
+        if (coScript == nullptr || coScript->countConnections() == 0) {
+            continue;
+        }
+        auto scriptKey = m_scriptControlKeys.find(key);
+        if (scriptKey == m_scriptControlKeys.end()) {
+            scriptKey = m_scriptControlKeys.insert(key, qMakePair(
+                    QScriptValue(m_pEngine, key.group),
+                    QScriptValue(m_pEngine, key.item)));
+        }
+        const QScriptValue value(coScript->get());
+        for (const auto& conn : coScript->scriptConnections()) {
+            m_dispatchCallbacks.setProperty(count, conn.callback);
+            m_dispatchContexts.setProperty(count, conn.context);
+            m_dispatchValues.setProperty(count, value);
+            m_dispatchGroups.setProperty(count, scriptKey->first);
+            m_dispatchItems.setProperty(count, scriptKey->second);
+            m_dispatchedConnections.append(conn);
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    // Drops the references of a larger previous batch
+    const QScriptValue length(count);
+    m_dispatchCallbacks.setProperty("length", length);
+    m_dispatchContexts.setProperty("length", length);
+    m_dispatchValues.setProperty("length", length);
+    m_dispatchGroups.setProperty("length", length);
+    m_dispatchItems.setProperty("length", length);
+
+    QScriptValue errors = m_scriptConnectionDispatcher.call(QScriptValue(),
+            QScriptValueList() << m_dispatchCallbacks << m_dispatchContexts
+                    << m_dispatchValues << m_dispatchGroups
+                    << m_dispatchItems << length);
+    if (errors.isError()) {
+        qWarning() << "ControllerEngine: Invocation of connections failed:"
+                   << errors.toString();
+        m_pEngine->clearExceptions();
+        return;
+    }
+    const quint32 errorCount = errors.property("length").toUInt32();
+    for (quint32 i = 0; i < errorCount; ++i) {
+        const QScriptValue error = errors.property(i);
+        const ScriptConnection& conn =
+                m_dispatchedConnections.at(error.property(0u).toInt32());
+        qWarning() << "ControllerEngine: Invocation of connection " << conn.id.toString()
+                   << "connected to (" + conn.key.group + ", " + conn.key.item + ") failed:"
+                   << error.property(1u).toString();
+    }
+}
+
 /* -------- ------------------------------------------------------
    Purpose: (Dis)connects a ScriptConnection
    Input:   the ScriptConnection to disconnect
@@ -977,6 +1162,37 @@ bool ControllerEngine::evaluate(const QString& scriptName, QList<QString> script
     scriptCode.append('\n');
     input.close();
 
+    const QScriptProgram program = compileScriptFile(filename, scriptCode);
+    if (program.isNull()) {
+        return false;
+    }
+
+    // Evaluate the code
+    QScriptValue scriptFunction = m_pEngine->evaluate(program);
+
+    // Record errors
+    if (checkException()) {
+        return false;
+    }
+
+    return true;
+}
+
+QScriptProgram ControllerEngine::compileScriptFile(const QString& filename,
+                                                  const QString& scriptCode) {
+    const QByteArray hash = QCryptographicHash::hash(QByteArray::fromRawData(
+            reinterpret_cast<const char*>(scriptCode.constData()),
+            scriptCode.size() * static_cast<int>(sizeof(QChar))),
+            QCryptographicHash::Sha1);
+    {
+        QMutexLocker locker(&s_scriptProgramCacheMutex);
+        auto it = s_scriptProgramCache.constFind(filename);
+        if (it != s_scriptProgramCache.constEnd() && it.value().hash == hash) {
+            // The syntax has been checked before
+            return it.value().program;
+        }
+    }
+
     // Check syntax
     QScriptSyntaxCheckResult result = m_pEngine->checkSyntax(scriptCode);
     QString error = "";
@@ -1007,18 +1223,15 @@ bool ControllerEngine::evaluate(const QString& scriptName, QList<QString> script
 
             ErrorDialogHandler::instance()->requestErrorDialog(props);
         }
-        return false;
-    }
-
-    // Evaluate the code
-    QScriptValue scriptFunction = m_pEngine->evaluate(scriptCode, filename);
-
-    // Record errors
-    if (checkException()) {
-        return false;
+        return QScriptProgram();
     }
 
-    return true;
+    const QScriptProgram program(scriptCode, filename);
+    QMutexLocker locker(&s_scriptProgramCacheMutex);
+    CachedScriptProgram& cached = s_scriptProgramCache[filename];
+    cached.hash = hash;
+    cached.program = program;
+    return program;
 }
 
 bool ControllerEngine::hasErrors(const QString& filename) {
@@ -1053,18 +1266,28 @@ int ControllerEngine::beginTimer(int interval, QScriptValue timerCallback,
         interval = 20;
     }
 
-    // This makes use of every QObject's internal timer mechanism. Nice, clean,
-    // and simple. See http://doc.trolltech.com/4.6/qobject.html#startTimer for
-    // details
-    int timerId = startTimer(interval);
-    TimerInfo info;
+    if (m_timerWheelTickId == 0) {
+        // The wheel has been idle, so its next tick is now
+        advanceTimerWheel();
+        m_timerWheelTickId = startTimer(kTimerWheelTickMs, Qt::PreciseTimer);
+    }
+    const int intervalTicks =
+            (interval + kTimerWheelTickMs - 1) / kTimerWheelTickMs;
+    const int timerId = m_timerWheel.start(intervalTicks, oneShot);
+    if (timerId == 0) {
+        qWarning() << "Script timer could not be created";
+        return 0;
+    }
+    const int index = TimerWheel::indexOf(timerId);
+    if (index >= m_timers.size()) {
+        m_timers.resize(m_timerWheel.poolSize());
+    }
+    TimerInfo& info = m_timers[index];
+    info.timerId = timerId;
     info.callback = timerCallback;
     info.context = getThisObjectInFunctionCall();
     info.oneShot = oneShot;
-    m_timers[timerId] = info;
-    if (timerId == 0) {
-        qWarning() << "Script timer could not be created";
-    } else if (oneShot) {
+    if (oneShot) {
         controllerDebug("Starting one-shot timer:" << timerId);
     } else {
         controllerDebug("Starting timer:" << timerId);
@@ -1078,23 +1301,33 @@ int ControllerEngine::beginTimer(int interval, QScriptValue timerCallback,
    Output:  -
    -------- ------------------------------------------------------ */
 void ControllerEngine::stopTimer(int timerId) {
-    if (!m_timers.contains(timerId)) {
+    if (!m_timerWheel.stop(timerId)) {
         qWarning() << "Killing timer" << timerId << ": That timer does not exist!";
         return;
     }
     controllerDebug("Killing timer:" << timerId);
-    killTimer(timerId);
-    m_timers.remove(timerId);
+    // Release the script values
+    m_timers[TimerWheel::indexOf(timerId)] = TimerInfo();
+    if (m_timerWheel.isEmpty() && m_timerWheelTickId != 0) {
+        killTimer(m_timerWheelTickId);
+        m_timerWheelTickId = 0;
+    }
 }
 
 void ControllerEngine::stopAllTimers() {
-    QMutableHashIterator<int, TimerInfo> i(m_timers);
-    while (i.hasNext()) {
-        i.next();
-        stopTimer(i.key());
+    for (int index = 0; index < m_timers.size(); ++index) {
+        if (m_timers[index].timerId != 0) {
+            stopTimer(m_timers[index].timerId);
+        }
     }
 }
 
+void ControllerEngine::advanceTimerWheel() {
+    m_timerWheel.advance(
+            mixxx::Time::elapsed().toIntegerMillis() / kTimerWheelTickMs,
+            &m_expiredTimerIds);
+}
+
 void ControllerEngine::timerEvent(QTimerEvent *event) {
     int timerId = event->timerId();
 
@@ -1104,26 +1337,36 @@ void ControllerEngine::timerEvent(QTimerEvent *event) {
         return;
     }
 
-    QHash<int, TimerInfo>::const_iterator it = m_timers.find(timerId);
-    if (it == m_timers.end()) {
+    if (timerId != m_timerWheelTickId) {
         qWarning() << "Timer" << timerId << "fired but there's no function mapped to it!";
         return;
     }
 
-    // NOTE(rryan): Do not assign by reference -- make a copy. I have no idea
-    // why but this causes segfaults in ~QScriptValue while scratching if we
-    // don't copy here -- even though internalExecute passes the QScriptValues
-    // by value. *boggle*
-    const TimerInfo timerTarget = it.value();
-    if (timerTarget.oneShot) {
-        stopTimer(timerId);
-    }
+    m_expiredTimerIds.clear();
+    advanceTimerWheel();
+    // Callbacks may start timers, but the wheel is not advanced until the
+    // next tick
+    for (int i = 0; i < m_expiredTimerIds.size(); ++i) {
+        const int expiredTimerId = m_expiredTimerIds[i];
+        // A previous callback may have stopped the timer
+        if (!m_timerWheel.isActive(expiredTimerId)) {
+            continue;
+        }
+        // NOTE(rryan): Do not assign by reference -- make a copy. I have no idea
+        // why but this causes segfaults in ~QScriptValue while scratching if we
+        // don't copy here -- even though internalExecute passes the QScriptValues
+        // by value. *boggle*
+        const TimerInfo timerTarget = m_timers[TimerWheel::indexOf(expiredTimerId)];
+        if (timerTarget.oneShot) {
+            stopTimer(expiredTimerId);
+        }
 
-    if (timerTarget.callback.isString()) {
-        internalExecute(timerTarget.context, timerTarget.callback.toString());
-    } else if (timerTarget.callback.isFunction()) {
-        internalExecute(timerTarget.context, timerTarget.callback,
-                        QScriptValueList());
+        if (timerTarget.callback.isString()) {
+            internalExecute(timerTarget.context, timerTarget.callback.toString());
+        } else if (timerTarget.callback.isFunction()) {
+            internalExecute(timerTarget.context, timerTarget.callback,
+                            QScriptValueList());
+        }
     }
 }
 
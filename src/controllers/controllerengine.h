@@ -11,6 +11,8 @@
 #include <QTimerEvent>
 #include <QFileSystemWatcher>
 #include <QMessageBox>
+#include <QMutex>
+#include <QSet>
 #include <QtScript>
 
 #include "bytearrayclass.h"
@@ -19,6 +21,7 @@
 #include "controllers/softtakeover.h"
 #include "util/alphabetafilter.h"
 #include "util/duration.h"
+#include "util/timerwheel.h"
 
 // Forward declaration(s)
 class Controller;
@@ -47,6 +50,32 @@ class ScriptConnection {
     }
 };
 
+// ScriptConnectionQueue collects the controls with script connections that
+// have changed, from the threads that change them. The controller thread
+// takes all of them at once and calls their connections with a single entry
+// into the script engine. A control that changes several times before that
+// is queued only once and its connections get the latest value.
+class ScriptConnectionQueue {
+  public:
+    explicit ScriptConnectionQueue(ControllerEngine* pEngine)
+            : m_pEngine(pEngine) {
+    }
+
+    // Thread-safe. Asks the engine to dispatch the queued controls when
+    // the queue was empty.
+    void enqueue(const ConfigKey& key);
+    QList<ConfigKey> takeAll();
+    // Called when the engine is deleted, because the queue is shared with
+    // control signals that may still be delivered
+    void detach();
+
+  private:
+    QMutex m_mutex;
+    ControllerEngine* m_pEngine;
+    QList<ConfigKey> m_keys;
+    QSet<ConfigKey> m_queuedKeys;
+};
+
 // ScriptConnectionInvokableWrapper is a class providing scripts
 // with an interface to ScriptConnection.
 class ScriptConnectionInvokableWrapper : public QObject {
@@ -91,6 +120,10 @@ class ControllerEngine : public QObject {
 
     // Wrap a snippet of JS code in an anonymous function
     QScriptValue wrapFunctionCode(const QString& codeSnippet, int numberOfArgs);
+    // Wraps all snippets that are not wrapped yet with a single evaluation,
+    // so that the handlers of a preset are resolved when it is loaded
+    // instead of with their first message
+    void wrapFunctionCodes(const QStringList& codeSnippets, int numberOfArgs);
     QScriptValue getThisObjectInFunctionCall();
 
     // Look up registered script function prefixes
@@ -165,9 +198,16 @@ class ControllerEngine : public QObject {
 
   private slots:
     void errorDialogButton(const QString& key, QMessageBox::StandardButton button);
+    // Calls the script connections of the controls in the queue
+    void slotDispatchScriptConnections();
 
   private:
     bool syntaxIsValid(const QString& scriptCode);
+    static QString wrapperCode(const QString& codeSnippet, int numberOfArgs);
+    // Returns the cached program of the script file or an invalid program
+    // if the code has a syntax error
+    QScriptProgram compileScriptFile(const QString& filename,
+                                     const QString& scriptCode);
     bool evaluate(const QString& scriptName, QList<QString> scriptPaths);
     bool internalExecute(QScriptValue thisObject, const QString& scriptCode);
     bool internalExecute(QScriptValue thisObject, QScriptValue functionObject,
@@ -178,6 +218,8 @@ class ControllerEngine : public QObject {
     void generateScriptFunctions(const QString& code);
     // Stops and removes all timers (for shutdown).
     void stopAllTimers();
+    // Advances the wheel of the script timers to the current time
+    void advanceTimerWheel();
 
     void callFunctionOnObjects(QList<QString>, const QString&, QScriptValueList args = QScriptValueList());
     bool checkException();
@@ -196,12 +238,35 @@ class ControllerEngine : public QObject {
     QList<QString> m_scriptFunctionPrefixes;
     QMap<QString, QStringList> m_scriptErrors;
     QHash<ConfigKey, ControlObjectScript*> m_controlCache;
+    QSharedPointer<ScriptConnectionQueue> m_pScriptConnectionQueue;
+    // A script function that calls a batch of script connections. Its
+    // argument arrays are reused by every dispatch.
+    QScriptValue m_scriptConnectionDispatcher;
+    QScriptValue m_dispatchCallbacks;
+    QScriptValue m_dispatchContexts;
+    QScriptValue m_dispatchValues;
+    QScriptValue m_dispatchGroups;
+    QScriptValue m_dispatchItems;
+    QVector<ScriptConnection> m_dispatchedConnections;
+    // The group and item of the connected controls as script strings
+    QHash<ConfigKey, QPair<QScriptValue, QScriptValue>> m_scriptControlKeys;
     struct TimerInfo {
+        TimerInfo()
+                : timerId(0),
+                  oneShot(false) {
+        }
+        int timerId;
         QScriptValue callback;
         QScriptValue context;
         bool oneShot;
     };
-    QHash<int, TimerInfo> m_timers;
+    // The script timers are kept in a timer wheel that is advanced by a
+    // single timer while any of them is running. Their callbacks are
+    // indexed by the pool index of their id.
+    TimerWheel m_timerWheel;
+    QVector<TimerInfo> m_timers;
+    QVector<int> m_expiredTimerIds;
+    int m_timerWheelTickId;
     SoftTakeoverCtrl m_st;
     ByteArrayClass* m_pBaClass;
     // 256 (default) available virtual decks is enough I would think.
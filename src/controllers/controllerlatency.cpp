@@ -0,0 +1,202 @@
+#include "controllers/controllerlatency.h"
+
+#include <QStringList>
+
+#include "controllers/controllerdebug.h"
+#include "util/cmdlineargs.h"
+#include "util/math.h"
+#include "util/time.h"
+#include "util/timer.h"
+
+namespace {
+
+// The percentiles are reported about this often while there is input
+const int kReportIntervalMillis = 10000;
+
+const double kPercentiles[] = { 0.5, 0.9, 0.99 };
+
+// The engine stage is measured for all controllers together
+const QString kEngineStatKey = QStringLiteral("Controller latency engine");
+
+QString percentileName(double fraction) {
+    return QString("p%1").arg(fraction * 100);
+}
+
+} // anonymous namespace
+
+const int ControllerLatency::kHistogramBuckets;
+const qint64 ControllerLatency::kHistogramBucketNanos;
+
+QAtomicInteger<qint64> ControllerLatency::s_enginePendingNanos(0);
+ControllerLatency::Histogram ControllerLatency::s_engineHistogram;
+
+ControllerLatency::Histogram::Histogram() {
+    for (int i = 0; i < kHistogramBuckets; ++i) {
+        buckets[i] = 0;
+    }
+}
+
+void ControllerLatency::Histogram::record(qint64 nanos) {
+    const int bucket = static_cast<int>(math_clamp(
+            nanos / kHistogramBucketNanos,
+            static_cast<qint64>(0),
+            static_cast<qint64>(kHistogramBuckets - 1)));
+    buckets[bucket].fetchAndAddRelaxed(1);
+}
+
+mixxx::Duration ControllerLatency::Histogram::percentile(double fraction) const {
+    int counts[kHistogramBuckets];
+    qint64 total = 0;
+    for (int i = 0; i < kHistogramBuckets; ++i) {
+        counts[i] = buckets[i].load();
+        total += counts[i];
+    }
+    if (total == 0) {
+        return mixxx::Duration::empty();
+    }
+    const qint64 target = static_cast<qint64>(ceil(fraction * total));
+    qint64 count = 0;
+    for (int i = 0; i < kHistogramBuckets; ++i) {
+        count += counts[i];
+        if (count >= target) {
+            return mixxx::Duration::fromNanos((i + 1) * kHistogramBucketNanos);
+        }
+    }
+    return mixxx::Duration::fromNanos(kHistogramBuckets * kHistogramBucketNanos);
+}
+
+ControllerLatency::ControllerLatency()
+        : m_receivedNanos(0),
+          m_handlerStartNanos(0),
+          m_outputPendingNanos(0) {
+}
+
+// static
+QString ControllerLatency::stageName(Stage stage) {
+    switch (stage) {
+        case DRIVER:
+            return "driver";
+        case HANDLER:
+            return "handler";
+        case ENGINE:
+            return "engine";
+        case OUTPUT:
+            return "output";
+        default:
+            return "unknown";
+    }
+}
+
+// static
+bool ControllerLatency::isEnabled() {
+    return CmdlineArgs::Instance().getDeveloper() || ControllerDebug::enabled();
+}
+
+void ControllerLatency::inputReceived(const QString& controllerName,
+                                      mixxx::Duration timestamp) {
+    if (!isEnabled()) {
+        m_receivedNanos = 0;
+        return;
+    }
+    if (m_controllerName != controllerName) {
+        m_controllerName = controllerName;
+        for (int stage = 0; stage < NUM_STAGES; ++stage) {
+            m_statKeys[stage] = QString("Controller %1 latency %2").arg(
+                    controllerName, stageName(static_cast<Stage>(stage)));
+        }
+    }
+    const qint64 nowNanos = mixxx::Time::elapsed().toIntegerNanos();
+    m_receivedNanos = timestamp.toIntegerNanos();
+    // Timestamps of another clock would give bogus latencies
+    if (m_receivedNanos <= 0 || m_receivedNanos > nowNanos) {
+        m_receivedNanos = nowNanos;
+    }
+    record(DRIVER, nowNanos - m_receivedNanos);
+    m_handlerStartNanos = nowNanos;
+}
+
+void ControllerLatency::inputHandled() {
+    if (m_receivedNanos == 0) {
+        return;
+    }
+    const qint64 nowNanos = mixxx::Time::elapsed().toIntegerNanos();
+    record(HANDLER, nowNanos - m_handlerStartNanos);
+    if (m_outputPendingNanos == 0) {
+        m_outputPendingNanos = m_receivedNanos;
+    }
+    // Only the oldest input that is waiting for the engine is measured
+    s_enginePendingNanos.testAndSetRelaxed(0, m_receivedNanos);
+    m_receivedNanos = 0;
+
+    if (!m_reportTimer.isValid()) {
+        m_reportTimer.start();
+    } else if (m_reportTimer.elapsed() >= kReportIntervalMillis) {
+        m_reportTimer.restart();
+        reportPercentiles();
+    }
+}
+
+void ControllerLatency::outputSent() {
+    if (m_outputPendingNanos == 0) {
+        return;
+    }
+    record(OUTPUT, mixxx::Time::elapsed().toIntegerNanos() - m_outputPendingNanos);
+    m_outputPendingNanos = 0;
+}
+
+// static
+void ControllerLatency::engineCallbackStarted() {
+    if (s_enginePendingNanos.loadAcquire() == 0) {
+        return;
+    }
+    const qint64 receivedNanos = s_enginePendingNanos.fetchAndStoreRelaxed(0);
+    if (receivedNanos == 0) {
+        return;
+    }
+    const qint64 nanos = mixxx::Time::elapsed().toIntegerNanos() - receivedNanos;
+    s_engineHistogram.record(nanos);
+    Stat::track(kEngineStatKey, Stat::DURATION_NANOSEC,
+                kDefaultComputeFlags, nanos);
+}
+
+mixxx::Duration ControllerLatency::percentile(Stage stage, double fraction) const {
+    if (stage == ENGINE) {
+        return s_engineHistogram.percentile(fraction);
+    }
+    return m_histograms[stage].percentile(fraction);
+}
+
+QString ControllerLatency::summary() const {
+    QStringList stages;
+    for (int stage = 0; stage < NUM_STAGES; ++stage) {
+        QStringList percentiles;
+        for (double fraction : kPercentiles) {
+            percentiles << percentileName(fraction) + "=" +
+                    percentile(static_cast<Stage>(stage), fraction)
+                            .formatMillisWithUnit();
+        }
+        stages << stageName(static_cast<Stage>(stage)) + ": " +
+                percentiles.join(" ");
+    }
+    return QString("%1 latency: %2").arg(m_controllerName, stages.join(", "));
+}
+
+void ControllerLatency::record(Stage stage, qint64 nanos) {
+    m_histograms[stage].record(nanos);
+    Stat::track(m_statKeys[stage], Stat::DURATION_NANOSEC,
+                kDefaultComputeFlags, nanos);
+}
+
+void ControllerLatency::reportPercentiles() {
+    for (int stage = 0; stage < NUM_STAGES; ++stage) {
+        const QString& statKey = stage == ENGINE ?
+                kEngineStatKey : m_statKeys[stage];
+        for (double fraction : kPercentiles) {
+            Stat::track(statKey + " " + percentileName(fraction),
+                        Stat::DURATION_NANOSEC, kDefaultComputeFlags,
+                        percentile(static_cast<Stage>(stage), fraction)
+                                .toIntegerNanos());
+        }
+    }
+    controllerDebug(summary());
+}
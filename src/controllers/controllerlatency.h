@@ -0,0 +1,98 @@
+#ifndef CONTROLLERS_CONTROLLERLATENCY_H
+#define CONTROLLERS_CONTROLLERLATENCY_H
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QString>
+#include <QTime>
+
+#include "util/class.h"
+#include "util/duration.h"
+
+// Measures the latency of the input of a controller along its path through
+// Mixxx, starting at the timestamp of the driver. The latencies are
+// accumulated into lock-free histograms. Each measurement is reported to the
+// StatsManager, and the percentiles are reported and printed with the
+// controller debug output periodically.
+//
+// The engine does not know which controller has set a control, so the
+// latency until the engine picks up the input is measured for the input of
+// all controllers together.
+//
+// Latencies are only measured in developer mode or with the controller debug
+// output, otherwise all calls return immediately.
+class ControllerLatency {
+  public:
+    enum Stage {
+        // Until the controller thread handles the message
+        DRIVER = 0,
+        // The time that the mapping or the script handler takes
+        HANDLER,
+        // Until the engine starts the next callback, which picks up the
+        // controls that the handler has set
+        ENGINE,
+        // Until the next message is sent to the device, e.g. the feedback of
+        // an LED
+        OUTPUT,
+        NUM_STAGES
+    };
+
+    // The histograms have kHistogramBuckets buckets of kHistogramBucketNanos
+    // each, the last one also counts all longer latencies.
+    static const int kHistogramBuckets = 200;
+    static const qint64 kHistogramBucketNanos = 250000;
+
+    ControllerLatency();
+
+    static QString stageName(Stage stage);
+
+    static bool isEnabled();
+
+    // The following functions must only be called from the controller
+    // thread.
+
+    // Called when a message of the given driver timestamp is handled
+    void inputReceived(const QString& controllerName, mixxx::Duration timestamp);
+    // Called when the handlers of the message have returned
+    void inputHandled();
+    void outputSent();
+
+    // Called by the engine at the start of each callback
+    static void engineCallbackStarted();
+
+    // Returns the latency that the given fraction of the measurements of the
+    // stage do not exceed, rounded up to the histogram buckets
+    mixxx::Duration percentile(Stage stage, double fraction) const;
+
+    QString summary() const;
+
+  private:
+    struct Histogram {
+        Histogram();
+        void record(qint64 nanos);
+        mixxx::Duration percentile(double fraction) const;
+
+        QAtomicInt buckets[kHistogramBuckets];
+    };
+
+    void record(Stage stage, qint64 nanos);
+    void reportPercentiles();
+
+    QString m_controllerName;
+    qint64 m_receivedNanos;
+    qint64 m_handlerStartNanos;
+    // The received time of the oldest input since the last output, or 0
+    qint64 m_outputPendingNanos;
+    Histogram m_histograms[NUM_STAGES];
+    QString m_statKeys[NUM_STAGES];
+    QTime m_reportTimer;
+
+    // The driver timestamp of the oldest input that the engine has not
+    // picked up yet, or 0
+    static QAtomicInteger<qint64> s_enginePendingNanos;
+    static Histogram s_engineHistogram;
+
+    DISALLOW_COPY_AND_ASSIGN(ControllerLatency);
+};
+
+#endif // CONTROLLERS_CONTROLLERLATENCY_H
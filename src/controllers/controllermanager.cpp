@@ -13,7 +13,9 @@
 #include "controllers/controllerlearningeventfilter.h"
 #include "util/cmdlineargs.h"
 #include "util/time.h"
+#include "util/threadroles.h"
 
+#include "controllers/midi/midioutputscheduler.h"
 #include "controllers/midi/portmidienumerator.h"
 #ifdef __HSS1394__
 #include "controllers/midi/hss1394enumerator.h"
@@ -116,6 +118,8 @@ ControllerLearningEventFilter* ControllerManager::getControllerLearningEventFilt
 
 void ControllerManager::slotInitialize() {
     qDebug() << "ControllerManager:slotInitialize";
+    // Runs in the controller thread
+    mixxx::ThreadRoles::applyToCurrentThread(mixxx::ThreadRole::Controller);
 
     // Initialize preset info parsers. This object is only for use in the main
     // thread. Do not touch it from within ControllerManager.
@@ -255,6 +259,7 @@ void ControllerManager::slotSetUpDevices() {
             qWarning() << "There was a problem opening" << name;
             continue;
         }
+        applyOutputRateLimit(pController);
         pController->applyPreset(getPresetPaths(m_pConfig), true);
     }
 
@@ -334,6 +339,14 @@ void ControllerManager::pollDevices() {
     //qDebug() << "ControllerManager::pollDevices()" << duration << start;
 }
 
+void ControllerManager::applyOutputRateLimit(Controller* pController) {
+    pController->setOutputRateLimit(
+            m_pConfig->getValue(ConfigKey("[Controller]", "OutputFrameRate"),
+                    MidiOutputScheduler::kDefaultFramesPerSecond),
+            m_pConfig->getValue(ConfigKey("[Controller]", "OutputBytesPerSecond"),
+                    MidiOutputScheduler::kDefaultBytesPerSecond));
+}
+
 void ControllerManager::openController(Controller* pController) {
     if (!pController) {
         return;
@@ -347,6 +360,7 @@ void ControllerManager::openController(Controller* pController) {
     // If successfully opened the device, apply the preset and save the
     // preference setting.
     if (result == 0) {
+        applyOutputRateLimit(pController);
         pController->applyPreset(getPresetPaths(m_pConfig), true);
 
         // Update configuration to reflect controller is enabled.
@@ -84,6 +84,7 @@ class ControllerManager : public QObject {
     void startPolling();
     void stopPolling();
     void maybeStartOrStopPolling();
+    void applyOutputRateLimit(Controller* pController);
 
     static QString presetFilenameFromName(QString name) {
         return name.replace(" ", "_").replace("/", "_").replace("\\", "_");
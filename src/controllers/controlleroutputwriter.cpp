@@ -0,0 +1,61 @@
+#include "controllers/controlleroutputwriter.h"
+
+#include <QMutexLocker>
+
+#include "util/assert.h"
+
+ControllerOutputWriter::ControllerOutputWriter()
+        : QThread(),
+          m_bStop(false) {
+}
+
+ControllerOutputWriter::~ControllerOutputWriter() {
+    // Subclasses must stop the thread before their write() is gone
+    DEBUG_ASSERT(!isRunning());
+}
+
+void ControllerOutputWriter::enqueue(int key, const QByteArray& report) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_lastReports.find(key);
+    if (it != m_lastReports.end()) {
+        if (it.value() == report) {
+            // The device has this report already or is about to get it
+            return;
+        }
+        it.value() = report;
+    } else {
+        m_lastReports.insert(key, report);
+    }
+
+    if (!m_pendingReports.contains(key)) {
+        m_pendingKeys.append(key);
+    }
+    m_pendingReports.insert(key, report);
+    m_reportsPending.wakeOne();
+}
+
+void ControllerOutputWriter::stop() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bStop = true;
+        m_reportsPending.wakeOne();
+    }
+    wait();
+}
+
+void ControllerOutputWriter::run() {
+    QMutexLocker locker(&m_mutex);
+    while (true) {
+        while (m_pendingKeys.isEmpty() && !m_bStop) {
+            m_reportsPending.wait(&m_mutex);
+        }
+        if (m_pendingKeys.isEmpty()) {
+            break;
+        }
+        const QByteArray report = m_pendingReports.take(m_pendingKeys.takeFirst());
+        // Newer reports are enqueued while this one is written
+        locker.unlock();
+        write(report);
+        locker.relock();
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef CONTROLLERS_CONTROLLEROUTPUTWRITER_H
+#define CONTROLLERS_CONTROLLEROUTPUTWRITER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "util/class.h"
+
+// Writes the output reports of a controller on a thread of its own, so
+// that a slow device does not block the controller thread that processes
+// the input and runs the scripts.
+//
+// Reports are identified by a key, e.g. the report ID of a HID report. A
+// report that is equal to the previous one with its key is dropped, and a
+// pending report is replaced by a newer one with the same key. While the
+// device is busy the updates of a report are thus merged into a single
+// write.
+class ControllerOutputWriter : public QThread {
+    Q_OBJECT
+  public:
+    ControllerOutputWriter();
+    ~ControllerOutputWriter() override;
+
+    // Called from the controller thread and the threads that render its
+    // screens
+    void enqueue(int key, const QByteArray& report);
+
+    // Writes the pending reports and waits until the thread has finished
+    void stop();
+
+  protected:
+    void run() override;
+
+    // Writes the report to the device
+    virtual void write(const QByteArray& report) = 0;
+
+  private:
+    QMutex m_mutex;
+    // The report that has been enqueued last for each key
+    QHash<int, QByteArray> m_lastReports;
+    QWaitCondition m_reportsPending;
+    QList<int> m_pendingKeys;
+    QHash<int, QByteArray> m_pendingReports;
+    bool m_bStop;
+
+    DISALLOW_COPY_AND_ASSIGN(ControllerOutputWriter);
+};
+
+#endif // CONTROLLERS_CONTROLLEROUTPUTWRITER_H
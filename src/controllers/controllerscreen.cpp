@@ -0,0 +1,266 @@
+#include "controllers/controllerscreen.h"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QtEndian>
+
+#include "controllers/controlleroutputwriter.h"
+#include "util/math.h"
+
+namespace {
+
+const int kDefaultTileSize = 32;
+
+QColor colorFromRgb(int color) {
+    return QColor(QRgb(0xFF000000 | (color & 0xFFFFFF)));
+}
+
+void appendBigEndian16(QByteArray* pData, int value) {
+    pData->append(static_cast<char>((value >> 8) & 0xFF));
+    pData->append(static_cast<char>(value & 0xFF));
+}
+
+} // anonymous namespace
+
+// static
+bool ControllerScreen::pixelFormatFromName(const QString& name,
+                                           PixelFormat* pFormat) {
+    const QString lowerName = name.toLower();
+    if (lowerName == "rgb565le") {
+        *pFormat = PixelFormat::RGB565_LE;
+    } else if (lowerName == "rgb565be") {
+        *pFormat = PixelFormat::RGB565_BE;
+    } else if (lowerName == "rgb888") {
+        *pFormat = PixelFormat::RGB888;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+ControllerScreen::ControllerScreen(ControllerOutputWriter* pWriter, int keyBase,
+                                   int width, int height, PixelFormat format,
+                                   int framesPerSecond)
+        : m_pRenderer(new ControllerScreenRenderer(pWriter, keyBase,
+                width, height, format, framesPerSecond)),
+          m_size(width, height),
+          m_tileSize(kDefaultTileSize, kDefaultTileSize) {
+    m_pRenderer->start(QThread::LowPriority);
+}
+
+ControllerScreen::~ControllerScreen() {
+    if (m_painter.isActive()) {
+        m_painter.end();
+    }
+    m_pRenderer->stop();
+}
+
+QPainter* ControllerScreen::painter() {
+    if (!m_painter.isActive()) {
+        m_picture = QPicture();
+        m_painter.begin(&m_picture);
+        m_painter.setRenderHint(QPainter::Antialiasing);
+        m_painter.setRenderHint(QPainter::TextAntialiasing);
+    }
+    return &m_painter;
+}
+
+void ControllerScreen::setHeader(QList<int> header) {
+    m_header.clear();
+    for (int byte : header) {
+        m_header.append(static_cast<char>(byte));
+    }
+}
+
+void ControllerScreen::setTileSize(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        qWarning() << "ControllerScreen: Invalid tile size" << width << height;
+        return;
+    }
+    m_tileSize = QSize(width, height);
+}
+
+void ControllerScreen::clear(int color) {
+    painter()->fillRect(QRect(QPoint(0, 0), m_size), colorFromRgb(color));
+}
+
+void ControllerScreen::fillRect(int x, int y, int width, int height,
+                                int color) {
+    painter()->fillRect(x, y, width, height, colorFromRgb(color));
+}
+
+void ControllerScreen::drawLine(int x1, int y1, int x2, int y2, int color,
+                                int lineWidth) {
+    QPainter* pPainter = painter();
+    pPainter->setPen(QPen(colorFromRgb(color), lineWidth));
+    pPainter->drawLine(x1, y1, x2, y2);
+}
+
+void ControllerScreen::drawText(int x, int y, int width, int height,
+                                QString text, int pixelSize, int color,
+                                int alignment) {
+    QPainter* pPainter = painter();
+    QFont font = pPainter->font();
+    font.setPixelSize(math_max(1, pixelSize));
+    pPainter->setFont(font);
+    pPainter->setPen(colorFromRgb(color));
+    pPainter->drawText(QRect(x, y, width, height), alignment, text);
+}
+
+void ControllerScreen::drawImage(int x, int y, QString path) {
+    auto it = m_images.find(path);
+    if (it == m_images.end()) {
+        QImage image(path);
+        if (image.isNull()) {
+            qWarning() << "ControllerScreen: Failed to load" << path;
+        }
+        it = m_images.insert(path, image);
+    }
+    if (!it.value().isNull()) {
+        painter()->drawImage(x, y, it.value());
+    }
+}
+
+void ControllerScreen::commit() {
+    // An empty frame keeps the screen as it is
+    if (!m_painter.isActive()) {
+        return;
+    }
+    m_painter.end();
+    ControllerScreenRenderer::Frame frame;
+    frame.picture = m_picture;
+    frame.header = m_header;
+    frame.tileSize = m_tileSize;
+    m_pRenderer->setFrame(frame);
+}
+
+ControllerScreenRenderer::ControllerScreenRenderer(
+        ControllerOutputWriter* pWriter, int keyBase, int width, int height,
+        ControllerScreen::PixelFormat format, int framesPerSecond)
+        : QThread(),
+          m_pWriter(pWriter),
+          m_keyBase(keyBase),
+          m_format(format),
+          m_frameIntervalMillis(1000 / math_max(1, framesPerSecond)),
+          m_image(width, height, format == ControllerScreen::PixelFormat::RGB888 ?
+                  QImage::Format_RGB888 : QImage::Format_RGB16),
+          m_bFramePending(false),
+          m_bStop(false) {
+    m_image.fill(Qt::black);
+}
+
+ControllerScreenRenderer::~ControllerScreenRenderer() {
+    stop();
+}
+
+void ControllerScreenRenderer::setFrame(const Frame& frame) {
+    QMutexLocker locker(&m_mutex);
+    m_pendingFrame = frame;
+    m_bFramePending = true;
+    m_framePending.wakeOne();
+}
+
+void ControllerScreenRenderer::stop() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bStop = true;
+        m_framePending.wakeOne();
+    }
+    wait();
+}
+
+void ControllerScreenRenderer::run() {
+    QElapsedTimer frameTimer;
+    QMutexLocker locker(&m_mutex);
+    while (true) {
+        while (!m_bFramePending && !m_bStop) {
+            m_framePending.wait(&m_mutex);
+        }
+        if (!m_bFramePending) {
+            break;
+        }
+        // Frames that are committed until the next frame is due replace
+        // the pending one
+        if (!m_bStop && frameTimer.isValid()) {
+            const qint64 elapsedMillis = frameTimer.elapsed();
+            if (elapsedMillis < static_cast<qint64>(m_frameIntervalMillis)) {
+                m_framePending.wait(&m_mutex,
+                        m_frameIntervalMillis - elapsedMillis);
+                continue;
+            }
+        }
+        const Frame frame = m_pendingFrame;
+        m_pendingFrame = Frame();
+        m_bFramePending = false;
+        locker.unlock();
+        frameTimer.start();
+        render(frame);
+        locker.relock();
+    }
+}
+
+int ControllerScreenRenderer::render(const Frame& frame) {
+    // Painting detaches the image from the previous one. A frame is drawn
+    // over the previous frame.
+    m_previousImage = m_image;
+    {
+        QPainter painter(&m_image);
+        frame.picture.play(&painter);
+    }
+
+    const QSize tileSize = frame.tileSize;
+    const int bytesPerPixel = m_image.depth() / 8;
+    const int tileColumns = (m_image.width() + tileSize.width() - 1) /
+            tileSize.width();
+    int sentTiles = 0;
+    for (int y = 0; y < m_image.height(); y += tileSize.height()) {
+        for (int x = 0; x < m_image.width(); x += tileSize.width()) {
+            const QRect tile = QRect(QPoint(x, y), tileSize)
+                    .intersected(m_image.rect());
+            const int tileKey = m_keyBase + (y / tileSize.height()) *
+                    tileColumns + x / tileSize.width();
+            bool changed = false;
+            for (int line = tile.top(); line <= tile.bottom() && !changed; ++line) {
+                changed = memcmp(
+                        m_image.constScanLine(line) + tile.left() * bytesPerPixel,
+                        m_previousImage.constScanLine(line) + tile.left() * bytesPerPixel,
+                        tile.width() * bytesPerPixel) != 0;
+            }
+            if (changed) {
+                m_pWriter->enqueue(tileKey, encodeTile(frame.header, tile));
+                ++sentTiles;
+            }
+        }
+    }
+    return sentTiles;
+}
+
+QByteArray ControllerScreenRenderer::encodeTile(const QByteArray& header,
+                                                const QRect& rect) const {
+    const int bytesPerPixel = m_image.depth() / 8;
+    QByteArray data;
+    data.reserve(header.size() + 8 + rect.width() * rect.height() * bytesPerPixel);
+    data.append(header);
+    appendBigEndian16(&data, rect.x());
+    appendBigEndian16(&data, rect.y());
+    appendBigEndian16(&data, rect.width());
+    appendBigEndian16(&data, rect.height());
+
+    // QImage::Format_RGB16 keeps the pixels in the byte order of the host
+    const bool bSwap = m_format != ControllerScreen::PixelFormat::RGB888 &&
+            ((m_format == ControllerScreen::PixelFormat::RGB565_BE) !=
+             (Q_BYTE_ORDER == Q_BIG_ENDIAN));
+    for (int line = rect.top(); line <= rect.bottom(); ++line) {
+        const char* pPixels = reinterpret_cast<const char*>(
+                m_image.constScanLine(line)) + rect.left() * bytesPerPixel;
+        const int offset = data.size();
+        data.append(pPixels, rect.width() * bytesPerPixel);
+        if (bSwap) {
+            char* pData = data.data() + offset;
+            for (int i = 0; i < rect.width(); ++i) {
+                qSwap(pData[2 * i], pData[2 * i + 1]);
+            }
+        }
+    }
+    return data;
+}
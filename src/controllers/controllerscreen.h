@@ -0,0 +1,132 @@
+#ifndef CONTROLLERS_CONTROLLERSCREEN_H
+#define CONTROLLERS_CONTROLLERSCREEN_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPainter>
+#include <QPicture>
+#include <QScopedPointer>
+#include <QSize>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "util/class.h"
+
+class ControllerOutputWriter;
+class ControllerScreenRenderer;
+
+// A screen of a controller, e.g. the display of a jog wheel, that scripts
+// draw on. The drawing commands of a frame are only recorded on the
+// controller thread. The frames are rendered by a thread of the screen at
+// most at its frame rate, and a frame that is committed while the previous
+// one waits to be rendered replaces it.
+//
+// Only the tiles of a frame that differ from the previous frame are encoded
+// in the pixel format of the device. Each tile is sent to the output writer
+// as a message of the header set by the script, followed by the x, y, width
+// and height of the tile as 16-bit big-endian values and its pixels row by
+// row. A tile whose previous message has not been written yet is replaced.
+class ControllerScreen : public QObject {
+    Q_OBJECT
+  public:
+    enum class PixelFormat {
+        RGB565_LE,
+        RGB565_BE,
+        RGB888,
+    };
+
+    // Returns false if the name is not one of "rgb565le", "rgb565be" or
+    // "rgb888"
+    static bool pixelFormatFromName(const QString& name, PixelFormat* pFormat);
+
+    // The messages are enqueued with keys starting at keyBase
+    ControllerScreen(ControllerOutputWriter* pWriter, int keyBase,
+                     int width, int height, PixelFormat format,
+                     int framesPerSecond);
+    // Renders the last committed frame and stops the thread
+    ~ControllerScreen() override;
+
+    // The script interface, which must be called from the controller thread
+    Q_INVOKABLE void setHeader(QList<int> header);
+    Q_INVOKABLE void setTileSize(int width, int height);
+    // Colors are given as 0xRRGGBB
+    Q_INVOKABLE void clear(int color);
+    Q_INVOKABLE void fillRect(int x, int y, int width, int height, int color);
+    Q_INVOKABLE void drawLine(int x1, int y1, int x2, int y2, int color,
+                              int lineWidth = 1);
+    Q_INVOKABLE void drawText(int x, int y, int width, int height,
+                              QString text, int pixelSize, int color,
+                              int alignment = Qt::AlignLeft | Qt::AlignVCenter);
+    // The image files are loaded once
+    Q_INVOKABLE void drawImage(int x, int y, QString path);
+    // Hands the commands that have been drawn since the last commit to the
+    // renderer, which draws them over the previous frame
+    Q_INVOKABLE void commit();
+
+  private:
+    QPainter* painter();
+
+    QScopedPointer<ControllerScreenRenderer> m_pRenderer;
+    const QSize m_size;
+    QByteArray m_header;
+    QSize m_tileSize;
+    QPicture m_picture;
+    QPainter m_painter;
+    QHash<QString, QImage> m_images;
+
+    DISALLOW_COPY_AND_ASSIGN(ControllerScreen);
+};
+
+// Renders the frames of a ControllerScreen on a thread of its own
+class ControllerScreenRenderer : public QThread {
+    Q_OBJECT
+  public:
+    struct Frame {
+        QPicture picture;
+        QByteArray header;
+        QSize tileSize;
+    };
+
+    ControllerScreenRenderer(ControllerOutputWriter* pWriter, int keyBase,
+                             int width, int height,
+                             ControllerScreen::PixelFormat format,
+                             int framesPerSecond);
+    ~ControllerScreenRenderer() override;
+
+    // Replaces the frame that has not been rendered yet
+    void setFrame(const Frame& frame);
+
+    // Renders the pending frame and waits until the thread has finished
+    void stop();
+
+    // Renders the frame and sends the tiles that have changed since the
+    // previous one. Returns the number of sent tiles.
+    int render(const Frame& frame);
+
+  protected:
+    void run() override;
+
+  private:
+    QByteArray encodeTile(const QByteArray& header, const QRect& rect) const;
+
+    ControllerOutputWriter* const m_pWriter;
+    const int m_keyBase;
+    const ControllerScreen::PixelFormat m_format;
+    const unsigned long m_frameIntervalMillis;
+    QImage m_image;
+    QImage m_previousImage;
+
+    QMutex m_mutex;
+    QWaitCondition m_framePending;
+    Frame m_pendingFrame;
+    bool m_bFramePending;
+    bool m_bStop;
+
+    DISALLOW_COPY_AND_ASSIGN(ControllerScreenRenderer);
+};
+
+#endif // CONTROLLERS_CONTROLLERSCREEN_H
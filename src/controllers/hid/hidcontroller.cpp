@@ -48,8 +48,30 @@ void HidReader::run() {
     delete [] data;
 }
 
+HidWriter::HidWriter(hid_device* device, const QString& deviceName)
+        : m_pHidDevice(device),
+          m_deviceName(deviceName) {
+}
+
+HidWriter::~HidWriter() {
+    stop();
+}
+
+void HidWriter::write(const QByteArray& report) {
+    int result = hid_write(m_pHidDevice, (unsigned char*)report.constData(), report.size());
+    if (result == -1) {
+        qWarning() << "Unable to send data to" << m_deviceName << ":"
+                   << HidController::safeDecodeWideString(hid_error(m_pHidDevice), 512);
+    } else {
+        controllerDebug(result << "bytes sent to" << m_deviceName
+                 << "(including report ID of"
+                 << static_cast<unsigned char>(report.at(0)) << ")");
+    }
+}
+
 HidController::HidController(const hid_device_info deviceInfo)
-        : m_pHidDevice(NULL) {
+        : m_pHidDevice(NULL),
+          m_pWriter(NULL) {
     // Copy required variables from deviceInfo, which will be freed after
     // this class is initialized by caller.
     hid_vendor_id = deviceInfo.vendor_id;
@@ -242,6 +264,11 @@ int HidController::open() {
         return -1;
     }
 
+    // The scripts send their first reports when the engine starts
+    m_pWriter = new HidWriter(m_pHidDevice, getName());
+    m_pWriter->setObjectName(QString("HidWriter %1").arg(getName()));
+    m_pWriter->start(QThread::HighPriority);
+
     setOpen(true);
     startEngine();
 
@@ -289,6 +316,13 @@ int HidController::close() {
     //  incase it has any final parting messages
     stopEngine();
 
+    // Writes the final reports
+    if (m_pWriter != NULL) {
+        controllerDebug("  Waiting on writer to finish");
+        delete m_pWriter;
+        m_pWriter = NULL;
+    }
+
     // Close device
     controllerDebug("  Closing device");
     hid_close(m_pHidDevice);
@@ -310,24 +344,18 @@ void HidController::send(QByteArray data) {
 }
 
 void HidController::send(QByteArray data, unsigned int reportID) {
+    if (m_pWriter == NULL) {
+        qWarning() << "HID device" << getName() << "not open for output!";
+        return;
+    }
     // Append the Report ID to the beginning of data[] per the API..
     data.prepend(reportID);
-
-    int result = hid_write(m_pHidDevice, (unsigned char*)data.constData(), data.size());
-    if (result == -1) {
-        if (ControllerDebug::enabled()) {
-            qWarning() << "Unable to send data to" << getName()
-                       << "serial #" << hid_serial << ":"
-                       << safeDecodeWideString(hid_error(m_pHidDevice), 512);
-        } else {
-            qWarning() << "Unable to send data to" << getName() << ":"
-                       << safeDecodeWideString(hid_error(m_pHidDevice), 512);
-        }
-    } else {
-        controllerDebug(result << "bytes sent to" << getName()
-                 << "serial #" << hid_serial
-                 << "(including report ID of" << reportID << ")");
-    }
+    // Devices with few report IDs often tell their reports apart by the
+    // first byte of the data
+    const int key = (static_cast<int>(reportID) << 8) |
+            (data.size() > 1 ? static_cast<unsigned char>(data.at(1)) : 0);
+    m_pWriter->enqueue(key, data);
+    latency()->outputSent();
 }
 
 //static
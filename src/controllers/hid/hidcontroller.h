@@ -13,6 +13,7 @@
 #include <QAtomicInt>
 
 #include "controllers/controller.h"
+#include "controllers/controlleroutputwriter.h"
 #include "controllers/hid/hidcontrollerpreset.h"
 #include "controllers/hid/hidcontrollerpresetfilehandler.h"
 #include "util/duration.h"
@@ -38,6 +39,20 @@ class HidReader : public QThread {
     QAtomicInt m_stop;
 };
 
+class HidWriter : public ControllerOutputWriter {
+    Q_OBJECT
+  public:
+    HidWriter(hid_device* device, const QString& deviceName);
+    ~HidWriter() override;
+
+  protected:
+    void write(const QByteArray& report) override;
+
+  private:
+    hid_device* m_pHidDevice;
+    const QString m_deviceName;
+};
+
 class HidController : public Controller {
     Q_OBJECT
   public:
@@ -108,6 +123,7 @@ class HidController : public Controller {
     QString m_sUID;
     hid_device* m_pHidDevice;
     HidReader* m_pReader;
+    HidWriter* m_pWriter;
     HidControllerPreset m_preset;
 };
 
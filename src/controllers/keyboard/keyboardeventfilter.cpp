@@ -45,32 +45,35 @@ bool KeyboardEventFilter::eventFilter(QObject*, QEvent* e) {
             }
         }
 
-        QKeySequence ks = getKeySeq(ke);
-        if (!ks.isEmpty()) {
-            ConfigValueKbd ksv(ks);
+        const int keyCode = getKeyCode(ke);
+        if (keyCode != 0) {
+            if (CmdlineArgs::Instance().getDeveloper()) {
+                qDebug() << "keyboard press: " << QKeySequence(keyCode).toString();
+            }
             // Check if a shortcut is defined
             bool result = false;
-            // using const_iterator here is faster than QMultiHash::values()
-            for (QMultiHash<ConfigValueKbd, ConfigKey>::const_iterator it =
-                         m_keySequenceToControlHash.find(ksv);
-                 it != m_keySequenceToControlHash.end() && it.key() == ksv; ++it) {
-                const ConfigKey& configKey = it.value();
-                if (configKey.group != "[KeyboardShortcuts]") {
-                    ControlObject* control = ControlObject::getControl(configKey);
-                    if (control) {
-                        //qDebug() << configKey << "MIDI_NOTE_ON" << 1;
-                        // Add key to active key list
-                        m_qActiveKeyList.append(KeyDownInformation(
-                            keyId, ke->modifiers(), control));
-                        // Since setting the value might cause us to go down
-                        // a route that would eventually clear the active
-                        // key list, do that last.
-                        control->setValueFromMidi(MIDI_NOTE_ON, 1);
-                        result = true;
-                    } else {
-                        qDebug() << "Warning: Keyboard key is configured for nonexistent control:"
-                                 << configKey.group << configKey.item;
-                    }
+            const auto it = m_keyMappings.constFind(keyCode);
+            if (it == m_keyMappings.constEnd()) {
+                return false;
+            }
+            // Copy the mappings, since setting a value might change the
+            // keyboard config
+            const QVector<KeyMapping> mappings = it.value();
+            for (const KeyMapping& mapping : mappings) {
+                ControlObject* control = ControlObject::getControl(mapping.handle);
+                if (control) {
+                    //qDebug() << mapping.configKey << "MIDI_NOTE_ON" << 1;
+                    // Add key to active key list
+                    m_qActiveKeyList.append(KeyDownInformation(
+                        keyId, ke->modifiers(), control));
+                    // Since setting the value might cause us to go down
+                    // a route that would eventually clear the active
+                    // key list, do that last.
+                    control->setValueFromMidi(MIDI_NOTE_ON, 1);
+                    result = true;
+                } else {
+                    qDebug() << "Warning: Keyboard key is configured for nonexistent control:"
+                             << mapping.configKey.group << mapping.configKey.item;
                 }
             }
             return result;
@@ -120,50 +123,51 @@ bool KeyboardEventFilter::eventFilter(QObject*, QEvent* e) {
         // This event is not fired on ubunty natty, why?
         // TODO(XXX): find a way to support KeyboardLayoutChange Bug #997811
         //qDebug() << "QEvent::KeyboardLayoutChange";
+        buildKeyMappings();
     }
     return false;
 }
 
-QKeySequence KeyboardEventFilter::getKeySeq(QKeyEvent* e) {
-    QString modseq;
-    QKeySequence k;
-
-    // TODO(XXX) check if we may simply return QKeySequence(e->modifiers()+e->key())
-
-    if (e->modifiers() & Qt::ShiftModifier)
-        modseq += "Shift+";
-
-    if (e->modifiers() & Qt::ControlModifier)
-        modseq += "Ctrl+";
-
-    if (e->modifiers() & Qt::AltModifier)
-        modseq += "Alt+";
-
-    if (e->modifiers() & Qt::MetaModifier)
-        modseq += "Meta+";
-
-    if (e->key() >= 0x01000020 && e->key() <= 0x01000023) {
+// static
+int KeyboardEventFilter::getKeyCode(QKeyEvent* e) {
+    if (e->key() >= Qt::Key_Shift && e->key() <= Qt::Key_Alt) {
         // Do not act on Modifier only
         // avoid returning "khmer vowel sign ie (U+17C0)"
-        return k;
-    }
-
-    QString keyseq = QKeySequence(e->key()).toString();
-    k = QKeySequence(modseq + keyseq);
-
-    if (CmdlineArgs::Instance().getDeveloper()) {
-        qDebug() << "keyboard press: " << k.toString();
+        return 0;
     }
-    return k;
+    const int modifiers = e->modifiers() & (Qt::ShiftModifier |
+            Qt::ControlModifier | Qt::AltModifier | Qt::MetaModifier);
+    return e->key() | modifiers;
 }
 
 void KeyboardEventFilter::setKeyboardConfig(ConfigObject<ConfigValueKbd>* pKbdConfigObject) {
+    m_pKbdConfigObject = pKbdConfigObject;
+    buildKeyMappings();
+}
+
+void KeyboardEventFilter::buildKeyMappings() {
+    m_keyMappings.clear();
+    if (m_pKbdConfigObject == nullptr) {
+        return;
+    }
     // Keyboard configs are a surjection from ConfigKey to key sequence. We
     // invert the mapping to create an injection from key sequence to
     // ConfigKey. This allows a key sequence to trigger multiple controls in
     // Mixxx.
-    m_keySequenceToControlHash = pKbdConfigObject->transpose();
-    m_pKbdConfigObject = pKbdConfigObject;
+    const QMultiHash<ConfigValueKbd, ConfigKey> keySequenceToControlHash =
+            m_pKbdConfigObject->transpose();
+    for (auto it = keySequenceToControlHash.constBegin();
+            it != keySequenceToControlHash.constEnd(); ++it) {
+        const QKeySequence& keySequence = it.key().m_qKey;
+        if (keySequence.isEmpty() || it.value().group == "[KeyboardShortcuts]") {
+            continue;
+        }
+        // The handle is assigned even if the control does not exist yet
+        KeyMapping mapping;
+        mapping.configKey = it.value();
+        mapping.handle = ControlObject::getHandle(it.value());
+        m_keyMappings[keySequence[0]].append(mapping);
+    }
 }
 
 ConfigObject<ConfigValueKbd>* KeyboardEventFilter::getKeyboardConfig() {
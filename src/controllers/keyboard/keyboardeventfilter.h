@@ -4,8 +4,10 @@
 #include <QObject>
 #include <QEvent>
 #include <QKeyEvent>
-#include <QMultiHash>
+#include <QHash>
+#include <QVector>
 
+#include "control/controlhandle.h"
 #include "preferences/configobject.h"
 
 class ControlObject;
@@ -38,14 +40,23 @@ class KeyboardEventFilter : public QObject {
         ControlObject* pControl;
     };
 
-    // Returns a valid QString with modifier keys from a QKeyEvent
-    QKeySequence getKeySeq(QKeyEvent *e);
+    struct KeyMapping {
+        ConfigKey configKey;
+        ControlHandle handle;
+    };
+
+    // Returns the key code combined with the modifiers of a QKeyEvent, as in
+    // the first key of a QKeySequence, or 0 for a modifier key
+    static int getKeyCode(QKeyEvent* e);
+    // Resolves the controls of the keyboard config for each key code
+    void buildKeyMappings();
+
     // List containing keys which is currently pressed
     QList<KeyDownInformation> m_qActiveKeyList;
     // Pointer to keyboard config object
     ConfigObject<ConfigValueKbd> *m_pKbdConfigObject;
-    // Multi-hash of key sequence to
-    QMultiHash<ConfigValueKbd, ConfigKey> m_keySequenceToControlHash;
+    // The controls of each key code, which are triggered in this order
+    QHash<int, QVector<KeyMapping>> m_keyMappings;
 };
 
 #endif  // CONTROLLERS_KEYBOARD_KEYBOARDEVENTFILTER_H
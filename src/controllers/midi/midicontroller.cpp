@@ -11,6 +11,7 @@
 #include "controllers/midi/midiutils.h"
 #include "controllers/defs_controllers.h"
 #include "controllers/controllerdebug.h"
+#include "control/controlinputtime.h"
 #include "control/controlobject.h"
 #include "errordialoghandler.h"
 #include "mixer/playermanager.h"
@@ -18,7 +19,8 @@
 #include "util/screensaver.h"
 
 MidiController::MidiController()
-        : Controller() {
+        : Controller(),
+          m_outputScheduler(this) {
     setDeviceCategory(tr("MIDI Controller"));
 }
 
@@ -34,14 +36,40 @@ QString MidiController::presetExtension() {
 
 void MidiController::visit(const MidiControllerPreset* preset) {
     m_preset = *preset;
+    for (QHash<uint16_t, MidiInputMapping>::iterator it =
+                 m_preset.inputMappings.begin();
+         it != m_preset.inputMappings.end(); ++it) {
+        resolveControlHandle(&it.value());
+    }
+    m_inputMappingTable.build(m_preset.inputMappings);
     emit(presetLoaded(getPreset()));
 }
 
+// static
+void MidiController::resolveControlHandle(MidiInputMapping* pMapping) {
+    if (pMapping->options.script) {
+        pMapping->controlHandle = ControlHandle();
+    } else {
+        pMapping->controlHandle = ControlObject::getHandle(pMapping->control);
+    }
+}
+
 int MidiController::close() {
     destroyOutputHandlers();
+    // The outputs of the device are updated again when it is opened
+    m_outputScheduler.reset();
     return 0;
 }
 
+void MidiController::setOutputRateLimit(int framesPerSecond, int bytesPerSecond) {
+    m_outputScheduler.setRateLimit(framesPerSecond, bytesPerSecond);
+}
+
+void MidiController::sendShortMsg(unsigned char status, unsigned char byte1,
+                                  unsigned char byte2) {
+    m_outputScheduler.sendShortMsg(status, byte1, byte2);
+}
+
 void MidiController::visit(const HidControllerPreset* preset) {
     Q_UNUSED(preset);
     qWarning() << "ERROR: Attempting to load an HidControllerPreset to a MidiController!";
@@ -63,6 +91,18 @@ bool MidiController::applyPreset(QList<QString> scriptPaths, bool initializeScri
     // Handles the engine
     bool result = Controller::applyPreset(scriptPaths, initializeScripts);
 
+    // Resolves the script handlers of the input before the first message
+    ControllerEngine* pEngine = getEngine();
+    if (pEngine != NULL) {
+        QStringList codeSnippets;
+        for (const auto& mapping : m_preset.inputMappings) {
+            if (mapping.options.script) {
+                codeSnippets.append(mapping.control.item);
+            }
+        }
+        pEngine->wrapFunctionCodes(codeSnippets, 5);
+    }
+
     // Only execute this code if this is an output device
     if (isOutputDevice()) {
         if (m_outputs.count() > 0) {
@@ -162,7 +202,8 @@ void MidiController::destroyOutputHandlers() {
 }
 
 void MidiController::learnTemporaryInputMappings(const MidiInputMappings& mappings) {
-    foreach (const MidiInputMapping& mapping, mappings) {
+    foreach (MidiInputMapping mapping, mappings) {
+        resolveControlHandle(&mapping);
         m_temporaryInputMappings.insert(mapping.key.key, mapping);
 
         unsigned char opCode = MidiUtils::opCodeFromStatus(mapping.key.status);
@@ -196,6 +237,7 @@ void MidiController::commitTemporaryInputMappings() {
     // the original set.
     m_preset.inputMappings.unite(m_temporaryInputMappings);
     m_temporaryInputMappings.clear();
+    m_inputMappingTable.build(m_preset.inputMappings);
 }
 
 void MidiController::receive(unsigned char status, unsigned char control,
@@ -208,6 +250,8 @@ void MidiController::receive(unsigned char status, unsigned char control,
     MidiKey mappingKey(status, control);
 
     triggerActivity();
+    latency()->inputReceived(getName(), timestamp);
+    ControlInputTime::Scope inputTime(timestamp);
     if (isLearning()) {
         emit(messageReceived(status, control, value));
 
@@ -217,15 +261,18 @@ void MidiController::receive(unsigned char status, unsigned char control,
             for (; it != m_temporaryInputMappings.end() && it.key() == mappingKey.key; ++it) {
                 processInputMapping(it.value(), status, control, value, timestamp);
             }
+            latency()->inputHandled();
             return;
         }
     }
 
-    QHash<uint16_t, MidiInputMapping>::const_iterator it =
-            m_preset.inputMappings.find(mappingKey.key);
-    for (; it != m_preset.inputMappings.end() && it.key() == mappingKey.key; ++it) {
-        processInputMapping(it.value(), status, control, value, timestamp);
+    int count = 0;
+    const MidiInputMapping* pMappings =
+            m_inputMappingTable.find(status, control, &count);
+    for (int i = 0; i < count; ++i) {
+        processInputMapping(pMappings[i], status, control, value, timestamp);
     }
+    latency()->inputHandled();
 }
 
 void MidiController::processInputMapping(const MidiInputMapping& mapping,
@@ -253,7 +300,9 @@ void MidiController::processInputMapping(const MidiInputMapping& mapping,
     }
 
     // Only pass values on to valid ControlObjects.
-    ControlObject* pCO = ControlObject::getControl(mapping.control);
+    ControlObject* pCO = mapping.controlHandle.valid() ?
+            ControlObject::getControl(mapping.controlHandle) :
+            ControlObject::getControl(mapping.control);
     if (pCO == NULL) {
         return;
     }
@@ -459,6 +508,8 @@ void MidiController::receive(QByteArray data, mixxx::Duration timestamp) {
     MidiKey mappingKey(data.at(0), 0xFF);
 
     triggerActivity();
+    latency()->inputReceived(getName(), timestamp);
+    ControlInputTime::Scope inputTime(timestamp);
     // TODO(rryan): Need to review how MIDI learn works with sysex messages. I
     // don't think this actually does anything useful.
     if (isLearning()) {
@@ -471,6 +522,7 @@ void MidiController::receive(QByteArray data, mixxx::Duration timestamp) {
             for (; it != m_temporaryInputMappings.end() && it.key() == mappingKey.key; ++it) {
                 processInputMapping(it.value(), data, timestamp);
             }
+            latency()->inputHandled();
             return;
         }
     }
@@ -480,6 +532,7 @@ void MidiController::receive(QByteArray data, mixxx::Duration timestamp) {
     for (; it != m_preset.inputMappings.end() && it.key() == mappingKey.key; ++it) {
         processInputMapping(it.value(), data, timestamp);
     }
+    latency()->inputHandled();
 }
 
 void MidiController::processInputMapping(const MidiInputMapping& mapping,
@@ -16,8 +16,10 @@
 #include "controllers/controller.h"
 #include "controllers/midi/midicontrollerpreset.h"
 #include "controllers/midi/midicontrollerpresetfilehandler.h"
+#include "controllers/midi/midiinputmappingtable.h"
 #include "controllers/midi/midimessage.h"
 #include "controllers/midi/midioutputhandler.h"
+#include "controllers/midi/midioutputscheduler.h"
 #include "controllers/softtakeover.h"
 
 class MidiController : public Controller {
@@ -51,13 +53,20 @@ class MidiController : public Controller {
 
     bool matchPreset(const PresetInfo& preset)  override;
 
+    void setOutputRateLimit(int framesPerSecond, int bytesPerSecond) override;
+
   signals:
     void messageReceived(unsigned char status, unsigned char control,
                          unsigned char value);
 
   protected:
-    Q_INVOKABLE virtual void sendShortMsg(unsigned char status,
-                                          unsigned char byte1, unsigned char byte2) = 0;
+    // Sends the message through the output scheduler, which drops it if the
+    // output has this value already
+    Q_INVOKABLE void sendShortMsg(unsigned char status,
+                                  unsigned char byte1, unsigned char byte2);
+    // Sends the message to the device right away
+    virtual void sendShortMsgNow(unsigned char status,
+                                 unsigned char byte1, unsigned char byte2) = 0;
 
     // Alias for send()
     // The length parameter is here for backwards compatibility for when scripts
@@ -83,6 +92,10 @@ class MidiController : public Controller {
     void commitTemporaryInputMappings();
 
   private:
+    // Looks up the control handle of a non-script mapping, so that incoming
+    // messages do not need to look up the control by its ConfigKey.
+    static void resolveControlHandle(MidiInputMapping* pMapping);
+
     void processInputMapping(const MidiInputMapping& mapping,
                              unsigned char status,
                              unsigned char control,
@@ -106,11 +119,16 @@ class MidiController : public Controller {
     QHash<uint16_t, MidiInputMapping> m_temporaryInputMappings;
     QList<MidiOutputHandler*> m_outputs;
     MidiControllerPreset m_preset;
+    // The input mappings of m_preset, rebuilt whenever they change
+    MidiInputMappingTable m_inputMappingTable;
     SoftTakeoverCtrl m_st;
+    MidiOutputScheduler m_outputScheduler;
     QList<QPair<MidiInputMapping, unsigned char> > m_fourteen_bit_queued_mappings;
 
     // So it can access sendShortMsg()
     friend class MidiOutputHandler;
+    // So it can access sendShortMsgNow()
+    friend class MidiOutputScheduler;
     friend class MidiControllerTest;
 };
 
@@ -0,0 +1,38 @@
+#include "controllers/midi/midiinputmappingtable.h"
+
+MidiInputMappingTable::MidiInputMappingTable() {
+}
+
+void MidiInputMappingTable::build(
+        const QHash<uint16_t, MidiInputMapping>& mappings) {
+    m_mappings.clear();
+    m_channelRanges.clear();
+    m_systemRanges.clear();
+    if (mappings.isEmpty()) {
+        return;
+    }
+
+    m_mappings.reserve(mappings.size());
+    for (const uint16_t key : mappings.uniqueKeys()) {
+        Range range;
+        range.first = m_mappings.size();
+        for (auto it = mappings.find(key);
+                it != mappings.end() && it.key() == key; ++it) {
+            m_mappings.append(it.value());
+        }
+        range.count = m_mappings.size() - range.first;
+
+        MidiKey mappingKey;
+        mappingKey.key = key;
+        if (isChannelStatus(mappingKey.status)) {
+            if (m_channelRanges.isEmpty()) {
+                // Every control byte of every channel message
+                m_channelRanges.resize(
+                        (kFirstSystemStatus - kFirstChannelStatus) << 8);
+            }
+            m_channelRanges[channelIndex(mappingKey)] = range;
+        } else {
+            m_systemRanges.insert(key, range);
+        }
+    }
+}
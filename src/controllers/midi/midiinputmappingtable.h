@@ -0,0 +1,69 @@
+#ifndef CONTROLLERS_MIDI_MIDIINPUTMAPPINGTABLE_H
+#define CONTROLLERS_MIDI_MIDIINPUTMAPPINGTABLE_H
+
+#include <QHash>
+#include <QVector>
+
+#include "controllers/midi/midimessage.h"
+
+// The input mappings of a preset compiled into a flat table, so that the
+// mappings of a channel message are found by indexing the table with its
+// status and control bytes instead of looking them up in a hash. This keeps
+// the cost of dense streams like jog wheels and 14-bit faders low.
+//
+// The mappings of system messages are rare and stay in a hash. The mappings
+// of a message keep the order in which the preset hash iterates them.
+class MidiInputMappingTable {
+  public:
+    MidiInputMappingTable();
+
+    // Replaces the mappings of the table. The controls of the mappings
+    // should be resolved.
+    void build(const QHash<uint16_t, MidiInputMapping>& mappings);
+
+    // Returns the first mapping of the message or nullptr if there is none.
+    // The mappings of the message follow the first one.
+    const MidiInputMapping* find(unsigned char status, unsigned char control,
+                                 int* pCount) const {
+        // The control byte of messages without one is replaced like in the
+        // keys of the preset
+        const MidiKey key(status, control);
+        Range range;
+        if (isChannelStatus(key.status)) {
+            if (m_channelRanges.isEmpty()) {
+                return nullptr;
+            }
+            range = m_channelRanges[channelIndex(key)];
+        } else {
+            range = m_systemRanges.value(key.key);
+        }
+        *pCount = range.count;
+        return range.count > 0 ? &m_mappings[range.first] : nullptr;
+    }
+
+  private:
+    static const unsigned char kFirstChannelStatus = 0x80;
+    static const unsigned char kFirstSystemStatus = 0xF0;
+
+    static bool isChannelStatus(unsigned char status) {
+        return status >= kFirstChannelStatus && status < kFirstSystemStatus;
+    }
+    static int channelIndex(const MidiKey& key) {
+        return ((key.status - kFirstChannelStatus) << 8) | key.control;
+    }
+
+    struct Range {
+        Range()
+                : first(0),
+                  count(0) {
+        }
+        int first;
+        int count;
+    };
+
+    QVector<MidiInputMapping> m_mappings;
+    QVector<Range> m_channelRanges;
+    QHash<uint16_t, Range> m_systemRanges;
+};
+
+#endif // CONTROLLERS_MIDI_MIDIINPUTMAPPINGTABLE_H
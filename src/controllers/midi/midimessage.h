@@ -5,6 +5,7 @@
 #include <QPair>
 #include <QMetaType>
 
+#include "control/controlhandle.h"
 #include "preferences/usersettings.h"
 
 // The second value of each OpCode will be the channel number the message
@@ -171,6 +172,9 @@ struct MidiInputMapping {
     MidiOptions options;
     ConfigKey control;
     QString description;
+    // The handle of control, resolved by MidiController when the mapping is
+    // loaded. Invalid for script mappings.
+    ControlHandle controlHandle;
 };
 typedef QList<MidiInputMapping> MidiInputMappings;
 
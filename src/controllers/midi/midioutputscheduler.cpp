@@ -0,0 +1,146 @@
+#include "controllers/midi/midioutputscheduler.h"
+
+#include <limits>
+
+#include "controllers/midi/midicontroller.h"
+#include "controllers/midi/midimessage.h"
+#include "util/math.h"
+
+namespace {
+
+// The second data byte is the value of the output. Note on and note off
+// messages share the output of their note.
+quint16 outputKey(unsigned char status, unsigned char byte1) {
+    unsigned char opCode = status & 0xF0;
+    if (opCode == MIDI_NOTE_OFF) {
+        opCode = MIDI_NOTE_ON;
+    }
+    switch (opCode) {
+    case MIDI_NOTE_ON:
+    case MIDI_AFTERTOUCH:
+    case MIDI_CC:
+        return (static_cast<quint16>(opCode | (status & 0x0F)) << 8) | byte1;
+    default:
+        // The whole message is the value of the channel
+        return static_cast<quint16>(status) << 8;
+    }
+}
+
+int messageLength(unsigned char status) {
+    switch (status & 0xF0) {
+    case MIDI_PROGRAM_CH:
+    case MIDI_CH_AFTERTOUCH:
+        return 2;
+    default:
+        return 3;
+    }
+}
+
+} // anonymous namespace
+
+MidiOutputScheduler::Output::Output()
+        : status(0),
+          byte1(0),
+          byte2(0),
+          sentStatus(0),
+          sentByte2(0),
+          bSent(false),
+          bPending(false),
+          // Never sent, i.e. not in the previous frame
+          sentFrame(-2) {
+}
+
+MidiOutputScheduler::MidiOutputScheduler(MidiController* pController)
+        : QObject(pController),
+          m_pController(pController),
+          m_timer(this),
+          m_bytesPerFrame(0),
+          m_frame(0) {
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, SIGNAL(timeout()),
+            this, SLOT(flush()));
+    setRateLimit(kDefaultFramesPerSecond, kDefaultBytesPerSecond);
+}
+
+void MidiOutputScheduler::setRateLimit(int framesPerSecond, int bytesPerSecond) {
+    framesPerSecond = math_clamp(framesPerSecond, 1, 1000);
+    m_timer.setInterval(1000 / framesPerSecond);
+    if (bytesPerSecond > 0) {
+        // At least one message per frame
+        m_bytesPerFrame = math_max(3, bytesPerSecond / framesPerSecond);
+    } else {
+        m_bytesPerFrame = std::numeric_limits<int>::max();
+    }
+}
+
+void MidiOutputScheduler::reset() {
+    m_timer.stop();
+    m_outputs.clear();
+    m_pendingChanges.clear();
+    m_pendingContinuousChanges.clear();
+}
+
+void MidiOutputScheduler::sendShortMsg(unsigned char status,
+        unsigned char byte1, unsigned char byte2) {
+    if (status >= 0xF0) {
+        m_pController->sendShortMsgNow(status, byte1, byte2);
+        return;
+    }
+    const quint16 key = outputKey(status, byte1);
+    Output& output = m_outputs[key];
+    output.status = status;
+    output.byte1 = byte1;
+    output.byte2 = byte2;
+    if (output.bPending || isSent(output)) {
+        // The pending value is replaced or the output has the value already
+        return;
+    }
+    output.bPending = true;
+    // Changes in consecutive frames are continuous
+    if (m_frame - output.sentFrame <= 1) {
+        m_pendingContinuousChanges.append(key);
+    } else {
+        m_pendingChanges.append(key);
+    }
+    if (!m_timer.isActive()) {
+        flush();
+    }
+}
+
+void MidiOutputScheduler::sendPending(QVector<quint16>* pPending, int* pBudget) {
+    int count = 0;
+    for (; count < pPending->size(); ++count) {
+        Output& output = m_outputs[pPending->at(count)];
+        const int length = messageLength(output.status);
+        if (*pBudget < length) {
+            break;
+        }
+        output.bPending = false;
+        if (isSent(output)) {
+            // Changed back to the sent value
+            continue;
+        }
+        m_pController->sendShortMsgNow(output.status, output.byte1, output.byte2);
+        m_pController->latency()->outputSent();
+        output.sentStatus = output.status;
+        output.sentByte2 = output.byte2;
+        output.bSent = true;
+        output.sentFrame = m_frame;
+        *pBudget -= length;
+    }
+    pPending->remove(0, count);
+}
+
+void MidiOutputScheduler::flush() {
+    ++m_frame;
+    int budget = m_bytesPerFrame;
+    sendPending(&m_pendingChanges, &budget);
+    sendPending(&m_pendingContinuousChanges, &budget);
+    // The next frame starts after the interval, also when all pending values
+    // have been sent
+    if (budget < m_bytesPerFrame || !m_pendingChanges.isEmpty() ||
+            !m_pendingContinuousChanges.isEmpty()) {
+        m_timer.start();
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef CONTROLLERS_MIDI_MIDIOUTPUTSCHEDULER_H
+#define CONTROLLERS_MIDI_MIDIOUTPUTSCHEDULER_H
+
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include "util/class.h"
+
+class MidiController;
+
+// Coalesces the short messages that are sent to a MIDI controller and
+// limits the rate at which they are sent. The last value of each output,
+// i.e. of each channel and note, controller or other channel message, is
+// kept, and only the values that differ from the last sent ones are sent.
+//
+// The pending values are flushed once per frame with a budget of bytes per
+// frame. The first message after an idle frame is sent right away. Outputs
+// that have not changed during the previous frame, e.g. the feedback of a
+// button, are sent before those that change continuously, e.g. meters.
+// The values of the outputs that do not fit into the budget of a frame are
+// sent with the following frames, coalesced with newer values.
+//
+// System messages are not coalesced and sent right away.
+class MidiOutputScheduler : public QObject {
+    Q_OBJECT
+  public:
+    static const int kDefaultFramesPerSecond = 100;
+    // Twice the rate of a DIN MIDI link
+    static const int kDefaultBytesPerSecond = 6250;
+
+    explicit MidiOutputScheduler(MidiController* pController);
+
+    // A byte rate of 0 disables the limit, but not the coalescing
+    void setRateLimit(int framesPerSecond, int bytesPerSecond);
+
+    void sendShortMsg(unsigned char status, unsigned char byte1,
+                      unsigned char byte2);
+
+    // Forgets the values that have been sent, e.g. when the device has
+    // been closed
+    void reset();
+
+  private slots:
+    void flush();
+
+  private:
+    struct Output {
+        Output();
+
+        unsigned char status;
+        unsigned char byte1;
+        unsigned char byte2;
+        unsigned char sentStatus;
+        unsigned char sentByte2;
+        bool bSent;
+        bool bPending;
+        // The frame in which the value was sent last
+        int sentFrame;
+    };
+
+    static bool isSent(const Output& output) {
+        return output.bSent && output.sentStatus == output.status &&
+                output.sentByte2 == output.byte2;
+    }
+
+    void sendPending(QVector<quint16>* pPending, int* pBudget);
+
+    MidiController* const m_pController;
+    QTimer m_timer;
+    int m_bytesPerFrame;
+    int m_frame;
+    QHash<quint16, Output> m_outputs;
+    // The outputs with a pending value in the order of their changes
+    QVector<quint16> m_pendingChanges;
+    QVector<quint16> m_pendingContinuousChanges;
+
+    DISALLOW_COPY_AND_ASSIGN(MidiOutputScheduler);
+};
+
+#endif // CONTROLLERS_MIDI_MIDIOUTPUTSCHEDULER_H
@@ -7,15 +7,19 @@
  *
  */
 
+#include <porttime.h>
+
 #include "controllers/midi/midiutils.h"
 #include "controllers/midi/portmidicontroller.h"
 #include "controllers/controllerdebug.h"
+#include "util/time.h"
 
 PortMidiController::PortMidiController(const PmDeviceInfo* inputDeviceInfo,
                                        const PmDeviceInfo* outputDeviceInfo,
                                        int inputDeviceIndex,
                                        int outputDeviceIndex)
         : MidiController(),
+          m_bInputThreadEnabled(true),
           m_cReceiveMsg_index(0),
           m_bInSysex(false) {
     for (unsigned int k = 0; k < MIXXX_PORTMIDI_BUFFER_LEN; ++k) {
@@ -71,6 +75,16 @@ int PortMidiController::open() {
             qWarning() << "PortMidi error:" << Pm_GetErrorText(err);
             return -2;
         }
+        // PortTime has been started when the input was opened
+        m_timestampOffset = mixxx::Time::elapsed() -
+                mixxx::Duration::fromMillis(Pt_Time());
+        if (m_bInputThreadEnabled) {
+            m_pInputThread.reset(new PortMidiInputThread(m_pInputDevice.data()));
+            connect(m_pInputThread.data(), SIGNAL(eventsAvailable()),
+                    this, SLOT(slotProcessInput()),
+                    Qt::QueuedConnection);
+            m_pInputThread->start(QThread::TimeCriticalPriority);
+        }
     }
     if (m_pOutputDevice && isOutputDevice()) {
         controllerDebug("PortMidiController: Opening"
@@ -100,6 +114,12 @@ int PortMidiController::close() {
 
     int result = 0;
 
+    // The thread must not read from the closed device
+    if (m_pInputThread) {
+        m_pInputThread->stop();
+        m_pInputThread.reset();
+    }
+
     if (m_pInputDevice && m_pInputDevice->isOpen()) {
         PmError err = m_pInputDevice->close();
         if (err != pmNoError) {
@@ -145,9 +165,27 @@ bool PortMidiController::poll() {
         return false;
     }
 
+    processEvents(numEvents);
+    return numEvents > 0;
+}
+
+void PortMidiController::slotProcessInput() {
+    if (!m_pInputThread) {
+        return;
+    }
+    int numEvents;
+    do {
+        numEvents = m_pInputThread->takeEvents(
+                m_midiBuffer, MIXXX_PORTMIDI_BUFFER_LEN);
+        processEvents(numEvents);
+    } while (numEvents == MIXXX_PORTMIDI_BUFFER_LEN);
+}
+
+void PortMidiController::processEvents(int numEvents) {
     for (int i = 0; i < numEvents; i++) {
         unsigned char status = Pm_MessageStatus(m_midiBuffer[i].message);
-        mixxx::Duration timestamp = mixxx::Duration::fromMillis(m_midiBuffer[i].timestamp);
+        mixxx::Duration timestamp = m_timestampOffset +
+                mixxx::Duration::fromMillis(m_midiBuffer[i].timestamp);
 
         if ((status & 0xF8) == 0xF8) {
             // Handle real-time MIDI messages at any time
@@ -201,11 +239,10 @@ bool PortMidiController::poll() {
             }
         }
     }
-    return numEvents > 0;
 }
 
-void PortMidiController::sendShortMsg(unsigned char status, unsigned char byte1,
-                                      unsigned char byte2) {
+void PortMidiController::sendShortMsgNow(unsigned char status, unsigned char byte1,
+                                         unsigned char byte2) {
     if (m_pOutputDevice.isNull() || !m_pOutputDevice->isOpen()) {
         return;
     }
@@ -23,6 +23,7 @@
 
 #include "controllers/midi/midicontroller.h"
 #include "controllers/midi/portmididevice.h"
+#include "controllers/midi/portmidiinputthread.h"
 
 // Note:
 // A standard Midi device runs at 31.25 kbps, with 10 bits / byte
@@ -69,21 +70,26 @@ class PortMidiController : public MidiController {
     int open() override;
     int close() override;
     bool poll() override;
+    // Processes the events that have been read by the input thread
+    void slotProcessInput();
 
   protected:
     // MockPortMidiController needs this to not be private.
-    void sendShortMsg(unsigned char status, unsigned char byte1,
-                      unsigned char byte2) override;
+    void sendShortMsgNow(unsigned char status, unsigned char byte1,
+                         unsigned char byte2) override;
 
   private:
     // The sysex data must already contain the start byte 0xf0 and the end byte
     // 0xf7.
     void send(QByteArray data) override;
 
+    // The input is read by m_pInputThread while the device is open
     bool isPolling() const override {
-        return true;
+        return !m_pInputThread;
     }
 
+    void processEvents(int numEvents);
+
     // For testing only so that test fixtures can install mock PortMidiDevices.
     void setPortMidiInputDevice(PortMidiDevice* device) {
         m_pInputDevice.reset(device);
@@ -91,11 +97,20 @@ class PortMidiController : public MidiController {
     void setPortMidiOutputDevice(PortMidiDevice* device) {
         m_pOutputDevice.reset(device);
     }
+    // For testing only so that the mock devices are polled synchronously.
+    void setInputThreadEnabled(bool enabled) {
+        m_bInputThreadEnabled = enabled;
+    }
 
     QScopedPointer<PortMidiDevice> m_pInputDevice;
     QScopedPointer<PortMidiDevice> m_pOutputDevice;
+    bool m_bInputThreadEnabled;
+    QScopedPointer<PortMidiInputThread> m_pInputThread;
 
     PmEvent m_midiBuffer[MIXXX_PORTMIDI_BUFFER_LEN];
+    // Converts the PortTime timestamps of the input to the time since the
+    // start of Mixxx, like the timestamps of the other controllers
+    mixxx::Duration m_timestampOffset;
 
     // Storage for SysEx messages
     unsigned char m_cReceiveMsg[MIXXX_SYSEX_BUFFER_LEN];
@@ -3,6 +3,12 @@
 
 #include <portmidi.h>
 
+#include <QMutex>
+#include <QMutexLocker>
+
+// The calls into PortMidi are serialized, because its streams are read by
+// the input threads and written by the controller thread, while PortMidi
+// itself is not thread-safe, e.g. all ALSA streams share one sequencer.
 class PortMidiDevice {
   public:
     PortMidiDevice(const PmDeviceInfo* deviceInfo,
@@ -28,6 +34,7 @@ class PortMidiDevice {
     }
 
     virtual PmError openInput(int32_t bufferSize) {
+        QMutexLocker locker(mutex());
         return Pm_OpenInput(&m_pStream, m_deviceIndex,
                             NULL, // no drive hacks
                             bufferSize,
@@ -36,6 +43,7 @@ class PortMidiDevice {
     }
 
     virtual PmError openOutput() {
+        QMutexLocker locker(mutex());
         return Pm_OpenOutput(&m_pStream,
                              m_deviceIndex,
                              NULL, // No driver hacks
@@ -46,28 +54,38 @@ class PortMidiDevice {
     }
 
     virtual PmError close() {
+        QMutexLocker locker(mutex());
         PmError err = Pm_Close(m_pStream);
         m_pStream = NULL;
         return err;
     }
 
     virtual PmError poll() {
+        QMutexLocker locker(mutex());
         return Pm_Poll(m_pStream);
     }
 
     virtual int read(PmEvent* buffer, int32_t length) {
+        QMutexLocker locker(mutex());
         return Pm_Read(m_pStream, buffer, length);
     }
 
     virtual PmError writeShort(int32_t message) {
+        QMutexLocker locker(mutex());
         return Pm_WriteShort(m_pStream, 0, message);
     }
 
     virtual PmError writeSysEx(unsigned char* message) {
+        QMutexLocker locker(mutex());
         return Pm_WriteSysEx(m_pStream, 0, message);
     }
 
   private:
+    static QMutex* mutex() {
+        static QMutex s_mutex;
+        return &s_mutex;
+    }
+
     const PmDeviceInfo* m_pDeviceInfo;
     int m_deviceIndex;
     PortMidiStream* m_pStream;
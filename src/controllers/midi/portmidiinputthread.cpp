@@ -0,0 +1,68 @@
+#include "controllers/midi/portmidiinputthread.h"
+
+#include "controllers/midi/portmidicontroller.h"
+#include "controllers/midi/portmididevice.h"
+
+namespace {
+
+// The events that are queued for the controller thread. A busy controller
+// thread may fall behind by several hundred milliseconds of a fast stream,
+// see MIXXX_PORTMIDI_BUFFER_LEN.
+const int kQueueSize = 4 * MIXXX_PORTMIDI_BUFFER_LEN;
+
+// While the device is idle, i.e. about the time of a single MIDI message
+const unsigned long kIdleSleepMicros = 250;
+
+} // anonymous namespace
+
+PortMidiInputThread::PortMidiInputThread(PortMidiDevice* pDevice)
+        : m_pDevice(pDevice),
+          m_events(kQueueSize),
+          m_stop(0),
+          m_signalPending(0) {
+}
+
+PortMidiInputThread::~PortMidiInputThread() {
+    stop();
+}
+
+void PortMidiInputThread::stop() {
+    m_stop.storeRelease(1);
+    wait();
+}
+
+int PortMidiInputThread::takeEvents(PmEvent* pBuffer, int length) {
+    // Events that are queued from now on are signalled again
+    m_signalPending.storeRelease(0);
+    return m_events.read(pBuffer, length);
+}
+
+void PortMidiInputThread::run() {
+    PmEvent buffer[MIXXX_PORTMIDI_BUFFER_LEN];
+    while (!m_stop.loadAcquire()) {
+        // Returns true if events are available or an error code.
+        const PmError gotEvents = m_pDevice->poll();
+        if (gotEvents < 0) {
+            qWarning() << "PortMidi error:" << Pm_GetErrorText(gotEvents);
+        }
+        if (gotEvents <= 0) {
+            usleep(kIdleSleepMicros);
+            continue;
+        }
+
+        const int numEvents = m_pDevice->read(buffer, MIXXX_PORTMIDI_BUFFER_LEN);
+        if (numEvents < 0) {
+            qWarning() << "PortMidi error:" << Pm_GetErrorText((PmError)numEvents);
+            usleep(kIdleSleepMicros);
+            continue;
+        }
+        const int numQueued = m_events.write(buffer, numEvents);
+        if (numQueued < numEvents) {
+            qWarning() << "PortMidi input queue overflow: dropped"
+                       << numEvents - numQueued << "events";
+        }
+        if (numQueued > 0 && m_signalPending.testAndSetOrdered(0, 1)) {
+            emit(eventsAvailable());
+        }
+    }
+}
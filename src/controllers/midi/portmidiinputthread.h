@@ -0,0 +1,53 @@
+#ifndef CONTROLLERS_MIDI_PORTMIDIINPUTTHREAD_H
+#define CONTROLLERS_MIDI_PORTMIDIINPUTTHREAD_H
+
+#include <portmidi.h>
+
+#include <QAtomicInt>
+#include <QThread>
+
+#include "util/class.h"
+#include "util/fifo.h"
+
+class PortMidiDevice;
+
+// Reads the input of a PortMidi device on a thread of its own with a high
+// priority, so that the messages are received without waiting for the
+// controller thread, which may be busy running the scripts. The events
+// are handed to the controller thread through a lock-free queue, and
+// eventsAvailable() is only emitted when the controller thread has taken
+// all events that were signalled before.
+//
+// PortMidi has neither a blocking nor a callback interface for its input,
+// so the thread polls the device and sleeps briefly while it is idle.
+class PortMidiInputThread : public QThread {
+    Q_OBJECT
+  public:
+    // The device must stay open until the thread has been stopped
+    explicit PortMidiInputThread(PortMidiDevice* pDevice);
+    ~PortMidiInputThread() override;
+
+    // Stops the thread and waits until it has finished
+    void stop();
+
+    // Called from the controller thread. Returns the number of events that
+    // have been copied to the buffer.
+    int takeEvents(PmEvent* pBuffer, int length);
+
+  signals:
+    void eventsAvailable();
+
+  protected:
+    void run() override;
+
+  private:
+    PortMidiDevice* const m_pDevice;
+    FIFO<PmEvent> m_events;
+    QAtomicInt m_stop;
+    // Set when eventsAvailable() has been emitted and not been handled yet
+    QAtomicInt m_signalPending;
+
+    DISALLOW_COPY_AND_ASSIGN(PortMidiInputThread);
+};
+
+#endif // CONTROLLERS_MIDI_PORTMIDIINPUTTHREAD_H
@@ -1,5 +1,7 @@
 #include "database/schemamanager.h"
 
+#include <QRegExp>
+
 #include "util/db/fwdsqlquery.h"
 #include "util/db/sqltransaction.h"
 #include "util/xml.h"
@@ -29,6 +31,39 @@ namespace {
             return schemaVersion;
         }
     }
+
+    // TODO(XXX) We can't have semicolons in schema.xml for anything other
+    // than statement separators and the statements in the body of a
+    // trigger.
+    QStringList splitSqlStatements(const QString& sql) {
+        const QRegExp triggerStart("^CREATE\\s+(TEMP\\s+|TEMPORARY\\s+)?TRIGGER\\b",
+                Qt::CaseInsensitive);
+        const QRegExp triggerEnd("\\bEND$", Qt::CaseInsensitive);
+        QStringList sqlStatements;
+        QString statement;
+        for (const auto& part : sql.split(";")) {
+            if (statement.isEmpty()) {
+                statement = part.trimmed();
+            } else {
+                statement += ";" + part;
+            }
+            if (statement.contains(triggerStart) &&
+                    !statement.trimmed().contains(triggerEnd)) {
+                // Continue with the next statement of the body
+                continue;
+            }
+            statement = statement.trimmed();
+            if (!statement.isEmpty()) {
+                sqlStatements.append(statement);
+            }
+            statement.clear();
+        }
+        if (!statement.isEmpty()) {
+            // An incomplete trigger, which fails to execute
+            sqlStatements.append(statement);
+        }
+        return sqlStatements;
+    }
 }
 
 SchemaManager::SchemaManager(const QSqlDatabase& database)
@@ -64,6 +99,33 @@ bool SchemaManager::isBackwardsCompatibleWithVersion(int targetVersion) const {
     return iBackwardsCompatibleVersion <= targetVersion;
 }
 
+bool SchemaManager::executeSqlStatements(const QStringList& sqlStatements) {
+    for (const auto& statement : sqlStatements) {
+        FwdSqlQuery query(m_database, statement);
+        if (!(query.isPrepared() && query.execPrepared())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SchemaManager::executeOptionalSqlStatements(const QStringList& sqlStatements) {
+    if (!FwdSqlQuery(m_database, "SAVEPOINT optional_sql").execPrepared()) {
+        kLogger.warning()
+                << "Skipped optional database schema migration";
+        return;
+    }
+    if (executeSqlStatements(sqlStatements)) {
+        FwdSqlQuery(m_database, "RELEASE SAVEPOINT optional_sql").execPrepared();
+    } else {
+        kLogger.warning()
+                << "Failed to execute optional database schema migration"
+                << "- the database is upgraded without it";
+        FwdSqlQuery(m_database, "ROLLBACK TO SAVEPOINT optional_sql").execPrepared();
+        FwdSqlQuery(m_database, "RELEASE SAVEPOINT optional_sql").execPrepared();
+    }
+}
+
 SchemaManager::Result SchemaManager::upgradeToSchemaVersion(
         const QString& schemaFilename,
         int targetVersion) {
@@ -146,7 +208,6 @@ SchemaManager::Result SchemaManager::upgradeToSchemaVersion(
 
         QDomElement revision = revisionMap[nextVersion];
         QDomElement eDescription = revision.firstChildElement("description");
-        QDomElement eSql = revision.firstChildElement("sql");
         QString minCompatibleVersion = revision.attribute("min_compatible");
 
         // Default the min-compatible version to the current version string if
@@ -155,7 +216,7 @@ SchemaManager::Result SchemaManager::upgradeToSchemaVersion(
             minCompatibleVersion = QString::number(nextVersion);
         }
 
-        VERIFY_OR_DEBUG_ASSERT(!eSql.isNull()) {
+        VERIFY_OR_DEBUG_ASSERT(!revision.firstChildElement("sql").isNull()) {
             kLogger.critical()
                     << "Failed to parse database schema migrations from"
                     << schemaFilename;
@@ -163,7 +224,6 @@ SchemaManager::Result SchemaManager::upgradeToSchemaVersion(
         }
 
         QString description = eDescription.text();
-        QString sql = eSql.text();
 
         kLogger.info()
                 << "Upgrading to database schema to version"
@@ -172,21 +232,19 @@ SchemaManager::Result SchemaManager::upgradeToSchemaVersion(
 
         SqlTransaction transaction(m_database);
 
-        // TODO(XXX) We can't have semicolons in schema.xml for anything other
-        // than statement separators.
-        QStringList sqlStatements = sql.split(";");
-
-        QStringListIterator it(sqlStatements);
-
         bool result = true;
-        while (result && it.hasNext()) {
-            QString statement = it.next().trimmed();
-            if (statement.isEmpty()) {
-                // skip blank lines
-                continue;
+        for (QDomElement eSql = revision.firstChildElement("sql");
+                result && !eSql.isNull();
+                eSql = eSql.nextSiblingElement("sql")) {
+            const QStringList sqlStatements = splitSqlStatements(eSql.text());
+            if (eSql.attribute("optional") == "true") {
+                // Optional statements depend on features of SQLite that
+                // might not be available, e.g. the FTS5 extension. They
+                // are either executed all together or not at all.
+                executeOptionalSqlStatements(sqlStatements);
+            } else {
+                result = executeSqlStatements(sqlStatements);
             }
-            FwdSqlQuery query(m_database, statement);
-            result = query.isPrepared() && query.execPrepared();
         }
 
         if (result) {
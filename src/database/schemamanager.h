@@ -33,6 +33,9 @@ class SchemaManager {
             int targetVersion);
 
   private:
+    bool executeSqlStatements(const QStringList& sqlStatements);
+    void executeOptionalSqlStatements(const QStringList& sqlStatements);
+
     QSqlDatabase m_database;
     SettingsDAO m_settingsDao;
 
@@ -1,14 +1,47 @@
 #include "dialog/dlgdevelopertools.h"
 
 #include <QDateTime>
+#include <QScrollBar>
+#include <QTextStream>
 
 #include "control/control.h"
+#include "engine/callbackprofiler.h"
 #include "util/cmdlineargs.h"
+#include "util/memoryaccounting.h"
 #include "util/statsmanager.h"
 
+namespace {
+
+QString formatNanos(qint64 nanos) {
+    return QString("%1 ms").arg(nanos / 1e6, 0, 'f', 2);
+}
+
+// Returns the upper bound of the histogram bucket that contains the given
+// fraction of the callbacks.
+QString histogramPercentile(const CallbackProfiler& profiler, int stage,
+                            int total, double fraction) {
+    int count = 0;
+    for (int bucket = 0; bucket < CallbackProfiler::kHistogramBuckets; ++bucket) {
+        count += profiler.histogramCount(stage, bucket);
+        if (count > 0 && count >= total * fraction) {
+            if (bucket == CallbackProfiler::kHistogramBuckets - 1) {
+                return ">= " + formatNanos(
+                        bucket * CallbackProfiler::kHistogramBucketNanos);
+            }
+            return "< " + formatNanos(
+                    (bucket + 1) * CallbackProfiler::kHistogramBucketNanos);
+        }
+    }
+    return "-";
+}
+
+} // anonymous namespace
+
 DlgDeveloperTools::DlgDeveloperTools(QWidget* pParent,
-                                     UserSettingsPointer pConfig)
-        : QDialog(pParent) {
+                                     UserSettingsPointer pConfig,
+                                     CallbackProfiler* pCallbackProfiler)
+        : QDialog(pParent),
+          m_pCallbackProfiler(pCallbackProfiler) {
     Q_UNUSED(pConfig);
     setupUi(this);
 
@@ -72,6 +105,16 @@ DlgDeveloperTools::DlgDeveloperTools(QWidget* pParent,
 
     m_logCursor = logTextView->textCursor();
 
+    // The stage table is aligned with spaces
+    QFont fixedFont("Monospace");
+    fixedFont.setStyleHint(QFont::TypeWriter);
+    callbackTextView->setFont(fixedFont);
+    memoryTextView->setFont(fixedFont);
+    if (!m_pCallbackProfiler || !m_pCallbackProfiler->isEnabled()) {
+        callbackTextView->setPlainText(
+                tr("The audio callback is only profiled in developer mode."));
+    }
+
     // Update at 2FPS.
     startTimer(500);
 
@@ -106,9 +149,93 @@ void DlgDeveloperTools::timerEvent(QTimerEvent* pEvent) {
         if (pManager) {
             pManager->updateStats();
         }
+    } else if (toolTabWidget->currentWidget() == callbackTab) {
+        updateCallbackProfile();
+    } else if (toolTabWidget->currentWidget() == memoryTab) {
+        updateMemoryAccounting();
     }
 }
 
+void DlgDeveloperTools::updateMemoryAccounting() {
+    QString text;
+    QTextStream stream(&text);
+    qint64 totalBytes = 0;
+    for (int i = 0; i < MemoryAccounting::kCategoryCount; ++i) {
+        const auto category = static_cast<MemoryAccounting::Category>(i);
+        const qint64 bytes = MemoryAccounting::bytes(category);
+        totalBytes += bytes;
+        stream << QString("%1 %2 MB\n")
+                .arg(MemoryAccounting::categoryName(category), -24)
+                .arg(bytes / (1024.0 * 1024.0), 10, 'f', 2);
+    }
+    stream << QString("%1 %2 MB\n")
+            .arg("total", -24)
+            .arg(totalBytes / (1024.0 * 1024.0), 10, 'f', 2);
+    memoryTextView->setPlainText(text);
+}
+
+void DlgDeveloperTools::updateCallbackProfile() {
+    if (!m_pCallbackProfiler || !m_pCallbackProfiler->isEnabled()) {
+        return;
+    }
+    const CallbackProfiler& profiler = *m_pCallbackProfiler;
+
+    QString text;
+    QTextStream stream(&text);
+
+    // Each callback is counted once in the histogram of each stage.
+    int callbacks = 0;
+    for (int bucket = 0; bucket < CallbackProfiler::kHistogramBuckets; ++bucket) {
+        callbacks += profiler.histogramCount(CallbackProfiler::NUM_STAGES, bucket);
+    }
+    stream << "Callbacks: " << callbacks
+           << "  Deadline misses: " << profiler.deadlineMissCount() << "\n\n";
+
+    stream << QString("%1 %2 %3 %4\n")
+            .arg("Stage", -20).arg("p50", -12).arg("p99", -12).arg("max", -12);
+    for (int stage = 0; stage <= CallbackProfiler::NUM_STAGES; ++stage) {
+        const QString name = stage < CallbackProfiler::NUM_STAGES ?
+                CallbackProfiler::stageName(
+                        static_cast<CallbackProfiler::Stage>(stage)) :
+                QString("total");
+        stream << QString("%1 %2 %3 %4\n")
+                .arg(name, -20)
+                .arg(histogramPercentile(profiler, stage, callbacks, 0.5), -12)
+                .arg(histogramPercentile(profiler, stage, callbacks, 0.99), -12)
+                .arg(histogramPercentile(profiler, stage, callbacks, 1.0), -12);
+    }
+
+    QVector<CallbackProfiler::DeadlineMiss> misses;
+    profiler.getDeadlineMisses(&misses);
+    if (!misses.isEmpty()) {
+        stream << "\nLast deadline misses, most recent first:\n";
+    }
+    for (const auto& miss : misses) {
+        stream << QString("%1 s: %2 of %3")
+                .arg(miss.timeNanos / 1e9, 0, 'f', 3)
+                .arg(formatNanos(miss.totalNanos))
+                .arg(formatNanos(miss.budgetNanos));
+        for (int stage = 0; stage < CallbackProfiler::NUM_STAGES; ++stage) {
+            stream << ", "
+                   << CallbackProfiler::stageName(
+                           static_cast<CallbackProfiler::Stage>(stage))
+                   << " " << formatNanos(miss.stageNanos[stage]);
+        }
+        if (miss.slowestChannel >= 0) {
+            stream << ", slowest channel "
+                   << profiler.channelGroup(miss.slowestChannel)
+                   << " " << formatNanos(miss.slowestChannelNanos);
+        }
+        stream << "\n";
+    }
+    stream.flush();
+
+    // Keep the scroll position while the text is updated.
+    const int scrollPosition = callbackTextView->verticalScrollBar()->value();
+    callbackTextView->setPlainText(text);
+    callbackTextView->verticalScrollBar()->setValue(scrollPosition);
+}
+
 void DlgDeveloperTools::slotControlSearch(const QString& search) {
     m_controlProxyModel.setFilterFixedString(search);
 }
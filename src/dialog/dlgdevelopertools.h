@@ -11,11 +11,14 @@
 #include "preferences/usersettings.h"
 #include "util/statmodel.h"
 
+class CallbackProfiler;
+
 class DlgDeveloperTools : public QDialog, public Ui::DlgDeveloperTools {
     Q_OBJECT
   public:
     DlgDeveloperTools(QWidget* pParent,
-                      UserSettingsPointer pConfig);
+                      UserSettingsPointer pConfig,
+                      CallbackProfiler* pCallbackProfiler);
 
   protected:
     void timerEvent(QTimerEvent* pTimerEvent) override;
@@ -27,6 +30,9 @@ class DlgDeveloperTools : public QDialog, public Ui::DlgDeveloperTools {
     void slotControlDump();
 
   private:
+    void updateCallbackProfile();
+    void updateMemoryAccounting();
+
     ControlModel m_controlModel;
     QSortFilterProxyModel m_controlProxyModel;
 
@@ -35,6 +41,8 @@ class DlgDeveloperTools : public QDialog, public Ui::DlgDeveloperTools {
 
     QFile m_logFile;
     QTextCursor m_logCursor;
+
+    CallbackProfiler* m_pCallbackProfiler;
 };
 
 #endif // DIALOG_DLGDEVELOPERTOOLS_H
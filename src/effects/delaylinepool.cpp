@@ -0,0 +1,112 @@
+#include "effects/delaylinepool.h"
+
+#include <iterator>
+#include <utility>
+
+#include <QMutexLocker>
+#include <QtConcurrentRun>
+
+#include "util/assert.h"
+#include "util/memoryaccounting.h"
+
+namespace {
+
+// The delay lines of 4 Echo effects at 96 kHz
+const SINT kEchoDelayLineSamples = 3 * 96000 * 2;
+
+qint64 bytesOfSamples(SINT samples) {
+    return static_cast<qint64>(samples) * sizeof(CSAMPLE);
+}
+
+} // anonymous namespace
+
+const SINT DelayLinePool::kMaxIdleSamples = 4 * kEchoDelayLineSamples;
+
+QMutex DelayLinePool::s_mutex;
+std::vector<mixxx::SampleBuffer> DelayLinePool::s_idleBuffers;
+SINT DelayLinePool::s_idleSamples = 0;
+
+// static
+mixxx::SampleBuffer DelayLinePool::lease(SINT size) {
+    mixxx::SampleBuffer buffer;
+    {
+        QMutexLocker locker(&s_mutex);
+        // Prefer the most recently released buffer, which is the most likely
+        // to still be in the cache
+        for (auto it = s_idleBuffers.rbegin(); it != s_idleBuffers.rend(); ++it) {
+            if (it->size() == size) {
+                buffer.swap(*it);
+                s_idleBuffers.erase(std::next(it).base());
+                s_idleSamples -= size;
+                break;
+            }
+        }
+    }
+    if (buffer.size() == 0) {
+        mixxx::SampleBuffer(size).swap(buffer);
+        // Leased and idle buffers are accounted until they are freed
+        MemoryAccounting::add(MemoryAccounting::Category::EffectStates,
+                bytesOfSamples(size));
+    }
+    buffer.clear();
+    return buffer;
+}
+
+// static
+void DelayLinePool::release(mixxx::SampleBuffer buffer) {
+    VERIFY_OR_DEBUG_ASSERT(buffer.size() > 0) {
+        return;
+    }
+    std::vector<mixxx::SampleBuffer>* pExpired = nullptr;
+    {
+        QMutexLocker locker(&s_mutex);
+        s_idleSamples += buffer.size();
+        s_idleBuffers.push_back(std::move(buffer));
+        if (s_idleSamples > kMaxIdleSamples) {
+            pExpired = new std::vector<mixxx::SampleBuffer>;
+            auto it = s_idleBuffers.begin();
+            while (it != s_idleBuffers.end() && s_idleSamples > kMaxIdleSamples) {
+                s_idleSamples -= it->size();
+                pExpired->push_back(std::move(*it));
+                ++it;
+            }
+            s_idleBuffers.erase(s_idleBuffers.begin(), it);
+        }
+    }
+    if (pExpired) {
+        freeLater(pExpired);
+    }
+}
+
+// static
+SINT DelayLinePool::idleSamples() {
+    QMutexLocker locker(&s_mutex);
+    return s_idleSamples;
+}
+
+// static
+void DelayLinePool::reclaim() {
+    std::vector<mixxx::SampleBuffer>* pExpired =
+            new std::vector<mixxx::SampleBuffer>;
+    {
+        QMutexLocker locker(&s_mutex);
+        pExpired->swap(s_idleBuffers);
+        s_idleSamples = 0;
+    }
+    freeLater(pExpired);
+}
+
+// static
+void DelayLinePool::freeLater(std::vector<mixxx::SampleBuffer>* pBuffers) {
+    // Returning big allocations to the system unmaps their pages, which
+    // doesn't need to hold up the main thread.
+    SINT samples = 0;
+    for (const auto& buffer : *pBuffers) {
+        samples += buffer.size();
+    }
+    MemoryAccounting::subtract(MemoryAccounting::Category::EffectStates,
+            bytesOfSamples(samples));
+    QtConcurrent::run([pBuffers] {
+        delete pBuffers;
+    });
+}
@@ -0,0 +1,101 @@
+#ifndef DELAYLINEPOOL_H
+#define DELAYLINEPOOL_H
+
+#include <vector>
+
+#include <QMutex>
+
+#include "util/class.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+// Delay lines of effects like the Echo are megabytes in size. Allocating a
+// new one for every EffectState means the memory has to be requested from
+// the system and faulted in again every time an effect is loaded or a
+// channel is routed to a chain. Instead, EffectStates lease their delay lines
+// from DelayLinePool and return them when they are deleted, so the memory of
+// deleted states is reused by the next state that needs a delay line of the
+// same size.
+//
+// Buffers are cleared when they are leased, which also touches every page
+// of a newly allocated buffer, so the audio callback never page faults on
+// them. Like EffectStates, delay lines should only be leased and released
+// from the main thread.
+class DelayLinePool {
+  public:
+    // The maximum number of samples kept for reuse. When more samples are
+    // released, the oldest idle buffers are freed on a worker thread.
+    static const SINT kMaxIdleSamples;
+
+    // Returns a cleared buffer with size samples.
+    static mixxx::SampleBuffer lease(SINT size);
+    // Returns a buffer to the pool.
+    static void release(mixxx::SampleBuffer buffer);
+
+    // The total size of the buffers that are currently kept for reuse
+    static SINT idleSamples();
+    // Frees all idle buffers
+    static void reclaim();
+
+  private:
+    // Frees the buffers of pBuffers and pBuffers itself on a worker thread
+    static void freeLater(std::vector<mixxx::SampleBuffer>* pBuffers);
+
+    static QMutex s_mutex;
+    // Ordered from the least to the most recently released buffer
+    static std::vector<mixxx::SampleBuffer> s_idleBuffers;
+    static SINT s_idleSamples;
+};
+
+// A delay line leased from DelayLinePool for the lifetime of the object.
+class DelayLine {
+  public:
+    DelayLine() {
+    }
+    explicit DelayLine(SINT size)
+            : m_buffer(DelayLinePool::lease(size)) {
+    }
+    DelayLine(DelayLine&& that)
+            : m_buffer(std::move(that.m_buffer)) {
+    }
+    ~DelayLine() {
+        if (m_buffer.size() > 0) {
+            DelayLinePool::release(std::move(m_buffer));
+        }
+    }
+
+    DelayLine& operator=(DelayLine&& that) {
+        // The previous buffer is released by the destructor of that
+        m_buffer.swap(that.m_buffer);
+        return *this;
+    }
+
+    SINT size() const {
+        return m_buffer.size();
+    }
+
+    CSAMPLE* data(SINT offset = 0) {
+        return m_buffer.data(offset);
+    }
+    const CSAMPLE* data(SINT offset = 0) const {
+        return m_buffer.data(offset);
+    }
+
+    CSAMPLE& operator[](SINT index) {
+        return m_buffer[index];
+    }
+    const CSAMPLE& operator[](SINT index) const {
+        return m_buffer[index];
+    }
+
+    void clear() {
+        m_buffer.clear();
+    }
+
+  private:
+    mixxx::SampleBuffer m_buffer;
+
+    DISALLOW_COPY_AND_ASSIGN(DelayLine);
+};
+
+#endif /* DELAYLINEPOOL_H */
@@ -61,7 +61,7 @@ void Effect::addToEngine(EngineEffectChain* pChain, int iIndex,
             m_pEffectsManager,
             m_pInstantiator);
 
-    EffectsRequest* request = new EffectsRequest();
+    EffectsRequest* request = m_pEffectsManager->newRequest();
     request->type = EffectsRequest::ADD_EFFECT_TO_CHAIN;
     request->pTargetChain = pChain;
     request->AddEffectToChain.pEffect = m_pEngineEffect;
@@ -82,7 +82,7 @@ void Effect::removeFromEngine(EngineEffectChain* pChain, int iIndex) {
         return;
     }
 
-    EffectsRequest* request = new EffectsRequest();
+    EffectsRequest* request = m_pEffectsManager->newRequest();
     request->type = EffectsRequest::REMOVE_EFFECT_FROM_CHAIN;
     request->pTargetChain = pChain;
     request->RemoveEffectFromChain.pEffect = m_pEngineEffect;
@@ -93,6 +93,31 @@ void Effect::removeFromEngine(EngineEffectChain* pChain, int iIndex) {
     m_bAddedToEngine = false;
 }
 
+void Effect::addStagedToEngine(EngineEffect* pEngineEffect) {
+    VERIFY_OR_DEBUG_ASSERT(pEngineEffect) {
+        return;
+    }
+    VERIFY_OR_DEBUG_ASSERT(!m_bAddedToEngine) {
+        return;
+    }
+
+    m_pEngineEffect = pEngineEffect;
+    m_bAddedToEngine = true;
+
+    m_pEngineEffect->setEnabled(m_bEnabled);
+    for (int i = 0; i < m_parameters.size(); ++i) {
+        const EffectParameter* pParameter = m_parameters.at(i);
+        m_pEngineEffect->setParameterParameters(i,
+                pParameter->getMinimum(), pParameter->getMaximum(),
+                pParameter->getDefault(), pParameter->getValue());
+    }
+}
+
+void Effect::detachFromEngine() {
+    m_pEngineEffect = NULL;
+    m_bAddedToEngine = false;
+}
+
 void Effect::updateEngineState() {
     if (!m_pEngineEffect) {
         return;
@@ -127,7 +152,7 @@ void Effect::sendParameterUpdate() {
     if (!m_pEngineEffect) {
         return;
     }
-    EffectsRequest* pRequest = new EffectsRequest();
+    EffectsRequest* pRequest = m_pEffectsManager->newRequest();
     pRequest->type = EffectsRequest::SET_EFFECT_PARAMETERS;
     pRequest->pTargetEffect = m_pEngineEffect;
     pRequest->SetEffectParameters.enabled = m_bEnabled;
@@ -37,6 +37,9 @@ class Effect : public QObject {
     EffectState* createState(const mixxx::EngineParameters& bufferParameters);
 
     const EffectManifest& getManifest() const;
+    EffectInstantiatorPointer getInstantiator() const {
+        return m_pInstantiator;
+    }
 
     unsigned int numKnobParameters() const;
     unsigned int numButtonParameters() const;
@@ -59,6 +62,15 @@ class Effect : public QObject {
     void addToEngine(EngineEffectChain* pChain, int iIndex,
                      const QSet<ChannelHandleAndGroup>& activeInputChannels);
     void removeFromEngine(EngineEffectChain* pChain, int iIndex);
+    // Takes pEngineEffect, which has been built for this effect by
+    // StagedEffectChain and is added to the engine with its chain. The state
+    // of the effect is applied to pEngineEffect directly because the engine
+    // does not process it yet.
+    void addStagedToEngine(EngineEffect* pEngineEffect);
+    // Forgets the EngineEffect without removing it from its chain when the
+    // chain is replaced as a whole. The EngineEffect is deleted with the
+    // replaced chain.
+    void detachFromEngine();
     void updateEngineState();
 
     static EffectPointer createFromXml(EffectsManager* pEffectsManager,
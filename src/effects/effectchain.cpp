@@ -5,6 +5,8 @@
 #include "effects/effectsmanager.h"
 #include "effects/effectprocessor.h"
 #include "effects/effectxmlelements.h"
+#include "effects/stagedeffectchain.h"
+#include "engine/effects/engineeffect.h"
 #include "engine/effects/engineeffectchain.h"
 #include "engine/effects/engineeffectrack.h"
 #include "engine/effects/message.h"
@@ -37,7 +39,7 @@ void EffectChain::addToEngine(EngineEffectRack* pRack, int iIndex) {
     m_pEngineEffectChain = new EngineEffectChain(m_id,
         m_pEffectsManager->registeredInputChannels(),
         m_pEffectsManager->registeredOutputChannels());
-    EffectsRequest* pRequest = new EffectsRequest();
+    EffectsRequest* pRequest = m_pEffectsManager->newRequest();
     pRequest->type = EffectsRequest::ADD_CHAIN_TO_RACK;
     pRequest->pTargetRack = pRack;
     pRequest->AddChainToRack.pChain = m_pEngineEffectChain;
@@ -68,7 +70,7 @@ void EffectChain::removeFromEngine(EngineEffectRack* pRack, int iIndex) {
         }
     }
 
-    EffectsRequest* pRequest = new EffectsRequest();
+    EffectsRequest* pRequest = m_pEffectsManager->newRequest();
     pRequest->type = EffectsRequest::REMOVE_CHAIN_FROM_RACK;
     pRequest->pTargetRack = pRack;
     pRequest->RemoveChainFromRack.pChain = m_pEngineEffectChain;
@@ -79,6 +81,82 @@ void EffectChain::removeFromEngine(EngineEffectRack* pRack, int iIndex) {
     m_pEngineEffectChain = nullptr;
 }
 
+void EffectChain::addStagedToEngine(EngineEffectRack* pRack, int iIndex,
+                                    StagedEffectChain* pStage,
+                                    EffectChainPointer pReplacedChain) {
+    VERIFY_OR_DEBUG_ASSERT(!m_bAddedToEngine) {
+        return;
+    }
+    VERIFY_OR_DEBUG_ASSERT(pStage && pStage->chain().data() == this) {
+        return;
+    }
+
+    // The engine doesn't know the staged objects yet, so their state is set
+    // directly and they start processing with it.
+    m_pEngineEffectChain = pStage->takeEngineEffectChain();
+    m_pEngineEffectChain->setParameters(m_bEnabled, m_insertionType, m_dMix);
+    const QSet<ChannelHandleAndGroup>& stagedInputChannels =
+            pStage->enabledInputChannels();
+    for (int i = 0; i < m_effects.size(); ++i) {
+        EffectPointer pEffect = m_effects[i];
+        if (!pEffect) {
+            continue;
+        }
+        EngineEffect* pEngineEffect = pStage->takeEngineEffect(i, pEffect);
+        if (pEngineEffect == nullptr) {
+            // The effect has been loaded while the chain was staged
+            pEngineEffect = new EngineEffect(pEffect->getManifest(),
+                    stagedInputChannels,
+                    m_pEffectsManager,
+                    pEffect->getInstantiator());
+        }
+        m_pEngineEffectChain->addStagedEffect(pEngineEffect, i);
+        pEffect->addStagedToEngine(pEngineEffect);
+    }
+
+    EngineEffectChain* pOldChain = nullptr;
+    if (pReplacedChain) {
+        pOldChain = pReplacedChain->detachFromEngine();
+    }
+
+    EffectsRequest* pRequest = m_pEffectsManager->newRequest();
+    pRequest->type = EffectsRequest::REPLACE_CHAIN_IN_RACK;
+    pRequest->pTargetRack = pRack;
+    pRequest->ReplaceChainInRack.pChain = m_pEngineEffectChain;
+    pRequest->ReplaceChainInRack.pOldChain = pOldChain;
+    pRequest->ReplaceChainInRack.iIndex = iIndex;
+    m_pEffectsManager->writeRequest(pRequest);
+    m_bAddedToEngine = true;
+
+    // Catch up with the routing switches that have been changed while the
+    // chain was staged.
+    const QSet<ChannelHandleAndGroup> enabledInputChannels = m_enabledInputChannels;
+    m_enabledInputChannels = stagedInputChannels;
+    for (const ChannelHandleAndGroup& handle_group : stagedInputChannels) {
+        if (!enabledInputChannels.contains(handle_group)) {
+            disableForInputChannel(handle_group);
+        }
+    }
+    for (const ChannelHandleAndGroup& handle_group : enabledInputChannels) {
+        enableForInputChannel(handle_group);
+    }
+}
+
+EngineEffectChain* EffectChain::detachFromEngine() {
+    if (!m_bAddedToEngine) {
+        return nullptr;
+    }
+    for (const EffectPointer& pEffect : m_effects) {
+        if (pEffect) {
+            pEffect->detachFromEngine();
+        }
+    }
+    EngineEffectChain* pEngineEffectChain = m_pEngineEffectChain;
+    m_pEngineEffectChain = nullptr;
+    m_bAddedToEngine = false;
+    return pEngineEffectChain;
+}
+
 void EffectChain::updateEngineState() {
     if (!m_bAddedToEngine) {
         return;
@@ -169,7 +247,7 @@ void EffectChain::enableForInputChannel(const ChannelHandleAndGroup& handle_grou
         return;
     }
 
-    EffectsRequest* request = new EffectsRequest();
+    EffectsRequest* request = m_pEffectsManager->newRequest();
     request->type = EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL;
     request->pTargetChain = m_pEngineEffectChain;
     request->EnableInputChannelForChain.pChannelHandle = &handle_group.handle();
@@ -220,7 +298,7 @@ void EffectChain::disableForInputChannel(const ChannelHandleAndGroup& handle_gro
         if (!m_bAddedToEngine) {
             return;
         }
-        EffectsRequest* request = new EffectsRequest();
+        EffectsRequest* request = m_pEffectsManager->newRequest();
         request->type = EffectsRequest::DISABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL;
         request->pTargetChain = m_pEngineEffectChain;
         request->DisableInputChannelForChain.pChannelHandle = &handle_group.handle();
@@ -317,7 +395,7 @@ void EffectChain::sendParameterUpdate() {
     if (!m_bAddedToEngine) {
         return;
     }
-    EffectsRequest* pRequest = new EffectsRequest();
+    EffectsRequest* pRequest = m_pEffectsManager->newRequest();
     pRequest->type = EffectsRequest::SET_EFFECT_CHAIN_PARAMETERS;
     pRequest->pTargetChain = m_pEngineEffectChain;
     pRequest->SetEffectChainParameters.enabled = m_bEnabled;
@@ -15,6 +15,7 @@ class EffectsManager;
 class EngineEffectRack;
 class EngineEffectChain;
 class EffectChain;
+class StagedEffectChain;
 typedef QSharedPointer<EffectChain> EffectChainPointer;
 
 // The main-thread representation of an effect chain. This class is NOT
@@ -28,6 +29,14 @@ class EffectChain : public QObject {
 
     void addToEngine(EngineEffectRack* pRack, int iIndex);
     void removeFromEngine(EngineEffectRack* pRack, int iIndex);
+    // Adds the engine objects that pStage has built for this chain to the
+    // engine with a single REPLACE_CHAIN_IN_RACK request, which replaces
+    // pReplacedChain at iIndex of pRack, or an empty index if it is null.
+    // The state of the chain and its effects is applied to the engine
+    // objects before the request is sent.
+    void addStagedToEngine(EngineEffectRack* pRack, int iIndex,
+                           StagedEffectChain* pStage,
+                           EffectChainPointer pReplacedChain);
     void updateEngineState();
 
     // The ID of an EffectChain is a unique ID given to it to help associate it
@@ -108,6 +117,10 @@ class EffectChain : public QObject {
     }
 
     void sendParameterUpdate();
+    // Forgets the engine objects of the chain when it is replaced as a whole
+    // with addStagedToEngine(). Returns the EngineEffectChain, which owns the
+    // EngineEffects of the chain from then on.
+    EngineEffectChain* detachFromEngine();
 
     EffectsManager* m_pEffectsManager;
     EffectChainPointer m_pPrototype;
@@ -1,7 +1,10 @@
 #include "effects/effectchainslot.h"
 
+#include <QtConcurrentRun>
+
 #include "effects/effectrack.h"
 #include "effects/effectxmlelements.h"
+#include "effects/stagedeffectchain.h"
 #include "control/controlpotmeter.h"
 #include "control/controlpushbutton.h"
 #include "mixer/playermanager.h"
@@ -87,6 +90,12 @@ EffectChainSlot::EffectChainSlot(EffectRack* pRack, const QString& group,
 
 EffectChainSlot::~EffectChainSlot() {
     //qDebug() << debugString() << "destroyed";
+    for (QFutureWatcher<StagedEffectChain*>* pWatcher : m_stagingWatchers) {
+        pWatcher->waitForFinished();
+        delete pWatcher->result();
+        delete pWatcher;
+    }
+    m_stagingWatchers.clear();
     clear();
     delete m_pControlClear;
     delete m_pControlNumEffects;
@@ -195,7 +204,56 @@ void EffectChainSlot::slotChainEffectChanged(unsigned int effectSlotNumber,
 void EffectChainSlot::loadEffectChainToSlot(EffectChainPointer pEffectChain) {
     //qDebug() << debugString() << "loadEffectChainToSlot" << (pEffectChain ? pEffectChain->id() : "(null)");
     clear();
+    loadEffectChainInner(pEffectChain);
+}
 
+void EffectChainSlot::swapEffectChain(EffectChainPointer pEffectChain,
+                                      EffectsManager* pEffectsManager) {
+    VERIFY_OR_DEBUG_ASSERT(pEffectChain &&
+            pEffectChain->getEngineEffectChain() == nullptr) {
+        return;
+    }
+
+    // While another chain is being staged, the engine still processes the
+    // chain that was loaded before that one.
+    EffectChainPointer pReplacedChain = m_pReplacedEffectChain;
+    if (!pReplacedChain && m_pEffectChain &&
+            m_pEffectChain->getEngineEffectChain() != nullptr) {
+        pReplacedChain = m_pEffectChain;
+    }
+    unloadEffectChain();
+    m_pReplacedEffectChain = pReplacedChain;
+    loadEffectChainInner(pEffectChain);
+    updateRoutingSwitches();
+
+    QFutureWatcher<StagedEffectChain*>* pWatcher =
+            new QFutureWatcher<StagedEffectChain*>(this);
+    connect(pWatcher, SIGNAL(finished()),
+            this, SLOT(slotEffectChainStaged()));
+    m_stagingWatchers.append(pWatcher);
+    pWatcher->setFuture(QtConcurrent::run(&StagedEffectChain::build,
+            new StagedEffectChain(pEffectsManager, pEffectChain)));
+}
+
+void EffectChainSlot::slotEffectChainStaged() {
+    QFutureWatcher<StagedEffectChain*>* pWatcher =
+            static_cast<QFutureWatcher<StagedEffectChain*>*>(sender());
+    m_stagingWatchers.removeOne(pWatcher);
+    StagedEffectChain* pStage = pWatcher->result();
+    pWatcher->deleteLater();
+
+    // Another chain may have been loaded into the slot in the meantime
+    if (m_pEffectChain == pStage->chain() &&
+            m_pEffectChain->getEngineEffectChain() == nullptr) {
+        m_pEffectChain->addStagedToEngine(
+                m_pEffectRack->getEngineEffectRack(), m_iChainSlotNumber,
+                pStage, m_pReplacedEffectChain);
+        m_pReplacedEffectChain.clear();
+    }
+    delete pStage;
+}
+
+void EffectChainSlot::loadEffectChainInner(EffectChainPointer pEffectChain) {
     if (pEffectChain) {
         m_pEffectChain = pEffectChain;
 
@@ -264,10 +322,21 @@ EffectChainPointer EffectChainSlot::getOrCreateEffectChain(
 }
 
 void EffectChainSlot::clear() {
-    // Stop listening to signals from any loaded effect
+    if (m_pReplacedEffectChain) {
+        m_pReplacedEffectChain->removeFromEngine(
+                m_pEffectRack->getEngineEffectRack(), m_iChainSlotNumber);
+        m_pReplacedEffectChain.clear();
+    }
     if (m_pEffectChain) {
         m_pEffectChain->removeFromEngine(m_pEffectRack->getEngineEffectRack(),
                                          m_iChainSlotNumber);
+    }
+    unloadEffectChain();
+}
+
+void EffectChainSlot::unloadEffectChain() {
+    // Stop listening to signals from any loaded effect
+    if (m_pEffectChain) {
         for (EffectSlotPointer pSlot : m_slots) {
             pSlot->clear();
         }
@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QMap>
 #include <QList>
+#include <QFutureWatcher>
 #include <QSignalMapper>
 
 #include "effects/effect.h"
@@ -16,6 +17,7 @@ class ControlObject;
 class ControlPushButton;
 class EffectChainSlot;
 class EffectRack;
+class StagedEffectChain;
 typedef QSharedPointer<EffectChainSlot> EffectChainSlotPointer;
 
 class EffectChainSlot : public QObject {
@@ -34,6 +36,14 @@ class EffectChainSlot : public QObject {
     EffectSlotPointer getEffectSlot(unsigned int slotNumber);
 
     void loadEffectChainToSlot(EffectChainPointer pEffectChain);
+    // Loads pEffectChain like loadEffectChainToSlot() followed by
+    // updateRoutingSwitches(), but builds its engine side on a worker thread
+    // while the engine keeps processing the previously loaded chain. The
+    // engine then swaps the chains with one request and crossfades from the
+    // previous chain, so that loading a chain preset mid-mix doesn't glitch.
+    // pEffectChain must not have been added to the engine.
+    void swapEffectChain(EffectChainPointer pEffectChain,
+                         EffectsManager* pEffectsManager);
     void updateRoutingSwitches();
     EffectChainPointer getEffectChain() const;
     EffectChainPointer getOrCreateEffectChain(EffectsManager* pEffectsManager);
@@ -118,6 +128,7 @@ class EffectChainSlot : public QObject {
     void slotControlChainNextPreset(double v);
     void slotControlChainPrevPreset(double v);
     void slotChannelStatusChanged(const QString& group);
+    void slotEffectChainStaged();
 
   private:
     QString debugString() const {
@@ -128,7 +139,16 @@ class EffectChainSlot : public QObject {
     const QString m_group;
     EffectRack* m_pEffectRack;
 
+    // Loads pEffectChain after the previous chain has been unloaded
+    void loadEffectChainInner(EffectChainPointer pEffectChain);
+    // Unloads the chain without removing it from the engine
+    void unloadEffectChain();
+
     EffectChainPointer m_pEffectChain;
+    // The chain that the engine processes until m_pEffectChain has been
+    // staged by swapEffectChain()
+    EffectChainPointer m_pReplacedEffectChain;
+    QList<QFutureWatcher<StagedEffectChain*>*> m_stagingWatchers;
 
     ControlPushButton* m_pControlClear;
     ControlObject* m_pControlNumEffects;
@@ -215,13 +215,7 @@ void EffectParameter::updateEngineState() {
     if (!pEngineEffect) {
         return;
     }
-    EffectsRequest* pRequest = new EffectsRequest();
-    pRequest->type = EffectsRequest::SET_PARAMETER_PARAMETERS;
-    pRequest->pTargetEffect = pEngineEffect;
-    pRequest->SetParameterParameters.iParameter = m_iParameterNumber;
-    pRequest->value = m_value;
-    pRequest->minimum = m_minimum;
-    pRequest->maximum = m_maximum;
-    pRequest->default_value = m_default;
-    m_pEffectsManager->writeRequest(pRequest);
+    m_pEffectsManager->writeParameterChange(pEngineEffect, m_iParameterNumber,
+                                            m_minimum, m_maximum, m_default,
+                                            m_value);
 }
@@ -13,6 +13,7 @@
 #include "engine/effects/groupfeaturestate.h"
 #include "engine/effects/message.h"
 #include "engine/channelhandle.h"
+#include "util/memoryaccounting.h"
 
 class EngineEffect;
 
@@ -39,7 +40,9 @@ class EngineEffect;
 // without wasting a lot of memory.
 class EffectState {
   public:
-    EffectState(const mixxx::EngineParameters& bufferParameters) {
+    EffectState(const mixxx::EngineParameters& bufferParameters)
+            : m_memoryAccount(MemoryAccounting::Category::EffectStates,
+                      sizeof(EffectState)) {
         // Subclasses should call engineParametersChanged here.
         Q_UNUSED(bufferParameters);
     };
@@ -53,6 +56,16 @@ class EffectState {
     // Subclasses should clear any mixxx::SampleBuffer members and set
     // other values back to their defaults.
     virtual void clear() {};
+
+    // The accounted size of the state object, which is set by
+    // EffectProcessorImpl::createState. Delay lines are accounted by
+    // DelayLinePool.
+    void setAccountedBytes(qint64 bytes) {
+        m_memoryAccount.setBytes(bytes);
+    }
+
+  private:
+    MemoryAccount m_memoryAccount;
 };
 
 // EffectProcessor is an abstract base class for interfacing with the main
@@ -62,7 +75,8 @@ class EffectProcessor {
   public:
     virtual ~EffectProcessor() { }
 
-    // Called from main thread to avoid allocating memory in the audio callback thread
+    // Called from main thread to avoid allocating memory in the audio callback thread,
+    // or from a worker thread for an effect of a StagedEffectChain
     virtual void initialize(
             const QSet<ChannelHandleAndGroup>& activeInputChannels,
             EffectsManager* pEffectsManager,
@@ -90,6 +104,17 @@ class EffectProcessor {
                          const mixxx::EngineParameters& bufferParameters,
                          const EffectEnableState enableState,
                          const GroupFeatureState& groupFeatures) = 0;
+
+    // Returns the number of frames by which the output of process() lags
+    // behind its input, e.g. the lookahead of a limiter or the block size
+    // of an FFT based effect. EngineMaster delays the other channels by the
+    // same amount so synced decks stay aligned. Called from the audio
+    // callback thread, so it must not block.
+    virtual SINT getLatencyFrames(
+            const mixxx::EngineParameters& bufferParameters) const {
+        Q_UNUSED(bufferParameters);
+        return 0;
+    }
 };
 
 // EffectProcessorImpl manages a separate EffectState for every routing of
@@ -186,6 +211,7 @@ class EffectProcessorImpl : public EffectProcessor {
 
     EffectSpecificState* createState(const mixxx::EngineParameters& bufferParameters) final {
         EffectSpecificState* pState = new EffectSpecificState(bufferParameters);
+        pState->setAccountedBytes(sizeof(EffectSpecificState));
         if (kEffectDebugOutput) {
             qDebug() << this << "EffectProcessorImpl creating EffectState" << pState;
         }
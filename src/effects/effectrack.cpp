@@ -35,7 +35,7 @@ EngineEffectRack* EffectRack::getEngineEffectRack() {
 
 void EffectRack::addToEngine() {
     m_pEngineEffectRack = new EngineEffectRack(m_iRackNumber);
-    EffectsRequest* pRequest = new EffectsRequest();
+    EffectsRequest* pRequest = m_pEffectsManager->newRequest();
     pRequest->type = EffectsRequest::ADD_EFFECT_RACK;
     pRequest->AddEffectRack.pRack = m_pEngineEffectRack;
     pRequest->AddEffectRack.signalProcessingStage = m_signalProcessingStage;
@@ -64,7 +64,7 @@ void EffectRack::removeFromEngine() {
         }
     }
 
-    EffectsRequest* pRequest = new EffectsRequest();
+    EffectsRequest* pRequest = m_pEffectsManager->newRequest();
     pRequest->type = EffectsRequest::REMOVE_EFFECT_RACK;
     pRequest->RemoveEffectRack.signalProcessingStage = m_signalProcessingStage;
     pRequest->RemoveEffectRack.pRack = m_pEngineEffectRack;
@@ -114,9 +114,8 @@ void EffectRack::loadNextChain(const unsigned int iChainSlotNumber,
             pLoadedChain);
 
     pNextChain = EffectChain::clone(pNextChain);
-    pNextChain->addToEngine(m_pEngineEffectRack, iChainSlotNumber);
-    m_effectChainSlots[iChainSlotNumber]->loadEffectChainToSlot(pNextChain);
-    m_effectChainSlots[iChainSlotNumber]->updateRoutingSwitches();
+    m_effectChainSlots[iChainSlotNumber]->swapEffectChain(pNextChain,
+            m_pEffectsManager);
 }
 
 
@@ -130,9 +129,8 @@ void EffectRack::loadPrevChain(const unsigned int iChainSlotNumber,
         pLoadedChain);
 
     pPrevChain = EffectChain::clone(pPrevChain);
-    pPrevChain->addToEngine(m_pEngineEffectRack, iChainSlotNumber);
-    m_effectChainSlots[iChainSlotNumber]->loadEffectChainToSlot(pPrevChain);
-    m_effectChainSlots[iChainSlotNumber]->updateRoutingSwitches();
+    m_effectChainSlots[iChainSlotNumber]->swapEffectChain(pPrevChain,
+            m_pEffectsManager);
 }
 
 void EffectRack::maybeLoadEffect(const unsigned int iChainSlotNumber,
@@ -20,15 +20,31 @@ const QString EffectsBackend::getName() const {
 void EffectsBackend::registerEffect(const QString& id,
                                     const EffectManifest& manifest,
                                     EffectInstantiatorPointer pInstantiator) {
+    registerEffect(id, [manifest]() { return manifest; }, pInstantiator);
+}
+
+void EffectsBackend::registerEffect(const QString& id,
+                                    const ManifestFactory& createManifest,
+                                    EffectInstantiatorPointer pInstantiator) {
     if (m_registeredEffects.contains(id)) {
         qWarning() << "WARNING: Effect" << id << "already registered";
         return;
     }
 
-    m_registeredEffects[id] = QPair<EffectManifest, EffectInstantiatorPointer>(
-            manifest, pInstantiator);
+    RegisteredEffect& effect = m_registeredEffects[id];
+    effect.createManifest = createManifest;
+    effect.manifestCreated = false;
+    effect.pInstantiator = pInstantiator;
     m_effectIds.append(id);
-    emit(effectRegistered(manifest));
+    emit(effectRegistered(id));
+}
+
+const EffectManifest& EffectsBackend::manifestOf(RegisteredEffect* pEffect) const {
+    if (!pEffect->manifestCreated) {
+        pEffect->manifest = pEffect->createManifest();
+        pEffect->manifestCreated = true;
+    }
+    return pEffect->manifest;
 }
 
 const QList<QString>& EffectsBackend::getEffectIds() const {
@@ -36,11 +52,12 @@ const QList<QString>& EffectsBackend::getEffectIds() const {
 }
 
 EffectManifest EffectsBackend::getManifest(const QString& effectId) const {
-    if (!m_registeredEffects.contains(effectId)) {
+    auto it = m_registeredEffects.find(effectId);
+    if (it == m_registeredEffects.end()) {
         qWarning() << "WARNING: Effect" << effectId << "is not registered.";
         return EffectManifest();
     }
-    return m_registeredEffects[effectId].first;
+    return manifestOf(&it.value());
 }
 
 bool EffectsBackend::canInstantiateEffect(const QString& effectId) const {
@@ -49,13 +66,13 @@ bool EffectsBackend::canInstantiateEffect(const QString& effectId) const {
 
 EffectPointer EffectsBackend::instantiateEffect(EffectsManager* pEffectsManager,
                                                 const QString& effectId) {
-    if (!m_registeredEffects.contains(effectId)) {
+    auto it = m_registeredEffects.find(effectId);
+    if (it == m_registeredEffects.end()) {
         qWarning() << "WARNING: Effect" << effectId << "is not registered.";
         return EffectPointer();
     }
-    QPair<EffectManifest, EffectInstantiatorPointer>& effectInfo =
-            m_registeredEffects[effectId];
 
     return EffectPointer(new Effect(pEffectsManager,
-                                    effectInfo.first, effectInfo.second));
+                                    manifestOf(&it.value()),
+                                    it->pInstantiator));
 }
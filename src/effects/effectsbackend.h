@@ -1,6 +1,8 @@
 #ifndef EFFECTSBACKEND_H
 #define EFFECTSBACKEND_H
 
+#include <functional>
+
 #include <QObject>
 #include <QList>
 #include <QSet>
@@ -16,6 +18,11 @@ class EffectProcessor;
 // An EffectsBackend is an implementation of a provider of Effect's for use
 // within the rest of Mixxx. The job of the EffectsBackend is to both enumerate
 // and instantiate effects.
+//
+// Effects are registered with a function that creates their manifest. The
+// manifest with all its parameters is only created when it is requested for
+// the first time, e.g. when the effect is loaded or listed in the
+// preferences.
 class EffectsBackend : public QObject {
     Q_OBJECT
   public:
@@ -32,25 +39,41 @@ class EffectsBackend : public QObject {
             EffectsManager* pEffectsManager, const QString& effectId);
 
   signals:
-    void effectRegistered(EffectManifest);
+    void effectRegistered(QString effectId);
 
   protected:
+    typedef std::function<EffectManifest()> ManifestFactory;
+
     void registerEffect(const QString& id,
                         const EffectManifest& manifest,
                         EffectInstantiatorPointer pInstantiator);
+    void registerEffect(const QString& id,
+                        const ManifestFactory& createManifest,
+                        EffectInstantiatorPointer pInstantiator);
 
     template <typename EffectProcessorImpl>
     void registerEffect() {
         registerEffect(
                 EffectProcessorImpl::getId(),
-                EffectProcessorImpl::getManifest(),
+                ManifestFactory(&EffectProcessorImpl::getManifest),
                 EffectInstantiatorPointer(
                             new EffectProcessorInstantiator<EffectProcessorImpl>()));
     }
 
   private:
+    struct RegisteredEffect {
+        ManifestFactory createManifest;
+        // Created by the factory on first use
+        EffectManifest manifest;
+        bool manifestCreated;
+        EffectInstantiatorPointer pInstantiator;
+    };
+
+    const EffectManifest& manifestOf(RegisteredEffect* pEffect) const;
+
     QString m_name;
-    QMap<QString, QPair<EffectManifest, EffectInstantiatorPointer> > m_registeredEffects;
+    // Filled on demand from the const getters
+    mutable QMap<QString, RegisteredEffect> m_registeredEffects;
     QList<QString> m_effectIds;
 };
 
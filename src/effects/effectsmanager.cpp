@@ -13,6 +13,9 @@ namespace {
 const QString kEffectGroupSeparator = "_";
 const QString kGroupClose = "]";
 const unsigned int kEffectMessagPipeFifoSize = 2048;
+// Enough for the requests of loading the chain presets of all effect units
+const int kPreallocatedRequests = 512;
+const int kPreallocatedParameterBatches = 4;
 } // anonymous namespace
 
 
@@ -21,7 +24,11 @@ EffectsManager::EffectsManager(QObject* pParent, UserSettingsPointer pConfig,
         : QObject(pParent),
           m_pChannelHandleFactory(pChannelHandleFactory),
           m_pEffectChainManager(new EffectChainManager(pConfig, this)),
+          m_availableEffectManifestsCreated(false),
+          m_numAvailableEffects(0),
           m_nextRequestId(0),
+          m_requestPool(kPreallocatedRequests, kPreallocatedParameterBatches),
+          m_pPendingParameterBatch(nullptr),
           m_pLoEqFreq(NULL),
           m_pHiEqFreq(NULL),
           m_underDestruction(false) {
@@ -50,9 +57,11 @@ EffectsManager::~EffectsManager() {
     }
     for (QHash<qint64, EffectsRequest*>::iterator it = m_activeRequests.begin();
          it != m_activeRequests.end();) {
-        delete it.value();
+        m_requestPool.release(it.value());
         it = m_activeRequests.erase(it);
     }
+    m_requestPool.releaseBatch(m_pPendingParameterBatch);
+    m_pPendingParameterBatch = nullptr;
 
     delete m_pHiEqFreq;
     delete m_pLoEqFreq;
@@ -74,29 +83,40 @@ void EffectsManager::addEffectsBackend(EffectsBackend* pBackend) {
     }
     m_effectsBackends.append(pBackend);
 
-    QList<QString> backendEffects = pBackend->getEffectIds();
-    for (const QString& effectId : backendEffects) {
-        m_availableEffectManifests.append(pBackend->getManifest(effectId));
-    }
-
-    m_pNumEffectsAvailable->forceSet(m_availableEffectManifests.size());
+    // The manifests are only created when the list of all effects is needed
+    m_availableEffectManifests.clear();
+    m_availableEffectManifestsCreated = false;
+    m_numAvailableEffects += pBackend->getEffectIds().size();
+    m_pNumEffectsAvailable->forceSet(m_numAvailableEffects);
 
-    qSort(m_availableEffectManifests.begin(), m_availableEffectManifests.end(),
-          alphabetizeEffectManifests);
-
-    connect(pBackend, SIGNAL(effectRegistered(EffectManifest)),
-            this, SLOT(slotBackendRegisteredEffect(EffectManifest)));
+    connect(pBackend, SIGNAL(effectRegistered(QString)),
+            this, SLOT(slotBackendRegisteredEffect(QString)));
+}
 
-    connect(pBackend, SIGNAL(effectRegistered(EffectManifest)),
-            this, SIGNAL(availableEffectsUpdated(EffectManifest)));
+void EffectsManager::slotBackendRegisteredEffect(QString effectId) {
+    const EffectManifest manifest = getEffectManifest(effectId);
+    if (m_availableEffectManifestsCreated) {
+        auto insertion_point = qLowerBound(m_availableEffectManifests.begin(),
+                                           m_availableEffectManifests.end(),
+                                           manifest, alphabetizeEffectManifests);
+        m_availableEffectManifests.insert(insertion_point, manifest);
+    }
+    m_pNumEffectsAvailable->forceSet(++m_numAvailableEffects);
+    emit(availableEffectsUpdated(manifest));
 }
 
-void EffectsManager::slotBackendRegisteredEffect(EffectManifest manifest) {
-    auto insertion_point = qLowerBound(m_availableEffectManifests.begin(),
-                                       m_availableEffectManifests.end(),
-                                       manifest, alphabetizeEffectManifests);
-    m_availableEffectManifests.insert(insertion_point, manifest);
-    m_pNumEffectsAvailable->forceSet(m_availableEffectManifests.size());
+const QList<EffectManifest>& EffectsManager::getAvailableEffectManifests() const {
+    if (!m_availableEffectManifestsCreated) {
+        for (EffectsBackend* pBackend : m_effectsBackends) {
+            for (const QString& effectId : pBackend->getEffectIds()) {
+                m_availableEffectManifests.append(pBackend->getManifest(effectId));
+            }
+        }
+        qSort(m_availableEffectManifests.begin(), m_availableEffectManifests.end(),
+              alphabetizeEffectManifests);
+        m_availableEffectManifestsCreated = true;
+    }
+    return m_availableEffectManifests;
 }
 
 void EffectsManager::registerInputChannel(const ChannelHandleAndGroup& handle_group) {
@@ -118,11 +138,11 @@ const QSet<ChannelHandleAndGroup>& EffectsManager::registeredOutputChannels() co
 const QList<EffectManifest> EffectsManager::getAvailableEffectManifestsFiltered(
         EffectManifestFilterFnc filter) const {
     if (filter == nullptr) {
-        return m_availableEffectManifests;
+        return getAvailableEffectManifests();
     }
 
     QList<EffectManifest> list;
-    for (const auto& manifest : m_availableEffectManifests) {
+    for (const auto& manifest : getAvailableEffectManifests()) {
         if (filter(manifest)) {
             list.append(manifest);
         }
@@ -135,43 +155,47 @@ bool EffectsManager::isEQ(const QString& effectId) const {
 }
 
 QString EffectsManager::getNextEffectId(const QString& effectId) {
-    if (m_availableEffectManifests.isEmpty()) {
+    const QList<EffectManifest>& availableEffectManifests =
+            getAvailableEffectManifests();
+    if (availableEffectManifests.isEmpty()) {
         return QString();
     }
     if (effectId.isNull()) {
-        return m_availableEffectManifests.first().id();
+        return availableEffectManifests.first().id();
     }
 
     int index;
-    for (index = 0; index < m_availableEffectManifests.size(); ++index) {
-        if (effectId == m_availableEffectManifests.at(index).id()) {
+    for (index = 0; index < availableEffectManifests.size(); ++index) {
+        if (effectId == availableEffectManifests.at(index).id()) {
             break;
         }
     }
-    if (++index >= m_availableEffectManifests.size()) {
+    if (++index >= availableEffectManifests.size()) {
         index = 0;
     }
-    return m_availableEffectManifests.at(index).id();
+    return availableEffectManifests.at(index).id();
 }
 
 QString EffectsManager::getPrevEffectId(const QString& effectId) {
-    if (m_availableEffectManifests.isEmpty()) {
+    const QList<EffectManifest>& availableEffectManifests =
+            getAvailableEffectManifests();
+    if (availableEffectManifests.isEmpty()) {
         return QString();
     }
     if (effectId.isNull()) {
-        return m_availableEffectManifests.last().id();
+        return availableEffectManifests.last().id();
     }
 
     int index;
-    for (index = 0; index < m_availableEffectManifests.size(); ++index) {
-        if (effectId == m_availableEffectManifests.at(index).id()) {
+    for (index = 0; index < availableEffectManifests.size(); ++index) {
+        if (effectId == availableEffectManifests.at(index).id()) {
             break;
         }
     }
     if (--index < 0) {
-        index = m_availableEffectManifests.size() - 1;
+        index = availableEffectManifests.size() - 1;
     }
-    return m_availableEffectManifests.at(index).id();
+    return availableEffectManifests.at(index).id();
 }
 
 QPair<EffectManifest, EffectsBackend*> EffectsManager::getEffectManifestAndBackend(
@@ -382,6 +406,13 @@ void EffectsManager::loadEffectChains() {
 }
 
 bool EffectsManager::writeRequest(EffectsRequest* request) {
+    // Parameter changes must reach the engine before any request that is
+    // written after them, e.g. one that removes their effect.
+    slotFlushParameterChanges();
+    return writeRequestInner(request);
+}
+
+bool EffectsManager::writeRequestInner(EffectsRequest* request) {
     if (m_underDestruction) {
         // Catch all delete Messages since the engine is already down
         // and we cannot wait for a communication cycle
@@ -389,7 +420,7 @@ bool EffectsManager::writeRequest(EffectsRequest* request) {
     }
 
     if (m_pRequestPipe.isNull()) {
-        delete request;
+        m_requestPool.release(request);
         return false;
     }
 
@@ -398,15 +429,68 @@ bool EffectsManager::writeRequest(EffectsRequest* request) {
     processEffectsResponses();
 
     request->request_id = m_nextRequestId++;
-    // TODO(XXX) use preallocated requests to avoid delete calls from engine
     if (m_pRequestPipe->writeMessages(&request, 1) == 1) {
         m_activeRequests[request->request_id] = request;
         return true;
     }
-    delete request;
+    m_requestPool.release(request);
     return false;
 }
 
+void EffectsManager::writeParameterChange(EngineEffect* pEffect, int iParameter,
+                                          double minimum, double maximum,
+                                          double default_value, double value) {
+    EffectParameterChange* pChange = nullptr;
+    if (m_pPendingParameterBatch == nullptr) {
+        m_pPendingParameterBatch = m_requestPool.newBatch();
+        QMetaObject::invokeMethod(this, "slotFlushParameterChanges",
+                                  Qt::QueuedConnection);
+    } else {
+        for (int i = 0; i < m_pPendingParameterBatch->count; ++i) {
+            EffectParameterChange& change = m_pPendingParameterBatch->changes[i];
+            if (change.pEffect == pEffect && change.iParameter == iParameter) {
+                pChange = &change;
+                break;
+            }
+        }
+    }
+
+    if (pChange == nullptr) {
+        if (m_pPendingParameterBatch->count >= EffectParameterBatch::kMaxChanges) {
+            EffectParameterBatch* pFullBatch = m_pPendingParameterBatch;
+            m_pPendingParameterBatch = m_requestPool.newBatch();
+            EffectsRequest* pRequest = m_requestPool.newRequest();
+            pRequest->type = EffectsRequest::SET_PARAMETER_PARAMETERS_BATCH;
+            pRequest->SetParameterParametersBatch.pBatch = pFullBatch;
+            writeRequestInner(pRequest);
+        }
+        pChange = &m_pPendingParameterBatch->changes[
+                m_pPendingParameterBatch->count++];
+        pChange->pEffect = pEffect;
+        pChange->iParameter = iParameter;
+    }
+    pChange->minimum = minimum;
+    pChange->maximum = maximum;
+    pChange->default_value = default_value;
+    pChange->value = value;
+}
+
+void EffectsManager::slotFlushParameterChanges() {
+    if (m_pPendingParameterBatch == nullptr) {
+        return;
+    }
+    EffectParameterBatch* pBatch = m_pPendingParameterBatch;
+    m_pPendingParameterBatch = nullptr;
+    if (pBatch->count == 0) {
+        m_requestPool.releaseBatch(pBatch);
+        return;
+    }
+    EffectsRequest* pRequest = m_requestPool.newRequest();
+    pRequest->type = EffectsRequest::SET_PARAMETER_PARAMETERS_BATCH;
+    pRequest->SetParameterParametersBatch.pBatch = pBatch;
+    writeRequestInner(pRequest);
+}
+
 void EffectsManager::processEffectsResponses() {
     if (m_pRequestPipe.isNull()) {
         return;
@@ -433,7 +517,7 @@ void EffectsManager::processEffectsResponses() {
 
             collectGarbage(pRequest);
 
-            delete pRequest;
+            m_requestPool.release(pRequest);
             it = m_activeRequests.erase(it);
         }
     }
@@ -446,6 +530,16 @@ void EffectsManager::collectGarbage(const EffectsRequest* pRequest) {
     } else if (pRequest->type == EffectsRequest::REMOVE_CHAIN_FROM_RACK) {
         //qDebug() << debugString() << "delete" << request->RemoveEffectFromChain.pEffect;
         delete pRequest->RemoveChainFromRack.pChain;
+    } else if (pRequest->type == EffectsRequest::REPLACE_CHAIN_IN_RACK) {
+        // The engine responds after the crossfade from the replaced chain,
+        // which owns the engine effects of the EffectChain it belonged to.
+        EngineEffectChain* pOldChain = pRequest->ReplaceChainInRack.pOldChain;
+        if (pOldChain != nullptr) {
+            for (EngineEffect* pEffect : pOldChain->effects()) {
+                delete pEffect;
+            }
+            delete pOldChain;
+        }
     } else if (pRequest->type == EffectsRequest::REMOVE_EFFECT_RACK) {
         //qDebug() << debugString() << "delete" << pRequest->RemoveEffectRack.pRack;
         delete pRequest->RemoveEffectRack.pRack;
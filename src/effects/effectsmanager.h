@@ -17,6 +17,7 @@
 #include "effects/effectchainslot.h"
 #include "effects/effectrack.h"
 #include "effects/effectsbackend.h"
+#include "effects/effectsrequestpool.h"
 #include "engine/channelhandle.h"
 #include "engine/effects/message.h"
 #include "util/class.h"
@@ -79,9 +80,8 @@ class EffectsManager : public QObject {
     QString getNextEffectId(const QString& effectId);
     QString getPrevEffectId(const QString& effectId);
 
-    inline const QList<EffectManifest>& getAvailableEffectManifests() const {
-        return m_availableEffectManifests;
-    };
+    // Creates the manifests of all effects when called for the first time
+    const QList<EffectManifest>& getAvailableEffectManifests() const;
     const QList<EffectManifest> getAvailableEffectManifestsFiltered(
         EffectManifestFilterFnc filter) const;
     bool isEQ(const QString& effectId) const;
@@ -93,15 +93,33 @@ class EffectsManager : public QObject {
     // Temporary, but for setting up all the default EffectChains and EffectRacks
     void setup();
 
+    // Returns an empty EffectsRequest from the request pool, to be passed to
+    // writeRequest().
+    EffectsRequest* newRequest() {
+        return m_requestPool.newRequest();
+    }
+
     // Write an EffectsRequest to the EngineEffectsManager. EffectsManager takes
-    // ownership of request and deletes it once a response is received.
+    // ownership of request and returns it to the request pool once a response
+    // is received. The request must have been obtained from newRequest().
     bool writeRequest(EffectsRequest* request);
 
+    // Sets the parameters of an EngineEffectParameter. The changes are
+    // collected and sent to the engine as a single
+    // SET_PARAMETER_PARAMETERS_BATCH request when control returns to the event
+    // loop, or before the next other request, so that e.g. moving a superknob
+    // or loading a chain preset only sends one request. Repeated changes of
+    // the same parameter are merged.
+    void writeParameterChange(EngineEffect* pEffect, int iParameter,
+                              double minimum, double maximum,
+                              double default_value, double value);
+
   signals:
     void availableEffectsUpdated(EffectManifest);
 
   private slots:
-    void slotBackendRegisteredEffect(EffectManifest manifest);
+    void slotBackendRegisteredEffect(QString effectId);
+    void slotFlushParameterChanges();
 
   private:
     QString debugString() const {
@@ -109,19 +127,26 @@ class EffectsManager : public QObject {
     }
 
     void processEffectsResponses();
+    bool writeRequestInner(EffectsRequest* request);
     void collectGarbage(const EffectsRequest* pResponse);
 
     ChannelHandleFactory* m_pChannelHandleFactory;
 
     EffectChainManager* m_pEffectChainManager;
     QList<EffectsBackend*> m_effectsBackends;
-    QList<EffectManifest> m_availableEffectManifests;
+    // Sorted by the display name, filled on demand from the const getters
+    mutable QList<EffectManifest> m_availableEffectManifests;
+    mutable bool m_availableEffectManifestsCreated;
+    int m_numAvailableEffects;
 
     EngineEffectsManager* m_pEngineEffectsManager;
 
     QScopedPointer<EffectsRequestPipe> m_pRequestPipe;
     qint64 m_nextRequestId;
     QHash<qint64, EffectsRequest*> m_activeRequests;
+    EffectsRequestPool m_requestPool;
+    // The parameter changes that have not been sent yet
+    EffectParameterBatch* m_pPendingParameterBatch;
 
     ControlObject* m_pNumEffectsAvailable;
     // We need to create Control Objects for Equalizers' frequencies
@@ -0,0 +1,72 @@
+#include "effects/effectsrequestpool.h"
+
+#include <QtAlgorithms>
+
+#include "util/assert.h"
+
+EffectsRequestPool::EffectsRequestPool(int preallocatedRequests,
+                                       int preallocatedBatches) {
+    m_allRequests.reserve(preallocatedRequests);
+    m_freeRequests.reserve(preallocatedRequests);
+    for (int i = 0; i < preallocatedRequests; ++i) {
+        EffectsRequest* pRequest = new EffectsRequest();
+        m_allRequests.append(pRequest);
+        m_freeRequests.append(pRequest);
+    }
+    m_allBatches.reserve(preallocatedBatches);
+    m_freeBatches.reserve(preallocatedBatches);
+    for (int i = 0; i < preallocatedBatches; ++i) {
+        EffectParameterBatch* pBatch = new EffectParameterBatch();
+        m_allBatches.append(pBatch);
+        m_freeBatches.append(pBatch);
+    }
+}
+
+EffectsRequestPool::~EffectsRequestPool() {
+    // Requests that are still in flight are deleted as well. The engine is
+    // gone by the time the pool is deleted.
+    qDeleteAll(m_allRequests);
+    qDeleteAll(m_allBatches);
+}
+
+EffectsRequest* EffectsRequestPool::newRequest() {
+    if (m_freeRequests.isEmpty()) {
+        EffectsRequest* pRequest = new EffectsRequest();
+        m_allRequests.append(pRequest);
+        return pRequest;
+    }
+    EffectsRequest* pRequest = m_freeRequests.takeLast();
+    *pRequest = EffectsRequest();
+    return pRequest;
+}
+
+EffectParameterBatch* EffectsRequestPool::newBatch() {
+    if (m_freeBatches.isEmpty()) {
+        EffectParameterBatch* pBatch = new EffectParameterBatch();
+        m_allBatches.append(pBatch);
+        return pBatch;
+    }
+    EffectParameterBatch* pBatch = m_freeBatches.takeLast();
+    pBatch->count = 0;
+    return pBatch;
+}
+
+void EffectsRequestPool::release(EffectsRequest* pRequest) {
+    if (pRequest == nullptr) {
+        return;
+    }
+    if (pRequest->type == EffectsRequest::SET_PARAMETER_PARAMETERS_BATCH) {
+        releaseBatch(pRequest->SetParameterParametersBatch.pBatch);
+        pRequest->SetParameterParametersBatch.pBatch = nullptr;
+    }
+    DEBUG_ASSERT(!m_freeRequests.contains(pRequest));
+    m_freeRequests.append(pRequest);
+}
+
+void EffectsRequestPool::releaseBatch(EffectParameterBatch* pBatch) {
+    if (pBatch == nullptr) {
+        return;
+    }
+    DEBUG_ASSERT(!m_freeBatches.contains(pBatch));
+    m_freeBatches.append(pBatch);
+}
@@ -0,0 +1,50 @@
+#ifndef EFFECTSREQUESTPOOL_H
+#define EFFECTSREQUESTPOOL_H
+
+#include <QList>
+
+#include "engine/effects/message.h"
+#include "util/class.h"
+
+// A free list of EffectsRequests and EffectParameterBatches for the main
+// thread. Requests are handed to the engine and returned to the pool by
+// EffectsManager once their response has been received, so after the pool has
+// grown to the peak number of requests in flight, writing requests no longer
+// allocates. The engine never creates or deletes requests, so the pool does
+// not need to be thread-safe.
+class EffectsRequestPool {
+  public:
+    EffectsRequestPool(int preallocatedRequests, int preallocatedBatches);
+    virtual ~EffectsRequestPool();
+
+    // Returns a default-constructed request. Allocates only if all requests
+    // of the pool are in use.
+    EffectsRequest* newRequest();
+    // Returns an empty batch. Allocates only if all batches of the pool are
+    // in use.
+    EffectParameterBatch* newBatch();
+
+    // Returns pRequest and the batch attached to it to the pool.
+    void release(EffectsRequest* pRequest);
+    void releaseBatch(EffectParameterBatch* pBatch);
+
+    int allocatedRequestCount() const {
+        return m_allRequests.size();
+    }
+    int freeRequestCount() const {
+        return m_freeRequests.size();
+    }
+    int allocatedBatchCount() const {
+        return m_allBatches.size();
+    }
+
+  private:
+    QList<EffectsRequest*> m_allRequests;
+    QList<EffectsRequest*> m_freeRequests;
+    QList<EffectParameterBatch*> m_allBatches;
+    QList<EffectParameterBatch*> m_freeBatches;
+
+    DISALLOW_COPY_AND_ASSIGN(EffectsRequestPool);
+};
+
+#endif /* EFFECTSREQUESTPOOL_H */
@@ -176,22 +176,18 @@ void EchoEffect::processChannel(const ChannelHandle& handle, EchoGroupState* pGr
     decrementRing(&read_position, delay_samples, gs.delay_buf.size());
 
     // Feedback the delay buffer and then add the new input.
-    const CSAMPLE_GAIN send_delta = (send_amount - gs.prev_send) /
-            bufferParameters.framesPerBuffer();
-    const CSAMPLE_GAIN send_start = gs.prev_send + send_delta;
-
-    const CSAMPLE_GAIN feedback_delta = (feedback_amount - gs.prev_feedback) /
-            bufferParameters.framesPerBuffer();
-    const CSAMPLE_GAIN feedback_start = gs.prev_feedback + feedback_delta;
+    const CSAMPLE_GAIN* sendRamped = gs.send.ramp(
+            send_amount, bufferParameters.framesPerBuffer());
+    const CSAMPLE_GAIN* feedbackRamped = gs.feedback.ramp(
+            feedback_amount, bufferParameters.framesPerBuffer());
 
     //TODO: rewrite to remove assumption of stereo buffer
     for (unsigned int i = 0;
             i < bufferParameters.samplesPerBuffer();
             i += bufferParameters.channelCount()) {
-        CSAMPLE_GAIN send_ramped = send_start
-                + send_delta * i / bufferParameters.channelCount();
-        CSAMPLE_GAIN feedback_ramped = feedback_start
-                + feedback_delta * i / bufferParameters.channelCount();
+        const SINT frame = i / bufferParameters.channelCount();
+        CSAMPLE_GAIN send_ramped = sendRamped[frame];
+        CSAMPLE_GAIN feedback_ramped = feedbackRamped[frame];
 
         CSAMPLE bufferedSampleLeft = gs.delay_buf[read_position];
         CSAMPLE bufferedSampleRight = gs.delay_buf[read_position + 1];
@@ -251,7 +247,5 @@ void EchoEffect::processChannel(const ChannelHandle& handle, EchoGroupState* pGr
         gs.delay_buf.clear();
     }
 
-    gs.prev_send = send_amount;
-    gs.prev_feedback = feedback_amount;
     gs.prev_delay_samples = delay_samples;
 }
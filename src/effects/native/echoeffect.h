@@ -3,12 +3,14 @@
 
 #include <QMap>
 
+#include "effects/delaylinepool.h"
 #include "effects/effectprocessor.h"
 #include "engine/engine.h"
 #include "engine/effects/engineeffect.h"
 #include "engine/effects/engineeffectparameter.h"
 #include "util/class.h"
 #include "util/defs.h"
+#include "util/rampedparameter.h"
 #include "util/sample.h"
 #include "util/samplebuffer.h"
 
@@ -19,28 +21,30 @@ class EchoGroupState : public EffectState {
     static constexpr int kMaxDelaySeconds = 3;
 
     EchoGroupState(const mixxx::EngineParameters bufferParameters)
-           : EffectState(bufferParameters) {
+           : EffectState(bufferParameters),
+             send(0, bufferParameters.framesPerBuffer()),
+             feedback(0, bufferParameters.framesPerBuffer()) {
         audioParametersChanged(bufferParameters);
        clear();
     }
 
     void audioParametersChanged(const mixxx::EngineParameters bufferParameters) {
-        delay_buf = mixxx::SampleBuffer(kMaxDelaySeconds
+        delay_buf = DelayLine(kMaxDelaySeconds
                 * bufferParameters.sampleRate() * bufferParameters.channelCount());
     };
 
     void clear() {
         delay_buf.clear();
-        prev_send = 0.0f;
-        prev_feedback= 0.0f;
+        send.reset(0);
+        feedback.reset(0);
         prev_delay_samples = 0;
         write_position = 0;
         ping_pong = 0;
     };
 
-    mixxx::SampleBuffer delay_buf;
-    CSAMPLE_GAIN prev_send;
-    CSAMPLE_GAIN prev_feedback;
+    DelayLine delay_buf;
+    RampedParameter send;
+    RampedParameter feedback;
     int prev_delay_samples;
     int write_position;
     int ping_pong;
@@ -166,15 +166,11 @@ void FlangerEffect::processChannel(const ChannelHandle& handle,
     // independently in the loop below, so do not multiply lfoPeriodSamples by
     // the number of channels.
 
-    CSAMPLE_GAIN mix = m_pMixParameter->value();
-    RampingValue<CSAMPLE_GAIN> mixRamped(
-            pState->prev_mix, mix, bufferParameters.framesPerBuffer());
-    pState->prev_mix = mix;
-
-    CSAMPLE_GAIN regen = m_pRegenParameter->value();
-    RampingValue<CSAMPLE_GAIN> regenRamped(
-            pState->prev_regen, regen, bufferParameters.framesPerBuffer());
-    pState->prev_regen = regen;
+    const SINT framesPerBuffer = bufferParameters.framesPerBuffer();
+    const CSAMPLE_GAIN* mixRamped = pState->mix.ramp(
+            m_pMixParameter->value(), framesPerBuffer);
+    const CSAMPLE_GAIN* regenRamped = pState->regen.ramp(
+            m_pRegenParameter->value(), framesPerBuffer);
 
     // With and Manual is limited by amount of amplitude that remains from width
     // to kMaxDelayMs
@@ -184,25 +180,18 @@ void FlangerEffect::processChannel(const ChannelHandle& handle,
     double minManual = kCenterDelayMs - (kMaxLfoWidthMs - width) / 2;
     manual = math_clamp(manual, minManual, maxManual);
 
-    RampingValue<double> widthRamped(
-            pState->prev_width, width, bufferParameters.framesPerBuffer());
-    pState->prev_width = width;
-
-    RampingValue<double> manualRamped(
-            pState->prev_manual, manual, bufferParameters.framesPerBuffer());
-    pState->prev_manual = manual;
+    const CSAMPLE_GAIN* widthRamped = pState->width.ramp(width, framesPerBuffer);
+    const CSAMPLE_GAIN* manualRamped = pState->manual.ramp(manual, framesPerBuffer);
 
     CSAMPLE* delayLeft = pState->delayLeft;
     CSAMPLE* delayRight = pState->delayRight;
 
-   for (unsigned int i = 0;
-          i < bufferParameters.samplesPerBuffer();
-          i += bufferParameters.channelCount()) {
-
-        CSAMPLE_GAIN mix_ramped = mixRamped.getNext();
-        CSAMPLE_GAIN regen_ramped = regenRamped.getNext();
-        double width_ramped = widthRamped.getNext();
-        double manual_ramped = manualRamped.getNext();
+    for (SINT frame = 0; frame < framesPerBuffer; ++frame) {
+        const SINT i = frame * bufferParameters.channelCount();
+        CSAMPLE_GAIN mix_ramped = mixRamped[frame];
+        CSAMPLE_GAIN regen_ramped = regenRamped[frame];
+        double width_ramped = widthRamped[frame];
+        double manual_ramped = manualRamped[frame];
 
         pState->lfoFrames++;
         if (pState->lfoFrames >= lfoPeriodFrames) {
@@ -241,7 +230,7 @@ void FlangerEffect::processChannel(const ChannelHandle& handle,
         SampleUtil::clear(delayLeft, kBufferLenth);
         SampleUtil::clear(delayRight, kBufferLenth);
         pState->previousPeriodFrames = -1;
-        pState->prev_regen = 0;
-        pState->prev_mix = 0;
+        pState->regen.reset(0);
+        pState->mix.reset(0);
     }
 }
@@ -10,7 +10,7 @@
 #include "util/defs.h"
 #include "util/sample.h"
 #include "util/types.h"
-#include "util/rampingvalue.h"
+#include "util/rampedparameter.h"
 
 namespace {
 constexpr double kMaxDelayMs = 13.0;
@@ -29,10 +29,10 @@ struct FlangerGroupState : public EffectState {
               delayPos(0),
               lfoFrames(0),
               previousPeriodFrames(-1),
-              prev_regen(0),
-              prev_mix(0),
-              prev_width(0),
-              prev_manual(kCenterDelayMs) {
+              regen(0, bufferParameters.framesPerBuffer()),
+              mix(0, bufferParameters.framesPerBuffer()),
+              width(0, bufferParameters.framesPerBuffer()),
+              manual(kCenterDelayMs, bufferParameters.framesPerBuffer()) {
         SampleUtil::clear(delayLeft, kBufferLenth);
         SampleUtil::clear(delayRight, kBufferLenth);
     }
@@ -41,10 +41,10 @@ struct FlangerGroupState : public EffectState {
     unsigned int delayPos;
     unsigned int lfoFrames;
     double previousPeriodFrames;
-    CSAMPLE_GAIN prev_regen;
-    CSAMPLE_GAIN prev_mix;
-    CSAMPLE_GAIN prev_width;
-    CSAMPLE_GAIN prev_manual;
+    RampedParameter regen;
+    RampedParameter mix;
+    RampedParameter width;
+    RampedParameter manual;
 };
 
 class FlangerEffect : public EffectProcessorImpl<FlangerGroupState> {
@@ -113,8 +113,10 @@ void LinkwitzRiley8EQEffect::processChannel(const ChannelHandle& handle,
         pState->setFilters(bufferParameters.sampleRate(), pState->m_loFreq, pState->m_hiFreq);
     }
 
-    pState->m_high2->process(pInput, pState->m_pHighBuf, bufferParameters.samplesPerBuffer()); // HighPass first run
-    pState->m_low2->process(pInput, pState->m_pLowBuf, bufferParameters.samplesPerBuffer()); // LowPass first run for low and bandpass
+    // HighPass first run and LowPass first run for low and bandpass
+    pState->m_high2->processPair(pInput, pState->m_pHighBuf,
+            pState->m_low2, pInput, pState->m_pLowBuf,
+            bufferParameters.samplesPerBuffer());
 
     if (fMid != pState->old_mid ||
             fHigh != pState->old_high) {
@@ -129,8 +131,10 @@ void LinkwitzRiley8EQEffect::processChannel(const ChannelHandle& handle,
                 bufferParameters.samplesPerBuffer());
     }
 
-    pState->m_high1->process(pState->m_pHighBuf, pState->m_pMidBuf, bufferParameters.samplesPerBuffer()); // HighPass + BandPass second run
-    pState->m_low1->process(pState->m_pLowBuf, pState->m_pLowBuf, bufferParameters.samplesPerBuffer()); // LowPass second run
+    // HighPass + BandPass second run and LowPass second run
+    pState->m_high1->processPair(pState->m_pHighBuf, pState->m_pMidBuf,
+            pState->m_low1, pState->m_pLowBuf, pState->m_pLowBuf,
+            bufferParameters.samplesPerBuffer());
 
     if (fLow != pState->old_low) {
         SampleUtil::copy2WithRampingGain(pOutput,
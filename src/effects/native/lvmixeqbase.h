@@ -87,12 +87,19 @@ class LVMixEQEffectGroupState : public EffectState {
             m_delay3->process(pInput, m_pHighBuf, numSamples);
         }
 
-        if (fMid || m_oldMid) {
+        const bool processMid = fMid || m_oldMid;
+        const bool processLow = fLow || m_oldLow;
+        if (processMid) {
             m_delay2->process(pInput, m_pBandBuf, numSamples);
-            m_low2->process(m_pBandBuf, m_pBandBuf, numSamples);
         }
 
-        if (fLow || m_oldLow) {
+        if (processMid && processLow) {
+            // Both low passes of the crossover in a single pass
+            m_low1->processPair(pInput, m_pLowBuf,
+                    m_low2, m_pBandBuf, m_pBandBuf, numSamples);
+        } else if (processMid) {
+            m_low2->process(m_pBandBuf, m_pBandBuf, numSamples);
+        } else if (processLow) {
             m_low1->process(pInput, m_pLowBuf, numSamples);
         }
 
@@ -186,11 +186,6 @@ void PhaserEffect::processChannel(const ChannelHandle& handle,
 
     CSAMPLE left = 0, right = 0;
 
-    CSAMPLE_GAIN oldDepth = pState->oldDepth;
-    const CSAMPLE_GAIN depthDelta = (depth - oldDepth)
-            / bufferParameters.framesPerBuffer();
-    const CSAMPLE_GAIN depthStart = oldDepth + depthDelta;
-
     int stereoCheck = m_pStereoParameter->value();
     int counter = 0;
 
@@ -225,12 +220,13 @@ void PhaserEffect::processChannel(const ChannelHandle& handle,
         left = processSample(left, oldInLeft, oldOutLeft, filterCoefLeft, stages);
         right = processSample(right, oldInRight, oldOutRight, filterCoefRight, stages);
 
-        const CSAMPLE_GAIN depth = depthStart + depthDelta * (i / bufferParameters.channelCount());
-
-        // Computing output combining the original and processed sample
-        pOutput[i] = pInput[i] * (1.0 - 0.5 * depth) + left * depth * 0.5;
-        pOutput[i + 1] = pInput[i + 1] * (1.0 - 0.5 * depth) + right * depth * 0.5;
+        pOutput[i] = left;
+        pOutput[i + 1] = right;
     }
 
-    pState->oldDepth = depth;
+    // Computing output combining the original and processed samples
+    const CSAMPLE_GAIN* wetGains = pState->wetGain.ramp(
+            0.5 * depth, bufferParameters.framesPerBuffer());
+    RampedParameter::crossfadeStereo(pOutput, pInput, wetGains,
+            bufferParameters.framesPerBuffer());
 }
@@ -6,6 +6,7 @@
 #include "engine/effects/engineeffectparameter.h"
 #include "util/class.h"
 #include "util/defs.h"
+#include "util/rampedparameter.h"
 #include "util/sample.h"
 #include "util/types.h"
 
@@ -14,14 +15,15 @@
 class PhaserGroupState final : public EffectState {
   public:
     PhaserGroupState(const mixxx::EngineParameters& bufferParameters)
-            : EffectState(bufferParameters) {
+            : EffectState(bufferParameters),
+              wetGain(0, bufferParameters.framesPerBuffer()) {
         clear();
     }
 
     void clear() {
         leftPhase = 0;
         rightPhase = 0;
-        oldDepth = 0;
+        wetGain.reset(0);
         SampleUtil::clear(oldInLeft, MAXSTAGES);
         SampleUtil::clear(oldOutLeft, MAXSTAGES);
         SampleUtil::clear(oldInRight, MAXSTAGES);
@@ -34,8 +36,8 @@ class PhaserGroupState final : public EffectState {
     CSAMPLE oldOutRight[MAXSTAGES];
     CSAMPLE leftPhase;
     CSAMPLE rightPhase;
-    CSAMPLE_GAIN oldDepth;
-
+    // Half of the depth, the gain of the processed signal
+    RampedParameter wetGain;
 };
 
 class PhaserEffect : public EffectProcessorImpl<PhaserGroupState> {
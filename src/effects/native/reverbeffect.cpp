@@ -108,13 +108,15 @@ void ReverbEffect::processChannel(const ChannelHandle& handle,
     const auto damping = m_pDampingParameter->value();
     const auto send = m_pSendParameter->value();
 
-    // Reinitialize the effect when turning it on to prevent replaying the old buffer
-    // from the last time the effect was enabled.
-    // Also, update the sample rate if it has changed.
-    if (enableState == EffectEnableState::Enabling
-        || pState->sampleRate != bufferParameters.sampleRate()) {
+    // Update the sample rate if it has changed, which reallocates the delay
+    // lines. Otherwise only clear the delay lines when turning the effect on
+    // to prevent replaying the old buffer from the last time the effect was
+    // enabled.
+    if (pState->sampleRate != bufferParameters.sampleRate()) {
         pState->reverb.init(bufferParameters.sampleRate());
         pState->sampleRate = bufferParameters.sampleRate();
+    } else if (enableState == EffectEnableState::Enabling) {
+        pState->reverb.activate();
     }
     pState->reverb.processBuffer(pInput, pOutput,
                                  bufferParameters.samplesPerBuffer(),
@@ -19,7 +19,11 @@
 class ReverbGroupState : public EffectState {
   public:
     ReverbGroupState(const mixxx::EngineParameters& bufferParameters)
-        : EffectState(bufferParameters) {
+        : EffectState(bufferParameters),
+          sampleRate(bufferParameters.sampleRate()) {
+        // Allocates the delay lines here in the main thread instead of
+        // in the callback when the effect is enabled
+        reverb.init(sampleRate);
     }
 
     void engineParametersChanged(const mixxx::EngineParameters& bufferParameters) {
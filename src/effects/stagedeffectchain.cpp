@@ -0,0 +1,76 @@
+#include "effects/stagedeffectchain.h"
+
+#include "effects/effectsmanager.h"
+#include "engine/effects/engineeffect.h"
+#include "engine/effects/engineeffectchain.h"
+#include "util/assert.h"
+
+StagedEffectChain::StagedEffectChain(EffectsManager* pEffectsManager,
+                                     EffectChainPointer pChain)
+        : m_pEffectsManager(pEffectsManager),
+          m_pChain(pChain),
+          m_id(pChain->id()),
+          m_enabledInputChannels(pChain->enabledChannels()),
+          m_registeredInputChannels(pEffectsManager->registeredInputChannels()),
+          m_registeredOutputChannels(pEffectsManager->registeredOutputChannels()),
+          m_pEngineEffectChain(nullptr) {
+    for (const EffectPointer& pEffect : pChain->effects()) {
+        StagedEffect effect;
+        if (pEffect) {
+            effect.pEffect = pEffect;
+            effect.manifest = pEffect->getManifest();
+            effect.pInstantiator = pEffect->getInstantiator();
+        }
+        m_effects.append(effect);
+    }
+}
+
+StagedEffectChain::~StagedEffectChain() {
+    for (const StagedEffect& effect : m_effects) {
+        delete effect.pEngineEffect;
+    }
+    delete m_pEngineEffectChain;
+}
+
+// static
+StagedEffectChain* StagedEffectChain::build(StagedEffectChain* pStage) {
+    // EngineEffect and the EffectProcessors also read the registered channels
+    // of EffectsManager, which are only registered during startup.
+    pStage->m_pEngineEffectChain = new EngineEffectChain(pStage->m_id,
+            pStage->m_registeredInputChannels,
+            pStage->m_registeredOutputChannels);
+    for (StagedEffect& effect : pStage->m_effects) {
+        if (effect.pInstantiator) {
+            effect.pEngineEffect = new EngineEffect(effect.manifest,
+                    pStage->m_enabledInputChannels,
+                    pStage->m_pEffectsManager,
+                    effect.pInstantiator);
+        }
+    }
+    for (const ChannelHandleAndGroup& inputChannel :
+            pStage->m_enabledInputChannels) {
+        pStage->m_pEngineEffectChain->enableStagedInputChannel(
+                inputChannel.handle());
+    }
+    pStage->m_pEngineEffectChain->prepareCrossfade();
+    return pStage;
+}
+
+EngineEffectChain* StagedEffectChain::takeEngineEffectChain() {
+    EngineEffectChain* pChain = m_pEngineEffectChain;
+    m_pEngineEffectChain = nullptr;
+    return pChain;
+}
+
+EngineEffect* StagedEffectChain::takeEngineEffect(int iIndex,
+                                                  EffectPointer pEffect) {
+    VERIFY_OR_DEBUG_ASSERT(iIndex >= 0) {
+        return nullptr;
+    }
+    if (iIndex >= m_effects.size() || m_effects[iIndex].pEffect != pEffect) {
+        return nullptr;
+    }
+    EngineEffect* pEngineEffect = m_effects[iIndex].pEngineEffect;
+    m_effects[iIndex].pEngineEffect = nullptr;
+    return pEngineEffect;
+}
@@ -0,0 +1,80 @@
+#ifndef STAGEDEFFECTCHAIN_H
+#define STAGEDEFFECTCHAIN_H
+
+#include <QList>
+#include <QSet>
+#include <QString>
+
+#include "effects/effect.h"
+#include "effects/effectchain.h"
+#include "effects/effectinstantiator.h"
+#include "effects/effectmanifest.h"
+#include "engine/channelhandle.h"
+#include "util/class.h"
+
+class EffectsManager;
+class EngineEffect;
+class EngineEffectChain;
+
+// The engine side of an EffectChain, built on a worker thread so that loading
+// a chain preset doesn't instantiate the EffectProcessors and allocate their
+// EffectStates on the main thread, see EffectChainSlot::swapEffectChain().
+// The constructor takes a snapshot of the effects and the enabled input
+// channels of the chain on the main thread, build() creates the
+// EngineEffectChain and the EngineEffects from it on a worker thread, and
+// EffectChain::addStagedToEngine() takes them on the main thread again. The
+// engine doesn't know the objects until they have been taken, so they are
+// only used by one thread at a time.
+//
+// The EffectProcessors are created on the worker thread, so their
+// constructors may only use thread-safe parts of Mixxx, like looking up
+// controls with ControlProxy.
+class StagedEffectChain {
+  public:
+    StagedEffectChain(EffectsManager* pEffectsManager,
+                      EffectChainPointer pChain);
+    // Deletes the engine objects that have not been taken.
+    virtual ~StagedEffectChain();
+
+    // Builds the engine objects of pStage. Returns pStage for QFutureWatcher.
+    static StagedEffectChain* build(StagedEffectChain* pStage);
+
+    EffectChainPointer chain() const {
+        return m_pChain;
+    }
+
+    // The input channels that the engine objects have been built for
+    const QSet<ChannelHandleAndGroup>& enabledInputChannels() const {
+        return m_enabledInputChannels;
+    }
+
+    EngineEffectChain* takeEngineEffectChain();
+    // Returns null if pEffect is not the effect that was at iIndex when the
+    // snapshot was taken, e.g. because another effect has been loaded since.
+    EngineEffect* takeEngineEffect(int iIndex, EffectPointer pEffect);
+
+  private:
+    struct StagedEffect {
+        StagedEffect()
+                : pEngineEffect(nullptr) {
+        }
+        EffectPointer pEffect;
+        EffectManifest manifest;
+        EffectInstantiatorPointer pInstantiator;
+        EngineEffect* pEngineEffect;
+    };
+
+    EffectsManager* m_pEffectsManager;
+    EffectChainPointer m_pChain;
+    QString m_id;
+    QSet<ChannelHandleAndGroup> m_enabledInputChannels;
+    QSet<ChannelHandleAndGroup> m_registeredInputChannels;
+    QSet<ChannelHandleAndGroup> m_registeredOutputChannels;
+    // Null effects for empty effect slots
+    QList<StagedEffect> m_effects;
+    EngineEffectChain* m_pEngineEffectChain;
+
+    DISALLOW_COPY_AND_ASSIGN(StagedEffectChain);
+};
+
+#endif /* STAGEDEFFECTCHAIN_H */
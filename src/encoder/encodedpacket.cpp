@@ -0,0 +1,126 @@
+#include "encoder/encodedpacket.h"
+
+#include <cstring>
+
+#include <QMutexLocker>
+
+#include "util/assert.h"
+#include "util/counter.h"
+
+namespace {
+
+// About 10 seconds of MP3 packets of all connections. The packets that are
+// released while the pool is full are deleted.
+const int kMaxFreePackets = 512;
+
+Counter s_allocatedPacketsCounter("EncodedPacketPool allocated packets");
+
+} // anonymous namespace
+
+void EncodedPacket::setSize(int size) {
+    VERIFY_OR_DEBUG_ASSERT(size >= 0 && size <= capacity()) {
+        size = size < 0 ? 0 : capacity();
+    }
+    m_size = size;
+}
+
+EncodedPacketPointer::EncodedPacketPointer(EncodedPacket* pPacket)
+        : m_pPacket(pPacket) {
+    if (m_pPacket) {
+        m_pPacket->m_refCount.ref();
+    }
+}
+
+EncodedPacketPointer::EncodedPacketPointer(const EncodedPacketPointer& other)
+        : EncodedPacketPointer(other.m_pPacket) {
+}
+
+EncodedPacketPointer& EncodedPacketPointer::operator=(
+        const EncodedPacketPointer& other) {
+    if (other.m_pPacket) {
+        other.m_pPacket->m_refCount.ref();
+    }
+    reset();
+    m_pPacket = other.m_pPacket;
+    return *this;
+}
+
+EncodedPacketPointer& EncodedPacketPointer::operator=(
+        EncodedPacketPointer&& other) {
+    if (this != &other) {
+        reset();
+        m_pPacket = other.m_pPacket;
+        other.m_pPacket = nullptr;
+    }
+    return *this;
+}
+
+void EncodedPacketPointer::reset() {
+    if (m_pPacket && !m_pPacket->m_refCount.deref()) {
+        m_pPacket->m_pPool->recycle(m_pPacket);
+    }
+    m_pPacket = nullptr;
+}
+
+EncodedPacketPool::~EncodedPacketPool() {
+    QMutexLocker locker(&m_mutex);
+    qDeleteAll(m_freePackets);
+    m_freePackets.clear();
+}
+
+// static
+EncodedPacketPool* EncodedPacketPool::instance() {
+    static EncodedPacketPool s_pool;
+    return &s_pool;
+}
+
+EncodedPacketPointer EncodedPacketPool::acquire(int capacity) {
+    EncodedPacket* pPacket = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_freePackets.isEmpty()) {
+            // The most recently released packets are most likely large
+            // enough, because the packets of an encoder have similar sizes
+            pPacket = m_freePackets.takeLast();
+        }
+    }
+    if (!pPacket) {
+        pPacket = new EncodedPacket(this);
+        s_allocatedPacketsCounter.increment();
+    }
+    if (pPacket->capacity() < capacity) {
+        pPacket->m_data.resize(capacity);
+    }
+    pPacket->m_size = 0;
+    return EncodedPacketPointer(pPacket);
+}
+
+EncodedPacketPointer EncodedPacketPool::copy(const unsigned char* header,
+        const unsigned char* body, int headerLen, int bodyLen) {
+    headerLen = header ? qMax(headerLen, 0) : 0;
+    bodyLen = body ? qMax(bodyLen, 0) : 0;
+    EncodedPacketPointer pPacket = acquire(headerLen + bodyLen);
+    if (headerLen > 0) {
+        std::memcpy(pPacket->data(), header, headerLen);
+    }
+    if (bodyLen > 0) {
+        std::memcpy(pPacket->data() + headerLen, body, bodyLen);
+    }
+    pPacket->setSize(headerLen + bodyLen);
+    return pPacket;
+}
+
+int EncodedPacketPool::freeCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_freePackets.size();
+}
+
+void EncodedPacketPool::recycle(EncodedPacket* pPacket) {
+    QMutexLocker locker(&m_mutex);
+    if (m_freePackets.size() < kMaxFreePackets) {
+        m_freePackets.append(pPacket);
+        return;
+    }
+    locker.unlock();
+    delete pPacket;
+}
@@ -0,0 +1,135 @@
+#ifndef ENCODER_ENCODEDPACKET_H
+#define ENCODER_ENCODEDPACKET_H
+
+#include <vector>
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVector>
+
+#include "util/class.h"
+
+class EncodedPacketPool;
+
+// A buffer of encoded audio that an encoder passes by reference to its
+// outputs. A packet is returned to the EncodedPacketPool when the last
+// EncodedPacketPointer to it is released, so a long running stream reuses
+// the same few buffers instead of allocating one for every packet.
+//
+// The data must not be changed after the packet has been passed on, because
+// it may be read by several threads.
+class EncodedPacket {
+  public:
+    unsigned char* data() {
+        return m_data.data();
+    }
+    const unsigned char* data() const {
+        return m_data.data();
+    }
+    // The number of valid bytes
+    int size() const {
+        return m_size;
+    }
+    int capacity() const {
+        return static_cast<int>(m_data.size());
+    }
+    // Sets the number of bytes that have been written to data(), at most
+    // the capacity
+    void setSize(int size);
+
+  private:
+    friend class EncodedPacketPointer;
+    friend class EncodedPacketPool;
+
+    explicit EncodedPacket(EncodedPacketPool* pPool)
+            : m_pPool(pPool),
+              m_size(0),
+              m_refCount(0) {
+    }
+
+    EncodedPacketPool* const m_pPool;
+    std::vector<unsigned char> m_data;
+    int m_size;
+    QAtomicInt m_refCount;
+
+    DISALLOW_COPY_AND_ASSIGN(EncodedPacket);
+};
+
+// A reference to an EncodedPacket. Copying it is cheap and thread-safe.
+class EncodedPacketPointer {
+  public:
+    EncodedPacketPointer()
+            : m_pPacket(nullptr) {
+    }
+    EncodedPacketPointer(const EncodedPacketPointer& other);
+    EncodedPacketPointer(EncodedPacketPointer&& other)
+            : m_pPacket(other.m_pPacket) {
+        other.m_pPacket = nullptr;
+    }
+    ~EncodedPacketPointer() {
+        reset();
+    }
+
+    EncodedPacketPointer& operator=(const EncodedPacketPointer& other);
+    EncodedPacketPointer& operator=(EncodedPacketPointer&& other);
+
+    // Releases the reference
+    void reset();
+
+    EncodedPacket* get() const {
+        return m_pPacket;
+    }
+    EncodedPacket* operator->() const {
+        return m_pPacket;
+    }
+    EncodedPacket& operator*() const {
+        return *m_pPacket;
+    }
+    explicit operator bool() const {
+        return m_pPacket != nullptr;
+    }
+
+  private:
+    friend class EncodedPacketPool;
+
+    // Takes a new reference
+    explicit EncodedPacketPointer(EncodedPacket* pPacket);
+
+    EncodedPacket* m_pPacket;
+};
+
+// The packets that are currently not in use. The packets of a pool must be
+// released before it is deleted. instance() is shared by all encoders and
+// lives until the end of the program, so a packet may outlive the encoder
+// that has written it.
+//
+// All functions are thread-safe.
+class EncodedPacketPool {
+  public:
+    EncodedPacketPool() {}
+    ~EncodedPacketPool();
+
+    static EncodedPacketPool* instance();
+
+    // Returns an empty packet with at least the capacity
+    EncodedPacketPointer acquire(int capacity);
+    // Returns a packet with a copy of the concatenated data, for encoders
+    // whose library owns the encoded data
+    EncodedPacketPointer copy(const unsigned char* header,
+            const unsigned char* body, int headerLen, int bodyLen);
+
+    // The number of packets that are kept for reuse
+    int freeCount() const;
+
+  private:
+    friend class EncodedPacketPointer;
+
+    void recycle(EncodedPacket* pPacket);
+
+    mutable QMutex m_mutex;
+    QVector<EncodedPacket*> m_freePackets;
+
+    DISALLOW_COPY_AND_ASSIGN(EncodedPacketPool);
+};
+
+#endif // ENCODER_ENCODEDPACKET_H
@@ -1,11 +1,19 @@
 #ifndef ENCODERCALLBACK_H
 #define ENCODERCALLBACK_H
 
+#include "encoder/encodedpacket.h"
+
 class EncoderCallback {
   public:
     // writes to encoded audio to a stream, e.g., a file stream or broadcast stream
     virtual void write(const unsigned char *header, const unsigned char *body,
                        int headerLen, int bodyLen) = 0;
+    // writes a packet from the EncodedPacketPool. A callback that keeps the
+    // encoded audio, e.g. in a queue, overrides this to keep a reference
+    // instead of a copy.
+    virtual void writePacket(const EncodedPacketPointer& pPacket) {
+        write(nullptr, pPacket->data(), 0, pPacket->size());
+    }
     // gets stream position
     virtual int tell() = 0;
     // sets stream position
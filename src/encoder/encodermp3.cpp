@@ -40,8 +40,6 @@ const int EncoderMp3::MONO_VBR_OFFSET = 4;
 EncoderMp3::EncoderMp3(EncoderCallback* pCallback)
   : m_lameFlags(nullptr),
     m_bitrate(128),
-    m_bufferOut(nullptr),
-    m_bufferOutSize(0),
     /*
      * @ Author: Tobias Rafreider
      * Nobody has initialized the field before my code review.  At runtime the
@@ -257,8 +255,6 @@ EncoderMp3::~EncoderMp3() {
         delete m_bufferIn[0];
     if (m_bufferIn[1] != nullptr)
         delete m_bufferIn[1];
-    if (m_bufferOut != nullptr)
-        delete m_bufferOut;
 }
 
 void EncoderMp3::setEncoderSettings(const EncoderSettings& settings)
@@ -293,22 +289,6 @@ void EncoderMp3::setEncoderSettings(const EncoderSettings& settings)
     }
 }
 
-/*
- * Grow the outBuffer if needed.
- */
-
-int EncoderMp3::bufferOutGrow(int size) {
-    if (m_bufferOutSize >= size)
-        return 0;
-
-    m_bufferOut = (unsigned char *)realloc(m_bufferOut, size);
-    if (m_bufferOut == nullptr)
-        return -1;
-
-    m_bufferOutSize = size;
-    return 0;
-}
-
 /*
  * Grow the inBuffer(s) if needed.
  */
@@ -333,21 +313,28 @@ void EncoderMp3::flush() {
         return;
     int rc = 0;
     /**Flush also writes ID3 tags **/
-    rc = lame_encode_flush(m_lameFlags, m_bufferOut, m_bufferOutSize);
+    // LAME needs 7200 bytes for the remaining frames
+    EncodedPacketPointer pPacket = EncodedPacketPool::instance()->acquire(7200);
+    rc = lame_encode_flush(m_lameFlags, pPacket->data(), pPacket->capacity());
     if (rc < 0) {
         return;
     }
     // end encoded audio to broadcast or file
-    m_pCallback->write(nullptr, m_bufferOut, 0, rc);
-
-    // Write the lame/xing header.
-    rc = lame_get_lametag_frame(m_lameFlags, m_bufferOut, m_bufferOutSize);
-    if (rc != m_bufferOutSize) {
-        bufferOutGrow(rc);
-        rc = lame_get_lametag_frame(m_lameFlags, m_bufferOut, m_bufferOutSize);
+    pPacket->setSize(rc);
+    m_pCallback->writePacket(pPacket);
+
+    // Write the lame/xing header. Without a buffer, LAME returns its size.
+    const int tagSize = static_cast<int>(
+            lame_get_lametag_frame(m_lameFlags, nullptr, 0));
+    EncodedPacketPointer pTag = EncodedPacketPool::instance()->acquire(tagSize);
+    rc = static_cast<int>(lame_get_lametag_frame(
+            m_lameFlags, pTag->data(), pTag->capacity()));
+    if (rc > tagSize) {
+        return;
     }
+    pTag->setSize(rc);
     m_pCallback->seek(0);
-    m_pCallback->write(nullptr, m_bufferOut, 0, rc);
+    m_pCallback->writePacket(pTag);
 }
 
 void EncoderMp3::encodeBuffer(const CSAMPLE *samples, const int size) {
@@ -357,7 +344,9 @@ void EncoderMp3::encodeBuffer(const CSAMPLE *samples, const int size) {
     int rc = 0;
 
     outsize = (int)((1.25 * size + 7200) + 1);
-    bufferOutGrow(outsize);
+    // LAME encodes into a packet from the pool, which is passed on without
+    // a copy. It is returned to the pool when all outputs have written it.
+    EncodedPacketPointer pPacket = EncodedPacketPool::instance()->acquire(outsize);
 
     bufferInGrow(size);
 
@@ -369,20 +358,22 @@ void EncoderMp3::encodeBuffer(const CSAMPLE *samples, const int size) {
     }
 
     rc = lame_encode_buffer_float(m_lameFlags, m_bufferIn[0], m_bufferIn[1],
-                                  size/2, m_bufferOut, m_bufferOutSize);
-    if (rc < 0) {
+                                  size/2, pPacket->data(), pPacket->capacity());
+    if (rc <= 0) {
+        // rc is 0 while LAME buffers the samples for the next frame
         return;
     }
     //write encoded audio to broadcast stream or file
-    m_pCallback->write(nullptr, m_bufferOut, 0, rc);
+    pPacket->setSize(rc);
+    m_pCallback->writePacket(pPacket);
 }
 
 void EncoderMp3::initStream() {
-    m_bufferOutSize = (int)((1.25 * 20000 + 7200) + 1);
-    m_bufferOut = (unsigned char *)malloc(m_bufferOutSize);
-
-    m_bufferIn[0] = (float *)malloc(m_bufferOutSize * sizeof(float));
-    m_bufferIn[1] = (float *)malloc(m_bufferOutSize * sizeof(float));
+    // The size of the former output buffer, so the input buffers only grow
+    // for large buffers of the engine
+    const int bufferSize = (int)((1.25 * 20000 + 7200) + 1);
+    m_bufferIn[0] = (float *)malloc(bufferSize * sizeof(float));
+    m_bufferIn[1] = (float *)malloc(bufferSize * sizeof(float));
     return;
 }
 
@@ -34,7 +34,6 @@ class EncoderMp3 : public Encoder {
 
   private:
     void initStream();
-    int bufferOutGrow(int size);
     int bufferInGrow(int size);
 
     // For lame
@@ -154,8 +153,6 @@ class EncoderMp3 : public Encoder {
     int m_vbr_index;
     vbr_mode m_encoding_mode;
     MPEG_mode_e m_stereo_mode;
-    unsigned char *m_bufferOut;
-    int m_bufferOutSize;
     float *m_bufferIn[2];
     int m_bufferInSize;
 
@@ -0,0 +1,41 @@
+#ifndef BEATSNAPSHOT_H
+#define BEATSNAPSHOT_H
+
+#include "track/beats.h"
+
+// The beats around the play position of a deck in the current callback.
+// EngineBuffer looks them up once per callback before it processes its
+// EngineControls, so the controls that need the beat context of the play
+// position share a single search of the beats instead of each doing their
+// own.
+struct BeatSnapshot {
+    BeatSnapshot()
+            : pBeats(nullptr),
+              position(-1),
+              prevBeat(-1),
+              nextBeat(-1),
+              closestBeat(-1),
+              beatLength(0.0),
+              beatFraction(0.0) {
+    }
+
+    // False if the position is before the first or after the last beat
+    bool hasBeatContext() const {
+        return prevBeat != -1 && nextBeat != -1;
+    }
+
+    // The beats that have been searched, only for telling whether the
+    // snapshot is still up to date. Null if the track has no beats.
+    const Beats* pBeats;
+    double position;
+    // -1 if there is no such beat
+    double prevBeat;
+    double nextBeat;
+    double closestBeat;
+    // The distance between prevBeat and nextBeat, and the fraction of it
+    // that has been played, see BpmControl::getBeatContextNoLookup()
+    double beatLength;
+    double beatFraction;
+};
+
+#endif // BEATSNAPSHOT_H
@@ -389,9 +389,17 @@ double BpmControl::calcSyncedRate(double userTweak) {
     double dThisPosition = getCurrentSample();
     double dBeatLength;
     double my_percentage;
-    if (!BpmControl::getBeatContextNoLookup(dThisPosition,
-                                            m_pPrevBeat->get(), m_pNextBeat->get(),
-                                            &dBeatLength, &my_percentage)) {
+    const BeatSnapshot* pSnapshot = getBeatSnapshot(dThisPosition, m_pBeats);
+    if (pSnapshot) {
+        if (!pSnapshot->hasBeatContext()) {
+            m_resetSyncAdjustment = true;
+            return rate + userTweak;
+        }
+        dBeatLength = pSnapshot->beatLength;
+        my_percentage = pSnapshot->beatFraction;
+    } else if (!BpmControl::getBeatContextNoLookup(dThisPosition,
+                                                   m_pPrevBeat->get(), m_pNextBeat->get(),
+                                                   &dBeatLength, &my_percentage)) {
         m_resetSyncAdjustment = true;
         return rate + userTweak;
     }
@@ -490,6 +498,14 @@ double BpmControl::getBeatDistance(double dThisPosition) const {
     // is used in synccontrol to update the internal clock beat distance, and if
     // we don't adjust the reported distance the track will try to adjust
     // sync against itself.
+    const BeatSnapshot* pSnapshot = getBeatSnapshot(dThisPosition, m_pBeats);
+    if (pSnapshot) {
+        if (!pSnapshot->hasBeatContext()) {
+            return 0.0 - m_dUserOffset;
+        }
+        return pSnapshot->beatFraction - m_dUserOffset;
+    }
+
     double dPrevBeat = m_pPrevBeat->get();
     double dNextBeat = m_pNextBeat->get();
 
@@ -579,7 +595,15 @@ double BpmControl::getNearestPositionInPhase(double dThisPosition, bool respectL
     double dThisPrevBeat = m_pPrevBeat->get();
     double dThisNextBeat = m_pNextBeat->get();
     double dThisBeatLength;
-    if (dThisPosition > dThisNextBeat || dThisPosition < dThisPrevBeat) {
+    const BeatSnapshot* pSnapshot = getBeatSnapshot(dThisPosition, m_pBeats);
+    if (pSnapshot) {
+        if (!pSnapshot->hasBeatContext()) {
+            return dThisPosition;
+        }
+        dThisPrevBeat = pSnapshot->prevBeat;
+        dThisNextBeat = pSnapshot->nextBeat;
+        dThisBeatLength = pSnapshot->beatLength;
+    } else if (dThisPosition > dThisNextBeat || dThisPosition < dThisPrevBeat) {
         // There's a chance the COs might be out of date, so do a lookup.
         // TODO: figure out a way so that quantized control can take care of
         // this so this call isn't necessary.
@@ -616,7 +640,10 @@ double BpmControl::getNearestPositionInPhase(double dThisPosition, bool respectL
         }
 
         TrackPointer otherTrack = pOtherEngineBuffer->getLoadedTrack();
-        BeatsPointer otherBeats = otherTrack ? otherTrack->getBeats() : BeatsPointer();
+        // The other deck may be processed in parallel, so its beats are
+        // taken from the snapshot of its track
+        BeatsPointer otherBeats = otherTrack ?
+                otherTrack->getEngineSnapshot()->pBeats : BeatsPointer();
 
         // If either track does not have beats, then we can't adjust the phase.
         if (!otherBeats) {
@@ -849,9 +876,13 @@ void BpmControl::collectFeatures(GroupFeatureState* pGroupFeatures) const {
     if (getBeatContextNoLookup(dThisPosition,
                        dThisPrevBeat, dThisNextBeat,
                        &dThisBeatLength, &dThisBeatFraction)) {
-        pGroupFeatures->has_beat_length_sec = true;
-        // Note: dThisBeatLength is fractional frames count * 2 (stereo samples)  
-        pGroupFeatures->beat_length_sec = dThisBeatLength / m_pTrack->getSampleRate() / 2 * calcRateRatio();
+        const TrackEngineSnapshot* pTrackSnapshot = getTrackSnapshot();
+        if (pTrackSnapshot && pTrackSnapshot->sampleRate > 0) {
+            pGroupFeatures->has_beat_length_sec = true;
+            // Note: dThisBeatLength is fractional frames count * 2 (stereo samples)
+            pGroupFeatures->beat_length_sec = dThisBeatLength /
+                    pTrackSnapshot->sampleRate / 2 * calcRateRatio();
+        }
 
         pGroupFeatures->has_beat_fraction = true;
         pGroupFeatures->beat_fraction = dThisBeatFraction;
@@ -1,14 +1,17 @@
 #include <QtDebug>
 #include <QFileInfo>
+#include <cstdlib>
 
 #include "engine/cachingreader.h"
 #include "control/controlobject.h"
+#include "mixer/playermanager.h"
 #include "track/track.h"
 #include "util/assert.h"
 #include "util/counter.h"
 #include "util/math.h"
 #include "util/sample.h"
 #include "util/logger.h"
+#include "util/time.h"
 
 
 namespace {
@@ -20,13 +23,118 @@ mixxx::Logger kLogger("CachingReader");
 // TODO() Do we suffer chache misses if we use an audio buffer of above 23 ms?
 const SINT kDefaultHintFrames = 1024;
 
-// currently CachingReaderWorker::kCachingReaderChunkLength is 65536 (0x10000);
+const QString kConfigGroup = QStringLiteral("[CachingReader]");
+
+// currently CachingReaderChunk::kSamples is 16384 (0x4000);
 // For 80 chunks we need 5242880 (0x500000) bytes (5 MiB) of Memory
-//static
-const SINT kNumberOfCachedChunksInMemory = 80;
+const int kDefaultMinChunksDeck = 80;
+// ~110 s at 48 kHz
+const int kDefaultMaxChunksDeck = 640;
+// Samplers mostly play short one-shots
+const int kDefaultMinChunksSampler = 16;
+const int kDefaultMaxChunksSampler = 80;
+// The budget for the chunks borrowed by all readers combined
+const int kDefaultMemoryBudgetMiB = 128;
+
+// The memory ceiling for preloading whole tracks of all players combined
+const int kDefaultMaxPreloadMiBs = 2048;
+
+// The size limit of the cache of decoded tracks on disk that is shared
+// by all players, if enabled with [CachingReader],disk_cache
+const int kDefaultDiskCacheMiBs = 4096;
+
+// The number of chunks that are borrowed at once
+const int kChunksPerAllocation = 4;
+
+// Chunks that have not been read or hinted for this time are given back
+// to the budget when other readers need them.
+const mixxx::Duration kIdleChunkTime = mixxx::Duration::fromSeconds(30);
+
+Counter s_hintHitCounter("CachingReader::hintAndMaybeWake(): Cache hits");
+Counter s_hintMissCounter("CachingReader::hintAndMaybeWake(): Cache misses");
+Counter s_evictionCounter("CachingReader::allocateChunkExpireLRU(): Evicted chunks");
+
+int getConfigValue(const UserSettingsPointer& pConfig,
+        const QString& item, int defaultValue) {
+    if (!pConfig) {
+        return defaultValue;
+    }
+    return math_max(pConfig->getValue(ConfigKey(kConfigGroup, item), defaultValue), 0);
+}
+
+int minChunksForGroup(const QString& group, const UserSettingsPointer& pConfig) {
+    if (PlayerManager::isSamplerGroup(group)) {
+        return math_max(getConfigValue(pConfig,
+                "min_chunks_sampler", kDefaultMinChunksSampler), 1);
+    }
+    return math_max(getConfigValue(pConfig,
+            "min_chunks_deck", kDefaultMinChunksDeck), 1);
+}
+
+int maxChunksForGroup(const QString& group, const UserSettingsPointer& pConfig) {
+    if (PlayerManager::isSamplerGroup(group)) {
+        return math_max(getConfigValue(pConfig,
+                "max_chunks_sampler", kDefaultMaxChunksSampler), 1);
+    }
+    return math_max(getConfigValue(pConfig,
+            "max_chunks_deck", kDefaultMaxChunksDeck), 1);
+}
 
 } // anonymous namespace
 
+// Lock-free accounting of the chunks that the readers borrow in addition
+// to their minimum number of chunks. Shared by all readers.
+class CachingReaderChunkBudget {
+  public:
+    // The budget is only read from the config for the first reader
+    static CachingReaderChunkBudget* instance(const UserSettingsPointer& pConfig) {
+        static CachingReaderChunkBudget s_budget(
+                getConfigValue(pConfig, "memory_budget_mb", kDefaultMemoryBudgetMiB)
+                * (1024 * 1024 / (CachingReaderChunk::kSamples * sizeof(CSAMPLE))));
+        return &s_budget;
+    }
+
+    // Borrows up to count chunks and returns the number of chunks that
+    // have been borrowed. Registers the demand if the budget is exhausted.
+    int acquire(int count) {
+        while (true) {
+            const int available = m_available.loadAcquire();
+            const int acquired = math_min(available, count);
+            if (acquired <= 0) {
+                m_demand.fetchAndStoreRelease(count);
+                return 0;
+            }
+            if (m_available.testAndSetOrdered(available, available - acquired)) {
+                return acquired;
+            }
+        }
+    }
+
+    void release(int count) {
+        m_available.fetchAndAddOrdered(count);
+        int demand = m_demand.loadAcquire();
+        while (demand > 0 &&
+                !m_demand.testAndSetOrdered(demand, math_max(demand - count, 0))) {
+            demand = m_demand.loadAcquire();
+        }
+    }
+
+    // Returns true if a reader is short of chunks and the budget is
+    // exhausted.
+    bool hasDemand() const {
+        return m_demand.loadAcquire() > 0;
+    }
+
+  private:
+    explicit CachingReaderChunkBudget(int chunks)
+            : m_available(chunks),
+              m_demand(0) {
+    }
+
+    QAtomicInt m_available;
+    QAtomicInt m_demand;
+};
+
 
 CachingReader::CachingReader(QString group,
                              UserSettingsPointer config)
@@ -34,16 +142,35 @@ CachingReader::CachingReader(QString group,
           m_chunkReadRequestFIFO(1024),
           m_readerStatusFIFO(1024),
           m_readerStatus(INVALID),
+          m_allocatedChunkFIFO(maxChunksForGroup(group, config)),
+          m_releasedChunkFIFO(maxChunksForGroup(group, config)),
+          m_releasedPreloadFIFO(4),
+          m_pPreload(nullptr),
+          m_pendingChunkAllocations(0),
+          m_playPositionChunkIndex(-1),
+          m_playPositionGeneration(0),
+          m_maxChunks(math_max(maxChunksForGroup(group, config),
+                  minChunksForGroup(group, config))),
+          m_pChunkBudget(CachingReaderChunkBudget::instance(config)),
           m_mruCachingReaderChunk(nullptr),
           m_lruCachingReaderChunk(nullptr),
-          m_sampleBuffer(CachingReaderChunk::kSamples * kNumberOfCachedChunksInMemory),
-          m_worker(group, &m_chunkReadRequestFIFO, &m_readerStatusFIFO) {
-
-    m_allocatedCachingReaderChunks.reserve(kNumberOfCachedChunksInMemory);
+          m_sampleBuffer(CachingReaderChunk::kSamples * minChunksForGroup(group, config)),
+          m_sampleBufferAccount(MemoryAccounting::Category::CachingReaderChunks,
+                  sizeof(CSAMPLE) * m_sampleBuffer.size()),
+          m_readerFramesPerTrackFrame(1.0),
+          m_worker(group, &m_chunkReadRequestFIFO, &m_readerStatusFIFO,
+                  &m_allocatedChunkFIFO, &m_releasedChunkFIFO,
+                  &m_releasedPreloadFIFO) {
+    const int minChunks = minChunksForGroup(group, config);
+    // Reserve enough space upfront so that no memory is allocated when
+    // chunks are added in the engine callback.
+    m_chunks.reserve(m_maxChunks);
+    m_extraChunks.reserve(m_maxChunks - minChunks);
+    m_allocatedCachingReaderChunks.reserve(m_maxChunks);
     // Divide up the allocated raw memory buffer into total_chunks
     // chunks. Initialize each chunk to hold nothing and add it to the free
     // list.
-    for (SINT i = 0; i < kNumberOfCachedChunksInMemory; ++i) {
+    for (SINT i = 0; i < minChunks; ++i) {
         CachingReaderChunkForOwner* c =
                 new CachingReaderChunkForOwner(
                         mixxx::SampleBuffer::WritableSlice(
@@ -54,6 +181,17 @@ CachingReader::CachingReader(QString group,
         m_freeChunks.push_back(c);
     }
 
+    m_worker.setMaxPreloadMiBs(getConfigValue(
+            config, "max_preload_mb", kDefaultMaxPreloadMiBs));
+    // Preview decks only decode the chunks they play instead of decoding
+    // each track that is auditioned into the disk cache
+    if (getConfigValue(config, "disk_cache", 0) > 0 &&
+            !PlayerManager::isPreviewDeckGroup(group)) {
+        m_worker.setDiskCache(config->getSettingsPath() + "/pcmcache",
+                getConfigValue(config, "disk_cache_mb", kDefaultDiskCacheMiBs));
+    }
+    m_worker.setResampleOnLoad(getConfigValue(config, "resample_on_load", 0) > 0);
+
     // Forward signals from worker
     connect(&m_worker, SIGNAL(trackLoading()),
             this, SIGNAL(trackLoading()),
@@ -64,13 +202,30 @@ CachingReader::CachingReader(QString group,
     connect(&m_worker, SIGNAL(trackLoadFailed(TrackPointer, QString)),
             this, SIGNAL(trackLoadFailed(TrackPointer, QString)),
             Qt::DirectConnection);
-
-    m_worker.start(QThread::HighPriority);
 }
 
 CachingReader::~CachingReader() {
     m_worker.quitWait();
+    // Take over the chunks that are in flight to be deleted with all other
+    // chunks below
+    receiveAllocatedChunks();
+    CachingReaderChunkAllocation* pAllocation;
+    while (m_releasedChunkFIFO.read(&pAllocation, 1) == 1) {
+        delete pAllocation;
+    }
+    for (CachingReaderChunkAllocation* pExtraChunk: m_extraChunks) {
+        m_chunks.removeOne(&pExtraChunk->chunk);
+    }
     qDeleteAll(m_chunks);
+    qDeleteAll(m_extraChunks);
+    CachingReaderPreload* pPreload;
+    while (m_releasedPreloadFIFO.read(&pPreload, 1) == 1) {
+        CachingReaderPreload::release(pPreload, nullptr);
+    }
+    if (m_pPreload) {
+        CachingReaderPreload::release(m_pPreload, nullptr);
+    }
+    m_pChunkBudget->release(m_extraChunks.size() + m_pendingChunkAllocations);
 }
 
 void CachingReader::freeChunk(CachingReaderChunkForOwner* pChunk) {
@@ -124,10 +279,14 @@ CachingReaderChunkForOwner* CachingReader::allocateChunk(SINT chunkIndex) {
 CachingReaderChunkForOwner* CachingReader::allocateChunkExpireLRU(SINT chunkIndex) {
     CachingReaderChunkForOwner* pChunk = allocateChunk(chunkIndex);
     if (!pChunk) {
+        // The additional chunks will only arrive in one of the next
+        // callbacks, the LRU chunk has to make room for now.
+        growChunks();
         if (m_lruCachingReaderChunk == nullptr) {
             kLogger.warning() << "ERROR: No LRU chunk to free in allocateChunkExpireLRU.";
             return nullptr;
         }
+        s_evictionCounter++;
         freeChunk(m_lruCachingReaderChunk);
         pChunk = allocateChunk(chunkIndex);
     }
@@ -135,6 +294,68 @@ CachingReaderChunkForOwner* CachingReader::allocateChunkExpireLRU(SINT chunkInde
     return pChunk;
 }
 
+void CachingReader::growChunks() {
+    const int count = math_min(kChunksPerAllocation,
+            m_maxChunks - m_chunks.size() - m_pendingChunkAllocations);
+    if (count <= 0) {
+        return;
+    }
+    const int acquired = m_pChunkBudget->acquire(count);
+    if (acquired > 0) {
+        m_pendingChunkAllocations += acquired;
+        m_worker.allocateChunks(acquired);
+        m_worker.workReady();
+    }
+}
+
+void CachingReader::receiveAllocatedChunks() {
+    CachingReaderChunkAllocation* pAllocation;
+    while (m_allocatedChunkFIFO.read(&pAllocation, 1) == 1) {
+        DEBUG_ASSERT(m_pendingChunkAllocations > 0);
+        --m_pendingChunkAllocations;
+        m_extraChunks.append(pAllocation);
+        m_chunks.append(&pAllocation->chunk);
+        m_freeChunks.push_back(&pAllocation->chunk);
+    }
+}
+
+void CachingReader::releaseIdleChunks() {
+    if (m_extraChunks.isEmpty() || !m_pChunkBudget->hasDemand()) {
+        return;
+    }
+    // Chunks on the free list are idle by definition
+    auto findFreeExtraChunk = [this]() -> CachingReaderChunkAllocation* {
+        for (CachingReaderChunkAllocation* pAllocation: m_extraChunks) {
+            if (pAllocation->chunk.getState() == CachingReaderChunkForOwner::FREE) {
+                return pAllocation;
+            }
+        }
+        return nullptr;
+    };
+    CachingReaderChunkAllocation* pAllocation = findFreeExtraChunk();
+    if (!pAllocation) {
+        if (m_lruCachingReaderChunk == nullptr ||
+                mixxx::Time::elapsed() - m_lruCachingReaderChunk->getLastAccessTime()
+                        < kIdleChunkTime) {
+            return;
+        }
+        freeChunk(m_lruCachingReaderChunk);
+        pAllocation = findFreeExtraChunk();
+        if (!pAllocation) {
+            // All additional chunks are pending
+            return;
+        }
+    }
+    // Only a single chunk per callback
+    m_freeChunks.removeOne(&pAllocation->chunk);
+    m_chunks.removeOne(&pAllocation->chunk);
+    m_extraChunks.removeOne(pAllocation);
+    // The FIFO is large enough for all additional chunks
+    m_releasedChunkFIFO.writeBlocking(&pAllocation, 1);
+    m_pChunkBudget->release(1);
+    m_worker.workReady();
+}
+
 CachingReaderChunkForOwner* CachingReader::lookupChunk(SINT chunkIndex) {
     // Defaults to nullptr if it's not in the hash.
     CachingReaderChunkForOwner* chunk = m_allocatedCachingReaderChunks.value(chunkIndex, nullptr);
@@ -165,6 +386,7 @@ void CachingReader::freshenChunk(CachingReaderChunkForOwner* pChunk) {
     // Insert the chunk as the new most-recently-used item.
     pChunk->insertIntoListBefore(m_mruCachingReaderChunk);
     m_mruCachingReaderChunk = pChunk;
+    pChunk->setLastAccessTime(mixxx::Time::elapsed());
 }
 
 CachingReaderChunkForOwner* CachingReader::lookupChunkAndFreshen(SINT chunkIndex) {
@@ -181,7 +403,18 @@ void CachingReader::newTrack(TrackPointer pTrack) {
     m_worker.workReady();
 }
 
+void CachingReader::releasePreload() {
+    if (m_pPreload) {
+        // Only a single preload per track load can be in flight
+        m_releasedPreloadFIFO.writeBlocking(&m_pPreload, 1);
+        m_pPreload = nullptr;
+        m_worker.workReady();
+    }
+}
+
 void CachingReader::process() {
+    receiveAllocatedChunks();
+
     ReaderStatusUpdate status;
     while (m_readerStatusFIFO.read(&status, 1) == 1) {
         CachingReaderChunkForOwner* pChunk = static_cast<CachingReaderChunkForOwner*>(status.chunk);
@@ -201,12 +434,22 @@ void CachingReader::process() {
         }
         if (status.status == TRACK_NOT_LOADED) {
             m_readerStatus = status.status;
+            m_readerFramesPerTrackFrame = 1.0;
+            releasePreload();
         } else if (status.status == TRACK_LOADED) {
             m_readerStatus = status.status;
+            m_readerFramesPerTrackFrame = status.readerFramesPerTrackFrame;
             // Reset the max. readable frame index
             m_readableFrameIndexRange = status.readableFrameIndexRange;
             // Free all chunks with sample data from a previous track
             freeAllChunks();
+            releasePreload();
+        } else if (status.status == TRACK_PRELOADED) {
+            DEBUG_ASSERT(!m_pPreload);
+            m_pPreload = status.preload;
+            // The chunks are not needed anymore and can be given back to
+            // the budget
+            freeAllChunks();
         }
         if (m_readerStatus == TRACK_LOADED) {
             // Adjust the readable frame index range after loading or reading
@@ -301,7 +544,26 @@ SINT CachingReader::read(SINT startSample, SINT numSamples, bool reverse, CSAMPL
         // buffer. The buffer will be filled with silence for every
         // unreadable sample or samples outside of the track region
         // later at the end of this function.
-        if (!remainingFrameIndexRange.empty()) {
+        if (m_pPreload && !remainingFrameIndexRange.empty()) {
+            // The whole track is in memory, cache misses are impossible
+            const mixxx::IndexRange bufferedFrameIndexRange = reverse ?
+                    m_pPreload->readBufferedSampleFramesReverse(
+                            &buffer[samplesRemaining],
+                            remainingFrameIndexRange) :
+                    m_pPreload->readBufferedSampleFrames(
+                            buffer,
+                            remainingFrameIndexRange);
+            // The preload starts with the first readable frame
+            DEBUG_ASSERT(bufferedFrameIndexRange.empty() ||
+                    bufferedFrameIndexRange.start() == remainingFrameIndexRange.start());
+            const SINT bufferedSamples =
+                    CachingReaderChunk::frames2samples(bufferedFrameIndexRange.length());
+            if (!reverse) {
+                buffer += bufferedSamples;
+            }
+            DEBUG_ASSERT(samplesRemaining >= bufferedSamples);
+            samplesRemaining -= bufferedSamples;
+        } else if (!remainingFrameIndexRange.empty()) {
             // The intersection between the readable samples from the track
             // and the requested samples is not empty, so start reading.
             DEBUG_ASSERT(!intersect(remainingFrameIndexRange, m_readableFrameIndexRange).empty());
@@ -416,17 +678,60 @@ SINT CachingReader::read(SINT startSample, SINT numSamples, bool reverse, CSAMPL
     return numSamples;
 }
 
+void CachingReader::updatePlayPositionGeneration(const HintVector& hintList) {
+    for (const auto& hint: hintList) {
+        if (hint.priority != Hint::kPriorityPlayPosition) {
+            continue;
+        }
+        const SINT chunkIndex = CachingReaderChunk::indexForFrame(math_max(
+                static_cast<SINT>(hint.frame * m_readerFramesPerTrackFrame),
+                SINT(0)));
+        // Moving on to the next chunk while playing is not a jump
+        if (m_playPositionChunkIndex >= 0 &&
+                std::abs(chunkIndex - m_playPositionChunkIndex) > 1) {
+            ++m_playPositionGeneration;
+            m_worker.setPlayPositionGeneration(m_playPositionGeneration);
+        }
+        m_playPositionChunkIndex = chunkIndex;
+        return;
+    }
+}
+
 void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
-    // If no file is loaded, skip.
-    if (m_readerStatus != TRACK_LOADED) {
+    // Give chunks back first, the hints below will touch the chunks
+    // that are still needed.
+    releaseIdleChunks();
+
+    // If no file is loaded or the whole track is in memory, skip.
+    if (m_readerStatus != TRACK_LOADED || m_pPreload) {
         return;
     }
 
     // For every chunk that the hints indicated, check if it is in the cache. If
     // any are not, then wake.
     bool shouldWake = false;
+    int hits = 0;
+    int misses = 0;
 
+    updatePlayPositionGeneration(hintList);
+
+    // Process the hints with the lowest priority first. The chunks with the
+    // highest priority then end up as the most recently used ones and will
+    // be the last to be evicted. The worker reorders the read requests by
+    // priority anyway.
+    QVarLengthArray<const Hint*, 512> sortedHints;
     for (const auto& hint: hintList) {
+        int i = sortedHints.size();
+        sortedHints.append(&hint);
+        while (i > 0 && sortedHints[i - 1]->priority < hint.priority) {
+            sortedHints[i] = sortedHints[i - 1];
+            --i;
+        }
+        sortedHints[i] = &hint;
+    }
+
+    for (const Hint* pHint: sortedHints) {
+        const Hint& hint = *pHint;
         SINT hintFrame = hint.frame;
         SINT hintFrameCount = hint.frameCount;
 
@@ -447,6 +752,15 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
             continue;
         }
 
+        if (m_readerFramesPerTrackFrame != 1.0) {
+            // All frames of the converted track around the hinted frames
+            const SINT hintFrameEnd = static_cast<SINT>(
+                    ceil((hintFrame + hintFrameCount) * m_readerFramesPerTrackFrame));
+            hintFrame = static_cast<SINT>(
+                    floor(hintFrame * m_readerFramesPerTrackFrame));
+            hintFrameCount = hintFrameEnd - hintFrame;
+        }
+
         const auto readableFrameIndexRange = intersect(
                 m_readableFrameIndexRange,
                 mixxx::IndexRange::forward(hintFrame, hintFrameCount));
@@ -460,6 +774,7 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
             CachingReaderChunkForOwner* pChunk = lookupChunk(chunkIndex);
             if (pChunk == nullptr) {
                 shouldWake = true;
+                ++misses;
                 pChunk = allocateChunkExpireLRU(chunkIndex);
                 if (pChunk == nullptr) {
                     kLogger.warning() << "ERROR: Couldn't allocate spare CachingReaderChunk to make CachingReaderChunkReadRequest.";
@@ -467,7 +782,8 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
                 }
                 // Do not insert the allocated chunk into the MRU/LRU list,
                 // because it will be handed over to the worker immediately
-                CachingReaderChunkReadRequest request(pChunk);
+                CachingReaderChunkReadRequest request(
+                        pChunk, hint.priority, m_playPositionGeneration);
                 pChunk->giveToWorker();
                 // kLogger.debug() << "Requesting read of chunk" << current << "into" << pChunk;
                 // kLogger.debug() << "Requesting read into " << request.chunk->data;
@@ -483,10 +799,18 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
                 // This will cause the chunk to be 'freshened' in the cache. The
                 // chunk will be moved to the end of the LRU list.
                 freshenChunk(pChunk);
+                ++hits;
             }
         }
     }
 
+    if (hits > 0) {
+        s_hintHitCounter += hits;
+    }
+    if (misses > 0) {
+        s_hintMissCounter += misses;
+    }
+
     // If there are chunks to be read, wake up.
     if (shouldWake) {
         m_worker.workReady();
@@ -18,6 +18,8 @@
 #include "util/fifo.h"
 #include "engine/cachingreaderworker.h"
 
+class CachingReaderChunkBudget;
+
 // A Hint is an indication to the CachingReader that a certain section of a
 // SoundSource will be used 'soon' and so it should be brought into memory by
 // the reader work thread.
@@ -27,17 +29,27 @@ typedef struct Hint {
     // If a range of frames should be present, use frameCount to indicate that the
     // range (frame, frame + frameCount) should be present in memory.
     SINT frameCount;
-    // Currently unused -- but in the future could be used to prioritize certain
-    // hints over others. A priority of 1 is the highest priority and should be
-    // used for samples that will be read imminently. Hints for samples that
-    // have the potential to be read (i.e. a cue point) should be issued with
-    // priority >10.
+    // Chunks are read in the order of their priority. A priority of 1 is the
+    // highest priority and should be used for samples that will be read
+    // imminently. Hints for samples that have the potential to be read
+    // (i.e. a cue point) should be issued with priority >= 10. Pending
+    // reads with a lower priority than loops are dropped when the play
+    // position jumps.
     int priority;
 
     // for the default frame count in forward direction
     static constexpr SINT kFrameCountForward = 0;
     static constexpr SINT kFrameCountBackward = -1;
 
+    // The samples around the play position
+    static constexpr int kPriorityPlayPosition = 1;
+    // The loop in and out points of an enabled loop
+    static constexpr int kPriorityLoop = 2;
+    // Cue points, hotcues and the loop in point of a disabled loop
+    static constexpr int kPriorityCue = 10;
+    // Samples that will be needed later, if the play position keeps moving
+    static constexpr int kPriorityBackground = 20;
+
 } Hint;
 
 // Note that we use a QVarLengthArray here instead of a QVector. Since this list
@@ -71,6 +83,30 @@ typedef QVarLengthArray<Hint, 512> HintVector;
 // least-recently-used list. When a chunk needs to be allocated and there are no
 // free chunks then the least recently used chunk is free'd (see
 // allocateChunkExpireLRU).
+//
+// Each reader owns a minimum number of chunks. On demand it borrows
+// additional chunks up to a maximum from a memory budget that is shared by
+// all readers. When the budget is exhausted, readers with chunks that have
+// not been accessed for a while give them back, so that the memory moves
+// to the readers that need it (see growChunks and releaseIdleChunks). The
+// minimum and maximum numbers of chunks for decks and samplers and the
+// size of the budget are read from the [CachingReader] config group.
+//
+// Players with [group],preload enabled decode the whole track into memory
+// after it has been loaded (see CachingReaderPreload). Once that is
+// finished, reading is a plain copy and hints are ignored. Players that
+// load the same file share a single preload, so e.g. a sampler bank that
+// uses the same one-shot in several slots decodes and stores it once.
+//
+// With [CachingReader],disk_cache enabled the worker also stores decoded
+// tracks on disk and reads them from there the next time they are loaded
+// (see CachingReaderDiskCache).
+//
+// With [CachingReader],resample_on_load enabled the worker converts tracks
+// with a different sample rate than the engine while decoding them, with
+// a filter that is too expensive for the engine callback (see
+// AudioSourceResampler). The scaler then only has to apply the tempo and
+// pitch changes.
 class CachingReader : public QObject {
     Q_OBJECT
 
@@ -98,6 +134,14 @@ class CachingReader : public QObject {
     // for this to take effect.
     virtual void newTrack(TrackPointer pTrack);
 
+    // The frames that read() returns per frame of the track. Differs from
+    // 1 if the track has been converted to the sample rate of the engine
+    // while loading, then the samples of read() are at the converted
+    // positions. Hints are always given in frames of the track.
+    double readerFramesPerTrackFrame() const {
+        return m_readerFramesPerTrackFrame;
+    }
+
     void setScheduler(EngineWorkerScheduler* pScheduler) {
         m_worker.setScheduler(pScheduler);
     }
@@ -140,11 +184,55 @@ class CachingReader : public QObject {
     // Gets a chunk from the free list, frees the LRU CachingReaderChunk if none available.
     CachingReaderChunkForOwner* allocateChunkExpireLRU(SINT chunkIndex);
 
+    // Borrows additional chunks from the budget and requests the worker
+    // to allocate them, unless the maximum has been reached.
+    void growChunks();
+
+    // Takes over the chunks that the worker has allocated
+    void receiveAllocatedChunks();
+
+    // Gives idle chunks back to the budget if other readers are short
+    // of chunks.
+    void releaseIdleChunks();
+
+    // Passes the preload back to the worker to free its memory
+    void releasePreload();
+
+    // Starts a new play position generation if the play position has
+    // jumped, which makes pending low priority requests stale.
+    void updatePlayPositionGeneration(const HintVector& hintList);
+
     ReaderStatus m_readerStatus;
 
     // Keeps track of all CachingReaderChunks we've allocated.
     QVector<CachingReaderChunkForOwner*> m_chunks;
 
+    // The additional chunks that have been borrowed from the budget. They
+    // are included in m_chunks.
+    QVector<CachingReaderChunkAllocation*> m_extraChunks;
+
+    // Thread-safe FIFOs for passing the additional chunks between the
+    // engine callback and the reader thread, which allocates and deletes
+    // them.
+    FIFO<CachingReaderChunkAllocation*> m_allocatedChunkFIFO;
+    FIFO<CachingReaderChunkAllocation*> m_releasedChunkFIFO;
+    FIFO<CachingReaderPreload*> m_releasedPreloadFIFO;
+
+    // The whole decoded track if the player preloads tracks and preloading
+    // has finished, nullptr otherwise. Replaces the chunks while set.
+    CachingReaderPreload* m_pPreload;
+
+    // The number of chunks that have been requested from the worker, but
+    // have not been received yet.
+    int m_pendingChunkAllocations;
+
+    // The chunk of the last play position hint and the current generation
+    SINT m_playPositionChunkIndex;
+    int m_playPositionGeneration;
+
+    const int m_maxChunks;
+    CachingReaderChunkBudget* const m_pChunkBudget;
+
     // List of free chunks. Linked list so that we have constant time insertions
     // and deletions. Iteration is not necessary.
     QLinkedList<CachingReaderChunkForOwner*> m_freeChunks;
@@ -159,10 +247,13 @@ class CachingReader : public QObject {
 
     // The raw memory buffer which is divided up into chunks.
     mixxx::SampleBuffer m_sampleBuffer;
+    MemoryAccount m_sampleBufferAccount;
 
     // The readable frame index range as reported by the worker.
     mixxx::IndexRange m_readableFrameIndexRange;
 
+    double m_readerFramesPerTrackFrame;
+
     CachingReaderWorker m_worker;
 };
 
@@ -2,6 +2,7 @@
 #define ENGINE_CACHINGREADERCHUNK_H
 
 #include "sources/audiosource.h"
+#include "util/duration.h"
 
 // A Chunk is a memory-resident section of audio that has been cached.
 // Each chunk holds a fixed number kFrames of frames with samples for
@@ -116,6 +117,15 @@ public:
         m_state = READY;
     }
 
+    // The time when the chunk has been read or hinted for the last time.
+    // Maintained by the cache to detect idle chunks.
+    mixxx::Duration getLastAccessTime() const {
+        return m_lastAccessTime;
+    }
+    void setLastAccessTime(mixxx::Duration lastAccessTime) {
+        m_lastAccessTime = lastAccessTime;
+    }
+
     // Inserts a chunk into the double-linked list before the
     // given chunk. If the list is currently empty simply pass
     // pBefore = nullptr. Please note that if pBefore points to
@@ -133,6 +143,8 @@ public:
 private:
     State m_state;
 
+    mixxx::Duration m_lastAccessTime;
+
     CachingReaderChunkForOwner* m_pPrev; // previous item in double-linked list
     CachingReaderChunkForOwner* m_pNext; // next item in double-linked list
 };
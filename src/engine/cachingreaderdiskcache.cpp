@@ -0,0 +1,292 @@
+#include "engine/cachingreaderdiskcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QtDebug>
+
+#include <cstring>
+
+#include "engine/cachingreaderchunk.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/sample.h"
+#include "util/version.h"
+
+namespace {
+
+mixxx::Logger kLogger("CachingReaderDiskCache");
+
+// Must be changed whenever the layout of the cache files changes
+const char kMagic[8] = { 'M', 'X', 'X', 'P', 'C', 'M', '0', '1' };
+
+const QString kFileSuffix = QStringLiteral(".pcm");
+
+// The file starts with this header followed by the interleaved samples
+// in native byte order.
+struct Header {
+    char magic[8];
+    quint32 channelCount;
+    quint32 sampleRate;
+    quint32 bitrate;
+    quint32 reserved;
+    qint64 frameIndexStart;
+    qint64 frameIndexEnd;
+};
+
+static_assert(sizeof(Header) % sizeof(CSAMPLE) == 0,
+        "The samples following the header must be aligned");
+
+// Reads the samples of a cache entry from a memory mapped file
+class AudioSourceDiskCache : public mixxx::AudioSource {
+  public:
+    explicit AudioSourceDiskCache(const QString& filePath)
+            : AudioSource(QUrl::fromLocalFile(filePath)),
+              m_file(filePath),
+              m_pMappedFile(nullptr),
+              m_pSamples(nullptr) {
+    }
+
+    ~AudioSourceDiskCache() override {
+        close();
+    }
+
+    void close() override {
+        if (m_pMappedFile) {
+            m_file.unmap(m_pMappedFile);
+            m_pMappedFile = nullptr;
+            m_pSamples = nullptr;
+        }
+        m_file.close();
+    }
+
+  protected:
+    OpenResult tryOpen(
+            OpenMode /*mode*/,
+            const OpenParams& /*params*/) override {
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            kLogger.warning() << "Failed to open" << m_file.fileName();
+            return OpenResult::Failed;
+        }
+        Header header;
+        if (m_file.read(reinterpret_cast<char*>(&header), sizeof(header)) !=
+                sizeof(header) ||
+                std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+                header.channelCount != CachingReaderChunk::kChannels ||
+                header.frameIndexStart > header.frameIndexEnd) {
+            kLogger.warning() << "Invalid cache file" << m_file.fileName();
+            return OpenResult::Failed;
+        }
+        const auto frameIndexRange = mixxx::IndexRange::between(
+                header.frameIndexStart, header.frameIndexEnd);
+        const qint64 sampleBytes = qint64(frameIndexRange.length()) *
+                header.channelCount * sizeof(CSAMPLE);
+        if (m_file.size() != qint64(sizeof(header)) + sampleBytes) {
+            // Incomplete or corrupt
+            kLogger.warning() << "Invalid cache file size" << m_file.fileName();
+            return OpenResult::Failed;
+        }
+        m_pMappedFile = m_file.map(0, m_file.size());
+        if (!m_pMappedFile) {
+            kLogger.warning() << "Failed to map" << m_file.fileName()
+                    << m_file.errorString();
+            return OpenResult::Failed;
+        }
+        m_pSamples = reinterpret_cast<const CSAMPLE*>(
+                m_pMappedFile + sizeof(header));
+
+        setChannelCount(header.channelCount);
+        setSampleRate(header.sampleRate);
+        initFrameIndexRangeOnce(frameIndexRange);
+        initBitrateOnce(header.bitrate);
+        return OpenResult::Succeeded;
+    }
+
+    mixxx::ReadableSampleFrames readSampleFramesClamped(
+            mixxx::WritableSampleFrames writableSampleFrames) override {
+        const auto frameIndexRange = writableSampleFrames.frameIndexRange();
+        const SINT sampleCount = frames2samples(frameIndexRange.length());
+        if (writableSampleFrames.writableLength() < sampleCount) {
+            // Skipping frames, nothing to copy
+            return mixxx::ReadableSampleFrames(frameIndexRange);
+        }
+        SampleUtil::copy(writableSampleFrames.writableData(),
+                m_pSamples + frames2samples(frameIndexRange.start() - frameIndexMin()),
+                sampleCount);
+        return mixxx::ReadableSampleFrames(
+                frameIndexRange,
+                mixxx::SampleBuffer::ReadableSlice(
+                        writableSampleFrames.writableData(),
+                        sampleCount));
+    }
+
+  private:
+    QFile m_file;
+    uchar* m_pMappedFile;
+    const CSAMPLE* m_pSamples;
+};
+
+} // anonymous namespace
+
+CachingReaderDiskCache::CachingReaderDiskCache(
+        const QString& directory, int maxMiBs)
+        : m_directory(directory),
+          m_maxBytes(qint64(maxMiBs) * 1024 * 1024),
+          m_writeBuffer(CachingReaderChunk::kSamples) {
+    if (!m_directory.exists() && !QDir().mkpath(directory)) {
+        kLogger.warning() << "Failed to create" << directory;
+    }
+}
+
+CachingReaderDiskCache::~CachingReaderDiskCache() {
+    cancelWriting();
+}
+
+QString CachingReaderDiskCache::filePathForTrack(
+        const TrackPointer& pTrack) const {
+    const QFileInfo fileInfo(pTrack->getLocation());
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(fileInfo.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(fileInfo.size()));
+    hash.addData(QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+    // The decoders are part of Mixxx, they may produce different results
+    // in another version.
+    hash.addData(Version::version().toUtf8());
+    hash.addData(kMagic, sizeof(kMagic));
+    return m_directory.filePath(
+            QString::fromLatin1(hash.result().toHex()) + kFileSuffix);
+}
+
+mixxx::AudioSourcePointer CachingReaderDiskCache::openAudioSource(
+        const TrackPointer& pTrack) {
+    const QString filePath = filePathForTrack(pTrack);
+    if (!QFile::exists(filePath)) {
+        return mixxx::AudioSourcePointer();
+    }
+    auto pAudioSource = std::make_shared<AudioSourceDiskCache>(filePath);
+    if (pAudioSource->open(mixxx::AudioSource::OpenMode::Strict) !=
+            mixxx::AudioSource::OpenResult::Succeeded) {
+        QFile::remove(filePath);
+        return mixxx::AudioSourcePointer();
+    }
+    // The modification time of the entries keeps track of their last use
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(),
+                QFileDevice::FileModificationTime);
+    }
+#endif
+    kLogger.debug() << "Reading" << pTrack->getLocation() << "from" << filePath;
+    return pAudioSource;
+}
+
+void CachingReaderDiskCache::startWriting(const TrackPointer& pTrack,
+        const mixxx::AudioSourcePointer& pAudioSource,
+        const mixxx::IndexRange& frameIndexRange) {
+    cancelWriting();
+    const qint64 sampleBytes = qint64(frameIndexRange.length()) *
+            CachingReaderChunk::kChannels * sizeof(CSAMPLE);
+    if (frameIndexRange.empty() ||
+            qint64(sizeof(Header)) + sampleBytes > m_maxBytes) {
+        return;
+    }
+
+    m_writeFilePath = filePathForTrack(pTrack);
+    // Other workers may write the same entry at the same time
+    m_pWriteFile = std::make_unique<QTemporaryFile>(
+            m_writeFilePath + QStringLiteral(".XXXXXX"));
+    if (!m_pWriteFile->open()) {
+        kLogger.warning() << "Failed to create a file in" << m_directory.path();
+        cancelWriting();
+        return;
+    }
+
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.channelCount = CachingReaderChunk::kChannels;
+    header.sampleRate = pAudioSource->sampleRate();
+    header.bitrate = pAudioSource->bitrate();
+    header.reserved = 0;
+    header.frameIndexStart = frameIndexRange.start();
+    header.frameIndexEnd = frameIndexRange.end();
+    if (m_pWriteFile->write(reinterpret_cast<const char*>(&header),
+            sizeof(header)) != sizeof(header)) {
+        cancelWriting();
+        return;
+    }
+    m_pWriteAudioSource = pAudioSource;
+    m_remainingFrameIndexRange = frameIndexRange;
+}
+
+bool CachingReaderDiskCache::writeNextSampleFrames(
+        mixxx::SampleBuffer::WritableSlice tempSlice) {
+    if (!m_pWriteAudioSource) {
+        return false;
+    }
+    const auto frameIndexRange = mixxx::IndexRange::forward(
+            m_remainingFrameIndexRange.start(),
+            math_min(m_remainingFrameIndexRange.length(),
+                    CachingReaderChunk::kFrames));
+    mixxx::AudioSourceStereoProxy audioSourceProxy(
+            m_pWriteAudioSource, tempSlice);
+    const auto readableSampleFrames = audioSourceProxy.readSampleFrames(
+            mixxx::WritableSampleFrames(
+                    frameIndexRange,
+                    mixxx::SampleBuffer::WritableSlice(m_writeBuffer)));
+    // Tracks with decoding errors are not cached, the chunks that are
+    // read from the decoder handle them.
+    if (readableSampleFrames.frameIndexRange() != frameIndexRange) {
+        kLogger.warning() << "Not caching" << m_writeFilePath
+                << "after failing to read" << frameIndexRange;
+        cancelWriting();
+        return true;
+    }
+    const qint64 bytes = readableSampleFrames.readableLength() * sizeof(CSAMPLE);
+    if (m_pWriteFile->write(reinterpret_cast<const char*>(
+            readableSampleFrames.readableData()), bytes) != bytes) {
+        kLogger.warning() << "Failed to write" << m_pWriteFile->fileName()
+                << m_pWriteFile->errorString();
+        cancelWriting();
+        return true;
+    }
+    m_remainingFrameIndexRange.shrinkFront(frameIndexRange.length());
+    if (m_remainingFrameIndexRange.empty()) {
+        commitWriting();
+    }
+    return true;
+}
+
+void CachingReaderDiskCache::commitWriting() {
+    m_pWriteFile->setAutoRemove(false);
+    if (!m_pWriteFile->rename(m_writeFilePath)) {
+        // Already written by another worker
+        m_pWriteFile->remove();
+    }
+    cancelWriting();
+    evictLeastRecentlyUsed();
+}
+
+void CachingReaderDiskCache::cancelWriting() {
+    // Removes the temporary file unless it has been committed
+    m_pWriteFile.reset();
+    m_pWriteAudioSource.reset();
+    m_remainingFrameIndexRange = mixxx::IndexRange();
+}
+
+void CachingReaderDiskCache::evictLeastRecentlyUsed() {
+    const QFileInfoList entries = m_directory.entryInfoList(
+            QStringList() << (QStringLiteral("*") + kFileSuffix),
+            QDir::Files, QDir::Time);
+    qint64 bytes = 0;
+    // Sorted by descending modification time
+    for (const QFileInfo& entry : entries) {
+        bytes += entry.size();
+        if (bytes > m_maxBytes) {
+            kLogger.debug() << "Evicting" << entry.filePath();
+            QFile::remove(entry.filePath());
+        }
+    }
+}
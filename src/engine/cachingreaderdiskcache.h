@@ -0,0 +1,70 @@
+#ifndef ENGINE_CACHINGREADERDISKCACHE_H
+#define ENGINE_CACHINGREADERDISKCACHE_H
+
+#include <QDir>
+#include <QString>
+#include <QTemporaryFile>
+
+#include <memory>
+
+#include "sources/audiosource.h"
+#include "track/track.h"
+#include "util/class.h"
+#include "util/indexrange.h"
+#include "util/samplebuffer.h"
+
+// An optional cache of decoded tracks on disk. Once a track has been
+// decoded completely its stereo samples are stored uncompressed, and the
+// next time the track is loaded it is read through a memory mapping
+// instead of the decoder. Entries are identified by the location, size
+// and modification time of the file and the Mixxx version that decoded
+// it. The least recently used entries are deleted when the size of the
+// cache exceeds its limit.
+//
+// Each CachingReaderWorker owns an instance. All instances share the
+// same directory, and all functions are called from the worker thread.
+class CachingReaderDiskCache {
+  public:
+    CachingReaderDiskCache(const QString& directory, int maxMiBs);
+    virtual ~CachingReaderDiskCache();
+
+    // Returns a null pointer if the track has not been cached
+    mixxx::AudioSourcePointer openAudioSource(const TrackPointer& pTrack);
+
+    // Starts caching the given frames of an audio source that has been
+    // opened for the track. Replaces a pending write.
+    void startWriting(const TrackPointer& pTrack,
+            const mixxx::AudioSourcePointer& pAudioSource,
+            const mixxx::IndexRange& frameIndexRange);
+
+    // Decodes and writes the next block of a pending write. The entry
+    // is committed after the last block. tempSlice must hold a block
+    // with all channels of the audio source. Returns false if nothing
+    // is being written.
+    bool writeNextSampleFrames(mixxx::SampleBuffer::WritableSlice tempSlice);
+
+    void cancelWriting();
+
+  private:
+    QString filePathForTrack(const TrackPointer& pTrack) const;
+
+    void commitWriting();
+
+    // Deletes the least recently used entries until the cache fits into
+    // its size limit
+    void evictLeastRecentlyUsed();
+
+    const QDir m_directory;
+    const qint64 m_maxBytes;
+
+    // The pending write
+    mixxx::AudioSourcePointer m_pWriteAudioSource;
+    std::unique_ptr<QTemporaryFile> m_pWriteFile;
+    QString m_writeFilePath;
+    mixxx::IndexRange m_remainingFrameIndexRange;
+    mixxx::SampleBuffer m_writeBuffer;
+
+    DISALLOW_COPY_AND_ASSIGN(CachingReaderDiskCache);
+};
+
+#endif // ENGINE_CACHINGREADERDISKCACHE_H
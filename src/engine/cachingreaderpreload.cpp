@@ -0,0 +1,208 @@
+#include "engine/cachingreaderpreload.h"
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "engine/cachingreaderchunk.h"
+#include "engine/engineworker.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+mixxx::Logger kLogger("CachingReaderPreload");
+
+// The memory of all preloads combined
+QAtomicInt s_preloadedMiBs;
+
+// The shared preloads by location, guarding their reference counts and
+// waiters
+QMutex s_registryMutex;
+QHash<QString, CachingReaderPreload*> s_registry;
+
+int mibsForFrames(SINT frames) {
+    const qint64 kMiB = 1024 * 1024;
+    const qint64 bytes = CachingReaderChunk::frames2samples(frames) * sizeof(CSAMPLE);
+    return static_cast<int>((bytes + kMiB - 1) / kMiB);
+}
+
+} // anonymous namespace
+
+// static
+CachingReaderPreload* CachingReaderPreload::acquire(
+        const QString& location,
+        const mixxx::IndexRange& frameIndexRange,
+        int maxMiBs,
+        EngineWorker* pWaiter,
+        bool* pFill) {
+    *pFill = false;
+    QMutexLocker locker(&s_registryMutex);
+    CachingReaderPreload* pShared = s_registry.value(location);
+    if (pShared && pShared->m_frameIndexRange == frameIndexRange) {
+        ++pShared->m_refCount;
+        if (pWaiter && pShared->state() == State::Filling) {
+            pShared->m_waiters.append(pWaiter);
+        }
+        kLogger.debug() << "Sharing preload of" << location;
+        return pShared;
+    }
+
+    const int mibs = mibsForFrames(frameIndexRange.length());
+    while (true) {
+        const int preloadedMiBs = s_preloadedMiBs.loadAcquire();
+        if (preloadedMiBs + mibs > maxMiBs) {
+            kLogger.warning()
+                    << "Not preloading" << mibs << "MiB, already"
+                    << preloadedMiBs << "of" << maxMiBs << "MiB preloaded";
+            return nullptr;
+        }
+        if (s_preloadedMiBs.testAndSetOrdered(preloadedMiBs, preloadedMiBs + mibs)) {
+            break;
+        }
+    }
+    // A preload of the same file with a different range stays unshared
+    const QString sharedLocation = pShared ? QString() : location;
+    auto pPreload = new CachingReaderPreload(sharedLocation, frameIndexRange, mibs);
+    if (!sharedLocation.isEmpty()) {
+        s_registry.insert(sharedLocation, pPreload);
+    }
+    *pFill = true;
+    return pPreload;
+}
+
+// static
+void CachingReaderPreload::release(CachingReaderPreload* pPreload,
+        EngineWorker* pWaiter) {
+    {
+        QMutexLocker locker(&s_registryMutex);
+        pPreload->m_waiters.removeAll(pWaiter);
+        if (--pPreload->m_refCount > 0) {
+            return;
+        }
+        if (!pPreload->m_location.isEmpty() &&
+                s_registry.value(pPreload->m_location) == pPreload) {
+            s_registry.remove(pPreload->m_location);
+        }
+    }
+    delete pPreload;
+}
+
+void CachingReaderPreload::finish() {
+    DEBUG_ASSERT(isComplete());
+    QMutexLocker locker(&s_registryMutex);
+    setStateAndWakeWaiters(State::Complete);
+}
+
+void CachingReaderPreload::abandon() {
+    QMutexLocker locker(&s_registryMutex);
+    // Let the next player that loads the file start over
+    if (!m_location.isEmpty() && s_registry.value(m_location) == this) {
+        s_registry.remove(m_location);
+    }
+    setStateAndWakeWaiters(State::Abandoned);
+}
+
+void CachingReaderPreload::setStateAndWakeWaiters(State state) {
+    m_state.storeRelease(static_cast<int>(state));
+    for (EngineWorker* pWaiter : m_waiters) {
+        pWaiter->wake();
+    }
+    m_waiters.clear();
+}
+
+CachingReaderPreload::CachingReaderPreload(
+        const QString& location,
+        const mixxx::IndexRange& frameIndexRange, int mibs)
+        : m_location(location),
+          m_frameIndexRange(frameIndexRange),
+          m_bufferedFrameIndexRange(mixxx::IndexRange::forward(frameIndexRange.start(), 0)),
+          m_mibs(mibs),
+          m_sampleBuffer(CachingReaderChunk::frames2samples(frameIndexRange.length())),
+          m_memoryAccount(MemoryAccounting::Category::CachingReaderPreloads,
+                  sizeof(CSAMPLE) * m_sampleBuffer.size()),
+          m_state(static_cast<int>(State::Filling)),
+          m_refCount(1) {
+}
+
+CachingReaderPreload::~CachingReaderPreload() {
+    s_preloadedMiBs.fetchAndAddOrdered(-m_mibs);
+}
+
+bool CachingReaderPreload::bufferNextSampleFrames(
+        const mixxx::AudioSourcePointer& pAudioSource,
+        mixxx::SampleBuffer::WritableSlice tempOutputBuffer,
+        SINT maxFrames) {
+    const auto nextFrameIndexRange = mixxx::IndexRange::forward(
+            m_bufferedFrameIndexRange.end(),
+            math_min(maxFrames, m_frameIndexRange.end() - m_bufferedFrameIndexRange.end()));
+    if (nextFrameIndexRange.empty()) {
+        return true;
+    }
+    mixxx::AudioSourceStereoProxy audioSourceProxy(
+            pAudioSource,
+            tempOutputBuffer);
+    DEBUG_ASSERT(audioSourceProxy.channelCount() == CachingReaderChunk::kChannels);
+    const SINT sampleOffset = CachingReaderChunk::frames2samples(
+            nextFrameIndexRange.start() - m_frameIndexRange.start());
+    const auto readableSampleFrames =
+            audioSourceProxy.readSampleFrames(
+                    mixxx::WritableSampleFrames(
+                            nextFrameIndexRange,
+                            mixxx::SampleBuffer::WritableSlice(
+                                    m_sampleBuffer.data(sampleOffset),
+                                    CachingReaderChunk::frames2samples(
+                                            nextFrameIndexRange.length()))));
+    if (readableSampleFrames.frameIndexRange() != nextFrameIndexRange) {
+        kLogger.warning()
+                << "Failed to preload sample frames:"
+                << "actual =" << readableSampleFrames.frameIndexRange()
+                << ", expected =" << nextFrameIndexRange;
+        return false;
+    }
+    m_bufferedFrameIndexRange.growBack(nextFrameIndexRange.length());
+    return true;
+}
+
+mixxx::IndexRange CachingReaderPreload::readBufferedSampleFrames(
+        CSAMPLE* sampleBuffer,
+        const mixxx::IndexRange& frameIndexRange) const {
+    const auto copyableFrameIndexRange =
+            intersect(frameIndexRange, m_bufferedFrameIndexRange);
+    if (!copyableFrameIndexRange.empty()) {
+        const SINT dstSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - frameIndexRange.start());
+        const SINT srcSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - m_frameIndexRange.start());
+        const SINT sampleCount = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.length());
+        SampleUtil::copy(
+                sampleBuffer + dstSampleOffset,
+                m_sampleBuffer.data(srcSampleOffset),
+                sampleCount);
+    }
+    return copyableFrameIndexRange;
+}
+
+mixxx::IndexRange CachingReaderPreload::readBufferedSampleFramesReverse(
+        CSAMPLE* reverseSampleBuffer,
+        const mixxx::IndexRange& frameIndexRange) const {
+    const auto copyableFrameIndexRange =
+            intersect(frameIndexRange, m_bufferedFrameIndexRange);
+    if (!copyableFrameIndexRange.empty()) {
+        const SINT dstSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - frameIndexRange.start());
+        const SINT srcSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - m_frameIndexRange.start());
+        const SINT sampleCount = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.length());
+        SampleUtil::copyReverse(
+                reverseSampleBuffer - dstSampleOffset - sampleCount,
+                m_sampleBuffer.data(srcSampleOffset),
+                sampleCount);
+    }
+    return copyableFrameIndexRange;
+}
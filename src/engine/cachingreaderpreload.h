@@ -0,0 +1,125 @@
+#ifndef ENGINE_CACHINGREADERPRELOAD_H
+#define ENGINE_CACHINGREADERPRELOAD_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QString>
+
+#include "sources/audiosource.h"
+#include "util/class.h"
+#include "util/memoryaccounting.h"
+
+class EngineWorker;
+
+// The complete decoded audio data of a track in a single contiguous
+// buffer. The CachingReaderWorker fills it block by block in the
+// background and hands it over to the CachingReader when it is complete.
+// From then on the reader copies the samples directly from memory
+// instead of using chunks.
+//
+// The memory of all preloads combined is limited by a global ceiling.
+//
+// Preloads are shared between all players that load the same file, e.g.
+// samplers that play the same one-shot. The first worker that loads the file
+// fills the preload, the workers of the other players wait until it is
+// complete and pass the same preload to their readers. A preload is
+// reference counted and deleted by the worker that releases the last
+// reference. The sample data is only written by the filling worker and only
+// read after the preload has been completed.
+class CachingReaderPreload {
+  public:
+    enum class State {
+        Filling,
+        Complete,
+        // The filling worker gave up, the preload will never be completed
+        Abandoned,
+    };
+
+    // Returns the preload of the file at location that has been created by
+    // another player for the same frameIndexRange and has not been
+    // abandoned. Otherwise creates a new preload, which the caller has to
+    // fill and which is shared with the other players from then on.
+    // *pFill tells which of both happened. pWaiter is woken up when a
+    // shared preload is completed or abandoned. Returns nullptr if
+    // allocating the buffer for frameIndexRange would exceed the memory
+    // ceiling of maxMiBs for all preloads combined.
+    static CachingReaderPreload* acquire(
+            const QString& location,
+            const mixxx::IndexRange& frameIndexRange,
+            int maxMiBs,
+            EngineWorker* pWaiter,
+            bool* pFill);
+
+    // Drops a reference that has been obtained by acquire(). Deletes the
+    // preload if it was the last one.
+    static void release(CachingReaderPreload* pPreload,
+            EngineWorker* pWaiter);
+
+    State state() const {
+        return static_cast<State>(m_state.loadAcquire());
+    }
+
+    // Called by the filling worker when the preload is complete or if it
+    // fails to fill it. Wakes up the waiting workers.
+    void finish();
+    void abandon();
+
+    // The frames that will be buffered when the preload is complete
+    const mixxx::IndexRange& frameIndexRange() const {
+        return m_frameIndexRange;
+    }
+
+    // The frames that have been buffered so far
+    const mixxx::IndexRange& bufferedFrameIndexRange() const {
+        return m_bufferedFrameIndexRange;
+    }
+
+    // Only for the filling worker, see state() for the others
+    bool isComplete() const {
+        return m_bufferedFrameIndexRange == m_frameIndexRange;
+    }
+
+    // Decodes up to maxFrames of the remaining frames from the audio source.
+    // Returns false if the audio source did not provide the expected
+    // sample data.
+    bool bufferNextSampleFrames(
+            const mixxx::AudioSourcePointer& pAudioSource,
+            mixxx::SampleBuffer::WritableSlice tempOutputBuffer,
+            SINT maxFrames);
+
+    // Same as the corresponding functions of CachingReaderChunk
+    mixxx::IndexRange readBufferedSampleFrames(
+            CSAMPLE* sampleBuffer,
+            const mixxx::IndexRange& frameIndexRange) const;
+    mixxx::IndexRange readBufferedSampleFramesReverse(
+            CSAMPLE* reverseSampleBuffer,
+            const mixxx::IndexRange& frameIndexRange) const;
+
+  private:
+    CachingReaderPreload(const QString& location,
+            const mixxx::IndexRange& frameIndexRange, int mibs);
+    ~CachingReaderPreload();
+
+    // Wakes up and forgets all waiting workers and changes the state.
+    // Must be called with the registry locked.
+    void setStateAndWakeWaiters(State state);
+
+    // Empty if the preload is not shared
+    const QString m_location;
+
+    const mixxx::IndexRange m_frameIndexRange;
+    mixxx::IndexRange m_bufferedFrameIndexRange;
+    // The amount of memory that is accounted for this preload
+    const int m_mibs;
+    mixxx::SampleBuffer m_sampleBuffer;
+    MemoryAccount m_memoryAccount;
+
+    QAtomicInt m_state;
+    // Guarded by the registry lock
+    int m_refCount;
+    QList<EngineWorker*> m_waiters;
+
+    DISALLOW_COPY_AND_ASSIGN(CachingReaderPreload);
+};
+
+#endif // ENGINE_CACHINGREADERPRELOAD_H
@@ -5,31 +5,77 @@
 #include "control/controlobject.h"
 
 #include "engine/cachingreaderworker.h"
+#include "engine/cachingreader.h"
+#include "mixer/playermanager.h"
+#include "sources/audiosourceresampler.h"
 #include "sources/soundsourceproxy.h"
 #include "util/compatibility.h"
 #include "util/event.h"
 #include "util/logger.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
 
 
 namespace {
 
 mixxx::Logger kLogger("CachingReaderWorker");
 
+// The decks play what is read right away, the samplers usually only after
+// some time if at all
+EngineWorker::Priority priorityForGroup(const QString& group) {
+    if (PlayerManager::isDeckGroup(group)) {
+        return EngineWorker::Priority::High;
+    } else if (PlayerManager::isSamplerGroup(group)) {
+        return EngineWorker::Priority::Low;
+    }
+    return EngineWorker::Priority::Normal;
+}
+
+// Prefetching from the file covers the requested chunk and a few seconds
+// after it, which hides the latency of network shares while playing
+const SINT kPrefetchChunks = 16;
+
+// The number of recently prefetched ranges that are not prefetched again,
+// about one for the play position and each hotcue
+const int kPrefetchedFrameIndexRanges = 8;
+
+// The decoders read a bit before the frames they decode. With a variable
+// bitrate the estimated position is off as well.
+const qint64 kMinPrefetchMarginBytes = 256 * 1024;
+
 } // anonymous namespace
 
 CachingReaderWorker::CachingReaderWorker(
         QString group,
         FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
-        FIFO<ReaderStatusUpdate>* pReaderStatusFIFO)
-        : m_group(group),
+        FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
+        FIFO<CachingReaderChunkAllocation*>* pAllocatedChunkFIFO,
+        FIFO<CachingReaderChunkAllocation*>* pReleasedChunkFIFO,
+        FIFO<CachingReaderPreload*>* pReleasedPreloadFIFO)
+        : EngineWorker(priorityForGroup(group)),
+          m_group(group),
           m_tag(QString("CachingReaderWorker %1").arg(m_group)),
           m_pChunkReadRequestFIFO(pChunkReadRequestFIFO),
           m_pReaderStatusFIFO(pReaderStatusFIFO),
-          m_newTrackAvailable(false),
-          m_stop(0) {
+          m_pAllocatedChunkFIFO(pAllocatedChunkFIFO),
+          m_pReleasedChunkFIFO(pReleasedChunkFIFO),
+          m_pReleasedPreloadFIFO(pReleasedPreloadFIFO),
+          m_chunksToAllocate(0),
+          m_playPositionGeneration(0),
+          m_pPreload(nullptr),
+          m_bFillingPreload(false),
+          m_maxPreloadMiBs(0),
+          m_preloadKey(group, "preload"),
+          m_pPreloadProgress(new ControlObject(ConfigKey(group, "preload_progress"))),
+          m_bResampleOnLoad(false),
+          m_prefetchedFrameIndexRanges(kPrefetchedFrameIndexRanges),
+          m_nextPrefetchedFrameIndexRange(0),
+          m_newTrackAvailable(false) {
 }
 
 CachingReaderWorker::~CachingReaderWorker() {
+    cancelPreload();
+    delete m_pPreloadProgress;
 }
 
 ReaderStatusUpdate CachingReaderWorker::processReadRequest(
@@ -47,9 +93,15 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
 
     // Try to read the data required for the chunk from the audio source
     // and adjust the max. readable frame index if decoding errors occur.
+    PerformanceTimer timer;
+    timer.start();
     const mixxx::IndexRange bufferedFrameIndexRange = pChunk->bufferSampleFrames(
             m_pAudioSource,
             mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer));
+    m_prefetcher.reportRead(
+            estimatedByteOffset(bufferedFrameIndexRange.end()) -
+                    estimatedByteOffset(bufferedFrameIndexRange.start()),
+            timer.elapsed());
     ReaderStatus status = bufferedFrameIndexRange.empty() ? CHUNK_READ_EOF : CHUNK_READ_SUCCESS;
     if (chunkFrameIndexRange != bufferedFrameIndexRange) {
         kLogger.warning()
@@ -80,6 +132,166 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
     return ReaderStatusUpdate(status, pChunk, m_readableFrameIndexRange);
 }
 
+void CachingReaderWorker::prefetchChunk(const CachingReaderChunk* pChunk) {
+    if (!m_prefetcher.isOpen()) {
+        return;
+    }
+    const auto chunkFrameIndexRange = intersect(
+            pChunk->frameIndexRange(m_pAudioSource), m_readableFrameIndexRange);
+    if (chunkFrameIndexRange.empty()) {
+        return;
+    }
+    // Prefetched again once the reader has passed the first half of a
+    // range, so sequential playback keeps a few seconds ahead
+    for (const auto& prefetched : m_prefetchedFrameIndexRanges) {
+        if (!prefetched.empty() &&
+                prefetched.start() <= chunkFrameIndexRange.start() &&
+                chunkFrameIndexRange.end() <= prefetched.start() + prefetched.length() / 2) {
+            return;
+        }
+    }
+    const auto frameIndexRange = intersect(
+            mixxx::IndexRange::forward(
+                    chunkFrameIndexRange.start() - CachingReaderChunk::kFrames,
+                    (kPrefetchChunks + 1) * CachingReaderChunk::kFrames),
+            m_readableFrameIndexRange);
+    const qint64 start = estimatedByteOffset(frameIndexRange.start());
+    const qint64 end = estimatedByteOffset(frameIndexRange.end());
+    const qint64 margin = math_max(kMinPrefetchMarginBytes, end - start);
+    m_prefetcher.prefetch(start - margin, end - start + 2 * margin);
+    m_prefetchedFrameIndexRanges[m_nextPrefetchedFrameIndexRange] = frameIndexRange;
+    m_nextPrefetchedFrameIndexRange =
+            (m_nextPrefetchedFrameIndexRange + 1) % m_prefetchedFrameIndexRanges.size();
+}
+
+qint64 CachingReaderWorker::estimatedByteOffset(SINT frameIndex) const {
+    if (!m_prefetcher.isOpen() || m_pAudioSource->frameLength() <= 0) {
+        return 0;
+    }
+    const auto frameIndexRange = m_pAudioSource->frameIndexRange();
+    return qint64(double(m_prefetcher.fileSize()) *
+            (frameIndexRange.clampIndex(frameIndex) - frameIndexRange.start()) /
+            frameIndexRange.length());
+}
+
+bool CachingReaderWorker::takeNextReadRequest(
+        CachingReaderChunkReadRequest* pRequest) {
+    CachingReaderChunkReadRequest request;
+    while (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
+        prefetchChunk(request.chunk);
+        m_readRequests.append(request);
+    }
+    const int generation = m_playPositionGeneration.loadAcquire();
+    while (!m_readRequests.isEmpty()) {
+        // Requests with the same priority are served in the order of
+        // their arrival.
+        int next = 0;
+        for (int i = 1; i < m_readRequests.size(); ++i) {
+            if (m_readRequests[i].priority < m_readRequests[next].priority) {
+                next = i;
+            }
+        }
+        *pRequest = m_readRequests[next];
+        m_readRequests.remove(next);
+        if (pRequest->priority <= Hint::kPriorityLoop ||
+                pRequest->generation == generation) {
+            return true;
+        }
+        // The play position has moved since the request was made. Hand the
+        // chunk back to the cache, it will be requested again if it is
+        // still hinted.
+        const ReaderStatusUpdate update(CHUNK_READ_DISCARDED,
+                pRequest->chunk, m_readableFrameIndexRange);
+        m_pReaderStatusFIFO->writeBlocking(&update, 1);
+    }
+    return false;
+}
+
+bool CachingReaderWorker::processAllocations() {
+    bool processed = false;
+    CachingReaderChunkAllocation* pAllocation;
+    while (m_pReleasedChunkFIFO->read(&pAllocation, 1) == 1) {
+        delete pAllocation;
+        processed = true;
+    }
+    CachingReaderPreload* pPreload;
+    while (m_pReleasedPreloadFIFO->read(&pPreload, 1) == 1) {
+        CachingReaderPreload::release(pPreload, this);
+        processed = true;
+    }
+    // The cache never requests more chunks than fit into the FIFO
+    const int count = m_chunksToAllocate.fetchAndStoreAcquire(0);
+    for (int i = 0; i < count; ++i) {
+        pAllocation = new CachingReaderChunkAllocation();
+        m_pAllocatedChunkFIFO->writeBlocking(&pAllocation, 1);
+        processed = true;
+    }
+    return processed;
+}
+
+bool CachingReaderWorker::preloadNextSampleFrames() {
+    if (!m_pPreload) {
+        return false;
+    }
+    if (m_bFillingPreload) {
+        // Only decode a single chunk at once to not hold up pending read
+        // requests for too long.
+        if (!m_pPreload->bufferNextSampleFrames(m_pAudioSource,
+                mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer),
+                CachingReaderChunk::kFrames)) {
+            cancelPreload();
+            return true;
+        }
+        const auto& frameIndexRange = m_pPreload->frameIndexRange();
+        if (!m_pPreload->isComplete()) {
+            m_pPreloadProgress->set(
+                    double(m_pPreload->bufferedFrameIndexRange().length()) /
+                    frameIndexRange.length());
+            return true;
+        }
+        m_pPreload->finish();
+    } else {
+        switch (m_pPreload->state()) {
+        case CachingReaderPreload::State::Filling:
+            // Woken up when the other worker is done
+            return false;
+        case CachingReaderPreload::State::Abandoned:
+            // Keep reading chunks
+            cancelPreload();
+            return true;
+        case CachingReaderPreload::State::Complete:
+            break;
+        }
+    }
+    ReaderStatusUpdate update(TRACK_PRELOADED, nullptr, m_readableFrameIndexRange);
+    // The reference is passed on to the cache
+    update.preload = m_pPreload;
+    m_pPreload = nullptr;
+    m_pReaderStatusFIFO->writeBlocking(&update, 1);
+    m_pPreloadProgress->set(1.0);
+    return true;
+}
+
+void CachingReaderWorker::cancelPreload() {
+    if (m_pPreload) {
+        if (m_bFillingPreload &&
+                m_pPreload->state() == CachingReaderPreload::State::Filling) {
+            m_pPreload->abandon();
+        }
+        CachingReaderPreload::release(m_pPreload, this);
+        m_pPreload = nullptr;
+    }
+    m_pPreloadProgress->set(0.0);
+}
+
+bool CachingReaderWorker::writeDiskCache() {
+    if (!m_pDiskCache) {
+        return false;
+    }
+    return m_pDiskCache->writeNextSampleFrames(
+            mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer));
+}
+
 // WARNING: Always called from a different thread (GUI)
 void CachingReaderWorker::newTrack(TrackPointer pTrack) {
     QMutexLocker locker(&m_newTrackMutex);
@@ -87,33 +299,35 @@ void CachingReaderWorker::newTrack(TrackPointer pTrack) {
     m_newTrackAvailable = true;
 }
 
-void CachingReaderWorker::run() {
-    unsigned static id = 0; //the id of this thread, for debugging purposes
-    QThread::currentThread()->setObjectName(QString("CachingReaderWorker %1").arg(++id));
-
-    CachingReaderChunkReadRequest request;
-
+bool CachingReaderWorker::runOnce() {
+    const int requests = workRequests();
     Event::start(m_tag);
-    while (!load_atomic(m_stop)) {
-        if (m_newTrackAvailable) {
-            TrackPointer pLoadTrack;
-            { // locking scope
-                QMutexLocker locker(&m_newTrackMutex);
-                pLoadTrack = m_pNewTrack;
-                m_pNewTrack.reset();
-                m_newTrackAvailable = false;
-            } // implicitly unlocks the mutex
-            loadTrack(pLoadTrack);
-        } else if (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
-            // Read the requested chunk and send the result
-            const ReaderStatusUpdate update(processReadRequest(request));
-            m_pReaderStatusFIFO->writeBlocking(&update, 1);
-        } else {
-            Event::end(m_tag);
-            m_semaRun.acquire();
-            Event::start(m_tag);
-        }
+    bool moreWork = true;
+    CachingReaderChunkReadRequest request;
+    if (m_newTrackAvailable) {
+        TrackPointer pLoadTrack;
+        { // locking scope
+            QMutexLocker locker(&m_newTrackMutex);
+            pLoadTrack = m_pNewTrack;
+            m_pNewTrack.reset();
+            m_newTrackAvailable = false;
+        } // implicitly unlocks the mutex
+        loadTrack(pLoadTrack);
+    } else if (takeNextReadRequest(&request)) {
+        // Read the requested chunk and send the result
+        const ReaderStatusUpdate update(processReadRequest(request));
+        m_pReaderStatusFIFO->writeBlocking(&update, 1);
+    } else if (processAllocations()) {
+        // Check for more work
+    } else {
+        // All that the engine has asked for is done, the preload and
+        // the disk cache are done in the background, a block at a time
+        // so that the pool checks the other workers in between.
+        workDone(requests);
+        moreWork = preloadNextSampleFrames() || writeDiskCache();
     }
+    Event::end(m_tag);
+    return moreWork;
 }
 
 namespace {
@@ -132,6 +346,15 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     // Emit that a new track is loading, stops the current track
     emit(trackLoading());
 
+    // A completed preload of the previous track is released by the cache
+    // after it received the new status.
+    cancelPreload();
+    if (m_pDiskCache) {
+        m_pDiskCache->cancelWriting();
+    }
+    m_prefetcher.close();
+    m_prefetchedFrameIndexRanges.fill(mixxx::IndexRange());
+
     ReaderStatusUpdate status;
     status.status = TRACK_NOT_LOADED;
 
@@ -157,7 +380,18 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
 
     mixxx::AudioSource::OpenParams config;
     config.setChannelCount(CachingReaderChunk::kChannels);
-    m_pAudioSource = openAudioSourceForReading(pTrack, config);
+    // Decoding is not needed if the track has been cached on disk before
+    bool cached = false;
+    if (m_pDiskCache) {
+        m_pAudioSource = m_pDiskCache->openAudioSource(pTrack);
+        cached = m_pAudioSource != nullptr;
+    }
+    if (!cached) {
+        m_pAudioSource = openAudioSourceForReading(pTrack, config);
+        if (m_pAudioSource) {
+            m_prefetcher.open(filename);
+        }
+    }
     if (!m_pAudioSource) {
         m_readableFrameIndexRange = mixxx::IndexRange();
         // Must unlock before emitting to avoid deadlock
@@ -169,6 +403,25 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         return;
     }
 
+    // The disk cache and the track keep the sample rate of the file, only
+    // the chunks are converted
+    const mixxx::AudioSourcePointer pDecodedAudioSource = m_pAudioSource;
+    if (m_bResampleOnLoad) {
+        const mixxx::AudioSignal::SampleRate engineSampleRate(
+                static_cast<SINT>(ControlObject::get(
+                        ConfigKey("[Master]", "samplerate"))));
+        if (engineSampleRate.valid() &&
+                engineSampleRate != m_pAudioSource->sampleRate()) {
+            kLogger.debug() << m_group << "Converting" << filename
+                    << "from" << m_pAudioSource->sampleRate()
+                    << "Hz to" << engineSampleRate << "Hz";
+            status.readerFramesPerTrackFrame =
+                    double(engineSampleRate) / double(m_pAudioSource->sampleRate());
+            m_pAudioSource = mixxx::AudioSourceResampler::create(
+                    m_pAudioSource, engineSampleRate);
+        }
+    }
+
     const SINT tempReadBufferSize = m_pAudioSource->frames2samples(CachingReaderChunk::kFrames);
     if (m_tempReadBuffer.size() != tempReadBufferSize) {
         mixxx::SampleBuffer(tempReadBufferSize).swap(m_tempReadBuffer);
@@ -183,24 +436,42 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     status.status = TRACK_LOADED;
     m_pReaderStatusFIFO->writeBlocking(&status, 1);
 
+    // The track is playable from chunks right away, the whole track is
+    // decoded in the background between the read requests.
+    if (ControlObject::get(m_preloadKey) > 0.0 && !m_readableFrameIndexRange.empty()) {
+        // Other players that have loaded the same file share its preload
+        // Players with a different sample rate can not share the preload
+        QString preloadKey = pTrack->getCanonicalLocation();
+        if (m_pAudioSource != pDecodedAudioSource) {
+            preloadKey += QString("@%1").arg(m_pAudioSource->sampleRate());
+        }
+        m_pPreload = CachingReaderPreload::acquire(
+                preloadKey, m_readableFrameIndexRange,
+                m_maxPreloadMiBs, this, &m_bFillingPreload);
+    }
+
+    // Cached in the background after preloading
+    if (m_pDiskCache && !cached) {
+        m_pDiskCache->startWriting(pTrack, pDecodedAudioSource,
+                pDecodedAudioSource->frameIndexRange());
+    }
+
     // Clear the chunks to read list.
     CachingReaderChunkReadRequest request;
     while (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
-        kLogger.debug() << "Cancelling read request for " << request.chunk->getIndex();
+        m_readRequests.append(request);
+    }
+    for (const auto& pendingRequest: m_readRequests) {
+        kLogger.debug() << "Cancelling read request for " << pendingRequest.chunk->getIndex();
         status.status = CHUNK_READ_INVALID;
-        status.chunk = request.chunk;
+        status.chunk = pendingRequest.chunk;
         m_pReaderStatusFIFO->writeBlocking(&status, 1);
     }
+    m_readRequests.clear();
 
     // Emit that the track is loaded.
     const SINT sampleCount =
             CachingReaderChunk::frames2samples(
-                    m_pAudioSource->frameLength());
-    emit(trackLoaded(pTrack, m_pAudioSource->sampleRate(), sampleCount));
-}
-
-void CachingReaderWorker::quitWait() {
-    m_stop = 1;
-    m_semaRun.release();
-    wait();
+                    pDecodedAudioSource->frameLength());
+    emit(trackLoaded(pTrack, pDecodedAudioSource->sampleRate(), sampleCount));
 }
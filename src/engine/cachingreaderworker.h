@@ -3,42 +3,88 @@
 
 #include <QtDebug>
 #include <QMutex>
-#include <QSemaphore>
-#include <QThread>
 #include <QString>
+#include <QVector>
+
+#include <memory>
 
 #include "engine/cachingreaderchunk.h"
+#include "engine/cachingreaderdiskcache.h"
+#include "engine/cachingreaderpreload.h"
 #include "track/track.h"
 #include "engine/engineworker.h"
 #include "sources/audiosource.h"
 #include "util/fifo.h"
+#include "util/fileprefetcher.h"
+#include "util/memoryaccounting.h"
+#include "preferences/configobject.h"
 
 
 typedef struct CachingReaderChunkReadRequest {
     CachingReaderChunk* chunk;
+    // The Hint::priority of the hint that requested the chunk
+    int priority;
+    // The play position generation when the chunk was requested, see
+    // CachingReaderWorker::setPlayPositionGeneration()
+    int generation;
 
     explicit CachingReaderChunkReadRequest(
-            CachingReaderChunk* chunkArg = nullptr)
-        : chunk(chunkArg) {
+            CachingReaderChunk* chunkArg = nullptr,
+            int priorityArg = 0,
+            int generationArg = 0)
+        : chunk(chunkArg),
+          priority(priorityArg),
+          generation(generationArg) {
     }
 } CachingReaderChunkReadRequest;
 
+// A chunk that owns its sample memory. The CachingReader borrows these
+// from the global chunk budget in addition to its minimum number of
+// chunks. They are allocated and deleted by the worker, because the
+// engine thread must not allocate or free memory.
+struct CachingReaderChunkAllocation {
+    CachingReaderChunkAllocation()
+        : sampleBuffer(CachingReaderChunk::kSamples),
+          chunk(mixxx::SampleBuffer::WritableSlice(sampleBuffer)),
+          memoryAccount(MemoryAccounting::Category::CachingReaderChunks,
+                  sizeof(CSAMPLE) * CachingReaderChunk::kSamples) {
+    }
+    mixxx::SampleBuffer sampleBuffer;
+    CachingReaderChunkForOwner chunk;
+    MemoryAccount memoryAccount;
+};
+
+class ControlObject;
+
 enum ReaderStatus {
     INVALID,
     TRACK_NOT_LOADED,
     TRACK_LOADED,
     CHUNK_READ_SUCCESS,
     CHUNK_READ_EOF,
-    CHUNK_READ_INVALID
+    CHUNK_READ_INVALID,
+    // The request became stale before the chunk was read
+    CHUNK_READ_DISCARDED,
+    // The whole track has been decoded into memory
+    TRACK_PRELOADED
 };
 
 typedef struct ReaderStatusUpdate {
     ReaderStatus status;
     CachingReaderChunk* chunk;
     mixxx::IndexRange readableFrameIndexRange;
+    // Only set for TRACK_PRELOADED. The cache takes over the ownership
+    // and passes it back through the released preload FIFO.
+    CachingReaderPreload* preload;
+    // Only set for TRACK_LOADED. The frames of the chunks per frame of the
+    // track, which differs from 1 if the sample rate has been converted
+    // while loading.
+    double readerFramesPerTrackFrame;
     ReaderStatusUpdate()
         : status(INVALID)
-        , chunk(nullptr) {
+        , chunk(nullptr)
+        , preload(nullptr)
+        , readerFramesPerTrackFrame(1.0) {
     }
     ReaderStatusUpdate(
             ReaderStatus statusArg,
@@ -46,7 +92,9 @@ typedef struct ReaderStatusUpdate {
             const mixxx::IndexRange& readableFrameIndexRangeArg)
         : status(statusArg)
         , chunk(chunkArg)
-        , readableFrameIndexRange(readableFrameIndexRangeArg) {
+        , readableFrameIndexRange(readableFrameIndexRangeArg)
+        , preload(nullptr)
+        , readerFramesPerTrackFrame(1.0) {
     }
 } ReaderStatusUpdate;
 
@@ -57,17 +105,54 @@ class CachingReaderWorker : public EngineWorker {
     // Construct a CachingReader with the given group.
     CachingReaderWorker(QString group,
             FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
-            FIFO<ReaderStatusUpdate>* pReaderStatusFIFO);
+            FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
+            FIFO<CachingReaderChunkAllocation*>* pAllocatedChunkFIFO,
+            FIFO<CachingReaderChunkAllocation*>* pReleasedChunkFIFO,
+            FIFO<CachingReaderPreload*>* pReleasedPreloadFIFO);
     virtual ~CachingReaderWorker();
 
     // Request to load a new track. wake() must be called afterwards.
     virtual void newTrack(TrackPointer pTrack);
 
-    // Run upkeep operations like loading tracks and reading from file. Run by a
-    // thread pool via the EngineWorkerScheduler.
-    virtual void run();
+    // Request to allocate additional chunks. The chunks are passed to the
+    // cache through the allocated chunk FIFO. workReady() must be called
+    // afterwards. Called from the engine thread.
+    void allocateChunks(int count) {
+        m_chunksToAllocate.fetchAndAddRelease(count);
+    }
 
-    void quitWait();
+    // The cache starts a new generation whenever the play position jumps.
+    // Pending requests of older generations with a lower priority than
+    // Hint::kPriorityLoop are dropped instead of being read. Called from
+    // the engine thread.
+    void setPlayPositionGeneration(int generation) {
+        m_playPositionGeneration.storeRelease(generation);
+    }
+
+    // The memory ceiling for preloading whole tracks of all players
+    // combined. Must be set before the worker is started.
+    void setMaxPreloadMiBs(int maxPreloadMiBs) {
+        m_maxPreloadMiBs = maxPreloadMiBs;
+    }
+
+    // Enables caching decoded tracks on disk. Must be set before the
+    // worker is started.
+    void setDiskCache(const QString& directory, int maxMiBs) {
+        m_pDiskCache = std::make_unique<CachingReaderDiskCache>(
+                directory, maxMiBs);
+    }
+
+    // Enables converting tracks to the sample rate of the engine while
+    // they are decoded, if their sample rate differs. Must be set before
+    // the worker is started.
+    void setResampleOnLoad(bool resampleOnLoad) {
+        m_bResampleOnLoad = resampleOnLoad;
+    }
+
+    // Runs one upkeep operation like loading a track or reading a chunk from
+    // file. Run by the EngineWorkerPool after the EngineWorkerScheduler has
+    // woken up the worker.
+    bool runOnce() override;
 
   signals:
     // Emitted once a new track is loaded and ready to be read from.
@@ -83,6 +168,39 @@ class CachingReaderWorker : public EngineWorker {
     // reader thread.
     FIFO<CachingReaderChunkReadRequest>* m_pChunkReadRequestFIFO;
     FIFO<ReaderStatusUpdate>* m_pReaderStatusFIFO;
+    FIFO<CachingReaderChunkAllocation*>* m_pAllocatedChunkFIFO;
+    FIFO<CachingReaderChunkAllocation*>* m_pReleasedChunkFIFO;
+    FIFO<CachingReaderPreload*>* m_pReleasedPreloadFIFO;
+
+    QAtomicInt m_chunksToAllocate;
+    QAtomicInt m_playPositionGeneration;
+
+    // The requests that have been taken from the FIFO but have not been
+    // processed yet. Only accessed by the worker thread.
+    QVector<CachingReaderChunkReadRequest> m_readRequests;
+
+    // The preload of the current track until it is complete. It is either
+    // filled by this worker, or shared with another player that fills it.
+    CachingReaderPreload* m_pPreload;
+    bool m_bFillingPreload;
+    int m_maxPreloadMiBs;
+
+    // [group],preload enables preloading whole tracks,
+    // [group],preload_progress shows the progress from 0 to 1.
+    ConfigKey m_preloadKey;
+    ControlObject* m_pPreloadProgress;
+
+    // Optional, null if disabled
+    std::unique_ptr<CachingReaderDiskCache> m_pDiskCache;
+
+    bool m_bResampleOnLoad;
+
+    // Only open while the track is decoded from its file, not while it is
+    // read from the disk cache
+    FilePrefetcher m_prefetcher;
+    // The frames that have been prefetched recently, used as a ring
+    QVector<mixxx::IndexRange> m_prefetchedFrameIndexRanges;
+    int m_nextPrefetchedFrameIndexRange;
 
     // Queue of Tracks to load, and the corresponding lock. Must acquire the
     // lock to touch.
@@ -96,6 +214,36 @@ class CachingReaderWorker : public EngineWorker {
     ReaderStatusUpdate processReadRequest(
             const CachingReaderChunkReadRequest& request);
 
+    // Lets the operating system read the part of the file with the chunk
+    // and the chunks after it in the background, unless that has been
+    // done recently. Called for every request as soon as it arrives, so
+    // the storage is busy while the worker decodes the earlier requests.
+    void prefetchChunk(const CachingReaderChunk* pChunk);
+
+    // The position in the file of a frame, assuming a constant bitrate
+    qint64 estimatedByteOffset(SINT frameIndex) const;
+
+    // Moves all new requests from the FIFO into m_readRequests and takes
+    // the request with the highest priority. Returns false if there are
+    // no requests.
+    bool takeNextReadRequest(CachingReaderChunkReadRequest* pRequest);
+
+    // Allocates the requested chunks and deletes the released chunks and
+    // preloads. Returns true if there was anything to do.
+    bool processAllocations();
+
+    // Decodes the next block of the track if the player preloads whole
+    // tracks, or passes a shared preload to the cache once another worker
+    // has completed it. Returns true if there was anything to do.
+    bool preloadNextSampleFrames();
+
+    // Aborts preloading the current track
+    void cancelPreload();
+
+    // Writes the next block of the current track to the disk cache.
+    // Returns true if there was anything to do.
+    bool writeDiskCache();
+
     // The current audio source of the track loaded
     mixxx::AudioSourcePointer m_pAudioSource;
 
@@ -109,8 +257,6 @@ class CachingReaderWorker : public EngineWorker {
     // This frame index references the frame that follows the
     // last frame with readable sample data.
     mixxx::IndexRange m_readableFrameIndexRange;
-
-    QAtomicInt m_stop;
 };
 
 
@@ -0,0 +1,138 @@
+#include "engine/callbackprofiler.h"
+
+#include "util/counter.h"
+#include "util/math.h"
+#include "util/time.h"
+#include "util/timer.h"
+
+const int CallbackProfiler::kHistogramBuckets;
+const qint64 CallbackProfiler::kHistogramBucketNanos;
+const int CallbackProfiler::kDeadlineMissCount;
+
+CallbackProfiler::CallbackProfiler(bool bEnabled)
+        : m_bEnabled(bEnabled),
+          m_bActive(false),
+          m_stage(OTHER),
+          m_lastSwitchNanos(0),
+          m_deadlineMissCount(0),
+          m_totalStatKey("AudioCallback total"),
+          m_deadlineMissStatKey("AudioCallback deadline misses") {
+    for (int stage = 0; stage < NUM_STAGES; ++stage) {
+        m_stageStatKeys.append(QString("AudioCallback stage %1").arg(
+                stageName(static_cast<Stage>(stage))));
+    }
+}
+
+// static
+QString CallbackProfiler::stageName(Stage stage) {
+    switch (stage) {
+        case OTHER:
+            return "other";
+        case CHANNELS:
+            return "channels";
+        case EFFECTS:
+            return "effects";
+        case CHANNEL_MIXER:
+            return "channel mixer";
+        case HEADPHONE_TALKOVER:
+            return "headphone/talkover";
+        case SIDECHAIN:
+            return "sidechain";
+        case OUTPUT:
+            return "output";
+        default:
+            return "unknown";
+    }
+}
+
+void CallbackProfiler::startCallback() {
+    if (!m_bEnabled) {
+        return;
+    }
+    m_current = DeadlineMiss();
+    m_stage = OTHER;
+    m_lastSwitchNanos = 0;
+    m_timer.start();
+    m_bActive = true;
+}
+
+CallbackProfiler::Stage CallbackProfiler::switchStage(Stage stage) {
+    const Stage previousStage = m_stage;
+    if (!m_bActive) {
+        return previousStage;
+    }
+    const qint64 nowNanos = m_timer.elapsed().toIntegerNanos();
+    m_current.stageNanos[m_stage] += nowNanos - m_lastSwitchNanos;
+    m_lastSwitchNanos = nowNanos;
+    m_stage = stage;
+    return previousStage;
+}
+
+void CallbackProfiler::setSlowestChannel(int channelIndex, qint64 nanos) {
+    if (!m_bActive) {
+        return;
+    }
+    m_current.slowestChannel = channelIndex;
+    m_current.slowestChannelNanos = nanos;
+}
+
+void CallbackProfiler::finishCallback(mixxx::Duration budget) {
+    if (!m_bActive) {
+        return;
+    }
+    switchStage(OTHER);
+    m_bActive = false;
+    m_current.totalNanos = m_lastSwitchNanos;
+    m_current.budgetNanos = budget.toIntegerNanos();
+
+    for (int stage = 0; stage <= NUM_STAGES; ++stage) {
+        const qint64 nanos = stage < NUM_STAGES ?
+                m_current.stageNanos[stage] : m_current.totalNanos;
+        const int bucket = static_cast<int>(math_min(
+                nanos / kHistogramBucketNanos,
+                static_cast<qint64>(kHistogramBuckets - 1)));
+        // There is only one writer, the increment does not need to be
+        // ordered with anything else.
+        m_histograms[stage][bucket].fetchAndAddRelaxed(1);
+        if (stage < NUM_STAGES) {
+            Stat::track(m_stageStatKeys[stage], Stat::DURATION_NANOSEC,
+                        kDefaultComputeFlags, nanos);
+        } else {
+            Stat::track(m_totalStatKey, Stat::DURATION_NANOSEC,
+                        kDefaultComputeFlags, nanos);
+        }
+    }
+
+    if (m_current.totalNanos > m_current.budgetNanos) {
+        m_current.timeNanos = mixxx::Time::elapsed().toIntegerNanos();
+        const int count = m_deadlineMissCount.load();
+        m_deadlineMisses[count % kDeadlineMissCount].setValue(m_current);
+        m_deadlineMissCount.storeRelease(count + 1);
+        Counter deadlineMisses(m_deadlineMissStatKey);
+        deadlineMisses.increment();
+    }
+}
+
+void CallbackProfiler::getDeadlineMisses(
+        QVector<DeadlineMiss>* pMisses) const {
+    pMisses->clear();
+    const int count = m_deadlineMissCount.loadAcquire();
+    for (int i = 0; i < math_min(count, kDeadlineMissCount); ++i) {
+        pMisses->append(m_deadlineMisses[
+                (count - 1 - i) % kDeadlineMissCount].getValue());
+    }
+}
+
+void CallbackProfiler::registerChannel(int channelIndex, const QString& group) {
+    if (m_channelGroups.size() <= channelIndex) {
+        m_channelGroups.resize(channelIndex + 1);
+    }
+    m_channelGroups[channelIndex] = group;
+}
+
+QString CallbackProfiler::channelGroup(int channelIndex) const {
+    if (channelIndex < 0 || channelIndex >= m_channelGroups.size()) {
+        return QString();
+    }
+    return m_channelGroups[channelIndex];
+}
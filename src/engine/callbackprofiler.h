@@ -0,0 +1,162 @@
+#ifndef CALLBACKPROFILER_H
+#define CALLBACKPROFILER_H
+
+#include <QAtomicInt>
+#include <QString>
+#include <QVector>
+
+#include "control/controlvalue.h"
+#include "util/class.h"
+#include "util/compatibility.h"
+#include "util/duration.h"
+#include "util/performancetimer.h"
+
+// Measures how the time of each audio callback is spent among the stages
+// of the engine. The stage times are accumulated into lock-free histograms
+// and reported to the StatsManager, and for the last few callbacks that
+// missed their deadline the full breakdown is kept so that the developer
+// tools can show what was slow.
+//
+// The time of nested stages is only credited to the innermost stage, so the
+// stage times of a callback add up to its total time.
+//
+// Profiling is only done if the profiler is enabled, otherwise all calls
+// from the engine thread return immediately.
+class CallbackProfiler {
+  public:
+    enum Stage {
+        OTHER = 0,
+        CHANNELS,
+        EFFECTS,
+        CHANNEL_MIXER,
+        HEADPHONE_TALKOVER,
+        SIDECHAIN,
+        OUTPUT,
+        NUM_STAGES
+    };
+
+    // The histograms have kHistogramBuckets buckets of kHistogramBucketNanos
+    // each, the last one also counts all longer durations.
+    static const int kHistogramBuckets = 128;
+    static const qint64 kHistogramBucketNanos = 100000;
+    static const int kDeadlineMissCount = 16;
+
+    struct DeadlineMiss {
+        DeadlineMiss()
+                : timeNanos(0),
+                  budgetNanos(0),
+                  totalNanos(0),
+                  slowestChannel(-1),
+                  slowestChannelNanos(0) {
+            for (int i = 0; i < NUM_STAGES; ++i) {
+                stageNanos[i] = 0;
+            }
+        }
+        // The time since startup when the callback finished
+        qint64 timeNanos;
+        qint64 budgetNanos;
+        qint64 totalNanos;
+        qint64 stageNanos[NUM_STAGES];
+        // The index of the channel that took the longest to process as
+        // passed to setSlowestChannel(), or -1
+        int slowestChannel;
+        qint64 slowestChannelNanos;
+    };
+
+    explicit CallbackProfiler(bool bEnabled);
+
+    static QString stageName(Stage stage);
+
+    bool isEnabled() const {
+        return m_bEnabled;
+    }
+
+    // The following functions must only be called from the audio callback.
+
+    // True between startCallback() and finishCallback()
+    bool isActive() const {
+        return m_bActive;
+    }
+
+    void startCallback();
+
+    // Credits the time since the last switch to the current stage and makes
+    // the given stage current. Returns the previous stage.
+    Stage switchStage(Stage stage);
+
+    void setSlowestChannel(int channelIndex, qint64 nanos);
+
+    // Ends the callback that was started by startCallback(). If it took
+    // longer than the budget it is recorded as a deadline miss.
+    void finishCallback(mixxx::Duration budget);
+
+    // The following functions may be called from any thread.
+
+    // Returns the count of callbacks in the given bucket of the histogram
+    // for the stage, or with NUM_STAGES of the total callback time.
+    int histogramCount(int stage, int bucket) const {
+        return load_atomic(m_histograms[stage][bucket]);
+    }
+
+    int deadlineMissCount() const {
+        return m_deadlineMissCount.loadAcquire();
+    }
+
+    // Fills pMisses with the recorded deadline misses, most recent first.
+    void getDeadlineMisses(QVector<DeadlineMiss>* pMisses) const;
+
+    // Channel names are only registered and looked up from the main thread.
+    void registerChannel(int channelIndex, const QString& group);
+    QString channelGroup(int channelIndex) const;
+
+  private:
+    const bool m_bEnabled;
+
+    bool m_bActive;
+    Stage m_stage;
+    PerformanceTimer m_timer;
+    qint64 m_lastSwitchNanos;
+    DeadlineMiss m_current;
+
+    QAtomicInt m_histograms[NUM_STAGES + 1][kHistogramBuckets];
+
+    ControlValueAtomic<DeadlineMiss> m_deadlineMisses[kDeadlineMissCount];
+    QAtomicInt m_deadlineMissCount;
+
+    QVector<QString> m_stageStatKeys;
+    QString m_totalStatKey;
+    QString m_deadlineMissStatKey;
+
+    QVector<QString> m_channelGroups;
+
+    DISALLOW_COPY_AND_ASSIGN(CallbackProfiler);
+};
+
+// Credits the time of the enclosing scope to the given stage of the profiler.
+// Does nothing if pProfiler is null or not in a callback.
+class ScopedCallbackStage {
+  public:
+    ScopedCallbackStage(CallbackProfiler* pProfiler,
+                        CallbackProfiler::Stage stage)
+            : m_pProfiler(pProfiler && pProfiler->isActive() ?
+                          pProfiler : nullptr),
+              m_previousStage(CallbackProfiler::OTHER) {
+        if (m_pProfiler) {
+            m_previousStage = m_pProfiler->switchStage(stage);
+        }
+    }
+
+    ~ScopedCallbackStage() {
+        if (m_pProfiler) {
+            m_pProfiler->switchStage(m_previousStage);
+        }
+    }
+
+  private:
+    CallbackProfiler* const m_pProfiler;
+    CallbackProfiler::Stage m_previousStage;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedCallbackStage);
+};
+
+#endif /* CALLBACKPROFILER_H */
@@ -0,0 +1,247 @@
+#include "engine/channelmixer.h"
+
+#include <array>
+#include <cstddef>
+
+#include "util/sample.h"
+#include "util/timer.h"
+
+namespace {
+
+// A channel buffer that is mixed into the output with a gain ramping
+// linearly from startGain for the first frame by gainDelta per frame,
+// following the same formula as SampleUtil::applyRampingGain(). Buffers
+// that already have their gain applied are mixed with a constant gain
+// of one.
+struct MixSource {
+    const CSAMPLE* pBuffer;
+    CSAMPLE_GAIN startGain;
+    CSAMPLE_GAIN gainDelta;
+};
+
+typedef QVarLengthArray<MixSource, kPreallocatedChannels> MixSources;
+
+// TODO(XXX): Replace with std::index_sequence when we switch to C++14
+template<std::size_t... I>
+struct IndexSequence {};
+
+template<std::size_t N, std::size_t... I>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {};
+
+template<std::size_t... I>
+struct MakeIndexSequence<0, I...> {
+    typedef IndexSequence<I...> type;
+};
+
+inline CSAMPLE sum(CSAMPLE value) {
+    return value;
+}
+
+template<typename... Rest>
+inline CSAMPLE sum(CSAMPLE first, Rest... rest) {
+    return first + sum(rest...);
+}
+
+// Mixes all sources with their ramping gains into pOutput in a single pass.
+// The pack expansions unroll the inner loop over the channels at compile
+// time, so reading and writing each output sample happens only once
+// regardless of the number of channels.
+template<bool accumulate, std::size_t... I>
+inline void mixSources(CSAMPLE* M_RESTRICT pOutput,
+        const MixSource* pSources, int numFrames, IndexSequence<I...>) {
+    const CSAMPLE* pBuffers[] = { pSources[I].pBuffer... };
+    const CSAMPLE_GAIN startGains[] = { pSources[I].startGain... };
+    const CSAMPLE_GAIN gainDeltas[] = { pSources[I].gainDelta... };
+    // note: "int i" like in SampleUtil for vectorizing
+    for (int i = 0; i < numFrames; ++i) {
+        const CSAMPLE left = sum(pBuffers[I][i * 2]
+                * (startGains[I] + gainDeltas[I] * i)...);
+        const CSAMPLE right = sum(pBuffers[I][i * 2 + 1]
+                * (startGains[I] + gainDeltas[I] * i)...);
+        if (accumulate) {
+            pOutput[i * 2] += left;
+            pOutput[i * 2 + 1] += right;
+        } else {
+            pOutput[i * 2] = left;
+            pOutput[i * 2 + 1] = right;
+        }
+    }
+}
+
+typedef void (*MixFunction)(CSAMPLE* pOutput, const MixSource* pSources,
+        int numFrames);
+
+template<bool accumulate, std::size_t N>
+void mixSourcesN(CSAMPLE* pOutput, const MixSource* pSources, int numFrames) {
+    mixSources<accumulate>(pOutput, pSources, numFrames,
+            typename MakeIndexSequence<N>::type());
+}
+
+template<>
+void mixSourcesN<false, 0>(CSAMPLE* pOutput, const MixSource*, int numFrames) {
+    SampleUtil::clear(pOutput, numFrames * 2);
+}
+
+template<>
+void mixSourcesN<true, 0>(CSAMPLE*, const MixSource*, int) {
+}
+
+template<bool accumulate, std::size_t... N>
+std::array<MixFunction, sizeof...(N)> makeMixFunctions(IndexSequence<N...>) {
+    return {{ &mixSourcesN<accumulate, N>... }};
+}
+
+// Mix functions for 0 to kPreallocatedChannels channels
+const std::array<MixFunction, kPreallocatedChannels + 1> kMixFunctions =
+        makeMixFunctions<false>(
+                MakeIndexSequence<kPreallocatedChannels + 1>::type());
+const std::array<MixFunction, kPreallocatedChannels + 1> kAccumulateFunctions =
+        makeMixFunctions<true>(
+                MakeIndexSequence<kPreallocatedChannels + 1>::type());
+
+// Mixes an arbitrary number of sources, the unrolled mix functions are
+// used in chunks of kPreallocatedChannels.
+void mixChannels(CSAMPLE* pOutput, const MixSources& sources,
+        bool accumulate, unsigned int iBufferSize) {
+    const int numFrames = iBufferSize / 2;
+    int mixed = 0;
+    do {
+        const int count = math_min(sources.size() - mixed, kPreallocatedChannels);
+        const auto& functions = accumulate ? kAccumulateFunctions : kMixFunctions;
+        functions[count](pOutput, sources.constData() + mixed, numFrames);
+        mixed += count;
+        accumulate = true;
+    } while (mixed < sources.size());
+}
+
+// Calculates the old and new gain of a channel and updates its gain cache
+void updateGain(const EngineMaster::GainCalculator& gainCalculator,
+        EngineMaster::ChannelInfo* pChannelInfo,
+        EngineMaster::GainCache* pGainCache,
+        CSAMPLE_GAIN* pOldGain, CSAMPLE_GAIN* pNewGain) {
+    *pOldGain = pGainCache->m_gain;
+    if (pGainCache->m_fadeout) {
+        *pNewGain = 0;
+        pGainCache->m_fadeout = false;
+    } else {
+        *pNewGain = gainCalculator.getGain(pChannelInfo);
+    }
+    pGainCache->m_gain = *pNewGain;
+}
+
+MixSource makeMixSource(const CSAMPLE* pBuffer,
+        CSAMPLE_GAIN oldGain, CSAMPLE_GAIN newGain,
+        unsigned int iBufferSize) {
+    MixSource source;
+    source.pBuffer = pBuffer;
+    const int numFrames = iBufferSize / 2;
+    source.gainDelta = numFrames > 0 ?
+            (newGain - oldGain) / CSAMPLE_GAIN(numFrames) : CSAMPLE_GAIN_ZERO;
+    source.startGain = oldGain + source.gainDelta;
+    return source;
+}
+
+} // anonymous namespace
+
+// static
+void ChannelMixer::applyEffectsAndMixChannels(
+        const EngineMaster::GainCalculator& gainCalculator,
+        QVarLengthArray<EngineMaster::ChannelInfo*, kPreallocatedChannels>* activeChannels,
+        QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels>* channelGainCache,
+        CSAMPLE* pOutput, const ChannelHandle& outputHandle,
+        unsigned int iBufferSize,
+        unsigned int iSampleRate,
+        EngineEffectsManager* pEngineEffectsManager) {
+    // Signal flow overview:
+    // 1. Calculate gains for each channel
+    // 2. For channels with active post-fader effects, pass the calculated
+    //    gain and input buffer to pEngineEffectsManager, which then:
+    //     A) Copies the channel input buffer to a temporary buffer
+    //     B) Applies gain to the temporary buffer
+    //     C) Processes effects on the temporary buffer
+    //     D) Mixes the temporary buffer into pOutput
+    // 3. Mix all other channels into pOutput while applying the gain in
+    //    the same pass
+    // The original channel input buffers are not modified.
+    const int totalActive = activeChannels->size();
+    ScopedTimer t("EngineMaster::applyEffectsAndMixChannels_%1active", totalActive);
+    MixSources sources;
+    bool accumulate = false;
+    for (int i = 0; i < totalActive; ++i) {
+        EngineMaster::ChannelInfo* pChannelInfo = activeChannels->at(i);
+        CSAMPLE_GAIN oldGain;
+        CSAMPLE_GAIN newGain;
+        updateGain(gainCalculator, pChannelInfo,
+                &(*channelGainCache)[pChannelInfo->m_index],
+                &oldGain, &newGain);
+        CSAMPLE* pBuffer = pChannelInfo->m_pBuffer;
+        if (pEngineEffectsManager->isPostFaderActive(
+                pChannelInfo->m_handle, outputHandle)) {
+            if (!accumulate) {
+                SampleUtil::clear(pOutput, iBufferSize);
+                accumulate = true;
+            }
+            pEngineEffectsManager->processPostFaderAndMix(
+                    pChannelInfo->m_handle, outputHandle,
+                    pBuffer, pOutput, iBufferSize, iSampleRate,
+                    pChannelInfo->m_features, oldGain, newGain);
+        } else {
+            // No effect will touch the buffer, but the effects still need
+            // to track the enable state for this routing.
+            pEngineEffectsManager->processPostFaderInPlace(
+                    pChannelInfo->m_handle, outputHandle,
+                    pBuffer, iBufferSize, iSampleRate,
+                    pChannelInfo->m_features);
+            sources.append(makeMixSource(pBuffer, oldGain, newGain, iBufferSize));
+        }
+    }
+    mixChannels(pOutput, sources, accumulate, iBufferSize);
+}
+
+// static
+void ChannelMixer::applyEffectsInPlaceAndMixChannels(
+        const EngineMaster::GainCalculator& gainCalculator,
+        QVarLengthArray<EngineMaster::ChannelInfo*, kPreallocatedChannels>* activeChannels,
+        QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels>* channelGainCache,
+        CSAMPLE* pOutput, const ChannelHandle& outputHandle,
+        unsigned int iBufferSize,
+        unsigned int iSampleRate,
+        EngineEffectsManager* pEngineEffectsManager) {
+    // Signal flow overview:
+    // 1. Calculate gains for each channel
+    // 2. For channels with active post-fader effects, pass the calculated
+    //    gain and input buffer to pEngineEffectsManager, which then:
+    //    A) Applies the calculated gain to the channel buffer, modifying the original input buffer
+    //    B) Applies effects to the buffer, modifying the original input buffer
+    // 3. Mix the channel buffers together to make pOutput, overwriting the
+    //    pOutput buffer from the last engine callback. The gain of channels
+    //    without effects is applied in the same pass.
+    const int totalActive = activeChannels->size();
+    ScopedTimer t("EngineMaster::applyEffectsInPlaceAndMixChannels_%1active", totalActive);
+    MixSources sources;
+    for (int i = 0; i < totalActive; ++i) {
+        EngineMaster::ChannelInfo* pChannelInfo = activeChannels->at(i);
+        CSAMPLE_GAIN oldGain;
+        CSAMPLE_GAIN newGain;
+        updateGain(gainCalculator, pChannelInfo,
+                &(*channelGainCache)[pChannelInfo->m_index],
+                &oldGain, &newGain);
+        CSAMPLE* pBuffer = pChannelInfo->m_pBuffer;
+        if (pEngineEffectsManager->isPostFaderActive(
+                pChannelInfo->m_handle, outputHandle)) {
+            pEngineEffectsManager->processPostFaderInPlace(
+                    pChannelInfo->m_handle, outputHandle,
+                    pBuffer, iBufferSize, iSampleRate,
+                    pChannelInfo->m_features, oldGain, newGain);
+            sources.append(makeMixSource(pBuffer,
+                    CSAMPLE_GAIN_ONE, CSAMPLE_GAIN_ONE, iBufferSize));
+        } else {
+            pEngineEffectsManager->processPostFaderInPlace(
+                    pChannelInfo->m_handle, outputHandle,
+                    pBuffer, iBufferSize, iSampleRate,
+                    pChannelInfo->m_features);
+            sources.append(makeMixSource(pBuffer, oldGain, newGain, iBufferSize));
+        }
+    }
+    mixChannels(pOutput, sources, false, iBufferSize);
+}
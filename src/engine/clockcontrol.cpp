@@ -18,32 +18,11 @@ ClockControl::~ClockControl() {
 }
 
 void ClockControl::trackLoaded(TrackPointer pNewTrack, TrackPointer pOldTrack) {
+    Q_UNUSED(pNewTrack);
     Q_UNUSED(pOldTrack);
 
     // Clear on-beat control
     m_pCOBeatActive->set(0.0);
-
-    // Disconnect any previously loaded track/beats
-    if (m_pTrack) {
-        disconnect(m_pTrack.get(), SIGNAL(beatsUpdated()),
-                   this, SLOT(slotBeatsUpdated()));
-    }
-    if (pNewTrack) {
-        m_pTrack = pNewTrack;
-        m_pBeats = m_pTrack->getBeats();
-        connect(m_pTrack.get(), SIGNAL(beatsUpdated()),
-                this, SLOT(slotBeatsUpdated()));
-    } else {
-        m_pBeats.clear();
-        m_pTrack.reset();
-    }
-
-}
-
-void ClockControl::slotBeatsUpdated() {
-    if(m_pTrack) {
-        m_pBeats = m_pTrack->getBeats();
-    }
 }
 
 void ClockControl::process(const double dRate,
@@ -61,8 +40,20 @@ void ClockControl::process(const double dRate,
     // by the rate.
     const double blinkIntervalSamples = 2.0 * samplerate * (1.0 * dRate) * blinkSeconds;
 
+    // The beats are taken from the track snapshot of this callback, so
+    // they never change while they are used
+    const TrackEngineSnapshot* pTrackSnapshot = getTrackSnapshot();
+    const BeatsPointer pBeats = pTrackSnapshot ?
+            pTrackSnapshot->pBeats : BeatsPointer();
+    if (pBeats != m_pBeats) {
+        m_pBeats = pBeats;
+        m_beatCursor = BeatCursor();
+    }
+
     if (m_pBeats) {
-        double closestBeat = m_pBeats->findClosestBeat(currentSample);
+        const BeatSnapshot* pSnapshot = getBeatSnapshot(currentSample, m_pBeats);
+        double closestBeat = pSnapshot ? pSnapshot->closestBeat :
+                m_pBeats->findClosestBeat(currentSample, &m_beatCursor);
         double distanceToClosestBeat = fabs(currentSample - closestBeat);
         m_pCOBeatActive->set(distanceToClosestBeat < blinkIntervalSamples / 2.0);
     }
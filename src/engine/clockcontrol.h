@@ -23,13 +23,14 @@ class ClockControl: public EngineControl {
 
   public slots:
     void trackLoaded(TrackPointer pNewTrack, TrackPointer pOldTrack) override;
-    void slotBeatsUpdated();
 
   private:
     ControlObject* m_pCOBeatActive;
     ControlProxy* m_pCOSampleRate;
-    TrackPointer m_pTrack;
+    // The beats of the track snapshot, only accessed from the engine thread
     BeatsPointer m_pBeats;
+    // Speeds up finding the closest beat in every callback
+    BeatCursor m_beatCursor;
 };
 
 #endif /* CLOCKCONTROL_H */
@@ -10,8 +10,10 @@
 #include "control/controlobject.h"
 #include "control/controlpushbutton.h"
 #include "control/controlindicator.h"
+#include "mixer/playermanager.h"
 #include "vinylcontrol/defs_vinylcontrol.h"
 #include "util/sample.h"
+#include "util/math.h"
 
 // TODO: Convert these doubles to a standard enum
 // and convert elseif logic to switch statements
@@ -33,6 +35,7 @@ CueControl::CueControl(QString group,
         m_iCurrentlyPreviewingHotcues(0),
         m_bypassCueSetByPlay(false),
         m_iNumHotCues(NUM_HOT_CUES),
+        m_bPreviewDeck(PlayerManager::isPreviewDeckGroup(group)),
         m_pLoadedTrack(),
         m_mutex(QMutex::Recursive) {
     // To silence a compiler warning about CUE_MODE_PIONEER.
@@ -51,6 +54,10 @@ CueControl::CueControl(QString group,
 
     m_pCueMode = new ControlObject(ConfigKey(group, "cue_mode"));
 
+    m_pPrefetchPosition = new ControlObject(ConfigKey(group, "prefetch_position"));
+    m_pPrefetchPosition->set(-1.0);
+    m_pPrefetchLength = new ControlObject(ConfigKey(group, "prefetch_length"));
+
     m_pCueSet = new ControlPushButton(ConfigKey(group, "cue_set"));
     m_pCueSet->setButtonMode(ControlPushButton::TRIGGER);
     connect(m_pCueSet, SIGNAL(valueChanged(double)),
@@ -110,6 +117,8 @@ CueControl::CueControl(QString group,
 CueControl::~CueControl() {
     delete m_pCuePoint;
     delete m_pCueMode;
+    delete m_pPrefetchPosition;
+    delete m_pPrefetchLength;
     delete m_pCueSet;
     delete m_pCueGoto;
     delete m_pCueGotoAndPlay;
@@ -199,6 +208,7 @@ void CueControl::trackLoaded(TrackPointer pNewTrack, TrackPointer pOldTrack) {
 
         m_pCueIndicator->setBlinkValue(ControlIndicator::OFF);
         m_pCuePoint->set(-1.0);
+        m_pPrefetchPosition->set(-1.0);
         m_pLoadedTrack.reset();
     }
 
@@ -212,6 +222,7 @@ void CueControl::trackLoaded(TrackPointer pNewTrack, TrackPointer pOldTrack) {
             Qt::DirectConnection);
 
     CuePointer pLoadCue;
+    CuePointer pFirstHotcue;
     for (const CuePointer& pCue: m_pLoadedTrack->getCuePoints()) {
         if (pCue->getType() == Cue::CUE) {
             continue; // skip
@@ -223,6 +234,10 @@ void CueControl::trackLoaded(TrackPointer pNewTrack, TrackPointer pOldTrack) {
         int hotcue = pCue->getHotCue();
         if (hotcue != -1) {
             attachCue(pCue, hotcue);
+            if (pCue->getPosition() >= 0.0 &&
+                    (!pFirstHotcue || hotcue < pFirstHotcue->getHotCue())) {
+                pFirstHotcue = pCue;
+            }
         }
     }
     double cuePoint;
@@ -245,7 +260,11 @@ void CueControl::trackLoaded(TrackPointer pNewTrack, TrackPointer pOldTrack) {
     // point on song load. Note that [Controls],cueRecall == 0 corresponds to "ON", not OFF.
     bool cueRecall = (getConfig()->getValue(
            ConfigKey("[Controls]","CueRecall"), 0) == 0);
-    if (cueRecall && (cuePoint >= 0.0)) {
+    if (m_bPreviewDeck && cuePoint <= 0.0 && pFirstHotcue) {
+        // The intro of a track is rarely what we want to hear when
+        // browsing with the preview deck
+        seekExact(pFirstHotcue->getPosition());
+    } else if (cueRecall && (cuePoint >= 0.0)) {
         seekExact(cuePoint);
     } else if (!(m_pVinylControlEnabled->get() &&
             m_pVinylControlMode->get() == MIXXX_VCMODE_ABSOLUTE)) {
@@ -270,15 +289,15 @@ void CueControl::trackCuesUpdated() {
     if (!m_pLoadedTrack)
         return;
 
-    const QList<CuePointer> cuePoints(m_pLoadedTrack->getCuePoints());
-    QListIterator<CuePointer> it(cuePoints);
-    while (it.hasNext()) {
-        CuePointer pCue(it.next());
+    const TrackEngineSnapshotPointer pTrackSnapshot =
+            m_pLoadedTrack->getEngineSnapshot();
+    for (const CueIndex::Entry& entry : pTrackSnapshot->cueIndex.entries()) {
+        const CuePointer& pCue = entry.pCue;
 
-        if (pCue->getType() != Cue::CUE && pCue->getType() != Cue::LOAD)
+        if (entry.type != Cue::CUE && entry.type != Cue::LOAD)
             continue;
 
-        int hotcue = pCue->getHotCue();
+        int hotcue = entry.hotCue;
         if (hotcue != -1) {
             HotcueControl* pControl = m_hotcueControls.value(hotcue, NULL);
 
@@ -552,10 +571,21 @@ void CueControl::hintReader(HintVector* pHintList) {
     if (cuePoint >= 0) {
         cue_hint.frame = SampleUtil::floorPlayPosToFrame(m_pCuePoint->get());
         cue_hint.frameCount = Hint::kFrameCountForward;
-        cue_hint.priority = 10;
+        cue_hint.priority = Hint::kPriorityCue;
         pHintList->append(cue_hint);
     }
 
+    const double prefetchPosition = m_pPrefetchPosition->get();
+    const double prefetchLength = m_pPrefetchLength->get();
+    if (prefetchPosition >= 0 && prefetchLength > 0) {
+        Hint prefetch_hint;
+        prefetch_hint.frame = SampleUtil::floorPlayPosToFrame(prefetchPosition);
+        prefetch_hint.frameCount = math_max(
+                SampleUtil::floorPlayPosToFrame(prefetchLength), SINT(1));
+        prefetch_hint.priority = Hint::kPriorityBackground;
+        pHintList->append(prefetch_hint);
+    }
+
     // this is called from the engine thread
     // it is no locking required, because m_hotcueControl is filled during the
     // constructor and getPosition()->get() is a ControlObject
@@ -564,7 +594,7 @@ void CueControl::hintReader(HintVector* pHintList) {
         if (position != -1) {
             cue_hint.frame = SampleUtil::floorPlayPosToFrame(position);
             cue_hint.frameCount = Hint::kFrameCountForward;
-            cue_hint.priority = 10;
+            cue_hint.priority = Hint::kPriorityCue;
             pHintList->append(cue_hint);
         }
     }
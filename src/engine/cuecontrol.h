@@ -138,11 +138,17 @@ class CueControl : public EngineControl {
     bool m_bypassCueSetByPlay;
 
     const int m_iNumHotCues;
+    // Previews of tracks without a cue point start at the first hotcue
+    const bool m_bPreviewDeck;
     QList<HotcueControl*> m_hotcueControls;
 
     ControlObject* m_pTrackSamples;
     ControlObject* m_pCuePoint;
     ControlObject* m_pCueMode;
+    // A range in samples that is kept in the cache in the background,
+    // e.g. where Auto DJ is going to start playing the track
+    ControlObject* m_pPrefetchPosition;
+    ControlObject* m_pPrefetchLength;
     ControlPushButton* m_pCueSet;
     ControlPushButton* m_pCueCDJ;
     ControlPushButton* m_pCueDefault;
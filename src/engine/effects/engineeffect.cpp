@@ -74,9 +74,40 @@ void EngineEffect::deleteStatesForInputChannel(const ChannelHandle* inputChannel
     m_pProcessor->deleteStatesForInputChannel(inputChannel);
 }
 
+bool EngineEffect::setParameterParameters(int iParameter, double minimum,
+                                          double maximum, double default_value,
+                                          double value) {
+    EngineEffectParameter* pParameter = m_parameters.value(iParameter, NULL);
+    if (!pParameter) {
+        return false;
+    }
+    pParameter->setMinimum(minimum);
+    pParameter->setMaximum(maximum);
+    pParameter->setDefaultValue(default_value);
+    pParameter->setValue(value);
+    return true;
+}
+
+void EngineEffect::setEnabled(bool enabled) {
+    for (auto& outputMap : m_effectEnableStateForChannelMatrix) {
+        for (auto& enableState : outputMap) {
+            if (enableState != EffectEnableState::Disabled && !enabled) {
+                enableState = EffectEnableState::Disabling;
+            // If an input is not routed to the chain, and the effect gets
+            // a message to disable, then the effect gets the message to enable,
+            // process() will not have executed, so the enableState will still be
+            // DISABLING instead of DISABLED.
+            } else if ((enableState == EffectEnableState::Disabled ||
+                       enableState == EffectEnableState::Disabling)
+                       && enabled) {
+                enableState = EffectEnableState::Enabling;
+            }
+        }
+    }
+}
+
 bool EngineEffect::processEffectsRequest(EffectsRequest& message,
                                          EffectsResponsePipe* pResponsePipe) {
-    EngineEffectParameter* pParameter = NULL;
     EffectsResponse response(message);
 
     switch (message.type) {
@@ -86,23 +117,7 @@ bool EngineEffect::processEffectsRequest(EffectsRequest& message,
                          << "enabled" << message.SetEffectParameters.enabled;
             }
 
-            for (auto& outputMap : m_effectEnableStateForChannelMatrix) {
-                for (auto& enableState : outputMap) {
-                    if (enableState != EffectEnableState::Disabled
-                        && !message.SetEffectParameters.enabled) {
-                        enableState = EffectEnableState::Disabling;
-                    // If an input is not routed to the chain, and the effect gets
-                    // a message to disable, then the effect gets the message to enable,
-                    // process() will not have executed, so the enableState will still be
-                    // DISABLING instead of DISABLED.
-                    } else if ((enableState == EffectEnableState::Disabled ||
-                               enableState == EffectEnableState::Disabling)
-                               && message.SetEffectParameters.enabled) {
-                        enableState = EffectEnableState::Enabling;
-                    }
-                }
-            }
-
+            setEnabled(message.SetEffectParameters.enabled);
             response.success = true;
             pResponsePipe->writeMessages(&response, 1);
             return true;
@@ -116,13 +131,10 @@ bool EngineEffect::processEffectsRequest(EffectsRequest& message,
                          << "default_value" << message.default_value
                          << "value" << message.value;
             }
-            pParameter = m_parameters.value(
-                message.SetParameterParameters.iParameter, NULL);
-            if (pParameter) {
-                pParameter->setMinimum(message.minimum);
-                pParameter->setMaximum(message.maximum);
-                pParameter->setDefaultValue(message.default_value);
-                pParameter->setValue(message.value);
+            if (setParameterParameters(
+                    message.SetParameterParameters.iParameter,
+                    message.minimum, message.maximum,
+                    message.default_value, message.value)) {
                 response.success = true;
             } else {
                 response.success = false;
@@ -231,3 +243,17 @@ bool EngineEffect::process(const ChannelHandle& inputHandle,
 
     return processingOccured;
 }
+
+SINT EngineEffect::latencyFrames(const ChannelHandle& inputHandle,
+                                 const ChannelHandle& outputHandle,
+                                 const unsigned int numSamples,
+                                 const unsigned int sampleRate) {
+    if (m_effectEnableStateForChannelMatrix[inputHandle][outputHandle] ==
+            EffectEnableState::Disabled) {
+        return 0;
+    }
+    const mixxx::EngineParameters bufferParameters(
+          mixxx::AudioSignal::SampleRate(sampleRate),
+          numSamples / mixxx::kEngineChannelCount);
+    return m_pProcessor->getLatencyFrames(bufferParameters);
+}
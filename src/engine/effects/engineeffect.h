@@ -43,6 +43,17 @@ class EngineEffect : public EffectsRequestHandler {
         EffectsRequest& message,
         EffectsResponsePipe* pResponsePipe);
 
+    // Applies a SET_EFFECT_PARAMETERS request. Also called from the main
+    // thread for an effect that is not processed by the engine yet, see
+    // StagedEffectChain.
+    void setEnabled(bool enabled);
+
+    // Applies the parameters of a SET_PARAMETER_PARAMETERS request or of one
+    // change of a SET_PARAMETER_PARAMETERS_BATCH request. Returns false if
+    // there is no such parameter.
+    bool setParameterParameters(int iParameter, double minimum, double maximum,
+                                double default_value, double value);
+
     bool process(const ChannelHandle& inputHandle, const ChannelHandle& outputHandle,
                  const CSAMPLE* pInput, CSAMPLE* pOutput,
                  const unsigned int numSamples,
@@ -50,6 +61,14 @@ class EngineEffect : public EffectsRequestHandler {
                  const EffectEnableState chainEnableState,
                  const GroupFeatureState& groupFeatures);
 
+    // Returns the latency that process() adds to the given routing, or 0
+    // if the effect is disabled for it. See
+    // EffectProcessor::getLatencyFrames()
+    SINT latencyFrames(const ChannelHandle& inputHandle,
+                       const ChannelHandle& outputHandle,
+                       const unsigned int numSamples,
+                       const unsigned int sampleRate);
+
   private:
     QString debugString() const {
         return QString("EngineEffect(%1)").arg(m_manifest.name());
@@ -12,7 +12,8 @@ EngineEffectChain::EngineEffectChain(const QString& id,
           m_insertionType(EffectChainInsertionType::Insert),
           m_dMix(0),
           m_buffer1(MAX_BUFFER_LEN),
-          m_buffer2(MAX_BUFFER_LEN) {
+          m_buffer2(MAX_BUFFER_LEN),
+          m_pCrossfadeChain(nullptr) {
     // Try to prevent memory allocation.
     m_effects.reserve(256);
 
@@ -75,16 +76,64 @@ bool EngineEffectChain::removeEffect(EngineEffect* pEffect, int iIndex) {
 
 // this is called from the engine thread onCallbackStart()
 bool EngineEffectChain::updateParameters(const EffectsRequest& message) {
+    setParameters(message.SetEffectChainParameters.enabled,
+                  message.SetEffectChainParameters.insertion_type,
+                  message.SetEffectChainParameters.mix);
+    return true;
+}
+
+void EngineEffectChain::setParameters(bool enabled,
+                                      EffectChainInsertionType insertionType,
+                                      double mix) {
     // TODO(rryan): Parameter interpolation.
-    m_insertionType = message.SetEffectChainParameters.insertion_type;
-    m_dMix = message.SetEffectChainParameters.mix;
+    m_insertionType = insertionType;
+    m_dMix = mix;
 
-    if (m_enableState != EffectEnableState::Disabled && !message.SetEffectParameters.enabled) {
+    if (m_enableState != EffectEnableState::Disabled && !enabled) {
         m_enableState = EffectEnableState::Disabling;
-    } else if (m_enableState == EffectEnableState::Disabled && message.SetEffectParameters.enabled) {
+    } else if (m_enableState == EffectEnableState::Disabled && enabled) {
         m_enableState = EffectEnableState::Enabling;
     }
-    return true;
+}
+
+bool EngineEffectChain::addStagedEffect(EngineEffect* pEffect, int iIndex) {
+    return addEffect(pEffect, iIndex);
+}
+
+void EngineEffectChain::enableStagedInputChannel(const ChannelHandle& inputHandle) {
+    // The effects will reset their states when they are processed with
+    // the enabling state for the first time
+    for (auto&& outputChannelStatus : m_chainStatusForChannelMatrix[inputHandle]) {
+        outputChannelStatus.enable_state = EffectEnableState::Enabling;
+    }
+}
+
+void EngineEffectChain::prepareCrossfade() {
+    mixxx::SampleBuffer(MAX_BUFFER_LEN).swap(m_crossfadeBuffer1);
+    mixxx::SampleBuffer(MAX_BUFFER_LEN).swap(m_crossfadeBuffer2);
+    m_buffer1.clear();
+    m_buffer2.clear();
+    m_crossfadeBuffer1.clear();
+    m_crossfadeBuffer2.clear();
+}
+
+void EngineEffectChain::startCrossfade(EngineEffectChain* pChain) {
+    VERIFY_OR_DEBUG_ASSERT(m_crossfadeBuffer1.size() > 0 &&
+            m_crossfadeBuffer2.size() > 0) {
+        return;
+    }
+    m_pCrossfadeChain = pChain;
+    // The crossfade already ramps from the replaced chain to the wet output
+    // of this chain, which shouldn't ramp up from dry on top of that.
+    for (auto& outputMap : m_chainStatusForChannelMatrix) {
+        for (auto& outputChannelStatus : outputMap) {
+            outputChannelStatus.old_gain = m_dMix;
+        }
+    }
+}
+
+void EngineEffectChain::finishCrossfade() {
+    m_pCrossfadeChain = nullptr;
 }
 
 bool EngineEffectChain::processEffectsRequest(EffectsRequest& message,
@@ -209,12 +258,105 @@ EngineEffectChain::ChannelStatus& EngineEffectChain::getChannelStatus(
     return status;
 }
 
+int EngineEffectChain::numActiveInputChannels() const {
+    // While crossfading, process() also processes the replaced chain and
+    // both use the crossfade buffers
+    int count = m_pCrossfadeChain != nullptr ?
+            m_pCrossfadeChain->numActiveInputChannels() : 0;
+    for (const auto& outputMap : m_chainStatusForChannelMatrix) {
+        for (const auto& outputChannelStatus : outputMap) {
+            if (outputChannelStatus.enable_state != EffectEnableState::Disabled) {
+                ++count;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+bool EngineEffectChain::isActive(const ChannelHandle& inputHandle,
+                                 const ChannelHandle& outputHandle) {
+    if (m_pCrossfadeChain != nullptr &&
+            m_pCrossfadeChain->isActive(inputHandle, outputHandle)) {
+        return true;
+    }
+    // Same effective enable state as in process()
+    if (m_enableState != EffectEnableState::Enabled) {
+        return m_enableState != EffectEnableState::Disabled;
+    }
+    const ChannelStatus& channelStatus =
+            m_chainStatusForChannelMatrix[inputHandle][outputHandle];
+    return channelStatus.enable_state != EffectEnableState::Disabled;
+}
+
+SINT EngineEffectChain::latencyFrames(const ChannelHandle& inputHandle,
+                                      const ChannelHandle& outputHandle,
+                                      const unsigned int numSamples,
+                                      const unsigned int sampleRate) {
+    if (!isActive(inputHandle, outputHandle)) {
+        return 0;
+    }
+    SINT latency = 0;
+    for (EngineEffect* pEffect : m_effects) {
+        if (pEffect != nullptr) {
+            latency += pEffect->latencyFrames(inputHandle, outputHandle,
+                    numSamples, sampleRate);
+        }
+    }
+    return latency;
+}
+
 bool EngineEffectChain::process(const ChannelHandle& inputHandle,
                                 const ChannelHandle& outputHandle,
                                 CSAMPLE* pIn, CSAMPLE* pOut,
                                 const unsigned int numSamples,
                                 const unsigned int sampleRate,
                                 const GroupFeatureState& groupFeatures) {
+    if (m_pCrossfadeChain != nullptr) {
+        return processCrossfade(inputHandle, outputHandle, pIn, pOut,
+                                numSamples, sampleRate, groupFeatures);
+    }
+    return processEffects(inputHandle, outputHandle, pIn, pOut,
+                          numSamples, sampleRate, groupFeatures);
+}
+
+bool EngineEffectChain::processCrossfade(const ChannelHandle& inputHandle,
+                                         const ChannelHandle& outputHandle,
+                                         CSAMPLE* pIn, CSAMPLE* pOut,
+                                         const unsigned int numSamples,
+                                         const unsigned int sampleRate,
+                                         const GroupFeatureState& groupFeatures) {
+    // Neither chain modifies pIn when processing into another buffer, so
+    // both are processed from the same input. A chain that doesn't process
+    // the routing contributes the input unchanged.
+    const CSAMPLE* pOldOutput = pIn;
+    if (m_pCrossfadeChain->process(inputHandle, outputHandle,
+                                   pIn, m_crossfadeBuffer1.data(),
+                                   numSamples, sampleRate, groupFeatures)) {
+        pOldOutput = m_crossfadeBuffer1.data();
+    }
+    const CSAMPLE* pNewOutput = pIn;
+    if (processEffects(inputHandle, outputHandle,
+                       pIn, m_crossfadeBuffer2.data(),
+                       numSamples, sampleRate, groupFeatures)) {
+        pNewOutput = m_crossfadeBuffer2.data();
+    }
+    if (pOldOutput == pIn && pNewOutput == pIn) {
+        return false;
+    }
+    SampleUtil::copy2WithRampingGain(pOut,
+            pOldOutput, 1.0, 0.0,
+            pNewOutput, 0.0, 1.0,
+            numSamples);
+    return true;
+}
+
+bool EngineEffectChain::processEffects(const ChannelHandle& inputHandle,
+                                       const ChannelHandle& outputHandle,
+                                       CSAMPLE* pIn, CSAMPLE* pOut,
+                                       const unsigned int numSamples,
+                                       const unsigned int sampleRate,
+                                       const GroupFeatureState& groupFeatures) {
     // Compute the effective enable state from the channel input routing switch and
     // the chain's enable state. When either of these are turned on/off, send the
     // effects the intermediate enabling/disabling signal.
@@ -40,8 +40,53 @@ class EngineEffectChain : public EffectsRequestHandler {
 
     bool enabledForChannel(const ChannelHandle& handle) const;
 
+    // Returns the number of input channels that process() may currently
+    // apply the effects of this chain to, including channels that are still
+    // being enabled or disabled.
+    int numActiveInputChannels() const;
+
+    // Returns false if process() is guaranteed to neither modify the
+    // buffers nor depend on their content for the given routing. This
+    // allows the caller to defer linear operations like gain ramping.
+    bool isActive(const ChannelHandle& inputHandle,
+                  const ChannelHandle& outputHandle);
+
+    // Returns the sum of the latencies of the effects that process() applies
+    // to the given routing. See EffectProcessor::getLatencyFrames()
+    SINT latencyFrames(const ChannelHandle& inputHandle,
+                       const ChannelHandle& outputHandle,
+                       const unsigned int numSamples,
+                       const unsigned int sampleRate);
+
     void deleteStatesForInputChannel(const ChannelHandle* channel);
 
+    // The effects of this chain by their index, null for empty slots
+    const QList<EngineEffect*>& effects() const {
+        return m_effects;
+    }
+
+    // Applies the parameters of a SET_EFFECT_CHAIN_PARAMETERS request
+    void setParameters(bool enabled, EffectChainInsertionType insertionType,
+                       double mix);
+
+    // For setting up a chain that the engine does not process yet from the
+    // thread that builds it, see StagedEffectChain. The effects must have
+    // been created with the input channels that are enabled here as active
+    // input channels, so they already have their EffectStates.
+    bool addStagedEffect(EngineEffect* pEffect, int iIndex);
+    void enableStagedInputChannel(const ChannelHandle& inputHandle);
+    // Allocates the buffers for crossfading from the chain that this chain
+    // replaces and clears all buffers of the chain, so the audio callback
+    // doesn't page fault on them.
+    void prepareCrossfade();
+
+    // Called by EngineEffectRack when this chain replaces pChain. Until
+    // finishCrossfade() is called at the start of the next callback,
+    // process() crossfades from the output of pChain to the output of this
+    // chain.
+    void startCrossfade(EngineEffectChain* pChain);
+    void finishCrossfade();
+
   private:
     struct ChannelStatus {
         ChannelStatus()
@@ -57,6 +102,18 @@ class EngineEffectChain : public EffectsRequestHandler {
     }
 
     bool updateParameters(const EffectsRequest& message);
+    bool processEffects(const ChannelHandle& inputHandle,
+                        const ChannelHandle& outputHandle,
+                        CSAMPLE* pIn, CSAMPLE* pOut,
+                        const unsigned int numSamples,
+                        const unsigned int sampleRate,
+                        const GroupFeatureState& groupFeatures);
+    bool processCrossfade(const ChannelHandle& inputHandle,
+                          const ChannelHandle& outputHandle,
+                          CSAMPLE* pIn, CSAMPLE* pOut,
+                          const unsigned int numSamples,
+                          const unsigned int sampleRate,
+                          const GroupFeatureState& groupFeatures);
     bool addEffect(EngineEffect* pEffect, int iIndex);
     bool removeEffect(EngineEffect* pEffect, int iIndex);
     bool enableForInputChannel(const ChannelHandle* inputHandle,
@@ -75,6 +132,11 @@ class EngineEffectChain : public EffectsRequestHandler {
     QList<EngineEffect*> m_effects;
     mixxx::SampleBuffer m_buffer1;
     mixxx::SampleBuffer m_buffer2;
+    // The replaced chain while crossfading from it
+    EngineEffectChain* m_pCrossfadeChain;
+    // Only allocated for chains that have been built by StagedEffectChain
+    mixxx::SampleBuffer m_crossfadeBuffer1;
+    mixxx::SampleBuffer m_crossfadeBuffer2;
     ChannelHandleMap<ChannelHandleMap<ChannelStatus>> m_chainStatusForChannelMatrix;
 
     DISALLOW_COPY_AND_ASSIGN(EngineEffectChain);
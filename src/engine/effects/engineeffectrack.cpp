@@ -44,6 +44,39 @@ bool EngineEffectRack::processEffectsRequest(EffectsRequest& message,
     return true;
 }
 
+bool EngineEffectRack::isActive(const ChannelHandle& inputHandle,
+                                const ChannelHandle& outputHandle) {
+    for (EngineEffectChain* pChain : m_chains) {
+        if (pChain != nullptr && pChain->isActive(inputHandle, outputHandle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SINT EngineEffectRack::latencyFrames(const ChannelHandle& inputHandle,
+                                     const ChannelHandle& outputHandle,
+                                     const unsigned int numSamples,
+                                     const unsigned int sampleRate) {
+    SINT latency = 0;
+    for (EngineEffectChain* pChain : m_chains) {
+        if (pChain != nullptr) {
+            latency += pChain->latencyFrames(inputHandle, outputHandle,
+                    numSamples, sampleRate);
+        }
+    }
+    return latency;
+}
+
+bool EngineEffectRack::isParallelSafe() const {
+    for (EngineEffectChain* pChain : m_chains) {
+        if (pChain != nullptr && pChain->numActiveInputChannels() > 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool EngineEffectRack::process(const ChannelHandle& inputHandle,
                                const ChannelHandle& outputHandle,
                                CSAMPLE* pIn, CSAMPLE* pOut,
@@ -138,3 +171,39 @@ bool EngineEffectRack::removeEffectChain(EngineEffectChain* pChain, int iIndex)
     m_chains.replace(iIndex, NULL);
     return true;
 }
+
+bool EngineEffectRack::replaceEffectChain(EngineEffectChain* pChain,
+                                          EngineEffectChain* pOldChain,
+                                          int iIndex) {
+    if (iIndex < 0) {
+        if (kEffectDebugOutput) {
+            qDebug() << debugString()
+                     << "WARNING: REPLACE_CHAIN_IN_RACK message with invalid index:"
+                     << iIndex;
+        }
+        return false;
+    }
+    if (m_chains.contains(pChain)) {
+        if (kEffectDebugOutput) {
+            qDebug() << debugString() << "WARNING: chain already added to EngineEffectRack:"
+                     << pChain->id();
+        }
+        return false;
+    }
+    while (iIndex >= m_chains.size()) {
+        m_chains.append(NULL);
+    }
+    if (m_chains.at(iIndex) != pOldChain) {
+        qDebug() << debugString()
+                 << "WARNING: REPLACE_CHAIN_IN_RACK consistency error"
+                 << m_chains.at(iIndex) << "loaded but received request to replace"
+                 << pOldChain;
+        return false;
+    }
+
+    m_chains.replace(iIndex, pChain);
+    if (pOldChain != nullptr) {
+        pChain->startCrossfade(pOldChain);
+    }
+    return true;
+}
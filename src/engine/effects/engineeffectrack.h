@@ -27,10 +27,33 @@ class EngineEffectRack : public EffectsRequestHandler {
                  const unsigned int sampleRate,
                  const GroupFeatureState& groupFeatures);
 
+    // Returns true if any chain of this rack may process the given routing.
+    // See EngineEffectChain::isActive()
+    bool isActive(const ChannelHandle& inputHandle,
+                  const ChannelHandle& outputHandle);
+
+    // Returns the sum of the latencies of the chains of this rack for the
+    // given routing. See EngineEffectChain::latencyFrames()
+    SINT latencyFrames(const ChannelHandle& inputHandle,
+                       const ChannelHandle& outputHandle,
+                       const unsigned int numSamples,
+                       const unsigned int sampleRate);
+
+    // Returns true if in-place process() calls for different input channels
+    // may run concurrently, i.e. no chain is active for more than one input
+    // channel. The rack itself only uses its buffers when not in place.
+    bool isParallelSafe() const;
+
     int number() const {
         return m_iRackNumber;
     }
 
+    // Replaces pOldChain, which may be null for an empty index, with pChain
+    // at iIndex for a REPLACE_CHAIN_IN_RACK request and lets pChain
+    // crossfade from pOldChain. Returns false if pOldChain is not at iIndex.
+    bool replaceEffectChain(EngineEffectChain* pChain,
+                            EngineEffectChain* pOldChain, int iIndex);
+
   private:
     bool addEffectChain(EngineEffectChain* pChain, int iIndex);
     bool removeEffectChain(EngineEffectChain* pChain, int iIndex);
@@ -3,14 +3,25 @@
 #include "engine/effects/engineeffectrack.h"
 #include "engine/effects/engineeffectchain.h"
 #include "engine/effects/engineeffect.h"
+#include "engine/callbackprofiler.h"
 
 #include "util/defs.h"
 #include "util/sample.h"
 
+namespace {
+
+// The number of requests that are taken from the pipe at once
+const int kRequestBatchSize = 32;
+
+} // anonymous namespace
+
 EngineEffectsManager::EngineEffectsManager(EffectsResponsePipe* pResponsePipe)
         : m_pResponsePipe(pResponsePipe),
           m_buffer1(MAX_BUFFER_LEN),
-          m_buffer2(MAX_BUFFER_LEN) {
+          m_buffer2(MAX_BUFFER_LEN),
+          m_bPreFaderParallelSafe(true),
+          m_numCrossfades(0),
+          m_pCallbackProfiler(nullptr) {
     // Try to prevent memory allocation.
     m_chains.reserve(256);
     m_effects.reserve(256);
@@ -20,103 +31,243 @@ EngineEffectsManager::~EngineEffectsManager() {
 }
 
 void EngineEffectsManager::onCallbackStart() {
-    EffectsRequest* request = NULL;
-    while (m_pResponsePipe->readMessages(&request, 1) > 0) {
-        EffectsResponse response(*request);
-        bool processed = false;
-        switch (request->type) {
-            case EffectsRequest::ADD_EFFECT_RACK:
-            case EffectsRequest::REMOVE_EFFECT_RACK:
-                if (processEffectsRequest(*request, m_pResponsePipe.data())) {
-                    processed = true;
-                }
-                break;
-            case EffectsRequest::ADD_CHAIN_TO_RACK:
-            case EffectsRequest::REMOVE_CHAIN_FROM_RACK:
-                VERIFY_OR_DEBUG_ASSERT(request->pTargetRack) {
-                    response.success = false;
-                    response.status = EffectsResponse::NO_SUCH_RACK;
+    // The previous callback has processed the crossfades from the chains
+    // that have been replaced
+    bool bRequestsProcessed = m_numCrossfades > 0;
+    finishCrossfades();
+
+    EffectsRequest* requests[kRequestBatchSize];
+    int count;
+    while ((count = m_pResponsePipe->readMessages(
+            requests, kRequestBatchSize)) > 0) {
+        bRequestsProcessed = true;
+        for (int i = 0; i < count; ++i) {
+            EffectsRequest* request = requests[i];
+            EffectsResponse response(*request);
+            bool processed = false;
+            switch (request->type) {
+                case EffectsRequest::ADD_EFFECT_RACK:
+                case EffectsRequest::REMOVE_EFFECT_RACK:
+                    if (processEffectsRequest(*request, m_pResponsePipe.data())) {
+                        processed = true;
+                    }
                     break;
-                }
+                case EffectsRequest::ADD_CHAIN_TO_RACK:
+                case EffectsRequest::REMOVE_CHAIN_FROM_RACK:
+                    VERIFY_OR_DEBUG_ASSERT(request->pTargetRack) {
+                        response.success = false;
+                        response.status = EffectsResponse::NO_SUCH_RACK;
+                        break;
+                    }
+
+                    processed = request->pTargetRack->processEffectsRequest(
+                        *request, m_pResponsePipe.data());
 
-                processed = request->pTargetRack->processEffectsRequest(
-                    *request, m_pResponsePipe.data());
-
-                if (processed) {
-                    // When an effect-chain becomes active (part of a rack), keep
-                    // it in our master list so that we can respond to
-                    // requests about it.
-                    if (request->type == EffectsRequest::ADD_CHAIN_TO_RACK) {
-                        m_chains.append(request->AddChainToRack.pChain);
-                    } else if (request->type == EffectsRequest::REMOVE_CHAIN_FROM_RACK) {
-                        m_chains.removeAll(request->RemoveChainFromRack.pChain);
+                    if (processed) {
+                        // When an effect-chain becomes active (part of a rack), keep
+                        // it in our master list so that we can respond to
+                        // requests about it.
+                        if (request->type == EffectsRequest::ADD_CHAIN_TO_RACK) {
+                            m_chains.append(request->AddChainToRack.pChain);
+                        } else if (request->type == EffectsRequest::REMOVE_CHAIN_FROM_RACK) {
+                            m_chains.removeAll(request->RemoveChainFromRack.pChain);
+                            // The removed chain is not processed anymore, so
+                            // the chain it replaced may be deleted as well
+                            finishCrossfades(request->RemoveChainFromRack.pChain);
+                        }
+                    } else {
+                        if (!processed) {
+                            // If we got here, the message was not handled for
+                            // an unknown reason.
+                            response.success = false;
+                            response.status = EffectsResponse::INVALID_REQUEST;
+                        }
                     }
-                } else {
-                    if (!processed) {
+                    break;
+                case EffectsRequest::REPLACE_CHAIN_IN_RACK:
+                    processed = replaceEffectChain(*request, &response);
+                    break;
+                case EffectsRequest::ADD_EFFECT_TO_CHAIN:
+                case EffectsRequest::REMOVE_EFFECT_FROM_CHAIN:
+                case EffectsRequest::SET_EFFECT_CHAIN_PARAMETERS:
+                case EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL:
+                case EffectsRequest::DISABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL:
+                    VERIFY_OR_DEBUG_ASSERT(m_chains.contains(request->pTargetChain)) {
+                        response.success = false;
+                        response.status = EffectsResponse::NO_SUCH_CHAIN;
+                        break;
+                    }
+
+                    processed = request->pTargetChain->processEffectsRequest(
+                        *request, m_pResponsePipe.data());
+                    if (processed) {
+                        // When an effect becomes active (part of a chain), keep
+                        // it in our master list so that we can respond to
+                        // requests about it.
+                        if (request->type == EffectsRequest::ADD_EFFECT_TO_CHAIN) {
+                            m_effects.append(request->AddEffectToChain.pEffect);
+                        } else if (request->type == EffectsRequest::REMOVE_EFFECT_FROM_CHAIN) {
+                            m_effects.removeAll(request->RemoveEffectFromChain.pEffect);
+                        }
+                    } else {
                         // If we got here, the message was not handled for
                         // an unknown reason.
                         response.success = false;
                         response.status = EffectsResponse::INVALID_REQUEST;
                     }
-                }
-                break;
-            case EffectsRequest::ADD_EFFECT_TO_CHAIN:
-            case EffectsRequest::REMOVE_EFFECT_FROM_CHAIN:
-            case EffectsRequest::SET_EFFECT_CHAIN_PARAMETERS:
-            case EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL:
-            case EffectsRequest::DISABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL:
-                VERIFY_OR_DEBUG_ASSERT(m_chains.contains(request->pTargetChain)) {
-                    response.success = false;
-                    response.status = EffectsResponse::NO_SUCH_CHAIN;
                     break;
-                }
+                case EffectsRequest::SET_EFFECT_PARAMETERS:
+                case EffectsRequest::SET_PARAMETER_PARAMETERS:
+                    VERIFY_OR_DEBUG_ASSERT(m_effects.contains(request->pTargetEffect)) {
+                        response.success = false;
+                        response.status = EffectsResponse::NO_SUCH_EFFECT;
+                        break;
+                    }
 
-                processed = request->pTargetChain->processEffectsRequest(
-                    *request, m_pResponsePipe.data());
-                if (processed) {
-                    // When an effect becomes active (part of a chain), keep
-                    // it in our master list so that we can respond to
-                    // requests about it.
-                    if (request->type == EffectsRequest::ADD_EFFECT_TO_CHAIN) {
-                        m_effects.append(request->AddEffectToChain.pEffect);
-                    } else if (request->type == EffectsRequest::REMOVE_EFFECT_FROM_CHAIN) {
-                        m_effects.removeAll(request->RemoveEffectFromChain.pEffect);
+                    processed = request->pTargetEffect
+                            ->processEffectsRequest(*request, m_pResponsePipe.data());
+
+                    if (!processed) {
+                        // If we got here, the message was not handled for an
+                        // unknown reason.
+                        response.success = false;
+                        response.status = EffectsResponse::INVALID_REQUEST;
                     }
-                } else {
-                    // If we got here, the message was not handled for
-                    // an unknown reason.
-                    response.success = false;
-                    response.status = EffectsResponse::INVALID_REQUEST;
-                }
-                break;
-            case EffectsRequest::SET_EFFECT_PARAMETERS:
-            case EffectsRequest::SET_PARAMETER_PARAMETERS:
-                VERIFY_OR_DEBUG_ASSERT(m_effects.contains(request->pTargetEffect)) {
+                    break;
+                case EffectsRequest::SET_PARAMETER_PARAMETERS_BATCH:
+                    VERIFY_OR_DEBUG_ASSERT(
+                            request->SetParameterParametersBatch.pBatch) {
+                        response.success = false;
+                        response.status = EffectsResponse::INVALID_REQUEST;
+                        break;
+                    }
+                    response.success = applyParameterBatch(
+                            *request->SetParameterParametersBatch.pBatch,
+                            &response.status);
+                    break;
+                default:
                     response.success = false;
-                    response.status = EffectsResponse::NO_SUCH_EFFECT;
+                    response.status = EffectsResponse::UNHANDLED_MESSAGE_TYPE;
                     break;
-                }
+            }
 
-                processed = request->pTargetEffect
-                        ->processEffectsRequest(*request, m_pResponsePipe.data());
+            if (!processed) {
+                m_pResponsePipe->writeMessages(&response, 1);
+            }
+        }
+    }
 
-                if (!processed) {
-                    // If we got here, the message was not handled for an
-                    // unknown reason.
-                    response.success = false;
-                    response.status = EffectsResponse::INVALID_REQUEST;
-                }
-                break;
-            default:
-                response.success = false;
-                response.status = EffectsResponse::UNHANDLED_MESSAGE_TYPE;
-                break;
+    // Chains only become active for a channel through a request. While
+    // processing they can only go from enabling to enabled or from disabling
+    // to disabled, so the result stays valid until the next request.
+    if (bRequestsProcessed) {
+        updatePreFaderParallelSafe();
+    }
+}
+
+void EngineEffectsManager::updatePreFaderParallelSafe() {
+    m_bPreFaderParallelSafe = true;
+    const QList<EngineEffectRack*>& racks =
+            m_racksByStage.value(SignalProcessingStage::Prefader);
+    for (EngineEffectRack* pRack : racks) {
+        if (pRack != nullptr && !pRack->isParallelSafe()) {
+            m_bPreFaderParallelSafe = false;
+            return;
         }
+    }
+}
+
+bool EngineEffectsManager::replaceEffectChain(const EffectsRequest& request,
+                                              EffectsResponse* pResponse) {
+    EngineEffectChain* pChain = request.ReplaceChainInRack.pChain;
+    EngineEffectChain* pOldChain = request.ReplaceChainInRack.pOldChain;
+    VERIFY_OR_DEBUG_ASSERT(request.pTargetRack) {
+        pResponse->success = false;
+        pResponse->status = EffectsResponse::NO_SUCH_RACK;
+        return false;
+    }
+    VERIFY_OR_DEBUG_ASSERT(pChain) {
+        pResponse->success = false;
+        pResponse->status = EffectsResponse::INVALID_REQUEST;
+        return false;
+    }
+    if (kEffectDebugOutput) {
+        qDebug() << debugString() << "REPLACE_CHAIN_IN_RACK"
+                 << pOldChain << "with" << pChain
+                 << request.ReplaceChainInRack.iIndex;
+    }
+    if (!request.pTargetRack->replaceEffectChain(pChain, pOldChain,
+            request.ReplaceChainInRack.iIndex)) {
+        pResponse->success = false;
+        pResponse->status = EffectsResponse::INVALID_REQUEST;
+        return false;
+    }
 
-        if (!processed) {
-            m_pResponsePipe->writeMessages(&response, 1);
+    // Keep the master lists up to date so that we can respond to requests
+    // about the new chain and its effects
+    if (pOldChain != nullptr) {
+        m_chains.removeAll(pOldChain);
+        for (EngineEffect* pEffect : pOldChain->effects()) {
+            if (pEffect != nullptr) {
+                m_effects.removeAll(pEffect);
+            }
+        }
+    }
+    m_chains.append(pChain);
+    for (EngineEffect* pEffect : pChain->effects()) {
+        if (pEffect != nullptr) {
+            m_effects.append(pEffect);
+        }
+    }
+    pResponse->success = true;
+
+    if (pOldChain == nullptr) {
+        return false;
+    }
+    if (m_numCrossfades == kMaxCrossfades) {
+        // Cut over to the new chain rather than block the audio thread
+        pChain->finishCrossfade();
+        return false;
+    }
+    Crossfade& crossfade = m_crossfades[m_numCrossfades++];
+    crossfade.pChain = pChain;
+    crossfade.response = *pResponse;
+    return true;
+}
+
+void EngineEffectsManager::finishCrossfades(const EngineEffectChain* pChain) {
+    int remaining = 0;
+    for (int i = 0; i < m_numCrossfades; ++i) {
+        Crossfade& crossfade = m_crossfades[i];
+        if (pChain == nullptr || crossfade.pChain == pChain) {
+            crossfade.pChain->finishCrossfade();
+            m_pResponsePipe->writeMessages(&crossfade.response, 1);
+        } else {
+            m_crossfades[remaining++] = crossfade;
         }
     }
+    m_numCrossfades = remaining;
+}
+
+bool EngineEffectsManager::applyParameterBatch(
+        const EffectParameterBatch& batch,
+        EffectsResponse::StatusCode* pStatus) {
+    bool success = true;
+    for (int i = 0; i < batch.count; ++i) {
+        const EffectParameterChange& change = batch.changes[i];
+        VERIFY_OR_DEBUG_ASSERT(m_effects.contains(change.pEffect)) {
+            success = false;
+            *pStatus = EffectsResponse::NO_SUCH_EFFECT;
+            continue;
+        }
+        if (!change.pEffect->setParameterParameters(
+                change.iParameter, change.minimum, change.maximum,
+                change.default_value, change.value)) {
+            success = false;
+            *pStatus = EffectsResponse::NO_SUCH_PARAMETER;
+        }
+    }
+    return success;
 }
 
 void EngineEffectsManager::processPreFaderInPlace(const ChannelHandle& inputHandle,
@@ -145,6 +296,7 @@ void EngineEffectsManager::processPostFaderInPlace(
     const GroupFeatureState& groupFeatures,
     const CSAMPLE_GAIN oldGain,
     const CSAMPLE_GAIN newGain) {
+    ScopedCallbackStage stage(m_pCallbackProfiler, CallbackProfiler::EFFECTS);
     processInner(SignalProcessingStage::Postfader,
                  inputHandle, outputHandle,
                  pInOut, pInOut,
@@ -161,6 +313,7 @@ void EngineEffectsManager::processPostFaderAndMix(
     const GroupFeatureState& groupFeatures,
     const CSAMPLE_GAIN oldGain,
     const CSAMPLE_GAIN newGain) {
+    ScopedCallbackStage stage(m_pCallbackProfiler, CallbackProfiler::EFFECTS);
     processInner(SignalProcessingStage::Postfader,
                  inputHandle, outputHandle,
                  pIn, pOut,
@@ -168,6 +321,38 @@ void EngineEffectsManager::processPostFaderAndMix(
                  oldGain, newGain);
 }
 
+bool EngineEffectsManager::isPostFaderActive(
+    const ChannelHandle& inputHandle,
+    const ChannelHandle& outputHandle) {
+    const auto racksIt = m_racksByStage.constFind(SignalProcessingStage::Postfader);
+    if (racksIt == m_racksByStage.constEnd()) {
+        return false;
+    }
+    for (EngineEffectRack* pRack : racksIt.value()) {
+        if (pRack != nullptr && pRack->isActive(inputHandle, outputHandle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SINT EngineEffectsManager::latencyFrames(
+    const ChannelHandle& inputHandle,
+    const ChannelHandle& outputHandle,
+    const unsigned int numSamples,
+    const unsigned int sampleRate) {
+    SINT latency = 0;
+    for (const QList<EngineEffectRack*>& racks : m_racksByStage) {
+        for (EngineEffectRack* pRack : racks) {
+            if (pRack != nullptr) {
+                latency += pRack->latencyFrames(inputHandle, outputHandle,
+                        numSamples, sampleRate);
+            }
+        }
+    }
+    return latency;
+}
+
 void EngineEffectsManager::processInner(
     const SignalProcessingStage stage,
     const ChannelHandle& inputHandle,
@@ -10,6 +10,7 @@
 #include "engine/effects/groupfeaturestate.h"
 #include "engine/channelhandle.h"
 
+class CallbackProfiler;
 class EngineEffectRack;
 class EngineEffectChain;
 class EngineEffect;
@@ -21,6 +22,21 @@ class EngineEffectsManager : public EffectsRequestHandler {
 
     void onCallbackStart();
 
+    // The post-fader effects processing is credited to the effects stage of
+    // the given profiler.
+    void setCallbackProfiler(CallbackProfiler* pCallbackProfiler) {
+        m_pCallbackProfiler = pCallbackProfiler;
+    }
+
+    // Returns true if processPreFaderInPlace() may be called for different
+    // input channels concurrently. This is the case as long as no pre-fader
+    // chain is active for more than one input channel, because the chains
+    // and their effects keep scratch buffers and per-channel state that are
+    // not synchronized. Updated by onCallbackStart().
+    bool isPreFaderProcessingParallelSafe() const {
+        return m_bPreFaderParallelSafe;
+    }
+
     // Take a buffer of numSamples samples of audio from a channel, provided as
     // pInput, and apply each EffectChain enabled for this channel to it,
     // putting the resulting output in pOutput. If pInput is equal to pOutput,
@@ -55,6 +71,21 @@ class EngineEffectsManager : public EffectsRequestHandler {
         const CSAMPLE_GAIN oldGain = CSAMPLE_GAIN_ONE,
         const CSAMPLE_GAIN newGain = CSAMPLE_GAIN_ONE);
 
+    // Returns false if no post-fader effect will process the channel for
+    // this output. In that case ChannelMixer applies the channel gain while
+    // mixing instead of in a separate pass.
+    bool isPostFaderActive(
+        const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle);
+
+    // Returns the latency that the pre-fader and post-fader effects add to
+    // the given routing. See EffectProcessor::getLatencyFrames()
+    SINT latencyFrames(
+        const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle,
+        const unsigned int numSamples,
+        const unsigned int sampleRate);
+
     bool processEffectsRequest(
         EffectsRequest& message,
         EffectsResponsePipe* pResponsePipe);
@@ -73,6 +104,22 @@ class EngineEffectsManager : public EffectsRequestHandler {
     bool addPostFaderEffectRack(EngineEffectRack* pRack);
     bool removePostFaderEffectRack(EngineEffectRack* pRack);
 
+    void updatePreFaderParallelSafe();
+
+    // Handles a REPLACE_CHAIN_IN_RACK request. Returns true if the response
+    // is delayed until the crossfade from the replaced chain has finished.
+    bool replaceEffectChain(const EffectsRequest& request,
+                            EffectsResponse* pResponse);
+    // Ends the crossfades of the chains that have replaced a chain and
+    // writes the responses of their requests, so the replaced chains may be
+    // deleted. With pChain only the crossfade of that chain is ended.
+    void finishCrossfades(const EngineEffectChain* pChain = nullptr);
+
+    // Applies all changes of a SET_PARAMETER_PARAMETERS_BATCH request. Changes
+    // for unknown effects or parameters are skipped and reported in pStatus.
+    bool applyParameterBatch(const EffectParameterBatch& batch,
+                             EffectsResponse::StatusCode* pStatus);
+
     void processInner(const SignalProcessingStage stage,
                       const ChannelHandle& inputHandle,
                       const ChannelHandle& outputHandle,
@@ -87,9 +134,22 @@ class EngineEffectsManager : public EffectsRequestHandler {
     QHash<SignalProcessingStage, QList<EngineEffectRack*>> m_racksByStage;
     QList<EngineEffectChain*> m_chains;
     QList<EngineEffect*> m_effects;
+    bool m_bPreFaderParallelSafe;
+
+    // The chains that replaced a chain in the current callback, with the
+    // responses to their requests
+    struct Crossfade {
+        EngineEffectChain* pChain;
+        EffectsResponse response;
+    };
+    static const int kMaxCrossfades = 32;
+    Crossfade m_crossfades[kMaxCrossfades];
+    int m_numCrossfades;
 
     mixxx::SampleBuffer m_buffer1;
     mixxx::SampleBuffer m_buffer2;
+
+    CallbackProfiler* m_pCallbackProfiler;
 };
 
 
@@ -19,6 +19,30 @@ class EngineEffectRack;
 class EngineEffectChain;
 class EngineEffect;
 
+// The parameters of a single EngineEffectParameter, see
+// EffectsRequest::SET_PARAMETER_PARAMETERS.
+struct EffectParameterChange {
+    EngineEffect* pEffect;
+    int iParameter;
+    double minimum;
+    double maximum;
+    double default_value;
+    double value;
+};
+
+// A number of parameter changes that the engine applies together in one
+// callback, see EffectsRequest::SET_PARAMETER_PARAMETERS_BATCH.
+struct EffectParameterBatch {
+    static const int kMaxChanges = 256;
+
+    EffectParameterBatch()
+            : count(0) {
+    }
+
+    int count;
+    EffectParameterChange changes[kMaxChanges];
+};
+
 struct EffectsRequest {
     enum MessageType {
         // Messages for EngineEffectsManager
@@ -28,6 +52,10 @@ struct EffectsRequest {
         // Messages for EngineEffectRack
         ADD_CHAIN_TO_RACK,
         REMOVE_CHAIN_FROM_RACK,
+        // Replaces a chain of a rack with a chain that has been built
+        // completely on another thread, see StagedEffectChain. The response
+        // is delayed until the chain has crossfaded from the replaced chain.
+        REPLACE_CHAIN_IN_RACK,
 
         // Messages for EngineEffectChain
         SET_EFFECT_CHAIN_PARAMETERS,
@@ -42,6 +70,9 @@ struct EffectsRequest {
         SET_EFFECT_PARAMETERS,
         SET_PARAMETER_PARAMETERS,
 
+        // Messages for EngineEffectsManager that target several EngineEffects
+        SET_PARAMETER_PARAMETERS_BATCH,
+
         // Must come last.
         NUM_REQUEST_TYPES
     };
@@ -61,6 +92,7 @@ struct EffectsRequest {
         CLEAR_STRUCT(RemoveEffectRack);
         CLEAR_STRUCT(AddChainToRack);
         CLEAR_STRUCT(RemoveChainFromRack);
+        CLEAR_STRUCT(ReplaceChainInRack);
         CLEAR_STRUCT(EnableInputChannelForChain);
         CLEAR_STRUCT(DisableInputChannelForChain);
         CLEAR_STRUCT(AddEffectToChain);
@@ -68,6 +100,7 @@ struct EffectsRequest {
         CLEAR_STRUCT(SetEffectChainParameters);
         CLEAR_STRUCT(SetEffectParameters);
         CLEAR_STRUCT(SetParameterParameters);
+        CLEAR_STRUCT(SetParameterParametersBatch);
 #undef CLEAR_STRUCT
     }
 
@@ -79,6 +112,7 @@ struct EffectsRequest {
         // Used by:
         // - ADD_CHAIN_TO_RACK
         // - REMOVE_CHAIN_FROM_RACK
+        // - REPLACE_CHAIN_IN_RACK
         EngineEffectRack* pTargetRack;
         // Used by:
         // - ADD_EFFECT_TO_CHAIN
@@ -110,6 +144,12 @@ struct EffectsRequest {
             EngineEffectChain* pChain;
             int iIndex;
         } RemoveChainFromRack;
+        struct {
+            EngineEffectChain* pChain;
+            // May be null if the rack has no chain at iIndex
+            EngineEffectChain* pOldChain;
+            int iIndex;
+        } ReplaceChainInRack;
         struct {
             EffectStatesMapArray* pEffectStatesMapArray;
             const ChannelHandle* pChannelHandle;
@@ -136,6 +176,9 @@ struct EffectsRequest {
         struct {
             int iParameter;
         } SetParameterParameters;
+        struct {
+            EffectParameterBatch* pBatch;
+        } SetParameterParametersBatch;
     };
 
     // Used by SET_EFFECT_PARAMETER.
@@ -5,6 +5,7 @@
 #include "engine/cachingreader.h"
 #include "preferences/usersettings.h"
 #include "control/controlindicator.h"
+#include "control/controlinputtime.h"
 #include "control/controllinpotmeter.h"
 #include "control/controlproxy.h"
 #include "control/controlpotmeter.h"
@@ -14,6 +15,8 @@
 #include "engine/cuecontrol.h"
 #include "engine/enginebufferscalelinear.h"
 #include "engine/enginebufferscalerubberband.h"
+#include "engine/enginebufferscalerubberbandthreaded.h"
+#include "engine/enginebufferscalesinc.h"
 #include "engine/enginebufferscalest.h"
 #include "engine/enginechannel.h"
 #include "engine/enginecontrol.h"
@@ -68,6 +71,7 @@ EngineBuffer::EngineBuffer(QString group, UserSettingsPointer pConfig,
           m_reverse_old(false),
           m_pitch_old(0),
           m_baserate_old(0),
+          m_readerFramesPerTrackFrame_old(1.0),
           m_rate_old(0.),
           m_trackSamplesOld(-1),
           m_trackSampleRateOld(0),
@@ -80,11 +84,18 @@ EngineBuffer::EngineBuffer(QString group, UserSettingsPointer pConfig,
           m_pRepeat(NULL),
           m_startButton(NULL),
           m_endButton(NULL),
+          m_pScaleVarispeed(NULL),
+          m_pScaleRBThreaded(NULL),
+          m_pWorkerScheduler(NULL),
           m_bScalerOverride(false),
           m_iSeekQueued(SEEK_NONE),
           m_iSeekPhaseQueued(0),
           m_iEnableSyncQueued(SYNC_REQUEST_NONE),
           m_iSyncModeQueued(SYNC_INVALID),
+          m_queuedTriggerNanos(0),
+          m_bTriggeredSeekPending(false),
+          m_bTriggeredSeekInPhase(false),
+          m_triggeredSeekPosition(0.0),
           m_iTrackLoading(0),
           m_bPlayAfterLoading(false),
           m_iSampleRate(0),
@@ -178,6 +189,10 @@ EngineBuffer::EngineBuffer(QString group, UserSettingsPointer pConfig,
     m_pKeylockEngine->connectValueChanged(SLOT(slotKeylockEngineChanged(double)),
                                           Qt::DirectConnection);
 
+    m_pVarispeedEngine = new ControlProxy("[Master]", "varispeed_engine", this);
+    m_pVarispeedEngine->connectValueChanged(SLOT(slotVarispeedEngineChanged(double)),
+                                            Qt::DirectConnection);
+
     m_pTrackSamples = new ControlObject(ConfigKey(m_group, "track_samples"));
     m_pTrackSampleRate = new ControlObject(ConfigKey(m_group, "track_samplerate"));
 
@@ -242,19 +257,18 @@ EngineBuffer::EngineBuffer(QString group, UserSettingsPointer pConfig,
     addControl(m_pCueControl);
 
     m_pReadAheadManager = new ReadAheadManager(m_pReader,
-                                               m_pLoopingControl);
+                                               m_pLoopingControl,
+                                               JumpTargetBuffers::numTargetsForGroup(group, pConfig));
     m_pReadAheadManager->addRateControl(m_pRateControl);
 
     // Construct scaling objects
     m_pScaleLinear = new EngineBufferScaleLinear(m_pReadAheadManager);
+    m_pScaleSinc = new EngineBufferScaleSinc(m_pReadAheadManager);
     m_pScaleST = new EngineBufferScaleST(m_pReadAheadManager);
     m_pScaleRB = new EngineBufferScaleRubberBand(m_pReadAheadManager);
-    if (m_pKeylockEngine->get() == SOUNDTOUCH) {
-        m_pScaleKeylock = m_pScaleST;
-    } else {
-        m_pScaleKeylock = m_pScaleRB;
-    }
-    m_pScaleVinyl = m_pScaleLinear;
+    slotKeylockEngineChanged(m_pKeylockEngine->get());
+    slotVarispeedEngineChanged(m_pVarispeedEngine->get());
+    m_pScaleVinyl = m_pScaleVarispeed;
     m_pScale = m_pScaleVinyl;
     m_pScale->clear();
     m_bScalerChanged = true;
@@ -307,8 +321,10 @@ EngineBuffer::~EngineBuffer() {
     delete m_pTrackSampleRate;
 
     delete m_pScaleLinear;
+    delete m_pScaleSinc;
     delete m_pScaleST;
     delete m_pScaleRB;
+    delete m_pScaleRBThreaded;
 
     delete m_pKeylock;
     delete m_pEject;
@@ -387,6 +403,7 @@ void EngineBuffer::queueNewPlaypos(double newpos, enum SeekRequest seekType) {
         seekType = SEEK_STANDARD;
     }
     m_queuedSeekPosition.setValue(newpos);
+    m_queuedTriggerNanos.store(ControlInputTime::currentNanos());
     // set m_queuedPosition valid
     m_iSeekQueued = seekType;
 }
@@ -516,6 +533,9 @@ void EngineBuffer::slotTrackLoaded(TrackPointer pTrack,
     m_pause.lock();
     m_visualPlayPos->setInvalid();
     m_pCurrentTrack = pTrack;
+    m_pTrackSnapshot = pTrack->getEngineSnapshot();
+    setBeats(m_pTrackSnapshot->pBeats);
+    m_pReadAheadManager->clearJumpTargets();
     m_trackSampleRateOld = iTrackSampleRate;
     m_trackSamplesOld = iTrackNumSamples;
     m_pTrackSamples->set(iTrackNumSamples);
@@ -561,6 +581,9 @@ void EngineBuffer::ejectTrack() {
     m_pTrackSampleRate->set(0);
     TrackPointer pTrack = m_pCurrentTrack;
     m_pCurrentTrack.reset();
+    m_pTrackSnapshot.reset();
+    setBeats(BeatsPointer());
+    m_pReadAheadManager->clearJumpTargets();
     m_trackSampleRateOld = 0;
     m_trackSamplesOld = 0;
     m_playButton->set(0.0);
@@ -577,6 +600,72 @@ void EngineBuffer::ejectTrack() {
     }
 }
 
+void EngineBuffer::updateTrackSnapshot() {
+    if (!m_pCurrentTrack) {
+        return;
+    }
+    TrackEngineSnapshotPointer pSnapshot = m_pCurrentTrack->getEngineSnapshot();
+    if (pSnapshot == m_pTrackSnapshot) {
+        return;
+    }
+    if (pSnapshot->pBeats != m_pBeats) {
+        setBeats(pSnapshot->pBeats);
+    }
+    m_pTrackSnapshot = std::move(pSnapshot);
+}
+
+void EngineBuffer::setBeats(const BeatsPointer& pBeats) {
+    m_pBeats = pBeats;
+    // The snapshot of the former beats must not be mistaken for one of the
+    // new beats
+    m_beatSnapshot = BeatSnapshot();
+    m_beatCursor = BeatCursor();
+}
+
+void EngineBuffer::updateBeatSnapshot(double dPosition) {
+    m_beatSnapshot.position = dPosition;
+    if (!m_pBeats) {
+        m_beatSnapshot.pBeats = nullptr;
+        m_beatSnapshot.prevBeat = -1;
+        m_beatSnapshot.nextBeat = -1;
+        m_beatSnapshot.closestBeat = -1;
+        return;
+    }
+
+    // Most callbacks stay between the beats of the last one
+    // NOTE: Like in QuantizeControl this bypasses the epsilon of
+    // findPrevNextBeats()
+    if (m_beatSnapshot.pBeats != m_pBeats.data() ||
+            !m_beatSnapshot.hasBeatContext() ||
+            dPosition < m_beatSnapshot.prevBeat ||
+            dPosition > m_beatSnapshot.nextBeat) {
+        m_beatSnapshot.pBeats = m_pBeats.data();
+        if (!m_pBeats->findPrevNextBeats(dPosition,
+                &m_beatSnapshot.prevBeat, &m_beatSnapshot.nextBeat,
+                &m_beatCursor)) {
+            m_beatSnapshot.prevBeat = -1;
+            m_beatSnapshot.nextBeat = -1;
+        }
+    }
+
+    const double prevBeat = m_beatSnapshot.prevBeat;
+    const double nextBeat = m_beatSnapshot.nextBeat;
+    if (prevBeat == -1) {
+        m_beatSnapshot.closestBeat = nextBeat;
+    } else if (nextBeat == -1) {
+        m_beatSnapshot.closestBeat = prevBeat;
+    } else {
+        m_beatSnapshot.closestBeat =
+                (nextBeat - dPosition > dPosition - prevBeat) ?
+                        prevBeat : nextBeat;
+    }
+    if (!BpmControl::getBeatContextNoLookup(dPosition, prevBeat, nextBeat,
+            &m_beatSnapshot.beatLength, &m_beatSnapshot.beatFraction)) {
+        m_beatSnapshot.beatLength = 0.0;
+        m_beatSnapshot.beatFraction = 0.0;
+    }
+}
+
 void EngineBuffer::slotPassthroughChanged(double enabled) {
     if (enabled) {
         // If passthrough was enabled, stop playing the current track.
@@ -654,6 +743,7 @@ void EngineBuffer::slotControlPlayRequest(double v) {
     bool verifiedPlay = updateIndicatorsAndModifyPlay(v > 0.0);
 
     if (!oldPlay && verifiedPlay) {
+        m_queuedTriggerNanos.store(ControlInputTime::currentNanos());
         if (m_pQuantize->get() > 0.0
 #ifdef __VINYLCONTROL__
                 && m_pVinylControlControl && !m_pVinylControlControl->isEnabled()
@@ -718,11 +808,39 @@ void EngineBuffer::slotKeylockEngineChanged(double dIndex) {
     KeylockEngine engine = static_cast<KeylockEngine>(iEngine);
     if (engine == SOUNDTOUCH) {
         m_pScaleKeylock = m_pScaleST;
+    } else if (engine == RUBBERBAND_THREADED) {
+        if (!m_pScaleRBThreaded) {
+            EngineBufferScaleRubberBandThreaded* pScaleRBThreaded =
+                    new EngineBufferScaleRubberBandThreaded(m_pReadAheadManager);
+            pScaleRBThreaded->setScheduler(m_pWorkerScheduler);
+            if (m_iSampleRate > 0) {
+                pScaleRBThreaded->setSampleRate(m_iSampleRate);
+            }
+            m_pScaleRBThreaded = pScaleRBThreaded;
+        }
+        m_pScaleKeylock = m_pScaleRBThreaded;
     } else {
         m_pScaleKeylock = m_pScaleRB;
     }
 }
 
+void EngineBuffer::slotVarispeedEngineChanged(double dIndex) {
+    if (m_bScalerOverride) {
+        return;
+    }
+    int iEngine = static_cast<int>(dIndex);
+    VarispeedEngine engine = static_cast<VarispeedEngine>(iEngine);
+    if (engine == VARISPEED_SINC_MEDIUM) {
+        m_pScaleSinc->setQuality(EngineBufferScaleSinc::Quality::Medium);
+        m_pScaleVarispeed = m_pScaleSinc;
+    } else if (engine == VARISPEED_SINC_HIGH) {
+        m_pScaleSinc->setQuality(EngineBufferScaleSinc::Quality::High);
+        m_pScaleVarispeed = m_pScaleSinc;
+    } else {
+        m_pScaleVarispeed = m_pScaleLinear;
+    }
+}
+
 void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     // Bail if we receive a buffer size with incomplete sample frames. Assert in debug builds.
     VERIFY_OR_DEBUG_ASSERT((iBufferSize % kSamplesPerFrame) == 0) {
@@ -748,8 +866,14 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     // We do this even if rubberband is not active.
     if (sample_rate != m_iSampleRate) {
         m_pScaleLinear->setSampleRate(sample_rate);
+        m_pScaleSinc->setSampleRate(sample_rate);
         m_pScaleST->setSampleRate(sample_rate);
         m_pScaleRB->setSampleRate(sample_rate);
+        EngineBufferScaleRubberBandThreaded* pScaleRBThreaded =
+                m_pScaleRBThreaded;
+        if (pScaleRBThreaded) {
+            pScaleRBThreaded->setSampleRate(sample_rate);
+        }
         m_iSampleRate = sample_rate;
     }
 
@@ -757,6 +881,8 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     if (!bTrackLoading && m_pause.tryLock()) {
         ScopedTimer t("EngineBuffer::process_pauselock");
 
+        updateTrackSnapshot();
+
         double baserate = 0.0;
         if (sample_rate > 0) {
             baserate = ((double)m_trackSampleRateOld / sample_rate);
@@ -780,7 +906,8 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
         processSyncRequests();
 
         // Note: This may effects the m_filepos_play, play, scaler and crossfade buffer
-        processSeek(paused);
+        const SINT triggerOffsetFrames = takeTriggerOffsetFrames(iBufferSize);
+        processSeek(paused, triggerOffsetFrames);
 
         // speed is the ratio between track-time and real-time
         // (1.0 being normal rate. 2.0 plays at 2x speed -- 2 track seconds
@@ -845,6 +972,11 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
             }
         }
 
+        if (!m_bScalerOverride) {
+            // Only the linear scaler supports ramping through zero
+            m_pScaleVinyl = is_scratching ? m_pScaleLinear : m_pScaleVarispeed;
+        }
+
         if (speed != 0.0) {
             // Do not switch scaler when we have no transport
             enableIndependentPitchTempoScaling(useIndependentPitchAndTempoScaling,
@@ -906,7 +1038,12 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
         // If the baserate, speed, or pitch has changed, we need to update the
         // scaler. Also, if we have changed scalers then we need to update the
         // scaler.
+        // Differs from 1 if the reader has converted the sample rate of
+        // the track, the scaler reads the samples of the reader
+        const double readerFramesPerTrackFrame =
+                m_pReader->readerFramesPerTrackFrame();
         if (baserate != m_baserate_old || speed != m_speed_old ||
+                readerFramesPerTrackFrame != m_readerFramesPerTrackFrame_old ||
                 pitchRatio != m_pitch_old || tempoRatio != m_tempo_ratio_old ||
                 m_bScalerChanged) {
             // The rate returned by the scale object can be different from the
@@ -920,6 +1057,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
             // For the other, crossfade forward and backward samples
             if ((m_speed_old * speed < 0) &&  // Direction has changed!
                     (m_pScale != m_pScaleVinyl || // only m_pScaleLinear supports going though 0
+                           m_pScale == m_pScaleSinc ||
                            m_reverse_old != is_reverse)) { // no pitch change when reversing
                 //XXX: Trying to force RAMAN to read from correct
                 //     playpos when rate changes direction - Albert
@@ -929,6 +1067,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
             }
 
             m_baserate_old = baserate;
+            m_readerFramesPerTrackFrame_old = readerFramesPerTrackFrame;
             m_speed_old = speed;
             m_pitch_old = pitchRatio;
             m_tempo_ratio_old = tempoRatio;
@@ -939,7 +1078,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
             // master samplerate), the deck speed, the pitch shift, and whether
             // the deck speed should affect the pitch.
 
-            m_pScale->setScaleParameters(baserate,
+            m_pScale->setScaleParameters(baserate * readerFramesPerTrackFrame,
                                          &speed,
                                          &pitchRatio);
 
@@ -972,32 +1111,33 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
             bCurBufferPaused = true;
         }
 
-        m_rate_old = rate;
-
         // If the buffer is not paused, then scale the audio.
+        // Note: m_rate_old is still the rate of the last buffer here, which
+        // tells setNewPlaypos() in processTriggeredSeek() whether to crossfade
         if (!bCurBufferPaused) {
-            // Perform scaling of Reader buffer into buffer.
-            double framesRead =
-                    m_pScale->scaleBuffer(pOutput, iBufferSize);
-            // TODO(XXX): The result framesRead might not be an integer value.
-            // Converting to samples here does not make sense. All positional
-            // calculations should be done in frames instead of samples! Otherwise
-            // rounding errors might occur when converting from samples back to
-            // frames later.
-            double samplesRead = framesRead * kSamplesPerFrame;
-
-            if (m_bScalerOverride) {
-                // If testing, we don't have a real log so we fake the position.
-                m_filepos_play += samplesRead;
-            } else {
-                // Adjust filepos_play by the amount we processed.
-                m_filepos_play =
-                        m_pReadAheadManager->getFilePlaypositionFromLog(
-                                m_filepos_play, samplesRead);
+            // A start or a seek that was triggered during the last callback
+            // period begins at the matching frame of this buffer. Before it
+            // the deck is silent if it was stopped, or keeps playing from
+            // the old position.
+            int triggerOffsetSamples = 0;
+            if (triggerOffsetFrames > 0 && !m_bCrossfadeReady &&
+                    (m_rate_old == 0.0 || m_bTriggeredSeekPending)) {
+                triggerOffsetSamples = triggerOffsetFrames * kSamplesPerFrame;
+                if (m_rate_old == 0.0) {
+                    SampleUtil::clear(pOutput, triggerOffsetSamples);
+                } else {
+                    scaleIntoBuffer(pOutput, triggerOffsetSamples);
+                }
             }
+            processTriggeredSeek(rate, triggerOffsetSamples / kSamplesPerFrame);
+
+            CSAMPLE* pTriggeredOutput = pOutput + triggerOffsetSamples;
+            const int triggeredBufferSize = iBufferSize - triggerOffsetSamples;
+            scaleIntoBuffer(pTriggeredOutput, triggeredBufferSize);
             if (m_bCrossfadeReady) {
                 SampleUtil::linearCrossfadeBuffers(
-                        pOutput, m_pCrossfadeBuffer, pOutput, iBufferSize);
+                        pTriggeredOutput, m_pCrossfadeBuffer,
+                        pTriggeredOutput, triggeredBufferSize);
             }
             // Note: we do not fade here if we pass the end or the start of
             // the track in reverse direction
@@ -1007,6 +1147,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
             // or start may pass in the middle of the buffer.
         } else {
             // Pause
+            processTriggeredSeek(rate, 0);
             if (m_bCrossfadeReady) {
                 // We don't ramp here, since EnginePregain handles fades
                 // from and to speed == 0
@@ -1016,6 +1157,10 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
             }
         }
 
+        m_rate_old = rate;
+
+        // Shared by all controls for this callback
+        updateBeatSnapshot(m_filepos_play);
         QListIterator<EngineControl*> it(m_engineControls);
         while (it.hasNext()) {
             EngineControl* pControl = it.next();
@@ -1092,6 +1237,28 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     m_bCrossfadeReady = false;
 }
 
+void EngineBuffer::scaleIntoBuffer(CSAMPLE* pOutput, const int iBufferSize) {
+    // Perform scaling of Reader buffer into buffer.
+    double framesRead =
+            m_pScale->scaleBuffer(pOutput, iBufferSize);
+    // TODO(XXX): The result framesRead might not be an integer value.
+    // Converting to samples here does not make sense. All positional
+    // calculations should be done in frames instead of samples! Otherwise
+    // rounding errors might occur when converting from samples back to
+    // frames later.
+    double samplesRead = framesRead * kSamplesPerFrame;
+
+    if (m_bScalerOverride) {
+        // If testing, we don't have a real log so we fake the position.
+        m_filepos_play += samplesRead;
+    } else {
+        // Adjust filepos_play by the amount we processed.
+        m_filepos_play =
+                m_pReadAheadManager->getFilePlaypositionFromLog(
+                        m_filepos_play, samplesRead);
+    }
+}
+
 void EngineBuffer::processSlip(int iBufferSize) {
     // Do a single read from m_bSlipEnabled so we don't run in to race conditions.
     bool enabled = static_cast<bool>(load_atomic(m_slipEnabled));
@@ -1141,7 +1308,13 @@ void EngineBuffer::processSyncRequests() {
     }
 }
 
-void EngineBuffer::processSeek(bool paused) {
+SINT EngineBuffer::takeTriggerOffsetFrames(const int iBufferSize) {
+    const qint64 triggerNanos = m_queuedTriggerNanos.fetchAndStoreAcquire(0);
+    return ControlInputTime::frameOffsetInCallback(
+            triggerNanos, iBufferSize / kSamplesPerFrame);
+}
+
+void EngineBuffer::processSeek(bool paused, SINT triggerOffsetFrames) {
     // We need to read position just after reading seekType, to ensure that we
     // read the matching position to seek_typ or a position from a new (second)
     // seek just queued from another thread
@@ -1173,12 +1346,41 @@ void EngineBuffer::processSeek(bool paused) {
             return;
     }
 
-    if ((seekType & SEEK_PHASE) && !paused && m_pQuantize->toBool()) {
+    const bool bInPhase = (seekType & SEEK_PHASE) && !paused &&
+            m_pQuantize->toBool();
+    if (bInPhase) {
         position = m_pBpmControl->getNearestPositionInPhase(position, true, true);
     }
 
     double newPlayFrame = position / kSamplesPerFrame;
     position = round(newPlayFrame) * kSamplesPerFrame;
+    // A deck at the end of the track would not play this buffer before
+    // the seek, so the seek is applied right away
+    if (triggerOffsetFrames > 0 && !paused &&
+            m_filepos_play < m_trackSamplesOld) {
+        m_bTriggeredSeekPending = true;
+        m_bTriggeredSeekInPhase = bInPhase;
+        m_triggeredSeekPosition = position;
+        return;
+    }
+    if (position != m_filepos_play) {
+        setNewPlaypos(position);
+    }
+}
+
+void EngineBuffer::processTriggeredSeek(double rate, SINT offsetFrames) {
+    if (!m_bTriggeredSeekPending) {
+        return;
+    }
+    m_bTriggeredSeekPending = false;
+
+    double position = m_triggeredSeekPosition;
+    if (m_bTriggeredSeekInPhase) {
+        // The phase has been matched for the start of the buffer, so the
+        // seek lands on the beat if it is shifted like the other decks have
+        // moved until the trigger
+        position += round(offsetFrames * rate) * kSamplesPerFrame;
+    }
     if (position != m_filepos_play) {
         setNewPlaypos(position);
     }
@@ -1259,7 +1461,7 @@ void EngineBuffer::hintReader(const double dRate) {
     if (m_bSlipEnabledProcessing) {
         Hint hint;
         hint.frame = SampleUtil::floorPlayPosToFrame(m_dSlipPosition);
-        hint.priority = 1;
+        hint.priority = Hint::kPriorityPlayPosition;
         if (m_dSlipRate >= 0) {
             hint.frameCount = Hint::kFrameCountForward;
         } else {
@@ -1272,6 +1474,7 @@ void EngineBuffer::hintReader(const double dRate) {
         pControl->hintReader(&m_hintList);
     }
     m_pReader->hintAndMaybeWake(m_hintList);
+    m_pReadAheadManager->updateJumpTargets(m_hintList);
 }
 
 // WARNING: This method runs in the GUI thread
@@ -1298,6 +1501,10 @@ void EngineBuffer::addControl(EngineControl* pControl) {
 
 void EngineBuffer::bindWorkers(EngineWorkerScheduler* pWorkerScheduler) {
     m_pReader->setScheduler(pWorkerScheduler);
+    m_pWorkerScheduler = pWorkerScheduler;
+    if (m_pScaleRBThreaded) {
+        m_pScaleRBThreaded->setScheduler(pWorkerScheduler);
+    }
 }
 
 bool EngineBuffer::isTrackLoaded() {
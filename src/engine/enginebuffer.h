@@ -20,8 +20,10 @@
 
 #include <QMutex>
 #include <QAtomicInt>
+#include <QAtomicInteger>
 #include <gtest/gtest_prod.h>
 
+#include "engine/beatsnapshot.h"
 #include "engine/cachingreader.h"
 #include "preferences/usersettings.h"
 #include "control/controlvalue.h"
@@ -57,8 +59,10 @@ class ControlTTRotary;
 class ControlPotmeter;
 class EngineBufferScale;
 class EngineBufferScaleLinear;
+class EngineBufferScaleSinc;
 class EngineBufferScaleST;
 class EngineBufferScaleRubberBand;
+class EngineBufferScaleRubberBandThreaded;
 class EngineSync;
 class EngineWorkerScheduler;
 class VisualPlayPosition;
@@ -100,9 +104,18 @@ class EngineBuffer : public EngineObject {
     enum KeylockEngine {
         SOUNDTOUCH,
         RUBBERBAND,
+        RUBBERBAND_THREADED,
         KEYLOCK_ENGINE_COUNT,
     };
 
+    // The scalers when the pitch follows the tempo
+    enum VarispeedEngine {
+        VARISPEED_LINEAR,
+        VARISPEED_SINC_MEDIUM,
+        VARISPEED_SINC_HIGH,
+        VARISPEED_ENGINE_COUNT,
+    };
+
     EngineBuffer(QString _group, UserSettingsPointer pConfig,
                  EngineChannel* pChannel, EngineMaster* pMixingEngine);
     virtual ~EngineBuffer();
@@ -137,6 +150,17 @@ class EngineBuffer : public EngineObject {
     double getVisualPlayPos();
     double getTrackSamples();
 
+    // The beats around the play position of the current callback. Must only
+    // be called from the engine thread.
+    const BeatSnapshot& getBeatSnapshot() const {
+        return m_beatSnapshot;
+    }
+    // The properties of the loaded track as of the current callback, or
+    // null if no track is loaded. Must only be called from the engine thread.
+    const TrackEngineSnapshot* getTrackSnapshot() const {
+        return m_pTrackSnapshot.get();
+    }
+
     void collectFeatures(GroupFeatureState* pGroupFeatures) const;
 
     // For dependency injection of readers.
@@ -155,6 +179,21 @@ class EngineBuffer : public EngineObject {
             return tr("Soundtouch (faster)");
         case RUBBERBAND:
             return tr("Rubberband (better)");
+        case RUBBERBAND_THREADED:
+            return tr("Rubberband (threaded)");
+        default:
+            return tr("Unknown (bad value)");
+        }
+    }
+
+    static QString getVarispeedEngineName(VarispeedEngine engine) {
+        switch (engine) {
+        case VARISPEED_LINEAR:
+            return tr("Linear (faster)");
+        case VARISPEED_SINC_MEDIUM:
+            return tr("Sinc (better)");
+        case VARISPEED_SINC_HIGH:
+            return tr("Sinc (best)");
         default:
             return tr("Unknown (bad value)");
         }
@@ -177,6 +216,7 @@ class EngineBuffer : public EngineObject {
     void slotControlSeekExact(double);
     void slotControlSlip(double);
     void slotKeylockEngineChanged(double);
+    void slotVarispeedEngineChanged(double);
 
     void slotEjectTrack(double);
 
@@ -203,6 +243,15 @@ class EngineBuffer : public EngineObject {
 
     void updateIndicators(double rate, int iBufferSize);
 
+    // Looks up the beats around the position, unless it is still between
+    // the beats of the last lookup
+    void updateBeatSnapshot(double dPosition);
+    // Must be called with m_pause locked
+    void setBeats(const BeatsPointer& pBeats);
+    // Picks up the latest snapshot of the loaded track, must be called with
+    // m_pause locked
+    void updateTrackSnapshot();
+
     void hintReader(const double rate);
 
     void ejectTrack();
@@ -220,8 +269,22 @@ class EngineBuffer : public EngineObject {
     // Reset buffer playpos and set file playpos.
     void setNewPlaypos(double playpos);
 
+    // Scales the next iBufferSize samples into pOutput and advances the
+    // play position
+    void scaleIntoBuffer(CSAMPLE* pOutput, const int iBufferSize);
+
     void processSyncRequests();
-    void processSeek(bool paused);
+    // A seek that has been triggered by controller input before this
+    // callback is not applied here if the deck plays, but left to
+    // processTriggeredSeek() at the frame that matches the arrival of the
+    // input
+    void processSeek(bool paused, SINT triggerOffsetFrames);
+    // Applies the seek that processSeek() has left, offsetFrames into the
+    // buffer at the given rate
+    void processTriggeredSeek(double rate, SINT offsetFrames);
+    // Returns the frame of this callback at which the controller input that
+    // has requested the latest seek or start takes effect
+    SINT takeTriggerOffsetFrames(const int iBufferSize);
 
     bool updateIndicatorsAndModifyPlay(bool newPlay);
     void verifyPlay();
@@ -285,6 +348,8 @@ class EngineBuffer : public EngineObject {
     // The previous callback's baserate. Used to check if the scaler parameters
     // need updating.
     double m_baserate_old;
+    // The previous callback's CachingReader::readerFramesPerTrackFrame()
+    double m_readerFramesPerTrackFrame_old;
 
     // Copy of rate_exchange, used to check if rate needs to be updated
     double m_rate_old;
@@ -332,6 +397,7 @@ class EngineBuffer : public EngineObject {
     ControlPotmeter* m_playposSlider;
     ControlProxy* m_pSampleRate;
     ControlProxy* m_pKeylockEngine;
+    ControlProxy* m_pVarispeedEngine;
     ControlPushButton* m_pKeylock;
 
     // This ControlProxys is created as parent to this and deleted by
@@ -361,11 +427,20 @@ class EngineBuffer : public EngineObject {
     // ScaleST and ScaleRB during a single callback.
     EngineBufferScale* volatile m_pScaleKeylock;
 
+    // The varispeed engine is configurable like the keylock engine. It is
+    // replaced by m_pScaleLinear for scratching.
+    EngineBufferScale* volatile m_pScaleVarispeed;
+
     // Object used for vinyl-style interpolation scaling of the audio
     EngineBufferScaleLinear* m_pScaleLinear;
+    // Object used for varispeed scaling of the audio without aliasing
+    EngineBufferScaleSinc* m_pScaleSinc;
     // Objects used for pitch-indep time stretch (key lock) scaling of the audio
     EngineBufferScaleST* m_pScaleST;
     EngineBufferScaleRubberBand* m_pScaleRB;
+    // Starts a worker thread, so it is only created when selected
+    EngineBufferScaleRubberBandThreaded* volatile m_pScaleRBThreaded;
+    EngineWorkerScheduler* m_pWorkerScheduler;
 
     // Indicates whether the scaler has changed since the last process()
     bool m_bScalerChanged;
@@ -377,6 +452,13 @@ class EngineBuffer : public EngineObject {
     QAtomicInt m_iEnableSyncQueued;
     QAtomicInt m_iSyncModeQueued;
     ControlValueAtomic<double> m_queuedSeekPosition;
+    // The arrival time of the controller input that has queued the latest
+    // seek or start, see ControlInputTime
+    QAtomicInteger<qint64> m_queuedTriggerNanos;
+    // The seek that processSeek() has left for processTriggeredSeek()
+    bool m_bTriggeredSeekPending;
+    bool m_bTriggeredSeekInPhase;
+    double m_triggeredSeekPosition;
 
     // Is true if the previous buffer was silent due to pausing
     QAtomicInt m_iTrackLoading;
@@ -386,6 +468,15 @@ class EngineBuffer : public EngineObject {
     int m_iSampleRate;
 
     TrackPointer m_pCurrentTrack;
+    // Only changed with m_pause locked, so they are not changed while the
+    // engine processes this buffer
+    BeatsPointer m_pBeats;
+    BeatCursor m_beatCursor;
+    BeatSnapshot m_beatSnapshot;
+    // Picked up from the track once per callback, so the engine never
+    // waits for the lock of the track, e.g. while the analyzer sets the
+    // beats
+    TrackEngineSnapshotPointer m_pTrackSnapshot;
 #ifdef __SCALER_DEBUG__
     QFile df;
     QTextStream writer;
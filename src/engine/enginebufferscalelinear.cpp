@@ -7,6 +7,45 @@
 #include "util/math.h"
 #include "util/sample.h"
 
+namespace {
+
+// Returns the number of stereo frames at the positions
+// firstFrame + k * rate that can be interpolated from the buffer, whose
+// floor and ceil samples are both within the buffer.
+inline SINT framesWithinBuffer(double firstFrame, double rate, SINT bufferSize) {
+    // The ceil sample of the last frame has to be in the buffer
+    const SINT endFrame = (bufferSize - 2) / 2;
+    if (endFrame <= 0 || firstFrame >= endFrame) {
+        return 0;
+    }
+    // The last frame is left to the scalar loop to be safe from rounding
+    return math_max<SINT>(
+            static_cast<SINT>((endFrame - firstFrame) / rate) - 1, 0);
+}
+
+// Interpolates stereo frames at a steady rate. The scalar loop handles
+// the rate ramps and the buffer boundaries, so the iterations of this
+// loop are independent and without any branches that would prevent the
+// compiler from vectorizing it.
+inline void interpolateSteadyRate(
+        CSAMPLE* __restrict pOutput,
+        const CSAMPLE* __restrict pInput,
+        double firstFrame,
+        double rate,
+        SINT frameCount) {
+    for (SINT k = 0; k < frameCount; ++k) {
+        const double frame = firstFrame + k * rate;
+        // Truncation is the floor of positive positions
+        const SINT floorFrame = static_cast<SINT>(frame);
+        const CSAMPLE frac = static_cast<CSAMPLE>(frame - floorFrame);
+        const CSAMPLE* pFloor = pInput + 2 * floorFrame;
+        pOutput[2 * k] = pFloor[0] + frac * (pFloor[2] - pFloor[0]);
+        pOutput[2 * k + 1] = pFloor[1] + frac * (pFloor[3] - pFloor[1]);
+    }
+}
+
+} // anonymous namespace
+
 EngineBufferScaleLinear::EngineBufferScaleLinear(ReadAheadManager *pReadAheadManager)
     : m_pReadAheadManager(pReadAheadManager),
       m_bufferInt(SampleUtil::alloc(kiLinearScaleReadAheadLength)),
@@ -238,6 +277,26 @@ SINT EngineBufferScaleLinear::do_scale(CSAMPLE* buf, SINT buf_size) {
 
     // Hot frame loop
     while (i < buf_size) {
+        if (rate_delta_abs == 0 && rate_add > 0 && m_dNextFrame >= 0) {
+            // Steady rate: All frames that are within the buffer at once
+            const SINT steadyFrames = math_min<SINT>(
+                    framesWithinBuffer(m_dNextFrame, rate_add, m_bufferIntSize),
+                    getAudioSignal().samples2frames(buf_size - i));
+            if (steadyFrames > 0) {
+                interpolateSteadyRate(
+                        &buf[i], m_bufferInt, m_dNextFrame, rate_add,
+                        steadyFrames);
+                m_dCurrentFrame = m_dNextFrame + (steadyFrames - 1) * rate_add;
+                const SINT lastFloorSample = getAudioSignal().frames2samples(
+                        static_cast<SINT>(m_dCurrentFrame));
+                m_floorSampleOld[0] = m_bufferInt[lastFloorSample];
+                m_floorSampleOld[1] = m_bufferInt[lastFloorSample + 1];
+                m_dNextFrame = m_dNextFrame + steadyFrames * rate_add;
+                i += getAudioSignal().frames2samples(steadyFrames);
+                continue;
+            }
+        }
+
         // shift indicies
         m_dCurrentFrame = m_dNextFrame;
 
@@ -0,0 +1,455 @@
+#include "engine/enginebufferscalerubberbandthreaded.h"
+
+#include <rubberband/RubberBandStretcher.h>
+
+#include <QtDebug>
+
+#include <algorithm>
+
+#include "engine/enginebufferscalest.h"
+#include "engine/readaheadmanager.h"
+#include "util/compatibility.h"
+#include "util/counter.h"
+#include "util/defs.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+using RubberBand::RubberBandStretcher;
+
+namespace {
+
+// This is the default increment from RubberBand 1.8.1.
+const SINT kRubberBandBlockSize = 256;
+
+// The maximum number of frames that are retrieved from RubberBand at once
+const SINT kRetrieveBlockSize = 1024;
+
+// The number of samples that can be in flight in each direction
+const int kFIFOSize = 32768;
+
+// The number of callback buffers that the worker is kept ahead
+const SINT kLookaheadBuffers = 3;
+
+// The fallback scaler reads blocks of this size from the ReadAheadManager
+const SINT kFallbackReadFrames = 1024;
+
+// The unscaled frames that are played by the fallback scaler while the
+// worker is priming. If the worker cannot catch up within this number of
+// frames the pipeline is restarted.
+const SINT kFallbackReaderFrames = 32768;
+
+}  // namespace
+
+// Serves the fallback scaler either directly from the ReadAheadManager or,
+// while priming, from a copy of the samples that have been passed to the
+// worker. Only getNextSamples() is used by the scaler, so the default
+// constructor of ReadAheadManager is sufficient.
+class RubberBandFallbackReader : public ReadAheadManager {
+  public:
+    explicit RubberBandFallbackReader(ReadAheadManager* pReadAheadManager)
+            : m_pReadAheadManager(pReadAheadManager),
+              m_pBuffer(SampleUtil::alloc(kFallbackReaderFrames * 2)),
+              m_readPosition(0),
+              m_writePosition(0),
+              m_bPriming(false) {
+    }
+    ~RubberBandFallbackReader() override {
+        SampleUtil::free(m_pBuffer);
+    }
+
+    SINT getNextSamples(double dRate, CSAMPLE* buffer,
+            SINT requested_samples) override {
+        if (!m_bPriming) {
+            return m_pReadAheadManager->getNextSamples(
+                    dRate, buffer, requested_samples);
+        }
+        const SINT samples = math_min(requested_samples, readAvailable());
+        SampleUtil::copy(buffer, m_pBuffer + m_readPosition, samples);
+        m_readPosition += samples;
+        return samples;
+    }
+
+    void setPriming(bool bPriming) {
+        m_bPriming = bPriming;
+        m_readPosition = 0;
+        m_writePosition = 0;
+    }
+
+    SINT readAvailable() const {
+        return m_writePosition - m_readPosition;
+    }
+    SINT writeAvailable() const {
+        return kFallbackReaderFrames * 2 - readAvailable();
+    }
+
+    void write(const CSAMPLE* pSamples, SINT samples) {
+        DEBUG_ASSERT(samples <= writeAvailable());
+        if (m_writePosition + samples > kFallbackReaderFrames * 2) {
+            // Move the unread samples to the front
+            const SINT available = readAvailable();
+            std::copy(m_pBuffer + m_readPosition,
+                    m_pBuffer + m_writePosition, m_pBuffer);
+            m_readPosition = 0;
+            m_writePosition = available;
+        }
+        SampleUtil::copy(m_pBuffer + m_writePosition, pSamples, samples);
+        m_writePosition += samples;
+    }
+
+  private:
+    ReadAheadManager* m_pReadAheadManager;
+    CSAMPLE* m_pBuffer;
+    SINT m_readPosition;
+    SINT m_writePosition;
+    bool m_bPriming;
+};
+
+EngineBufferScaleRubberBandWorker::EngineBufferScaleRubberBandWorker()
+        : EngineWorker(Priority::High),
+          m_iSampleRate(0),
+          m_inputFIFO(kFIFOSize),
+          m_outputFIFO(kFIFOSize),
+          m_interleaved(SampleUtil::alloc(kRetrieveBlockSize * 2)),
+          m_requestedSampleRate(0),
+          m_requestedResetGeneration(0),
+          m_acknowledgedResetGeneration(0),
+          m_latencyFrames(0) {
+    m_deinterleaved[0] = SampleUtil::alloc(kRetrieveBlockSize);
+    m_deinterleaved[1] = SampleUtil::alloc(kRetrieveBlockSize);
+}
+
+EngineBufferScaleRubberBandWorker::~EngineBufferScaleRubberBandWorker() {
+    SampleUtil::free(m_interleaved);
+    SampleUtil::free(m_deinterleaved[0]);
+    SampleUtil::free(m_deinterleaved[1]);
+}
+
+bool EngineBufferScaleRubberBandWorker::runOnce() {
+    const int requests = workRequests();
+    const int generation = m_requestedResetGeneration.loadAcquire();
+    if (generation != m_acknowledgedResetGeneration.load()) {
+        reset();
+        m_acknowledgedResetGeneration.storeRelease(generation);
+        return true;
+    }
+    if (processBlock()) {
+        return true;
+    }
+    workDone(requests);
+    return false;
+}
+
+int EngineBufferScaleRubberBandWorker::requestReset(SINT iSampleRate) {
+    m_requestedSampleRate.store(iSampleRate);
+    return m_requestedResetGeneration.fetchAndAddRelease(1) + 1;
+}
+
+void EngineBufferScaleRubberBandWorker::reset() {
+    // The engine does not write any input until the reset has been
+    // acknowledged, everything in the FIFO is outdated.
+    m_inputFIFO.flushReadData(m_inputFIFO.readAvailable());
+
+    const SINT iSampleRate = m_requestedSampleRate.load();
+    if (iSampleRate <= 0) {
+        m_pRubberBand.reset();
+        m_iSampleRate = 0;
+        m_latencyFrames.store(0);
+        return;
+    }
+    if (!m_pRubberBand || iSampleRate != m_iSampleRate) {
+        m_pRubberBand = std::make_unique<RubberBandStretcher>(
+                iSampleRate, 2, RubberBandStretcher::OptionProcessRealTime);
+        m_pRubberBand->setMaxProcessSize(kRubberBandBlockSize);
+        // Setting the time ratio to a very high value will cause RubberBand
+        // to preallocate buffers large enough to (almost certainly)
+        // avoid memory reallocations during playback.
+        m_pRubberBand->setTimeRatio(2.0);
+        m_pRubberBand->setTimeRatio(1.0);
+        m_appliedParameters = RubberBandScaleParameters();
+        m_iSampleRate = iSampleRate;
+    } else {
+        m_pRubberBand->reset();
+    }
+    applyScaleParameters();
+    m_latencyFrames.store(static_cast<int>(m_pRubberBand->getLatency()));
+}
+
+void EngineBufferScaleRubberBandWorker::applyScaleParameters() {
+    const RubberBandScaleParameters parameters = m_parameters.getValue();
+    if (parameters == m_appliedParameters) {
+        return;
+    }
+    // RubberBand handles checking for whether the changes are no-ops.
+    m_pRubberBand->setPitchScale(parameters.pitchScale);
+    m_pRubberBand->setTimeRatio(parameters.timeRatio);
+
+    // See EngineBufferScaleRubberBand::setScaleParameters(). The tempo
+    // reported to the engine is not adjusted.
+    double timeRatioInverse = 1.0 / parameters.timeRatio;
+    if (m_pRubberBand->getInputIncrement() == 0) {
+        qWarning() << "EngineBufferScaleRubberBandWorker inputIncrement is 0."
+                   << "Taking evasive action.";
+        while (m_pRubberBand->getInputIncrement() == 0) {
+            timeRatioInverse += 0.001;
+            m_pRubberBand->setTimeRatio(1.0 / timeRatioInverse);
+        }
+    }
+    m_appliedParameters = parameters;
+}
+
+bool EngineBufferScaleRubberBandWorker::processBlock() {
+    if (!m_pRubberBand) {
+        return false;
+    }
+    applyScaleParameters();
+
+    const SINT available = m_pRubberBand->available();
+    if (available > 0) {
+        const SINT frames = math_min(math_min(available, kRetrieveBlockSize),
+                m_outputFIFO.writeAvailable() / 2);
+        if (frames <= 0) {
+            // Wait until the engine has consumed some output
+            return false;
+        }
+        const SINT received = m_pRubberBand->retrieve(
+                (float* const*)m_deinterleaved, frames);
+        SampleUtil::interleaveBuffer(m_interleaved,
+                m_deinterleaved[0], m_deinterleaved[1], received);
+        m_outputFIFO.write(m_interleaved, received * 2);
+        return received > 0;
+    }
+
+    SINT framesRequired = m_pRubberBand->getSamplesRequired();
+    if (framesRequired == 0) {
+        // rubberband 1.3 can report 0 samples needed forever although
+        // nothing is available, see EngineBufferScaleRubberBand.
+        framesRequired = kRubberBandBlockSize;
+    }
+    const SINT frames = math_min(math_min(framesRequired, kRubberBandBlockSize),
+            m_inputFIFO.readAvailable() / 2);
+    if (frames <= 0) {
+        // Wait for more input
+        return false;
+    }
+    m_inputFIFO.read(m_interleaved, frames * 2);
+    SampleUtil::deinterleaveBuffer(m_deinterleaved[0], m_deinterleaved[1],
+            m_interleaved, frames);
+    m_pRubberBand->process((const float* const*)m_deinterleaved, frames, false);
+    return true;
+}
+
+EngineBufferScaleRubberBandThreaded::EngineBufferScaleRubberBandThreaded(
+        ReadAheadManager* pReadAheadManager)
+        : m_pReadAheadManager(pReadAheadManager),
+          m_pFallbackReader(std::make_unique<RubberBandFallbackReader>(
+                  pReadAheadManager)),
+          m_pScaleST(std::make_unique<EngineBufferScaleST>(
+                  m_pFallbackReader.get())),
+          m_state(State::Reset),
+          m_resetGeneration(0),
+          m_primingOutputFrames(0),
+          m_pendingInputFrames(0.0),
+          m_discardedInputFrames(0.0),
+          m_buffer_back(SampleUtil::alloc(MAX_BUFFER_LEN)),
+          m_bBackwards(false) {
+    resetPipeline(false);
+}
+
+EngineBufferScaleRubberBandThreaded::~EngineBufferScaleRubberBandThreaded() {
+    m_worker.quitWait();
+    SampleUtil::free(m_buffer_back);
+}
+
+void EngineBufferScaleRubberBandThreaded::setScheduler(
+        EngineWorkerScheduler* pScheduler) {
+    m_worker.setScheduler(pScheduler);
+}
+
+void EngineBufferScaleRubberBandThreaded::setScaleParameters(double base_rate,
+                                                             double* pTempoRatio,
+                                                             double* pPitchRatio) {
+    // Negative speed means we are going backwards. pitch does not affect
+    // the playback direction.
+    m_bBackwards = *pTempoRatio < 0;
+
+    // Limit the minimum seek speed to stay within RubberBand's limits, see
+    // EngineBufferScaleRubberBand::setScaleParameters().
+    const double kMinSeekSpeed = 1.0 / 128.0;
+    double speed_abs = fabs(*pTempoRatio);
+    if (speed_abs < kMinSeekSpeed) {
+        // Let the caller know we ignored their speed.
+        speed_abs = *pTempoRatio = 0;
+    }
+
+    double pitchScale = fabs(base_rate * *pPitchRatio);
+    if (pitchScale > 0) {
+        m_scaleParameters.pitchScale = pitchScale;
+    }
+    // Time ratio is the ratio of stretched to unstretched duration.
+    double timeRatioInverse = base_rate * speed_abs;
+    if (timeRatioInverse > 0) {
+        m_scaleParameters.timeRatio = 1.0 / timeRatioInverse;
+    }
+    m_worker.setScaleParameters(m_scaleParameters);
+
+    // The fallback scaler may clamp the ratios differently, the reported
+    // values are those of RubberBand.
+    double tempoRatio = *pTempoRatio;
+    double pitchRatio = *pPitchRatio;
+    m_pScaleST->setScaleParameters(base_rate, &tempoRatio, &pitchRatio);
+
+    // Used by other methods so we need to keep them up to date.
+    m_dBaseRate = base_rate;
+    m_dTempoRatio = speed_abs;
+    m_dPitchRatio = *pPitchRatio;
+}
+
+void EngineBufferScaleRubberBandThreaded::setSampleRate(SINT iSampleRate) {
+    EngineBufferScale::setSampleRate(iSampleRate);
+    m_pScaleST->setSampleRate(iSampleRate);
+    resetPipeline(false);
+}
+
+void EngineBufferScaleRubberBandThreaded::clear() {
+    resetPipeline(false);
+}
+
+void EngineBufferScaleRubberBandThreaded::resetPipeline(bool bAccountDiscarded) {
+    if (bAccountDiscarded && m_pendingInputFrames > 0) {
+        m_discardedInputFrames += m_pendingInputFrames;
+    }
+    m_pendingInputFrames = 0.0;
+    m_resetGeneration = m_worker.requestReset(getAudioSignal().sampleRate());
+    m_pFallbackReader->setPriming(false);
+    m_pScaleST->clear();
+    m_state = State::Reset;
+    wakeWorker();
+}
+
+void EngineBufferScaleRubberBandThreaded::wakeWorker() {
+    if (!m_worker.workReady()) {
+        // No scheduler in tests
+        m_worker.wake();
+    }
+}
+
+bool EngineBufferScaleRubberBandThreaded::writeLookahead(SINT outputFrames) {
+    const bool bPriming = m_state == State::Priming;
+    const double rate = inputFramesPerOutputFrame();
+    FIFO<CSAMPLE>* pInputFIFO = m_worker.inputFIFO();
+
+    // The frames in flight in output time. The frames that are buffered
+    // inside of RubberBand are not included, this only makes the input
+    // a bit longer than necessary while priming.
+    SINT targetOutputFrames = (kLookaheadBuffers + 1) * outputFrames;
+    if (bPriming) {
+        targetOutputFrames += m_primingOutputFrames + m_worker.latencyFrames();
+    }
+    const double bufferedOutputFrames =
+            m_worker.outputFIFO()->readAvailable() / 2 +
+            pInputFIFO->readAvailable() / 2 / rate;
+    SINT frames = static_cast<SINT>(ceil(
+            (targetOutputFrames - bufferedOutputFrames) * rate));
+    if (bPriming) {
+        // Keep enough samples for the next buffer of the fallback scaler
+        const SINT fallbackFrames = kFallbackReadFrames +
+                static_cast<SINT>(ceil(outputFrames * rate));
+        frames = math_max(frames,
+                fallbackFrames - m_pFallbackReader->readAvailable() / 2);
+        if (frames > m_pFallbackReader->writeAvailable() / 2) {
+            return false;
+        }
+    }
+    frames = math_min(frames, static_cast<SINT>(MAX_BUFFER_LEN / 2));
+    frames = math_min(frames, pInputFIFO->writeAvailable() / 2);
+
+    SINT remainingSamples = frames * 2;
+    while (remainingSamples > 0) {
+        const SINT samples = m_pReadAheadManager->getNextSamples(
+                // The value doesn't matter here. All that matters is we
+                // are going forward or backward.
+                (m_bBackwards ? -1.0 : 1.0) * rate,
+                m_buffer_back,
+                remainingSamples);
+        if (samples <= 0) {
+            // End of track
+            break;
+        }
+        pInputFIFO->write(m_buffer_back, samples);
+        if (bPriming) {
+            m_pFallbackReader->write(m_buffer_back, samples);
+        }
+        m_pendingInputFrames += samples / 2;
+        remainingSamples -= samples;
+    }
+    return true;
+}
+
+double EngineBufferScaleRubberBandThreaded::scaleBuffer(
+        CSAMPLE* pOutputBuffer,
+        SINT iOutputBufferSize) {
+    if (m_dBaseRate == 0.0 || m_dTempoRatio == 0.0) {
+        SampleUtil::clear(pOutputBuffer, iOutputBufferSize);
+        // No actual samples/frames have been read from the
+        // unscaled input buffer!
+        return 0.0;
+    }
+
+    const SINT outputFrames = getAudioSignal().samples2frames(iOutputBufferSize);
+    FIFO<CSAMPLE>* pOutputFIFO = m_worker.outputFIFO();
+    m_discardedInputFrames = 0.0;
+
+    if (m_state == State::Reset &&
+            m_worker.acknowledgedResetGeneration() == m_resetGeneration) {
+        // Everything that the worker has written so far has been
+        // produced from discarded input.
+        pOutputFIFO->flushReadData(pOutputFIFO->readAvailable());
+        m_pFallbackReader->setPriming(true);
+        m_primingOutputFrames = 0;
+        m_state = State::Priming;
+    }
+
+    if (m_state == State::Priming) {
+        // Skip what has already been played by the fallback scaler
+        const SINT skipFrames =
+                m_primingOutputFrames + m_worker.latencyFrames();
+        if (pOutputFIFO->readAvailable() >=
+                getAudioSignal().frames2samples(skipFrames + outputFrames)) {
+            pOutputFIFO->flushReadData(
+                    getAudioSignal().frames2samples(skipFrames));
+            m_pFallbackReader->setPriming(false);
+            m_state = State::Running;
+        }
+    }
+
+    if (m_state == State::Running) {
+        if (pOutputFIFO->readAvailable() >= iOutputBufferSize) {
+            pOutputFIFO->read(pOutputBuffer, iOutputBufferSize);
+            // See EngineBufferScaleRubberBand::scaleBuffer()
+            const double framesRead = inputFramesPerOutputFrame() * outputFrames;
+            m_pendingInputFrames -= framesRead;
+            writeLookahead(outputFrames);
+            wakeWorker();
+            return framesRead;
+        }
+        Counter counter("EngineBufferScaleRubberBandThreaded underflow");
+        counter.increment();
+        resetPipeline(true);
+    }
+
+    bool bFallbackReaderFull = false;
+    if (m_state == State::Priming) {
+        bFallbackReaderFull = !writeLookahead(outputFrames);
+        wakeWorker();
+    }
+    double framesRead = m_pScaleST->scaleBuffer(pOutputBuffer, iOutputBufferSize);
+    if (m_state == State::Priming) {
+        m_primingOutputFrames += outputFrames;
+        m_pendingInputFrames -= framesRead;
+        if (bFallbackReaderFull) {
+            // The worker does not catch up, start over
+            resetPipeline(true);
+        }
+    }
+    return framesRead + m_discardedInputFrames;
+}
@@ -0,0 +1,184 @@
+#ifndef ENGINEBUFFERSCALERUBBERBANDTHREADED_H
+#define ENGINEBUFFERSCALERUBBERBANDTHREADED_H
+
+#include <QAtomicInt>
+
+#include "control/controlvalue.h"
+#include "engine/enginebufferscale.h"
+#include "engine/engineworker.h"
+#include "util/fifo.h"
+#include "util/memory.h"
+
+namespace RubberBand {
+class RubberBandStretcher;
+}  // namespace RubberBand
+
+class EngineBufferScaleST;
+class EngineWorkerScheduler;
+class ReadAheadManager;
+class RubberBandFallbackReader;
+
+struct RubberBandScaleParameters {
+    RubberBandScaleParameters()
+            : timeRatio(1.0),
+              pitchScale(1.0) {
+    }
+    bool operator==(const RubberBandScaleParameters& other) const {
+        return timeRatio == other.timeRatio && pitchScale == other.pitchScale;
+    }
+    bool operator!=(const RubberBandScaleParameters& other) const {
+        return !(*this == other);
+    }
+    double timeRatio;
+    double pitchScale;
+};
+
+// Runs the RubberBand stretcher of an EngineBufferScaleRubberBandThreaded.
+// The engine thread writes the unscaled samples into the input FIFO and
+// reads the stretched samples from the output FIFO, all other state is
+// only touched by the worker thread.
+class EngineBufferScaleRubberBandWorker : public EngineWorker {
+  public:
+    EngineBufferScaleRubberBandWorker();
+    ~EngineBufferScaleRubberBandWorker() override;
+
+    bool runOnce() override;
+
+    // Both FIFOs hold interleaved stereo samples
+    FIFO<CSAMPLE>* inputFIFO() {
+        return &m_inputFIFO;
+    }
+    FIFO<CSAMPLE>* outputFIFO() {
+        return &m_outputFIFO;
+    }
+
+    void setScaleParameters(const RubberBandScaleParameters& parameters) {
+        m_parameters.setValue(parameters);
+    }
+
+    // Asks the worker to discard its input and restart the stretcher with
+    // the given sample rate. Returns the generation that is acknowledged
+    // by acknowledgedResetGeneration() when this has happened.
+    int requestReset(SINT iSampleRate);
+    int acknowledgedResetGeneration() const {
+        return m_acknowledgedResetGeneration.loadAcquire();
+    }
+
+    // The latency of the stretcher in output frames, valid after a reset
+    // has been acknowledged.
+    SINT latencyFrames() const {
+        return m_latencyFrames.load();
+    }
+
+  private:
+    void reset();
+    void applyScaleParameters();
+
+    // Moves one block of samples through the stretcher. Returns false if
+    // there is nothing to do until more input arrives or output is consumed.
+    bool processBlock();
+
+    std::unique_ptr<RubberBand::RubberBandStretcher> m_pRubberBand;
+    SINT m_iSampleRate;
+    RubberBandScaleParameters m_appliedParameters;
+
+    FIFO<CSAMPLE> m_inputFIFO;
+    FIFO<CSAMPLE> m_outputFIFO;
+    CSAMPLE* m_deinterleaved[2];
+    CSAMPLE* m_interleaved;
+
+    ControlValueAtomic<RubberBandScaleParameters> m_parameters;
+    QAtomicInt m_requestedSampleRate;
+    QAtomicInt m_requestedResetGeneration;
+    QAtomicInt m_acknowledgedResetGeneration;
+    QAtomicInt m_latencyFrames;
+};
+
+// Uses librubberband to scale audio like EngineBufferScaleRubberBand, but
+// runs the stretcher on a worker thread that stays a few buffers ahead of
+// the audio callback. The callback only reads ahead with the
+// ReadAheadManager and copies the stretched output. While the worker has
+// not produced enough output, e.g. after a seek or when it could not keep
+// up, the buffer is scaled with SoundTouch instead.
+//
+// This class is not thread safe, all functions except the constructor
+// and setScheduler() must be called from the engine thread.
+class EngineBufferScaleRubberBandThreaded : public EngineBufferScale {
+    Q_OBJECT
+  public:
+    explicit EngineBufferScaleRubberBandThreaded(
+            ReadAheadManager* pReadAheadManager);
+    ~EngineBufferScaleRubberBandThreaded() override;
+
+    void setScheduler(EngineWorkerScheduler* pScheduler);
+
+    void setScaleParameters(double base_rate,
+                            double* pTempoRatio,
+                            double* pPitchRatio) override;
+
+    void setSampleRate(SINT iSampleRate) override;
+
+    double scaleBuffer(
+            CSAMPLE* pOutputBuffer,
+            SINT iOutputBufferSize) override;
+
+    // Flush buffer.
+    void clear() override;
+
+  private:
+    enum class State {
+        // Waiting for the worker to discard its input
+        Reset,
+        // The worker is catching up with the input that the fallback
+        // scaler is playing
+        Priming,
+        // Playing the output of the worker
+        Running,
+    };
+
+    // Discards the samples in flight. If bAccountDiscarded is set the
+    // discarded unscaled frames are added to the frames read by the
+    // current buffer, so that the play position follows the audio.
+    void resetPipeline(bool bAccountDiscarded);
+
+    // Reads ahead from the ReadAheadManager into the input FIFO of the
+    // worker until it holds enough samples for the next few buffers, and
+    // while priming also into the fallback reader. Returns false if the
+    // fallback reader has no space left.
+    bool writeLookahead(SINT outputFrames);
+
+    void wakeWorker();
+
+    double inputFramesPerOutputFrame() const {
+        return m_dBaseRate * m_dTempoRatio;
+    }
+
+    // The read-ahead manager that we use to fetch samples
+    ReadAheadManager* m_pReadAheadManager;
+
+    EngineBufferScaleRubberBandWorker m_worker;
+
+    // Plays the unscaled samples from the ReadAheadManager in State::Reset
+    // and the copies of those that have been passed to the worker in
+    // State::Priming, so that there is no gap when switching between them.
+    std::unique_ptr<RubberBandFallbackReader> m_pFallbackReader;
+    std::unique_ptr<EngineBufferScaleST> m_pScaleST;
+
+    RubberBandScaleParameters m_scaleParameters;
+
+    State m_state;
+    int m_resetGeneration;
+    // Output frames played by the fallback scaler while priming
+    SINT m_primingOutputFrames;
+    // Unscaled frames that have been read from the ReadAheadManager but
+    // not reported as consumed by scaleBuffer()
+    double m_pendingInputFrames;
+    double m_discardedInputFrames;
+
+    CSAMPLE* m_buffer_back;
+
+    // Holds the playback direction
+    bool m_bBackwards;
+};
+
+#endif /* ENGINEBUFFERSCALERUBBERBANDTHREADED_H */
@@ -0,0 +1,291 @@
+#include "engine/enginebufferscalesinc.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+// Number of stereo frames that are buffered from the RAMAN
+const SINT kBufferFrames = 4096;
+
+// Number of fractional positions between two frames with precomputed
+// coefficients. The coefficients in between are interpolated linearly.
+const int kPhases = 256;
+
+// The cutoff frequency is the fraction of the Nyquist frequency that is
+// passed. Above a rate of 1 / kCutoff the highest frequencies of the
+// track alias, that is at +15 % or +9 % pitch.
+struct MediumFilter {
+    static const int kTaps = 16;
+    static constexpr double kCutoff = 0.87;
+};
+
+struct HighFilter {
+    static const int kTaps = 32;
+    static constexpr double kCutoff = 0.92;
+};
+
+double blackmanWindow(double x) {
+    // x is within [-1, 1]
+    return 0.42 + 0.5 * cos(M_PI * x) + 0.08 * cos(2 * M_PI * x);
+}
+
+double sinc(double x) {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    return sin(M_PI * x) / (M_PI * x);
+}
+
+// The coefficients of the fractional positions frac = phase / kPhases.
+// The output frame at position floorFrame + frac is the sum of the kTaps
+// frames from floorFrame - kTaps / 2 + 1 to floorFrame + kTaps / 2
+// weighted with the coefficients of its phase. Each row of coefficients
+// is followed by the differences to the next phase.
+template<typename Filter>
+class SincTable {
+  public:
+    static const int kTaps = Filter::kTaps;
+    static const int kHalfTaps = kTaps / 2;
+    static const int kRowLength = 2 * kTaps;
+
+    // The table is built by the first call, which must not be made from
+    // the engine thread.
+    static const SincTable& instance() {
+        static const SincTable table;
+        return table;
+    }
+
+    const CSAMPLE* row(int phase) const {
+        return &m_coefficients[phase * kRowLength];
+    }
+
+  private:
+    SincTable() {
+        double coefficients[kPhases + 1][kTaps];
+        for (int phase = 0; phase <= kPhases; ++phase) {
+            const double frac = static_cast<double>(phase) / kPhases;
+            double sum = 0.0;
+            for (int tap = 0; tap < kTaps; ++tap) {
+                const double distance = tap - (kHalfTaps - 1) - frac;
+                const double coefficient = Filter::kCutoff *
+                        sinc(Filter::kCutoff * distance) *
+                        blackmanWindow(distance / kHalfTaps);
+                coefficients[phase][tap] = coefficient;
+                sum += coefficient;
+            }
+            // Unity gain for DC at all positions
+            for (int tap = 0; tap < kTaps; ++tap) {
+                coefficients[phase][tap] /= sum;
+            }
+        }
+        for (int phase = 0; phase < kPhases; ++phase) {
+            CSAMPLE* pRow = &m_coefficients[phase * kRowLength];
+            for (int tap = 0; tap < kTaps; ++tap) {
+                pRow[tap] = static_cast<CSAMPLE>(coefficients[phase][tap]);
+                pRow[kTaps + tap] = static_cast<CSAMPLE>(
+                        coefficients[phase + 1][tap] - coefficients[phase][tap]);
+            }
+        }
+    }
+
+    CSAMPLE m_coefficients[kPhases * kRowLength];
+};
+
+// Interpolates a stereo frame from the kTaps frames of pInput. The number
+// of taps is constant, so the compiler unrolls and vectorizes the loop.
+template<int kTaps>
+inline void interpolateFrame(
+        CSAMPLE* M_RESTRICT pOutput,
+        const CSAMPLE* M_RESTRICT pInput,
+        const CSAMPLE* M_RESTRICT pRow,
+        CSAMPLE frac) {
+    const CSAMPLE* pDeltas = pRow + kTaps;
+    CSAMPLE left = 0;
+    CSAMPLE right = 0;
+    for (int tap = 0; tap < kTaps; ++tap) {
+        const CSAMPLE coefficient = pRow[tap] + frac * pDeltas[tap];
+        left += coefficient * pInput[2 * tap];
+        right += coefficient * pInput[2 * tap + 1];
+    }
+    pOutput[0] = left;
+    pOutput[1] = right;
+}
+
+} // anonymous namespace
+
+EngineBufferScaleSinc::EngineBufferScaleSinc(ReadAheadManager* pReadAheadManager)
+    : m_pReadAheadManager(pReadAheadManager),
+      m_quality(static_cast<int>(Quality::High)),
+      m_activeQuality(Quality::High),
+      m_pBuffer(SampleUtil::alloc(getAudioSignal().frames2samples(kBufferFrames))),
+      m_bufferFrames(0),
+      m_dPosition(0.0),
+      m_bClear(true),
+      m_dRate(1.0),
+      m_dOldRate(1.0) {
+    // Build the tables of all qualities before the engine starts, the
+    // quality may be changed during playback
+    SincTable<MediumFilter>::instance();
+    SincTable<HighFilter>::instance();
+    SampleUtil::clear(m_pBuffer, getAudioSignal().frames2samples(kBufferFrames));
+}
+
+EngineBufferScaleSinc::~EngineBufferScaleSinc() {
+    SampleUtil::free(m_pBuffer);
+}
+
+void EngineBufferScaleSinc::setQuality(Quality quality) {
+    m_quality.store(static_cast<int>(quality));
+}
+
+void EngineBufferScaleSinc::setScaleParameters(double base_rate,
+                                               double* pTempoRatio,
+                                               double* pPitchRatio) {
+    Q_UNUSED(pPitchRatio);
+
+    m_dOldRate = m_dRate;
+    m_dRate = base_rate * *pTempoRatio;
+}
+
+void EngineBufferScaleSinc::clear() {
+    m_bClear = true;
+}
+
+void EngineBufferScaleSinc::reset(SINT historyFrames) {
+    // Silence before the first frame
+    SampleUtil::clear(m_pBuffer, getAudioSignal().frames2samples(historyFrames));
+    m_bufferFrames = historyFrames;
+    m_dPosition = historyFrames;
+}
+
+double EngineBufferScaleSinc::scaleBuffer(
+        CSAMPLE* pOutputBuffer,
+        SINT iOutputBufferSize) {
+    if (iOutputBufferSize == 0) {
+        return 0.0;
+    }
+
+    const Quality quality = static_cast<Quality>(m_quality.load());
+    if (m_bClear || quality != m_activeQuality) {
+        // A new quality needs a different number of history frames. The
+        // few buffered frames that are dropped are not worth the effort
+        // for a change of the preferences.
+        m_activeQuality = quality;
+        reset(quality == Quality::Medium ?
+                SincTable<MediumFilter>::kHalfTaps - 1 :
+                SincTable<HighFilter>::kHalfTaps - 1);
+        if (m_bClear) {
+            m_dOldRate = m_dRate; // If cleared, don't interpolate rate.
+            m_bClear = false;
+        }
+    }
+
+    double rateOld = m_dOldRate;
+    const double rateNew = m_dRate;
+    // We only need to ramp the rate changes once.
+    m_dOldRate = m_dRate;
+    if (rateOld * rateNew < 0) {
+        // EngineBuffer clears the scaler if the direction changes,
+        // so this should not happen. Start the new direction from a stop.
+        rateOld = 0.0;
+    }
+
+    const SINT frames = getAudioSignal().samples2frames(iOutputBufferSize);
+    if (m_activeQuality == Quality::Medium) {
+        return scaleFrames<MediumFilter>(pOutputBuffer, frames, rateOld, rateNew);
+    }
+    return scaleFrames<HighFilter>(pOutputBuffer, frames, rateOld, rateNew);
+}
+
+template<typename Filter>
+bool EngineBufferScaleSinc::refill(double rate, SINT framesWanted) {
+    // Keep the history of the next frame
+    const SINT firstFrame = static_cast<SINT>(m_dPosition) -
+            (SincTable<Filter>::kHalfTaps - 1);
+    if (firstFrame > 0) {
+        m_bufferFrames -= firstFrame;
+        memmove(m_pBuffer,
+                m_pBuffer + getAudioSignal().frames2samples(firstFrame),
+                getAudioSignal().frames2samples(m_bufferFrames) * sizeof(CSAMPLE));
+        m_dPosition -= firstFrame;
+    }
+    const SINT framesToRead = math_clamp<SINT>(
+            framesWanted, 1, kBufferFrames - m_bufferFrames);
+    const SINT samplesRead = m_pReadAheadManager->getNextSamples(
+            rate,
+            m_pBuffer + getAudioSignal().frames2samples(m_bufferFrames),
+            getAudioSignal().frames2samples(framesToRead));
+    m_bufferFrames += getAudioSignal().samples2frames(samplesRead);
+    return samplesRead > 0;
+}
+
+template<typename Filter>
+double EngineBufferScaleSinc::scaleFrames(CSAMPLE* pOutput, SINT frames,
+        double rateOld, double rateNew) {
+    typedef SincTable<Filter> Table;
+    const Table& table = Table::instance();
+
+    // The RAMAN reads backwards for negative rates, so we always advance
+    // by the absolute rate
+    const double readRate = rateNew != 0.0 ? rateNew : rateOld;
+    const double stepOld = fabs(rateOld);
+    // Smooth any changes in the playback rate over one buffer
+    const double stepDelta = (fabs(rateNew) - stepOld) / frames;
+    const bool unity = stepDelta == 0.0 && stepOld == 1.0;
+
+    double framesConsumed = 0.0;
+    int readFailedCount = 0;
+    SINT i = 0;
+    while (i < frames) {
+        const SINT floorFrame = static_cast<SINT>(m_dPosition);
+        if (floorFrame + Table::kHalfTaps >= m_bufferFrames) {
+            // Read what is needed for the remaining frames
+            const double remainingAdvance = (frames - i) * stepOld +
+                    stepDelta * ((frames - 1) * frames - (i - 1) * i) / 2.0;
+            const SINT framesWanted = static_cast<SINT>(
+                    m_dPosition + remainingAdvance) + Table::kHalfTaps + 1 -
+                    m_bufferFrames;
+            if (!refill<Filter>(readRate, framesWanted)) {
+                // Protection against infinite read loops when (for example)
+                // we are reading from a broken file.
+                if (++readFailedCount > 1) {
+                    break;
+                }
+            }
+            continue;
+        }
+
+        const SINT firstFrame = floorFrame - (Table::kHalfTaps - 1);
+        const double frac = m_dPosition - floorFrame;
+        CSAMPLE* pFrame = pOutput + getAudioSignal().frames2samples(i);
+        if (unity && frac == 0.0) {
+            // Special case -- no scaling needed!
+            const CSAMPLE* pInput = m_pBuffer +
+                    getAudioSignal().frames2samples(floorFrame);
+            pFrame[0] = pInput[0];
+            pFrame[1] = pInput[1];
+        } else {
+            const double phasePosition = frac * kPhases;
+            const int phase = static_cast<int>(phasePosition);
+            interpolateFrame<Table::kTaps>(
+                    pFrame,
+                    m_pBuffer + getAudioSignal().frames2samples(firstFrame),
+                    table.row(phase),
+                    static_cast<CSAMPLE>(phasePosition - phase));
+        }
+
+        const double step = stepOld + stepDelta * i;
+        m_dPosition += step;
+        framesConsumed += step;
+        ++i;
+    }
+
+    // Zero the remaining frames if we didn't fill them.
+    SampleUtil::clear(pOutput + getAudioSignal().frames2samples(i),
+            getAudioSignal().frames2samples(frames - i));
+    return framesConsumed;
+}
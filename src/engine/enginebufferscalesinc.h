@@ -0,0 +1,72 @@
+#ifndef ENGINEBUFFERSCALESINC_H
+#define ENGINEBUFFERSCALESINC_H
+
+#include <atomic>
+
+#include "engine/enginebufferscale.h"
+#include "engine/readaheadmanager.h"
+
+// Varispeed scaler that resamples with a windowed sinc filter, i.e. pitch
+// and tempo are changed together like with EngineBufferScaleLinear. It
+// does not alias audibly at the pitch ranges of the rate slider, at a
+// fraction of the CPU costs of the keylock scalers.
+//
+// The filter coefficients are looked up from polyphase tables that are
+// computed once per quality in the constructor, so the engine thread
+// never computes a sinc. The scaler can not ramp through zero, direction
+// changes and scratching are left to EngineBufferScaleLinear.
+class EngineBufferScaleSinc : public EngineBufferScale {
+  public:
+    enum class Quality {
+        // 16 taps
+        Medium,
+        // 32 taps
+        High,
+    };
+
+    explicit EngineBufferScaleSinc(
+            ReadAheadManager* pReadAheadManager);
+    ~EngineBufferScaleSinc() override;
+
+    // Thread-safe, takes effect with the next call of scaleBuffer()
+    void setQuality(Quality quality);
+
+    double scaleBuffer(
+            CSAMPLE* pOutputBuffer,
+            SINT iOutputBufferSize) override;
+    void clear() override;
+
+    void setScaleParameters(double base_rate,
+                            double* pTempoRatio,
+                            double* pPitchRatio) override;
+
+  private:
+    template<typename Filter>
+    double scaleFrames(CSAMPLE* pOutput, SINT frames,
+            double rateOld, double rateNew);
+
+    // Discards all frames that are no longer needed for the next frame
+    // and appends up to framesWanted frames from the RAMAN. Returns false
+    // if nothing could be read.
+    template<typename Filter>
+    bool refill(double rate, SINT framesWanted);
+
+    void reset(SINT historyFrames);
+
+    // The read-ahead manager that we use to fetch samples
+    ReadAheadManager* m_pReadAheadManager;
+
+    std::atomic<int> m_quality;
+    Quality m_activeQuality;
+
+    // The unscaled frames around the position of the next output frame
+    CSAMPLE* m_pBuffer;
+    SINT m_bufferFrames;
+    double m_dPosition;
+
+    bool m_bClear;
+    double m_dRate;
+    double m_dOldRate;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "engine/enginechannelthreadpool.h"
+
+#include <QSemaphore>
+#include <QThread>
+#include <QtDebug>
+
+#ifdef __LINUX__
+#include <pthread.h>
+#endif
+
+#include "util/math.h"
+#include "util/threadroles.h"
+#include "util/timer.h"
+
+class EngineChannelThreadPool::Worker : public QThread {
+  public:
+    Worker(EngineChannelThreadPool* pPool, int index)
+            : m_pPool(pPool),
+              m_index(index) {
+        setObjectName(QString("EngineChannelWorker %1").arg(index));
+    }
+
+    void wake() {
+        m_wakeup.release();
+    }
+
+  protected:
+    void run() override {
+#ifdef __LINUX__
+        // The engine thread gets real-time scheduling from the audio API,
+        // the workers need the same or they will miss the deadline.
+        struct sched_param spm = { 0 };
+        spm.sched_priority = 1;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &spm)) {
+            qWarning() << objectName() << "Failed bumping priority";
+        }
+#endif
+        mixxx::ThreadRoles::applyToCurrentThread(
+                mixxx::ThreadRole::EngineHelper);
+        while (true) {
+            m_wakeup.acquire();
+            if (m_pPool->m_quit.load()) {
+                return;
+            }
+            {
+                ScopedTimer t("EngineChannelThreadPool::worker%1", m_index);
+                m_pPool->runTasks();
+            }
+            m_pPool->m_busyWorkers.fetchAndAddRelease(-1);
+        }
+    }
+
+  private:
+    EngineChannelThreadPool* const m_pPool;
+    const int m_index;
+    QSemaphore m_wakeup;
+};
+
+EngineChannelThreadPool::EngineChannelThreadPool(int numWorkers)
+        : m_pTask(nullptr),
+          m_count(0),
+          m_nextIndex(0),
+          m_busyWorkers(0),
+          m_quit(0) {
+    for (int i = 0; i < numWorkers; ++i) {
+        Worker* pWorker = new Worker(this, i);
+        pWorker->start(QThread::TimeCriticalPriority);
+        m_workers.append(pWorker);
+    }
+}
+
+EngineChannelThreadPool::~EngineChannelThreadPool() {
+    m_quit.store(1);
+    for (Worker* pWorker : m_workers) {
+        pWorker->wake();
+    }
+    for (Worker* pWorker : m_workers) {
+        pWorker->wait();
+        delete pWorker;
+    }
+}
+
+void EngineChannelThreadPool::run(Task* pTask, int count) {
+    if (count <= 0) {
+        return;
+    }
+    // The calling thread processes tasks as well, so do not wake up more
+    // workers than there are remaining tasks.
+    const int numWake = math_min(m_workers.size(), count - 1);
+    m_pTask = pTask;
+    m_count = count;
+    m_nextIndex.store(0);
+    m_busyWorkers.storeRelease(numWake);
+    for (int i = 0; i < numWake; ++i) {
+        m_workers[i]->wake();
+    }
+
+    {
+        ScopedTimer t("EngineChannelThreadPool::engine");
+        runTasks();
+    }
+
+    // Join: All tasks have been taken when runTasks() returns, but workers
+    // may still process theirs. A late worker must also have left
+    // runTasks() before the next run() resets the task index.
+    while (m_busyWorkers.loadAcquire() > 0) {
+        // spin
+    }
+}
+
+void EngineChannelThreadPool::runTasks() {
+    while (true) {
+        const int index = m_nextIndex.fetchAndAddAcquire(1);
+        if (index >= m_count) {
+            return;
+        }
+        m_pTask->run(index);
+    }
+}
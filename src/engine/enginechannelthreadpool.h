@@ -0,0 +1,58 @@
+#ifndef ENGINECHANNELTHREADPOOL_H
+#define ENGINECHANNELTHREADPOOL_H
+
+#include <QAtomicInt>
+#include <QList>
+
+#include "util/class.h"
+
+// A small pool of real-time threads that helps the engine thread to
+// process independent tasks within a single callback, e.g. the process()
+// calls of all active EngineChannels. The workers do not run a Qt event
+// loop. They sleep on a semaphore between callbacks and take the next
+// task index from an atomic counter, so no locks are taken while the
+// tasks are processed.
+class EngineChannelThreadPool {
+  public:
+    class Task {
+      public:
+        virtual ~Task() {}
+        // Called exactly once for each index in [0, count) passed to
+        // EngineChannelThreadPool::run(), concurrently from different
+        // threads.
+        virtual void run(int index) = 0;
+    };
+
+    explicit EngineChannelThreadPool(int numWorkers);
+    virtual ~EngineChannelThreadPool();
+
+    int numWorkers() const {
+        return m_workers.size();
+    }
+
+    // Runs pTask for all indices in [0, count). The calling thread takes
+    // part in processing and this only returns after all workers that have
+    // been woken up have finished, so pTask does not need to outlive it.
+    // Only to be called from the engine thread.
+    void run(Task* pTask, int count);
+
+  private:
+    class Worker;
+
+    // Processes tasks until there are none left
+    void runTasks();
+
+    QList<Worker*> m_workers;
+
+    // Written by the engine thread before waking the workers
+    Task* m_pTask;
+    int m_count;
+
+    QAtomicInt m_nextIndex;
+    QAtomicInt m_busyWorkers;
+    QAtomicInt m_quit;
+
+    DISALLOW_COPY_AND_ASSIGN(EngineChannelThreadPool);
+};
+
+#endif /* ENGINECHANNELTHREADPOOL_H */
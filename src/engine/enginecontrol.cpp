@@ -103,6 +103,22 @@ void EngineControl::notifySeek(double dNewPlaypos) {
     Q_UNUSED(dNewPlaypos);
 }
 
+const BeatSnapshot* EngineControl::getBeatSnapshot(double dPosition,
+        const BeatsPointer& pBeats) const {
+    if (!m_pEngineBuffer || !pBeats) {
+        return nullptr;
+    }
+    const BeatSnapshot& snapshot = m_pEngineBuffer->getBeatSnapshot();
+    if (snapshot.position != dPosition || snapshot.pBeats != pBeats.data()) {
+        return nullptr;
+    }
+    return &snapshot;
+}
+
+const TrackEngineSnapshot* EngineControl::getTrackSnapshot() const {
+    return m_pEngineBuffer ? m_pEngineBuffer->getTrackSnapshot() : nullptr;
+}
+
 EngineBuffer* EngineControl::pickSyncTarget() {
     EngineMaster* pMaster = getEngineMaster();
     if (!pMaster) {
@@ -11,6 +11,7 @@
 #include "track/track.h"
 #include "control/controlvalue.h"
 #include "engine/effects/groupfeaturestate.h"
+#include "engine/beatsnapshot.h"
 #include "engine/cachingreader.h"
 
 class EngineMaster;
@@ -77,6 +78,14 @@ class EngineControl : public QObject {
     // Seek to an exact sample and don't allow quantizing adjustment.
     void seekExact(double sample);
     EngineBuffer* pickSyncTarget();
+    // The beats around the position that EngineBuffer has looked up in this
+    // callback, or null if they have been looked up for another position or
+    // in other beats. Must only be called from the engine thread.
+    const BeatSnapshot* getBeatSnapshot(double dPosition,
+            const BeatsPointer& pBeats) const;
+    // The properties of the loaded track as of this callback, or null.
+    // Must only be called from the engine thread.
+    const TrackEngineSnapshot* getTrackSnapshot() const;
 
     UserSettingsPointer getConfig();
     EngineMaster* getEngineMaster();
@@ -0,0 +1,63 @@
+#include "engine/enginedelaycompensation.h"
+
+#include "util/math.h"
+#include "util/sample.h"
+
+EngineDelayCompensation::EngineDelayCompensation()
+        : m_ring(kRingFrames * 2),
+          m_writeFrame(0),
+          m_delayFrames(0),
+          m_oldDelayFrames(0) {
+    m_ring.clear();
+}
+
+void EngineDelayCompensation::setDelayFrames(SINT delayFrames) {
+    m_delayFrames = math_clamp<SINT>(delayFrames, 0, kMaxDelayFrames);
+}
+
+void EngineDelayCompensation::clear() {
+    m_ring.clear();
+    m_writeFrame = 0;
+    m_oldDelayFrames = m_delayFrames;
+}
+
+void EngineDelayCompensation::process(CSAMPLE* pInOut, SINT numSamples) {
+    const SINT numFrames = numSamples / 2;
+    if (m_delayFrames == 0 && m_oldDelayFrames == 0) {
+        // Keep the ring up to date for a later delay
+        for (SINT i = 0; i < numFrames; ++i) {
+            m_ring[m_writeFrame * 2] = pInOut[i * 2];
+            m_ring[m_writeFrame * 2 + 1] = pInOut[i * 2 + 1];
+            m_writeFrame = (m_writeFrame + 1) % kRingFrames;
+        }
+        return;
+    }
+
+    const bool crossfade = m_delayFrames != m_oldDelayFrames;
+    const CSAMPLE_GAIN gainDelta = numFrames > 0 ?
+            CSAMPLE_GAIN_ONE / numFrames : CSAMPLE_GAIN_ZERO;
+    CSAMPLE_GAIN newGain = CSAMPLE_GAIN_ZERO;
+    // The frame is written before it is read, so a delay of 0 passes the
+    // input through
+    SINT readFrame = (m_writeFrame + kRingFrames - m_delayFrames) % kRingFrames;
+    SINT oldReadFrame = (m_writeFrame + kRingFrames - m_oldDelayFrames) % kRingFrames;
+    for (SINT i = 0; i < numFrames; ++i) {
+        m_ring[m_writeFrame * 2] = pInOut[i * 2];
+        m_ring[m_writeFrame * 2 + 1] = pInOut[i * 2 + 1];
+        m_writeFrame = (m_writeFrame + 1) % kRingFrames;
+        if (crossfade) {
+            newGain += gainDelta;
+            const CSAMPLE_GAIN oldGain = CSAMPLE_GAIN_ONE - newGain;
+            pInOut[i * 2] = m_ring[oldReadFrame * 2] * oldGain +
+                    m_ring[readFrame * 2] * newGain;
+            pInOut[i * 2 + 1] = m_ring[oldReadFrame * 2 + 1] * oldGain +
+                    m_ring[readFrame * 2 + 1] * newGain;
+            oldReadFrame = (oldReadFrame + 1) % kRingFrames;
+        } else {
+            pInOut[i * 2] = m_ring[readFrame * 2];
+            pInOut[i * 2 + 1] = m_ring[readFrame * 2 + 1];
+        }
+        readFrame = (readFrame + 1) % kRingFrames;
+    }
+    m_oldDelayFrames = m_delayFrames;
+}
@@ -0,0 +1,44 @@
+#ifndef ENGINEDELAYCOMPENSATION_H
+#define ENGINEDELAYCOMPENSATION_H
+
+#include "util/class.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+// Delays a stereo channel by a number of frames that may change in every
+// callback. EngineMaster delays each channel by the difference between the
+// highest effect latency of all channels and its own, so the outputs of the
+// channels line up. A change of the delay crossfades from the old to the new
+// delay over one buffer instead of jumping.
+class EngineDelayCompensation {
+  public:
+    // About 170 ms at 48 kHz
+    static const SINT kMaxDelayFrames = 8191;
+
+    EngineDelayCompensation();
+
+    // Longer delays are clamped to kMaxDelayFrames
+    void setDelayFrames(SINT delayFrames);
+
+    SINT delayFrames() const {
+        return m_delayFrames;
+    }
+
+    // Forgets the past input, e.g. if process() has not been called for
+    // some callbacks. Continues with the current delay without a crossfade.
+    void clear();
+
+    void process(CSAMPLE* pInOut, SINT numSamples);
+
+  private:
+    static const SINT kRingFrames = kMaxDelayFrames + 1;
+
+    mixxx::SampleBuffer m_ring;
+    SINT m_writeFrame;
+    SINT m_delayFrames;
+    SINT m_oldDelayFrames;
+
+    DISALLOW_COPY_AND_ASSIGN(EngineDelayCompensation);
+};
+
+#endif // ENGINEDELAYCOMPENSATION_H
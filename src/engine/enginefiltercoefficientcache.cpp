@@ -0,0 +1,147 @@
+#include "engine/enginefiltercoefficientcache.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#define MIXXX
+#include <fidlib.h>
+
+namespace {
+
+const int kSlotCount = 512;
+// The number of slots after the hashed slot that may hold a design
+const int kProbeCount = 4;
+// Like FIDSPEC_LENGTH in enginefilteriir.h
+const int kMaxSpecLength = 40;
+
+struct Key {
+    char spec[kMaxSpecLength];
+    double sampleRate;
+    double freq0;
+    double freq1;
+    int adj;
+    int nCoef;
+};
+
+struct Design {
+    Key key;
+    double gain;
+    double coef[EngineFilterCoefficientCache::kMaxCoefficients];
+};
+
+// The sequence is 0 while the slot is empty and odd while it is written
+struct Slot {
+    Design design;
+    QAtomicInt sequence;
+};
+
+Slot s_slots[kSlotCount];
+
+bool makeKey(Key* pKey, int nCoef, const char* spec,
+        double sampleRate, double freq0, double freq1, int adj) {
+    const size_t specLength = strlen(spec);
+    if (specLength >= sizeof(pKey->spec)) {
+        return false;
+    }
+    // Keys are compared and hashed as bytes, including the padding
+    memset(pKey, 0, sizeof(*pKey));
+    memcpy(pKey->spec, spec, specLength);
+    pKey->sampleRate = sampleRate;
+    pKey->freq0 = freq0;
+    pKey->freq1 = freq1;
+    pKey->adj = adj;
+    pKey->nCoef = nCoef;
+    return true;
+}
+
+unsigned int hashKey(const Key& key) {
+    // FNV-1a
+    const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(&key);
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(key); ++i) {
+        hash = (hash ^ pBytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool tryRead(const Slot& slot, const Key& key, Design* pDesign) {
+    const int sequence = slot.sequence.loadAcquire();
+    if (sequence == 0 || (sequence & 1)) {
+        return false;
+    }
+    *pDesign = slot.design;
+    // The design must be copied before the sequence is checked again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load() != sequence) {
+        return false;
+    }
+    return memcmp(&pDesign->key, &key, sizeof(key)) == 0;
+}
+
+void tryWrite(Slot* pSlot, const Design& design) {
+    const int sequence = pSlot->sequence.load();
+    if ((sequence & 1) ||
+            !pSlot->sequence.testAndSetAcquire(sequence, sequence + 1)) {
+        // Another thread is writing the slot
+        return;
+    }
+    // The design must not become visible before the odd sequence
+    std::atomic_thread_fence(std::memory_order_release);
+    pSlot->design = design;
+    pSlot->sequence.storeRelease(sequence + 2);
+}
+
+} // anonymous namespace
+
+//static
+QAtomicInt EngineFilterCoefficientCache::s_hits;
+QAtomicInt EngineFilterCoefficientCache::s_misses;
+
+//static
+double EngineFilterCoefficientCache::designCoefs(double* pCoef, int nCoef,
+        const char* spec, double sampleRate, double freq0, double freq1,
+        int adj) {
+    Design design;
+    if (nCoef > kMaxCoefficients || !makeKey(&design.key, nCoef, spec,
+            sampleRate, freq0, freq1, adj)) {
+        return fid_design_coef(pCoef, nCoef, spec, sampleRate, freq0, freq1, adj);
+    }
+
+    const unsigned int hash = hashKey(design.key);
+    Design cached;
+    for (int probe = 0; probe < kProbeCount; ++probe) {
+        if (tryRead(s_slots[(hash + probe) % kSlotCount], design.key, &cached)) {
+            s_hits.fetchAndAddRelaxed(1);
+            memcpy(pCoef, cached.coef, nCoef * sizeof(double));
+            return cached.gain;
+        }
+    }
+
+    s_misses.fetchAndAddRelaxed(1);
+    memset(design.coef, 0, sizeof(design.coef));
+    design.gain = fid_design_coef(design.coef, nCoef, spec,
+            sampleRate, freq0, freq1, adj);
+    memcpy(pCoef, design.coef, nCoef * sizeof(double));
+
+    // Take the first empty slot, or replace the design in the hashed slot
+    int index = hash % kSlotCount;
+    for (int probe = 0; probe < kProbeCount; ++probe) {
+        const int probeIndex = (hash + probe) % kSlotCount;
+        if (s_slots[probeIndex].sequence.loadAcquire() == 0) {
+            index = probeIndex;
+            break;
+        }
+    }
+    tryWrite(&s_slots[index], design);
+    return design.gain;
+}
+
+//static
+void EngineFilterCoefficientCache::clear() {
+    for (int i = 0; i < kSlotCount; ++i) {
+        s_slots[i].sequence.storeRelease(0);
+    }
+    s_hits.storeRelease(0);
+    s_misses.storeRelease(0);
+}
@@ -0,0 +1,42 @@
+#ifndef ENGINEFILTERCOEFFICIENTCACHE_H
+#define ENGINEFILTERCOEFFICIENTCACHE_H
+
+#include <QAtomicInt>
+
+// Caches the coefficients that fidlib designs for the IIR filters, shared
+// by all instances. The EQs and filter effects of all decks redesign their
+// filters whenever a knob moves, and fid_design_coef() allocates and takes
+// far longer than copying the coefficients of an earlier design with the
+// same parameters. Knobs that are moved by controllers or restored from
+// presets produce the same few parameters again and again.
+//
+// The cache has a fixed number of slots that are protected by sequence
+// numbers like the slots of a TripleBuffer, so it never allocates or locks.
+// A lookup that races with an insertion into the same slot is a miss, and
+// an insertion that races with another one is dropped.
+class EngineFilterCoefficientCache {
+  public:
+    // The largest number of coefficients of a design, EngineFilterIIR<16>
+    static const int kMaxCoefficients = 16;
+
+    // Like fid_design_coef(): stores the nCoef coefficients in pCoef and
+    // returns the gain. Designs the filter with fidlib on a cache miss.
+    static double designCoefs(double* pCoef, int nCoef, const char* spec,
+            double sampleRate, double freq0, double freq1, int adj);
+
+    // For tests and benchmarks. clear() must not be called while the
+    // engine is running.
+    static int hitCount() {
+        return s_hits.loadAcquire();
+    }
+    static int missCount() {
+        return s_misses.loadAcquire();
+    }
+    static void clear();
+
+  private:
+    static QAtomicInt s_hits;
+    static QAtomicInt s_misses;
+};
+
+#endif // ENGINEFILTERCOEFFICIENTCACHE_H
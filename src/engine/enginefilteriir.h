@@ -5,8 +5,10 @@
 #include <cstdio>
 #include <fidlib.h>
 
+#include "engine/enginefiltercoefficientcache.h"
 #include "engine/engineobject.h"
 #include "util/sample.h"
+#include "util/stereodouble.h"
 
 // set to 1 to print some analysis data using qDebug()
 // It prints the resulting delay after 50 % of impulse have passed
@@ -74,11 +76,9 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 
     void initBuffers() {
         // Copy the current buffers into the old buffers
-        memcpy(m_oldBuf1, m_buf1, sizeof(m_buf1));
-        memcpy(m_oldBuf2, m_buf2, sizeof(m_buf2));
+        memcpy(m_oldBuf, m_buf, sizeof(m_buf));
         // Set the current buffers to 0
-        memset(m_buf1, 0, sizeof(m_buf1));
-        memset(m_buf2, 0, sizeof(m_buf2));
+        memset(m_buf, 0, sizeof(m_buf));
         m_doRamping = true;
     }
 
@@ -93,8 +93,8 @@ class EngineFilterIIR : public EngineFilterIIRBase {
             // Copy the old coefficients into m_oldCoef
             memcpy(m_oldCoef, m_coef, sizeof(m_coef));
 
-            m_coef[0] = fid_design_coef(m_coef + 1, SIZE,
-                    spec_d, sampleRate, freq0, freq1, adj);
+            m_coef[0] = EngineFilterCoefficientCache::designCoefs(
+                    m_coef + 1, SIZE, spec_d, sampleRate, freq0, freq1, adj);
 
             initBuffers();
 
@@ -141,9 +141,11 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 
             // Copy the old coefficients into m_oldCoef
             memcpy(m_oldCoef, m_coef, sizeof(m_coef));
-            m_coef[0] = fid_design_coef(m_coef + 1, n_coef1,
+            m_coef[0] = EngineFilterCoefficientCache::designCoefs(
+                    m_coef + 1, n_coef1,
                     spec1, sampleRate, freq01, freq11, adj1) *
-                        fid_design_coef(m_coef + 1 + n_coef1, SIZE - n_coef1,
+                        EngineFilterCoefficientCache::designCoefs(
+                    m_coef + 1 + n_coef1, SIZE - n_coef1,
                     spec2, sampleRate, freq02, freq12, adj2);
 
             initBuffers();
@@ -197,8 +199,9 @@ class EngineFilterIIR : public EngineFilterIIRBase {
                          const int iBufferSize) {
         if (!m_doRamping) {
             for (int i = 0; i < iBufferSize; i += 2) {
-                pOutput[i] = processSample(m_coef, m_buf1, pIn[i]);
-                pOutput[i+1] = processSample(m_coef, m_buf2, pIn[i + 1]);
+                processSample(m_coef, m_buf,
+                        mixxx::StereoDouble::fromFrame(&pIn[i]))
+                        .toFrame(&pOutput[i]);
             }
         } else {
             double cross_mix = 0.0;
@@ -215,32 +218,26 @@ class EngineFilterIIR : public EngineFilterIIRBase {
                 // of the new filter but it turns out that this produces
                 // a gain drop due to the filter delay which is more
                 // conspicuous than the settling noise.
-                double old1;
-                double old2;
+                const mixxx::StereoDouble in =
+                        mixxx::StereoDouble::fromFrame(&pIn[i]);
+                mixxx::StereoDouble old;
                 if (!m_doStart) {
                     // Process old filter, but only if we do not do a fresh start
-                    old1 = processSample(m_oldCoef, m_oldBuf1, pIn[i]);
-                    old2 = processSample(m_oldCoef, m_oldBuf2, pIn[i + 1]);
+                    old = processSample(m_oldCoef, m_oldBuf, in);
                 } else {
                     if (m_startFromDry) {
-                        old1 = pIn[i];
-                        old2 = pIn[i + 1];
+                        old = in;
                     } else {
-                        old1 = 0;
-                        old2 = 0;
+                        old = mixxx::StereoDouble::zero();
                     }
                 }
-                double new1 = processSample(m_coef, m_buf1, pIn[i]);
-                double new2 = processSample(m_coef, m_buf2, pIn[i + 1]);
+                mixxx::StereoDouble current = processSample(m_coef, m_buf, in);
 
                 if (i < iBufferSize / 2) {
-                    pOutput[i] = old1;
-                    pOutput[i + 1] = old2;
+                    old.toFrame(&pOutput[i]);
                 } else {
-                    pOutput[i] = new1 * cross_mix +
-                                 old1 * (1.0 - cross_mix);
-                    pOutput[i + 1] = new2  * cross_mix +
-                                     old2 * (1.0 - cross_mix);
+                    (current * cross_mix + old * (1.0 - cross_mix))
+                            .toFrame(&pOutput[i]);
                     cross_mix += cross_inc;
                 }
             }
@@ -249,12 +246,74 @@ class EngineFilterIIR : public EngineFilterIIRBase {
         }
     }
 
+    // Processes this filter and pOther in a single pass, e.g. the parallel
+    // low and high passes of a crossover. The two recurrences do not depend
+    // on each other, so interleaving them keeps the FPU busy while each one
+    // waits for its previous results. Falls back to two process() calls while
+    // one of the filters is ramping. Both inputs are read before the outputs of
+    // a frame are written, so pIn and pOtherIn may be the same buffer and
+    // each output may be the same buffer as its input.
+    template<unsigned int OTHER_SIZE, enum IIRPass OTHER_PASS>
+    void processPair(const CSAMPLE* pIn, CSAMPLE* pOutput,
+            EngineFilterIIR<OTHER_SIZE, OTHER_PASS>* pOther,
+            const CSAMPLE* pOtherIn, CSAMPLE* pOtherOutput,
+            const int iBufferSize) {
+        if (m_doRamping || pOther->m_doRamping) {
+            process(pIn, pOutput, iBufferSize);
+            pOther->process(pOtherIn, pOtherOutput, iBufferSize);
+            return;
+        }
+        for (int i = 0; i < iBufferSize; i += 2) {
+            const mixxx::StereoDouble in =
+                    mixxx::StereoDouble::fromFrame(&pIn[i]);
+            const mixxx::StereoDouble otherIn =
+                    mixxx::StereoDouble::fromFrame(&pOtherIn[i]);
+            const mixxx::StereoDouble out = processSample(m_coef, m_buf, in);
+            const mixxx::StereoDouble otherOut = pOther->processSample(
+                    pOther->m_coef, pOther->m_buf, otherIn);
+            out.toFrame(&pOutput[i]);
+            otherOut.toFrame(&pOtherOutput[i]);
+        }
+    }
+
+    // Like processPair(), but processes three filters on the same input,
+    // e.g. the three bands of a waveform.
+    template<unsigned int SECOND_SIZE, enum IIRPass SECOND_PASS,
+            unsigned int THIRD_SIZE, enum IIRPass THIRD_PASS>
+    void processTriple(const CSAMPLE* pIn, CSAMPLE* pOutput,
+            EngineFilterIIR<SECOND_SIZE, SECOND_PASS>* pSecond,
+            CSAMPLE* pSecondOutput,
+            EngineFilterIIR<THIRD_SIZE, THIRD_PASS>* pThird,
+            CSAMPLE* pThirdOutput,
+            const int iBufferSize) {
+        if (m_doRamping || pSecond->m_doRamping || pThird->m_doRamping) {
+            process(pIn, pOutput, iBufferSize);
+            pSecond->process(pIn, pSecondOutput, iBufferSize);
+            pThird->process(pIn, pThirdOutput, iBufferSize);
+            return;
+        }
+        for (int i = 0; i < iBufferSize; i += 2) {
+            const mixxx::StereoDouble in =
+                    mixxx::StereoDouble::fromFrame(&pIn[i]);
+            const mixxx::StereoDouble out = processSample(m_coef, m_buf, in);
+            const mixxx::StereoDouble secondOut = pSecond->processSample(
+                    pSecond->m_coef, pSecond->m_buf, in);
+            const mixxx::StereoDouble thirdOut = pThird->processSample(
+                    pThird->m_coef, pThird->m_buf, in);
+            out.toFrame(&pOutput[i]);
+            secondOut.toFrame(&pSecondOutput[i]);
+            thirdOut.toFrame(&pThirdOutput[i]);
+        }
+    }
+
   protected:
-    inline double processSample(double* coef, double* buf, double val);
+    // Processes one frame of both channels, which share the coefficients
+    // but have their own state in buf.
+    inline mixxx::StereoDouble processSample(const double* coef,
+            mixxx::StereoDouble* buf, mixxx::StereoDouble val);
     inline void pauseFilterInner() {
         // Set the current buffers to 0
-        memset(m_buf1, 0, sizeof(m_buf1));
-        memset(m_buf2, 0, sizeof(m_buf2));
+        memset(m_buf, 0, sizeof(m_buf));
         m_doRamping = true;
         m_doStart = true;
     }
@@ -263,15 +322,10 @@ class EngineFilterIIR : public EngineFilterIIRBase {
     // Old coefficients needed for ramping
     double m_oldCoef[SIZE + 1];
 
-    // Channel 1 state
-    double m_buf1[SIZE];
-    // Old channel 1 buffer needed for ramping
-    double m_oldBuf1[SIZE];
-
-    // Channel 2 state
-    double m_buf2[SIZE];
-    // Old channel 2 buffer needed for ramping
-    double m_oldBuf2[SIZE];
+    // State of both channels
+    mixxx::StereoDouble m_buf[SIZE];
+    // Old state needed for ramping
+    mixxx::StereoDouble m_oldBuf[SIZE];
 
     // Flag set to true if ramping needs to be done
     bool m_doRamping;
@@ -279,13 +333,15 @@ class EngineFilterIIR : public EngineFilterIIRBase {
     bool m_doStart;
     // Flag set to true if this is a chained filter
     bool m_startFromDry;
+
+    template<unsigned int OTHER_SIZE, enum IIRPass OTHER_PASS>
+    friend class EngineFilterIIR;
 };
 
 template<>
-inline double EngineFilterIIR<2, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<2, IIR_LP>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -296,10 +352,9 @@ inline double EngineFilterIIR<2, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<2, IIR_BP>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = -tmp;
@@ -310,10 +365,9 @@ inline double EngineFilterIIR<2, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<2, IIR_HP>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -324,10 +378,9 @@ inline double EngineFilterIIR<2, IIR_HP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<4, IIR_LP>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -343,10 +396,9 @@ inline double EngineFilterIIR<4, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<8, IIR_BP>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -373,10 +425,9 @@ inline double EngineFilterIIR<8, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<4, IIR_HP>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     iir= val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -392,10 +443,9 @@ inline double EngineFilterIIR<4, IIR_HP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<8, IIR_LP>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -422,10 +472,9 @@ inline double EngineFilterIIR<8, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<16, IIR_BP>::processSample(double* coef,
-                                                         double* buf,
-                                                         double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<16, IIR_BP>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     buf[7] = buf[8]; buf[8] = buf[9]; buf[9] = buf[10]; buf[10] = buf[11];
@@ -474,10 +523,9 @@ inline double EngineFilterIIR<16, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<8, IIR_HP>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -505,10 +553,9 @@ inline double EngineFilterIIR<8, IIR_HP>::processSample(double* coef,
 
 // IIR_LP and IIR_HP use the same processSample routine
 template<>
-inline double EngineFilterIIR<5, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<5, IIR_BP>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = coef[2] * tmp;
@@ -519,10 +566,9 @@ inline double EngineFilterIIR<5, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_LPMO>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-   double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<4, IIR_LPMO>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+   mixxx::StereoDouble tmp, fir, iir;
    tmp= buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
    iir= val * coef[0];
    iir -= coef[1]*tmp; fir= tmp;
@@ -545,10 +591,9 @@ inline double EngineFilterIIR<4, IIR_LPMO>::processSample(double* coef,
 
 
 template<>
-inline double EngineFilterIIR<4, IIR_HPMO>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-   double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<4, IIR_HPMO>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+   mixxx::StereoDouble tmp, fir, iir;
    tmp= buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
    iir= val * coef[0];
    iir -= coef[1]*tmp; fir= -tmp;
@@ -570,10 +615,9 @@ inline double EngineFilterIIR<4, IIR_HPMO>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_LP2>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<2, IIR_LP2>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -591,10 +635,9 @@ inline double EngineFilterIIR<2, IIR_LP2>::processSample(double* coef,
 
 
 template<>
-inline double EngineFilterIIR<2, IIR_HP2>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+inline mixxx::StereoDouble EngineFilterIIR<2, IIR_HP2>::processSample(
+        const double* coef, mixxx::StereoDouble* buf, mixxx::StereoDouble val) {
+    mixxx::StereoDouble tmp, fir, iir;
     tmp = buf[0];
     iir = val * -coef[0]; // swap gain to be in phase with LP2
     iir -= coef[1] * tmp; fir = -tmp;
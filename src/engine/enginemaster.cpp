@@ -7,27 +7,65 @@
 #include "preferences/usersettings.h"
 #include "control/controlaudiotaperpot.h"
 #include "control/controlaudiotaperpot.h"
+#include "control/controlinputtime.h"
 #include "control/controlpotmeter.h"
 #include "control/controlpushbutton.h"
+#include "controllers/controllerlatency.h"
 #include "effects/effectsmanager.h"
 #include "engine/channelmixer.h"
 #include "engine/effects/engineeffectsmanager.h"
 #include "engine/enginebuffer.h"
 #include "engine/enginebuffer.h"
 #include "engine/enginechannel.h"
+#include "engine/enginechannelthreadpool.h"
 #include "engine/enginedeck.h"
 #include "engine/enginedelay.h"
+#include "engine/enginedelaycompensation.h"
 #include "engine/enginetalkoverducking.h"
 #include "engine/enginevumeter.h"
+#include "engine/engineworkerpool.h"
 #include "engine/engineworkerscheduler.h"
 #include "engine/enginexfader.h"
 #include "engine/sidechain/enginesidechain.h"
 #include "engine/sync/enginesync.h"
 #include "mixer/playermanager.h"
+#include "util/cmdlineargs.h"
 #include "util/defs.h"
+#include "util/math.h"
+#include "util/realtimesafety.h"
 #include "util/sample.h"
+#include "util/time.h"
 #include "util/timer.h"
 #include "util/trace.h"
+#include "waveform/visualplayposition.h"
+
+namespace {
+
+// Processes m_activeChannels[startIndex + index] for each index
+class ProcessChannelsTask : public EngineChannelThreadPool::Task {
+  public:
+    typedef void (EngineMaster::*ProcessChannel)(EngineMaster::ChannelInfo*, int);
+
+    ProcessChannelsTask(EngineMaster* pEngineMaster, ProcessChannel processChannel,
+            EngineMaster::ChannelInfo* const* ppChannels, int iBufferSize)
+            : m_pEngineMaster(pEngineMaster),
+              m_processChannel(processChannel),
+              m_ppChannels(ppChannels),
+              m_iBufferSize(iBufferSize) {
+    }
+
+    void run(int index) override {
+        (m_pEngineMaster->*m_processChannel)(m_ppChannels[index], m_iBufferSize);
+    }
+
+  private:
+    EngineMaster* const m_pEngineMaster;
+    const ProcessChannel m_processChannel;
+    EngineMaster::ChannelInfo* const* const m_ppChannels;
+    const int m_iBufferSize;
+};
+
+} // anonymous namespace
 
 EngineMaster::EngineMaster(UserSettingsPointer pConfig,
                            const char* group,
@@ -36,6 +74,7 @@ EngineMaster::EngineMaster(UserSettingsPointer pConfig,
                            bool bEnableSidechain)
         : m_pChannelHandleFactory(pChannelHandleFactory),
           m_pEngineEffectsManager(pEffectsManager ? pEffectsManager->getEngineEffectsManager() : NULL),
+          m_callbackProfiler(CmdlineArgs::Instance().getDeveloper()),
           m_masterGainOld(0.0),
           m_boothGainOld(0.0),
           m_headphoneMasterGainOld(0.0),
@@ -63,9 +102,27 @@ EngineMaster::EngineMaster(UserSettingsPointer pConfig,
     m_bBusOutputConnected[EngineChannel::CENTER] = false;
     m_bBusOutputConnected[EngineChannel::RIGHT] = false;
     m_bExternalRecordBroadcastInputConnected = false;
+    m_bLatencyCompensationActive = false;
+    m_maxChannelLatencyFrames = 0;
+    m_outputLatencyFrames = 0;
+    if (m_pEngineEffectsManager) {
+        m_pEngineEffectsManager->setCallbackProfiler(&m_callbackProfiler);
+    }
+    // The threads that run the readers of all players, before any of them
+    // is created
+    EngineWorkerPool::setNumThreads(pConfig->getValue(
+            ConfigKey(group, "num_worker_threads"),
+            EngineWorkerPool::defaultNumThreads()));
     m_pWorkerScheduler = new EngineWorkerScheduler(this);
     m_pWorkerScheduler->start(QThread::HighPriority);
 
+    // Opt-in: Number of additional threads for processing the channels in
+    // parallel to the engine thread. 0 processes all channels serially.
+    const int numEngineThreads = pConfig->getValue(
+            ConfigKey(group, "num_engine_threads"), 0);
+    m_pChannelThreadPool = numEngineThreads > 0 ?
+            new EngineChannelThreadPool(numEngineThreads) : NULL;
+
     // Master sample rate
     m_pMasterSampleRate = new ControlObject(ConfigKey(group, "samplerate"), true, true);
     m_pMasterSampleRate->set(44100.);
@@ -143,6 +200,10 @@ EngineMaster::EngineMaster(UserSettingsPointer pConfig,
     SampleUtil::clear(m_pMaster, MAX_BUFFER_LEN);
     SampleUtil::clear(m_pBooth, MAX_BUFFER_LEN);
     SampleUtil::clear(m_pTalkover, MAX_BUFFER_LEN);
+
+    m_pDirectOutput = NULL;
+    m_directOutputType = AudioPath::INVALID;
+    m_bDirectOutputRendered = false;
     SampleUtil::clear(m_pTalkoverHeadphones, MAX_BUFFER_LEN);
     SampleUtil::clear(m_pSidechainMix, MAX_BUFFER_LEN);
 
@@ -175,6 +236,11 @@ EngineMaster::EngineMaster(UserSettingsPointer pConfig,
     m_pKeylockEngine->set(pConfig->getValueString(
             ConfigKey(group, "keylock_engine")).toDouble());
 
+    m_pVarispeedEngine = new ControlObject(ConfigKey(group, "varispeed_engine"),
+                                           true, false, true);
+    m_pVarispeedEngine->set(pConfig->getValueString(
+            ConfigKey(group, "varispeed_engine")).toDouble());
+
     // TODO: Make this read only and make EngineMaster decide whether
     // processing the master mix is necessary.
     m_pMasterEnabled = new ControlObject(ConfigKey(group, "enabled"),
@@ -187,6 +253,8 @@ EngineMaster::EngineMaster(UserSettingsPointer pConfig,
             true, false, true);  // persist = true
     m_pHeadphoneEnabled = new ControlObject(ConfigKey(group, "headEnabled"));
     m_pHeadphoneEnabled->setReadOnly();
+    m_pSkippedBuses = new ControlObject(ConfigKey(group, "skipped_buses"));
+    m_pSkippedBuses->setReadOnly();
 
     // Note: the EQ Rack is set in EffectsManager::setupDefaults();
 }
@@ -194,6 +262,7 @@ EngineMaster::EngineMaster(UserSettingsPointer pConfig,
 EngineMaster::~EngineMaster() {
     qDebug() << "in ~EngineMaster()";
     delete m_pKeylockEngine;
+    delete m_pVarispeedEngine;
     delete m_pCrossfader;
     delete m_pBalance;
     delete m_pHeadMix;
@@ -227,6 +296,7 @@ EngineMaster::~EngineMaster() {
     delete m_pMasterMonoMixdown;
     delete m_pMicMonitorMode;
     delete m_pHeadphoneEnabled;
+    delete m_pSkippedBuses;
 
     SampleUtil::free(m_pHead);
     SampleUtil::free(m_pMaster);
@@ -237,7 +307,7 @@ EngineMaster::~EngineMaster() {
         SampleUtil::free(m_pOutputBusBuffers[o]);
     }
 
-    delete m_pWorkerScheduler;
+    delete m_pChannelThreadPool;
 
     for (int i = 0; i < m_channels.size(); ++i) {
         ChannelInfo* pChannelInfo = m_channels[i];
@@ -245,8 +315,13 @@ EngineMaster::~EngineMaster() {
         delete pChannelInfo->m_pChannel;
         delete pChannelInfo->m_pVolumeControl;
         delete pChannelInfo->m_pMuteControl;
+        delete pChannelInfo->m_pDelayCompensation;
         delete pChannelInfo;
     }
+
+    // The workers of the channels report to the scheduler until they
+    // are stopped
+    delete m_pWorkerScheduler;
 }
 
 const CSAMPLE* EngineMaster::getMasterBuffer() const {
@@ -265,6 +340,83 @@ const CSAMPLE* EngineMaster::getSidechainBuffer() const {
     return m_pSidechainMix;
 }
 
+void EngineMaster::processChannel(ChannelInfo* pChannelInfo, int iBufferSize) {
+    EngineChannel* pChannel = pChannelInfo->m_pChannel;
+    if (m_callbackProfiler.isActive()) {
+        PerformanceTimer timer;
+        timer.start();
+        pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
+        pChannelInfo->m_processNanos = timer.elapsed().toIntegerNanos();
+    } else {
+        pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
+    }
+
+    if (m_bLatencyCompensationActive) {
+        pChannelInfo->m_pDelayCompensation->process(
+                pChannelInfo->m_pBuffer, iBufferSize);
+    }
+
+    // Collect metadata for effects
+    if (m_pEngineEffectsManager) {
+        GroupFeatureState features;
+        pChannel->collectFeatures(&features);
+        pChannelInfo->m_features = features;
+    }
+}
+
+void EngineMaster::updateLatencyCompensation(int iBufferSize) {
+    if (!m_pEngineEffectsManager) {
+        return;
+    }
+
+    // m_activeChannels[0] is NULL if there is no sync master
+    SINT maxLatencyFrames = 0;
+    for (int i = 0; i < m_activeChannels.size(); ++i) {
+        ChannelInfo* pChannelInfo = m_activeChannels[i];
+        if (pChannelInfo == NULL) {
+            continue;
+        }
+        // Both the pre-fader and the post-fader effects of the channel are
+        // processed with the master as output
+        pChannelInfo->m_latencyFrames = m_pEngineEffectsManager->latencyFrames(
+                pChannelInfo->m_handle, m_masterHandle.handle(),
+                iBufferSize, m_iSampleRate);
+        maxLatencyFrames = math_max(maxLatencyFrames,
+                pChannelInfo->m_latencyFrames);
+    }
+
+    // Keep delaying for one more callback after the latencies drop to 0,
+    // so the delays can crossfade back to no delay
+    const bool bActive = maxLatencyFrames > 0 || m_maxChannelLatencyFrames > 0;
+    for (int i = 0; i < m_activeChannels.size(); ++i) {
+        ChannelInfo* pChannelInfo = m_activeChannels[i];
+        if (pChannelInfo == NULL) {
+            continue;
+        }
+        EngineDelayCompensation* pDelay = pChannelInfo->m_pDelayCompensation;
+        pDelay->setDelayFrames(maxLatencyFrames - pChannelInfo->m_latencyFrames);
+        if (bActive && (!m_bLatencyCompensationActive ||
+                pChannelInfo->m_bDelayCompensationStale)) {
+            // The ring has not been written while the compensation or the
+            // channel was inactive
+            pDelay->clear();
+        }
+        pChannelInfo->m_bDelayCompensationStale = !bActive;
+    }
+    m_bLatencyCompensationActive = bActive;
+    m_maxChannelLatencyFrames = maxLatencyFrames;
+
+    const SINT outputLatencyFrames = maxLatencyFrames +
+            m_pEngineEffectsManager->latencyFrames(
+                    m_masterHandle.handle(), m_masterHandle.handle(),
+                    iBufferSize, m_iSampleRate);
+    if (outputLatencyFrames != m_outputLatencyFrames && m_iSampleRate > 0) {
+        m_outputLatencyFrames = outputLatencyFrames;
+        VisualPlayPosition::setEngineLatencySecs(
+                static_cast<double>(outputLatencyFrames) / m_iSampleRate);
+    }
+}
+
 void EngineMaster::processChannels(int iBufferSize) {
     m_activeBusChannels[EngineChannel::LEFT].clear();
     m_activeBusChannels[EngineChannel::CENTER].clear();
@@ -285,6 +437,7 @@ void EngineMaster::processChannels(int iBufferSize) {
 
         // Skip inactive channels.
         if (!pChannel || !pChannel->isActive()) {
+            pChannelInfo->m_bDelayCompensationStale = true;
             continue;
         }
 
@@ -344,18 +497,33 @@ void EngineMaster::processChannels(int iBufferSize) {
         }
     }
 
-    // Now that the list is built and ordered, do the processing.
-    for (int i = activeChannelsStartIndex;
-             i < m_activeChannels.size(); ++i) {
-        ChannelInfo* pChannelInfo = m_activeChannels[i];
-        EngineChannel* pChannel = pChannelInfo->m_pChannel;
-        pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
-
-        // Collect metadata for effects
-        if (m_pEngineEffectsManager) {
-            GroupFeatureState features;
-            pChannel->collectFeatures(&features);
-            pChannelInfo->m_features = features;
+    updateLatencyCompensation(iBufferSize);
+
+    // Now that the list is built and ordered, do the processing. The
+    // pre-fader effects run within EngineChannel::process(), so the channels
+    // are only processed in parallel while no pre-fader chain is shared
+    // between them. The results do not depend on the order in which the
+    // workers pick up the channels, because each channel only writes to its
+    // own buffer and the channels are mixed in m_activeChannels order below.
+    const bool bParallel = m_pChannelThreadPool &&
+            (!m_pEngineEffectsManager ||
+             m_pEngineEffectsManager->isPreFaderProcessingParallelSafe());
+    if (bParallel) {
+        int i = activeChannelsStartIndex;
+        if (i == 0) {
+            // The other channels may follow the sync master, so it has to
+            // be processed before all of them.
+            processChannel(m_activeChannels[0], iBufferSize);
+            ++i;
+        }
+        // The channels are independent from each other until postProcess()
+        ProcessChannelsTask task(this, &EngineMaster::processChannel,
+                m_activeChannels.constData() + i, iBufferSize);
+        m_pChannelThreadPool->run(&task, m_activeChannels.size() - i);
+    } else {
+        for (int i = activeChannelsStartIndex;
+                 i < m_activeChannels.size(); ++i) {
+            processChannel(m_activeChannels[i], iBufferSize);
         }
     }
 
@@ -367,6 +535,22 @@ void EngineMaster::processChannels(int iBufferSize) {
             i < m_activeChannels.size(); ++i) {
         m_activeChannels[i]->m_pChannel->postProcess(iBufferSize);
     }
+
+    if (m_callbackProfiler.isActive()) {
+        const ChannelInfo* pSlowestChannel = NULL;
+        for (int i = activeChannelsStartIndex;
+                i < m_activeChannels.size(); ++i) {
+            const ChannelInfo* pChannelInfo = m_activeChannels[i];
+            if (!pSlowestChannel || pChannelInfo->m_processNanos >
+                    pSlowestChannel->m_processNanos) {
+                pSlowestChannel = pChannelInfo;
+            }
+        }
+        if (pSlowestChannel) {
+            m_callbackProfiler.setSlowestChannel(
+                    pSlowestChannel->m_index, pSlowestChannel->m_processNanos);
+        }
+    }
 }
 
 void EngineMaster::process(const int iBufferSize) {
@@ -375,12 +559,32 @@ void EngineMaster::process(const int iBufferSize) {
         QThread::currentThread()->setObjectName("Engine");
         haveSetName = true;
     }
+    RealtimeThreadScope realtimeThread;
     Trace t("EngineMaster::process");
+    ControllerLatency::engineCallbackStarted();
+    ControlInputTime::engineCallbackStarted(mixxx::Time::elapsed());
 
     bool masterEnabled = m_pMasterEnabled->get();
     bool boothEnabled = m_pBoothEnabled->get();
     bool headphoneEnabled = m_pHeadphoneEnabled->get();
 
+    // Render into the buffer of processInto() by using it as the buffer of
+    // the mix for this callback
+    CSAMPLE** ppDirectOutputMix = NULL;
+    if (m_pDirectOutput) {
+        if (m_directOutputType == AudioPath::MASTER && masterEnabled) {
+            ppDirectOutputMix = &m_pMaster;
+        } else if (m_directOutputType == AudioPath::HEADPHONES &&
+                headphoneEnabled) {
+            ppDirectOutputMix = &m_pHead;
+        }
+    }
+    CSAMPLE* pOwnMixBuffer = NULL;
+    if (ppDirectOutputMix) {
+        pOwnMixBuffer = *ppDirectOutputMix;
+        *ppDirectOutputMix = m_pDirectOutput;
+    }
+
     m_iSampleRate = static_cast<int>(m_pMasterSampleRate->get());
     m_iBufferSize = iBufferSize;
     // TODO: remove assumption of stereo buffer
@@ -393,8 +597,11 @@ void EngineMaster::process(const int iBufferSize) {
 
     // Update internal master sync rate.
     m_pMasterSync->onCallbackStart(m_iSampleRate, m_iBufferSize);
-    // Prepare each channel for output
-    processChannels(m_iBufferSize);
+    {
+        ScopedCallbackStage stage(&m_callbackProfiler, CallbackProfiler::CHANNELS);
+        // Prepare each channel for output
+        processChannels(m_iBufferSize);
+    }
     // Do internal master sync post-processing
     m_pMasterSync->onCallbackEnd(m_iSampleRate, m_iBufferSize);
 
@@ -413,60 +620,84 @@ void EngineMaster::process(const int iBufferSize) {
     // Mix all the PFL enabled channels together.
     m_headphoneGain.setGain(pflMixGainInHeadphones);
 
-    if (headphoneEnabled) {
-        // Process effects and mix PFL channels together for the headphones.
-        // Effects will be reprocessed post-fader for the crossfader busses
-        // and master mix, so the channel input buffers cannot be modified here.
-        ChannelMixer::applyEffectsAndMixChannels(
-            m_headphoneGain, &m_activeHeadphoneChannels,
-            &m_channelHeadphoneGainCache,
-            m_pHead, m_headphoneHandle.handle(),
-            m_iBufferSize, m_iSampleRate,
-            m_pEngineEffectsManager);
-
-        // Process headphone channel effects
-        if (m_pEngineEffectsManager) {
-            GroupFeatureState headphoneFeatures;
-            // If there is only one channel in the headphone mix, use its features
-            // for effects processing. This allows for previewing how an effect will
-            // sound on a playing deck before turning up the dry/wet knob to make it
-            // audible on the master mix. Without this, the effect would sound different
-            // in headphones than how it would sound if it was enabled on the deck,
-            // for example with tempo synced effects.
-            if (m_activeHeadphoneChannels.size() == 1) {
-                headphoneFeatures = m_activeHeadphoneChannels.at(0)->m_features;
-            }
-            m_pEngineEffectsManager->processPostFaderInPlace(
-                m_headphoneHandle.handle(),
-                m_headphoneHandle.handle(),
-                m_pHead,
-                m_iBufferSize, m_iSampleRate,
-                headphoneFeatures);
-        }
+    // Only the buses with a consumer are mixed. The talkover mix is only
+    // used with microphones, and the crossfader buses are only used by the
+    // master mix and the bus outputs.
+    const bool talkoverEnabled = m_pNumMicsConfigured->get() > 0;
+    const bool crossfaderBusesEnabled = masterEnabled ||
+            m_bBusOutputConnected[EngineChannel::LEFT] ||
+            m_bBusOutputConnected[EngineChannel::CENTER] ||
+            m_bBusOutputConnected[EngineChannel::RIGHT];
+    const int skippedBuses =
+            (headphoneEnabled ? 0 : SKIPPED_HEADPHONES) |
+            (boothEnabled ? 0 : SKIPPED_BOOTH) |
+            (talkoverEnabled ? 0 : SKIPPED_TALKOVER) |
+            (crossfaderBusesEnabled ? 0 : SKIPPED_CROSSFADER_BUSES);
+    if (m_pSkippedBuses->get() != skippedBuses) {
+        m_pSkippedBuses->forceSet(skippedBuses);
     }
 
-    // Mix all the talkover enabled channels together.
-    // Effects processing is done in place to avoid unnecessary buffer copying.
-    ChannelMixer::applyEffectsInPlaceAndMixChannels(
-        m_talkoverGain, &m_activeTalkoverChannels,
-        &m_channelTalkoverGainCache,
-        m_pTalkover, m_masterHandle.handle(),
-        m_iBufferSize, m_iSampleRate, m_pEngineEffectsManager);
-
-    // Process effects on all microphones mixed together
     // We have no metadata for mixed effect buses, so use an empty GroupFeatureState.
     GroupFeatureState busFeatures;
-    m_pEngineEffectsManager->processPostFaderInPlace(
-            m_busTalkoverHandle.handle(),
-            m_masterHandle.handle(),
-            m_pTalkover,
-            m_iBufferSize, m_iSampleRate, busFeatures);
 
+    {
+        ScopedCallbackStage stage(&m_callbackProfiler,
+                CallbackProfiler::HEADPHONE_TALKOVER);
+        if (headphoneEnabled) {
+            // Process effects and mix PFL channels together for the headphones.
+            // Effects will be reprocessed post-fader for the crossfader busses
+            // and master mix, so the channel input buffers cannot be modified here.
+            ChannelMixer::applyEffectsAndMixChannels(
+                m_headphoneGain, &m_activeHeadphoneChannels,
+                &m_channelHeadphoneGainCache,
+                m_pHead, m_headphoneHandle.handle(),
+                m_iBufferSize, m_iSampleRate,
+                m_pEngineEffectsManager);
+
+            // Process headphone channel effects
+            if (m_pEngineEffectsManager) {
+                GroupFeatureState headphoneFeatures;
+                // If there is only one channel in the headphone mix, use its features
+                // for effects processing. This allows for previewing how an effect will
+                // sound on a playing deck before turning up the dry/wet knob to make it
+                // audible on the master mix. Without this, the effect would sound different
+                // in headphones than how it would sound if it was enabled on the deck,
+                // for example with tempo synced effects.
+                if (m_activeHeadphoneChannels.size() == 1) {
+                    headphoneFeatures = m_activeHeadphoneChannels.at(0)->m_features;
+                }
+                m_pEngineEffectsManager->processPostFaderInPlace(
+                    m_headphoneHandle.handle(),
+                    m_headphoneHandle.handle(),
+                    m_pHead,
+                    m_iBufferSize, m_iSampleRate,
+                    headphoneFeatures);
+            }
+        }
+
+        // Clear talkover compressor for the next round of gain calculation.
+        m_pTalkoverDucking->clearKeys();
+        if (talkoverEnabled) {
+            // Mix all the talkover enabled channels together.
+            // Effects processing is done in place to avoid unnecessary buffer copying.
+            ChannelMixer::applyEffectsInPlaceAndMixChannels(
+                m_talkoverGain, &m_activeTalkoverChannels,
+                &m_channelTalkoverGainCache,
+                m_pTalkover, m_masterHandle.handle(),
+                m_iBufferSize, m_iSampleRate, m_pEngineEffectsManager);
+
+            // Process effects on all microphones mixed together
+            m_pEngineEffectsManager->processPostFaderInPlace(
+                    m_busTalkoverHandle.handle(),
+                    m_masterHandle.handle(),
+                    m_pTalkover,
+                    m_iBufferSize, m_iSampleRate, busFeatures);
 
-    // Clear talkover compressor for the next round of gain calculation.
-    m_pTalkoverDucking->clearKeys();
-    if (m_pTalkoverDucking->getMode() != EngineTalkoverDucking::OFF) {
-        m_pTalkoverDucking->processKey(m_pTalkover, m_iBufferSize);
+            // The manual ducking does not depend on the key
+            if (m_pTalkoverDucking->getMode() == EngineTalkoverDucking::AUTO) {
+                m_pTalkoverDucking->processKey(m_pTalkover, m_iBufferSize);
+            }
+        }
     }
 
     // Calculate the crossfader gains for left and right side of the crossfader
@@ -484,7 +715,10 @@ void EngineMaster::process(const int iBufferSize) {
     m_masterGain.setGains(crossfaderLeftGain, 1.0, crossfaderRightGain,
                             m_pTalkoverDucking->getGain(m_iBufferSize / 2));
 
-    for (int o = EngineChannel::LEFT; o <= EngineChannel::RIGHT; o++) {
+    for (int o = EngineChannel::LEFT;
+            crossfaderBusesEnabled && o <= EngineChannel::RIGHT; o++) {
+        ScopedCallbackStage stage(&m_callbackProfiler,
+                CallbackProfiler::CHANNEL_MIXER);
         ChannelMixer::applyEffectsInPlaceAndMixChannels(
             m_masterGain,
             &m_activeBusChannels[o],
@@ -494,7 +728,7 @@ void EngineMaster::process(const int iBufferSize) {
     }
 
     // Process crossfader orientation bus channel effects
-    if (m_pEngineEffectsManager) {
+    if (m_pEngineEffectsManager && crossfaderBusesEnabled) {
         m_pEngineEffectsManager->processPostFaderInPlace(
             m_busCrossfaderLeftHandle.handle(),
             m_masterHandle.handle(),
@@ -674,6 +908,8 @@ void EngineMaster::process(const int iBufferSize) {
         // so skip sending a buffer to m_pSidechain here.
         if (!m_bExternalRecordBroadcastInputConnected
             && m_pEngineSideChain != nullptr) {
+            ScopedCallbackStage stage(&m_callbackProfiler,
+                    CallbackProfiler::SIDECHAIN);
             m_pEngineSideChain->writeSamples(m_pSidechainMix, iFrames);
         }
 
@@ -731,11 +967,34 @@ void EngineMaster::process(const int iBufferSize) {
         m_pBoothDelay->process(m_pBooth, m_iBufferSize);
     }
 
+    if (ppDirectOutputMix) {
+        *ppDirectOutputMix = pOwnMixBuffer;
+        // The sound device expects clamped samples. This is the same as the
+        // clamping copy of SoundDevice::composeOutputBuffer() without the copy.
+        SampleUtil::copyClampBuffer(m_pDirectOutput, m_pDirectOutput,
+                m_iBufferSize);
+        m_bDirectOutputRendered = true;
+    }
+
     // We're close to the end of the callback. Wake up the engine worker
     // scheduler so that it runs the workers.
     m_pWorkerScheduler->runWorkers();
 }
 
+bool EngineMaster::processInto(const int iBufferSize,
+        AudioPath::AudioPathType type, CSAMPLE* pOutput) {
+    m_pDirectOutput = pOutput;
+    m_directOutputType = type;
+    m_bDirectOutputRendered = false;
+    process(iBufferSize);
+    m_pDirectOutput = NULL;
+    return m_bDirectOutputRendered;
+}
+
+bool EngineMaster::workersIdle() const {
+    return m_pWorkerScheduler->workersIdle();
+}
+
 void EngineMaster::applyMasterEffects() {
     // Apply master effects
     if (m_pEngineEffectsManager) {
@@ -751,6 +1010,8 @@ void EngineMaster::applyMasterEffects() {
 }
 
 void EngineMaster::processHeadphones(const double masterMixGainInHeadphones) {
+    ScopedCallbackStage stage(&m_callbackProfiler,
+            CallbackProfiler::HEADPHONE_TALKOVER);
     // Add master mix to headphones
     SampleUtil::addWithRampingGain(m_pHead, m_pMaster,
                                    m_headphoneMasterGainOld,
@@ -789,7 +1050,9 @@ void EngineMaster::addChannel(EngineChannel* pChannel) {
     pChannelInfo->m_pMuteControl->setButtonMode(ControlPushButton::POWERWINDOW);
     pChannelInfo->m_pBuffer = SampleUtil::alloc(MAX_BUFFER_LEN);
     SampleUtil::clear(pChannelInfo->m_pBuffer, MAX_BUFFER_LEN);
+    pChannelInfo->m_pDelayCompensation = new EngineDelayCompensation();
     m_channels.append(pChannelInfo);
+    m_callbackProfiler.registerChannel(pChannelInfo->m_index, group);
     const GainCache gainCacheDefault = {0, false};
     m_channelHeadphoneGainCache.append(gainCacheDefault);
     m_channelTalkoverGainCache.append(gainCacheDefault);
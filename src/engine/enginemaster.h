@@ -24,6 +24,7 @@
 #include "preferences/usersettings.h"
 #include "control/controlobject.h"
 #include "control/controlpushbutton.h"
+#include "engine/callbackprofiler.h"
 #include "engine/engineobject.h"
 #include "engine/enginechannel.h"
 #include "engine/channelhandle.h"
@@ -32,6 +33,7 @@
 #include "recording/recordingmanager.h"
 
 class EngineWorkerScheduler;
+class EngineChannelThreadPool;
 class EngineBuffer;
 class EngineChannel;
 class EngineDeck;
@@ -47,6 +49,7 @@ class GuiTick;
 class EngineSync;
 class EngineTalkoverDucking;
 class EngineDelay;
+class EngineDelayCompensation;
 
 // The number of channels to pre-allocate in various structures in the
 // engine. Prevents memory allocation in EngineMaster::addChannel.
@@ -55,6 +58,16 @@ static const int kPreallocatedChannels = 64;
 class EngineMaster : public QObject, public AudioSource {
     Q_OBJECT
   public:
+    // The buses that are only mixed if something consumes them. The bits
+    // of the buses that were skipped in the last callback are published
+    // in [Master],skipped_buses.
+    enum SkippedBus {
+        SKIPPED_HEADPHONES = 1,
+        SKIPPED_BOOTH = 2,
+        SKIPPED_TALKOVER = 4,
+        SKIPPED_CROSSFADER_BUSES = 8,
+    };
+
     EngineMaster(UserSettingsPointer pConfig,
                  const char* pGroup,
                  EffectsManager* pEffectsManager,
@@ -86,6 +99,20 @@ class EngineMaster : public QObject, public AudioSource {
 
     void process(const int iBufferSize);
 
+    // Like process(), but renders the mix of the output of the given type
+    // directly into pOutput instead of into the engine buffer of that
+    // output, and clamps it there, so the sound device does not need to copy
+    // it. This is only possible when pOutput is the only consumer of the mix,
+    // and only for MASTER and HEADPHONES, because other mixes are not rendered
+    // into a buffer of their own. Returns false if the mix was not rendered
+    // into pOutput, e.g. because it is disabled.
+    bool processInto(const int iBufferSize, AudioPath::AudioPathType type,
+            CSAMPLE* pOutput);
+
+    // Whether the engine workers, e.g. the readers of the decks, have done
+    // all the work that the previous callbacks have requested
+    bool workersIdle() const;
+
     // Add an EngineChannel to the mixing engine. This is not thread safe --
     // only call it before the engine has started mixing.
     void addChannel(EngineChannel* pChannel);
@@ -123,21 +150,39 @@ class EngineMaster : public QObject, public AudioSource {
         return m_pEngineSideChain;
     }
 
+    CallbackProfiler* getCallbackProfiler() {
+        return &m_callbackProfiler;
+    }
+
     struct ChannelInfo {
         ChannelInfo(int index)
                 : m_pChannel(NULL),
                   m_pBuffer(NULL),
                   m_pVolumeControl(NULL),
                   m_pMuteControl(NULL),
-                  m_index(index) {
+                  m_pDelayCompensation(NULL),
+                  m_index(index),
+                  m_processNanos(0),
+                  m_latencyFrames(0),
+                  m_bDelayCompensationStale(true) {
         }
         ChannelHandle m_handle;
         EngineChannel* m_pChannel;
         CSAMPLE* m_pBuffer;
         ControlObject* m_pVolumeControl;
         ControlPushButton* m_pMuteControl;
+        // Delays the channel to line it up with the channel that has the
+        // highest latency of its pre- and post-fader effects
+        EngineDelayCompensation* m_pDelayCompensation;
         GroupFeatureState m_features;
         int m_index;
+        // The time of the last process() call, only measured while the
+        // callback profiler is active
+        qint64 m_processNanos;
+        // The latency of the effects of the channel in the last callback
+        SINT m_latencyFrames;
+        // Set while the channel is inactive and its delay is not written
+        bool m_bDelayCompensationStale;
     };
 
     struct GainCache {
@@ -270,6 +315,12 @@ class EngineMaster : public QObject, public AudioSource {
     // m_activeTalkoverChannels with each channel that is active for the
     // respective output.
     void processChannels(int iBufferSize);
+    // Calls process() on the channel and collects its features for effects
+    void processChannel(ChannelInfo* pChannelInfo, int iBufferSize);
+    // Queries the effect latency of the active channels, sets the delays
+    // that line them up and reports the latency of the master output to
+    // VisualPlayPosition
+    void updateLatencyCompensation(int iBufferSize);
 
     ChannelHandleFactory* m_pChannelHandleFactory;
     void applyMasterEffects();
@@ -277,6 +328,8 @@ class EngineMaster : public QObject, public AudioSource {
 
     EngineEffectsManager* m_pEngineEffectsManager;
 
+    CallbackProfiler m_callbackProfiler;
+
     // List of channels added to the engine.
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_channels;
 
@@ -303,7 +356,14 @@ class EngineMaster : public QObject, public AudioSource {
     CSAMPLE* m_pTalkoverHeadphones;
     CSAMPLE* m_pSidechainMix;
 
+    // The target of processInto() during the callback
+    CSAMPLE* m_pDirectOutput;
+    AudioPath::AudioPathType m_directOutputType;
+    bool m_bDirectOutputRendered;
+
     EngineWorkerScheduler* m_pWorkerScheduler;
+    // Processes the channels in parallel, NULL if disabled
+    EngineChannelThreadPool* m_pChannelThreadPool;
     EngineSync* m_pMasterSync;
 
     ControlObject* m_pMasterGain;
@@ -334,6 +394,7 @@ class EngineMaster : public QObject, public AudioSource {
     ControlPushButton* m_pXFaderReverse;
     ControlPushButton* m_pHeadSplitEnabled;
     ControlObject* m_pKeylockEngine;
+    ControlObject* m_pVarispeedEngine;
 
     PflGainCalculator m_headphoneGain;
     TalkoverGainCalculator m_talkoverGain;
@@ -355,9 +416,16 @@ class EngineMaster : public QObject, public AudioSource {
     // Mix two Mono channels. This is useful for outdoor gigs
     ControlObject* m_pMasterMonoMixdown;
     ControlObject* m_pMicMonitorMode;
+    // The SkippedBus bits of the last callback
+    ControlObject* m_pSkippedBuses;
 
     volatile bool m_bBusOutputConnected[3];
     bool m_bExternalRecordBroadcastInputConnected;
+
+    // The channels are only delayed while an effect reports a latency
+    bool m_bLatencyCompensationActive;
+    SINT m_maxChannelLatencyFrames;
+    SINT m_outputLatencyFrames;
 };
 
 #endif
@@ -0,0 +1,274 @@
+#include "engine/engineofflinerenderer.h"
+
+#include <QFileInfo>
+
+#include "control/controlobject.h"
+#include "engine/enginemaster.h"
+#include "mixer/playermanager.h"
+#include "recording/defs_recording.h"
+#include "util/compatibility.h"
+#include "util/denormalsarezero.h"
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/performancetimer.h"
+#include "util/sample.h"
+
+namespace {
+
+const mixxx::Logger kLogger("EngineOfflineRenderer");
+
+// The buffers that are rendered before anything is started. The tracks that
+// have been loaded before the rendering has begun are available after the
+// first two, one for the reader to send the track and one for the main
+// thread to receive the signals of the loaded track.
+const int kLoadingBuffers = 4;
+
+// Rendering fails if no deck plays after this time, e.g. because the Auto DJ
+// queue is empty
+const double kMaxStartSecs = 30.0;
+
+// The interval for polling the workers and the main thread. Short compared
+// to the time it takes to process a buffer.
+const unsigned long kPollIntervalMicros = 50;
+
+Encoder::Format formatForFile(const QString& fileName,
+        UserSettingsPointer pConfig) {
+    QString suffix = QFileInfo(fileName).suffix().toUpper();
+    if (suffix == "AIF") {
+        suffix = ENCODING_AIFF;
+    }
+    const EncoderFactory& factory = EncoderFactory::getFactory();
+    for (const auto& format : factory.getFormats()) {
+        if (format.internalName == suffix) {
+            return format;
+        }
+    }
+    // Fall back to the format of the recording preferences
+    return factory.getSelectedFormat(pConfig);
+}
+
+} // anonymous namespace
+
+EngineOfflineRenderer::EngineOfflineRenderer(UserSettingsPointer pConfig,
+        EngineMaster* pEngine, const QString& fileName,
+        unsigned int sampleRate, SINT framesPerBuffer, double durationSecs,
+        bool autoDJ)
+        : m_pConfig(pConfig),
+          m_pEngine(pEngine),
+          m_fileName(fileName),
+          m_durationSecs(durationSecs),
+          m_bAutoDJ(autoDJ),
+          m_iSampleRate(sampleRate),
+          m_framesPerBuffer(framesPerBuffer),
+          m_buffer(framesPerBuffer * 2),
+          m_mainThreadSyncsRequested(0) {
+    // The engine only renders the master mix if a master output is connected
+    m_pEngine->onOutputConnected(AudioOutput(AudioOutput::MASTER, 0, 2));
+
+    const double bufferMSec = m_framesPerBuffer * 1000.0 / m_iSampleRate;
+    ControlObject::set(ConfigKey("[Master]", "samplerate"), m_iSampleRate);
+    ControlObject::set(ConfigKey("[Master]", "latency"), bufferMSec);
+    ControlObject::set(ConfigKey("[Master]", "audio_buffer_size"), bufferMSec);
+}
+
+EngineOfflineRenderer::~EngineOfflineRenderer() {
+    stop();
+}
+
+void EngineOfflineRenderer::stop() {
+    m_stop = 1;
+    wait();
+}
+
+void EngineOfflineRenderer::run() {
+#ifdef __SSE__
+    // Like the sound devices, to avoid the performance penalty of denormals
+    // https://bugs.launchpad.net/mixxx/+bug/1404401
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+#endif
+
+    if (!openEncoder()) {
+        emit(renderFinished(false));
+        return;
+    }
+
+    bool success = true;
+    for (int i = 0; i < kLoadingBuffers && success; ++i) {
+        processBuffer();
+        success = waitForWorkersAndMainThread();
+    }
+    startPlaying();
+
+    // Nothing is written until a deck plays, e.g. while Auto DJ loads the
+    // first track
+    const SINT maxStartBuffers = static_cast<SINT>(
+            kMaxStartSecs * m_iSampleRate / m_framesPerBuffer);
+    SINT startBuffers = 0;
+    while (success && !isPlaying()) {
+        if (startBuffers++ >= maxStartBuffers) {
+            kLogger.warning() << "No deck has been started, nothing rendered";
+            success = false;
+            break;
+        }
+        processBuffer();
+        success = waitForWorkersAndMainThread();
+    }
+
+    const SINT maxFrames = static_cast<SINT>(m_durationSecs * m_iSampleRate);
+    SINT frames = 0;
+    mixxx::Duration engineTime;
+    PerformanceTimer renderTimer;
+    renderTimer.start();
+    while (success && isPlaying() && (maxFrames <= 0 || frames < maxFrames)) {
+        PerformanceTimer bufferTimer;
+        bufferTimer.start();
+        processBuffer();
+        engineTime += bufferTimer.elapsed();
+
+        SINT bufferFrames = m_framesPerBuffer;
+        if (maxFrames > 0) {
+            bufferFrames = math_min(bufferFrames, maxFrames - frames);
+        }
+        m_pEncoder->encodeBuffer(m_buffer.data(), bufferFrames * 2);
+        frames += bufferFrames;
+
+        success = waitForWorkersAndMainThread();
+    }
+    const mixxx::Duration renderTime = renderTimer.elapsed();
+
+    stopPlaying();
+    m_pEncoder->flush();
+    m_pEncoder.reset();
+    m_file.close();
+
+    const double renderedSecs = static_cast<double>(frames) / m_iSampleRate;
+    const SINT buffers = (frames + m_framesPerBuffer - 1) / m_framesPerBuffer;
+    kLogger.info() << "Rendered" << renderedSecs << "s into" << m_fileName
+                   << "in" << renderTime.toDoubleSeconds() << "s,"
+                   << renderedSecs / math_max(renderTime.toDoubleSeconds(), 1e-9)
+                   << "times faster than real time";
+    if (buffers > 0) {
+        kLogger.info() << "Engine time per buffer of" << m_framesPerBuffer
+                       << "frames:" << engineTime.toDoubleMicros() / buffers
+                       << "us, the buffer lasts"
+                       << m_framesPerBuffer * 1e6 / m_iSampleRate << "us";
+    }
+    emit(renderFinished(success));
+}
+
+bool EngineOfflineRenderer::openEncoder() {
+    const Encoder::Format format = formatForFile(m_fileName, m_pConfig);
+    m_pEncoder = EncoderFactory::getFactory().getNewEncoder(
+            format, m_pConfig, this);
+
+    m_file.setFileName(m_fileName);
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        kLogger.warning() << "Could not open" << m_fileName << "for writing";
+        m_pEncoder.reset();
+        return false;
+    }
+    m_dataStream.setDevice(&m_file);
+
+    QString errorMsg;
+    if (m_pEncoder->initEncoder(m_iSampleRate, errorMsg) < 0) {
+        kLogger.warning() << "Could not initialize the" << format.label
+                          << "encoder" << errorMsg;
+        m_pEncoder.reset();
+        m_file.close();
+        return false;
+    }
+    kLogger.info() << "Rendering" << format.label << "to" << m_fileName
+                   << "with" << m_framesPerBuffer << "frames per buffer at"
+                   << m_iSampleRate << "Hz";
+    return true;
+}
+
+void EngineOfflineRenderer::processBuffer() {
+    const int iBufferSize = static_cast<int>(m_framesPerBuffer * 2);
+    if (!m_pEngine->processInto(iBufferSize, AudioPath::MASTER,
+            m_buffer.data())) {
+        SampleUtil::copyClampBuffer(m_buffer.data(),
+                m_pEngine->getMasterBuffer(), iBufferSize);
+    }
+}
+
+bool EngineOfflineRenderer::waitForWorkersAndMainThread() {
+    // The main thread processes the signals of this buffer before the sync,
+    // so all the work that it requests from the workers in return has been
+    // requested when the sync is done. Check the sync first for that reason.
+    ++m_mainThreadSyncsRequested;
+    QMetaObject::invokeMethod(this, "slotSyncMainThread", Qt::QueuedConnection);
+    while (load_atomic(m_mainThreadSyncsDone) != m_mainThreadSyncsRequested ||
+            !m_pEngine->workersIdle()) {
+        if (load_atomic(m_stop)) {
+            return false;
+        }
+        QThread::usleep(kPollIntervalMicros);
+    }
+    return !load_atomic(m_stop);
+}
+
+void EngineOfflineRenderer::slotSyncMainThread() {
+    m_mainThreadSyncsDone.ref();
+}
+
+void EngineOfflineRenderer::startPlaying() {
+    if (m_bAutoDJ) {
+        ControlObject::set(ConfigKey("[AutoDJ]", "enabled"), 1.0);
+        return;
+    }
+    const int numDecks = static_cast<int>(
+            ControlObject::get(ConfigKey("[Master]", "num_decks")));
+    for (int i = 0; i < numDecks; ++i) {
+        const QString group = PlayerManager::groupForDeck(i);
+        if (ControlObject::get(ConfigKey(group, "track_loaded")) > 0.0) {
+            ControlObject::set(ConfigKey(group, "play"), 1.0);
+        }
+    }
+}
+
+void EngineOfflineRenderer::stopPlaying() {
+    if (m_bAutoDJ) {
+        ControlObject::set(ConfigKey("[AutoDJ]", "enabled"), 0.0);
+    }
+    const int numDecks = static_cast<int>(
+            ControlObject::get(ConfigKey("[Master]", "num_decks")));
+    for (int i = 0; i < numDecks; ++i) {
+        ControlObject::set(
+                ConfigKey(PlayerManager::groupForDeck(i), "play"), 0.0);
+    }
+}
+
+bool EngineOfflineRenderer::isPlaying() const {
+    const int numDecks = static_cast<int>(
+            ControlObject::get(ConfigKey("[Master]", "num_decks")));
+    for (int i = 0; i < numDecks; ++i) {
+        if (ControlObject::get(
+                ConfigKey(PlayerManager::groupForDeck(i), "play")) > 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Encoder calls this method to write compressed audio
+void EngineOfflineRenderer::write(const unsigned char* header,
+        const unsigned char* body, int headerLen, int bodyLen) {
+    if (headerLen > 0) {
+        m_dataStream.writeRawData((const char*) header, headerLen);
+    }
+    m_dataStream.writeRawData((const char*) body, bodyLen);
+}
+
+int EngineOfflineRenderer::tell() {
+    return m_file.pos();
+}
+
+void EngineOfflineRenderer::seek(int pos) {
+    m_file.seek(static_cast<qint64>(pos));
+}
+
+int EngineOfflineRenderer::filelen() {
+    return m_file.size();
+}
@@ -0,0 +1,93 @@
+#ifndef ENGINEOFFLINERENDERER_H
+#define ENGINEOFFLINERENDERER_H
+
+#include <QAtomicInt>
+#include <QDataStream>
+#include <QFile>
+#include <QThread>
+
+#include "encoder/encoder.h"
+#include "encoder/encodercallback.h"
+#include "preferences/usersettings.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+class EngineMaster;
+
+// Drives the EngineMaster without a sound device, as fast as the CPU allows,
+// and encodes the master mix into a file with the Encoder of the format that
+// matches the file extension. This renders a set with the real engine, with
+// everything that is going on in it, e.g. sync, effects and the transitions
+// of Auto DJ.
+//
+// After each buffer the renderer waits until the engine workers have read
+// what has been requested and the main thread has processed the signals of
+// the engine, which is where e.g. Auto DJ reacts. So the result is the same
+// as from a sound card with the same buffer size that never underflows, and
+// the render speed is a benchmark of the engine with a realistic load.
+//
+// Nothing is rendered until a deck plays. The rendering stops when no deck
+// plays anymore, or after the given duration.
+//
+// No sound device must be open while rendering, because the renderer calls
+// EngineMaster::process() from its own thread.
+class EngineOfflineRenderer : public QThread, public EncoderCallback {
+    Q_OBJECT
+  public:
+    // A duration of 0 renders until no deck plays anymore. With autoDJ, Auto
+    // DJ is enabled when the tracks are loaded, otherwise all decks with a
+    // track are started.
+    EngineOfflineRenderer(UserSettingsPointer pConfig, EngineMaster* pEngine,
+            const QString& fileName, unsigned int sampleRate,
+            SINT framesPerBuffer, double durationSecs, bool autoDJ);
+    ~EngineOfflineRenderer() override;
+
+    // Stops rendering and waits for the thread. The file is complete up to
+    // where the rendering has been stopped.
+    void stop();
+
+    void write(const unsigned char* header, const unsigned char* body,
+            int headerLen, int bodyLen) override;
+    int tell() override;
+    void seek(int pos) override;
+    int filelen() override;
+
+  signals:
+    void renderFinished(bool success);
+
+  protected:
+    void run() override;
+
+  private slots:
+    void slotSyncMainThread();
+
+  private:
+    bool openEncoder();
+    void processBuffer();
+    // Returns false if the renderer has been stopped meanwhile
+    bool waitForWorkersAndMainThread();
+    void startPlaying();
+    void stopPlaying();
+    bool isPlaying() const;
+
+    UserSettingsPointer m_pConfig;
+    EngineMaster* const m_pEngine;
+    const QString m_fileName;
+    const double m_durationSecs;
+    const bool m_bAutoDJ;
+    const SINT m_iSampleRate;
+    const SINT m_framesPerBuffer;
+
+    EncoderPointer m_pEncoder;
+    QFile m_file;
+    QDataStream m_dataStream;
+    mixxx::SampleBuffer m_buffer;
+
+    QAtomicInt m_stop;
+    // The number of buffers after which the main thread was asked to process
+    // its events, and the number of these requests it has processed
+    int m_mainThreadSyncsRequested;
+    QAtomicInt m_mainThreadSyncsDone;
+};
+
+#endif // ENGINEOFFLINERENDERER_H
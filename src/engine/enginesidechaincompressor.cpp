@@ -1,6 +1,15 @@
 #include <QtDebug>
 
 #include "engine/enginesidechaincompressor.h"
+#include "util/math.h"
+
+namespace {
+
+// The key is searched in blocks of this many frames for a sample above the
+// threshold
+const int kKeyBlockFrames = 64;
+
+} // anonymous namespace
 
 EngineSideChainCompressor::EngineSideChainCompressor(const char* group)
         : m_compressRatio(0.0),
@@ -43,9 +52,21 @@ void EngineSideChainCompressor::clearKeys() {
 }
 
 void EngineSideChainCompressor::processKey(const CSAMPLE* pIn, const int iBufferSize) {
-    for (int i = 0; i + 1 < iBufferSize; i += 2) {
-        CSAMPLE val = (pIn[i] + pIn[i + 1]) / 2;
-        if (val > m_threshold) {
+    if (m_bAboveThreshold) {
+        // Another key has already triggered the compressor
+        return;
+    }
+    // Without a branch the maximum of a block is vectorized, only between
+    // the blocks we stop early if the key is above the threshold.
+    const int frames = iBufferSize / 2;
+    for (int start = 0; start < frames; start += kKeyBlockFrames) {
+        const int end = math_min(start + kKeyBlockFrames, frames);
+        CSAMPLE maxSum = pIn[start * 2] + pIn[start * 2 + 1];
+        for (int i = start + 1; i < end; ++i) {
+            const CSAMPLE sum = pIn[i * 2] + pIn[i * 2 + 1];
+            maxSum = sum > maxSum ? sum : maxSum;
+        }
+        if (maxSum / 2 > m_threshold) {
             m_bAboveThreshold = true;
             return;
         }
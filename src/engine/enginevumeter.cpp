@@ -21,7 +21,13 @@
 #include "util/math.h"
 #include "util/sample.h"
 
-EngineVuMeter::EngineVuMeter(QString group) {
+// static
+QMap<QString, QWeakPointer<VuMeterBlock> > EngineVuMeter::s_vuMeterBlocks;
+
+EngineVuMeter::EngineVuMeter(QString group)
+        : m_group(group),
+          m_pBlock(new VuMeterBlock()),
+          m_updateCount(0) {
     // The VUmeter widget is controlled via a controlpotmeter, which means
     // that it should react on the setValue(int) signal.
     m_ctrlVuMeter = new ControlPotmeter(ConfigKey(group, "VuMeter"), 0., 1.);
@@ -41,12 +47,17 @@ EngineVuMeter::EngineVuMeter(QString group) {
 
     m_pSampleRate = new ControlProxy("[Master]", "samplerate", this);
 
+    s_vuMeterBlocks.insert(m_group, m_pBlock);
+
     // Initialize the calculation:
     reset();
 }
 
 EngineVuMeter::~EngineVuMeter()
 {
+    if (s_vuMeterBlocks.value(m_group) == m_pBlock) {
+        s_vuMeterBlocks.remove(m_group);
+    }
     delete m_ctrlVuMeter;
     delete m_ctrlVuMeterL;
     delete m_ctrlVuMeterR;
@@ -55,18 +66,60 @@ EngineVuMeter::~EngineVuMeter()
     delete m_ctrlPeakIndicatorR;
 }
 
+// static
+QSharedPointer<const VuMeterBlock> EngineVuMeter::getVuMeterBlock(
+        const QString& group) {
+    return s_vuMeterBlocks.value(group).toStrongRef();
+}
+
 void EngineVuMeter::process(CSAMPLE* pIn, const int iBufferSize) {
-    CSAMPLE fVolSumL, fVolSumR;
+    SampleUtil::ChannelLevels levelsL;
+    SampleUtil::ChannelLevels levelsR;
 
     int sampleRate = (int)m_pSampleRate->get();
 
-    SampleUtil::CLIP_STATUS clipped = SampleUtil::sumAbsPerChannel(&fVolSumL,
-            &fVolSumR, pIn, iBufferSize);
-    m_fRMSvolumeSumL += fVolSumL;
-    m_fRMSvolumeSumR += fVolSumR;
+    // The levels and the clipping of both channels in a single pass
+    SampleUtil::CLIP_STATUS clipped = SampleUtil::levelsPerChannel(&levelsL,
+            &levelsR, pIn, iBufferSize);
+    m_fRMSvolumeSumL += levelsL.sumAbs;
+    m_fRMSvolumeSumR += levelsR.sumAbs;
+    m_fSquaresSumL += levelsL.sumSquares;
+    m_fSquaresSumR += levelsR.sumSquares;
+    m_fPeakL = math_max(m_fPeakL, levelsL.peak);
+    m_fPeakR = math_max(m_fPeakR, levelsR.peak);
 
     m_iSamplesCalculated += iBufferSize / 2;
 
+    bool clippingL = m_bClippingL;
+    if (clipped & SampleUtil::CLIPPING_LEFT) {
+        clippingL = true;
+        m_peakDurationL = PEAK_DURATION * sampleRate / iBufferSize / 2000;
+    } else if (m_peakDurationL <= 0) {
+        clippingL = false;
+    } else {
+        --m_peakDurationL;
+    }
+
+    bool clippingR = m_bClippingR;
+    if (clipped & SampleUtil::CLIPPING_RIGHT) {
+        clippingR = true;
+        m_peakDurationR = PEAK_DURATION * sampleRate / iBufferSize / 2000;
+    } else if (m_peakDurationR <= 0) {
+        clippingR = false;
+    } else {
+        --m_peakDurationR;
+    }
+
+    // The peak indicators only change a few times per second at most, so
+    // the controls are not touched in the other callbacks.
+    if (clippingL != m_bClippingL || clippingR != m_bClippingR) {
+        m_bClippingL = clippingL;
+        m_bClippingR = clippingR;
+        m_ctrlPeakIndicatorL->set(m_bClippingL ? 1. : 0.);
+        m_ctrlPeakIndicatorR->set(m_bClippingR ? 1. : 0.);
+        m_ctrlPeakIndicator->set(m_bClippingL || m_bClippingR ? 1. : 0.);
+    }
+
     // Are we ready to update the VU meter?:
     if (m_iSamplesCalculated > (sampleRate / VU_UPDATE_RATE)) {
         doSmooth(m_fRMSvolumeL,
@@ -91,31 +144,33 @@ void EngineVuMeter::process(CSAMPLE* pIn, const int iBufferSize) {
         if (fabs(fRMSvolume - m_ctrlVuMeter->get()) > epsilon)
             m_ctrlVuMeter->set(fRMSvolume);
 
+        publishLevels();
+
         // Reset calculation:
         m_iSamplesCalculated = 0;
         m_fRMSvolumeSumL = 0;
         m_fRMSvolumeSumR = 0;
+        m_fSquaresSumL = 0;
+        m_fSquaresSumR = 0;
+        m_fPeakL = 0;
+        m_fPeakR = 0;
     }
+}
 
-    if (clipped & SampleUtil::CLIPPING_LEFT) {
-        m_ctrlPeakIndicatorL->set(1.);
-        m_peakDurationL = PEAK_DURATION * sampleRate / iBufferSize / 2000;
-    } else if (m_peakDurationL <= 0) {
-        m_ctrlPeakIndicatorL->set(0.);
-    } else {
-        --m_peakDurationL;
-    }
-
-    if (clipped & SampleUtil::CLIPPING_RIGHT) {
-        m_ctrlPeakIndicatorR->set(1.);
-        m_peakDurationR = PEAK_DURATION * sampleRate / iBufferSize / 2000;
-    } else if (m_peakDurationR <= 0) {
-        m_ctrlPeakIndicatorR->set(0.);
-    } else {
-        --m_peakDurationR;
+void EngineVuMeter::publishLevels() {
+    VuMeterLevels levels;
+    levels.levelL = m_fRMSvolumeL;
+    levels.levelR = m_fRMSvolumeR;
+    if (m_iSamplesCalculated > 0) {
+        levels.rmsL = sqrt(m_fSquaresSumL / m_iSamplesCalculated);
+        levels.rmsR = sqrt(m_fSquaresSumR / m_iSamplesCalculated);
     }
-
-    m_ctrlPeakIndicator->set(m_ctrlPeakIndicatorR->get() || m_ctrlPeakIndicatorL->get());
+    levels.peakL = m_fPeakL;
+    levels.peakR = m_fPeakR;
+    levels.clippingL = m_bClippingL;
+    levels.clippingR = m_bClippingR;
+    levels.updateCount = ++m_updateCount;
+    m_pBlock->setValue(levels);
 }
 
 void EngineVuMeter::doSmooth(CSAMPLE &currentVolume, CSAMPLE newVolume)
@@ -143,6 +198,14 @@ void EngineVuMeter::reset() {
     m_fRMSvolumeSumL = 0;
     m_fRMSvolumeR = 0;
     m_fRMSvolumeSumR = 0;
+    m_fSquaresSumL = 0;
+    m_fSquaresSumR = 0;
+    m_fPeakL = 0;
+    m_fPeakR = 0;
     m_peakDurationL = 0;
     m_peakDurationR = 0;
+    m_bClippingL = false;
+    m_bClippingR = false;
+
+    publishLevels();
 }
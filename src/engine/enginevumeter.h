@@ -17,6 +17,11 @@
 #ifndef ENGINEVUMETER_H
 #define ENGINEVUMETER_H
 
+#include <QMap>
+#include <QSharedPointer>
+#include <QWeakPointer>
+
+#include "control/controlvalue.h"
 #include "engine/engineobject.h"
 
 // Rate at which the vumeter is updated (using a sample rate of 44100 Hz):
@@ -31,6 +36,40 @@
 class ControlPotmeter;
 class ControlProxy;
 
+// The levels of a VU meter, published by the engine VU_UPDATE_RATE times
+// per second. Unlike the controls they can be polled lock free at any
+// rate, e.g. by widgets at their frame rate or by controller outputs.
+struct VuMeterLevels {
+    VuMeterLevels()
+            : levelL(0),
+              levelR(0),
+              rmsL(0),
+              rmsR(0),
+              peakL(0),
+              peakR(0),
+              clippingL(false),
+              clippingR(false),
+              updateCount(0) {
+    }
+    // The smoothed levels of [group],VuMeterL and [group],VuMeterR
+    CSAMPLE levelL;
+    CSAMPLE levelR;
+    // The RMS and the peak of the samples since the previous update,
+    // CSAMPLE_PEAK is full scale
+    CSAMPLE rmsL;
+    CSAMPLE rmsR;
+    CSAMPLE peakL;
+    CSAMPLE peakR;
+    // The state of [group],PeakIndicatorL and [group],PeakIndicatorR
+    bool clippingL;
+    bool clippingR;
+    // Incremented with every update, so a reader can tell if the levels
+    // are new
+    unsigned int updateCount;
+};
+
+typedef ControlValueAtomic<VuMeterLevels> VuMeterBlock;
+
 class EngineVuMeter : public EngineObject {
     Q_OBJECT
   public:
@@ -41,8 +80,16 @@ class EngineVuMeter : public EngineObject {
 
     void reset();
 
+    // Returns the block with the levels of the VU meter of the group, or
+    // null if there is none.
+    // WARNING: Not thread safe. This function must only be called from the
+    // main thread.
+    static QSharedPointer<const VuMeterBlock> getVuMeterBlock(
+            const QString& group);
+
   private:
     void doSmooth(CSAMPLE &currentVolume, CSAMPLE newVolume);
+    void publishLevels();
 
     ControlPotmeter* m_ctrlVuMeter;
     ControlPotmeter* m_ctrlVuMeterL;
@@ -51,6 +98,10 @@ class EngineVuMeter : public EngineObject {
     CSAMPLE m_fRMSvolumeSumL;
     CSAMPLE m_fRMSvolumeR;
     CSAMPLE m_fRMSvolumeSumR;
+    CSAMPLE m_fSquaresSumL;
+    CSAMPLE m_fSquaresSumR;
+    CSAMPLE m_fPeakL;
+    CSAMPLE m_fPeakR;
     int m_iSamplesCalculated;
 
     ControlPotmeter* m_ctrlPeakIndicator;
@@ -58,8 +109,17 @@ class EngineVuMeter : public EngineObject {
     ControlPotmeter* m_ctrlPeakIndicatorR;
     int m_peakDurationL;
     int m_peakDurationR;
+    // The states of the peak indicators, which are only set on changes
+    bool m_bClippingL;
+    bool m_bClippingR;
 
     ControlProxy* m_pSampleRate;
+
+    QString m_group;
+    QSharedPointer<VuMeterBlock> m_pBlock;
+    unsigned int m_updateCount;
+
+    static QMap<QString, QWeakPointer<VuMeterBlock> > s_vuMeterBlocks;
 };
 
 #endif
@@ -2,16 +2,23 @@
 // Created 6/2/2010 by RJ Ryan (rryan@mit.edu)
 
 #include "engine/engineworker.h"
+#include "engine/engineworkerpool.h"
 #include "engine/engineworkerscheduler.h"
+#include "util/compatibility.h"
 
-EngineWorker::EngineWorker()
-    : m_pScheduler(NULL) {
+EngineWorker::EngineWorker(Priority priority, EngineWorkerPool* pPool)
+    : m_priority(priority),
+      m_pPool(pPool),
+      m_pScheduler(NULL),
+      m_workRequestsDone(0),
+      m_bQuit(false) {
 }
 
 EngineWorker::~EngineWorker() {
 }
 
-void EngineWorker::run() {
+EngineWorkerPool* EngineWorker::pool() const {
+    return m_pPool ? m_pPool : EngineWorkerPool::instance();
 }
 
 void EngineWorker::setScheduler(EngineWorkerScheduler* pScheduler) {
@@ -20,8 +27,31 @@ void EngineWorker::setScheduler(EngineWorkerScheduler* pScheduler) {
 
 bool EngineWorker::workReady() {
     if (m_pScheduler) {
+        // Count the request at the scheduler first, so its count of pending
+        // requests never drops below zero.
         m_pScheduler->workerReady(this);
+        m_workRequests.ref();
         return true;
     }
     return false;
 }
+
+void EngineWorker::wake() {
+    pool()->wake(this);
+}
+
+void EngineWorker::quitWait() {
+    pool()->quitWait(this);
+}
+
+int EngineWorker::workRequests() const {
+    return load_atomic(m_workRequests);
+}
+
+void EngineWorker::workDone(int workRequests) {
+    const int done = workRequests - m_workRequestsDone;
+    if (done > 0 && m_pScheduler) {
+        m_workRequestsDone = workRequests;
+        m_pScheduler->workerDone(done);
+    }
+}
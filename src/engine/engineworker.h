@@ -6,35 +6,82 @@
 
 #include <QAtomicInt>
 #include <QObject>
-#include <QSemaphore>
-#include <QThread>
 
 // EngineWorker is an interface for running background processing work when the
 // audio callback is not active. While the audio callback is active, an
 // EngineWorker can emit its workReady signal, and an EngineWorkerManager will
 // schedule it for running after the audio callback has completed.
+//
+// The workers do not have threads of their own, they are run by the threads
+// of an EngineWorkerPool.
 
+class EngineWorkerPool;
 class EngineWorkerScheduler;
 
-class EngineWorker : public QThread {
+class EngineWorker : public QObject {
     Q_OBJECT
   public:
-    EngineWorker();
-    virtual ~EngineWorker();
+    // The order in which the pool serves the workers that have work
+    enum class Priority {
+        // Workers that the engine waits for, e.g. the readers of decks
+        High = 0,
+        Normal,
+        // Workers that prefetch for later, e.g. the readers of samplers
+        Low,
+    };
+    static constexpr int kNumPriorities = 3;
 
-    virtual void run();
+    // Without a pool the shared EngineWorkerPool::instance() is used
+    explicit EngineWorker(Priority priority = Priority::Normal,
+            EngineWorkerPool* pPool = nullptr);
+    ~EngineWorker() override;
+
+    // Does a bounded amount of work, e.g. reads a single chunk, and returns
+    // true if there is more work to do right away. Otherwise the worker is
+    // run again when it is woken up. Never called by two threads at the
+    // same time.
+    virtual bool runOnce() = 0;
 
     void setScheduler(EngineWorkerScheduler* pScheduler);
     bool workReady();
-    void wake() {
-        m_semaRun.release();
+    // Queues the worker in the pool. The engine callback must use
+    // workReady() instead.
+    void wake();
+
+    // Waits until the worker is not running anymore and does not run it
+    // again. Must be called before the members of the subclass are
+    // destroyed.
+    void quitWait();
+
+    Priority priority() const {
+        return m_priority;
     }
 
   protected:
-    QSemaphore m_semaRun;
+    // The number of times workReady() has been called. A worker takes this
+    // before it looks for work and passes it to workDone() when it has found
+    // none, so the scheduler knows that everything requested up to then has
+    // been done.
+    int workRequests() const;
+    void workDone(int workRequests);
 
   private:
+    friend class EngineWorkerPool;
+
+    EngineWorkerPool* pool() const;
+
+    const Priority m_priority;
+    EngineWorkerPool* const m_pPool;
     EngineWorkerScheduler* m_pScheduler;
+    QAtomicInt m_workRequests;
+    // Only touched by the pool thread that runs the worker
+    int m_workRequestsDone;
+
+    // The number of wake() calls that the pool has not handled yet. The
+    // worker is queued or running as long as this is not 0.
+    QAtomicInt m_wakeups;
+    // Guarded by the mutex of the pool
+    bool m_bQuit;
 };
 
 #endif /* ENGINEWORKER_H */
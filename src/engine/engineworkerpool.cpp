@@ -0,0 +1,129 @@
+#include "engine/engineworkerpool.h"
+
+#include <QThread>
+
+#include "util/compatibility.h"
+#include "util/math.h"
+#include "util/threadroles.h"
+
+namespace {
+
+// The readers mostly wait for the disk and the decoders, so a few threads
+// keep up with many players
+const int kMaxDefaultNumThreads = 4;
+
+QAtomicInt s_numThreads(0);
+
+} // anonymous namespace
+
+class EngineWorkerPool::Thread : public QThread {
+  public:
+    Thread(EngineWorkerPool* pPool, int index)
+            : m_pPool(pPool) {
+        setObjectName(QString("EngineWorker %1").arg(index));
+    }
+
+  protected:
+    void run() override {
+        mixxx::ThreadRoles::applyToCurrentThread(
+                mixxx::ThreadRole::EngineWorker);
+        m_pPool->runWorkers();
+    }
+
+  private:
+    EngineWorkerPool* const m_pPool;
+};
+
+EngineWorkerPool::EngineWorkerPool(int numThreads)
+        : m_bQuit(false) {
+    for (int i = 0; i < math_max(numThreads, 1); ++i) {
+        Thread* pThread = new Thread(this, i);
+        pThread->start(QThread::HighPriority);
+        m_threads.append(pThread);
+    }
+}
+
+EngineWorkerPool::~EngineWorkerPool() {
+    m_mutex.lock();
+    m_bQuit = true;
+    m_workerQueued.wakeAll();
+    m_mutex.unlock();
+    for (Thread* pThread : m_threads) {
+        pThread->wait();
+        delete pThread;
+    }
+}
+
+// static
+EngineWorkerPool* EngineWorkerPool::instance() {
+    static EngineWorkerPool s_pool(load_atomic(s_numThreads) > 0 ?
+            load_atomic(s_numThreads) : defaultNumThreads());
+    return &s_pool;
+}
+
+// static
+void EngineWorkerPool::setNumThreads(int numThreads) {
+    s_numThreads = numThreads;
+}
+
+// static
+int EngineWorkerPool::defaultNumThreads() {
+    return math_clamp(QThread::idealThreadCount(), 2, kMaxDefaultNumThreads);
+}
+
+void EngineWorkerPool::wake(EngineWorker* pWorker) {
+    // Only the first wakeup queues the worker, the thread that runs it
+    // takes care of the ones that follow.
+    if (pWorker->m_wakeups.fetchAndAddOrdered(1) > 0) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    if (!pWorker->m_bQuit) {
+        m_queues[static_cast<int>(pWorker->priority())].enqueue(pWorker);
+        m_workerQueued.wakeOne();
+    }
+}
+
+void EngineWorkerPool::quitWait(EngineWorker* pWorker) {
+    QMutexLocker locker(&m_mutex);
+    pWorker->m_bQuit = true;
+    m_queues[static_cast<int>(pWorker->priority())].removeAll(pWorker);
+    while (m_runningWorkers.contains(pWorker)) {
+        m_workerFinished.wait(&m_mutex);
+    }
+}
+
+EngineWorker* EngineWorkerPool::dequeueWorker() {
+    for (auto& queue : m_queues) {
+        if (!queue.isEmpty()) {
+            return queue.dequeue();
+        }
+    }
+    return nullptr;
+}
+
+void EngineWorkerPool::runWorkers() {
+    QMutexLocker locker(&m_mutex);
+    while (!m_bQuit) {
+        EngineWorker* pWorker = dequeueWorker();
+        if (!pWorker) {
+            m_workerQueued.wait(&m_mutex);
+            continue;
+        }
+        m_runningWorkers.append(pWorker);
+        locker.unlock();
+
+        // The wakeups up to here are handled by this run. If there have
+        // been more meanwhile the worker might have missed their work.
+        const int wakeups = pWorker->m_wakeups.loadAcquire();
+        const bool bRunAgain = pWorker->runOnce() ||
+                pWorker->m_wakeups.fetchAndAddOrdered(-wakeups) != wakeups;
+
+        locker.relock();
+        m_runningWorkers.removeOne(pWorker);
+        if (bRunAgain && !pWorker->m_bQuit) {
+            m_queues[static_cast<int>(pWorker->priority())].enqueue(pWorker);
+        }
+        m_workerFinished.wakeAll();
+    }
+}
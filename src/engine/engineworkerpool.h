@@ -0,0 +1,69 @@
+#ifndef ENGINEWORKERPOOL_H
+#define ENGINEWORKERPOOL_H
+
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+
+#include "engine/engineworker.h"
+#include "util/class.h"
+
+// A fixed number of threads that run all EngineWorkers, instead of a thread
+// for each worker. Workers that have been woken up are queued by their
+// priority and a pool thread calls their runOnce() until they report that
+// they have no more work. A worker that has more work is queued again
+// behind the workers of the same priority, so e.g. all deck readers are
+// served before any sampler reader, and a deck that preloads a whole track
+// does not hold up the others.
+//
+// Waking up a worker takes a mutex, so the engine callback does not do
+// that directly, see EngineWorkerScheduler.
+class EngineWorkerPool {
+  public:
+    explicit EngineWorkerPool(int numThreads);
+    virtual ~EngineWorkerPool();
+
+    // The pool of all workers that are not given a pool of their own. It
+    // is created when it is used first, with the number of threads of the
+    // last call of setNumThreads() up to then.
+    static EngineWorkerPool* instance();
+    // Has no effect after the shared pool has been created
+    static void setNumThreads(int numThreads);
+    static int defaultNumThreads();
+
+    int numThreads() const {
+        return m_threads.size();
+    }
+
+    // Queues the worker unless it is queued or running already
+    void wake(EngineWorker* pWorker);
+
+    // Removes the worker from the queue and waits until no thread runs it
+    // anymore. It is not queued again afterwards.
+    void quitWait(EngineWorker* pWorker);
+
+  private:
+    class Thread;
+
+    // Runs the queued workers until the pool quits
+    void runWorkers();
+
+    // Returns the first worker of the highest priority, or null if none is
+    // queued. Must be called with the mutex locked.
+    EngineWorker* dequeueWorker();
+
+    QList<Thread*> m_threads;
+
+    QMutex m_mutex;
+    QWaitCondition m_workerQueued;
+    QWaitCondition m_workerFinished;
+    QQueue<EngineWorker*> m_queues[EngineWorker::kNumPriorities];
+    // A worker may appear twice while it is handed over to another thread
+    QList<EngineWorker*> m_runningWorkers;
+    bool m_bQuit;
+
+    DISALLOW_COPY_AND_ASSIGN(EngineWorkerPool);
+};
+
+#endif /* ENGINEWORKERPOOL_H */
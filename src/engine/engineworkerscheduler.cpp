@@ -5,6 +5,7 @@
 
 #include "engine/engineworker.h"
 #include "engine/engineworkerscheduler.h"
+#include "util/compatibility.h"
 #include "util/event.h"
 
 EngineWorkerScheduler::EngineWorkerScheduler(QObject* pParent)
@@ -24,6 +25,7 @@ EngineWorkerScheduler::~EngineWorkerScheduler() {
 
 void EngineWorkerScheduler::workerReady(EngineWorker* pWorker) {
     if (pWorker) {
+        m_pendingWorkRequests.ref();
         // If the write fails, we really can't do much since we should not block
         // in this slot. Write the address of the variable pWorker, since it is
         // a 1-element array.
@@ -32,6 +34,14 @@ void EngineWorkerScheduler::workerReady(EngineWorker* pWorker) {
     }
 }
 
+void EngineWorkerScheduler::workerDone(int done) {
+    m_pendingWorkRequests.fetchAndAddRelease(-done);
+}
+
+bool EngineWorkerScheduler::workersIdle() const {
+    return load_atomic(m_pendingWorkRequests) == 0;
+}
+
 void EngineWorkerScheduler::runWorkers() {
     // Wake the scheduler if we have written a worker-ready message to the
     // scheduler. There is no race condition in accessing this boolean because
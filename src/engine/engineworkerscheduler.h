@@ -1,6 +1,7 @@
 #ifndef ENGINEWORKERSCHEDULER_H
 #define ENGINEWORKERSCHEDULER_H
 
+#include <QAtomicInt>
 #include <QMutex>
 #include <QThreadPool>
 #include <QWaitCondition>
@@ -21,6 +22,13 @@ class EngineWorkerScheduler : public QThread {
 
     void runWorkers();
     void workerReady(EngineWorker* worker);
+    // Called by a worker when it has done some of the requested work
+    void workerDone(int done);
+
+    // Whether all workers have done the work that has been requested from
+    // them. The engine callback does not wait for the workers, but the
+    // offline renderer does, otherwise it would run ahead of the readers.
+    bool workersIdle() const;
 
   protected:
     void run();
@@ -34,6 +42,7 @@ class EngineWorkerScheduler : public QThread {
     QWaitCondition m_waitCondition;
     QMutex m_mutex;
     volatile bool m_bQuit;
+    QAtomicInt m_pendingWorkRequests;
 };
 
 #endif /* ENGINEWORKERSCHEDULER_H */
@@ -0,0 +1,162 @@
+#include "engine/jumptargetbuffers.h"
+
+#include <QVarLengthArray>
+
+#include "mixer/playermanager.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+const QString kConfigGroup = QStringLiteral("[CachingReader]");
+
+// A few hotcues besides the loop, most players do not need more
+const int kDefaultNumTargetsDeck = 4;
+// Samplers are mostly played from their start
+const int kDefaultNumTargetsSampler = 0;
+
+const SINT kChannels = CachingReaderChunk::kChannels;
+
+} // anonymous namespace
+
+// Covers the crossfade of a loop wrap for the usual buffer sizes
+const SINT JumpTargetBuffers::kFramesBefore = 2048;
+// About one chunk, like the hints of the cue points
+const SINT JumpTargetBuffers::kFramesAfter = 8192;
+
+JumpTargetBuffers::JumpTargetBuffers(int numTargets) {
+    const SINT numSamples = (kFramesBefore + kFramesAfter) * kChannels;
+    m_targets.resize(math_clamp(numTargets, 0, kMaxTargets));
+    for (Target& target : m_targets) {
+        target.frame = -1;
+        target.filled = false;
+        target.wanted = false;
+        target.pSamples = SampleUtil::alloc(numSamples);
+    }
+}
+
+JumpTargetBuffers::~JumpTargetBuffers() {
+    for (const Target& target : m_targets) {
+        SampleUtil::free(target.pSamples);
+    }
+}
+
+// static
+int JumpTargetBuffers::numTargetsForGroup(const QString& group,
+        const UserSettingsPointer& pConfig) {
+    const bool sampler = PlayerManager::isSamplerGroup(group);
+    const int defaultValue = sampler ?
+            kDefaultNumTargetsSampler : kDefaultNumTargetsDeck;
+    if (!pConfig) {
+        return defaultValue;
+    }
+    return math_clamp(pConfig->getValue(ConfigKey(kConfigGroup,
+            sampler ? "jump_targets_sampler" : "jump_targets_deck"),
+            defaultValue), 0, kMaxTargets);
+}
+
+void JumpTargetBuffers::update(const HintVector& hintList,
+        CachingReader* pReader) {
+    if (m_targets.isEmpty()) {
+        return;
+    }
+
+    // The loop in point of an enabled loop comes first, then the cue points.
+    // Backward hints are loop out points, which are not jumped to.
+    QVarLengthArray<SINT, kMaxTargets> frames;
+    for (int priority : { Hint::kPriorityLoop, Hint::kPriorityCue }) {
+        for (const Hint& hint : hintList) {
+            if (frames.size() == m_targets.size()) {
+                break;
+            }
+            if (hint.priority != priority ||
+                    hint.frameCount != Hint::kFrameCountForward ||
+                    hint.frame < 0) {
+                continue;
+            }
+            // The buffers are read at the positions of the reader
+            const SINT readerFrame = static_cast<SINT>(round(
+                    hint.frame * pReader->readerFramesPerTrackFrame()));
+            bool duplicate = false;
+            for (SINT frame : frames) {
+                duplicate = duplicate || frame == readerFrame;
+            }
+            if (!duplicate) {
+                frames.append(readerFrame);
+            }
+        }
+    }
+
+    // Keep the buffers of the targets that are still wanted and give the
+    // others to the new targets
+    for (Target& target : m_targets) {
+        target.wanted = false;
+        for (SINT frame : frames) {
+            target.wanted = target.wanted || target.frame == frame;
+        }
+    }
+    for (SINT frame : frames) {
+        bool found = false;
+        for (const Target& target : m_targets) {
+            found = found || target.frame == frame;
+        }
+        if (found) {
+            continue;
+        }
+        for (Target& target : m_targets) {
+            if (!target.wanted) {
+                target.frame = frame;
+                target.filled = false;
+                target.wanted = true;
+                break;
+            }
+        }
+    }
+
+    // Copying one buffer per callback keeps the cost of a new set of
+    // targets low. If the target is not in the cache yet, it is tried
+    // again in the next callback.
+    for (Target& target : m_targets) {
+        if (target.wanted && !target.filled) {
+            const SINT numSamples = (kFramesBefore + kFramesAfter) * kChannels;
+            target.filled = pReader->read(
+                    (target.frame - kFramesBefore) * kChannels, numSamples,
+                    false, target.pSamples) == numSamples;
+            break;
+        }
+    }
+}
+
+void JumpTargetBuffers::clear() {
+    for (Target& target : m_targets) {
+        target.frame = -1;
+        target.filled = false;
+    }
+}
+
+SINT JumpTargetBuffers::read(SINT startSample, SINT numSamples, bool reverse,
+        CSAMPLE* pBuffer) const {
+    if (numSamples <= 0) {
+        return 0;
+    }
+    // Like CachingReader::read(), in reverse the samples end at startSample
+    const SINT firstSample = reverse ? startSample - numSamples : startSample;
+    for (const Target& target : m_targets) {
+        if (!target.filled) {
+            continue;
+        }
+        const SINT bufferStart = (target.frame - kFramesBefore) * kChannels;
+        const SINT bufferEnd = (target.frame + kFramesAfter) * kChannels;
+        if (firstSample < bufferStart || firstSample + numSamples > bufferEnd) {
+            continue;
+        }
+        const CSAMPLE* pSamples = &target.pSamples[firstSample - bufferStart];
+        if (reverse) {
+            SampleUtil::copyReverse(pBuffer, pSamples, numSamples);
+        } else {
+            SampleUtil::copy(pBuffer, pSamples, numSamples);
+        }
+        return numSamples;
+    }
+    return 0;
+}
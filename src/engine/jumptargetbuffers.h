@@ -0,0 +1,71 @@
+#ifndef JUMPTARGETBUFFERS_H
+#define JUMPTARGETBUFFERS_H
+
+#include <QString>
+#include <QVector>
+
+#include "engine/cachingreader.h"
+#include "preferences/usersettings.h"
+#include "util/class.h"
+#include "util/types.h"
+
+// Copies of the audio around the positions that the play position is likely
+// to jump to, i.e. the frames of the loop and cue hints. A buffer is filled
+// from the cache of the CachingReader while the target is there, so when
+// the play position wraps around the loop or jumps to a hotcue after the
+// cache has lost the target or before it has read it, ReadAheadManager
+// reads from the buffer instead of returning silence. This includes the
+// samples before the loop in point that are crossfaded with the loop end,
+// and with a tight loop the whole loop.
+//
+// The number of targets for each player is read from
+// [CachingReader],jump_targets_deck and [CachingReader],jump_targets_sampler.
+// With 0 the buffers are disabled.
+//
+// Must only be used from the engine thread.
+class JumpTargetBuffers {
+  public:
+    static const int kMaxTargets = 8;
+    // The frames that are kept before and after each target
+    static const SINT kFramesBefore;
+    static const SINT kFramesAfter;
+
+    explicit JumpTargetBuffers(int numTargets);
+    virtual ~JumpTargetBuffers();
+
+    static int numTargetsForGroup(const QString& group,
+            const UserSettingsPointer& pConfig);
+
+    int numTargets() const {
+        return m_targets.size();
+    }
+
+    // Picks the targets from the hints, loops first, and fills at most one
+    // buffer of a target that has changed from the cache of the reader
+    void update(const HintVector& hintList, CachingReader* pReader);
+
+    // Forgets all targets, e.g. when another track is loaded
+    void clear();
+
+    // Reads the samples like CachingReader::read() if they are all in one
+    // of the buffers. Returns the number of samples that have been read,
+    // which is 0 if they are not.
+    SINT read(SINT startSample, SINT numSamples, bool reverse,
+            CSAMPLE* pBuffer) const;
+
+  private:
+    struct Target {
+        // The frame of the reader, -1 if unused
+        SINT frame;
+        bool filled;
+        // Only used by update()
+        bool wanted;
+        CSAMPLE* pSamples;
+    };
+
+    QVector<Target> m_targets;
+
+    DISALLOW_COPY_AND_ASSIGN(JumpTargetBuffers);
+};
+
+#endif // JUMPTARGETBUFFERS_H
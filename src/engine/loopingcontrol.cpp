@@ -406,32 +406,46 @@ double LoopingControl::nextTrigger(bool reverse,
     return kNoTrigger;
 }
 
+bool LoopingControl::getActiveLoop(double* pStartSample, double* pEndSample) const {
+    if (!m_bLoopingEnabled || m_bAdjustingLoopIn || m_bAdjustingLoopOut) {
+        return false;
+    }
+    const LoopSamples loopSamples = m_loopSamples.getValue();
+    if (loopSamples.start == kNoTrigger || loopSamples.end == kNoTrigger ||
+            loopSamples.start >= loopSamples.end) {
+        return false;
+    }
+    *pStartSample = loopSamples.start;
+    *pEndSample = loopSamples.end;
+    return true;
+}
+
 void LoopingControl::hintReader(HintVector* pHintList) {
     LoopSamples loopSamples = m_loopSamples.getValue();
     Hint loop_hint;
     // If the loop is enabled, then this is high priority because we will loop
-    // sometime potentially very soon! The current audio itself is priority 1,
-    // but we will issue ourselves at priority 2.
+    // sometime potentially very soon! The current audio itself has the
+    // highest priority, but we are next.
     if (m_bLoopingEnabled) {
         // If we're looping, hint the loop in and loop out, in case we reverse
         // into it. We could save information from process to tell which
         // direction we're going in, but that this is much simpler, and hints
         // aren't that bad to make anyway.
         if (loopSamples.start >= 0) {
-            loop_hint.priority = 2;
+            loop_hint.priority = Hint::kPriorityLoop;
             loop_hint.frame = SampleUtil::floorPlayPosToFrame(loopSamples.start);
             loop_hint.frameCount = Hint::kFrameCountForward;
             pHintList->append(loop_hint);
         }
         if (loopSamples.end >= 0) {
-            loop_hint.priority = 10;
+            loop_hint.priority = Hint::kPriorityLoop;
             loop_hint.frame = SampleUtil::ceilPlayPosToFrame(loopSamples.end);
             loop_hint.frameCount = Hint::kFrameCountBackward;
             pHintList->append(loop_hint);
         }
     } else {
         if (loopSamples.start >= 0) {
-            loop_hint.priority = 10;
+            loop_hint.priority = Hint::kPriorityCue;
             loop_hint.frame = SampleUtil::floorPlayPosToFrame(loopSamples.start);
             loop_hint.frameCount = Hint::kFrameCountForward;
             pHintList->append(loop_hint);
@@ -44,6 +44,11 @@ class LoopingControl : public EngineControl {
                        const double currentSample,
                        double *pTarget);
 
+    // Returns the loop that the play position wraps around, false if
+    // looping is disabled or the loop is being adjusted. Unlike
+    // nextTrigger() this has no side effects.
+    bool getActiveLoop(double* pStartSample, double* pEndSample) const;
+
     // hintReader will add to hintList hints both the loop in and loop out
     // sample, if set.
     void hintReader(HintVector* pHintList) override;
@@ -79,7 +79,14 @@ void QuantizeControl::setCurrentSample(const double dCurrentSample,
     // NOTE: This bypasses the epsilon calculation, but is there a way
     //       that could actually cause a problem?
     if (dCurrentSample < m_pCOPrevBeat->get() || dCurrentSample > m_pCONextBeat->get()) {
-        lookupBeatPositions(dCurrentSample);
+        const BeatSnapshot* pSnapshot = getBeatSnapshot(dCurrentSample, m_pBeats);
+        if (pSnapshot) {
+            // EngineBuffer has searched the beats for this callback already
+            m_pCOPrevBeat->set(pSnapshot->prevBeat);
+            m_pCONextBeat->set(pSnapshot->nextBeat);
+        } else {
+            lookupBeatPositions(dCurrentSample);
+        }
     }
     updateClosestBeat(dCurrentSample);
 }
@@ -87,7 +94,8 @@ void QuantizeControl::setCurrentSample(const double dCurrentSample,
 void QuantizeControl::lookupBeatPositions(double dCurrentSample) {
     if (m_pBeats) {
         double prevBeat, nextBeat;
-        m_pBeats->findPrevNextBeats(dCurrentSample, &prevBeat, &nextBeat);
+        m_pBeats->findPrevNextBeats(dCurrentSample, &prevBeat, &nextBeat,
+                                    &m_beatCursor);
         m_pCOPrevBeat->set(prevBeat);
         m_pCONextBeat->set(nextBeat);
     }
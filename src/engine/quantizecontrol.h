@@ -41,6 +41,7 @@ class QuantizeControl : public EngineControl {
 
     TrackPointer m_pTrack;
     BeatsPointer m_pBeats;
+    BeatCursor m_beatCursor;
 };
 
 #endif // QUANTIZECONTROL_H
@@ -8,12 +8,14 @@
 #include "control/controlproxy.h"
 #include "util/rotary.h"
 #include "util/math.h"
+#include "util/time.h"
 #include "vinylcontrol/defs_vinylcontrol.h"
 
 #include "engine/bpmcontrol.h"
 #include "engine/enginecontrol.h"
 #include "engine/ratecontrol.h"
 #include "engine/positionscratchcontroller.h"
+#include "engine/vinylpitchchannel.h"
 
 #include <QtDebug>
 
@@ -80,6 +82,7 @@ RateControl::RateControl(QString group,
     m_pVCEnabled = ControlObject::getControl(ConfigKey(getGroup(), "vinylcontrol_enabled"));
     m_pVCScratching = ControlObject::getControl(ConfigKey(getGroup(), "vinylcontrol_scratching"));
     m_pVCMode = ControlObject::getControl(ConfigKey(getGroup(), "vinylcontrol_mode"));
+    m_pVinylPitchChannel = VinylPitchChannel::forGroup(getGroup());
 
     // Permanent rate-change buttons
     buttonRatePermDown =
@@ -460,7 +463,11 @@ double RateControl::calculateSpeed(double baserate, double speed, bool paused,
             if (m_pVCScratching->toBool()) {
                 *pReportScratching = true;
             }
-            rate = speed;
+            // The decoded rate is followed to the time of this callback,
+            // before falling back to the vinylcontrol_rate control
+            if (!m_pVinylPitchChannel->rateAt(mixxx::Time::elapsed(), &rate)) {
+                rate = speed;
+            }
         } else {
             double scratchFactor = m_pScratch2->get();
             // Don't trust values from m_pScratch2
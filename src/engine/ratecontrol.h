@@ -9,6 +9,7 @@
 #include "preferences/usersettings.h"
 #include "engine/enginecontrol.h"
 #include "engine/sync/syncable.h"
+#include "util/memory.h"
 
 const int RATE_TEMP_STEP = 500;
 const int RATE_TEMP_STEP_SMALL = RATE_TEMP_STEP * 10.;
@@ -24,6 +25,7 @@ class ControlPushButton;
 class ControlProxy;
 class EngineChannel;
 class PositionScratchController;
+class VinylPitchChannel;
 
 // RateControl is an EngineControl that is in charge of managing the rate of
 // playback of a given channel of audio in the Mixxx engine. Using input from
@@ -158,6 +160,7 @@ public:
     ControlObject* m_pVCEnabled;
     ControlObject* m_pVCScratching;
     ControlObject* m_pVCMode;
+    std::shared_ptr<VinylPitchChannel> m_pVinylPitchChannel;
     ControlObject* m_pScratch2Scratching;
     Rotary* m_pJogFilter;
 
@@ -12,22 +12,30 @@
 
 static const int kNumChannels = 2;
 
+// The frames that are hinted ahead of the play position at normal speed
+// and at most, at higher rates in between
+static const SINT kMinReadAheadFrames = 2 * CachingReaderChunk::kFrames;
+static const SINT kMaxReadAheadFrames = 8 * CachingReaderChunk::kFrames;
+
 ReadAheadManager::ReadAheadManager()
         : m_pLoopingControl(NULL),
           m_pRateControl(NULL),
           m_currentPosition(0),
           m_pReader(NULL),
-          m_pCrossFadeBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)) {
+          m_pCrossFadeBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
+          m_jumpTargets(0) {
     // For testing only: ReadAheadManagerMock
 }
 
 ReadAheadManager::ReadAheadManager(CachingReader* pReader,
-                                   LoopingControl* pLoopingControl)
+                                   LoopingControl* pLoopingControl,
+                                   int numJumpTargets)
         : m_pLoopingControl(pLoopingControl),
           m_pRateControl(NULL),
           m_currentPosition(0),
           m_pReader(pReader),
-          m_pCrossFadeBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)) {
+          m_pCrossFadeBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
+          m_jumpTargets(numJumpTargets) {
     DEBUG_ASSERT(m_pLoopingControl != NULL);
     DEBUG_ASSERT(m_pReader != NULL);
 }
@@ -52,6 +60,11 @@ SINT ReadAheadManager::getNextSamples(double dRate, CSAMPLE* pOutput,
     const double loop_trigger = m_pLoopingControl->nextTrigger(
             in_reverse, m_currentPosition, &target);
 
+    // The samples of the reader differ from the samples of the track if
+    // the track has been converted to the sample rate of the engine, all
+    // positions are kept in samples of the track
+    const double readerRatio = readerSamplesPerTrackSample();
+
     SINT preloop_samples = 0;
     double samplesToLoopTrigger = 0.0;
 
@@ -59,9 +72,9 @@ SINT ReadAheadManager::getNextSamples(double dRate, CSAMPLE* pOutput,
 
     SINT samples_from_reader = requested_samples;
     if (loop_trigger != kNoTrigger) {
-        samplesToLoopTrigger = in_reverse ?
+        samplesToLoopTrigger = readerRatio * (in_reverse ?
                 m_currentPosition - loop_trigger :
-                loop_trigger - m_currentPosition;
+                loop_trigger - m_currentPosition);
         if (samplesToLoopTrigger >= 0.0) {
             // We can only read whole frames from the reader.
             // Use ceil here, to be sure to reach the loop trigger.
@@ -82,9 +95,9 @@ SINT ReadAheadManager::getNextSamples(double dRate, CSAMPLE* pOutput,
     }
 
     SINT start_sample = SampleUtil::roundPlayPosToFrameStart(
-            m_currentPosition, kNumChannels);
+            m_currentPosition * readerRatio, kNumChannels);
 
-    SINT samples_read = m_pReader->read(
+    SINT samples_read = readSamples(
             start_sample, samples_from_reader, in_reverse, pOutput);
 
     if (samples_read != samples_from_reader) {
@@ -94,12 +107,13 @@ SINT ReadAheadManager::getNextSamples(double dRate, CSAMPLE* pOutput,
     // Increment or decrement current read-ahead position
     // Mixing int and double here is desired, because the fractional frame should
     // be resist
+    const double track_samples_read = samples_read / readerRatio;
     if (in_reverse) {
-        addReadLogEntry(m_currentPosition, m_currentPosition - samples_read);
-        m_currentPosition -= samples_read;
+        addReadLogEntry(m_currentPosition, m_currentPosition - track_samples_read);
+        m_currentPosition -= track_samples_read;
     } else {
-        addReadLogEntry(m_currentPosition, m_currentPosition + samples_read);
-        m_currentPosition += samples_read;
+        addReadLogEntry(m_currentPosition, m_currentPosition + track_samples_read);
+        m_currentPosition += track_samples_read;
     }
 
     // Activate on this trigger if necessary
@@ -113,7 +127,7 @@ SINT ReadAheadManager::getNextSamples(double dRate, CSAMPLE* pOutput,
             double overshoot = preloop_samples - samplesToLoopTrigger;
             // start the loop later accordingly to be sure the loop length is as desired
             // e.g. exactly one bar.
-            m_currentPosition += overshoot;
+            m_currentPosition += overshoot / readerRatio;
 
             // Example in frames;
             // loop start 1.1 loop end 3.3 loop length 2.2
@@ -129,9 +143,11 @@ SINT ReadAheadManager::getNextSamples(double dRate, CSAMPLE* pOutput,
         // start reading before the loop start point, to crossfade these samples
         // with the samples we need to the loop end
         int loop_read_position = SampleUtil::roundPlayPosToFrameStart(
-                m_currentPosition + (in_reverse ? preloop_samples : -preloop_samples), kNumChannels);
+                m_currentPosition * readerRatio +
+                        (in_reverse ? preloop_samples : -preloop_samples),
+                kNumChannels);
 
-        int looping_samples_read = m_pReader->read(
+        int looping_samples_read = readSamples(
                 loop_read_position, samples_read, in_reverse, m_pCrossFadeBuffer);
 
         if (looping_samples_read != samples_read) {
@@ -148,6 +164,32 @@ SINT ReadAheadManager::getNextSamples(double dRate, CSAMPLE* pOutput,
     return samples_read;
 }
 
+SINT ReadAheadManager::readSamples(SINT startSample, SINT numSamples,
+        bool reverse, CSAMPLE* pBuffer) {
+    SINT samplesRead = m_pReader->read(startSample, numSamples, reverse, pBuffer);
+    if (samplesRead == 0 && numSamples > 0) {
+        // The reader has not got the samples in its cache. If this is a
+        // jump to a loop in point or a cue, the samples might be kept in a
+        // jump target buffer.
+        samplesRead = m_jumpTargets.read(startSample, numSamples, reverse, pBuffer);
+    }
+    return samplesRead;
+}
+
+double ReadAheadManager::readerSamplesPerTrackSample() const {
+    return m_pReader ? m_pReader->readerFramesPerTrackFrame() : 1.0;
+}
+
+void ReadAheadManager::updateJumpTargets(const HintVector& hintList) {
+    if (m_pReader) {
+        m_jumpTargets.update(hintList, m_pReader);
+    }
+}
+
+void ReadAheadManager::clearJumpTargets() {
+    m_jumpTargets.clear();
+}
+
 void ReadAheadManager::addRateControl(RateControl* pRateControl) {
     m_pRateControl = pRateControl;
 }
@@ -168,34 +210,82 @@ void ReadAheadManager::notifySeek(double seekPosition) {
 
 void ReadAheadManager::hintReader(double dRate, HintVector* pHintList) {
     bool in_reverse = dRate < 0;
-    Hint current_position;
 
     // SoundTouch can read up to 2 chunks ahead. Always keep 2 chunks ahead in
-    // cache.
-    SINT frameCountToCache = 2 * CachingReaderChunk::kFrames;
-    current_position.frameCount = frameCountToCache;
+    // cache, and more if the track plays faster, so the same time is
+    // covered at high rates and while fast forwarding.
+    const SINT frameCountToCache = math_min(
+            static_cast<SINT>(kMinReadAheadFrames * math_max(1.0, fabs(dRate))),
+            kMaxReadAheadFrames);
 
     // this called after the precious chunk was consumed
-    if (in_reverse) {
-        current_position.frame =
-                static_cast<SINT>(ceil(m_currentPosition / kNumChannels)) -
-                frameCountToCache;
-    } else {
-        current_position.frame =
-                static_cast<SINT>(floor(m_currentPosition / kNumChannels));
+    const SINT currentFrame = in_reverse ?
+            static_cast<SINT>(ceil(m_currentPosition / kNumChannels)) :
+            static_cast<SINT>(floor(m_currentPosition / kNumChannels));
+
+    // The read-ahead stops at the end of an active loop and continues at
+    // the other end, where the play position will wrap to
+    SINT framesBeforeWrap = frameCountToCache;
+    SINT wrapFrame = 0;
+    double loopStart;
+    double loopEnd;
+    if (m_pLoopingControl &&
+            m_pLoopingControl->getActiveLoop(&loopStart, &loopEnd) &&
+            m_currentPosition >= loopStart && m_currentPosition <= loopEnd) {
+        if (in_reverse) {
+            framesBeforeWrap = currentFrame -
+                    SampleUtil::floorPlayPosToFrame(loopStart);
+            wrapFrame = SampleUtil::ceilPlayPosToFrame(loopEnd);
+        } else {
+            framesBeforeWrap = SampleUtil::ceilPlayPosToFrame(loopEnd) -
+                    currentFrame;
+            wrapFrame = SampleUtil::floorPlayPosToFrame(loopStart);
+        }
+        framesBeforeWrap = math_clamp(framesBeforeWrap, SINT(0), frameCountToCache);
+    }
+
+    // top priority, we need to read this data immediately
+    appendHint(pHintList, currentFrame, framesBeforeWrap, in_reverse,
+            Hint::kPriorityPlayPosition);
+    SINT nextFrame = in_reverse ?
+            currentFrame - framesBeforeWrap :
+            currentFrame + framesBeforeWrap;
+    if (framesBeforeWrap < frameCountToCache) {
+        appendHint(pHintList, wrapFrame, frameCountToCache - framesBeforeWrap,
+                in_reverse, Hint::kPriorityPlayPosition);
+        nextFrame = in_reverse ?
+                wrapFrame - (frameCountToCache - framesBeforeWrap) :
+                wrapFrame + (frameCountToCache - framesBeforeWrap);
     }
 
+    // Prefetch the following chunks in the background, so that they are
+    // already there when the play position arrives.
+    appendHint(pHintList, nextFrame, frameCountToCache, in_reverse,
+            Hint::kPriorityBackground);
+
+    // The frames in the other direction are needed as soon as the track is
+    // scratched or rolled back, e.g. right after a jump to a cue
+    appendHint(pHintList, currentFrame, CachingReaderChunk::kFrames,
+            !in_reverse, Hint::kPriorityCue);
+}
+
+// static
+void ReadAheadManager::appendHint(HintVector* pHintList, SINT frame,
+        SINT frameCount, bool reverse, int priority) {
+    Hint hint;
+    hint.frame = reverse ? frame - frameCount : frame;
+    hint.frameCount = frameCount;
     // If we are trying to cache before the start of the track,
     // Then we don't need to cache because it's all zeros!
-    if (current_position.frame < 0 &&
-            current_position.frame + current_position.frameCount < 0)
-    {
-    	return;
+    if (hint.frame < 0) {
+        hint.frameCount += hint.frame;
+        hint.frame = 0;
     }
-
-    // top priority, we need to read this data immediately
-    current_position.priority = 1;
-    pHintList->append(current_position);
+    if (hint.frameCount <= 0) {
+        return;
+    }
+    hint.priority = priority;
+    pHintList->append(hint);
 }
 
 // Not thread-save, call from engine thread only
@@ -219,6 +309,8 @@ double ReadAheadManager::getFilePlaypositionFromLog(
     if (numConsumedSamples == 0) {
         return currentFilePlayposition;
     }
+    // The scalers consume samples of the reader
+    numConsumedSamples /= readerSamplesPerTrackSample();
 
     if (m_readAheadLog.size() == 0) {
         // No log entries to read from.
@@ -11,6 +11,7 @@
 #include "util/types.h"
 #include "util/math.h"
 #include "engine/cachingreader.h"
+#include "engine/jumptargetbuffers.h"
 
 class LoopingControl;
 class RateControl;
@@ -27,8 +28,10 @@ class RateControl;
 class ReadAheadManager {
   public:
     ReadAheadManager(); // Only for testing: ReadAheadManagerMock
+    // numJumpTargets is the number of JumpTargetBuffers, 0 disables them
     ReadAheadManager(CachingReader* reader,
-                              LoopingControl* pLoopingControl);
+                              LoopingControl* pLoopingControl,
+                              int numJumpTargets = 0);
     virtual ~ReadAheadManager();
 
     // Call this method to fill buffer with requested_samples out of the
@@ -53,9 +56,17 @@ class ReadAheadManager {
     virtual void notifySeek(double seekPosition);
 
     // hintReader allows the ReadAheadManager to provide hints to the reader to
-    // indicate that the given portion of a song is about to be read.
+    // indicate that the given portion of a song is about to be read. The
+    // hinted frames grow with the rate, follow the direction of dRate and
+    // continue at the other end of an active loop.
     virtual void hintReader(double dRate, HintVector* hintList);
 
+    // Updates the buffers of the jump targets from the final hints of this
+    // callback
+    void updateJumpTargets(const HintVector& hintList);
+    // Must be called when another track is loaded
+    void clearJumpTargets();
+
     virtual double getFilePlaypositionFromLog(double currentFilePlayposition,
                                                        double numConsumedSamples);
 
@@ -119,12 +130,25 @@ class ReadAheadManager {
     void addReadLogEntry(double virtualPlaypositionStart,
                          double virtualPlaypositionEndNonInclusive);
 
+    // Appends a hint of frameCount frames that start at frame, or end at
+    // frame in reverse, clamped to the start of the track
+    static void appendHint(HintVector* pHintList, SINT frame,
+            SINT frameCount, bool reverse, int priority);
+
+    // The samples that the reader returns per sample of the track
+    double readerSamplesPerTrackSample() const;
+
+    // Reads from the reader, or from the jump target buffers on a cache miss
+    SINT readSamples(SINT startSample, SINT numSamples, bool reverse,
+            CSAMPLE* pBuffer);
+
     LoopingControl* m_pLoopingControl;
     RateControl* m_pRateControl;
     QLinkedList<ReadLogEntry> m_readAheadLog;
     double m_currentPosition;
     CachingReader* m_pReader;
     CSAMPLE* m_pCrossFadeBuffer;
+    JumpTargetBuffers m_jumpTargets;
 };
 
 #endif // READAHEADMANGER_H
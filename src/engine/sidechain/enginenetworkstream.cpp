@@ -79,6 +79,10 @@ void EngineNetworkStream::startStream(double sampleRate) {
     m_inputStreamStartTimeUs = getNetworkTimeUs();
     m_inputStreamFramesWritten = 0;
 
+    if (m_pInputWorker) {
+        m_pInputWorker->startStream(m_sampleRate);
+    }
+
     for(NetworkOutputStreamWorkerPtr worker : m_outputWorkers) {
         if (worker.isNull()) {
             continue;
@@ -105,6 +109,10 @@ int EngineNetworkStream::getReadExpected() {
 }
 
 void EngineNetworkStream::read(CSAMPLE* buffer, int frames) {
+    if (m_pInputWorker) {
+        m_pInputWorker->read(buffer, frames);
+        return;
+    }
     int readAvailable = m_pInputFifo->readAvailable();
     int readRequired = frames * m_numInputChannels;
     int copyCount = math_min(readAvailable, readRequired);
@@ -215,9 +223,8 @@ void EngineNetworkStream::removeOutputWorker(NetworkOutputStreamWorkerPtr pWorke
 }
 
 void EngineNetworkStream::setInputWorker(NetworkInputStreamWorker* pInputWorker) {
-    if (pInputWorker) {
-        pInputWorker->setSourceFifo(m_pInputFifo);
-    }
+    // Only called while the stream is not read
+    m_pInputWorker = m_numInputChannels ? pInputWorker : nullptr;
 }
 
 int EngineNetworkStream::nextOutputSlotAvailable() {
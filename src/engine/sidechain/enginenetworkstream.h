@@ -19,6 +19,11 @@ class EngineNetworkStream {
 
     int getReadExpected();
     void read(CSAMPLE* buffer, int frames);
+    // True if the input is resampled to the clock of the device that reads
+    // it, so every read is complete
+    bool inputFollowsReader() const {
+        return m_pInputWorker != nullptr;
+    }
 
     qint64 getInputStreamTimeUs();
     qint64 getInputStreamTimeFrames();
@@ -254,10 +254,10 @@ void EngineRecord::write(const unsigned char *header, const unsigned char *body,
     }
     // Relevant for OGG
     if (headerLen > 0) {
-        m_dataStream.writeRawData((const char*) header, headerLen);
+        m_fileWriter.write((const char*) header, headerLen);
     }
     // Always write body
-    m_dataStream.writeRawData((const char*) body, bodyLen);
+    m_fileWriter.write((const char*) body, bodyLen);
     emit(bytesRecorded((headerLen+bodyLen)));
 
 }
@@ -266,43 +266,32 @@ int EngineRecord::tell() {
     if (!fileOpen()) {
         return -1;
     }
-    return m_dataStream.device()->pos();
+    return static_cast<int>(m_fileWriter.pos());
 }
 // Encoder calls this method to write compressed audio
 void EngineRecord::seek(int pos) {
     if (!fileOpen()) {
         return;
     }
-    m_dataStream.device()->seek(static_cast<qint64>(pos));
+    m_fileWriter.seek(static_cast<qint64>(pos));
 }
 // These are not used for streaming, but the interface requires them
 int EngineRecord::filelen() {
     if (!fileOpen()) {
         return 0;
     }
-    return m_dataStream.device()->size();
+    return static_cast<int>(m_fileWriter.size());
 }
 
 bool EngineRecord::fileOpen() {
-    return (m_file.handle() != -1);
+    return m_fileWriter.isOpen();
 }
 
 bool EngineRecord::openFile() {
-    // We can use a QFile to write compressed audio.
-    if (m_pEncoder) {
-        m_file.setFileName(m_fileName);
-        if (!m_file.open(QIODevice::WriteOnly)) {
-            return false;
-        }
-        if (m_file.handle() != -1) {
-            m_dataStream.setDevice(&m_file);
-        }
-    } else {
+    if (!m_pEncoder) {
         return false;
     }
-
-    // Return whether the file is really open.
-    return fileOpen();
+    return m_fileWriter.open(m_fileName);
 }
 
 bool EngineRecord::openCueFile() {
@@ -342,13 +331,14 @@ bool EngineRecord::openCueFile() {
 }
 
 void EngineRecord::closeFile() {
-    if (m_file.handle() != -1) {
-        // Close QFile and encoder, if open.
+    if (fileOpen()) {
+        // Close the file and encoder, if open. The remaining data is
+        // written in the background.
         if (m_pEncoder) {
             m_pEncoder->flush();
             m_pEncoder.reset();
         }
-        m_file.close();
+        m_fileWriter.close();
     }
 }
 
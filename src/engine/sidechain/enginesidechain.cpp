@@ -30,12 +30,96 @@
 #include "engine/sidechain/sidechainworker.h"
 #include "util/counter.h"
 #include "util/event.h"
+#include "util/performancetimer.h"
 #include "util/sample.h"
+#include "util/stat.h"
 #include "util/timer.h"
 #include "util/trace.h"
 
 #define SIDECHAIN_BUFFER_SIZE 65536
 
+namespace {
+
+// The interval for reporting the load of the workers
+const mixxx::Duration kLoadReportInterval = mixxx::Duration::fromSeconds(1);
+const Stat::ComputeFlags kLoadStatFlags =
+        Stat::COUNT | Stat::AVERAGE | Stat::MIN | Stat::MAX;
+
+} // anonymous namespace
+
+// Runs a worker in a thread of its own with a FIFO that is filled by the
+// sidechain thread. Reports the fraction of the time that the worker is
+// busy.
+class SideChainWorkerThread : public QThread {
+  public:
+    SideChainWorkerThread(SideChainWorker* pWorker, int index)
+            : m_pWorker(pWorker),
+              m_bStopThread(false),
+              m_sampleFifo(SIDECHAIN_BUFFER_SIZE),
+              m_pWorkBuffer(SampleUtil::alloc(SIDECHAIN_BUFFER_SIZE)),
+              m_name(QString("EngineSideChain worker %1").arg(index)),
+              m_loadStatKey(m_name + " load %"),
+              m_overrunCounterKey(m_name + " buffer overrun") {
+        // See the priority of EngineSideChain
+        start(QThread::HighPriority);
+    }
+
+    ~SideChainWorkerThread() override {
+        m_bStopThread = true;
+        m_waitForSamples.wake();
+        wait();
+        m_pWorker->shutdown();
+        delete m_pWorker;
+        SampleUtil::free(m_pWorkBuffer);
+    }
+
+    // Called by the sidechain thread
+    void writeSamples(const CSAMPLE* pBuffer, int iSamples) {
+        if (m_sampleFifo.write(pBuffer, iSamples) != iSamples) {
+            Counter(m_overrunCounterKey).increment();
+        }
+        m_waitForSamples.wake();
+    }
+
+  private:
+    void run() override {
+        QThread::currentThread()->setObjectName(m_name);
+        PerformanceTimer reportTimer;
+        reportTimer.start();
+        mixxx::Duration busy;
+        while (!m_bStopThread) {
+            m_waitForSamples.wait(static_cast<int>(
+                    kLoadReportInterval.toIntegerMillis()));
+            PerformanceTimer processTimer;
+            processTimer.start();
+            int samplesRead;
+            while ((samplesRead = m_sampleFifo.read(m_pWorkBuffer,
+                                                    SIDECHAIN_BUFFER_SIZE))) {
+                Trace process("SideChainWorkerThread::process");
+                m_pWorker->process(m_pWorkBuffer, samplesRead);
+            }
+            busy += processTimer.elapsed();
+
+            const mixxx::Duration elapsed = reportTimer.elapsed();
+            if (elapsed >= kLoadReportInterval) {
+                Stat::track(m_loadStatKey, Stat::UNSPECIFIED, kLoadStatFlags,
+                        100.0 * busy.toDoubleSeconds() / elapsed.toDoubleSeconds());
+                reportTimer.start();
+                busy = mixxx::Duration();
+            }
+        }
+    }
+
+    SideChainWorker* const m_pWorker;
+    volatile bool m_bStopThread;
+    FIFO<CSAMPLE> m_sampleFifo;
+    CSAMPLE* const m_pWorkBuffer;
+    FIFOWakeup m_waitForSamples;
+    const QString m_name;
+    const QString m_loadStatKey;
+    const QString m_overrunCounterKey;
+};
+
 EngineSideChain::EngineSideChain(UserSettingsPointer pConfig)
         : m_pConfig(pConfig),
           m_bStopThread(false),
@@ -51,19 +135,16 @@ EngineSideChain::EngineSideChain(UserSettingsPointer pConfig)
 }
 
 EngineSideChain::~EngineSideChain() {
-    m_waitLock.lock();
     m_bStopThread = true;
-    m_waitForSamples.wakeAll();
-    m_waitLock.unlock();
+    m_waitForSamples.wake();
 
     // Wait until the thread has finished.
     wait();
 
     MMutexLocker locker(&m_workerLock);
-    while (!m_workers.empty()) {
-        SideChainWorker* pWorker = m_workers.takeLast();
-        pWorker->shutdown();
-        delete pWorker;
+    while (!m_workerThreads.empty()) {
+        // Stops the thread and shuts down the worker
+        delete m_workerThreads.takeLast();
     }
     locker.unlock();
 
@@ -72,7 +153,8 @@ EngineSideChain::~EngineSideChain() {
 
 void EngineSideChain::addSideChainWorker(SideChainWorker* pWorker) {
     MMutexLocker locker(&m_workerLock);
-    m_workers.append(pWorker);
+    m_workerThreads.append(
+            new SideChainWorkerThread(pWorker, m_workerThreads.size() + 1));
 }
 
 void EngineSideChain::receiveBuffer(AudioInput input,
@@ -99,7 +181,7 @@ void EngineSideChain::writeSamples(const CSAMPLE* pBuffer, int iFrames) {
     if (m_sampleFifo.writeAvailable() < SIDECHAIN_BUFFER_SIZE / 5) {
         // Signal to the sidechain that samples are available.
         Trace wakeup("EngineSideChain::writeSamples wake up");
-        m_waitForSamples.wakeAll();
+        m_waitForSamples.wake();
     }
 }
 
@@ -112,11 +194,8 @@ void EngineSideChain::run() {
     Event::start("EngineSideChain");
     while (!m_bStopThread) {
         // Sleep until samples are available.
-        m_waitLock.lock();
-
         Event::end("EngineSideChain");
-        m_waitForSamples.wait(&m_waitLock);
-        m_waitLock.unlock();
+        m_waitForSamples.wait();
         Event::start("EngineSideChain");
 
         int samples_read;
@@ -124,8 +203,8 @@ void EngineSideChain::run() {
                                                  SIDECHAIN_BUFFER_SIZE))) {
             Trace process("EngineSideChain::process");
             MMutexLocker locker(&m_workerLock);
-            foreach (SideChainWorker* pWorker, m_workers) {
-                pWorker->process(m_pWorkBuffer, samples_read);
+            for (SideChainWorkerThread* pWorkerThread : m_workerThreads) {
+                pWorkerThread->writeSamples(m_pWorkBuffer, samples_read);
             }
         }
 
@@ -19,16 +19,18 @@
 
 #include <QThread>
 #include <QMutex>
-#include <QWaitCondition>
 #include <QList>
 
 #include "preferences/usersettings.h"
 #include "engine/sidechain/sidechainworker.h"
 #include "soundio/soundmanagerutil.h"
 #include "util/fifo.h"
+#include "util/fifowakeup.h"
 #include "util/mutex.h"
 #include "util/types.h"
 
+class SideChainWorkerThread;
+
 class EngineSideChain : public QThread, public AudioDestination {
     Q_OBJECT
   public:
@@ -46,7 +48,8 @@ class EngineSideChain : public QThread, public AudioDestination {
                        const CSAMPLE* pBuffer,
                        unsigned int iFrames) override;
 
-    // Thread-safe, blocking.
+    // Thread-safe, blocking. Each worker processes the samples in a thread
+    // of its own, so that a slow encoder does not delay the others.
     void addSideChainWorker(SideChainWorker* pWorker);
 
   private:
@@ -59,14 +62,14 @@ class EngineSideChain : public QThread, public AudioDestination {
     FIFO<CSAMPLE> m_sampleFifo;
     CSAMPLE* m_pWorkBuffer;
 
-    // Provides thread safety around the wait condition below.
-    QMutex m_waitLock;
-    // Allows sleeping until we have samples to process.
-    QWaitCondition m_waitForSamples;
+    // Allows sleeping until we have samples to process. Woken up by the
+    // engine callback without taking a lock.
+    FIFOWakeup m_waitForSamples;
 
-    // Sidechain workers registered with EngineSideChain.
+    // Sidechain workers registered with EngineSideChain. The samples are
+    // copied from m_pWorkBuffer into the FIFO of the thread of each worker.
     MMutex m_workerLock;
-    QList<SideChainWorker*> m_workers GUARDED_BY(m_workerLock);
+    QList<SideChainWorkerThread*> m_workerThreads GUARDED_BY(m_workerLock);
 };
 
 #endif
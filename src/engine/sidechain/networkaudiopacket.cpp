@@ -0,0 +1,75 @@
+#include "engine/sidechain/networkaudiopacket.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+namespace {
+
+// "MXNA" and the version of the format
+const quint32 kMagic = 0x4d584e41;
+const quint8 kVersion = 1;
+
+// magic, version, channels, frames, sample rate, sequence, timestamp
+const int kHeaderSize = 4 + 1 + 1 + 2 + 4 + 4 + 8;
+
+static_assert(sizeof(CSAMPLE) == sizeof(quint32),
+        "The samples are transmitted as 32 bit floats");
+
+} // anonymous namespace
+
+// static
+int NetworkAudioPacket::serializedSize(int frames, int channels) {
+    return kHeaderSize + frames * channels * static_cast<int>(sizeof(quint32));
+}
+
+int NetworkAudioPacket::serialize(char* pData) const {
+    uchar* pBytes = reinterpret_cast<uchar*>(pData);
+    qToBigEndian<quint32>(kMagic, pBytes);
+    pBytes[4] = kVersion;
+    pBytes[5] = static_cast<quint8>(channels);
+    qToBigEndian<quint16>(static_cast<quint16>(frames), pBytes + 6);
+    qToBigEndian<quint32>(sampleRate, pBytes + 8);
+    qToBigEndian<quint32>(sequence, pBytes + 12);
+    qToBigEndian<qint64>(timestampFrames, pBytes + 16);
+    pBytes += kHeaderSize;
+    const int sampleCount = frames * channels;
+    for (int i = 0; i < sampleCount; ++i) {
+        quint32 bits;
+        memcpy(&bits, &samples[i], sizeof(bits));
+        qToLittleEndian<quint32>(bits, pBytes);
+        pBytes += sizeof(bits);
+    }
+    return serializedSize(frames, channels);
+}
+
+bool NetworkAudioPacket::deserialize(const char* pData, int size) {
+    if (size < kHeaderSize) {
+        return false;
+    }
+    const uchar* pBytes = reinterpret_cast<const uchar*>(pData);
+    if (qFromBigEndian<quint32>(pBytes) != kMagic || pBytes[4] != kVersion) {
+        return false;
+    }
+    channels = pBytes[5];
+    frames = qFromBigEndian<quint16>(pBytes + 6);
+    if (channels <= 0 || channels > kMaxChannels ||
+            frames <= 0 || frames > kMaxFrames ||
+            size != serializedSize(frames, channels)) {
+        return false;
+    }
+    sampleRate = qFromBigEndian<quint32>(pBytes + 8);
+    sequence = qFromBigEndian<quint32>(pBytes + 12);
+    timestampFrames = qFromBigEndian<qint64>(pBytes + 16);
+    if (timestampFrames < 0) {
+        return false;
+    }
+    pBytes += kHeaderSize;
+    const int sampleCount = frames * channels;
+    for (int i = 0; i < sampleCount; ++i) {
+        const quint32 bits = qFromLittleEndian<quint32>(pBytes);
+        memcpy(&samples[i], &bits, sizeof(bits));
+        pBytes += sizeof(bits);
+    }
+    return true;
+}
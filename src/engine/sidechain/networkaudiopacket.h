@@ -0,0 +1,46 @@
+#ifndef ENGINE_SIDECHAIN_NETWORKAUDIOPACKET_H
+#define ENGINE_SIDECHAIN_NETWORKAUDIOPACKET_H
+
+#include <QtGlobal>
+
+#include "util/types.h"
+
+// A UDP datagram of the low latency network audio stream between a
+// NetworkAudioSender and a NetworkInputStreamWorker. The samples are sent
+// uncompressed, because an encoder would add more latency than the network.
+//
+// The timestamp is the position of the first frame in the stream of the
+// sender, so the receiver can put packets that arrive out of order or twice
+// in place and measure the jitter of the network against its own clock.
+// It is always a multiple of the frames per packet.
+//
+// The struct has a fixed size without pointers, so it can be passed through
+// a FIFO to the audio thread.
+struct NetworkAudioPacket {
+    // 1.5 ms @ 44100 Hz. Short packets keep the latency low, but each one
+    // carries about 50 bytes of IP and UDP headers.
+    static const int kDefaultFrames = 64;
+    static const int kMaxFrames = 256;
+    static const int kMaxChannels = 2;
+
+    // The size of the datagram for the number of frames and channels
+    static int serializedSize(int frames, int channels);
+
+    // Writes the datagram to pData, which holds serializedSize() bytes, in
+    // a byte order independent form. Returns the number of bytes written.
+    int serialize(char* pData) const;
+    // Returns false if the datagram is not a valid packet
+    bool deserialize(const char* pData, int size);
+
+    quint32 sequence;
+    qint64 timestampFrames;
+    quint32 sampleRate;
+    int channels;
+    int frames;
+    // Not transmitted: The time when the receiver got the packet, by
+    // EngineNetworkStream::getNetworkTimeUs()
+    qint64 arrivalTimeUs;
+    CSAMPLE samples[kMaxFrames * kMaxChannels];
+};
+
+#endif // ENGINE_SIDECHAIN_NETWORKAUDIOPACKET_H
@@ -0,0 +1,178 @@
+#include "engine/sidechain/networkaudiosender.h"
+
+#include <QHostInfo>
+#include <QUdpSocket>
+
+#include "util/assert.h"
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+const mixxx::Logger kLogger("NetworkAudioSender");
+
+// Expedited Forwarding (DSCP 46), which routers and access points that
+// support QoS send before bulk traffic
+const int kTypeOfService = 46 << 2;
+
+} // anonymous namespace
+
+NetworkAudioSender::NetworkAudioSender(const QString& host, quint16 port)
+        : m_host(host),
+          m_port(port),
+          m_threadWaiting(0),
+          m_stop(0),
+          m_pSocket(nullptr),
+          m_packetSamples(0),
+          m_datagram(NetworkAudioPacket::serializedSize(
+                  NetworkAudioPacket::kMaxFrames,
+                  NetworkAudioPacket::kMaxChannels), '\0'),
+          m_sendErrors(0) {
+    m_packet.sequence = 0;
+    m_packet.timestampFrames = 0;
+    m_packet.arrivalTimeUs = 0;
+}
+
+NetworkAudioSender::~NetworkAudioSender() {
+    shutdown();
+}
+
+void NetworkAudioSender::shutdown() {
+    m_stop = 1;
+    m_readSema.release();
+    wait();
+}
+
+void NetworkAudioSender::outputAvailable() {
+    m_readSema.release();
+}
+
+void NetworkAudioSender::setOutputFifo(QSharedPointer<FIFO<CSAMPLE>> pOutputFifo) {
+    m_pOutputFifo = pOutputFifo;
+}
+
+QSharedPointer<FIFO<CSAMPLE>> NetworkAudioSender::getOutputFifo() {
+    return m_pOutputFifo;
+}
+
+bool NetworkAudioSender::threadWaiting() {
+    return m_threadWaiting.load() != 0;
+}
+
+int NetworkAudioSender::outputLatencyFrames() {
+    return NetworkAudioPacket::kDefaultFrames;
+}
+
+bool NetworkAudioSender::resolveHost() {
+    if (m_address.setAddress(m_host)) {
+        return true;
+    }
+    const QHostInfo info = QHostInfo::fromName(m_host);
+    for (const QHostAddress& address : info.addresses()) {
+        // Prefer IPv4, which every receiver listens on
+        if (m_address.isNull() ||
+                address.protocol() == QAbstractSocket::IPv4Protocol) {
+            m_address = address;
+        }
+    }
+    if (m_address.isNull()) {
+        kLogger.warning() << "Failed to resolve" << m_host << info.errorString();
+        return false;
+    }
+    return true;
+}
+
+void NetworkAudioSender::run() {
+    QThread::currentThread()->setObjectName(
+            QString("NetworkAudioSender %1:%2").arg(m_host).arg(m_port));
+
+    VERIFY_OR_DEBUG_ASSERT(m_pOutputFifo) {
+        kLogger.warning() << "run: FIFO handle is not available. Aborting";
+        return;
+    }
+
+    if (!resolveHost()) {
+        setState(NETWORKSTREAMWORKER_STATE_ERROR);
+        return;
+    }
+
+    QUdpSocket socket;
+    socket.setSocketOption(QAbstractSocket::TypeOfServiceOption, kTypeOfService);
+    m_pSocket = &socket;
+    kLogger.info() << "Sending network audio to" << m_address.toString()
+                   << "port" << m_port;
+
+    setState(NETWORKSTREAMWORKER_STATE_READY);
+    m_threadWaiting = 1;
+    while (!m_stop.load()) {
+        incRunCount();
+        if (!m_readSema.tryAcquire(1, 1000)) {
+            continue;
+        }
+        // The FIFO is read completely, so the semaphore may have been
+        // released again for frames that have already been sent
+        while (m_readSema.tryAcquire()) {
+        }
+
+        int readAvailable = m_pOutputFifo->readAvailable();
+        if (readAvailable) {
+            CSAMPLE* dataPtr1;
+            ring_buffer_size_t size1;
+            CSAMPLE* dataPtr2;
+            ring_buffer_size_t size2;
+            // We use size1 and size2, so we can ignore the return value
+            (void)m_pOutputFifo->aquireReadRegions(readAvailable, &dataPtr1,
+                    &size1, &dataPtr2, &size2);
+            process(dataPtr1, size1);
+            if (size2 > 0) {
+                process(dataPtr2, size2);
+            }
+            m_pOutputFifo->releaseReadRegions(readAvailable);
+        }
+    }
+    m_threadWaiting = 0;
+    m_pSocket = nullptr;
+    setState(NETWORKSTREAMWORKER_STATE_DISCONNECTED);
+}
+
+void NetworkAudioSender::process(const CSAMPLE* pBuffer, const int iBufferSize) {
+    const int channels = getNumOutputChannels();
+    if (channels <= 0 || channels > NetworkAudioPacket::kMaxChannels) {
+        return;
+    }
+    const int packetSamples = NetworkAudioPacket::kDefaultFrames * channels;
+    int samplesLeft = iBufferSize;
+    while (samplesLeft > 0) {
+        const int count = math_min(samplesLeft, packetSamples - m_packetSamples);
+        SampleUtil::copy(m_packet.samples + m_packetSamples, pBuffer, count);
+        m_packetSamples += count;
+        pBuffer += count;
+        samplesLeft -= count;
+        if (m_packetSamples == packetSamples) {
+            m_packet.channels = channels;
+            sendPacket();
+        }
+    }
+}
+
+void NetworkAudioSender::sendPacket() {
+    m_packet.frames = NetworkAudioPacket::kDefaultFrames;
+    m_packet.sampleRate = static_cast<quint32>(getSampleRate());
+    const int size = m_packet.serialize(m_datagram.data());
+    if (m_pSocket->writeDatagram(m_datagram.constData(), size,
+            m_address, m_port) != size) {
+        // Only the first of a series of errors is reported
+        if (m_sendErrors++ == 0) {
+            kLogger.warning() << "Failed to send to" << m_address.toString()
+                              << m_pSocket->errorString();
+        }
+    } else {
+        m_sendErrors = 0;
+    }
+    // A packet that could not be sent is lost for the receiver, like one
+    // that is dropped by the network
+    ++m_packet.sequence;
+    m_packet.timestampFrames += m_packet.frames;
+    m_packetSamples = 0;
+}
@@ -0,0 +1,62 @@
+#ifndef ENGINE_SIDECHAIN_NETWORKAUDIOSENDER_H
+#define ENGINE_SIDECHAIN_NETWORKAUDIOSENDER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QString>
+#include <QThread>
+
+#include "engine/sidechain/networkaudiopacket.h"
+#include "engine/sidechain/networkoutputstreamworker.h"
+#include "util/class.h"
+#include "util/fifo.h"
+
+class QUdpSocket;
+
+// Sends the network stream uncompressed and with low latency as UDP
+// datagrams, e.g. to a monitor in a remote booth that receives it with a
+// NetworkInputStreamWorker. Unlike a broadcast connection, which waits for
+// a large chunk of audio, it is woken up for every packet.
+class NetworkAudioSender : public QThread, public NetworkOutputStreamWorker {
+  public:
+    NetworkAudioSender(const QString& host, quint16 port);
+    ~NetworkAudioSender() override;
+
+    // Called by the thread with the samples of the FIFO
+    void process(const CSAMPLE* pBuffer, const int iBufferSize) override;
+    // Ends the thread
+    void shutdown() override;
+
+    void outputAvailable() override;
+    void setOutputFifo(QSharedPointer<FIFO<CSAMPLE>> pOutputFifo) override;
+    QSharedPointer<FIFO<CSAMPLE>> getOutputFifo() override;
+    bool threadWaiting() override;
+    int outputLatencyFrames() override;
+
+  private:
+    void run() override;
+    bool resolveHost();
+    void sendPacket();
+
+    const QString m_host;
+    const quint16 m_port;
+    QSharedPointer<FIFO<CSAMPLE>> m_pOutputFifo;
+    QSemaphore m_readSema;
+    QAtomicInt m_threadWaiting;
+    QAtomicInt m_stop;
+
+    // Only used by the thread
+    QHostAddress m_address;
+    QUdpSocket* m_pSocket;
+    NetworkAudioPacket m_packet;
+    int m_packetSamples;
+    QByteArray m_datagram;
+    int m_sendErrors;
+
+    DISALLOW_COPY_AND_ASSIGN(NetworkAudioSender);
+};
+
+#endif // ENGINE_SIDECHAIN_NETWORKAUDIOSENDER_H
@@ -3,14 +3,118 @@
 
 #include <engine/sidechain/networkinputstreamworker.h>
 
-NetworkInputStreamWorker::NetworkInputStreamWorker()
-    : m_sampleRate(0),
-      m_numInputChannels(0) {
+#include <QByteArray>
+#include <QHostAddress>
+#include <QUdpSocket>
+
+#include "engine/sidechain/enginenetworkstream.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("NetworkInputStreamWorker");
+
+// About 40 ms with the default packets. The audio thread takes the
+// packets with every callback.
+const int kPacketFifoSize = 32;
+
+// Larger reads are split by the jitter buffer
+const SINT kMaxFramesPerRead = 4096;
+
+// The interval for checking if the thread is stopped
+const int kStopCheckIntervalMs = 100;
+
+} // anonymous namespace
+
+NetworkInputStreamWorker::NetworkInputStreamWorker(int numInputChannels,
+        quint16 port, double targetLatencyMillis)
+    : m_port(port),
+      m_targetLatencyMillis(targetLatencyMillis),
+      m_stop(0),
+      m_packetFifo(kPacketFifoSize),
+      m_jitterBuffer(numInputChannels, kMaxFramesPerRead) {
 }
 
 NetworkInputStreamWorker::~NetworkInputStreamWorker() {
+    stop();
 }
 
-void NetworkInputStreamWorker::setSourceFifo(FIFO<CSAMPLE>* pFifo) {
-    (void)pFifo;
+void NetworkInputStreamWorker::startStream(double sampleRate) {
+    m_jitterBuffer.reset(sampleRate);
+    m_jitterBuffer.setMaxLatencyFrames(static_cast<SINT>(
+            m_targetLatencyMillis * sampleRate / 1000.0));
+}
+
+void NetworkInputStreamWorker::stop() {
+    m_stop = 1;
+    wait();
+}
+
+void NetworkInputStreamWorker::read(CSAMPLE* pBuffer, int frames) {
+    NetworkAudioPacket* dataPtr1;
+    ring_buffer_size_t size1;
+    NetworkAudioPacket* dataPtr2;
+    ring_buffer_size_t size2;
+    const int count = m_packetFifo.aquireReadRegions(
+            m_packetFifo.readAvailable(), &dataPtr1, &size1, &dataPtr2, &size2);
+    for (int i = 0; i < size1; ++i) {
+        m_jitterBuffer.insert(dataPtr1[i]);
+    }
+    for (int i = 0; i < size2; ++i) {
+        m_jitterBuffer.insert(dataPtr2[i]);
+    }
+    m_packetFifo.releaseReadRegions(count);
+
+    m_jitterBuffer.read(pBuffer, frames);
+}
+
+void NetworkInputStreamWorker::run() {
+    QThread::currentThread()->setObjectName("NetworkInputStreamWorker");
+
+    QUdpSocket socket;
+    if (!socket.bind(QHostAddress::Any, m_port)) {
+        kLogger.warning() << "Failed to receive on UDP port" << m_port
+                          << socket.errorString();
+        return;
+    }
+    kLogger.info() << "Receiving network audio on UDP port" << m_port;
+
+    // One byte more than the largest packet, to detect larger datagrams
+    QByteArray datagram(NetworkAudioPacket::serializedSize(
+            NetworkAudioPacket::kMaxFrames,
+            NetworkAudioPacket::kMaxChannels) + 1, '\0');
+    int droppedPackets = 0;
+    while (!m_stop.load()) {
+        if (!socket.waitForReadyRead(kStopCheckIntervalMs)) {
+            continue;
+        }
+        // The packets of a burst leave the socket at about the same time,
+        // which the jitter buffer takes into account
+        const qint64 arrivalTimeUs = EngineNetworkStream::getNetworkTimeUs();
+        while (socket.hasPendingDatagrams()) {
+            const qint64 size = socket.readDatagram(
+                    datagram.data(), datagram.size());
+            NetworkAudioPacket* dataPtr1;
+            ring_buffer_size_t size1;
+            NetworkAudioPacket* dataPtr2;
+            ring_buffer_size_t size2;
+            (void)m_packetFifo.aquireWriteRegions(1,
+                    &dataPtr1, &size1, &dataPtr2, &size2);
+            if (size1 == 0) {
+                // The audio thread does not read the stream
+                if (droppedPackets++ == 0) {
+                    kLogger.warning() << "Packet FIFO full, dropping packets";
+                }
+                continue;
+            }
+            if (!dataPtr1->deserialize(datagram.constData(),
+                    static_cast<int>(size))) {
+                kLogger.debug() << "Ignoring invalid datagram of" << size << "bytes";
+                continue;
+            }
+            dataPtr1->arrivalTimeUs = arrivalTimeUs;
+            m_packetFifo.releaseWriteRegions(1);
+            droppedPackets = 0;
+        }
+    }
 }
@@ -4,19 +4,46 @@
 #ifndef ENGINE_SIDECHAIN_NETWORKINPUTSTREAMWORKER_H
 #define ENGINE_SIDECHAIN_NETWORKINPUTSTREAMWORKER_H
 
+#include <QAtomicInt>
+#include <QThread>
+
+#include "engine/sidechain/networkaudiopacket.h"
+#include "engine/sidechain/networkjitterbuffer.h"
+#include "util/class.h"
 #include "util/fifo.h"
 #include "util/sample.h"
 
-class NetworkInputStreamWorker {
+// Receives the low latency stream of a NetworkAudioSender on a UDP port.
+// The thread passes the packets with their arrival time to the audio
+// thread, which plays them through a NetworkJitterBuffer with the clock of
+// the device that reads the network stream.
+class NetworkInputStreamWorker : public QThread {
   public:
-    NetworkInputStreamWorker();
-    virtual ~NetworkInputStreamWorker();
+    NetworkInputStreamWorker(int numInputChannels, quint16 port,
+            double targetLatencyMillis);
+    ~NetworkInputStreamWorker() override;
+
+    // Called before the network stream is read for the first time
+    void startStream(double sampleRate);
+    // Ends the thread
+    void stop();
 
-    void setSourceFifo(FIFO<CSAMPLE>* pFifo);
+    // Called by the audio thread
+    void read(CSAMPLE* pBuffer, int frames);
 
   private:
-    double m_sampleRate;
-    int m_numInputChannels;
+    void run() override;
+
+    const quint16 m_port;
+    const double m_targetLatencyMillis;
+    QAtomicInt m_stop;
+
+    // From the thread to the audio thread
+    FIFO<NetworkAudioPacket> m_packetFifo;
+    // Only used by the audio thread
+    NetworkJitterBuffer m_jitterBuffer;
+
+    DISALLOW_COPY_AND_ASSIGN(NetworkInputStreamWorker);
 };
 
 #endif // ENGINE_SIDECHAIN_NETWORKINPUTSTREAMWORKER_H
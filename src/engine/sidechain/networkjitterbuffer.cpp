@@ -0,0 +1,254 @@
+#include "engine/sidechain/networkjitterbuffer.h"
+
+#include <cmath>
+
+#include "util/counter.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+// 186 ms with the default packets, which is far more than the latencies
+// this is meant for
+const int kSlotCount = 128;
+
+// The peak delay decays to half within about 700 packets, i.e. one second
+// with the default packets.
+const double kPeakDecay = 0.999;
+
+// The shortest transit time may rise by 1000 ppm of the stream time, more
+// than the drift of any crystal clock
+const double kMinTransitRise = 0.001;
+
+Counter s_lostPacketsCounter("NetworkJitterBuffer lost packets");
+Counter s_latePacketsCounter("NetworkJitterBuffer late packets");
+Counter s_underflowCounter("NetworkJitterBuffer underflows");
+
+} // anonymous namespace
+
+NetworkJitterBuffer::NetworkJitterBuffer(int channels, SINT maxFramesPerRead)
+        : m_channels(channels),
+          m_maxFramesPerRead(maxFramesPerRead),
+          m_sampleRate(0),
+          m_maxLatencyFrames(0),
+          m_slots(kSlotCount),
+          m_packetFrames(0),
+          m_receivedEnd(-1),
+          m_readPosition(0),
+          m_bufferingStart(-1),
+          m_playing(false),
+          m_hasTransit(false),
+          m_minTransitUs(0),
+          m_peakDelayUs(0),
+          m_framesPerRead(0),
+          m_targetFrames(0),
+          m_resampler(channels, maxFramesPerRead),
+          // Like the buffer of the resampler
+          m_resamplerInput((2 * maxFramesPerRead + 4) * channels),
+          m_lostPackets(0),
+          m_latePackets(0),
+          m_underflows(0) {
+    reset(0);
+}
+
+void NetworkJitterBuffer::reset(double sampleRate) {
+    m_sampleRate = sampleRate;
+    m_framesPerRead = 0;
+    m_lostPackets = 0;
+    m_latePackets = 0;
+    m_underflows = 0;
+    resetStream(0);
+}
+
+void NetworkJitterBuffer::setMaxLatencyFrames(SINT frames) {
+    m_maxLatencyFrames = math_max<SINT>(frames, 1);
+    m_targetFrames = math_min(m_targetFrames, m_maxLatencyFrames);
+}
+
+void NetworkJitterBuffer::resetStream(int packetFrames) {
+    m_packetFrames = packetFrames;
+    for (NetworkAudioPacket& packet : m_slots) {
+        packet.timestampFrames = -1;
+    }
+    m_receivedEnd = -1;
+    m_readPosition = 0;
+    m_bufferingStart = -1;
+    m_playing = false;
+    m_hasTransit = false;
+    m_minTransitUs = 0;
+    m_peakDelayUs = 0;
+    m_targetFrames = m_maxLatencyFrames;
+    m_resampler.reset();
+}
+
+void NetworkJitterBuffer::stopPlaying() {
+    m_playing = false;
+    m_bufferingStart = m_receivedEnd;
+    m_resampler.reset();
+}
+
+SINT NetworkJitterBuffer::fillFrames() const {
+    if (m_receivedEnd < 0) {
+        return 0;
+    }
+    if (m_playing) {
+        return static_cast<SINT>(math_max<qint64>(
+                m_receivedEnd - m_readPosition, 0));
+    }
+    return static_cast<SINT>(m_receivedEnd - m_bufferingStart);
+}
+
+qint64 NetworkJitterBuffer::capacityFrames() const {
+    return static_cast<qint64>(kSlotCount) * m_packetFrames;
+}
+
+NetworkAudioPacket& NetworkJitterBuffer::slot(qint64 timestampFrames) {
+    return m_slots[(timestampFrames / m_packetFrames) % kSlotCount];
+}
+
+void NetworkJitterBuffer::insert(const NetworkAudioPacket& packet) {
+    if (packet.channels != m_channels ||
+            static_cast<double>(packet.sampleRate) != m_sampleRate) {
+        return;
+    }
+    if (packet.frames != m_packetFrames) {
+        resetStream(packet.frames);
+    }
+    if (packet.timestampFrames % m_packetFrames != 0) {
+        return;
+    }
+    if (m_receivedEnd >= 0 &&
+            qAbs(packet.timestampFrames - m_receivedEnd) > capacityFrames()) {
+        // The sender has been restarted
+        resetStream(packet.frames);
+    }
+
+    updateTarget(packet);
+
+    const qint64 end = packet.timestampFrames + packet.frames;
+    if (m_playing && end <= m_readPosition) {
+        ++m_latePackets;
+        s_latePacketsCounter.increment();
+        return;
+    }
+    if (m_playing && end - m_readPosition > capacityFrames()) {
+        // The reader has fallen behind so far that the slot of the packet
+        // has not been read yet
+        stopPlaying();
+    }
+    slot(packet.timestampFrames) = packet;
+    if (m_bufferingStart < 0) {
+        m_bufferingStart = packet.timestampFrames;
+    }
+    m_receivedEnd = math_max(m_receivedEnd, end);
+}
+
+void NetworkJitterBuffer::updateTarget(const NetworkAudioPacket& packet) {
+    const double transitUs = packet.arrivalTimeUs -
+            packet.timestampFrames * 1000000.0 / m_sampleRate;
+    if (!m_hasTransit) {
+        m_hasTransit = true;
+        m_minTransitUs = transitUs;
+        m_peakDelayUs = 0;
+    } else {
+        const double packetUs = m_packetFrames * 1000000.0 / m_sampleRate;
+        m_minTransitUs = math_min(transitUs,
+                m_minTransitUs + kMinTransitRise * packetUs);
+        m_peakDelayUs = math_max(transitUs - m_minTransitUs,
+                m_peakDelayUs * kPeakDecay);
+    }
+    updateTargetFrames();
+}
+
+void NetworkJitterBuffer::updateTargetFrames() {
+    // A packet that is delayed by the peak must still arrive before the
+    // frames of the next read are used up
+    const SINT peakFrames = static_cast<SINT>(
+            std::ceil(m_peakDelayUs * m_sampleRate / 1000000.0));
+    m_targetFrames = math_min<SINT>(
+            peakFrames + m_framesPerRead + m_packetFrames,
+            m_maxLatencyFrames);
+}
+
+void NetworkJitterBuffer::read(CSAMPLE* pBuffer, SINT frames) {
+    while (frames > 0) {
+        const SINT chunkFrames = math_min(frames, m_maxFramesPerRead);
+        readChunk(pBuffer, chunkFrames);
+        pBuffer += chunkFrames * m_channels;
+        frames -= chunkFrames;
+    }
+}
+
+void NetworkJitterBuffer::readChunk(CSAMPLE* pBuffer, SINT frames) {
+    if (frames != m_framesPerRead) {
+        m_framesPerRead = frames;
+        updateTargetFrames();
+    }
+    if (!m_playing) {
+        if (m_receivedEnd < 0 ||
+                m_receivedEnd - m_bufferingStart < m_targetFrames) {
+            SampleUtil::clear(pBuffer, frames * m_channels);
+            return;
+        }
+        m_playing = true;
+        m_readPosition = m_receivedEnd - m_targetFrames;
+        m_resampler.reset();
+    }
+
+    SINT fill = static_cast<SINT>(m_receivedEnd - m_readPosition);
+    if (fill > math_min<qint64>(2 * m_maxLatencyFrames + frames,
+            capacityFrames())) {
+        // Far too much is buffered after a stall of the network or the
+        // reader. Resampling would take too long to catch up.
+        m_readPosition = m_receivedEnd - m_targetFrames;
+        m_resampler.reset();
+        fill = m_targetFrames;
+    }
+
+    m_resampler.updateRatio(math_max<SINT>(fill, 0), m_targetFrames, frames);
+    const SINT inputFrames = m_resampler.inputFramesRequired(frames);
+    pull(m_resamplerInput.data(), inputFrames);
+    const SINT outputFrames = m_resampler.process(m_resamplerInput.data(),
+            inputFrames, pBuffer, frames);
+    if (outputFrames < frames) {
+        SampleUtil::clear(pBuffer + outputFrames * m_channels,
+                (frames - outputFrames) * m_channels);
+    }
+
+    if (fill < inputFrames) {
+        // The missing frames have been replaced by silence. Buffer up to
+        // the target again.
+        ++m_underflows;
+        s_underflowCounter.increment();
+        stopPlaying();
+    }
+}
+
+void NetworkJitterBuffer::pull(CSAMPLE* pBuffer, SINT frames) {
+    while (frames > 0) {
+        const SINT offset = static_cast<SINT>(m_readPosition % m_packetFrames);
+        const qint64 packetStart = m_readPosition - offset;
+        const SINT count = math_min<SINT>(frames, m_packetFrames - offset);
+        NetworkAudioPacket& packet = slot(packetStart);
+        const bool received = packet.timestampFrames == packetStart;
+        if (received) {
+            SampleUtil::copy(pBuffer, packet.samples + offset * m_channels,
+                    count * m_channels);
+        } else {
+            SampleUtil::clear(pBuffer, count * m_channels);
+        }
+        if (offset + count == m_packetFrames) {
+            if (received) {
+                packet.timestampFrames = -1;
+            } else if (packetStart < m_receivedEnd) {
+                // A newer packet has arrived, so this one is lost or so
+                // late that it is of no use
+                ++m_lostPackets;
+                s_lostPacketsCounter.increment();
+            }
+        }
+        m_readPosition += count;
+        pBuffer += count * m_channels;
+        frames -= count;
+    }
+}
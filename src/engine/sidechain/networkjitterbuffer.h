@@ -0,0 +1,117 @@
+#ifndef ENGINE_SIDECHAIN_NETWORKJITTERBUFFER_H
+#define ENGINE_SIDECHAIN_NETWORKJITTERBUFFER_H
+
+#include <vector>
+
+#include "engine/sidechain/networkaudiopacket.h"
+#include "soundio/driftresampler.h"
+#include "util/class.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+// Plays the packets of a low latency network audio stream with the clock of
+// the device that reads them, i.e. the clock reference device.
+//
+// The packets are put in place by their timestamp, so packets that arrive
+// out of order are played in order and lost packets are replaced by
+// silence. The buffer is adaptive: The variation of the transit times of the
+// packets is measured against the stream clock, and the fill level that is
+// kept grows with the largest recent delay and shrinks slowly when the
+// network calms down. It never exceeds the configured latency.
+//
+// The clocks of the sender and the reading device drift apart. Like for a
+// secondary sound device, the stream is resampled by a ratio close to 1 that
+// keeps the fill level at the target, so no frames are dropped or repeated.
+// Only if the fill level is far off, it jumps to the target.
+//
+// All buffers are allocated in the constructor. The functions are called
+// from the audio thread only.
+class NetworkJitterBuffer {
+  public:
+    // maxFramesPerRead is the largest number of frames that is requested
+    // from read() at a time.
+    NetworkJitterBuffer(int channels, SINT maxFramesPerRead);
+
+    // Starts again without packets for a stream with the sample rate of the
+    // reading device. Packets with another sample rate are dropped.
+    void reset(double sampleRate);
+
+    // The upper limit of the latency, the configured target latency
+    void setMaxLatencyFrames(SINT frames);
+    SINT maxLatencyFrames() const {
+        return m_maxLatencyFrames;
+    }
+
+    void insert(const NetworkAudioPacket& packet);
+
+    // Writes frames interleaved frames to pBuffer. Silence is written before
+    // enough packets are buffered and after the buffer has run dry.
+    void read(CSAMPLE* pBuffer, SINT frames);
+
+    bool isPlaying() const {
+        return m_playing;
+    }
+    // The frames that are buffered for the next read
+    SINT fillFrames() const;
+    // The fill level that is kept before a read
+    SINT targetFrames() const {
+        return m_targetFrames;
+    }
+
+    int lostPackets() const {
+        return m_lostPackets;
+    }
+    int latePackets() const {
+        return m_latePackets;
+    }
+    int underflows() const {
+        return m_underflows;
+    }
+
+  private:
+    void resetStream(int packetFrames);
+    void stopPlaying();
+    void updateTarget(const NetworkAudioPacket& packet);
+    void updateTargetFrames();
+    void readChunk(CSAMPLE* pBuffer, SINT frames);
+    // Copies the next frames of the stream to pBuffer and frees the slots
+    // of the packets that have been copied completely
+    void pull(CSAMPLE* pBuffer, SINT frames);
+    NetworkAudioPacket& slot(qint64 timestampFrames);
+    qint64 capacityFrames() const;
+
+    const int m_channels;
+    const SINT m_maxFramesPerRead;
+    double m_sampleRate;
+    SINT m_maxLatencyFrames;
+
+    // The packets by their timestamp. A free slot has a negative timestamp.
+    std::vector<NetworkAudioPacket> m_slots;
+    int m_packetFrames;
+    // The end of the newest packet, or -1 before the first packet
+    qint64 m_receivedEnd;
+    // The position of the next frame that is read
+    qint64 m_readPosition;
+    // The end of the stream when the buffering has started
+    qint64 m_bufferingStart;
+    bool m_playing;
+
+    // The shortest transit time, which follows a drift of the clocks slowly,
+    // and the decaying peak of the transit times above it
+    bool m_hasTransit;
+    double m_minTransitUs;
+    double m_peakDelayUs;
+    SINT m_framesPerRead;
+    SINT m_targetFrames;
+
+    DriftResampler m_resampler;
+    mixxx::SampleBuffer m_resamplerInput;
+
+    int m_lostPackets;
+    int m_latePackets;
+    int m_underflows;
+
+    DISALLOW_COPY_AND_ASSIGN(NetworkJitterBuffer);
+};
+
+#endif // ENGINE_SIDECHAIN_NETWORKJITTERBUFFER_H
@@ -6,6 +6,15 @@
 
 namespace {
 const mixxx::Logger kLogger("NetworkStreamWorker");
+
+const int kNetworkLatencyFrames = 8192; // 185 ms @ 44100 Hz
+// Related chunk sizes:
+// Mp3 frames = 1152 samples
+// Ogg frames = 64 to 8192 samples.
+// In Mixxx 1.11 we transmit every decoder-frames at once,
+// Which results in case of ogg in a dynamic latency from 0.14 ms to to 185 ms
+// Now we have switched to a fixed latency of 8192 frames (stereo samples) =
+// which is 185 @ 44100 ms and twice the maximum of the max mixxx audio buffer
 }
 
 NetworkOutputStreamWorker::NetworkOutputStreamWorker()
@@ -53,6 +62,18 @@ bool NetworkOutputStreamWorker::threadWaiting() {
     return false;
 }
 
+int NetworkOutputStreamWorker::outputLatencyFrames() {
+    return kNetworkLatencyFrames;
+}
+
+double NetworkOutputStreamWorker::getSampleRate() {
+    return m_sampleRate;
+}
+
+int NetworkOutputStreamWorker::getNumOutputChannels() {
+    return m_numOutputChannels;
+}
+
 qint64 NetworkOutputStreamWorker::getStreamTimeFrames() {
     return static_cast<double>(getStreamTimeUs()) * m_sampleRate / 1000000.0;
 }
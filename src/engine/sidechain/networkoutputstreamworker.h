@@ -57,6 +57,11 @@ class NetworkOutputStreamWorker {
     void stopStream();
 
     virtual bool threadWaiting();
+    // The frames that are collected before outputAvailable() is called
+    virtual int outputLatencyFrames();
+
+    double getSampleRate();
+    int getNumOutputChannels();
 
     qint64 getStreamTimeUs();
     qint64 getStreamTimeFrames();
@@ -0,0 +1,207 @@
+#include "engine/sidechain/recordingfilewriter.h"
+
+#include <QMutexLocker>
+
+#include <limits>
+
+#ifndef __WINDOWS__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace {
+
+const mixxx::Logger kLogger("RecordingFileWriter");
+
+// The size of the batches, a multiple of the block size of all storage
+const int kBatchBytes = 1024 * 1024;
+
+// The writes block while more data waits to be written, about 10 minutes of
+// uncompressed audio at 44.1 kHz
+const int kMaxQueuedBytes = 100 * 1024 * 1024;
+
+// The space that is allocated ahead of the writes
+const qint64 kPreallocateBytes = 64 * 1024 * 1024;
+
+} // anonymous namespace
+
+RecordingFileWriter::RecordingFileWriter()
+        : m_position(0),
+          m_size(0),
+          m_batchPosition(0),
+          m_queuedBytes(0),
+          m_stop(false),
+          m_preallocatedSize(0) {
+    start(QThread::LowPriority);
+}
+
+RecordingFileWriter::~RecordingFileWriter() {
+    close();
+    QMutexLocker locker(&m_mutex);
+    m_stop = true;
+    m_requestSubmitted.wakeAll();
+    locker.unlock();
+    // Writes all data before it returns
+    wait();
+}
+
+bool RecordingFileWriter::open(const QString& fileName) {
+    close();
+    QSharedPointer<QFile> pFile(new QFile(fileName));
+    if (!pFile->open(QIODevice::WriteOnly)) {
+        kLogger.warning() << "Failed to open" << fileName << pFile->errorString();
+        return false;
+    }
+    m_pFile = pFile;
+    m_position = 0;
+    m_size = 0;
+    return true;
+}
+
+void RecordingFileWriter::close() {
+    if (!m_pFile) {
+        return;
+    }
+    submitBatch();
+    Request request;
+    request.pFile = m_pFile;
+    request.position = m_size;
+    request.close = true;
+    submit(request);
+    m_pFile.reset();
+}
+
+void RecordingFileWriter::write(const char* data, int length) {
+    if (!m_pFile || length <= 0) {
+        return;
+    }
+    if (m_batch.isEmpty()) {
+        m_batch.reserve(kBatchBytes);
+        m_batchPosition = m_position;
+    }
+    m_batch.append(data, length);
+    m_position += length;
+    m_size = math_max(m_size, m_position);
+    if (m_batch.size() >= kBatchBytes) {
+        submitBatch();
+    }
+}
+
+void RecordingFileWriter::seek(qint64 position) {
+    if (position == m_position) {
+        return;
+    }
+    // The batch is contiguous
+    submitBatch();
+    m_position = position;
+}
+
+void RecordingFileWriter::submitBatch() {
+    if (m_batch.isEmpty()) {
+        return;
+    }
+    Request request;
+    request.pFile = m_pFile;
+    request.position = m_batchPosition;
+    request.data = m_batch;
+    request.close = false;
+    // The thread owns the data now
+    m_batch = QByteArray();
+    submit(request);
+}
+
+void RecordingFileWriter::submit(const Request& request) {
+    QMutexLocker locker(&m_mutex);
+    if (m_queuedBytes > kMaxQueuedBytes) {
+        kLogger.warning() << "The storage is too slow, waiting for the writes";
+        while (m_queuedBytes > kMaxQueuedBytes) {
+            m_requestProcessed.wait(&m_mutex);
+        }
+    }
+    m_requests.enqueue(request);
+    m_queuedBytes += request.data.size();
+    m_requestSubmitted.wakeOne();
+}
+
+void RecordingFileWriter::run() {
+    QThread::currentThread()->setObjectName("RecordingFileWriter");
+    QMutexLocker locker(&m_mutex);
+    while (true) {
+        while (m_requests.isEmpty() && !m_stop) {
+            m_requestSubmitted.wait(&m_mutex);
+        }
+        if (m_requests.isEmpty()) {
+            // Stopped after all data has been written
+            return;
+        }
+        const Request request = m_requests.dequeue();
+        locker.unlock();
+        process(request);
+        locker.relock();
+        m_queuedBytes -= request.data.size();
+        m_requestProcessed.wakeAll();
+    }
+}
+
+void RecordingFileWriter::process(const Request& request) {
+    QFile* pFile = request.pFile.data();
+    if (request.close) {
+#ifndef __WINDOWS__
+        // Release the space that has been allocated beyond the end
+        if (m_pPreallocatedFile == request.pFile) {
+            pFile->flush();
+            if (ftruncate(pFile->handle(), request.position) != 0) {
+                kLogger.warning() << "Failed to truncate" << pFile->fileName();
+            }
+        }
+#endif
+        if (m_pPreallocatedFile == request.pFile) {
+            m_pPreallocatedFile.reset();
+        }
+        pFile->close();
+        return;
+    }
+    preallocate(request.pFile, request.position + request.data.size());
+    if (!pFile->seek(request.position) ||
+            pFile->write(request.data) != request.data.size()) {
+        kLogger.warning() << "Failed to write" << pFile->fileName()
+                          << pFile->errorString();
+    }
+}
+
+void RecordingFileWriter::preallocate(const QSharedPointer<QFile>& pFile,
+        qint64 size) {
+    if (m_pPreallocatedFile != pFile) {
+        m_pPreallocatedFile = pFile;
+        m_preallocatedSize = 0;
+    }
+    if (size <= m_preallocatedSize) {
+        return;
+    }
+    const qint64 offset = m_preallocatedSize;
+    const qint64 length = size + kPreallocateBytes - offset;
+    bool allocated = false;
+#if defined(__LINUX__)
+    // Keeps the size, so that the file is complete if it is not closed
+    allocated = fallocate(pFile->handle(), FALLOC_FL_KEEP_SIZE,
+            offset, length) == 0;
+#elif defined(__APPLE__)
+    fstore_t store;
+    store.fst_flags = F_ALLOCATEALL;
+    store.fst_posmode = F_PEOFPOSMODE;
+    store.fst_offset = 0;
+    store.fst_length = length;
+    store.fst_bytesalloc = 0;
+    allocated = fcntl(pFile->handle(), F_PREALLOCATE, &store) != -1;
+#endif
+    if (allocated) {
+        m_preallocatedSize = offset + length;
+    } else {
+        // Not supported by the platform or the file system, do not try
+        // again for this file
+        m_preallocatedSize = std::numeric_limits<qint64>::max();
+    }
+}
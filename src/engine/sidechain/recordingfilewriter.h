@@ -0,0 +1,91 @@
+#ifndef ENGINE_SIDECHAIN_RECORDINGFILEWRITER_H
+#define ENGINE_SIDECHAIN_RECORDINGFILEWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "util/class.h"
+
+// Writes the encoded audio of a recording on a thread of its own, so that
+// slow storage does not delay the encoder. The data is collected into
+// large batches that are written in order. Seeking, e.g. for updating the
+// header of a file, only starts a new batch.
+//
+// The space of the file is allocated ahead of the writes where the
+// platform supports it. This keeps long recordings from being fragmented
+// and makes the writes cheaper on slow cards. Closing a file only starts
+// writing its remaining data, so the next file of a split recording can be
+// opened right away.
+//
+// All functions besides the destructor, which writes all data, are to be
+// called from a single thread.
+class RecordingFileWriter : public QThread {
+  public:
+    RecordingFileWriter();
+    ~RecordingFileWriter() override;
+
+    // Opens a new file for writing. A file that is still open is closed
+    // first.
+    bool open(const QString& fileName);
+    // Writes the remaining data and closes the file in the background
+    void close();
+    bool isOpen() const {
+        return !m_pFile.isNull();
+    }
+
+    void write(const char* data, int length);
+
+    // The position of the next write and the size of the file with all
+    // writes so far
+    qint64 pos() const {
+        return m_position;
+    }
+    qint64 size() const {
+        return m_size;
+    }
+    void seek(qint64 position);
+
+  private:
+    struct Request {
+        QSharedPointer<QFile> pFile;
+        qint64 position;
+        QByteArray data;
+        bool close;
+    };
+
+    void run() override;
+
+    void submitBatch();
+    // Blocks while too much data waits to be written
+    void submit(const Request& request);
+
+    // Called by the thread
+    void process(const Request& request);
+    void preallocate(const QSharedPointer<QFile>& pFile, qint64 size);
+
+    QSharedPointer<QFile> m_pFile;
+    qint64 m_position;
+    qint64 m_size;
+    QByteArray m_batch;
+    qint64 m_batchPosition;
+
+    QMutex m_mutex;
+    QWaitCondition m_requestSubmitted;
+    QWaitCondition m_requestProcessed;
+    QQueue<Request> m_requests;
+    int m_queuedBytes;
+    bool m_stop;
+
+    // Only used by the thread
+    QSharedPointer<QFile> m_pPreallocatedFile;
+    qint64 m_preallocatedSize;
+
+    DISALLOW_COPY_AND_ASSIGN(RecordingFileWriter);
+};
+
+#endif // ENGINE_SIDECHAIN_RECORDINGFILEWRITER_H
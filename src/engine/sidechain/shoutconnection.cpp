@@ -1,6 +1,7 @@
 // shoutconnection.cpp
 // Created July 4th 2017 by Stéphane Lepin <stephane.lepin@gmail.com>
 
+#include <QMutexLocker>
 #include <QUrl>
 
 // These includes are only required by ignoreSigpipe, which is unix-only
@@ -27,6 +28,8 @@
 #include "recording/defs_recording.h"
 #include "track/track.h"
 #include "util/logger.h"
+#include "util/math.h"
+#include "util/time.h"
 
 #include <engine/sidechain/shoutconnection.h>
 
@@ -36,12 +39,20 @@ static const int kMaxNetworkCache = 491520;  // 10 s mp3 @ 192 kbit/s
 // Shoutcast default receive buffer 1048576 and autodumpsourcetime 30 s
 // http://wiki.shoutcast.com/wiki/SHOUTcast_DNAS_Server_2
 static const int kMaxShoutFailures = 3;
+// The interval for sending the data that the server did not take before,
+// while no new samples arrive
+static const int kSendQueueIntervalMs = 10;
+// The interval for publishing the statistics of the connection
+static const int kStatisticsIntervalMs = 1000;
+// The packets of a shared encoder that are queued until they are sent,
+// about 5 s of MP3
+static const int kMaxQueuedPackets = 200;
 
 const mixxx::Logger kLogger("ShoutConnection");
 }
 
 ShoutConnection::ShoutConnection(BroadcastProfilePtr profile,
-        UserSettingsPointer pConfig)
+        UserSettingsPointer pConfig, SharedEncoderPoolPointer pEncoderPool)
         : m_pTextCodec(nullptr),
           m_pMetaData(),
           m_pShout(nullptr),
@@ -52,6 +63,9 @@ ShoutConnection::ShoutConnection(BroadcastProfilePtr profile,
           m_pConfig(pConfig),
           m_pProfile(profile),
           m_encoder(nullptr),
+          m_pEncoderPool(pEncoderPool),
+          m_bytesSent(0),
+          m_statisticsBytesTransmitted(0),
           m_pMasterSamplerate(new ControlProxy("[Master]", "samplerate")),
           m_pBroadcastEnabled(new ControlProxy(BROADCAST_PREF_KEY, "enabled")),
           m_custom_metadata(false),
@@ -110,6 +124,8 @@ ShoutConnection::~ShoutConnection() {
        qWarning() << "ShoutOutput::~ShoutOutput(): Thread didn't die.\
        Ignored but file a bug report if problems rise!";
     }
+
+    releaseEncoder();
 }
 
 bool ShoutConnection::isConnected() {
@@ -165,7 +181,7 @@ void ShoutConnection::updateFromPreferences() {
     // Delete m_encoder if it has been initialized (with maybe) different bitrate.
     // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    releaseEncoder();
 
     m_format_is_mp3 = false;
     m_format_is_ov = false;
@@ -379,34 +395,63 @@ void ShoutConnection::updateFromPreferences() {
     // Initialize m_encoder
     EncoderBroadcastSettings broadcastSettings(m_pProfile);
     if (m_format_is_mp3) {
-        m_encoder = EncoderFactory::getFactory().getNewEncoder(
-            EncoderFactory::getFactory().getFormatFor(ENCODING_MP3), m_pConfig, this);
-        m_encoder->setEncoderSettings(broadcastSettings);
+        // The connections that stream MP3 with the same settings share one
+        // encoder
+        const QString key = QString("%1 %2 kbps %3 %4 Hz").arg(
+                QString(BROADCAST_FORMAT_MP3),
+                QString::number(broadcastSettings.getQuality()),
+                QString::number(static_cast<int>(
+                        broadcastSettings.getChannelMode())),
+                QString::number(iMasterSamplerate));
+        m_pSharedEncoder = m_pEncoderPool->subscribe(key, this,
+                [this, &broadcastSettings, iMasterSamplerate](
+                        EncoderCallback* pCallback) {
+                    EncoderPointer pEncoder =
+                            EncoderFactory::getFactory().getNewEncoder(
+                                    EncoderFactory::getFactory().getFormatFor(
+                                            ENCODING_MP3),
+                                    m_pConfig, pCallback);
+                    pEncoder->setEncoderSettings(broadcastSettings);
+                    QString errorMsg;
+                    if (pEncoder->initEncoder(iMasterSamplerate, errorMsg) < 0) {
+                        // e.g., if lame is not found
+                        // init m_encoder itself will display a message box
+                        kLogger.warning() << "**** Encoder init failed";
+                        kLogger.warning() << errorMsg;
+                        return EncoderPointer();
+                    }
+                    return pEncoder;
+                });
+        if (!m_pSharedEncoder) {
+            setState(NETWORKSTREAMWORKER_STATE_ERROR);
+            m_lastErrorStr = "Encoder error";
+            return;
+        }
     } else if (m_format_is_ov) {
         m_encoder = EncoderFactory::getFactory().getNewEncoder(
             EncoderFactory::getFactory().getFormatFor(ENCODING_OGG), m_pConfig, this);
         m_encoder->setEncoderSettings(broadcastSettings);
-    } else {
-        kLogger.warning() << "**** Unknown Encoder Format";
-        setState(NETWORKSTREAMWORKER_STATE_ERROR);
-        m_lastErrorStr = "Encoder format error";
-        return;
-    }
 
-    QString errorMsg;
-    if(m_encoder->initEncoder(iMasterSamplerate, errorMsg) < 0) {
-        // e.g., if lame is not found
-        // init m_encoder itself will display a message box
-        kLogger.warning() << "**** Encoder init failed";
-        kLogger.warning() << errorMsg;
+        QString errorMsg;
+        if(m_encoder->initEncoder(iMasterSamplerate, errorMsg) < 0) {
+            // e.g., if lame is not found
+            // init m_encoder itself will display a message box
+            kLogger.warning() << "**** Encoder init failed";
+            kLogger.warning() << errorMsg;
 
-        // delete m_encoder calls write() make sure it will be exit early
-        DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-        m_encoder.reset();
+            // delete m_encoder calls write() make sure it will be exit early
+            DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
+            m_encoder.reset();
 
-        setState(NETWORKSTREAMWORKER_STATE_ERROR);
-        m_lastErrorStr = "Encoder error";
+            setState(NETWORKSTREAMWORKER_STATE_ERROR);
+            m_lastErrorStr = "Encoder error";
 
+            return;
+        }
+    } else {
+        kLogger.warning() << "**** Unknown Encoder Format";
+        setState(NETWORKSTREAMWORKER_STATE_ERROR);
+        m_lastErrorStr = "Encoder format error";
         return;
     }
     setState(NETWORKSTREAMWORKER_STATE_READY);
@@ -427,7 +472,7 @@ bool ShoutConnection::processConnect() {
     // Make sure that we call updateFromPreferences always
     updateFromPreferences();
 
-    if (!m_encoder) {
+    if (!m_encoder && !m_pSharedEncoder) {
         // updateFromPreferences failed
         setStatus(BroadcastProfile::STATUS_FAILURE);
         kLogger.warning() << "ShoutOutput::processConnect() returning false";
@@ -525,6 +570,10 @@ bool ShoutConnection::processConnect() {
             }
             m_threadWaiting = true;
 
+            m_bytesSent = 0;
+            m_statisticsBytesTransmitted = 0;
+            m_statisticsTime = mixxx::Time::elapsed();
+
             setStatus(BroadcastProfile::STATUS_CONNECTED);
             emit(broadcastConnected());
 
@@ -547,7 +596,7 @@ bool ShoutConnection::processConnect() {
     shout_close(m_pShout);
     // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    releaseEncoder();
     if (m_pProfile->getEnabled()) {
         setStatus(BroadcastProfile::STATUS_FAILURE);
     } else {
@@ -572,7 +621,7 @@ bool ShoutConnection::processDisconnect() {
     }
     // delete m_encoder calls write() check if it will be exit early
     DEBUG_ASSERT(m_iShoutStatus != SHOUTERR_CONNECTED);
-    m_encoder.reset();
+    releaseEncoder();
     return disconnected;
 }
 
@@ -605,6 +654,37 @@ void ShoutConnection::write(const unsigned char* header, const unsigned char* bo
         }
     }
 }
+void ShoutConnection::receivePacket(const EncodedPacketPointer& pPacket) {
+    QMutexLocker locker(&m_packetsMutex);
+    if (m_packets.size() >= kMaxQueuedPackets) {
+        // The connection is stalled, drop the oldest audio
+        m_packets.removeFirst();
+    }
+    m_packets.append(pPacket);
+}
+
+void ShoutConnection::sendPackets() {
+    QMutexLocker locker(&m_packetsMutex);
+    m_sendingPackets.swap(m_packets);
+    locker.unlock();
+    for (const EncodedPacketPointer& pPacket : m_sendingPackets) {
+        write(nullptr, pPacket->data(), 0, pPacket->size());
+    }
+    // Returns the packets to the pool once the other connections have sent
+    // them as well
+    m_sendingPackets.clear();
+}
+
+void ShoutConnection::releaseEncoder() {
+    m_encoder.reset();
+    if (m_pSharedEncoder) {
+        m_pSharedEncoder->unsubscribe(this);
+        m_pSharedEncoder.reset();
+    }
+    QMutexLocker locker(&m_packetsMutex);
+    m_packets.clear();
+}
+
 // These are not used for streaming, but the interface requires them
 int ShoutConnection::tell() {
     if (!m_pShout) {
@@ -626,12 +706,11 @@ bool ShoutConnection::writeSingle(const unsigned char* data, size_t len) {
     setFunctionCode(8);
     int ret = shout_send_raw(m_pShout, data, len);
     if (ret == SHOUTERR_BUSY) {
-        // in case of busy, frames are queued
-        // try to flush queue after a short sleep
-        kLogger.warning() << "writeSingle() SHOUTERR_BUSY, trying again";
-        usleep(10000); // wait 10 ms until "busy" is over. TODO() tweak for an optimum.
-        // if this fails, the queue is transmitted after the next regular shout_send_raw()
-        (void)shout_send_raw(m_pShout, nullptr, 0);
+        // In non-blocking mode the frames are queued by libshout. The queue
+        // is sent by sendQueuedData() without blocking this thread, so a
+        // slow server does not delay the encoding.
+        kLogger.debug() << "writeSingle() SHOUTERR_BUSY, data is queued";
+        m_bytesSent += len;
     } else if (ret < SHOUTERR_SUCCESS) {
         m_lastErrorStr = shout_get_error(m_pShout);
         kLogger.warning()
@@ -643,10 +722,43 @@ bool ShoutConnection::writeSingle(const unsigned char* data, size_t len) {
         return false;
     } else {
         m_iShoutFailures = 0;
+        m_bytesSent += len;
     }
     return true;
 }
 
+void ShoutConnection::sendQueuedData() {
+    if (!m_pShout || m_iShoutStatus != SHOUTERR_CONNECTED ||
+            shout_queuelen(m_pShout) <= 0) {
+        return;
+    }
+    (void)writeSingle(nullptr, 0);
+}
+
+void ShoutConnection::updateStatistics(bool force) {
+    const mixxx::Duration now = mixxx::Time::elapsed();
+    const qint64 elapsedMillis = (now - m_statisticsTime).toIntegerMillis();
+    if (!force && elapsedMillis < kStatisticsIntervalMs) {
+        return;
+    }
+    int queuedBytes = 0;
+    if (m_pShout && m_iShoutStatus == SHOUTERR_CONNECTED) {
+        queuedBytes = static_cast<int>(math_max(
+                shout_queuelen(m_pShout), static_cast<ssize_t>(0)));
+    }
+    // The bytes that have left the queue
+    const qint64 bytesTransmitted = m_bytesSent - queuedBytes;
+    int bytesPerSecond = 0;
+    if (elapsedMillis > 0) {
+        bytesPerSecond = static_cast<int>(math_max(
+                bytesTransmitted - m_statisticsBytesTransmitted, qint64(0)) *
+                1000 / elapsedMillis);
+    }
+    m_statisticsBytesTransmitted = bytesTransmitted;
+    m_statisticsTime = now;
+    m_pProfile->setConnectionStatistics(queuedBytes, bytesPerSecond);
+}
+
 void ShoutConnection::process(const CSAMPLE* pBuffer, const int iBufferSize) {
     setFunctionCode(4);
     if(!m_pProfile->getEnabled())
@@ -655,14 +767,24 @@ void ShoutConnection::process(const CSAMPLE* pBuffer, const int iBufferSize) {
     setState(NETWORKSTREAMWORKER_STATE_BUSY);
 
     // If we aren't connected, bail.
-    if (m_iShoutStatus != SHOUTERR_CONNECTED)
+    if (m_iShoutStatus != SHOUTERR_CONNECTED) {
+        // Do not send the encoded audio later
+        QMutexLocker locker(&m_packetsMutex);
+        m_packets.clear();
         return;
+    }
 
     // If we are connected, encode the samples.
     if (iBufferSize > 0 && m_encoder) {
         setFunctionCode(6);
         m_encoder->encodeBuffer(pBuffer, iBufferSize);
         // the encoded frames are received by the write() callback.
+    } else if (iBufferSize > 0 && m_pSharedEncoder) {
+        setFunctionCode(6);
+        // Only encodes if this connection feeds the encoder. The packets of
+        // all connections that share it are received by receivePacket().
+        m_pSharedEncoder->encodeBuffer(this, pBuffer, iBufferSize);
+        sendPackets();
     }
 
     // Check if track metadata has changed and if so, update.
@@ -936,13 +1058,20 @@ void ShoutConnection::run() {
             if(processDisconnect()) {
                 setStatus(BroadcastProfile::STATUS_UNCONNECTED);
             }
+            updateStatistics(true);
             setFunctionCode(2);
             break;
         }
 
         setFunctionCode(1);
         incRunCount();
-        if(!m_readSema.tryAcquire(1, 1000)) {
+        updateStatistics(false);
+        // Wake up early while the server has not taken all data
+        const bool dataQueued = m_pShout &&
+                m_iShoutStatus == SHOUTERR_CONNECTED &&
+                shout_queuelen(m_pShout) > 0;
+        if(!m_readSema.tryAcquire(1, dataQueued ? kSendQueueIntervalMs : 1000)) {
+            sendQueuedData();
             continue;
         }
 
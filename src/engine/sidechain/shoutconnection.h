@@ -15,6 +15,7 @@
 #include <QVector>
 #include <QSharedPointer>
 
+#include "broadcast/sharedencoder.h"
 #include "control/controlobject.h"
 #include "control/controlproxy.h"
 #include "encoder/encodercallback.h"
@@ -22,6 +23,7 @@
 #include "errordialoghandler.h"
 #include "preferences/usersettings.h"
 #include "track/track.h"
+#include "util/duration.h"
 #include "util/fifo.h"
 #include "preferences/broadcastprofile.h"
 
@@ -33,10 +35,12 @@ struct _util_dict;
 typedef struct _util_dict shout_metadata_t;
 
 class ShoutConnection
-        : public QThread, public EncoderCallback, public NetworkOutputStreamWorker {
+        : public QThread, public EncoderCallback, public NetworkOutputStreamWorker,
+          public SharedEncoderSubscriber {
     Q_OBJECT
   public:
-    ShoutConnection(BroadcastProfilePtr profile, UserSettingsPointer pConfig);
+    ShoutConnection(BroadcastProfilePtr profile, UserSettingsPointer pConfig,
+            SharedEncoderPoolPointer pEncoderPool);
     virtual ~ShoutConnection();
 
     // This is called by the Engine implementation for each sample. Encode and
@@ -50,6 +54,9 @@ class ShoutConnection
     // the server.
     void write(const unsigned char* header, const unsigned char* body,
                int headerLen, int bodyLen) override;
+    // Called by a shared encoder with the packets that are sent by
+    // process(). Only a reference is queued.
+    void receivePacket(const EncodedPacketPointer& pPacket) override;
     // gets stream position
     int tell() override;
     // sets stream position
@@ -111,6 +118,15 @@ class ShoutConnection
 
     bool writeSingle(const unsigned char *data, size_t len);
 
+    // Sends the packets of the shared encoder
+    void sendPackets();
+    // Sends the data that libshout has queued, because the server did not
+    // take it before
+    void sendQueuedData();
+    // Publishes the queue depth and the throughput to the profile
+    void updateStatistics(bool force);
+    void releaseEncoder();
+
     QByteArray encodeString(const QString& string);
 
     bool waitForRetry();
@@ -126,7 +142,18 @@ class ShoutConnection
     long m_iShoutFailures;
     UserSettingsPointer m_pConfig;
     BroadcastProfilePtr m_pProfile;
+    // Ogg streams have their own encoder, MP3 streams share one with the
+    // streams that have the same settings
     EncoderPointer m_encoder;
+    SharedEncoderPoolPointer m_pEncoderPool;
+    SharedEncoderPointer m_pSharedEncoder;
+    QMutex m_packetsMutex;
+    QList<EncodedPacketPointer> m_packets;
+    QList<EncodedPacketPointer> m_sendingPackets;
+    // The bytes that have been passed to libshout since connecting
+    qint64 m_bytesSent;
+    qint64 m_statisticsBytesTransmitted;
+    mixxx::Duration m_statisticsTime;
     ControlProxy* m_pMasterSamplerate;
     ControlProxy* m_pBroadcastEnabled;
     // static metadata according to prefereneces
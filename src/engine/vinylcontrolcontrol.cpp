@@ -107,7 +107,7 @@ void VinylControlControl::slotControlVinylSeek(double fractionalPos) {
             return; // If off, do nothing.
         case MIXXX_RELATIVE_CUE_ONECUE:
             //if onecue, just seek to the regular cue
-            seekExact(m_pCurrentTrack->getCuePoint());
+            seekExact(m_pCurrentTrack->getEngineSnapshot()->cuePoint);
             return;
         case MIXXX_RELATIVE_CUE_HOTCUE:
             // Continue processing in this function.
@@ -117,25 +117,14 @@ void VinylControlControl::slotControlVinylSeek(double fractionalPos) {
             return;
         }
 
-        double shortest_distance = 0;
-        int nearest_playpos = -1;
-
-        const QList<CuePointer> cuePoints(m_pCurrentTrack->getCuePoints());
-        QListIterator<CuePointer> it(cuePoints);
-        while (it.hasNext()) {
-            CuePointer pCue(it.next());
-            if (pCue->getType() != Cue::CUE || pCue->getHotCue() == -1) {
-                continue;
-            }
-
-            int cue_position = pCue->getPosition();
-            // pick cues closest to new_playpos
-            if ((nearest_playpos == -1) ||
-                (fabs(new_playpos - cue_position) < shortest_distance)) {
-                nearest_playpos = cue_position;
-                shortest_distance = fabs(new_playpos - cue_position);
-            }
-        }
+        // Wait-free, may be called from the vinyl control thread
+        const TrackEngineSnapshotPointer pTrackSnapshot =
+                m_pCurrentTrack->getEngineSnapshot();
+        const CueIndex::Entry* pNearestCue =
+                pTrackSnapshot->cueIndex.findClosest(
+                        new_playpos, CueIndex::Filter::HotCues);
+        const int nearest_playpos = pNearestCue ?
+                static_cast<int>(pNearestCue->position) : -1;
 
         if (nearest_playpos == -1) {
             if (new_playpos >= 0) {
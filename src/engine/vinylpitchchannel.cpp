@@ -0,0 +1,67 @@
+#include "engine/vinylpitchchannel.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "util/math.h"
+
+namespace {
+
+// An older rate is not followed, because the decoder has lost the signal or
+// stopped, so the engine falls back to the vinylcontrol_rate control
+const mixxx::Duration kMaxSampleAge = mixxx::Duration::fromMillis(100);
+
+QMutex s_channelsMutex;
+QHash<QString, std::shared_ptr<VinylPitchChannel>> s_channels;
+
+} // anonymous namespace
+
+// static
+std::shared_ptr<VinylPitchChannel> VinylPitchChannel::forGroup(
+        const QString& group) {
+    QMutexLocker locker(&s_channelsMutex);
+    std::shared_ptr<VinylPitchChannel> pChannel = s_channels.value(group);
+    if (!pChannel) {
+        pChannel = std::make_shared<VinylPitchChannel>();
+        s_channels.insert(group, pChannel);
+    }
+    return pChannel;
+}
+
+void VinylPitchChannel::publish(const VinylPitchSample& sample) {
+    // There is only one writer, so its own last write is read back
+    State state = m_state.getValue();
+    state.previous = state.valid ? state.latest : sample;
+    state.latest = sample;
+    state.valid = true;
+    m_state.setValue(state);
+}
+
+void VinylPitchChannel::reset() {
+    m_state.setValue(State());
+}
+
+bool VinylPitchChannel::rateAt(mixxx::Duration time, double* pRate) const {
+    const State state = m_state.getValue();
+    if (!state.valid || time - state.latest.time > kMaxSampleAge) {
+        return false;
+    }
+    *pRate = state.latest.rate;
+    const mixxx::Duration interval = state.latest.time - state.previous.time;
+    // A stopped record stays stopped
+    if (interval <= mixxx::Duration() || time <= state.latest.time ||
+            state.latest.rate == 0.0) {
+        return true;
+    }
+    // A rate that changes while scratching is followed to the callback time
+    // instead of lagging behind by the decoding interval
+    const double slope = (state.latest.rate - state.previous.rate) /
+            interval.toDoubleSeconds();
+    const double extrapolated = math_min(time - state.latest.time, interval)
+            .toDoubleSeconds();
+    const double rate = state.latest.rate + slope * extrapolated;
+    // The direction only changes when the decoder reports it
+    *pRate = (rate * state.latest.rate < 0.0) ? 0.0 : rate;
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef ENGINE_VINYLPITCHCHANNEL_H
+#define ENGINE_VINYLPITCHCHANNEL_H
+
+#include <QString>
+
+#include "control/controlvalue.h"
+#include "util/duration.h"
+#include "util/memory.h"
+
+// A rate of a vinyl control deck as decoded from the timecode
+struct VinylPitchSample {
+    VinylPitchSample()
+            : rate(0.0),
+              position(0.0),
+              hasPosition(false) {
+    }
+
+    // The time of decoding, see mixxx::Time::elapsed()
+    mixxx::Duration time;
+    // The rate of the track, 1.0 = original rate
+    double rate;
+    // The position of the needle on the record in seconds
+    double position;
+    bool hasPosition;
+};
+
+// Passes the rate of a vinyl control deck from the decoder thread directly
+// to the engine callback. The decoder still sets the vinylcontrol_rate
+// control for the other controls, but the engine follows the latest samples
+// to its own callback time.
+//
+// There is one writer and any number of readers, both are wait-free.
+class VinylPitchChannel {
+  public:
+    // The channels are shared by the decoder and the engine of a deck.
+    // Must not be called from the engine callback.
+    static std::shared_ptr<VinylPitchChannel> forGroup(const QString& group);
+
+    // Called by the decoder
+    void publish(const VinylPitchSample& sample);
+    // Called by the decoder when it stops
+    void reset();
+
+    // Returns false if the decoder has not published a rate recently.
+    // Otherwise the rate is extrapolated from the two latest samples,
+    // for at most the interval between them.
+    bool rateAt(mixxx::Duration time, double* pRate) const;
+
+  private:
+    struct State {
+        State()
+                : valid(false) {
+        }
+        VinylPitchSample previous;
+        VinylPitchSample latest;
+        bool valid;
+    };
+
+    ControlValueAtomic<State> m_state;
+};
+
+#endif // ENGINE_VINYLPITCHCHANNEL_H
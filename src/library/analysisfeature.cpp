@@ -135,7 +135,8 @@ void AnalysisFeature::analyzeTracks(QList<TrackId> trackIds) {
         m_pAnalyzerQueue = new AnalyzerQueue(
                 m_pDbConnectionPool,
                 m_pConfig,
-                getAnalyzerQueueMode(m_pConfig));
+                getAnalyzerQueueMode(m_pConfig),
+                AnalyzerQueue::numWorkersForBatchAnalysis(m_pConfig));
 
         connect(m_pAnalyzerQueue, SIGNAL(trackProgress(int)),
                 m_pAnalysisView, SLOT(trackAnalysisProgress(int)));
@@ -149,12 +150,9 @@ void AnalysisFeature::analyzeTracks(QList<TrackId> trackIds) {
         emit(analysisActive(true));
     }
 
-    for (const auto& trackId: trackIds) {
-        TrackPointer pTrack = m_pTrackCollection->getTrackDAO().getTrack(trackId);
-        if (pTrack) {
-            //qDebug() << this << "Queueing track for analysis" << pTrack->getLocation();
-            m_pAnalyzerQueue->queueAnalyseTrack(pTrack);
-        }
+    for (const auto& pTrack: m_pTrackCollection->getTrackDAO().getTracks(trackIds)) {
+        //qDebug() << this << "Queueing track for analysis" << pTrack->getLocation();
+        m_pAnalyzerQueue->queueAnalyseTrack(pTrack);
     }
     if (trackIds.size() > 0) {
         setTitleProgress(0, trackIds.size());
@@ -13,6 +13,11 @@ const double kTransitionPreferenceDefault = 10.0;
 
 static const bool sDebug = false;
 
+// The audio that is prefetched after the fade in of the next track
+const double kPrefetchMarginSeconds = 5.0;
+// Limits the prefetched audio to a part of the minimum cache of a deck
+const double kMaxPrefetchSeconds = 10.0;
+
 DeckAttributes::DeckAttributes(int index,
                                BaseTrackPlayer* pPlayer,
                                EngineChannel::ChannelOrientation orientation)
@@ -24,6 +29,10 @@ DeckAttributes::DeckAttributes(int index,
           m_playPos(group, "playposition"),
           m_play(group, "play"),
           m_repeat(group, "repeat"),
+          m_trackSamples(group, "track_samples"),
+          m_trackSampleRate(group, "track_samplerate"),
+          m_prefetchPosition(group, "prefetch_position"),
+          m_prefetchLength(group, "prefetch_length"),
           m_pPlayer(pPlayer) {
     connect(m_pPlayer, SIGNAL(newTrackLoaded(TrackPointer)),
             this, SLOT(slotTrackLoaded(TrackPointer)));
@@ -38,6 +47,20 @@ DeckAttributes::DeckAttributes(int index,
 DeckAttributes::~DeckAttributes() {
 }
 
+void DeckAttributes::prefetch(double playPosition, double seconds) {
+    const double samples = trackSamples();
+    if (samples <= 0.0 || seconds <= 0.0) {
+        return;
+    }
+    // The controls count the samples of both channels
+    m_prefetchPosition.set(math_clamp(playPosition, 0.0, 1.0) * samples);
+    m_prefetchLength.set(seconds * trackSampleRate() * 2);
+}
+
+void DeckAttributes::cancelPrefetch() {
+    m_prefetchPosition.set(-1.0);
+}
+
 void DeckAttributes::slotPlayChanged(double v) {
     emit(playChanged(this, v > 0.0));
 }
@@ -695,6 +718,8 @@ void AutoDJProcessor::playerPlayChanged(DeckAttributes* pAttributes, bool playin
     // This is required because the user may have loaded a track or changed play
     // manually
     if (playing) {
+        // The audio is in the cache of the deck from now on
+        pAttributes->cancelPrefetch();
         calculateTransition(pAttributes, getOtherDeck(pAttributes));
     }
 }
@@ -748,14 +773,50 @@ void AutoDJProcessor::calculateTransition(DeckAttributes* pFromDeck,
 
             if (m_nextTransitionTime > 0.0) {
                 pFromDeck->posThreshold = 1.0 - pFromDeck->fadeDuration;
+                // Start the fade on a beat of the outgoing track
+                BeatsPointer pBeats = fromTrack->getBeats();
+                const double fromTrackSamples = pFromDeck->trackSamples();
+                if (pBeats && fromTrackSamples > 0.0) {
+                    const double beat = pBeats->findPrevBeat(
+                            pFromDeck->posThreshold * fromTrackSamples);
+                    if (beat > 0.0) {
+                        pFromDeck->posThreshold = beat / fromTrackSamples;
+                    }
+                }
             } else {
                 // in case of pause transition
                 pFromDeck->posThreshold = 1.0;
             }
             qDebug() << "m_fadeDuration" << pFromDeck->group << "="
                      << pFromDeck->fadeDuration;
+
+            if (pToDeck && !pToDeck->isPlaying()) {
+                prefetchTransition(pToDeck);
+            }
+        }
+    }
+}
+
+void AutoDJProcessor::prefetchTransition(DeckAttributes* pToDeck) {
+    TrackPointer toTrack = pToDeck->getLoadedTrack();
+    if (!toTrack) {
+        return;
+    }
+    // Where playerPositionChanged() will start the deck: at the beginning
+    // for a pause between the tracks, otherwise at the current position
+    // unless it is too close to the end
+    double startPosition = 0.0;
+    if (m_nextTransitionTime >= 0.0) {
+        startPosition = pToDeck->playPosition();
+        const double toTrackDuration = toTrack->getDuration();
+        if (toTrackDuration > 0.0) {
+            startPosition = math_min(startPosition,
+                    1.0 - 2 * m_nextTransitionTime / toTrackDuration);
         }
     }
+    pToDeck->prefetch(startPosition, math_min(
+            fabs(m_nextTransitionTime) + kPrefetchMarginSeconds,
+            kMaxPrefetchSeconds));
 }
 
 void AutoDJProcessor::playerTrackLoaded(DeckAttributes* pDeck, TrackPointer pTrack) {
@@ -61,6 +61,22 @@ class DeckAttributes : public QObject {
         m_repeat.set(enabled ? 1.0 : 0.0);
     }
 
+    // The length of the loaded track in samples per channel and its rate,
+    // which are 0 until the track has been opened
+    double trackSamples() const {
+        return m_trackSamples.get();
+    }
+
+    double trackSampleRate() const {
+        return m_trackSampleRate.get();
+    }
+
+    // Keeps the audio from the play position on for the given number of
+    // seconds in the cache of the deck, so that it is ready when the deck
+    // starts playing there
+    void prefetch(double playPosition, double seconds);
+    void cancelPrefetch();
+
     TrackPointer getLoadedTrack() const;
 
   signals:
@@ -88,6 +104,10 @@ class DeckAttributes : public QObject {
     ControlProxy m_playPos;
     ControlProxy m_play;
     ControlProxy m_repeat;
+    ControlProxy m_trackSamples;
+    ControlProxy m_trackSampleRate;
+    ControlProxy m_prefetchPosition;
+    ControlProxy m_prefetchLength;
     BaseTrackPlayer* m_pPlayer;
 };
 
@@ -181,6 +201,9 @@ class AutoDJProcessor : public QObject {
     bool loadNextTrackFromQueue(const DeckAttributes& pDeck, bool play = false);
     void calculateTransition(DeckAttributes* pFromDeck,
                              DeckAttributes* pToDeck);
+    // Prefetches the audio that the deck is going to play during the next
+    // transition
+    void prefetchTransition(DeckAttributes* pToDeck);
     DeckAttributes* getOtherDeck(DeckAttributes* pFromDeck,
                                  bool playing = false);
 
@@ -1,13 +1,22 @@
 #include "library/baseexternallibraryfeature.h"
 
+#include <QDateTime>
+#include <QFileInfo>
 #include <QMenu>
 
 #include "library/basesqltablemodel.h"
+#include "library/dao/settingsdao.h"
 
 BaseExternalLibraryFeature::BaseExternalLibraryFeature(QObject* pParent,
                                                        TrackCollection* pCollection)
         : LibraryFeature(pParent),
-          m_pTrackCollection(pCollection) {
+          m_pTrackCollection(pCollection),
+          m_lastImportProgress(-1) {
+    m_importThreadPool.setMaxThreadCount(1);
+    connect(this, SIGNAL(importProgress(int)),
+            this, SLOT(slotImportProgress(int)),
+            Qt::QueuedConnection);
+
     m_pAddToAutoDJAction = new QAction(tr("Add to Auto DJ Queue (bottom)"), this);
     connect(m_pAddToAutoDJAction, SIGNAL(triggered()),
             this, SLOT(slotAddToAutoDJ()));
@@ -27,6 +36,50 @@ BaseExternalLibraryFeature::~BaseExternalLibraryFeature() {
     delete m_pImportAsMixxxPlaylistAction;
 }
 
+// static
+QString BaseExternalLibraryFeature::importStateOfFile(const QString& filePath) {
+    const QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        return QString();
+    }
+    return QString("%1|%2|%3").arg(
+            fileInfo.absoluteFilePath(),
+            QString::number(fileInfo.size()),
+            QString::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+}
+
+// static
+bool BaseExternalLibraryFeature::isImportUpToDate(QSqlDatabase database,
+        const QString& settingsKey, const QString& importState) {
+    if (importState.isEmpty()) {
+        return false;
+    }
+    return SettingsDAO(database).getValue(settingsKey) == importState;
+}
+
+// static
+void BaseExternalLibraryFeature::setImportState(QSqlDatabase database,
+        const QString& settingsKey, const QString& importState) {
+    SettingsDAO(database).setValue(settingsKey, importState);
+}
+
+void BaseExternalLibraryFeature::reportImportProgress(
+        const QXmlStreamReader& xml) {
+    const QIODevice* pDevice = xml.device();
+    if (!pDevice || pDevice->size() <= 0) {
+        return;
+    }
+    const int percent = static_cast<int>(pDevice->pos() * 100 / pDevice->size());
+    if (percent != m_lastImportProgress) {
+        m_lastImportProgress = percent;
+        emit(importProgress(percent));
+    }
+}
+
+void BaseExternalLibraryFeature::slotImportProgress(int percent) {
+    onImportProgress(percent);
+}
+
 void BaseExternalLibraryFeature::onRightClick(const QPoint& globalPos) {
     Q_UNUSED(globalPos);
     m_lastRightClickedIndex = QModelIndex();
@@ -3,6 +3,9 @@
 
 #include <QAction>
 #include <QModelIndex>
+#include <QSqlDatabase>
+#include <QThreadPool>
+#include <QXmlStreamReader>
 
 #include "library/libraryfeature.h"
 
@@ -19,7 +22,30 @@ class BaseExternalLibraryFeature : public LibraryFeature {
     virtual void onRightClick(const QPoint& globalPos);
     virtual void onRightClickChild(const QPoint& globalPos, QModelIndex index);
 
+  signals:
+    // Emitted from the import thread when the percentage of the parsed
+    // file has changed
+    void importProgress(int percent);
+
   protected:
+    // Identifies the state of an exported library file by its location,
+    // size and modification time
+    static QString importStateOfFile(const QString& filePath);
+    // The import state is stored in the settings of the library once the
+    // tables of a feature are in sync with the exported file, so that an
+    // unchanged file is not parsed and imported again
+    static bool isImportUpToDate(QSqlDatabase database,
+            const QString& settingsKey, const QString& importState);
+    static void setImportState(QSqlDatabase database,
+            const QString& settingsKey, const QString& importState);
+
+    // Called from the import thread while parsing the file
+    void reportImportProgress(const QXmlStreamReader& xml);
+    // Called with the progress of the import in the thread of the feature
+    virtual void onImportProgress(int percent) {
+        Q_UNUSED(percent);
+    }
+
     // Must be implemented by external Libraries copied to Mixxx DB
     virtual BaseSqlTableModel* getPlaylistModelForPlaylist(QString playlist) {
         Q_UNUSED(playlist);
@@ -32,7 +58,12 @@ class BaseExternalLibraryFeature : public LibraryFeature {
 
     TrackCollection* const m_pTrackCollection;
 
+    // The imports of a feature run one after the other, without changing
+    // the size of the global thread pool
+    QThreadPool m_importThreadPool;
+
   private slots:
+    void slotImportProgress(int percent);
     void slotAddToAutoDJ();
     void slotAddToAutoDJTop();
     void slotImportAsMixxxPlaylist();
@@ -43,6 +74,9 @@ class BaseExternalLibraryFeature : public LibraryFeature {
     QAction* m_pAddToAutoDJAction;
     QAction* m_pAddToAutoDJTopAction;
     QAction* m_pImportAsMixxxPlaylistAction;
+
+    // Only accessed by the import thread
+    int m_lastImportProgress;
 };
 
 #endif // BASEEXTERNALLIBRARYFEATURE_H
@@ -548,11 +548,13 @@ void BasePlaylistFeature::slotExportTrackFiles() {
     pPlaylistTableModel->select();
 
     int rows = pPlaylistTableModel->rowCount();
-    QList<TrackPointer> tracks;
+    QList<TrackId> trackIds;
     for (int i = 0; i < rows; ++i) {
         QModelIndex index = pPlaylistTableModel->index(i, 0);
-        tracks.push_back(pPlaylistTableModel->getTrack(index));
+        trackIds.push_back(pPlaylistTableModel->getTrackId(index));
     }
+    QList<TrackPointer> tracks(
+            m_pTrackCollection->getTrackDAO().getTracks(trackIds));
 
     TrackExportWizard track_export(nullptr, m_pConfig, tracks);
     track_export.exportTracks();
@@ -651,25 +653,27 @@ QModelIndex BasePlaylistFeature::constructChildModel(int selected_id) {
 }
 
 void BasePlaylistFeature::updateChildModel(int selected_id) {
-    buildPlaylistList();
-
+    // Only the row of the changed playlist is refreshed
     int row = 0;
-    for (QList<QPair<int, QString> >::const_iterator it = m_playlistList.begin();
+    for (QList<QPair<int, QString> >::iterator it = m_playlistList.begin();
          it != m_playlistList.end(); ++it, ++row) {
         int playlist_id = it->first;
-        QString playlist_name = it->second;
 
         if (selected_id == playlist_id) {
-            TreeItem* item = m_childModel.getItem(indexFromPlaylistId(playlist_id));
-            item->setLabel(playlist_name);
+            it->second = fetchPlaylistLabel(playlist_id);
+            QModelIndex index = m_childModel.index(row, 0);
+            TreeItem* item = m_childModel.getItem(index);
+            item->setLabel(it->second);
             item->setData(playlist_id);
             decorateChild(item, playlist_id);
+            m_childModel.triggerRepaint(index);
         }
-
     }
 }
 
-
+QString BasePlaylistFeature::fetchPlaylistLabel(int playlistId) {
+    return m_playlistDao.getPlaylistName(playlistId);
+}
 
 /**
   * Clears the child model dynamically, but the invisible root item remains
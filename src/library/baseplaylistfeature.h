@@ -71,6 +71,9 @@ class BasePlaylistFeature : public LibraryFeature {
     virtual void updateChildModel(int selected_id);
     virtual void clearChildModel();
     virtual void buildPlaylistList() = 0;
+    // Returns the label of a single playlist in the list, which is the
+    // name unless overridden
+    virtual QString fetchPlaylistLabel(int playlistId);
     virtual void decorateChild(TreeItem *pChild, int playlist_id) = 0;
     virtual void addToAutoDJ(bool bTop);
 
@@ -4,6 +4,9 @@
 #include <QtDebug>
 #include <QUrl>
 
+#include <algorithm>
+#include <cstdlib>
+
 #include "library/basesqltablemodel.h"
 
 #include "library/coverartdelegate.h"
@@ -12,6 +15,7 @@
 #include "library/bpmdelegate.h"
 #include "library/previewbuttondelegate.h"
 #include "library/queryutil.h"
+#include "library/sqlselectthread.h"
 #include "mixer/playermanager.h"
 #include "mixer/playerinfo.h"
 #include "track/keyutils.h"
@@ -20,6 +24,7 @@
 #include "util/duration.h"
 #include "util/dnd.h"
 #include "util/assert.h"
+#include "util/math.h"
 #include "util/performancetimer.h"
 
 static const bool sDebug = false;
@@ -30,6 +35,11 @@ static const bool sDebug = false;
 static const int kIdColumn = 0;
 static const int kMaxSortColumns = 3;
 
+// The values of the table columns are fetched on demand in pages of rows
+static const int kRowsPerMetadataPage = 256;
+// Enough pages for the rows around the viewport on any screen
+static const int kMaxMetadataPages = 16;
+
 // Constant for getModelSetting(name)
 static const char* COLUMNS_SORTING = "ColumnsSorting";
 
@@ -41,17 +51,24 @@ BaseSqlTableModel::BaseSqlTableModel(QObject* pParent,
           m_pTrackCollection(pTrackCollection),
           m_database(pTrackCollection->database()),
           m_previewDeckGroup(PlayerManager::groupForPreviewDeck(0)),
+          m_tableRowCount(0),
           m_bInitialized(false),
-          m_currentSearch("") {
+          m_currentSearch(""),
+          m_selectGeneration(0),
+          m_bLoading(false) {
     DEBUG_ASSERT(m_pTrackCollection);
     connect(&PlayerInfo::instance(), SIGNAL(trackLoaded(QString, TrackPointer)),
             this, SLOT(trackLoaded(QString, TrackPointer)));
     connect(&m_pTrackCollection->getTrackDAO(), SIGNAL(forceModelUpdate()),
-            this, SLOT(select()));
+            this, SLOT(selectAsync()));
     trackLoaded(m_previewDeckGroup, PlayerInfo::instance().getTrackInfo(m_previewDeckGroup));
 }
 
 BaseSqlTableModel::~BaseSqlTableModel() {
+    SqlSelectThread* pSelectThread = m_pTrackCollection->getSelectThread();
+    if (pSelectThread) {
+        pSelectThread->cancel(this);
+    }
 }
 
 void BaseSqlTableModel::initHeaderData() {
@@ -188,7 +205,9 @@ void BaseSqlTableModel::clearRows() {
     if (!m_rowInfo.isEmpty()) {
         beginRemoveRows(QModelIndex(), 0, m_rowInfo.size() - 1);
         m_rowInfo.clear();
+        m_tableRowCount = 0;
         m_trackIdToRows.clear();
+        m_metadataPages.clear();
         endRemoveRows();
     }
     DEBUG_ASSERT(m_rowInfo.isEmpty());
@@ -213,6 +232,7 @@ void BaseSqlTableModel::replaceRows(
         beginInsertRows(QModelIndex(), 0, rows.size() - 1);
         m_rowInfo = rows;
         m_trackIdToRows = trackIdToRows;
+        m_metadataPages.clear();
         endInsertRows();
     }
 }
@@ -236,12 +256,14 @@ void BaseSqlTableModel::select() {
         qDebug() << this << "select()";
     }
 
+    // Supersedes a pending selectAsync()
+    cancelSelect();
+
     PerformanceTimer time;
     time.start();
 
     // Prepare query for id and all columns not in m_trackSource
-    QString queryString = QString("SELECT %1 FROM %2 %3")
-            .arg(m_tableColumns.join(","), m_tableName, m_tableOrderBy);
+    QString queryString = rowQuery();
 
     if (sDebug) {
         qDebug() << this << "select() executing:" << queryString;
@@ -260,45 +282,17 @@ void BaseSqlTableModel::select() {
         return;
     }
 
-    // Remove all the rows from the table after(!) the query has been
-    // executed successfully. See Bug #1090888.
-    // TODO(rryan) we could edit the table in place instead of clearing it?
-    clearRows();
-
     // The size of the result set is not known in advance for a
     // forward-only query, so we cannot reserve memory for rows
     // in advance.
     QVector<RowInfo> rowInfos;
     QSet<TrackId> trackIds;
-    int idColumn = -1;
+    QHash<TrackId, int> occurrences;
     while (query.next()) {
-        QSqlRecord sqlRecord = query.record();
-
-        if (idColumn < 0) {
-            idColumn = sqlRecord.indexOf(m_idColumn);
-        }
-        VERIFY_OR_DEBUG_ASSERT(idColumn >= 0) {
-            qCritical()
-                    << "ID column not available in database query results:"
-                    << m_idColumn;
-            return;
-        }
-        // TODO(XXX): Can we get rid of the hard-coded assumption that
-        // the the first column always contains the id?
-        DEBUG_ASSERT(idColumn == kIdColumn);
-
-        TrackId trackId(sqlRecord.value(idColumn));
+        // The query only selects the id column
+        TrackId trackId(query.value(kIdColumn));
         trackIds.insert(trackId);
-
-        RowInfo rowInfo;
-        rowInfo.trackId = trackId;
-        // current position defines the ordering
-        rowInfo.order = rowInfos.size();
-        rowInfo.metadata.reserve(sqlRecord.count());
-        for (int i = 0;  i < m_tableColumns.size(); ++i) {
-            rowInfo.metadata.push_back(sqlRecord.value(i));
-        }
-        rowInfos.push_back(rowInfo);
+        rowInfos.push_back(makeRowInfo(trackId, rowInfos.size(), &occurrences));
     }
 
     if (sDebug) {
@@ -313,7 +307,197 @@ void BaseSqlTableModel::select() {
                                      m_sortColumns,
                                      m_tableColumns.size() - 1, // exclude the 1st column with the id
                                      &m_trackSortOrder);
+    }
+
+    setRows(std::move(rowInfos));
+
+    qDebug() << this << "select() took" << time.elapsed().debugMillisWithUnit()
+             << m_rowInfo.size();
+}
+
+void BaseSqlTableModel::selectAsync() {
+    SqlSelectThread* pSelectThread = m_pTrackCollection->getSelectThread();
+    if (!m_bInitialized || !pSelectThread) {
+        select();
+        return;
+    }
+
+    if (sDebug) {
+        qDebug() << this << "selectAsync()";
+    }
+
+    connect(pSelectThread, SIGNAL(selected(SqlSelectResultPointer)),
+            this, SLOT(slotSelected(SqlSelectResultPointer)),
+            Qt::UniqueConnection);
+
+    SqlSelectRequest request;
+    request.pRequester = this;
+    request.generation = ++m_selectGeneration;
+    request.temporaryViews = SqlSelectThread::temporaryViews(m_database);
+    request.rowQuery = rowQuery();
+    if (m_trackSource) {
+        // Selects the tracks of the rows with a subquery, because their
+        // ids are not known yet
+        request.trackQuery = m_trackSource->filterAndSortQuery(
+                QString("SELECT %1 FROM %2").arg(m_idColumn, m_tableName),
+                m_currentSearch,
+                m_currentSearchFilter,
+                m_trackSourceOrderBy,
+                m_sortColumns,
+                m_tableColumns.size() - 1); // exclude the 1st column with the id
+    }
+    pSelectThread->request(request);
+    setLoading(true);
+}
+
+void BaseSqlTableModel::slotSelected(SqlSelectResultPointer pResult) {
+    if (pResult->pRequester != this ||
+            pResult->generation != m_selectGeneration) {
+        return;
+    }
+    setLoading(false);
+    if (!pResult->ok) {
+        // E.g. a temporary table that only exists on the connection of
+        // this model
+        qWarning() << this << "Failed to select asynchronously";
+        select();
+        return;
+    }
+
+    PerformanceTimer time;
+    time.start();
+
+    QVector<RowInfo> rowInfos;
+    QSet<TrackId> trackIds;
+    QHash<TrackId, int> occurrences;
+    rowInfos.reserve(pResult->rowTrackIds.size());
+    for (const auto& trackId : pResult->rowTrackIds) {
+        trackIds.insert(trackId);
+        rowInfos.push_back(makeRowInfo(trackId, rowInfos.size(), &occurrences));
+    }
+
+    if (m_trackSource && !trackIds.isEmpty()) {
+        m_trackSource->filterAndSortResult(trackIds,
+                                           pResult->sortedTrackIds,
+                                           m_currentSearch,
+                                           m_currentSearchFilter,
+                                           m_sortColumns,
+                                           m_tableColumns.size() - 1, // exclude the 1st column with the id
+                                           &m_trackSortOrder);
+    }
+
+    setRows(std::move(rowInfos));
+
+    if (sDebug) {
+        qDebug() << this << "slotSelected() took"
+                 << time.elapsed().debugMillisWithUnit() << m_rowInfo.size();
+    }
+}
+
+void BaseSqlTableModel::cancelSelect() {
+    ++m_selectGeneration;
+    SqlSelectThread* pSelectThread = m_pTrackCollection->getSelectThread();
+    if (pSelectThread) {
+        pSelectThread->cancel(this);
+    }
+    setLoading(false);
+}
+
+void BaseSqlTableModel::setLoading(bool loading) {
+    if (m_bLoading != loading) {
+        m_bLoading = loading;
+        emit(loadingChanged(loading));
+    }
+}
+
+QString BaseSqlTableModel::rowQuery() const {
+    // The values of the other columns are fetched on demand
+    return QString("SELECT %1 FROM %2 %3")
+            .arg(m_idColumn, m_tableName, m_tableOrderBy);
+}
+
+// static
+BaseSqlTableModel::RowInfo BaseSqlTableModel::makeRowInfo(
+        TrackId trackId, int order, QHash<TrackId, int>* pOccurrences) {
+    RowInfo rowInfo;
+    rowInfo.trackId = trackId;
+    // current position defines the ordering
+    rowInfo.order = order;
+    rowInfo.tableRow = order;
+    rowInfo.occurrence = (*pOccurrences)[trackId]++;
+    return rowInfo;
+}
+
+const QVector<QVariant>& BaseSqlTableModel::rowMetadata(int row) const {
+    const int page = row / kRowsPerMetadataPage;
+    auto it = m_metadataPages.constFind(page);
+    if (it == m_metadataPages.constEnd()) {
+        // Drops the page that is the farthest from this one
+        while (m_metadataPages.size() >= kMaxMetadataPages) {
+            auto farthest = m_metadataPages.begin();
+            for (auto i = m_metadataPages.begin(); i != m_metadataPages.end(); ++i) {
+                if (std::abs(i.key() - page) > std::abs(farthest.key() - page)) {
+                    farthest = i;
+                }
+            }
+            m_metadataPages.erase(farthest);
+        }
+        it = m_metadataPages.insert(page, fetchMetadataPage(page));
+    }
+    return it.value()[row - page * kRowsPerMetadataPage];
+}
+
+QVector<QVector<QVariant>> BaseSqlTableModel::fetchMetadataPage(int page) const {
+    const int firstRow = page * kRowsPerMetadataPage;
+    const int endRow = math_min(firstRow + kRowsPerMetadataPage, m_rowInfo.size());
+
+    QSet<TrackId> trackIds;
+    for (int row = firstRow; row < endRow; ++row) {
+        trackIds.insert(m_rowInfo[row].trackId);
+    }
+    QStringList idStrings;
+    for (const auto& trackId : trackIds) {
+        idStrings << trackId.toString();
+    }
+
+    // The rows of a track that occurs more than once, e.g. in a history
+    // playlist, are told apart by their order in the table
+    QHash<TrackId, QVector<QVector<QVariant>>> trackRows;
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    if (query.exec(QString("SELECT %1 FROM %2 WHERE %3 IN (%4) %5")
+            .arg(m_tableColumns.join(","), m_tableName, m_idColumn,
+                    idStrings.join(","), m_tableOrderBy))) {
+        while (query.next()) {
+            QVector<QVariant> metadata;
+            metadata.reserve(m_tableColumns.size());
+            for (int i = 0; i < m_tableColumns.size(); ++i) {
+                metadata.push_back(query.value(i));
+            }
+            trackRows[TrackId(query.value(kIdColumn))].push_back(metadata);
+        }
+    } else {
+        LOG_FAILED_QUERY(query);
+    }
+
+    QVector<QVector<QVariant>> metadataPage;
+    metadataPage.reserve(endRow - firstRow);
+    for (int row = firstRow; row < endRow; ++row) {
+        const RowInfo& rowInfo = m_rowInfo[row];
+        const QVector<QVector<QVariant>> rows = trackRows.value(rowInfo.trackId);
+        if (rowInfo.occurrence < rows.size()) {
+            metadataPage.push_back(rows[rowInfo.occurrence]);
+        } else {
+            // Removed since the rows have been selected
+            metadataPage.push_back(QVector<QVariant>(m_tableColumns.size()));
+        }
+    }
+    return metadataPage;
+}
 
+void BaseSqlTableModel::setRows(QVector<RowInfo>&& rowInfos) {
+    const int tableRowCount = rowInfos.size();
+    if (m_trackSource) {
         // Re-sort the track IDs since filterAndSort can change their order or mark
         // them for removal (by setting their row to -1).
         for (auto& rowInfo: rowInfos) {
@@ -353,15 +537,243 @@ void BaseSqlTableModel::select() {
     // number of total rows returned by the query
     DEBUG_ASSERT(trackIdToRows.size() <= rowInfos.size());
 
+    // Remove all the rows from the table after(!) the query has been
+    // executed successfully. See Bug #1090888.
+    // TODO(rryan) we could edit the table in place instead of clearing it?
+    clearRows();
+    m_tableRowCount = tableRowCount;
+
     // We're done! Issue the update signals and replace the master maps.
     replaceRows(
             std::move(rowInfos),
             std::move(trackIdToRows));
     // Both rowInfo and trackIdToRows (might) have been moved and
     // must not be used afterwards!
+}
 
-    qDebug() << this << "select() took" << time.elapsed().debugMillisWithUnit()
-             << m_rowInfo.size();
+bool BaseSqlTableModel::canPatchRows() const {
+    // The rows of a table sort are in the order of the table
+    return m_bInitialized && !m_bLoading &&
+            m_trackSourceOrderBy.isEmpty() && !m_tableOrderBy.isEmpty();
+}
+
+bool BaseSqlTableModel::isSortedByTableColumn(
+        int column, Qt::SortOrder order) const {
+    return m_trackSourceOrderBy.isEmpty() && !m_sortColumns.isEmpty() &&
+            m_sortColumns.first().m_column == column &&
+            m_sortColumns.first().m_order == order;
+}
+
+void BaseSqlTableModel::reindexRows(int firstRow) {
+    m_trackIdToRows.clear();
+    m_trackIdToRows.reserve(m_rowInfo.size());
+    QHash<TrackId, int> occurrences;
+    for (int row = 0; row < m_rowInfo.size(); ++row) {
+        RowInfo& rowInfo = m_rowInfo[row];
+        // All rows of a track are either shown or filtered out
+        rowInfo.occurrence = occurrences[rowInfo.trackId]++;
+        m_trackIdToRows[rowInfo.trackId].push_back(row);
+    }
+
+    const int firstPage = firstRow / kRowsPerMetadataPage;
+    for (auto it = m_metadataPages.begin(); it != m_metadataPages.end();) {
+        if (it.key() >= firstPage) {
+            it = m_metadataPages.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool BaseSqlTableModel::insertTableRows(int tableRow,
+                                        const QList<TrackId>& trackIds) {
+    if (!canPatchRows() || tableRow < 0 || tableRow > m_tableRowCount) {
+        return false;
+    }
+    if (trackIds.isEmpty()) {
+        return true;
+    }
+
+    // The inserted tracks that the search shows
+    QHash<TrackId, int> shownTracks;
+    if (m_trackSource) {
+        m_trackSource->filterAndSort(QSet<TrackId>::fromList(trackIds),
+                                     m_currentSearch,
+                                     m_currentSearchFilter,
+                                     m_trackSourceOrderBy,
+                                     m_sortColumns,
+                                     m_tableColumns.size() - 1, // exclude the 1st column with the id
+                                     &shownTracks);
+    }
+    QVector<RowInfo> insertedRows;
+    for (int i = 0; i < trackIds.size(); ++i) {
+        const TrackId& trackId = trackIds[i];
+        if (!m_trackSource || shownTracks.contains(trackId)) {
+            RowInfo rowInfo;
+            rowInfo.trackId = trackId;
+            rowInfo.order = 0;
+            rowInfo.tableRow = tableRow + i;
+            rowInfo.occurrence = 0;
+            insertedRows.push_back(rowInfo);
+            m_trackSortOrder.insert(trackId, 0);
+        }
+    }
+
+    // The first row behind the inserted table rows
+    int firstRow = 0;
+    while (firstRow < m_rowInfo.size() &&
+            m_rowInfo[firstRow].tableRow < tableRow) {
+        ++firstRow;
+    }
+    for (int row = firstRow; row < m_rowInfo.size(); ++row) {
+        m_rowInfo[row].tableRow += trackIds.size();
+    }
+    m_tableRowCount += trackIds.size();
+
+    if (!insertedRows.isEmpty()) {
+        beginInsertRows(QModelIndex(), firstRow,
+                firstRow + insertedRows.size() - 1);
+        m_rowInfo.insert(firstRow, insertedRows.size(), RowInfo());
+        std::copy(insertedRows.begin(), insertedRows.end(),
+                m_rowInfo.begin() + firstRow);
+        reindexRows(firstRow);
+        endInsertRows();
+    } else {
+        reindexRows(firstRow);
+    }
+    if (firstRow + insertedRows.size() < m_rowInfo.size()) {
+        // The rows behind have moved, e.g. their position in a playlist
+        emit(dataChanged(index(firstRow + insertedRows.size(), 0),
+                index(m_rowInfo.size() - 1, columnCount() - 1)));
+    }
+    return true;
+}
+
+bool BaseSqlTableModel::removeTableRows(QList<int> tableRows) {
+    if (!canPatchRows()) {
+        return false;
+    }
+    qSort(tableRows);
+    tableRows.erase(std::unique(tableRows.begin(), tableRows.end()),
+            tableRows.end());
+    if (tableRows.isEmpty()) {
+        return true;
+    }
+    if (tableRows.first() < 0 || tableRows.last() >= m_tableRowCount) {
+        return false;
+    }
+
+    // The rows of the removed table rows, the others move up by the
+    // removed table rows in front of them
+    QVector<int> removedRows;
+    int firstRow = m_rowInfo.size();
+    auto removed = tableRows.constBegin();
+    int removedCount = 0;
+    for (int row = 0; row < m_rowInfo.size(); ++row) {
+        RowInfo& rowInfo = m_rowInfo[row];
+        while (removed != tableRows.constEnd() && *removed < rowInfo.tableRow) {
+            ++removed;
+            ++removedCount;
+        }
+        if (removed != tableRows.constEnd() && *removed == rowInfo.tableRow) {
+            removedRows.push_back(row);
+        }
+        if (firstRow == m_rowInfo.size() &&
+                rowInfo.tableRow >= tableRows.first()) {
+            firstRow = row;
+        }
+        rowInfo.tableRow -= removedCount;
+    }
+    m_tableRowCount -= tableRows.size();
+
+    // Removes consecutive rows at once from the back, so that the rows in
+    // front keep their index
+    reindexRows(firstRow);
+    for (int end = removedRows.size(); end > 0;) {
+        int begin = end - 1;
+        while (begin > 0 && removedRows[begin - 1] == removedRows[begin] - 1) {
+            --begin;
+        }
+        const int first = removedRows[begin];
+        const int count = removedRows[end - 1] - first + 1;
+        beginRemoveRows(QModelIndex(), first, first + count - 1);
+        m_rowInfo.remove(first, count);
+        reindexRows(first);
+        endRemoveRows();
+        end = begin;
+    }
+    if (firstRow < m_rowInfo.size()) {
+        // The rows behind have moved, e.g. their position in a playlist
+        emit(dataChanged(index(firstRow, 0),
+                index(m_rowInfo.size() - 1, columnCount() - 1)));
+    }
+    return true;
+}
+
+bool BaseSqlTableModel::moveTableRow(int fromTableRow, int toTableRow) {
+    if (!canPatchRows() || fromTableRow < 0 || toTableRow < 0 ||
+            fromTableRow >= m_tableRowCount || toTableRow >= m_tableRowCount) {
+        return false;
+    }
+    if (fromTableRow == toTableRow) {
+        return true;
+    }
+
+    // The table rows in between move by one towards fromTableRow
+    int fromRow = -1;
+    for (int row = 0; row < m_rowInfo.size(); ++row) {
+        int& tableRow = m_rowInfo[row].tableRow;
+        if (tableRow == fromTableRow) {
+            fromRow = row;
+            tableRow = toTableRow;
+        } else if (fromTableRow < toTableRow &&
+                tableRow > fromTableRow && tableRow <= toTableRow) {
+            --tableRow;
+        } else if (toTableRow < fromTableRow &&
+                tableRow >= toTableRow && tableRow < fromTableRow) {
+            ++tableRow;
+        }
+    }
+
+    if (fromRow >= 0) {
+        // The index of the moved row after the move
+        int toRow = 0;
+        for (int row = 0; row < m_rowInfo.size(); ++row) {
+            if (row != fromRow && m_rowInfo[row].tableRow < toTableRow) {
+                ++toRow;
+            }
+        }
+        if (toRow != fromRow) {
+            // The destination is given by the index before the move
+            beginMoveRows(QModelIndex(), fromRow, fromRow, QModelIndex(),
+                    toRow > fromRow ? toRow + 1 : toRow);
+            const RowInfo rowInfo = m_rowInfo[fromRow];
+            m_rowInfo.remove(fromRow);
+            m_rowInfo.insert(toRow, rowInfo);
+            reindexRows(math_min(fromRow, toRow));
+            endMoveRows();
+        }
+    }
+
+    // The rows between both table rows have moved
+    const int firstTableRow = math_min(fromTableRow, toTableRow);
+    const int lastTableRow = math_max(fromTableRow, toTableRow);
+    int firstRow = 0;
+    while (firstRow < m_rowInfo.size() &&
+            m_rowInfo[firstRow].tableRow < firstTableRow) {
+        ++firstRow;
+    }
+    int lastRow = firstRow - 1;
+    while (lastRow + 1 < m_rowInfo.size() &&
+            m_rowInfo[lastRow + 1].tableRow <= lastTableRow) {
+        ++lastRow;
+    }
+    reindexRows(firstRow);
+    if (firstRow <= lastRow) {
+        emit(dataChanged(index(firstRow, 0),
+                index(lastRow, columnCount() - 1)));
+    }
+    return true;
 }
 
 void BaseSqlTableModel::setTable(const QString& tableName,
@@ -371,6 +783,12 @@ void BaseSqlTableModel::setTable(const QString& tableName,
     if (sDebug) {
         qDebug() << this << "setTable" << tableName << tableColumns << idColumn;
     }
+    if (tableName != m_tableName) {
+        // The rows of the previous table must not be shown while the
+        // rows of this table are selected asynchronously
+        cancelSelect();
+        clearRows();
+    }
     m_tableName = tableName;
     m_idColumn = idColumn;
     m_tableColumns = tableColumns;
@@ -427,7 +845,7 @@ void BaseSqlTableModel::search(const QString& searchText, const QString& extraFi
         qDebug() << this << "search" << searchText;
     }
     setSearch(searchText, extraFilter);
-    select();
+    selectAsync();
 }
 
 void BaseSqlTableModel::setSort(int column, Qt::SortOrder order) {
@@ -573,7 +991,7 @@ void BaseSqlTableModel::sort(int column, Qt::SortOrder order) {
         qDebug() << this << "sort()" << column << order;
     }
     setSort(column, order);
-    select();
+    selectAsync();
 }
 
 int BaseSqlTableModel::rowCount(const QModelIndex& parent) const {
@@ -994,7 +1412,7 @@ QVariant BaseSqlTableModel::getBaseValue(
             return m_previewDeckTrackId == trackId;
         }
 
-        const QVector<QVariant>& columns = rowInfo.metadata;
+        const QVector<QVariant>& columns = rowMetadata(row);
         if (sDebug) {
             qDebug() << "Returning table-column value" << columns.at(column)
                      << "for column" << column << "role" << role;
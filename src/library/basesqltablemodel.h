@@ -10,6 +10,7 @@
 #include "library/trackcollection.h"
 #include "library/trackmodel.h"
 #include "library/columncache.h"
+#include "library/sqlselectthread.h"
 #include "util/class.h"
 
 // BaseSqlTableModel is a custom-written SQL-backed table which aggressively
@@ -29,6 +30,11 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
         return m_bInitialized;
     }
 
+    // Returns true while the rows are selected asynchronously
+    bool isLoading() const {
+        return m_bLoading;
+    }
+
     void setSearch(const QString& searchText, const QString& extraFilter = QString());
     void setSort(int column, Qt::SortOrder order);
 
@@ -84,6 +90,13 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
 
   public slots:
     void select();
+    // Executes the queries of select() on the select thread of the track
+    // collection, if there is one, and replaces the rows when they arrive.
+    // A later select() or selectAsync() supersedes it.
+    void selectAsync();
+
+  signals:
+    void loadingChanged(bool loading);
 
   protected:
     void setTable(const QString& tableName, const QString& trackIdColumn,
@@ -96,6 +109,23 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     // Use this if you want a model that can be changed
     virtual Qt::ItemFlags readWriteFlags(const QModelIndex &index) const;
 
+    // Patch the rows after rows have been inserted into or removed from the
+    // table, instead of selecting all rows again. The rows are given by
+    // their index in the order of the table before the change, which is
+    // only the order of the model while it is sorted by a column of the
+    // table. Return false without any change if the rows cannot be patched
+    // and need to be selected again.
+    bool insertTableRows(int tableRow, const QList<TrackId>& trackIds);
+    bool removeTableRows(QList<int> tableRows);
+    bool moveTableRow(int fromTableRow, int toTableRow);
+    // The number of rows of the table including those that the search
+    // filters out
+    int tableRowCount() const {
+        return m_tableRowCount;
+    }
+    // Returns true if the rows are sorted by the column of the table
+    bool isSortedByTableColumn(int column, Qt::SortOrder order) const;
+
     TrackCollection* m_pTrackCollection;
     QSqlDatabase m_database;
 
@@ -107,6 +137,7 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     virtual void tracksChanged(QSet<TrackId> trackIds);
     virtual void trackLoaded(QString group, TrackPointer pTrack);
     void refreshCell(int row, int column);
+    void slotSelected(SqlSelectResultPointer pResult);
 
   private:
     // A simple helper function for initializing header title and width.  Note
@@ -123,7 +154,11 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     struct RowInfo {
         TrackId trackId;
         int order;
-        QVector<QVariant> metadata;
+        // The index of the row in the order of the table
+        int tableRow;
+        // The number of rows of the same track before this one in the
+        // order of the table
+        int occurrence;
 
         bool operator<(const RowInfo& other) const {
             // -1 is greater than anything
@@ -138,12 +173,29 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
 
     typedef QHash<TrackId, QLinkedList<int>> TrackId2Rows;
 
+    void cancelSelect();
+    void setLoading(bool loading);
+    QString rowQuery() const;
+    static RowInfo makeRowInfo(TrackId trackId, int order,
+            QHash<TrackId, int>* pOccurrences);
+    const QVector<QVariant>& rowMetadata(int row) const;
+    QVector<QVector<QVariant>> fetchMetadataPage(int page) const;
+    void setRows(QVector<RowInfo>&& rowInfos);
+
+    bool canPatchRows() const;
+    // Updates the occurrences and the rows of the tracks after rows have
+    // been patched, and drops the metadata from firstRow on
+    void reindexRows(int firstRow);
+
     void clearRows();
     void replaceRows(
             QVector<RowInfo>&& rows,
             TrackId2Rows&& trackIdToRows);
 
     QVector<RowInfo> m_rowInfo;
+    int m_tableRowCount;
+    // The values of the table columns of the recently accessed rows
+    mutable QHash<int, QVector<QVector<QVariant>>> m_metadataPages;
 
     QString m_tableName;
     QString m_idColumn;
@@ -158,6 +210,9 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     QString m_currentSearchFilter;
     QVector<QHash<int, QVariant> > m_headerInfo;
     QString m_trackSourceOrderBy;
+    // Identifies the latest request of selectAsync()
+    int m_selectGeneration;
+    bool m_bLoading;
 
     DISALLOW_COPY_AND_ASSIGN(BaseSqlTableModel);
 };
@@ -3,20 +3,38 @@
 
 #include "library/basetrackcache.h"
 
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
 #include <QScopedPointer>
 
+#include <algorithm>
+
 #include "control/controlproxy.h"
 #include "library/trackcollection.h"
 #include "library/searchqueryparser.h"
 #include "library/queryutil.h"
 #include "track/keyutils.h"
 #include "track/trackcache.h"
+#include "util/db/dbconnection.h"
+#include "util/db/sqllikewildcards.h"
+#include "util/math.h"
 #include "util/performancetimer.h"
 
 namespace {
 
 const bool sDebug = false;
 
+// Must be changed whenever the layout of the snapshot changes
+const quint32 kSnapshotMagic = 0x4d585443; // "MXTC"
+const quint32 kSnapshotFormatVersion = 1;
+
+// The tracks that are read again from the table by each query
+const int kMaxTracksPerReload = 500;
+
+// The results of the text filters that are kept for the next keystrokes
+const int kMaxTextFilterResults = 16;
+
 }  // namespace
 
 BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
@@ -32,6 +50,12 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
           m_columnCache(columns),
           m_bIndexBuilt(false),
           m_bIsCaching(isCaching),
+          m_trackInfo(columns.size()),
+          m_memoryAccount(MemoryAccounting::Category::BaseTrackCache),
+          m_textFilterResults(kMaxTextFilterResults),
+          m_maxSortIndexes(0),
+          m_sortIndexKeyNotation(-1.0),
+          m_snapshotGeneration(-1),
           m_trackDAO(pTrackCollection->getTrackDAO()),
           m_database(pTrackCollection->database()),
           m_pQueryParser(new SearchQueryParser(pTrackCollection)) {
@@ -50,10 +74,20 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
     m_searchColumnIndices.resize(m_searchColumns.size());
     for (int i = 0; i < m_searchColumns.size(); ++i) {
         m_searchColumnIndices[i] = m_columnCache.fieldIndex(m_searchColumns[i]);
+        if (m_searchColumnIndices[i] >= 0) {
+            m_indexedColumns.append(m_searchColumns[i]);
+            m_indexedColumnIndices.append(m_searchColumnIndices[i]);
+        }
     }
+    m_pQueryParser->setTextFilterIndex(this);
+    m_pQueryParser->setKeyFilterIndex(this);
 }
 
 BaseTrackCache::~BaseTrackCache() {
+    if (!m_sortIndexFilePath.isEmpty()) {
+        // Even the stale orders are good hints for the next start
+        TrackSortIndex::writeFile(m_sortIndexFilePath, m_sortIndexes);
+    }
     delete m_pQueryParser;
 }
 
@@ -101,7 +135,10 @@ void BaseTrackCache::slotTracksRemoved(QSet<TrackId> trackIds) {
     }
     for (const auto& trackId : trackIds) {
         m_trackInfo.remove(trackId);
+        m_searchIndex.remove(trackId);
+        invalidateIndexes(trackId);
     }
+    updateMemoryAccount();
 }
 
 void BaseTrackCache::slotTrackDirty(TrackId trackId) {
@@ -172,14 +209,15 @@ bool BaseTrackCache::updateIndexWithTrackpointer(TrackPointer pTrack) {
 
     TrackId trackId(pTrack->getId());
     if (trackId.isValid()) {
-        // m_trackInfo[id] will insert a QVector<QVariant> into the
-        // m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[trackId];
-        // prealocate memory for all columns at once
-        record.resize(numColumns);
+        const int row = m_trackInfo.insert(trackId);
         for (int i = 0; i < numColumns; ++i) {
-            getTrackValueForColumn(pTrack, i, record[i]);
+            QVariant trackValue;
+            getTrackValueForColumn(pTrack, i, trackValue);
+            m_trackInfo.setValue(row, i, trackValue);
         }
+        updateSearchIndex(trackId, row);
+        invalidateIndexes(trackId);
+        updateMemoryAccount();
     }
     return true;
 }
@@ -206,31 +244,38 @@ bool BaseTrackCache::updateIndexWithQuery(const QString& queryString) {
     int numColumns = columnCount();
     int idColumn = query.record().indexOf(m_idColumn);
 
+    const int nativeLocationColumn =
+            fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_NATIVELOCATION);
     while (query.next()) {
         TrackId trackId(query.value(idColumn));
 
-        //m_trackInfo[id] will insert a QVector<QVariant> into the
-        //m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[trackId];
-        record.resize(numColumns);
+        // Adds the track if it is not cached yet
+        const int row = m_trackInfo.insert(trackId);
 
         for (int i = 0; i < numColumns; ++i) {
-            if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_NATIVELOCATION) == i) {
+            if (nativeLocationColumn == i) {
                 // Database stores all locations with Qt separators: "/"
                 // Here we want to cache the display string with native separators.
                 QString location = query.value(i).toString();
-                record[i] = QDir::toNativeSeparators(location);
+                m_trackInfo.setValue(row, i, QDir::toNativeSeparators(location));
             }
             else {
-                record[i] = query.value(i);
+                m_trackInfo.setValue(row, i, query.value(i));
             }
         }
+        updateSearchIndex(trackId, row);
+        invalidateIndexes(trackId);
     }
+    updateMemoryAccount();
 
     qDebug() << this << "updateIndexWithQuery took" << timer.elapsed().debugMillisWithUnit();
     return true;
 }
 
+void BaseTrackCache::updateMemoryAccount() {
+    m_memoryAccount.setBytes(m_trackInfo.estimatedBytes());
+}
+
 void BaseTrackCache::buildIndex() {
     if (sDebug) {
         qDebug() << this << "buildIndex()";
@@ -247,10 +292,21 @@ void BaseTrackCache::buildIndex() {
     // clear the table, and keep track of what IDs we see, then delete the ones
     // we don't see.
     m_trackInfo.clear();
+    m_searchIndex.clear();
 
+    if (!m_snapshotFilePath.isEmpty()) {
+        // Changes while the table is read are read again later
+        m_snapshotGeneration = queryGeneration();
+    }
     if (!updateIndexWithQuery(queryString)) {
         qDebug() << "buildIndex failed!";
     }
+    // The orders are verified when they are used next
+    for (auto& sortIndex : m_sortIndexes) {
+        sortIndex.invalidateAll();
+    }
+    m_keyIndex.invalidateAll();
+    m_textFilterResults.clear();
 
     m_bIndexBuilt = true;
 }
@@ -285,6 +341,330 @@ void BaseTrackCache::updateTracksInIndex(QSet<TrackId> trackIds) {
     emit(tracksChanged(trackIds));
 }
 
+void BaseTrackCache::setFullTextSearchTable(const QString& tableName) {
+    m_fullTextSearchTable = tableName;
+    m_searchIndex.clear();
+    m_textFilterResults.clear();
+    if (m_fullTextSearchTable.isEmpty() && m_bIndexBuilt) {
+        for (const auto& trackId : m_trackInfo.trackIds()) {
+            updateSearchIndex(trackId, m_trackInfo.row(trackId));
+        }
+    }
+}
+
+void BaseTrackCache::setSortIndexes(int maxCount, const QString& filePath) {
+    m_maxSortIndexes = math_max(0, maxCount);
+    m_sortIndexFilePath = filePath;
+    m_sortIndexes.clear();
+    if (m_maxSortIndexes > 0 && !m_sortIndexFilePath.isEmpty()) {
+        for (const auto& sortIndex : TrackSortIndex::readFile(m_sortIndexFilePath)) {
+            if (m_sortIndexes.size() < m_maxSortIndexes &&
+                    fieldIndex(sortIndex.columnName()) > 0) {
+                m_sortIndexes.append(sortIndex);
+            }
+        }
+    }
+}
+
+void BaseTrackCache::setSnapshotFile(const QString& filePath) {
+    m_snapshotFilePath = filePath;
+}
+
+qint64 BaseTrackCache::queryGeneration() const {
+    QSqlQuery query(m_database);
+    if (!query.exec("SELECT generation FROM library_generation") ||
+            !query.next()) {
+        LOG_FAILED_QUERY(query);
+        return -1;
+    }
+    return query.value(0).toLongLong();
+}
+
+QSet<TrackId> BaseTrackCache::queryChangedTracks(qint64 generation) const {
+    QSet<TrackId> trackIds;
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT track_id FROM library_changes WHERE generation > :generation");
+    query.bindValue(":generation", generation);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return trackIds;
+    }
+    while (query.next()) {
+        trackIds.insert(TrackId(query.value(0)));
+    }
+    return trackIds;
+}
+
+void BaseTrackCache::reloadTracks(const QSet<TrackId>& trackIds) {
+    // The tracks that have been removed from the table or have left it are
+    // not selected again
+    QStringList idStrings;
+    auto it = trackIds.constBegin();
+    while (it != trackIds.constEnd()) {
+        m_trackInfo.remove(*it);
+        m_searchIndex.remove(*it);
+        invalidateIndexes(*it);
+        idStrings << it->toString();
+        ++it;
+        if (idStrings.size() == kMaxTracksPerReload ||
+                (it == trackIds.constEnd() && !idStrings.isEmpty())) {
+            updateIndexWithQuery(QString("SELECT %1 FROM %2 WHERE %3 in (%4)")
+                    .arg(m_columnsJoined, m_tableName, m_idColumn,
+                            idStrings.join(",")));
+            idStrings.clear();
+        }
+    }
+}
+
+bool BaseTrackCache::readSnapshot() {
+    if (m_snapshotFilePath.isEmpty()) {
+        return false;
+    }
+    QFile file(m_snapshotFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    PerformanceTimer timer;
+    timer.start();
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint32 formatVersion = 0;
+    in >> magic >> formatVersion;
+    if (magic != kSnapshotMagic || formatVersion != kSnapshotFormatVersion) {
+        qWarning() << "Invalid track cache snapshot" << m_snapshotFilePath;
+        return false;
+    }
+    qint64 generation = -1;
+    QString databaseName;
+    QString tableName;
+    QString columnsJoined;
+    bool hasSearchIndex = false;
+    in >> generation >> databaseName >> tableName >> columnsJoined
+       >> hasSearchIndex;
+    // The generation starts again with a new database
+    const qint64 currentGeneration = queryGeneration();
+    if (in.status() != QDataStream::Ok ||
+            databaseName != m_database.databaseName() ||
+            tableName != m_tableName || columnsJoined != m_columnsJoined ||
+            generation < 0 || generation > currentGeneration) {
+        qDebug() << this << "Ignoring outdated track cache snapshot"
+                 << m_snapshotFilePath;
+        return false;
+    }
+    if (!m_trackInfo.read(&in) ||
+            (hasSearchIndex && !m_searchIndex.read(&in))) {
+        qWarning() << "Failed to read track cache snapshot" << m_snapshotFilePath;
+        m_trackInfo.clear();
+        m_searchIndex.clear();
+        updateMemoryAccount();
+        return false;
+    }
+    if (!m_fullTextSearchTable.isEmpty()) {
+        m_searchIndex.clear();
+    } else if (!hasSearchIndex) {
+        for (const auto& trackId : m_trackInfo.trackIds()) {
+            updateSearchIndex(trackId, m_trackInfo.row(trackId));
+        }
+    }
+    // The orders are verified when they are used next
+    for (auto& sortIndex : m_sortIndexes) {
+        sortIndex.invalidateAll();
+    }
+    m_keyIndex.invalidateAll();
+    m_textFilterResults.clear();
+    m_bIndexBuilt = true;
+
+    const QSet<TrackId> changedTrackIds = queryChangedTracks(generation);
+    reloadTracks(changedTrackIds);
+    m_snapshotGeneration = currentGeneration;
+    updateMemoryAccount();
+
+    qDebug() << this << "readSnapshot of" << m_trackInfo.size() << "tracks with"
+             << changedTrackIds.size() << "changed tracks took"
+             << timer.elapsed().debugMillisWithUnit();
+    return true;
+}
+
+bool BaseTrackCache::writeSnapshot() {
+    if (m_snapshotFilePath.isEmpty() || !m_bIndexBuilt) {
+        return false;
+    }
+    const qint64 generation = queryGeneration();
+    if (generation < 0) {
+        return false;
+    }
+    // The values must match the table at the generation of the snapshot
+    reloadTracks(queryChangedTracks(m_snapshotGeneration));
+    m_snapshotGeneration = generation;
+
+    // Written to a temporary file that replaces the old one on commit
+    QSaveFile file(m_snapshotFilePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write" << m_snapshotFilePath
+                   << file.errorString();
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    const bool hasSearchIndex = m_fullTextSearchTable.isEmpty();
+    out << kSnapshotMagic << kSnapshotFormatVersion << generation
+        << m_database.databaseName() << m_tableName << m_columnsJoined
+        << hasSearchIndex;
+    m_trackInfo.write(&out);
+    if (hasSearchIndex) {
+        m_searchIndex.write(&out);
+    }
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "Failed to write" << m_snapshotFilePath
+                   << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void BaseTrackCache::invalidateIndexes(TrackId trackId) {
+    for (auto& sortIndex : m_sortIndexes) {
+        sortIndex.invalidate(trackId);
+    }
+    m_keyIndex.invalidate(trackId);
+    m_textFilterResults.clear();
+}
+
+void BaseTrackCache::updateSearchIndex(TrackId trackId, int row) {
+    if (!m_fullTextSearchTable.isEmpty()) {
+        return;
+    }
+    QStringList values;
+    for (int column : m_indexedColumnIndices) {
+        values.append(m_trackInfo.toString(row, column));
+    }
+    m_searchIndex.update(trackId, values);
+}
+
+bool BaseTrackCache::textFilterTrackIds(const QStringList& sqlColumns,
+                                        const QString& argument,
+                                        TrackIdSet* pTrackIds) const {
+    // The wildcards of LIKE are left to SQL
+    if (!m_bIndexBuilt || !m_fullTextSearchTable.isEmpty() ||
+            argument.size() < TrackSearchIndex::kMinTermLength ||
+            argument.contains(kSqlLikeMatchAll) ||
+            argument.contains(kSqlLikeMatchOne)) {
+        return false;
+    }
+    QVector<int> columns;
+    for (const auto& sqlColumn : sqlColumns) {
+        const int index = m_indexedColumns.indexOf(sqlColumn);
+        if (index < 0) {
+            return false;
+        }
+        columns.append(m_indexedColumnIndices[index]);
+    }
+
+    PerformanceTimer timer;
+    timer.start();
+    const QString term = mixxx::DbConnection::toLatinLow(argument);
+    TrackIdSet previousTrackIds;
+    bool exact = false;
+    const bool refined = m_textFilterResults.findSuperset(
+            sqlColumns, term, &previousTrackIds, &exact);
+    if (refined && exact) {
+        *pTrackIds = previousTrackIds;
+        return true;
+    }
+    // A refined term, e.g. after one more keystroke, only needs to check
+    // the tracks that matched before
+    const QVector<TrackId> candidates = refined ?
+            previousTrackIds.toTrackIds() : m_searchIndex.findCandidates(term);
+    TrackIdSet trackIds;
+    for (const auto& trackId : candidates) {
+        const int row = m_trackInfo.row(trackId);
+        for (int column : columns) {
+            const QString value = m_trackInfo.toString(row, column);
+            if (mixxx::DbConnection::toLatinLow(value).contains(term)) {
+                trackIds.insert(trackId);
+                break;
+            }
+        }
+    }
+    m_textFilterResults.insert(sqlColumns, term, trackIds);
+    *pTrackIds = trackIds;
+
+    if (sDebug) {
+        qDebug() << this << "textFilterTrackIds" << argument << "matches"
+                 << trackIds.size() << "of" << candidates.size() << "candidates in"
+                 << timer.elapsed().debugMillisWithUnit();
+    }
+    return true;
+}
+
+bool BaseTrackCache::textFilterToSql(const QStringList& sqlColumns,
+                                     const QString& argument,
+                                     QString* pSql) const {
+    if (m_fullTextSearchTable.isEmpty()) {
+        TrackIdSet trackIds;
+        if (!textFilterTrackIds(sqlColumns, argument, &trackIds)) {
+            return false;
+        }
+        *pSql = QString("%1 in (%2)").arg(m_idColumn, trackIds.toSqlList());
+        return true;
+    }
+
+    // The wildcards of LIKE are left to SQL
+    if (argument.size() < TrackSearchIndex::kMinTermLength ||
+            argument.contains(kSqlLikeMatchAll) ||
+            argument.contains(kSqlLikeMatchOne)) {
+        return false;
+    }
+    for (const auto& sqlColumn : sqlColumns) {
+        if (!m_indexedColumns.contains(sqlColumn)) {
+            return false;
+        }
+    }
+    // A phrase of the trigram tokenizer matches any substring of the
+    // column, case-insensitively like LIKE. Unlike LIKE it does not
+    // fold the diacritics, which need SQLite 3.45 or newer.
+    QString phrase = argument;
+    phrase.replace("\"", "\"\"");
+    const QString match = QString("{%1} : \"%2\"")
+            .arg(sqlColumns.join(" "), phrase);
+    FieldEscaper escaper(m_database);
+    *pSql = QString("%1 in (SELECT rowid FROM %2 WHERE %2 MATCH %3)")
+            .arg(m_idColumn, m_fullTextSearchTable,
+                    escaper.escapeString(match));
+    return true;
+}
+
+bool BaseTrackCache::keyFilterTrackIds(KeyUtils::KeyMask keys,
+                                       TrackIdSet* pTrackIds) const {
+    const int keyIdColumn = fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY_ID);
+    if (!m_bIndexBuilt || keyIdColumn < 0) {
+        return false;
+    }
+
+    PerformanceTimer timer;
+    timer.start();
+    m_keyIndex.update(m_trackInfo.rows(),
+            [this, keyIdColumn](int row) {
+                return static_cast<mixxx::track::io::key::ChromaticKey>(
+                        static_cast<int>(m_trackInfo.toDouble(row, keyIdColumn)));
+            });
+    TrackIdSet trackIds;
+    for (const auto& trackId : m_keyIndex.select(keys)) {
+        trackIds.insert(trackId);
+    }
+    *pTrackIds = trackIds;
+
+    if (sDebug) {
+        qDebug() << this << "keyFilterTrackIds" << keys << "matches"
+                 << trackIds.size() << "tracks in"
+                 << timer.elapsed().debugMillisWithUnit();
+    }
+    return true;
+}
+
 void BaseTrackCache::getTrackValueForColumn(TrackPointer pTrack,
                                             int column,
                                             QVariant& trackValue) const {
@@ -375,11 +755,9 @@ QVariant BaseTrackCache::data(TrackId trackId, int column) const {
     // metadata. Currently the upper-levels will not delegate row-specific
     // columns to this method, but there should still be a check here I think.
     if (!result.isValid()) {
-        QHash<TrackId, QVector<QVariant> >::const_iterator it =
-                m_trackInfo.find(trackId);
-        if (it != m_trackInfo.end()) {
-            const QVector<QVariant>& fields = it.value();
-            result = fields.value(column, result);
+        const int row = m_trackInfo.row(trackId);
+        if (row >= 0 && column >= 0 && column < m_columnCount) {
+            result = m_trackInfo.value(row, column);
         }
     }
     return result;
@@ -397,35 +775,14 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         return;
     }
 
-    if (!m_bIndexBuilt) {
-        buildIndex();
-    }
-
     QStringList idStrings;
-    // TODO(rryan) consider making this the data passed in and a separate
-    // QVector for output
-    QSet<TrackId> dirtyTracks;
     for (const auto& trackId: trackIds) {
         idStrings << trackId.toString();
-        if (m_dirtyTracks.contains(trackId)) {
-            dirtyTracks.insert(trackId);
-        }
-    }
-
-    std::unique_ptr<QueryNode> pQuery(parseQuery(
-        searchQuery, extraFilter, idStrings));
-
-    QString filter = pQuery->toSql();
-    if (!filter.isEmpty()) {
-        filter.prepend("WHERE ");
     }
 
-    QString queryString = QString("SELECT %1 FROM %2 %3 %4")
-            .arg(m_idColumn, m_tableName, filter, orderByClause);
-
-    if (sDebug) {
-        qDebug() << this << "select() executing:" << queryString;
-    }
+    QString queryString = filterAndSortQuery(
+            idStrings.join(","), searchQuery, extraFilter, orderByClause,
+            sortColumns, columnOffset);
 
     QSqlQuery query(m_database);
     // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
@@ -438,23 +795,65 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
     }
 
     int idColumn = query.record().indexOf(m_idColumn);
-    int rows = query.size();
+    QVector<TrackId> sortedTrackIds;
+    while (query.next()) {
+        sortedTrackIds.append(TrackId(query.value(idColumn)));
+    }
 
     if (sDebug) {
-        qDebug() << "Rows returned:" << rows;
+        qDebug() << "Rows returned:" << sortedTrackIds.size();
     }
 
-    m_trackOrder.resize(0); // keeps alocated memory
-    trackToIndex->clear();
-    if (rows > 0) {
-        trackToIndex->reserve(rows);
-        m_trackOrder.reserve(rows);
+    filterAndSortResult(trackIds, sortedTrackIds, searchQuery, extraFilter,
+            sortColumns, columnOffset, trackToIndex);
+}
+
+QString BaseTrackCache::filterAndSortQuery(const QString& trackIds,
+                                          const QString& searchQuery,
+                                          const QString& extraFilter,
+                                          const QString& orderByClause,
+                                          const QList<SortColumn>& sortColumns,
+                                          const int columnOffset) {
+    if (!m_bIndexBuilt && !readSnapshot()) {
+        buildIndex();
     }
 
-    while (query.next()) {
-        TrackId trackId(query.value(idColumn));
-        (*trackToIndex)[trackId] = m_trackOrder.size();
-        m_trackOrder.append(trackId);
+    std::unique_ptr<QueryNode> pQuery(parseQuery(
+        searchQuery, extraFilter, trackIds));
+
+    QString filter = pQuery->toSql();
+    if (!filter.isEmpty()) {
+        filter.prepend("WHERE ");
+    }
+
+    // The tracks are sorted by filterAndSortResult() instead
+    QString queryString = QString("SELECT %1 FROM %2 %3 %4")
+            .arg(m_idColumn, m_tableName, filter,
+                 sortsInMemory(sortColumns, columnOffset) ?
+                         QString() : orderByClause);
+
+    if (sDebug) {
+        qDebug() << this << "select() executing:" << queryString;
+    }
+    return queryString;
+}
+
+void BaseTrackCache::filterAndSortResult(const QSet<TrackId>& trackIds,
+                                         const QVector<TrackId>& sortedTrackIds,
+                                         const QString& searchQuery,
+                                         const QString& extraFilter,
+                                         const QList<SortColumn>& sortColumns,
+                                         const int columnOffset,
+                                         QHash<TrackId, int>* trackToIndex) {
+    if (sortsInMemory(sortColumns, columnOffset)) {
+        m_trackOrder = sortInMemory(sortedTrackIds, sortColumns, columnOffset);
+    } else {
+        m_trackOrder = sortedTrackIds;
+    }
+    trackToIndex->clear();
+    trackToIndex->reserve(m_trackOrder.size());
+    for (int i = 0; i < m_trackOrder.size(); ++i) {
+        (*trackToIndex)[m_trackOrder[i]] = i;
     }
 
     // At this point, the original set of tracks have been divided into two
@@ -466,10 +865,20 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
     // membership of tracks in either set, we must then insertion-sort the
     // missing tracks into the resulting index list.
 
+    QSet<TrackId> dirtyTracks;
+    for (const auto& trackId: trackIds) {
+        if (m_dirtyTracks.contains(trackId)) {
+            dirtyTracks.insert(trackId);
+        }
+    }
     if (dirtyTracks.size() == 0) {
         return;
     }
 
+    // The filter on the ids of the tracks always matches
+    std::unique_ptr<QueryNode> pQuery(parseQuery(
+        searchQuery, extraFilter, QString()));
+
     for (TrackId trackId: dirtyTracks) {
         // Only get the track if it is in the cache.
         TrackPointer pTrack = lookupCachedTrack(trackId);
@@ -532,15 +941,15 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
 }
 
 std::unique_ptr<QueryNode> BaseTrackCache::parseQuery(QString query, QString extraFilter,
-                                      QStringList idStrings) const {
+                                      QString trackIds) const {
     QStringList queryFragments;
     if (!extraFilter.isNull() && extraFilter != "") {
         queryFragments << QString("(%1)").arg(extraFilter);
     }
 
-    if (idStrings.size() > 0) {
+    if (!trackIds.isEmpty()) {
         queryFragments << QString("%1 in (%2)")
-                .arg(m_idColumn, idStrings.join(","));
+                .arg(m_idColumn, trackIds);
     }
 
     return m_pQueryParser->parseQuery(query, m_searchColumns,
@@ -577,21 +986,21 @@ int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
 
         // This should not happen, but it's a recoverable error so we should
         // only log it.
-        if (!m_trackInfo.contains(otherTrackId)) {
+        const int otherRow = m_trackInfo.row(otherTrackId);
+        if (otherRow < 0) {
             qDebug() << "WARNING: track" << otherTrackId << "was not in index";
             //updateTrackInIndex(otherTrackId);
         }
 
         int compare = 0;
         for (int i = 0; i < sortColumns.count(); i++) {
-            QVariant tableValue =
-                    data(otherTrackId, sortColumns[i].m_column - columnOffset);
-
+            // The values of the table are compared as they are cached,
+            // without looking up the cached Track objects
             compare = compareColumnValues(
                     sortColumns[i].m_column - columnOffset,
                     sortColumns[i].m_order,
                     trackValues[i],
-                    tableValue);
+                    otherRow);
 
             if (compare != 0) {
                 break;
@@ -613,23 +1022,12 @@ int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
 }
 
 int BaseTrackCache::compareColumnValues(int sortColumn, Qt::SortOrder sortOrder,
-                                        QVariant val1, QVariant val2) const {
+                                        const QVariant& val1, int row2) const {
     int result = 0;
 
-    if (sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_YEAR) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_DURATION) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BITRATE) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BPM) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_REPLAYGAIN) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_SAMPLERATE) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_CHANNELS) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TIMESPLAYED) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_RATING) ||
-            sortColumn == fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION)
-    ) {
+    if (isNumericSortColumn(sortColumn)) {
         // Sort as floats.
-        double delta = val1.toDouble() - val2.toDouble();
+        double delta = val1.toDouble() - m_trackInfo.toDouble(row2, sortColumn);
 
         if (fabs(delta) < .00001)
             result = 0;
@@ -644,7 +1042,7 @@ int BaseTrackCache::compareColumnValues(int sortColumn, Qt::SortOrder sortOrder,
         int key1 = KeyUtils::keyToCircleOfFifthsOrder(
             KeyUtils::guessKeyFromText(val1.toString()), notation);
         int key2 = KeyUtils::keyToCircleOfFifthsOrder(
-            KeyUtils::guessKeyFromText(val2.toString()), notation);
+            KeyUtils::guessKeyFromText(m_trackInfo.toString(row2, sortColumn)), notation);
         if (key1 > key2) {
             result = 1;
         } else if (key1 < key2) {
@@ -653,7 +1051,8 @@ int BaseTrackCache::compareColumnValues(int sortColumn, Qt::SortOrder sortOrder,
             result = 0;
         }
     } else {
-        result = val1.toString().localeAwareCompare(val2.toString());
+        result = val1.toString().localeAwareCompare(
+                m_trackInfo.toString(row2, sortColumn));
     }
 
     // If we're in descending order, flip the comparison.
@@ -663,3 +1062,158 @@ int BaseTrackCache::compareColumnValues(int sortColumn, Qt::SortOrder sortOrder,
 
     return result;
 }
+
+bool BaseTrackCache::isNumericSortColumn(int sortColumn) const {
+    return sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_YEAR) ||
+            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER) ||
+            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_DURATION) ||
+            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BITRATE) ||
+            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_BPM) ||
+            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_REPLAYGAIN) ||
+            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_SAMPLERATE) ||
+            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_CHANNELS) ||
+            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_TIMESPLAYED) ||
+            sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_RATING) ||
+            sortColumn == fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION);
+}
+
+// Compares the cached values of two rows in ascending order like
+// compareColumnValues()
+int BaseTrackCache::compareRows(int sortColumn, int row1, int row2) const {
+    if (isNumericSortColumn(sortColumn)) {
+        double delta = m_trackInfo.toDouble(row1, sortColumn) -
+                m_trackInfo.toDouble(row2, sortColumn);
+        if (fabs(delta) < .00001) {
+            return 0;
+        }
+        return delta > 0.0 ? 1 : -1;
+    } else if (sortColumn == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY)) {
+        KeyUtils::KeyNotation notation = KeyUtils::keyNotationFromNumericValue(
+            m_pKeyNotationCP->get());
+        int key1;
+        int key2;
+        const int keyIdColumn = fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY_ID);
+        if (keyIdColumn >= 0) {
+            // Like the SQL of the sort, without parsing the text
+            key1 = KeyUtils::keyToCircleOfFifthsOrder(
+                static_cast<mixxx::track::io::key::ChromaticKey>(
+                    static_cast<int>(m_trackInfo.toDouble(row1, keyIdColumn))),
+                notation);
+            key2 = KeyUtils::keyToCircleOfFifthsOrder(
+                static_cast<mixxx::track::io::key::ChromaticKey>(
+                    static_cast<int>(m_trackInfo.toDouble(row2, keyIdColumn))),
+                notation);
+        } else {
+            key1 = KeyUtils::keyToCircleOfFifthsOrder(
+                KeyUtils::guessKeyFromText(m_trackInfo.toString(row1, sortColumn)),
+                notation);
+            key2 = KeyUtils::keyToCircleOfFifthsOrder(
+                KeyUtils::guessKeyFromText(m_trackInfo.toString(row2, sortColumn)),
+                notation);
+        }
+        return key1 - key2;
+    }
+    return m_trackInfo.toString(row1, sortColumn).localeAwareCompare(
+            m_trackInfo.toString(row2, sortColumn));
+}
+
+bool BaseTrackCache::sortsInMemory(const QList<SortColumn>& sortColumns,
+                                   const int columnOffset) const {
+    if (m_maxSortIndexes <= 0 || sortColumns.isEmpty()) {
+        return false;
+    }
+    // Only the cached columns, i.e. neither the id nor the columns of the
+    // table of the model
+    for (const auto& sc : sortColumns) {
+        const int column = sc.m_column - columnOffset;
+        if (column <= 0 || column >= m_columnCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const TrackSortIndex& BaseTrackCache::sortIndex(int column) {
+    const QString columnName = columnNameForFieldIndex(column);
+    int i = 0;
+    while (i < m_sortIndexes.size() &&
+            m_sortIndexes[i].columnName() != columnName) {
+        ++i;
+    }
+    if (i < m_sortIndexes.size()) {
+        m_sortIndexes.move(i, 0);
+    } else {
+        m_sortIndexes.prepend(TrackSortIndex(columnName));
+        while (m_sortIndexes.size() > m_maxSortIndexes) {
+            m_sortIndexes.removeLast();
+        }
+    }
+
+    TrackSortIndex& index = m_sortIndexes.first();
+    if (column == fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY)) {
+        // The order of the keys depends on their notation
+        const double keyNotation = m_pKeyNotationCP->get();
+        if (keyNotation != m_sortIndexKeyNotation) {
+            index.invalidateAll();
+            m_sortIndexKeyNotation = keyNotation;
+        }
+    }
+    PerformanceTimer timer;
+    timer.start();
+    index.update(m_trackInfo.rows(),
+            [this, column](int row1, int row2) {
+                return compareRows(column, row1, row2);
+            });
+    if (sDebug) {
+        qDebug() << this << "sortIndex()" << columnName << "took"
+                 << timer.elapsed().debugMillisWithUnit();
+    }
+    return index;
+}
+
+QVector<TrackId> BaseTrackCache::sortInMemory(const QVector<TrackId>& trackIds,
+        const QList<SortColumn>& sortColumns,
+        const int columnOffset) {
+    const int primaryColumn = sortColumns.first().m_column - columnOffset;
+    QSet<TrackId> trackIdSet;
+    trackIdSet.reserve(trackIds.size());
+    for (const auto& trackId : trackIds) {
+        trackIdSet.insert(trackId);
+    }
+    QVector<TrackId> sortedTrackIds = sortIndex(primaryColumn).select(
+            trackIdSet, sortColumns.first().m_order);
+    if (sortColumns.size() < 2) {
+        return sortedTrackIds;
+    }
+
+    // The tracks with equal values of the primary column are sorted by the
+    // other columns
+    auto compareSecondary = [this, &sortColumns, columnOffset](
+            const TrackId& lhs, const TrackId& rhs) {
+        const int row1 = m_trackInfo.row(lhs);
+        const int row2 = m_trackInfo.row(rhs);
+        for (int i = 1; i < sortColumns.size(); ++i) {
+            int compare = compareRows(
+                    sortColumns[i].m_column - columnOffset, row1, row2);
+            if (compare != 0) {
+                return sortColumns[i].m_order == Qt::AscendingOrder ?
+                        compare < 0 : compare > 0;
+            }
+        }
+        return false;
+    };
+    auto first = sortedTrackIds.begin();
+    while (first != sortedTrackIds.end()) {
+        const int firstRow = m_trackInfo.row(*first);
+        auto last = first + 1;
+        while (last != sortedTrackIds.end() &&
+                compareRows(primaryColumn, firstRow, m_trackInfo.row(*last)) == 0) {
+            ++last;
+        }
+        if (last - first > 1) {
+            std::stable_sort(first, last, compareSecondary);
+        }
+        first = last;
+    }
+    return sortedTrackIds;
+}
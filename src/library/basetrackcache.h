@@ -16,9 +16,16 @@
 #include "control/controlproxy.h"
 #include "library/dao/trackdao.h"
 #include "library/columncache.h"
+#include "library/columnartrackinfo.h"
+#include "library/searchquery.h"
+#include "library/textfilterresultcache.h"
+#include "library/trackkeyindex.h"
+#include "library/tracksearchindex.h"
+#include "library/tracksortindex.h"
 #include "track/track.h"
 #include "util/class.h"
 #include "util/memory.h"
+#include "util/memoryaccounting.h"
 
 class SearchQueryParser;
 class QueryNode;
@@ -40,7 +47,18 @@ class SortColumn {
 // waste of memory because all the table-models were caching the same data
 // (track properties). Furthermore, the base SQL tables of these table-models
 // involve complicated joins, which are very slow.
-class BaseTrackCache : public QObject {
+//
+// The text of the search columns is indexed by trigrams, which answers the
+// text filters of the searches without a LIKE over all tracks. The results
+// of the recent text filters are kept, so a term that is refined by one more
+// keystroke only checks the tracks that matched before. The tracks are also
+// grouped by their key, which answers the key filters.
+//
+// If enabled, the tracks are also kept in the order of the columns that
+// were sorted by most recently. Sorting by these columns then only picks
+// the matching tracks from the kept order instead of sorting them in SQL.
+class BaseTrackCache : public QObject, public TextFilterIndex,
+                       public KeyFilterIndex {
     Q_OBJECT
   public:
     BaseTrackCache(TrackCollection* pTrackCollection,
@@ -71,11 +89,60 @@ class BaseTrackCache : public QObject {
                                const QList<SortColumn>& sortColumns,
                                const int columnOffset,
                                QHash<TrackId, int>* trackToIndex);
+    // The two steps of filterAndSort(), which allow to execute the query on
+    // another connection. The tracks are passed as a comma separated list of
+    // ids or as a query that selects them. The result of the query provides
+    // the ids in their sorted order; the trackIds that are passed with it
+    // must be the tracks that were selected. Both steps must be passed the
+    // same sort columns.
+    QString filterAndSortQuery(const QString& trackIds,
+                               const QString& query,
+                               const QString& extraFilter,
+                               const QString& orderByClause,
+                               const QList<SortColumn>& sortColumns,
+                               const int columnOffset);
+    void filterAndSortResult(const QSet<TrackId>& trackIds,
+                             const QVector<TrackId>& sortedTrackIds,
+                             const QString& query,
+                             const QString& extraFilter,
+                             const QList<SortColumn>& sortColumns,
+                             const int columnOffset,
+                             QHash<TrackId, int>* trackToIndex);
     virtual bool isCached(TrackId trackId) const;
     virtual void ensureCached(TrackId trackId);
     virtual void ensureCached(QSet<TrackId> trackIds);
     virtual void setSearchColumns(const QStringList& columns);
 
+    // Answers the text searches from an FTS5 table with the trigram
+    // tokenizer instead of the index in memory. The rowid of the table is
+    // the id of the track and its columns are named like the search
+    // columns. Pass an empty name to use the index in memory again.
+    void setFullTextSearchTable(const QString& tableName);
+
+    // Keeps the order of the tracks for up to maxCount of the columns that
+    // were sorted by most recently. The orders are restored from and saved
+    // to the file, which may be empty. 0 disables the sorting in memory.
+    void setSortIndexes(int maxCount, const QString& filePath);
+
+    // Restores the values and the search index from the file instead of
+    // reading all tracks from the table when the index is built lazily.
+    // The table must be the library, whose changes are recorded by their
+    // generation: only the tracks that have changed since the snapshot are
+    // read again.
+    void setSnapshotFile(const QString& filePath);
+    // Writes the snapshot of the current generation, which should be done
+    // before the database is closed
+    bool writeSnapshot();
+
+    bool textFilterTrackIds(const QStringList& sqlColumns,
+                            const QString& argument,
+                            TrackIdSet* pTrackIds) const override;
+    bool textFilterToSql(const QStringList& sqlColumns,
+                         const QString& argument,
+                         QString* pSql) const override;
+    bool keyFilterTrackIds(KeyUtils::KeyMask keys,
+                           TrackIdSet* pTrackIds) const override;
+
   signals:
     void tracksChanged(QSet<TrackId> trackIds);
 
@@ -93,17 +160,34 @@ class BaseTrackCache : public QObject {
     bool updateIndexWithTrackpointer(TrackPointer pTrack);
     void updateTrackInIndex(TrackId trackId);
     void updateTracksInIndex(QSet<TrackId> trackIds);
+    void updateSearchIndex(TrackId trackId, int row);
+    bool readSnapshot();
+    qint64 queryGeneration() const;
+    QSet<TrackId> queryChangedTracks(qint64 generation) const;
+    void reloadTracks(const QSet<TrackId>& trackIds);
     void getTrackValueForColumn(TrackPointer pTrack, int column,
                                 QVariant& trackValue) const;
 
     std::unique_ptr<QueryNode> parseQuery(QString query, QString extraFilter,
-                          QStringList idStrings) const;
+                          QString trackIds) const;
     int findSortInsertionPoint(TrackPointer pTrack,
                                const QList<SortColumn>& sortColumns,
                                const int columnOffset,
                                const QVector<TrackId>& trackIds) const;
     int compareColumnValues(int sortColumn, Qt::SortOrder sortOrder,
-                            QVariant val1, QVariant val2) const;
+                            const QVariant& val1, int row2) const;
+    int compareRows(int sortColumn, int row1, int row2) const;
+    bool isNumericSortColumn(int sortColumn) const;
+    bool sortsInMemory(const QList<SortColumn>& sortColumns,
+                       const int columnOffset) const;
+    QVector<TrackId> sortInMemory(const QVector<TrackId>& trackIds,
+                                  const QList<SortColumn>& sortColumns,
+                                  const int columnOffset);
+    const TrackSortIndex& sortIndex(int column);
+    // Invalidates the track in the sort indexes and the key index
+    void invalidateIndexes(TrackId trackId);
+    // After the cached values have been changed
+    void updateMemoryAccount();
     bool trackMatches(const TrackPointer& pTrack,
                       const QRegExp& matcher) const;
     bool trackMatchesNumeric(const TrackPointer& pTrack,
@@ -134,7 +218,27 @@ class BaseTrackCache : public QObject {
 
     bool m_bIndexBuilt;
     bool m_bIsCaching;
-    QHash<TrackId, QVector<QVariant> > m_trackInfo;
+    ColumnarTrackInfo m_trackInfo;
+    MemoryAccount m_memoryAccount;
+    // The search columns at construction that are cached
+    QStringList m_indexedColumns;
+    QVector<int> m_indexedColumnIndices;
+    TrackSearchIndex m_searchIndex;
+    // Narrows the candidates while a search is typed
+    mutable TextFilterResultCache m_textFilterResults;
+    QString m_fullTextSearchTable;
+    // Updated when a key filter is answered
+    mutable TrackKeyIndex m_keyIndex;
+    // The most recently used first
+    QList<TrackSortIndex> m_sortIndexes;
+    int m_maxSortIndexes;
+    QString m_sortIndexFilePath;
+    // The key notation of the order of the key column
+    double m_sortIndexKeyNotation;
+    QString m_snapshotFilePath;
+    // The generation of the library that the cached values are known to
+    // match, apart from the tracks that have changed since
+    qint64 m_snapshotGeneration;
     TrackDAO& m_trackDAO;
     QSqlDatabase m_database;
     SearchQueryParser* m_pQueryParser;
@@ -5,6 +5,7 @@
 #include <QPalette>
 
 #include "library/bpmdelegate.h"
+#include "library/cellpixmapcache.h"
 #include "library/trackmodel.h"
 
 // We override the typical QDoubleSpinBox editor by registering this class with
@@ -78,8 +79,14 @@ void BPMDelegate::paint(QPainter* painter,const QStyleOptionViewItem &option,
     if (m_pTableView != NULL) {
         QStyle* style = m_pTableView->style();
         if (style != NULL) {
-            style->drawControl(QStyle::CE_ItemViewItem, &opt, painter,
-                               m_pCheckBox);
+            CellPixmapCache::paint(painter, opt.rect,
+                    "bpm|" + CellPixmapCache::optionKey(opt, style),
+                    [this, &opt, style](QPainter* pPainter, const QRect& rect) {
+                        QStyleOptionViewItemV4 cellOption = opt;
+                        cellOption.rect = rect;
+                        style->drawControl(QStyle::CE_ItemViewItem,
+                                           &cellOption, pPainter, m_pCheckBox);
+                    });
         }
     }
 }
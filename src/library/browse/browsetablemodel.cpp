@@ -95,7 +95,18 @@ void BrowseTableModel::addSearchColumn(int index) {
 
 void BrowseTableModel::setPath(const MDir& path) {
     m_current_directory = path;
-    m_pBrowseThread->executePopulation(m_current_directory, this);
+    // The tracks of the library are loaded from the database at once
+    // instead of reading their files again
+    TrackDAO& trackDao = m_pTrackCollection->getTrackDAO();
+    m_libraryTracks = trackDao.getTracks(trackDao.getTrackIdsInDirectory(
+            m_current_directory.dir().absolutePath()));
+    QSet<QString> libraryLocations;
+    libraryLocations.reserve(m_libraryTracks.size());
+    for (const auto& pTrack: m_libraryTracks) {
+        libraryLocations.insert(pTrack->getLocation());
+    }
+    m_pBrowseThread->executePopulation(m_current_directory, this,
+            libraryLocations);
 }
 
 TrackPointer BrowseTableModel::getTrack(const QModelIndex& index) const {
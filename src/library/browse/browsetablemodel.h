@@ -83,6 +83,9 @@ class BrowseTableModel : public QStandardItemModel, public virtual TrackModel {
     TrackCollection* m_pTrackCollection;
     RecordingManager* m_pRecordingManager;
     BrowseThreadPointer m_pBrowseThread;
+    // Keeps the tracks of the library in the current directory cached
+    // while the BrowseThread is populating the model
+    QList<TrackPointer> m_libraryTracks;
     QString m_previewDeckGroup;
 };
 
@@ -6,17 +6,47 @@
 #include <QStringList>
 #include <QDateTime>
 #include <QDirIterator>
+#include <QRunnable>
+
+#include <vector>
 
 #include "library/browse/browsetablemodel.h"
 
 #include "sources/soundsourceproxy.h"
 #include "track/trackcache.h"
+#include "util/math.h"
+#include "util/memory.h"
 #include "util/trace.h"
 
 
 QWeakPointer<BrowseThread> BrowseThread::m_weakInstanceRef;
 static QMutex s_Mutex;
 
+namespace {
+
+// The tags of a few files are read at once, since reading them is mostly
+// waiting for the drive
+const int kTagReaderThreadCount = 4;
+
+// The rows that are sent to the GUI at once
+const int kRowsPerBatch = 16;
+
+// The rows of the files outside of the library that are kept for visiting
+// their folders again
+const int kMaxCachedRows = 10000;
+
+} // anonymous namespace
+
+struct BrowseThread::CachedRow {
+    ~CachedRow() {
+        qDeleteAll(items);
+    }
+
+    QDateTime fileModifiedTime;
+    qint64 fileSize;
+    QList<QStandardItem*> items;
+};
+
 /*
  * This class is a singleton and represents a thread
  * that is used to read ID3 metadata
@@ -29,9 +59,11 @@ static QMutex s_Mutex;
  * make sense to use this class in non-GUI threads
  */
 BrowseThread::BrowseThread(QObject *parent)
-        : QThread(parent) {
+        : QThread(parent),
+          m_rowCache(kMaxCachedRows) {
     m_bStopThread = false;
     m_model_observer = NULL;
+    m_tagReaderPool.setMaxThreadCount(kTagReaderThreadCount);
     //start Thread
     start(QThread::LowPriority);
 
@@ -63,10 +95,12 @@ BrowseThreadPointer BrowseThread::getInstanceRef() {
     return strong;
 }
 
-void BrowseThread::executePopulation(const MDir& path, BrowseTableModel* client) {
+void BrowseThread::executePopulation(const MDir& path, BrowseTableModel* client,
+        const QSet<QString>& libraryLocations) {
     m_path_mutex.lock();
     m_path = path;
     m_model_observer = client;
+    m_libraryLocations = libraryLocations;
     m_path_mutex.unlock();
     m_locationUpdated.wakeAll();
 }
@@ -98,7 +132,15 @@ public:
         QStandardItem(year) {
     }
 
-    QVariant data(int role) const {
+    YearItem(const YearItem& other)
+        : QStandardItem(other) {
+    }
+
+    QStandardItem* clone() const override {
+        return new YearItem(*this);
+    }
+
+    QVariant data(int role) const override {
         switch (role) {
         case Qt::DisplayRole:
         {
@@ -111,12 +153,177 @@ public:
     }
 };
 
+QList<QStandardItem*> createRow(const TrackPointer& pTrack) {
+    QList<QStandardItem*> row_data;
+
+    QStandardItem* item = new QStandardItem("0");
+    item->setData("0", Qt::UserRole);
+    row_data.insert(COLUMN_PREVIEW, item);
+
+    item = new QStandardItem(pTrack->getFileName());
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_FILENAME, item);
+
+    item = new QStandardItem(pTrack->getArtist());
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_ARTIST, item);
+
+    item = new QStandardItem(pTrack->getTitle());
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_TITLE, item);
+
+    item = new QStandardItem(pTrack->getAlbum());
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_ALBUM, item);
+
+    item = new QStandardItem(pTrack->getAlbumArtist());
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_ALBUMARTIST, item);
+
+    item = new QStandardItem(pTrack->getTrackNumber());
+    item->setToolTip(item->text());
+    item->setData(item->text().toInt(), Qt::UserRole);
+    row_data.insert(COLUMN_TRACK_NUMBER, item);
+
+    const QString year(pTrack->getYear());
+    item = new YearItem(year);
+    item->setToolTip(year);
+    // The year column is sorted according to the numeric calendar year
+    item->setData(mixxx::TrackMetadata::parseCalendarYear(year), Qt::UserRole);
+    row_data.insert(COLUMN_YEAR, item);
+
+    item = new QStandardItem(pTrack->getGenre());
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_GENRE, item);
+
+    item = new QStandardItem(pTrack->getComposer());
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_COMPOSER, item);
+
+    item = new QStandardItem(pTrack->getGrouping());
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_GROUPING, item);
+
+    item = new QStandardItem(pTrack->getComment());
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_COMMENT, item);
+
+    QString duration = pTrack->getDurationText(mixxx::Duration::Precision::SECONDS);
+    item = new QStandardItem(duration);
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_DURATION, item);
+
+    item = new QStandardItem(pTrack->getBpmText());
+    item->setToolTip(item->text());
+    item->setData(pTrack->getBpm(), Qt::UserRole);
+    row_data.insert(COLUMN_BPM, item);
+
+    item = new QStandardItem(pTrack->getKeyText());
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_KEY, item);
+
+    item = new QStandardItem(pTrack->getType());
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_TYPE, item);
+
+    item = new QStandardItem(pTrack->getBitrateText());
+    item->setToolTip(item->text());
+    item->setData(pTrack->getBitrate(), Qt::UserRole);
+    row_data.insert(COLUMN_BITRATE, item);
+
+    QString location = pTrack->getLocation();
+    QString nativeLocation = QDir::toNativeSeparators(location);
+    item = new QStandardItem(nativeLocation);
+    item->setToolTip(nativeLocation);
+    item->setData(location, Qt::UserRole);
+    row_data.insert(COLUMN_NATIVELOCATION, item);
+
+    QDateTime modifiedTime = pTrack->getFileModifiedTime().toLocalTime();
+    item = new QStandardItem(modifiedTime.toString(Qt::DefaultLocaleShortDate));
+    item->setToolTip(item->text());
+    item->setData(modifiedTime, Qt::UserRole);
+    row_data.insert(COLUMN_FILE_MODIFIED_TIME, item);
+
+    QDateTime creationTime = pTrack->getFileCreationTime().toLocalTime();
+    item = new QStandardItem(creationTime.toString(Qt::DefaultLocaleShortDate));
+    item->setToolTip(item->text());
+    item->setData(creationTime, Qt::UserRole);
+    row_data.insert(COLUMN_FILE_CREATION_TIME, item);
+
+    const mixxx::ReplayGain replayGain(pTrack->getReplayGain());
+    item = new QStandardItem(
+            mixxx::ReplayGain::ratioToString(replayGain.getRatio()));
+    item->setToolTip(item->text());
+    item->setData(item->text(), Qt::UserRole);
+    row_data.insert(COLUMN_REPLAYGAIN, item);
+    return row_data;
 }
 
+QList<QStandardItem*> cloneRow(const QList<QStandardItem*>& items) {
+    QList<QStandardItem*> row_data;
+    row_data.reserve(items.size());
+    for (const auto* pItem: items) {
+        row_data.append(pItem->clone());
+    }
+    return row_data;
+}
+
+// Resolves the track of a file and reads its tags if they have never been
+// read before, e.g. unless it is a track of the library
+class TagReader: public QRunnable {
+  public:
+    TagReader(int row, const QString& location, SecurityTokenPointer pToken)
+            : m_row(row),
+              m_location(location),
+              m_pToken(pToken) {
+        setAutoDelete(false);
+    }
+
+    void run() override {
+        // The TrackCache is unlocked instantly even if a new track object
+        // has been created and inserted into the cache. Newly created track
+        // objects will only contain a reference of the corresponding file,
+        // but not any metadata, yet. This reduces lock contention on the
+        // global track cache.
+        m_pTrack = TrackCache::instance().resolve(
+                m_location, m_pToken).getTrack();
+        // Update the track object by (re-)importing metadata from the file
+        SoundSourceProxy(m_pTrack).updateTrackFromSource();
+    }
+
+    int row() const {
+        return m_row;
+    }
+    const TrackPointer& getTrack() const {
+        return m_pTrack;
+    }
+
+  private:
+    const int m_row;
+    const QString m_location;
+    const SecurityTokenPointer m_pToken;
+    TrackPointer m_pTrack;
+};
+
+} // anonymous namespace
+
 void BrowseThread::populateModel() {
     m_path_mutex.lock();
     MDir thisPath = m_path;
     BrowseTableModel* thisModelObserver = m_model_observer;
+    const QSet<QString> libraryLocations = m_libraryLocations;
     m_path_mutex.unlock();
 
     // Refresh the name filters in case we loaded new SoundSource plugins.
@@ -130,11 +337,16 @@ void BrowseThread::populateModel() {
     // see signal/slot connection in BrowseTableModel
     emit(clearModel(thisModelObserver));
 
-    QList< QList<QStandardItem*> > rows;
-
-    int row = 0;
-    // Iterate over the files
+    // The rows of the model are read in the order of the directory
+    // listing, i.e. the first rows that are shown are read first
+    QList<QFileInfo> files;
     while (fileIt.hasNext()) {
+        fileIt.next();
+        files.append(fileIt.fileInfo());
+    }
+
+    QList< QList<QStandardItem*> > rows;
+    for (int first = 0; first < files.size(); first += kRowsPerBatch) {
         // If a user quickly jumps through the folders
         // the current task becomes "dirty"
         m_path_mutex.lock();
@@ -146,149 +358,54 @@ void BrowseThread::populateModel() {
             return populateModel();
         }
 
-        QList<QStandardItem*> row_data;
-
-        QStandardItem* item = new QStandardItem("0");
-        item->setData("0", Qt::UserRole);
-        row_data.insert(COLUMN_PREVIEW, item);
-
-        const QString filepath = fileIt.next();
-        {
-            TrackPointer pTrack =
-                TrackCache::instance().resolve(
-                        filepath, thisPath.token()).getTrack();
-            // The TrackCache is unlocked instantly even if a new track object
-            // has been created and inserted into the cache. Newly created track
-            // objects will only contain a reference of the corresponding file,
-            // but not any metadata, yet. This reduces lock contention on the
-            // global track cache.
-
-            // Update the track object by (re-)importing metadata from the file
-            SoundSourceProxy(pTrack).updateTrackFromSource();
-
-            item = new QStandardItem(pTrack->getFileName());
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_FILENAME, item);
-
-            item = new QStandardItem(pTrack->getArtist());
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_ARTIST, item);
-
-            item = new QStandardItem(pTrack->getTitle());
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_TITLE, item);
-
-            item = new QStandardItem(pTrack->getAlbum());
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_ALBUM, item);
-
-            item = new QStandardItem(pTrack->getAlbumArtist());
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_ALBUMARTIST, item);
-
-            item = new QStandardItem(pTrack->getTrackNumber());
-            item->setToolTip(item->text());
-            item->setData(item->text().toInt(), Qt::UserRole);
-            row_data.insert(COLUMN_TRACK_NUMBER, item);
-
-            const QString year(pTrack->getYear());
-            item = new YearItem(year);
-            item->setToolTip(year);
-            // The year column is sorted according to the numeric calendar year
-            item->setData(mixxx::TrackMetadata::parseCalendarYear(year), Qt::UserRole);
-            row_data.insert(COLUMN_YEAR, item);
-
-            item = new QStandardItem(pTrack->getGenre());
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_GENRE, item);
-
-            item = new QStandardItem(pTrack->getComposer());
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_COMPOSER, item);
-
-            item = new QStandardItem(pTrack->getGrouping());
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_GROUPING, item);
-
-            item = new QStandardItem(pTrack->getComment());
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_COMMENT, item);
-
-            QString duration = pTrack->getDurationText(mixxx::Duration::Precision::SECONDS);
-            item = new QStandardItem(duration);
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_DURATION, item);
-
-            item = new QStandardItem(pTrack->getBpmText());
-            item->setToolTip(item->text());
-            item->setData(pTrack->getBpm(), Qt::UserRole);
-            row_data.insert(COLUMN_BPM, item);
-
-            item = new QStandardItem(pTrack->getKeyText());
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_KEY, item);
-
-            item = new QStandardItem(pTrack->getType());
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_TYPE, item);
-
-            item = new QStandardItem(pTrack->getBitrateText());
-            item->setToolTip(item->text());
-            item->setData(pTrack->getBitrate(), Qt::UserRole);
-            row_data.insert(COLUMN_BITRATE, item);
-
-            QString location = pTrack->getLocation();
-            QString nativeLocation = QDir::toNativeSeparators(location);
-            item = new QStandardItem(nativeLocation);
-            item->setToolTip(nativeLocation);
-            item->setData(location, Qt::UserRole);
-            row_data.insert(COLUMN_NATIVELOCATION, item);
-
-            QDateTime modifiedTime = pTrack->getFileModifiedTime().toLocalTime();
-            item = new QStandardItem(modifiedTime.toString(Qt::DefaultLocaleShortDate));
-            item->setToolTip(item->text());
-            item->setData(modifiedTime, Qt::UserRole);
-            row_data.insert(COLUMN_FILE_MODIFIED_TIME, item);
-
-            QDateTime creationTime = pTrack->getFileCreationTime().toLocalTime();
-            item = new QStandardItem(creationTime.toString(Qt::DefaultLocaleShortDate));
-            item->setToolTip(item->text());
-            item->setData(creationTime, Qt::UserRole);
-            row_data.insert(COLUMN_FILE_CREATION_TIME, item);
-
-            const mixxx::ReplayGain replayGain(pTrack->getReplayGain());
-            item = new QStandardItem(
-                    mixxx::ReplayGain::ratioToString(replayGain.getRatio()));
-            item->setToolTip(item->text());
-            item->setData(item->text(), Qt::UserRole);
-            row_data.insert(COLUMN_REPLAYGAIN, item);
-        } // implicitly release track pointer and unlock cache
-
-        rows.append(row_data);
-        ++row;
-        // If 10 tracks have been analyzed, send it to GUI
-        // Will limit GUI freezing
-        if (row % 10 == 0) {
-            // this is a blocking operation
-            emit(rowsAppended(rows, thisModelObserver));
-            qDebug() << "Append " << rows.count() << " from " << filepath;
-            rows.clear();
+        // The tags of the files that have not been visited before or
+        // that have been modified since are read in parallel. The rows
+        // of the tracks in the library are never cached, since their
+        // metadata might have been edited without modifying the file.
+        const int last = math_min(first + kRowsPerBatch, files.size());
+        std::vector<std::unique_ptr<TagReader>> tagReaders;
+        for (int i = first; i < last; ++i) {
+            const QFileInfo& fileInfo = files.at(i);
+            const QString filepath = fileInfo.absoluteFilePath();
+            if (!libraryLocations.contains(filepath)) {
+                const CachedRow* pCachedRow = m_rowCache.object(filepath);
+                if (pCachedRow &&
+                        pCachedRow->fileModifiedTime == fileInfo.lastModified() &&
+                        pCachedRow->fileSize == fileInfo.size()) {
+                    rows.append(cloneRow(pCachedRow->items));
+                    continue;
+                }
+            }
+            tagReaders.push_back(std::make_unique<TagReader>(
+                    rows.size(), filepath, thisPath.token()));
+            m_tagReaderPool.start(tagReaders.back().get());
+            rows.append(QList<QStandardItem*>());
         }
-        // Sleep additionally for 10ms which prevents us from GUI freezes
+        m_tagReaderPool.waitForDone();
+
+        for (const auto& pTagReader: tagReaders) {
+            const TrackPointer& pTrack = pTagReader->getTrack();
+            rows[pTagReader->row()] = createRow(pTrack);
+            const QFileInfo& fileInfo = files.at(first + pTagReader->row());
+            if (!libraryLocations.contains(fileInfo.absoluteFilePath())) {
+                CachedRow* pCachedRow = new CachedRow;
+                pCachedRow->fileModifiedTime = fileInfo.lastModified();
+                pCachedRow->fileSize = fileInfo.size();
+                pCachedRow->items = cloneRow(rows.at(pTagReader->row()));
+                m_rowCache.insert(fileInfo.absoluteFilePath(), pCachedRow);
+            }
+        }
+        // implicitly release the track pointers
+
+        // this is a blocking operation
+        emit(rowsAppended(rows, thisModelObserver));
+        qDebug() << "Append " << rows.count() << " from "
+                 << files.at(last - 1).absoluteFilePath();
+        rows.clear();
+        // Sleep additionally which prevents us from GUI freezes
         msleep(20);
     }
-    emit(rowsAppended(rows, thisModelObserver));
-    qDebug() << "Append last " << rows.count();
+    if (files.isEmpty()) {
+        emit(rowsAppended(rows, thisModelObserver));
+    }
 }
@@ -6,7 +6,10 @@
 #define BROWSETHREAD_H
 
 #include <QThread>
+#include <QThreadPool>
 #include <QMutex>
+#include <QCache>
+#include <QSet>
 #include <QWaitCondition>
 #include <QStandardItem>
 #include <QList>
@@ -31,7 +34,10 @@ class BrowseThread : public QThread {
     Q_OBJECT
   public:
     virtual ~BrowseThread();
-    void executePopulation(const MDir& path, BrowseTableModel* client);
+    // The rows of the tracks at the library locations are populated from
+    // the cached track objects, which are kept alive by the client
+    void executePopulation(const MDir& path, BrowseTableModel* client,
+            const QSet<QString>& libraryLocations);
     void run();
     static BrowseThreadPointer getInstanceRef();
 
@@ -44,14 +50,23 @@ class BrowseThread : public QThread {
 
     void populateModel();
 
+    struct CachedRow;
+
     QMutex m_mutex;
     QWaitCondition m_locationUpdated;
     volatile bool m_bStopThread;
 
-    // You must hold m_path_mutex to touch m_path or m_model_observer
+    // You must hold m_path_mutex to touch m_path, m_model_observer or
+    // m_libraryLocations
     QMutex m_path_mutex;
     MDir m_path;
     BrowseTableModel* m_model_observer;
+    QSet<QString> m_libraryLocations;
+
+    // Only accessed by this thread
+    QThreadPool m_tagReaderPool;
+    // The rows of the files outside of the library by location
+    QCache<QString, CachedRow> m_rowCache;
 
     static QWeakPointer<BrowseThread> m_weakInstanceRef;
 };
@@ -0,0 +1,67 @@
+#include "library/cellpixmapcache.h"
+
+#include <QCache>
+#include <QPixmap>
+#include <QStringBuilder>
+
+namespace {
+
+// Enough for the visible cells of the delegate columns of a few tables on
+// a high-DPI display
+const int kCacheLimitBytes = 8 * 1024 * 1024;
+
+QCache<QString, QPixmap>& pixmaps() {
+    static QCache<QString, QPixmap> s_pixmaps(kCacheLimitBytes);
+    return s_pixmaps;
+}
+
+} // anonymous namespace
+
+// static
+QString CellPixmapCache::optionKey(const QStyleOptionViewItemV4& option,
+                                   const QStyle* pStyle) {
+    return QString::number(reinterpret_cast<quintptr>(pStyle), 16) % '|' %
+            QString::number(option.palette.cacheKey(), 16) % '|' %
+            option.font.key() % '|' %
+            QString::number(static_cast<int>(option.state), 16) % '|' %
+            QString::number(static_cast<int>(option.features), 16) % '|' %
+            QString::number(static_cast<int>(option.displayAlignment), 16) % '|' %
+            QString::number(static_cast<int>(option.checkState)) % '|' %
+            QString::number(static_cast<int>(option.backgroundBrush.style())) % '|' %
+            QString::number(option.backgroundBrush.color().rgba(), 16) % '|' %
+            option.text;
+}
+
+// static
+void CellPixmapCache::paint(QPainter* painter, const QRect& rect,
+                            const QString& key, const Render& render) {
+    if (rect.isEmpty()) {
+        return;
+    }
+    const int devicePixelRatio = painter->device()
+            ? painter->device()->devicePixelRatio() : 1;
+    const QString sizeKey = key % '|' %
+            QString::number(rect.width()) % 'x' %
+            QString::number(rect.height()) % '@' %
+            QString::number(devicePixelRatio);
+
+    const QPixmap* pCachedPixmap = pixmaps().object(sizeKey);
+    if (pCachedPixmap == nullptr) {
+        QPixmap* pPixmap = new QPixmap(rect.size() * devicePixelRatio);
+        pPixmap->setDevicePixelRatio(devicePixelRatio);
+        pPixmap->fill(Qt::transparent);
+        QPainter pixmapPainter(pPixmap);
+        render(&pixmapPainter, QRect(QPoint(0, 0), rect.size()));
+        pixmapPainter.end();
+        const int bytes = pPixmap->width() * pPixmap->height() *
+                pPixmap->depth() / 8;
+        pCachedPixmap = pPixmap;
+        // Takes the ownership, the pixmap is drawn before it can be evicted
+        if (!pixmaps().insert(sizeKey, pPixmap, bytes)) {
+            // Deleted by the cache because it exceeds the limit
+            render(painter, rect);
+            return;
+        }
+    }
+    painter->drawPixmap(rect.topLeft(), *pCachedPixmap);
+}
@@ -0,0 +1,37 @@
+#ifndef LIBRARY_CELLPIXMAPCACHE_H
+#define LIBRARY_CELLPIXMAPCACHE_H
+
+#include <QPainter>
+#include <QRect>
+#include <QString>
+#include <QStyle>
+#include <QStyleOptionViewItem>
+
+#include <functional>
+
+// A small cache of the rendered content of library table cells that is
+// shared by the delegates. Cells that look the same, e.g. the same rating
+// in rows that are not selected, are rendered once with the style and then
+// only drawn from the cache, which keeps scrolling large tables smooth.
+//
+// The pixmaps are kept apart from QPixmapCache so that they don't evict
+// the cover art of the table.
+class CellPixmapCache {
+  public:
+    // Paints the cell content into rect, which is at the origin when the
+    // content is rendered for the cache
+    typedef std::function<void(QPainter* painter, const QRect& rect)> Render;
+
+    // The part of a key that describes how an item view cell is styled
+    // and what it shows
+    static QString optionKey(const QStyleOptionViewItemV4& option,
+                             const QStyle* pStyle);
+
+    // Draws the cell content with the key into rect, after rendering it
+    // with render if it is not cached. The size of the cell and the device
+    // pixel ratio of the painter are added to the key.
+    static void paint(QPainter* painter, const QRect& rect,
+                      const QString& key, const Render& render);
+};
+
+#endif // LIBRARY_CELLPIXMAPCACHE_H
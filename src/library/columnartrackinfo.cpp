@@ -0,0 +1,431 @@
+#include "library/columnartrackinfo.h"
+
+#include <QDataStream>
+
+namespace {
+
+bool isIntegral(QVariant::Type type) {
+    switch (type) {
+    case QVariant::Bool:
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isFloatingPoint(QVariant::Type type) {
+    return type == QVariant::Double ||
+            type == static_cast<QVariant::Type>(QMetaType::Float);
+}
+
+QVariant integralVariant(qint64 value, QVariant::Type type) {
+    switch (type) {
+    case QVariant::Bool:
+        return QVariant(value != 0);
+    case QVariant::Int:
+        return QVariant(static_cast<int>(value));
+    case QVariant::UInt:
+        return QVariant(static_cast<uint>(value));
+    default:
+        return QVariant(static_cast<qlonglong>(value));
+    }
+}
+
+} // anonymous namespace
+
+ColumnarTrackInfo::Column::Column()
+        : m_storage(Storage::Empty),
+          m_type(QVariant::Invalid),
+          m_rowCount(0) {
+}
+
+void ColumnarTrackInfo::Column::resize(int rowCount) {
+    m_rowCount = rowCount;
+    switch (m_storage) {
+    case Storage::Empty:
+        break;
+    case Storage::Integer:
+        m_integers.resize(rowCount);
+        m_nulls.resize(rowCount);
+        break;
+    case Storage::Double:
+        m_doubles.resize(rowCount);
+        m_nulls.resize(rowCount);
+        break;
+    case Storage::String:
+        m_strings.resize(rowCount);
+        break;
+    case Storage::Variant:
+        m_variants.resize(rowCount);
+        break;
+    }
+}
+
+void ColumnarTrackInfo::Column::store(Storage storage, QVariant::Type type) {
+    // All rows are null so far
+    m_storage = storage;
+    m_type = type;
+    if (storage == Storage::Integer || storage == Storage::Double) {
+        m_nulls.fill(true, m_rowCount);
+    }
+    resize(m_rowCount);
+}
+
+void ColumnarTrackInfo::Column::convertToVariants() {
+    QVector<QVariant> variants(m_rowCount);
+    for (int row = 0; row < m_rowCount; ++row) {
+        variants[row] = value(row);
+    }
+    m_variants.swap(variants);
+    m_integers = QVector<qint64>();
+    m_doubles = QVector<double>();
+    m_strings = QVector<QString>();
+    m_nulls = QBitArray();
+    m_storage = Storage::Variant;
+}
+
+void ColumnarTrackInfo::Column::setValue(int row, const QVariant& value,
+        QSet<QString>* pStrings) {
+    const QVariant::Type type = value.type();
+    const bool isNull = value.isNull();
+    if (m_storage == Storage::Empty) {
+        if (isNull) {
+            if (type != QVariant::Invalid) {
+                m_type = type;
+            }
+            return;
+        }
+        if (isIntegral(type)) {
+            store(Storage::Integer, type);
+        } else if (isFloatingPoint(type)) {
+            store(Storage::Double, QVariant::Double);
+        } else if (type == QVariant::String) {
+            store(Storage::String, type);
+        } else {
+            store(Storage::Variant, type);
+        }
+    }
+
+    switch (m_storage) {
+    case Storage::Integer:
+        if (isNull) {
+            m_nulls.setBit(row, true);
+            return;
+        }
+        if (isIntegral(type)) {
+            if (type != m_type) {
+                // Mixed types, e.g. from the database and from a Track
+                m_type = QVariant::LongLong;
+            }
+            m_integers[row] = value.toLongLong();
+            m_nulls.setBit(row, false);
+            return;
+        }
+        if (isFloatingPoint(type)) {
+            // A column with integers and doubles, e.g. the duration
+            QVector<double> doubles(m_rowCount);
+            for (int i = 0; i < m_rowCount; ++i) {
+                doubles[i] = m_integers[i];
+            }
+            m_doubles.swap(doubles);
+            m_integers = QVector<qint64>();
+            m_storage = Storage::Double;
+            m_type = QVariant::Double;
+            m_doubles[row] = value.toDouble();
+            m_nulls.setBit(row, false);
+            return;
+        }
+        break;
+    case Storage::Double:
+        if (isNull) {
+            m_nulls.setBit(row, true);
+            return;
+        }
+        if (isFloatingPoint(type) || isIntegral(type)) {
+            m_doubles[row] = value.toDouble();
+            m_nulls.setBit(row, false);
+            return;
+        }
+        break;
+    case Storage::String:
+        if (isNull) {
+            m_strings[row] = QString();
+            return;
+        }
+        if (type == QVariant::String) {
+            // Shares the data with the equal strings of all columns
+            m_strings[row] = *pStrings->insert(value.toString());
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (m_storage != Storage::Variant) {
+        convertToVariants();
+    }
+    m_variants[row] = value;
+}
+
+QVariant ColumnarTrackInfo::Column::value(int row) const {
+    switch (m_storage) {
+    case Storage::Empty:
+        return QVariant(m_type);
+    case Storage::Integer:
+        if (m_nulls.testBit(row)) {
+            return QVariant(m_type);
+        }
+        return integralVariant(m_integers[row], m_type);
+    case Storage::Double:
+        if (m_nulls.testBit(row)) {
+            return QVariant(m_type);
+        }
+        return QVariant(m_doubles[row]);
+    case Storage::String:
+        return QVariant(m_strings[row]);
+    case Storage::Variant:
+        return m_variants[row];
+    }
+    return QVariant();
+}
+
+double ColumnarTrackInfo::Column::toDouble(int row) const {
+    switch (m_storage) {
+    case Storage::Integer:
+        return m_nulls.testBit(row) ? 0.0 : m_integers[row];
+    case Storage::Double:
+        return m_nulls.testBit(row) ? 0.0 : m_doubles[row];
+    default:
+        return value(row).toDouble();
+    }
+}
+
+QString ColumnarTrackInfo::Column::toString(int row) const {
+    switch (m_storage) {
+    case Storage::String:
+        return m_strings[row];
+    default:
+        return value(row).toString();
+    }
+}
+
+void ColumnarTrackInfo::Column::write(QDataStream* pStream) const {
+    *pStream << static_cast<qint32>(m_storage) << static_cast<qint32>(m_type);
+    switch (m_storage) {
+    case Storage::Empty:
+        break;
+    case Storage::Integer:
+        *pStream << m_integers << m_nulls;
+        break;
+    case Storage::Double:
+        *pStream << m_doubles << m_nulls;
+        break;
+    case Storage::String:
+        *pStream << m_strings;
+        break;
+    case Storage::Variant:
+        *pStream << m_variants;
+        break;
+    }
+}
+
+bool ColumnarTrackInfo::Column::read(QDataStream* pStream, int rowCount,
+        QSet<QString>* pStrings) {
+    qint32 storage = 0;
+    qint32 type = 0;
+    *pStream >> storage >> type;
+    m_storage = static_cast<Storage>(storage);
+    m_type = static_cast<QVariant::Type>(type);
+    m_rowCount = rowCount;
+    int size = 0;
+    switch (m_storage) {
+    case Storage::Empty:
+        size = rowCount;
+        break;
+    case Storage::Integer:
+        *pStream >> m_integers >> m_nulls;
+        size = m_integers.size();
+        if (m_nulls.size() != size) {
+            return false;
+        }
+        break;
+    case Storage::Double:
+        *pStream >> m_doubles >> m_nulls;
+        size = m_doubles.size();
+        if (m_nulls.size() != size) {
+            return false;
+        }
+        break;
+    case Storage::String:
+        *pStream >> m_strings;
+        size = m_strings.size();
+        // Shares the data with the equal strings of all columns again
+        for (auto& string : m_strings) {
+            if (!string.isNull()) {
+                string = *pStrings->insert(string);
+            }
+        }
+        break;
+    case Storage::Variant:
+        *pStream >> m_variants;
+        size = m_variants.size();
+        break;
+    default:
+        return false;
+    }
+    return pStream->status() == QDataStream::Ok && size == rowCount;
+}
+
+ColumnarTrackInfo::ColumnarTrackInfo(int columnCount)
+        : m_columnCount(columnCount),
+          m_columns(columnCount),
+          m_rowCount(0),
+          m_stringsCountedCount(0),
+          m_stringsBytes(0) {
+}
+
+void ColumnarTrackInfo::clear() {
+    m_columns.clear();
+    m_columns.resize(m_columnCount);
+    m_rows.clear();
+    m_freeRows.clear();
+    m_rowCount = 0;
+    m_strings.clear();
+    m_stringsCountedCount = 0;
+    m_stringsBytes = 0;
+}
+
+int ColumnarTrackInfo::insert(TrackId trackId) {
+    auto it = m_rows.find(trackId);
+    if (it != m_rows.end()) {
+        return it.value();
+    }
+    int row;
+    if (!m_freeRows.isEmpty()) {
+        row = m_freeRows.takeLast();
+    } else {
+        row = m_rowCount++;
+        // Grows the arrays geometrically like QVector::append()
+        for (auto& column : m_columns) {
+            column.resize(m_rowCount);
+        }
+    }
+    m_rows.insert(trackId, row);
+    return row;
+}
+
+void ColumnarTrackInfo::remove(TrackId trackId) {
+    auto it = m_rows.find(trackId);
+    if (it == m_rows.end()) {
+        return;
+    }
+    const int row = it.value();
+    m_rows.erase(it);
+    // Clears the row for the next track
+    for (auto& column : m_columns) {
+        column.setValue(row, QVariant(), &m_strings);
+    }
+    m_freeRows.append(row);
+}
+
+void ColumnarTrackInfo::setValue(int row, int column, const QVariant& value) {
+    m_columns[column].setValue(row, value, &m_strings);
+}
+
+QVariant ColumnarTrackInfo::value(int row, int column) const {
+    if (row < 0 || column < 0 || column >= m_columnCount) {
+        return QVariant();
+    }
+    return m_columns[column].value(row);
+}
+
+double ColumnarTrackInfo::toDouble(int row, int column) const {
+    if (row < 0 || column < 0 || column >= m_columnCount) {
+        return 0.0;
+    }
+    return m_columns[column].toDouble(row);
+}
+
+QString ColumnarTrackInfo::toString(int row, int column) const {
+    if (row < 0 || column < 0 || column >= m_columnCount) {
+        return QString();
+    }
+    return m_columns[column].toString(row);
+}
+
+void ColumnarTrackInfo::write(QDataStream* pStream) const {
+    *pStream << static_cast<qint32>(m_columnCount)
+             << static_cast<qint32>(m_rowCount)
+             << static_cast<qint32>(m_rows.size());
+    for (auto it = m_rows.constBegin(); it != m_rows.constEnd(); ++it) {
+        *pStream << static_cast<qint32>(it.key().toInt())
+                 << static_cast<qint32>(it.value());
+    }
+    *pStream << m_freeRows;
+    for (const auto& column : m_columns) {
+        column.write(pStream);
+    }
+}
+
+bool ColumnarTrackInfo::read(QDataStream* pStream) {
+    clear();
+    qint32 columnCount = 0;
+    qint32 rowCount = 0;
+    qint32 trackCount = 0;
+    *pStream >> columnCount >> rowCount >> trackCount;
+    bool valid = pStream->status() == QDataStream::Ok &&
+            columnCount == m_columnCount &&
+            rowCount >= 0 && trackCount >= 0 && trackCount <= rowCount;
+    for (qint32 i = 0; valid && i < trackCount; ++i) {
+        qint32 trackId = 0;
+        qint32 row = 0;
+        *pStream >> trackId >> row;
+        valid = pStream->status() == QDataStream::Ok &&
+                row >= 0 && row < rowCount;
+        m_rows.insert(TrackId(trackId), row);
+    }
+    if (valid) {
+        *pStream >> m_freeRows;
+        valid = m_rows.size() + m_freeRows.size() == rowCount;
+    }
+    m_rowCount = rowCount;
+    for (auto& column : m_columns) {
+        if (!valid) {
+            break;
+        }
+        valid = column.read(pStream, rowCount, &m_strings);
+    }
+    if (!valid) {
+        clear();
+    }
+    return valid;
+}
+
+qint64 ColumnarTrackInfo::Column::estimatedBytes() const {
+    return sizeof(qint64) * static_cast<qint64>(m_integers.capacity()) +
+            sizeof(double) * static_cast<qint64>(m_doubles.capacity()) +
+            sizeof(QString) * static_cast<qint64>(m_strings.capacity()) +
+            sizeof(QVariant) * static_cast<qint64>(m_variants.capacity()) +
+            m_nulls.size() / 8;
+}
+
+qint64 ColumnarTrackInfo::estimatedBytes() const {
+    if (m_stringsCountedCount != m_strings.size()) {
+        m_stringsBytes = 0;
+        for (const auto& string : m_strings) {
+            m_stringsBytes += sizeof(QChar) * static_cast<qint64>(string.size());
+        }
+        m_stringsCountedCount = m_strings.size();
+    }
+    qint64 bytes = m_stringsBytes +
+            (sizeof(TrackId) + sizeof(int)) * static_cast<qint64>(m_rows.size()) +
+            sizeof(int) * static_cast<qint64>(m_freeRows.capacity());
+    for (const auto& column : m_columns) {
+        bytes += column.estimatedBytes();
+    }
+    return bytes;
+}
@@ -0,0 +1,128 @@
+#ifndef LIBRARY_COLUMNARTRACKINFO_H
+#define LIBRARY_COLUMNARTRACKINFO_H
+
+#include <QBitArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+#include <vector>
+
+#include "track/trackid.h"
+
+class QDataStream;
+
+// The values of the cached columns of all tracks in BaseTrackCache, stored
+// column by column. Each column keeps its values in a contiguous array of
+// the type that the first value of the column has, i.e. integers, doubles
+// or strings. Only the columns that receive values of different types fall
+// back to QVariants. Equal strings of all columns share their data.
+//
+// The rows of removed tracks are reused by the tracks that are inserted
+// later.
+//
+// The values can be written to a stream and read back with their storage,
+// which restores them without converting each value again.
+class ColumnarTrackInfo {
+  public:
+    explicit ColumnarTrackInfo(int columnCount);
+
+    void clear();
+
+    int size() const {
+        return m_rows.size();
+    }
+    bool contains(TrackId trackId) const {
+        return m_rows.contains(trackId);
+    }
+    QList<TrackId> trackIds() const {
+        return m_rows.keys();
+    }
+    // The row of each stored track
+    const QHash<TrackId, int>& rows() const {
+        return m_rows;
+    }
+    // Returns -1 if the track is not stored
+    int row(TrackId trackId) const {
+        return m_rows.value(trackId, -1);
+    }
+
+    // Returns the row of the track, which is added with null values if it
+    // was not stored yet
+    int insert(TrackId trackId);
+    void remove(TrackId trackId);
+
+    void setValue(int row, int column, const QVariant& value);
+    QVariant value(int row, int column) const;
+
+    // Typed access without a QVariant, for the stored types that convert
+    // without loss. Null values are returned as 0 or an empty string.
+    double toDouble(int row, int column) const;
+    QString toString(int row, int column) const;
+
+    void write(QDataStream* pStream) const;
+    // Returns false and leaves the values cleared if the stream is invalid
+    // or has been written with another number of columns
+    bool read(QDataStream* pStream);
+
+    // The memory of the arrays and of the string data without the overhead
+    // of the containers, for the memory accounting
+    qint64 estimatedBytes() const;
+
+  private:
+    class Column {
+      public:
+        Column();
+
+        void resize(int rowCount);
+        void setValue(int row, const QVariant& value, QSet<QString>* pStrings);
+        QVariant value(int row) const;
+        double toDouble(int row) const;
+        QString toString(int row) const;
+
+        void write(QDataStream* pStream) const;
+        bool read(QDataStream* pStream, int rowCount, QSet<QString>* pStrings);
+
+        qint64 estimatedBytes() const;
+
+      private:
+        enum class Storage {
+            // Only null values so far
+            Empty,
+            Integer,
+            Double,
+            String,
+            Variant,
+        };
+
+        void store(Storage storage, QVariant::Type type);
+        void convertToVariants();
+
+        Storage m_storage;
+        // The type of the values that are returned from the typed storage
+        QVariant::Type m_type;
+        int m_rowCount;
+        QVector<qint64> m_integers;
+        QVector<double> m_doubles;
+        QVector<QString> m_strings;
+        QVector<QVariant> m_variants;
+        // Integer and Double only
+        QBitArray m_nulls;
+    };
+
+    const int m_columnCount;
+    std::vector<Column> m_columns;
+    QHash<TrackId, int> m_rows;
+    QVector<int> m_freeRows;
+    int m_rowCount;
+    // All strings that are stored in a column
+    QSet<QString> m_strings;
+    // The strings are only added until the values are cleared, so their
+    // size is only summed again when their number has changed
+    mutable int m_stringsCountedCount;
+    mutable qint64 m_stringsBytes;
+};
+
+#endif // LIBRARY_COLUMNARTRACKINFO_H
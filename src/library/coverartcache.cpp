@@ -1,5 +1,6 @@
 #include <QFutureWatcher>
 #include <QPixmapCache>
+#include <QThread>
 #include <QStringBuilder>
 #include <QtConcurrentRun>
 #include <QtDebug>
@@ -7,6 +8,9 @@
 #include "library/coverartcache.h"
 #include "library/coverartutils.h"
 #include "util/logger.h"
+#include "util/math.h"
+#include "util/memory.h"
+#include "util/threadroles.h"
 
 
 namespace {
@@ -26,11 +30,22 @@ inline QImage resizeImageWidth(const QImage& image, int width) {
     return image.scaledToWidth(width, kTransformationMode);
 }
 
+// The widths of the thumbnails for the covers of the decks, in ascending
+// order. Larger widgets use the full-size cover.
+const int kThumbnailWidths[] = { 64, 128, 256, 512 };
+
 } // anonymous namespace
 
 const bool sDebug = false;
 
-CoverArtCache::CoverArtCache() {
+CoverArtCache::CoverArtCache()
+        : m_nextSequenceNumber(0),
+          m_runningLoadCount(0),
+          m_memoryAccount(MemoryAccounting::Category::CoverArt) {
+    // A few threads of their own, so that the loads neither wait for nor
+    // delay the tasks of the global pool
+    m_loadThreadPool.setMaxThreadCount(
+            math_clamp(QThread::idealThreadCount() / 2, 1, 4));
     // The initial QPixmapCache limit is 10MB.
     // But it is not used just by the coverArt stuff,
     // it is also used by Qt to handle other things behind the scenes.
@@ -49,7 +64,8 @@ QPixmap CoverArtCache::requestCover(const CoverInfo& requestInfo,
                                     const QObject* pRequestor,
                                     const int desiredWidth,
                                     const bool onlyCached,
-                                    const bool signalWhenDone) {
+                                    const bool signalWhenDone,
+                                    Priority priority) {
     if (sDebug) {
         kLogger.debug() << "requestCover"
                  << requestInfo << pRequestor <<
@@ -64,13 +80,6 @@ QPixmap CoverArtCache::requestCover(const CoverInfo& requestInfo,
         return QPixmap();
     }
 
-    // keep a list of trackIds for which a future is currently running
-    // to avoid loading the same picture again while we are loading it
-    QPair<const QObject*, quint16> requestId = qMakePair(pRequestor, requestInfo.hash);
-    if (m_runningRequests.contains(requestId)) {
-        return QPixmap();
-    }
-
     // If this request comes from CoverDelegate (table view), it'll want to get
     // a cropped cover which is ready to be drawn in the table view (cover art
     // column). It's very important to keep the cropped covers in cache because
@@ -93,24 +102,111 @@ QPixmap CoverArtCache::requestCover(const CoverInfo& requestInfo,
         return QPixmap();
     }
 
-    m_runningRequests.insert(requestId);
-    QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
-    QFuture<FutureResult> future = QtConcurrent::run(
-            this, &CoverArtCache::loadCover, requestInfo, pRequestor,
-            desiredWidth, signalWhenDone);
-    connect(watcher, SIGNAL(finished()), this, SLOT(coverLoaded()));
-    watcher->setFuture(future);
+    // Merge the request with a pending or running load of the same cover
+    // to avoid loading the same picture again while we are loading it
+    auto it = m_loads.find(cacheKey);
+    if (it == m_loads.end()) {
+        Load load;
+        load.info = requestInfo;
+        load.desiredWidth = desiredWidth;
+        load.priority = priority;
+        load.sequenceNumber = m_nextSequenceNumber++;
+        load.running = false;
+        it = m_loads.insert(cacheKey, load);
+    } else if (priority < it->priority) {
+        it->priority = priority;
+    }
+    bool merged = false;
+    for (auto& requestor : it->requestors) {
+        if (requestor.pRequestor == pRequestor) {
+            requestor.signalWhenDone |= signalWhenDone;
+            merged = true;
+        }
+    }
+    if (!merged) {
+        it->requestors.append(Requestor{pRequestor, signalWhenDone});
+    }
+    startLoads();
     return QPixmap();
 }
 
+void CoverArtCache::startLoads() {
+    while (m_runningLoadCount < m_loadThreadPool.maxThreadCount()) {
+        auto next = m_loads.end();
+        for (auto it = m_loads.begin(); it != m_loads.end(); ++it) {
+            if (it->running) {
+                continue;
+            }
+            if (next == m_loads.end() || it->priority < next->priority ||
+                    (it->priority == next->priority &&
+                            it->sequenceNumber < next->sequenceNumber)) {
+                next = it;
+            }
+        }
+        if (next == m_loads.end()) {
+            return;
+        }
+        next->running = true;
+        ++m_runningLoadCount;
+        QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
+        QFuture<FutureResult> future = QtConcurrent::run(&m_loadThreadPool,
+                this, &CoverArtCache::loadCover, next->info,
+                static_cast<const QObject*>(nullptr),
+                next->desiredWidth, true);
+        connect(watcher, SIGNAL(finished()), this, SLOT(coverLoaded()));
+        watcher->setFuture(future);
+    }
+}
+
+void CoverArtCache::cancelRequests(const QObject* pRequestor) {
+    auto it = m_loads.begin();
+    while (it != m_loads.end()) {
+        QList<Requestor>& requestors = it->requestors;
+        for (int i = requestors.size() - 1; i >= 0; --i) {
+            if (requestors[i].pRequestor == pRequestor) {
+                requestors.removeAt(i);
+            }
+        }
+        // A running load still fills the cache
+        if (requestors.isEmpty() && !it->running) {
+            it = m_loads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 //static
 void CoverArtCache::requestCover(const Track& track,
-                         const QObject* pRequestor) {
+                         const QObject* pRequestor,
+                         int desiredWidth,
+                         Priority priority) {
     CoverArtCache* pCache = CoverArtCache::instance();
     if (pCache == nullptr) return;
 
     CoverInfo info = track.getCoverInfo();
-    pCache->requestCover(info, pRequestor, 0, false, true);
+    pCache->requestCover(info, pRequestor, desiredWidth, false, true,
+            priority);
+}
+
+//static
+int CoverArtCache::thumbnailWidth(const QSize& size) {
+    // The covers are scaled into the widget preserving their aspect ratio
+    const int width = math_max(size.width(), size.height());
+    for (int thumbnailWidth : kThumbnailWidths) {
+        if (width <= thumbnailWidth) {
+            return thumbnailWidth;
+        }
+    }
+    return 0;
+}
+
+void CoverArtCache::setThumbnailCache(const QString& directory, int maxMiBs) {
+    m_pThumbnailCache = std::make_unique<CoverThumbnailCache>(
+            directory, maxMiBs);
+    // The limit may have been lowered
+    QtConcurrent::run(m_pThumbnailCache.get(),
+            &CoverThumbnailCache::evictLeastRecentlyUsed);
 }
 
 CoverArtCache::FutureResult CoverArtCache::loadCover(
@@ -122,6 +218,19 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
         kLogger.debug() << "loadCover"
                  << info << desiredWidth << signalWhenDone;
     }
+    mixxx::ThreadRoles::applyToCurrentThread(mixxx::ThreadRole::CoverLoader);
+
+    // Thumbnails are loaded without decoding the full-size cover
+    if (desiredWidth > 0 && m_pThumbnailCache) {
+        const QImage image = m_pThumbnailCache->load(info, desiredWidth);
+        if (!image.isNull()) {
+            FutureResult res;
+            res.pRequestor = pRequestor;
+            res.cover = CoverArt(info, image, desiredWidth);
+            res.signalWhenDone = signalWhenDone;
+            return res;
+        }
+    }
 
     QImage image = CoverArtUtils::loadCover(info);
 
@@ -134,6 +243,9 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
     // efficiency.
     if (!image.isNull() && desiredWidth > 0) {
         image = resizeImageWidth(image, desiredWidth);
+        if (m_pThumbnailCache) {
+            m_pThumbnailCache->save(info, desiredWidth, image);
+        }
     }
 
     FutureResult res;
@@ -169,14 +281,52 @@ void CoverArtCache::coverLoaded() {
         // because insert replaces the images with the same key
         QString cacheKey = pixmapCacheKey(
                 res.cover.hash, res.cover.resizedToWidth);
-        QPixmapCache::insert(cacheKey, pixmap);
+        if (QPixmapCache::insert(cacheKey, pixmap)) {
+            accountCachedPixmap(cacheKey, pixmap);
+        }
+    }
+
+    const Load load = m_loads.take(pixmapCacheKey(
+            res.cover.hash, res.cover.resizedToWidth));
+    --m_runningLoadCount;
+    watcher->deleteLater();
+
+    for (const auto& requestor : load.requestors) {
+        if (requestor.signalWhenDone) {
+            emit(coverFound(requestor.pRequestor, res.cover, pixmap, false));
+        }
     }
+    startLoads();
+}
 
-    m_runningRequests.remove(qMakePair(res.pRequestor, res.cover.hash));
+void CoverArtCache::accountCachedPixmap(
+        const QString& cacheKey, const QPixmap& pixmap) {
+    const qint64 bytes = static_cast<qint64>(pixmap.width()) *
+            pixmap.height() * pixmap.depth() / 8;
+    qint64 totalBytes = m_memoryAccount.bytes() + bytes -
+            m_cachedPixmapBytes.value(cacheKey);
+    m_cachedPixmapBytes.insert(cacheKey, bytes);
+    m_memoryAccount.setBytes(totalBytes);
+    // QPixmapCache::cacheLimit() is in KiB. Checking the keys only when
+    // the limit is exceeded keeps the lookups from reordering the cache.
+    if (totalBytes > static_cast<qint64>(QPixmapCache::cacheLimit()) * 1024) {
+        pruneCachedPixmaps();
+    }
+}
 
-    if (res.signalWhenDone) {
-        emit(coverFound(res.pRequestor, res.cover, pixmap, false));
+void CoverArtCache::pruneCachedPixmaps() {
+    qint64 totalBytes = 0;
+    QPixmap pixmap;
+    auto it = m_cachedPixmapBytes.begin();
+    while (it != m_cachedPixmapBytes.end()) {
+        if (QPixmapCache::find(it.key(), &pixmap)) {
+            totalBytes += it.value();
+            ++it;
+        } else {
+            it = m_cachedPixmapBytes.erase(it);
+        }
     }
+    m_memoryAccount.setBytes(totalBytes);
 }
 
 void CoverArtCache::requestGuessCovers(QList<TrackPointer> tracks) {
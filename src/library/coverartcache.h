@@ -1,16 +1,34 @@
 #ifndef COVERARTCACHE_H
 #define COVERARTCACHE_H
 
+#include <QHash>
+#include <QList>
 #include <QObject>
 #include <QPixmap>
+#include <QSize>
+#include <QThreadPool>
+
+#include <memory>
 
 #include "library/coverart.h"
+#include "library/coverthumbnailcache.h"
+#include "util/memoryaccounting.h"
 #include "util/singleton.h"
 #include "track/track.h"
 
 class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
     Q_OBJECT
   public:
+    // The order in which the requested covers are loaded
+    enum class Priority {
+        // Covers that are shown right now, e.g. in the rows of the library
+        // table and in dialogs
+        Visible = 0,
+        Deck,
+        // Covers that might be shown soon
+        Prefetch,
+    };
+
     /* This method is used to request a cover art pixmap.
      *
      * @param pRequestor : an arbitrary pointer (can be any number you'd like,
@@ -22,15 +40,35 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
      *      search algorithm.
      *      In this way, the method will just look into CoverCache and return
      *      a Pixmap if it is already loaded in the QPixmapCache.
+     *
+     * Requests for the same cover and width are merged and loaded once.
      */
     QPixmap requestCover(const CoverInfo& info,
                          const QObject* pRequestor,
                          const int desiredWidth,
                          const bool onlyCached,
-                         const bool signalWhenDone);
+                         const bool signalWhenDone,
+                         Priority priority = Priority::Visible);
 
+    // Drops the requests of the requestor that are not being loaded yet,
+    // e.g. for the rows that have been scrolled out of view. Must also be
+    // called before the requestor is deleted.
+    void cancelRequests(const QObject* pRequestor);
+
+    // A desiredWidth of 0 requests the full-size cover
     static void requestCover(const Track& track,
-                             const QObject* pRequestor);
+                             const QObject* pRequestor,
+                             int desiredWidth = 0,
+                             Priority priority = Priority::Deck);
+
+    // Returns the width of the thumbnail for a widget of the given size,
+    // so that widgets of similar sizes share the entries of the caches,
+    // or 0 for the full-size cover.
+    static int thumbnailWidth(const QSize& size);
+
+    // Keeps the covers that are requested with a width on disk. Must be
+    // called before the first request.
+    void setThumbnailCache(const QString& directory, int maxMiBs);
 
     // Guesses the cover art for the provided tracks by searching the tracks'
     // metadata and folders for image files. All I/O is done in a separate
@@ -74,7 +112,43 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
     void guessCover(TrackPointer pTrack);
 
   private:
-    QSet<QPair<const QObject*, quint16> > m_runningRequests;
+    struct Requestor {
+        const QObject* pRequestor;
+        bool signalWhenDone;
+    };
+
+    // The requests for a cover at one width
+    struct Load {
+        CoverInfo info;
+        int desiredWidth;
+        Priority priority;
+        // Loads of the same priority are started in the order of their
+        // first request
+        quint64 sequenceNumber;
+        QList<Requestor> requestors;
+        bool running;
+    };
+
+    // Starts the pending loads with the highest priority while the pool
+    // has idle threads
+    void startLoads();
+
+    // Accounts a pixmap that has been inserted into QPixmapCache
+    void accountCachedPixmap(const QString& cacheKey, const QPixmap& pixmap);
+    // Forgets the pixmaps that QPixmapCache has evicted meanwhile
+    void pruneCachedPixmaps();
+
+    // By the key of QPixmapCache, only accessed from the main thread
+    QHash<QString, Load> m_loads;
+    quint64 m_nextSequenceNumber;
+    int m_runningLoadCount;
+    std::unique_ptr<CoverThumbnailCache> m_pThumbnailCache;
+    // The sizes of the pixmaps that may still be in QPixmapCache, which
+    // evicts them silently
+    QHash<QString, qint64> m_cachedPixmapBytes;
+    MemoryAccount m_memoryAccount;
+    // Destroyed first, waits for the running loads
+    QThreadPool m_loadThreadPool;
 };
 
 #endif // COVERARTCACHE_H
@@ -14,7 +14,8 @@ CoverArtDelegate::CoverArtDelegate(QObject *parent)
           m_iCoverLocationColumn(-1),
           m_iCoverHashColumn(-1),
           m_iTrackLocationColumn(-1),
-          m_iIdColumn(-1) {
+          m_iIdColumn(-1),
+          m_pTableView(qobject_cast<QTableView*>(parent)) {
     // This assumes that the parent is wtracktableview
     connect(parent, SIGNAL(onlyCachedCoverArt(bool)),
             this, SLOT(slotOnlyCachedCoverArt(bool)));
@@ -28,10 +29,8 @@ CoverArtDelegate::CoverArtDelegate(QObject *parent)
     }
 
     TrackModel* pTrackModel = NULL;
-    QTableView* pTableView = NULL;
-    if (QTableView *tableView = qobject_cast<QTableView*>(parent)) {
-        pTableView = tableView;
-        pTrackModel = dynamic_cast<TrackModel*>(pTableView->model());
+    if (m_pTableView) {
+        pTrackModel = dynamic_cast<TrackModel*>(m_pTableView->model());
     }
 
     if (pTrackModel) {
@@ -53,21 +52,83 @@ CoverArtDelegate::CoverArtDelegate(QObject *parent)
 }
 
 CoverArtDelegate::~CoverArtDelegate() {
+    CoverArtCache* pCache = CoverArtCache::instance();
+    if (pCache) {
+        pCache->cancelRequests(this);
+    }
 }
 
 void CoverArtDelegate::slotOnlyCachedCoverArt(bool b) {
     m_bOnlyCachedCover = b;
 
+    if (m_bOnlyCachedCover) {
+        // The rows that are waiting for their covers may be scrolled out of
+        // view. Those that are still visible request them again when the
+        // user has stopped.
+        CoverArtCache* pCache = CoverArtCache::instance();
+        if (pCache) {
+            pCache->cancelRequests(this);
+        }
+        for (const auto& rows : m_hashToRow) {
+            foreach (int row, rows) {
+                m_cacheMissRows.append(row);
+            }
+        }
+        m_hashToRow.clear();
+        return;
+    }
+
     // If we can request non-cache covers now, request updates for all rows that
     // were cache misses since the last time.
-    if (!m_bOnlyCachedCover) {
-        foreach (int row, m_cacheMissRows) {
-            emit(coverReadyForCell(row, m_iCoverColumn));
+    foreach (int row, m_cacheMissRows) {
+        emit(coverReadyForCell(row, m_iCoverColumn));
+    }
+    m_cacheMissRows.clear();
+
+    prefetchNextPage();
+}
+
+void CoverArtDelegate::prefetchNextPage() {
+    CoverArtCache* pCache = CoverArtCache::instance();
+    if (pCache == NULL || m_pTableView == NULL || m_pTableView->model() == NULL ||
+            m_iCoverColumn == -1 || m_pTableView->isColumnHidden(m_iCoverColumn)) {
+        return;
+    }
+    const QAbstractItemModel* pModel = m_pTableView->model();
+    const int firstVisibleRow = m_pTableView->rowAt(0);
+    const int lastVisibleRow = m_pTableView->rowAt(
+            m_pTableView->viewport()->height() - 1);
+    if (firstVisibleRow < 0 || lastVisibleRow < 0) {
+        // The visible rows end above the bottom of the view
+        return;
+    }
+    const int width = m_pTableView->columnWidth(m_iCoverColumn);
+    const int pageRows = lastVisibleRow - firstVisibleRow + 1;
+    const int lastRow = math_min(lastVisibleRow + pageRows,
+            pModel->rowCount() - 1);
+    // Only fills the cache for painting the rows later
+    for (int row = lastVisibleRow + 1; row <= lastRow; ++row) {
+        const CoverInfo info = coverInfoForIndex(
+                pModel->index(row, m_iCoverColumn));
+        if (info.type == CoverInfo::METADATA || info.type == CoverInfo::FILE) {
+            pCache->requestCover(info, this, width, false, false,
+                    CoverArtCache::Priority::Prefetch);
         }
-        m_cacheMissRows.clear();
     }
 }
 
+CoverInfo CoverArtDelegate::coverInfoForIndex(const QModelIndex& index) const {
+    CoverInfo info;
+    info.type = static_cast<CoverInfo::Type>(
+        index.sibling(index.row(), m_iCoverTypeColumn).data().toInt());
+    info.source = static_cast<CoverInfo::Source>(
+        index.sibling(index.row(), m_iCoverSourceColumn).data().toInt());
+    info.coverLocation = index.sibling(index.row(), m_iCoverLocationColumn).data().toString();
+    info.hash = index.sibling(index.row(), m_iCoverHashColumn).data().toUInt();
+    info.trackLocation = index.sibling(index.row(), m_iTrackLocationColumn).data().toString();
+    return info;
+}
+
 void CoverArtDelegate::slotCoverFound(const QObject* pRequestor,
                                       const CoverInfo& info,
                                       QPixmap pixmap, bool fromCache) {
@@ -95,21 +156,13 @@ void CoverArtDelegate::paint(QPainter *painter,
         return;
     }
 
-    CoverInfo info;
-    info.type = static_cast<CoverInfo::Type>(
-        index.sibling(index.row(), m_iCoverTypeColumn).data().toInt());
+    const CoverInfo info = coverInfoForIndex(index);
 
     // We don't support types other than METADATA or FILE currently.
     if (info.type != CoverInfo::METADATA && info.type != CoverInfo::FILE) {
         return;
     }
 
-    info.source = static_cast<CoverInfo::Source>(
-        index.sibling(index.row(), m_iCoverSourceColumn).data().toInt());
-    info.coverLocation = index.sibling(index.row(), m_iCoverLocationColumn).data().toString();
-    info.hash = index.sibling(index.row(), m_iCoverHashColumn).data().toUInt();
-    info.trackLocation = index.sibling(index.row(), m_iTrackLocationColumn).data().toString();
-
     // We listen for updates via slotCoverFound above and signal to
     // BaseSqlTableModel when a row's cover is ready.
     QPixmap pixmap = pCache->requestCover(info, this, option.rect.width(),
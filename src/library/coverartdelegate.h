@@ -7,8 +7,11 @@
 #include <QHash>
 #include <QLinkedList>
 
+#include "library/coverart.h"
 #include "library/trackmodel.h"
 
+class QTableView;
+
 class CoverArtDelegate : public QStyledItemDelegate {
     Q_OBJECT
   public:
@@ -40,6 +43,12 @@ class CoverArtDelegate : public QStyledItemDelegate {
                         QPixmap pixmap, bool fromCache);
 
   private:
+    // Requests the covers of the rows below the visible ones with a low
+    // priority, anticipating the user scrolling down
+    void prefetchNextPage();
+
+    CoverInfo coverInfoForIndex(const QModelIndex& index) const;
+
     bool m_bOnlyCachedCover;
     int m_iCoverColumn;
     int m_iCoverSourceColumn;
@@ -48,6 +57,7 @@ class CoverArtDelegate : public QStyledItemDelegate {
     int m_iCoverHashColumn;
     int m_iTrackLocationColumn;
     int m_iIdColumn;
+    QTableView* m_pTableView;
 
     // We need to record rows in paint() (which is const) so these are marked
     // mutable.
@@ -0,0 +1,118 @@
+#include "library/coverthumbnailcache.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace {
+
+const mixxx::Logger kLogger("CoverThumbnailCache");
+
+// The format is detected from the contents when an entry is loaded
+const QString kFileSuffix = QStringLiteral(".thumb");
+
+const int kJpegQuality = 90;
+
+// The least recently used entries are deleted after this many bytes
+// have been written
+const qint64 kMaxSavedBytesBeforeEviction = 16 * 1024 * 1024;
+
+} // anonymous namespace
+
+CoverThumbnailCache::CoverThumbnailCache(const QString& directory, int maxMiBs)
+        : m_directory(directory),
+          m_maxBytes(qint64(maxMiBs) * 1024 * 1024),
+          m_savedBytes(0) {
+    if (!m_directory.exists() && !QDir().mkpath(directory)) {
+        kLogger.warning() << "Failed to create" << directory;
+    }
+}
+
+QString CoverThumbnailCache::filePathForCover(
+        const CoverInfo& info, int width) const {
+    // The covers in files are shared by the tracks of a folder
+    QString location;
+    if (info.type == CoverInfo::FILE) {
+        location = info.trackLocation.isEmpty() ? info.coverLocation :
+                QFileInfo(QFileInfo(info.trackLocation).dir(),
+                        info.coverLocation).absoluteFilePath();
+    } else {
+        location = info.trackLocation;
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(static_cast<int>(info.type)));
+    hash.addData(QByteArray::number(info.hash));
+    hash.addData(location.toUtf8());
+    return m_directory.filePath(QString("%1_%2%3").arg(
+            QString::fromLatin1(hash.result().toHex()),
+            QString::number(width), kFileSuffix));
+}
+
+QImage CoverThumbnailCache::load(const CoverInfo& info, int width) const {
+    const QString filePath = filePathForCover(info, width);
+    QImage image(filePath);
+    if (image.isNull()) {
+        return image;
+    }
+    // The modification time of the entries keeps track of their last use
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(),
+                QFileDevice::FileModificationTime);
+    }
+#endif
+    return image;
+}
+
+void CoverThumbnailCache::save(const CoverInfo& info, int width,
+        const QImage& image) {
+    if (image.isNull()) {
+        return;
+    }
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    // JPEG does not keep the transparency
+    const char* format = image.hasAlphaChannel() ? "PNG" : "JPG";
+    if (!image.save(&buffer, format, kJpegQuality)) {
+        return;
+    }
+    const QString filePath = filePathForCover(info, width);
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) ||
+            file.write(data) != data.size() || !file.commit()) {
+        kLogger.warning() << "Failed to write" << filePath
+                << file.errorString();
+        return;
+    }
+    const int maxSavedBytes = static_cast<int>(math_min(
+            m_maxBytes / 16, kMaxSavedBytesBeforeEviction));
+    const int savedBytes =
+            m_savedBytes.fetchAndAddOrdered(data.size()) + data.size();
+    // Only the thread that resets the counter evicts
+    if (savedBytes > maxSavedBytes &&
+            m_savedBytes.testAndSetOrdered(savedBytes, 0)) {
+        evictLeastRecentlyUsed();
+    }
+}
+
+void CoverThumbnailCache::evictLeastRecentlyUsed() {
+    const QFileInfoList entries = m_directory.entryInfoList(
+            QStringList() << (QStringLiteral("*") + kFileSuffix),
+            QDir::Files, QDir::Time);
+    qint64 bytes = 0;
+    // Sorted by descending modification time
+    for (const QFileInfo& entry : entries) {
+        bytes += entry.size();
+        if (bytes > m_maxBytes) {
+            QFile::remove(entry.filePath());
+        }
+    }
+}
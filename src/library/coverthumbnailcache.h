@@ -0,0 +1,49 @@
+#ifndef LIBRARY_COVERTHUMBNAILCACHE_H
+#define LIBRARY_COVERTHUMBNAILCACHE_H
+
+#include <QAtomicInt>
+#include <QDir>
+#include <QImage>
+#include <QString>
+
+#include "library/coverart.h"
+#include "util/class.h"
+
+// A cache of scaled covers on disk, so that the covers of the library table
+// and of the decks are loaded from a small file instead of decoding the
+// full-size image of the track or folder, also after a restart. Each entry
+// holds the cover scaled to one width.
+//
+// Entries are identified by the type, the hash and the location of the
+// cover. The hash alone is only 16 bits wide. A changed cover gets a new
+// hash, so entries are never updated: the least recently used ones are
+// deleted when the size of the cache exceeds its limit.
+//
+// The functions may be called from any thread. An entry is replaced
+// atomically.
+class CoverThumbnailCache {
+  public:
+    CoverThumbnailCache(const QString& directory, int maxMiBs);
+
+    // Returns a null image if there is no entry for the width
+    QImage load(const CoverInfo& info, int width) const;
+
+    void save(const CoverInfo& info, int width, const QImage& image);
+
+    // Deletes the least recently used entries until the cache fits into its
+    // size limit
+    void evictLeastRecentlyUsed();
+
+  private:
+    QString filePathForCover(const CoverInfo& info, int width) const;
+
+    const QDir m_directory;
+    const qint64 m_maxBytes;
+
+    // The bytes that have been written since the last eviction
+    QAtomicInt m_savedBytes;
+
+    DISALLOW_COPY_AND_ASSIGN(CoverThumbnailCache);
+};
+
+#endif // LIBRARY_COVERTHUMBNAILCACHE_H
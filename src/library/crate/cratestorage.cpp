@@ -22,38 +22,23 @@ const QString CRATE_SUMMARY_VIEW = "crate_summary";
 const QString CRATESUMMARY_TRACK_COUNT = "track_count";
 const QString CRATESUMMARY_TRACK_DURATION = "track_duration";
 
-const QString kCrateTracksJoin = QString(
-        "LEFT JOIN %3 ON %3.%4=%1.%2").arg(
-                CRATE_TABLE,
-                CRATETABLE_ID,
-                CRATE_TRACKS_TABLE,
-                CRATETRACKSTABLE_CRATEID);
-
-const QString kLibraryTracksJoin = kCrateTracksJoin + QString(
-        " LEFT JOIN %3 ON %3.%4=%1.%2").arg(
-                CRATE_TRACKS_TABLE,
-                CRATETRACKSTABLE_TRACKID,
-                LIBRARY_TABLE,
-                LIBRARYTABLE_ID);
-
-const QString kCrateSummaryViewSelect = QString(
-        "SELECT %1.*,"
-            "COUNT(CASE %2.%4 WHEN 0 THEN 1 ELSE NULL END) AS %5,"
-            "SUM(CASE %2.%4 WHEN 0 THEN %2.%3 ELSE 0 END) AS %6 "
-            "FROM %1").arg(
-                CRATE_TABLE,
-                LIBRARY_TABLE,
-                LIBRARYTABLE_DURATION,
-                LIBRARYTABLE_MIXXXDELETED,
-                CRATESUMMARY_TRACK_COUNT,
-                CRATESUMMARY_TRACK_DURATION);
+// The number and duration of the tracks of each crate are maintained
+// by triggers (see schema.xml)
+const QString CRATE_SUMMARIES_TABLE = "crate_summaries";
+const QString CRATESUMMARIES_CRATEID = "crate_id";
 
 const QString kCrateSummaryViewQuery = QString(
-            "CREATE TEMPORARY VIEW IF NOT EXISTS %1 AS %2 %3 GROUP BY %4.%5").arg(
+            "CREATE TEMPORARY VIEW IF NOT EXISTS %1 AS "
+            "SELECT %2.*,"
+                "IFNULL(%3.%5,0) AS %5,"
+                "IFNULL(%3.%6,0) AS %6 "
+            "FROM %2 LEFT JOIN %3 ON %3.%4=%2.%7").arg(
                     CRATE_SUMMARY_VIEW,
-                    kCrateSummaryViewSelect,
-                    kLibraryTracksJoin,
                     CRATE_TABLE,
+                    CRATE_SUMMARIES_TABLE,
+                    CRATESUMMARIES_CRATEID,
+                    CRATESUMMARY_TRACK_COUNT,
+                    CRATESUMMARY_TRACK_DURATION,
                     CRATETABLE_ID);
 
 
@@ -83,6 +68,9 @@ class CrateQueryBinder {
 
 const QChar kSqlListSeparator(',');
 
+// Limits the length of statements with inlined lists of track ids
+const int kMaxTrackIdsPerStatement = 10000;
+
 // It is not possible to bind multiple values as a list to a query.
 // The list of track ids has to be transformed into a single list
 // string before it can be used in an SQL query.
@@ -254,7 +242,8 @@ void CrateStorage::createViews() {
 uint CrateStorage::countCrates() const {
     FwdSqlQuery query(m_database, QString(
             "SELECT COUNT(*) FROM %1").arg(
-                    CRATE_TABLE));
+                    CRATE_TABLE),
+            FwdSqlQuery::Caching::Enabled);
     if (query.execPrepared() && query.next()) {
         uint result = query.fieldValue(0).toUInt();
         DEBUG_ASSERT(!query.next());
@@ -269,7 +258,8 @@ bool CrateStorage::readCrateById(CrateId id, Crate* pCrate) const {
     FwdSqlQuery query(m_database, QString(
             "SELECT * FROM %1 WHERE %2=:id").arg(
                     CRATE_TABLE,
-                    CRATETABLE_ID));
+                    CRATETABLE_ID),
+            FwdSqlQuery::Caching::Enabled);
     query.bindValue(":id", id);
     if (query.execPrepared()) {
         CrateSelectResult crates(std::move(query));
@@ -292,7 +282,8 @@ bool CrateStorage::readCrateByName(const QString& name, Crate* pCrate) const {
     FwdSqlQuery query(m_database, QString(
             "SELECT * FROM %1 WHERE %2=:name").arg(
                     CRATE_TABLE,
-                    CRATETABLE_NAME));
+                    CRATETABLE_NAME),
+            FwdSqlQuery::Caching::Enabled);
     query.bindValue(":name", name);
     if (query.execPrepared()) {
         CrateSelectResult crates(std::move(query));
@@ -399,7 +390,8 @@ bool CrateStorage::readCrateSummaryById(CrateId id, CrateSummary* pCrateSummary)
     FwdSqlQuery query(m_database, QString(
             "SELECT * FROM %1 WHERE %2=:id").arg(
                     CRATE_SUMMARY_VIEW,
-                    CRATETABLE_ID));
+                    CRATETABLE_ID),
+            FwdSqlQuery::Caching::Enabled);
     query.bindValue(":id", id);
     if (query.execPrepared()) {
         CrateSummarySelectResult crateSummaries(std::move(query));
@@ -422,7 +414,8 @@ uint CrateStorage::countCrateTracks(CrateId crateId) const {
     FwdSqlQuery query(m_database, QString(
             "SELECT COUNT(*) FROM %1 WHERE %2=:crateId").arg(
                     CRATE_TRACKS_TABLE,
-                    CRATETRACKSTABLE_CRATEID));
+                    CRATETRACKSTABLE_CRATEID),
+            FwdSqlQuery::Caching::Enabled);
     query.bindValue(":crateId", crateId);
     if (query.execPrepared() && query.next()) {
         uint result = query.fieldValue(0).toUInt();
@@ -464,7 +457,8 @@ CrateTrackSelectResult CrateStorage::selectCrateTracksSorted(CrateId crateId) co
             "SELECT * FROM %1 WHERE %2=:crateId ORDER BY %3").arg(
                     CRATE_TRACKS_TABLE,
                     CRATETRACKSTABLE_CRATEID,
-                    CRATETRACKSTABLE_TRACKID));
+                    CRATETRACKSTABLE_TRACKID),
+            FwdSqlQuery::Caching::Enabled);
     query.bindValue(":crateId", crateId);
     if (query.execPrepared()) {
         return CrateTrackSelectResult(std::move(query));
@@ -479,7 +473,8 @@ CrateTrackSelectResult CrateStorage::selectTrackCratesSorted(TrackId trackId) co
             "SELECT * FROM %1 WHERE %2=:trackId ORDER BY %3").arg(
                     CRATE_TRACKS_TABLE,
                     CRATETRACKSTABLE_TRACKID,
-                    CRATETRACKSTABLE_CRATEID));
+                    CRATETRACKSTABLE_CRATEID),
+            FwdSqlQuery::Caching::Enabled);
     query.bindValue(":trackId", trackId);
     if (query.execPrepared()) {
         return CrateTrackSelectResult(std::move(query));
@@ -564,7 +559,8 @@ bool CrateStorage::onInsertingCrate(
                     CRATE_TABLE,
                     CRATETABLE_NAME,
                     CRATETABLE_LOCKED,
-                    CRATETABLE_AUTODJ_SOURCE));
+                    CRATETABLE_AUTODJ_SOURCE),
+            FwdSqlQuery::Caching::Enabled);
     VERIFY_OR_DEBUG_ASSERT(query.isPrepared()) {
         return false;
     }
@@ -601,7 +597,8 @@ bool CrateStorage::onUpdatingCrate(
                     CRATETABLE_NAME,
                     CRATETABLE_LOCKED,
                     CRATETABLE_AUTODJ_SOURCE,
-                    CRATETABLE_ID));
+                    CRATETABLE_ID),
+            FwdSqlQuery::Caching::Enabled);
     VERIFY_OR_DEBUG_ASSERT(query.isPrepared()) {
         return false;
     }
@@ -638,7 +635,8 @@ bool CrateStorage::onDeletingCrate(
         FwdSqlQuery query(m_database, QString(
                 "DELETE FROM %1 WHERE %2=:id").arg(
                         CRATE_TRACKS_TABLE,
-                        CRATETRACKSTABLE_CRATEID));
+                        CRATETRACKSTABLE_CRATEID),
+                FwdSqlQuery::Caching::Enabled);
         VERIFY_OR_DEBUG_ASSERT(query.isPrepared()) {
             return false;
         }
@@ -655,7 +653,8 @@ bool CrateStorage::onDeletingCrate(
         FwdSqlQuery query(m_database, QString(
                 "DELETE FROM %1 WHERE %2=:id").arg(
                         CRATE_TABLE,
-                        CRATETABLE_ID));
+                        CRATETABLE_ID),
+                FwdSqlQuery::Caching::Enabled);
         VERIFY_OR_DEBUG_ASSERT(query.isPrepared()) {
             return false;
         }
@@ -681,27 +680,31 @@ bool CrateStorage::onDeletingCrate(
 bool CrateStorage::onAddingCrateTracks(
         CrateId crateId,
         const QList<TrackId>& trackIds) {
-    FwdSqlQuery query(m_database, QString(
-            "INSERT OR IGNORE INTO %1 (%2, %3) VALUES (:crateId,:trackId)").arg(
-                    CRATE_TRACKS_TABLE,
-                    CRATETRACKSTABLE_CRATEID,
-                    CRATETRACKSTABLE_TRACKID));
-    if (!query.isPrepared()) {
-        return false;
-    }
-    query.bindValue(":crateId", crateId);
-    for (const auto& trackId: trackIds) {
-        query.bindValue(":trackId", trackId);
+    // All tracks are added with a single statement per chunk
+    for (int first = 0; first < trackIds.size();
+            first += kMaxTrackIdsPerStatement) {
+        const QList<TrackId> chunk = trackIds.mid(first, kMaxTrackIdsPerStatement);
+        FwdSqlQuery query(m_database, QString(
+                "INSERT OR IGNORE INTO %1 (%2, %3) "
+                "SELECT :crateId, %4 FROM %5 WHERE %4 IN (%6)").arg(
+                        CRATE_TRACKS_TABLE,
+                        CRATETRACKSTABLE_CRATEID,
+                        CRATETRACKSTABLE_TRACKID,
+                        LIBRARYTABLE_ID,
+                        LIBRARY_TABLE,
+                        joinSqlStringList(chunk)));
+        if (!query.isPrepared()) {
+            return false;
+        }
+        query.bindValue(":crateId", crateId);
         if (!query.execPrepared()) {
             return false;
         }
-        if (query.numRowsAffected() == 0) {
-            // track is already in crate
+        if (query.numRowsAffected() < chunk.size()) {
+            // tracks are already in crate
             kLogger.debug()
-                    << "Track" << trackId
-                    << "not added to crate" << crateId;
-        } else {
-            DEBUG_ASSERT(query.numRowsAffected() == 1);
+                    << (chunk.size() - query.numRowsAffected())
+                    << "tracks not added to crate" << crateId;
         }
     }
     return true;
@@ -711,29 +714,29 @@ bool CrateStorage::onAddingCrateTracks(
 bool CrateStorage::onRemovingCrateTracks(
         CrateId crateId,
         const QList<TrackId>& trackIds) {
-    // NOTE(uklotzde): We remove tracks in a loop
+    // NOTE(uklotzde): We remove tracks in chunks
     // analogously to adding tracks (see above).
-    FwdSqlQuery query(m_database, QString(
-            "DELETE FROM %1 WHERE %2=:crateId AND %3=:trackId").arg(
-                    CRATE_TRACKS_TABLE,
-                    CRATETRACKSTABLE_CRATEID,
-                    CRATETRACKSTABLE_TRACKID));
-    if (!query.isPrepared()) {
-        return false;
-    }
-    query.bindValue(":crateId", crateId);
-    for (const auto& trackId: trackIds) {
-        query.bindValue(":trackId", trackId);
+    for (int first = 0; first < trackIds.size();
+            first += kMaxTrackIdsPerStatement) {
+        const QList<TrackId> chunk = trackIds.mid(first, kMaxTrackIdsPerStatement);
+        FwdSqlQuery query(m_database, QString(
+                "DELETE FROM %1 WHERE %2=:crateId AND %3 IN (%4)").arg(
+                        CRATE_TRACKS_TABLE,
+                        CRATETRACKSTABLE_CRATEID,
+                        CRATETRACKSTABLE_TRACKID,
+                        joinSqlStringList(chunk)));
+        if (!query.isPrepared()) {
+            return false;
+        }
+        query.bindValue(":crateId", crateId);
         if (!query.execPrepared()) {
             return false;
         }
-        if (query.numRowsAffected() == 0) {
-            // track not found in crate
+        if (query.numRowsAffected() < chunk.size()) {
+            // tracks not found in crate
             kLogger.debug()
-                    << "Track" << trackId
-                    << "not removed from crate" << crateId;
-        } else {
-            DEBUG_ASSERT(query.numRowsAffected() == 1);
+                    << (chunk.size() - query.numRowsAffected())
+                    << "tracks not removed from crate" << crateId;
         }
     }
     return true;
@@ -748,7 +751,8 @@ bool CrateStorage::onPurgingTracks(
     FwdSqlQuery query(m_database, QString(
             "DELETE FROM %1 WHERE %2=:trackId").arg(
                     CRATE_TRACKS_TABLE,
-                    CRATETRACKSTABLE_TRACKID));
+                    CRATETRACKSTABLE_TRACKID),
+            FwdSqlQuery::Caching::Enabled);
     if (!query.isPrepared()) {
         return false;
     }
@@ -6,6 +6,7 @@
 #include "library/dao/analysisdao.h"
 #include "library/queryutil.h"
 #include "preferences/waveformsettings.h"
+#include "util/db/cachedsqlquery.h"
 #include "util/performancetimer.h"
 #include "waveform/waveform.h"
 
@@ -30,8 +31,7 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::getAnalysesForTrack(TrackId trackI
         return QList<AnalysisInfo>();
     }
 
-    QSqlQuery query(m_db);
-    query.prepare(QString(
+    CachedSqlQuery query(m_db, QString(
         "SELECT id, type, description, version, data_checksum FROM %1 "
         "WHERE track_id=:trackId").arg(s_analysisTableName));
     query.bindValue(":trackId", trackId.toVariant());
@@ -45,8 +45,7 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::getAnalysesForTrackByType(
         return QList<AnalysisInfo>();
     }
 
-    QSqlQuery query(m_db);
-    query.prepare(QString(
+    CachedSqlQuery query(m_db, QString(
         "SELECT id, type, description, version, data_checksum FROM %1 "
         "WHERE track_id=:trackId AND type=:type").arg(s_analysisTableName));
     query.bindValue(":trackId", trackId.toVariant());
@@ -84,6 +83,19 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
         int checksum = query->value(dataChecksumColumn).toInt();
         QString dataPath = analysisPath.absoluteFilePath(
             QString::number(info.analysisId));
+        const QByteArray header = loadDataFromFile(
+                dataPath, Waveform::mappedFileHeaderSize());
+        if (Waveform::isMappedFileHeader(header)) {
+            // Only the header is checksummed, the data is mapped when
+            // the waveform is created
+            if (checksum != qChecksum(header.constData(), header.length())) {
+                qDebug() << "WARNING: Corrupt analysis header loaded from" << dataPath;
+                continue;
+            }
+            info.mappedFileName = dataPath;
+            analyses.append(info);
+            continue;
+        }
         QByteArray compressedData = loadDataFromFile(dataPath);
         int file_checksum = qChecksum(compressedData.constData(),
                                       compressedData.length());
@@ -117,10 +129,60 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
     QByteArray compressedData = qCompress(info->data, kCompressionLevel);
     int checksum = qChecksum(compressedData.constData(),
                              compressedData.length());
+    if (!saveAnalysisInfo(info, checksum)) {
+        return false;
+    }
 
-    QSqlQuery query(m_db);
+    QString dataPath = getAnalysisStoragePath().absoluteFilePath(
+        QString::number(info->analysisId));
+    if (!saveDataToFile(dataPath, compressedData)) {
+        qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
+        return false;
+    }
+
+    qDebug() << "AnalysisDAO saved analysis" << info->analysisId
+             << QString("%1 (%2 compressed)").arg(QString::number(info->data.length()),
+                                                  QString::number(compressedData.length()))
+             << "bytes for track"
+             << info->trackId << "in" << time.elapsed().debugMillisWithUnit();
+    return true;
+}
+
+bool AnalysisDao::saveMappedWaveform(AnalysisDao::AnalysisInfo* info,
+                                     const Waveform& waveform) {
+    if (!m_db.isOpen() || info == NULL) {
+        return false;
+    }
+
+    if (!info->trackId.isValid()) {
+        qDebug() << "Can't save analysis since trackId is invalid.";
+        return false;
+    }
+    PerformanceTimer time;
+    time.start();
+
+    const QByteArray header = waveform.mappedFileHeader();
+    int checksum = qChecksum(header.constData(), header.length());
+    if (!saveAnalysisInfo(info, checksum)) {
+        return false;
+    }
+
+    QString dataPath = getAnalysisStoragePath().absoluteFilePath(
+        QString::number(info->analysisId));
+    if (!waveform.writeMappedFile(dataPath)) {
+        qDebug() << "WARNING: Couldn't save mapped waveform to file" << dataPath;
+        return false;
+    }
+
+    qDebug() << "AnalysisDAO saved mapped waveform" << info->analysisId
+             << "for track" << info->trackId
+             << "in" << time.elapsed().debugMillisWithUnit();
+    return true;
+}
+
+bool AnalysisDao::saveAnalysisInfo(AnalysisDao::AnalysisInfo* info, int checksum) {
     if (info->analysisId == -1) {
-        query.prepare(QString(
+        CachedSqlQuery query(m_db, QString(
             "INSERT INTO %1 (track_id, type, description, version, data_checksum) "
             "VALUES (:trackId,:type,:description,:version,:data_checksum)")
                       .arg(s_analysisTableName));
@@ -138,7 +200,7 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
         }
         info->analysisId = query.lastInsertId().toInt();
     } else {
-        query.prepare(QString(
+        CachedSqlQuery query(m_db, QString(
             "UPDATE %1 SET "
             "track_id = :trackId,"
             "type = :type,"
@@ -159,19 +221,6 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
             return false;
         }
     }
-
-    QString dataPath = getAnalysisStoragePath().absoluteFilePath(
-        QString::number(info->analysisId));
-    if (!saveDataToFile(dataPath, compressedData)) {
-        qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
-        return false;
-    }
-
-    qDebug() << "AnalysisDAO saved analysis" << info->analysisId
-             << QString("%1 (%2 compressed)").arg(QString::number(info->data.length()),
-                                                  QString::number(compressedData.length()))
-             << "bytes for track"
-             << info->trackId << "in" << time.elapsed().debugMillisWithUnit();
     return true;
 }
 
@@ -179,8 +228,7 @@ bool AnalysisDao::deleteAnalysis(const int analysisId) {
     if (analysisId == -1) {
         return false;
     }
-    QSqlQuery query(m_db);
-    query.prepare(QString(
+    CachedSqlQuery query(m_db, QString(
         "DELETE FROM %1 WHERE id = :id").arg(s_analysisTableName));
     query.bindValue(":id", analysisId);
 
@@ -224,8 +272,7 @@ bool AnalysisDao::deleteAnalysesForTrack(TrackId trackId) {
     if (!trackId.isValid()) {
         return false;
     }
-    QSqlQuery query(m_db);
-    query.prepare(QString(
+    CachedSqlQuery query(m_db, QString(
         "SELECT id FROM %1 where track_id = :track_id").arg(s_analysisTableName));
     query.bindValue(":track_id", trackId.toVariant());
 
@@ -252,7 +299,7 @@ QDir AnalysisDao::getAnalysisStoragePath() const {
     return dir.absolutePath().append("/");
 }
 
-QByteArray AnalysisDao::loadDataFromFile(const QString& filename) const {
+QByteArray AnalysisDao::loadDataFromFile(const QString& filename, qint64 maxSize) const {
     QFile file(filename);
     if (!file.exists()) {
         return QByteArray();
@@ -260,6 +307,9 @@ QByteArray AnalysisDao::loadDataFromFile(const QString& filename) const {
     if (!file.open(QIODevice::ReadOnly)) {
         return QByteArray();
     }
+    if (maxSize >= 0) {
+        return file.read(maxSize);
+    }
     return file.readAll();
 }
 
@@ -332,8 +382,7 @@ void AnalysisDao::saveTrackAnalyses(const Track& track) {
     analysis.type = AnalysisDao::TYPE_WAVEFORM;
     analysis.description = pWaveform->getDescription();
     analysis.version = pWaveform->getVersion();
-    analysis.data = pWaveform->toByteArray();
-    bool success = saveAnalysis(&analysis);
+    bool success = saveMappedWaveform(&analysis, *pWaveform);
     if (success) {
         pWaveform->setSaveState(Waveform::SaveState::Saved);
     }
@@ -347,9 +396,8 @@ void AnalysisDao::saveTrackAnalyses(const Track& track) {
     analysis.type = AnalysisDao::TYPE_WAVESUMMARY;
     analysis.description = pWaveSummary->getDescription();
     analysis.version = pWaveSummary->getVersion();
-    analysis.data = pWaveSummary->toByteArray();
 
-    success = saveAnalysis(&analysis);
+    success = saveMappedWaveform(&analysis, *pWaveSummary);
     if (success) {
         pWaveSummary->setSaveState(Waveform::SaveState::Saved);
     }
@@ -29,6 +29,9 @@ class AnalysisDao : public DAO {
         QString description;
         QString version;
         QByteArray data;
+        // Set instead of data for waveforms in the mapped format, see
+        // Waveform::readMappedFile()
+        QString mappedFileName;
     };
 
     explicit AnalysisDao(UserSettingsPointer pConfig);
@@ -51,6 +54,10 @@ class AnalysisDao : public DAO {
     QList<AnalysisInfo> getAnalysesForTrackByType(TrackId trackId, AnalysisType type);
     QList<AnalysisInfo> getAnalysesForTrack(TrackId trackId);
     bool saveAnalysis(AnalysisInfo* analysis);
+    // Saves a waveform or waveform summary in the mapped format. Also
+    // used to migrate waveforms from the compressed format when they are
+    // loaded.
+    bool saveMappedWaveform(AnalysisInfo* analysis, const Waveform& waveform);
     bool deleteAnalysis(const int analysisId);
     void deleteAnalyses(const QList<TrackId>& trackIds);
     bool deleteAnalysesForTrack(TrackId trackId);
@@ -58,13 +65,14 @@ class AnalysisDao : public DAO {
     void saveTrackAnalyses(const Track& track);
 
   private:
+    bool saveAnalysisInfo(AnalysisInfo* analysis, int checksum);
     bool saveWaveform(const Track& tio,
                       const Waveform& waveform,
                       AnalysisType type);
     bool loadWaveform(const Track& tio,
                       Waveform* waveform, AnalysisType type);
     QDir getAnalysisStoragePath() const;
-    QByteArray loadDataFromFile(const QString& fileName) const;
+    QByteArray loadDataFromFile(const QString& fileName, qint64 maxSize = -1) const;
     bool saveDataToFile(const QString& fileName, const QByteArray& data) const;
     bool deleteFile(const QString& filename) const;
     QList<AnalysisInfo> loadAnalysesFromQuery(TrackId trackId, QSqlQuery* query);
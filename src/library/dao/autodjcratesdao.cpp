@@ -167,6 +167,28 @@ void AutoDJCratesDAO::createAndConnectAutoDjCratesDatabase() {
         return;
     }
 
+    // Index the tracks in the order of the active-tracks view, so that
+    // counting and picking active tracks walks a range of the index instead
+    // of sorting all tracks.  The indexes contain the track ID, so that
+    // the table itself is not read.
+    // CREATE INDEX temp_autodj_crates_timesplayed_index
+    // ON temp_autodj_crates (autodjrefs, timesplayed, lastplayed, track_id);
+    // CREATE INDEX temp_autodj_crates_lastplayed_index
+    // ON temp_autodj_crates (autodjrefs, lastplayed, track_id);
+    if (!oQuery.exec("CREATE INDEX " AUTODJCRATES_TABLE "_timesplayed_index ON "
+            AUTODJCRATES_TABLE " (" AUTODJCRATESTABLE_AUTODJREFS ", "
+            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_LASTPLAYED
+            ", " AUTODJCRATESTABLE_TRACKID ")")) {
+        LOG_FAILED_QUERY(oQuery);
+        return;
+    }
+    if (!oQuery.exec("CREATE INDEX " AUTODJCRATES_TABLE "_lastplayed_index ON "
+            AUTODJCRATES_TABLE " (" AUTODJCRATESTABLE_AUTODJREFS ", "
+            AUTODJCRATESTABLE_LASTPLAYED ", " AUTODJCRATESTABLE_TRACKID ")")) {
+        LOG_FAILED_QUERY(oQuery);
+        return;
+    }
+
     // Create the active-tracks view.
     //oQuery.exec ("DROP VIEW IF EXISTS " AUTODJACTIVETRACKS_TABLE);
     if (!createActiveTracksView (m_bUseIgnoreTime)) {
@@ -216,10 +238,10 @@ void AutoDJCratesDAO::createAndConnectAutoDjCratesDatabase() {
 
     // Be notified when tracks are added/removed from playlists.
     // We only care about the auto-DJ playlist and the set-log playlists.
-    connect(&m_pTrackCollection->getPlaylistDAO(), SIGNAL(trackAdded(int,TrackId,int)),
-            this, SLOT(slotPlaylistTrackAdded(int,TrackId,int)));
-    connect(&m_pTrackCollection->getPlaylistDAO(), SIGNAL(trackRemoved(int,TrackId,int)),
-            this, SLOT(slotPlaylistTrackRemoved(int,TrackId,int)));
+    connect(&m_pTrackCollection->getPlaylistDAO(), SIGNAL(tracksAdded(int,QList<TrackId>)),
+            this, SLOT(slotPlaylistTracksAdded(int,QList<TrackId>)));
+    connect(&m_pTrackCollection->getPlaylistDAO(), SIGNAL(tracksRemoved(int,QList<TrackId>)),
+            this, SLOT(slotPlaylistTracksRemoved(int,QList<TrackId>)));
 
     // Be notified when tracks are loaded to, or unloaded from, a deck.
     // These count as auto-DJ references, i.e. prevent the track from being
@@ -509,15 +531,19 @@ TrackId AutoDJCratesDAO::getRandomTrackId() {
     // Calculate the number of active-tracks that have never been played, and
     // the total number of active-tracks.
     QSqlQuery oQuery(m_database);
+    // The counts are taken from the table instead of the ordered view, so
+    // that they are answered from the index without sorting.
     // SELECT COUNT(*) AS count
-    // FROM temp_autodj_activetracks
-    // WHERE timesplayed = 0
+    // FROM temp_autodj_crates
+    // WHERE autodjrefs = 0 AND timesplayed = 0
     // UNION ALL SELECT COUNT(*) AS count
-    // FROM temp_autodj_activetracks;
-    oQuery.prepare("SELECT COUNT(*) AS count FROM " AUTODJACTIVETRACKS_TABLE
-        " WHERE " AUTODJCRATESTABLE_TIMESPLAYED
-        " = 0 UNION ALL SELECT COUNT(*) AS count FROM "
-        AUTODJACTIVETRACKS_TABLE);
+    // FROM temp_autodj_crates
+    // WHERE autodjrefs = 0;
+    oQuery.prepare("SELECT COUNT(*) AS count FROM " AUTODJCRATES_TABLE
+        " WHERE " AUTODJCRATESTABLE_AUTODJREFS " = 0 AND "
+        AUTODJCRATESTABLE_TIMESPLAYED " = 0 UNION ALL SELECT COUNT(*) AS count"
+        " FROM " AUTODJCRATES_TABLE " WHERE " AUTODJCRATESTABLE_AUTODJREFS
+        " = 0");
     VERIFY_OR_DEBUG_ASSERT(oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
         return TrackId();
@@ -569,10 +595,12 @@ TrackId AutoDJCratesDAO::getRandomTrackId() {
         QString strDateTime = timeCurrent.toString("yyyy-MM-dd hh:mm:ss");
 
         // Count the number of tracks that haven't been played since this time.
-        // SELECT COUNT(*) FROM temp_autodj_activetracks WHERE lastplayed < :lastplayed;
+        // SELECT COUNT(*) FROM temp_autodj_crates
+        // WHERE autodjrefs = 0 AND lastplayed < :lastplayed;
         int iIgnoreTimeTracks = 0;
-        oQuery.prepare("SELECT COUNT(*) FROM " AUTODJACTIVETRACKS_TABLE
-            " WHERE " AUTODJCRATESTABLE_LASTPLAYED " < :lastplayed");
+        oQuery.prepare("SELECT COUNT(*) FROM " AUTODJCRATES_TABLE
+            " WHERE " AUTODJCRATESTABLE_AUTODJREFS " = 0 AND "
+            AUTODJCRATESTABLE_LASTPLAYED " < :lastplayed");
         oQuery.bindValue (":lastplayed", strDateTime);
         if (oQuery.exec()) {
             if (oQuery.next()) {
@@ -776,14 +804,20 @@ void AutoDJCratesDAO::updateAutoDjCrate(CrateId crateId) {
     // Create an entry for all tracks that weren't in the auto-DJ-crates
     // table already.
     // The number of crate references is known to be 1 for such tracks.
-    // The number of references to each track in the auto-DJ playlist isn't
-    // set yet; it defaults to zero.
-    // If no records were modified by this query, then there's no reason to
-    // update the number of auto-DJ-playlist references to each track.
-
+    // The number of references to each track in the auto-DJ playlist and
+    // the last-played date/time are looked up for these tracks only, so
+    // that adding a crate doesn't rebuild the whole table.
     // INSERT INTO temp_autodj_crates (
-    //     track_id, craterefs, timesplayed, autodjrefs)
-    // SELECT crate_tracks.track_id, 1, library.timesplayed, 0
+    //     track_id, craterefs, timesplayed, autodjrefs, lastplayed)
+    // SELECT crate_tracks.track_id, 1, library.timesplayed, (
+    //     SELECT COUNT(*) FROM PlaylistTracks
+    //     WHERE PlaylistTracks.track_id = crate_tracks.track_id
+    //     AND PlaylistTracks.playlist_id IN (
+    //         SELECT id FROM Playlists WHERE hidden = PLHT_AUTO_DJ)), IFNULL((
+    //     SELECT MAX(pl_datetime_added) FROM PlaylistTracks
+    //     WHERE PlaylistTracks.track_id = crate_tracks.track_id
+    //     AND PlaylistTracks.playlist_id IN (
+    //         SELECT id FROM Playlists WHERE hidden = PLHT_SET_LOG)), "")
     // FROM crate_tracks, library
     // WHERE crate_tracks.crate_id = :crate_id
     // AND crate_tracks.track_id NOT IN (
@@ -792,17 +826,32 @@ void AutoDJCratesDAO::updateAutoDjCrate(CrateId crateId) {
     // AND library.mixxx_deleted = 0;
     oQuery.prepare(QString("INSERT INTO " AUTODJCRATES_TABLE " ("
             AUTODJCRATESTABLE_TRACKID ", " AUTODJCRATESTABLE_CRATEREFS ", "
-            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS
-            ") SELECT " CRATE_TRACKS_TABLE ".%1, 1, " LIBRARY_TABLE
-            ".timesplayed, 0 FROM " CRATE_TRACKS_TABLE ", " LIBRARY_TABLE
-            " WHERE " CRATE_TRACKS_TABLE ".%2 = :crate_id AND "
-            CRATE_TRACKS_TABLE ".%1 NOT IN (SELECT " AUTODJCRATESTABLE_TRACKID
-            " FROM " AUTODJCRATES_TABLE" ) AND " CRATE_TRACKS_TABLE ".%1 = "
-            LIBRARY_TABLE ".%3 AND " LIBRARY_TABLE ".%4 = 0")
+            AUTODJCRATESTABLE_TIMESPLAYED ", " AUTODJCRATESTABLE_AUTODJREFS ", "
+            AUTODJCRATESTABLE_LASTPLAYED ") SELECT " CRATE_TRACKS_TABLE ".%1, 1, "
+            LIBRARY_TABLE ".%9, (SELECT COUNT(*) FROM " PLAYLIST_TRACKS_TABLE
+            " WHERE " PLAYLIST_TRACKS_TABLE ".%5 = " CRATE_TRACKS_TABLE ".%1 AND "
+            PLAYLIST_TRACKS_TABLE ".%6 IN (SELECT %7 FROM " PLAYLIST_TABLE
+            " WHERE %8 = %10)), IFNULL((SELECT MAX(%11) FROM "
+            PLAYLIST_TRACKS_TABLE " WHERE " PLAYLIST_TRACKS_TABLE ".%5 = "
+            CRATE_TRACKS_TABLE ".%1 AND " PLAYLIST_TRACKS_TABLE ".%6 IN (SELECT "
+            "%7 FROM " PLAYLIST_TABLE " WHERE %8 = %12)), \"\") FROM "
+            CRATE_TRACKS_TABLE ", " LIBRARY_TABLE " WHERE " CRATE_TRACKS_TABLE
+            ".%2 = :crate_id AND " CRATE_TRACKS_TABLE ".%1 NOT IN (SELECT "
+            AUTODJCRATESTABLE_TRACKID " FROM " AUTODJCRATES_TABLE" ) AND "
+            CRATE_TRACKS_TABLE ".%1 = " LIBRARY_TABLE ".%3 AND " LIBRARY_TABLE
+            ".%4 = 0")
             .arg(CRATETRACKSTABLE_TRACKID, // %1
                  CRATETRACKSTABLE_CRATEID, // %2
                  LIBRARYTABLE_ID, // %3
-                 LIBRARYTABLE_MIXXXDELETED)); // %4
+                 LIBRARYTABLE_MIXXXDELETED, // %4
+                 PLAYLISTTRACKSTABLE_TRACKID, // %5
+                 PLAYLISTTRACKSTABLE_PLAYLISTID, // %6
+                 PLAYLISTTABLE_ID, // %7
+                 PLAYLISTTABLE_HIDDEN, // %8
+                 LIBRARYTABLE_TIMESPLAYED) // %9
+            .arg(QString::number(PlaylistDAO::PLHT_AUTO_DJ), // %10
+                 PLAYLISTTRACKSTABLE_DATETIMEADDED, // %11
+                 QString::number(PlaylistDAO::PLHT_SET_LOG))); // %12
     oQuery.bindValue(":crate_id", crateId.toVariant());
     if (!oQuery.exec()) {
         LOG_FAILED_QUERY(oQuery);
@@ -813,20 +862,33 @@ void AutoDJCratesDAO::updateAutoDjCrate(CrateId crateId) {
         return;
     }
 
-    // Update the number of auto-DJ-playlist references to each track.
-    // There's no way to avoid updating the number of references to tracks
-    // that were already in the database, but the auto-DJ-playlist is likely
-    // to be small compared to the number of tracks in auto-DJ crates, so
-    // this isn't so bad.
-    if (!updateAutoDjPlaylistReferences()) {
-        return;
-    }
-
-    // Update the last-played date/time for each track.
-    // Similarly, there's no way to avoid updating the last-played date/time
-    // of tracks that were already in the database.
-    if (!updateLastPlayedDateTime()) {
-        return;
+    // Incorporate the new tracks that are loaded into decks.  They are the
+    // tracks of this crate with a single crate reference, because the
+    // references of the existing tracks have been incremented above.
+    int iDecks = (int) PlayerManager::numDecks();
+    for (int i = 0; i < iDecks; ++i) {
+        QString group = PlayerManager::groupForDeck(i);
+        TrackPointer pTrack = PlayerInfo::instance().getTrackInfo(group);
+        if (!pTrack) {
+            continue;
+        }
+        // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs + 1
+        // WHERE track_id = :track_id AND craterefs = 1
+        // AND track_id IN (
+        //     SELECT track_id FROM crate_tracks WHERE crate_id = :crate_id);
+        oQuery.prepare(QString("UPDATE " AUTODJCRATES_TABLE " SET "
+                AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
+                " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id AND "
+                AUTODJCRATESTABLE_CRATEREFS " = 1 AND " AUTODJCRATESTABLE_TRACKID
+                " IN (SELECT %1 FROM " CRATE_TRACKS_TABLE " WHERE %2 = :crate_id)")
+                .arg(CRATETRACKSTABLE_TRACKID, // %1
+                     CRATETRACKSTABLE_CRATEID)); // %2
+        oQuery.bindValue(":track_id", pTrack->getId().toVariant());
+        oQuery.bindValue(":crate_id", crateId.toVariant());
+        if (!oQuery.exec()) {
+            LOG_FAILED_QUERY(oQuery);
+            return;
+        }
     }
 
     // The transaction was successful.
@@ -968,8 +1030,9 @@ void AutoDJCratesDAO::slotPlaylistAdded(int playlistId) {
     // We only care about changes to set-log playlists.
     if (m_pTrackCollection->getPlaylistDAO().getHiddenType(playlistId)
             == PlaylistDAO::PLHT_SET_LOG) {
+        // A new playlist has no tracks yet that could change the
+        // last-played date/time.
         m_lstSetLogPlaylistIds.append(playlistId);
-        updateLastPlayedDateTime();
     }
 }
 
@@ -984,53 +1047,66 @@ void AutoDJCratesDAO::slotPlaylistDeleted(int playlistId) {
 }
 
 // Signaled by the playlist DAO when a track is added to a playlist.
-void AutoDJCratesDAO::slotPlaylistTrackAdded(int playlistId, TrackId trackId,
-                                             int /* a_iPosition */) {
+void AutoDJCratesDAO::slotPlaylistTracksAdded(int playlistId,
+                                              const QList<TrackId>& trackIds) {
     // Deal with changes to the auto-DJ playlist.
     if (playlistId == m_iAutoDjPlaylistId) {
-        QSqlQuery oQuery(m_database);
-        // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs + 1
-        // WHERE track_id = :track_id;
-        oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-            " + 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
+        updateAutoDjPlaylistReferencesOfTracks(trackIds, 1);
     } else if (m_lstSetLogPlaylistIds.contains(playlistId)) {
         // Deal with changes to set-log playlists.
         // If this query doesn't succeed, it'll log a message.
         // Do nothing special otherwise -- any change it makes can be part of
         // any current transaction.
-        updateLastPlayedDateTimeForTrack(trackId);
+        for (const auto& trackId: trackIds) {
+            updateLastPlayedDateTimeForTrack(trackId);
+        }
     }
 }
 
-// Signaled by the playlist DAO when a track is removed from a playlist.
-void AutoDJCratesDAO::slotPlaylistTrackRemoved(int playlistId,
-                                               TrackId trackId,
-                                               int /* a_iPosition */) {
+// Signaled by the playlist DAO when tracks are removed from a playlist.
+void AutoDJCratesDAO::slotPlaylistTracksRemoved(int playlistId,
+                                                const QList<TrackId>& trackIds) {
     // Deal with changes to the auto-DJ playlist.
     if (playlistId == m_iAutoDjPlaylistId) {
-        QSqlQuery oQuery(m_database);
-        // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs - 1 WHERE track_id = :track_id;
-        oQuery.prepare("UPDATE " AUTODJCRATES_TABLE " SET "
-            AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
-            " - 1 WHERE " AUTODJCRATESTABLE_TRACKID " = :track_id");
-        oQuery.bindValue(":track_id", trackId.toVariant());
-        if (!oQuery.exec()) {
-            LOG_FAILED_QUERY(oQuery);
-            return;
-        }
+        updateAutoDjPlaylistReferencesOfTracks(trackIds, -1);
     } else if (m_lstSetLogPlaylistIds.contains(playlistId)) {
         // Deal with changes to set-log playlists.
         // If this query doesn't succeed, it'll log a message.
         // Do nothing special otherwise -- any change it makes can be part of
         // any current transaction.
-        updateLastPlayedDateTimeForTrack(trackId);
+        for (const auto& trackId: trackIds) {
+            updateLastPlayedDateTimeForTrack(trackId);
+        }
+    }
+}
+
+bool AutoDJCratesDAO::updateAutoDjPlaylistReferencesOfTracks(
+        const QList<TrackId>& trackIds, int delta) {
+    // Tracks that occur more than once are updated with a multiple of the
+    // delta. Usually all tracks occur once and need a single update.
+    QHash<TrackId, int> occurrences;
+    for (const auto& trackId: trackIds) {
+        ++occurrences[trackId];
     }
+    QMap<int, QStringList> trackIdsByOccurrences;
+    for (auto it = occurrences.constBegin(); it != occurrences.constEnd(); ++it) {
+        trackIdsByOccurrences[it.value()].append(it.key().toString());
+    }
+    QSqlQuery oQuery(m_database);
+    for (auto it = trackIdsByOccurrences.constBegin();
+            it != trackIdsByOccurrences.constEnd(); ++it) {
+        // UPDATE temp_autodj_crates SET autodjrefs = autodjrefs + :delta
+        // WHERE track_id IN (...);
+        if (!oQuery.exec(QString("UPDATE " AUTODJCRATES_TABLE " SET "
+                AUTODJCRATESTABLE_AUTODJREFS " = " AUTODJCRATESTABLE_AUTODJREFS
+                " + %1 WHERE " AUTODJCRATESTABLE_TRACKID " IN (%2)")
+                .arg(QString::number(delta * it.key()),
+                        it.value().join(",")))) {
+            LOG_FAILED_QUERY(oQuery);
+            return false;
+        }
+    }
+    return true;
 }
 
 // Signaled by the PlayerInfo singleton when a track is loaded to a deck.
@@ -56,6 +56,11 @@ class AutoDJCratesDAO : public QObject {
     // auto-DJ-crates database.  Returns true if successful.
     bool updateLastPlayedDateTimeForTrack(TrackId trackId);
 
+    // Adds the delta to the number of auto-DJ-playlist references of each
+    // occurrence of the tracks
+    bool updateAutoDjPlaylistReferencesOfTracks(
+            const QList<TrackId>& trackIds, int delta);
+
     // Calculates a random Track from AutoDJ,
     // This is used when all active tracks are already queued up.
     TrackId getRandomTrackIdFromAutoDj(int percentActive);
@@ -82,13 +87,13 @@ class AutoDJCratesDAO : public QObject {
     // Signaled by the playlist DAO when a playlist is deleted.
     void slotPlaylistDeleted(int playlistId);
 
-    // Signaled by the playlist DAO when a track is added to a playlist.
-    void slotPlaylistTrackAdded(int playlistId, TrackId trackId,
-                                int position);
+    // Signaled by the playlist DAO when tracks are added to a playlist.
+    void slotPlaylistTracksAdded(int playlistId,
+                                 const QList<TrackId>& trackIds);
 
-    // Signaled by the playlist DAO when a track is removed from a playlist.
-    void slotPlaylistTrackRemoved(int playlistId, TrackId trackId,
-                                  int position);
+    // Signaled by the playlist DAO when tracks are removed from a playlist.
+    void slotPlaylistTracksRemoved(int playlistId,
+                                   const QList<TrackId>& trackIds);
 
     // Signaled by the PlayerInfo singleton when a track is loaded to, or
     // unloaded from, a deck.
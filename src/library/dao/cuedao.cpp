@@ -10,12 +10,12 @@
 #include "track/track.h"
 #include "library/queryutil.h"
 #include "util/assert.h"
+#include "util/db/cachedsqlquery.h"
 #include "util/performancetimer.h"
 
 int CueDAO::cueCount() {
     qDebug() << "CueDAO::cueCount" << QThread::currentThread() << m_database.connectionName();
-    QSqlQuery query(m_database);
-    query.prepare("SELECT COUNT(*) FROM " CUE_TABLE);
+    CachedSqlQuery query(m_database, "SELECT COUNT(*) FROM " CUE_TABLE);
     if (query.exec()) {
         if (query.next()) {
             return query.value(0).toInt();
@@ -29,8 +29,8 @@ int CueDAO::cueCount() {
 
 int CueDAO::numCuesForTrack(TrackId trackId) {
     qDebug() << "CueDAO::numCuesForTrack" << QThread::currentThread() << m_database.connectionName();
-    QSqlQuery query(m_database);
-    query.prepare("SELECT COUNT(*) FROM " CUE_TABLE " WHERE track_id = :id");
+    CachedSqlQuery query(m_database,
+            "SELECT COUNT(*) FROM " CUE_TABLE " WHERE track_id = :id");
     query.bindValue(":id", trackId.toVariant());
     if (query.exec()) {
         if (query.next()) {
@@ -58,50 +58,81 @@ CuePointer CueDAO::cueFromRow(const QSqlQuery& query) const {
     return pCue;
 }
 
-QList<CuePointer> CueDAO::getCuesForTrack(TrackId trackId) const {
-    //qDebug() << "CueDAO::getCuesForTrack" << QThread::currentThread() << m_database.connectionName();
-    QList<CuePointer> cues;
+QHash<TrackId, QList<CuePointer>> CueDAO::cuesFromQuery(QSqlQuery* pQuery) const {
+    QHash<TrackId, QList<CuePointer>> cuesByTrack;
     // A hash from hotcue index to cue id and cue*, used to detect if more
     // than one cue has been assigned to a single hotcue id.
-    QMap<int, QPair<int, CuePointer> > dupe_hotcues;
+    QHash<TrackId, QMap<int, QPair<int, CuePointer> > > dupe_hotcues;
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM " CUE_TABLE " WHERE track_id = :id");
-    query.bindValue(":id", trackId.toVariant());
-    if (query.exec()) {
-        const int idColumn = query.record().indexOf("id");
-        const int hotcueIdColumn = query.record().indexOf("hotcue");
-        while (query.next()) {
-            CuePointer pCue;
-            int cueId = query.value(idColumn).toInt();
-            if (m_cues.contains(cueId)) {
-                pCue = m_cues[cueId];
-            }
-            if (!pCue) {
-                pCue = cueFromRow(query);
-            }
-            int hotcueId = query.value(hotcueIdColumn).toInt();
-            if (hotcueId != -1) {
-                if (dupe_hotcues.contains(hotcueId)) {
-                    m_cues.remove(dupe_hotcues[hotcueId].first);
-                    cues.removeOne(dupe_hotcues[hotcueId].second);
-                }
-                dupe_hotcues[hotcueId] = qMakePair(cueId, pCue);
-            }
-            if (pCue) {
-                cues.push_back(pCue);
+    const int idColumn = pQuery->record().indexOf("id");
+    const int trackIdColumn = pQuery->record().indexOf("track_id");
+    const int hotcueIdColumn = pQuery->record().indexOf("hotcue");
+    while (pQuery->next()) {
+        CuePointer pCue;
+        int cueId = pQuery->value(idColumn).toInt();
+        if (m_cues.contains(cueId)) {
+            pCue = m_cues[cueId];
+        }
+        if (!pCue) {
+            pCue = cueFromRow(*pQuery);
+        }
+        const TrackId trackId(pQuery->value(trackIdColumn));
+        QList<CuePointer>& cues = cuesByTrack[trackId];
+        QMap<int, QPair<int, CuePointer> >& trackDupeHotcues =
+                dupe_hotcues[trackId];
+        int hotcueId = pQuery->value(hotcueIdColumn).toInt();
+        if (hotcueId != -1) {
+            if (trackDupeHotcues.contains(hotcueId)) {
+                m_cues.remove(trackDupeHotcues[hotcueId].first);
+                cues.removeOne(trackDupeHotcues[hotcueId].second);
             }
+            trackDupeHotcues[hotcueId] = qMakePair(cueId, pCue);
         }
-    } else {
+        if (pCue) {
+            cues.push_back(pCue);
+        }
+    }
+    return cuesByTrack;
+}
+
+QList<CuePointer> CueDAO::getCuesForTrack(TrackId trackId) const {
+    //qDebug() << "CueDAO::getCuesForTrack" << QThread::currentThread() << m_database.connectionName();
+    CachedSqlQuery query(m_database, "SELECT * FROM " CUE_TABLE " WHERE track_id = :id");
+    query.bindValue(":id", trackId.toVariant());
+    if (!query.exec()) {
         LOG_FAILED_QUERY(query);
+        return QList<CuePointer>();
     }
-    return cues;
+    return cuesFromQuery(&query).value(trackId);
+}
+
+QHash<TrackId, QList<CuePointer>> CueDAO::getCuesForTracks(
+        const QList<TrackId>& trackIds) const {
+    if (trackIds.isEmpty()) {
+        return QHash<TrackId, QList<CuePointer>>();
+    }
+    QStringList idList;
+    for (const auto& trackId: trackIds) {
+        idList << trackId.toString();
+    }
+
+    // The cues of each track in the same order as by getCuesForTrack()
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT * FROM " CUE_TABLE " WHERE track_id in (%1) "
+                          "ORDER BY track_id, id")
+                  .arg(idList.join(",")));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return QHash<TrackId, QList<CuePointer>>();
+    }
+    return cuesFromQuery(&query);
 }
 
 bool CueDAO::deleteCuesForTrack(TrackId trackId) {
     qDebug() << "CueDAO::deleteCuesForTrack" << QThread::currentThread() << m_database.connectionName();
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM " CUE_TABLE " WHERE track_id = :track_id");
+    CachedSqlQuery query(m_database,
+            "DELETE FROM " CUE_TABLE " WHERE track_id = :track_id");
     query.bindValue(":track_id", trackId.toVariant());
     if (query.exec()) {
         return true;
@@ -137,8 +168,8 @@ bool CueDAO::saveCue(Cue* cue) {
     }
     if (cue->getId() == -1) {
         // New cue
-        QSqlQuery query(m_database);
-        query.prepare("INSERT INTO " CUE_TABLE " (track_id, type, position, length, hotcue, label, color) VALUES (:track_id, :type, :position, :length, :hotcue, :label, :color)");
+        CachedSqlQuery query(m_database,
+                "INSERT INTO " CUE_TABLE " (track_id, type, position, length, hotcue, label, color) VALUES (:track_id, :type, :position, :length, :hotcue, :label, :color)");
         query.bindValue(":track_id", cue->getTrackId().toVariant());
         query.bindValue(":type", cue->getType());
         query.bindValue(":position", cue->getPosition());
@@ -156,16 +187,16 @@ bool CueDAO::saveCue(Cue* cue) {
         qDebug() << query.executedQuery() << query.lastError();
     } else {
         // Update cue
-        QSqlQuery query(m_database);
-        query.prepare("UPDATE " CUE_TABLE " SET "
-                        "track_id = :track_id,"
-                        "type = :type,"
-                        "position = :position,"
-                        "length = :length,"
-                        "hotcue = :hotcue,"
-                        "label = :label,"
-                        "color = :color"
-                        " WHERE id = :id");
+        CachedSqlQuery query(m_database,
+                "UPDATE " CUE_TABLE " SET "
+                "track_id = :track_id,"
+                "type = :type,"
+                "position = :position,"
+                "length = :length,"
+                "hotcue = :hotcue,"
+                "label = :label,"
+                "color = :color"
+                " WHERE id = :id");
         query.bindValue(":id", cue->getId());
         query.bindValue(":track_id", cue->getTrackId().toVariant());
         query.bindValue(":type", cue->getType());
@@ -188,8 +219,7 @@ bool CueDAO::saveCue(Cue* cue) {
 bool CueDAO::deleteCue(Cue* cue) {
     //qDebug() << "CueDAO::deleteCue" << QThread::currentThread() << m_database.connectionName();
     if (cue->getId() != -1) {
-        QSqlQuery query(m_database);
-        query.prepare("DELETE FROM " CUE_TABLE " WHERE id = :id");
+        CachedSqlQuery query(m_database, "DELETE FROM " CUE_TABLE " WHERE id = :id");
         query.bindValue(":id", cue->getId());
         if (query.exec()) {
             return true;
@@ -4,6 +4,7 @@
 #ifndef CUEDAO_H
 #define CUEDAO_H
 
+#include <QHash>
 #include <QMap>
 #include <QSqlDatabase>
 
@@ -25,6 +26,9 @@ class CueDAO : public DAO {
     int cueCount();
     int numCuesForTrack(TrackId trackId);
     QList<CuePointer> getCuesForTrack(TrackId trackId) const;
+    // The cues of many tracks at once, tracks without cues are omitted
+    QHash<TrackId, QList<CuePointer>> getCuesForTracks(
+            const QList<TrackId>& trackIds) const;
     bool deleteCuesForTrack(TrackId trackId);
     bool deleteCuesForTracks(const QList<TrackId>& trackIds);
     bool saveCue(Cue* cue);
@@ -34,6 +38,8 @@ class CueDAO : public DAO {
     void saveTrackCues(TrackId trackId, const QList<CuePointer>& cueList);
   private:
     CuePointer cueFromRow(const QSqlQuery& query) const;
+    // Reads the cues of all rows of an executed query
+    QHash<TrackId, QList<CuePointer>> cuesFromQuery(QSqlQuery* pQuery) const;
 
     QSqlDatabase m_database;
     mutable QMap<int, CuePointer> m_cues;
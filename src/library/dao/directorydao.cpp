@@ -106,7 +106,7 @@ QSet<TrackId> DirectoryDAO::relocateDirectory(const QString& oldFolder,
     // Also update information in the track_locations table. This is where mixxx
     // gets the location information for a track. Put marks around %1 so that
     // this also works on windows
-    query.prepare(QString("SELECT library.id, track_locations.id, track_locations.location "
+    query.prepare(QString("SELECT library.id "
                           "FROM library INNER JOIN track_locations ON "
                           "track_locations.id = library.location WHERE "
                           "track_locations.location LIKE '%1' ESCAPE '%2'")
@@ -117,26 +117,24 @@ QSet<TrackId> DirectoryDAO::relocateDirectory(const QString& oldFolder,
     }
 
     QSet<TrackId> trackIds;
-    QList<int> loc_ids;
-    QStringList old_locs;
     while (query.next()) {
         trackIds.insert(TrackId(query.value(0)));
-        loc_ids.append(query.value(1).toInt());
-        old_locs.append(query.value(2).toString());
     }
 
-    QString replacement = "UPDATE track_locations SET location = :newloc "
-            "WHERE id = :id";
-    query.prepare(replacement);
-    for (int i = 0; i < loc_ids.size(); ++i) {
-        QString newloc = old_locs.at(i);
-        newloc.replace(0, oldFolder.size(), newFolder);
-        query.bindValue("newloc", newloc);
-        query.bindValue("id", loc_ids.at(i));
-        if (!query.exec()) {
-            LOG_FAILED_QUERY(query) << "could not relocate path of tracks";
-            return QSet<TrackId>();
-        }
+    // Replace the old folder at the start of the paths of all tracks at once
+    query.prepare(QString("UPDATE track_locations SET "
+                          "location = :newFolder || substr(location, length(:oldFolder) + 1), "
+                          "directory = :newDirectory || substr(directory, length(:oldDirectory) + 1) "
+                          "WHERE location LIKE '%1' ESCAPE '%2'")
+                  .arg(startsWithOldFolder, kSqlLikeMatchAll));
+    // Each placeholder is only bound once
+    query.bindValue(":newFolder", newFolder);
+    query.bindValue(":oldFolder", oldFolder);
+    query.bindValue(":newDirectory", newFolder);
+    query.bindValue(":oldDirectory", oldFolder);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query) << "could not relocate path of tracks";
+        return QSet<TrackId>();
     }
 
     qDebug() << "Relocated tracks:" << trackIds.size();
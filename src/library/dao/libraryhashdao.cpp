@@ -26,6 +26,22 @@ QHash<QString, int> LibraryHashDAO::getDirectoryHashes() {
     return hashes;
 }
 
+QHash<QString, qint64> LibraryHashDAO::getDirectoryModifiedTimes() {
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT directory_path, directory_mtime FROM LibraryHashes "
+                  "WHERE directory_mtime<>0");
+    QHash<QString, qint64> modifiedTimes;
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+    while (query.next()) {
+        modifiedTimes.insert(query.value(0).toString(),
+                query.value(1).toLongLong());
+    }
+    return modifiedTimes;
+}
+
 int LibraryHashDAO::getDirectoryHash(const QString& dirPath) {
     //qDebug() << "LibraryHashDAO::getDirectoryHash" << QThread::currentThread() << m_database.connectionName();
     int hash = -1;
@@ -109,6 +125,25 @@ void LibraryHashDAO::updateDirectoryStatuses(const QStringList& dirPaths,
     }
 }
 
+void LibraryHashDAO::saveDirectoryHashes(
+        const QList<DirectoryHash>& directoryHashes) {
+    // Prepared once for all directories, which are usually written within
+    // the transaction of the scan
+    QSqlQuery query(m_database);
+    query.prepare("INSERT OR REPLACE INTO LibraryHashes "
+            "(directory_path, hash, directory_deleted, needs_verification, "
+            "directory_mtime) "
+            "VALUES (:directory_path, :hash, 0, 0, :directory_mtime)");
+    for (const auto& directoryHash : directoryHashes) {
+        query.bindValue(":directory_path", directoryHash.dirPath);
+        query.bindValue(":hash", directoryHash.hash);
+        query.bindValue(":directory_mtime", directoryHash.modifiedTime);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query) << "Saving dirhash failed.";
+        }
+    }
+}
+
 void LibraryHashDAO::markAsExisting(const QString& dirPath) {
     //qDebug() << "LibraryHashDAO::markExisting" << QThread::currentThread() << m_database.connectionName();
     QSqlQuery query(m_database);
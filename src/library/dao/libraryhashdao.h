@@ -3,11 +3,29 @@
 
 #include <QObject>
 #include <QHash>
+#include <QList>
 #include <QString>
 #include <QSqlDatabase>
 
 #include "library/dao/dao.h"
 
+struct DirectoryHash {
+    DirectoryHash()
+            : hash(0),
+              modifiedTime(0) {
+    }
+    DirectoryHash(const QString& dirPath, int hash, qint64 modifiedTime)
+            : dirPath(dirPath),
+              hash(hash),
+              modifiedTime(modifiedTime) {
+    }
+
+    QString dirPath;
+    int hash;
+    // In milliseconds since the epoch or 0 if unknown
+    qint64 modifiedTime;
+};
+
 class LibraryHashDAO : public DAO {
   public:
     ~LibraryHashDAO() override {}
@@ -17,10 +35,15 @@ class LibraryHashDAO : public DAO {
     };
 
     QHash<QString, int> getDirectoryHashes();
+    // Only contains the directories with a known modification time
+    QHash<QString, qint64> getDirectoryModifiedTimes();
     int getDirectoryHash(const QString& dirPath);
     void saveDirectoryHash(const QString& dirPath, const int hash);
     void updateDirectoryHash(const QString& dirPath, const int newHash,
                              const int dir_deleted);
+    // Inserts or replaces the hashes of directories that exist and have
+    // been verified
+    void saveDirectoryHashes(const QList<DirectoryHash>& directoryHashes);
     void markAsExisting(const QString& dirPath);
     void invalidateAllDirectories();
     void markUnverifiedDirectoriesAsDeleted();
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include <QtDebug>
 #include <QtSql>
 
@@ -6,8 +8,34 @@
 #include "library/queryutil.h"
 #include "library/trackcollection.h"
 #include "library/autodj/autodjprocessor.h"
+#include "util/assert.h"
+#include "util/db/cachedsqlquery.h"
 #include "util/math.h"
 
+#define PLAYLIST_POSITIONS_TABLE "temp_playlist_positions"
+
+namespace {
+
+// SQLite before version 3.8.8 does not accept more rows in a VALUES clause.
+// The values are inlined, so the limit for bound values does not apply.
+const int kMaxRowsPerStatement = 500;
+
+// Inserts rows that are formatted like "(1,2)" with as few statements
+// as possible
+bool insertRows(QSqlQuery* pQuery, const QString& insertInto,
+        const QStringList& rows) {
+    for (int first = 0; first < rows.size(); first += kMaxRowsPerStatement) {
+        if (!pQuery->exec(QString("%1 VALUES %2").arg(insertInto,
+                rows.mid(first, kMaxRowsPerStatement).join(",")))) {
+            LOG_FAILED_QUERY(*pQuery);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
 PlaylistDAO::PlaylistDAO()
         : m_pAutoDJProcessor(nullptr) {
 }
@@ -105,9 +133,9 @@ int PlaylistDAO::createUniquePlaylist(QString* pName, const HiddenType hidden) {
 QString PlaylistDAO::getPlaylistName(const int playlistId) const {
     //qDebug() << "PlaylistDAO::getPlaylistName" << QThread::currentThread() << m_database.connectionName();
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT name FROM Playlists "
-                  "WHERE id= :id");
+    CachedSqlQuery query(m_database,
+            "SELECT name FROM Playlists "
+            "WHERE id= :id");
     query.bindValue(":id", playlistId);
 
     if (!query.exec()) {
@@ -127,9 +155,9 @@ QString PlaylistDAO::getPlaylistName(const int playlistId) const {
 QList<TrackId> PlaylistDAO::getTrackIds(const int playlistId) const {
     QList<TrackId> trackIds;
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT DISTINCT track_id FROM PlaylistTracks "
-                  "WHERE playlist_id = :id");
+    CachedSqlQuery query(m_database,
+            "SELECT DISTINCT track_id FROM PlaylistTracks "
+            "WHERE playlist_id = :id");
     query.bindValue(":id", playlistId);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
@@ -146,8 +174,7 @@ QList<TrackId> PlaylistDAO::getTrackIds(const int playlistId) const {
 int PlaylistDAO::getPlaylistIdFromName(const QString& name) const {
     //qDebug() << "PlaylistDAO::getPlaylistIdFromName" << QThread::currentThread() << m_database.connectionName();
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT id FROM Playlists WHERE name = :name");
+    CachedSqlQuery query(m_database, "SELECT id FROM Playlists WHERE name = :name");
     query.bindValue(":name", name);
     if (query.exec()) {
         if (query.next()) {
@@ -200,8 +227,7 @@ void PlaylistDAO::deletePlaylist(const int playlistId) {
 }
 
 void PlaylistDAO::renamePlaylist(const int playlistId, const QString& newName) {
-    QSqlQuery query(m_database);
-    query.prepare("UPDATE Playlists SET name = :name WHERE id = :id");
+    CachedSqlQuery query(m_database, "UPDATE Playlists SET name = :name WHERE id = :id");
     query.bindValue(":name", newName);
     query.bindValue(":id", playlistId);
     if (!query.exec()) {
@@ -212,8 +238,8 @@ void PlaylistDAO::renamePlaylist(const int playlistId, const QString& newName) {
 }
 
 bool PlaylistDAO::setPlaylistLocked(const int playlistId, const bool locked) {
-    QSqlQuery query(m_database);
-    query.prepare("UPDATE Playlists SET locked = :lock WHERE id = :id");
+    CachedSqlQuery query(m_database,
+            "UPDATE Playlists SET locked = :lock WHERE id = :id");
     // SQLite3 doesn't support boolean value. Using integer instead.
     int lock = locked ? 1 : 0;
     query.bindValue(":lock", lock);
@@ -228,8 +254,7 @@ bool PlaylistDAO::setPlaylistLocked(const int playlistId, const bool locked) {
 }
 
 bool PlaylistDAO::isPlaylistLocked(const int playlistId) const {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT locked FROM Playlists WHERE id = :id");
+    CachedSqlQuery query(m_database, "SELECT locked FROM Playlists WHERE id = :id");
     query.bindValue(":id", playlistId);
 
     if (query.exec()) {
@@ -246,9 +271,9 @@ bool PlaylistDAO::isPlaylistLocked(const int playlistId) const {
 bool PlaylistDAO::removeTracksFromPlaylist(const int playlistId, const int startIndex) {
     // Retain the first track if it is loaded in a deck
     ScopedTransaction transaction(m_database);
-    QSqlQuery query(m_database);
-    query.prepare("DELETE FROM PlaylistTracks "
-                  "WHERE playlist_id=:id AND position>=:pos");
+    CachedSqlQuery query(m_database,
+            "DELETE FROM PlaylistTracks "
+            "WHERE playlist_id=:id AND position>=:pos");
     query.bindValue(":id", playlistId);
     query.bindValue(":pos", startIndex);
     if (!query.exec()) {
@@ -267,38 +292,17 @@ bool PlaylistDAO::appendTracksToPlaylist(const QList<TrackId>& trackIds, const i
     // Start the transaction
     ScopedTransaction transaction(m_database);
 
-    int position = getMaxPosition(playlistId);
-
     // Append after the last song. If no songs or a failed query then 0 becomes 1.
-    ++position;
-
-    //Insert the song into the PlaylistTracks table
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO PlaylistTracks (playlist_id, track_id, position, pl_datetime_added)"
-                  "VALUES (:playlist_id, :track_id, :position, CURRENT_TIMESTAMP)");
-    query.bindValue(":playlist_id", playlistId);
-
+    const int position = getMaxPosition(playlistId) + 1;
 
-    int insertPosition = position;
-    for (const auto& trackId: trackIds) {
-        query.bindValue(":track_id", trackId.toVariant());
-        query.bindValue(":position", insertPosition++);
-        if (!query.exec()) {
-            LOG_FAILED_QUERY(query);
-            return false;
-        }
+    if (!insertTracksAtPosition(playlistId, trackIds, position)) {
+        return false;
     }
 
     // Commit the transaction
     transaction.commit();
 
-    insertPosition = position;
-    for (const auto& trackId: trackIds) {
-        m_playlistsTrackIsIn.insert(trackId, playlistId);
-        // TODO(XXX) don't emit if the track didn't add successfully.
-        emit(trackAdded(playlistId, trackId, insertPosition++));
-    }
-    emit(changed(playlistId));
+    notifyTracksAdded(playlistId, trackIds, position);
     return true;
 }
 
@@ -311,8 +315,7 @@ bool PlaylistDAO::appendTrackToPlaylist(TrackId trackId, const int playlistId) {
 /** Find out how many playlists exist. */
 unsigned int PlaylistDAO::playlistCount() const {
     // qDebug() << "PlaylistDAO::playlistCount" << QThread::currentThread() << m_database.connectionName();
-    QSqlQuery query(m_database);
-    query.prepare("SELECT count(*) as count FROM Playlists");
+    CachedSqlQuery query(m_database, "SELECT count(*) as count FROM Playlists");
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
     }
@@ -328,8 +331,7 @@ int PlaylistDAO::getPlaylistId(const int index) const {
     //qDebug() << "PlaylistDAO::getPlaylistId"
     //         << QThread::currentThread() << m_database.connectionName();
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT id FROM Playlists");
+    CachedSqlQuery query(m_database, "SELECT id FROM Playlists");
 
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
@@ -350,8 +352,7 @@ PlaylistDAO::HiddenType PlaylistDAO::getHiddenType(const int playlistId) const {
     // qDebug() << "PlaylistDAO::getHiddenType"
     //          << QThread::currentThread() << m_database.connectionName();
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT hidden FROM Playlists WHERE id = :id");
+    CachedSqlQuery query(m_database, "SELECT hidden FROM Playlists WHERE id = :id");
     query.bindValue(":id", playlistId);
 
     if (query.exec()) {
@@ -405,214 +406,268 @@ void PlaylistDAO::removeHiddenTracks(const int playlistId) {
         return;
     }
 
+    QList<int> positions;
     while (query.next()) {
-    	int position = query.value(query.record().indexOf("position")).toInt();
-    	removeTracksFromPlaylistInner(playlistId, position);
+        positions.append(query.value(query.record().indexOf("position")).toInt());
     }
 
+    QList<TrackId> removedTrackIds;
+    QList<int> removedPositions;
+    if (!removeTracksAtPositions(playlistId, positions, &removedTrackIds,
+            &removedPositions)) {
+        return;
+    }
     transaction.commit();
-    emit(changed(playlistId));
+    notifyTracksRemoved(playlistId, removedTrackIds, removedPositions);
 }
 
 
 void PlaylistDAO::removeTrackFromPlaylist(const int playlistId, const TrackId& trackId) {
     ScopedTransaction transaction(m_database);
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT position FROM PlaylistTracks WHERE playlist_id=:id "
-                "AND track_id=:track_id");
-    query.bindValue(":id", playlistId);
-    query.bindValue(":track_id", trackId.toVariant());
-
-    query.setForwardOnly(true);
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
+    QList<TrackId> removedTrackIds;
+    QList<int> removedPositions;
+    if (!removeTracksAtPositions(playlistId,
+            getPositionsOfTracks(playlistId, QList<TrackId>() << trackId),
+            &removedTrackIds, &removedPositions)) {
         return;
     }
 
-    while (query.next()) {
-    	int position = query.value(query.record().indexOf("position")).toInt();
-        removeTracksFromPlaylistInner(playlistId, position);
-
-    }
-
     transaction.commit();
-    emit(changed(playlistId));
+    notifyTracksRemoved(playlistId, removedTrackIds, removedPositions);
 }
 
 
 void PlaylistDAO::removeTrackFromPlaylist(const int playlistId, const int position) {
-    // qDebug() << "PlaylistDAO::removeTrackFromPlaylist"
-    //          << QThread::currentThread() << m_database.connectionName();
-    ScopedTransaction transaction(m_database);
-    removeTracksFromPlaylistInner(playlistId, position);
-    transaction.commit();
-    emit(changed(playlistId));
+    QList<int> positions;
+    positions.append(position);
+    removeTracksFromPlaylist(playlistId, positions);
 }
 
 void PlaylistDAO::removeTracksFromPlaylist(const int playlistId, QList<int>& positions) {
-    // get positions in reversed order
-    qSort(positions.begin(), positions.end(), qGreater<int>());
-
     //qDebug() << "PlaylistDAO::removeTrackFromPlaylist"
     //         << QThread::currentThread() << m_database.connectionName();
     ScopedTransaction transaction(m_database);
-    QSqlQuery query(m_database);
-    foreach (int position , positions) {
-    	removeTracksFromPlaylistInner(playlistId, position);
+    QList<TrackId> removedTrackIds;
+    QList<int> removedPositions;
+    if (!removeTracksAtPositions(playlistId, positions, &removedTrackIds,
+            &removedPositions)) {
+        return;
     }
     transaction.commit();
-    emit(changed(playlistId));
+    notifyTracksRemoved(playlistId, removedTrackIds, removedPositions);
 }
 
-void PlaylistDAO::removeTracksFromPlaylistInner(int playlistId, int position) {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT track_id FROM PlaylistTracks WHERE playlist_id=:id "
-                  "AND position=:position");
-    query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
+bool PlaylistDAO::insertTrackIntoPlaylist(TrackId trackId, const int playlistId, int position) {
+    if (!trackId.isValid()) {
+        return false;
+    }
+    return insertTracksIntoPlaylist(
+            QList<TrackId>() << trackId, playlistId, position) > 0;
+}
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-        return;
+int PlaylistDAO::insertTracksIntoPlaylist(const QList<TrackId>& trackIds,
+                                          const int playlistId, int position) {
+    if (playlistId < 0 || position < 0) {
+        return 0;
     }
 
-    if (!query.next()) {
-        qDebug() << "removeTrackFromPlaylist no track exists at position:"
-                 << position << "in playlist:" << playlistId;
-        return;
+    QList<TrackId> validTrackIds;
+    for (const auto& trackId: trackIds) {
+        if (trackId.isValid()) {
+            validTrackIds.append(trackId);
+        }
     }
-    TrackId trackId(query.value(query.record().indexOf("track_id")));
 
-    // Delete the track from the playlist.
-    query.prepare("DELETE FROM PlaylistTracks "
-                  "WHERE playlist_id=:id AND position= :position");
-    query.bindValue(":id", playlistId);
-    query.bindValue(":position", position);
+    ScopedTransaction transaction(m_database);
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-        return;
+    int max_position = getMaxPosition(playlistId) + 1;
+
+    if (position > max_position) {
+        position = max_position;
     }
 
-    QString queryString;
-    queryString = QString("UPDATE PlaylistTracks SET position=position-1 "
-                          "WHERE position>=%1 AND "
-                          "playlist_id=%2").arg(QString::number(position),
-                                                QString::number(playlistId));
-    if (!query.exec(queryString)) {
-        LOG_FAILED_QUERY(query);
+    if (!insertTracksAtPosition(playlistId, validTrackIds, position)) {
+        return 0;
     }
 
-    m_playlistsTrackIsIn.remove(trackId, playlistId);
-    emit(trackRemoved(playlistId, trackId, position));
-}
+    transaction.commit();
 
+    notifyTracksAdded(playlistId, validTrackIds, position);
+    return validTrackIds.size();
+}
 
+bool PlaylistDAO::insertTracksAtPosition(const int playlistId,
+        const QList<TrackId>& trackIds, const int position) {
+    if (trackIds.isEmpty()) {
+        return true;
+    }
 
-bool PlaylistDAO::insertTrackIntoPlaylist(TrackId trackId, const int playlistId, int position) {
-    if (playlistId < 0 || !trackId.isValid() || position < 0)
+    // Move all tracks behind the insert position at once
+    CachedSqlQuery query(m_database,
+            "UPDATE PlaylistTracks SET position=position+:count "
+            "WHERE playlist_id=:id AND position>=:position");
+    query.bindValue(":count", trackIds.size());
+    query.bindValue(":id", playlistId);
+    query.bindValue(":position", position);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
         return false;
+    }
 
-    ScopedTransaction transaction(m_database);
+    QStringList rows;
+    int insertPosition = position;
+    for (const auto& trackId: trackIds) {
+        rows.append(QString("(%1,%2,%3,CURRENT_TIMESTAMP)").arg(
+                QString::number(playlistId),
+                trackId.toString(),
+                QString::number(insertPosition++)));
+    }
+    return insertRows(&query,
+            "INSERT INTO PlaylistTracks "
+            "(playlist_id, track_id, position, pl_datetime_added)",
+            rows);
+}
 
-    int max_position = getMaxPosition(playlistId) + 1;
+bool PlaylistDAO::removeTracksAtPositions(const int playlistId,
+        QList<int> positions, QList<TrackId>* pRemovedTrackIds,
+        QList<int>* pRemovedPositions) {
+    DEBUG_ASSERT(pRemovedTrackIds);
+    DEBUG_ASSERT(pRemovedPositions);
+    qSort(positions);
+    positions.erase(std::unique(positions.begin(), positions.end()),
+            positions.end());
+    if (positions.isEmpty()) {
+        return true;
+    }
+    const int maxPosition = getMaxPosition(playlistId);
 
-    if (position > max_position) {
-        position = max_position;
+    QSqlQuery query(m_database);
+    for (int first = 0; first < positions.size();
+            first += kMaxRowsPerStatement) {
+        QStringList positionList;
+        for (int position : positions.mid(first, kMaxRowsPerStatement)) {
+            positionList.append(QString::number(position));
+        }
+        const QString condition = QString(
+                "WHERE playlist_id=%1 AND position IN (%2)").arg(
+                        QString::number(playlistId), positionList.join(","));
+        if (!query.exec("SELECT track_id, position FROM PlaylistTracks " +
+                condition + " ORDER BY position")) {
+            LOG_FAILED_QUERY(query);
+            return false;
+        }
+        while (query.next()) {
+            pRemovedTrackIds->append(TrackId(query.value(0)));
+            pRemovedPositions->append(query.value(1).toInt());
+        }
+        if (!query.exec("DELETE FROM PlaylistTracks " + condition)) {
+            LOG_FAILED_QUERY(query);
+            return false;
+        }
+    }
+
+    // Close the gaps between the remaining tracks
+    QHash<int, int> newPositions;
+    int removedCount = 0;
+    auto removedPosition = positions.constBegin();
+    for (int position = positions.first(); position <= maxPosition; ++position) {
+        if (removedPosition != positions.constEnd() &&
+                *removedPosition == position) {
+            ++removedCount;
+            ++removedPosition;
+        } else {
+            newPositions.insert(position, position - removedCount);
+        }
     }
+    return updatePositions(playlistId, newPositions);
+}
 
-    // Move all the tracks in the playlist up by one
-    QString queryString =
-            QString("UPDATE PlaylistTracks SET position=position+1 "
-                    "WHERE position>=%1 AND "
-                    "playlist_id=%2").arg(QString::number(position),
-                                          QString::number(playlistId));
+bool PlaylistDAO::updatePositions(const int playlistId,
+        const QHash<int, int>& newPositions) {
+    if (newPositions.isEmpty()) {
+        return true;
+    }
 
+    // The new positions are joined from a temporary table, which only
+    // lives as long as the connection
     QSqlQuery query(m_database);
-    if (!query.exec(queryString)) {
+    if (!query.exec("CREATE TEMP TABLE IF NOT EXISTS " PLAYLIST_POSITIONS_TABLE
+                    " (old_position INTEGER PRIMARY KEY, new_position INTEGER)") ||
+            !query.exec("DELETE FROM " PLAYLIST_POSITIONS_TABLE)) {
         LOG_FAILED_QUERY(query);
         return false;
     }
+    QStringList rows;
+    for (auto it = newPositions.constBegin(); it != newPositions.constEnd(); ++it) {
+        rows.append(QString("(%1,%2)").arg(
+                QString::number(it.key()), QString::number(it.value())));
+    }
+    if (!insertRows(&query,
+            "INSERT INTO " PLAYLIST_POSITIONS_TABLE " (old_position, new_position)",
+            rows)) {
+        return false;
+    }
 
-    //Insert the song into the PlaylistTracks table
-    query.prepare("INSERT INTO PlaylistTracks (playlist_id, track_id, position, pl_datetime_added)"
-                  "VALUES (:playlist_id, :track_id, :position, CURRENT_TIMESTAMP)");
-    query.bindValue(":playlist_id", playlistId);
-    query.bindValue(":track_id", trackId.toVariant());
-    query.bindValue(":position", position);
-
+    query.prepare("UPDATE PlaylistTracks SET position=("
+                  "SELECT new_position FROM " PLAYLIST_POSITIONS_TABLE " "
+                  "WHERE old_position=PlaylistTracks.position) "
+                  "WHERE playlist_id=:id AND position IN ("
+                  "SELECT old_position FROM " PLAYLIST_POSITIONS_TABLE ")");
+    query.bindValue(":id", playlistId);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
         return false;
     }
-    transaction.commit();
-
-    m_playlistsTrackIsIn.insert(trackId, playlistId);
-    emit(trackAdded(playlistId, trackId, position));
-    emit(changed(playlistId));
     return true;
 }
 
-int PlaylistDAO::insertTracksIntoPlaylist(const QList<TrackId>& trackIds,
-                                          const int playlistId, int position) {
-    if (playlistId < 0 || position < 0) {
-        return 0;
-    }
-
-    int tracksAdded = 0;
-    ScopedTransaction transaction(m_database);
-
-    int max_position = getMaxPosition(playlistId) + 1;
-
-    if (position > max_position) {
-        position = max_position;
-    }
-
-    QSqlQuery insertQuery(m_database);
-    insertQuery.prepare("INSERT INTO PlaylistTracks (playlist_id, track_id, position)"
-                        "VALUES (:playlist_id, :track_id, :position)");
+QList<int> PlaylistDAO::getPositionsOfTracks(const int playlistId,
+        const QList<TrackId>& trackIds) const {
+    QList<int> positions;
     QSqlQuery query(m_database);
-    int insertPositon = position;
-    for (const auto& trackId: trackIds) {
-        if (!trackId.isValid()) {
-            continue;
+    query.setForwardOnly(true);
+    for (int first = 0; first < trackIds.size();
+            first += kMaxRowsPerStatement) {
+        QStringList idList;
+        for (const auto& trackId : trackIds.mid(first, kMaxRowsPerStatement)) {
+            idList.append(trackId.toString());
         }
-        // Move all tracks in playlist up by 1.
-        // TODO(XXX) We could do this in one query before the for loop.
-        query.prepare(QString("UPDATE PlaylistTracks SET position=position+1 "
-                              "WHERE position>=%1 AND "
-                              "playlist_id=%2").arg(insertPositon).arg(playlistId));
-
-        if (!query.exec()) {
+        if (!query.exec(QString("SELECT position FROM PlaylistTracks "
+                "WHERE playlist_id=%1 AND track_id IN (%2)").arg(
+                        QString::number(playlistId), idList.join(",")))) {
             LOG_FAILED_QUERY(query);
             continue;
         }
-
-        // Insert the track at the given position
-        insertQuery.bindValue(":playlist_id", playlistId);
-        insertQuery.bindValue(":track_id", trackId.toVariant());
-        insertQuery.bindValue(":position", insertPositon);
-        if (!insertQuery.exec()) {
-            LOG_FAILED_QUERY(insertQuery);
-            continue;
+        while (query.next()) {
+            positions.append(query.value(0).toInt());
         }
-
-        // Increment the insert position for the track.
-        ++insertPositon;
-        ++tracksAdded;
     }
+    return positions;
+}
 
-    transaction.commit();
-
-    insertPositon = position;
+void PlaylistDAO::notifyTracksAdded(const int playlistId,
+        const QList<TrackId>& trackIds, const int position) {
     for (const auto& trackId: trackIds) {
         m_playlistsTrackIsIn.insert(trackId, playlistId);
-        // TODO(XXX) The position is wrong if any track failed to insert.
-        emit(trackAdded(playlistId, trackId, insertPositon++));
+    }
+    if (!trackIds.isEmpty()) {
+        emit(tracksAdded(playlistId, trackIds));
+        emit(tracksInserted(playlistId, position, trackIds));
+    }
+    emit(changed(playlistId));
+}
+
+void PlaylistDAO::notifyTracksRemoved(const int playlistId,
+        const QList<TrackId>& trackIds, const QList<int>& positions) {
+    for (const auto& trackId: trackIds) {
+        m_playlistsTrackIsIn.remove(trackId, playlistId);
+    }
+    if (!trackIds.isEmpty()) {
+        emit(tracksRemoved(playlistId, trackIds));
+        emit(positionsRemoved(playlistId, positions));
     }
     emit(changed(playlistId));
-    return tracksAdded;
 }
 
 void PlaylistDAO::addPlaylistToAutoDJQueue(const int playlistId, const bool bTop) {
@@ -620,9 +675,9 @@ void PlaylistDAO::addPlaylistToAutoDJQueue(const int playlistId, const bool bTop
 
     // Query the PlaylistTracks database to locate tracks in the selected
     // playlist. Tracks are automatically sorted by position.
-    QSqlQuery query(m_database);
-    query.prepare("SELECT track_id FROM PlaylistTracks "
-                  "WHERE playlist_id = :plid ORDER BY position ASC");
+    CachedSqlQuery query(m_database,
+            "SELECT track_id FROM PlaylistTracks "
+            "WHERE playlist_id = :plid ORDER BY position ASC");
     query.bindValue(":plid", playlistId);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
@@ -653,9 +708,9 @@ void PlaylistDAO::addTracksToAutoDJQueue(const QList<TrackId>& trackIds, const b
 int PlaylistDAO::getPreviousPlaylist(const int currentPlaylistId, HiddenType hidden) const {
     // Find out the highest position existing in the playlist so we know what
     // position this track should have.
-    QSqlQuery query(m_database);
-    query.prepare("SELECT max(id) as id FROM Playlists "
-                  "WHERE id < :id AND hidden = :hidden");
+    CachedSqlQuery query(m_database,
+            "SELECT max(id) as id FROM Playlists "
+            "WHERE id < :id AND hidden = :hidden");
     query.bindValue(":id", currentPlaylistId);
     query.bindValue(":hidden", hidden);
 
@@ -700,10 +755,10 @@ bool PlaylistDAO::copyPlaylistTracks(const int sourcePlaylistID, const int targe
         return false;
     }
 
-    // Query each added track and its new position.
-    // SELECT track_id, position FROM PlaylistTracks WHERE playlist_id = :target_plid AND position > :position_offset;
-    query.prepare(QString("SELECT %2, %3 FROM " PLAYLIST_TRACKS_TABLE
-        " WHERE %1 = :target_plid AND %3 > :position_offset")
+    // Query each added track in the order of its new position.
+    // SELECT track_id FROM PlaylistTracks WHERE playlist_id = :target_plid AND position > :position_offset ORDER BY position;
+    query.prepare(QString("SELECT %2 FROM " PLAYLIST_TRACKS_TABLE
+        " WHERE %1 = :target_plid AND %3 > :position_offset ORDER BY %3")
         .arg(PLAYLISTTRACKSTABLE_PLAYLISTID)    // %1
         .arg(PLAYLISTTRACKSTABLE_TRACKID)       // %2
         .arg(PLAYLISTTRACKSTABLE_POSITION));    // %3
@@ -717,23 +772,21 @@ bool PlaylistDAO::copyPlaylistTracks(const int sourcePlaylistID, const int targe
     // Commit the transaction
     transaction.commit();
 
-    // Let subscribers know about each added track.
+    // Let subscribers know about all added tracks at once.
+    QList<TrackId> copiedTrackIds;
     while (query.next()) {
-        TrackId copiedTrackId(query.value(0));
-        int copiedPosition = query.value(1).toInt();
-        m_playlistsTrackIsIn.insert(copiedTrackId, targetPlaylistID);
-        emit(trackAdded(targetPlaylistID, copiedTrackId, copiedPosition));
+        copiedTrackIds.append(TrackId(query.value(0)));
     }
-    emit(changed(targetPlaylistID));
+    notifyTracksAdded(targetPlaylistID, copiedTrackIds, positionOffset + 1);
     return true;
 }
 
 int PlaylistDAO::getMaxPosition(const int playlistId) const {
     // Find out the highest position existing in the playlist so we know what
     // position this track should have.
-    QSqlQuery query(m_database);
-    query.prepare("SELECT max(position) as position FROM PlaylistTracks "
-                  "WHERE playlist_id = :id");
+    CachedSqlQuery query(m_database,
+            "SELECT max(position) as position FROM PlaylistTracks "
+            "WHERE playlist_id = :id");
     query.bindValue(":id", playlistId);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
@@ -748,22 +801,33 @@ int PlaylistDAO::getMaxPosition(const int playlistId) const {
 }
 
 void PlaylistDAO::removeTracksFromPlaylists(const QList<TrackId>& trackIds) {
-    // copy the hash, because there is no guarantee that "it" is valid after remove
-    QMultiHash<TrackId, int> playlistsTrackIsInCopy = m_playlistsTrackIsIn;
+    // Each playlist is updated only once for all of its tracks
+    QHash<int, QList<TrackId>> trackIdsByPlaylist;
     for (const auto& trackId: trackIds) {
-        for (auto it = playlistsTrackIsInCopy.constBegin();
-                it != playlistsTrackIsInCopy.constEnd(); ++it) {
-            if (it.key() == trackId) {
-                removeTrackFromPlaylist(it.value(), trackId);
-            }
+        for (int playlistId : m_playlistsTrackIsIn.values(trackId)) {
+            trackIdsByPlaylist[playlistId].append(trackId);
         }
     }
+    for (auto it = trackIdsByPlaylist.constBegin();
+            it != trackIdsByPlaylist.constEnd(); ++it) {
+        const int playlistId = it.key();
+        ScopedTransaction transaction(m_database);
+        QList<TrackId> removedTrackIds;
+        QList<int> removedPositions;
+        if (!removeTracksAtPositions(playlistId,
+                getPositionsOfTracks(playlistId, it.value()),
+                &removedTrackIds, &removedPositions)) {
+            continue;
+        }
+        transaction.commit();
+        notifyTracksRemoved(playlistId, removedTrackIds, removedPositions);
+    }
 }
 
 int PlaylistDAO::tracksInPlaylist(const int playlistId) const {
-    QSqlQuery query(m_database);
-    query.prepare("SELECT COUNT(id) AS count FROM PlaylistTracks "
-                  "WHERE playlist_id = :playlist_id");
+    CachedSqlQuery query(m_database,
+            "SELECT COUNT(id) AS count FROM PlaylistTracks "
+            "WHERE playlist_id = :playlist_id");
     query.bindValue(":playlist_id", playlistId);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query) << "Couldn't get the number of tracks in playlist"
@@ -828,6 +892,8 @@ void PlaylistDAO::moveTrack(const int playlistId, const int oldPosition, const i
     // Print out any SQL error, if there was one.
     if (query.lastError().isValid()) {
         qDebug() << query.lastError();
+    } else {
+        emit(trackMoved(playlistId, oldPosition, newPosition));
     }
 
     emit(changed(playlistId));
@@ -854,12 +920,17 @@ void PlaylistDAO::searchForDuplicateTrack(const int fromPosition,
 
 void PlaylistDAO::shuffleTracks(const int playlistId, const QList<int>& positions, const QHash<int,TrackId>& allIds) {
     ScopedTransaction transaction(m_database);
-    QSqlQuery query(m_database);
 
     int seed = QDateTime::currentDateTime().toTime_t();
     qsrand(seed);
     QHash<int,TrackId> trackPositionIds = allIds;
     QList<int> newPositions = positions;
+    // The original position of the track at each position, so that all
+    // swaps are written with a single update
+    QHash<int, int> originalPositions;
+    for (int position : positions) {
+        originalPositions.insert(position, position);
+    }
     const int searchDistance = math_max(trackPositionIds.count() / 4, 1);
 
     qDebug() << "Shuffling Tracks";
@@ -977,20 +1048,21 @@ void PlaylistDAO::shuffleTracks(const int playlistId, const QList<int>& position
         trackPositionIds.insert(trackBPosition, trackAId);
         newPositions.swap(newPositions.indexOf(trackAPosition),
                           newPositions.indexOf(trackBPosition));
-        QString swapQuery = "UPDATE PlaylistTracks SET position=%1 "
-                "WHERE position=%2 AND playlist_id=%3";
-        query.exec(swapQuery.arg(QString::number(-1),
-                                 QString::number(trackAPosition),
-                                 QString::number(playlistId)));
-        query.exec(swapQuery.arg(QString::number(trackAPosition),
-                                 QString::number(trackBPosition),
-                                 QString::number(playlistId)));
-        query.exec(swapQuery.arg(QString::number(trackBPosition),
-                                 QString::number(-1),
-                                 QString::number(playlistId)));
-
-        if (query.lastError().isValid())
-            qDebug() << query.lastError();
+        const int originalAPosition = originalPositions.value(trackAPosition);
+        originalPositions.insert(trackAPosition,
+                originalPositions.value(trackBPosition));
+        originalPositions.insert(trackBPosition, originalAPosition);
+    }
+
+    QHash<int, int> shuffledPositions;
+    for (auto it = originalPositions.constBegin();
+            it != originalPositions.constEnd(); ++it) {
+        if (it.key() != it.value()) {
+            shuffledPositions.insert(it.value(), it.key());
+        }
+    }
+    if (!updatePositions(playlistId, shuffledPositions)) {
+        return;
     }
 
     transaction.commit();
@@ -125,14 +125,44 @@ class PlaylistDAO : public QObject, public virtual DAO {
     void added(int playlistId);
     void deleted(int playlistId);
     void changed(int playlistId);
-    void trackAdded(int playlistId, TrackId trackId, int position);
-    void trackRemoved(int playlistId, TrackId trackId, int position);
+    // Emitted once per operation with all tracks that have been added to
+    // or removed from the playlist
+    void tracksAdded(int playlistId, const QList<TrackId>& trackIds);
+    void tracksRemoved(int playlistId, const QList<TrackId>& trackIds);
+    // Emitted before changed() with the positions of an operation, so that
+    // a model of the playlist can patch its rows instead of selecting them
+    // again: the tracks that have been inserted at consecutive positions
+    // from position on, the ascending positions of the tracks that have
+    // been removed before the gaps were closed, and a track that has been
+    // moved.
+    void tracksInserted(int playlistId, int position,
+                        const QList<TrackId>& trackIds);
+    void positionsRemoved(int playlistId, const QList<int>& positions);
+    void trackMoved(int playlistId, int oldPosition, int newPosition);
     void renamed(int playlistId, QString a_strName);
     void lockChanged(int playlistId);
 
   private:
     bool removeTracksFromPlaylist(const int playlistId, const int startIndex);
-    void removeTracksFromPlaylistInner(int playlistId, int position);
+    // The following functions modify the playlist with a few set-based
+    // statements within the current transaction and neither update the
+    // membership cache nor emit any signals.
+    bool insertTracksAtPosition(const int playlistId,
+            const QList<TrackId>& trackIds, const int position);
+    bool removeTracksAtPositions(const int playlistId, QList<int> positions,
+            QList<TrackId>* pRemovedTrackIds, QList<int>* pRemovedPositions);
+    // Moves the tracks from the positions of the keys to the positions of
+    // the values
+    bool updatePositions(const int playlistId,
+            const QHash<int, int>& newPositions);
+    QList<int> getPositionsOfTracks(const int playlistId,
+            const QList<TrackId>& trackIds) const;
+
+    void notifyTracksAdded(const int playlistId,
+            const QList<TrackId>& trackIds, const int position);
+    void notifyTracksRemoved(const int playlistId,
+            const QList<TrackId>& trackIds, const QList<int>& positions);
+
     void searchForDuplicateTrack(const int fromPosition,
                                  const int toPosition,
                                  TrackId trackID,
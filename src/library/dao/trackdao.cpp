@@ -9,10 +9,15 @@
 #include <QRegExp>
 #include <QCoreApplication>
 #include <QChar>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <vector>
 
 #include "sources/soundsourceproxy.h"
 #include "track/track.h"
 #include "library/queryutil.h"
+#include "util/db/cachedsqlquery.h"
 #include "util/db/sqlstringformatter.h"
 #include "util/db/sqllikewildcards.h"
 #include "util/db/sqllikewildcardescaper.h"
@@ -51,7 +56,13 @@ TrackDAO::TrackDAO(CueDAO& cueDao,
           m_pConfig(pConfig),
           m_trackLocationIdColumn(UndefinedRecordIndex),
           m_queryLibraryIdColumn(UndefinedRecordIndex),
-          m_queryLibraryMixxxDeletedColumn(UndefinedRecordIndex) {
+          m_queryLibraryMixxxDeletedColumn(UndefinedRecordIndex),
+          m_multiRowInsertRowCount(0),
+          m_metadataExportQueue([](TrackId trackId) {
+              return TrackCache::instance().isCached(trackId);
+          }) {
+    connect(&m_metadataExportQueue, SIGNAL(exported()),
+            this, SLOT(slotTrackMetadataExported()));
 }
 
 TrackDAO::~TrackDAO() {
@@ -63,6 +74,11 @@ TrackDAO::~TrackDAO() {
 void TrackDAO::finish() {
     qDebug() << "TrackDAO::finish()";
 
+    // Write the pending metadata into the files and store that they are
+    // synchronized before the database is detached
+    m_metadataExportQueue.flush();
+    slotTrackMetadataExported();
+
     // clear out played information on exit
     // crash prevention: if mixxx crashes, played information will be maintained
     qDebug() << "Clearing played information for this session";
@@ -98,8 +114,8 @@ TrackId TrackDAO::getTrackId(const QString& absoluteFilePath) {
 
     TrackId trackId;
 
-    QSqlQuery query(m_database);
-    query.prepare("SELECT library.id FROM library INNER JOIN track_locations ON library.location = track_locations.id WHERE track_locations.location=:location");
+    CachedSqlQuery query(m_database,
+            "SELECT library.id FROM library INNER JOIN track_locations ON library.location = track_locations.id WHERE track_locations.location=:location");
     query.bindValue(":location", absoluteFilePath);
     if (query.exec()) {
         if (query.next()) {
@@ -143,9 +159,9 @@ QList<TrackId> TrackDAO::getTrackIds(const QList<QFileInfo>& files) {
 
 QSet<QString> TrackDAO::getTrackLocations() {
     QSet<QString> locations;
-    QSqlQuery query(m_database);
-    query.prepare("SELECT track_locations.location FROM track_locations "
-                  "INNER JOIN library on library.location = track_locations.id");
+    CachedSqlQuery query(m_database,
+            "SELECT track_locations.location FROM track_locations "
+            "INNER JOIN library on library.location = track_locations.id");
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
     }
@@ -196,16 +212,16 @@ void TrackDAO::saveTrack(TrackCacheLocker* pCacheLocker, Track* pTrack) {
 
         // Write audio meta data, if enabled in the preferences.
         //
-        // This must be done before updating the database, because
-        // a timestamp is used to keep track of when metadata has been
-        // last synchronized. Exporting metadata will update this time
-        // stamp on the track object!
+        // This only takes the metadata that is written into the file
+        // later by the queue, so the file is not accessed while the track
+        // cache is locked. The metadata is normalized for the export before
+        // updating the database.
         if (m_pConfig && m_pConfig->getValueString(ConfigKey("[Library]","SyncTrackMetadataExport")).toInt() == 1) {
-            SoundSourceProxy::exportTrackMetadataBeforeSaving(pTrack);
+            m_metadataExportQueue.enqueue(pTrack);
         }
 
         // The track cache can safely be unlocked now that the metadata has
-        // been exported to the file. Updating the database is thread-safe
+        // been taken for the export. Updating the database is thread-safe
         // an we accept this very small chance of a race condition here.
         // Exporting metadata to a file cannot be rolled back if updating
         // the database fails, so we have to account for inconsistencies
@@ -269,6 +285,27 @@ void TrackDAO::slotTrackClean(Track* pTrack) {
     }
 }
 
+void TrackDAO::slotTrackMetadataExported() {
+    const QList<TrackId> trackIds = m_metadataExportQueue.takeExportedTrackIds();
+    if (trackIds.isEmpty() || !m_database.isOpen()) {
+        return;
+    }
+    // The tracks have been saved before their metadata was exported
+    CachedSqlQuery query(m_database, "UPDATE library SET header_parsed=1 WHERE id=:id");
+    for (const auto& trackId: trackIds) {
+        query.bindValue(":id", trackId.toVariant());
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+        }
+        // A track that has been loaded again meanwhile would store the
+        // outdated flag when saved
+        TrackPointer pTrack = TrackCache::instance().lookupById(trackId).getTrack();
+        if (pTrack) {
+            pTrack->setMetadataSynchronized(true);
+        }
+    }
+}
+
 void TrackDAO::databaseTrackAdded(TrackPointer pTrack) {
     emit(dbTrackAdded(pTrack));
 }
@@ -303,7 +340,120 @@ void TrackDAO::slotTrackChanged(Track* pTrack) {
     }
 }
 
-void TrackDAO::addTracksPrepare() {
+namespace {
+
+// The columns of the inserts apart from the id, which is only bound by
+// the multi-row inserts of insertNewTracks()
+const QStringList kTrackLocationInsertColumns = {
+        "location", "directory", "filename", "filesize", "fs_deleted",
+        "needs_verification"};
+const QStringList kLibraryInsertColumns = {
+        "artist", "title", "album", "album_artist", "year", "genre",
+        "tracknumber", "tracktotal", "composer", "grouping", "filetype",
+        "location", "comment", "url", "duration", "rating", "key",
+        "key_id", "bitrate", "samplerate", "cuepoint", "bpm",
+        "replaygain", "replaygain_peak", "wavesummaryhex", "timesplayed",
+        "channels", "mixxx_deleted", "header_parsed",
+        "beats_version", "beats_sub_version", "beats", "bpm_lock",
+        "keys_version", "keys_sub_version", "keys",
+        "coverart_source", "coverart_type", "coverart_location",
+        "coverart_hash"};
+
+// The default limit of SQLite for the number of values that are bound
+// to a statement
+const int kMaxBoundValuesPerStatement = 999;
+
+// The tracks that are inserted by a multi-row insert
+const int kMaxRowsPerInsert = kMaxBoundValuesPerStatement /
+        (kLibraryInsertColumns.size() + 1);
+
+// Returns the placeholders of the values of a row, e.g. "(:a_1,:b_1)"
+QString insertPlaceholders(const QStringList& columns, const QString& suffix) {
+    QStringList placeholders;
+    for (const auto& column : columns) {
+        placeholders.append(":" + column + suffix);
+    }
+    return QString("(%1)").arg(placeholders.join(","));
+}
+
+QString insertStatement(const QString& tableName, const QStringList& columns) {
+    return QString("INSERT INTO %1 (%2) VALUES %3").arg(
+            tableName, columns.join(","), insertPlaceholders(columns, QString()));
+}
+
+QString multiRowSuffix(int row) {
+    return QString("_%1").arg(row);
+}
+
+QString multiRowInsertStatement(const QString& tableName,
+        QStringList columns, int rowCount) {
+    columns.prepend("id");
+    QStringList rows;
+    for (int row = 0; row < rowCount; ++row) {
+        rows.append(insertPlaceholders(columns, multiRowSuffix(row)));
+    }
+    return QString("INSERT INTO %1 (%2) VALUES %3").arg(
+            tableName, columns.join(","), rows.join(","));
+}
+
+// Returns the id that AUTOINCREMENT would assign to the next row
+// or an invalid id if the query fails
+DbId nextAutoIncrementId(const QSqlDatabase& database, const QString& tableName) {
+    QSqlQuery query(database);
+    query.prepare(QString("SELECT max("
+            "ifnull((SELECT seq FROM sqlite_sequence WHERE name=:name),0),"
+            "ifnull((SELECT max(id) FROM %1),0)) + 1").arg(tableName));
+    query.bindValue(":name", tableName);
+    if (!query.exec() || !query.next()) {
+        LOG_FAILED_QUERY(query);
+        return DbId();
+    }
+    return DbId(query.value(0));
+}
+
+// The pragmas of a bulk import, which inserts more pages in a single
+// transaction than the default page cache holds. Pages that do not fit
+// are written to the database file before the commit, each time after
+// syncing the journal.
+const QList<QPair<QString, QString>> kBulkImportPragmas = {
+        qMakePair(QString("cache_size"), QString("-65536"))}; // KiB
+
+} // anonymous namespace
+
+void TrackDAO::tunePragmasForBulkImport() {
+    DEBUG_ASSERT(m_bulkImportRestorePragmas.isEmpty());
+    QSqlQuery query(m_database);
+    QList<QPair<QString, QString>> pragmas = kBulkImportPragmas;
+    if (query.exec("PRAGMA journal_mode") && query.next() &&
+            query.value(0).toString().compare("wal", Qt::CaseInsensitive) == 0) {
+        // Safe with a write-ahead log, which is only synced on checkpoints.
+        // The pragma cannot be changed inside of a transaction.
+        pragmas.append(qMakePair(QString("synchronous"), QString("NORMAL")));
+    }
+    for (const auto& pragma : pragmas) {
+        if (!query.exec(QString("PRAGMA %1").arg(pragma.first)) || !query.next()) {
+            LOG_FAILED_QUERY(query);
+            continue;
+        }
+        m_bulkImportRestorePragmas.append(
+                qMakePair(pragma.first, query.value(0).toString()));
+        if (!query.exec(QString("PRAGMA %1 = %2").arg(pragma.first, pragma.second))) {
+            LOG_FAILED_QUERY(query);
+        }
+    }
+}
+
+void TrackDAO::restorePragmasAfterBulkImport() {
+    QSqlQuery query(m_database);
+    for (const auto& pragma : m_bulkImportRestorePragmas) {
+        if (!query.exec(QString("PRAGMA %1 = %2").arg(pragma.first, pragma.second))) {
+            LOG_FAILED_QUERY(query);
+        }
+    }
+    m_bulkImportRestorePragmas.clear();
+}
+
+void TrackDAO::addTracksPrepare(bool bulkImport) {
         if (m_pQueryLibraryInsert || m_pQueryTrackLocationInsert ||
                 m_pQueryLibrarySelect || m_pQueryTrackLocationSelect ||
                 m_pTransaction) {
@@ -312,6 +462,9 @@ void TrackDAO::addTracksPrepare() {
         // true == do a db rollback
         addTracksFinish(true);
     }
+    if (bulkImport) {
+        tunePragmasForBulkImport();
+    }
     // Start the transaction
     m_pTransaction = std::make_unique<SqlTransaction>(m_database);
 
@@ -321,33 +474,13 @@ void TrackDAO::addTracksPrepare() {
     m_pQueryLibraryUpdate = std::make_unique<QSqlQuery>(m_database);
     m_pQueryLibrarySelect = std::make_unique<QSqlQuery>(m_database);
 
-    m_pQueryTrackLocationInsert->prepare("INSERT INTO track_locations "
-            "("
-            "location,directory,filename,filesize,fs_deleted,needs_verification"
-            ") VALUES ("
-            ":location,:directory,:filename,:filesize,:fs_deleted,:needs_verification"
-            ")");
+    m_pQueryTrackLocationInsert->prepare(
+            insertStatement("track_locations", kTrackLocationInsertColumns));
 
     m_pQueryTrackLocationSelect->prepare("SELECT id FROM track_locations WHERE location=:location");
 
-    m_pQueryLibraryInsert->prepare("INSERT INTO library "
-            "("
-            "artist,title,album,album_artist,year,genre,tracknumber,tracktotal,composer,"
-            "grouping,filetype,location,comment,url,duration,rating,key,key_id,"
-            "bitrate,samplerate,cuepoint,bpm,replaygain,replaygain_peak,wavesummaryhex,"
-            "timesplayed,channels,mixxx_deleted,header_parsed,"
-            "beats_version,beats_sub_version,beats,bpm_lock,"
-            "keys_version,keys_sub_version,keys,"
-            "coverart_source,coverart_type,coverart_location,coverart_hash"
-            ") VALUES ("
-            ":artist,:title,:album,:album_artist,:year,:genre,:tracknumber,:tracktotal,:composer,"
-            ":grouping,:filetype,:location,:comment,:url,:duration,:rating,:key,:key_id,"
-            ":bitrate,:samplerate,:cuepoint,:bpm,:replaygain,:replaygain_peak,:wavesummaryhex,"
-            ":timesplayed,:channels,:mixxx_deleted,:header_parsed,"
-            ":beats_version,:beats_sub_version,:beats,:bpm_lock,"
-            ":keys_version,:keys_sub_version,:keys,"
-            ":coverart_source,:coverart_type,:coverart_location,:coverart_hash"
-            ")");
+    m_pQueryLibraryInsert->prepare(
+            insertStatement("library", kLibraryInsertColumns));
 
     m_pQueryLibraryUpdate->prepare("UPDATE library SET mixxx_deleted = 0 "
             "WHERE id=:id");
@@ -369,7 +502,11 @@ void TrackDAO::addTracksFinish(bool rollback) {
     m_pQueryTrackLocationSelect.reset();
     m_pQueryLibraryInsert.reset();
     m_pQueryLibrarySelect.reset();
+    m_pQueryTrackLocationMultiRowInsert.reset();
+    m_pQueryLibraryMultiRowInsert.reset();
+    m_multiRowInsertRowCount = 0;
     m_pTransaction.reset();
+    restorePragmasAfterBulkImport();
 
     emit(tracksAdded(m_tracksAddedSet));
     m_tracksAddedSet.clear();
@@ -393,42 +530,44 @@ namespace {
         }
     }
 
-    // Bind common values for insert/update
-    void bindTrackLibraryValues(QSqlQuery* pTrackLibraryQuery, const Track& track) {
-        pTrackLibraryQuery->bindValue(":artist", track.getArtist());
-        pTrackLibraryQuery->bindValue(":title", track.getTitle());
-        pTrackLibraryQuery->bindValue(":album", track.getAlbum());
-        pTrackLibraryQuery->bindValue(":album_artist", track.getAlbumArtist());
-        pTrackLibraryQuery->bindValue(":year", track.getYear());
-        pTrackLibraryQuery->bindValue(":genre", track.getGenre());
-        pTrackLibraryQuery->bindValue(":composer", track.getComposer());
-        pTrackLibraryQuery->bindValue(":grouping", track.getGrouping());
-        pTrackLibraryQuery->bindValue(":tracknumber", track.getTrackNumber());
-        pTrackLibraryQuery->bindValue(":tracktotal", track.getTrackTotal());
-        pTrackLibraryQuery->bindValue(":filetype", track.getType());
-        pTrackLibraryQuery->bindValue(":comment", track.getComment());
-        pTrackLibraryQuery->bindValue(":url", track.getURL());
-        pTrackLibraryQuery->bindValue(":duration", track.getDuration());
-        pTrackLibraryQuery->bindValue(":rating", track.getRating());
-        pTrackLibraryQuery->bindValue(":bitrate", track.getBitrate());
-        pTrackLibraryQuery->bindValue(":samplerate", track.getSampleRate());
-        pTrackLibraryQuery->bindValue(":cuepoint", track.getCuePoint());
-        pTrackLibraryQuery->bindValue(":bpm_lock", track.isBpmLocked()? 1 : 0);
-        pTrackLibraryQuery->bindValue(":replaygain", track.getReplayGain().getRatio());
-        pTrackLibraryQuery->bindValue(":replaygain_peak", track.getReplayGain().getPeak());
-        pTrackLibraryQuery->bindValue(":channels", track.getChannels());
-
-        pTrackLibraryQuery->bindValue(":header_parsed", track.isMetadataSynchronized() ? 1 : 0);
+    // Bind common values for insert/update. The suffix is appended to the
+    // names of the placeholders of the row, see insertPlaceholders().
+    void bindTrackLibraryValues(QSqlQuery* pTrackLibraryQuery, const Track& track,
+            const QString& suffix = QString()) {
+        pTrackLibraryQuery->bindValue(":artist" + suffix, track.getArtist());
+        pTrackLibraryQuery->bindValue(":title" + suffix, track.getTitle());
+        pTrackLibraryQuery->bindValue(":album" + suffix, track.getAlbum());
+        pTrackLibraryQuery->bindValue(":album_artist" + suffix, track.getAlbumArtist());
+        pTrackLibraryQuery->bindValue(":year" + suffix, track.getYear());
+        pTrackLibraryQuery->bindValue(":genre" + suffix, track.getGenre());
+        pTrackLibraryQuery->bindValue(":composer" + suffix, track.getComposer());
+        pTrackLibraryQuery->bindValue(":grouping" + suffix, track.getGrouping());
+        pTrackLibraryQuery->bindValue(":tracknumber" + suffix, track.getTrackNumber());
+        pTrackLibraryQuery->bindValue(":tracktotal" + suffix, track.getTrackTotal());
+        pTrackLibraryQuery->bindValue(":filetype" + suffix, track.getType());
+        pTrackLibraryQuery->bindValue(":comment" + suffix, track.getComment());
+        pTrackLibraryQuery->bindValue(":url" + suffix, track.getURL());
+        pTrackLibraryQuery->bindValue(":duration" + suffix, track.getDuration());
+        pTrackLibraryQuery->bindValue(":rating" + suffix, track.getRating());
+        pTrackLibraryQuery->bindValue(":bitrate" + suffix, track.getBitrate());
+        pTrackLibraryQuery->bindValue(":samplerate" + suffix, track.getSampleRate());
+        pTrackLibraryQuery->bindValue(":cuepoint" + suffix, track.getCuePoint());
+        pTrackLibraryQuery->bindValue(":bpm_lock" + suffix, track.isBpmLocked()? 1 : 0);
+        pTrackLibraryQuery->bindValue(":replaygain" + suffix, track.getReplayGain().getRatio());
+        pTrackLibraryQuery->bindValue(":replaygain_peak" + suffix, track.getReplayGain().getPeak());
+        pTrackLibraryQuery->bindValue(":channels" + suffix, track.getChannels());
+
+        pTrackLibraryQuery->bindValue(":header_parsed" + suffix, track.isMetadataSynchronized() ? 1 : 0);
 
         const PlayCounter playCounter(track.getPlayCounter());
-        pTrackLibraryQuery->bindValue(":timesplayed", playCounter.getTimesPlayed());
-        pTrackLibraryQuery->bindValue(":played", playCounter.isPlayed() ? 1 : 0);
+        pTrackLibraryQuery->bindValue(":timesplayed" + suffix, playCounter.getTimesPlayed());
+        pTrackLibraryQuery->bindValue(":played" + suffix, playCounter.isPlayed() ? 1 : 0);
 
         const CoverInfo coverInfo(track.getCoverInfo());
-        pTrackLibraryQuery->bindValue(":coverart_source", coverInfo.source);
-        pTrackLibraryQuery->bindValue(":coverart_type", coverInfo.type);
-        pTrackLibraryQuery->bindValue(":coverart_location", coverInfo.coverLocation);
-        pTrackLibraryQuery->bindValue(":coverart_hash", coverInfo.hash);
+        pTrackLibraryQuery->bindValue(":coverart_source" + suffix, coverInfo.source);
+        pTrackLibraryQuery->bindValue(":coverart_type" + suffix, coverInfo.type);
+        pTrackLibraryQuery->bindValue(":coverart_location" + suffix, coverInfo.coverLocation);
+        pTrackLibraryQuery->bindValue(":coverart_hash" + suffix, coverInfo.hash);
 
         QByteArray beatsBlob;
         QString beatsVersion;
@@ -442,10 +581,10 @@ namespace {
             beatsSubVersion = pBeats->getSubVersion();
             dBpm = pBeats->getBpm();
         }
-        pTrackLibraryQuery->bindValue(":bpm", dBpm);
-        pTrackLibraryQuery->bindValue(":beats_version", beatsVersion);
-        pTrackLibraryQuery->bindValue(":beats_sub_version", beatsSubVersion);
-        pTrackLibraryQuery->bindValue(":beats", beatsBlob);
+        pTrackLibraryQuery->bindValue(":bpm" + suffix, dBpm);
+        pTrackLibraryQuery->bindValue(":beats_version" + suffix, beatsVersion);
+        pTrackLibraryQuery->bindValue(":beats_sub_version" + suffix, beatsSubVersion);
+        pTrackLibraryQuery->bindValue(":beats" + suffix, beatsBlob);
 
         QByteArray keysBlob;
         QString keysVersion;
@@ -460,11 +599,11 @@ namespace {
             key = keys.getGlobalKey();
             keyText = KeyUtils::getGlobalKeyText(keys);
         }
-        pTrackLibraryQuery->bindValue(":keys", keysBlob);
-        pTrackLibraryQuery->bindValue(":keys_version", keysVersion);
-        pTrackLibraryQuery->bindValue(":keys_sub_version", keysSubVersion);
-        pTrackLibraryQuery->bindValue(":key", keyText);
-        pTrackLibraryQuery->bindValue(":key_id", static_cast<int>(key));
+        pTrackLibraryQuery->bindValue(":keys" + suffix, keysBlob);
+        pTrackLibraryQuery->bindValue(":keys_version" + suffix, keysVersion);
+        pTrackLibraryQuery->bindValue(":keys_sub_version" + suffix, keysSubVersion);
+        pTrackLibraryQuery->bindValue(":key" + suffix, keyText);
+        pTrackLibraryQuery->bindValue(":key_id" + suffix, static_cast<int>(key));
     }
 
     bool insertTrackLibrary(QSqlQuery* pTrackLibraryInsert, const Track& track, DbId trackLocationId) {
@@ -680,6 +819,255 @@ TrackPointer TrackDAO::addTracksAddFile(const QFileInfo& fileInfo, bool unremove
     return addTracksAddTrack(std::move(cacheResolver), unremove);
 }
 
+//static
+TrackPointer TrackDAO::resolveTrackToAdd(const QFileInfo& fileInfo,
+        bool deferCoverArt) {
+    // The same checks as in addTracksAddFile()
+    if (!SoundSourceProxy::isFileSupported(fileInfo)) {
+        qWarning() << "TrackDAO::addTracksAddFiles:"
+                << "Unsupported file type"
+                << TrackRef::location(fileInfo);
+        return TrackPointer();
+    }
+    TrackCacheResolver cacheResolver(
+            TrackCache::instance().resolve(fileInfo));
+    const TrackPointer pTrack = cacheResolver.getTrack();
+    if (!pTrack) {
+        qWarning() << "TrackDAO::addTracksAddFiles:"
+                << "File not found"
+                << TrackRef::location(fileInfo);
+        return TrackPointer();
+    }
+    if (pTrack->getId().isValid()) {
+        qDebug() << "TrackDAO::addTracksAddFiles:"
+                << "Track has already been added to the database"
+                << pTrack->getId();
+        return TrackPointer();
+    }
+    // The id is updated in the cache with those of the other tracks. The
+    // track cannot be evicted until then, because it is referenced.
+    cacheResolver.unlockCache();
+
+    SoundSourceProxy(pTrack).updateTrackFromSource(
+            SoundSourceProxy::ImportTrackMetadataMode::Default,
+            deferCoverArt ?
+                    SoundSourceProxy::ImportCoverImageMode::Deferred :
+                    SoundSourceProxy::ImportCoverImageMode::Immediately);
+    if (!pTrack->isMetadataSynchronized()) {
+        qWarning() << "TrackDAO::addTracksAddFiles:"
+                << "Failed to parse track metadata from file"
+                << pTrack->getLocation();
+    }
+    return pTrack;
+}
+
+bool TrackDAO::insertNewTracks(const QList<TrackPointer>& tracks,
+        QList<TrackId>* pTrackIds) {
+    DEBUG_ASSERT(!tracks.isEmpty() && tracks.size() <= kMaxRowsPerInsert);
+    const int rowCount = tracks.size();
+    if (m_multiRowInsertRowCount != rowCount) {
+        m_pQueryTrackLocationMultiRowInsert = std::make_unique<QSqlQuery>(m_database);
+        m_pQueryTrackLocationMultiRowInsert->prepare(multiRowInsertStatement(
+                "track_locations", kTrackLocationInsertColumns, rowCount));
+        m_pQueryLibraryMultiRowInsert = std::make_unique<QSqlQuery>(m_database);
+        m_pQueryLibraryMultiRowInsert->prepare(multiRowInsertStatement(
+                "library", kLibraryInsertColumns, rowCount));
+        m_multiRowInsertRowCount = rowCount;
+    }
+
+    // The ids are assigned explicitly, because only the id of the last row
+    // of a multi-row insert would be known otherwise
+    const DbId firstTrackLocationId(
+            nextAutoIncrementId(m_database, "track_locations"));
+    const DbId firstTrackId(nextAutoIncrementId(m_database, "library"));
+    if (!firstTrackLocationId.isValid() || !firstTrackId.isValid()) {
+        return false;
+    }
+
+    QSqlQuery* pTrackLocationInsert = m_pQueryTrackLocationMultiRowInsert.get();
+    QSqlQuery* pLibraryInsert = m_pQueryLibraryMultiRowInsert.get();
+    for (int row = 0; row < rowCount; ++row) {
+        const Track& track = *tracks[row];
+        const QString suffix = multiRowSuffix(row);
+        const int trackLocationId = firstTrackLocationId.toInt() + row;
+        pTrackLocationInsert->bindValue(":id" + suffix, trackLocationId);
+        pTrackLocationInsert->bindValue(":location" + suffix, track.getLocation());
+        pTrackLocationInsert->bindValue(":directory" + suffix, track.getDirectory());
+        pTrackLocationInsert->bindValue(":filename" + suffix, track.getFileName());
+        pTrackLocationInsert->bindValue(":filesize" + suffix, track.getFileSize());
+        pTrackLocationInsert->bindValue(":fs_deleted" + suffix, 0);
+        pTrackLocationInsert->bindValue(":needs_verification" + suffix, 0);
+
+        bindTrackLibraryValues(pLibraryInsert, track, suffix);
+        pLibraryInsert->bindValue(":id" + suffix, firstTrackId.toInt() + row);
+        pLibraryInsert->bindValue(":location" + suffix, trackLocationId);
+        pLibraryInsert->bindValue(":mixxx_deleted" + suffix, 0);
+        pLibraryInsert->bindValue(":wavesummaryhex" + suffix,
+                QVariant(QVariant::ByteArray));
+    }
+
+    // Either all or none of the tracks are inserted, e.g. if one of the
+    // locations has been inserted in the meantime
+    QSqlQuery query(m_database);
+    if (!query.exec("SAVEPOINT insert_new_tracks")) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    if (!pTrackLocationInsert->exec()) {
+        LOG_FAILED_QUERY(*pTrackLocationInsert);
+    } else if (!pLibraryInsert->exec()) {
+        LOG_FAILED_QUERY(*pLibraryInsert);
+    } else {
+        if (!query.exec("RELEASE insert_new_tracks")) {
+            LOG_FAILED_QUERY(query);
+        }
+        for (int row = 0; row < rowCount; ++row) {
+            pTrackIds->append(TrackId(firstTrackId.toInt() + row));
+        }
+        return true;
+    }
+    if (!query.exec("ROLLBACK TO insert_new_tracks") ||
+            !query.exec("RELEASE insert_new_tracks")) {
+        LOG_FAILED_QUERY(query);
+    }
+    return false;
+}
+
+QList<TrackPointer> TrackDAO::addTracksAddFiles(
+        const QList<QFileInfo>& fileInfos, bool unremove, bool deferCoverArt) {
+    VERIFY_OR_DEBUG_ASSERT(m_pQueryTrackLocationSelect) {
+        qDebug() << "TrackDAO::addTracksAddFiles: needed SqlQuerys have not "
+                "been prepared. Skipping tracks";
+        QList<TrackPointer> tracks;
+        for (int i = 0; i < fileInfos.size(); ++i) {
+            tracks.append(TrackPointer());
+        }
+        return tracks;
+    }
+
+    // The metadata of all files is imported before any of them is added
+    QList<TrackPointer> tracks;
+    for (const auto& fileInfo : fileInfos) {
+        tracks.append(resolveTrackToAdd(fileInfo, deferCoverArt));
+    }
+    return addTracksAddResolvedTracks(tracks, unremove);
+}
+
+QList<TrackPointer> TrackDAO::addTracksAddResolvedTracks(
+        QList<TrackPointer> tracks, bool unremove) {
+    VERIFY_OR_DEBUG_ASSERT(m_pQueryTrackLocationSelect) {
+        qDebug() << "TrackDAO::addTracksAddResolvedTracks: needed SqlQuerys "
+                "have not been prepared. Skipping tracks";
+        for (auto& pTrack : tracks) {
+            pTrack.reset();
+        }
+        return tracks;
+    }
+
+    QSet<Track*> resolvedTracks;
+    QStringList locations;
+    for (const auto& pTrack : tracks) {
+        if (pTrack && !resolvedTracks.contains(pTrack.get())) {
+            resolvedTracks.insert(pTrack.get());
+            locations.append(pTrack->getLocation());
+        }
+    }
+
+    // Tracks with locations that are in the database already are added
+    // one by one, which also unremoves them if requested
+    QSet<QString> existingLocations;
+    QSqlQuery query(m_database);
+    for (int first = 0; first < locations.size();
+            first += kMaxBoundValuesPerStatement) {
+        const QStringList chunk = locations.mid(first, kMaxBoundValuesPerStatement);
+        QStringList placeholders;
+        for (int i = 0; i < chunk.size(); ++i) {
+            placeholders.append("?");
+        }
+        query.prepare(QString("SELECT location FROM track_locations "
+                "WHERE location IN (%1)").arg(placeholders.join(",")));
+        for (const auto& location : chunk) {
+            query.addBindValue(location);
+        }
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            continue;
+        }
+        while (query.next()) {
+            existingLocations.insert(query.value(0).toString());
+        }
+    }
+
+    QList<QPair<TrackPointer, TrackId>> tracksWithIds;
+    QList<TrackPointer> insertedTracks;
+    QList<TrackPointer> newTracks;
+    resolvedTracks.clear();
+    for (const auto& pTrack : tracks) {
+        if (!pTrack || resolvedTracks.contains(pTrack.get())) {
+            continue;
+        }
+        resolvedTracks.insert(pTrack.get());
+        if (existingLocations.contains(pTrack->getLocation())) {
+            const TrackId trackId(addTracksAddTrack(pTrack, unremove));
+            if (trackId.isValid()) {
+                tracksWithIds.append(qMakePair(pTrack, trackId));
+            }
+        } else {
+            newTracks.append(pTrack);
+        }
+    }
+    for (int first = 0; first < newTracks.size(); first += kMaxRowsPerInsert) {
+        const QList<TrackPointer> chunk = newTracks.mid(first, kMaxRowsPerInsert);
+        QList<TrackId> trackIds;
+        if (insertNewTracks(chunk, &trackIds)) {
+            for (int i = 0; i < chunk.size(); ++i) {
+                tracksWithIds.append(qMakePair(chunk[i], trackIds[i]));
+                DEBUG_ASSERT(!m_tracksAddedSet.contains(trackIds[i]));
+                m_tracksAddedSet.insert(trackIds[i]);
+                insertedTracks.append(chunk[i]);
+            }
+        } else {
+            // Adds the tracks one by one to skip those that fail
+            for (const auto& pTrack : chunk) {
+                const TrackId trackId(addTracksAddTrack(pTrack, unremove));
+                if (trackId.isValid()) {
+                    tracksWithIds.append(qMakePair(pTrack, trackId));
+                }
+            }
+        }
+    }
+
+    // Locks the cache only once for all tracks
+    TrackCache::instance().updateTrackIds(tracksWithIds);
+
+    // The analyses and cues need the ids of the tracks. The new tracks
+    // have no cues in the database that would need to be deleted.
+    for (const auto& pTrack : insertedTracks) {
+        m_analysisDao.saveTrackAnalyses(*pTrack);
+        const QList<CuePointer> cuePoints(pTrack->getCuePoints());
+        if (!cuePoints.isEmpty()) {
+            m_cueDao.saveTrackCues(pTrack->getId(), cuePoints);
+        }
+    }
+    for (auto& pTrack : tracks) {
+        if (!pTrack) {
+            continue;
+        }
+        const TrackId trackId(pTrack->getId());
+        if (!trackId.isValid()) {
+            qWarning() << "TrackDAO::addTracksAddFiles:"
+                    << "Failed to add track to database"
+                    << pTrack->getLocation();
+            pTrack.reset();
+        } else if (m_tracksAddedSet.contains(trackId)) {
+            // Only newly inserted tracks must be marked as clean, see
+            // addTracksAddTrack()
+            pTrack->markClean();
+        }
+    }
+    return tracks;
+}
+
 TrackPointer TrackDAO::addSingleTrack(const QFileInfo& fileInfo, bool unremove) {
     addTracksPrepare();
     TrackPointer pTrack(addTracksAddFile(fileInfo, unremove));
@@ -750,11 +1138,12 @@ QList<TrackId> TrackDAO::addMultipleTracks(
         LOG_FAILED_QUERY(query);
     }
     const int addIndexColumn = query.record().indexOf("add_index");
+    QList<QFileInfo> newFileInfos;
     while (query.next()) {
         int addIndex = query.value(addIndexColumn).toInt();
-        const QFileInfo fileInfo(fileInfoList.at(addIndex));
-        addTracksAddFile(fileInfo, unremove);
+        newFileInfos.append(fileInfoList.at(addIndex));
     }
+    addTracksAddFiles(newFileInfos, unremove);
 
     // Now that we have imported any tracks that were not already in the
     // library, re-select ordering by playlist_import.add_index to return
@@ -854,6 +1243,23 @@ QList<TrackId> TrackDAO::getTrackIds(const QDir& dir) {
     return trackIds;
 }
 
+QList<TrackId> TrackDAO::getTrackIdsInDirectory(const QString& directory) {
+    CachedSqlQuery query(m_database,
+            "SELECT library.id FROM library INNER JOIN track_locations "
+            "ON library.location = track_locations.id "
+            "WHERE track_locations.directory = :directory");
+    query.bindValue(":directory", directory);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query) << "could not get tracks in directory:" << directory;
+    }
+
+    QList<TrackId> trackIds;
+    while (query.next()) {
+        trackIds.append(TrackId(query.value(0)));
+    }
+    return trackIds;
+}
+
 bool TrackDAO::onPurgingTracks(
         const QList<TrackId>& trackIds) {
     if (trackIds.empty()) {
@@ -1158,9 +1564,77 @@ struct ColumnPopulator {
     TrackPopulatorFn populator;
 };
 
-}  // namespace
+const ColumnPopulator kTrackColumns[] = {
+    // Location must be first.
+    { "track_locations.location", nullptr },
+    { "artist", setTrackArtist },
+    { "title", setTrackTitle },
+    { "album", setTrackAlbum },
+    { "album_artist", setTrackAlbumArtist },
+    { "year", setTrackYear },
+    { "genre", setTrackGenre },
+    { "composer", setTrackComposer },
+    { "grouping", setTrackGrouping },
+    { "tracknumber", setTrackNumber },
+    { "tracktotal", setTrackTotal },
+    { "filetype", setTrackFiletype },
+    { "rating", setTrackRating },
+    { "comment", setTrackComment },
+    { "url", setTrackUrl },
+    { "duration", setTrackDuration },
+    { "bitrate", setTrackBitrate },
+    { "samplerate", setTrackSampleRate },
+    { "cuepoint", setTrackCuePoint },
+    { "replaygain", setTrackReplayGainRatio },
+    { "replaygain_peak", setTrackReplayGainPeak },
+    { "channels", setTrackChannels },
+    { "timesplayed", setTrackTimesPlayed },
+    { "played", setTrackPlayed },
+    { "datetime_added", setTrackDateAdded },
+    { "header_parsed", setTrackMetadataSynchronized },
+
+    // Beat detection columns are handled by setTrackBeats. Do not change
+    // the ordering of these columns or put other columns in between them!
+    { "bpm", setTrackBeats },
+    { "beats_version", nullptr },
+    { "beats_sub_version", nullptr },
+    { "beats", nullptr },
+    { "bpm_lock", nullptr },
+
+    // Beat detection columns are handled by setTrackKey. Do not change the
+    // ordering of these columns or put other columns in between them!
+    { "key", setTrackKey },
+    { "keys_version", nullptr },
+    { "keys_sub_version", nullptr },
+    { "keys", nullptr },
+
+    // Cover art columns are handled by setTrackCoverInfo. Do not change the
+    // ordering of these columns or put other columns in between them!
+    { "coverart_source", setTrackCoverInfo },
+    { "coverart_type", nullptr },
+    { "coverart_location", nullptr },
+    { "coverart_hash", nullptr }
+};
+
+const int kTrackColumnCount = sizeof(kTrackColumns) / sizeof(*kTrackColumns);
+
+// The columns of kTrackColumns followed by library.id
+QString trackColumnsAndId() {
+    QString columnsStr;
+    int columnsSize = qstrlen("library.id");
+    for (int i = 0; i < kTrackColumnCount; ++i) {
+        columnsSize += qstrlen(kTrackColumns[i].name) + 1;
+    }
+    columnsStr.reserve(columnsSize);
+    for (int i = 0; i < kTrackColumnCount; ++i) {
+        columnsStr.append(kTrackColumns[i].name);
+        columnsStr.append(QChar(','));
+    }
+    columnsStr.append("library.id");
+    return columnsStr;
+}
 
-#define ARRAYLENGTH(x) (sizeof(x) / sizeof(*x))
+}  // namespace
 
 TrackPointer TrackDAO::getTrackFromDB(TrackId trackId) const {
     if (!trackId.isValid()) {
@@ -1168,78 +1642,13 @@ TrackPointer TrackDAO::getTrackFromDB(TrackId trackId) const {
     }
 
     ScopedTimer t("TrackDAO::getTrackFromDB");
-    QSqlQuery query(m_database);
-
-    ColumnPopulator columns[] = {
-        // Location must be first.
-        { "track_locations.location", nullptr },
-        { "artist", setTrackArtist },
-        { "title", setTrackTitle },
-        { "album", setTrackAlbum },
-        { "album_artist", setTrackAlbumArtist },
-        { "year", setTrackYear },
-        { "genre", setTrackGenre },
-        { "composer", setTrackComposer },
-        { "grouping", setTrackGrouping },
-        { "tracknumber", setTrackNumber },
-        { "tracktotal", setTrackTotal },
-        { "filetype", setTrackFiletype },
-        { "rating", setTrackRating },
-        { "comment", setTrackComment },
-        { "url", setTrackUrl },
-        { "duration", setTrackDuration },
-        { "bitrate", setTrackBitrate },
-        { "samplerate", setTrackSampleRate },
-        { "cuepoint", setTrackCuePoint },
-        { "replaygain", setTrackReplayGainRatio },
-        { "replaygain_peak", setTrackReplayGainPeak },
-        { "channels", setTrackChannels },
-        { "timesplayed", setTrackTimesPlayed },
-        { "played", setTrackPlayed },
-        { "datetime_added", setTrackDateAdded },
-        { "header_parsed", setTrackMetadataSynchronized },
-
-        // Beat detection columns are handled by setTrackBeats. Do not change
-        // the ordering of these columns or put other columns in between them!
-        { "bpm", setTrackBeats },
-        { "beats_version", nullptr },
-        { "beats_sub_version", nullptr },
-        { "beats", nullptr },
-        { "bpm_lock", nullptr },
-
-        // Beat detection columns are handled by setTrackKey. Do not change the
-        // ordering of these columns or put other columns in between them!
-        { "key", setTrackKey },
-        { "keys_version", nullptr },
-        { "keys_sub_version", nullptr },
-        { "keys", nullptr },
-
-        // Cover art columns are handled by setTrackCoverInfo. Do not change the
-        // ordering of these columns or put other columns in between them!
-        { "coverart_source", setTrackCoverInfo },
-        { "coverart_type", nullptr },
-        { "coverart_location", nullptr },
-        { "coverart_hash", nullptr }
-    };
 
-    QString columnsStr;
-    int columnsSize = 0;
-    const int columnsCount = ARRAYLENGTH(columns);
-    for (int i = 0; i < columnsCount; ++i) {
-        columnsSize += qstrlen(columns[i].name) + 1;
-    }
-    columnsStr.reserve(columnsSize);
-    for (int i = 0; i < columnsCount; ++i) {
-        if (i > 0) {
-            columnsStr.append(QChar(','));
-        }
-        columnsStr.append(columns[i].name);
-    }
-
-    query.prepare(QString(
+    // The columns are the same for all tracks
+    CachedSqlQuery query(m_database, QString(
             "SELECT %1 FROM Library "
             "INNER JOIN track_locations ON library.location = track_locations.id "
-            "WHERE library.id = %2").arg(columnsStr, trackId.toString()));
+            "WHERE library.id = :id").arg(trackColumnsAndId()));
+    query.bindValue(":id", trackId.toVariant());
 
     if (!query.exec() || !query.next()) {
         LOG_FAILED_QUERY(query)
@@ -1247,14 +1656,71 @@ TrackPointer TrackDAO::getTrackFromDB(TrackId trackId) const {
         return TrackPointer();
     }
 
-    QSqlRecord queryRecord = query.record();
-    int recordCount = queryRecord.count();
-    VERIFY_OR_DEBUG_ASSERT(recordCount == columnsCount) {
-        recordCount = math_min(recordCount, columnsCount);
+    return getTrackFromRecord(trackId, query.record(), nullptr);
+}
+
+QList<TrackPointer> TrackDAO::getTracks(const QList<TrackId>& trackIds) const {
+    ScopedTimer t("TrackDAO::getTracks");
+
+    // The TrackCache is only locked while looking up the cached tracks,
+    // see also getTrack()
+    QHash<TrackId, TrackPointer> tracks(
+            TrackCache::instance().lookupByIds(trackIds));
+
+    QList<TrackId> missingTrackIds;
+    QStringList missingIdList;
+    for (const auto& trackId: trackIds) {
+        if (trackId.isValid() && !tracks.contains(trackId)) {
+            missingTrackIds.append(trackId);
+            missingIdList.append(trackId.toString());
+        }
     }
 
+    if (!missingTrackIds.isEmpty()) {
+        const QHash<TrackId, QList<CuePointer>> cuesByTrack(
+                m_cueDao.getCuesForTracks(missingTrackIds));
+        QSqlQuery query(m_database);
+        query.setForwardOnly(true);
+        query.prepare(QString(
+                "SELECT %1 FROM Library "
+                "INNER JOIN track_locations ON library.location = track_locations.id "
+                "WHERE library.id IN (%2)").arg(
+                        trackColumnsAndId(),
+                        missingIdList.join(",")));
+        if (query.exec()) {
+            while (query.next()) {
+                const QSqlRecord record(query.record());
+                const TrackId trackId(record.value(kTrackColumnCount));
+                const auto cues = cuesByTrack.value(trackId);
+                TrackPointer pTrack(getTrackFromRecord(trackId, record, &cues));
+                if (pTrack) {
+                    tracks.insert(trackId, pTrack);
+                }
+            }
+        } else {
+            LOG_FAILED_QUERY(query);
+        }
+    }
+
+    QList<TrackPointer> result;
+    result.reserve(trackIds.size());
+    for (const auto& trackId: trackIds) {
+        TrackPointer pTrack(tracks.value(trackId));
+        if (pTrack) {
+            result.append(pTrack);
+        }
+    }
+    return result;
+}
+
+TrackPointer TrackDAO::getTrackFromRecord(TrackId trackId,
+        const QSqlRecord& record, const QList<CuePointer>* pCues) const {
+    DEBUG_ASSERT(record.count() == kTrackColumnCount + 1);
+    // Not the trailing library.id
+    const int recordCount = math_min(record.count(), kTrackColumnCount);
+
     // Location is the first column.
-    const QString trackLocation(queryRecord.value(0).toString());
+    const QString trackLocation(record.value(0).toString());
     const QFileInfo fileInfo(trackLocation);
 
     TrackCacheResolver cacheResolver(
@@ -1278,17 +1744,17 @@ TrackPointer TrackDAO::getTrackFromDB(TrackId trackId) const {
     // For every column run its populator to fill the track in with the data.
     bool shouldDirty = false;
     for (int i = 0; i < recordCount; ++i) {
-        TrackPopulatorFn populator = columns[i].populator;
+        TrackPopulatorFn populator = kTrackColumns[i].populator;
         if (populator != nullptr) {
             // If any populator says the track should be dirty then we dirty it.
-            if ((*populator)(queryRecord, i, pTrack)) {
+            if ((*populator)(record, i, pTrack)) {
                 shouldDirty = true;
             }
         }
     }
 
     // Populate track cues from the cues table.
-    pTrack->setCuePoints(m_cueDao.getCuesForTrack(trackId));
+    pTrack->setCuePoints(pCues ? *pCues : m_cueDao.getCuesForTrack(trackId));
 
     // Normally we will set the track as clean but sometimes when loading from
     // the database we need to perform upkeep that ought to be written back to
@@ -1316,7 +1782,9 @@ TrackPointer TrackDAO::getTrackFromDB(TrackId trackId) const {
                 " to replace the default value introduced with a previous"
                 " schema upgrade";
         mixxx::TrackMetadata trackMetadata;
-        if (SoundSourceProxy(pTrack).importTrackMetadata(&trackMetadata) == mixxx::MetadataSource::ImportResult::Succeeded) {
+        if (SoundSourceProxy(pTrack).importTrackMetadata(
+                &trackMetadata, mixxx::MetadataSource::IMPORT_TAGS) ==
+                mixxx::MetadataSource::ImportResult::Succeeded) {
             // Copy the track total from the temporary track object
             pTrack->setTrackTotal(trackMetadata.getTrackInfo().getTrackTotal());
             // Also set the track number if it is still empty due
@@ -1379,10 +1847,9 @@ bool TrackDAO::updateTrack(Track* pTrack) {
             << "Updating track in database"
             << pTrack->getLocation();
 
-    QSqlQuery query(m_database);
-
     // Update everything but "location", since that's what we identify the track by.
-    query.prepare("UPDATE library SET "
+    CachedSqlQuery query(m_database,
+            "UPDATE library SET "
             "artist=:artist,"
             "title=:title,"
             "album=:album,"
@@ -1456,14 +1923,27 @@ void TrackDAO::invalidateTrackLocationsInLibrary() {
     //qDebug() << "TrackDAO::invalidateTrackLocations" << QThread::currentThread() << m_database.connectionName();
     //qDebug() << "invalidateTrackLocations(" << libraryPath << ")";
 
-    QSqlQuery query(m_database);
-    query.prepare("UPDATE track_locations SET needs_verification = 1");
+    CachedSqlQuery query(m_database, "UPDATE track_locations SET needs_verification = 1");
     if (!query.exec()) {
         LOG_FAILED_QUERY(query)
                 << "Couldn't mark tracks in library as needing verification.";
     }
 }
 
+void TrackDAO::invalidateTrackLocationsInDirectories(const QStringList& directories) {
+    QSqlQuery query(m_database);
+    query.prepare(
+        QString("UPDATE track_locations "
+                "SET needs_verification=1 "
+                "WHERE directory IN (%1)").arg(
+                        SqlStringFormatter::formatList(m_database, directories)));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "Couldn't mark tracks in" << directories.size()
+                << "directories as needing verification.";
+    }
+}
+
 void TrackDAO::markTrackLocationsAsVerified(const QStringList& locations) {
     //qDebug() << "TrackDAO::markTrackLocationsAsVerified" << QThread::currentThread() << m_database.connectionName();
 
@@ -1518,10 +1998,10 @@ void TrackDAO::markUnverifiedTracksAsDeleted() {
 
 void TrackDAO::markTrackLocationsAsDeleted(const QString& directory) {
     //qDebug() << "TrackDAO::markTrackLocationsAsDeleted" << QThread::currentThread() << m_database.connectionName();
-    QSqlQuery query(m_database);
-    query.prepare("UPDATE track_locations "
-                  "SET fs_deleted=1 "
-                  "WHERE directory=:directory");
+    CachedSqlQuery query(m_database,
+            "UPDATE track_locations "
+            "SET fs_deleted=1 "
+            "WHERE directory=:directory");
     query.bindValue(":directory", directory);
     if (!query.exec()) {
         LOG_FAILED_QUERY(query)
@@ -1713,20 +2193,112 @@ void TrackDAO::markTracksAsMixxxDeleted(const QString& dir) {
     }
 }
 
+namespace {
+
+// The files are checked by more threads than cores, since they are
+// mostly waiting for the file system, e.g. on a network share
+const int kVerificationThreadCount = 16;
+// The directories that are checked before their results are written
+const int kVerificationBatchSize = 256;
+// Directories with fewer tracks are not listed
+const int kMinTracksForDirectoryListing = 4;
+
+struct TrackLocationToVerify {
+    int id;
+    QString location;
+    QString filename;
+};
+
+// Finds the missing tracks of a directory. A directory with many tracks
+// is listed once instead of checking each of its files.
+class DirectoryVerifier: public QRunnable {
+  public:
+    DirectoryVerifier(
+            const QString& directory,
+            const QList<TrackLocationToVerify>& tracks,
+            volatile const bool* pCancel)
+            : m_directory(directory),
+              m_tracks(tracks),
+              m_pCancel(pCancel) {
+        setAutoDelete(false);
+    }
+
+    void run() override {
+        if (*m_pCancel) {
+            return;
+        }
+        QSet<QString> fileNames;
+        if (!m_directory.isEmpty() &&
+                m_tracks.size() >= kMinTracksForDirectoryListing) {
+            const QStringList entries(QDir(m_directory).entryList(
+                    QDir::Files | QDir::Hidden | QDir::System));
+            fileNames = QSet<QString>::fromList(entries);
+        }
+        for (const auto& track: m_tracks) {
+            // Files that are not listed are checked once more, e.g. if
+            // they have another case on a case insensitive file system
+            if (fileNames.contains(track.filename) ||
+                    QFile::exists(track.location)) {
+                m_existingTrackLocationIds.append(QString::number(track.id));
+            } else {
+                m_missingTrackLocationIds.append(QString::number(track.id));
+            }
+        }
+    }
+
+    const QString& directory() const {
+        return m_directory;
+    }
+    const QStringList& existingTrackLocationIds() const {
+        return m_existingTrackLocationIds;
+    }
+    const QStringList& missingTrackLocationIds() const {
+        return m_missingTrackLocationIds;
+    }
+
+  private:
+    const QString m_directory;
+    const QList<TrackLocationToVerify> m_tracks;
+    volatile const bool* m_pCancel;
+    QStringList m_existingTrackLocationIds;
+    QStringList m_missingTrackLocationIds;
+};
+
+bool updateVerifiedTrackLocations(
+        QSqlDatabase database,
+        const QStringList& trackLocationIds,
+        bool fsDeleted) {
+    if (trackLocationIds.isEmpty()) {
+        return true;
+    }
+    QSqlQuery query(database);
+    query.prepare(QString("UPDATE track_locations "
+                          "SET fs_deleted=%1, needs_verification=0 "
+                          "WHERE id IN (%2)").arg(
+                                  QString::number(fsDeleted ? 1 : 0),
+                                  trackLocationIds.join(",")));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
 bool TrackDAO::verifyRemainingTracks(
         const QStringList& libraryRootDirs,
         volatile const bool* pCancel) {
     // This function is called from the LibraryScanner Thread, which also has a
     // transaction running, so we do NOT NEED to use one here
     QSqlQuery query(m_database);
-    QSqlQuery query2(m_database);
 
     // Because all tracks were marked with needs_verification anything that is
     // not inside one of the tracked library directories will need an explicit
     // check if it exists.
     // TODO(kain88) check if all others are marked with 0 again
     query.setForwardOnly(true);
-    query.prepare("SELECT location "
+    query.prepare("SELECT id, location, directory, filename "
                   "FROM track_locations "
                   "WHERE needs_verification = 1");
     if (!query.exec()) {
@@ -1734,40 +2306,70 @@ bool TrackDAO::verifyRemainingTracks(
         return false;
     }
 
-    query2.prepare("UPDATE track_locations "
-                   "SET fs_deleted=:fs_deleted, needs_verification=0 "
-                   "WHERE location=:location");
-
+    const int idColumn = query.record().indexOf("id");
     const int locationColumn = query.record().indexOf("location");
-    QString trackLocation;
+    const int directoryColumn = query.record().indexOf("directory");
+    const int filenameColumn = query.record().indexOf("filename");
+    QStringList deletedTrackLocationIds;
+    QMap<QString, QList<TrackLocationToVerify>> tracksByDirectory;
     while (query.next()) {
-        trackLocation = query.value(locationColumn).toString();
-        int fs_deleted = 0;
+        TrackLocationToVerify track;
+        track.id = query.value(idColumn).toInt();
+        track.location = query.value(locationColumn).toString();
+        track.filename = query.value(filenameColumn).toString();
+        bool underLibraryRoot = false;
         for (const auto& dir: libraryRootDirs) {
-            if (trackLocation.startsWith(dir)) {
+            if (track.location.startsWith(dir)) {
                 // Track is under the library root,
                 // but was not verified.
                 // This happens if the track was deleted
                 // a symlink duplicate or on a non normalized
                 // path like on non case sensitive file systems.
-                fs_deleted = 1;
+                underLibraryRoot = true;
                 break;
             }
         }
-
-        if (fs_deleted == 0) {
-            fs_deleted = QFile::exists(trackLocation) ? 0 : 1;
+        if (underLibraryRoot) {
+            deletedTrackLocationIds.append(QString::number(track.id));
+        } else {
+            tracksByDirectory[query.value(directoryColumn).toString()].append(track);
         }
+    }
+    query.finish();
+    if (!updateVerifiedTrackLocations(m_database, deletedTrackLocationIds, true)) {
+        return false;
+    }
 
-        query2.bindValue(":fs_deleted", fs_deleted);
-        query2.bindValue(":location", trackLocation);
-        if (!query2.exec()) {
-            LOG_FAILED_QUERY(query2);
+    // The directories are checked in batches by a pool of threads, while
+    // the database is only accessed by this thread
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(kVerificationThreadCount);
+    auto nextDirectory = tracksByDirectory.constBegin();
+    while (nextDirectory != tracksByDirectory.constEnd()) {
+        std::vector<std::unique_ptr<DirectoryVerifier>> verifiers;
+        while (nextDirectory != tracksByDirectory.constEnd() &&
+                static_cast<int>(verifiers.size()) < kVerificationBatchSize) {
+            verifiers.push_back(std::make_unique<DirectoryVerifier>(
+                    nextDirectory.key(), nextDirectory.value(), pCancel));
+            threadPool.start(verifiers.back().get());
+            ++nextDirectory;
         }
-        emit(progressVerifyTracksOutside(trackLocation));
+        threadPool.waitForDone();
         if (*pCancel) {
             return false;
         }
+
+        QStringList existingTrackLocationIds;
+        QStringList missingTrackLocationIds;
+        for (const auto& pVerifier: verifiers) {
+            existingTrackLocationIds += pVerifier->existingTrackLocationIds();
+            missingTrackLocationIds += pVerifier->missingTrackLocationIds();
+        }
+        if (!updateVerifiedTrackLocations(m_database, missingTrackLocationIds, true) ||
+                !updateVerifiedTrackLocations(m_database, existingTrackLocationIds, false)) {
+            return false;
+        }
+        emit(progressVerifyTracksOutside(verifiers.back()->directory()));
     }
     return true;
 }
@@ -1775,12 +2377,34 @@ bool TrackDAO::verifyRemainingTracks(
 struct TrackWithoutCover {
     TrackId trackId;
     QString trackLocation;
-    QString directoryPath;
     QString trackAlbum;
 };
 
-void TrackDAO::detectCoverArtForTracksWithoutCover(volatile const bool* pCancel,
-                                              QSet<TrackId>* pTracksChanged) {
+QStringList TrackDAO::getDirectoriesOfTracksWithoutCover() {
+    QStringList directories;
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT DISTINCT track_locations.directory "
+                  "FROM library "
+                  "INNER JOIN track_locations "
+                  "ON library.location = track_locations.id "
+                  // CoverInfo::Source 0 is UNKNOWN
+                  "WHERE (coverart_source IS NULL or coverart_source = 0) "
+                  "AND track_locations.fs_deleted = 0 "
+                  "ORDER BY track_locations.directory");
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "failed looking for tracks with unknown cover art";
+        return directories;
+    }
+    while (query.next()) {
+        directories.append(query.value(0).toString());
+    }
+    return directories;
+}
+
+void TrackDAO::detectCoverArtForTracksInDirectory(const QString& directoryPath,
+                                                  QSet<TrackId>* pTracksChanged) {
     // WARNING TO ANYONE TOUCHING THIS IN THE FUTURE
     // The library contains user selected cover art. There is nothing worse than
     // spending hours curating your library only to have an automated search
@@ -1793,15 +2417,15 @@ void TrackDAO::detectCoverArtForTracksWithoutCover(volatile const bool* pCancel,
     query.prepare("SELECT "
                   " library.id, " // 0
                   " track_locations.location, " // 1
-                  " track_locations.directory, " // 2
-                  " album, " // 3
-                  " coverart_source " // 4
+                  " album, " // 2
+                  " coverart_source " // 3
                   "FROM library "
                   "INNER JOIN track_locations "
                   "ON library.location = track_locations.id "
                   // CoverInfo::Source 0 is UNKNOWN
-                  "WHERE coverart_source IS NULL or coverart_source = 0 "
-                  "ORDER BY track_locations.directory");
+                  "WHERE (coverart_source IS NULL or coverart_source = 0) "
+                  "AND track_locations.directory = :directory");
+    query.bindValue(":directory", directoryPath);
 
     QList<TrackWithoutCover> tracksWithoutCover;
 
@@ -1814,51 +2438,37 @@ void TrackDAO::detectCoverArtForTracksWithoutCover(volatile const bool* pCancel,
     // We quickly iterate through the results to prevent blocking the database
     // for other operations. Bug #1399981.
     while (query.next()) {
-        if (*pCancel) {
-            return;
-        }
-
         TrackWithoutCover track;
         track.trackId = TrackId(query.value(0));
         track.trackLocation = query.value(1).toString();
-        // TODO(rryan) use QFileInfo path instead? symlinks? relative?
-        track.directoryPath = query.value(2).toString();
-        track.trackAlbum = query.value(3).toString();
+        track.trackAlbum = query.value(2).toString();
 
         CoverInfo::Source source = static_cast<CoverInfo::Source>(
-            query.value(4).toInt());
+            query.value(3).toInt());
         VERIFY_OR_DEBUG_ASSERT(source != CoverInfo::USER_SELECTED) {
-            qWarning() << "PROGRAMMING ERROR! detectCoverArtForTracksWithoutCover()"
+            qWarning() << "PROGRAMMING ERROR! detectCoverArtForTracksInDirectory()"
                        << "got a USER_SELECTED track. Skipping.";
             continue;
         }
         tracksWithoutCover.append(track);
     }
+    query.finish();
 
-    QSqlQuery updateQuery(m_database);
-    updateQuery.prepare(
-        "UPDATE library SET "
-        "  coverart_type=:coverart_type,"
-        "  coverart_source=:coverart_source,"
-        "  coverart_hash=:coverart_hash,"
-        "  coverart_location=:coverart_location "
-        "WHERE id=:track_id");
+    CachedSqlQuery updateQuery(m_database,
+            "UPDATE library SET "
+            "  coverart_type=:coverart_type,"
+            "  coverart_source=:coverart_source,"
+            "  coverart_hash=:coverart_hash,"
+            "  coverart_location=:coverart_location "
+            "WHERE id=:track_id");
 
-
-    QRegExp coverArtFilenames(CoverArtUtils::supportedCoverArtExtensionsRegex(),
-                              Qt::CaseInsensitive);
-    QString currentDirectoryPath;
-    MDir currentDirectory;
+    // Keeps the directory accessible in a sandbox. It is only searched once
+    // for all of its tracks and only if one of them has no embedded cover.
+    const MDir directory(directoryPath);
+    bool possibleCoversFound = false;
     QLinkedList<QFileInfo> possibleCovers;
 
     for (const auto& track: tracksWithoutCover) {
-        if (*pCancel) {
-            return;
-        }
-
-        //qDebug() << "Searching for cover art for" << trackLocation;
-        emit(progressCoverArt(track.trackLocation));
-
         QFileInfo trackInfo(track.trackLocation);
         if (!trackInfo.exists()) {
             //qDebug() << trackLocation << "does not exist";
@@ -1884,12 +2494,10 @@ void TrackDAO::detectCoverArtForTracksWithoutCover(volatile const bool* pCancel,
             continue;
         }
 
-        if (track.directoryPath != currentDirectoryPath) {
-            possibleCovers.clear();
-            currentDirectoryPath = track.directoryPath;
-            currentDirectory = MDir(currentDirectoryPath);
+        if (!possibleCoversFound) {
             possibleCovers = CoverArtUtils::findPossibleCoversInFolder(
-                currentDirectoryPath);
+                directoryPath);
+            possibleCoversFound = true;
         }
 
         CoverInfoRelative coverInfo = CoverArtUtils::selectCoverArtForTrack(
@@ -3,13 +3,16 @@
 
 #include <QFileInfo>
 #include <QObject>
+#include <QPair>
 #include <QSet>
 #include <QList>
 #include <QSqlDatabase>
+#include <QSqlRecord>
 #include <QString>
 
 #include "preferences/usersettings.h"
 #include "library/dao/dao.h"
+#include "library/trackmetadataexportqueue.h"
 #include "track/track.h"
 #include "util/class.h"
 #include "util/memory.h"
@@ -45,11 +48,19 @@ class TrackDAO : public QObject, public virtual DAO {
     TrackId getTrackId(const QString& absoluteFilePath);
     QList<TrackId> getTrackIds(const QList<QFileInfo>& files);
     QList<TrackId> getTrackIds(const QDir& dir);
+    // Only the tracks in the directory itself, not in its subdirectories
+    QList<TrackId> getTrackIdsInDirectory(const QString& directory);
 
     bool trackExistsInDatabase(const QString& absoluteFilePath);
 
     // WARNING: Only call this from the main thread instance of TrackDAO.
     TrackPointer getTrack(TrackId trackId) const;
+    // Loads the tracks that are not cached with a single query for their
+    // rows and another one for their cues, e.g. for adding a playlist to
+    // Auto DJ. Returns the tracks in the order of their ids, an id that
+    // has not been found is skipped.
+    // WARNING: Only call this from the main thread instance of TrackDAO.
+    QList<TrackPointer> getTracks(const QList<TrackId>& trackIds) const;
 
     // Returns a set of all track locations in the library.
     QSet<QString> getTrackLocations();
@@ -58,12 +69,32 @@ class TrackDAO : public QObject, public virtual DAO {
     TrackPointer addSingleTrack(const QFileInfo& fileInfo, bool unremove);
     QList<TrackId> addMultipleTracks(const QList<QFileInfo>& fileInfoList, bool unremove);
 
-    void addTracksPrepare();
+    // A bulk import also tunes the database connection until
+    // addTracksFinish()
+    void addTracksPrepare(bool bulkImport = false);
     TrackPointer addTracksAddFile(const QFileInfo& fileInfo, bool unremove);
+    // Adds the files like addTracksAddFile(), but inserts the tracks that
+    // are new to the library with multi-row statements. Returns the tracks
+    // in the order of the files or null if a file could not be added.
+    // Deferred cover art is left unknown for
+    // detectCoverArtForTracksInDirectory().
+    QList<TrackPointer> addTracksAddFiles(const QList<QFileInfo>& fileInfos,
+            bool unremove, bool deferCoverArt = false);
+    // Adds the tracks that have been resolved by resolveTrackToAdd() like
+    // addTracksAddFiles(). Null tracks are passed through.
+    QList<TrackPointer> addTracksAddResolvedTracks(QList<TrackPointer> tracks,
+            bool unremove);
     TrackPointer addTracksAddTrack(TrackCacheResolver&& /*r-value ref*/ cacheResolver, bool unremove);
     TrackId addTracksAddTrack(const TrackPointer& pTrack, bool unremove);
     void addTracksFinish(bool rollback = false);
 
+    // Resolves a file that is not in the library yet and imports its
+    // metadata without keeping the cache locked. Returns null if the file
+    // cannot be added. It does not access the database, so the files of
+    // a batch can be parsed by several threads in parallel.
+    static TrackPointer resolveTrackToAdd(const QFileInfo& fileInfo,
+            bool deferCoverArt);
+
     bool onHidingTracks(
             const QList<TrackId>& trackIds);
     void afterHidingTracks(
@@ -95,6 +126,7 @@ class TrackDAO : public QObject, public virtual DAO {
     void markTrackLocationsAsVerified(const QStringList& locations);
     void markTracksInDirectoriesAsVerified(const QStringList& directories);
     void invalidateTrackLocationsInLibrary();
+    void invalidateTrackLocationsInDirectories(const QStringList& directories);
     void markUnverifiedTracksAsDeleted();
     void markTrackLocationsAsDeleted(const QString& directory);
     bool detectMovedTracks(QSet<TrackId>* pTracksMovedSetOld,
@@ -106,8 +138,13 @@ class TrackDAO : public QObject, public virtual DAO {
             const QStringList& libraryRootDirs,
             volatile const bool* pCancel);
 
-    void detectCoverArtForTracksWithoutCover(volatile const bool* pCancel,
-                                        QSet<TrackId>* pTracksChanged);
+    // The directories of the tracks whose cover art has not been guessed
+    // yet, e.g. because it has been deferred by the library scanner
+    QStringList getDirectoriesOfTracksWithoutCover();
+    // Guesses the cover art of the tracks in the directory that have not
+    // been guessed yet with at most one search for images in the directory
+    void detectCoverArtForTracksInDirectory(const QString& directoryPath,
+                                            QSet<TrackId>* pTracksChanged);
 
   signals:
     void trackDirty(TrackId trackId) const;
@@ -117,7 +154,6 @@ class TrackDAO : public QObject, public virtual DAO {
     void tracksRemoved(QSet<TrackId> trackIds);
     void dbTrackAdded(TrackPointer pTrack);
     void progressVerifyTracksOutside(QString path);
-    void progressCoverArt(QString file);
     void forceModelUpdate();
 
   public slots:
@@ -129,14 +165,24 @@ class TrackDAO : public QObject, public virtual DAO {
     void slotTrackDirty(Track* pTrack);
     void slotTrackChanged(Track* pTrack);
     void slotTrackClean(Track* pTrack);
+    void slotTrackMetadataExported();
 
   private:
     TrackPointer getTrackFromDB(TrackId trackId) const;
+    // Resolves and populates a track from the columns of a library row.
+    // The cues of the track are loaded if pCues is null.
+    TrackPointer getTrackFromRecord(TrackId trackId, const QSqlRecord& record,
+            const QList<CuePointer>* pCues) const;
 
     friend class TrackCollection;
     void saveTrack(TrackCacheLocker* pCacheLocker, Track* pTrack);
     bool updateTrack(Track* pTrack);
 
+    // Inserts the tracks with multi-row statements, either all or none
+    bool insertNewTracks(const QList<TrackPointer>& tracks, QList<TrackId>* pTrackIds);
+    void tunePragmasForBulkImport();
+    void restorePragmasAfterBulkImport();
+
     QSqlDatabase m_database;
 
     CueDAO& m_cueDao;
@@ -151,13 +197,24 @@ class TrackDAO : public QObject, public virtual DAO {
     std::unique_ptr<QSqlQuery> m_pQueryLibraryInsert;
     std::unique_ptr<QSqlQuery> m_pQueryLibraryUpdate;
     std::unique_ptr<QSqlQuery> m_pQueryLibrarySelect;
+    std::unique_ptr<QSqlQuery> m_pQueryTrackLocationMultiRowInsert;
+    std::unique_ptr<QSqlQuery> m_pQueryLibraryMultiRowInsert;
     std::unique_ptr<SqlTransaction> m_pTransaction;
     int m_trackLocationIdColumn;
     int m_queryLibraryIdColumn;
     int m_queryLibraryMixxxDeletedColumn;
+    // The number of rows of the prepared multi-row inserts
+    int m_multiRowInsertRowCount;
+
+    // The values of the pragmas that were changed for a bulk import
+    QList<QPair<QString, QString>> m_bulkImportRestorePragmas;
 
     QSet<TrackId> m_tracksAddedSet;
 
+    // Writes the metadata of saved tracks into the files after the
+    // database has been updated
+    TrackMetadataExportQueue m_metadataExportQueue;
+
     DISALLOW_COPY_AND_ASSIGN(TrackDAO);
 };
 
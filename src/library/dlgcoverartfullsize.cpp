@@ -88,7 +88,8 @@ void DlgCoverArtFullSize::slotLoadTrack(TrackPointer pTrack) {
 
 void DlgCoverArtFullSize::slotTrackCoverArtUpdated() {
     if (m_pLoadedTrack != nullptr) {
-        CoverArtCache::requestCover(*m_pLoadedTrack, this);
+        CoverArtCache::requestCover(*m_pLoadedTrack, this, 0,
+                CoverArtCache::Priority::Visible);
     }
 }
 
@@ -5,6 +5,7 @@
 #include <QMessageBox>
 
 #include "util/assert.h"
+#include "util/duration.h"
 
 TrackExportDlg::TrackExportDlg(QWidget *parent,
                                UserSettingsPointer pConfig,
@@ -12,17 +13,21 @@ TrackExportDlg::TrackExportDlg(QWidget *parent,
         : QDialog(parent),
           Ui::DlgTrackExport(),
           m_pConfig(pConfig),
-          m_worker(worker) {
+          m_worker(worker),
+          m_copyTimerStarted(false) {
     setupUi(this);
     connect(cancelButton, SIGNAL(clicked()), this, SLOT(cancelButtonClicked()));
     exportProgress->setMinimum(0);
     exportProgress->setMaximum(1);
     exportProgress->setValue(0);
     statusLabel->setText("");
+    throughputLabel->setText("");
     setModal(true);
 
     connect(m_worker, SIGNAL(progress(QString, int, int)), this,
             SLOT(slotProgress(QString, int, int)));
+    connect(m_worker, SIGNAL(bytesProgress(qint64, qint64)), this,
+            SLOT(slotBytesProgress(qint64, qint64)));
     connect(m_worker,
             SIGNAL(askOverwriteMode(QString, std::promise<TrackExportWorker::OverwriteAnswer>*)),
             this,
@@ -54,6 +59,23 @@ void TrackExportDlg::slotProgress(QString filename, int progress, int count) {
     exportProgress->setValue(progress);
 }
 
+void TrackExportDlg::slotBytesProgress(qint64 bytesCopied, qint64 bytesTotal) {
+    if (!m_copyTimerStarted) {
+        m_copyTimer.start();
+        m_copyTimerStarted = true;
+        return;
+    }
+    const double seconds = m_copyTimer.elapsed().toDoubleSeconds();
+    if (seconds <= 0 || bytesCopied <= 0) {
+        return;
+    }
+    const double bytesPerSecond = bytesCopied / seconds;
+    const double remainingSeconds = (bytesTotal - bytesCopied) / bytesPerSecond;
+    throughputLabel->setText(tr("%1 MB/s, %2 remaining").arg(
+            QString::number(bytesPerSecond / (1024 * 1024), 'f', 1),
+            mixxx::Duration::formatSeconds(remainingSeconds)));
+}
+
 void TrackExportDlg::slotAskOverwriteMode(
         QString filename,
         std::promise<TrackExportWorker::OverwriteAnswer>* promise) {
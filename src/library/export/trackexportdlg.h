@@ -11,6 +11,7 @@
 #include "library/export/trackexportworker.h"
 #include "library/export/ui_dlgtrackexport.h"
 #include "track/track.h"
+#include "util/performancetimer.h"
 
 // A dialog for interacting with the track exporter in an interactive manner.
 // Handles errors and user interactions.
@@ -31,6 +32,8 @@ class TrackExportDlg : public QDialog, public Ui::DlgTrackExport {
 
   public slots:
     void slotProgress(QString filename, int progress, int count);
+    // Shows the throughput and the estimated remaining time
+    void slotBytesProgress(qint64 bytesCopied, qint64 bytesTotal);
     void slotAskOverwriteMode(
             QString filename,
             std::promise<TrackExportWorker::OverwriteAnswer>* promise);
@@ -50,6 +53,10 @@ class TrackExportDlg : public QDialog, public Ui::DlgTrackExport {
     UserSettingsPointer m_pConfig;
     QList<TrackPointer> m_tracks;
     TrackExportWorker* m_worker;
+    // Started with the first copied bytes, after the questions have been
+    // answered
+    PerformanceTimer m_copyTimer;
+    bool m_copyTimerStarted;
 };
 
 #endif  // DLGTRACKEXPORT_H
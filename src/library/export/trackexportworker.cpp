@@ -3,10 +3,103 @@
 
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QMutexLocker>
 #include <QDebug>
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+#include <QStorageInfo>
+#endif
+
+#include <thread>
+#include <vector>
+
+#ifdef __LINUX__
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <sys/sysmacros.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include "util/math.h"
 
 namespace {
 
+// Parallel streams keep the queue of an SSD or the pipe to a file server
+// busy. A USB stick or a hard disk only gets slower when the writes of
+// several files are interleaved.
+const int kFastDeviceCopyStreams = 4;
+const int kSlowDeviceCopyStreams = 1;
+
+// Large enough that the per-call overhead does not matter, small enough
+// that a cancel is noticed quickly even on a slow stick
+const qint64 kCopyChunkBytes = 4 * 1024 * 1024;
+
+const unsigned long kProgressIntervalMillis = 250;
+
+#ifdef __LINUX__
+bool readSysfsFlag(const QDir& dir, const QString& name) {
+    QFile file(dir.filePath(name));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return file.readAll().trimmed() == "1";
+}
+#endif
+
+// Chooses the number of copy streams by the device the directory is
+// stored on
+int copyStreamsForDirectory(const QString& dirPath) {
+#ifdef __LINUX__
+    const QByteArray path = QFile::encodeName(dirPath);
+    struct statfs fs;
+    if (statfs(path.constData(), &fs) == 0) {
+        switch (static_cast<unsigned long>(fs.f_type)) {
+        case 0x6969: // NFS
+        case 0x517B: // SMB
+        case 0xFF534D42: // CIFS
+        case 0xFE534D42: // SMB2
+            return kFastDeviceCopyStreams;
+        default:
+            break;
+        }
+    }
+    struct stat st;
+    if (stat(path.constData(), &st) != 0) {
+        return kSlowDeviceCopyStreams;
+    }
+    if (major(st.st_dev) == 0) {
+        // Not a single block device, e.g. FUSE, tmpfs or btrfs
+        return kFastDeviceCopyStreams;
+    }
+    QDir device(QFileInfo(QString("/sys/dev/block/%1:%2").arg(
+            major(st.st_dev)).arg(minor(st.st_dev))).canonicalFilePath());
+    if (device.exists("partition")) {
+        device.cdUp();
+    }
+    if (device.canonicalPath().contains("/usb") ||
+            readSysfsFlag(device, "removable") ||
+            readSysfsFlag(device, "queue/rotational")) {
+        return kSlowDeviceCopyStreams;
+    }
+    return kFastDeviceCopyStreams;
+#else
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+    // Local SSDs cannot be told apart from USB sticks here, only network
+    // shares are detected
+    const QByteArray fileSystemType =
+            QStorageInfo(dirPath).fileSystemType().toLower();
+    if (fileSystemType == "nfs" || fileSystemType == "smbfs" ||
+            fileSystemType == "cifs" || fileSystemType == "afpfs" ||
+            fileSystemType == "webdav") {
+        return kFastDeviceCopyStreams;
+    }
+#endif
+    return kSlowDeviceCopyStreams;
+#endif
+}
+
 QString rewriteFilename(const QFileInfo& fileinfo, int index) {
     // We don't have total control over the inputs, so definitely
     // don't use .arg().arg().arg().
@@ -71,29 +164,52 @@ QMap<QString, QFileInfo> createCopylist(const QList<TrackPointer>& tracks) {
 void TrackExportWorker::run() {
     int i = 0;
     QMap<QString, QFileInfo> copy_list = createCopylist(m_tracks);
+    m_jobs.clear();
     for (auto it = copy_list.constBegin(); it != copy_list.constEnd(); ++it) {
-        // We emit progress twice per loop, which may seem excessive, but it
-        // guarantees that we emit a sane progress before we start and after
-        // we end.  In between, each filename will get its own visible tick
-        // on the bar, which looks really nice.
-        emit(progress(it->fileName(), i, copy_list.size()));
-        copyFile(*it, it.key());
+        // The questions are asked before anything is copied.  Each skipped
+        // filename gets its own visible tick on the bar, the copied ones
+        // tick when they are done.
+        if (it == copy_list.constBegin()) {
+            emit(progress(it->fileName(), i, copy_list.size()));
+        }
+        const bool copy = prepareCopy(*it, it.key());
+        if (load_atomic(m_bStop)) {
+            emit(canceled());
+            return;
+        }
+        if (copy) {
+            CopyJob job;
+            job.sourcePath = it->canonicalFilePath();
+            job.destPath = QDir(m_destDir).filePath(it.key());
+            job.filename = it->fileName();
+            m_jobs.append(job);
+        } else {
+            ++i;
+            emit(progress(it->fileName(), i, copy_list.size()));
+        }
+    }
+    if (!m_jobs.isEmpty()) {
+        copyFiles(i, copy_list.size());
         if (load_atomic(m_bStop)) {
             emit(canceled());
             return;
         }
-        ++i;
-        emit(progress(it->fileName(), i, copy_list.size()));
     }
 }
 
-void TrackExportWorker::copyFile(const QFileInfo& source_fileinfo,
-                                 const QString& dest_filename) {
+bool TrackExportWorker::prepareCopy(const QFileInfo& source_fileinfo,
+                                    const QString& dest_filename) {
     QString sourceFilename = source_fileinfo.canonicalFilePath();
     const QString dest_path = QDir(m_destDir).filePath(dest_filename);
     QFileInfo dest_fileinfo(dest_path);
 
     if (dest_fileinfo.exists()) {
+        if (dest_fileinfo.size() == source_fileinfo.size() &&
+                dest_fileinfo.lastModified() >= source_fileinfo.lastModified()) {
+            // Most likely exported before
+            qDebug() << "skipping up to date" << sourceFilename;
+            return false;
+        }
         switch (m_overwriteMode) {
         // Give the user the option to overwrite existing files in the destination.
         case OverwriteMode::ASK:
@@ -101,19 +217,19 @@ void TrackExportWorker::copyFile(const QFileInfo& source_fileinfo,
             case OverwriteAnswer::SKIP:
             case OverwriteAnswer::SKIP_ALL:
                 qDebug() << "skipping" << sourceFilename;
-                return;
+                return false;
             case OverwriteAnswer::OVERWRITE:
             case OverwriteAnswer::OVERWRITE_ALL:
                 break;
             case OverwriteAnswer::CANCEL:
                 m_errorMessage = tr("Export process was canceled");
                 stop();
-                return;
+                return false;
             }
             break;
         case OverwriteMode::SKIP_ALL:
             qDebug() << "skipping" << sourceFilename;
-            return;
+            return false;
         case OverwriteMode::OVERWRITE_ALL:;
         }
 
@@ -127,21 +243,152 @@ void TrackExportWorker::copyFile(const QFileInfo& source_fileinfo,
             qWarning() << error_message;
             m_errorMessage = error_message;
             stop();
-            return;
+            return false;
         }
     }
+    return true;
+}
+
+void TrackExportWorker::copyFiles(int done, int count) {
+    qint64 bytesTotal = 0;
+    for (const auto& job : m_jobs) {
+        bytesTotal += QFileInfo(job.sourcePath).size();
+    }
+    const int streams = math_min(
+            m_copyStreams > 0 ? m_copyStreams : copyStreamsForDirectory(m_destDir),
+            m_jobs.size());
+    qDebug() << "Copying" << m_jobs.size() << "files with" << streams
+             << "streams";
 
-    qDebug() << "Copying" << sourceFilename << "to" << dest_path;
-    QFile source_file(sourceFilename);
-    if (!source_file.copy(dest_path)) {
-        const QString error_message = tr(
-                "Error exporting track %1 to %2: %3. Stopping.").arg(
-                sourceFilename, dest_path, source_file.errorString());
-        qWarning() << error_message;
-        m_errorMessage = error_message;
-        stop();
-        return;
+    m_nextJob = 0;
+    m_runningStreams = streams;
+    m_finishedFilenames.clear();
+    m_bytesCopied = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < streams; ++i) {
+        threads.emplace_back([this] { copyStream(); });
+    }
+
+    // The signals are emitted from this thread only
+    emit(bytesProgress(0, bytesTotal));
+    QMutexLocker locker(&m_mutex);
+    while (true) {
+        if (m_finishedFilenames.isEmpty() && m_runningStreams > 0) {
+            m_jobFinished.wait(&m_mutex, kProgressIntervalMillis);
+        }
+        QStringList finishedFilenames;
+        finishedFilenames.swap(m_finishedFilenames);
+        const bool running = m_runningStreams > 0;
+        locker.unlock();
+
+        emit(bytesProgress(m_bytesCopied.load(), bytesTotal));
+        for (const QString& filename : finishedFilenames) {
+            ++done;
+            emit(progress(filename, done, count));
+        }
+        if (!running) {
+            break;
+        }
+        locker.relock();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void TrackExportWorker::copyStream() {
+    QMutexLocker locker(&m_mutex);
+    while (!load_atomic(m_bStop) && m_nextJob < m_jobs.size()) {
+        const CopyJob job = m_jobs[m_nextJob++];
+        locker.unlock();
+        qDebug() << "Copying" << job.sourcePath << "to" << job.destPath;
+        const QString error_message = copyFileContents(job);
+        locker.relock();
+        if (!error_message.isEmpty()) {
+            qWarning() << error_message;
+            // Only the first error is shown
+            if (m_errorMessage.isEmpty()) {
+                m_errorMessage = error_message;
+            }
+            stop();
+        } else if (!load_atomic(m_bStop)) {
+            m_finishedFilenames.append(job.filename);
+        }
+        m_jobFinished.wakeAll();
+    }
+    --m_runningStreams;
+    m_jobFinished.wakeAll();
+}
+
+QString TrackExportWorker::copyFileContents(const CopyJob& job) {
+    // Unbuffered, because the chunks are larger than the buffer of QFile
+    QFile source_file(job.sourcePath);
+    if (!source_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        return tr("Error exporting track %1 to %2: %3. Stopping.").arg(
+                job.sourcePath, job.destPath, source_file.errorString());
+    }
+    QFile dest_file(job.destPath);
+    if (!dest_file.open(QIODevice::WriteOnly | QIODevice::Truncate |
+            QIODevice::Unbuffered)) {
+        return tr("Error exporting track %1 to %2: %3. Stopping.").arg(
+                job.sourcePath, job.destPath, dest_file.errorString());
+    }
+
+    QString error_string;
+    qint64 bytesCopied = 0;
+#ifdef __LINUX__
+    // sendfile() copies in the kernel without a round trip of the data
+    // through this buffer. Older kernels do not support regular files as
+    // the destination, then the buffer is used.
+    bool useSendfile = true;
+#endif
+    std::vector<char> buffer;
+    while (!load_atomic(m_bStop)) {
+        qint64 chunkBytes = -1;
+#ifdef __LINUX__
+        if (useSendfile) {
+            const ssize_t rc = sendfile(dest_file.handle(), source_file.handle(),
+                    nullptr, static_cast<size_t>(kCopyChunkBytes));
+            if (rc >= 0) {
+                chunkBytes = rc;
+            } else if (bytesCopied == 0 && (errno == EINVAL || errno == ENOSYS)) {
+                useSendfile = false;
+            } else {
+                error_string = QString::fromLocal8Bit(strerror(errno));
+                break;
+            }
+        }
+#endif
+        if (chunkBytes < 0) {
+            if (buffer.empty()) {
+                buffer.resize(kCopyChunkBytes);
+            }
+            chunkBytes = source_file.read(buffer.data(), kCopyChunkBytes);
+            if (chunkBytes < 0) {
+                error_string = source_file.errorString();
+                break;
+            }
+            if (dest_file.write(buffer.data(), chunkBytes) != chunkBytes) {
+                error_string = dest_file.errorString();
+                break;
+            }
+        }
+        if (chunkBytes == 0) {
+            // End of file
+            return QString();
+        }
+        bytesCopied += chunkBytes;
+        m_bytesCopied += chunkBytes;
+    }
+
+    // Canceled or failed, don't leave a truncated file behind
+    dest_file.close();
+    dest_file.remove();
+    if (error_string.isEmpty()) {
+        return QString();
     }
+    return tr("Error exporting track %1 to %2: %3. Stopping.").arg(
+            job.sourcePath, job.destPath, error_string);
 }
 
 TrackExportWorker::OverwriteAnswer TrackExportWorker::makeOverwriteRequest(
@@ -190,6 +437,6 @@ TrackExportWorker::OverwriteAnswer TrackExportWorker::makeOverwriteRequest(
 }
 
 void TrackExportWorker::stop() {
-    // We'll wait for the current file to finish copying, then stop.
+    // The streams stop within a chunk and remove their unfinished files.
     m_bStop = true;
 }
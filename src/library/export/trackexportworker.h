@@ -1,18 +1,25 @@
 #ifndef TRACKEXPORTWORKER_H
 #define TRACKEXPORTWORKER_H
 
+#include <QMutex>
 #include <QObject>
 #include <QScopedPointer>
 #include <QString>
+#include <QStringList>
 #include <QThread>
+#include <QWaitCondition>
+#include <atomic>
 #include <future>
 
 #include "track/track.h"
 
 // A QThread class for copying a list of files to a single destination directory.
-// Currently does not preserve subdirectory relationships.  This class performs
-// all copies in a blocking style within its own thread.  May be canceled from
-// another thread.
+// Currently does not preserve subdirectory relationships.  The questions about
+// existing files are asked first, then the files are copied by several
+// streams at once if the destination is an SSD or a network share, and one at
+// a time to slow USB sticks and hard disks.  Existing files with the size of
+// the source that are not older are skipped without asking, so an export can
+// be repeated quickly.  May be canceled from another thread.
 class TrackExportWorker : public QThread {
     Q_OBJECT
   public:
@@ -38,6 +45,12 @@ class TrackExportWorker : public QThread {
             : m_destDir(destDir), m_tracks(tracks) { }
     virtual ~TrackExportWorker() { };
 
+    // The number of files that are copied at once. 0, the default, chooses
+    // by the device of the destination directory.
+    void setCopyStreams(int streams) {
+        m_copyStreams = streams;
+    }
+
     // exports ALL the tracks.  Thread joins on success or failure.
     void run() override;
 
@@ -47,7 +60,7 @@ class TrackExportWorker : public QThread {
         return m_errorMessage;
     }
 
-    // Cancels the export after the current copy operation.
+    // Cancels the export.  Files that are being copied are removed.
     // May be called from another thread.
     void stop();
 
@@ -61,16 +74,34 @@ class TrackExportWorker : public QThread {
             QString filename,
             std::promise<TrackExportWorker::OverwriteAnswer>* promise);
     void progress(QString filename, int progress, int count);
+    // Emitted a few times per second while the files are copied.  The bytes
+    // of skipped files are not included.
+    void bytesProgress(qint64 bytesCopied, qint64 bytesTotal);
     void canceled();
 
   private:
-    // Copies the file at source_fileinfo to the destination directory with the
-    // name given by dest_filename (not a full path).  If the destination file
-    // exists, will emit an overwrite request signal to ask how to proceed.
-    // On unrecoverable error, sets the error message and stops the export
-    // process entirely.
-    void copyFile(const QFileInfo& source_fileinfo,
-                  const QString& dest_filename);
+    struct CopyJob {
+        QString sourcePath;
+        QString destPath;
+        QString filename;
+    };
+
+    // Decides if the file at source_fileinfo needs to be copied to the
+    // destination directory with the name given by dest_filename (not a full
+    // path).  If the destination file exists and differs, will emit an
+    // overwrite request signal to ask how to proceed.  On unrecoverable
+    // error, sets the error message and stops the export process entirely.
+    bool prepareCopy(const QFileInfo& source_fileinfo,
+                     const QString& dest_filename);
+
+    // Runs the copy jobs and emits the progress until all are done or the
+    // export is stopped.
+    void copyFiles(int done, int count);
+    // The loop of a copy stream, which takes the next job until none is left
+    void copyStream();
+    // Returns an error message on failure, or an empty string on success or
+    // when the export has been stopped.
+    QString copyFileContents(const CopyJob& job);
 
     // Emit a signal requesting overwrite mode, and block until we get an
     // answer.  Updates m_overwriteMode appropriately.
@@ -82,6 +113,16 @@ class TrackExportWorker : public QThread {
     OverwriteMode m_overwriteMode = OverwriteMode::ASK;
     const QString m_destDir;
     const QList<TrackPointer> m_tracks;
+    int m_copyStreams = 0;
+
+    // Guards the copy jobs and the error message while the streams run
+    QMutex m_mutex;
+    QWaitCondition m_jobFinished;
+    QList<CopyJob> m_jobs;
+    int m_nextJob = 0;
+    int m_runningStreams = 0;
+    QStringList m_finishedFilenames;
+    std::atomic<qint64> m_bytesCopied{0};
 };
 
 #endif  // TRACKEXPORTWORKER_H
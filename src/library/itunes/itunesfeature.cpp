@@ -20,6 +20,12 @@
 
 const QString ITunesFeature::ITDB_PATH_KEY = "mixxx.itunesfeature.itdbpath";
 
+namespace {
+
+const QString kImportStateKey = "mixxx.itunesfeature.importstate";
+
+} // anonymous namespace
+
 QString localhost_token() {
 #if defined(__WINDOWS__)
     return "//localhost/";
@@ -156,17 +162,9 @@ void ITunesFeature::activate(bool forceReload) {
             settings.setValue(ITDB_PATH_KEY, m_dbfile);
         }
         m_isActivated =  true;
-        // Ususally the maximum number of threads
-        // is > 2 depending on the CPU cores
-        // Unfortunately, within VirtualBox
-        // the maximum number of allowed threads
-        // is 1 at all times We'll need to increase
-        // the number to > 1, otherwise importing the music collection
-        // takes place when the GUI threads terminates, i.e., on
-        // Mixxx shutdown.
-        QThreadPool::globalInstance()->setMaxThreadCount(4); //Tobias decided to use 4
         // Let a worker thread do the XML parsing
-        m_future = QtConcurrent::run(this, &ITunesFeature::importLibrary);
+        m_future = QtConcurrent::run(&m_importThreadPool,
+                                     this, &ITunesFeature::importLibrary);
         m_future_watcher.setFuture(m_future);
         m_title = tr("(loading) iTunes");
         // calls a slot in the sidebar model such that 'iTunes (isLoading)' is displayed.
@@ -331,8 +329,16 @@ TreeItem* ITunesFeature::importLibrary() {
     QThread* thisThread = QThread::currentThread();
     thisThread->setPriority(QThread::LowPriority);
 
+    // The tables are still in sync with an unchanged library
+    const QString importState = importStateOfFile(m_dbfile);
+    if (isImportUpToDate(m_database, kImportStateKey, importState)) {
+        qDebug() << "iTunes music collection is unchanged";
+        return loadPlaylists();
+    }
+
     //Delete all table entries of iTunes feature
     ScopedTransaction transaction(m_database);
+    setImportState(m_database, kImportStateKey, QString());
     clearTable("itunes_playlist_tracks");
     clearTable("itunes_library");
     clearTable("itunes_playlists");
@@ -361,6 +367,7 @@ TreeItem* ITunesFeature::importLibrary() {
     TreeItem* playlist_root = NULL;
     while (!xml.atEnd() && !m_cancelImport) {
         xml.readNext();
+        reportImportProgress(xml);
         if (xml.isStartElement()) {
             if (xml.name() == "key") {
                 QString key = xml.readElementText();
@@ -396,6 +403,10 @@ TreeItem* ITunesFeature::importLibrary() {
         }
     }
 
+    if (!xml.hasError() && !m_cancelImport) {
+        setImportState(m_database, kImportStateKey, importState);
+    }
+
     // Even if an error occurred, commit the transaction. The file may have been
     // half-parsed.
     transaction.commit();
@@ -428,6 +439,7 @@ void ITunesFeature::parseTracks(QXmlStreamReader &xml) {
     //read all sunsequent <dict> until we reach the closing ENTRY tag
     while (!xml.atEnd() && !m_cancelImport) {
         xml.readNext();
+        reportImportProgress(xml);
 
         if (xml.isStartElement()) {
             if (xml.name() == "dict") {
@@ -634,6 +646,21 @@ TreeItem* ITunesFeature::parsePlaylists(QXmlStreamReader &xml) {
     return rootItem;
 }
 
+TreeItem* ITunesFeature::loadPlaylists() {
+    TreeItem* rootItem = new TreeItem(this);
+    QSqlQuery query(m_database);
+    query.prepare("SELECT name FROM itunes_playlists ORDER BY id");
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        delete rootItem;
+        return NULL;
+    }
+    while (query.next()) {
+        rootItem->appendChild(query.value(0).toString());
+    }
+    return rootItem;
+}
+
 bool ITunesFeature::readNextStartElement(QXmlStreamReader& xml) {
     QXmlStreamReader::TokenType token = QXmlStreamReader::NoToken;
     while (token != QXmlStreamReader::EndDocument && token != QXmlStreamReader::Invalid) {
@@ -757,6 +784,11 @@ void ITunesFeature::clearTable(QString table_name) {
     }
 }
 
+void ITunesFeature::onImportProgress(int percent) {
+    m_title = tr("(loading %1%) iTunes").arg(percent);
+    emit(featureIsLoading(this, false));
+}
+
 void ITunesFeature::onTrackCollectionLoaded() {
     std::unique_ptr<TreeItem> root(m_future.result());
     if (root) {
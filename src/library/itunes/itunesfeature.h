@@ -37,6 +37,9 @@ class ITunesFeature : public BaseExternalLibraryFeature {
     void onRightClick(const QPoint& globalPos);
     void onTrackCollectionLoaded();
 
+  protected:
+    void onImportProgress(int percent) override;
+
   private:
     virtual BaseSqlTableModel* getPlaylistModelForPlaylist(QString playlist);
     static QString getiTunesMusicPath();
@@ -46,6 +49,8 @@ class ITunesFeature : public BaseExternalLibraryFeature {
     void parseTracks(QXmlStreamReader &xml);
     void parseTrack(QXmlStreamReader &xml, QSqlQuery &query);
     TreeItem* parsePlaylists(QXmlStreamReader &xml);
+    // Constructs the childmodel from the playlists of a previous import
+    TreeItem* loadPlaylists();
     void parsePlaylist(QXmlStreamReader &xml, QSqlQuery &query1,
                        QSqlQuery &query2, TreeItem*);
     void clearTable(QString table_name);
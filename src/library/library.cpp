@@ -74,7 +74,8 @@ Library::Library(
       m_pPlaylistFeature(nullptr),
       m_pCrateFeature(nullptr),
       m_pAnalysisFeature(nullptr),
-      m_scanner(pDbConnectionPool, m_pTrackCollection, pConfig) {
+      m_scanner(pDbConnectionPool, m_pTrackCollection, pConfig),
+      m_selectThread(pDbConnectionPool) {
 
     QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
 
@@ -89,6 +90,7 @@ Library::Library(
 
     kLogger.info() << "Connecting database";
     m_pTrackCollection->connectDatabase(dbConnection);
+    m_pTrackCollection->setSelectThread(&m_selectThread);
 
     qRegisterMetaType<Library::RemovalType>("Library::RemovalType");
 
@@ -187,6 +189,7 @@ Library::~Library() {
 
     delete m_pLibraryControl;
 
+    m_pTrackCollection->setSelectThread(nullptr);
     kLogger.info() << "Disconnecting database";
     m_pTrackCollection->disconnectDatabase();
 
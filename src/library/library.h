@@ -19,6 +19,7 @@
 #include "library/coverartcache.h"
 #include "library/setlogfeature.h"
 #include "library/scanner/libraryscanner.h"
+#include "library/sqlselectthread.h"
 #include "util/db/dbconnectionpool.h"
 
 class TrackModel;
@@ -141,6 +142,7 @@ class Library: public QObject,
     CrateFeature* m_pCrateFeature;
     AnalysisFeature* m_pAnalysisFeature;
     LibraryScanner m_scanner;
+    SqlSelectThread m_selectThread;
     QFont m_trackTableFont;
     int m_iTrackTableRowHeight;
     QScopedPointer<ControlObject> m_pKeyNotation;
@@ -2,6 +2,7 @@
 // Created 8/23/2009 by RJ Ryan (rryan@mit.edu)
 
 #include <QtDebug>
+#include <QDir>
 
 #include "library/mixxxlibraryfeature.h"
 
@@ -21,6 +22,20 @@
 #include "library/dlghidden.h"
 #include "library/dlgmissing.h"
 
+namespace {
+
+// Created by the schema migration if SQLite supports it, see schema.xml
+const QString kFullTextSearchTable = "library_fts";
+
+// The number of columns that the library keeps the track order of
+const int kDefaultSortIndexCount = 4;
+
+const QString kSortIndexFileName = "library_sort.index";
+
+const QString kSnapshotFileName = "library_cache.snapshot";
+
+} // anonymous namespace
+
 MixxxLibraryFeature::MixxxLibraryFeature(Library* pLibrary,
                                          TrackCollection* pTrackCollection,
                                          UserSettingsPointer pConfig)
@@ -90,6 +105,19 @@ MixxxLibraryFeature::MixxxLibraryFeature(Library* pLibrary,
 
     BaseTrackCache* pBaseTrackCache = new BaseTrackCache(
             pTrackCollection, tableName, LIBRARYTABLE_ID, columns, true);
+    if (m_pConfig->getValue(ConfigKey("[Library]", "FullTextSearch"), false)) {
+        if (pTrackCollection->database().tables().contains(kFullTextSearchTable)) {
+            pBaseTrackCache->setFullTextSearchTable(kFullTextSearchTable);
+        } else {
+            qWarning() << "Full-text search is not supported by the database";
+        }
+    }
+    pBaseTrackCache->setSortIndexes(
+            m_pConfig->getValue(ConfigKey("[Library]", "SortIndexCount"),
+                    kDefaultSortIndexCount),
+            QDir(m_pConfig->getSettingsPath()).filePath(kSortIndexFileName));
+    pBaseTrackCache->setSnapshotFile(
+            QDir(m_pConfig->getSettingsPath()).filePath(kSnapshotFileName));
     connect(&m_trackDao, SIGNAL(trackDirty(TrackId)),
             pBaseTrackCache, SLOT(slotTrackDirty(TrackId)));
     connect(&m_trackDao, SIGNAL(trackClean(TrackId)),
@@ -117,6 +145,8 @@ MixxxLibraryFeature::MixxxLibraryFeature(Library* pLibrary,
 }
 
 MixxxLibraryFeature::~MixxxLibraryFeature() {
+    // The database is still open
+    m_pBaseTrackCache->writeSnapshot();
     delete m_pLibraryTableModel;
 }
 
@@ -149,7 +179,7 @@ TreeItemModel* MixxxLibraryFeature::getChildModel() {
 
 void MixxxLibraryFeature::refreshLibraryModels() {
     if (m_pLibraryTableModel) {
-        m_pLibraryTableModel->select();
+        m_pLibraryTableModel->selectAsync();
     }
     if (m_pMissingView) {
         m_pMissingView->onShow();
@@ -12,10 +12,67 @@
 //
 
 #include <QtDebug>
+#include <QDir>
 #include <QFile>
 #include <QIODevice>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QVector>
+
+#include <vector>
 
 #include "library/parser.h"
+#include "util/memory.h"
+
+namespace {
+
+// Checking files is bound by the latency of the (network) file system
+const int kResolverThreadCount = 8;
+// The locations that are checked by each task
+const int kResolverBatchSize = 64;
+
+QString resolveFilepath(const QString& trackLocation, const QDir& baseDir) {
+    if (QFile::exists(trackLocation)) {
+        return trackLocation;
+    }
+    // Try relative to the playlist
+    QString rel = baseDir.filePath(trackLocation);
+    if (QFile::exists(rel)) {
+        return rel;
+    }
+    // We couldn't match this to a real file so ignore it
+    return QString();
+}
+
+// Resolves a range of the locations into the preallocated results
+class FilepathResolver: public QRunnable {
+  public:
+    FilepathResolver(
+            const QList<QString>& trackLocations,
+            const QString& basepath,
+            int first,
+            int count,
+            QString* pFilepaths)
+            : m_trackLocations(trackLocations.mid(first, count)),
+              m_basepath(basepath),
+              m_pFilepaths(pFilepaths + first) {
+    }
+
+    void run() override {
+        // Each task uses its own QDir, which caches its path lazily
+        const QDir baseDir(m_basepath);
+        for (int i = 0; i < m_trackLocations.size(); ++i) {
+            m_pFilepaths[i] = resolveFilepath(m_trackLocations[i], baseDir);
+        }
+    }
+
+  private:
+    const QList<QString> m_trackLocations;
+    const QString m_basepath;
+    QString* const m_pFilepaths;
+};
+
+} // anonymous namespace
 
 /**
    @author Ingo Kossyk (kossyki@cs.tu-berlin.de)
@@ -49,6 +106,42 @@ bool Parser::isFilepath(QString sFilepath) {
     return exists;
 }
 
+// static
+QList<QString> Parser::resolveFilepaths(
+        const QList<QString>& trackLocations, const QString& basepath) {
+    // Each task writes only its own range of the results
+    QVector<QString> filepaths(trackLocations.size());
+    QString* pFilepaths = filepaths.data();
+    std::vector<std::unique_ptr<FilepathResolver>> resolvers;
+    for (int first = 0; first < trackLocations.size();
+            first += kResolverBatchSize) {
+        resolvers.push_back(std::make_unique<FilepathResolver>(
+                trackLocations, basepath, first, kResolverBatchSize,
+                pFilepaths));
+    }
+    if (resolvers.size() == 1) {
+        // Not worth a thread
+        resolvers.front()->run();
+    } else if (!resolvers.empty()) {
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(kResolverThreadCount);
+        for (const auto& pResolver : resolvers) {
+            pResolver->setAutoDelete(false);
+            threadPool.start(pResolver.get());
+        }
+        threadPool.waitForDone();
+    }
+
+    QList<QString> resolved;
+    resolved.reserve(filepaths.size());
+    for (const auto& filepath : filepaths) {
+        if (!filepath.isEmpty()) {
+            resolved.append(filepath);
+        }
+    }
+    return resolved;
+}
+
 bool Parser::isBinary(QString filename) {
     QFile file(filename);
 
@@ -54,6 +54,12 @@ protected:
     bool isBinary(QString);
     /**Checks if the given string represents a local filepath**/
     bool isFilepath(QString);
+    // Returns the local files of the parsed locations in their order. A
+    // location that does not exist is tried relative to the basepath of the
+    // playlist, otherwise it is skipped. The files are checked in parallel,
+    // which matters for long playlists on network drives.
+    static QList<QString> resolveFilepaths(
+            const QList<QString>& trackLocations, const QString& basepath);
     // check for Utf8 encoding
     static bool isUtf8(const char* string);
 };
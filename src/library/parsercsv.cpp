@@ -60,6 +60,7 @@ QList<QString> ParserCsv::parse(QString sFilename) {
         }
 
         file.close();
+        m_sLocations = resolveFilepaths(m_sLocations, basepath);
 
         if(m_sLocations.count() != 0)
             return m_sLocations;
@@ -79,7 +79,7 @@ QList<QString> ParserM3u::parse(QString sFilename)
         }
 
         while(!textstream.atEnd()) {
-            QString sLine = getFilepath(&textstream, basepath);
+            QString sLine = getFilepath(&textstream);
             if(sLine.isEmpty())
                 break;
 
@@ -88,6 +88,7 @@ QList<QString> ParserM3u::parse(QString sFilename)
         }
 
         file.close();
+        m_sLocations = resolveFilepaths(m_sLocations, basepath);
         return m_sLocations;
     }
 
@@ -96,7 +97,7 @@ QList<QString> ParserM3u::parse(QString sFilename)
 }
 
 
-QString ParserM3u::getFilepath(QTextStream *stream, QString basepath)
+QString ParserM3u::getFilepath(QTextStream *stream)
 {
     QString textline,filename = "";
 
@@ -117,15 +118,9 @@ QString ParserM3u::getFilepath(QTextStream *stream, QString basepath)
             //qDebug() << "QURL UTF-8: " << location;
             QString trackLocation = location.toString();
             //qDebug() << "UTF8 TrackLocation:" << trackLocation;
-            if(isFilepath(trackLocation)) {
+            // The files are checked after parsing, see resolveFilepaths()
+            if (!trackLocation.isEmpty()) {
                 return trackLocation;
-            } else {
-                // Try relative to m3u dir
-                QString rel = QDir(basepath).filePath(trackLocation);
-                if (isFilepath(rel)) {
-                    return rel;
-                }
-                // We couldn't match this to a real file so ignore it
             }
         }
         textline = stream->readLine();
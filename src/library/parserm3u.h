@@ -33,8 +33,8 @@ public:
     static bool writeM3U8File(const QString &file_str, QList<QString> &items, bool useRelativePath);
 
 private:
-    /**Reads a line from the file and returns filepath if a valid file**/
-    QString getFilepath(QTextStream *, QString);
+    /**Reads the next location from the file**/
+    QString getFilepath(QTextStream *);
 
 
 };
@@ -63,7 +63,7 @@ QList<QString> ParserPls::parse(QString sFilename)
         QTextStream textstream(ba.constData());
 
         while(!textstream.atEnd()) {
-            QString psLine = getFilepath(&textstream, basepath);
+            QString psLine = getFilepath(&textstream);
             if(psLine.isNull()) {
                 break;
             } else {
@@ -73,6 +73,7 @@ QList<QString> ParserPls::parse(QString sFilename)
         }
 
         file.close();
+        m_sLocations = resolveFilepaths(m_sLocations, basepath);
 
         if(m_sLocations.count() != 0)
             return m_sLocations;
@@ -107,7 +108,7 @@ long ParserPls::getNumEntries(QTextStream *stream)
 }
 
 
-QString ParserPls::getFilepath(QTextStream *stream, QString basepath)
+QString ParserPls::getFilepath(QTextStream *stream)
 {
     QString textline,filename = "";
     textline = stream->readLine();
@@ -129,16 +130,9 @@ QString ParserPls::getFilepath(QTextStream *stream, QString basepath)
             QUrl location = QUrl::fromEncoded(strlocbytes);
             QString trackLocation = location.toString();
             //qDebug() << trackLocation;
-
-            if(isFilepath(trackLocation)) {
+            // The files are checked after parsing, see resolveFilepaths()
+            if (!trackLocation.isEmpty()) {
                 return trackLocation;
-            } else {
-                // Try relative to m3u dir
-                QString rel = QDir(basepath).filePath(trackLocation);
-                if (isFilepath(rel)) {
-                    return rel;
-                }
-                // We couldn't match this to a real file so ignore it
             }
         }
         textline = stream->readLine();
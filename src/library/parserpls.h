@@ -32,7 +32,7 @@ class ParserPls : public Parser {
     /**Returns the Number of entries in the pls file**/
     long getNumEntries(QTextStream*);
     /**Reads a line from the file and returns filepath**/
-    QString getFilepath(QTextStream*, QString);
+    QString getFilepath(QTextStream*);
 
 };
 
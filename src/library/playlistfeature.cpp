@@ -125,55 +125,68 @@ bool PlaylistFeature::dragMoveAcceptChild(const QModelIndex& index, QUrl url) {
     return !locked && formatSupported;
 }
 
-void PlaylistFeature::buildPlaylistList() {
-    m_playlistList.clear();
+namespace {
 
-    QString queryString = QString(
+// The number and duration of the tracks of each playlist are maintained
+// by triggers (see schema.xml)
+const QString kPlaylistSummariesViewQuery =
         "CREATE TEMPORARY VIEW IF NOT EXISTS PlaylistsCountsDurations "
         "AS SELECT "
         "  Playlists.id AS id, "
         "  Playlists.name AS name, "
         "  LOWER(Playlists.name) AS sort_name, "
-        "  COUNT(case library.mixxx_deleted when 0 then 1 else null end) AS count, "
-        "  SUM(case library.mixxx_deleted when 0 then library.duration else 0 end) AS durationSeconds "
+        "  IFNULL(playlist_summaries.track_count, 0) AS count, "
+        "  IFNULL(playlist_summaries.track_duration, 0) AS durationSeconds "
         "FROM Playlists "
-        "LEFT JOIN PlaylistTracks ON PlaylistTracks.playlist_id = Playlists.id "
-        "LEFT JOIN library ON PlaylistTracks.track_id = library.id "
-        "WHERE Playlists.hidden = 0 "
-        "GROUP BY Playlists.id");
-    queryString.append(mixxx::DbConnection::collateLexicographically(
-            " ORDER BY sort_name"));
+        "LEFT JOIN playlist_summaries ON playlist_summaries.playlist_id = Playlists.id "
+        "WHERE Playlists.hidden = 0";
+
+QString formatPlaylistLabel(const QSqlQuery& query) {
+    return QString("%1 (%2) %3").arg(
+            query.value(query.record().indexOf("name")).toString(),
+            QString::number(query.value(query.record().indexOf("count")).toInt()),
+            mixxx::Duration::formatSeconds(
+                    query.value(query.record().indexOf("durationSeconds")).toInt()));
+}
+
+} // anonymous namespace
+
+void PlaylistFeature::buildPlaylistList() {
+    m_playlistList.clear();
+
     QSqlQuery query(m_pTrackCollection->database());
-    if (!query.exec(queryString)) {
+    if (!query.exec(kPlaylistSummariesViewQuery)) {
         LOG_FAILED_QUERY(query);
     }
 
     // Setup the sidebar playlist model
-    QSqlTableModel playlistTableModel(this, m_pTrackCollection->database());
-    playlistTableModel.setTable("PlaylistsCountsDurations");
-    playlistTableModel.select();
-    while (playlistTableModel.canFetchMore()) {
-        playlistTableModel.fetchMore();
+    query.setForwardOnly(true);
+    if (!query.exec(mixxx::DbConnection::collateLexicographically(
+            "SELECT id, name, count, durationSeconds "
+            "FROM PlaylistsCountsDurations ORDER BY sort_name"))) {
+        LOG_FAILED_QUERY(query);
+        return;
+    }
+    while (query.next()) {
+        m_playlistList.append(qMakePair(
+                query.value(query.record().indexOf("id")).toInt(),
+                formatPlaylistLabel(query)));
+    }
+}
+
+QString PlaylistFeature::fetchPlaylistLabel(int playlistId) {
+    QSqlQuery query(m_pTrackCollection->database());
+    if (!query.exec(kPlaylistSummariesViewQuery)) {
+        LOG_FAILED_QUERY(query);
     }
-    QSqlRecord record = playlistTableModel.record();
-    int nameColumn = record.indexOf("name");
-    int idColumn = record.indexOf("id");
-    int countColumn = record.indexOf("count");
-    int durationColumn = record.indexOf("durationSeconds");
-
-    for (int row = 0; row < playlistTableModel.rowCount(); ++row) {
-        int id = playlistTableModel.data(
-            playlistTableModel.index(row, idColumn)).toInt();
-        QString name = playlistTableModel.data(
-            playlistTableModel.index(row, nameColumn)).toString();
-        int count = playlistTableModel.data(
-            playlistTableModel.index(row, countColumn)).toInt();
-        int duration = playlistTableModel.data(
-            playlistTableModel.index(row, durationColumn)).toInt();
-        m_playlistList.append(qMakePair(id, QString("%1 (%2) %3")
-                                        .arg(name, QString::number(count),
-                                                mixxx::Duration::formatSeconds(duration))));
+    query.prepare("SELECT id, name, count, durationSeconds "
+                  "FROM PlaylistsCountsDurations WHERE id = :id");
+    query.bindValue(":id", playlistId);
+    if (!query.exec() || !query.next()) {
+        LOG_FAILED_QUERY(query);
+        return BasePlaylistFeature::fetchPlaylistLabel(playlistId);
     }
+    return formatPlaylistLabel(query);
 }
 
 void PlaylistFeature::decorateChild(TreeItem* item, int playlist_id) {
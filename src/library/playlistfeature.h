@@ -41,6 +41,7 @@ class PlaylistFeature : public BasePlaylistFeature {
 
  protected:
     void buildPlaylistList();
+    QString fetchPlaylistLabel(int playlistId) override;
     void decorateChild(TreeItem *pChild, int playlist_id);
 
   private:
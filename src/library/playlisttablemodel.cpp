@@ -9,7 +9,8 @@ PlaylistTableModel::PlaylistTableModel(QObject* parent,
                                        bool showAll)
         : BaseSqlTableModel(parent, pTrackCollection, settingsNamespace),
           m_iPlaylistId(-1),
-          m_showAll(showAll) {
+          m_showAll(showAll),
+          m_bRowsPatched(false) {
 }
 
 PlaylistTableModel::~PlaylistTableModel() {
@@ -22,16 +23,19 @@ void PlaylistTableModel::setTableModel(int playlistId) {
         return;
     }
 
-    m_iPlaylistId = playlistId;
-
     if (!m_showAll) {
         // From Mixxx 2.1 we drop tracks that have been explicitly deleted
         // in the library (mixxx_deleted = 0) from playlists.
         // These invisible tracks, consuming a playlist position number where
         // a source user of confusion in the past.
-        m_pTrackCollection->getPlaylistDAO().removeHiddenTracks(m_iPlaylistId);
+        // This is done before switching to the playlist, so that the rows of
+        // the previous playlist are not patched.
+        m_pTrackCollection->getPlaylistDAO().removeHiddenTracks(playlistId);
     }
 
+    m_iPlaylistId = playlistId;
+    m_bRowsPatched = false;
+
     QString playlistTableName = "playlist_" + QString::number(m_iPlaylistId);
     QSqlQuery query(m_database);
     FieldEscaper escaper(m_database);
@@ -70,6 +74,18 @@ void PlaylistTableModel::setTableModel(int playlistId) {
 
     connect(&m_pTrackCollection->getPlaylistDAO(), SIGNAL(changed(int)),
             this, SLOT(playlistChanged(int)));
+    connect(&m_pTrackCollection->getPlaylistDAO(),
+            SIGNAL(tracksInserted(int, int, const QList<TrackId>&)),
+            this, SLOT(playlistTracksInserted(int, int, const QList<TrackId>&)),
+            Qt::UniqueConnection);
+    connect(&m_pTrackCollection->getPlaylistDAO(),
+            SIGNAL(positionsRemoved(int, const QList<int>&)),
+            this, SLOT(playlistPositionsRemoved(int, const QList<int>&)),
+            Qt::UniqueConnection);
+    connect(&m_pTrackCollection->getPlaylistDAO(),
+            SIGNAL(trackMoved(int, int, int)),
+            this, SLOT(playlistTrackMoved(int, int, int)),
+            Qt::UniqueConnection);
 }
 
 int PlaylistTableModel::addTracks(const QModelIndex& index,
@@ -268,7 +284,56 @@ TrackModel::CapabilitiesFlags PlaylistTableModel::getCapabilities() const {
 }
 
 void PlaylistTableModel::playlistChanged(int playlistId) {
-    if (playlistId == m_iPlaylistId) {
-        select(); // Repopulate the data model.
+    if (playlistId != m_iPlaylistId) {
+        return;
+    }
+    if (m_bRowsPatched) {
+        // Sent after the change that has been patched
+        m_bRowsPatched = false;
+        return;
+    }
+    select(); // Repopulate the data model.
+}
+
+bool PlaylistTableModel::canPatchPositions(int tracksInPlaylist) const {
+    if (!isSortedByTableColumn(
+            fieldIndex(ColumnCache::COLUMN_PLAYLISTTRACKSTABLE_POSITION),
+            Qt::AscendingOrder)) {
+        return false;
+    }
+    // The positions are unique, so the last one is the number of tracks
+    // if there are no gaps
+    return m_pTrackCollection->getPlaylistDAO().getMaxPosition(m_iPlaylistId) ==
+            tracksInPlaylist;
+}
+
+void PlaylistTableModel::playlistTracksInserted(int playlistId, int position,
+        const QList<TrackId>& trackIds) {
+    if (playlistId != m_iPlaylistId) {
+        return;
+    }
+    m_bRowsPatched = canPatchPositions(tableRowCount() + trackIds.size()) &&
+            insertTableRows(position - 1, trackIds);
+}
+
+void PlaylistTableModel::playlistPositionsRemoved(int playlistId,
+        const QList<int>& positions) {
+    if (playlistId != m_iPlaylistId) {
+        return;
+    }
+    QList<int> tableRows;
+    for (int position : positions) {
+        tableRows.append(position - 1);
+    }
+    m_bRowsPatched = canPatchPositions(tableRowCount() - positions.size()) &&
+            removeTableRows(tableRows);
+}
+
+void PlaylistTableModel::playlistTrackMoved(int playlistId, int oldPosition,
+        int newPosition) {
+    if (playlistId != m_iPlaylistId) {
+        return;
     }
+    m_bRowsPatched = canPatchPositions(tableRowCount()) &&
+            moveTableRow(oldPosition - 1, newPosition - 1);
 }
@@ -34,10 +34,24 @@ class PlaylistTableModel : public BaseSqlTableModel {
 
   private slots:
     void playlistChanged(int playlistId);
+    // Patch the rows of a playlist that is sorted by position, e.g. when a
+    // played track is appended to a long history playlist
+    void playlistTracksInserted(int playlistId, int position,
+                                const QList<TrackId>& trackIds);
+    void playlistPositionsRemoved(int playlistId, const QList<int>& positions);
+    void playlistTrackMoved(int playlistId, int oldPosition, int newPosition);
 
   private:
+    // Returns true if the rows are in the order of the positions and the
+    // positions count from 1 without gaps after the playlist has been
+    // changed to the given number of tracks, so that the position of each
+    // track is its row in the table
+    bool canPatchPositions(int tracksInPlaylist) const;
+
     int m_iPlaylistId;
     bool m_showAll;
+    // The rows of the last change have been patched and need no select()
+    bool m_bRowsPatched;
 };
 
 #endif
@@ -1,6 +1,7 @@
 #include <QPainter>
 #include <QPushButton>
 
+#include "library/cellpixmapcache.h"
 #include "library/previewbuttondelegate.h"
 #include "library/trackmodel.h"
 #include "mixer/playerinfo.h"
@@ -84,21 +85,29 @@ void PreviewButtonDelegate::paint(QPainter *painter,
         return;
     }
 
-    m_pButton->setGeometry(option.rect);
     bool playing = m_pPreviewDeckPlay->toBool();
     // Check-state is whether the track is loaded (index.data()) and whether
     // it's playing.
-    m_pButton->setChecked(index.data().toBool() && playing);
+    const bool checked = index.data().toBool() && playing;
 
     if (option.state == QStyle::State_Selected) {
         painter->fillRect(option.rect, option.palette.base());
     }
 
-    painter->save();
-    // Render button at the desired position
-    painter->translate(option.rect.topLeft());
-    m_pButton->render(painter);
-    painter->restore();
+    const QString key = QString("preview|%1|%2|%3").arg(
+            checked ? "1" : "0",
+            QString::number(reinterpret_cast<quintptr>(m_pButton->style()), 16),
+            QString::number(m_pButton->palette().cacheKey(), 16));
+    CellPixmapCache::paint(painter, option.rect, key,
+            [this, &option, checked](QPainter* pPainter, const QRect& rect) {
+                m_pButton->setGeometry(option.rect);
+                m_pButton->setChecked(checked);
+                pPainter->save();
+                // Render button at the desired position
+                pPainter->translate(rect.topLeft());
+                m_pButton->render(pPainter);
+                pPainter->restore();
+            });
 }
 
 void PreviewButtonDelegate::updateEditorGeometry(QWidget *editor,
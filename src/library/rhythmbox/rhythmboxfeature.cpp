@@ -10,6 +10,26 @@
 #include "library/treeitem.h"
 #include "library/queryutil.h"
 
+namespace {
+
+const QString kImportStateKey = "mixxx.rhythmboxfeature.importstate";
+
+// Returns the location of a file of the Rhythmbox database or an empty
+// string if it does not exist
+QString rhythmboxFilePath(const QString& fileName) {
+    QString filePath = QDir::homePath() + "/.gnome2/rhythmbox/" + fileName;
+    if (QFile::exists(filePath)) {
+        return filePath;
+    }
+    filePath = QDir::homePath() + "/.local/share/rhythmbox/" + fileName;
+    if (QFile::exists(filePath)) {
+        return filePath;
+    }
+    return QString();
+}
+
+} // anonymous namespace
+
 RhythmboxFeature::RhythmboxFeature(QObject* parent, TrackCollection* pTrackCollection)
         : BaseExternalLibraryFeature(parent, pTrackCollection),
           m_pTrackCollection(pTrackCollection),
@@ -112,16 +132,8 @@ void RhythmboxFeature::activate() {
 
     if (!m_isActivated) {
         m_isActivated =  true;
-        // Ususally the maximum number of threads
-        // is > 2 depending on the CPU cores
-        // Unfortunately, within VirtualBox
-        // the maximum number of allowed threads
-        // is 1 at all times We'll need to increase
-        // the number to > 1, otherwise importing the music collection
-        // takes place when the GUI threads terminates, i.e., on
-        // Mixxx shutdown.
-        QThreadPool::globalInstance()->setMaxThreadCount(4); //Tobias decided to use 4
-        m_track_future = QtConcurrent::run(this, &RhythmboxFeature::importMusicCollection);
+        m_track_future = QtConcurrent::run(&m_importThreadPool,
+                this, &RhythmboxFeature::importMusicCollection);
         m_track_watcher.setFuture(m_track_future);
         m_title = "(loading) Rhythmbox";
         //calls a slot in the sidebar model such that 'Rhythmbox (isLoading)' is displayed.
@@ -145,12 +157,19 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
     qDebug() << "importMusicCollection Thread Id: " << QThread::currentThread();
      // Try and open the Rhythmbox DB. An API call which tells us where
      // the file is would be nice.
-    QFile db(QDir::homePath() + "/.gnome2/rhythmbox/rhythmdb.xml");
-    if (!db.exists()) {
-        db.setFileName(QDir::homePath() + "/.local/share/rhythmbox/rhythmdb.xml");
-        if (!db.exists()) {
-            return NULL;
-        }
+    const QString dbFilePath = rhythmboxFilePath("rhythmdb.xml");
+    if (dbFilePath.isEmpty()) {
+        return NULL;
+    }
+    QFile db(dbFilePath);
+
+    // The tables are still in sync if neither the tracks nor the playlists
+    // have changed
+    const QString importState = importStateOfFile(dbFilePath) + "|" +
+            importStateOfFile(rhythmboxFilePath("playlists.xml"));
+    if (isImportUpToDate(m_database, kImportStateKey, importState)) {
+        qDebug() << "Rhythmbox music collection is unchanged";
+        return loadPlaylists();
     }
 
     if (!db.open(QIODevice::ReadOnly | QIODevice::Text))
@@ -158,6 +177,7 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
 
     //Delete all table entries of Traktor feature
     ScopedTransaction transaction(m_database);
+    setImportState(m_database, kImportStateKey, QString());
     clearTable("rhythmbox_playlist_tracks");
     clearTable("rhythmbox_library");
     clearTable("rhythmbox_playlists");
@@ -175,6 +195,7 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
     QXmlStreamReader xml(&db);
     while (!xml.atEnd() && !m_cancelImport) {
         xml.readNext();
+        reportImportProgress(xml);
         if (xml.isStartElement() && xml.name() == "entry") {
             QXmlStreamAttributes attr = xml.attributes();
             //Check if we really parse a track and not album art information
@@ -196,21 +217,26 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
     if (m_cancelImport) {
         return NULL;
     }
-    return importPlaylists();
+    TreeItem* rootItem = importPlaylists();
+    if (rootItem && !m_cancelImport) {
+        setImportState(m_database, kImportStateKey, importState);
+    }
+    return rootItem;
 }
 
 TreeItem* RhythmboxFeature::importPlaylists() {
-    QFile db(QDir::homePath() + "/.gnome2/rhythmbox/playlists.xml");
-    if (!db.exists()) {
-        db.setFileName(QDir::homePath() + "/.local/share/rhythmbox/playlists.xml");
-        if (!db.exists()) {
-            return NULL;
-        }
+    const QString dbFilePath = rhythmboxFilePath("playlists.xml");
+    if (dbFilePath.isEmpty()) {
+        return NULL;
     }
+    QFile db(dbFilePath);
     //Open file
      if (!db.open(QIODevice::ReadOnly | QIODevice::Text))
         return NULL;
 
+    // Insert all playlists in a single transaction
+    ScopedTransaction transaction(m_database);
+
     QSqlQuery query_insert_to_playlists(m_database);
     query_insert_to_playlists.prepare("INSERT INTO rhythmbox_playlists (id, name) "
                                       "VALUES (:id, :name)");
@@ -261,11 +287,27 @@ TreeItem* RhythmboxFeature::importPlaylists() {
         return NULL;
     }
     db.close();
+    transaction.commit();
 
     return rootItem;
 
 }
 
+TreeItem* RhythmboxFeature::loadPlaylists() {
+    TreeItem* rootItem = new TreeItem(this);
+    QSqlQuery query(m_database);
+    query.prepare("SELECT name FROM rhythmbox_playlists ORDER BY id");
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        delete rootItem;
+        return NULL;
+    }
+    while (query.next()) {
+        rootItem->appendChild(query.value(0).toString());
+    }
+    return rootItem;
+}
+
 void RhythmboxFeature::importTrack(QXmlStreamReader &xml, QSqlQuery &query) {
     QString title;
     QString artist;
@@ -433,6 +475,11 @@ void RhythmboxFeature::clearTable(QString table_name) {
     }
 }
 
+void RhythmboxFeature::onImportProgress(int percent) {
+    m_title = tr("(loading %1%) Rhythmbox").arg(percent);
+    emit(featureIsLoading(this, false));
+}
+
 void RhythmboxFeature::onTrackCollectionLoaded() {
     std::unique_ptr<TreeItem> root(m_track_future.result());
     if (root) {
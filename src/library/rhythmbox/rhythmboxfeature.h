@@ -33,12 +33,17 @@ class RhythmboxFeature : public BaseExternalLibraryFeature {
     TreeItem* importMusicCollection();
     // processes the playlist entries
     TreeItem* importPlaylists();
+    // constructs the childmodel from the playlists of a previous import
+    TreeItem* loadPlaylists();
 
   public slots:
     void activate();
     void activateChild(const QModelIndex& index);
     void onTrackCollectionLoaded();
 
+  protected:
+    void onImportProgress(int percent) override;
+
   private:
     virtual BaseSqlTableModel* getPlaylistModelForPlaylist(QString playlist);
     // Removes all rows from a given table
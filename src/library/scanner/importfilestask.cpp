@@ -1,20 +1,29 @@
 #include "library/scanner/importfilestask.h"
 
+#include "library/dao/trackdao.h"
 #include "library/scanner/libraryscanner.h"
 #include "track/trackref.h"
 #include "util/timer.h"
 
+namespace {
+
+// The files of a large directory are split into tasks of this size, so
+// their tags are parsed by several threads of the pool
+const int kMaxFilesPerTask = 32;
+
+} // anonymous namespace
+
 ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
                                  const ScannerGlobalPointer scannerGlobal,
                                  const QString& dirPath,
-                                 const bool prevHashExists,
+                                 const qint64 modifiedTime,
                                  const int newHash,
                                  const QLinkedList<QFileInfo>& filesToImport,
                                  const QLinkedList<QFileInfo>& possibleCovers,
                                  SecurityTokenPointer pToken)
         : ScannerTask(pScanner, scannerGlobal),
           m_dirPath(dirPath),
-          m_prevHashExists(prevHashExists),
+          m_modifiedTime(modifiedTime),
           m_newHash(newHash),
           m_filesToImport(filesToImport),
           m_possibleCovers(possibleCovers),
@@ -23,7 +32,20 @@ ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
 
 void ImportFilesTask::run() {
     ScopedTimer timer("ImportFilesTask::run");
-    for (const QFileInfo& fileInfo: m_filesToImport) {
+    QLinkedList<QFileInfo> filesToImport = m_filesToImport;
+    const bool split = filesToImport.size() > kMaxFilesPerTask;
+    if (split) {
+        // The task with the last files stores the hash of the directory
+        QLinkedList<QFileInfo> remainingFiles;
+        while (filesToImport.size() > kMaxFilesPerTask) {
+            remainingFiles.prepend(filesToImport.takeLast());
+        }
+        m_pScanner->queueTask(
+                new ImportFilesTask(m_pScanner, m_scannerGlobal, m_dirPath,
+                                    m_modifiedTime, m_newHash, remainingFiles,
+                                    m_possibleCovers, m_pToken));
+    }
+    for (const QFileInfo& fileInfo: filesToImport) {
         // If a flag was raised telling us to cancel the library scan then stop.
         if (m_scannerGlobal->shouldCancel()) {
             setSuccess(false);
@@ -50,10 +72,21 @@ void ImportFilesTask::run() {
             }
             qDebug() << "Importing track" << trackLocation;
 
-            emit(addNewTrack(trackLocation));
+            // Parsing the tags is the most expensive part of the import and
+            // is done by the tasks in parallel. The tracks are inserted into
+            // the database in batches by the scanner thread.
+            TrackPointer pTrack = TrackDAO::resolveTrackToAdd(fileInfo, true);
+            if (pTrack && pTrack->thread() == QThread::currentThread()) {
+                // Like the tracks that are resolved by the scanner thread.
+                // The threads of the pool have no event loop.
+                pTrack->moveToThread(m_pScanner->thread());
+            }
+            emit(addNewTrack(trackLocation, pTrack));
         }
     }
-    // Insert or update the hash in the database.
-    emit(directoryHashedAndScanned(m_dirPath, !m_prevHashExists, m_newHash));
+    if (!split) {
+        // Insert or update the hash in the database.
+        emit(directoryHashedAndScanned(m_dirPath, m_newHash, m_modifiedTime));
+    }
     setSuccess(true);
 }
@@ -16,7 +16,7 @@ class ImportFilesTask : public ScannerTask {
     ImportFilesTask(LibraryScanner* pScanner,
                     const ScannerGlobalPointer scannerGlobal,
                     const QString& dirPath,
-                    const bool prevHashExists,
+                    const qint64 modifiedTime,
                     const int newHash,
                     const QLinkedList<QFileInfo>& filesToImport,
                     const QLinkedList<QFileInfo>& possibleCovers,
@@ -27,7 +27,7 @@ class ImportFilesTask : public ScannerTask {
 
   private:
     const QString m_dirPath;
-    const bool m_prevHashExists;
+    const qint64 m_modifiedTime;
     const int m_newHash;
     const QLinkedList<QFileInfo> m_filesToImport;
     const QLinkedList<QFileInfo> m_possibleCovers;
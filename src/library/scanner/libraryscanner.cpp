@@ -1,24 +1,54 @@
 #include "library/scanner/libraryscanner.h"
 
+#include <QTimer>
+
 #include "sources/soundsourceproxy.h"
 #include "library/scanner/recursivescandirectorytask.h"
 #include "library/scanner/libraryscannerdlg.h"
+#include "library/scanner/librarywatcher.h"
 #include "library/scanner/scannertask.h"
 #include "library/queryutil.h"
+#include "library/dao/settingsdao.h"
 #include "library/coverartutils.h"
 #include "library/trackcollection.h"
 #include "util/logger.h"
+#include "util/math.h"
 #include "util/trace.h"
 #include "util/file.h"
 #include "util/timer.h"
+#include "util/threadroles.h"
 #include "library/scanner/scannerutil.h"
 #include "util/db/dbconnectionpooler.h"
 #include "util/db/dbconnectionpooled.h"
 
 namespace {
 
-// TODO(rryan) make configurable
-const int kScannerThreadPoolSize = 1;
+// Listing directories mostly waits for the file system, which is
+// particularly slow for network shares
+const int kDefaultScannerThreadCount = 4;
+const int kMaxScannerThreadCount = 32;
+
+// The new tracks that are added to the database at once
+const int kNewTracksPerBatch = 256;
+// The directory hashes that are written to the database at once
+const int kDirectoryHashesPerBatch = 256;
+
+// Watching the directories of a big library costs kernel memory and time
+// on startup, which only pays off for frequent rescans
+const bool kDefaultWatchDirectories = false;
+const int kDefaultMaxWatchedDirectories = 8192;
+// The interval of the full scans that catch the changes that have been
+// missed by the watcher
+const int kDefaultFullScanIntervalDays = 7;
+
+// The statistics of the query planner are updated while the scanner is
+// idle, SQLite only analyzes the tables that have changed much
+const int kOptimizeDatabaseIntervalMillis = 60 * 60 * 1000;
+
+// The start times of the last scans that have finished cleanly in the
+// library settings
+const QString kLastScanKey = "mixxx.libraryscanner.lastscan";
+const QString kLastFullScanKey = "mixxx.libraryscanner.lastfullscan";
 
 mixxx::Logger kLogger("LibraryScanner");
 
@@ -37,7 +67,17 @@ LibraryScanner::LibraryScanner(
                   m_analysisDao, m_libraryHashDao,
                   pConfig),
           m_stateSema(1), // only one transaction is possible at a time
-          m_state(IDLE) {
+          m_state(IDLE),
+          m_bWatchDirectories(pConfig->getValue(
+                  ConfigKey("[Library]", "WatchDirectories"),
+                  kDefaultWatchDirectories)),
+          m_maxWatchedDirectories(pConfig->getValue(
+                  ConfigKey("[Library]", "MaxWatchedDirectories"),
+                  kDefaultMaxWatchedDirectories)),
+          m_fullScanIntervalDays(pConfig->getValue(
+                  ConfigKey("[Library]", "FullScanIntervalDays"),
+                  kDefaultFullScanIntervalDays)),
+          m_bCoverArtDetectionQueued(false) {
     // Move LibraryScanner to its own thread so that our signals/slots will
     // queue to our event loop.
     kLogger.debug() << "Starting thread";
@@ -47,7 +87,13 @@ LibraryScanner::LibraryScanner(
     const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
     setObjectName(QString("LibraryScanner %1").arg(instanceId));
 
-    m_pool.setMaxThreadCount(kScannerThreadPoolSize);
+    m_pool.setMaxThreadCount(math_clamp(
+            pConfig->getValue(
+                    ConfigKey("[Library]", "ScannerThreadCount"),
+                    // Parsing the tags of the new files keeps the cores busy
+                    math_max(kDefaultScannerThreadCount,
+                            QThread::idealThreadCount())),
+            1, kMaxScannerThreadCount));
 
     // Listen to signals from our public methods (invoked by other threads) and
     // connect them to our slots to run the command on the scanner thread.
@@ -70,7 +116,7 @@ LibraryScanner::LibraryScanner(
     connect(this, SIGNAL(progressLoading(QString)),
             m_pProgressDlg.data(), SLOT(slotUpdate(QString)));
     connect(this, SIGNAL(progressHashing(QString)),
-            m_pProgressDlg.data(), SLOT(slotUpdate(QString)));
+            m_pProgressDlg.data(), SLOT(slotUpdateDirectory(QString)));
     connect(this, SIGNAL(scanStarted()),
             m_pProgressDlg.data(), SLOT(slotScanStarted()));
     connect(this, SIGNAL(scanFinished()),
@@ -79,8 +125,6 @@ LibraryScanner::LibraryScanner(
             this, SLOT(slotCancel()));
     connect(&m_trackDao, SIGNAL(progressVerifyTracksOutside(QString)),
             m_pProgressDlg.data(), SLOT(slotUpdate(QString)));
-    connect(&m_trackDao, SIGNAL(progressCoverArt(QString)),
-            m_pProgressDlg.data(), SLOT(slotUpdateCover(QString)));
 
     start();
 }
@@ -91,6 +135,8 @@ LibraryScanner::~LibraryScanner() {
 
 void LibraryScanner::run() {
     kLogger.debug() << "Entering thread";
+    mixxx::ThreadRoles::applyToCurrentThread(
+            mixxx::ThreadRole::LibraryScanner);
     {
         Trace trace("LibraryScanner");
 
@@ -110,10 +156,32 @@ void LibraryScanner::run() {
         m_analysisDao.initialize(dbConnection);
         m_directoryDao.initialize(dbConnection);
 
+        if (m_bWatchDirectories) {
+            // The directories that have been modified since the last scan
+            // have changed while Mixxx was not running
+            const SettingsDAO settings(dbConnection);
+            m_pLibraryWatcher.reset(new LibraryWatcher(m_maxWatchedDirectories));
+            m_pLibraryWatcher->watchDirectories(
+                    m_libraryHashDao.getDirectoryHashes().keys(),
+                    QDateTime::fromString(
+                            settings.getValue(kLastScanKey), Qt::ISODate));
+        }
+
+        // Resume the detection of the cover art that has been deferred
+        // before Mixxx has been closed
+        startCoverArtDetection();
+
+        QTimer optimizeDatabaseTimer;
+        connect(&optimizeDatabaseTimer, SIGNAL(timeout()),
+                this, SLOT(slotOptimizeDatabase()));
+        optimizeDatabaseTimer.start(kOptimizeDatabaseIntervalMillis);
+
         // Start the event loop.
         kLogger.debug() << "Event loop starting";
         exec();
         kLogger.debug() << "Event loop stopped";
+
+        m_pLibraryWatcher.reset();
     }
     kLogger.debug() << "Exiting thread";
 }
@@ -128,12 +196,20 @@ void LibraryScanner::slotStartScan() {
     // finish the scan immediately.
     if (m_libraryRootDirs.isEmpty()) {
         changeScannerState(IDLE);
+        startCoverArtDetection();
         return;
     }
     changeScannerState(SCANNING);
 
+    // The cover art of the tracks that are added by the scan is only
+    // detected afterwards
+    m_coverArtDirectories.clear();
+    setPriority(QThread::NormalPriority);
+
     QSet<QString> trackLocations = m_trackDao.getTrackLocations();
     QHash<QString, int> directoryHashes = m_libraryHashDao.getDirectoryHashes();
+    QHash<QString, qint64> directoryModifiedTimes =
+            m_libraryHashDao.getDirectoryModifiedTimes();
     QRegExp extensionFilter(SoundSourceProxy::getSupportedFileNamesRegex());
     QRegExp coverExtensionFilter =
             QRegExp(CoverArtUtils::supportedCoverArtExtensionsRegex(),
@@ -143,27 +219,57 @@ void LibraryScanner::slotStartScan() {
     m_scannerGlobal = ScannerGlobalPointer(
             new ScannerGlobal(trackLocations, directoryHashes, extensionFilter,
                               coverExtensionFilter, directoryBlacklist));
+    m_scannerGlobal->setDirectoryModifiedTimes(directoryModifiedTimes);
 
-    m_scannerGlobal->startTimer();
+    QSet<QString> changedDirectories;
+    if (takeChangedDirectories(directoryHashes, &changedDirectories)) {
+        m_scannerGlobal->setChangedDirectories(changedDirectories);
+    }
 
-    emit(scanStarted());
+    // A scan that does not finish cleanly leaves directories and tracks
+    // unverified, so the next scan must not be an incremental one.
+    m_scanStartTime = QDateTime::currentDateTimeUtc();
+    const QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
+    SettingsDAO settings(dbConnection);
+    settings.setValue(kLastScanKey, QString());
 
-    // First, we're going to mark all the directories that we've previously
-    // hashed as needing verification. As we search through the directory tree
-    // when we rescan, we'll mark any directory that does still exist as
-    // verified.
-    m_libraryHashDao.invalidateAllDirectories();
+    m_scannerGlobal->startTimer();
 
-    // Mark all the tracks in the library as needing verification of their
-    // existence. (ie. we want to check they're still on your hard drive where
-    // we think they are)
-    m_trackDao.invalidateTrackLocationsInLibrary();
+    emit(scanStarted());
 
-    kLogger.debug() << "Recursively scanning library.";
+    if (m_scannerGlobal->isIncremental()) {
+        // Only the changed directories and their tracks need verification.
+        // They are marked as deleted if they do no longer exist.
+        const QStringList changedDirectoryList = changedDirectories.toList();
+        if (!changedDirectoryList.isEmpty()) {
+            m_libraryHashDao.updateDirectoryStatuses(
+                    changedDirectoryList, false, false);
+            m_trackDao.invalidateTrackLocationsInDirectories(
+                    changedDirectoryList);
+        }
+        kLogger.debug() << "Scanning" << changedDirectoryList.size()
+                        << "changed directories.";
+    } else {
+        // First, we're going to mark all the directories that we've
+        // previously hashed as needing verification. As we search through
+        // the directory tree when we rescan, we'll mark any directory that
+        // does still exist as verified.
+        m_libraryHashDao.invalidateAllDirectories();
+
+        // Mark all the tracks in the library as needing verification of
+        // their existence. (ie. we want to check they're still on your hard
+        // drive where we think they are)
+        m_trackDao.invalidateTrackLocationsInLibrary();
+
+        kLogger.debug() << "Recursively scanning library.";
+    }
 
     // Start scanning the library. This prepares insertion queries in TrackDAO
     // (must be called before calling addTracksAdd) and begins a transaction.
-    m_trackDao.addTracksPrepare();
+    m_newTrackPaths.clear();
+    m_newTracks.clear();
+    m_directoryHashes.clear();
+    m_trackDao.addTracksPrepare(true);
 
     // First Scan all known directories we have a hash for.
     // In a second stage, we scan all new directories. This guarantees,
@@ -183,7 +289,24 @@ void LibraryScanner::slotStartScan() {
         // scanning so that relies on having an open bookmark for the containing
         // directory.
         MDir dir(dirPath);
-        if (!m_scannerGlobal->testAndMarkDirectoryScanned(dir.dir())) {
+        if (m_scannerGlobal->directoryUnchangedSinceLastScan(dir.dir().path())) {
+            // An incremental scan only visits the changed directories below
+            // the unchanged root directory
+            const QString rootPrefix = ScannerUtil::directoryPrefix(dir.dir());
+            foreach (const QString& changedDirPath, changedDirectories) {
+                if (!(changedDirPath + '/').startsWith(rootPrefix)) {
+                    continue;
+                }
+                const QDir changedDir(changedDirPath);
+                if (changedDir.exists() &&
+                        !m_scannerGlobal->testAndMarkDirectoryScanned(changedDir)) {
+                    queueTask(new RecursiveScanDirectoryTask(this, m_scannerGlobal,
+                                                             changedDir,
+                                                             dir.token(),
+                                                             false));
+                }
+            }
+        } else if (!m_scannerGlobal->testAndMarkDirectoryScanned(dir.dir())) {
             queueTask(new RecursiveScanDirectoryTask(this, m_scannerGlobal,
                                                      dir.dir(),
                                                      dir.token(),
@@ -193,6 +316,71 @@ void LibraryScanner::slotStartScan() {
     pWatcher->taskDone();
 }
 
+bool LibraryScanner::takeChangedDirectories(
+        const QHash<QString, int>& directoryHashes,
+        QSet<QString>* pChangedDirectories) {
+    if (!m_pLibraryWatcher) {
+        return false;
+    }
+    const bool complete = m_pLibraryWatcher->isComplete();
+    const QSet<QString> changedDirectories =
+            m_pLibraryWatcher->takeChangedDirectories();
+
+    const QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
+    const SettingsDAO settings(dbConnection);
+    const QDateTime lastScan = QDateTime::fromString(
+            settings.getValue(kLastScanKey), Qt::ISODate);
+    const QDateTime lastFullScan = QDateTime::fromString(
+            settings.getValue(kLastFullScanKey), Qt::ISODate);
+    if (!complete || !lastScan.isValid() || !lastFullScan.isValid() ||
+            lastFullScan.daysTo(QDateTime::currentDateTimeUtc()) >=
+                    m_fullScanIntervalDays) {
+        kLogger.debug() << "Scanning all directories. Last full scan:"
+                        << lastFullScan;
+        return false;
+    }
+
+    QStringList rootPrefixes;
+    foreach (const QString& dirPath, m_libraryRootDirs) {
+        const QDir rootDir(dirPath);
+        rootPrefixes.append(ScannerUtil::directoryPrefix(rootDir));
+        // The root directories that have been added since the last scan
+        if (!directoryHashes.contains(rootDir.path())) {
+            pChangedDirectories->insert(rootDir.path());
+        }
+    }
+    QSet<QString> removedDirectories;
+    for (const auto& dirPath : changedDirectories) {
+        for (const auto& rootPrefix : rootPrefixes) {
+            if ((dirPath + '/').startsWith(rootPrefix)) {
+                pChangedDirectories->insert(dirPath);
+                if (!QFileInfo(dirPath).isDir()) {
+                    removedDirectories.insert(dirPath);
+                }
+                break;
+            }
+        }
+    }
+
+    // The subdirectories of a removed or renamed directory are gone as well,
+    // but they are not reported by the watcher
+    if (!removedDirectories.isEmpty()) {
+        for (auto it = directoryHashes.constBegin();
+                it != directoryHashes.constEnd(); ++it) {
+            const QString& dirPath = it.key();
+            int separator = dirPath.lastIndexOf('/');
+            while (separator > 0) {
+                if (removedDirectories.contains(dirPath.left(separator))) {
+                    pChangedDirectories->insert(dirPath);
+                    break;
+                }
+                separator = dirPath.lastIndexOf('/', separator - 1);
+            }
+        }
+    }
+    return true;
+}
+
 // is called when all tasks of the first stage are done (threads are finished)
 void LibraryScanner::slotFinishHashedScan() {
     kLogger.debug() << "slotFinishHashedScan";
@@ -293,14 +481,8 @@ void LibraryScanner::cleanUpScan() {
 
     transaction.commit();
 
-    kLogger.debug() << "Detecting cover art for unscanned files";
-    QSet<TrackId> coverArtTracksChanged;
-    m_trackDao.detectCoverArtForTracksWithoutCover(
-            m_scannerGlobal->shouldCancelPointer(), &coverArtTracksChanged);
-
     // Update BaseTrackCache via signals connected to the main TrackDAO.
     emit(tracksMoved(tracksMovedSetOld, tracksMovedSetNew));
-    emit(tracksChanged(coverArtTracksChanged));
 }
 
 
@@ -320,6 +502,9 @@ void LibraryScanner::slotFinishUnhashedScan() {
         kLogger.debug() << "Recursive scanning interrupted by the user";
     }
 
+    addNewTracks();
+    saveDirectoryHashes();
+
     // Finish adding the tracks -- rollback the transaction if the scan did not
     // finish cleanly and the user did not cancel the transaction.
     m_trackDao.addTracksFinish(!m_scannerGlobal->shouldCancel() &&
@@ -331,6 +516,7 @@ void LibraryScanner::slotFinishUnhashedScan() {
 
     if (!m_scannerGlobal->shouldCancel() && bScanFinishedCleanly) {
         kLogger.debug() << "Scan finished cleanly";
+        recordFinishedScan();
     } else {
         kLogger.debug() << "Scan cancelled";
     }
@@ -352,6 +538,93 @@ void LibraryScanner::slotFinishUnhashedScan() {
     // now we may accept new scan commands
 
     emit(scanFinished());
+
+    // Also resumes the cover art detection that has been interrupted by
+    // the scan
+    startCoverArtDetection();
+}
+
+void LibraryScanner::startCoverArtDetection() {
+    m_coverArtDirectories = m_trackDao.getDirectoriesOfTracksWithoutCover();
+    if (m_coverArtDirectories.isEmpty()) {
+        return;
+    }
+    kLogger.debug() << "Detecting cover art in"
+                    << m_coverArtDirectories.size() << "directories";
+    // The scans of the library take precedence
+    setPriority(QThread::LowPriority);
+    queueCoverArtDetection();
+}
+
+void LibraryScanner::queueCoverArtDetection() {
+    if (!m_bCoverArtDetectionQueued) {
+        m_bCoverArtDetectionQueued = true;
+        QMetaObject::invokeMethod(this, "slotDetectCoverArt", Qt::QueuedConnection);
+    }
+}
+
+void LibraryScanner::slotDetectCoverArt() {
+    m_bCoverArtDetectionQueued = false;
+    // A new scan restarts the detection when it is finished
+    if (m_state != IDLE || m_coverArtDirectories.isEmpty()) {
+        return;
+    }
+    ScopedTimer timer("LibraryScanner::slotDetectCoverArt");
+    const QString directoryPath = m_coverArtDirectories.takeFirst();
+    QSet<TrackId> coverArtTracksChanged;
+    {
+        QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
+        ScopedTransaction transaction(dbConnection);
+        m_trackDao.detectCoverArtForTracksInDirectory(
+                directoryPath, &coverArtTracksChanged);
+        transaction.commit();
+    }
+    if (!coverArtTracksChanged.isEmpty()) {
+        // Update BaseTrackCache via signals connected to the main TrackDAO.
+        emit(tracksChanged(coverArtTracksChanged));
+    }
+
+    // One directory at a time, so that the requests to scan are handled
+    // in between
+    if (m_coverArtDirectories.isEmpty()) {
+        kLogger.debug() << "Cover art detection finished";
+        setPriority(QThread::NormalPriority);
+    } else {
+        queueCoverArtDetection();
+    }
+}
+
+void LibraryScanner::recordFinishedScan() {
+    const QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
+    SettingsDAO settings(dbConnection);
+    const QString scanStartTime = m_scanStartTime.toString(Qt::ISODate);
+    settings.setValue(kLastScanKey, scanStartTime);
+    if (!m_scannerGlobal->isIncremental()) {
+        settings.setValue(kLastFullScanKey, scanStartTime);
+    }
+    // A scan writes many pages that are read concurrently from the log
+    // until they have been copied back into the database
+    mixxx::DbConnection::checkpointWriteAheadLog(dbConnection);
+    // The scan may have added or changed many tracks and locations
+    mixxx::DbConnection::optimize(dbConnection);
+
+    if (m_pLibraryWatcher) {
+        // The directories that have been added by the scan are watched
+        // from now on. Their changes during the scan are caught by the
+        // modification times.
+        m_pLibraryWatcher->watchDirectories(
+                m_libraryHashDao.getDirectoryHashes().keys(),
+                m_scanStartTime);
+    }
+}
+
+void LibraryScanner::slotOptimizeDatabase() {
+    if (m_state != IDLE || !m_coverArtDirectories.isEmpty()) {
+        // Done after the scan, see recordFinishedScan()
+        return;
+    }
+    mixxx::DbConnection::optimize(
+            mixxx::DbConnectionPooled(m_pDbConnectionPool));
 }
 
 void LibraryScanner::scan() {
@@ -409,14 +682,14 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
     m_scannerGlobal->getTaskWatcher().watchTask();
     connect(pTask, SIGNAL(queueTask(ScannerTask*)),
             this, SLOT(queueTask(ScannerTask*)));
-    connect(pTask, SIGNAL(directoryHashedAndScanned(QString, bool, int)),
-            this, SLOT(slotDirectoryHashedAndScanned(QString, bool, int)));
-    connect(pTask, SIGNAL(directoryUnchanged(QString)),
-            this, SLOT(slotDirectoryUnchanged(QString)));
+    connect(pTask, SIGNAL(directoryHashedAndScanned(QString, int, qint64)),
+            this, SLOT(slotDirectoryHashedAndScanned(QString, int, qint64)));
+    connect(pTask, SIGNAL(directoryUnchanged(QString, qint64)),
+            this, SLOT(slotDirectoryUnchanged(QString, qint64)));
     connect(pTask, SIGNAL(trackExists(QString)),
             this, SLOT(slotTrackExists(QString)));
-    connect(pTask, SIGNAL(addNewTrack(QString)),
-            this, SLOT(slotAddNewTrack(QString)));
+    connect(pTask, SIGNAL(addNewTrack(QString, TrackPointer)),
+            this, SLOT(slotAddNewTrack(QString, TrackPointer)));
 
     // Progress signals.
     // Pass directly to the main thread
@@ -429,10 +702,10 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
 }
 
 void LibraryScanner::slotDirectoryHashedAndScanned(const QString& directoryPath,
-                                               bool newDirectory, int hash) {
+                                                   int hash, qint64 modifiedTime) {
     ScopedTimer timer("LibraryScanner::slotDirectoryHashedAndScanned");
     //kLogger.debug() << "sloDirectoryHashedAndScanned" << directoryPath
-    //          << newDirectory << hash;
+    //          << hash << modifiedTime;
 
     // For statistics tracking -- if we hashed a directory then we scanned it
     // (it was changed or new).
@@ -440,23 +713,43 @@ void LibraryScanner::slotDirectoryHashedAndScanned(const QString& directoryPath,
         m_scannerGlobal->directoryScanned();
     }
 
-    if (newDirectory) {
-        m_libraryHashDao.saveDirectoryHash(directoryPath, hash);
-    } else {
-        m_libraryHashDao.updateDirectoryHash(directoryPath, hash, 0);
+    m_directoryHashes.append(DirectoryHash(directoryPath, hash, modifiedTime));
+    if (m_directoryHashes.size() >= kDirectoryHashesPerBatch) {
+        saveDirectoryHashes();
     }
     emit(progressHashing(directoryPath));
 }
 
-void LibraryScanner::slotDirectoryUnchanged(const QString& directoryPath) {
+void LibraryScanner::slotDirectoryUnchanged(const QString& directoryPath,
+                                            qint64 modifiedTime) {
     ScopedTimer timer("LibraryScanner::slotDirectoryUnchanged");
     //kLogger.debug() << "slotDirectoryUnchanged" << directoryPath;
     if (m_scannerGlobal) {
         m_scannerGlobal->addVerifiedDirectory(directoryPath);
+        // The modification time changes with entries that are not hashed
+        // like cover art or is not known yet
+        if (modifiedTime !=
+                m_scannerGlobal->directoryModifiedTimeInDatabase(directoryPath)) {
+            m_directoryHashes.append(DirectoryHash(directoryPath,
+                    m_scannerGlobal->directoryHashInDatabase(directoryPath),
+                    modifiedTime));
+            if (m_directoryHashes.size() >= kDirectoryHashesPerBatch) {
+                saveDirectoryHashes();
+            }
+        }
     }
     emit(progressHashing(directoryPath));
 }
 
+void LibraryScanner::saveDirectoryHashes() {
+    if (m_directoryHashes.isEmpty()) {
+        return;
+    }
+    ScopedTimer timer("LibraryScanner::saveDirectoryHashes");
+    m_libraryHashDao.saveDirectoryHashes(m_directoryHashes);
+    m_directoryHashes.clear();
+}
+
 void LibraryScanner::slotTrackExists(const QString& trackPath) {
     //kLogger.debug() << "slotTrackExists" << trackPath;
     ScopedTimer timer("LibraryScanner::slotTrackExists");
@@ -465,34 +758,55 @@ void LibraryScanner::slotTrackExists(const QString& trackPath) {
     }
 }
 
-void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
+void LibraryScanner::slotAddNewTrack(const QString& trackPath,
+        TrackPointer pTrack) {
     //kLogger.debug() << "slotAddNewTrack" << trackPath;
-    ScopedTimer timer("LibraryScanner::addNewTrack");
-    // For statistics tracking and to detect moved tracks
-    TrackPointer pTrack(m_trackDao.addTracksAddFile(trackPath, false));
-    if (pTrack) {
-        // The track's actual location might differ from the
-        // given trackPath
-        const QString trackLocation(pTrack->getLocation());
-        // Acknowledge successful track addition
-        if (m_scannerGlobal) {
-            m_scannerGlobal->trackAdded(trackLocation);
-        }
-        // Signal the main instance of TrackDAO, that there is
-        // a new track in the database.
-        emit(trackAdded(pTrack));
-        emit(progressLoading(trackLocation));
-    } else {
-        // Acknowledge failed track addition
-        // TODO(XXX): Is it really intended to acknowledge a failed
-        // track addition with a trackAdded() signal??
-        if (m_scannerGlobal) {
-            m_scannerGlobal->trackAdded(trackPath);
+    m_newTrackPaths.append(trackPath);
+    m_newTracks.append(pTrack);
+    if (m_newTrackPaths.size() >= kNewTracksPerBatch) {
+        addNewTracks();
+    }
+}
+
+void LibraryScanner::addNewTracks() {
+    if (m_newTrackPaths.isEmpty()) {
+        return;
+    }
+    ScopedTimer timer("LibraryScanner::addNewTracks");
+    // The metadata has already been parsed by the tasks
+    const QList<TrackPointer> tracks(
+            m_trackDao.addTracksAddResolvedTracks(m_newTracks, false));
+    DEBUG_ASSERT(tracks.size() == m_newTrackPaths.size());
+    for (int i = 0; i < tracks.size(); ++i) {
+        const TrackPointer& pTrack = tracks[i];
+        const QString& trackPath = m_newTrackPaths[i];
+        // For statistics tracking and to detect moved tracks
+        if (pTrack) {
+            // The track's actual location might differ from the
+            // given trackPath
+            const QString trackLocation(pTrack->getLocation());
+            // Acknowledge successful track addition
+            if (m_scannerGlobal) {
+                m_scannerGlobal->trackAdded(trackLocation);
+            }
+            // Signal the main instance of TrackDAO, that there is
+            // a new track in the database.
+            emit(trackAdded(pTrack));
+            emit(progressLoading(trackLocation));
+        } else {
+            // Acknowledge failed track addition
+            // TODO(XXX): Is it really intended to acknowledge a failed
+            // track addition with a trackAdded() signal??
+            if (m_scannerGlobal) {
+                m_scannerGlobal->trackAdded(trackPath);
+            }
+            kLogger.warning()
+                    << "Failed to add track to library:"
+                    << trackPath;
         }
-        kLogger.warning()
-                << "Failed to add track to library:"
-                << trackPath;
     }
+    m_newTrackPaths.clear();
+    m_newTracks.clear();
 }
 
 bool LibraryScanner::changeScannerState(ScannerState newState) {
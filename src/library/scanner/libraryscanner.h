@@ -1,6 +1,9 @@
 #ifndef MIXXX_LIBRARYSCANNER_H
 #define MIXXX_LIBRARYSCANNER_H
 
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
 #include <QThread>
 #include <QThreadPool>
 #include <QString>
@@ -22,6 +25,7 @@
 
 class ScannerTask;
 class LibraryScannerDlg;
+class LibraryWatcher;
 class TrackCollection;
 
 class LibraryScanner : public QThread {
@@ -66,13 +70,19 @@ class LibraryScanner : public QThread {
     void slotStartScan();
     void slotFinishHashedScan();
     void slotFinishUnhashedScan();
+    // Detects the cover art of the tracks in the next directory
+    void slotDetectCoverArt();
+    // Updates the statistics of the database unless a scan or the cover
+    // art detection is running
+    void slotOptimizeDatabase();
 
     // ScannerTask signal handlers.
     void slotDirectoryHashedAndScanned(const QString& directoryPath,
-                                   bool newDirectory, int hash);
-    void slotDirectoryUnchanged(const QString& directoryPath);
+                                       int hash, qint64 modifiedTime);
+    void slotDirectoryUnchanged(const QString& directoryPath,
+                                qint64 modifiedTime);
     void slotTrackExists(const QString& trackPath);
-    void slotAddNewTrack(const QString& trackPath);
+    void slotAddNewTrack(const QString& trackPath, TrackPointer pTrack);
 
   private:
     enum ScannerState {
@@ -96,7 +106,23 @@ class LibraryScanner : public QThread {
     // CANCELING -> IDLE
     bool changeScannerState(LibraryScanner::ScannerState newState);
 
+    // Returns false if the scan needs to walk all directories of the
+    // library instead of only the ones that have changed
+    bool takeChangedDirectories(const QHash<QString, int>& directoryHashes,
+            QSet<QString>* pChangedDirectories);
     void cleanUpScan();
+    // Starts the detection of the cover art that has not been guessed,
+    // which runs in the background until the next scan
+    void startCoverArtDetection();
+    void queueCoverArtDetection();
+    // Records the scan that has finished cleanly as the one that the
+    // changes of the next scan are relative to
+    void recordFinishedScan();
+    // Adds the new tracks that have been found since the last call
+    void addNewTracks();
+    // Writes the directory hashes that have been collected since the last
+    // call
+    void saveDirectoryHashes();
 
     mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
 
@@ -126,7 +152,24 @@ class LibraryScanner : public QThread {
     volatile ScannerState m_state;
 
     QStringList m_libraryRootDirs;
+
+    // Only exists while the thread runs if the directories are watched
+    QScopedPointer<LibraryWatcher> m_pLibraryWatcher;
+    const bool m_bWatchDirectories;
+    const int m_maxWatchedDirectories;
+    const int m_fullScanIntervalDays;
+    QDateTime m_scanStartTime;
     QScopedPointer<LibraryScannerDlg> m_pProgressDlg;
+
+    // The new tracks that are added with the next batch
+    QStringList m_newTrackPaths;
+    QList<TrackPointer> m_newTracks;
+    // The directory hashes that are written with the next batch
+    QList<DirectoryHash> m_directoryHashes;
+
+    // The directories with tracks whose cover art needs to be detected
+    QStringList m_coverArtDirectories;
+    bool m_bCoverArtDetectionQueued;
 };
 
 #endif // MIXXX_LIBRARYSCANNER_H
@@ -25,7 +25,8 @@
 
 LibraryScannerDlg::LibraryScannerDlg(QWidget* parent, Qt::WindowFlags f)
         : QWidget(parent, f),
-          m_bCancelled(false) {
+          m_bCancelled(false),
+          m_scannedDirectories(0) {
     setWindowIcon(QIcon(":/images/ic_mixxx_window.png"));
 
     QVBoxLayout* pLayout = new QVBoxLayout(this);
@@ -47,6 +48,11 @@ LibraryScannerDlg::LibraryScannerDlg(QWidget* parent, Qt::WindowFlags f)
     connect(this, SIGNAL(progress(QString)),
             pCurrent, SLOT(setText(QString)));
     pLayout->addWidget(pCurrent);
+
+    QLabel* pRate = new QLabel(this);
+    connect(this, SIGNAL(directoryRate(QString)),
+            pRate, SLOT(setText(QString)));
+    pLayout->addWidget(pRate);
     setLayout(pLayout);
 }
 
@@ -65,17 +71,16 @@ void LibraryScannerDlg::slotUpdate(QString path) {
     }
 }
 
-void LibraryScannerDlg::slotUpdateCover(QString path) {
-    //qDebug() << "LibraryScannerDlg slotUpdate" << m_timer.elapsed() << path;
-    if (!m_bCancelled && m_timer.elapsed() > mixxx::Duration::fromSeconds(2)) {
-       setVisible(true);
-    }
+void LibraryScannerDlg::slotUpdateDirectory(QString path) {
+    ++m_scannedDirectories;
+    slotUpdate(path);
 
     if (isVisible()) {
-        QString status = QString("%1: %2")
-                .arg(tr("Scanning cover art (safe to cancel)"))
-                .arg(path);
-        emit(progress(status));
+        const double seconds = m_timer.elapsed().toDoubleSeconds();
+        if (seconds > 0) {
+            emit(directoryRate(tr("%1 directories/s")
+                    .arg(m_scannedDirectories / seconds, 0, 'f', 0)));
+        }
     }
 }
 
@@ -88,6 +93,8 @@ void LibraryScannerDlg::slotCancel() {
 
 void LibraryScannerDlg::slotScanStarted() {
     m_bCancelled = false;
+    m_scannedDirectories = 0;
+    emit(directoryRate(QString()));
     m_timer.start();
 }
 
@@ -33,7 +33,8 @@ class LibraryScannerDlg : public QWidget {
 
   public slots:
     void slotUpdate(QString path);
-    void slotUpdateCover(QString path);
+    // Counts the directories that have been scanned
+    void slotUpdateDirectory(QString path);
     void slotCancel();
     void slotScanFinished();
     void slotScanStarted();
@@ -41,10 +42,12 @@ class LibraryScannerDlg : public QWidget {
   signals:
     void scanCancelled();
     void progress(QString);
+    void directoryRate(QString);
 
   private:
     PerformanceTimer m_timer;
     bool m_bCancelled;
+    int m_scannedDirectories;
 };
 
 #endif
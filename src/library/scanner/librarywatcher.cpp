@@ -0,0 +1,89 @@
+#include "library/scanner/librarywatcher.h"
+
+#include <QFileInfo>
+
+#include "util/logger.h"
+
+namespace {
+
+mixxx::Logger kLogger("LibraryWatcher");
+
+} // anonymous namespace
+
+LibraryWatcher::LibraryWatcher(int maxWatchedDirectories, QObject* pParent)
+        : QObject(pParent),
+          m_maxWatchedDirectories(maxWatchedDirectories),
+          m_watcher(this),
+          m_bComplete(true) {
+    connect(&m_watcher, SIGNAL(directoryChanged(QString)),
+            this, SLOT(slotDirectoryChanged(QString)));
+}
+
+void LibraryWatcher::watchDirectories(const QStringList& dirPaths,
+        const QDateTime& since) {
+    // The watcher drops the directories that have been removed or renamed
+    const QSet<QString> watchedDirPaths = m_watcher.directories().toSet();
+    const QSet<QString> newWatchedDirPaths = dirPaths.toSet();
+
+    QStringList unwatchedDirPaths;
+    for (const auto& dirPath : watchedDirPaths) {
+        if (!newWatchedDirPaths.contains(dirPath)) {
+            unwatchedDirPaths.append(dirPath);
+        }
+    }
+    if (!unwatchedDirPaths.isEmpty()) {
+        m_watcher.removePaths(unwatchedDirPaths);
+    }
+
+    m_bComplete = newWatchedDirPaths.size() <= m_maxWatchedDirectories;
+    if (!m_bComplete) {
+        kLogger.info()
+                << "Not watching" << newWatchedDirPaths.size()
+                << "directories, which are more than"
+                << m_maxWatchedDirectories;
+        if (!m_watcher.directories().isEmpty()) {
+            m_watcher.removePaths(m_watcher.directories());
+        }
+        return;
+    }
+
+    QStringList addedDirPaths;
+    for (const auto& dirPath : newWatchedDirPaths) {
+        if (watchedDirPaths.contains(dirPath)) {
+            continue;
+        }
+        const QFileInfo dirInfo(dirPath);
+        if (!dirInfo.isDir()) {
+            m_changedDirectories.insert(dirPath);
+            continue;
+        }
+        if (since.isValid() && dirInfo.lastModified() >= since) {
+            m_changedDirectories.insert(dirPath);
+        }
+        addedDirPaths.append(dirPath);
+    }
+    if (addedDirPaths.isEmpty()) {
+        return;
+    }
+    const QStringList failedDirPaths = m_watcher.addPaths(addedDirPaths);
+    if (!failedDirPaths.isEmpty()) {
+        // Usually the limit of watches of the platform has been reached
+        kLogger.warning()
+                << "Failed to watch" << failedDirPaths.size() << "of"
+                << addedDirPaths.size() << "directories";
+        m_bComplete = false;
+    }
+    kLogger.debug()
+            << "Watching" << m_watcher.directories().size() << "directories,"
+            << m_changedDirectories.size() << "changed";
+}
+
+QSet<QString> LibraryWatcher::takeChangedDirectories() {
+    QSet<QString> changedDirectories;
+    changedDirectories.swap(m_changedDirectories);
+    return changedDirectories;
+}
+
+void LibraryWatcher::slotDirectoryChanged(const QString& dirPath) {
+    m_changedDirectories.insert(dirPath);
+}
@@ -0,0 +1,48 @@
+#ifndef LIBRARYWATCHER_H
+#define LIBRARYWATCHER_H
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+// Records the directories of the library that have changed since they have
+// been taken the last time, so that a rescan only needs to visit those.
+// QFileSystemWatcher uses inotify, FSEvents, kqueue or
+// ReadDirectoryChangesW depending on the platform.
+//
+// A directory changes when an entry is added, removed or renamed, which are
+// the same changes that change the hash of the directory in LibraryHashDAO.
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+  public:
+    explicit LibraryWatcher(int maxWatchedDirectories,
+            QObject* pParent = nullptr);
+
+    // Watches the directories instead of the ones that are watched now. The
+    // directories that are watched for the first time and have been
+    // modified after since (if valid) or do not exist are recorded as
+    // changed, which covers the changes while they were not watched.
+    void watchDirectories(const QStringList& dirPaths, const QDateTime& since);
+
+    // Whether all changes have been recorded since the directories have
+    // been watched, which is false if a directory could not be watched
+    bool isComplete() const {
+        return m_bComplete;
+    }
+
+    QSet<QString> takeChangedDirectories();
+
+  private slots:
+    void slotDirectoryChanged(const QString& dirPath);
+
+  private:
+    const int m_maxWatchedDirectories;
+    QFileSystemWatcher m_watcher;
+    QSet<QString> m_changedDirectories;
+    bool m_bComplete;
+};
+
+#endif // LIBRARYWATCHER_H
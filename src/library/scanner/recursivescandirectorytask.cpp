@@ -1,11 +1,38 @@
+#include <QDateTime>
 #include <QDirIterator>
+#include <QFileInfo>
 
 #include "library/scanner/recursivescandirectorytask.h"
 
 #include "library/scanner/libraryscanner.h"
 #include "library/scanner/importfilestask.h"
+#include "sources/soundsourceproxy.h"
 #include "util/timer.h"
 
+namespace {
+
+// Modification times that are closer to the time they are read might still
+// change without a different value, because the file system only stores
+// them with a limited precision (2 s for FAT).
+const qint64 kModifiedTimePrecisionMillis = 2000;
+
+// Returns the modification time of the directory or 0 if it is unknown or
+// too recent to detect a change
+qint64 directoryModifiedTime(const QString& dirPath) {
+    const QDateTime modified = QFileInfo(dirPath).lastModified();
+    if (!modified.isValid()) {
+        return 0;
+    }
+    const qint64 modifiedTime = modified.toMSecsSinceEpoch();
+    if (QDateTime::currentMSecsSinceEpoch() - modifiedTime <
+            kModifiedTimePrecisionMillis) {
+        return 0;
+    }
+    return modifiedTime;
+}
+
+} // anonymous namespace
+
 RecursiveScanDirectoryTask::RecursiveScanDirectoryTask(
         LibraryScanner* pScanner, const ScannerGlobalPointer scannerGlobal,
         const QDir& dir, SecurityTokenPointer pToken, bool scanUnhashed)
@@ -26,6 +53,39 @@ void RecursiveScanDirectoryTask::run() {
     //qDebug() << "Burn CPU";
     //for (int i = 0;i < 1000000000; i++) asm("nop");
 
+    QString dirPath = m_dir.path();
+
+    // Read before listing the directory, so that a change while it is
+    // listed is detected by the next scan.
+    const qint64 modifiedTime = directoryModifiedTime(dirPath);
+
+    // Try to retrieve a hash from the last time that directory was scanned.
+    int prevHash = m_scannerGlobal->directoryHashInDatabase(dirPath);
+    bool prevHashExists = prevHash != -1;
+
+    if (prevHashExists && modifiedTime != 0 &&
+            modifiedTime == m_scannerGlobal->directoryModifiedTimeInDatabase(dirPath)) {
+        // No entry has been added, removed or renamed since the directory
+        // has been hashed, so neither its files nor its subdirectories need
+        // to be listed.
+        emit(directoryUnchanged(dirPath, modifiedTime));
+        foreach (const QString& subdirPath,
+                m_scannerGlobal->knownSubdirectories(dirPath)) {
+            if (m_scannerGlobal->directoryBlacklisted(subdirPath) ||
+                    m_scannerGlobal->directoryUnchangedSinceLastScan(subdirPath)) {
+                continue;
+            }
+            const QDir subdir(subdirPath);
+            if (!m_scannerGlobal->testAndMarkDirectoryScanned(subdir)) {
+                m_pScanner->queueTask(
+                        new RecursiveScanDirectoryTask(m_pScanner, m_scannerGlobal,
+                                                       subdir, m_pToken, m_scanUnhashed));
+            }
+        }
+        setSuccess(true);
+        return;
+    }
+
     // Note, we save on filesystem operations (and random work) by initializing
     // a QDirIterator with a QDir instead of a QString -- but it inherits its
     // Filter from the QDir so we have to set it first. If the QDir has not done
@@ -42,8 +102,8 @@ void RecursiveScanDirectoryTask::run() {
 
     // TODO(rryan) benchmark QRegExp copy versus QMutex/QRegExp in ScannerGlobal
     // versus slicing the extension off and checking for set/list containment.
-    QRegExp supportedExtensionsRegex =
-            m_scannerGlobal->supportedExtensionsRegex();
+    // Audio files are checked by looking up their extension in the registry
+    // of SoundSource providers.
     QRegExp supportedCoverExtensionsRegex =
             m_scannerGlobal->supportedCoverExtensionsRegex();
 
@@ -53,7 +113,7 @@ void RecursiveScanDirectoryTask::run() {
 
         if (currentFileInfo.isFile()) {
             const QString& fileName = currentFileInfo.fileName();
-            if (supportedExtensionsRegex.indexIn(fileName) != -1) {
+            if (SoundSourceProxy::isFileNameSupported(fileName)) {
                 newHashStr.append(currentFile);
                 filesToImport.append(currentFileInfo);
             } else if (supportedCoverExtensionsRegex.indexIn(fileName) != -1) {
@@ -66,6 +126,9 @@ void RecursiveScanDirectoryTask::run() {
                 // Art Folder since it is probably a waste of time.
                 continue;
             }
+            if (m_scannerGlobal->directoryUnchangedSinceLastScan(currentFile)) {
+                continue;
+            }
             const QDir currentDir(currentFile);
             dirsToScan.append(currentDir);
         }
@@ -75,12 +138,6 @@ void RecursiveScanDirectoryTask::run() {
     // Calculate a hash of the directory's file list.
     int newHash = qHash(newHashStr.join(""));
 
-    QString dirPath = m_dir.path();
-
-    // Try to retrieve a hash from the last time that directory was scanned.
-    int prevHash = m_scannerGlobal->directoryHashInDatabase(dirPath);
-    bool prevHashExists = prevHash != -1;
-
     if (prevHashExists || m_scanUnhashed) {
         // Compare the hashes, and if they don't match, rescan the files in that
         // directory!
@@ -90,13 +147,13 @@ void RecursiveScanDirectoryTask::run() {
             if (!filesToImport.isEmpty()) {
                 m_pScanner->queueTask(
                         new ImportFilesTask(m_pScanner, m_scannerGlobal, dirPath,
-                                            prevHashExists, newHash, filesToImport,
+                                            modifiedTime, newHash, filesToImport,
                                             possibleCovers, m_pToken));
             } else {
-                emit(directoryHashedAndScanned(dirPath, !prevHashExists, newHash));
+                emit(directoryHashedAndScanned(dirPath, newHash, modifiedTime));
             }
         } else {
-            emit(directoryUnchanged(dirPath));
+            emit(directoryUnchanged(dirPath, modifiedTime));
         }
     } else {
         m_scannerGlobal->addUnhashedDir(m_dir, m_pToken);
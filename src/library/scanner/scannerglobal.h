@@ -48,6 +48,7 @@ class ScannerGlobal {
               m_directoriesBlacklist(directoriesBlacklist),
               // Unless marked un-clean, we assume it will finish cleanly.
               m_scanFinishedCleanly(true),
+              m_incremental(false),
               m_shouldCancel(false),
               m_numScannedDirectories(0) {
     }
@@ -66,6 +67,50 @@ class ScannerGlobal {
         return m_directoryHashes.value(directoryPath, -1);
     }
 
+    // Must be called before the first task is queued.
+    void setDirectoryModifiedTimes(const QHash<QString, qint64>& modifiedTimes) {
+        m_directoryModifiedTimes = modifiedTimes;
+        for (auto it = m_directoryHashes.constBegin();
+                it != m_directoryHashes.constEnd(); ++it) {
+            const int separator = it.key().lastIndexOf('/');
+            if (separator > 0) {
+                m_knownSubdirectories[it.key().left(separator)].append(it.key());
+            }
+        }
+    }
+
+    // Returns the modification time of the directory when it has been
+    // hashed or 0 if it is unknown.
+    inline qint64 directoryModifiedTimeInDatabase(const QString& directoryPath) const {
+        return m_directoryModifiedTimes.value(directoryPath, 0);
+    }
+
+    // Returns the subdirectories of the directory that have been hashed
+    inline QStringList knownSubdirectories(const QString& directoryPath) const {
+        return m_knownSubdirectories.value(directoryPath);
+    }
+
+    // Restricts the scan to the directories that have changed since
+    // the last scan and the directories that are new. Must be called before
+    // the first task is queued.
+    void setChangedDirectories(const QSet<QString>& changedDirectories) {
+        m_changedDirectories = changedDirectories;
+        m_incremental = true;
+    }
+
+    bool isIncremental() const {
+        return m_incremental;
+    }
+
+    // Returns whether an incremental scan skips the directory, because it
+    // is known and has not changed. Its tracks and its subdirectories
+    // still have been verified by the last scan.
+    inline bool directoryUnchangedSinceLastScan(const QString& directoryPath) const {
+        return m_incremental &&
+                m_directoryHashes.contains(directoryPath) &&
+                !m_changedDirectories.contains(directoryPath);
+    }
+
     inline bool directoryBlacklisted(const QString& directoryPath) const {
         return m_directoriesBlacklist.contains(directoryPath);
     }
@@ -178,6 +223,12 @@ class ScannerGlobal {
 
     QSet<QString> m_trackLocations;
     QHash<QString, int> m_directoryHashes;
+    QHash<QString, qint64> m_directoryModifiedTimes;
+    QHash<QString, QStringList> m_knownSubdirectories;
+
+    // The directories that an incremental scan visits
+    QSet<QString> m_changedDirectories;
+    bool m_incremental;
 
     mutable QMutex m_supportedExtensionsMatcherMutex;
     QRegExp m_supportedExtensionsMatcher;
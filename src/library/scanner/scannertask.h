@@ -22,10 +22,13 @@ class ScannerTask : public QObject, public QRunnable {
     void taskDone(bool success);
     void queueTask(ScannerTask* pTask);
     void directoryHashedAndScanned(const QString& directoryPath,
-                                   bool newDirectory, int hash);
-    void directoryUnchanged(const QString& directoryPath);
+                                   int hash, qint64 modifiedTime);
+    void directoryUnchanged(const QString& directoryPath,
+                            qint64 modifiedTime);
     void trackExists(const QString& filePath);
-    void addNewTrack(const QString& filePath);
+    // The track has been resolved and its metadata has been parsed, or is
+    // null if the file could not be added
+    void addNewTrack(const QString& filePath, TrackPointer pTrack);
 
     // Feedback to GUI
     void progressLoading(const QString& fileName);
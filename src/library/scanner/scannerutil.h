@@ -28,6 +28,14 @@ class ScannerUtil {
         return blacklist;
     }
 
+    // Returns the path of the directory with a trailing separator. The paths
+    // of the directory and of everything below it with a trailing separator
+    // start with it.
+    static QString directoryPrefix(const QDir& dir) {
+        const QString path = dir.path();
+        return path.endsWith('/') ? path : path + '/';
+    }
+
   private:
     ScannerUtil() {}
 };
@@ -1,3 +1,4 @@
+#include <QHash>
 #include <QtDebug>
 
 #include "library/searchquery.h"
@@ -7,54 +8,105 @@
 #include "library/dao/trackschema.h"
 #include "util/db/sqllikewildcards.h"
 
+namespace {
+
+QHash<QString, TrackValueGetter> createTrackValueGetters() {
+    QHash<QString, TrackValueGetter> getters;
+    getters.insert(LIBRARYTABLE_ARTIST, [](const Track& track) -> QVariant {
+        return track.getArtist();
+    });
+    getters.insert(LIBRARYTABLE_TITLE, [](const Track& track) -> QVariant {
+        return track.getTitle();
+    });
+    getters.insert(LIBRARYTABLE_ALBUM, [](const Track& track) -> QVariant {
+        return track.getAlbum();
+    });
+    getters.insert(LIBRARYTABLE_ALBUMARTIST, [](const Track& track) -> QVariant {
+        return track.getAlbumArtist();
+    });
+    getters.insert(LIBRARYTABLE_YEAR, [](const Track& track) -> QVariant {
+        return track.getYear();
+    });
+    getters.insert(LIBRARYTABLE_DATETIMEADDED, [](const Track& track) -> QVariant {
+        return track.getDateAdded();
+    });
+    getters.insert(LIBRARYTABLE_GENRE, [](const Track& track) -> QVariant {
+        return track.getGenre();
+    });
+    getters.insert(LIBRARYTABLE_COMPOSER, [](const Track& track) -> QVariant {
+        return track.getComposer();
+    });
+    getters.insert(LIBRARYTABLE_GROUPING, [](const Track& track) -> QVariant {
+        return track.getGrouping();
+    });
+    getters.insert(LIBRARYTABLE_FILETYPE, [](const Track& track) -> QVariant {
+        return track.getType();
+    });
+    getters.insert(LIBRARYTABLE_TRACKNUMBER, [](const Track& track) -> QVariant {
+        return track.getTrackNumber();
+    });
+    getters.insert(LIBRARYTABLE_LOCATION, [](const Track& track) -> QVariant {
+        return QDir::toNativeSeparators(track.getLocation());
+    });
+    getters.insert(LIBRARYTABLE_COMMENT, [](const Track& track) -> QVariant {
+        return track.getComment();
+    });
+    getters.insert(LIBRARYTABLE_DURATION, [](const Track& track) -> QVariant {
+        return track.getDuration();
+    });
+    getters.insert(LIBRARYTABLE_BITRATE, [](const Track& track) -> QVariant {
+        return track.getBitrate();
+    });
+    getters.insert(LIBRARYTABLE_BPM, [](const Track& track) -> QVariant {
+        return track.getBpm();
+    });
+    getters.insert(LIBRARYTABLE_PLAYED, [](const Track& track) -> QVariant {
+        return track.getPlayCounter().isPlayed();
+    });
+    getters.insert(LIBRARYTABLE_TIMESPLAYED, [](const Track& track) -> QVariant {
+        return track.getPlayCounter().getTimesPlayed();
+    });
+    getters.insert(LIBRARYTABLE_RATING, [](const Track& track) -> QVariant {
+        return track.getRating();
+    });
+    getters.insert(LIBRARYTABLE_KEY, [](const Track& track) -> QVariant {
+        return track.getKeyText();
+    });
+    getters.insert(LIBRARYTABLE_KEY_ID, [](const Track& track) -> QVariant {
+        return static_cast<int>(track.getKey());
+    });
+    getters.insert(LIBRARYTABLE_BPM_LOCK, [](const Track& track) -> QVariant {
+        return track.isBpmLocked();
+    });
+    return getters;
+}
+
+QVector<TrackValueGetter> getTrackValueGettersForColumns(
+        const QStringList& columns) {
+    QVector<TrackValueGetter> getters;
+    for (const auto& column : columns) {
+        TrackValueGetter getter = getTrackValueGetterForColumn(column);
+        if (getter) {
+            getters.append(getter);
+        }
+    }
+    return getters;
+}
+
+} // anonymous namespace
+
+TrackValueGetter getTrackValueGetterForColumn(const QString& column) {
+    static const QHash<QString, TrackValueGetter> getters =
+            createTrackValueGetters();
+    return getters.value(column);
+}
+
 QVariant getTrackValueForColumn(const TrackPointer& pTrack, const QString& column) {
-    if (column == LIBRARYTABLE_ARTIST) {
-        return pTrack->getArtist();
-    } else if (column == LIBRARYTABLE_TITLE) {
-        return pTrack->getTitle();
-    } else if (column == LIBRARYTABLE_ALBUM) {
-        return pTrack->getAlbum();
-    } else if (column == LIBRARYTABLE_ALBUMARTIST) {
-        return pTrack->getAlbumArtist();
-    } else if (column == LIBRARYTABLE_YEAR) {
-        return pTrack->getYear();
-    } else if (column == LIBRARYTABLE_DATETIMEADDED) {
-        return pTrack->getDateAdded();
-    } else if (column == LIBRARYTABLE_GENRE) {
-        return pTrack->getGenre();
-    } else if (column == LIBRARYTABLE_COMPOSER) {
-        return pTrack->getComposer();
-    } else if (column == LIBRARYTABLE_GROUPING) {
-        return pTrack->getGrouping();
-    } else if (column == LIBRARYTABLE_FILETYPE) {
-        return pTrack->getType();
-    } else if (column == LIBRARYTABLE_TRACKNUMBER) {
-        return pTrack->getTrackNumber();
-    } else if (column == LIBRARYTABLE_LOCATION) {
-        return QDir::toNativeSeparators(pTrack->getLocation());
-    } else if (column == LIBRARYTABLE_COMMENT) {
-        return pTrack->getComment();
-    } else if (column == LIBRARYTABLE_DURATION) {
-        return pTrack->getDuration();
-    } else if (column == LIBRARYTABLE_BITRATE) {
-        return pTrack->getBitrate();
-    } else if (column == LIBRARYTABLE_BPM) {
-        return pTrack->getBpm();
-    } else if (column == LIBRARYTABLE_PLAYED) {
-        return pTrack->getPlayCounter().isPlayed();
-    } else if (column == LIBRARYTABLE_TIMESPLAYED) {
-        return pTrack->getPlayCounter().getTimesPlayed();
-    } else if (column == LIBRARYTABLE_RATING) {
-        return pTrack->getRating();
-    } else if (column == LIBRARYTABLE_KEY) {
-        return pTrack->getKeyText();
-    } else if (column == LIBRARYTABLE_KEY_ID) {
-        return static_cast<int>(pTrack->getKey());
-    } else if (column == LIBRARYTABLE_BPM_LOCK) {
-        return pTrack->isBpmLocked();
-    }
-
-    return QVariant();
+    TrackValueGetter getter = getTrackValueGetterForColumn(column);
+    if (!getter) {
+        return QVariant();
+    }
+    return getter(*pTrack);
 }
 
 //static
@@ -73,6 +125,11 @@ QString QueryNode::concatSqlClauses(
     }
 }
 
+//static
+QString QueryNode::trackIdsToSql(const TrackIdSet& trackIds) {
+    return QString("id IN (%1)").arg(trackIds.toSqlList());
+}
+
 bool AndNode::match(const TrackPointer& pTrack) const {
     for (const auto& pNode: m_nodes) {
         if (!pNode->match(pTrack)) {
@@ -85,17 +142,73 @@ bool AndNode::match(const TrackPointer& pTrack) const {
 }
 
 QString AndNode::toSql() const {
+    // The sets of tracks are intersected into a single clause, which
+    // precedes the clauses that SQL has to evaluate for each track
+    TrackIdSet matchingTrackIds;
+    bool hasMatchingTrackIds = false;
+    TrackIdSet nonMatchingTrackIds;
+    bool hasNonMatchingTrackIds = false;
     QStringList queryFragments;
     queryFragments.reserve(m_nodes.size());
     for (const auto& pNode: m_nodes) {
-        QString sql = pNode->toSql();
-        if (!sql.isEmpty()) {
-            queryFragments << sql;
+        TrackIdSet trackIds;
+        if (pNode->evaluate(&trackIds)) {
+            if (hasMatchingTrackIds) {
+                matchingTrackIds &= trackIds;
+            } else {
+                matchingTrackIds = trackIds;
+                hasMatchingTrackIds = true;
+            }
+        } else if (pNode->evaluateNonMatching(&trackIds)) {
+            nonMatchingTrackIds |= trackIds;
+            hasNonMatchingTrackIds = true;
+        } else {
+            QString sql = pNode->toSql();
+            if (!sql.isEmpty()) {
+                queryFragments << sql;
+            }
         }
     }
+    if (hasMatchingTrackIds) {
+        matchingTrackIds -= nonMatchingTrackIds;
+        queryFragments.prepend(trackIdsToSql(matchingTrackIds));
+    } else if (hasNonMatchingTrackIds) {
+        queryFragments.prepend("NOT (" % trackIdsToSql(nonMatchingTrackIds) % ")");
+    }
     return concatSqlClauses(queryFragments, "AND");
 }
 
+bool AndNode::evaluate(TrackIdSet* pTrackIds) const {
+    // An empty AND node matches all tracks
+    if (m_nodes.empty()) {
+        return false;
+    }
+    TrackIdSet matchingTrackIds;
+    TrackIdSet nonMatchingTrackIds;
+    bool hasMatchingTrackIds = false;
+    for (const auto& pNode: m_nodes) {
+        TrackIdSet trackIds;
+        if (pNode->evaluate(&trackIds)) {
+            if (hasMatchingTrackIds) {
+                matchingTrackIds &= trackIds;
+            } else {
+                matchingTrackIds = trackIds;
+                hasMatchingTrackIds = true;
+            }
+        } else if (pNode->evaluateNonMatching(&trackIds)) {
+            nonMatchingTrackIds |= trackIds;
+        } else {
+            return false;
+        }
+    }
+    if (!hasMatchingTrackIds) {
+        return false;
+    }
+    matchingTrackIds -= nonMatchingTrackIds;
+    *pTrackIds = matchingTrackIds;
+    return true;
+}
+
 bool OrNode::match(const TrackPointer& pTrack) const {
     // An empty OR node would always evaluate to false
     // which is inconsistent with the generated SQL query!
@@ -114,22 +227,54 @@ bool OrNode::match(const TrackPointer& pTrack) const {
 }
 
 QString OrNode::toSql() const {
+    // The sets of tracks are united into a single clause
+    TrackIdSet matchingTrackIds;
+    bool hasMatchingTrackIds = false;
     QStringList queryFragments;
     queryFragments.reserve(m_nodes.size());
     for (const auto& pNode: m_nodes) {
+        TrackIdSet trackIds;
+        if (pNode->evaluate(&trackIds)) {
+            matchingTrackIds |= trackIds;
+            hasMatchingTrackIds = true;
+            continue;
+        }
         QString sql = pNode->toSql();
         if (!sql.isEmpty()) {
             queryFragments << sql;
         }
     }
+    if (hasMatchingTrackIds) {
+        queryFragments.prepend(trackIdsToSql(matchingTrackIds));
+    }
     return concatSqlClauses(queryFragments, "OR");
 }
 
+bool OrNode::evaluate(TrackIdSet* pTrackIds) const {
+    if (m_nodes.empty()) {
+        return false;
+    }
+    TrackIdSet matchingTrackIds;
+    for (const auto& pNode: m_nodes) {
+        TrackIdSet trackIds;
+        if (!pNode->evaluate(&trackIds)) {
+            return false;
+        }
+        matchingTrackIds |= trackIds;
+    }
+    *pTrackIds = matchingTrackIds;
+    return true;
+}
+
 bool NotNode::match(const TrackPointer& pTrack) const {
     return !m_pNode->match(pTrack);
 }
 
 QString NotNode::toSql() const {
+    TrackIdSet trackIds;
+    if (m_pNode->evaluate(&trackIds)) {
+        return "NOT (" % trackIdsToSql(trackIds) % ")";
+    }
     QString sql(m_pNode->toSql());
     if (sql.isEmpty()) {
         return QString();
@@ -141,14 +286,34 @@ QString NotNode::toSql() const {
     }
 }
 
+bool NotNode::evaluate(TrackIdSet* pTrackIds) const {
+    return m_pNode->evaluateNonMatching(pTrackIds);
+}
+
+bool NotNode::evaluateNonMatching(TrackIdSet* pTrackIds) const {
+    return m_pNode->evaluate(pTrackIds);
+}
+
+TextFilterNode::TextFilterNode(const QSqlDatabase& database,
+                               const QStringList& sqlColumns,
+                               const QString& argument,
+                               const TextFilterIndex* pIndex)
+        : m_database(database),
+          m_sqlColumns(sqlColumns),
+          m_argument(argument),
+          m_pIndex(pIndex),
+          m_getters(getTrackValueGettersForColumns(sqlColumns)),
+          m_matcher(argument, Qt::CaseInsensitive) {
+}
+
 bool TextFilterNode::match(const TrackPointer& pTrack) const {
-    for (const auto& sqlColumn: m_sqlColumns) {
-        QVariant value = getTrackValueForColumn(pTrack, sqlColumn);
+    for (TrackValueGetter getter : m_getters) {
+        QVariant value = getter(*pTrack);
         if (!value.isValid() || !qVariantCanConvert<QString>(value)) {
             continue;
         }
 
-        if (value.toString().contains(m_argument, Qt::CaseInsensitive)) {
+        if (m_matcher.indexIn(value.toString()) >= 0) {
             return true;
         }
     }
@@ -156,6 +321,11 @@ bool TextFilterNode::match(const TrackPointer& pTrack) const {
 }
 
 QString TextFilterNode::toSql() const {
+    QString indexedSql;
+    if (m_pIndex && m_pIndex->textFilterToSql(m_sqlColumns, m_argument, &indexedSql)) {
+        return indexedSql;
+    }
+
     FieldEscaper escaper(m_database);
     QString escapedArgument = escaper.escapeString(kSqlLikeMatchAll + m_argument + kSqlLikeMatchAll);
 
@@ -166,6 +336,11 @@ QString TextFilterNode::toSql() const {
     return concatSqlClauses(searchClauses, "OR");
 }
 
+bool TextFilterNode::evaluate(TrackIdSet* pTrackIds) const {
+    return m_pIndex &&
+            m_pIndex->textFilterTrackIds(m_sqlColumns, m_argument, pTrackIds);
+}
+
 CrateFilterNode::CrateFilterNode(const CrateStorage* pCrateStorage,
                                  const QString& crateNameLike)
     : m_pCrateStorage(pCrateStorage),
@@ -173,29 +348,39 @@ CrateFilterNode::CrateFilterNode(const CrateStorage* pCrateStorage,
       m_matchInitialized(false) {
 }
 
-bool CrateFilterNode::match(const TrackPointer& pTrack) const {
+const TrackIdSet& CrateFilterNode::matchingTrackIds() const {
     if (!m_matchInitialized) {
         CrateTrackSelectResult crateTracks(
              m_pCrateStorage->selectTracksSortedByCrateNameLike(m_crateNameLike));
 
         while (crateTracks.next()) {
-            m_matchingTrackIds.push_back(crateTracks.trackId());
+            m_matchingTrackIds.insert(crateTracks.trackId());
         }
 
         m_matchInitialized = true;
     }
+    return m_matchingTrackIds;
+}
 
-    return std::binary_search(m_matchingTrackIds.begin(), m_matchingTrackIds.end(), pTrack->getId());
+bool CrateFilterNode::match(const TrackPointer& pTrack) const {
+    return matchingTrackIds().contains(pTrack->getId());
 }
 
 QString CrateFilterNode::toSql() const {
     return QString("id IN (%1)").arg(CrateStorage::formatQueryForTrackIdsByCrateNameLike(m_crateNameLike));
 }
 
+bool CrateFilterNode::evaluate(TrackIdSet* pTrackIds) const {
+    *pTrackIds = matchingTrackIds();
+    return true;
+}
+
 NumericFilterNode::NumericFilterNode(const QStringList& sqlColumns)
         : m_sqlColumns(sqlColumns),
+          m_getters(getTrackValueGettersForColumns(sqlColumns)),
           m_bOperatorQuery(false),
           m_operator("="),
+          m_operatorType(Operator::Equal),
           m_dOperatorArgument(0.0),
           m_bRangeQuery(false),
           m_dRangeLow(0.0),
@@ -213,6 +398,15 @@ void NumericFilterNode::init(QString argument) {
     if (operatorMatcher.indexIn(argument) != -1) {
         m_operator = operatorMatcher.cap(1);
         argument = operatorMatcher.cap(2);
+        if (m_operator == "<") {
+            m_operatorType = Operator::Less;
+        } else if (m_operator == ">") {
+            m_operatorType = Operator::Greater;
+        } else if (m_operator == "<=") {
+            m_operatorType = Operator::LessOrEqual;
+        } else if (m_operator == ">=") {
+            m_operatorType = Operator::GreaterOrEqual;
+        }
     }
 
     bool parsed = false;
@@ -240,19 +434,19 @@ double NumericFilterNode::parse(const QString& arg, bool *ok) {
 }
 
 bool NumericFilterNode::match(const TrackPointer& pTrack) const {
-    for (const auto& sqlColumn: m_sqlColumns) {
-        QVariant value = getTrackValueForColumn(pTrack, sqlColumn);
+    for (TrackValueGetter getter : m_getters) {
+        QVariant value = getter(*pTrack);
         if (!value.isValid() || !qVariantCanConvert<double>(value)) {
             continue;
         }
 
         double dValue = value.toDouble();
         if (m_bOperatorQuery) {
-            if ((m_operator == "=" && dValue == m_dOperatorArgument) ||
-                (m_operator == "<" && dValue < m_dOperatorArgument) ||
-                (m_operator == ">" && dValue > m_dOperatorArgument) ||
-                (m_operator == "<=" && dValue <= m_dOperatorArgument) ||
-                (m_operator == ">=" && dValue >= m_dOperatorArgument)) {
+            if ((m_operatorType == Operator::Equal && dValue == m_dOperatorArgument) ||
+                (m_operatorType == Operator::Less && dValue < m_dOperatorArgument) ||
+                (m_operatorType == Operator::Greater && dValue > m_dOperatorArgument) ||
+                (m_operatorType == Operator::LessOrEqual && dValue <= m_dOperatorArgument) ||
+                (m_operatorType == Operator::GreaterOrEqual && dValue >= m_dOperatorArgument)) {
                 return true;
             }
         } else if (m_bRangeQuery && dValue >= m_dRangeLow &&
@@ -328,22 +522,31 @@ double DurationFilterNode::parse(const QString& arg, bool* ok) {
 }
 
 KeyFilterNode::KeyFilterNode(mixxx::track::io::key::ChromaticKey key,
-                             bool fuzzy) {
-    if (fuzzy) {
-        m_matchKeys = KeyUtils::getCompatibleKeys(key);
-    } else {
-        m_matchKeys.push_back(key);
-    }
+                             bool fuzzy,
+                             const KeyFilterIndex* pIndex)
+        : m_matchKeys(fuzzy ? KeyUtils::getCompatibleKeysMask(key) :
+                      KeyUtils::keyToMask(key)),
+          m_pIndex(pIndex) {
 }
 
 bool KeyFilterNode::match(const TrackPointer& pTrack) const {
-    return m_matchKeys.contains(pTrack->getKey());
+    return (m_matchKeys & KeyUtils::keyToMask(pTrack->getKey())) != 0;
 }
 
 QString KeyFilterNode::toSql() const {
+    TrackIdSet trackIds;
+    if (evaluate(&trackIds)) {
+        return trackIdsToSql(trackIds);
+    }
     QStringList searchClauses;
-    for (const auto& matchKey: m_matchKeys) {
-        searchClauses << QString("key_id IS %1").arg(QString::number(matchKey));
+    for (int key = 0; key <= mixxx::track::io::key::B_MINOR; ++key) {
+        if (m_matchKeys & (KeyUtils::KeyMask(1) << key)) {
+            searchClauses << QString("key_id IS %1").arg(QString::number(key));
+        }
     }
     return concatSqlClauses(searchClauses, "OR");
 }
+
+bool KeyFilterNode::evaluate(TrackIdSet* pTrackIds) const {
+    return m_pIndex && m_pIndex->keyFilterTrackIds(m_matchKeys, pTrackIds);
+}
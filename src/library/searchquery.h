@@ -9,15 +9,26 @@
 #include <QRegExp>
 #include <QString>
 #include <QStringList>
+#include <QStringMatcher>
+#include <QVector>
 
 #include "track/track.h"
 #include "proto/keys.pb.h"
+#include "track/keyutils.h"
 #include "util/assert.h"
 #include "util/memory.h"
 #include "library/crate/cratestorage.h"
+#include "library/trackidset.h"
 
 QVariant getTrackValueForColumn(const TrackPointer& pTrack, const QString& column);
 
+// Reads the value of a column from a track
+typedef QVariant (*TrackValueGetter)(const Track& track);
+// Returns null if the column is not a property of the tracks. The filters
+// look up their getters once instead of comparing the names of the columns
+// for every track that they match.
+TrackValueGetter getTrackValueGetterForColumn(const QString& column);
+
 class QueryNode {
   public:
     QueryNode(const QueryNode&) = delete; // prevent copying
@@ -26,10 +37,27 @@ class QueryNode {
     virtual bool match(const TrackPointer& pTrack) const = 0;
     virtual QString toSql() const = 0;
 
+    // Returns true and sets pTrackIds to the tracks that match if the node
+    // can be evaluated as a set of tracks, e.g. for a crate or from an
+    // index. The composite nodes combine these sets in memory before the
+    // remaining nodes are evaluated by SQL. The default implementation
+    // returns false.
+    virtual bool evaluate(TrackIdSet* pTrackIds) const {
+        Q_UNUSED(pTrackIds);
+        return false;
+    }
+    // The same for the tracks that do not match
+    virtual bool evaluateNonMatching(TrackIdSet* pTrackIds) const {
+        Q_UNUSED(pTrackIds);
+        return false;
+    }
+
   protected:
     QueryNode() {}
 
     static QString concatSqlClauses(const QStringList& sqlClauses, const QString& sqlConcatOp);
+    // A clause that selects the tracks
+    static QString trackIdsToSql(const TrackIdSet& trackIds);
 };
 
 class GroupNode : public QueryNode {
@@ -50,12 +78,14 @@ class OrNode : public GroupNode {
   public:
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool evaluate(TrackIdSet* pTrackIds) const override;
 };
 
 class AndNode : public GroupNode {
   public:
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool evaluate(TrackIdSet* pTrackIds) const override;
 };
 
 class NotNode : public QueryNode {
@@ -67,28 +97,50 @@ class NotNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool evaluate(TrackIdSet* pTrackIds) const override;
+    bool evaluateNonMatching(TrackIdSet* pTrackIds) const override;
 
   private:
     std::unique_ptr<QueryNode> m_pNode;
 };
 
+// Answers text filters without evaluating a LIKE expression for every
+// track, see BaseTrackCache
+class TextFilterIndex {
+  public:
+    virtual ~TextFilterIndex() {}
+
+    // Returns false if the filter can not be answered from the index.
+    // Otherwise pTrackIds is set to the matching tracks.
+    virtual bool textFilterTrackIds(const QStringList& sqlColumns,
+                                    const QString& argument,
+                                    TrackIdSet* pTrackIds) const = 0;
+    // The same, but pSql is set to a clause that selects the matching
+    // tracks. This also works if the index can not provide the tracks
+    // themselves.
+    virtual bool textFilterToSql(const QStringList& sqlColumns,
+                                 const QString& argument,
+                                 QString* pSql) const = 0;
+};
+
 class TextFilterNode : public QueryNode {
   public:
     TextFilterNode(const QSqlDatabase& database,
                    const QStringList& sqlColumns,
-                   const QString& argument)
-            : m_database(database),
-              m_sqlColumns(sqlColumns),
-              m_argument(argument) {
-    }
+                   const QString& argument,
+                   const TextFilterIndex* pIndex = nullptr);
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool evaluate(TrackIdSet* pTrackIds) const override;
 
   private:
     QSqlDatabase m_database;
     QStringList m_sqlColumns;
     QString m_argument;
+    const TextFilterIndex* m_pIndex;
+    QVector<TrackValueGetter> m_getters;
+    QStringMatcher m_matcher;
 };
 
 class CrateFilterNode : public QueryNode {
@@ -98,12 +150,15 @@ class CrateFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool evaluate(TrackIdSet* pTrackIds) const override;
 
   private:
+    const TrackIdSet& matchingTrackIds() const;
+
     const CrateStorage* m_pCrateStorage;
     QString m_crateNameLike;
     mutable bool m_matchInitialized;
-    mutable std::vector<TrackId> m_matchingTrackIds;
+    mutable TrackIdSet m_matchingTrackIds;
 };
 
 class NumericFilterNode : public QueryNode {
@@ -124,11 +179,21 @@ class NumericFilterNode : public QueryNode {
     void init(QString argument);
 
   private:
+    enum class Operator {
+        Equal,
+        Less,
+        Greater,
+        LessOrEqual,
+        GreaterOrEqual,
+    };
+
     virtual double parse(const QString& arg, bool *ok);
 
     QStringList m_sqlColumns;
+    QVector<TrackValueGetter> m_getters;
     bool m_bOperatorQuery;
     QString m_operator;
+    Operator m_operatorType;
     double m_dOperatorArgument;
     bool m_bRangeQuery;
     double m_dRangeLow;
@@ -143,15 +208,30 @@ class DurationFilterNode : public NumericFilterNode {
     double parse(const QString& arg, bool* ok) override;
 };
 
+// Answers key filters without comparing the key of every track, see
+// BaseTrackCache
+class KeyFilterIndex {
+  public:
+    virtual ~KeyFilterIndex() {}
+
+    // Returns false if the filter can not be answered from the index.
+    // Otherwise pTrackIds is set to the tracks with one of the keys.
+    virtual bool keyFilterTrackIds(KeyUtils::KeyMask keys,
+                                   TrackIdSet* pTrackIds) const = 0;
+};
+
 class KeyFilterNode : public QueryNode {
   public:
-    KeyFilterNode(mixxx::track::io::key::ChromaticKey key, bool fuzzy);
+    KeyFilterNode(mixxx::track::io::key::ChromaticKey key, bool fuzzy,
+                  const KeyFilterIndex* pIndex = nullptr);
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool evaluate(TrackIdSet* pTrackIds) const override;
 
   private:
-    QList<mixxx::track::io::key::ChromaticKey> m_matchKeys;
+    KeyUtils::KeyMask m_matchKeys;
+    const KeyFilterIndex* m_pIndex;
 };
 
 class SqlNode : public QueryNode {
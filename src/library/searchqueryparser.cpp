@@ -6,7 +6,9 @@ const char* kNegatePrefix = "-";
 const char* kFuzzyPrefix = "~";
 
 SearchQueryParser::SearchQueryParser(TrackCollection* pTrackCollection)
-    : m_pTrackCollection(pTrackCollection) {
+    : m_pTrackCollection(pTrackCollection),
+      m_pTextFilterIndex(nullptr),
+      m_pKeyFilterIndex(nullptr) {
     m_textFilters << "artist"
                   << "album_artist"
                   << "album"
@@ -131,7 +133,8 @@ void SearchQueryParser::parseTokens(QStringList tokens,
                           &m_pTrackCollection->crates(), argument);
                 } else {
                     pNode = std::make_unique<TextFilterNode>(
-                          m_pTrackCollection->database(), m_fieldToSqlColumns[field], argument);
+                          m_pTrackCollection->database(), m_fieldToSqlColumns[field], argument,
+                          m_pTextFilterIndex);
                 }
             }
         } else if (m_numericFilterMatcher.indexIn(token) != -1) {
@@ -154,9 +157,11 @@ void SearchQueryParser::parseTokens(QStringList tokens,
                             KeyUtils::guessKeyFromText(argument);
                     if (key == mixxx::track::io::key::INVALID) {
                         pNode = std::make_unique<TextFilterNode>(
-                                m_pTrackCollection->database(), m_fieldToSqlColumns[field], argument);
+                                m_pTrackCollection->database(), m_fieldToSqlColumns[field], argument,
+                                m_pTextFilterIndex);
                     } else {
-                        pNode = std::make_unique<KeyFilterNode>(key, fuzzy);
+                        pNode = std::make_unique<KeyFilterNode>(
+                                key, fuzzy, m_pKeyFilterIndex);
                     }
                 } else if (field == "duration") {
                     pNode = std::make_unique<DurationFilterNode>(
@@ -167,7 +172,8 @@ void SearchQueryParser::parseTokens(QStringList tokens,
                            field == "dateadded") {
                     field = "datetime_added";
                     pNode = std::make_unique<TextFilterNode>(
-                        m_pTrackCollection->database(), m_fieldToSqlColumns[field], argument);
+                        m_pTrackCollection->database(), m_fieldToSqlColumns[field], argument,
+                        m_pTextFilterIndex);
                 }
             }
         } else {
@@ -178,7 +184,8 @@ void SearchQueryParser::parseTokens(QStringList tokens,
             // Don't trigger on a lone minus sign.
             if (!token.isEmpty()) {
                 pNode = std::make_unique<TextFilterNode>(
-                                m_pTrackCollection->database(), searchColumns, token);
+                                m_pTrackCollection->database(), searchColumns, token,
+                                m_pTextFilterIndex);
             }
         }
         if (pNode) {
@@ -16,6 +16,16 @@ class SearchQueryParser {
 
     virtual ~SearchQueryParser();
 
+    // The index is used by the text filters of the parsed queries if it is
+    // set. It must outlive these queries.
+    void setTextFilterIndex(const TextFilterIndex* pIndex) {
+        m_pTextFilterIndex = pIndex;
+    }
+    // The same for the key filters
+    void setKeyFilterIndex(const KeyFilterIndex* pIndex) {
+        m_pKeyFilterIndex = pIndex;
+    }
+
     std::unique_ptr<QueryNode> parseQuery(
             const QString& query,
             const QStringList& searchColumns,
@@ -31,6 +41,8 @@ class SearchQueryParser {
                             QStringList* tokens) const;
 
     TrackCollection* m_pTrackCollection;
+    const TextFilterIndex* m_pTextFilterIndex;
+    const KeyFilterIndex* m_pKeyFilterIndex;
     QStringList m_textFilters;
     QStringList m_numericFilters;
     QStringList m_specialFilters;
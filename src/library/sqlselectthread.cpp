@@ -0,0 +1,203 @@
+#include "library/sqlselectthread.h"
+
+#include <QMutexLocker>
+#include <QSqlQuery>
+
+#include "library/queryutil.h"
+#include "util/db/dbconnectionpooled.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/logger.h"
+#include "util/performancetimer.h"
+#include "util/threadroles.h"
+
+namespace {
+
+mixxx::Logger kLogger("SqlSelectThread");
+
+// The number of rows between two checks for a newer request
+const int kRowsPerCancelCheck = 256;
+
+} // anonymous namespace
+
+SqlSelectThread::SqlSelectThread(
+        mixxx::DbConnectionPoolPtr pDbConnectionPool,
+        QObject* pParent)
+        : QThread(pParent),
+          m_pDbConnectionPool(std::move(pDbConnectionPool)),
+          m_quit(false) {
+    qRegisterMetaType<SqlSelectResultPointer>("SqlSelectResultPointer");
+    start();
+}
+
+SqlSelectThread::~SqlSelectThread() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_quit = true;
+        m_pendingRequests.clear();
+        m_generations.clear();
+        m_requested.wakeAll();
+    }
+    wait();
+}
+
+// static
+QList<QPair<QString, QString>> SqlSelectThread::temporaryViews(
+        const QSqlDatabase& database) {
+    QList<QPair<QString, QString>> views;
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT name, sql FROM sqlite_temp_master "
+            "WHERE type = 'view' ORDER BY rowid")) {
+        LOG_FAILED_QUERY(query);
+        return views;
+    }
+    while (query.next()) {
+        views.append(qMakePair(query.value(0).toString(),
+                query.value(1).toString()));
+    }
+    return views;
+}
+
+void SqlSelectThread::request(const SqlSelectRequest& request) {
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_pendingRequests.begin(); it != m_pendingRequests.end(); ++it) {
+        if (it->pRequester == request.pRequester) {
+            m_pendingRequests.erase(it);
+            break;
+        }
+    }
+    m_pendingRequests.append(request);
+    m_generations.insert(request.pRequester, request.generation);
+    m_requested.wakeAll();
+}
+
+void SqlSelectThread::cancel(const QObject* pRequester) {
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_pendingRequests.begin(); it != m_pendingRequests.end(); ++it) {
+        if (it->pRequester == pRequester) {
+            m_pendingRequests.erase(it);
+            break;
+        }
+    }
+    m_generations.remove(pRequester);
+}
+
+bool SqlSelectThread::isCurrent(const SqlSelectRequest& request) const {
+    QMutexLocker locker(&m_mutex);
+    return !m_quit &&
+            m_generations.value(request.pRequester, -1) == request.generation;
+}
+
+void SqlSelectThread::run() {
+    kLogger.debug() << "Entering thread";
+    mixxx::ThreadRoles::applyToCurrentThread(
+            mixxx::ThreadRole::LibraryQuery);
+
+    // Queries only read, concurrently with the writers of the library
+    const mixxx::DbConnectionPooler dbConnectionPooler(
+            m_pDbConnectionPool, mixxx::DbConnection::Mode::ReadOnly);
+    QSqlDatabase database = mixxx::DbConnectionPooled(m_pDbConnectionPool);
+    if (!database.isOpen()) {
+        kLogger.warning()
+                << "Failed to open database connection for library queries";
+    }
+
+    forever {
+        SqlSelectRequest request;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_quit && m_pendingRequests.isEmpty()) {
+                m_requested.wait(&m_mutex);
+            }
+            if (m_quit) {
+                break;
+            }
+            request = m_pendingRequests.takeFirst();
+        }
+
+        SqlSelectResultPointer pResult = execute(request, database);
+        if (pResult && isCurrent(request)) {
+            emit(selected(pResult));
+        }
+    }
+    kLogger.debug() << "Exiting thread";
+}
+
+bool SqlSelectThread::updateTemporaryViews(
+        const SqlSelectRequest& request,
+        QSqlDatabase database) {
+    for (const auto& view : request.temporaryViews) {
+        auto it = m_temporaryViews.constFind(view.first);
+        if (it != m_temporaryViews.constEnd() && it.value() == view.second) {
+            continue;
+        }
+        // SQLite resolves the tables of a view when it is used, so the
+        // views can be created in any order
+        QSqlQuery query(database);
+        if (!query.exec(QString("DROP VIEW IF EXISTS temp.%1").arg(view.first)) ||
+                !query.exec(view.second)) {
+            LOG_FAILED_QUERY(query);
+            m_temporaryViews.remove(view.first);
+            return false;
+        }
+        m_temporaryViews.insert(view.first, view.second);
+    }
+    return true;
+}
+
+SqlSelectResultPointer SqlSelectThread::execute(
+        const SqlSelectRequest& request,
+        QSqlDatabase database) {
+    PerformanceTimer timer;
+    timer.start();
+
+    QSharedPointer<SqlSelectResult> pResult(new SqlSelectResult);
+    pResult->pRequester = request.pRequester;
+    pResult->generation = request.generation;
+    if (!database.isOpen() || !updateTemporaryViews(request, database)) {
+        // The requester falls back to its own connection
+        return pResult;
+    }
+
+    QSqlQuery query(database);
+    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
+    // won't allocate a giant in-memory table that we won't use at all.
+    query.setForwardOnly(true);
+    if (!query.exec(request.rowQuery)) {
+        LOG_FAILED_QUERY(query);
+        return pResult;
+    }
+    while (query.next()) {
+        if (pResult->rowTrackIds.size() % kRowsPerCancelCheck == 0 &&
+                !isCurrent(request)) {
+            return SqlSelectResultPointer();
+        }
+        pResult->rowTrackIds.append(TrackId(query.value(0)));
+    }
+    // Releases the lock on the database before the next query
+    query.finish();
+
+    if (!request.trackQuery.isEmpty() && !pResult->rowTrackIds.isEmpty()) {
+        if (!isCurrent(request)) {
+            return SqlSelectResultPointer();
+        }
+        if (!query.exec(request.trackQuery)) {
+            LOG_FAILED_QUERY(query);
+            return pResult;
+        }
+        while (query.next()) {
+            if (pResult->sortedTrackIds.size() % kRowsPerCancelCheck == 0 &&
+                    !isCurrent(request)) {
+                return SqlSelectResultPointer();
+            }
+            pResult->sortedTrackIds.append(TrackId(query.value(0)));
+        }
+        query.finish();
+    }
+
+    pResult->ok = true;
+    kLogger.debug()
+            << "Selected" << pResult->rowTrackIds.size() << "rows in"
+            << timer.elapsed().debugMillisWithUnit();
+    return pResult;
+}
@@ -0,0 +1,104 @@
+#ifndef LIBRARY_SQLSELECTTHREAD_H
+#define LIBRARY_SQLSELECTTHREAD_H
+
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QMutex>
+#include <QPair>
+#include <QSharedPointer>
+#include <QSqlDatabase>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "track/trackid.h"
+#include "util/db/dbconnectionpool.h"
+
+// The queries of a select() of a BaseSqlTableModel
+struct SqlSelectRequest {
+    SqlSelectRequest()
+            : pRequester(nullptr),
+              generation(0) {
+    }
+
+    // The model that receives the result, which is only compared
+    const QObject* pRequester;
+    int generation;
+    // The names and CREATE statements of the temporary views of the
+    // connection of the requester that the queries might depend on, in
+    // the order of their creation
+    QList<QPair<QString, QString>> temporaryViews;
+    // Selects the id of the track of each row
+    QString rowQuery;
+    // Selects the ids of the matching tracks in the order of the track
+    // source. Optional.
+    QString trackQuery;
+};
+
+struct SqlSelectResult {
+    SqlSelectResult()
+            : pRequester(nullptr),
+              generation(0),
+              ok(false) {
+    }
+
+    const QObject* pRequester;
+    int generation;
+    bool ok;
+    QVector<TrackId> rowTrackIds;
+    QVector<TrackId> sortedTrackIds;
+};
+
+typedef QSharedPointer<const SqlSelectResult> SqlSelectResultPointer;
+Q_DECLARE_METATYPE(SqlSelectResultPointer);
+
+// Executes the queries of the library views on its own connection from the
+// pool, so that the GUI thread does not wait for them. There is at most one
+// request per requester: a new request supersedes the pending one and
+// cancels the one that is executing between two rows.
+class SqlSelectThread : public QThread {
+    Q_OBJECT
+  public:
+    explicit SqlSelectThread(
+            mixxx::DbConnectionPoolPtr pDbConnectionPool,
+            QObject* pParent = nullptr);
+    ~SqlSelectThread() override;
+
+    // Returns the temporary views of the connection for a request
+    static QList<QPair<QString, QString>> temporaryViews(
+            const QSqlDatabase& database);
+
+    void request(const SqlSelectRequest& request);
+    void cancel(const QObject* pRequester);
+
+  signals:
+    // Not emitted for the requests that are superseded or cancelled
+    void selected(SqlSelectResultPointer pResult);
+
+  protected:
+    void run() override;
+
+  private:
+    bool isCurrent(const SqlSelectRequest& request) const;
+    bool updateTemporaryViews(const SqlSelectRequest& request,
+            QSqlDatabase database);
+    SqlSelectResultPointer execute(const SqlSelectRequest& request,
+            QSqlDatabase database);
+
+    const mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_requested;
+    QList<SqlSelectRequest> m_pendingRequests;
+    // The generation of the latest request of each requester
+    QHash<const QObject*, int> m_generations;
+    bool m_quit;
+
+    // The temporary views that have been created on the connection of this
+    // thread. Only accessed by the thread.
+    QHash<QString, QString> m_temporaryViews;
+};
+
+#endif // LIBRARY_SQLSELECTTHREAD_H
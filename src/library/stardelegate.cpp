@@ -18,6 +18,7 @@
 
 #include <QtDebug>
 
+#include "library/cellpixmapcache.h"
 #include "library/stardelegate.h"
 #include "library/stareditor.h"
 #include "library/starrating.h"
@@ -42,7 +43,18 @@ void StarDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
     initStyleOption(&newOption, index);
 
     StarRating starRating = qVariantValue<StarRating>(index.data());
-    StarEditor::renderHelper(painter, m_pTableView, option, &starRating);
+    const QString key = QString("star|%1/%2|").arg(
+            QString::number(starRating.starCount()),
+            QString::number(starRating.maxStarCount())) +
+            CellPixmapCache::optionKey(option,
+                    m_pTableView ? m_pTableView->style() : NULL);
+    CellPixmapCache::paint(painter, option.rect, key,
+            [this, &option, &starRating](QPainter* pPainter, const QRect& rect) {
+                QStyleOptionViewItemV4 cellOption = option;
+                cellOption.rect = rect;
+                StarEditor::renderHelper(pPainter, m_pTableView, cellOption,
+                                         &starRating);
+            });
 }
 
 QSize StarDelegate::sizeHint(const QStyleOptionViewItem& option,
@@ -0,0 +1,54 @@
+#include "library/textfilterresultcache.h"
+
+#include "util/assert.h"
+
+TextFilterResultCache::TextFilterResultCache(int maxCount)
+        : m_maxCount(maxCount) {
+    DEBUG_ASSERT(m_maxCount > 0);
+}
+
+void TextFilterResultCache::insert(const QStringList& sqlColumns,
+        const QString& foldedTerm, const TrackIdSet& trackIds) {
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].sqlColumns == sqlColumns &&
+                m_entries[i].foldedTerm == foldedTerm) {
+            m_entries.removeAt(i);
+            break;
+        }
+    }
+    Entry entry;
+    entry.sqlColumns = sqlColumns;
+    entry.foldedTerm = foldedTerm;
+    entry.trackIds = trackIds;
+    m_entries.prepend(entry);
+    while (m_entries.size() > m_maxCount) {
+        m_entries.removeLast();
+    }
+}
+
+bool TextFilterResultCache::findSuperset(const QStringList& sqlColumns,
+        const QString& foldedTerm, TrackIdSet* pTrackIds, bool* pExact) {
+    int found = -1;
+    for (int i = 0; i < m_entries.size(); ++i) {
+        const Entry& entry = m_entries[i];
+        if (entry.sqlColumns != sqlColumns ||
+                !foldedTerm.contains(entry.foldedTerm)) {
+            continue;
+        }
+        if (entry.foldedTerm.size() == foldedTerm.size()) {
+            found = i;
+            break;
+        }
+        if (found < 0 || entry.trackIds.size() < m_entries[found].trackIds.size()) {
+            found = i;
+        }
+    }
+    if (found < 0) {
+        return false;
+    }
+    // Used again
+    m_entries.move(found, 0);
+    *pTrackIds = m_entries.front().trackIds;
+    *pExact = m_entries.front().foldedTerm.size() == foldedTerm.size();
+    return true;
+}
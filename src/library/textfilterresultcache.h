@@ -0,0 +1,48 @@
+#ifndef LIBRARY_TEXTFILTERRESULTCACHE_H
+#define LIBRARY_TEXTFILTERRESULTCACHE_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "library/trackidset.h"
+
+// The tracks that matched the most recent text filters of a cache. While a
+// search is typed, each term contains the term of the previous keystroke,
+// so its tracks are a subset of the previous result: only these tracks
+// need to be checked again instead of all candidates of the search index.
+//
+// A result stays valid until any track has been added, changed or removed,
+// then all results need to be dropped.
+class TextFilterResultCache {
+  public:
+    explicit TextFilterResultCache(int maxCount);
+
+    void clear() {
+        m_entries.clear();
+    }
+
+    // The tracks whose columns contain the folded term
+    void insert(const QStringList& sqlColumns, const QString& foldedTerm,
+                const TrackIdSet& trackIds);
+
+    // Returns false if there is no result of the same columns whose term is
+    // contained in the folded term. Otherwise sets pTrackIds to the smallest
+    // of these results, which contains all tracks that match the term, and
+    // pExact to whether it is the result of the term itself.
+    bool findSuperset(const QStringList& sqlColumns, const QString& foldedTerm,
+                      TrackIdSet* pTrackIds, bool* pExact);
+
+  private:
+    struct Entry {
+        QStringList sqlColumns;
+        QString foldedTerm;
+        TrackIdSet trackIds;
+    };
+
+    const int m_maxCount;
+    // The most recently used first
+    QList<Entry> m_entries;
+};
+
+#endif // LIBRARY_TEXTFILTERRESULTCACHE_H
@@ -17,7 +17,8 @@ TrackCollection::TrackCollection(
         const UserSettingsPointer& pConfig)
         : m_analysisDao(pConfig),
           m_trackDao(m_cueDao, m_playlistDao,
-                     m_analysisDao, m_libraryHashDao, pConfig) {
+                     m_analysisDao, m_libraryHashDao, pConfig),
+          m_pSelectThread(nullptr) {
 }
 
 TrackCollection::~TrackCollection() {
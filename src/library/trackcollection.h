@@ -17,6 +17,7 @@
 
 
 // forward declaration(s)
+class SqlSelectThread;
 class Track;
 
 // Manages everything around tracks.
@@ -62,6 +63,15 @@ class TrackCollection : public QObject,
     }
     void setTrackSource(QSharedPointer<BaseTrackCache> pTrackSource);
 
+    // The thread for the queries of the library views, if they are
+    // executed asynchronously
+    SqlSelectThread* getSelectThread() const {
+        return m_pSelectThread;
+    }
+    void setSelectThread(SqlSelectThread* pSelectThread) {
+        m_pSelectThread = pSelectThread;
+    }
+
     void cancelLibraryScan();
 
     void relocateDirectory(QString oldDir, QString newDir);
@@ -106,6 +116,7 @@ class TrackCollection : public QObject,
     TrackDAO m_trackDao;
 
     QSharedPointer<BaseTrackCache> m_pTrackSource;
+    SqlSelectThread* m_pSelectThread;
 };
 
 #endif // TRACKCOLLECTION_H
@@ -0,0 +1,296 @@
+#include "library/trackidset.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <QStringList>
+
+namespace {
+
+const int kBitsPerWord = 64;
+const int kWordsPerBitmap = (1 << 16) / kBitsPerWord;
+// A bitmap takes 8 KiB, which is as much as an array of 4096 values
+const int kMaxArraySize = 4096;
+
+inline int bitCount(quint64 word) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    while (word) {
+        word &= word - 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline quint16 upperBits(int id) {
+    return static_cast<quint16>(static_cast<quint32>(id) >> 16);
+}
+
+inline quint16 lowerBits(int id) {
+    return static_cast<quint16>(static_cast<quint32>(id) & 0xFFFF);
+}
+
+} // anonymous namespace
+
+TrackIdSet::Chunk::Chunk()
+        : m_size(0) {
+}
+
+void TrackIdSet::Chunk::insert(quint16 value) {
+    if (isBitmap()) {
+        quint64& word = m_bits[value / kBitsPerWord];
+        const quint64 bit = quint64(1) << (value % kBitsPerWord);
+        if (!(word & bit)) {
+            word |= bit;
+            ++m_size;
+        }
+        return;
+    }
+    auto it = std::lower_bound(m_values.begin(), m_values.end(), value);
+    if (it != m_values.end() && *it == value) {
+        return;
+    }
+    m_values.insert(it, value);
+    ++m_size;
+    if (m_size > kMaxArraySize) {
+        toBitmap();
+    }
+}
+
+bool TrackIdSet::Chunk::contains(quint16 value) const {
+    if (isBitmap()) {
+        return (m_bits[value / kBitsPerWord] >> (value % kBitsPerWord)) & 1;
+    }
+    return std::binary_search(m_values.begin(), m_values.end(), value);
+}
+
+void TrackIdSet::Chunk::intersect(const Chunk& other) {
+    if (isBitmap() && other.isBitmap()) {
+        m_size = 0;
+        for (int i = 0; i < kWordsPerBitmap; ++i) {
+            m_bits[i] &= other.m_bits[i];
+            m_size += bitCount(m_bits[i]);
+        }
+    } else if (isBitmap()) {
+        // The result is not larger than the array of the other chunk
+        QVector<quint16> values;
+        for (quint16 value : other.m_values) {
+            if (contains(value)) {
+                values.append(value);
+            }
+        }
+        m_bits.clear();
+        m_values.swap(values);
+        m_size = m_values.size();
+    } else {
+        QVector<quint16> values;
+        for (quint16 value : m_values) {
+            if (other.contains(value)) {
+                values.append(value);
+            }
+        }
+        m_values.swap(values);
+        m_size = m_values.size();
+    }
+    optimize();
+}
+
+void TrackIdSet::Chunk::unite(const Chunk& other) {
+    if (!isBitmap() && !other.isBitmap()) {
+        QVector<quint16> values;
+        values.reserve(m_values.size() + other.m_values.size());
+        std::set_union(m_values.begin(), m_values.end(),
+                other.m_values.begin(), other.m_values.end(),
+                std::back_inserter(values));
+        m_values.swap(values);
+        m_size = m_values.size();
+    } else {
+        toBitmap();
+        if (other.isBitmap()) {
+            m_size = 0;
+            for (int i = 0; i < kWordsPerBitmap; ++i) {
+                m_bits[i] |= other.m_bits[i];
+                m_size += bitCount(m_bits[i]);
+            }
+        } else {
+            for (quint16 value : other.m_values) {
+                insert(value);
+            }
+        }
+    }
+    optimize();
+}
+
+void TrackIdSet::Chunk::subtract(const Chunk& other) {
+    if (isBitmap()) {
+        if (other.isBitmap()) {
+            m_size = 0;
+            for (int i = 0; i < kWordsPerBitmap; ++i) {
+                m_bits[i] &= ~other.m_bits[i];
+                m_size += bitCount(m_bits[i]);
+            }
+        } else {
+            for (quint16 value : other.m_values) {
+                quint64& word = m_bits[value / kBitsPerWord];
+                const quint64 bit = quint64(1) << (value % kBitsPerWord);
+                if (word & bit) {
+                    word &= ~bit;
+                    --m_size;
+                }
+            }
+        }
+    } else {
+        QVector<quint16> values;
+        for (quint16 value : m_values) {
+            if (!other.contains(value)) {
+                values.append(value);
+            }
+        }
+        m_values.swap(values);
+        m_size = m_values.size();
+    }
+    optimize();
+}
+
+template<typename F>
+void TrackIdSet::Chunk::forEach(F f) const {
+    if (isBitmap()) {
+        for (int i = 0; i < kWordsPerBitmap; ++i) {
+            quint64 word = m_bits[i];
+            while (word) {
+                const int bit = bitCount((word & (~word + 1)) - 1);
+                f(static_cast<quint16>(i * kBitsPerWord + bit));
+                word &= word - 1;
+            }
+        }
+    } else {
+        for (quint16 value : m_values) {
+            f(value);
+        }
+    }
+}
+
+void TrackIdSet::Chunk::toBitmap() {
+    if (isBitmap()) {
+        return;
+    }
+    m_bits.fill(0, kWordsPerBitmap);
+    for (quint16 value : m_values) {
+        m_bits[value / kBitsPerWord] |= quint64(1) << (value % kBitsPerWord);
+    }
+    m_values.clear();
+}
+
+void TrackIdSet::Chunk::optimize() {
+    if (isBitmap() && m_size <= kMaxArraySize) {
+        QVector<quint16> values;
+        values.reserve(m_size);
+        forEach([&values](quint16 value) {
+            values.append(value);
+        });
+        m_bits.clear();
+        m_values.swap(values);
+    } else if (!isBitmap() && m_size > kMaxArraySize) {
+        toBitmap();
+    }
+}
+
+void TrackIdSet::insert(TrackId trackId) {
+    if (!trackId.isValid()) {
+        return;
+    }
+    const int id = trackId.toInt();
+    Chunk& chunk = m_chunks[upperBits(id)];
+    const int size = chunk.size();
+    chunk.insert(lowerBits(id));
+    m_size += chunk.size() - size;
+}
+
+bool TrackIdSet::contains(TrackId trackId) const {
+    if (!trackId.isValid()) {
+        return false;
+    }
+    const int id = trackId.toInt();
+    auto it = m_chunks.constFind(upperBits(id));
+    return it != m_chunks.constEnd() && it->contains(lowerBits(id));
+}
+
+TrackIdSet& TrackIdSet::operator&=(const TrackIdSet& other) {
+    auto it = m_chunks.begin();
+    while (it != m_chunks.end()) {
+        auto otherIt = other.m_chunks.constFind(it.key());
+        if (otherIt == other.m_chunks.constEnd()) {
+            it = m_chunks.erase(it);
+            continue;
+        }
+        it->intersect(*otherIt);
+        if (it->size() == 0) {
+            it = m_chunks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    updateSize();
+    return *this;
+}
+
+TrackIdSet& TrackIdSet::operator|=(const TrackIdSet& other) {
+    for (auto otherIt = other.m_chunks.constBegin();
+            otherIt != other.m_chunks.constEnd(); ++otherIt) {
+        auto it = m_chunks.find(otherIt.key());
+        if (it == m_chunks.end()) {
+            m_chunks.insert(otherIt.key(), *otherIt);
+        } else {
+            it->unite(*otherIt);
+        }
+    }
+    updateSize();
+    return *this;
+}
+
+TrackIdSet& TrackIdSet::operator-=(const TrackIdSet& other) {
+    for (auto otherIt = other.m_chunks.constBegin();
+            otherIt != other.m_chunks.constEnd(); ++otherIt) {
+        auto it = m_chunks.find(otherIt.key());
+        if (it == m_chunks.end()) {
+            continue;
+        }
+        it->subtract(*otherIt);
+        if (it->size() == 0) {
+            m_chunks.erase(it);
+        }
+    }
+    updateSize();
+    return *this;
+}
+
+QVector<TrackId> TrackIdSet::toTrackIds() const {
+    QVector<TrackId> trackIds;
+    trackIds.reserve(m_size);
+    for (auto it = m_chunks.constBegin(); it != m_chunks.constEnd(); ++it) {
+        const int upper = static_cast<int>(it.key()) << 16;
+        it->forEach([&trackIds, upper](quint16 value) {
+            trackIds.append(TrackId(upper | value));
+        });
+    }
+    return trackIds;
+}
+
+QString TrackIdSet::toSqlList() const {
+    QStringList idStrings;
+    idStrings.reserve(m_size);
+    for (const auto& trackId : toTrackIds()) {
+        idStrings.append(trackId.toString());
+    }
+    return idStrings.join(",");
+}
+
+void TrackIdSet::updateSize() {
+    m_size = 0;
+    for (const auto& chunk : m_chunks) {
+        m_size += chunk.size();
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef LIBRARY_TRACKIDSET_H
+#define LIBRARY_TRACKIDSET_H
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "track/trackid.h"
+
+// A compressed set of track ids in the style of a roaring bitmap. The ids
+// are split into chunks of 2^16 ids by their upper bits. A chunk with few
+// ids keeps them in a sorted array and a chunk with many ids in a bitmap,
+// so sparse and dense sets both stay small. The sets are combined chunk
+// by chunk, which is much cheaper than looking up the ids one by one.
+//
+// Typical sets are the tracks of crates that are combined by the filters
+// of a search, see QueryNode::evaluate().
+class TrackIdSet {
+  public:
+    TrackIdSet()
+            : m_size(0) {
+    }
+
+    bool isEmpty() const {
+        return m_size == 0;
+    }
+    int size() const {
+        return m_size;
+    }
+
+    // Invalid ids are ignored
+    void insert(TrackId trackId);
+    bool contains(TrackId trackId) const;
+
+    TrackIdSet& operator&=(const TrackIdSet& other);
+    TrackIdSet& operator|=(const TrackIdSet& other);
+    // Removes the ids of the other set
+    TrackIdSet& operator-=(const TrackIdSet& other);
+
+    // In ascending order
+    QVector<TrackId> toTrackIds() const;
+    // The ids as a comma separated list for an IN clause of SQL
+    QString toSqlList() const;
+
+  private:
+    class Chunk {
+      public:
+        Chunk();
+
+        int size() const {
+            return m_size;
+        }
+        bool isBitmap() const {
+            return !m_bits.isEmpty();
+        }
+
+        void insert(quint16 value);
+        bool contains(quint16 value) const;
+
+        void intersect(const Chunk& other);
+        void unite(const Chunk& other);
+        void subtract(const Chunk& other);
+
+        // Calls f(value) for all values in ascending order
+        template<typename F>
+        void forEach(F f) const;
+
+      private:
+        void toBitmap();
+        // Switches to the representation that fits the size
+        void optimize();
+
+        // The sorted values if the chunk is not a bitmap
+        QVector<quint16> m_values;
+        // A bit for each of the 2^16 values, or empty
+        QVector<quint64> m_bits;
+        int m_size;
+    };
+
+    void updateSize();
+
+    // By the upper 16 bits of the ids, without empty chunks
+    QMap<quint16, Chunk> m_chunks;
+    int m_size;
+};
+
+#endif // LIBRARY_TRACKIDSET_H
@@ -0,0 +1,40 @@
+#include "library/trackkeyindex.h"
+
+TrackKeyIndex::TrackKeyIndex()
+        : m_bValid(false),
+          m_tracksByKey(mixxx::track::io::key::B_MINOR + 1) {
+}
+
+void TrackKeyIndex::invalidateAll() {
+    m_bValid = false;
+    m_staleTrackIds.clear();
+}
+
+void TrackKeyIndex::insert(TrackId trackId,
+        mixxx::track::io::key::ChromaticKey key) {
+    if (!mixxx::track::io::key::ChromaticKey_IsValid(key)) {
+        key = mixxx::track::io::key::INVALID;
+    }
+    m_keys.insert(trackId, key);
+    m_tracksByKey[static_cast<int>(key)].insert(trackId);
+}
+
+void TrackKeyIndex::remove(TrackId trackId) {
+    auto it = m_keys.find(trackId);
+    if (it != m_keys.end()) {
+        m_tracksByKey[static_cast<int>(it.value())].remove(trackId);
+        m_keys.erase(it);
+    }
+}
+
+QVector<TrackId> TrackKeyIndex::select(KeyUtils::KeyMask keys) const {
+    QVector<TrackId> selected;
+    for (int key = 0; key < m_tracksByKey.size(); ++key) {
+        if (keys & (KeyUtils::KeyMask(1) << key)) {
+            for (const auto& trackId : m_tracksByKey[key]) {
+                selected.append(trackId);
+            }
+        }
+    }
+    return selected;
+}
@@ -0,0 +1,73 @@
+#ifndef LIBRARY_TRACKKEYINDEX_H
+#define LIBRARY_TRACKKEYINDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include "proto/keys.pb.h"
+#include "track/keyutils.h"
+#include "track/trackid.h"
+
+// The tracks of a cache grouped by their key. A key filter, e.g. for the
+// keys that are compatible with a key, only needs to collect the tracks of
+// the matching keys instead of comparing the key of every track.
+//
+// Like TrackSortIndex the tracks that are added, changed or removed are
+// indexed again the next time the index is updated.
+class TrackKeyIndex {
+  public:
+    TrackKeyIndex();
+
+    // The track has been added, changed or removed
+    void invalidate(TrackId trackId) {
+        if (m_bValid) {
+            m_staleTrackIds.insert(trackId);
+        }
+    }
+    // The keys of all tracks might have changed
+    void invalidateAll();
+
+    // Brings the index up to date with the rows of the cache. The function
+    // returns the key of a row.
+    template<typename KeyOfRow>
+    void update(const QHash<TrackId, int>& rows, KeyOfRow keyOfRow);
+
+    // Returns the tracks with one of the keys in no particular order
+    QVector<TrackId> select(KeyUtils::KeyMask keys) const;
+
+  private:
+    void insert(TrackId trackId, mixxx::track::io::key::ChromaticKey key);
+    void remove(TrackId trackId);
+
+    bool m_bValid;
+    QSet<TrackId> m_staleTrackIds;
+    QHash<TrackId, mixxx::track::io::key::ChromaticKey> m_keys;
+    // Indexed by the key
+    QVector<QSet<TrackId>> m_tracksByKey;
+};
+
+template<typename KeyOfRow>
+void TrackKeyIndex::update(const QHash<TrackId, int>& rows, KeyOfRow keyOfRow) {
+    if (!m_bValid) {
+        m_keys.clear();
+        for (auto& trackIds : m_tracksByKey) {
+            trackIds.clear();
+        }
+        for (auto it = rows.constBegin(); it != rows.constEnd(); ++it) {
+            insert(it.key(), keyOfRow(it.value()));
+        }
+        m_bValid = true;
+    } else {
+        for (const auto& trackId : m_staleTrackIds) {
+            remove(trackId);
+            auto it = rows.constFind(trackId);
+            if (it != rows.constEnd()) {
+                insert(trackId, keyOfRow(it.value()));
+            }
+        }
+    }
+    m_staleTrackIds.clear();
+}
+
+#endif // LIBRARY_TRACKKEYINDEX_H
@@ -0,0 +1,219 @@
+#include "library/trackmetadataexportqueue.h"
+
+#include <QMutexLocker>
+
+#include "sources/soundsourceproxy.h"
+#include "util/assert.h"
+#include "util/counter.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("TrackMetadataExportQueue");
+
+// Merges the exports of a track that is edited several times in a row
+const mixxx::Duration kExportDelay = mixxx::Duration::fromMillis(1000);
+
+// The delay before a track that is in use is checked again
+const mixxx::Duration kInUseRetryDelay = mixxx::Duration::fromMillis(5000);
+
+// The delay after the first failed attempt, which is doubled after each
+// following one
+const mixxx::Duration kFailedRetryDelay = mixxx::Duration::fromMillis(5000);
+const int kMaxFailedAttempts = 5;
+
+Counter s_exportedCounter("TrackMetadataExportQueue exported");
+Counter s_failedCounter("TrackMetadataExportQueue failed");
+
+} // anonymous namespace
+
+TrackMetadataExportQueue::TrackMetadataExportQueue(
+        const TrackInUsePredicate& isTrackInUse)
+        : m_isTrackInUse(isTrackInUse),
+          m_exporting(false),
+          m_flushing(false),
+          m_stop(false) {
+    m_clock.start();
+    setObjectName("TrackMetadataExportQueue");
+}
+
+TrackMetadataExportQueue::~TrackMetadataExportQueue() {
+    QMutexLocker locker(&m_mutex);
+    m_stop = true;
+    m_jobsChanged.wakeAll();
+    if (!m_jobs.isEmpty()) {
+        kLogger.warning()
+                << "Dropping" << m_jobs.size()
+                << "pending exports of track metadata";
+    }
+    locker.unlock();
+    wait();
+}
+
+void TrackMetadataExportQueue::enqueue(Track* pTrack) {
+    DEBUG_ASSERT(pTrack);
+    Job job;
+    job.snapshot = pTrack->takeMetadataExportSnapshot();
+    job.trackId = pTrack->getId();
+    job.location = pTrack->getCanonicalLocation();
+    if (job.location.isEmpty()) {
+        kLogger.warning()
+                << "Unable to export track metadata into missing file"
+                << pTrack->getLocation();
+        return;
+    }
+    job.pSecurityToken = pTrack->getSecurityToken();
+
+    QMutexLocker locker(&m_mutex);
+    job.due = m_clock.elapsed() + kExportDelay;
+    const int index = indexOfLocation(job.location);
+    if (index >= 0) {
+        // The newer metadata replaces the pending export, but an explicit
+        // request for the export must not get lost
+        job.snapshot.markedForMetadataExport |=
+                m_jobs[index].snapshot.markedForMetadataExport;
+        m_jobs[index] = job;
+    } else if (job.snapshot.markedForMetadataExport ||
+            job.snapshot.metadataSynchronized) {
+        m_jobs.append(job);
+    } else {
+        // Would be skipped anyway, see Track::exportMetadata()
+        return;
+    }
+    m_jobsChanged.wakeAll();
+    locker.unlock();
+    if (!isRunning()) {
+        start(QThread::LowPriority);
+    }
+}
+
+void TrackMetadataExportQueue::flush() {
+    QMutexLocker locker(&m_mutex);
+    if (m_jobs.isEmpty() && !m_exporting) {
+        return;
+    }
+    m_flushing = true;
+    m_jobsChanged.wakeAll();
+    while ((!m_jobs.isEmpty() || m_exporting) && isRunning()) {
+        m_idle.wait(&m_mutex);
+    }
+    m_flushing = false;
+}
+
+QList<TrackId> TrackMetadataExportQueue::takeExportedTrackIds() {
+    QMutexLocker locker(&m_mutex);
+    QList<TrackId> trackIds;
+    trackIds.swap(m_exportedTrackIds);
+    return trackIds;
+}
+
+int TrackMetadataExportQueue::indexOfLocation(const QString& location) const {
+    for (int i = 0; i < m_jobs.size(); ++i) {
+        if (m_jobs[i].location == location) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int TrackMetadataExportQueue::indexOfNextJob() const {
+    int next = -1;
+    for (int i = 0; i < m_jobs.size(); ++i) {
+        if (next < 0 || m_jobs[i].due < m_jobs[next].due) {
+            next = i;
+        }
+    }
+    return next;
+}
+
+void TrackMetadataExportQueue::run() {
+    QMutexLocker locker(&m_mutex);
+    while (!m_stop) {
+        const int index = indexOfNextJob();
+        if (index < 0) {
+            m_idle.wakeAll();
+            m_jobsChanged.wait(&m_mutex);
+            continue;
+        }
+        const mixxx::Duration now = m_clock.elapsed();
+        if (!m_flushing && now < m_jobs[index].due) {
+            m_jobsChanged.wait(&m_mutex, static_cast<unsigned long>(
+                    (m_jobs[index].due - now).toIntegerMillis() + 1));
+            continue;
+        }
+        Job job = m_jobs.takeAt(index);
+        const bool flushing = m_flushing;
+        m_exporting = true;
+        locker.unlock();
+
+        const ExportResult result = exportJob(job, flushing);
+
+        locker.relock();
+        m_exporting = false;
+        bool retry = false;
+        switch (result) {
+        case ExportResult::Exported:
+            s_exportedCounter.increment();
+            if (job.trackId.isValid()) {
+                m_exportedTrackIds.append(job.trackId);
+            }
+            break;
+        case ExportResult::Skipped:
+            break;
+        case ExportResult::InUse:
+            job.due = m_clock.elapsed() + kInUseRetryDelay;
+            retry = true;
+            break;
+        case ExportResult::Failed:
+            s_failedCounter.increment();
+            ++job.failedAttempts;
+            if (flushing || job.failedAttempts >= kMaxFailedAttempts) {
+                kLogger.warning()
+                        << "Giving up exporting track metadata into file"
+                        << job.location
+                        << "after" << job.failedAttempts << "attempts";
+                break;
+            }
+            job.due = m_clock.elapsed() +
+                    kFailedRetryDelay * (1 << (job.failedAttempts - 1));
+            retry = true;
+            break;
+        }
+        // A newer export of the same file that has been enqueued meanwhile
+        // replaces the retry
+        if (retry && indexOfLocation(job.location) < 0) {
+            m_jobs.append(job);
+        }
+        if (result == ExportResult::Exported) {
+            locker.unlock();
+            emit(exported());
+            locker.relock();
+        }
+    }
+    m_idle.wakeAll();
+}
+
+TrackMetadataExportQueue::ExportResult TrackMetadataExportQueue::exportJob(
+        const Job& job, bool ignoreInUse) const {
+    if (!ignoreInUse && job.trackId.isValid() && m_isTrackInUse &&
+            m_isTrackInUse(job.trackId)) {
+        return ExportResult::InUse;
+    }
+    mixxx::MetadataSourcePointer pMetadataSource =
+            SoundSourceProxy::openMetadataSource(job.location);
+    if (!pMetadataSource) {
+        kLogger.warning()
+                << "Unable to export track metadata into file"
+                << job.location;
+        return ExportResult::Failed;
+    }
+    switch (Track::exportMetadata(job.snapshot, pMetadataSource, job.location)) {
+    case Track::ExportMetadataResult::Succeeded:
+        return ExportResult::Exported;
+    case Track::ExportMetadataResult::Skipped:
+        return ExportResult::Skipped;
+    case Track::ExportMetadataResult::Failed:
+        break;
+    }
+    return ExportResult::Failed;
+}
@@ -0,0 +1,97 @@
+#ifndef LIBRARY_TRACKMETADATAEXPORTQUEUE_H
+#define LIBRARY_TRACKMETADATAEXPORTQUEUE_H
+
+#include <functional>
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "track/track.h"
+#include "track/trackid.h"
+#include "util/class.h"
+#include "util/duration.h"
+#include "util/performancetimer.h"
+#include "util/sandbox.h"
+
+// Exports the metadata of saved tracks into their file tags in its own
+// thread, so saving a track neither blocks the thread that has released it
+// nor the track cache while a slow or network file is rewritten.
+//
+// The export of a file is delayed for a short time and merged with the
+// exports that follow for the same file, e.g. while several properties of a
+// track are edited one after another. A file is not written while its track
+// is in use, e.g. loaded into a deck, and an export that fails because the
+// file is locked is retried a few times with growing delays.
+//
+// The tracks whose file tags have been written are reported by exported().
+// The flag that the metadata is synchronized with the file must then be
+// stored again, because the track has been saved before the export.
+class TrackMetadataExportQueue : public QThread {
+    Q_OBJECT
+  public:
+    // Returns true if the track must not be written now
+    typedef std::function<bool(TrackId)> TrackInUsePredicate;
+
+    explicit TrackMetadataExportQueue(const TrackInUsePredicate& isTrackInUse);
+    // The exports that are still pending are dropped, see flush()
+    ~TrackMetadataExportQueue() override;
+
+    // Takes the metadata of a track that is saved. The track object may be
+    // deleted afterwards.
+    void enqueue(Track* pTrack);
+
+    // Exports all pending tracks now, even those that are in use, and
+    // returns when done. Exports that fail are not retried.
+    void flush();
+
+    // The ids of the tracks whose metadata has been exported since the
+    // last call
+    QList<TrackId> takeExportedTrackIds();
+
+  signals:
+    // Emitted from the export thread
+    void exported();
+
+  private:
+    struct Job {
+        TrackId trackId;
+        QString location;
+        // Keeps the file accessible in a sandbox after the track object has
+        // been deleted
+        SecurityTokenPointer pSecurityToken;
+        Track::MetadataExportSnapshot snapshot;
+        mixxx::Duration due;
+        int failedAttempts = 0;
+    };
+
+    enum class ExportResult {
+        Exported,
+        Skipped,
+        InUse,
+        Failed,
+    };
+
+    void run() override;
+    ExportResult exportJob(const Job& job, bool ignoreInUse) const;
+    int indexOfLocation(const QString& location) const;
+    int indexOfNextJob() const;
+
+    const TrackInUsePredicate m_isTrackInUse;
+
+    QMutex m_mutex;
+    QWaitCondition m_jobsChanged;
+    QWaitCondition m_idle;
+    PerformanceTimer m_clock;
+    QList<Job> m_jobs;
+    QList<TrackId> m_exportedTrackIds;
+    bool m_exporting;
+    bool m_flushing;
+    bool m_stop;
+
+    DISALLOW_COPY_AND_ASSIGN(TrackMetadataExportQueue);
+};
+
+#endif // LIBRARY_TRACKMETADATAEXPORTQUEUE_H
@@ -0,0 +1,196 @@
+#include "library/tracksearchindex.h"
+
+#include <QDataStream>
+
+#include <algorithm>
+
+#include "util/db/dbconnection.h"
+
+namespace {
+
+// Documents that are not current are kept until there are this many
+const int kMinStaleDocuments = 1024;
+
+// Intersects the sorted list with a sorted list that is usually longer
+void intersect(QVector<int>* pResult, const QVector<int>& other) {
+    auto out = pResult->begin();
+    auto it = other.constBegin();
+    for (auto in = pResult->constBegin(); in != pResult->constEnd(); ++in) {
+        it = std::lower_bound(it, other.constEnd(), *in);
+        if (it == other.constEnd()) {
+            break;
+        }
+        if (*it == *in) {
+            *out++ = *in;
+        }
+    }
+    pResult->resize(static_cast<int>(out - pResult->begin()));
+}
+
+} // anonymous namespace
+
+TrackSearchIndex::TrackSearchIndex() {
+}
+
+void TrackSearchIndex::clear() {
+    m_documentTracks.clear();
+    m_documents.clear();
+    m_postings.clear();
+}
+
+// static
+void TrackSearchIndex::addTrigrams(const QString& foldedText,
+        QVector<Trigram>* pTrigrams) {
+    const ushort* pChars = foldedText.utf16();
+    for (int i = 0; i + kMinTermLength <= foldedText.size(); ++i) {
+        pTrigrams->append(Trigram(pChars[i]) |
+                (Trigram(pChars[i + 1]) << 16) |
+                (Trigram(pChars[i + 2]) << 32));
+    }
+}
+
+void TrackSearchIndex::update(TrackId trackId, const QStringList& values) {
+    remove(trackId);
+
+    // The trigrams must not span two values
+    QVector<Trigram> trigrams;
+    for (const auto& value : values) {
+        addTrigrams(mixxx::DbConnection::toLatinLow(value), &trigrams);
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    const int document = m_documentTracks.size();
+    m_documentTracks.append(trackId);
+    m_documents.insert(trackId, document);
+    for (Trigram trigram : trigrams) {
+        m_postings[trigram].append(document);
+    }
+}
+
+void TrackSearchIndex::remove(TrackId trackId) {
+    auto it = m_documents.find(trackId);
+    if (it == m_documents.end()) {
+        return;
+    }
+    m_documentTracks[it.value()] = TrackId();
+    m_documents.erase(it);
+    const int staleDocuments = m_documentTracks.size() - m_documents.size();
+    if (staleDocuments >= kMinStaleDocuments &&
+            staleDocuments > m_documents.size()) {
+        compact();
+    }
+}
+
+void TrackSearchIndex::compact() {
+    // Renumbers the current documents in their order
+    QVector<int> newDocuments(m_documentTracks.size(), -1);
+    QVector<TrackId> documentTracks;
+    documentTracks.reserve(m_documents.size());
+    for (int document = 0; document < m_documentTracks.size(); ++document) {
+        const TrackId trackId = m_documentTracks[document];
+        if (trackId.isValid()) {
+            newDocuments[document] = documentTracks.size();
+            m_documents[trackId] = documentTracks.size();
+            documentTracks.append(trackId);
+        }
+    }
+    m_documentTracks.swap(documentTracks);
+
+    auto it = m_postings.begin();
+    while (it != m_postings.end()) {
+        PostingList& postings = it.value();
+        int count = 0;
+        for (int document : postings) {
+            const int newDocument = newDocuments[document];
+            if (newDocument >= 0) {
+                postings[count++] = newDocument;
+            }
+        }
+        if (count > 0) {
+            postings.resize(count);
+            postings.squeeze();
+            ++it;
+        } else {
+            it = m_postings.erase(it);
+        }
+    }
+}
+
+QVector<TrackId> TrackSearchIndex::findCandidates(const QString& foldedTerm) const {
+    QVector<TrackId> trackIds;
+    QVector<Trigram> trigrams;
+    addTrigrams(foldedTerm, &trigrams);
+    if (trigrams.isEmpty()) {
+        return trackIds;
+    }
+
+    // Starts with the shortest posting list
+    QVector<const PostingList*> postingLists;
+    for (Trigram trigram : trigrams) {
+        auto it = m_postings.constFind(trigram);
+        if (it == m_postings.constEnd()) {
+            return trackIds;
+        }
+        postingLists.append(&it.value());
+    }
+    std::sort(postingLists.begin(), postingLists.end(),
+            [](const PostingList* pLhs, const PostingList* pRhs) {
+                return pLhs->size() < pRhs->size();
+            });
+    QVector<int> documents = *postingLists.first();
+    for (int i = 1; i < postingLists.size() && !documents.isEmpty(); ++i) {
+        intersect(&documents, *postingLists[i]);
+    }
+
+    trackIds.reserve(documents.size());
+    for (int document : documents) {
+        const TrackId trackId = m_documentTracks[document];
+        if (trackId.isValid()) {
+            trackIds.append(trackId);
+        }
+    }
+    return trackIds;
+}
+
+void TrackSearchIndex::write(QDataStream* pStream) const {
+    *pStream << static_cast<qint32>(m_documentTracks.size());
+    for (const auto& trackId : m_documentTracks) {
+        *pStream << static_cast<qint32>(trackId.toInt());
+    }
+    *pStream << m_postings;
+}
+
+bool TrackSearchIndex::read(QDataStream* pStream) {
+    clear();
+    qint32 documentCount = 0;
+    *pStream >> documentCount;
+    bool valid = pStream->status() == QDataStream::Ok && documentCount >= 0;
+    for (qint32 document = 0; valid && document < documentCount; ++document) {
+        qint32 value = 0;
+        *pStream >> value;
+        valid = pStream->status() == QDataStream::Ok;
+        const TrackId trackId(value);
+        m_documentTracks.append(trackId);
+        if (trackId.isValid()) {
+            m_documents.insert(trackId, document);
+        }
+    }
+    if (valid) {
+        *pStream >> m_postings;
+        valid = pStream->status() == QDataStream::Ok;
+    }
+    // The documents are used as indexes into m_documentTracks
+    for (auto it = m_postings.constBegin(); valid && it != m_postings.constEnd(); ++it) {
+        for (int document : it.value()) {
+            if (document < 0 || document >= documentCount) {
+                valid = false;
+                break;
+            }
+        }
+    }
+    if (!valid) {
+        clear();
+    }
+    return valid;
+}
@@ -0,0 +1,65 @@
+#ifndef LIBRARY_TRACKSEARCHINDEX_H
+#define LIBRARY_TRACKSEARCHINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "track/trackid.h"
+
+class QDataStream;
+
+// An inverted index from the trigrams of the searchable text of the tracks
+// to the tracks that contain them. The text is folded like the LIKE
+// operator does it, see mixxx::DbConnection::toLatinLow().
+//
+// The index only returns candidates: a track that contains all trigrams of
+// a term does not necessarily contain the term itself.
+//
+// Each update of a track appends a new document, so the posting lists stay
+// sorted without moving their entries. The documents of updated and
+// removed tracks are dropped from the posting lists once there are more
+// of them than of the current documents.
+class TrackSearchIndex {
+  public:
+    // Terms that are shorter have no trigrams
+    static const int kMinTermLength = 3;
+
+    TrackSearchIndex();
+
+    void clear();
+
+    int size() const {
+        return m_documents.size();
+    }
+
+    // Replaces the text of the track
+    void update(TrackId trackId, const QStringList& values);
+    void remove(TrackId trackId);
+
+    // Returns the tracks whose text contains all trigrams of the folded
+    // term, sorted by the time they were updated. The term must have at
+    // least kMinTermLength characters.
+    QVector<TrackId> findCandidates(const QString& foldedTerm) const;
+
+    void write(QDataStream* pStream) const;
+    // Returns false and leaves the index cleared if the stream is invalid
+    bool read(QDataStream* pStream);
+
+  private:
+    typedef quint64 Trigram;
+    typedef QVector<int> PostingList;
+
+    static void addTrigrams(const QString& foldedText, QVector<Trigram>* pTrigrams);
+    void compact();
+
+    // The track of each document or an invalid id if the document is not
+    // current
+    QVector<TrackId> m_documentTracks;
+    // The current document of each track
+    QHash<TrackId, int> m_documents;
+    QHash<Trigram, PostingList> m_postings;
+};
+
+#endif // LIBRARY_TRACKSEARCHINDEX_H
@@ -0,0 +1,135 @@
+#include "library/tracksortindex.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("TrackSortIndex");
+
+// Must be changed whenever the layout of the file changes
+const quint32 kMagic = 0x4d585349; // "MXSI"
+const quint32 kFormatVersion = 1;
+
+} // anonymous namespace
+
+TrackSortIndex::TrackSortIndex(const QString& columnName)
+        : m_columnName(columnName),
+          m_bVerified(false) {
+}
+
+void TrackSortIndex::invalidateAll() {
+    // The current order is kept as the hint for sorting again
+    m_bVerified = false;
+    m_staleTrackIds.clear();
+}
+
+QVector<TrackId> TrackSortIndex::select(const QSet<TrackId>& trackIds,
+        Qt::SortOrder order) const {
+    QVector<TrackId> selected;
+    selected.reserve(trackIds.size());
+    if (order == Qt::AscendingOrder) {
+        for (auto it = m_trackIds.constBegin(); it != m_trackIds.constEnd(); ++it) {
+            if (trackIds.contains(*it)) {
+                selected.append(*it);
+            }
+        }
+    } else {
+        for (auto it = m_trackIds.crbegin(); it != m_trackIds.crend(); ++it) {
+            if (trackIds.contains(*it)) {
+                selected.append(*it);
+            }
+        }
+    }
+    if (selected.size() < trackIds.size()) {
+        QSet<TrackId> missingTrackIds = trackIds;
+        for (const auto& trackId : selected) {
+            missingTrackIds.remove(trackId);
+        }
+        for (const auto& trackId : missingTrackIds) {
+            selected.append(trackId);
+        }
+    }
+    return selected;
+}
+
+void TrackSortIndex::write(QDataStream* pStream) const {
+    *pStream << m_columnName << static_cast<qint32>(m_trackIds.size());
+    for (const auto& trackId : m_trackIds) {
+        *pStream << static_cast<qint32>(trackId.toInt());
+    }
+}
+
+bool TrackSortIndex::read(QDataStream* pStream) {
+    qint32 size = 0;
+    *pStream >> m_columnName >> size;
+    if (pStream->status() != QDataStream::Ok || size < 0) {
+        return false;
+    }
+    m_trackIds.clear();
+    for (qint32 i = 0; i < size && pStream->status() == QDataStream::Ok; ++i) {
+        qint32 value = 0;
+        *pStream >> value;
+        // Unknown tracks are dropped when the order is verified
+        if (value >= 0) {
+            m_trackIds.append(TrackId(value));
+        }
+    }
+    invalidateAll();
+    return pStream->status() == QDataStream::Ok;
+}
+
+// static
+QList<TrackSortIndex> TrackSortIndex::readFile(const QString& filePath) {
+    QList<TrackSortIndex> indexes;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return indexes;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint32 formatVersion = 0;
+    qint32 count = 0;
+    in >> magic >> formatVersion >> count;
+    if (magic != kMagic || formatVersion != kFormatVersion) {
+        kLogger.warning() << "Invalid sort index file" << filePath;
+        return indexes;
+    }
+    for (qint32 i = 0; i < count; ++i) {
+        TrackSortIndex index;
+        if (!index.read(&in)) {
+            kLogger.warning() << "Failed to read" << filePath;
+            return QList<TrackSortIndex>();
+        }
+        indexes.append(index);
+    }
+    return indexes;
+}
+
+// static
+bool TrackSortIndex::writeFile(const QString& filePath,
+        const QList<TrackSortIndex>& indexes) {
+    // Written to a temporary file that replaces the old one on commit
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        kLogger.warning() << "Failed to write" << filePath
+                << file.errorString();
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << kMagic << kFormatVersion << static_cast<qint32>(indexes.size());
+    for (const auto& index : indexes) {
+        index.write(&out);
+    }
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        kLogger.warning() << "Failed to write" << filePath
+                << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,174 @@
+#ifndef LIBRARY_TRACKSORTINDEX_H
+#define LIBRARY_TRACKSORTINDEX_H
+
+#include <algorithm>
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+#include "track/trackid.h"
+
+class QDataStream;
+
+// The tracks of a cache in the ascending order of the values of one of its
+// columns. A sort by this column only needs to pick the matching tracks
+// from the order instead of sorting them.
+//
+// The tracks that are added, changed or removed are merged into the order
+// the next time it is updated. The order that is read from a file is only
+// a hint: it is verified against the tracks of the cache and sorted again
+// if it does not match them.
+class TrackSortIndex {
+  public:
+    explicit TrackSortIndex(const QString& columnName = QString());
+
+    const QString& columnName() const {
+        return m_columnName;
+    }
+
+    // The track has been added, changed or removed
+    void invalidate(TrackId trackId) {
+        if (m_bVerified) {
+            m_staleTrackIds.insert(trackId);
+        }
+    }
+    // The values of all tracks might have changed
+    void invalidateAll();
+
+    // Brings the order up to date with the rows of the cache. The
+    // comparison returns a negative, zero or positive value for two rows.
+    template<typename Compare>
+    void update(const QHash<TrackId, int>& rows, Compare compare);
+
+    const QVector<TrackId>& sortedTrackIds() const {
+        return m_trackIds;
+    }
+
+    // Returns the tracks of the set in the order of the index. Tracks that
+    // are not indexed follow in no particular order.
+    QVector<TrackId> select(const QSet<TrackId>& trackIds,
+            Qt::SortOrder order) const;
+
+    static QList<TrackSortIndex> readFile(const QString& filePath);
+    static bool writeFile(const QString& filePath,
+            const QList<TrackSortIndex>& indexes);
+
+  private:
+    typedef QPair<int, TrackId> Entry; // row and track
+
+    template<typename Compare>
+    void sortAll(const QHash<TrackId, int>& rows, Compare compare);
+    template<typename Compare>
+    void mergeStale(const QHash<TrackId, int>& rows, Compare compare);
+
+    void write(QDataStream* pStream) const;
+    bool read(QDataStream* pStream);
+
+    QString m_columnName;
+    QVector<TrackId> m_trackIds;
+    // Whether m_trackIds has been verified against the cache since it has
+    // been read or all tracks have been invalidated
+    bool m_bVerified;
+    QSet<TrackId> m_staleTrackIds;
+};
+
+template<typename Compare>
+void TrackSortIndex::update(const QHash<TrackId, int>& rows, Compare compare) {
+    // Merging needs a pass over all tracks anyway, so many changes are
+    // cheaper to sort again from the order they are in
+    if (!m_bVerified || m_staleTrackIds.size() > rows.size() / 8) {
+        sortAll(rows, compare);
+    } else if (!m_staleTrackIds.isEmpty()) {
+        mergeStale(rows, compare);
+    }
+}
+
+template<typename Compare>
+void TrackSortIndex::sortAll(const QHash<TrackId, int>& rows, Compare compare) {
+    QVector<Entry> entries;
+    entries.reserve(rows.size());
+    QSet<TrackId> indexedTrackIds;
+    indexedTrackIds.reserve(rows.size());
+    bool sorted = m_staleTrackIds.isEmpty();
+    for (const auto& trackId : m_trackIds) {
+        auto it = rows.constFind(trackId);
+        if (it == rows.constEnd() || indexedTrackIds.contains(trackId)) {
+            sorted = false;
+            continue;
+        }
+        indexedTrackIds.insert(trackId);
+        if (sorted && !entries.isEmpty() &&
+                compare(entries.last().first, it.value()) > 0) {
+            sorted = false;
+        }
+        entries.append(Entry(it.value(), trackId));
+    }
+    if (entries.size() < rows.size()) {
+        sorted = false;
+        for (auto it = rows.constBegin(); it != rows.constEnd(); ++it) {
+            if (!indexedTrackIds.contains(it.key())) {
+                entries.append(Entry(it.value(), it.key()));
+            }
+        }
+    }
+    if (!sorted) {
+        std::stable_sort(entries.begin(), entries.end(),
+                [&compare](const Entry& lhs, const Entry& rhs) {
+                    return compare(lhs.first, rhs.first) < 0;
+                });
+    }
+
+    m_trackIds.resize(entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        m_trackIds[i] = entries[i].second;
+    }
+    m_bVerified = true;
+    m_staleTrackIds.clear();
+}
+
+template<typename Compare>
+void TrackSortIndex::mergeStale(const QHash<TrackId, int>& rows, Compare compare) {
+    // The stale tracks that still exist are sorted and merged into the
+    // order of the others
+    QVector<Entry> insertions;
+    for (const auto& trackId : m_staleTrackIds) {
+        auto it = rows.constFind(trackId);
+        if (it != rows.constEnd()) {
+            insertions.append(Entry(it.value(), trackId));
+        }
+    }
+    std::stable_sort(insertions.begin(), insertions.end(),
+            [&compare](const Entry& lhs, const Entry& rhs) {
+                return compare(lhs.first, rhs.first) < 0;
+            });
+
+    QVector<TrackId> trackIds;
+    trackIds.reserve(rows.size());
+    auto insertion = insertions.constBegin();
+    for (const auto& trackId : m_trackIds) {
+        if (m_staleTrackIds.contains(trackId)) {
+            continue;
+        }
+        const int row = rows.value(trackId, -1);
+        if (row < 0) {
+            continue;
+        }
+        while (insertion != insertions.constEnd() &&
+                compare(insertion->first, row) < 0) {
+            trackIds.append(insertion->second);
+            ++insertion;
+        }
+        trackIds.append(trackId);
+    }
+    for (; insertion != insertions.constEnd(); ++insertion) {
+        trackIds.append(insertion->second);
+    }
+    m_trackIds.swap(trackIds);
+    m_staleTrackIds.clear();
+}
+
+#endif // LIBRARY_TRACKSORTINDEX_H
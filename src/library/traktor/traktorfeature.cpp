@@ -17,6 +17,16 @@
 #include "library/treeitem.h"
 #include "util/sandbox.h"
 
+namespace {
+
+const QString kImportStateKey = "mixxx.traktorfeature.importstate";
+
+// Separates the names of the folders and the playlist in the path of a
+// playlist
+const QString kPlaylistPathDelimiter = "-->";
+
+} // anonymous namespace
+
 TraktorTrackModel::TraktorTrackModel(QObject* parent,
                                      TrackCollection* pTrackCollection,
                                      QSharedPointer<BaseTrackCache> trackSource)
@@ -139,17 +149,9 @@ void TraktorFeature::activate() {
 
     if (!m_isActivated) {
         m_isActivated =  true;
-        // Ususally the maximum number of threads
-        // is > 2 depending on the CPU cores
-        // Unfortunately, within VirtualBox
-        // the maximum number of allowed threads
-        // is 1 at all times We'll need to increase
-        // the number to > 1, otherwise importing the music collection
-        // takes place when the GUI threads terminates, i.e., on
-        // Mixxx shutdown.
-        QThreadPool::globalInstance()->setMaxThreadCount(4); //Tobias decided to use 4
         // Let a worker thread do the XML parsing
-        m_future = QtConcurrent::run(this, &TraktorFeature::importLibrary,
+        m_future = QtConcurrent::run(&m_importThreadPool,
+                                     this, &TraktorFeature::importLibrary,
                                      getTraktorMusicDatabase());
         m_future_watcher.setFuture(m_future);
         m_title = tr("(loading) Traktor");
@@ -182,8 +184,17 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
     thisThread->setPriority(QThread::LowPriority);
     //Invisible root item of Traktor's child model
     TreeItem* root = NULL;
+
+    // The tables are still in sync with an unchanged collection
+    const QString importState = importStateOfFile(file);
+    if (isImportUpToDate(m_database, kImportStateKey, importState)) {
+        qDebug() << "Traktor music collection is unchanged";
+        return loadPlaylists();
+    }
+
     //Delete all table entries of Traktor feature
     ScopedTransaction transaction(m_database);
+    setImportState(m_database, kImportStateKey, QString());
     clearTable("traktor_playlist_tracks");
     clearTable("traktor_library");
     clearTable("traktor_playlists");
@@ -211,6 +222,7 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
 
     while (!xml.atEnd() && !m_cancelImport) {
         xml.readNext();
+        reportImportProgress(xml);
         if (xml.isStartElement()) {
             if (xml.name() == "COLLECTION") {
                 inCollectionTag = true;
@@ -253,6 +265,9 @@ TreeItem* TraktorFeature::importLibrary(QString file) {
     }
 
     qDebug() << "Found: " << nAudioFiles << " audio files in Traktor";
+    if (!m_cancelImport) {
+        setImportState(m_database, kImportStateKey, importState);
+    }
     //initialize TraktorTableModel
     transaction.commit();
 
@@ -380,7 +395,7 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
     QString current_path = "";
     QMap<QString,QString> map;
 
-    QString delimiter = "-->";
+    const QString& delimiter = kPlaylistPathDelimiter;
 
     TreeItem *rootItem = new TreeItem(this);
     TreeItem * parent = rootItem;
@@ -397,6 +412,7 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
     while (!xml.atEnd() && !m_cancelImport) {
         //read next XML element
         xml.readNext();
+        reportImportProgress(xml);
 
         if (xml.isStartElement()) {
             if (xml.name() == "NODE") {
@@ -447,6 +463,41 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
     return rootItem;
 }
 
+TreeItem* TraktorFeature::loadPlaylists() {
+    TreeItem* rootItem = new TreeItem(this);
+    // The folders are not stored, but they are the parents of the
+    // playlists, which are stored in the order of the collection
+    QSqlQuery query(m_database);
+    query.prepare("SELECT name FROM traktor_playlists ORDER BY id");
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        delete rootItem;
+        return NULL;
+    }
+    QHash<QString, TreeItem*> folders;
+    while (query.next()) {
+        const QString path = query.value(0).toString();
+        const QStringList names = path.split(
+                kPlaylistPathDelimiter, QString::SkipEmptyParts);
+        if (names.isEmpty()) {
+            continue;
+        }
+        TreeItem* parent = rootItem;
+        QString folderPath;
+        for (int i = 0; i < names.size() - 1; ++i) {
+            folderPath += kPlaylistPathDelimiter;
+            folderPath += names[i];
+            TreeItem*& folder = folders[folderPath];
+            if (!folder) {
+                folder = parent->appendChild(names[i], folderPath);
+            }
+            parent = folder;
+        }
+        parent->appendChild(names.last(), path);
+    }
+    return rootItem;
+}
+
 void TraktorFeature::parsePlaylistEntries(
     QXmlStreamReader &xml,
     QString playlist_path,
@@ -597,6 +648,11 @@ QString TraktorFeature::getTraktorMusicDatabase() {
     return musicFolder;
 }
 
+void TraktorFeature::onImportProgress(int percent) {
+    m_title = tr("(loading %1%) Traktor").arg(percent);
+    emit(featureIsLoading(this, false));
+}
+
 void TraktorFeature::onTrackCollectionLoaded() {
     std::unique_ptr<TreeItem> root(m_future.result());
     if (root) {
@@ -53,6 +53,9 @@ class TraktorFeature : public BaseExternalLibraryFeature {
     void refreshLibraryModels();
     void onTrackCollectionLoaded();
 
+  protected:
+    void onImportProgress(int percent) override;
+
   private:
     virtual BaseSqlTableModel* getPlaylistModelForPlaylist(QString playlist);
     TreeItem* importLibrary(QString file);
@@ -60,6 +63,8 @@ class TraktorFeature : public BaseExternalLibraryFeature {
     void parseTrack(QXmlStreamReader &xml, QSqlQuery &query);
     // Iterates over all playliost and folders and constructs the childmodel
     TreeItem* parsePlaylists(QXmlStreamReader &xml);
+    // Constructs the childmodel from the playlists of a previous import
+    TreeItem* loadPlaylists();
     // processes a particular playlist
     void parsePlaylistEntries(QXmlStreamReader &xml, QString playlist_path,
     QSqlQuery query_insert_into_playlist, QSqlQuery query_insert_into_playlisttracks);
@@ -25,6 +25,8 @@
 
 #include "mixxx.h"
 #include "mixxxapplication.h"
+#include "analyzer/analyzerbatch.h"
+#include "preferences/settingsmanager.h"
 #include "sources/soundsourceproxy.h"
 #include "errordialoghandler.h"
 #include "util/cmdlineargs.h"
@@ -55,6 +57,15 @@ int runMixxx(MixxxApplication* app, const CmdlineArgs& args) {
     return result;
 }
 
+int runBatchAnalysis(const CmdlineArgs& args) {
+    SettingsManager settingsManager(nullptr, args.getSettingsPath());
+    AnalyzerBatch batch(
+            settingsManager.settings(),
+            args.getAnalyzeMode(),
+            args.getAnalyzePath());
+    return batch.run();
+}
+
 } // anonymous namespace
 
 int main(int argc, char * argv[]) {
@@ -90,6 +101,13 @@ int main(int argc, char * argv[]) {
     mixxx::Logging::initialize(args.getSettingsPath(),
                                args.getLogLevel(), args.getDebugAssertBreak());
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    // The batch analysis opens no windows and works without a display
+    if (args.getAnalyzeEnabled() && qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+#endif
+
     MixxxApplication app(argc, argv);
 
     // Support utf-8 for all translation strings. Not supported in Qt 5.
@@ -99,8 +117,10 @@ int main(int argc, char * argv[]) {
     QTextCodec::setCodecForTr(QTextCodec::codecForName("UTF-8"));
 #endif
 
-    // Enumerate and load SoundSource plugins
-    SoundSourceProxy::loadPlugins();
+    // Enumerate and load SoundSource plugins, the plugins that are known
+    // from the last run are only loaded when needed
+    SoundSourceProxy::loadPlugins(
+            QDir(args.getSettingsPath()).filePath("soundsourceplugins.cache"));
 
 #ifdef __APPLE__
     QDir dir(QApplication::applicationDirPath());
@@ -119,10 +139,15 @@ int main(int argc, char * argv[]) {
     }
 #endif
 
-    // When the last window is closed, terminate the Qt event loop.
-    QObject::connect(&app, SIGNAL(lastWindowClosed()), &app, SLOT(quit()));
+    int result;
+    if (args.getAnalyzeEnabled()) {
+        result = runBatchAnalysis(args);
+    } else {
+        // When the last window is closed, terminate the Qt event loop.
+        QObject::connect(&app, SIGNAL(lastWindowClosed()), &app, SLOT(quit()));
 
-    int result = runMixxx(&app, args);
+        result = runMixxx(&app, args);
+    }
 
     qDebug() << "Mixxx shutdown complete with code" << result;
 
@@ -102,6 +102,10 @@ BaseTrackPlayerImpl::BaseTrackPlayerImpl(QObject* pParent,
         ConfigKey(group, "end_of_track"));
     m_pEndOfTrack->set(0.);
 
+    m_pPreload = std::make_unique<ControlPushButton>(
+            ConfigKey(getGroup(), "preload"), true);
+    m_pPreload->setButtonMode(ControlPushButton::TOGGLE);
+
     m_pPreGain = std::make_unique<ControlProxy>(group, "pregain", this);
     // BPM of the current song
     m_pBPM = std::make_unique<ControlProxy>(group, "file_bpm", this);
@@ -257,6 +261,15 @@ void BaseTrackPlayerImpl::slotLoadTrack(TrackPointer pNewTrack, bool bPlay) {
 
     loadTrack(pNewTrack);
 
+    if (pNewTrack) {
+        // Beats that have been loaded from the library are decoded here
+        // instead of by the first lookup in the engine
+        BeatsPointer pBeats = pNewTrack->getBeats();
+        if (pBeats) {
+            pBeats->prepareCalculations();
+        }
+    }
+
     // Request a new track from EngineBuffer
     EngineBuffer* pEngineBuffer = m_pChannel->getEngineBuffer();
     pEngineBuffer->loadTrack(pNewTrack, bPlay);
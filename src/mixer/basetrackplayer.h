@@ -111,6 +111,8 @@ class BaseTrackPlayerImpl : public BaseTrackPlayer {
     std::unique_ptr<ControlProxy> m_pLoopOutPoint;
     std::unique_ptr<ControlObject> m_pDuration;
     std::unique_ptr<ControlObject> m_pEndOfTrack;
+    // Decode whole tracks into memory after loading, see CachingReader
+    std::unique_ptr<ControlPushButton> m_pPreload;
 
     // TODO() these COs are reconnected during runtime
     // This may lock the engine
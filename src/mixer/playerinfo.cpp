@@ -27,13 +27,16 @@ static const int kPlayingDeckUpdateIntervalMillis = 2000;
 static PlayerInfo* m_pPlayerInfo = NULL;
 
 PlayerInfo::PlayerInfo()
-        : m_pCOxfader(new ControlProxy("[Master]","crossfader", this)),
+        : m_mutex("PlayerInfo"),
+          m_pCOxfader(new ControlProxy("[Master]","crossfader", this)),
+          m_pLoadedTracks(std::make_shared<const LoadedTracks>()),
           m_currentlyPlayingDeck(-1) {
     startTimer(kPlayingDeckUpdateIntervalMillis);
 }
 
 PlayerInfo::~PlayerInfo() {
-    m_loadedTrackMap.clear();
+    std::atomic_store(&m_pLoadedTracks,
+            LoadedTracksPointer(std::make_shared<const LoadedTracks>()));
     clearControlCache();
 }
 
@@ -50,17 +53,38 @@ void PlayerInfo::destroy() {
     delete m_pPlayerInfo;
 }
 
+PlayerInfo::LoadedTracksPointer PlayerInfo::getLoadedTracksSnapshot() const {
+    return std::atomic_load(&m_pLoadedTracks);
+}
+
 TrackPointer PlayerInfo::getTrackInfo(const QString& group) {
-    QMutexLocker locker(&m_mutex);
-    return m_loadedTrackMap.value(group);
+    return getLoadedTracksSnapshot()->track(group);
 }
 
 void PlayerInfo::setTrackInfo(const QString& group, const TrackPointer& track) {
     TrackPointer pOld;
     { // Scope
-        QMutexLocker locker(&m_mutex);
-        pOld = m_loadedTrackMap.value(group);
-        m_loadedTrackMap.insert(group, track);
+        MMutexLocker locker(&m_mutex);
+        const LoadedTracksPointer pPrevious = getLoadedTracksSnapshot();
+        pOld = pPrevious->track(group);
+
+        // The sets are rebuilt from scratch, because several players may
+        // have loaded the same track
+        auto pLoadedTracks = std::make_shared<LoadedTracks>();
+        pLoadedTracks->m_tracksByGroup = pPrevious->m_tracksByGroup;
+        pLoadedTracks->m_tracksByGroup.insert(group, track);
+        for (const auto& pTrack : pLoadedTracks->m_tracksByGroup) {
+            if (!pTrack) {
+                continue;
+            }
+            pLoadedTracks->m_tracks.insert(pTrack.get());
+            if (pTrack->getId().isValid()) {
+                pLoadedTracks->m_trackIds.insert(pTrack->getId());
+            }
+            pLoadedTracks->m_locations.insert(pTrack->getLocation());
+        }
+        std::atomic_store(&m_pLoadedTracks,
+                LoadedTracksPointer(std::move(pLoadedTracks)));
     }
     if (pOld) {
         emit(trackUnloaded(group, pOld));
@@ -69,36 +93,19 @@ void PlayerInfo::setTrackInfo(const QString& group, const TrackPointer& track) {
 }
 
 bool PlayerInfo::isTrackLoaded(const TrackPointer& pTrack) const {
-    QMutexLocker locker(&m_mutex);
-    QMapIterator<QString, TrackPointer> it(m_loadedTrackMap);
-    while (it.hasNext()) {
-        it.next();
-        if (it.value() == pTrack) {
-            return true;
-        }
-    }
-    return false;
+    return getLoadedTracksSnapshot()->contains(pTrack);
+}
+
+bool PlayerInfo::isTrackLoaded(TrackId trackId) const {
+    return getLoadedTracksSnapshot()->containsTrackId(trackId);
 }
 
 QMap<QString, TrackPointer> PlayerInfo::getLoadedTracks() {
-    QMutexLocker locker(&m_mutex);
-    QMap<QString, TrackPointer> ret = m_loadedTrackMap;
-    return ret;
+    return getLoadedTracksSnapshot()->tracksByGroup();
 }
 
 bool PlayerInfo::isFileLoaded(const QString& track_location) const {
-    QMutexLocker locker(&m_mutex);
-    QMapIterator<QString, TrackPointer> it(m_loadedTrackMap);
-    while (it.hasNext()) {
-        it.next();
-        TrackPointer pTrack = it.value();
-        if (pTrack) {
-            if (pTrack->getLocation() == track_location) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return getLoadedTracksSnapshot()->containsLocation(track_location);
 }
 
 void PlayerInfo::timerEvent(QTimerEvent* pTimerEvent) {
@@ -107,7 +114,7 @@ void PlayerInfo::timerEvent(QTimerEvent* pTimerEvent) {
 }
 
 void PlayerInfo::updateCurrentPlayingDeck() {
-    QMutexLocker locker(&m_mutex);
+    MMutexLocker locker(&m_mutex);
 
     double maxVolume = 0;
     int maxDeck = -1;
@@ -159,7 +166,7 @@ void PlayerInfo::updateCurrentPlayingDeck() {
 }
 
 int PlayerInfo::getCurrentPlayingDeck() {
-    QMutexLocker locker(&m_mutex);
+    MMutexLocker locker(&m_mutex);
     return m_currentlyPlayingDeck;
 }
 
@@ -20,22 +20,63 @@
 #include <QObject>
 #include <QMutex>
 #include <QMap>
+#include <QSet>
 #include <QTimerEvent>
 
+#include <memory>
+
 #include "control/controlproxy.h"
 #include "track/track.h"
+#include "util/mutex.h"
 
 class PlayerInfo : public QObject {
     Q_OBJECT
   public:
+    // An immutable snapshot of the tracks that are loaded into the players.
+    // A new snapshot replaces the previous one whenever a track is loaded or
+    // unloaded, so a snapshot that has been taken stays consistent and can
+    // be queried for many tracks, e.g. while painting the rows of a table.
+    class LoadedTracks {
+      public:
+        const QMap<QString, TrackPointer>& tracksByGroup() const {
+            return m_tracksByGroup;
+        }
+        TrackPointer track(const QString& group) const {
+            return m_tracksByGroup.value(group);
+        }
+        bool contains(const TrackPointer& pTrack) const {
+            return pTrack && m_tracks.contains(pTrack.get());
+        }
+        bool containsTrackId(TrackId trackId) const {
+            return trackId.isValid() && m_trackIds.contains(trackId);
+        }
+        bool containsLocation(const QString& location) const {
+            return m_locations.contains(location);
+        }
+
+      private:
+        friend class PlayerInfo;
+
+        // QMap is faster than QHash for small count of elements < 50
+        QMap<QString, TrackPointer> m_tracksByGroup;
+        QSet<const Track*> m_tracks;
+        QSet<TrackId> m_trackIds;
+        QSet<QString> m_locations;
+    };
+    typedef std::shared_ptr<const LoadedTracks> LoadedTracksPointer;
+
     static PlayerInfo& instance();
     static void destroy();
+    // Takes no lock, may be called from any thread
+    LoadedTracksPointer getLoadedTracksSnapshot() const;
+
     TrackPointer getTrackInfo(const QString& group);
     void setTrackInfo(const QString& group, const TrackPointer& trackInfoObj);
     TrackPointer getCurrentPlayingTrack();
     int getCurrentPlayingDeck();
     QMap<QString, TrackPointer> getLoadedTracks();
     bool isTrackLoaded(const TrackPointer& pTrack) const;
+    bool isTrackLoaded(TrackId trackId) const;
     bool isFileLoaded(const QString& track_location) const;
 
   signals:
@@ -68,10 +109,11 @@ class PlayerInfo : public QObject {
     PlayerInfo();
     virtual ~PlayerInfo();
 
-    mutable QMutex m_mutex;
+    mutable MMutex m_mutex;
     ControlProxy* m_pCOxfader;
-    // QMap is faster than QHash for small count of elements < 50
-    QMap<QString, TrackPointer> m_loadedTrackMap;
+    // Only accessed with std::atomic_load() and std::atomic_store(), which
+    // are replaced while holding m_mutex
+    LoadedTracksPointer m_pLoadedTracks;
     int m_currentlyPlayingDeck;
     QList<DeckControls*> m_deckControlList;
 
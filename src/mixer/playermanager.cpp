@@ -128,10 +128,10 @@ void PlayerManager::bindToLibrary(Library* pLibrary) {
                 m_pAnalyzerQueue, SLOT(slotAnalyseTrack(TrackPointer)));
     }
 
-    // Connect the player to the analyzer queue so that loaded tracks are
-    // analysed.
+    // Preview decks request the analysis of a track once it has been
+    // previewed for a moment.
     foreach(PreviewDeck* pPreviewDeck, m_preview_decks) {
-        connect(pPreviewDeck, SIGNAL(newTrackLoaded(TrackPointer)),
+        connect(pPreviewDeck, SIGNAL(analyzeTrack(TrackPointer)),
                 m_pAnalyzerQueue, SLOT(slotAnalyseTrack(TrackPointer)));
     }
 }
@@ -439,7 +439,7 @@ void PlayerManager::addPreviewDeckInner() {
                                                 m_pEffectsManager, orientation,
                                                 group);
     if (m_pAnalyzerQueue) {
-        connect(pPreviewDeck, SIGNAL(newTrackLoaded(TrackPointer)),
+        connect(pPreviewDeck, SIGNAL(analyzeTrack(TrackPointer)),
                 m_pAnalyzerQueue, SLOT(slotAnalyseTrack(TrackPointer)));
     }
 
@@ -1,5 +1,12 @@
 #include "mixer/previewdeck.h"
 
+namespace {
+
+// Tracks that are previewed for a shorter time are skipped while browsing
+const int kAnalysisDelayMillis = 2000;
+
+} // anonymous namespace
+
 PreviewDeck::PreviewDeck(QObject* pParent,
                          UserSettingsPointer pConfig,
                          EngineMaster* pMixingEngine,
@@ -8,7 +15,33 @@ PreviewDeck::PreviewDeck(QObject* pParent,
                          QString group) :
         BaseTrackPlayerImpl(pParent, pConfig, pMixingEngine, pEffectsManager,
                             defaultOrientation, group, false, true) {
+    m_analysisDelay.setSingleShot(true);
+    m_analysisDelay.setInterval(kAnalysisDelayMillis);
+    connect(&m_analysisDelay, SIGNAL(timeout()),
+            this, SLOT(slotAnalysisDelayElapsed()));
+    connect(this, SIGNAL(newTrackLoaded(TrackPointer)),
+            this, SLOT(slotNewTrackLoaded(TrackPointer)));
+    connect(this, SIGNAL(loadingTrack(TrackPointer, TrackPointer)),
+            this, SLOT(slotLoadingTrack(TrackPointer, TrackPointer)));
 }
 
 PreviewDeck::~PreviewDeck() {
 }
+
+void PreviewDeck::slotNewTrackLoaded(TrackPointer pTrack) {
+    Q_UNUSED(pTrack);
+    m_analysisDelay.start();
+}
+
+void PreviewDeck::slotLoadingTrack(TrackPointer pNewTrack, TrackPointer pOldTrack) {
+    Q_UNUSED(pNewTrack);
+    Q_UNUSED(pOldTrack);
+    m_analysisDelay.stop();
+}
+
+void PreviewDeck::slotAnalysisDelayElapsed() {
+    TrackPointer pTrack = getLoadedTrack();
+    if (pTrack) {
+        emit(analyzeTrack(pTrack));
+    }
+}
@@ -1,8 +1,14 @@
 #ifndef MIXER_PREVIEWDECK_H
 #define MIXER_PREVIEWDECK_H
 
+#include <QTimer>
+
 #include "mixer/basetrackplayer.h"
 
+// The deck that auditions tracks from the library. Tracks are often loaded
+// one after another while browsing, so the analysis of a track, which also
+// loads its stored waveform, is only requested once it has been previewed
+// for a moment instead of for every track that is clicked.
 class PreviewDeck : public BaseTrackPlayerImpl {
     Q_OBJECT
   public:
@@ -13,6 +19,19 @@ class PreviewDeck : public BaseTrackPlayerImpl {
                 EngineChannel::ChannelOrientation defaultOrientation,
                 QString group);
     virtual ~PreviewDeck();
+
+  signals:
+    // Emitted when the loaded track has been previewed long enough to be
+    // analyzed
+    void analyzeTrack(TrackPointer pTrack);
+
+  private slots:
+    void slotNewTrackLoaded(TrackPointer pTrack);
+    void slotLoadingTrack(TrackPointer pNewTrack, TrackPointer pOldTrack);
+    void slotAnalysisDelayElapsed();
+
+  private:
+    QTimer m_analysisDelay;
 };
 
 #endif /* MIXER_PREVIEWDECK_H */
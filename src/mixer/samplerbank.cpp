@@ -92,6 +92,8 @@ bool SamplerBank::saveSamplerBankToPath(const QString& samplerBankPath) {
         QDomElement samplerNode = doc.createElement(QString("sampler"));
 
         samplerNode.setAttribute("group", pSampler->getGroup());
+        samplerNode.setAttribute("preload", ControlObject::get(
+                ConfigKey(pSampler->getGroup(), "preload")) > 0.0 ? 1 : 0);
 
         TrackPointer pTrack = pSampler->getLoadedTrack();
         if (pTrack) {
@@ -178,6 +180,10 @@ bool SamplerBank::loadSamplerBankFromPath(const QString& samplerBankPath) {
                         m_pCONumSamplers->set(samplerNum);
                     }
 
+                    // Must be set before loading, the track is preloaded on load
+                    ControlObject::set(ConfigKey(group, "preload"),
+                            e.attribute("preload", "0").toInt() > 0 ? 1.0 : 0.0);
+
                     if (location.isEmpty()) {
                         m_pPlayerManager->slotLoadTrackToPlayer(TrackPointer(), group);
                     } else {
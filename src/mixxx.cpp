@@ -20,10 +20,13 @@
 #include <QDesktopServices>
 #include <QDesktopWidget>
 #include <QFileDialog>
+#include <QFuture>
 #include <QGLWidget>
+#include <QtConcurrentRun>
 #include <QUrl>
 #include <QtDebug>
 
+#include "analyzer/analysiscache.h"
 #include "analyzer/analyzerqueue.h"
 #include "dialog/dlgabout.h"
 #include "preferences/dialog/dlgpreferences.h"
@@ -31,6 +34,7 @@
 #include "preferences/constants.h"
 #include "dialog/dlgdevelopertools.h"
 #include "engine/enginemaster.h"
+#include "engine/engineofflinerenderer.h"
 #include "effects/effectsmanager.h"
 #include "effects/native/nativebackend.h"
 #include "library/coverartcache.h"
@@ -38,25 +42,34 @@
 #include "library/library_preferences.h"
 #include "controllers/controllermanager.h"
 #include "controllers/keyboard/keyboardeventfilter.h"
+#include "mixer/deck.h"
 #include "mixer/playermanager.h"
 #include "recording/recordingmanager.h"
 #include "broadcast/broadcastmanager.h"
 #include "skin/legacyskinparser.h"
 #include "skin/skinloader.h"
 #include "soundio/soundmanager.h"
+#include "sources/mp3seekframecache.h"
 #include "sources/soundsourceproxy.h"
 #include "track/track.h"
 #include "waveform/waveformwidgetfactory.h"
 #include "waveform/sharedglcontext.h"
 #include "database/mixxxdb.h"
 #include "util/debug.h"
+#include "util/eventloopprofiler.h"
+#include "util/flightrecorder.h"
+#include "util/lockprofiler.h"
+#include "util/realtimesafety.h"
 #include "util/statsmanager.h"
 #include "util/timer.h"
 #include "util/time.h"
+#include "util/trace.h"
 #include "util/version.h"
+#include "control/controlcoalescer.h"
 #include "control/controlpushbutton.h"
 #include "util/compatibility.h"
 #include "util/sandbox.h"
+#include "util/startupbenchmark.h"
 #include "mixer/playerinfo.h"
 #include "waveform/guitick.h"
 #include "util/math.h"
@@ -67,8 +80,10 @@
 #include "preferences/settingsmanager.h"
 #include "widget/wmainmenubar.h"
 #include "util/screensaver.h"
+#include "util/threadroles.h"
 #include "util/logger.h"
 #include "util/db/dbconnectionpooled.h"
+#include "util/db/sqlqueryprofiler.h"
 
 #ifdef __VINYLCONTROL__
 #include "vinylcontrol/vinylcontrolmanager.h"
@@ -78,10 +93,25 @@
 #include "preferences/dialog/dlgprefmodplug.h"
 #endif
 
+#ifdef __VAMP__
+#include "analyzer/vamp/vamppluginloader.h"
+#endif
+
 namespace {
 
 const mixxx::Logger kLogger("MixxxMainWindow");
 
+// The number of launchProgress() calls while initializing
+const int kLaunchProgressSteps = 11;
+
+const ConfigKey kLaunchProgressConfigKey("[Config]", "LaunchProgress");
+
+// The decks that --startupBenchmark loads the music files into
+const int kStartupBenchmarkDecks = 4;
+// The longest wait for the tracks of the decks and for the library scan
+const int kStartupBenchmarkDecksTimeoutMillis = 60 * 1000;
+const int kStartupBenchmarkScanTimeoutMillis = 10 * 60 * 1000;
+
 } // anonymous namespace
 
 // static
@@ -97,6 +127,7 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
           m_pEngine(nullptr),
           m_pSkinLoader(nullptr),
           m_pSoundManager(nullptr),
+          m_pOfflineRenderer(nullptr),
           m_pPlayerManager(nullptr),
           m_pRecordingManager(nullptr),
 #ifdef __BROADCAST__
@@ -104,6 +135,7 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
 #endif
           m_pControllerManager(nullptr),
           m_pGuiTick(nullptr),
+          m_pControlCoalescer(nullptr),
 #ifdef __VINYLCONTROL__
           m_pVCManager(nullptr),
 #endif
@@ -117,16 +149,35 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
           m_toolTipsCfg(mixxx::TooltipsPreference::TOOLTIPS_ON),
           m_runtime_timer("MixxxMainWindow::runtime"),
           m_cmdLineArgs(args),
+          m_startupBenchmarkDecksLoading(0),
           m_pTouchShift(nullptr) {
     m_runtime_timer.start();
     mixxx::Time::start();
 
     Version::logBuildDetails();
 
-    // Only record stats in developer mode.
-    if (m_cmdLineArgs.getDeveloper()) {
+    // Only record stats in developer mode, for the timeline or the metrics.
+    if (m_cmdLineArgs.getDeveloper() || m_cmdLineArgs.getTimelineEnabled() ||
+            m_cmdLineArgs.getMetricsEnabled()) {
         StatsManager::createInstance();
     }
+    LockProfiler::setEnabled(m_cmdLineArgs.getProfileLocks());
+    RealtimeSafety::setEnabled(m_cmdLineArgs.getRealtimeSafety());
+    if (m_cmdLineArgs.getSlowSqlMillis() > 0) {
+        SqlQueryProfiler::setEnabled(m_cmdLineArgs.getProfileSql(),
+                mixxx::Duration::fromMillis(m_cmdLineArgs.getSlowSqlMillis()));
+    } else {
+        SqlQueryProfiler::setEnabled(m_cmdLineArgs.getProfileSql());
+    }
+    if (m_cmdLineArgs.getSlowEventMillis() > 0) {
+        EventLoopProfiler::setEnabled(m_cmdLineArgs.getProfileEventLoop(),
+                mixxx::Duration::fromMillis(m_cmdLineArgs.getSlowEventMillis()));
+    } else {
+        EventLoopProfiler::setEnabled(m_cmdLineArgs.getProfileEventLoop());
+    }
+    if (m_cmdLineArgs.getFlightRecorderEnabled()) {
+        FlightRecorder::createInstance();
+    }
 
     m_pSettingsManager = new SettingsManager(this, args.getSettingsPath());
 
@@ -165,17 +216,61 @@ MixxxMainWindow::~MixxxMainWindow() {
 
 void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     ScopedTimer t("MixxxMainWindow::initialize");
+    Trace trace("MixxxMainWindow::initialize");
+    PhaseTrace phase("MixxxMainWindow::initialize");
 
+    phase.next("settings");
     UserSettingsPointer pConfig = m_pSettingsManager->settings();
 
+    m_launchTimer.start();
+    const QStringList launchProgressProfile =
+            pConfig->getValueString(kLaunchProgressConfigKey).split(
+                    ",", QString::SkipEmptyParts);
+    if (launchProgressProfile.size() == kLaunchProgressSteps) {
+        for (const auto& progress : launchProgressProfile) {
+            m_launchProgressProfile.append(progress.toInt());
+        }
+    }
+
+    // Runs while the engine and the library are set up
+    SoundManager::initializePortAudioInBackground();
+
     Sandbox::initialize(QDir(pConfig->getSettingsPath()).filePath("sandbox.cfg"));
 
+    // Before any of the threads that apply them is started
+    mixxx::ThreadRoles::configure(pConfig);
+
+    // Before any track is opened
+    if (pConfig->getValue(ConfigKey("[SoundSourceMP3]", "seek_frame_cache"), 1) > 0) {
+        mixxx::Mp3SeekFrameCache::setDirectory(
+                QDir(pConfig->getSettingsPath()).filePath("mp3seekcache"));
+    }
+    // Before any track is analyzed
+    if (pConfig->getValue(ConfigKey("[Library]", "AnalysisCache"), 1) > 0) {
+        AnalysisCache::setDirectory(pConfig->getValue(
+                ConfigKey("[Library]", "AnalysisCacheDirectory"),
+                QDir(pConfig->getSettingsPath()).filePath("analysiscache")));
+    }
+#ifdef __VAMP__
+    // Before the beat and key preferences list the plugins
+    mixxx::VampPluginLoader::setCacheFile(
+            QDir(pConfig->getSettingsPath()).filePath("vampplugins.cache"));
+#endif
+
     QString resourcePath = pConfig->getResourcePath();
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    // The font database is thread-safe, the fonts are added while the
+    // engine and the library are set up (takes a long time)
+    QFuture<void> fontsInitialized = QtConcurrent::run(
+            &FontUtils::initializeFonts, resourcePath);
+#else
     FontUtils::initializeFonts(resourcePath); // takes a long time
+#endif
 
     launchProgress(2);
 
+    phase.next("effects");
     // Set the visibility of tooltips, default "1" = ON
     m_toolTipsCfg = static_cast<mixxx::TooltipsPreference>(
         pConfig->getValue(ConfigKey("[Controls]", "Tooltips"),
@@ -203,6 +298,7 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     launchProgress(8);
 
+    phase.next("sound");
     // Although m_pSoundManager is created here, m_pSoundManager->setupDevices()
     // needs to be called after m_pPlayerManager registers sound IO for each EngineChannel.
     m_pSoundManager = new SoundManager(pConfig, m_pEngine);
@@ -218,8 +314,11 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     launchProgress(11);
 
+    phase.next("players");
     // Needs to be created before CueControl (decks) and WTrackTableView.
     m_pGuiTick = new GuiTick();
+    // Needs to be created before any widget.
+    m_pControlCoalescer = new ControlCoalescer();
 
 #ifdef __VINYLCONTROL__
     m_pVCManager = new VinylControlManager(this, pConfig, m_pSoundManager);
@@ -254,6 +353,7 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     launchProgress(30);
 
+    phase.next("effect chains");
     m_pEffectsManager->loadEffectChains();
 
 #ifdef __VINYLCONTROL__
@@ -268,7 +368,13 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     delete pModplugPrefs; // not needed anymore
 #endif
 
-    CoverArtCache::createInstance();
+    phase.next("database");
+    CoverArtCache* pCoverArtCache = CoverArtCache::createInstance();
+    if (pConfig->getValue(ConfigKey("[Library]", "CoverThumbnailCache"), 1) > 0) {
+        pCoverArtCache->setThumbnailCache(
+                QDir(pConfig->getSettingsPath()).filePath("coverthumbnails"),
+                pConfig->getValue(ConfigKey("[Library]", "CoverThumbnailCacheMiBs"), 256));
+    }
 
     m_pDbConnectionPool = MixxxDb(pConfig).connectionPool();
     if (!m_pDbConnectionPool) {
@@ -284,6 +390,16 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     launchProgress(35);
 
+    if (args.getStartupBenchmarkTracks() > 0) {
+        phase.next("synthetic library");
+        const int generated = StartupBenchmark::generateLibrary(
+                mixxx::DbConnectionPooled(m_pDbConnectionPool),
+                args.getStartupBenchmarkTracks());
+        kLogger.info() << "Generated" << generated
+                       << "tracks for the startup benchmark";
+    }
+
+    phase.next("library");
     m_pLibrary = new Library(
             this,
             pConfig,
@@ -307,7 +423,8 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     bool hasChanged_MusicDir = false;
 
     QStringList dirs = m_pLibrary->getDirs();
-    if (dirs.size() < 1) {
+    // The benchmark must not wait for the user
+    if (dirs.size() < 1 && !args.getStartupBenchmarkEnabled()) {
         // TODO(XXX) this needs to be smarter, we can't distinguish between an empty
         // path return value (not sure if this is normally possible, but it is
         // possible with the Windows 7 "Music" library, which is what
@@ -327,6 +444,7 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     // Call inits to invoke all other construction parts
 
+    phase.next("controllers");
     // Initialize controller sub-system,
     // but do not set up controllers until the end of the application startup
     // (long)
@@ -335,12 +453,19 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     launchProgress(47);
 
+    phase.next("waveforms");
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    // Before the first widget that uses the fonts of the skins
+    fontsInitialized.waitForFinished();
+#endif
+
     WaveformWidgetFactory::createInstance(); // takes a long time
     WaveformWidgetFactory::instance()->startVSync(m_pGuiTick);
     WaveformWidgetFactory::instance()->setConfig(pConfig);
 
     launchProgress(52);
 
+    phase.next("preferences");
     connect(this, SIGNAL(newSkinLoaded()),
             m_pLibrary, SLOT(onSkinLoadFinished()));
 
@@ -364,6 +489,7 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     launchProgress(60);
 
+    phase.next("menu bar");
     // Connect signals to the menubar. Should be done before we go fullscreen
     // and emit newSkinLoaded.
     connectMenuBar();
@@ -376,6 +502,7 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     launchProgress(63);
 
+    phase.next("skin");
     QWidget* oldWidget = m_pWidgetParent;
 
     // Load skin to a QWidget that we set as the central widget. Assignment
@@ -422,6 +549,7 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     // Wait until all other ControlObjects are set up before initializing
     // controllers
+    phase.next("controller devices");
     m_pControllerManager->setUpDevices();
 
     // Scan the library for new files and directories
@@ -444,10 +572,17 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
         m_pLibrary->scan();
     }
 
+    phase.next("sound devices");
     // Try open player device If that fails, the preference panel is opened.
+    // When rendering offline the renderer drives the engine instead, so no
+    // sound device must be opened.
     bool retryClicked;
     do {
         retryClicked = false;
+        if (args.getRenderEnabled()) {
+            qDebug() << "Rendering offline, sound devices are not opened";
+            break;
+        }
         SoundDeviceError result = m_pSoundManager->setupDevices();
         if (result == SOUNDDEVICE_ERROR_DEVICE_COUNT ||
                 result == SOUNDDEVICE_ERROR_EXCESSIVE_OUTPUT_CHANNEL) {
@@ -467,7 +602,8 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     // In case persisting errors, the user has already received a message
     // box from the preferences dialog above. So we can watch here just the
     // output count.
-    while (m_pSoundManager->getConfig().getOutputs().count() == 0) {
+    while (!args.getRenderEnabled() &&
+            m_pSoundManager->getConfig().getOutputs().count() == 0) {
         // Exit when we press the Exit button in the noSoundDlg dialog
         // only call it if result != OK
         bool continueClicked = false;
@@ -477,11 +613,12 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
         if (continueClicked) break;
    }
 
+    phase.next("tracks");
     // Load tracks in args.qlMusicFiles (command line arguments) into player
-    // 1 and 2:
+    // 1 and 2. The startup benchmark loads them after the startup.
     const QList<QString>& musicFiles = args.getMusicFiles();
-    for (int i = 0; i < (int)m_pPlayerManager->numDecks()
-            && i < musicFiles.count(); ++i) {
+    for (int i = 0; !args.getStartupBenchmarkEnabled() &&
+            i < (int)m_pPlayerManager->numDecks() && i < musicFiles.count(); ++i) {
         if (SoundSourceProxy::isFileNameSupported(musicFiles.at(i))) {
             m_pPlayerManager->slotLoadToDeck(musicFiles.at(i), i+1);
         }
@@ -504,12 +641,35 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
     // The launch image widget is automatically disposed, but we still have a
     // pointer to it.
     m_pLaunchImage = nullptr;
+
+    if (args.getRenderEnabled()) {
+        const SoundManagerConfig& soundConfig = m_pSoundManager->getConfig();
+        m_pOfflineRenderer = new EngineOfflineRenderer(pConfig, m_pEngine,
+                args.getRenderPath(), soundConfig.getSampleRate(),
+                soundConfig.getFramesPerBuffer(), args.getRenderDuration(),
+                args.getRenderAutoDJ());
+        connect(m_pOfflineRenderer, SIGNAL(renderFinished(bool)),
+                this, SLOT(slotOfflineRenderFinished(bool)));
+        m_pOfflineRenderer->start(QThread::HighPriority);
+    }
+
+    if (args.getStartupBenchmarkEnabled()) {
+        // The startup ends when the event loop runs with the shown window
+        m_startupBenchmarkTimeout.setSingleShot(true);
+        connect(&m_startupBenchmarkTimeout, SIGNAL(timeout()),
+                this, SLOT(slotStartupBenchmarkTimeout()));
+        QTimer::singleShot(0, this, SLOT(slotStartupBenchmarkStarted()));
+    }
 }
 
 void MixxxMainWindow::finalize() {
     Timer t("MixxxMainWindow::~finalize");
     t.start();
 
+    // Closed while the startup benchmark runs
+    m_startupBenchmarkStep.clear();
+    m_startupBenchmarkTimeout.stop();
+
     if (m_inhibitScreensaver != mixxx::ScreenSaverPreference::PREVENT_OFF) {
         mixxx::ScreenSaverHelper::uninhibit();
     }
@@ -556,6 +716,13 @@ void MixxxMainWindow::finalize() {
         qWarning() << "WMainMenuBar was not deleted by our sendPostedEvents trick.";
     }
 
+    // EngineOfflineRenderer depends on Engine and Config
+    if (m_pOfflineRenderer) {
+        qDebug() << t.elapsed(false).debugMillisWithUnit() << "deleting EngineOfflineRenderer";
+        delete m_pOfflineRenderer;
+        m_pOfflineRenderer = nullptr;
+    }
+
     // SoundManager depend on Engine and Config
     qDebug() << t.elapsed(false).debugMillisWithUnit() << "deleting SoundManager";
     delete m_pSoundManager;
@@ -625,6 +792,7 @@ void MixxxMainWindow::finalize() {
     PlayerInfo::destroy();
     WaveformWidgetFactory::destroy();
 
+    delete m_pControlCoalescer;
     delete m_pGuiTick;
 
     // Check for leaked ControlObjects and give warnings.
@@ -680,6 +848,11 @@ void MixxxMainWindow::finalize() {
     t.elapsed(true);
     // Report the total time we have been running.
     m_runtime_timer.elapsed(true);
+    if (RealtimeSafety::isEnabled()) {
+        RealtimeSafety::logReport();
+    }
+    EventLoopProfiler::setEnabled(false);
+    FlightRecorder::destroy();
     StatsManager::destroy();
 }
 
@@ -1089,7 +1262,8 @@ void MixxxMainWindow::slotDeveloperTools(bool visible) {
     if (visible) {
         if (m_pDeveloperToolsDlg == nullptr) {
             UserSettingsPointer pConfig = m_pSettingsManager->settings();
-            m_pDeveloperToolsDlg = new DlgDeveloperTools(this, pConfig);
+            m_pDeveloperToolsDlg = new DlgDeveloperTools(this, pConfig,
+                    m_pEngine->getCallbackProfiler());
             connect(m_pDeveloperToolsDlg, SIGNAL(destroyed()),
                     this, SLOT(slotDeveloperToolsClosed()));
             connect(this, SIGNAL(closeDeveloperToolsDlgChecked(int)),
@@ -1153,6 +1327,95 @@ void MixxxMainWindow::slotNoVinylControlInputConfigured() {
     m_pPrefDlg->showSoundHardwarePage();
 }
 
+void MixxxMainWindow::slotOfflineRenderFinished(bool success) {
+    // Ignore the signal of a renderer that has been stopped in finalize()
+    if (!m_pOfflineRenderer) {
+        return;
+    }
+    if (!success) {
+        qWarning() << "Offline rendering to" << m_cmdLineArgs.getRenderPath()
+                   << "failed";
+    }
+    close();
+}
+
+void MixxxMainWindow::slotStartupBenchmarkStarted() {
+    StartupBenchmark::recordMilestone("startup", mixxx::Time::elapsed());
+
+    QStringList musicFiles;
+    for (const auto& musicFile : m_cmdLineArgs.getMusicFiles()) {
+        if (SoundSourceProxy::isFileNameSupported(musicFile)) {
+            musicFiles.append(musicFile);
+        }
+    }
+    const int numDecks = math_min(kStartupBenchmarkDecks,
+            static_cast<int>(m_pPlayerManager->numDecks()));
+    m_startupBenchmarkStep = "decks";
+    m_startupBenchmarkTimer.start();
+    if (musicFiles.isEmpty() || numDecks <= 0) {
+        qWarning() << "The startup benchmark loads no decks without music files";
+        finishStartupBenchmarkStep(false);
+        return;
+    }
+
+    // The decks load their tracks concurrently, the step ends with the
+    // last one. A deck that fails to load its track is emptied.
+    m_startupBenchmarkDecksLoading = numDecks;
+    m_startupBenchmarkTimeout.start(kStartupBenchmarkDecksTimeoutMillis);
+    for (int i = 1; i <= numDecks; ++i) {
+        Deck* pDeck = m_pPlayerManager->getDeck(i);
+        connect(pDeck, SIGNAL(newTrackLoaded(TrackPointer)),
+                this, SLOT(slotStartupBenchmarkTrackLoaded()));
+        connect(pDeck, SIGNAL(playerEmpty()),
+                this, SLOT(slotStartupBenchmarkTrackLoaded()));
+        m_pPlayerManager->slotLoadToDeck(
+                musicFiles.at((i - 1) % musicFiles.size()), i);
+    }
+}
+
+void MixxxMainWindow::slotStartupBenchmarkTrackLoaded() {
+    if (m_startupBenchmarkStep != "decks") {
+        return;
+    }
+    if (--m_startupBenchmarkDecksLoading <= 0) {
+        finishStartupBenchmarkStep(false);
+    }
+}
+
+void MixxxMainWindow::slotStartupBenchmarkScanFinished() {
+    if (m_startupBenchmarkStep == "scan") {
+        finishStartupBenchmarkStep(false);
+    }
+}
+
+void MixxxMainWindow::slotStartupBenchmarkTimeout() {
+    if (!m_startupBenchmarkStep.isEmpty()) {
+        qWarning() << "The startup benchmark step" << m_startupBenchmarkStep
+                   << "has timed out";
+        finishStartupBenchmarkStep(true);
+    }
+}
+
+void MixxxMainWindow::finishStartupBenchmarkStep(bool timedOut) {
+    m_startupBenchmarkTimeout.stop();
+    StartupBenchmark::recordMilestone(m_startupBenchmarkStep,
+            m_startupBenchmarkTimer.elapsed(), timedOut);
+
+    if (m_startupBenchmarkStep == "decks") {
+        m_startupBenchmarkStep = "scan";
+        connect(m_pLibrary, SIGNAL(scanFinished()),
+                this, SLOT(slotStartupBenchmarkScanFinished()));
+        m_startupBenchmarkTimer.start();
+        m_startupBenchmarkTimeout.start(kStartupBenchmarkScanTimeoutMillis);
+        m_pLibrary->scan();
+        return;
+    }
+
+    m_startupBenchmarkStep.clear();
+    StartupBenchmark::write(m_cmdLineArgs.getStartupBenchmarkPath());
+    close();
+}
+
 void MixxxMainWindow::slotNoDeckPassthroughInputConfigured() {
     QMessageBox::warning(
         this,
@@ -1427,6 +1690,25 @@ mixxx::ScreenSaverPreference MixxxMainWindow::getInhibitScreensaver()
 }
 
 void MixxxMainWindow::launchProgress(int progress) {
+    const int step = m_launchProgressTimes.size();
+    m_launchProgressTimes.append(m_launchTimer.elapsed());
+    if (step < m_launchProgressProfile.size()) {
+        progress = m_launchProgressProfile[step];
+    }
+    if (step == kLaunchProgressSteps - 1) {
+        // The share of the total time at each step
+        const double totalNanos = math_max<qint64>(
+                m_launchProgressTimes.last().toIntegerNanos(), 1);
+        QStringList launchProgressProfile;
+        for (const auto& time : m_launchProgressTimes) {
+            launchProgressProfile.append(QString::number(static_cast<int>(
+                    100 * time.toIntegerNanos() / totalNanos)));
+        }
+        m_pSettingsManager->settings()->setValue(kLaunchProgressConfigKey,
+                launchProgressProfile.join(","));
+    }
+    DEBUG_ASSERT(step < kLaunchProgressSteps);
+
     if (m_pLaunchImage) {
         m_pLaunchImage->progress(progress);
     }
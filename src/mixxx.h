@@ -18,26 +18,32 @@
 #ifndef MIXXX_H
 #define MIXXX_H
 
+#include <QList>
 #include <QMainWindow>
 #include <QSharedPointer>
 #include <QString>
+#include <QTimer>
 
 #include "preferences/configobject.h"
 #include "preferences/usersettings.h"
 #include "preferences/constants.h"
 #include "track/track.h"
 #include "util/cmdlineargs.h"
+#include "util/duration.h"
+#include "util/performancetimer.h"
 #include "util/timer.h"
 #include "util/db/dbconnectionpool.h"
 #include "soundio/sounddeviceerror.h"
 
 class ChannelHandleFactory;
+class ControlCoalescer;
 class ControlPushButton;
 class ControllerManager;
 class DlgDeveloperTools;
 class DlgPreferences;
 class EffectsManager;
 class EngineMaster;
+class EngineOfflineRenderer;
 class GuiTick;
 class LaunchImage;
 class Library;
@@ -100,6 +106,13 @@ class MixxxMainWindow : public QMainWindow {
     void slotNoMicrophoneInputConfigured();
     void slotNoDeckPassthroughInputConfigured();
     void slotNoVinylControlInputConfigured();
+    // Quits after rendering with --render
+    void slotOfflineRenderFinished(bool success);
+    // The steps of --startupBenchmark after the startup
+    void slotStartupBenchmarkStarted();
+    void slotStartupBenchmarkTrackLoaded();
+    void slotStartupBenchmarkScanFinished();
+    void slotStartupBenchmarkTimeout();
 
   signals:
     void newSkinLoaded();
@@ -119,6 +132,8 @@ class MixxxMainWindow : public QMainWindow {
 
     // progresses the launch image progress bar
     // this must be called from the GUi thread only
+    // The progress is replaced by the measured progress of the previous
+    // launch at the same step.
     void launchProgress(int progress);
 
     void initializeWindow();
@@ -127,6 +142,10 @@ class MixxxMainWindow : public QMainWindow {
 
     bool initializeDatabase();
 
+    // Ends the current step of --startupBenchmark and starts the next one,
+    // writes the results and quits after the last one
+    void finishStartupBenchmarkStep(bool timedOut);
+
     bool confirmExit();
     QDialog::DialogCode soundDeviceErrorDlg(
             const QString &title, const QString &text, bool* retryClicked);
@@ -155,6 +174,8 @@ class MixxxMainWindow : public QMainWindow {
 
     // The sound manager
     SoundManager* m_pSoundManager;
+    // Drives the engine instead of the sound devices with --render
+    EngineOfflineRenderer* m_pOfflineRenderer;
 
     // Keeps track of players
     PlayerManager* m_pPlayerManager;
@@ -166,6 +187,7 @@ class MixxxMainWindow : public QMainWindow {
     ControllerManager* m_pControllerManager;
 
     GuiTick* m_pGuiTick;
+    ControlCoalescer* m_pControlCoalescer;
 
     VinylControlManager* m_pVCManager;
 
@@ -191,8 +213,20 @@ class MixxxMainWindow : public QMainWindow {
     // Timer that tracks how long Mixxx has been running.
     Timer m_runtime_timer;
 
+    // The times of the launch progress steps, which are saved as the
+    // progress of the next launch
+    PerformanceTimer m_launchTimer;
+    QList<mixxx::Duration> m_launchProgressTimes;
+    QList<int> m_launchProgressProfile;
+
     const CmdlineArgs& m_cmdLineArgs;
 
+    // The current step of --startupBenchmark, empty when none is running
+    QString m_startupBenchmarkStep;
+    PerformanceTimer m_startupBenchmarkTimer;
+    QTimer m_startupBenchmarkTimeout;
+    int m_startupBenchmarkDecksLoading;
+
     ControlPushButton* m_pTouchShift;
     mixxx::ScreenSaverPreference m_inhibitScreensaver;
 
@@ -1,11 +1,13 @@
 #include <util/synthesizedmouseevents.h>
 #include <QtDebug>
+#include <QThread>
 #include <QTouchEvent>
 #include "mixxxapplication.h"
 
 #include "library/crate/crateid.h"
 #include "control/controlproxy.h"
 #include "mixxx.h"
+#include "util/eventloopprofiler.h"
 
 // When linking Qt statically on Windows we have to Q_IMPORT_PLUGIN all the
 // plugins we link in build/depends.py.
@@ -180,6 +182,18 @@ bool MixxxApplication::notify(QObject* target, QEvent* event) {
     bool ret = QApplication::notify(target, event);
     return ret;
 }
+
+#else
+
+bool MixxxApplication::notify(QObject* target, QEvent* event) {
+    if (EventLoopProfiler::isEnabled() &&
+            QThread::currentThread() == thread()) {
+        EventLoopProfiler::ScopedDispatch dispatch(target, event);
+        return QApplication::notify(target, event);
+    }
+    return QApplication::notify(target, event);
+}
+
 #endif // QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 
 bool MixxxApplication::touchIsRightButton() {
@@ -11,9 +11,9 @@ class MixxxApplication : public QApplication {
     MixxxApplication(int& argc, char** argv);
     ~MixxxApplication() override;
 
-#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-    virtual bool notify(QObject*, QEvent*);
-#endif
+    // Synthesizes the mouse events of touch screens with Qt 4 and measures
+    // the events of the GUI thread for the EventLoopProfiler
+    bool notify(QObject*, QEvent*) override;
 
   private:
     bool touchIsRightButton();
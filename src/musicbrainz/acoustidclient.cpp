@@ -12,6 +12,7 @@
 #include <QXmlStreamReader>
 #include <QTextStream>
 #include <QUrl>
+#include <QVector>
 #include <QtDebug>
 
 #include "musicbrainz/acoustidclient.h"
@@ -23,11 +24,17 @@
 const QString CLIENT_APIKEY = "czKxnkyO";
 const QString ACOUSTID_URL = "http://api.acoustid.org/v2/lookup";
 const int AcoustidClient::m_DefaultTimeout = 5000; // msec
+// AcoustID accepts up to 3 requests per second from each client
+const int AcoustidClient::m_RequestInterval = 334; // msec
+const int AcoustidClient::m_MaxFingerprintsPerRequest = 10;
 
 AcoustidClient::AcoustidClient(QObject* parent)
               : QObject(parent),
                 m_network(this),
                 m_timeouts(m_DefaultTimeout, this) {
+    m_requestTimer.setInterval(m_RequestInterval);
+    connect(&m_requestTimer, SIGNAL(timeout()),
+            this, SLOT(sendPendingRequests()));
 }
 
 void AcoustidClient::setTimeout(int msec) {
@@ -35,12 +42,48 @@ void AcoustidClient::setTimeout(int msec) {
 }
 
 void AcoustidClient::start(int id, const QString& fingerprint, int duration) {
+    PendingRequest request;
+    request.id = id;
+    request.fingerprint = fingerprint;
+    request.duration = duration;
+    m_pendingRequests.append(request);
+    if (!m_requestTimer.isActive()) {
+        // The first request is sent immediately
+        sendPendingRequests();
+        m_requestTimer.start();
+    }
+}
+
+void AcoustidClient::sendPendingRequests() {
+    if (m_pendingRequests.isEmpty()) {
+        m_requestTimer.stop();
+        return;
+    }
+    const QList<PendingRequest> batch =
+            m_pendingRequests.mid(0, m_MaxFingerprintsPerRequest);
+    m_pendingRequests = m_pendingRequests.mid(batch.size());
+
     QUrl url;
     url.addQueryItem("format", "xml");
     url.addQueryItem("client", CLIENT_APIKEY);
-    url.addQueryItem("duration", QString::number(duration));
     url.addQueryItem("meta", "recordingids");
-    url.addQueryItem("fingerprint", fingerprint);
+    QList<int> ids;
+    if (batch.size() == 1) {
+        url.addQueryItem("duration", QString::number(batch.first().duration));
+        url.addQueryItem("fingerprint", batch.first().fingerprint);
+    } else {
+        // The parameters of each fingerprint are suffixed with its index
+        // in the batch
+        for (int i = 0; i < batch.size(); ++i) {
+            url.addQueryItem(QString("duration.%1").arg(i),
+                    QString::number(batch[i].duration));
+            url.addQueryItem(QString("fingerprint.%1").arg(i),
+                    batch[i].fingerprint);
+        }
+    }
+    for (const auto& request : batch) {
+        ids.append(request.id);
+    }
     QByteArray body = url.encodedQuery();
 
     QNetworkRequest req(QUrl::fromEncoded(ACOUSTID_URL.toAscii()));
@@ -48,22 +91,37 @@ void AcoustidClient::start(int id, const QString& fingerprint, int duration) {
     req.setRawHeader("Content-Encoding", "gzip");
 
     qDebug() << "AcoustIdClient POST request:" << ACOUSTID_URL
+             << "fingerprints:" << batch.size()
              << "body:" << body;
 
     QNetworkReply* reply = m_network.post(req, gzipCompress(body));
     connect(reply, SIGNAL(finished()), SLOT(requestFinished()));
-    m_requests[reply] = id;
+    m_requests[reply] = ids;
 
     m_timeouts.addReply(reply);
 }
 
 void AcoustidClient::cancel(int id) {
-    QNetworkReply* reply = m_requests.key(id);
-    m_requests.remove(reply);
-    delete reply;
+    for (int i = m_pendingRequests.size() - 1; i >= 0; --i) {
+        if (m_pendingRequests[i].id == id) {
+            m_pendingRequests.removeAt(i);
+        }
+    }
+    for (auto it = m_requests.begin(); it != m_requests.end(); ++it) {
+        if (it.value().removeAll(id) > 0) {
+            if (it.value().isEmpty()) {
+                QNetworkReply* reply = it.key();
+                m_requests.erase(it);
+                delete reply;
+            }
+            return;
+        }
+    }
 }
 
 void AcoustidClient::cancelAll() {
+    m_requestTimer.stop();
+    m_pendingRequests.clear();
     qDeleteAll(m_requests.keys());
     m_requests.clear();
 }
@@ -77,7 +135,7 @@ void AcoustidClient::requestFinished() {
     if (!m_requests.contains(reply))
         return;
 
-    int id = m_requests.take(reply);
+    const QList<int> ids = m_requests.take(reply);
 
     int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     if (status != 200) {
@@ -95,15 +153,57 @@ void AcoustidClient::requestFinished() {
     qDebug() << "AcoustIdClient POST reply status:" << status << "body:" << body;
 
     QXmlStreamReader reader(body);
-    QString ID;
+    if (ids.size() == 1) {
+        QString ID;
+        while (!reader.atEnd()) {
+            if (reader.readNext() == QXmlStreamReader::StartElement
+                && reader.name()== "results") {
+                    ID = parseResult(reader);
+                }
+        }
+        emit(finished(ids.first(), ID));
+        return;
+    }
+
+    // A batch reply contains the results of each fingerprint together
+    // with its index
+    QVector<QString> IDs(ids.size());
     while (!reader.atEnd()) {
         if (reader.readNext() == QXmlStreamReader::StartElement
-            && reader.name()== "results") {
-                ID = parseResult(reader);
+            && reader.name() == "fingerprint") {
+            const QPair<int, QString> fingerprint = parseFingerprint(reader);
+            if (fingerprint.first >= 0 && fingerprint.first < IDs.size()) {
+                IDs[fingerprint.first] = fingerprint.second;
             }
+        }
     }
+    for (int i = 0; i < ids.size(); ++i) {
+        emit(finished(ids[i], IDs[i]));
+    }
+}
 
-    emit(finished(id, ID));
+QPair<int, QString> AcoustidClient::parseFingerprint(QXmlStreamReader& reader) {
+    int index = -1;
+    QString ID;
+    while (!reader.atEnd()) {
+        QXmlStreamReader::TokenType type = reader.readNext();
+        if (type == QXmlStreamReader::StartElement) {
+            QStringRef name = reader.name();
+            if (name == "index") {
+                bool ok = false;
+                index = reader.readElementText().toInt(&ok);
+                if (!ok) {
+                    index = -1;
+                }
+            } else if (name == "results" && ID.isEmpty()) {
+                ID = parseResult(reader);
+            }
+        }
+        if (type == QXmlStreamReader::EndElement && reader.name() == "fingerprint") {
+            break;
+        }
+    }
+    return qMakePair(index, ID);
 }
 
 QString AcoustidClient::parseResult(QXmlStreamReader& reader) {
@@ -115,7 +215,9 @@ QString AcoustidClient::parseResult(QXmlStreamReader& reader) {
                 return reader.readElementText();
             }
         }
-        if (type == QXmlStreamReader::EndElement && reader.name()=="result") {
+        // Empty results must not consume the results of the next fingerprint
+        if (type == QXmlStreamReader::EndElement &&
+                (reader.name() == "result" || reader.name() == "results")) {
             break;
         }
     }
@@ -10,8 +10,10 @@
 #ifndef ACOUSTIDCLIENT_H
 #define ACOUSTIDCLIENT_H
 
+#include <QList>
 #include <QMap>
 #include <QObject>
+#include <QTimer>
 #include <QtNetwork>
 
 #include "musicbrainz/network.h"
@@ -29,6 +31,9 @@ class AcoustidClient : public QObject {
     // You can create one AcoustidClient and make multiple requests using it.
     // IDs are provided by the caller when a request is started and included in
     // the finished signal - they have no meaning to AcoustidClient.
+    // The requests are sent within the rate limit of the AcoustID server.
+    // The fingerprints that are started meanwhile are looked up together
+    // with a single batch request.
 
   public:
     AcoustidClient(QObject* parent = 0);
@@ -37,7 +42,7 @@ class AcoustidClient : public QObject {
     void setTimeout(int msec);
 
     // Starts a request and returns immediately.  Finished() will be emitted
-    // later with the same ID.
+    // later with the same ID. The request might be queued.
     void start(int id, const QString& fingerprint, int duration);
 
     // Cancels the request with the given ID.  Finished() will never be emitted
@@ -55,14 +60,29 @@ class AcoustidClient : public QObject {
     void networkError(int, QString);
 
   private slots:
+    void sendPendingRequests();
     void requestFinished();
 
   private:
+    struct PendingRequest {
+        int id;
+        QString fingerprint;
+        int duration;
+    };
+
+    // Returns the index and the MBID of a fingerprint of a batch reply
+    QPair<int, QString> parseFingerprint(QXmlStreamReader& reader);
+
     static const int m_DefaultTimeout;
+    static const int m_RequestInterval;
+    static const int m_MaxFingerprintsPerRequest;
 
     QNetworkAccessManager m_network;
     NetworkTimeouts m_timeouts;
-    QMap<QNetworkReply*, int> m_requests;
+    QTimer m_requestTimer;
+    QList<PendingRequest> m_pendingRequests;
+    // The IDs of the fingerprints of each request in their order
+    QMap<QNetworkReply*, QList<int>> m_requests;
 };
 
 #endif // ACOUSTIDCLIENT_H
@@ -22,14 +22,35 @@
 const QString MusicBrainzClient::m_TrackUrl = "http://musicbrainz.org/ws/2/recording/";
 const QString MusicBrainzClient::m_DateRegex = "^[12]\\d{3}";
 const int MusicBrainzClient::m_DefaultTimeout = 5000; // msec
+// http://musicbrainz.org/doc/XML_Web_Service/Rate_Limiting
+const int MusicBrainzClient::m_RequestInterval = 1000; // msec
 
 MusicBrainzClient::MusicBrainzClient(QObject* parent)
                  : QObject(parent),
                    m_network(this),
                    m_timeouts(m_DefaultTimeout, this) {
+    m_requestTimer.setInterval(m_RequestInterval);
+    connect(&m_requestTimer, SIGNAL(timeout()),
+            this, SLOT(sendNextRequest()));
 }
 
 void MusicBrainzClient::start(int id, const QString& mbid) {
+    m_pendingRequests.append(qMakePair(id, mbid));
+    if (!m_requestTimer.isActive()) {
+        // The first request is sent immediately
+        sendNextRequest();
+        m_requestTimer.start();
+    }
+}
+
+void MusicBrainzClient::sendNextRequest() {
+    if (m_pendingRequests.isEmpty()) {
+        m_requestTimer.stop();
+        return;
+    }
+    const int id = m_pendingRequests.first().first;
+    const QString mbid = m_pendingRequests.takeFirst().second;
+
     typedef QPair<QString, QString> Param;
 
     QList<Param> parameters;
@@ -50,12 +71,19 @@ void MusicBrainzClient::start(int id, const QString& mbid) {
 }
 
 void MusicBrainzClient::cancel(int id) {
+    for (int i = m_pendingRequests.size() - 1; i >= 0; --i) {
+        if (m_pendingRequests[i].first == id) {
+            m_pendingRequests.removeAt(i);
+        }
+    }
     QNetworkReply* reply = m_requests.key(id);
     m_requests.remove(reply);
     delete reply;
 }
 
 void MusicBrainzClient::cancelAll() {
+    m_requestTimer.stop();
+    m_pendingRequests.clear();
     qDeleteAll(m_requests.keys());
     m_requests.clear();
 }
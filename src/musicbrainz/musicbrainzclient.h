@@ -13,6 +13,8 @@
 #include <QHash>
 #include <QMap>
 #include <QObject>
+#include <QPair>
+#include <QTimer>
 #include <QXmlStreamReader>
 #include <QtNetwork>
 
@@ -26,6 +28,8 @@ class MusicBrainzClient : public QObject {
   // You can create one MusicBrainzClient and make multiple requests using it.
   // IDs are provided by the caller when a request is started and included in
   // the Finished signal - they have no meaning to MusicBrainzClient.
+  // The requests are queued and sent one per second, the rate limit of
+  // the MusicBrainz server.
 
   public:
     MusicBrainzClient(QObject* parent = 0);
@@ -85,6 +89,7 @@ class MusicBrainzClient : public QObject {
     void networkError(int, QString);
 
   private slots:
+    void sendNextRequest();
     void requestFinished();
 
   private:
@@ -113,9 +118,13 @@ class MusicBrainzClient : public QObject {
     static const QString m_TrackUrl;
     static const QString m_DateRegex;
     static const int m_DefaultTimeout;
+    static const int m_RequestInterval;
 
     QNetworkAccessManager m_network;
     NetworkTimeouts m_timeouts;
+    QTimer m_requestTimer;
+    // The IDs and MBIDs of the requests that have not been sent yet
+    QList<QPair<int, QString>> m_pendingRequests;
     QMap<QNetworkReply*, int> m_requests;
 };
 
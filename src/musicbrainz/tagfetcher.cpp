@@ -38,10 +38,14 @@ QString TagFetcher::getFingerprint(const TrackPointer tio) {
 }
 
 void TagFetcher::startFetch(const TrackPointer track) {
-    cancel();
-    // qDebug() << "start to fetch track metadata";
     QList<TrackPointer> tracks;
     tracks.append(track);
+    startFetch(tracks);
+}
+
+void TagFetcher::startFetch(const QList<TrackPointer>& tracks) {
+    cancel();
+    // qDebug() << "start to fetch track metadata";
     m_tracks = tracks;
 
     QFuture<QString> future = QtConcurrent::mapped(m_tracks, getFingerprint);
@@ -28,6 +28,10 @@ class TagFetcher : public QObject {
     TagFetcher(QObject* parent = 0);
 
     void startFetch(const TrackPointer track);
+    // Fetches the tags of many tracks at once. The fingerprints are
+    // calculated in parallel on all cores and resultAvailable() is
+    // emitted for each track.
+    void startFetch(const QList<TrackPointer>& tracks);
 
   public slots:
     void cancel();
@@ -52,7 +56,6 @@ class TagFetcher : public QObject {
     AcoustidClient m_AcoustidClient;
     MusicBrainzClient m_MusicbrainzClient;
 
-    // Code can already be run on an arbitrary number of input tracks
     QList<TrackPointer> m_tracks;
 };
 
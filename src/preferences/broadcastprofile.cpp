@@ -394,6 +394,21 @@ int BroadcastProfile::connectionStatus() {
     return m_connectionStatus;
 }
 
+void BroadcastProfile::setConnectionStatistics(int queuedBytes,
+        int bytesPerSecond) {
+    m_queuedBytes = queuedBytes;
+    m_bytesPerSecond = bytesPerSecond;
+    emit connectionStatisticsChanged(queuedBytes, bytesPerSecond);
+}
+
+int BroadcastProfile::queuedBytes() {
+    return m_queuedBytes;
+}
+
+int BroadcastProfile::bytesPerSecond() {
+    return m_bytesPerSecond;
+}
+
 void BroadcastProfile::setSecureCredentialStorage(bool value) {
     m_secureCredentials = value;
 }
@@ -484,6 +499,11 @@ void BroadcastProfile::relayConnectionStatus(int newConnectionStatus) {
     setConnectionStatus(newConnectionStatus);
 }
 
+void BroadcastProfile::relayConnectionStatistics(int queuedBytes,
+        int bytesPerSecond) {
+    setConnectionStatistics(queuedBytes, bytesPerSecond);
+}
+
 // This was useless before, but now comes in handy for multi-broadcasting,
 // where it means "this connection is enabled and will be started by Mixxx"
 bool BroadcastProfile::getEnabled() const {
@@ -40,6 +40,13 @@ class BroadcastProfile : public QObject {
     void setConnectionStatus(int newState);
     int connectionStatus();
 
+    // The bytes that wait in the send queue of the connection and the
+    // bytes per second that the server has taken recently. Set by the
+    // thread of the connection.
+    void setConnectionStatistics(int queuedBytes, int bytesPerSecond);
+    int queuedBytes();
+    int bytesPerSecond();
+
     void setSecureCredentialStorage(bool enabled);
     bool secureCredentialStorage();
 
@@ -131,10 +138,12 @@ class BroadcastProfile : public QObject {
     void profileNameChanged(QString oldName, QString newName);
     void statusChanged(bool newStatus);
     void connectionStatusChanged(int newConnectionStatus);
+    void connectionStatisticsChanged(int queuedBytes, int bytesPerSecond);
 
   public slots:
     void relayStatus(bool newStatus);
     void relayConnectionStatus(int newConnectionStatus);
+    void relayConnectionStatistics(int queuedBytes, int bytesPerSecond);
 
   private:
     void adoptDefaultValues();
@@ -182,6 +191,8 @@ class BroadcastProfile : public QObject {
     bool m_oggDynamicUpdate;
 
     QAtomicInt m_connectionStatus;
+    QAtomicInt m_queuedBytes;
+    QAtomicInt m_bytesPerSecond;
 };
 
 #endif // BROADCASTPROFILE_H
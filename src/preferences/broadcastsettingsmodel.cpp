@@ -9,6 +9,7 @@ namespace {
 const int kColumnEnabled = 0;
 const int kColumnName = 1;
 const int kColumnStatus = 2;
+const int kColumnStatistics = 3;
 }
 
 BroadcastSettingsModel::BroadcastSettingsModel() {
@@ -26,10 +27,14 @@ void BroadcastSettingsModel::resetFromSettings(BroadcastSettingsPointer pSetting
     for(BroadcastProfilePtr profile : pSettings->profiles()) {
         BroadcastProfilePtr copy = profile->valuesCopy();
         copy->setConnectionStatus(profile->connectionStatus());
+        copy->setConnectionStatistics(profile->queuedBytes(),
+                profile->bytesPerSecond());
         connect(profile.data(), SIGNAL(statusChanged(bool)),
                 copy.data(), SLOT(relayStatus(bool)));
         connect(profile.data(), SIGNAL(connectionStatusChanged(int)),
                 copy.data(), SLOT(relayConnectionStatus(int)));
+        connect(profile.data(), SIGNAL(connectionStatisticsChanged(int, int)),
+                copy.data(), SLOT(relayConnectionStatistics(int, int)));
         addProfileToModel(copy);
     }
 }
@@ -50,6 +55,8 @@ bool BroadcastSettingsModel::addProfileToModel(BroadcastProfilePtr profile) {
             this, SLOT(onProfileNameChanged(QString,QString)));
     connect(profile.data(), SIGNAL(connectionStatusChanged(int)),
             this, SLOT(onConnectionStatusChanged(int)));
+    connect(profile.data(), SIGNAL(connectionStatisticsChanged(int, int)),
+            this, SLOT(onConnectionStatisticsChanged()));
     m_profiles.insert(profile->getProfileName(), BroadcastProfilePtr(profile));
 
     endInsertRows();
@@ -80,7 +87,7 @@ int BroadcastSettingsModel::rowCount(const QModelIndex& parent) const {
 
 int BroadcastSettingsModel::columnCount(const QModelIndex& parent) const {
     Q_UNUSED(parent);
-    return 3;
+    return 4;
 }
 
 QVariant BroadcastSettingsModel::data(const QModelIndex& index, int role) const {
@@ -113,6 +120,14 @@ QVariant BroadcastSettingsModel::data(const QModelIndex& index, int role) const
                 return Qt::AlignCenter;
             }
         }
+        else if (column == kColumnStatistics) {
+            if (role == Qt::DisplayRole) {
+                return connectionStatisticsString(profile);
+            }
+            else if (role == Qt::TextAlignmentRole) {
+                return Qt::AlignCenter;
+            }
+        }
     }
 
     return QVariant();
@@ -128,6 +143,8 @@ QVariant BroadcastSettingsModel::headerData(int section, Qt::Orientation orienta
                 return tr("Name");
             } else if(section == kColumnStatus) {
                 return tr("Status");
+            } else if(section == kColumnStatistics) {
+                return tr("Sending");
             }
         }
     }
@@ -186,6 +203,17 @@ QString BroadcastSettingsModel::connectionStatusString(BroadcastProfilePtr profi
     }
 }
 
+QString BroadcastSettingsModel::connectionStatisticsString(
+        BroadcastProfilePtr profile) {
+    if (profile->connectionStatus() != BroadcastProfile::STATUS_CONNECTED) {
+        return QString();
+    }
+    // The throughput in kbit/s like the bitrate of the stream
+    return tr("%1 kbps, %2 kB queued").arg(
+            QString::number(profile->bytesPerSecond() * 8 / 1000),
+            QString::number(profile->queuedBytes() / 1024));
+}
+
 QColor BroadcastSettingsModel::connectionStatusColor(BroadcastProfilePtr profile) {
     // Manual colors below were picked using Google's color picker (query: colorpicker)
     //
@@ -228,3 +256,9 @@ void BroadcastSettingsModel::onConnectionStatusChanged(int newStatus) {
     emit dataChanged(start, end);
 }
 
+void BroadcastSettingsModel::onConnectionStatisticsChanged() {
+    // Refresh the whole statistics column
+    QModelIndex start = this->index(0, kColumnStatistics);
+    QModelIndex end = this->index(this->rowCount()-1, kColumnStatistics);
+    emit dataChanged(start, end);
+}
@@ -0,0 +1,134 @@
+#include "preferences/configfilewriter.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+#include <QSaveFile>
+#endif
+
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("ConfigFileWriter");
+
+} // anonymous namespace
+
+ConfigFileWriter::ConfigFileWriter(const Serializer& serialize,
+        mixxx::Duration debounce)
+        : m_serialize(serialize),
+          m_debounce(debounce),
+          m_pending(false),
+          m_stop(false) {
+    m_clock.start();
+    setObjectName("ConfigFileWriter");
+}
+
+ConfigFileWriter::~ConfigFileWriter() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stop = true;
+        m_requested.wakeAll();
+    }
+    wait();
+    // The thread may not have been started or has ended before the deadline
+    writePending();
+}
+
+void ConfigFileWriter::requestWrite(const QString& filename) {
+    QMutexLocker locker(&m_mutex);
+    m_filename = filename;
+    m_deadline = m_clock.elapsed() + m_debounce;
+    m_pending = true;
+    m_requested.wakeAll();
+    locker.unlock();
+    if (!isRunning()) {
+        start(QThread::LowPriority);
+    }
+}
+
+void ConfigFileWriter::cancel() {
+    QMutexLocker locker(&m_mutex);
+    m_pending = false;
+}
+
+void ConfigFileWriter::run() {
+    QMutexLocker locker(&m_mutex);
+    while (!m_stop) {
+        if (!m_pending) {
+            m_requested.wait(&m_mutex);
+            continue;
+        }
+        const mixxx::Duration now = m_clock.elapsed();
+        if (now < m_deadline) {
+            m_requested.wait(&m_mutex, static_cast<unsigned long>(
+                    (m_deadline - now).toIntegerMillis() + 1));
+            continue;
+        }
+        locker.unlock();
+        writePending();
+        locker.relock();
+    }
+}
+
+void ConfigFileWriter::writePending() {
+    QMutexLocker locker(&m_mutex);
+    if (!m_pending) {
+        return;
+    }
+    m_pending = false;
+    const QString filename = m_filename;
+    locker.unlock();
+    // A request that arrives while writing is written again after the
+    // debounce time
+    writeFile(filename, m_serialize());
+}
+
+// static
+bool ConfigFileWriter::writeFile(const QString& filename,
+        const QByteArray& contents) {
+    const QString dirPath = QFileInfo(filename).absolutePath();
+    if (!QDir(dirPath).exists()) {
+        QDir().mkpath(dirPath);
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+    // Written to a temporary file that replaces the file on commit()
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        kLogger.warning() << "Could not write file" << filename
+                          << file.errorString();
+        return false;
+    }
+    if (file.write(contents) != contents.size() || !file.commit()) {
+        kLogger.warning() << "Error while writing configuration file"
+                          << filename << file.errorString();
+        return false;
+    }
+#else
+    const QString tempFilename = filename + ".tmp";
+    QFile file(tempFilename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        kLogger.warning() << "Could not write file" << tempFilename
+                          << file.errorString();
+        return false;
+    }
+    const bool written = file.write(contents) == contents.size();
+    file.close();
+    if (!written || file.error() != QFile::NoError) {
+        kLogger.warning() << "Error while writing configuration file"
+                          << tempFilename << file.errorString();
+        file.remove();
+        return false;
+    }
+    // QFile::rename() does not replace an existing file
+    QFile::remove(filename);
+    if (!QFile::rename(tempFilename, filename)) {
+        kLogger.warning() << "Could not replace" << filename;
+        return false;
+    }
+#endif
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef PREFERENCES_CONFIGFILEWRITER_H
+#define PREFERENCES_CONFIGFILEWRITER_H
+
+#include <functional>
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "util/class.h"
+#include "util/duration.h"
+#include "util/performancetimer.h"
+
+// Writes a configuration file in its own thread some time after the last
+// request, so a burst of changes is written once and a slow disk or a virus
+// scanner does not stall the thread that has changed the settings. The
+// contents are serialized by the writer thread when the file is written, so
+// they are always the latest.
+//
+// The file is replaced atomically: A crash while writing leaves the previous
+// version, never a truncated file.
+class ConfigFileWriter : public QThread {
+  public:
+    typedef std::function<QByteArray()> Serializer;
+
+    ConfigFileWriter(const Serializer& serialize, mixxx::Duration debounce);
+    // Writes a pending request before the thread ends
+    ~ConfigFileWriter() override;
+
+    // Writes the file after the debounce time, which starts again with
+    // every request
+    void requestWrite(const QString& filename);
+    // Drops a pending request, e.g. when the file is written synchronously
+    void cancel();
+
+    // Returns false if the file could not be written, the previous version
+    // is kept then
+    static bool writeFile(const QString& filename, const QByteArray& contents);
+
+  private:
+    void run() override;
+    void writePending();
+
+    const Serializer m_serialize;
+    const mixxx::Duration m_debounce;
+
+    QMutex m_mutex;
+    QWaitCondition m_requested;
+    PerformanceTimer m_clock;
+    bool m_pending;
+    bool m_stop;
+    QString m_filename;
+    mixxx::Duration m_deadline;
+
+    DISALLOW_COPY_AND_ASSIGN(ConfigFileWriter);
+};
+
+#endif // PREFERENCES_CONFIGFILEWRITER_H
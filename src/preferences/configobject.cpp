@@ -6,6 +6,9 @@
 #include <QDir>
 #include <QtDebug>
 
+#include "preferences/configfilewriter.h"
+#include "util/compatibility.h"
+#include "util/memory.h"
 #include "widget/wwidget.h"
 #include "util/cmdlineargs.h"
 #include "util/xml.h"
@@ -13,6 +16,10 @@
 // TODO(rryan): Move to a utility file.
 namespace {
 
+// Long enough to write the changes of a preferences dialog or a burst of
+// control changes at once
+const mixxx::Duration kSaveDebounce = mixxx::Duration::fromMillis(1000);
+
 QString computeResourcePath() {
     // Try to read in the resource directory from the command line
     QString qResourcePath = CmdlineArgs::Instance().getResourcePath();
@@ -150,12 +157,15 @@ template <class ValueType> ConfigObject<ValueType>::ConfigObject(const QString&
 }
 
 template <class ValueType> ConfigObject<ValueType>::~ConfigObject() {
+    // Writes a pending request while the values still exist
+    m_pWriter.reset();
 }
 
 template <class ValueType>
 void ConfigObject<ValueType>::set(const ConfigKey& k, const ValueType& v) {
     QWriteLocker lock(&m_valuesLock);
     m_values.insert(k, v);
+    m_dirty = 1;
 }
 
 template <class ValueType>
@@ -173,7 +183,11 @@ bool ConfigObject<ValueType>::exists(const ConfigKey& k) const {
 template <class ValueType>
 bool ConfigObject<ValueType>::remove(const ConfigKey& k) {
     QWriteLocker lock(&m_valuesLock);
-    return m_values.remove(k) > 0;
+    if (m_values.remove(k) > 0) {
+        m_dirty = 1;
+        return true;
+    }
+    return false;
 }
 
 template <class ValueType>
@@ -227,35 +241,48 @@ template <class ValueType> void ConfigObject<ValueType>::reopen(const QString& f
     }
 }
 
-template <class ValueType> void ConfigObject<ValueType>::save() {
-    QReadLocker lock(&m_valuesLock); // we only read the m_values here.
-    QFile file(m_filename);
-    if (!QDir(QFileInfo(file).absolutePath()).exists()) {
-        QDir().mkpath(QFileInfo(file).absolutePath());
-    }
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qDebug() << "Could not write file" << m_filename << ", don't worry.";
+template <class ValueType> void ConfigObject<ValueType>::requestSave() {
+    if (!load_atomic(m_dirty)) {
         return;
-    } else {
-        QTextStream stream(&file);
-        stream.setCodec("UTF-8");
-
-        QString grp = "";
+    }
+    QMutexLocker locker(&m_writerMutex);
+    if (!m_pWriter) {
+        m_pWriter = std::make_unique<ConfigFileWriter>(
+                [this] { return serialize(); }, kSaveDebounce);
+    }
+    m_pWriter->requestWrite(m_filename);
+}
 
-        typename QMap<ConfigKey, ValueType>::const_iterator i;
-        for (i = m_values.begin(); i != m_values.end(); ++i) {
-            //qDebug() << "group:" << it.key().group << "item" << it.key().item << "val" << it.value()->value;
-            if (i.key().group != grp) {
-                grp = i.key().group;
-                stream << "\n" << grp << "\n";
-            }
-            stream << i.key().item << " " << i.value().value << "\n";
+template <class ValueType> void ConfigObject<ValueType>::save() {
+    {
+        QMutexLocker locker(&m_writerMutex);
+        if (m_pWriter) {
+            m_pWriter->cancel();
         }
-        file.close();
-        if (file.error()!=QFile::NoError) { //could be better... should actually say what the error was..
-            qDebug() << "Error while writing configuration file:" << file.errorString();
+    }
+    ConfigFileWriter::writeFile(m_filename, serialize());
+}
+
+template <class ValueType> QByteArray ConfigObject<ValueType>::serialize() {
+    QReadLocker lock(&m_valuesLock); // we only read the m_values here.
+    m_dirty = 0;
+    QByteArray contents;
+    QTextStream stream(&contents, QIODevice::WriteOnly);
+    stream.setCodec("UTF-8");
+
+    QString grp = "";
+
+    typename QMap<ConfigKey, ValueType>::const_iterator i;
+    for (i = m_values.begin(); i != m_values.end(); ++i) {
+        //qDebug() << "group:" << it.key().group << "item" << it.key().item << "val" << it.value()->value;
+        if (i.key().group != grp) {
+            grp = i.key().group;
+            stream << "\n" << grp << "\n";
         }
+        stream << i.key().item << " " << i.value().value << "\n";
     }
+    stream.flush();
+    return contents;
 }
 
 template <class ValueType> ConfigObject<ValueType>::ConfigObject(const QDomNode& node) {
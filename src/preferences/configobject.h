@@ -7,7 +7,10 @@
 #include <QMap>
 #include <QHash>
 #include <QMetaType>
+#include <QMutex>
 #include <QReadWriteLock>
+#include <QAtomicInt>
+#include <memory>
 
 #include "util/debug.h"
 
@@ -99,6 +102,8 @@ class ConfigValueKbd : public ConfigValue {
     QKeySequence m_qKey;
 };
 
+class ConfigFileWriter;
+
 template <class ValueType> class ConfigObject {
   public:
     ConfigObject(const QString& file);
@@ -146,6 +151,13 @@ template <class ValueType> class ConfigObject {
     QMultiHash<ValueType, ConfigKey> transpose() const;
 
     void reopen(const QString& file);
+
+    // Writes the file in a background thread about a second after the last
+    // request if a value has changed since the last write. This does not
+    // block, so it is safe to call while playing.
+    void requestSave();
+    // Writes the file synchronously, replacing a pending request. Only meant
+    // for shutdown, where the file must be complete before quitting.
     void save();
 
     // Returns the resource path -- the path where controller presets, skins,
@@ -171,6 +183,15 @@ template <class ValueType> class ConfigObject {
     // Loads and parses the configuration file. Returns false if the file could
     // not be opened; otherwise true.
     bool parse();
+
+    // Returns the contents of the file and clears the dirty flag
+    QByteArray serialize();
+
+    // Set when a value is set or removed
+    QAtomicInt m_dirty;
+    // Created by the first requestSave()
+    QMutex m_writerMutex;
+    std::unique_ptr<ConfigFileWriter> m_pWriter;
 };
 
 #endif // PREFERENCES_CONFIGOBJECT_H
@@ -208,7 +208,7 @@ void DlgPrefBeats::slotApply() {
 
     m_pconfig->set(ConfigKey(BPM_CONFIG_KEY, BPM_RANGE_START), ConfigValue(m_minBpm));
     m_pconfig->set(ConfigKey(BPM_CONFIG_KEY, BPM_RANGE_END), ConfigValue(m_maxBpm));
-    m_pconfig->save();
+    m_pconfig->requestSave();
 }
 
 void DlgPrefBeats::populate() {
@@ -222,36 +222,26 @@ void DlgPrefBeats::populate() {
     connect(plugincombo, SIGNAL(currentIndexChanged(int)),
             this, SLOT(pluginSelected(int)));
     mixxx::VampPluginLoader vampPluginLoader;
-    std::vector<PluginLoader::PluginKey> plugins = vampPluginLoader.listPlugins();
-    qDebug() << "VampPluginLoader::listPlugins() returned" << plugins.size() << "plugins";
-    for (unsigned int iplugin=0; iplugin < plugins.size(); iplugin++) {
-        // TODO(XXX): WTF, 48000
-        Plugin *plugin = vampPluginLoader.loadPlugin(plugins[iplugin], 48000);
+    const mixxx::VampPluginLoader::PluginOutputList outputs =
+            vampPluginLoader.listPluginOutputs();
+    qDebug() << "VampPluginLoader::listPluginOutputs() returned" << outputs.size() << "outputs";
+    for (const auto& output : outputs) {
         //TODO: find a way to add beat trackers only
-        if (plugin) {
-            Plugin::OutputList outputs = plugin->getOutputDescriptors();
-            for (unsigned int ioutput=0; ioutput < outputs.size(); ioutput++) {
-                QString displayname = QString::fromStdString(plugin->getIdentifier()) + ":"
-                                            + QString::number(ioutput);
-                QString displaynametext = QString::fromStdString(plugin->getName());
-                qDebug() << "Plugin output displayname:" << displayname << displaynametext;
-                bool goodones = ((displayname.contains("mixxxbpmdetection")||
-                                  displayname.contains("qm-tempotracker:0"))||
-                                 displayname.contains("beatroot:0")||
-                                 displayname.contains("marsyas_ibt:0")||
-                                 displayname.contains("aubiotempo:0"));
-                if (goodones) {
-                    m_listName << displaynametext;
-                    QString pluginlibrary = QString::fromStdString(plugins[iplugin]).section(":",0,0);
-                    m_listLibrary << pluginlibrary;
-                    QString displayname = QString::fromStdString(plugin->getIdentifier()) + ":"
-                            + QString::number(ioutput);
-                    m_listIdentifier << displayname;
-                    plugincombo->addItem(displaynametext, displayname);
-                }
-            }
-            delete plugin;
-            plugin = 0;
+        QString displayname = output.pluginIdentifier + ":"
+                + QString::number(output.outputIndex);
+        QString displaynametext = output.pluginName;
+        qDebug() << "Plugin output displayname:" << displayname << displaynametext;
+        bool goodones = ((displayname.contains("mixxxbpmdetection")||
+                          displayname.contains("qm-tempotracker:0"))||
+                         displayname.contains("beatroot:0")||
+                         displayname.contains("marsyas_ibt:0")||
+                         displayname.contains("aubiotempo:0"));
+        if (goodones) {
+            m_listName << displaynametext;
+            QString pluginlibrary = QString::fromStdString(output.key).section(":",0,0);
+            m_listLibrary << pluginlibrary;
+            m_listIdentifier << displayname;
+            plugincombo->addItem(displaynametext, displayname);
         }
     }
 }
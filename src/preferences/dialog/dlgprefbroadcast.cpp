@@ -554,7 +554,8 @@ void DlgPrefBroadcast::onSectionResized() {
 
     sender()->blockSignals(true);
     connectionList->setColumnWidth(kColumnEnabled, 100);
-    connectionList->setColumnWidth(kColumnName, width * 0.65);
+    connectionList->setColumnWidth(kColumnName, width * 0.35);
+    connectionList->setColumnWidth(kColumnStatus, width * 0.2);
     // The last column is automatically resized to fill
     // the remaining width, thanks to stretchLastSection set to true.
     sender()->blockSignals(false);
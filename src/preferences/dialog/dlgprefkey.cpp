@@ -255,7 +255,7 @@ void DlgPrefKey::slotApply() {
     }
 
     KeyUtils::setNotation(notation);
-    m_pConfig->save();
+    m_pConfig->requestSave();
 }
 
 void DlgPrefKey::slotUpdate() {
@@ -284,33 +284,23 @@ void DlgPrefKey::populate() {
    plugincombo->clear();
    plugincombo->setDuplicatesEnabled(false);
    mixxx::VampPluginLoader vampPluginLoader;
-   std::vector<PluginLoader::PluginKey> plugins = vampPluginLoader.listPlugins();
-   qDebug() << "VampPluginLoader::listPlugins() returned" << plugins.size() << "plugins";
-   for (unsigned int iplugin=0; iplugin < plugins.size(); iplugin++) {
-       // TODO(XXX): WTF, 48000
-       Plugin* plugin = vampPluginLoader.loadPlugin(plugins[iplugin], 48000);
+   const mixxx::VampPluginLoader::PluginOutputList outputs =
+           vampPluginLoader.listPluginOutputs();
+   qDebug() << "VampPluginLoader::listPluginOutputs() returned" << outputs.size() << "outputs";
+   for (const auto& output : outputs) {
        //TODO(XXX): find a general way to add key detectors only
-       if (plugin) {
-           Plugin::OutputList outputs = plugin->getOutputDescriptors();
-           for (unsigned int ioutput=0; ioutput < outputs.size(); ioutput++) {
-               QString displayname = QString::fromStdString(plugin->getIdentifier()) + ":"
-                                           + QString::number(ioutput);
-               QString displaynametext = QString::fromStdString(plugin->getName());
-               qDebug() << "Plugin output displayname:" << displayname << displaynametext;
-               bool goodones = displayname.contains(VAMP_ANALYZER_KEY_DEFAULT_PLUGIN_ID);
-
-               if (goodones) {
-                   m_listName << displaynametext;
-                   QString pluginlibrary = QString::fromStdString(plugins[iplugin]).section(":",0,0);
-                   m_listLibrary << pluginlibrary;
-                   QString displayname = QString::fromStdString(plugin->getIdentifier()) + ":"
-                           + QString::number(ioutput);
-                   m_listIdentifier << displayname;
-                   plugincombo->addItem(displaynametext, displayname);
-               }
-           }
-           delete plugin;
-           plugin = 0;
+       QString displayname = output.pluginIdentifier + ":"
+               + QString::number(output.outputIndex);
+       QString displaynametext = output.pluginName;
+       qDebug() << "Plugin output displayname:" << displayname << displaynametext;
+       bool goodones = displayname.contains(VAMP_ANALYZER_KEY_DEFAULT_PLUGIN_ID);
+
+       if (goodones) {
+           m_listName << displaynametext;
+           QString pluginlibrary = QString::fromStdString(output.key).section(":",0,0);
+           m_listLibrary << pluginlibrary;
+           m_listIdentifier << displayname;
+           plugincombo->addItem(displaynametext, displayname);
        }
    }
 }
@@ -322,7 +322,7 @@ void DlgPrefLibrary::slotApply() {
     }
 
     // TODO(rryan): Don't save here.
-    m_pConfig->save();
+    m_pConfig->requestSave();
 }
 
 void DlgPrefLibrary::slotRowHeightValueChanged(int height) {
@@ -19,6 +19,7 @@
 #include "preferences/dialog/dlgprefsounditem.h"
 #include "engine/enginebuffer.h"
 #include "engine/enginemaster.h"
+#include "engine/engineworkerpool.h"
 #include "mixer/playermanager.h"
 #include "soundio/soundmanager.h"
 #include "soundio/sounddevice.h"
@@ -39,7 +40,8 @@ DlgPrefSound::DlgPrefSound(QWidget* pParent, SoundManager* pSoundManager,
           m_settingsModified(false),
           m_bLatencyChanged(false),
           m_bSkipConfigClear(true),
-          m_loading(false) {
+          m_loading(false),
+          m_bQueryingDevices(false) {
     setupUi(this);
 
     connect(m_pSoundManager, SIGNAL(devicesUpdated()),
@@ -88,6 +90,13 @@ DlgPrefSound::DlgPrefSound(QWidget* pParent, SoundManager* pSoundManager,
                         static_cast<EngineBuffer::KeylockEngine>(i)));
     }
 
+    varispeedComboBox->clear();
+    for (int i = 0; i < EngineBuffer::VARISPEED_ENGINE_COUNT; ++i) {
+        varispeedComboBox->addItem(
+                EngineBuffer::getVarispeedEngineName(
+                        static_cast<EngineBuffer::VarispeedEngine>(i)));
+    }
+
     m_pLatencyCompensation = new ControlProxy("[Master]", "microphoneLatencyCompensation", this);
     m_pMasterDelay = new ControlProxy("[Master]", "delay", this);
     m_pHeadDelay = new ControlProxy("[Master]", "headDelay", this);
@@ -137,6 +146,12 @@ DlgPrefSound::DlgPrefSound(QWidget* pParent, SoundManager* pSoundManager,
             this, SLOT(settingChanged()));
     connect(keylockComboBox, SIGNAL(currentIndexChanged(int)),
             this, SLOT(settingChanged()));
+    connect(varispeedComboBox, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(settingChanged()));
+    connect(engineThreadsSpinBox, SIGNAL(valueChanged(int)),
+            this, SLOT(settingChanged()));
+    connect(workerThreadsSpinBox, SIGNAL(valueChanged(int)),
+            this, SLOT(settingChanged()));
 
     connect(queryButton, SIGNAL(clicked()),
             this, SLOT(queryClicked()));
@@ -178,6 +193,8 @@ DlgPrefSound::DlgPrefSound(QWidget* pParent, SoundManager* pSoundManager,
 
     m_pKeylockEngine =
             new ControlProxy("[Master]", "keylock_engine", this);
+    m_pVarispeedEngine =
+            new ControlProxy("[Master]", "varispeed_engine", this);
 
 #ifdef __LINUX__
     qDebug() << "RLimit Cur " << RLimit::getCurRtPrio();
@@ -230,6 +247,14 @@ void DlgPrefSound::slotApply() {
         m_pKeylockEngine->set(keylockComboBox->currentIndex());
         m_pConfig->set(ConfigKey("[Master]", "keylock_engine"),
                        ConfigValue(keylockComboBox->currentIndex()));
+        m_pVarispeedEngine->set(varispeedComboBox->currentIndex());
+        m_pConfig->set(ConfigKey("[Master]", "varispeed_engine"),
+                       ConfigValue(varispeedComboBox->currentIndex()));
+        // Only read when the engine is created
+        m_pConfig->set(ConfigKey("[Master]", "num_engine_threads"),
+                       ConfigValue(engineThreadsSpinBox->value()));
+        m_pConfig->set(ConfigKey("[Master]", "num_worker_threads"),
+                       ConfigValue(workerThreadsSpinBox->value()));
 
         err = m_pSoundManager->setConfig(m_config);
     }
@@ -418,6 +443,17 @@ void DlgPrefSound::loadSettings(const SoundManagerConfig &config) {
             ConfigKey("[Master]", "keylock_engine"), 1);
     keylockComboBox->setCurrentIndex(keylock_engine);
 
+    // Default varispeed is linear.
+    int varispeed_engine = m_pConfig->getValue(
+            ConfigKey("[Master]", "varispeed_engine"), 0);
+    varispeedComboBox->setCurrentIndex(varispeed_engine);
+
+    engineThreadsSpinBox->setValue(m_pConfig->getValue(
+            ConfigKey("[Master]", "num_engine_threads"), 0));
+    workerThreadsSpinBox->setValue(m_pConfig->getValue(
+            ConfigKey("[Master]", "num_worker_threads"),
+            EngineWorkerPool::defaultNumThreads()));
+
     m_loading = false;
     // DlgPrefSoundItem has it's own inhibit flag 
     emit(loadPaths(m_config));
@@ -549,6 +585,12 @@ void DlgPrefSound::updateAudioBufferSizes(int sampleRateIndex) {
  * just changes and we need to display new devices.
  */
 void DlgPrefSound::refreshDevices() {
+    if (m_bQueryingDevices) {
+        // The query started by queryClicked() has finished
+        m_bQueryingDevices = false;
+        queryButton->setEnabled(true);
+        updateAPIs();
+    }
     if (m_config.getAPI() == "None") {
         m_outputDevices.clear();
         m_inputDevices.clear();
@@ -582,9 +624,11 @@ void DlgPrefSound::deviceSettingChanged() {
  * Slot called when the "Query Devices" button is clicked.
  */
 void DlgPrefSound::queryClicked() {
-    ScopedWaitCursor cursor;
-    m_pSoundManager->clearAndQueryDevices();
-    updateAPIs();
+    // The devices are queried in the background, refreshDevices() is called
+    // when they are available
+    m_bQueryingDevices = true;
+    queryButton->setEnabled(false);
+    m_pSoundManager->clearAndQueryDevicesInBackground();
 }
 
 /**
@@ -596,6 +640,11 @@ void DlgPrefSound::slotResetToDefaults() {
     loadSettings(newConfig);
     keylockComboBox->setCurrentIndex(EngineBuffer::RUBBERBAND);
     m_pKeylockEngine->set(EngineBuffer::RUBBERBAND);
+    varispeedComboBox->setCurrentIndex(EngineBuffer::VARISPEED_LINEAR);
+    m_pVarispeedEngine->set(EngineBuffer::VARISPEED_LINEAR);
+
+    engineThreadsSpinBox->setValue(0);
+    workerThreadsSpinBox->setValue(EngineWorkerPool::defaultNumThreads());
 
     masterMixComboBox->setCurrentIndex(1);
     m_pMasterEnabled->set(1.0);
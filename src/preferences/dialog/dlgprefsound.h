@@ -103,6 +103,7 @@ class DlgPrefSound : public DlgPreferencePage, public Ui::DlgPrefSoundDlg  {
     ControlProxy* m_pBoothDelay;
     ControlProxy* m_pLatencyCompensation;
     ControlProxy* m_pKeylockEngine;
+    ControlProxy* m_pVarispeedEngine;
     ControlProxy* m_pMasterEnabled;
     ControlProxy* m_pMasterMonoMixdown;
     ControlProxy* m_pMicMonitorMode;
@@ -113,6 +114,8 @@ class DlgPrefSound : public DlgPreferencePage, public Ui::DlgPrefSoundDlg  {
     bool m_bSkipConfigClear;
     SoundManagerConfig m_config;
     bool m_loading;
+    // Set by queryClicked() until the devices have been queried
+    bool m_bQueryingDevices;
 };
 
 #endif
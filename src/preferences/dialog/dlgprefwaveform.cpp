@@ -219,9 +219,14 @@ void DlgPrefWaveform::slotSetNormalizeOverview(bool normalize) {
 }
 
 void DlgPrefWaveform::slotWaveformMeasured(float frameRate, int droppedFrames) {
+    const WaveformWidgetFactory* factory = WaveformWidgetFactory::instance();
     frameRateAverage->setText(
             QString::number((double)frameRate, 'f', 2) + " : " +
-            tr("dropped frames") + " " + QString::number(droppedFrames));
+            tr("dropped frames") + " " + QString::number(droppedFrames) + " : " +
+            tr("render time") + " " +
+            factory->getAverageRenderTime().formatMillisWithUnit() + " (" +
+            tr("max") + " " +
+            factory->getMaxRenderTime().formatMillisWithUnit() + ")");
 }
 
 void DlgPrefWaveform::slotClearCachedWaveforms() {
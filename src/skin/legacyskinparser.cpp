@@ -26,6 +26,7 @@
 
 #include "skin/colorschemeparser.h"
 #include "skin/skincontext.h"
+#include "skin/skindocumentcache.h"
 #include "skin/launchimage.h"
 
 #include "effects/effectsmanager.h"
@@ -85,6 +86,7 @@
 #include "util/valuetransformer.h"
 #include "util/cmdlineargs.h"
 #include "util/timer.h"
+#include "util/trace.h"
 
 using mixxx::skin::SkinManifest;
 
@@ -150,7 +152,10 @@ LegacySkinParser::LegacySkinParser(UserSettingsPointer pConfig)
           m_pVCManager(NULL),
           m_pEffectsManager(NULL),
           m_pRecordingManager(NULL),
-          m_pParent(NULL) {
+          m_pParent(NULL),
+          m_bDeferHiddenWidgets(false),
+          m_bDeferNextGroup(false),
+          m_bDeferred(false) {
 }
 
 LegacySkinParser::LegacySkinParser(UserSettingsPointer pConfig,
@@ -169,7 +174,10 @@ LegacySkinParser::LegacySkinParser(UserSettingsPointer pConfig,
           m_pVCManager(pVCMan),
           m_pEffectsManager(pEffectsManager),
           m_pRecordingManager(pRecordingManager),
-          m_pParent(NULL) {
+          m_pParent(NULL),
+          m_bDeferHiddenWidgets(false),
+          m_bDeferNextGroup(false),
+          m_bDeferred(false) {
 }
 
 LegacySkinParser::~LegacySkinParser() {
@@ -200,29 +208,18 @@ QDomElement LegacySkinParser::openSkin(const QString& skinPath) {
     }
 
     QString skinXmlPath = skinDir.filePath("skin.xml");
-    QFile skinXmlFile(skinXmlPath);
-
-    if (!skinXmlFile.open(QIODevice::ReadOnly)) {
+    if (!QFile::exists(skinXmlPath)) {
         qDebug() << "LegacySkinParser::openSkin - can't open file:" << skinXmlPath
                  << "in directory:" << skinDir.path();
         return QDomElement();
     }
 
-    QDomDocument skin("skin");
-
-    QString errorMessage;
-    int errorLine;
-    int errorColumn;
-
-    if (!skin.setContent(&skinXmlFile,&errorMessage,&errorLine,&errorColumn)) {
-        qDebug() << "LegacySkinParser::openSkin - setContent failed see"
-                 << "line:" << errorLine << "column:" << errorColumn;
-        qDebug() << "LegacySkinParser::openSkin - message:" << errorMessage;
-        return QDomElement();
+    // Parsed only once for the launch image and the skin
+    QDomElement skin = SkinDocumentCache::load(skinXmlPath);
+    if (skin.isNull()) {
+        qDebug() << "LegacySkinParser::openSkin - failed to parse" << skinXmlPath;
     }
-
-    skinXmlFile.close();
-    return skin.documentElement();
+    return skin;
 }
 
 // static
@@ -304,10 +301,16 @@ Qt::MouseButton LegacySkinParser::parseButtonState(const QDomNode& node,
 
 QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent) {
     ScopedTimer timer("SkinLoader::parseSkin");
+    Trace trace("LegacySkinParser::parseSkin");
+    PhaseTrace phase("LegacySkinParser::parseSkin");
     qDebug() << "LegacySkinParser loading skin:" << skinPath;
 
-    m_pContext = std::make_unique<SkinContext>(m_pConfig, skinPath + "/skin.xml");
-    m_pContext->setSkinBasePath(skinPath + "/");
+    phase.next("open");
+    m_pRootContext = std::make_shared<SkinContext>(m_pConfig, skinPath + "/skin.xml");
+    m_pRootContext->setSkinBasePath(skinPath + "/");
+    m_pContext = std::make_unique<SkinContext>(*m_pRootContext);
+    m_bDeferHiddenWidgets = m_pConfig->getValue<bool>(
+            ConfigKey("[Config]", "DeferHiddenSkinWidgets"), true);
 
     if (m_pParent) {
         qDebug() << "ERROR: Somehow a parent already exists -- you are probably re-using a LegacySkinParser which is not advisable!";
@@ -319,6 +322,7 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
         return NULL;
     }
 
+    phase.next("attributes");
     SkinManifest manifest = getSkinManifest(skinDocument);
 
     // Keep track of created attribute controls so we can parent them.
@@ -383,6 +387,7 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
     // created parent so MixxxMainWindow can use it for nefarious purposes (
     // fullscreen mostly) --bkgood
     m_pParent = pParent;
+    phase.next("widgets");
     QList<QWidget*> widgets = parseNode(skinDocument);
 
     if (widgets.empty()) {
@@ -657,13 +662,103 @@ void LegacySkinParser::parseChildren(
 
 QWidget* LegacySkinParser::parseWidgetGroup(const QDomElement& node) {
     WWidgetGroup* pGroup = new WWidgetGroup(m_pParent);
+    // Only applies to the group of the page itself
+    const bool hiddenPage = m_bDeferNextGroup;
+    m_bDeferNextGroup = false;
     commonWidgetSetup(node, pGroup);
     pGroup->setup(node, *m_pContext);
     pGroup->Init();
-    parseChildren(node, pGroup);
+    // The connections have already been set up, so a group whose visibility
+    // is bound to a control is hidden by now
+    if (m_bDeferHiddenWidgets && (hiddenPage || pGroup->isHidden()) &&
+            canDeferChildren(node)) {
+        deferChildren(node, pGroup);
+    } else {
+        parseChildren(node, pGroup);
+    }
     return pGroup;
 }
 
+bool LegacySkinParser::canDeferChildren(const QDomElement& node) {
+    QDomElement childrenElement = m_pContext->selectElement(node, "Children");
+    for (QDomElement child = childrenElement.firstChildElement();
+            !child.isNull(); child = child.nextSiblingElement()) {
+        // Would also change the variable for the following siblings
+        if (child.tagName() == "SetVariable") {
+            return false;
+        }
+    }
+    return canDeferDescendants(childrenElement);
+}
+
+bool LegacySkinParser::canDeferDescendants(const QDomElement& element) {
+    for (QDomElement child = element.firstChildElement();
+            !child.isNull(); child = child.nextSiblingElement()) {
+        const QString tagName = child.tagName();
+        // Singletons are looked up by the containers in the whole skin, and
+        // the library widgets are bound to the library while it is loaded
+        if (tagName == "SingletonDefinition" || tagName == "Library" ||
+                tagName == "LibrarySidebar" || tagName == "SearchBox") {
+            return false;
+        }
+        if (tagName == "Template") {
+            const QString path = child.attribute("src");
+            auto it = m_deferrableTemplates.constFind(path);
+            if (it == m_deferrableTemplates.constEnd()) {
+                it = m_deferrableTemplates.insert(
+                        path, canDeferDescendants(loadTemplate(path)));
+            }
+            if (!it.value()) {
+                return false;
+            }
+        }
+        if (!canDeferDescendants(child)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LegacySkinParser::deferChildren(const QDomElement& node,
+                                     WWidgetGroup* pGroup) {
+    std::shared_ptr<LegacySkinParser> pParser;
+    if (m_bDeferred) {
+        pParser = shared_from_this();
+    } else {
+        if (!m_pDeferredParser) {
+            m_pDeferredParser = std::make_shared<LegacySkinParser>(
+                    m_pConfig, m_pKeyboard, m_pPlayerManager,
+                    m_pControllerManager, m_pLibrary, m_pVCManager,
+                    m_pEffectsManager, m_pRecordingManager);
+            m_pDeferredParser->m_pRootContext = m_pRootContext;
+            m_pDeferredParser->m_bDeferHiddenWidgets = m_bDeferHiddenWidgets;
+            m_pDeferredParser->m_bDeferred = true;
+        }
+        pParser = m_pDeferredParser;
+    }
+    const QHash<QString, QString> variables = m_pContext->variables();
+    pGroup->setChildrenBuilder([pParser, node, pGroup, variables]() {
+        pParser->parseDeferredChildren(node, pGroup, variables);
+    });
+}
+
+void LegacySkinParser::parseDeferredChildren(
+        const QDomElement& node,
+        WWidgetGroup* pGroup,
+        const QHash<QString, QString>& variables) {
+    Trace trace("LegacySkinParser::parseDeferredChildren");
+    // Another group might be shown while the children are built
+    std::unique_ptr<SkinContext> pOuterContext = std::move(m_pContext);
+    const SkinContext& parentContext =
+            pOuterContext ? *pOuterContext : *m_pRootContext;
+    m_pContext = std::make_unique<SkinContext>(parentContext);
+    for (auto it = variables.constBegin(); it != variables.constEnd(); ++it) {
+        m_pContext->setVariable(it.key(), it.value());
+    }
+    parseChildren(node, pGroup);
+    m_pContext = std::move(pOuterContext);
+}
+
 QWidget* LegacySkinParser::parseWidgetStack(const QDomElement& node) {
     bool createdNext = false;
     ControlObject* pNextControl = controlFromConfigNode(
@@ -705,6 +800,10 @@ QWidget* LegacySkinParser::parseWidgetStack(const QDomElement& node) {
     QWidget* pOldParent = m_pParent;
     m_pParent = pStack;
 
+    // The page that the stack shows first, see WWidgetStack::showEvent()
+    const int initialPage = pCurrentPageControl ?
+            static_cast<int>(pCurrentPageControl->get()) : 0;
+
     QDomNode childrenNode = m_pContext->selectNode(node, "Children");
     if (!childrenNode.isNull()) {
         // Descend chilren
@@ -718,7 +817,11 @@ QWidget* LegacySkinParser::parseWidgetStack(const QDomElement& node) {
             }
             QDomElement element = node.toElement();
 
+            // The pages that are not shown initially are built when they
+            // are shown for the first time
+            m_bDeferNextGroup = pStack->count() != initialPage;
             QList<QWidget*> child_widgets = parseNode(element);
+            m_bDeferNextGroup = false;
 
             if (child_widgets.empty()) {
                 SKIN_WARNING(node, *m_pContext)
@@ -1477,37 +1580,9 @@ QString LegacySkinParser::getLibraryStyle(const QDomNode& node) {
 }
 
 QDomElement LegacySkinParser::loadTemplate(const QString& path) {
-    QFileInfo templateFileInfo(path);
-
-    QString absolutePath = templateFileInfo.absoluteFilePath();
-
-    QHash<QString, QDomElement>::const_iterator it =
-            m_templateCache.find(absolutePath);
-    if (it != m_templateCache.end()) {
-        return it.value();
-    }
-
-    QFile templateFile(absolutePath);
-
-    if (!templateFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Could not open template file:" << absolutePath;
-    }
-
-    QDomDocument tmpl("template");
-    QString errorMessage;
-    int errorLine;
-    int errorColumn;
-
-    if (!tmpl.setContent(&templateFile, &errorMessage,
-                         &errorLine, &errorColumn)) {
-        qWarning() << "LegacySkinParser::loadTemplate - setContent failed see"
-                   << absolutePath << "line:" << errorLine << "column:" << errorColumn;
-        qWarning() << "LegacySkinParser::loadTemplate - message:" << errorMessage;
-        return QDomElement();
-    }
-
-    m_templateCache[absolutePath] = tmpl.documentElement();
-    return tmpl.documentElement();
+    // Each template is parsed only once, even if it is instantiated many
+    // times or the skin is reloaded
+    return SkinDocumentCache::load(path);
 }
 
 QList<QWidget*> LegacySkinParser::parseTemplate(const QDomElement& node) {
@@ -1519,6 +1594,7 @@ QList<QWidget*> LegacySkinParser::parseTemplate(const QDomElement& node) {
     }
 
     QString path = node.attribute("src");
+    Trace trace("LegacySkinParser::parseTemplate %1", path);
 
     QDomElement templateNode = loadTemplate(path);
 
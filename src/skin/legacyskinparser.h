@@ -5,6 +5,7 @@
 #include <QString>
 #include <QList>
 #include <QDomElement>
+#include <QHash>
 #include <QMutex>
 
 #include "preferences/usersettings.h"
@@ -27,7 +28,8 @@ class ControlObject;
 class LaunchImage;
 class WWidgetGroup;
 
-class LegacySkinParser : public QObject, public SkinParser {
+class LegacySkinParser : public QObject, public SkinParser,
+        public std::enable_shared_from_this<LegacySkinParser> {
     Q_OBJECT
   public:
     LegacySkinParser(UserSettingsPointer pConfig);
@@ -136,6 +138,18 @@ class LegacySkinParser : public QObject, public SkinParser {
     QString parseLaunchImageStyle(const QDomNode& node);
     void parseChildren(const QDomElement& node, WWidgetGroup* pGroup);
 
+    // The children of a widget group that starts hidden, e.g. a page of a
+    // WidgetStack that is not shown or a group whose visibility is bound to
+    // a control, are only built when the group is shown for the first time.
+    // The children must neither define skin variables for the siblings of
+    // the group nor contain widgets that have to exist when the skin has
+    // been loaded.
+    bool canDeferChildren(const QDomElement& node);
+    bool canDeferDescendants(const QDomElement& element);
+    void deferChildren(const QDomElement& node, WWidgetGroup* pGroup);
+    void parseDeferredChildren(const QDomElement& node, WWidgetGroup* pGroup,
+                               const QHash<QString, QString>& variables);
+
     UserSettingsPointer m_pConfig;
     KeyboardEventFilter* m_pKeyboard;
     PlayerManager* m_pPlayerManager;
@@ -145,9 +159,19 @@ class LegacySkinParser : public QObject, public SkinParser {
     EffectsManager* m_pEffectsManager;
     RecordingManager* m_pRecordingManager;
     QWidget* m_pParent;
+    // The context of the whole skin that the deferred children are parsed
+    // in, must outlive m_pContext
+    std::shared_ptr<SkinContext> m_pRootContext;
     std::unique_ptr<SkinContext> m_pContext;
     Tooltips m_tooltips;
-    QHash<QString, QDomElement> m_templateCache;
+    bool m_bDeferHiddenWidgets;
+    // Set while the group of a hidden WidgetStack page is parsed
+    bool m_bDeferNextGroup;
+    // Whether this parser builds the deferred children of a loaded skin
+    bool m_bDeferred;
+    // Shared by all deferred children of the skin
+    std::shared_ptr<LegacySkinParser> m_pDeferredParser;
+    QHash<QString, bool> m_deferrableTemplates;
     static QList<const char*> s_channelStrs;
     static QMutex s_safeStringMutex;
 };
@@ -0,0 +1,117 @@
+#include "skin/skindocumentcache.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrentRun>
+#include <QtDebug>
+
+#include "util/timer.h"
+#include "util/trace.h"
+
+namespace {
+
+struct Entry {
+    Entry() : size(-1) {}
+    QDateTime lastModified;
+    qint64 size;
+    QDomDocument document;
+};
+
+QMutex s_mutex;
+QHash<QString, Entry> s_entries;
+QFuture<void> s_preload;
+
+bool isUpToDate(const Entry& entry, const QFileInfo& fileInfo) {
+    return entry.size == fileInfo.size() &&
+            entry.lastModified == fileInfo.lastModified();
+}
+
+void preloadSkin(const QString& skinPath) {
+    ScopedTimer timer("SkinDocumentCache::preloadSkin");
+    Trace trace("SkinDocumentCache::preloadSkin");
+    QDirIterator it(skinPath, QStringList() << "*.xml", QDir::Files,
+            QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        SkinDocumentCache::load(it.next());
+    }
+}
+
+} // anonymous namespace
+
+// static
+QDomElement SkinDocumentCache::load(const QString& filePath) {
+    const QFileInfo fileInfo(filePath);
+    // Also resolves the skin: search path of templates
+    const QString canonicalPath = fileInfo.canonicalFilePath();
+    if (canonicalPath.isEmpty()) {
+        qWarning() << "SkinDocumentCache - file does not exist:" << filePath;
+        return QDomElement();
+    }
+
+    QMutexLocker locker(&s_mutex);
+    auto it = s_entries.constFind(canonicalPath);
+    if (it != s_entries.constEnd() && isUpToDate(it.value(), fileInfo)) {
+        return it.value().document.documentElement();
+    }
+    locker.unlock();
+
+    QFile file(canonicalPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "SkinDocumentCache - could not open file:" << canonicalPath;
+        return QDomElement();
+    }
+    Entry entry;
+    entry.lastModified = fileInfo.lastModified();
+    entry.size = fileInfo.size();
+    QString errorMessage;
+    int errorLine;
+    int errorColumn;
+    if (!entry.document.setContent(&file, &errorMessage,
+                                   &errorLine, &errorColumn)) {
+        qWarning() << "SkinDocumentCache - setContent failed see"
+                   << canonicalPath << "line:" << errorLine << "column:" << errorColumn;
+        qWarning() << "SkinDocumentCache - message:" << errorMessage;
+        return QDomElement();
+    }
+
+    locker.relock();
+    s_entries.insert(canonicalPath, entry);
+    return entry.document.documentElement();
+}
+
+// static
+void SkinDocumentCache::preloadInBackground(const QString& skinPath) {
+    const QString canonicalSkinPath = QDir(skinPath).canonicalPath();
+    if (canonicalSkinPath.isEmpty()) {
+        return;
+    }
+    // Follows a preloading that is still running
+    waitForPreload();
+
+    QMutexLocker locker(&s_mutex);
+    const QString skinDirPrefix = canonicalSkinPath + "/";
+    for (auto it = s_entries.begin(); it != s_entries.end();) {
+        if (it.key().startsWith(skinDirPrefix)) {
+            ++it;
+        } else {
+            it = s_entries.erase(it);
+        }
+    }
+    s_preload = QtConcurrent::run(&preloadSkin, canonicalSkinPath);
+}
+
+// static
+void SkinDocumentCache::waitForPreload() {
+    QMutexLocker locker(&s_mutex);
+    QFuture<void> preload = s_preload;
+    locker.unlock();
+    preload.waitForFinished();
+}
@@ -0,0 +1,32 @@
+#ifndef SKIN_SKINDOCUMENTCACHE_H
+#define SKIN_SKINDOCUMENTCACHE_H
+
+#include <QDomElement>
+#include <QString>
+
+// Keeps the parsed XML documents of a skin, i.e. skin.xml and its templates,
+// for all LegacySkinParsers, so loading the launch image, the skin and
+// reloading the skin parses each file only once. A document is parsed again
+// when its file has been modified.
+//
+// The documents of the skin are parsed in the background while Mixxx starts,
+// see preloadInBackground(). The documents must not be modified.
+//
+// All functions are thread-safe.
+class SkinDocumentCache {
+  public:
+    // Returns the root element of the XML file, or a null element if the
+    // file can't be read or parsed.
+    static QDomElement load(const QString& filePath);
+
+    // Parses all XML files of the skin in a thread of the global thread
+    // pool. The documents of other skins are dropped.
+    static void preloadInBackground(const QString& skinPath);
+    // Waits until the background preloading has finished
+    static void waitForPreload();
+
+  private:
+    SkinDocumentCache() = delete;
+};
+
+#endif // SKIN_SKINDOCUMENTCACHE_H
@@ -11,20 +11,27 @@
 
 #include "vinylcontrol/vinylcontrolmanager.h"
 #include "skin/legacyskinparser.h"
+#include "skin/skindocumentcache.h"
 #include "controllers/controllermanager.h"
 #include "library/library.h"
 #include "effects/effectsmanager.h"
 #include "mixer/playermanager.h"
+#include "util/cmdlineargs.h"
 #include "util/debug.h"
 #include "skin/launchimage.h"
 #include "util/timer.h"
+#include "util/trace.h"
+#include "widget/svgrastercache.h"
 #include "recording/recordingmanager.h"
 
 SkinLoader::SkinLoader(UserSettingsPointer pConfig) :
         m_pConfig(pConfig) {
+    SvgRasterCache::setCacheDirectory(
+            QDir(m_pConfig->getSettingsPath()).filePath("pixmapcache"));
 }
 
 SkinLoader::~SkinLoader() {
+    SkinDocumentCache::waitForPreload();
     LegacySkinParser::freeChannelStrings();
 }
 
@@ -57,7 +64,11 @@ QString SkinLoader::getSkinPath(const QString& skinName) const {
 }
 
 QString SkinLoader::getConfiguredSkinPath() const {
-    QString configSkin = m_pConfig->getValueString(ConfigKey("[Config]", "ResizableSkin"));
+    // The skin of the command line is not saved in the config
+    QString configSkin = CmdlineArgs::Instance().getSkin();
+    if (configSkin.isEmpty()) {
+        configSkin = m_pConfig->getValueString(ConfigKey("[Config]", "ResizableSkin"));
+    }
 
     // If we don't have a skin defined, we might be migrating from 1.11 and
     // should pick the closest-possible skin.
@@ -96,6 +107,7 @@ QWidget* SkinLoader::loadConfiguredSkin(QWidget* pParent,
                                         EffectsManager* pEffectsManager,
                                         RecordingManager* pRecordingManager) {
     ScopedTimer timer("SkinLoader::loadConfiguredSkin");
+    Trace trace("SkinLoader::loadConfiguredSkin");
     QString skinPath = getConfiguredSkinPath();
 
     // If we don't have a skin path then fail.
@@ -103,6 +115,8 @@ QWidget* SkinLoader::loadConfiguredSkin(QWidget* pParent,
         return NULL;
     }
 
+    // The files are not parsed twice if the preloading is still running
+    SkinDocumentCache::waitForPreload();
     LegacySkinParser legacy(m_pConfig, pKeyboard, pPlayerManager,
                             pControllerManager, pLibrary, pVCMan,
                             pEffectsManager, pRecordingManager);
@@ -111,6 +125,8 @@ QWidget* SkinLoader::loadConfiguredSkin(QWidget* pParent,
 
 LaunchImage* SkinLoader::loadLaunchImage(QWidget* pParent) {
     QString skinPath = getConfiguredSkinPath();
+    // The skin is parsed while the launch image is shown and Mixxx starts
+    SkinDocumentCache::preloadInBackground(skinPath);
     LegacySkinParser parser(m_pConfig);
     LaunchImage* pLaunchImage = parser.parseLaunchImage(skinPath, pParent);
     if (pLaunchImage == nullptr) {
@@ -0,0 +1,130 @@
+#include "soundio/driftresampler.h"
+
+#include <algorithm>
+
+#include "util/assert.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+// The fill level error is measured in chunks and low pass filtered, because
+// it jumps by one chunk whenever a callback overtakes the other.
+const double kErrorSmoothing = 0.05;
+
+// The gains are chosen for a critically damped loop with a time constant of
+// about 2000 callbacks, a few seconds at the usual latencies.
+const double kProportionalGain = 1e-3;
+const double kIntegralGain = 2.5e-7;
+
+// Frames that are kept for the interpolation before the next output frame
+const SINT kHistoryFrames = 1;
+
+inline CSAMPLE interpolateHermite(CSAMPLE y0, CSAMPLE y1, CSAMPLE y2,
+        CSAMPLE y3, double t) {
+    const double c1 = 0.5 * (y2 - y0);
+    const double c2 = y0 - 2.5 * y1 + 2.0 * y2 - 0.5 * y3;
+    const double c3 = 0.5 * (y3 - y0) + 1.5 * (y1 - y2);
+    return static_cast<CSAMPLE>(((c3 * t + c2) * t + c1) * t + y1);
+}
+
+} // anonymous namespace
+
+const double DriftResampler::kMaxDeviation = 0.002;
+
+DriftResampler::DriftResampler(int channelCount, SINT maxFramesPerBuffer)
+        : m_channelCount(channelCount),
+          // The frames of the previous call that are not yet consumed and
+          // the jitter between the ratio of two calls
+          m_buffer((2 * maxFramesPerBuffer + 4) * channelCount),
+          m_bufferFrames(0),
+          m_position(0.0),
+          m_ratio(1.0),
+          m_filteredError(0.0),
+          m_integral(0.0) {
+    reset();
+}
+
+void DriftResampler::reset() {
+    // A single frame of silence before the first input frame, so that the
+    // first output frame is the first input frame.
+    SampleUtil::clear(m_buffer.data(), kHistoryFrames * m_channelCount);
+    m_bufferFrames = kHistoryFrames;
+    m_position = kHistoryFrames;
+    m_ratio = 1.0;
+    m_filteredError = 0.0;
+    m_integral = 0.0;
+}
+
+void DriftResampler::updateRatio(SINT fillFrames, SINT targetFrames,
+        SINT framesPerBuffer) {
+    VERIFY_OR_DEBUG_ASSERT(framesPerBuffer > 0) {
+        return;
+    }
+    const double error = static_cast<double>(fillFrames - targetFrames) /
+            framesPerBuffer;
+    m_filteredError += kErrorSmoothing * (error - m_filteredError);
+    m_integral = math_clamp(m_integral + kIntegralGain * m_filteredError,
+            -kMaxDeviation, kMaxDeviation);
+    m_ratio = 1.0 + math_clamp(
+            kProportionalGain * m_filteredError + m_integral,
+            -kMaxDeviation, kMaxDeviation);
+}
+
+SINT DriftResampler::inputFramesRequired(SINT outputFrames) const {
+    if (outputFrames <= 0) {
+        return 0;
+    }
+    // The interpolation of the last output frame reads two frames ahead
+    const SINT lastIndex = static_cast<SINT>(
+            m_position + (outputFrames - 1) * m_ratio);
+    return math_max<SINT>(0, lastIndex + 3 - m_bufferFrames);
+}
+
+SINT DriftResampler::process(const CSAMPLE* pInput, SINT inputFrames,
+        CSAMPLE* pOutput, SINT maxOutputFrames) {
+    const SINT capacityFrames = m_buffer.size() / m_channelCount;
+    VERIFY_OR_DEBUG_ASSERT(m_bufferFrames + inputFrames <= capacityFrames) {
+        inputFrames = capacityFrames - m_bufferFrames;
+    }
+    SampleUtil::copy(m_buffer.data(m_bufferFrames * m_channelCount), pInput,
+            inputFrames * m_channelCount);
+    m_bufferFrames += inputFrames;
+
+    // The positions are computed like in inputFramesRequired() and not
+    // accumulated, so both agree on the number of frames that are needed.
+    const double startPosition = m_position;
+    SINT outputFrames = 0;
+    while (outputFrames < maxOutputFrames) {
+        const double position = startPosition + outputFrames * m_ratio;
+        const SINT index = static_cast<SINT>(position);
+        if (index + 2 >= m_bufferFrames) {
+            break;
+        }
+        const double t = position - index;
+        const CSAMPLE* pFrame0 = m_buffer.data((index - 1) * m_channelCount);
+        const CSAMPLE* pFrame1 = pFrame0 + m_channelCount;
+        const CSAMPLE* pFrame2 = pFrame1 + m_channelCount;
+        const CSAMPLE* pFrame3 = pFrame2 + m_channelCount;
+        for (int i = 0; i < m_channelCount; ++i) {
+            pOutput[i] = interpolateHermite(
+                    pFrame0[i], pFrame1[i], pFrame2[i], pFrame3[i], t);
+        }
+        pOutput += m_channelCount;
+        ++outputFrames;
+    }
+    m_position = startPosition + outputFrames * m_ratio;
+
+    // Drop the frames that are no longer needed for the interpolation
+    const SINT consumedFrames = math_min(
+            static_cast<SINT>(m_position) - kHistoryFrames, m_bufferFrames);
+    if (consumedFrames > 0) {
+        CSAMPLE* pBuffer = m_buffer.data();
+        std::copy(pBuffer + consumedFrames * m_channelCount,
+                pBuffer + m_bufferFrames * m_channelCount,
+                pBuffer);
+        m_bufferFrames -= consumedFrames;
+        m_position -= consumedFrames;
+    }
+    return outputFrames;
+}
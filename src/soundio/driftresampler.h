@@ -0,0 +1,67 @@
+#ifndef DRIFTRESAMPLER_H
+#define DRIFTRESAMPLER_H
+
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+// Resamples the audio that is passed between the clock reference device and
+// another sound device by a ratio close to 1, to compensate the drift between
+// their crystal clocks without dropping or duplicating frames.
+//
+// The ratio is controlled by a PI loop on the fill level of the FIFO between
+// the two devices, so it follows the actual clock difference of the devices.
+// The fill level jitters by a whole chunk when the order of the callbacks
+// changes, so it is low pass filtered and the ratio is changed slowly enough
+// that the pitch change is inaudible.
+//
+// The samples are interpolated with a 4 point cubic Hermite spline. All
+// buffers are allocated in the constructor, so process() can be called from
+// the audio callback.
+class DriftResampler {
+  public:
+    // maxFramesPerBuffer is the largest number of frames that is passed to
+    // or requested from process() at a time.
+    DriftResampler(int channelCount, SINT maxFramesPerBuffer);
+
+    // Starts again with ratio 1 and silence in the history
+    void reset();
+
+    // Adjusts the ratio from the current fill level of the FIFO, in frames.
+    // Both are compared with targetFrames, the fill level that leaves the
+    // same room for jitter in both directions. A FIFO that is fuller than the
+    // target is drained by consuming more input frames per output frame.
+    void updateRatio(SINT fillFrames, SINT targetFrames, SINT framesPerBuffer);
+
+    // The number of input frames consumed per output frame
+    double ratio() const {
+        return m_ratio;
+    }
+
+    // The number of input frames that need to be passed to process() to
+    // produce outputFrames frames
+    SINT inputFramesRequired(SINT outputFrames) const;
+
+    // Appends inputFrames frames from pInput and writes up to
+    // maxOutputFrames resampled frames to pOutput. Returns the number of
+    // frames written.
+    SINT process(const CSAMPLE* pInput, SINT inputFrames,
+            CSAMPLE* pOutput, SINT maxOutputFrames);
+
+    // The largest ratio deviation from 1, 2000 ppm. This is far more than
+    // the drift of crystal clocks, but allows to catch up a jitter quickly.
+    static const double kMaxDeviation;
+
+  private:
+    const int m_channelCount;
+    // The input frames from the frame before m_position on
+    mixxx::SampleBuffer m_buffer;
+    SINT m_bufferFrames;
+    // The position of the next output frame in m_buffer, in [1, 2) between
+    // calls to process()
+    double m_position;
+    double m_ratio;
+    double m_filteredError;
+    double m_integral;
+};
+
+#endif // DRIFTRESAMPLER_H
@@ -0,0 +1,409 @@
+#include "soundio/sounddevicejack.h"
+
+#include <QtDebug>
+
+#include "control/controlobject.h"
+#include "control/controlproxy.h"
+#include "engine/callbackprofiler.h"
+#include "soundio/soundmanager.h"
+#include "soundio/soundmanagerutil.h"
+#include "util/denormalsarezero.h"
+#include "util/math.h"
+#include "util/sample.h"
+#include "util/threadroles.h"
+#include "util/trace.h"
+#include "util/version.h"
+#include "waveform/visualplayposition.h"
+
+namespace {
+
+const int kCpuUsageUpdateRate = 30; // in 1/s, fits to display frame rate
+
+// Counts the physical ports of the server with the given flags, as seen from
+// the server: the playback ports of the sound cards are inputs.
+int countPhysicalPorts(jack_client_t* pClient, unsigned long flags) {
+    const char** ports = jack_get_ports(
+            pClient, NULL, JACK_DEFAULT_AUDIO_TYPE, JackPortIsPhysical | flags);
+    if (!ports) {
+        return 0;
+    }
+    int count = 0;
+    while (ports[count]) {
+        ++count;
+    }
+    jack_free(ports);
+    return count;
+}
+
+inline CSAMPLE* portBuffer(jack_port_t* pPort, jack_nframes_t nframes) {
+    return static_cast<CSAMPLE*>(jack_port_get_buffer(pPort, nframes));
+}
+
+} // anonymous namespace
+
+SoundDeviceJack::SoundDeviceJack(UserSettingsPointer config, SoundManager* sm,
+        int numOutputChannels, int numInputChannels,
+        unsigned int sampleRate)
+        : SoundDevice(config, sm),
+          m_pClient(NULL),
+          m_serverSampleRate(sampleRate),
+          m_bShutdown(false),
+          m_bThreadRoleApplied(false),
+          m_callbackEntryToDacSecs(0),
+          m_framesSinceAudioLatencyUsageUpdate(0) {
+    // Setting parent class members:
+    m_hostAPI = MIXXX_JACK_NATIVE_STRING;
+    m_dSampleRate = sampleRate;
+    m_strInternalName = kJackDeviceInternalName;
+    m_strDisplayName = QObject::tr("JACK server");
+    m_iNumInputChannels = numInputChannels;
+    m_iNumOutputChannels = numOutputChannels;
+
+    m_pMasterAudioLatencyUsage = new ControlProxy("[Master]",
+            "audio_latency_usage");
+}
+
+SoundDeviceJack::~SoundDeviceJack() {
+    close();
+    delete m_pMasterAudioLatencyUsage;
+}
+
+// static
+bool SoundDeviceJack::queryServer(int* pNumOutputChannels,
+        int* pNumInputChannels, unsigned int* pSampleRate) {
+    jack_status_t status;
+    jack_client_t* pClient = jack_client_open(
+            Version::applicationName().toLocal8Bit().constData(),
+            JackNoStartServer, &status);
+    if (!pClient) {
+        qDebug() << "No JACK server running, status" << status;
+        return false;
+    }
+    *pNumOutputChannels = countPhysicalPorts(pClient, JackPortIsInput);
+    *pNumInputChannels = countPhysicalPorts(pClient, JackPortIsOutput);
+    *pSampleRate = jack_get_sample_rate(pClient);
+    jack_client_close(pClient);
+    return true;
+}
+
+SoundDeviceError SoundDeviceJack::open(bool isClkRefDevice, int syncBuffers) {
+    Q_UNUSED(syncBuffers);
+    qDebug() << "SoundDeviceJack::open()" << getInternalName();
+
+    if (m_audioOutputs.empty() && m_audioInputs.empty()) {
+        m_lastError = QString::fromAscii(
+                "No inputs or outputs in SDJ::open() "
+                "(THIS IS A BUG, this should be filtered by SM::setupDevices)");
+        return SOUNDDEVICE_ERROR_ERR;
+    }
+    if (!isClkRefDevice) {
+        m_lastError = QObject::tr(
+                "The JACK server must be used for the main output, "
+                "it can not be synchronized to another sound device.");
+        return SOUNDDEVICE_ERROR_ERR;
+    }
+
+    jack_status_t status;
+    m_pClient = jack_client_open(
+            Version::applicationName().toLocal8Bit().constData(),
+            JackNoStartServer, &status);
+    if (!m_pClient) {
+        qWarning() << "JACK: Error opening client, status" << status;
+        m_lastError = QObject::tr("Could not connect to the JACK server.");
+        return SOUNDDEVICE_ERROR_ERR;
+    }
+
+    // The server decides about the sample rate and the period size
+    const jack_nframes_t sampleRate = jack_get_sample_rate(m_pClient);
+    if (sampleRate != m_dSampleRate) {
+        m_lastError = QObject::tr(
+                "The JACK server runs at a sample rate of %1 Hz.")
+                .arg(sampleRate);
+        close();
+        return SOUNDDEVICE_ERROR_ERR;
+    }
+
+    int numOutputPorts = 0;
+    foreach (AudioOutput out, m_audioOutputs) {
+        ChannelGroup channelGroup = out.getChannelGroup();
+        numOutputPorts = math_max(numOutputPorts,
+                channelGroup.getChannelBase() + channelGroup.getChannelCount());
+    }
+    int numInputPorts = 0;
+    foreach (AudioInput in, m_audioInputs) {
+        ChannelGroup channelGroup = in.getChannelGroup();
+        numInputPorts = math_max(numInputPorts,
+                channelGroup.getChannelBase() + channelGroup.getChannelCount());
+    }
+    if (!registerPorts(numOutputPorts, JackPortIsOutput, &m_outputPorts) ||
+            !registerPorts(numInputPorts, JackPortIsInput, &m_inputPorts)) {
+        m_lastError = QObject::tr("Could not register the JACK ports.");
+        close();
+        return SOUNDDEVICE_ERROR_ERR;
+    }
+    m_silentOutputPorts.clear();
+    for (int i = 0; i < numOutputPorts; ++i) {
+        m_silentOutputPorts.append(i);
+    }
+    foreach (AudioOutput out, m_audioOutputs) {
+        ChannelGroup channelGroup = out.getChannelGroup();
+        for (int i = 0; i < channelGroup.getChannelCount(); ++i) {
+            m_silentOutputPorts.removeOne(channelGroup.getChannelBase() + i);
+        }
+    }
+
+    m_bShutdown = false;
+    m_bThreadRoleApplied = false;
+    jack_set_process_callback(m_pClient, processCallback, this);
+    jack_set_xrun_callback(m_pClient, xrunCallback, this);
+    jack_on_shutdown(m_pClient, shutdownCallback, this);
+
+    m_clkRefTimer.start();
+    if (jack_activate(m_pClient)) {
+        m_lastError = QObject::tr("Could not activate the JACK client.");
+        close();
+        return SOUNDDEVICE_ERROR_ERR;
+    }
+    connectPhysicalPorts();
+
+    const jack_nframes_t periodFrames = jack_get_buffer_size(m_pClient);
+    jack_latency_range_t range;
+    range.min = 0;
+    range.max = 0;
+    if (!m_outputPorts.isEmpty()) {
+        jack_port_get_latency_range(m_outputPorts.first(),
+                JackPlaybackLatency, &range);
+    }
+    m_callbackEntryToDacSecs = (periodFrames + range.max) / m_dSampleRate;
+    const double bufferMSec = periodFrames / m_dSampleRate * 1000;
+    qDebug() << "JACK: Activated client with" << periodFrames
+             << "frames per period, latency:"
+             << m_callbackEntryToDacSecs * 1000 << "ms";
+
+    // Update the samplerate and latency ControlObjects, which allow the
+    // waveform view to properly correct for the latency.
+    ControlObject::set(ConfigKey("[Master]", "latency"),
+            m_callbackEntryToDacSecs * 1000);
+    ControlObject::set(ConfigKey("[Master]", "samplerate"), m_dSampleRate);
+    ControlObject::set(ConfigKey("[Master]", "audio_buffer_size"), bufferMSec);
+    return SOUNDDEVICE_ERROR_OK;
+}
+
+bool SoundDeviceJack::registerPorts(int numPorts, unsigned long flags,
+        QVector<jack_port_t*>* pPorts) {
+    const char* prefix = (flags & JackPortIsOutput) ? "out_" : "in_";
+    for (int i = 0; i < numPorts; ++i) {
+        const QByteArray name = QString("%1%2").arg(prefix).arg(i + 1).toLatin1();
+        jack_port_t* pPort = jack_port_register(m_pClient, name.constData(),
+                JACK_DEFAULT_AUDIO_TYPE, flags, 0);
+        if (!pPort) {
+            qWarning() << "JACK: Error registering port" << name;
+            return false;
+        }
+        pPorts->append(pPort);
+    }
+    return true;
+}
+
+void SoundDeviceJack::connectPhysicalPorts() {
+    // Our outputs go to the physical playback ports, which are inputs of the
+    // server and our inputs come from the physical capture ports.
+    const char** playbackPorts = jack_get_ports(m_pClient, NULL,
+            JACK_DEFAULT_AUDIO_TYPE, JackPortIsPhysical | JackPortIsInput);
+    if (playbackPorts) {
+        for (int i = 0; i < m_outputPorts.size() && playbackPorts[i]; ++i) {
+            if (jack_connect(m_pClient, jack_port_name(m_outputPorts[i]),
+                    playbackPorts[i])) {
+                qWarning() << "JACK: Error connecting to" << playbackPorts[i];
+            }
+        }
+        jack_free(playbackPorts);
+    }
+    const char** capturePorts = jack_get_ports(m_pClient, NULL,
+            JACK_DEFAULT_AUDIO_TYPE, JackPortIsPhysical | JackPortIsOutput);
+    if (capturePorts) {
+        for (int i = 0; i < m_inputPorts.size() && capturePorts[i]; ++i) {
+            if (jack_connect(m_pClient, capturePorts[i],
+                    jack_port_name(m_inputPorts[i]))) {
+                qWarning() << "JACK: Error connecting from" << capturePorts[i];
+            }
+        }
+        jack_free(capturePorts);
+    }
+}
+
+bool SoundDeviceJack::isOpen() const {
+    return m_pClient != NULL;
+}
+
+SoundDeviceError SoundDeviceJack::close() {
+    //qDebug() << "SoundDeviceJack::close()" << getInternalName();
+    jack_client_t* pClient = m_pClient;
+    m_pClient = NULL;
+    if (!pClient) {
+        return SOUNDDEVICE_ERROR_OK;
+    }
+    // The ports are unregistered when the client is closed and the process
+    // callback is no longer called once jack_deactivate() returns.
+    if (!m_bShutdown && jack_deactivate(pClient)) {
+        qWarning() << "JACK: Error deactivating client" << getInternalName();
+    }
+    m_outputPorts.clear();
+    m_inputPorts.clear();
+    if (jack_client_close(pClient)) {
+        qWarning() << "JACK: Error closing client" << getInternalName();
+        return SOUNDDEVICE_ERROR_ERR;
+    }
+    return SOUNDDEVICE_ERROR_OK;
+}
+
+QString SoundDeviceJack::getError() const {
+    return m_lastError;
+}
+
+void SoundDeviceJack::readProcess() {
+    // Only called for devices that are not the clock reference
+}
+
+void SoundDeviceJack::writeProcess() {
+    // Only called for devices that are not the clock reference
+}
+
+// static
+int SoundDeviceJack::processCallback(jack_nframes_t nframes, void* pArg) {
+    return static_cast<SoundDeviceJack*>(pArg)->process(nframes);
+}
+
+// static
+int SoundDeviceJack::xrunCallback(void* pArg) {
+    SoundDeviceJack* pDevice = static_cast<SoundDeviceJack*>(pArg);
+    pDevice->m_pSoundManager->underflowHappened(12);
+    return 0;
+}
+
+// static
+void SoundDeviceJack::shutdownCallback(void* pArg) {
+    SoundDeviceJack* pDevice = static_cast<SoundDeviceJack*>(pArg);
+    // The client can only be closed from here on
+    pDevice->m_bShutdown = true;
+    qWarning() << "JACK: The server has shut down" << pDevice->getInternalName();
+}
+
+int SoundDeviceJack::process(jack_nframes_t nframes) {
+    // JACK provides the period timing of its sound cards, so the entry of
+    // each callback is the same time before the DAC.
+    m_clkRefTimer.restart();
+    VisualPlayPosition::setCallbackEntryToDacSecs(
+            m_callbackEntryToDacSecs, m_clkRefTimer);
+
+    Trace trace("SoundDeviceJack::process %1", getInternalName());
+
+    // The JACK process thread is created by the server and may not have the
+    // denormals flags set.
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+#ifdef __SSE__
+    _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+#endif
+    if (!m_bThreadRoleApplied) {
+        mixxx::ThreadRoles::applyToCurrentThread(
+                mixxx::ThreadRole::AudioCallback);
+        m_bThreadRoleApplied = true;
+    }
+
+    CallbackProfiler* pCallbackProfiler = m_pSoundManager->getCallbackProfiler();
+    pCallbackProfiler->startCallback();
+
+    m_pSoundManager->processUnderflowHappened();
+
+    //Note: Input is processed first so that any ControlObject changes made in
+    //      response to input are processed as soon as possible (that is, when
+    //      m_pSoundManager->requestBuffer() is called below.)
+    if (!m_inputPorts.isEmpty()) {
+        composeInputPorts(nframes);
+        m_pSoundManager->pushInputBuffers(m_audioInputs, nframes);
+    }
+
+    m_pSoundManager->readProcess();
+
+    m_pSoundManager->onDeviceOutputCallback(nframes);
+
+    if (!m_outputPorts.isEmpty()) {
+        ScopedCallbackStage stage(pCallbackProfiler, CallbackProfiler::OUTPUT);
+        composeOutputPorts(nframes);
+    }
+
+    m_pSoundManager->writeProcess();
+
+    pCallbackProfiler->finishCallback(mixxx::Duration::fromSeconds(
+            nframes / m_dSampleRate));
+
+    updateAudioLatencyUsage(nframes);
+    return 0;
+}
+
+void SoundDeviceJack::composeOutputPorts(jack_nframes_t nframes) {
+    for (QList<AudioOutputBuffer>::const_iterator i = m_audioOutputs.begin(),
+                 e = m_audioOutputs.end(); i != e; ++i) {
+        const AudioOutputBuffer& out = *i;
+        const ChannelGroup outChans = out.getChannelGroup();
+        const int iChannelBase = outChans.getChannelBase();
+        const CSAMPLE* pAudioOutputBuffer = out.getBuffer(); // Always stereo
+
+        if (outChans.getChannelCount() == 1) {
+            // All AudioOutputs are stereo as of Mixxx 1.12.0. If we have a
+            // mono output then we need to downsample.
+            CSAMPLE* pPort = portBuffer(m_outputPorts[iChannelBase], nframes);
+            for (jack_nframes_t iFrameNo = 0; iFrameNo < nframes; ++iFrameNo) {
+                pPort[iFrameNo] = SampleUtil::clampSample(
+                        (pAudioOutputBuffer[iFrameNo * 2] +
+                                pAudioOutputBuffer[iFrameNo * 2 + 1]) / 2.0f);
+            }
+        } else {
+            CSAMPLE* pLeft = portBuffer(m_outputPorts[iChannelBase], nframes);
+            CSAMPLE* pRight = portBuffer(m_outputPorts[iChannelBase + 1], nframes);
+            SampleUtil::deinterleaveBuffer(pLeft, pRight, pAudioOutputBuffer,
+                    nframes);
+            // Clamps in place
+            SampleUtil::copyClampBuffer(pLeft, pLeft, nframes);
+            SampleUtil::copyClampBuffer(pRight, pRight, nframes);
+        }
+    }
+
+    foreach (int iPort, m_silentOutputPorts) {
+        SampleUtil::clear(portBuffer(m_outputPorts[iPort], nframes), nframes);
+    }
+}
+
+void SoundDeviceJack::composeInputPorts(jack_nframes_t nframes) {
+    for (QList<AudioInputBuffer>::const_iterator i = m_audioInputs.begin(),
+                 e = m_audioInputs.end(); i != e; ++i) {
+        const AudioInputBuffer& in = *i;
+        const ChannelGroup inChans = in.getChannelGroup();
+        const int iChannelBase = inChans.getChannelBase();
+        CSAMPLE* pInputBuffer = in.getBuffer(); // Always stereo
+
+        const CSAMPLE* pLeft = portBuffer(m_inputPorts[iChannelBase], nframes);
+        if (inChans.getChannelCount() == 1) {
+            SampleUtil::copyMonoToDualMono(pInputBuffer, pLeft, nframes);
+        } else {
+            const CSAMPLE* pRight =
+                    portBuffer(m_inputPorts[iChannelBase + 1], nframes);
+            SampleUtil::interleaveBuffer(pInputBuffer, pLeft, pRight, nframes);
+        }
+    }
+}
+
+void SoundDeviceJack::updateAudioLatencyUsage(jack_nframes_t nframes) {
+    m_framesSinceAudioLatencyUsageUpdate += nframes;
+    if (m_framesSinceAudioLatencyUsageUpdate
+            > (m_dSampleRate / kCpuUsageUpdateRate)) {
+        double secInAudioCb = m_timeInAudioCallback.toDoubleSeconds();
+        m_pMasterAudioLatencyUsage->set(
+                secInAudioCb
+                        / (m_framesSinceAudioLatencyUsageUpdate / m_dSampleRate));
+        m_timeInAudioCallback = mixxx::Duration::fromSeconds(0);
+        m_framesSinceAudioLatencyUsageUpdate = 0;
+    }
+    // measure time in Audio callback at the very last
+    m_timeInAudioCallback += m_clkRefTimer.elapsed();
+}
@@ -0,0 +1,85 @@
+#ifndef SOUNDDEVICEJACK_H
+#define SOUNDDEVICEJACK_H
+
+#include <jack/jack.h>
+
+#include <QString>
+#include <QVector>
+
+#include "soundio/sounddevice.h"
+#include "util/duration.h"
+#include "util/performancetimer.h"
+
+class ControlProxy;
+
+const QString kJackDeviceInternalName = "JACK";
+
+// A SoundDevice that is a client of a running JACK server, without the
+// PortAudio JACK host API in between. It has one JACK port per channel, which
+// are connected to the physical ports of the server when opened.
+//
+// The JACK process callback drives the engine with the period size of the
+// server, which can be as short as the server allows, e.g. 32 frames. The
+// engine output is deinterleaved straight into the port buffers, so there is
+// no intermediate interleaved buffer and no buffer adaptation.
+//
+// The device can only be used as the clock reference device, because JACK
+// already synchronizes all the sound cards of the server.
+class SoundDeviceJack : public SoundDevice {
+  public:
+    SoundDeviceJack(UserSettingsPointer config, SoundManager* sm,
+            int numOutputChannels, int numInputChannels,
+            unsigned int sampleRate);
+    ~SoundDeviceJack() override;
+
+    // Looks up the physical ports and the sample rate of the JACK server.
+    // Returns false if no server is running, a server is never started.
+    static bool queryServer(int* pNumOutputChannels, int* pNumInputChannels,
+            unsigned int* pSampleRate);
+
+    SoundDeviceError open(bool isClkRefDevice, int syncBuffers) override;
+    bool isOpen() const override;
+    SoundDeviceError close() override;
+    void readProcess() override;
+    void writeProcess() override;
+    QString getError() const override;
+    unsigned int getDefaultSampleRate() const override {
+        return m_serverSampleRate;
+    }
+
+  private:
+    static int processCallback(jack_nframes_t nframes, void* pArg);
+    static int xrunCallback(void* pArg);
+    static void shutdownCallback(void* pArg);
+
+    int process(jack_nframes_t nframes);
+    void composeOutputPorts(jack_nframes_t nframes);
+    void composeInputPorts(jack_nframes_t nframes);
+    bool registerPorts(int numPorts, unsigned long flags,
+            QVector<jack_port_t*>* pPorts);
+    void connectPhysicalPorts();
+    void updateAudioLatencyUsage(jack_nframes_t nframes);
+
+    jack_client_t* m_pClient;
+    // One port for each channel up to the highest channel in use
+    QVector<jack_port_t*> m_outputPorts;
+    QVector<jack_port_t*> m_inputPorts;
+    // The output ports that are not the target of an output, these are
+    // cleared in each callback
+    QVector<int> m_silentOutputPorts;
+    const unsigned int m_serverSampleRate;
+    // Set by the shutdown callback when the server has gone away
+    volatile bool m_bShutdown;
+    // The process thread is created by the server, its role is applied in
+    // the first callback
+    bool m_bThreadRoleApplied;
+    double m_callbackEntryToDacSecs;
+    QString m_lastError;
+
+    ControlProxy* m_pMasterAudioLatencyUsage;
+    mixxx::Duration m_timeInAudioCallback;
+    SINT m_framesSinceAudioLatencyUsageUpdate;
+    PerformanceTimer m_clkRefTimer;
+};
+
+#endif // SOUNDDEVICEJACK_H
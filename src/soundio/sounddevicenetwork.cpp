@@ -17,19 +17,6 @@
 #include "util/sample.h"
 
 namespace {
-const int kNetworkLatencyFrames = 8192; // 185 ms @ 44100 Hz
-// Related chunk sizes:
-// Mp3 frames = 1152 samples
-// Ogg frames = 64 to 8192 samples.
-// In Mixxx 1.11 we transmit every decoder-frames at once,
-// Which results in case of ogg in a dynamic latency from 0.14 ms to to 185 ms
-// Now we have switched to a fixed latency of 8192 frames (stereo samples) =
-// which is 185 @ 44100 ms and twice the maximum of the max mixxx audio buffer
-const int kBufferFrames = kNetworkLatencyFrames * 4; // 743 ms @ 44100 Hz
-// normally * 2 is sufficient.
-// We allow to buffer two extra chunks for a CPU overload case, when
-// the broadcast thread is not scheduled in time.
-
 const mixxx::Logger kLogger("SoundDeviceNetwork");
 }
 
@@ -138,8 +125,15 @@ void SoundDeviceNetwork::readProcess() {
     if (!m_inputFifo || !m_pNetworkStream || !m_iNumInputChannels) return;
 
     int inChunkSize = m_framesPerBuffer * m_iNumInputChannels;
-    int readAvailable = m_pNetworkStream->getReadExpected()
-            * m_iNumInputChannels;
+    int readAvailable;
+    if (m_pNetworkStream->inputFollowsReader()) {
+        // The stream follows the clock of this callback, so we read one
+        // chunk per callback
+        readAvailable = math_max(inChunkSize - m_inputFifo->readAvailable(), 0);
+    } else {
+        readAvailable = m_pNetworkStream->getReadExpected()
+                * m_iNumInputChannels;
+    }
     int writeAvailable = m_inputFifo->writeAvailable();
     int copyCount = qMin(writeAvailable, readAvailable);
     if (copyCount > 0) {
@@ -160,7 +154,9 @@ void SoundDeviceNetwork::readProcess() {
         }
         m_inputFifo->releaseWriteRegions(copyCount);
 
-        if (readAvailable > writeAvailable + inChunkSize / 2) {
+        if (m_pNetworkStream->inputFollowsReader()) {
+            // The drift is corrected by the jitter buffer of the stream
+        } else if (readAvailable > writeAvailable + inChunkSize / 2) {
             // we are not able to consume all frames
             if (m_inputDrift) {
                 // Skip one frame
@@ -335,10 +331,10 @@ void SoundDeviceNetwork::workerWriteProcess(NetworkOutputStreamWorkerPtr pWorker
         QSharedPointer<FIFO<CSAMPLE>> pFifo = pWorker->getOutputFifo();
         if(pFifo) {
             // interval = copyCount
-            // Check for desired kNetworkLatencyFrames + 1/2 interval to
+            // Check for the desired latency of the worker + 1/2 interval to
             // avoid big jitter due to interferences with sync code
             if (pFifo->readAvailable() + copyCount / 2
-                    >= (m_iNumOutputChannels * kNetworkLatencyFrames)) {
+                    >= (m_iNumOutputChannels * pWorker->outputLatencyFrames())) {
                 pWorker->outputAvailable();
             }
         }
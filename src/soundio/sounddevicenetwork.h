@@ -11,6 +11,7 @@
 
 #include "util/performancetimer.h"
 #include "util/memory.h"
+#include "util/threadroles.h"
 #include "soundio/sounddevice.h"
 
 #define CPU_USAGE_UPDATE_RATE 30 // in 1/s, fits to display frame rate
@@ -97,6 +98,8 @@ class SoundDeviceNetworkThread : public QThread {
             qWarning() << "SoundDeviceNetworkThread: Failed bumping priority";
         }
 #endif
+        mixxx::ThreadRoles::applyToCurrentThread(
+                mixxx::ThreadRole::AudioCallback);
 
         while(!m_stop) {
             m_pParent->callbackProcessClkRef();
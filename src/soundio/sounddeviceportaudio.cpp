@@ -29,6 +29,8 @@
 
 #include "control/controlobject.h"
 #include "control/controlproxy.h"
+#include "engine/callbackprofiler.h"
+#include "soundio/driftresampler.h"
 #include "soundio/sounddevice.h"
 #include "soundio/soundmanager.h"
 #include "soundio/soundmanagerutil.h"
@@ -37,6 +39,7 @@
 #include "util/timer.h"
 #include "util/trace.h"
 #include "util/math.h"
+#include "util/threadroles.h"
 #include "vinylcontrol/defs_vinylcontrol.h"
 #include "waveform/visualplayposition.h"
 
@@ -97,6 +100,8 @@ SoundDevicePortAudio::SoundDevicePortAudio(UserSettingsPointer config,
           m_deviceInfo(deviceInfo),
           m_outputFifo(NULL),
           m_inputFifo(NULL),
+          m_pOutputResampler(NULL),
+          m_pInputResampler(NULL),
           m_outputDrift(false),
           m_inputDrift(false),
           m_bSetThreadPriority(false),
@@ -263,6 +268,8 @@ SoundDeviceError SoundDevicePortAudio::open(bool isClkRefDevice, int syncBuffers
             m_outputFifo->releaseWriteRegions(
                     m_outputParams.channelCount * m_framesPerBuffer * kFifoSize
                             / 2);
+            m_pOutputResampler = new DriftResampler(
+                    m_outputParams.channelCount, m_framesPerBuffer);
         }
         if (m_inputParams.channelCount) {
             m_inputFifo = new FIFO<CSAMPLE>(
@@ -271,7 +278,15 @@ SoundDeviceError SoundDevicePortAudio::open(bool isClkRefDevice, int syncBuffers
             m_inputFifo->releaseWriteRegions(
                     m_inputParams.channelCount * m_framesPerBuffer * kFifoSize
                             / 2);
+            m_pInputResampler = new DriftResampler(
+                    m_inputParams.channelCount, m_framesPerBuffer);
         }
+        // The resampler of each direction reads or writes up to one chunk
+        // and its drift through this buffer
+        const int channelCount = math_max(
+                m_outputParams.channelCount, m_inputParams.channelCount);
+        mixxx::SampleBuffer(
+                channelCount * (2 * m_framesPerBuffer + 4)).swap(m_driftBuffer);
     } else if (m_syncBuffers == 1) { // "Disabled (short delay)"
         // this can be used on a second device when it is driven by the Clock
         // reference device clock
@@ -419,10 +434,14 @@ SoundDeviceError SoundDevicePortAudio::close() {
         if (m_inputFifo) {
             delete m_inputFifo;
         }
+        delete m_pOutputResampler;
+        delete m_pInputResampler;
     }
 
     m_outputFifo = NULL;
     m_inputFifo = NULL;
+    m_pOutputResampler = NULL;
+    m_pInputResampler = NULL;
     m_bSetThreadPriority = false;
 
     return SOUNDDEVICE_ERROR_OK;
@@ -690,105 +709,62 @@ int SoundDevicePortAudio::callbackProcessDrift(
     //
     // Additional we need an filled chunk and an empty chunk. These are used when on
     // sound card overtakes the other. This always happens, if they are driven form
-    // two crystals. In a test case every 30 s @ 23 ms. After they are consumed,
-    // the drift correction takes place and fills or clears the reserve buffers.
-    // If this is finished before another overtake happens, we do not face any
-    // dropouts or clicks.
+    // two crystals. In a test case every 30 s @ 23 ms.
     // So thats why we need a Fifo of 3 chunks.
     //
     // In addition there is a jitter effect. It happens that one callback is delayed,
     // in this case the second one fires two times and then the first one fires two
-    // time as well to catch up. This is also fixed by the additional buffers. If this
-    // happens just after an regular overtake, we will have clicks again.
+    // time as well to catch up. This is also fixed by the additional buffers.
     //
-    // I the tests it turns out that it only happens in the opposite direction, so
-    // 3 chunks are just fine.
+    // The drift itself is compensated by resampling the audio by a ratio that
+    // keeps the Fifo at its middle fill level on average, instead of skipping
+    // or duplicating a frame when a reserve chunk is consumed. This avoids the
+    // clicks of the skipped frames, which are audible with short buffers.
 
     if (m_inputParams.channelCount) {
-        int inChunkSize = framesPerBuffer * m_inputParams.channelCount;
+        const int channelCount = m_inputParams.channelCount;
         int readAvailable = m_inputFifo->readAvailable();
+        m_pInputResampler->updateRatio(readAvailable / channelCount,
+                framesPerBuffer * kDriftReserve, framesPerBuffer);
+        const SINT frames = m_pInputResampler->process(in, framesPerBuffer,
+                m_driftBuffer.data(), m_driftBuffer.size() / channelCount);
+        const int samples = frames * channelCount;
         int writeAvailable = m_inputFifo->writeAvailable();
-        if (readAvailable < inChunkSize * kDriftReserve) {
-            // risk of an underflow, duplicate one frame
-            m_inputFifo->write(in, inChunkSize);
-            if (m_inputDrift) {
-                // Do not compensate the first delay, because it is likely a jitter
-                // corrected in the next cycle
-                // Duplicate one frame
-                m_inputFifo->write(
-                        &in[inChunkSize - m_inputParams.channelCount],
-                        m_inputParams.channelCount);
-                //qDebug() << "callbackProcessDrift write:" << (float)readAvailable / inChunkSize << "Skip";
-            } else {
-                m_inputDrift = true;
-                //qDebug() << "callbackProcessDrift write:" << (float)readAvailable / inChunkSize << "Jitter Skip";
-            }
-        } else if (readAvailable == inChunkSize * kDriftReserve) {
-            // Everything Ok
-            m_inputFifo->write(in, inChunkSize);
-            m_inputDrift = false;
-            //qDebug() << "callbackProcess write:" << (float) readAvailable / inChunkSize << "Normal";
-        } else if (writeAvailable >= inChunkSize) {
-            // Risk of overflow, skip one frame
-            if (m_inputDrift) {
-                m_inputFifo->write(in, inChunkSize - m_inputParams.channelCount);
-                //qDebug() << "callbackProcessDrift write:" << (float)readAvailable / inChunkSize << "Skip";
-            } else {
-                m_inputFifo->write(in, inChunkSize);
-                m_inputDrift = true;
-                //qDebug() << "callbackProcessDrift write:" << (float)readAvailable / inChunkSize << "Jitter Skip";
-            }
+        if (writeAvailable >= samples) {
+            m_inputFifo->write(m_driftBuffer.data(), samples);
         } else if (writeAvailable) {
             // Fifo Overflow
-            m_inputFifo->write(in, writeAvailable);
+            m_inputFifo->write(m_driftBuffer.data(), writeAvailable);
             m_pSoundManager->underflowHappened(8);
-            //qDebug() << "callbackProcessDrift write:" << (float) readAvailable / inChunkSize << "Overflow";
+            //qDebug() << "callbackProcessDrift write:" << (float) readAvailable / samples << "Overflow";
         } else {
             // Buffer full
             m_pSoundManager->underflowHappened(9);
-            //qDebug() << "callbackProcessDrift write:" << (float) readAvailable / inChunkSize << "Buffer full";
+            //qDebug() << "callbackProcessDrift write:" << (float) readAvailable / samples << "Buffer full";
         }
     }
 
     if (m_outputParams.channelCount) {
-        int outChunkSize = framesPerBuffer * m_outputParams.channelCount;
+        const int channelCount = m_outputParams.channelCount;
+        int outChunkSize = framesPerBuffer * channelCount;
         int readAvailable = m_outputFifo->readAvailable();
-
-        if (readAvailable > outChunkSize * (kDriftReserve + 1)) {
-            m_outputFifo->read(out, outChunkSize);
-            if (m_outputDrift) {
-                // Risk of overflow, skip one frame
-                m_outputFifo->releaseReadRegions(m_outputParams.channelCount);
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Skip";
-            } else {
-                m_outputDrift = true;
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Jitter Skip";
-            }
-        } else if (readAvailable == outChunkSize * (kDriftReserve + 1)) {
-            m_outputFifo->read(out, outChunkSize);
-            m_outputDrift = false;
-            //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Normal";
-        } else if (readAvailable >= outChunkSize) {
-            if (m_outputDrift) {
-                // Risk of underflow, duplicate one frame
-                m_outputFifo->read(out,
-                        outChunkSize - m_outputParams.channelCount);
-                SampleUtil::copy(
-                        &out[outChunkSize - m_outputParams.channelCount],
-                        &out[outChunkSize - (2 * m_outputParams.channelCount)],
-                        m_outputParams.channelCount);
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Save";
-            } else {
-                m_outputFifo->read(out, outChunkSize);
-                m_outputDrift = true;
-                //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Jitter Save";
-            }
+        m_pOutputResampler->updateRatio(readAvailable / channelCount,
+                framesPerBuffer * (kDriftReserve + 1), framesPerBuffer);
+        const int readCount = channelCount *
+                m_pOutputResampler->inputFramesRequired(framesPerBuffer);
+
+        if (readAvailable >= readCount) {
+            m_outputFifo->read(m_driftBuffer.data(), readCount);
+            m_pOutputResampler->process(m_driftBuffer.data(),
+                    readCount / channelCount, out, framesPerBuffer);
         } else if (readAvailable) {
-            m_outputFifo->read(out,
-                    readAvailable);
+            m_outputFifo->read(m_driftBuffer.data(), readAvailable);
+            const SINT frames = m_pOutputResampler->process(
+                    m_driftBuffer.data(), readAvailable / channelCount,
+                    out, framesPerBuffer);
             // underflow
-            SampleUtil::clear(&out[readAvailable],
-                    outChunkSize - readAvailable);
+            SampleUtil::clear(&out[frames * channelCount],
+                    outChunkSize - frames * channelCount);
             m_pSoundManager->underflowHappened(10);
             //qDebug() << "callbackProcessDrift read:" << (float)readAvailable / outChunkSize << "Underflow";
         } else {
@@ -797,7 +773,7 @@ int SoundDevicePortAudio::callbackProcessDrift(
             m_pSoundManager->underflowHappened(11);
             //qDebug() << "callbackProcess read:" << (float)readAvailable / outChunkSize << "Buffer empty";
         }
-     }
+    }
     return paContinue;
 }
 
@@ -868,9 +844,10 @@ int SoundDevicePortAudio::callbackProcessClkRef(
     // in Linux userland, for example, this will have no effect.
     if (!m_bSetThreadPriority) {
         QThread::currentThread()->setPriority(QThread::TimeCriticalPriority);
+        mixxx::ThreadRoles::applyToCurrentThread(
+                mixxx::ThreadRole::AudioCallback);
         m_bSetThreadPriority = true;
 
-
 #ifdef __SSE__
         // This disables the denormals calculations, to avoid a
         // performance penalty of ~20
@@ -915,6 +892,9 @@ int SoundDevicePortAudio::callbackProcessClkRef(
 #endif
 #endif
 
+    CallbackProfiler* pCallbackProfiler = m_pSoundManager->getCallbackProfiler();
+    pCallbackProfiler->startCallback();
+
     if (statusFlags & (paOutputUnderflow | paInputOverflow)) {
         m_pSoundManager->underflowHappened(6);
     }
@@ -935,13 +915,21 @@ int SoundDevicePortAudio::callbackProcessClkRef(
 
     m_pSoundManager->readProcess();
 
+    // With a single stereo output, the engine may render it directly into
+    // the buffer of the device
+    bool outputRendered = false;
     {
         ScopedTimer t("SoundDevicePortAudio::callbackProcess prepare %1",
                 getInternalName());
-        m_pSoundManager->onDeviceOutputCallback(framesPerBuffer);
+        if (out && m_outputParams.channelCount == 2) {
+            outputRendered = m_pSoundManager->onDeviceOutputCallback(
+                    framesPerBuffer, out);
+        } else {
+            m_pSoundManager->onDeviceOutputCallback(framesPerBuffer);
+        }
     }
 
-    if (out) {
+    if (out && !outputRendered) {
         ScopedTimer t("SoundDevicePortAudio::callbackProcess output %1",
                 getInternalName());
 
@@ -953,11 +941,15 @@ int SoundDevicePortAudio::callbackProcessClkRef(
             return paContinue;
         }
 
+        ScopedCallbackStage stage(pCallbackProfiler, CallbackProfiler::OUTPUT);
         composeOutputBuffer(out, framesPerBuffer, 0, m_outputParams.channelCount);
     }
 
     m_pSoundManager->writeProcess();
 
+    pCallbackProfiler->finishCallback(mixxx::Duration::fromSeconds(
+            framesPerBuffer / m_dSampleRate));
+
     updateAudioLatencyUsage(framesPerBuffer);
 
     return paContinue;
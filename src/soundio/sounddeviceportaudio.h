@@ -25,11 +25,13 @@
 
 #include "soundio/sounddevice.h"
 #include "util/duration.h"
+#include "util/samplebuffer.h"
 
 #define CPU_USAGE_UPDATE_RATE 30 // in 1/s, fits to display frame rate
 
 class SoundManager;
 class ControlProxy;
+class DriftResampler;
 
 /** Dynamically resolved function which allows us to enable a realtime-priority callback
     thread from ALSA/PortAudio. This must be dynamically resolved because PortAudio can't
@@ -89,6 +91,10 @@ class SoundDevicePortAudio : public SoundDevice {
     PaStreamParameters m_inputParams;
     FIFO<CSAMPLE>* m_outputFifo;
     FIFO<CSAMPLE>* m_inputFifo;
+    // Compensate the clock drift in callbackProcessDrift()
+    DriftResampler* m_pOutputResampler;
+    DriftResampler* m_pInputResampler;
+    mixxx::SampleBuffer m_driftBuffer;
     bool m_outputDrift;
     bool m_inputDrift;
 
@@ -16,11 +16,16 @@
 
 #include "soundio/soundmanager.h"
 
+#include <QThread>
 #include <QtDebug>
 #include <cstring> // for memcpy and strcmp
 
 #ifdef __PORTAUDIO__
+#include <QFuture>
 #include <QLibrary>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrentRun>
 #include <portaudio.h>
 #endif // ifdef __PORTAUDIO__
 
@@ -30,13 +35,19 @@
 #include "engine/enginemaster.h"
 #include "engine/sidechain/enginenetworkstream.h"
 #include "engine/sidechain/enginesidechain.h"
+#include "engine/sidechain/networkaudiosender.h"
 #include "soundio/sounddevice.h"
+#ifdef __JACK__
+#include "soundio/sounddevicejack.h"
+#endif
 #include "soundio/sounddevicenetwork.h"
 #include "soundio/sounddevicenotfound.h"
 #include "soundio/sounddeviceportaudio.h"
 #include "soundio/soundmanagerutil.h"
 #include "util/cmdlineargs.h"
+#include "util/counter.h"
 #include "util/defs.h"
+#include "util/flightrecorder.h"
 #include "util/sample.h"
 #include "util/sleep.h"
 #include "util/version.h"
@@ -50,15 +61,62 @@ namespace {
 
 #define CPU_OVERLOAD_DURATION 500 // in ms
 
-struct DeviceMode {
-    SoundDevice* device;
-    bool isInput;
-    bool isOutput;
-};
-
 #ifdef __LINUX__
 const unsigned int kSleepSecondsAfterClosingDevice = 5;
 #endif
+
+// The low latency network audio stream, e.g. for a monitor in a remote
+// booth. The settings take effect after a restart.
+const QString kNetworkAudioGroup = "[NetworkAudio]";
+const int kDefaultNetworkAudioPort = 4464;
+const double kDefaultNetworkAudioLatencyMillis = 10.0;
+
+// Counts the audio latency overloads, at most one per CPU_OVERLOAD_DURATION
+Counter s_xrunCounter("SoundManager xruns");
+
+#ifdef __PORTAUDIO__
+// Pa_Initialize() enumerates the devices of all host APIs, which can take
+// seconds, see SoundManager::initializePortAudioInBackground()
+QMutex s_paInitializationMutex;
+QFuture<PaError> s_paInitialization;
+bool s_paInitializationPending = false;
+
+#ifndef __WINDOWS__
+// Terminates and initializes PortAudio again to pick up devices that have
+// been plugged in or removed, see
+// SoundManager::clearAndQueryDevicesInBackground()
+PaError reinitializePortAudio(bool terminate, bool sleepAfterClosing) {
+#ifdef __LINUX__
+    if (sleepAfterClosing) {
+        sleep(kSleepSecondsAfterClosingDevice);
+    }
+#else
+    Q_UNUSED(sleepAfterClosing);
+#endif
+    if (terminate) {
+        Pa_Terminate();
+    }
+    return Pa_Initialize();
+}
+#endif
+#endif
+
+// Outputs that the clock reference device is chosen by, and that the engine
+// may render directly into its buffer, see SoundManager::getChangedDevices()
+bool affectsClockReference(const QList<AudioOutput>& outputs) {
+    for (const auto& out: outputs) {
+        switch (out.getType()) {
+        case AudioPath::MASTER:
+        case AudioPath::HEADPHONES:
+        case AudioPath::DECK:
+        case AudioPath::BUS:
+            return true;
+        default:
+            break;
+        }
+    }
+    return false;
+}
 } // anonymous namespace
 
 SoundManager::SoundManager(UserSettingsPointer pConfig,
@@ -67,10 +125,18 @@ SoundManager::SoundManager(UserSettingsPointer pConfig,
           m_pConfig(pConfig),
 #ifdef __PORTAUDIO__
           m_paInitialized(false),
+#endif
+#if defined(__PORTAUDIO__) || defined(__JACK__)
           m_jackSampleRate(-1),
 #endif
           m_pErrorDevice(NULL),
-          m_underflowHappened(0) {
+          m_directOutputType(AudioPath::INVALID),
+          m_underflowHappened(0),
+#ifdef __PORTAUDIO__
+          m_bDeviceQueryPending(false),
+#endif
+          m_deviceProcessingPaused(0),
+          m_deviceProcessingActive(0) {
     // TODO(xxx) some of these ControlObject are not needed by soundmanager, or are unused here.
     // It is possible to take them out?
     m_pControlObjectSoundStatusCO = new ControlObject(
@@ -91,8 +157,35 @@ SoundManager::SoundManager(UserSettingsPointer pConfig,
     m_samplerates.push_back(48000);
     m_samplerates.push_back(96000);
 
+    const bool receiveNetworkAudio = m_pConfig->getValue(
+            ConfigKey(kNetworkAudioGroup, "ReceiveEnabled"), false);
     m_pNetworkStream = QSharedPointer<EngineNetworkStream>(
-            new EngineNetworkStream(2, 0));
+            new EngineNetworkStream(2, receiveNetworkAudio ? 2 : 0));
+    if (receiveNetworkAudio) {
+        m_pNetworkAudioReceiver = std::make_unique<NetworkInputStreamWorker>(
+                2,
+                m_pConfig->getValue(ConfigKey(kNetworkAudioGroup, "ReceivePort"),
+                        kDefaultNetworkAudioPort),
+                m_pConfig->getValue(ConfigKey(kNetworkAudioGroup, "TargetLatencyMs"),
+                        kDefaultNetworkAudioLatencyMillis));
+        m_pNetworkStream->setInputWorker(m_pNetworkAudioReceiver.get());
+        m_pNetworkAudioReceiver->start(QThread::HighPriority);
+    }
+    if (m_pConfig->getValue(ConfigKey(kNetworkAudioGroup, "SendEnabled"), false)) {
+        NetworkAudioSender* pSender = new NetworkAudioSender(
+                m_pConfig->getValue(ConfigKey(kNetworkAudioGroup, "SendHost"),
+                        "127.0.0.1"),
+                m_pConfig->getValue(ConfigKey(kNetworkAudioGroup, "SendPort"),
+                        kDefaultNetworkAudioPort));
+        m_pNetworkAudioSender = NetworkOutputStreamWorkerPtr(pSender);
+        m_pNetworkStream->addOutputWorker(m_pNetworkAudioSender);
+        pSender->start(QThread::HighPriority);
+    }
+
+#ifdef __PORTAUDIO__
+    connect(&m_deviceQueryWatcher, SIGNAL(finished()),
+            this, SLOT(finishQueryDevicesInBackground()));
+#endif
 
     queryDevices();
 
@@ -104,10 +197,21 @@ SoundManager::SoundManager(UserSettingsPointer pConfig,
 }
 
 SoundManager::~SoundManager() {
+    finishQueryDevicesInBackground();
     // Clean up devices.
     const bool sleepAfterClosing = false;
     clearDeviceList(sleepAfterClosing);
 
+    // The network stream is no longer processed
+    if (m_pNetworkAudioSender) {
+        m_pNetworkStream->removeOutputWorker(m_pNetworkAudioSender);
+        m_pNetworkAudioSender->shutdown();
+    }
+    if (m_pNetworkAudioReceiver) {
+        m_pNetworkStream->setInputWorker(nullptr);
+        m_pNetworkAudioReceiver->stop();
+    }
+
 #ifdef __PORTAUDIO__
     if (m_paInitialized) {
         Pa_Terminate();
@@ -153,12 +257,25 @@ QList<SoundDevice*> SoundManager::getDeviceList(
 QList<QString> SoundManager::getHostAPIList() const {
     QList<QString> apiList;
 
-    for (PaHostApiIndex i = 0; i < Pa_GetHostApiCount(); i++) {
-        const PaHostApiInfo* api = Pa_GetHostApiInfo(i);
-        if (api && QString(api->name) != "skeleton implementation") {
-            apiList.push_back(api->name);
+#ifdef __PORTAUDIO__
+    // Not while PortAudio is initialized again in the background
+    if (m_paInitialized) {
+        for (PaHostApiIndex i = 0; i < Pa_GetHostApiCount(); i++) {
+            const PaHostApiInfo* api = Pa_GetHostApiInfo(i);
+            if (api && QString(api->name) != "skeleton implementation") {
+                apiList.push_back(api->name);
+            }
         }
     }
+#endif
+#ifdef __JACK__
+    foreach (SoundDevice* pDevice, m_devices) {
+        if (pDevice->getHostAPI() == MIXXX_JACK_NATIVE_STRING) {
+            apiList.push_back(MIXXX_JACK_NATIVE_STRING);
+            break;
+        }
+    }
+#endif
 
     return apiList;
 }
@@ -188,25 +305,7 @@ void SoundManager::closeDevices(bool sleepAfterClosing) {
     // then the callback may be running when we call
     // onInputDisconnected/onOutputDisconnected.
     foreach (SoundDevice* pDevice, m_devices) {
-        foreach (AudioInput in, pDevice->inputs()) {
-            // Need to tell all registered AudioDestinations for this AudioInput
-            // that the input was disconnected.
-            for (QHash<AudioInput, AudioDestination*>::const_iterator it =
-                         m_registeredDestinations.find(in);
-                 it != m_registeredDestinations.end() && it.key() == in; ++it) {
-                it.value()->onInputUnconfigured(in);
-                m_pMaster->onInputDisconnected(in);
-            }
-        }
-        foreach (AudioOutput out, pDevice->outputs()) {
-            // Need to tell all registered AudioSources for this AudioOutput
-            // that the output was disconnected.
-            for (QHash<AudioOutput, AudioSource*>::const_iterator it =
-                         m_registeredSources.find(out);
-                 it != m_registeredSources.end() && it.key() == out; ++it) {
-                it.value()->onOutputDisconnected(out);
-            }
-        }
+        disconnectDevice(pDevice);
     }
 
     while (!m_inputBuffers.isEmpty()) {
@@ -221,6 +320,35 @@ void SoundManager::closeDevices(bool sleepAfterClosing) {
     m_pControlObjectSoundStatusCO->set(SOUNDMANAGER_DISCONNECTED);
 }
 
+void SoundManager::disconnectDevice(SoundDevice* pDevice) {
+    foreach (AudioInput in, pDevice->inputs()) {
+        // Need to tell all registered AudioDestinations for this AudioInput
+        // that the input was disconnected.
+        for (QHash<AudioInput, AudioDestination*>::const_iterator it =
+                     m_registeredDestinations.find(in);
+             it != m_registeredDestinations.end() && it.key() == in; ++it) {
+            it.value()->onInputUnconfigured(in);
+            m_pMaster->onInputDisconnected(in);
+        }
+    }
+    foreach (AudioOutput out, pDevice->outputs()) {
+        // Need to tell all registered AudioSources for this AudioOutput
+        // that the output was disconnected.
+        for (QHash<AudioOutput, AudioSource*>::const_iterator it =
+                     m_registeredSources.find(out);
+             it != m_registeredSources.end() && it.key() == out; ++it) {
+            it.value()->onOutputDisconnected(out);
+        }
+    }
+
+    foreach (const AudioInputBuffer& in, pDevice->inputs()) {
+        CSAMPLE* pBuffer = in.getBuffer();
+        if (m_inputBuffers.removeOne(pBuffer)) {
+            SampleUtil::free(pBuffer);
+        }
+    }
+}
+
 void SoundManager::clearDeviceList(bool sleepAfterClosing) {
     //qDebug() << "SoundManager::clearDeviceList()";
 
@@ -243,8 +371,9 @@ void SoundManager::clearDeviceList(bool sleepAfterClosing) {
 }
 
 QList<unsigned int> SoundManager::getSampleRates(QString api) const {
-#ifdef __PORTAUDIO__
-    if (api == MIXXX_PORTAUDIO_JACK_STRING) {
+#if defined(__PORTAUDIO__) || defined(__JACK__)
+    if (api == MIXXX_PORTAUDIO_JACK_STRING ||
+            api == MIXXX_JACK_NATIVE_STRING) {
         // queryDevices must have been called for this to work, but the
         // ctor calls it -bkgood
         QList<unsigned int> samplerates;
@@ -262,6 +391,7 @@ QList<unsigned int> SoundManager::getSampleRates() const {
 void SoundManager::queryDevices() {
     //qDebug() << "SoundManager::queryDevices()";
     queryDevicesPortaudio();
+    queryDevicesJack();
     queryDevicesMixxx();
 
     // now tell the prefs that we updated the device list -- bkgood
@@ -269,19 +399,84 @@ void SoundManager::queryDevices() {
 }
 
 void SoundManager::clearAndQueryDevices() {
+#ifdef __PORTAUDIO__
+    if (m_bDeviceQueryPending) {
+        // The devices are closed already
+        finishQueryDevicesInBackground();
+        return;
+    }
+#endif
     const bool sleepAfterClosing = true;
     clearDeviceList(sleepAfterClosing);
     queryDevices();
 }
 
+void SoundManager::clearAndQueryDevicesInBackground() {
+#if defined(__PORTAUDIO__) && !defined(__WINDOWS__)
+    if (m_bDeviceQueryPending) {
+        return;
+    }
+    bool sleepAfterClosing = false;
+    foreach (SoundDevice* pDevice, m_devices) {
+        if (pDevice->isOpen()) {
+            sleepAfterClosing = true;
+            break;
+        }
+    }
+    // The devices keep their PortAudio device info until they are deleted
+    // in finishQueryDevicesInBackground(), but they must not be opened again
+    // after PortAudio has been terminated. Only the thread pool waits for the
+    // host APIs to release them.
+    closeDevices(false);
+    m_pErrorDevice = NULL;
+
+    QMutexLocker locker(&s_paInitializationMutex);
+    if (!s_paInitializationPending) {
+#ifdef Q_OS_LINUX
+        setJACKName();
+#endif
+        s_paInitialization = QtConcurrent::run(&reinitializePortAudio,
+                m_paInitialized, sleepAfterClosing);
+        s_paInitializationPending = true;
+    }
+    m_paInitialized = false;
+    m_bDeviceQueryPending = true;
+    m_deviceQueryWatcher.setFuture(s_paInitialization);
+#else
+    clearAndQueryDevices();
+#endif
+}
+
+void SoundManager::finishQueryDevicesInBackground() {
+#ifdef __PORTAUDIO__
+    if (!m_bDeviceQueryPending) {
+        return;
+    }
+    m_deviceQueryWatcher.waitForFinished();
+    m_bDeviceQueryPending = false;
+    while (!m_devices.empty()) {
+        delete m_devices.takeLast();
+    }
+    // Takes the result of the background initialization
+    queryDevices();
+#endif
+}
+
 void SoundManager::queryDevicesPortaudio() {
 #ifdef __PORTAUDIO__
     PaError err = paNoError;
     if (!m_paInitialized) {
+        QMutexLocker locker(&s_paInitializationMutex);
+        if (s_paInitializationPending) {
+            err = s_paInitialization.result();
+            s_paInitialization = QFuture<PaError>();
+            s_paInitializationPending = false;
+        } else {
 #ifdef Q_OS_LINUX
-        setJACKName();
+            setJACKName();
 #endif
-        err = Pa_Initialize();
+            err = Pa_Initialize();
+        }
         m_paInitialized = true;
     }
     if (err != paNoError) {
@@ -325,6 +520,22 @@ void SoundManager::queryDevicesPortaudio() {
 #endif
 }
 
+void SoundManager::queryDevicesJack() {
+#ifdef __JACK__
+    int numOutputChannels = 0;
+    int numInputChannels = 0;
+    unsigned int sampleRate = 0;
+    if (!SoundDeviceJack::queryServer(
+            &numOutputChannels, &numInputChannels, &sampleRate)) {
+        return;
+    }
+    SoundDeviceJack* currentDevice = new SoundDeviceJack(m_pConfig, this,
+            numOutputChannels, numInputChannels, sampleRate);
+    m_devices.push_back(currentDevice);
+    m_jackSampleRate = sampleRate;
+#endif
+}
+
 void SoundManager::queryDevicesMixxx() {
     SoundDeviceNetwork* currentDevice = new SoundDeviceNetwork(
             m_pConfig, this, m_pNetworkStream);
@@ -336,6 +547,7 @@ SoundDeviceError SoundManager::setupDevices() {
     // pushBuffer and onDeviceOutputCallback until closeDevices() below.
 
     qDebug() << "SoundManager::setupDevices()";
+    finishQueryDevicesInBackground();
     m_pControlObjectSoundStatusCO->set(SOUNDMANAGER_CONNECTING);
     SoundDeviceError err = SOUNDDEVICE_ERROR_OK;
     // NOTE(rryan): Do not clear m_pClkRefDevice here. If we didn't touch the
@@ -345,6 +557,7 @@ SoundDeviceError SoundManager::setupDevices() {
     // latencies) when changing devices.
     //m_pClkRefDevice = NULL;
     m_pErrorDevice = NULL;
+    m_directOutputType = AudioPath::INVALID;
     int outputDevicesOpened = 0;
     int inputDevicesOpened = 0;
 
@@ -377,83 +590,10 @@ SoundDeviceError SoundManager::setupDevices() {
     // loop over all available devices
     foreach (SoundDevice* device, m_devices) {
         DeviceMode mode = {device, false, false};
-        device->clearInputs();
-        device->clearOutputs();
         m_pErrorDevice = device;
-        foreach (AudioInput in,
-                 m_config.getInputs().values(device->getInternalName())) {
-            mode.isInput = true;
-            // TODO(bkgood) look into allocating this with the frames per
-            // buffer value from SMConfig
-            AudioInputBuffer aib(in, SampleUtil::alloc(MAX_BUFFER_LEN));
-            err = device->addInput(aib);
-            if (err != SOUNDDEVICE_ERROR_OK) {
-                delete [] aib.getBuffer();
-                goto closeAndError;
-            }
-
-            m_inputBuffers.append(aib.getBuffer());
-
-            // Check if any AudioDestination is registered for this AudioInput
-            // and call the onInputConnected method.
-            for (auto it = m_registeredDestinations.find(in);
-                    it != m_registeredDestinations.end() && it.key() == in;
-                    ++it) {
-                it.value()->onInputConfigured(in);
-                m_pMaster->onInputConnected(in);
-            }
-        }
-        QList<AudioOutput> outputs =
-                m_config.getOutputs().values(device->getInternalName());
-
-        // Statically connect the Network Device to the Sidechain
-        if (device->getInternalName() == kNetworkDeviceInternalName) {
-            AudioOutput out(AudioPath::RECORD_BROADCAST, 0, 2, 0);
-            outputs.append(out);
-            if (m_config.getForceNetworkClock()) {
-                pNewMasterClockRef = device;
-            }
-        }
-
-        foreach (AudioOutput out, outputs) {
-            mode.isOutput = true;
-            if (device->getInternalName() != kNetworkDeviceInternalName) {
-                haveOutput = true;
-            }
-            // following keeps us from asking for a channel buffer EngineMaster
-            // doesn't have -- bkgood
-            const CSAMPLE* pBuffer = m_registeredSources.value(out)->buffer(out);
-            if (pBuffer == NULL) {
-                qDebug() << "AudioSource returned null for" << out.getString();
-                continue;
-            }
-
-            AudioOutputBuffer aob(out, pBuffer);
-            err = device->addOutput(aob);
-            if (err != SOUNDDEVICE_ERROR_OK) goto closeAndError;
-
-            if (!m_config.getForceNetworkClock()) {
-                if (out.getType() == AudioOutput::MASTER) {
-                    pNewMasterClockRef = device;
-                } else if ((out.getType() == AudioOutput::DECK ||
-                            out.getType() == AudioOutput::BUS)
-                        && !pNewMasterClockRef) {
-                    pNewMasterClockRef = device;
-                }
-            }
-
-            // Check if any AudioSource is registered for this AudioOutput and
-            // call the onOutputConnected method.
-            for (auto it = m_registeredSources.find(out);
-                    it != m_registeredSources.end() && it.key() == out;
-                    ++it) {
-                it.value()->onOutputConnected(out);
-            }
-        }
-
+        err = configureDevice(&mode, &pNewMasterClockRef, &haveOutput);
+        if (err != SOUNDDEVICE_ERROR_OK) goto closeAndError;
         if (mode.isInput || mode.isOutput) {
-            device->setSampleRate(m_config.getSampleRate());
-            device->setFramesPerBuffer(m_config.getFramesPerBuffer());
             toOpen.append(mode);
         }
     }
@@ -471,13 +611,11 @@ SoundDeviceError SoundManager::setupDevices() {
                        << device->getDisplayName();
         }
 
-        int syncBuffers = m_config.getSyncBuffers();
-        // If we are in safe mode and using experimental polling support, use
-        // the default of 2 sync buffers instead.
-        if (CmdlineArgs::Instance().getSafeMode() && syncBuffers == 0) {
-            syncBuffers = 2;
+        if (pNewMasterClockRef == device) {
+            // Before the device is opened, the callback reads it
+            m_directOutputType = directOutputType(device);
         }
-        err = device->open(pNewMasterClockRef == device, syncBuffers);
+        err = device->open(pNewMasterClockRef == device, getSyncBuffers());
         if (err != SOUNDDEVICE_ERROR_OK) goto closeAndError;
         devicesNotFound.remove(device->getInternalName());
         if (mode.isOutput) {
@@ -521,6 +659,229 @@ closeAndError:
     return err;
 }
 
+SoundDeviceError SoundManager::configureDevice(DeviceMode* pMode,
+        SoundDevice** ppNewMasterClockRef, bool* pHaveOutput) {
+    SoundDevice* device = pMode->device;
+    device->clearInputs();
+    device->clearOutputs();
+    SoundDeviceError err = SOUNDDEVICE_ERROR_OK;
+    foreach (AudioInput in,
+             m_config.getInputs().values(device->getInternalName())) {
+        pMode->isInput = true;
+        // TODO(bkgood) look into allocating this with the frames per
+        // buffer value from SMConfig
+        AudioInputBuffer aib(in, SampleUtil::alloc(MAX_BUFFER_LEN));
+        err = device->addInput(aib);
+        if (err != SOUNDDEVICE_ERROR_OK) {
+            delete [] aib.getBuffer();
+            return err;
+        }
+
+        m_inputBuffers.append(aib.getBuffer());
+
+        // Check if any AudioDestination is registered for this AudioInput
+        // and call the onInputConnected method.
+        for (auto it = m_registeredDestinations.find(in);
+                it != m_registeredDestinations.end() && it.key() == in;
+                ++it) {
+            it.value()->onInputConfigured(in);
+            m_pMaster->onInputConnected(in);
+        }
+    }
+    QList<AudioOutput> outputs =
+            m_config.getOutputs().values(device->getInternalName());
+
+    // Statically connect the Network Device to the Sidechain
+    if (device->getInternalName() == kNetworkDeviceInternalName) {
+        AudioOutput out(AudioPath::RECORD_BROADCAST, 0, 2, 0);
+        outputs.append(out);
+        if (m_config.getForceNetworkClock()) {
+            *ppNewMasterClockRef = device;
+        }
+    }
+
+    foreach (AudioOutput out, outputs) {
+        pMode->isOutput = true;
+        if (device->getInternalName() != kNetworkDeviceInternalName) {
+            *pHaveOutput = true;
+        }
+        // following keeps us from asking for a channel buffer EngineMaster
+        // doesn't have -- bkgood
+        const CSAMPLE* pBuffer = m_registeredSources.value(out)->buffer(out);
+        if (pBuffer == NULL) {
+            qDebug() << "AudioSource returned null for" << out.getString();
+            continue;
+        }
+
+        AudioOutputBuffer aob(out, pBuffer);
+        err = device->addOutput(aob);
+        if (err != SOUNDDEVICE_ERROR_OK) {
+            return err;
+        }
+
+        if (!m_config.getForceNetworkClock()) {
+            if (out.getType() == AudioOutput::MASTER) {
+                *ppNewMasterClockRef = device;
+            } else if ((out.getType() == AudioOutput::DECK ||
+                        out.getType() == AudioOutput::BUS)
+                    && !*ppNewMasterClockRef) {
+                *ppNewMasterClockRef = device;
+            }
+        }
+
+        // Check if any AudioSource is registered for this AudioOutput and
+        // call the onOutputConnected method.
+        for (auto it = m_registeredSources.find(out);
+                it != m_registeredSources.end() && it.key() == out;
+                ++it) {
+            it.value()->onOutputConnected(out);
+        }
+    }
+
+    if (pMode->isInput || pMode->isOutput) {
+        device->setSampleRate(m_config.getSampleRate());
+        device->setFramesPerBuffer(m_config.getFramesPerBuffer());
+    }
+    return SOUNDDEVICE_ERROR_OK;
+}
+
+bool SoundManager::getChangedDevices(const SoundManagerConfig& oldConfig,
+        QSet<QString>* pDeviceNames) const {
+    if (oldConfig.getAPI() != m_config.getAPI() ||
+            oldConfig.getSampleRate() != m_config.getSampleRate() ||
+            oldConfig.getFramesPerBuffer() != m_config.getFramesPerBuffer() ||
+            oldConfig.getSyncBuffers() != m_config.getSyncBuffers() ||
+            oldConfig.getForceNetworkClock() ||
+            m_config.getForceNetworkClock()) {
+        return false;
+    }
+    if (m_pControlObjectSoundStatusCO->get() != SOUNDMANAGER_CONNECTED) {
+        return false;
+    }
+
+    const QMultiHash<QString, AudioInput> oldInputs = oldConfig.getInputs();
+    const QMultiHash<QString, AudioOutput> oldOutputs = oldConfig.getOutputs();
+    const QMultiHash<QString, AudioInput> newInputs = m_config.getInputs();
+    const QMultiHash<QString, AudioOutput> newOutputs = m_config.getOutputs();
+
+    bool haveMaster = false;
+    foreach (const AudioOutput& out, newOutputs) {
+        if (out.getType() == AudioPath::MASTER) {
+            haveMaster = true;
+            break;
+        }
+    }
+    if (!haveMaster) {
+        // Without a master output the clock reference may be any device
+        return false;
+    }
+
+    QSet<QString> deviceNames = oldConfig.getDevices() + m_config.getDevices();
+    pDeviceNames->clear();
+    for (const auto& deviceName: deviceNames) {
+        const QList<AudioInput> oldIn = oldInputs.values(deviceName);
+        const QList<AudioInput> newIn = newInputs.values(deviceName);
+        const QList<AudioOutput> oldOut = oldOutputs.values(deviceName);
+        const QList<AudioOutput> newOut = newOutputs.values(deviceName);
+        if (QSet<AudioInput>::fromList(oldIn) ==
+                        QSet<AudioInput>::fromList(newIn) &&
+                QSet<AudioOutput>::fromList(oldOut) ==
+                        QSet<AudioOutput>::fromList(newOut)) {
+            continue;
+        }
+        if (affectsClockReference(oldOut) || affectsClockReference(newOut)) {
+            return false;
+        }
+        pDeviceNames->insert(deviceName);
+    }
+    return true;
+}
+
+bool SoundManager::reconfigureDevices(const QSet<QString>& deviceNames) {
+    QList<SoundDevice*> devices;
+    foreach (SoundDevice* pDevice, m_devices) {
+        if (deviceNames.contains(pDevice->getInternalName())) {
+            devices.append(pDevice);
+        }
+    }
+    if (devices.size() != deviceNames.size()) {
+        // A device is not available, let setupDevices() report it
+        return false;
+    }
+    qDebug() << "SoundManager::reconfigureDevices()" << deviceNames;
+
+    // The clock reference device keeps running, but must not service the
+    // devices that are changed
+    pauseDeviceProcessing();
+    bool closed = false;
+    for (SoundDevice* pDevice: devices) {
+        if (pDevice->isOpen()) {
+            pDevice->close();
+            closed = true;
+        }
+        disconnectDevice(pDevice);
+        pDevice->clearInputs();
+        pDevice->clearOutputs();
+    }
+    resumeDeviceProcessing();
+
+    if (closed) {
+#ifdef __LINUX__
+        // See closeDevices()
+        sleep(kSleepSecondsAfterClosingDevice);
+#endif
+    }
+
+    pauseDeviceProcessing();
+    SoundDeviceError err = SOUNDDEVICE_ERROR_OK;
+    // The clock reference device is not among the changed ones, see
+    // getChangedDevices()
+    SoundDevice* pNewMasterClockRef = NULL;
+    bool haveOutput = false;
+    for (SoundDevice* pDevice: devices) {
+        DeviceMode mode = {pDevice, false, false};
+        m_pErrorDevice = pDevice;
+        err = configureDevice(&mode, &pNewMasterClockRef, &haveOutput);
+        if (err == SOUNDDEVICE_ERROR_OK && (mode.isInput || mode.isOutput)) {
+            err = pDevice->open(false, getSyncBuffers());
+        }
+        if (err != SOUNDDEVICE_ERROR_OK) {
+            break;
+        }
+    }
+    resumeDeviceProcessing();
+
+    if (err != SOUNDDEVICE_ERROR_OK) {
+        qWarning() << "Reopening" << getErrorDeviceName() << "failed:"
+                   << getLastErrorMessage(err);
+        return false;
+    }
+    m_pErrorDevice = NULL;
+    emit(devicesSetup());
+    return true;
+}
+
+void SoundManager::pauseDeviceProcessing() {
+    m_deviceProcessingPaused.fetchAndStoreOrdered(1);
+    while (m_deviceProcessingActive.loadAcquire() > 0) {
+        QThread::msleep(1);
+    }
+}
+
+void SoundManager::resumeDeviceProcessing() {
+    m_deviceProcessingPaused.fetchAndStoreOrdered(0);
+}
+
+int SoundManager::getSyncBuffers() const {
+    int syncBuffers = m_config.getSyncBuffers();
+    // If we are in safe mode and using experimental polling support, use
+    // the default of 2 sync buffers instead.
+    if (CmdlineArgs::Instance().getSafeMode() && syncBuffers == 0) {
+        syncBuffers = 2;
+    }
+    return syncBuffers;
+}
+
 SoundDevice* SoundManager::getErrorDevice() const {
     return m_pErrorDevice;
 }
@@ -557,11 +918,27 @@ SoundManagerConfig SoundManager::getConfig() const {
     return m_config;
 }
 
+CallbackProfiler* SoundManager::getCallbackProfiler() const {
+    return m_pMaster->getCallbackProfiler();
+}
+
 SoundDeviceError SoundManager::setConfig(SoundManagerConfig config) {
     SoundDeviceError err = SOUNDDEVICE_ERROR_OK;
+    finishQueryDevicesInBackground();
+    const SoundManagerConfig oldConfig = m_config;
     m_config = config;
     checkConfig();
 
+    // Only reopen the devices whose inputs or outputs have changed if the
+    // clock reference device is not affected
+    QSet<QString> changedDevices;
+    if (getChangedDevices(oldConfig, &changedDevices)) {
+        if (changedDevices.isEmpty() || reconfigureDevices(changedDevices)) {
+            m_config.writeToDisk();
+            return SOUNDDEVICE_ERROR_OK;
+        }
+    }
+
     // Close open devices. After this call we will not get any more
     // onDeviceOutputCallback() or pushBuffer() calls because all the
     // SoundDevices are closed. closeDevices() blocks and can take a while.
@@ -602,6 +979,45 @@ void SoundManager::onDeviceOutputCallback(const SINT iFramesPerBuffer) {
     m_pMaster->process(iFramesPerBuffer * 2);
 }
 
+bool SoundManager::onDeviceOutputCallback(const SINT iFramesPerBuffer,
+        CSAMPLE* pStereoOutput) {
+    if (m_directOutputType == AudioPath::INVALID) {
+        onDeviceOutputCallback(iFramesPerBuffer);
+        return false;
+    }
+    return m_pMaster->processInto(iFramesPerBuffer * 2, m_directOutputType,
+            pStereoOutput);
+}
+
+AudioPath::AudioPathType SoundManager::directOutputType(
+        const SoundDevice* pClkRefDevice) const {
+    if (pClkRefDevice->outputs().size() != 1) {
+        return AudioPath::INVALID;
+    }
+    const AudioOutputBuffer& out = pClkRefDevice->outputs().first();
+    if (out.getChannelGroup().getChannelBase() != 0 ||
+            out.getChannelGroup().getChannelCount() != 2) {
+        return AudioPath::INVALID;
+    }
+    if (out.getType() != AudioPath::MASTER &&
+            out.getType() != AudioPath::HEADPHONES) {
+        return AudioPath::INVALID;
+    }
+    // The engine buffer of the mix is not filled, so no other device may
+    // read it.
+    foreach (const SoundDevice* pDevice, m_devices) {
+        if (pDevice == pClkRefDevice) {
+            continue;
+        }
+        foreach (const AudioOutputBuffer& otherOut, pDevice->outputs()) {
+            if (otherOut.getType() == out.getType()) {
+                return AudioPath::INVALID;
+            }
+        }
+    }
+    return out.getType();
+}
+
 void SoundManager::pushInputBuffers(const QList<AudioInputBuffer>& inputs,
                                     const SINT iFramesPerBuffer) {
    for (QList<AudioInputBuffer>::ConstIterator i = inputs.begin(),
@@ -617,23 +1033,31 @@ void SoundManager::pushInputBuffers(const QList<AudioInputBuffer>& inputs,
 }
 
 void SoundManager::writeProcess() {
-    QListIterator<SoundDevice*> dev_it(m_devices);
-    while (dev_it.hasNext()) {
-        SoundDevice* device = dev_it.next();
-        if (device) {
-            device->writeProcess();
+    m_deviceProcessingActive.ref();
+    if (!m_deviceProcessingPaused.loadAcquire()) {
+        QListIterator<SoundDevice*> dev_it(m_devices);
+        while (dev_it.hasNext()) {
+            SoundDevice* device = dev_it.next();
+            if (device) {
+                device->writeProcess();
+            }
         }
     }
+    m_deviceProcessingActive.deref();
 }
 
 void SoundManager::readProcess() {
-    QListIterator<SoundDevice*> dev_it(m_devices);
-    while (dev_it.hasNext()) {
-        SoundDevice* device = dev_it.next();
-        if (device) {
-            device->readProcess();
+    m_deviceProcessingActive.ref();
+    if (!m_deviceProcessingPaused.loadAcquire()) {
+        QListIterator<SoundDevice*> dev_it(m_devices);
+        while (dev_it.hasNext()) {
+            SoundDevice* device = dev_it.next();
+            if (device) {
+                device->readProcess();
+            }
         }
     }
+    m_deviceProcessingActive.deref();
 }
 
 void SoundManager::registerOutput(AudioOutput output, AudioSource *src) {
@@ -664,7 +1088,27 @@ QList<AudioInput> SoundManager::registeredInputs() const {
     return m_registeredDestinations.keys();
 }
 
-void SoundManager::setJACKName() const {
+// static
+void SoundManager::initializePortAudioInBackground() {
+#ifdef __PORTAUDIO__
+#ifndef __WINDOWS__
+    // The host APIs on Windows initialize COM for the thread that calls
+    // Pa_Initialize(), which must be the thread that opens the devices
+    QMutexLocker locker(&s_paInitializationMutex);
+    if (s_paInitializationPending) {
+        return;
+    }
+#ifdef Q_OS_LINUX
+    setJACKName();
+#endif
+    s_paInitialization = QtConcurrent::run(&Pa_Initialize);
+    s_paInitializationPending = true;
+#endif
+#endif
+}
+
+// static
+void SoundManager::setJACKName() {
 #ifdef __PORTAUDIO__
 #ifdef Q_OS_LINUX
     typedef PaError (*SetJackClientName)(const char *name);
@@ -705,6 +1149,8 @@ void SoundManager::processUnderflowHappened() {
             m_pMasterAudioLatencyOverload->set(1.0);
             m_pMasterAudioLatencyOverloadCount->set(
                     m_pMasterAudioLatencyOverloadCount->get() + 1);
+            s_xrunCounter.increment();
+            FlightRecorder::requestDump("xrun");
             m_underflowUpdateCount = CPU_OVERLOAD_DURATION * m_config.getSampleRate()
                     / m_config.getFramesPerBuffer() / 1000;
 
@@ -24,6 +24,8 @@
 #include <QList>
 #include <QHash>
 #include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QAtomicInt>
 
 #include "preferences/usersettings.h"
 #include "engine/sidechain/enginenetworkstream.h"
@@ -33,6 +35,7 @@
 #include "util/types.h"
 #include "util/cmdlineargs.h"
 
+class CallbackProfiler;
 class EngineMaster;
 class AudioOutput;
 class AudioInput;
@@ -48,6 +51,8 @@ class SoundDeviceNotFound;
 #define MIXXX_PORTAUDIO_ASIO_STRING "ASIO"
 #define MIXXX_PORTAUDIO_DIRECTSOUND_STRING "Windows DirectSound"
 #define MIXXX_PORTAUDIO_COREAUDIO_STRING "Core Audio"
+// The host API of SoundDeviceJack, which does not use PortAudio
+#define MIXXX_JACK_NATIVE_STRING "JACK Audio Connection Kit (native)"
 
 #define SOUNDMANAGER_DISCONNECTED 0
 #define SOUNDMANAGER_CONNECTING 1
@@ -64,10 +69,21 @@ class SoundManager : public QObject {
     // bOutputDevices or bInputDevices are set, respectively.
     QList<SoundDevice*> getDeviceList(QString filterAPI, bool bOutputDevices, bool bInputDevices);
 
+    // Starts initializing PortAudio in the global thread pool while Mixxx
+    // starts up. The SoundManager waits for it when it queries the devices.
+    static void initializePortAudioInBackground();
+
     // Creates a list of sound devices
     void clearAndQueryDevices();
+    // Like clearAndQueryDevices(), but PortAudio enumerates the devices in
+    // the global thread pool. The old devices are closed and stay in the
+    // list until devicesUpdated() is emitted with the new ones, they must not
+    // be opened in the meantime. Blocks on Windows, see
+    // initializePortAudioInBackground().
+    void clearAndQueryDevicesInBackground();
     void queryDevices();
     void queryDevicesPortaudio();
+    void queryDevicesJack();
     void queryDevicesMixxx();
 
     // Opens all the devices chosen by the user in the preferences dialog, and
@@ -91,10 +107,19 @@ class SoundManager : public QObject {
     // Get a list of host APIs supported by PortAudio.
     QList<QString> getHostAPIList() const;
     SoundManagerConfig getConfig() const;
+
+    // The profiler of the engine that is driven by the clock reference device
+    CallbackProfiler* getCallbackProfiler() const;
     SoundDeviceError setConfig(SoundManagerConfig config);
     void checkConfig();
 
     void onDeviceOutputCallback(const SINT iFramesPerBuffer);
+    // Called by the clock reference device instead of the above if it has an
+    // interleaved stereo buffer. If the engine can render the only output of
+    // the device directly into pStereoOutput, it does so and returns true.
+    // Otherwise the device has to compose its output buffer as usual.
+    bool onDeviceOutputCallback(const SINT iFramesPerBuffer,
+            CSAMPLE* pStereoOutput);
 
     // Used by SoundDevices to "push" any audio from their inputs that they have
     // into the mixing engine.
@@ -125,6 +150,11 @@ class SoundManager : public QObject {
 
     void processUnderflowHappened();
 
+  private slots:
+    // Replaces the device list once the background query has finished.
+    // Waits for it if called before, does nothing if there is none.
+    void finishQueryDevicesInBackground();
+
   signals:
     void devicesUpdated(); // emitted when pointers to SoundDevices go stale
     void devicesSetup(); // emitted when the sound devices have been set up
@@ -132,6 +162,12 @@ class SoundManager : public QObject {
     void inputRegistered(AudioInput input, AudioDestination *dest);
 
   private:
+    struct DeviceMode {
+        SoundDevice* device;
+        bool isInput;
+        bool isOutput;
+    };
+
     // Closes all the devices and empties the list of devices we have.
     void clearDeviceList(bool sleepAfterClosing);
 
@@ -141,12 +177,49 @@ class SoundManager : public QObject {
     // isn't open is safe.
     void closeDevices(bool sleepAfterClosing);
 
-    void setJACKName() const;
+    // Connects the configured inputs and outputs of pMode->device and sets
+    // isInput and isOutput. Updates *ppNewMasterClockRef and *pHaveOutput
+    // like setupDevices() does for all devices.
+    SoundDeviceError configureDevice(DeviceMode* pMode,
+            SoundDevice** ppNewMasterClockRef, bool* pHaveOutput);
+
+    // Tells the AudioSources and AudioDestinations of the device that it
+    // is disconnected, and frees its input buffers. The device must be
+    // closed.
+    void disconnectDevice(SoundDevice* pDevice);
+
+    // Closes and reopens only the given devices while the others keep
+    // running. Returns false if a device could not be reopened, the
+    // remaining devices must be set up again with setupDevices() then.
+    bool reconfigureDevices(const QSet<QString>& deviceNames);
+
+    // The names of the devices that have to be reopened when changing from
+    // oldConfig to m_config without touching the clock reference device.
+    // Returns false if all devices have to be reopened.
+    bool getChangedDevices(const SoundManagerConfig& oldConfig,
+            QSet<QString>* pDeviceNames) const;
+
+    // Keeps the clock reference device from servicing the other devices in
+    // readProcess() and writeProcess(), see reconfigureDevices(). Waits for
+    // a running readProcess() or writeProcess() to return.
+    void pauseDeviceProcessing();
+    void resumeDeviceProcessing();
+
+    int getSyncBuffers() const;
+
+    static void setJACKName();
+
+    // The type of the output that can be rendered directly into the buffer
+    // of the clock reference device, or INVALID
+    AudioPath::AudioPathType directOutputType(
+            const SoundDevice* pClkRefDevice) const;
 
     EngineMaster *m_pMaster;
     UserSettingsPointer m_pConfig;
 #ifdef __PORTAUDIO__
     bool m_paInitialized;
+#endif
+#if defined(__PORTAUDIO__) || defined(__JACK__)
     unsigned int m_jackSampleRate;
 #endif
     QList<SoundDevice*> m_devices;
@@ -155,12 +228,15 @@ class SoundManager : public QObject {
 
     SoundManagerConfig m_config;
     SoundDevice* m_pErrorDevice;
+    AudioPath::AudioPathType m_directOutputType;
     QHash<AudioOutput, AudioSource*> m_registeredSources;
     QHash<AudioInput, AudioDestination*> m_registeredDestinations;
     ControlObject* m_pControlObjectSoundStatusCO;
     ControlObject* m_pControlObjectVinylControlGainCO;
 
     QSharedPointer<EngineNetworkStream> m_pNetworkStream;
+    NetworkOutputStreamWorkerPtr m_pNetworkAudioSender;
+    std::unique_ptr<NetworkInputStreamWorker> m_pNetworkAudioReceiver;
 
     QAtomicInt m_underflowHappened;
     int m_underflowUpdateCount;
@@ -168,6 +244,13 @@ class SoundManager : public QObject {
     ControlProxy* m_pMasterAudioLatencyOverload;
 
     std::unique_ptr<SoundDeviceNotFound> m_soundDeviceNotFound;
+
+#ifdef __PORTAUDIO__
+    QFutureWatcher<int> m_deviceQueryWatcher;
+    bool m_bDeviceQueryPending;
+#endif
+    QAtomicInt m_deviceProcessingPaused;
+    QAtomicInt m_deviceProcessingActive;
 };
 
 #endif
@@ -191,14 +191,29 @@ class AudioSource: public UrlResource, public AudioSignal, public virtual /*impl
     class OpenParams : public AudioSignal {
       public:
         OpenParams()
-            : AudioSignal(kSampleLayout) {
+            : AudioSignal(kSampleLayout),
+              m_sequentialAccess(false) {
         }
         OpenParams(ChannelCount channelCount, SampleRate sampleRate)
-            : AudioSignal(kSampleLayout, channelCount, sampleRate) {
+            : AudioSignal(kSampleLayout, channelCount, sampleRate),
+              m_sequentialAccess(false) {
         }
 
         using AudioSignal::setChannelCount;
         using AudioSignal::setSampleRate;
+
+        // A hint that the audio data will be read once from start to
+        // end, e.g. for analysis. Decoders may then spend additional
+        // resources like threads on reading faster.
+        bool sequentialAccess() const {
+            return m_sequentialAccess;
+        }
+        void setSequentialAccess(bool sequentialAccess) {
+            m_sequentialAccess = sequentialAccess;
+        }
+
+      private:
+        bool m_sequentialAccess;
     };
 
     // Opens the AudioSource for reading audio data.
@@ -350,6 +365,22 @@ class AudioSource: public UrlResource, public AudioSignal, public virtual /*impl
         return that.open(mode, params);
     }
 
+    // For decoders that are able to convert the signal to stereo while
+    // copying the decoded samples, which saves the caller another pass
+    // over the samples. Returns the channel count of the signal that
+    // should be produced for the requested channel count. Mono signals
+    // are only converted if stereo has been requested explicitly.
+    static ChannelCount stereoDecodingChannelCount(
+            ChannelCount streamChannelCount,
+            ChannelCount requestedChannelCount) {
+        if (requestedChannelCount.valid() &&
+                (requestedChannelCount <= 2) &&
+                ((requestedChannelCount == 2) || (streamChannelCount > 2))) {
+            return ChannelCount(2);
+        }
+        return streamChannelCount;
+    }
+
   private:
     AudioSource(AudioSource&&) = delete;
     AudioSource& operator=(const AudioSource&) = delete;
@@ -0,0 +1,206 @@
+#include "sources/audiosourceresampler.h"
+
+#include <cmath>
+
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/sample.h"
+
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("AudioSourceResampler");
+
+// The frames before and after each position when the sample rate is
+// increased. The filter gets wider with the factor when it is decreased,
+// which keeps the transition band at the same fraction of the lower
+// Nyquist frequency.
+const int kMinHalfTaps = 32;
+
+// The fraction of the lower Nyquist frequency that is passed
+const double kCutoff = 0.95;
+
+// About 90 dB stopband attenuation
+const double kKaiserBeta = 9.0;
+
+// The number of fractional positions between two source frames with
+// precomputed coefficients, the coefficients in between are interpolated
+const int kPhases = 512;
+
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        const double factor = x / (2 * k);
+        term *= factor * factor;
+        sum += term;
+    }
+    return sum;
+}
+
+double kaiserWindow(double x) {
+    // x is within [-1, 1]
+    const double r = math_max(0.0, 1.0 - x * x);
+    return besselI0(kKaiserBeta * sqrt(r)) / besselI0(kKaiserBeta);
+}
+
+double sinc(double x) {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    return sin(M_PI * x) / (M_PI * x);
+}
+
+IndexRange resampledFrameIndexRange(
+        IndexRange sourceFrameIndexRange, double sourceFramesPerFrame) {
+    if (sourceFrameIndexRange.empty()) {
+        return IndexRange();
+    }
+    // All frames whose source position is within the source frames
+    const SINT start = static_cast<SINT>(
+            ceil(sourceFrameIndexRange.start() / sourceFramesPerFrame));
+    const SINT end = static_cast<SINT>(
+            floor((sourceFrameIndexRange.end() - 1) / sourceFramesPerFrame)) + 1;
+    return IndexRange::between(start, math_max(start, end));
+}
+
+} // anonymous namespace
+
+AudioSourceResampler::AudioSourceResampler(
+        AudioSourcePointer pAudioSource,
+        SampleRate sampleRate)
+    : AudioSource(pAudioSource->getUrl()),
+      m_pAudioSource(std::move(pAudioSource)),
+      m_sourceFramesPerFrame(
+              double(m_pAudioSource->sampleRate()) / double(sampleRate)),
+      m_halfTaps(static_cast<int>(
+              ceil(kMinHalfTaps * math_max(1.0, m_sourceFramesPerFrame)))),
+      m_tempCoefficients(2 * m_halfTaps) {
+    setChannelCount(m_pAudioSource->channelCount());
+    setSampleRate(sampleRate);
+    initFrameIndexRangeOnce(resampledFrameIndexRange(
+            m_pAudioSource->frameIndexRange(), m_sourceFramesPerFrame));
+    initBitrateOnce(m_pAudioSource->bitrate());
+
+    // The cutoff is relative to the source Nyquist frequency
+    const double cutoff = kCutoff / math_max(1.0, m_sourceFramesPerFrame);
+    const int taps = 2 * m_halfTaps;
+    m_coefficients.resize((kPhases + 1) * taps);
+    for (int phase = 0; phase <= kPhases; ++phase) {
+        const double frac = double(phase) / kPhases;
+        CSAMPLE* pRow = &m_coefficients[phase * taps];
+        double sum = 0.0;
+        for (int tap = 0; tap < taps; ++tap) {
+            const double distance = tap - (m_halfTaps - 1) - frac;
+            const double coefficient = cutoff * sinc(cutoff * distance) *
+                    kaiserWindow(distance / m_halfTaps);
+            pRow[tap] = static_cast<CSAMPLE>(coefficient);
+            sum += coefficient;
+        }
+        // Unity gain for DC at all positions
+        for (int tap = 0; tap < taps; ++tap) {
+            pRow[tap] = static_cast<CSAMPLE>(pRow[tap] / sum);
+        }
+    }
+}
+
+ReadableSampleFrames AudioSourceResampler::readSampleFramesClamped(
+        WritableSampleFrames writableSampleFrames) {
+    const auto frameIndexRange = writableSampleFrames.frameIndexRange();
+    if (writableSampleFrames.writableLength() < frames2samples(frameIndexRange.length())) {
+        // Skipping frames, nothing to compute
+        return ReadableSampleFrames(frameIndexRange);
+    }
+
+    // The source frames around the source positions of the frames
+    const SINT sourceStart = static_cast<SINT>(
+            floor(sourcePosition(frameIndexRange.start()))) - (m_halfTaps - 1);
+    const SINT sourceEnd = static_cast<SINT>(
+            floor(sourcePosition(frameIndexRange.end() - 1))) + m_halfTaps + 1;
+    const SINT sourceSamples = frames2samples(sourceEnd - sourceStart);
+    if (m_tempSampleBuffer.size() < sourceSamples) {
+        SampleBuffer(sourceSamples).swap(m_tempSampleBuffer);
+    }
+    // Silence before the first and after the last source frame
+    SampleUtil::clear(m_tempSampleBuffer.data(), sourceSamples);
+    const auto sourceFrameIndexRange = intersect(
+            IndexRange::between(sourceStart, sourceEnd),
+            m_pAudioSource->frameIndexRange());
+    if (sourceFrameIndexRange.empty()) {
+        return ReadableSampleFrames(IndexRange::between(
+                frameIndexRange.start(), frameIndexRange.start()));
+    }
+    const auto readableSourceFrames = readSampleFramesClampedOn(
+            *m_pAudioSource,
+            WritableSampleFrames(
+                    sourceFrameIndexRange,
+                    SampleBuffer::WritableSlice(
+                            m_tempSampleBuffer.data(
+                                    frames2samples(sourceFrameIndexRange.start() - sourceStart)),
+                            frames2samples(sourceFrameIndexRange.length()))));
+    const auto readSourceFrameIndexRange = readableSourceFrames.frameIndexRange();
+    if (readSourceFrameIndexRange != sourceFrameIndexRange) {
+        kLogger.warning()
+                << "Failed to read source frames"
+                << sourceFrameIndexRange
+                << "actual =" << readSourceFrameIndexRange;
+    }
+    if (readSourceFrameIndexRange.empty()) {
+        return ReadableSampleFrames(IndexRange::between(
+                frameIndexRange.start(), frameIndexRange.start()));
+    }
+    if (readableSourceFrames.readableData() != m_tempSampleBuffer.data(
+            frames2samples(readSourceFrameIndexRange.start() - sourceStart))) {
+        // The source did not decode in place
+        SampleUtil::copy(
+                m_tempSampleBuffer.data(
+                        frames2samples(readSourceFrameIndexRange.start() - sourceStart)),
+                readableSourceFrames.readableData(),
+                frames2samples(readSourceFrameIndexRange.length()));
+    }
+
+    // Only the frames whose source position has been read
+    SINT end = frameIndexRange.end();
+    while (end > frameIndexRange.start() &&
+            (sourcePosition(end - 1) >= readSourceFrameIndexRange.end() ||
+                    sourcePosition(end - 1) < readSourceFrameIndexRange.start())) {
+        --end;
+    }
+    const auto resampledFrameIndexRange =
+            IndexRange::between(frameIndexRange.start(), end);
+
+    const int taps = 2 * m_halfTaps;
+    const SINT channels = channelCount();
+    CSAMPLE* pOutput = writableSampleFrames.writableData();
+    for (SINT frameIndex = resampledFrameIndexRange.start();
+            frameIndex < resampledFrameIndexRange.end(); ++frameIndex) {
+        const double position = sourcePosition(frameIndex);
+        const SINT floorFrame = static_cast<SINT>(floor(position));
+        const double phasePosition = (position - floorFrame) * kPhases;
+        const int phase = math_min(static_cast<int>(phasePosition), kPhases - 1);
+        const CSAMPLE frac = static_cast<CSAMPLE>(phasePosition - phase);
+        const CSAMPLE* pRow = &m_coefficients[phase * taps];
+        const CSAMPLE* pNextRow = pRow + taps;
+        for (int tap = 0; tap < taps; ++tap) {
+            m_tempCoefficients[tap] = pRow[tap] + frac * (pNextRow[tap] - pRow[tap]);
+        }
+        const CSAMPLE* pInput = m_tempSampleBuffer.data(
+                frames2samples(floorFrame - (m_halfTaps - 1) - sourceStart));
+        for (SINT channel = 0; channel < channels; ++channel) {
+            CSAMPLE sum = 0;
+            for (int tap = 0; tap < taps; ++tap) {
+                sum += m_tempCoefficients[tap] * pInput[tap * channels + channel];
+            }
+            *pOutput++ = sum;
+        }
+    }
+    return ReadableSampleFrames(
+            resampledFrameIndexRange,
+            SampleBuffer::ReadableSlice(
+                    writableSampleFrames.writableData(),
+                    frames2samples(resampledFrameIndexRange.length())));
+}
+
+} // namespace mixxx
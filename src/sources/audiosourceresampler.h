@@ -0,0 +1,77 @@
+#ifndef MIXXX_AUDIOSOURCERESAMPLER_H
+#define MIXXX_AUDIOSOURCERESAMPLER_H
+
+
+#include <vector>
+
+#include "sources/audiosource.h"
+
+
+namespace mixxx {
+
+// Converts the sample rate of an opened audio source with a Kaiser
+// windowed sinc filter. The filter is wide enough for an offline
+// conversion, i.e. it is meant for decoding tracks in the background and
+// not for the engine callback.
+//
+// Each read is computed from the source frames around the requested
+// frames only, so the frames can be read in any order just like those
+// of the decoders, e.g. chunk by chunk by the CachingReader. The frame
+// with index i corresponds to the source position i * sourceFramesPerFrame().
+class AudioSourceResampler: public AudioSource {
+  public:
+    static AudioSourcePointer create(
+            AudioSourcePointer pAudioSource,
+            SampleRate sampleRate) {
+        return std::make_shared<AudioSourceResampler>(
+                std::move(pAudioSource),
+                sampleRate);
+    }
+
+    AudioSourceResampler(
+            AudioSourcePointer pAudioSource,
+            SampleRate sampleRate);
+
+    void close() override {
+        m_pAudioSource->close();
+    }
+
+    double sourceFramesPerFrame() const {
+        return m_sourceFramesPerFrame;
+    }
+
+  protected:
+    OpenResult tryOpen(
+            OpenMode mode,
+            const OpenParams& params) override {
+        return tryOpenOn(*m_pAudioSource, mode, params);
+    }
+
+    ReadableSampleFrames readSampleFramesClamped(
+            WritableSampleFrames writableSampleFrames) override;
+
+  private:
+    // The source position of a frame
+    double sourcePosition(SINT frameIndex) const {
+        return frameIndex * m_sourceFramesPerFrame;
+    }
+
+    AudioSourcePointer m_pAudioSource;
+    const double m_sourceFramesPerFrame;
+
+    // Half of the taps of the filter, the frames before and after each
+    // source position
+    const int m_halfTaps;
+    // The filter coefficients of the fractional source positions, each
+    // row contains 2 * m_halfTaps coefficients
+    std::vector<CSAMPLE> m_coefficients;
+
+    // The source frames that are needed for a read
+    SampleBuffer m_tempSampleBuffer;
+    std::vector<CSAMPLE> m_tempCoefficients;
+};
+
+} // namespace mixxx
+
+
+#endif // MIXXX_AUDIOSOURCERESAMPLER_H
@@ -106,7 +106,7 @@ ReadableSampleFrames AudioSourceStereoProxy::readSampleFramesClamped(
                 readableSampleFrames.readableData(),
                 readableSampleFrames.frameLength());
     } else {
-        SampleUtil::copyMultiToStereo(
+        SampleUtil::copyDownmixToStereo(
                 writableSlice.data(),
                 readableSampleFrames.readableData(),
                 readableSampleFrames.frameLength(),
@@ -27,14 +27,29 @@ class MetadataSource {
         Unavailable,
     };
 
+    // The fields of the track metadata that are imported. Parsing the
+    // audio properties of some formats requires to scan the audio stream.
+    enum ImportFieldTypes {
+        // Channels, sample rate, bitrate and duration
+        IMPORT_AUDIO_PROPERTIES = 0x01,
+        // Track and album info from the tags
+        IMPORT_TAGS = 0x02,
+        IMPORT_ALL_FIELDS = IMPORT_AUDIO_PROPERTIES | IMPORT_TAGS,
+    };
+    typedef int ImportFields;
+
     // Read both track metadata and cover art at once, because this
     // is the most common use case. Both pointers are output parameters
     // and might be passed a nullptr if their result is not needed.
+    // Only the selected fields of the track metadata are imported, the
+    // other fields are not modified. Cover art, which is the largest
+    // part of the tags, is only loaded if an image is passed.
     // If no metadata is available for a track then the source should
     // return Unavailable as this default implementation does.
     virtual std::pair<ImportResult, QDateTime> importTrackMetadataAndCoverImage(
             TrackMetadata* /*pTrackMetadata*/,
-            QImage* /*pCoverImage*/) const {
+            QImage* /*pCoverImage*/,
+            ImportFields /*importFields*/) const {
         return std::make_pair(ImportResult::Unavailable, QDateTime());
     }
 
@@ -43,8 +43,8 @@ const QString kSafelyWritableOrigFileSuffix = "_orig";
 //
 class AiffFile: public TagLib::RIFF::AIFF::File {
   public:
-    explicit AiffFile(TagLib::FileName fileName)
-        : TagLib::RIFF::AIFF::File(fileName) {
+    explicit AiffFile(TagLib::FileName fileName, bool readProperties = true)
+        : TagLib::RIFF::AIFF::File(fileName, readProperties) {
     }
 
     void importTrackMetadataFromTextChunks(TrackMetadata* pTrackMetadata) /*non-const*/ {
@@ -99,8 +99,14 @@ MetadataSourceTagLib::afterExportSucceeded() const {
 std::pair<MetadataSource::ImportResult, QDateTime>
 MetadataSourceTagLib::importTrackMetadataAndCoverImage(
         TrackMetadata* pTrackMetadata,
-        QImage* pCoverImage) const {
-    VERIFY_OR_DEBUG_ASSERT(pTrackMetadata || pCoverImage) {
+        QImage* pCoverImage,
+        ImportFields importFields) const {
+    // Only the selected fields are imported
+    TrackMetadata* const pAudioProperties =
+            (importFields & IMPORT_AUDIO_PROPERTIES) ? pTrackMetadata : nullptr;
+    TrackMetadata* const pTags =
+            (importFields & IMPORT_TAGS) ? pTrackMetadata : nullptr;
+    VERIFY_OR_DEBUG_ASSERT(pAudioProperties || pTags || pCoverImage) {
         kLogger.warning()
                 << "Nothing to import"
                 << "from file" << m_fileName
@@ -108,7 +114,7 @@ MetadataSourceTagLib::importTrackMetadataAndCoverImage(
         return std::make_pair(MetadataSource::ImportResult::Unavailable, QDateTime());
     }
     kLogger.trace() << "Importing"
-            << ((pTrackMetadata && pCoverImage) ? "track metadata and cover art" : (pTrackMetadata ? "track metadata" : "cover art"))
+            << (((pAudioProperties || pTags) && pCoverImage) ? "track metadata and cover art" : ((pAudioProperties || pTags) ? "track metadata" : "cover art"))
             << "from file" << m_fileName
             << "with type" << m_fileType;
 
@@ -118,29 +124,33 @@ MetadataSourceTagLib::importTrackMetadataAndCoverImage(
     // from the same tag types. Only the first available tag type
     // is read and data in subsequent tags is ignored.
 
+    // TagLib scans the audio stream of some formats for the audio
+    // properties, e.g. MP3 files without a Xing/VBRI header.
+    const bool readProperties = pAudioProperties != nullptr;
+
     switch (m_fileType) {
     case taglib::FileType::MP3:
     {
-        TagLib::MPEG::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName));
-        if (taglib::readAudioProperties(pTrackMetadata, file)) {
+        TagLib::MPEG::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName), readProperties);
+        if (taglib::readAudioProperties(pAudioProperties, file)) {
             const TagLib::ID3v2::Tag* pID3v2Tag =
                     taglib::hasID3v2Tag(file) ? file.ID3v2Tag() : nullptr;
             if (pID3v2Tag) {
-                taglib::importTrackMetadataFromID3v2Tag(pTrackMetadata, *pID3v2Tag);
+                taglib::importTrackMetadataFromID3v2Tag(pTags, *pID3v2Tag);
                 taglib::importCoverImageFromID3v2Tag(pCoverImage, *pID3v2Tag);
                 return afterImportSucceeded();
             } else {
                 const TagLib::APE::Tag* pAPETag =
                         taglib::hasAPETag(file) ? file.APETag() : nullptr;
                 if (pAPETag) {
-                    taglib::importTrackMetadataFromAPETag(pTrackMetadata, *pAPETag);
+                    taglib::importTrackMetadataFromAPETag(pTags, *pAPETag);
                     taglib::importCoverImageFromAPETag(pCoverImage, *pAPETag);
                     return afterImportSucceeded();
                 } else {
                     // fallback
                     const TagLib::Tag* pTag(file.tag());
                     if (pTag) {
-                        taglib::importTrackMetadataFromTag(pTrackMetadata, *pTag);
+                        taglib::importTrackMetadataFromTag(pTags, *pTag);
                         return afterImportSucceeded();
                     }
                 }
@@ -150,18 +160,18 @@ MetadataSourceTagLib::importTrackMetadataAndCoverImage(
     }
     case taglib::FileType::MP4:
     {
-        TagLib::MP4::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName));
-        if (taglib::readAudioProperties(pTrackMetadata, file)) {
+        TagLib::MP4::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName), readProperties);
+        if (taglib::readAudioProperties(pAudioProperties, file)) {
             const TagLib::MP4::Tag* pMP4Tag = file.tag();
             if (pMP4Tag) {
-                taglib::importTrackMetadataFromMP4Tag(pTrackMetadata, *pMP4Tag);
+                taglib::importTrackMetadataFromMP4Tag(pTags, *pMP4Tag);
                 taglib::importCoverImageFromMP4Tag(pCoverImage, *pMP4Tag);
                 return afterImportSucceeded();
             } else {
                 // fallback
                 const TagLib::Tag* pTag(file.tag());
                 if (pTag) {
-                    taglib::importTrackMetadataFromTag(pTrackMetadata, *pTag);
+                    taglib::importTrackMetadataFromTag(pTags, *pTag);
                     return afterImportSucceeded();
                 }
             }
@@ -170,32 +180,32 @@ MetadataSourceTagLib::importTrackMetadataAndCoverImage(
     }
     case taglib::FileType::FLAC:
     {
-        TagLib::FLAC::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName));
+        TagLib::FLAC::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName), readProperties);
         // Read cover art directly from the file first. Will be
         // overwritten with cover art contained in on of the tags.
         if (pCoverImage != nullptr) {
             *pCoverImage = taglib::importCoverImageFromVorbisCommentPictureList(file.pictureList());
         }
-        if (taglib::readAudioProperties(pTrackMetadata, file)) {
+        if (taglib::readAudioProperties(pAudioProperties, file)) {
             // VorbisComment tag takes precedence over ID3v2 tag
             TagLib::Ogg::XiphComment* pXiphComment =
                     taglib::hasXiphComment(file) ? file.xiphComment() : nullptr;
             if (pXiphComment) {
-                taglib::importTrackMetadataFromVorbisCommentTag(pTrackMetadata, *pXiphComment);
+                taglib::importTrackMetadataFromVorbisCommentTag(pTags, *pXiphComment);
                 taglib::importCoverImageFromVorbisCommentTag(pCoverImage, *pXiphComment);
                 return afterImportSucceeded();
             } else {
                 const TagLib::ID3v2::Tag* pID3v2Tag =
                         taglib::hasID3v2Tag(file) ? file.ID3v2Tag() : nullptr;
                 if (pID3v2Tag) {
-                    taglib::importTrackMetadataFromID3v2Tag(pTrackMetadata, *pID3v2Tag);
+                    taglib::importTrackMetadataFromID3v2Tag(pTags, *pID3v2Tag);
                     taglib::importCoverImageFromID3v2Tag(pCoverImage, *pID3v2Tag);
                     return afterImportSucceeded();
                 } else {
                     // fallback
                     const TagLib::Tag* pTag(file.tag());
                     if (pTag) {
-                        taglib::importTrackMetadataFromTag(pTrackMetadata, *pTag);
+                        taglib::importTrackMetadataFromTag(pTags, *pTag);
                         return afterImportSucceeded();
                     }
                 }
@@ -205,18 +215,18 @@ MetadataSourceTagLib::importTrackMetadataAndCoverImage(
     }
     case taglib::FileType::OGG:
     {
-        TagLib::Ogg::Vorbis::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName));
-        if (taglib::readAudioProperties(pTrackMetadata, file)) {
+        TagLib::Ogg::Vorbis::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName), readProperties);
+        if (taglib::readAudioProperties(pAudioProperties, file)) {
             TagLib::Ogg::XiphComment* pXiphComment = file.tag();
             if (pXiphComment) {
-                taglib::importTrackMetadataFromVorbisCommentTag(pTrackMetadata, *pXiphComment);
+                taglib::importTrackMetadataFromVorbisCommentTag(pTags, *pXiphComment);
                 taglib::importCoverImageFromVorbisCommentTag(pCoverImage, *pXiphComment);
                 return afterImportSucceeded();
             } else {
                 // fallback
                 const TagLib::Tag* pTag(file.tag());
                 if (pTag) {
-                    taglib::importTrackMetadataFromTag(pTrackMetadata, *pTag);
+                    taglib::importTrackMetadataFromTag(pTags, *pTag);
                     return afterImportSucceeded();
                 }
             }
@@ -226,18 +236,18 @@ MetadataSourceTagLib::importTrackMetadataAndCoverImage(
 #if (TAGLIB_HAS_OPUSFILE)
     case taglib::FileType::OPUS:
     {
-        TagLib::Ogg::Opus::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName));
-        if (taglib::readAudioProperties(pTrackMetadata, file)) {
+        TagLib::Ogg::Opus::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName), readProperties);
+        if (taglib::readAudioProperties(pAudioProperties, file)) {
             TagLib::Ogg::XiphComment* pXiphComment = file.tag();
             if (pXiphComment) {
-                taglib::importTrackMetadataFromVorbisCommentTag(pTrackMetadata, *pXiphComment);
+                taglib::importTrackMetadataFromVorbisCommentTag(pTags, *pXiphComment);
                 taglib::importCoverImageFromVorbisCommentTag(pCoverImage, *pXiphComment);
                  return afterImportSucceeded();
             } else {
                 // fallback
                 const TagLib::Tag* pTag(file.tag());
                 if (pTag) {
-                    taglib::importTrackMetadataFromTag(pTrackMetadata, *pTag);
+                    taglib::importTrackMetadataFromTag(pTags, *pTag);
                     return afterImportSucceeded();
                 }
             }
@@ -247,19 +257,19 @@ MetadataSourceTagLib::importTrackMetadataAndCoverImage(
 #endif // TAGLIB_HAS_OPUSFILE
     case taglib::FileType::WV:
     {
-        TagLib::WavPack::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName));
-        if (taglib::readAudioProperties(pTrackMetadata, file)) {
+        TagLib::WavPack::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName), readProperties);
+        if (taglib::readAudioProperties(pAudioProperties, file)) {
             const TagLib::APE::Tag* pAPETag =
                     taglib::hasAPETag(file) ? file.APETag() : nullptr;
             if (pAPETag) {
-                taglib::importTrackMetadataFromAPETag(pTrackMetadata, *pAPETag);
+                taglib::importTrackMetadataFromAPETag(pTags, *pAPETag);
                 taglib::importCoverImageFromAPETag(pCoverImage, *pAPETag);
                 return afterImportSucceeded();
             } else {
                 // fallback
                 const TagLib::Tag* pTag(file.tag());
                 if (pTag) {
-                    taglib::importTrackMetadataFromTag(pTrackMetadata, *pTag);
+                    taglib::importTrackMetadataFromTag(pTags, *pTag);
                     return afterImportSucceeded();
                 }
             }
@@ -268,8 +278,8 @@ MetadataSourceTagLib::importTrackMetadataAndCoverImage(
     }
     case taglib::FileType::WAV:
     {
-        TagLib::RIFF::WAV::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName));
-        if (taglib::readAudioProperties(pTrackMetadata, file)) {
+        TagLib::RIFF::WAV::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName), readProperties);
+        if (taglib::readAudioProperties(pAudioProperties, file)) {
 #if (TAGLIB_HAS_WAV_ID3V2TAG)
             const TagLib::ID3v2::Tag* pID3v2Tag =
                     file.hasID3v2Tag() ? file.ID3v2Tag() : nullptr;
@@ -277,14 +287,14 @@ MetadataSourceTagLib::importTrackMetadataAndCoverImage(
             const TagLib::ID3v2::Tag* pID3v2Tag = file.tag();
 #endif
             if (pID3v2Tag) {
-                taglib::importTrackMetadataFromID3v2Tag(pTrackMetadata, *pID3v2Tag);
+                taglib::importTrackMetadataFromID3v2Tag(pTags, *pID3v2Tag);
                 taglib::importCoverImageFromID3v2Tag(pCoverImage, *pID3v2Tag);
                 return afterImportSucceeded();
             } else {
                 // fallback
                 const TagLib::RIFF::Info::Tag* pTag = file.InfoTag();
                 if (pTag) {
-                    taglib::importTrackMetadataFromRIFFTag(pTrackMetadata, *pTag);
+                    taglib::importTrackMetadataFromRIFFTag(pTags, *pTag);
                     return afterImportSucceeded();
                 }
             }
@@ -293,19 +303,19 @@ MetadataSourceTagLib::importTrackMetadataAndCoverImage(
     }
     case taglib::FileType::AIFF:
     {
-        AiffFile file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName));
-        if (taglib::readAudioProperties(pTrackMetadata, file)) {
+        AiffFile file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName), readProperties);
+        if (taglib::readAudioProperties(pAudioProperties, file)) {
 #if (TAGLIB_HAS_AIFF_HAS_ID3V2TAG)
             const TagLib::ID3v2::Tag* pID3v2Tag = file.hasID3v2Tag() ? file.tag() : nullptr;
 #else
             const TagLib::ID3v2::Tag* pID3v2Tag = file.tag();
 #endif
             if (pID3v2Tag) {
-                taglib::importTrackMetadataFromID3v2Tag(pTrackMetadata, *pID3v2Tag);
+                taglib::importTrackMetadataFromID3v2Tag(pTags, *pID3v2Tag);
                 taglib::importCoverImageFromID3v2Tag(pCoverImage, *pID3v2Tag);
             } else {
                 // fallback
-                file.importTrackMetadataFromTextChunks(pTrackMetadata);
+                file.importTrackMetadataFromTextChunks(pTags);
             }
             return afterImportSucceeded();
         }
@@ -316,14 +326,14 @@ MetadataSourceTagLib::importTrackMetadataAndCoverImage(
             << "Cannot import track metadata"
             << "from file" << m_fileName
             << "with unknown or unsupported type" << m_fileType;
-        return MetadataSource::importTrackMetadataAndCoverImage(pTrackMetadata, pCoverImage);
+        return MetadataSource::importTrackMetadataAndCoverImage(pTrackMetadata, pCoverImage, importFields);
     }
 
     kLogger.warning()
             << "No track metadata or cover art found"
             << "in file" << m_fileName
             << "with type" << m_fileType;
-    return MetadataSource::importTrackMetadataAndCoverImage(pTrackMetadata, pCoverImage);
+    return MetadataSource::importTrackMetadataAndCoverImage(pTrackMetadata, pCoverImage, importFields);
 }
 
 namespace {
@@ -0,0 +1,259 @@
+#include "sources/mp3seekframecache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QCache>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#include <cstring>
+#include <limits>
+
+#include "util/assert.h"
+#include "util/logger.h"
+#include "util/memory.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("Mp3SeekFrameCache");
+
+// Must be changed whenever the layout of the cache files changes
+const char kMagic[8] = { 'M', 'X', 'X', 'M', 'P', '3', 'S', '1' };
+
+const QString kFileSuffix = QStringLiteral(".seek");
+
+// The file starts with this header followed by the seek frames in native
+// byte order
+struct Header {
+    char magic[8];
+    qint64 fileSize;
+    qint64 lastModified;
+    quint32 sampleRate;
+    quint32 streamChannelCount;
+    quint32 bitrate;
+    quint32 seekFrameCount;
+    qint64 frameIndexMax;
+};
+
+// 32 bits are enough for the frame index of more than a day of audio
+// and for the offsets in MP3 files up to 4 GiB
+struct StoredSeekFrame {
+    quint32 frameIndex;
+    quint32 byteOffset;
+};
+
+// Set once on startup before any file is opened
+QString s_directory;
+
+qint64 lastModifiedOf(const QFileInfo& fileInfo) {
+    return fileInfo.lastModified().toMSecsSinceEpoch();
+}
+
+struct MemoryEntry {
+    qint64 fileSize;
+    qint64 lastModified;
+    Mp3SeekFrameCache::Entry entry;
+};
+
+// Keyed by the absolute path, the cost of an entry is its size in bytes
+QMutex s_memoryEntriesMutex;
+QCache<QString, MemoryEntry> s_memoryEntries(
+        Mp3SeekFrameCache::kMaxMemoryBytes);
+
+} // anonymous namespace
+
+const SINT Mp3SeekFrameCache::kMinSeekFrameCount = 10 * 60 * 38;
+
+// About 3 hours of audio in files of any length
+const int Mp3SeekFrameCache::kMaxMemoryBytes = 8 * 1024 * 1024;
+
+//static
+void Mp3SeekFrameCache::setDirectory(const QString& directory) {
+    s_directory = directory;
+    if (!s_directory.isEmpty() && !QDir().mkpath(s_directory)) {
+        kLogger.warning() << "Failed to create" << s_directory;
+        s_directory.clear();
+    }
+}
+
+//static
+bool Mp3SeekFrameCache::isDiskCacheEnabled() {
+    return !s_directory.isEmpty();
+}
+
+//static
+QString Mp3SeekFrameCache::filePathForFile(const QFileInfo& fileInfo) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(fileInfo.absoluteFilePath().toUtf8());
+    return QDir(s_directory).filePath(
+            QString::fromLatin1(hash.result().toHex()) + kFileSuffix);
+}
+
+//static
+bool Mp3SeekFrameCache::load(const QFileInfo& fileInfo, Entry* pEntry) {
+    DEBUG_ASSERT(pEntry);
+    if (loadFromMemory(fileInfo, pEntry)) {
+        return true;
+    }
+    if (loadFromDisk(fileInfo, pEntry)) {
+        storeInMemory(fileInfo, *pEntry);
+        return true;
+    }
+    return false;
+}
+
+//static
+void Mp3SeekFrameCache::store(const QFileInfo& fileInfo, const Entry& entry) {
+    storeInMemory(fileInfo, entry);
+    if (isDiskCacheEnabled() &&
+            SINT(entry.seekFrames.size()) >= kMinSeekFrameCount) {
+        storeOnDisk(fileInfo, entry);
+    }
+}
+
+//static
+bool Mp3SeekFrameCache::loadFromMemory(const QFileInfo& fileInfo, Entry* pEntry) {
+    const QMutexLocker locked(&s_memoryEntriesMutex);
+    const MemoryEntry* pMemoryEntry =
+            s_memoryEntries.object(fileInfo.absoluteFilePath());
+    if (!pMemoryEntry ||
+            pMemoryEntry->fileSize != fileInfo.size() ||
+            pMemoryEntry->lastModified != lastModifiedOf(fileInfo)) {
+        return false;
+    }
+    *pEntry = pMemoryEntry->entry;
+    return true;
+}
+
+//static
+void Mp3SeekFrameCache::storeInMemory(const QFileInfo& fileInfo, const Entry& entry) {
+    const int cost = sizeof(MemoryEntry) +
+            entry.seekFrames.size() * sizeof(SeekFrame);
+    auto pMemoryEntry = std::make_unique<MemoryEntry>();
+    pMemoryEntry->fileSize = fileInfo.size();
+    pMemoryEntry->lastModified = lastModifiedOf(fileInfo);
+    pMemoryEntry->entry = entry;
+    const QMutexLocker locked(&s_memoryEntriesMutex);
+    // Takes ownership, entries that exceed the limit are deleted
+    s_memoryEntries.insert(fileInfo.absoluteFilePath(),
+            pMemoryEntry.release(), cost);
+}
+
+//static
+bool Mp3SeekFrameCache::loadFromDisk(const QFileInfo& fileInfo, Entry* pEntry) {
+    if (!isDiskCacheEnabled()) {
+        return false;
+    }
+    QFile file(filePathForFile(fileInfo));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    Header header;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) !=
+            sizeof(header) ||
+            std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        kLogger.warning() << "Invalid cache file" << file.fileName();
+        return false;
+    }
+    if (header.fileSize != fileInfo.size() ||
+            header.lastModified != lastModifiedOf(fileInfo)) {
+        // The file has been modified, the entry is replaced after scanning
+        // it again
+        return false;
+    }
+    if (header.seekFrameCount == 0 ||
+            file.size() != qint64(sizeof(header)) +
+                    qint64(header.seekFrameCount) * qint64(sizeof(StoredSeekFrame))) {
+        kLogger.warning() << "Invalid cache file size" << file.fileName();
+        return false;
+    }
+    std::vector<StoredSeekFrame> storedSeekFrames(header.seekFrameCount);
+    const qint64 bytes = qint64(storedSeekFrames.size()) * sizeof(StoredSeekFrame);
+    if (file.read(reinterpret_cast<char*>(storedSeekFrames.data()), bytes) != bytes) {
+        kLogger.warning() << "Failed to read" << file.fileName();
+        return false;
+    }
+
+    pEntry->sampleRate = header.sampleRate;
+    pEntry->streamChannelCount = header.streamChannelCount;
+    pEntry->bitrate = header.bitrate;
+    pEntry->frameIndexMax = header.frameIndexMax;
+    pEntry->seekFrames.clear();
+    pEntry->seekFrames.reserve(storedSeekFrames.size());
+    for (const StoredSeekFrame& storedSeekFrame : storedSeekFrames) {
+        // Both must be strictly increasing, otherwise the entry is corrupt
+        if (!pEntry->seekFrames.empty() &&
+                (pEntry->seekFrames.back().frameIndex >= SINT(storedSeekFrame.frameIndex) ||
+                        pEntry->seekFrames.back().byteOffset >= storedSeekFrame.byteOffset)) {
+            kLogger.warning() << "Invalid seek frames in" << file.fileName();
+            return false;
+        }
+        SeekFrame seekFrame;
+        seekFrame.frameIndex = storedSeekFrame.frameIndex;
+        seekFrame.byteOffset = storedSeekFrame.byteOffset;
+        pEntry->seekFrames.push_back(seekFrame);
+    }
+    if (pEntry->seekFrames.front().frameIndex != 0 ||
+            pEntry->seekFrames.back().frameIndex >= pEntry->frameIndexMax ||
+            qint64(pEntry->seekFrames.back().byteOffset) >= header.fileSize) {
+        kLogger.warning() << "Invalid seek frames in" << file.fileName();
+        return false;
+    }
+    return true;
+}
+
+//static
+void Mp3SeekFrameCache::storeOnDisk(const QFileInfo& fileInfo, const Entry& entry) {
+    if (fileInfo.size() > std::numeric_limits<quint32>::max() ||
+            entry.frameIndexMax > SINT(std::numeric_limits<quint32>::max())) {
+        // Does not fit into the compact layout, rare enough to be scanned
+        // every time
+        return;
+    }
+
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.fileSize = fileInfo.size();
+    header.lastModified = lastModifiedOf(fileInfo);
+    header.sampleRate = entry.sampleRate;
+    header.streamChannelCount = entry.streamChannelCount;
+    header.bitrate = entry.bitrate;
+    header.seekFrameCount = entry.seekFrames.size();
+    header.frameIndexMax = entry.frameIndexMax;
+
+    std::vector<StoredSeekFrame> storedSeekFrames;
+    storedSeekFrames.reserve(entry.seekFrames.size());
+    for (const SeekFrame& seekFrame : entry.seekFrames) {
+        StoredSeekFrame storedSeekFrame;
+        storedSeekFrame.frameIndex = seekFrame.frameIndex;
+        storedSeekFrame.byteOffset = seekFrame.byteOffset;
+        storedSeekFrames.push_back(storedSeekFrame);
+    }
+
+    // Written to a temporary file that replaces the entry on commit
+    QSaveFile file(filePathForFile(fileInfo));
+    if (!file.open(QIODevice::WriteOnly)) {
+        kLogger.warning() << "Failed to create" << file.fileName()
+                << file.errorString();
+        return;
+    }
+    const qint64 bytes = qint64(storedSeekFrames.size()) * sizeof(StoredSeekFrame);
+    if (file.write(reinterpret_cast<const char*>(&header), sizeof(header)) !=
+            sizeof(header) ||
+            file.write(reinterpret_cast<const char*>(storedSeekFrames.data()),
+                    bytes) != bytes ||
+            !file.commit()) {
+        kLogger.warning() << "Failed to write" << file.fileName()
+                << file.errorString();
+        return;
+    }
+    kLogger.debug() << "Stored" << entry.seekFrames.size()
+            << "seek frames of" << fileInfo.absoluteFilePath();
+}
+
+} // namespace mixxx
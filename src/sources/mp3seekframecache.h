@@ -0,0 +1,83 @@
+#ifndef MIXXX_MP3SEEKFRAMECACHE_H
+#define MIXXX_MP3SEEKFRAMECACHE_H
+
+#include <QFileInfo>
+#include <QString>
+
+#include <vector>
+
+#include "util/types.h"
+
+namespace mixxx {
+
+// A cache of the seek frame tables of SoundSourceMp3. Building the table
+// requires decoding the headers of all MP3 frames in the file, which takes
+// seconds for long mixes.
+//
+// The tables of the files that have been opened recently are kept in
+// memory, so a file that is opened again by another reader, e.g. by a deck
+// right after the analysis, is not scanned twice. The table of each file
+// that is long enough is also stored in a small binary file on disk and
+// read back the next time the file is opened. The disk cache is disabled
+// until a directory has been set.
+//
+// Entries are identified by the location of the file and are only used
+// while the size and modification time of the file are unchanged.
+//
+// The functions may be called from any thread. An entry is replaced
+// atomically, concurrent readers either see the old or the new entry.
+class Mp3SeekFrameCache {
+  public:
+    struct SeekFrame {
+        SINT frameIndex;
+        // Relative to the start of the file
+        quint64 byteOffset;
+    };
+
+    struct Entry {
+        Entry()
+                : sampleRate(0),
+                  streamChannelCount(0),
+                  bitrate(0),
+                  frameIndexMax(0) {
+        }
+
+        SINT sampleRate;
+        SINT streamChannelCount;
+        // kbit/s
+        SINT bitrate;
+        SINT frameIndexMax;
+        // Ordered by frame index, without the terminating frame at the end
+        // of the stream
+        std::vector<SeekFrame> seekFrames;
+    };
+
+    // Files with fewer MP3 frames are scanned quickly enough to not be
+    // stored on disk, about 10 minutes of audio
+    static const SINT kMinSeekFrameCount;
+
+    // The limit of the memory that is used for the recent entries
+    static const int kMaxMemoryBytes;
+
+    // An empty directory disables the disk cache
+    static void setDirectory(const QString& directory);
+    static bool isDiskCacheEnabled();
+
+    // Returns false if there is no valid entry for the file
+    static bool load(const QFileInfo& fileInfo, Entry* pEntry);
+
+    static void store(const QFileInfo& fileInfo, const Entry& entry);
+
+  private:
+    static bool loadFromMemory(const QFileInfo& fileInfo, Entry* pEntry);
+    static void storeInMemory(const QFileInfo& fileInfo, const Entry& entry);
+
+    static bool loadFromDisk(const QFileInfo& fileInfo, Entry* pEntry);
+    static void storeOnDisk(const QFileInfo& fileInfo, const Entry& entry);
+
+    static QString filePathForFile(const QFileInfo& fileInfo);
+};
+
+} // namespace mixxx
+
+#endif // MIXXX_MP3SEEKFRAMECACHE_H
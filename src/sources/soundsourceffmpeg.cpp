@@ -1,9 +1,11 @@
 #include "sources/soundsourceffmpeg.h"
 
 #include "encoder/encoderffmpegresample.h"
+#include "sources/mp3decoding.h"
 
 #include "util/logger.h"
 
+#include <algorithm>
 #include <mutex>
 #include <vector>
 
@@ -32,6 +34,37 @@ void initFFmpegLib() {
 // More than 2 channels are currently not supported
 const SINT kMaxChannelCount = 2;
 
+// The index of this demuxer contains every packet of the stream with its
+// exact timestamp and position, because both are stored in the sample
+// table of the file. The indexes of other demuxers may be sparse or only
+// estimated.
+const char* const kExactIndexInputFormatName = "mov,mp4,m4a,3gp,3g2,mj2";
+
+// Targets that are closer to the end of the cache are reached by decoding
+// forward instead of seeking by the packet index
+const SINT kMaxDecodeForwardFrames = 8192;
+
+#if AVSTREAM_FROM_API_VERSION_3_1
+// Lets FFmpeg choose the number of threads for decoders that support
+// decoding multiple frames or slices in parallel. Returns false if the
+// decoder does not.
+bool enableDecodingThreads(AVCodecContext* pCodecContext, AVCodec* pDecoder) {
+    int threadType = 0;
+    if (pDecoder->capabilities & AV_CODEC_CAP_FRAME_THREADS) {
+        threadType |= FF_THREAD_FRAME;
+    }
+    if (pDecoder->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+        threadType |= FF_THREAD_SLICE;
+    }
+    if (threadType == 0) {
+        return false;
+    }
+    pCodecContext->thread_count = 0; // auto
+    pCodecContext->thread_type = threadType;
+    return true;
+}
+#endif
+
 inline
 AVMediaType getMediaTypeOfStream(AVStream* pStream) {
     return m_pAVStreamWrapper.getMediaTypeOfStream(pStream);
@@ -303,7 +336,9 @@ SoundSourceFFmpeg::SoundSourceFFmpeg(const QUrl& url)
       m_lLastStoredPos(0),
       m_lStoreCount(0),
       m_lStoredSeekPoint(-1),
-      m_SStoredJumpPoint(nullptr) {
+      m_SStoredJumpPoint(nullptr),
+      m_packetIndexPreroll(1),
+      m_bThreadedDecoding(false) {
 }
 
 SoundSourceFFmpeg::~SoundSourceFFmpeg() {
@@ -312,7 +347,7 @@ SoundSourceFFmpeg::~SoundSourceFFmpeg() {
 
 SoundSource::OpenResult SoundSourceFFmpeg::tryOpen(
         OpenMode /*mode*/,
-        const OpenParams& /*config*/) {
+        const OpenParams& params) {
     AVFormatContext *pInputFormatContext =
             openInputFile(getLocalFileName());
     if (pInputFormatContext == nullptr) {
@@ -377,6 +412,12 @@ SoundSource::OpenResult SoundSourceFFmpeg::tryOpen(
     // Make sure that Codecs are identical or  avcodec_open2 fails.
     pCodecContext->codec_id = pDecoder->id;
 
+    // Only worth the threads when reading the whole file, the delay of
+    // the decoded frames slows down seeking
+    if (params.sequentialAccess()) {
+        m_bThreadedDecoding = enableDecodingThreads(pCodecContext, pDecoder);
+    }
+
     const OpenResult openAudioStreamResult = openAudioStream(pCodecContext, pDecoder);
 
     m_pAudioContext.take(&pCodecContext);
@@ -420,6 +461,8 @@ SoundSource::OpenResult SoundSourceFFmpeg::tryOpen(
     setSampleRate(sampleRate);
     initFrameIndexRangeOnce(frameIndexRange);
 
+    initPacketIndex(pDecoder->id);
+
 #if AVSTREAM_FROM_API_VERSION_3_1
     m_pResample = std::make_unique<EncoderFfmpegResample>(m_pAudioContext);
 #else
@@ -440,6 +483,8 @@ void SoundSourceFFmpeg::close() {
         m_SJumpPoints.remove(0);
         free(l_SRmJmp);
     }
+    m_packetIndex.clear();
+    m_bThreadedDecoding = false;
 
 #if AVSTREAM_FROM_API_VERSION_3_1
     m_pAudioContext.close();
@@ -448,6 +493,83 @@ void SoundSourceFFmpeg::close() {
     m_pInputFormatContext.close();
 }
 
+void SoundSourceFFmpeg::initPacketIndex(AVCodecID codecId) {
+    DEBUG_ASSERT(m_packetIndex.isEmpty());
+    if (strcmp(m_pInputFormatContext->iformat->name,
+            kExactIndexInputFormatName) != 0) {
+        return;
+    }
+    // The bit reservoir of MP3 frames may reach back into many previous
+    // frames, while the other codecs only overlap with the previous frame
+    m_packetIndexPreroll = (codecId == AV_CODEC_ID_MP3) ?
+            kMp3SeekFramePrefetchCount : 1;
+
+    AVRational frameTimeBase;
+    frameTimeBase.num = 1;
+    frameTimeBase.den = static_cast<int>(sampleRate());
+    m_packetIndex.reserve(m_pAudioStream->nb_index_entries);
+    for (int i = 0; i < m_pAudioStream->nb_index_entries; ++i) {
+        const AVIndexEntry& indexEntry = m_pAudioStream->index_entries[i];
+        if (!(indexEntry.flags & AVINDEX_KEYFRAME)) {
+            continue;
+        }
+        struct ffmpegLocationObject packet;
+        packet.pos = indexEntry.pos;
+        packet.pts = indexEntry.timestamp;
+        packet.startFrame = av_rescale_q(indexEntry.timestamp,
+                m_pAudioStream->time_base, frameTimeBase);
+        if (!m_packetIndex.isEmpty() &&
+                (packet.startFrame <= m_packetIndex.last().startFrame)) {
+            kLogger.warning()
+                    << "Ignoring the unordered packet index of"
+                    << getLocalFileName();
+            m_packetIndex.clear();
+            return;
+        }
+        m_packetIndex.append(packet);
+    }
+    kLogger.debug() << "Packet index with" << m_packetIndex.size()
+            << "entries";
+}
+
+bool SoundSourceFFmpeg::seekByPacketIndex(SINT frameIndex) {
+    // The first packet that starts after the frame
+    const auto iPacket = std::upper_bound(
+            m_packetIndex.constBegin(), m_packetIndex.constEnd(), frameIndex,
+            [](SINT value, const ffmpegLocationObject& packet) {
+                return value < packet.startFrame;
+            });
+    const SINT packetIndex =
+            (iPacket - m_packetIndex.constBegin()) - 1 - m_packetIndexPreroll;
+    if ((packetIndex < 0) || (m_packetIndex[packetIndex].startFrame <= 0)) {
+        // The decoder skips the priming frames at the start of the stream
+        // only when decoding from the start
+        return false;
+    }
+    const ffmpegLocationObject& packet = m_packetIndex[packetIndex];
+    const int ret = av_seek_frame(m_pInputFormatContext,
+            m_pAudioStream->index, packet.pts, AVSEEK_FLAG_BACKWARD);
+    if (ret < 0) {
+        kLogger.warning() << "seek: Can't seek to packet at" << packet.pos;
+        return false;
+    }
+#if AVSTREAM_FROM_API_VERSION_3_1
+    avcodec_flush_buffers(m_pAudioContext);
+#else
+    avcodec_flush_buffers(m_pAudioStream->codec);
+#endif
+
+    clearCache();
+    m_lCacheStartFrame = packet.startFrame;
+    m_lCacheEndFrame = packet.startFrame;
+    m_lCacheLastPos = 0;
+    m_lCacheFramePos = packet.startFrame;
+    // Skip the packets before it if the demuxer lands earlier
+    m_lStoredSeekPoint = packet.pos;
+    m_SStoredJumpPoint = nullptr;
+    return true;
+}
+
 void SoundSourceFFmpeg::clearCache() {
     while (m_SCache.size() > 0) {
         struct ffmpegCacheObject* l_SRmObj = m_SCache[0];
@@ -473,6 +595,7 @@ bool SoundSourceFFmpeg::readFramesToCache(unsigned int count, SINT offset) {
     qint64 l_lLastPacketPos = -1;
     int l_iError = 0;
     int l_iFrameCount = 0;
+    bool l_bDraining = false;
 
     while (l_iCount > 0) {
         if (l_pFrame != nullptr) {
@@ -509,7 +632,21 @@ bool SoundSourceFFmpeg::readFramesToCache(unsigned int count, SINT offset) {
 
         // Read one frame (which has nothing to do with Mixxx Frame)
         // it's some packed audio data from container like MP3, Ogg or MP4
-        if (av_read_frame(m_pInputFormatContext, &l_SPacket) >= 0) {
+        int l_iReadResult = l_bDraining ? AVERROR_EOF :
+                av_read_frame(m_pInputFormatContext, &l_SPacket);
+#if AVSTREAM_FROM_API_VERSION_3_1
+        if (l_iReadResult < 0 && m_bThreadedDecoding) {
+            // The frame threads still hold decoded frames. An empty
+            // packet makes the decoder return them until it reports EOF.
+            l_bDraining = true;
+            l_SPacket.data = nullptr;
+            l_SPacket.size = 0;
+            l_SPacket.stream_index = m_pAudioStream->index;
+            l_SPacket.pos = l_lLastPacketPos;
+            l_iReadResult = 0;
+        }
+#endif
+        if (l_iReadResult >= 0) {
             // Are we on correct audio stream. Currently we are always
             // Using first audio stream but in future there should be
             // possibility to choose which to use
@@ -559,7 +696,9 @@ bool SoundSourceFFmpeg::readFramesToCache(unsigned int count, SINT offset) {
                   continue;
                 }
 
-                if(l_iRet == AVERROR_EOF || l_iRet == AVERROR(EINVAL)) {
+                // While draining the decoder rejects the repeated empty
+                // packets, the frames are received below
+                if ((l_iRet == AVERROR_EOF && !l_bDraining) || l_iRet == AVERROR(EINVAL)) {
                       kLogger.warning() << "readFramesToCache: Warning can't decode frame!";
                 }
 
@@ -568,8 +707,19 @@ bool SoundSourceFFmpeg::readFramesToCache(unsigned int count, SINT offset) {
                 // AVERROR(EAGAIN) means that we need to feed more
                 // That we can decode Frame or Packet
                 if (l_iRet == AVERROR(EAGAIN)) {
-                  kLogger.warning() << "readFramesToCache: Need more packets to decode!";
-                  continue;
+                    // Expected while the frame threads are busy
+                    if (!m_bThreadedDecoding) {
+                        kLogger.warning() << "readFramesToCache: Need more packets to decode!";
+                    }
+                    // The decoder keeps its own reference
+#if (LIBAVCODEC_HAS_AV_PACKET_UNREF)
+                    av_packet_unref(&l_SPacket);
+#else
+                    av_free_packet(&l_SPacket);
+#endif
+                    l_SPacket.data = nullptr;
+                    l_SPacket.size = 0;
+                    continue;
                 }
 
                 if(l_iRet == AVERROR_EOF || l_iRet == AVERROR(EINVAL)) {
@@ -639,7 +789,9 @@ bool SoundSourceFFmpeg::readFramesToCache(unsigned int count, SINT offset) {
                             }
                             // Check wether we have this jumppoint stored allready or not
                             // We should have jumppoints below that pos
-                            if (l_STestObj == nullptr || l_STestObj->pos < l_SPacket.pos) {
+                            // The packet index has them all already
+                            if (m_packetIndex.isEmpty() &&
+                                    (l_STestObj == nullptr || l_STestObj->pos < l_SPacket.pos)) {
                                 struct ffmpegLocationObject  *l_SJmp = (struct ffmpegLocationObject  *)malloc(
                                         sizeof(struct ffmpegLocationObject));
                                 m_lLastStoredPos = m_lCacheFramePos;
@@ -900,7 +1052,13 @@ ReadableSampleFrames SoundSourceFFmpeg::readSampleFramesClamped(
         qint64 i = 0;
         struct ffmpegLocationObject *l_STestObj = nullptr;
 
-        if (seekFrameIndex < m_lCacheStartFrame) {
+        if (!m_packetIndex.isEmpty() &&
+                ((seekFrameIndex < m_lCacheStartFrame) ||
+                        (seekFrameIndex > m_lCacheEndFrame + kMaxDecodeForwardFrames)) &&
+                seekByPacketIndex(seekFrameIndex)) {
+            // Only the preroll packets before the frame need to be decoded
+            DEBUG_ASSERT(m_lCacheEndFrame <= seekFrameIndex);
+        } else if (seekFrameIndex < m_lCacheStartFrame) {
             // Seek to set (start of the stream which is FFmpeg frame 0)
             // because we are dealing with compressed audio FFmpeg takes
             // best of to seek that point (in this case 0 Is always there)
@@ -922,6 +1080,11 @@ ReadableSampleFrames SoundSourceFFmpeg::readSampleFramesClamped(
                 kLogger.warning() << "seek: Can't seek to 0 byte!";
                 return ReadableSampleFrames();
             }
+#if AVSTREAM_FROM_API_VERSION_3_1
+            avcodec_flush_buffers(m_pAudioContext);
+#else
+            avcodec_flush_buffers(m_pAudioStream->codec);
+#endif
 
             clearCache();
             m_lCacheStartFrame = 0;
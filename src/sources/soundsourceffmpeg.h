@@ -127,6 +127,14 @@ class SoundSourceFFmpeg: public SoundSource {
             OpenMode mode,
             const OpenParams& params) override;
 
+    // Builds m_packetIndex from the index of the container if it
+    // contains the exact position of every packet
+    void initPacketIndex(AVCodecID codecId);
+    // Positions the demuxer a few packets before the frame by using
+    // m_packetIndex. Returns false if the frame is not covered by the
+    // index or the demuxer failed to seek.
+    bool seekByPacketIndex(SINT frameIndex);
+
     bool readFramesToCache(unsigned int count, SINT offset);
     bool getBytesFromCache(CSAMPLE* buffer, SINT offset, SINT size);
     SINT getSizeofCache();
@@ -269,6 +277,17 @@ class SoundSourceFFmpeg: public SoundSource {
     SINT m_lStoreCount;
     SINT m_lStoredSeekPoint;
     struct ffmpegLocationObject *m_SStoredJumpPoint;
+
+    // The seek points of all packets, ordered by startFrame. Replaces
+    // the jump points that are otherwise collected while decoding.
+    QVector<struct ffmpegLocationObject> m_packetIndex;
+    // The number of packets that are decoded before the one that
+    // contains the frame after seeking by the index
+    SINT m_packetIndexPreroll;
+
+    // Decoded frames are delayed by frame threads and need to be
+    // flushed at the end of the stream
+    bool m_bThreadedDecoding;
 };
 
 class SoundSourceProviderFFmpeg: public SoundSourceProvider {
@@ -71,6 +71,7 @@ SoundSourceFLAC::SoundSourceFLAC(const QUrl& url)
           m_decoder(nullptr),
           m_maxBlocksize(0),
           m_bitsPerSample(kBitsPerSampleDefault),
+          m_streamChannelCount(0),
           m_sampleScaleFactor(CSAMPLE_ZERO),
           m_curFrameIndex(0) {
 }
@@ -81,8 +82,11 @@ SoundSourceFLAC::~SoundSourceFLAC() {
 
 SoundSource::OpenResult SoundSourceFLAC::tryOpen(
         OpenMode /*mode*/,
-        const OpenParams& /*config*/) {
+        const OpenParams& params) {
     DEBUG_ASSERT(!m_file.isOpen());
+    // Needed when the metadata is processed
+    m_requestedChannelCount = params.channelCount();
+
     if (!m_file.open(QIODevice::ReadOnly)) {
         kLogger.warning() << "Failed to open FLAC file:" << m_file.fileName();
         return OpenResult::Failed;
@@ -348,10 +352,10 @@ FLAC__bool SoundSourceFLAC::flacEOF() {
 FLAC__StreamDecoderWriteStatus SoundSourceFLAC::flacWrite(
         const FLAC__Frame* frame, const FLAC__int32* const buffer[]) {
     const SINT numChannels = frame->header.channels;
-    if (channelCount() > numChannels) {
+    if (m_streamChannelCount > numChannels) {
         kLogger.warning() << "Corrupt or unsupported FLAC file:"
                 << "Invalid number of channels in FLAC frame header"
-                << frame->header.channels << "<>" << channelCount();
+                << frame->header.channels << "<>" << m_streamChannelCount;
         return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
     }
     if (sampleRate() != SINT(frame->header.sample_rate)) {
@@ -386,7 +390,10 @@ FLAC__StreamDecoderWriteStatus SoundSourceFLAC::flacWrite(
     }
 
     CSAMPLE* pSampleBuffer = writableSlice.data();
-    DEBUG_ASSERT(channelCount() <= numChannels);
+    // The output has fewer channels than the frame only when converting
+    // to stereo, more channels only when converting mono to stereo.
+    DEBUG_ASSERT((channelCount() <= numChannels) ||
+            ((channelCount() == 2) && (numChannels == 1)));
     switch (channelCount()) {
     case 1: {
         // optimized code for 1 channel (mono)
@@ -396,7 +403,17 @@ FLAC__StreamDecoderWriteStatus SoundSourceFLAC::flacWrite(
         break;
     }
     case 2: {
-        // optimized code for 2 channels (stereo)
+        if (numChannels == 1) {
+            // mono to dual mono
+            for (SINT i = 0; i < numWritableFrames; ++i) {
+                const CSAMPLE sample = buffer[0][i] * m_sampleScaleFactor;
+                *pSampleBuffer++ = sample;
+                *pSampleBuffer++ = sample;
+            }
+            break;
+        }
+        // optimized code for 2 channels (stereo), only the first two
+        // channels of multi-channel signals are decoded
         for (SINT i = 0; i < numWritableFrames; ++i) {
             *pSampleBuffer++ = buffer[0][i] * m_sampleScaleFactor;
             *pSampleBuffer++ = buffer[1][i] * m_sampleScaleFactor;
@@ -424,7 +441,10 @@ void SoundSourceFLAC::flacMetadata(const FLAC__StreamMetadata* metadata) {
     switch (metadata->type) {
     case FLAC__METADATA_TYPE_STREAMINFO:
     {
-        setChannelCount(metadata->data.stream_info.channels);
+        m_streamChannelCount = metadata->data.stream_info.channels;
+        setChannelCount(stereoDecodingChannelCount(
+                ChannelCount(m_streamChannelCount),
+                m_requestedChannelCount));
         setSampleRate(metadata->data.stream_info.sample_rate);
         initFrameIndexRangeOnce(
                 IndexRange::forward(
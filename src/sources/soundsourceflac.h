@@ -48,6 +48,9 @@ class SoundSourceFLAC: public SoundSource {
     // of subframes (one for each channel)
     SINT m_maxBlocksize; // in time samples (audio samples = time samples * chanCount)
     SINT m_bitsPerSample;
+    // The decoded signal is converted to stereo if requested
+    ChannelCount m_requestedChannelCount;
+    SINT m_streamChannelCount;
 
     CSAMPLE m_sampleScaleFactor;
 
@@ -67,8 +67,9 @@ SoundSourceModPlug::~SoundSourceModPlug() {
 std::pair<MetadataSource::ImportResult, QDateTime>
 SoundSourceModPlug::importTrackMetadataAndCoverImage(
         TrackMetadata* pTrackMetadata,
-        QImage* pCoverArt) const {
-    if (pTrackMetadata != nullptr) {
+        QImage* pCoverArt,
+        ImportFields importFields) const {
+    if ((pTrackMetadata != nullptr) && (importFields != 0)) {
         QFile modFile(getLocalFileName());
         modFile.open(QIODevice::ReadOnly);
         const QByteArray fileBuf(modFile.readAll());
@@ -80,12 +81,16 @@ SoundSourceModPlug::importTrackMetadataAndCoverImage(
             return std::make_pair(ImportResult::Failed, QDateTime());
         }
 
-        pTrackMetadata->refTrackInfo().setComment(QString(ModPlug::ModPlug_GetMessage(pModFile)));
-        pTrackMetadata->refTrackInfo().setTitle(QString(ModPlug::ModPlug_GetName(pModFile)));
-        pTrackMetadata->setChannels(ChannelCount(kChannelCount));
-        pTrackMetadata->setSampleRate(SampleRate(kSampleRate));
-        pTrackMetadata->setDuration(Duration::fromMillis(ModPlug::ModPlug_GetLength(pModFile)));
-        pTrackMetadata->setBitrate(Bitrate(8)); // not really, but fill in something...
+        if (importFields & IMPORT_TAGS) {
+            pTrackMetadata->refTrackInfo().setComment(QString(ModPlug::ModPlug_GetMessage(pModFile)));
+            pTrackMetadata->refTrackInfo().setTitle(QString(ModPlug::ModPlug_GetName(pModFile)));
+        }
+        if (importFields & IMPORT_AUDIO_PROPERTIES) {
+            pTrackMetadata->setChannels(ChannelCount(kChannelCount));
+            pTrackMetadata->setSampleRate(SampleRate(kSampleRate));
+            pTrackMetadata->setDuration(Duration::fromMillis(ModPlug::ModPlug_GetLength(pModFile)));
+            pTrackMetadata->setBitrate(Bitrate(8)); // not really, but fill in something...
+        }
         ModPlug::ModPlug_Unload(pModFile);
 
         return std::make_pair(ImportResult::Succeeded, QFileInfo(modFile).lastModified());
@@ -93,7 +98,8 @@ SoundSourceModPlug::importTrackMetadataAndCoverImage(
 
     // The modplug library currently does not support reading cover-art from
     // modplug files -- kain88 (Oct 2014)
-    return MetadataSource::importTrackMetadataAndCoverImage(nullptr, pCoverArt);
+    return MetadataSource::importTrackMetadataAndCoverImage(
+            nullptr, pCoverArt, importFields);
 }
 
 SoundSource::OpenResult SoundSourceModPlug::tryOpen(
@@ -29,7 +29,8 @@ class SoundSourceModPlug: public SoundSource {
 
     std::pair<ImportResult, QDateTime> importTrackMetadataAndCoverImage(
             TrackMetadata* pTrackMetadata,
-            QImage* pCoverArt) const override;
+            QImage* pCoverArt,
+            ImportFields importFields) const override;
 
     void close() override;
 
@@ -1,11 +1,14 @@
 #include "sources/soundsourcemp3.h"
 #include "sources/mp3decoding.h"
+#include "sources/mp3seekframecache.h"
 
 #include "util/math.h"
 #include "util/logger.h"
 
 #include <id3tag.h>
 
+#include <QFileInfo>
+
 namespace mixxx {
 
 namespace {
@@ -157,6 +160,15 @@ bool decodeFrameHeader(
     return true;
 }
 
+// The number of evenly spaced seek frames of a cached entry that are checked
+// against the file besides the first and the last one
+const SINT kCheckedCachedSeekFrameCount = 16;
+
+inline bool isFrameSyncAt(const unsigned char* pData, quint64 size) {
+    // The 11 bits of the frame sync at the start of each MP3 frame header
+    return (size >= 2) && (pData[0] == 0xff) && ((pData[1] & 0xe0) == 0xe0);
+}
+
 } // anonymous namespace
 
 SoundSourceMp3::SoundSourceMp3(const QUrl& url)
@@ -166,6 +178,7 @@ SoundSourceMp3::SoundSourceMp3(const QUrl& url)
           m_pFileData(nullptr),
           m_avgSeekFrameCount(0),
           m_curFrameIndex(0),
+          m_streamChannelCount(0),
           m_madSynthCount(0),
           m_leftoverBuffer(kMaxBytesPerMp3Frame + MAD_BUFFER_GUARD) {
     m_seekFrameList.reserve(kSeekFrameListCapacity);
@@ -192,7 +205,7 @@ void SoundSourceMp3::finishDecoding() {
 
 SoundSource::OpenResult SoundSourceMp3::tryOpen(
         OpenMode /*mode*/,
-        const OpenParams& /*config*/) {
+        const OpenParams& params) {
     DEBUG_ASSERT(!channelCount().valid());
     DEBUG_ASSERT(!sampleRate().valid());
 
@@ -212,14 +225,107 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     // described in the following bug report:
     // https://bugs.launchpad.net/mixxx/+bug/1452005
 
+    DEBUG_ASSERT(m_seekFrameList.empty());
+    m_avgSeekFrameCount = 0;
+    m_curFrameIndex = 0;
+
+    // Scanning all frame headers takes a while, the seek frames of the
+    // previous scan are reused if the file is unchanged
+    const QFileInfo fileInfo(m_file);
+    Mp3SeekFrameCache::Entry streamInfo;
+    const bool cached = Mp3SeekFrameCache::load(fileInfo, &streamInfo) &&
+            initSeekFramesFromCache(streamInfo);
+    if (!cached) {
+        const OpenResult result = scanSeekFrames(&streamInfo);
+        if (result != OpenResult::Succeeded) {
+            return result;
+        }
+    }
+    DEBUG_ASSERT(!m_seekFrameList.empty());
+    DEBUG_ASSERT(m_seekFrameList.front().frameIndex == 0);
+    DEBUG_ASSERT(m_curFrameIndex == streamInfo.frameIndexMax);
+
+    // Initialize the AudioSource
+    setSampleRate(streamInfo.sampleRate);
+    m_streamChannelCount = streamInfo.streamChannelCount;
+    setChannelCount(stereoDecodingChannelCount(
+            ChannelCount(m_streamChannelCount), params.channelCount()));
+    initFrameIndexRangeOnce(IndexRange::forward(0, m_curFrameIndex));
+
+    // Calculate average values
+    m_avgSeekFrameCount = frameLength() / m_seekFrameList.size();
+    initBitrateOnce(streamInfo.bitrate);
+
+    if (!cached) {
+        streamInfo.seekFrames.reserve(m_seekFrameList.size());
+        for (const SeekFrameType& seekFrame : m_seekFrameList) {
+            Mp3SeekFrameCache::SeekFrame cachedSeekFrame;
+            cachedSeekFrame.frameIndex = seekFrame.frameIndex;
+            cachedSeekFrame.byteOffset = seekFrame.pInputData - m_pFileData;
+            streamInfo.seekFrames.push_back(cachedSeekFrame);
+        }
+        Mp3SeekFrameCache::store(fileInfo, streamInfo);
+    }
+
+    // Terminate m_seekFrameList
+    addSeekFrame(m_curFrameIndex, 0);
+    DEBUG_ASSERT(m_seekFrameList.back().frameIndex == frameIndexMax());
+
+    // Restart decoding at the beginning of the audio stream
+    restartDecoding(m_seekFrameList.front());
+
+    if (m_curFrameIndex != frameIndexMin()) {
+        kLogger.warning() << "Failed to start decoding:" << m_file.fileName();
+        // Abort
+        return OpenResult::Failed;
+    }
+
+    return OpenResult::Succeeded;
+}
+
+bool SoundSourceMp3::initSeekFramesFromCache(
+        const Mp3SeekFrameCache::Entry& cacheEntry) {
+    DEBUG_ASSERT(m_seekFrameList.empty());
+    if ((getIndexBySampleRate(SampleRate(cacheEntry.sampleRate)) >= kSampleRateCount) ||
+            (cacheEntry.streamChannelCount < 1) ||
+            (cacheEntry.streamChannelCount > kChannelCountMax) ||
+            (cacheEntry.bitrate <= 0) ||
+            cacheEntry.seekFrames.empty()) {
+        return false;
+    }
+    // Checking that some of the cached seek frames point to frame headers
+    // only touches a few pages of the file. The size and modification time
+    // of the file have already been compared by the cache.
+    const SINT seekFrameCount = cacheEntry.seekFrames.size();
+    const SINT checkStep = math_max(SINT(1),
+            seekFrameCount / kCheckedCachedSeekFrameCount);
+    for (SINT i = 0; i < seekFrameCount; i += checkStep) {
+        for (SINT j : { i, math_min(i + checkStep, seekFrameCount) - 1 }) {
+            const quint64 byteOffset = cacheEntry.seekFrames[j].byteOffset;
+            if ((byteOffset >= m_fileSize) ||
+                    !isFrameSyncAt(m_pFileData + byteOffset, m_fileSize - byteOffset)) {
+                kLogger.warning() << "Ignoring outdated seek frames of"
+                        << m_file.fileName();
+                return false;
+            }
+        }
+    }
+    for (const auto& seekFrame : cacheEntry.seekFrames) {
+        addSeekFrame(seekFrame.frameIndex, m_pFileData + seekFrame.byteOffset);
+    }
+    m_curFrameIndex = cacheEntry.frameIndexMax;
+    kLogger.debug() << "Using" << seekFrameCount << "cached seek frames of"
+            << m_file.fileName();
+    return true;
+}
+
+SoundSource::OpenResult SoundSourceMp3::scanSeekFrames(
+        Mp3SeekFrameCache::Entry* pStreamInfo) {
     // Transfer it to the mad stream-buffer:
     mad_stream_options(&m_madStream, MAD_OPTION_IGNORECRC);
     mad_stream_buffer(&m_madStream, m_pFileData, m_fileSize);
     DEBUG_ASSERT(m_pFileData == m_madStream.this_frame);
 
-    DEBUG_ASSERT(m_seekFrameList.empty());
-    m_avgSeekFrameCount = 0;
-    m_curFrameIndex = 0;
     int headerPerSampleRate[kSampleRateCount];
     for (int i = 0; i < kSampleRateCount; ++i) {
         headerPerSampleRate[i] = 0;
@@ -342,34 +448,16 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     }
 
     if (mostCommonSampleRateIndex < kSampleRateCount) {
-        setSampleRate(getSampleRateByIndex(mostCommonSampleRateIndex));
+        pStreamInfo->sampleRate = getSampleRateByIndex(mostCommonSampleRateIndex);
     } else {
         kLogger.warning() << "No single valid sample rate in header";
         // Abort
         return OpenResult::Failed;
     }
 
-    // Initialize the AudioSource
-    setChannelCount(maxChannelCount);
-    initFrameIndexRangeOnce(IndexRange::forward(0, m_curFrameIndex));
-
-    // Calculate average values
-    m_avgSeekFrameCount = frameLength() / m_seekFrameList.size();
-    const unsigned long avgBitrate = sumBitrate / m_seekFrameList.size();
-    initBitrateOnce(avgBitrate / 1000);
-
-    // Terminate m_seekFrameList
-    addSeekFrame(m_curFrameIndex, 0);
-    DEBUG_ASSERT(m_seekFrameList.back().frameIndex == frameIndexMax());
-
-    // Restart decoding at the beginning of the audio stream
-    restartDecoding(m_seekFrameList.front());
-
-    if (m_curFrameIndex != frameIndexMin()) {
-        kLogger.warning() << "Failed to start decoding:" << m_file.fileName();
-        // Abort
-        return OpenResult::Failed;
-    }
+    pStreamInfo->streamChannelCount = maxChannelCount;
+    pStreamInfo->bitrate = (sumBitrate / m_seekFrameList.size()) / 1000;
+    pStreamInfo->frameIndexMax = m_curFrameIndex;
 
     return OpenResult::Succeeded;
 }
@@ -629,9 +717,9 @@ ReadableSampleFrames SoundSourceMp3::readSampleFramesClamped(
 
 #ifndef QT_NO_DEBUG_OUTPUT
             const SINT madFrameChannelCount = MAD_NCHANNELS(&m_madFrame.header);
-            if (madFrameChannelCount != channelCount()) {
+            if (madFrameChannelCount != m_streamChannelCount) {
                 kLogger.debug() << "MP3 frame header with mismatching number of channels"
-                        << madFrameChannelCount << "<>" << channelCount();
+                        << madFrameChannelCount << "<>" << m_streamChannelCount;
             }
 #endif
 
@@ -658,9 +746,9 @@ ReadableSampleFrames SoundSourceMp3::readSampleFramesClamped(
             const SINT madSynthChannelCount = m_madSynth.pcm.channels;
             DEBUG_ASSERT(0 < madSynthChannelCount);
             DEBUG_ASSERT(madSynthChannelCount <= channelCount());
-            if (madSynthChannelCount != channelCount()) {
+            if (madSynthChannelCount != m_streamChannelCount) {
                 kLogger.warning() << "Reading MP3 data with different number of channels"
-                        << madSynthChannelCount << "<>" << channelCount();
+                        << madSynthChannelCount << "<>" << m_streamChannelCount;
             }
             if (madSynthChannelCount == 1) {
                 // MP3 frame contains a mono signal
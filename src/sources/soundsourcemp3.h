@@ -1,6 +1,7 @@
 #ifndef MIXXX_SOUNDSOURCEMP3_H
 #define MIXXX_SOUNDSOURCEMP3_H
 
+#include "sources/mp3seekframecache.h"
 #include "sources/soundsourceprovider.h"
 
 #ifdef _MSC_VER
@@ -54,11 +55,22 @@ class SoundSourceMp3: public SoundSource {
 
     void addSeekFrame(SINT frameIndex, const unsigned char* pInputData);
 
+    // Decodes the headers of all MP3 frames to fill m_seekFrameList and
+    // the properties of the stream
+    OpenResult scanSeekFrames(Mp3SeekFrameCache::Entry* pStreamInfo);
+    // Fills m_seekFrameList from a cached entry instead. Returns false if
+    // the entry does not match the file.
+    bool initSeekFramesFromCache(const Mp3SeekFrameCache::Entry& cacheEntry);
+
     /** Returns the position in m_seekFrameList of the requested frame index. */
     SINT findSeekFrameIndex(SINT frameIndex) const;
 
     SINT m_curFrameIndex;
 
+    // The maximum number of channels of all MP3 frames. Mono signals are
+    // converted to stereo while decoding if requested.
+    SINT m_streamChannelCount;
+
     // NOTE(uklotzde): Each invocation of initDecoding() must be
     // followed by an invocation of finishDecoding().
     void initDecoding();
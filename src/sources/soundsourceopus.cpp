@@ -70,15 +70,20 @@ SoundSourceOpus::~SoundSourceOpus() {
 std::pair<MetadataSource::ImportResult, QDateTime>
 SoundSourceOpus::importTrackMetadataAndCoverImage(
         TrackMetadata* pTrackMetadata,
-        QImage* pCoverArt) const {
+        QImage* pCoverArt,
+        ImportFields importFields) const {
     auto const imported =
             SoundSource::importTrackMetadataAndCoverImage(
-                    pTrackMetadata, pCoverArt);
+                    pTrackMetadata, pCoverArt, importFields);
     if (imported.first == ImportResult::Succeeded) {
         // Done if the default implementation in the base class
         // supports Opus files.
         return imported;
     }
+    if ((pTrackMetadata == nullptr) || (importFields == 0)) {
+        // No cover art without TagLib
+        return imported;
+    }
 
     // Beginning with version 1.9.0 TagLib supports the Opus format.
     // Until this becomes the minimum version required by Mixxx tags
@@ -114,18 +119,20 @@ SoundSourceOpus::importTrackMetadataAndCoverImage(
         return imported;
     }
 
-    pTrackMetadata->setChannels(ChannelCount(op_channel_count(pOggOpusFile, -1)));
-    pTrackMetadata->setSampleRate(kSampleRate);
-    pTrackMetadata->setBitrate(Bitrate(op_bitrate(pOggOpusFile, -1) / 1000));
-    // Cast to double is required for duration with sub-second precision
-    const double dTotalFrames = op_pcm_total(pOggOpusFile, -1);
-    pTrackMetadata->setDuration(Duration::fromMicros(
-            1000000 * dTotalFrames / pTrackMetadata->getSampleRate()));
+    if (importFields & IMPORT_AUDIO_PROPERTIES) {
+        pTrackMetadata->setChannels(ChannelCount(op_channel_count(pOggOpusFile, -1)));
+        pTrackMetadata->setSampleRate(kSampleRate);
+        pTrackMetadata->setBitrate(Bitrate(op_bitrate(pOggOpusFile, -1) / 1000));
+        // Cast to double is required for duration with sub-second precision
+        const double dTotalFrames = op_pcm_total(pOggOpusFile, -1);
+        pTrackMetadata->setDuration(Duration::fromMicros(
+                1000000 * dTotalFrames / pTrackMetadata->getSampleRate()));
+    }
 
 #ifndef TAGLIB_HAS_OPUSFILE
     const OpusTags *l_ptrOpusTags = op_tags(pOggOpusFile, -1);
     bool hasDate = false;
-    for (int i = 0; i < l_ptrOpusTags->comments; ++i) {
+    for (int i = 0; (importFields & IMPORT_TAGS) && (i < l_ptrOpusTags->comments); ++i) {
         QString l_SWholeTag = QString(l_ptrOpusTags->user_comments[i]);
         QString l_STag = l_SWholeTag.left(l_SWholeTag.indexOf("="));
         QString l_SPayload = l_SWholeTag.right((l_SWholeTag.length() - l_SWholeTag.indexOf("=")) - 1);
@@ -27,7 +27,8 @@ class SoundSourceOpus: public SoundSource {
 
     std::pair<ImportResult, QDateTime> importTrackMetadataAndCoverImage(
             TrackMetadata* pTrackMetadata,
-            QImage* pCoverArt) const override;
+            QImage* pCoverArt,
+            ImportFields importFields) const override;
 
     void close() override;
 
@@ -0,0 +1,170 @@
+#include "sources/soundsourceplugincache.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
+
+#include "sources/soundsourcepluginapi.h"
+#include "util/logger.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("SoundSourcePluginCache");
+
+// Must be changed whenever the layout of the file changes
+const quint32 kMagic = 0x4D585350; // "MXSP"
+const quint32 kFormatVersion = 1;
+
+qint64 lastModifiedOf(const QFileInfo& fileInfo) {
+    return fileInfo.lastModified().toMSecsSinceEpoch();
+}
+
+} // anonymous namespace
+
+SoundSourcePluginCache::SoundSourcePluginCache(const QString& filePath)
+        : m_filePath(filePath),
+          m_modified(false) {
+}
+
+bool SoundSourcePluginCache::load() {
+    m_entries.clear();
+    m_modified = false;
+    if (m_filePath.isEmpty()) {
+        return false;
+    }
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic;
+    quint32 formatVersion;
+    qint32 apiVersion;
+    quint32 entryCount;
+    in >> magic >> formatVersion >> apiVersion >> entryCount;
+    if (in.status() != QDataStream::Ok ||
+            magic != kMagic ||
+            formatVersion != kFormatVersion) {
+        kLogger.warning() << "Invalid cache file" << m_filePath;
+        return false;
+    }
+    if (apiVersion != MIXXX_SOUNDSOURCEPLUGINAPI_VERSION) {
+        // The plugins need to be loaded again to check their version
+        return false;
+    }
+    QList<Entry> entries;
+    for (quint32 i = 0; i < entryCount; ++i) {
+        Entry entry;
+        quint32 fileExtensionCount;
+        in >> entry.libFilePath >> entry.fileSize >> entry.lastModified
+                >> entry.providerName >> fileExtensionCount;
+        for (quint32 j = 0; j < fileExtensionCount; ++j) {
+            QString fileExtension;
+            qint32 priority;
+            in >> fileExtension >> priority;
+            if (priority < static_cast<qint32>(SoundSourceProviderPriority::LOWEST) ||
+                    priority > static_cast<qint32>(SoundSourceProviderPriority::HIGHEST)) {
+                kLogger.warning() << "Invalid priority in" << m_filePath;
+                return false;
+            }
+            entry.fileExtensionPriorities.insert(fileExtension,
+                    static_cast<SoundSourceProviderPriority>(priority));
+        }
+        if (in.status() != QDataStream::Ok ||
+                entry.fileExtensionPriorities.isEmpty()) {
+            kLogger.warning() << "Invalid cache file" << m_filePath;
+            return false;
+        }
+        entries.append(entry);
+    }
+    m_entries = entries;
+    return true;
+}
+
+bool SoundSourcePluginCache::save() const {
+    if (m_filePath.isEmpty()) {
+        return false;
+    }
+    // Written to a temporary file that replaces the old one on commit
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        kLogger.warning() << "Failed to create" << m_filePath
+                << file.errorString();
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << kMagic << kFormatVersion
+            << qint32(MIXXX_SOUNDSOURCEPLUGINAPI_VERSION)
+            << quint32(m_entries.size());
+    for (const Entry& entry : m_entries) {
+        out << entry.libFilePath << entry.fileSize << entry.lastModified
+                << entry.providerName
+                << quint32(entry.fileExtensionPriorities.size());
+        for (auto i = entry.fileExtensionPriorities.constBegin();
+                i != entry.fileExtensionPriorities.constEnd(); ++i) {
+            out << i.key() << static_cast<qint32>(i.value());
+        }
+    }
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        kLogger.warning() << "Failed to write" << m_filePath
+                << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+const SoundSourcePluginCache::Entry* SoundSourcePluginCache::find(
+        const QFileInfo& libFileInfo) const {
+    const QString libFilePath = libFileInfo.absoluteFilePath();
+    for (const Entry& entry : m_entries) {
+        if (entry.libFilePath == libFilePath) {
+            if (entry.fileSize == libFileInfo.size() &&
+                    entry.lastModified == lastModifiedOf(libFileInfo)) {
+                return &entry;
+            }
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+void SoundSourcePluginCache::insert(const QFileInfo& libFileInfo,
+        const SoundSourceProviderPointer& pProvider) {
+    Entry entry;
+    entry.libFilePath = libFileInfo.absoluteFilePath();
+    entry.fileSize = libFileInfo.size();
+    entry.lastModified = lastModifiedOf(libFileInfo);
+    entry.providerName = pProvider->getName();
+    for (const auto& fileExtension : pProvider->getSupportedFileExtensions()) {
+        entry.fileExtensionPriorities.insert(fileExtension,
+                pProvider->getPriorityHint(fileExtension));
+    }
+    if (entry.fileExtensionPriorities.isEmpty()) {
+        // Not registered at all
+        return;
+    }
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].libFilePath == entry.libFilePath) {
+            m_entries.removeAt(i);
+            break;
+        }
+    }
+    m_entries.append(entry);
+    m_modified = true;
+}
+
+void SoundSourcePluginCache::retain(const QStringList& libFilePaths) {
+    for (int i = m_entries.size() - 1; i >= 0; --i) {
+        if (!libFilePaths.contains(m_entries[i].libFilePath)) {
+            m_entries.removeAt(i);
+            m_modified = true;
+        }
+    }
+}
+
+} // namespace mixxx
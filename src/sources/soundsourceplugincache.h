@@ -0,0 +1,61 @@
+#ifndef MIXXX_SOUNDSOURCEPLUGINCACHE_H
+#define MIXXX_SOUNDSOURCEPLUGINCACHE_H
+
+#include <QFileInfo>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+#include "sources/soundsourceprovider.h"
+
+namespace mixxx {
+
+// The descriptions of the SoundSource plugins that have been loaded in an
+// earlier run, i.e. the name of the provider and the file extensions with
+// their priorities. With them the plugins are registered on startup
+// without loading the libraries, which are only loaded when a file of
+// their type is opened.
+//
+// A description is only used while the size and modification time of the
+// library are unchanged and it has been created for the current version
+// of the plugin API.
+class SoundSourcePluginCache {
+  public:
+    struct Entry {
+        QString libFilePath;
+        qint64 fileSize;
+        qint64 lastModified;
+        QString providerName;
+        QMap<QString, SoundSourceProviderPriority> fileExtensionPriorities;
+    };
+
+    // An empty file path disables the cache
+    explicit SoundSourcePluginCache(const QString& filePath);
+
+    // Returns false if the file does not exist or is invalid
+    bool load();
+    bool save() const;
+
+    // Returns nullptr if there is no valid entry for the library
+    const Entry* find(const QFileInfo& libFileInfo) const;
+
+    // Replaces the entry of the same library
+    void insert(const QFileInfo& libFileInfo,
+            const SoundSourceProviderPointer& pProvider);
+
+    // Removes the entries of all libraries that are not in the list
+    void retain(const QStringList& libFilePaths);
+
+    bool isModified() const {
+        return m_modified;
+    }
+
+  private:
+    const QString m_filePath;
+    QList<Entry> m_entries;
+    bool m_modified;
+};
+
+} // namespace mixxx
+
+#endif // MIXXX_SOUNDSOURCEPLUGINCACHE_H
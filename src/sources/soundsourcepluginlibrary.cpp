@@ -10,6 +10,47 @@ namespace {
 
 const Logger kLogger("SoundSourcePluginLibrary");
 
+// Stands in for the provider of a library that has not been loaded yet
+class DeferredSoundSourceProvider: public SoundSourceProvider {
+  public:
+    DeferredSoundSourceProvider(
+            SoundSourcePluginLibrary* pPluginLibrary,
+            const SoundSourcePluginCache::Entry& cacheEntry)
+            : m_pPluginLibrary(pPluginLibrary),
+              m_name(cacheEntry.providerName),
+              m_fileExtensionPriorities(cacheEntry.fileExtensionPriorities) {
+    }
+
+    QString getName() const override {
+        return m_name;
+    }
+
+    QStringList getSupportedFileExtensions() const override {
+        return m_fileExtensionPriorities.keys();
+    }
+
+    SoundSourceProviderPriority getPriorityHint(
+            const QString& supportedFileExtension) const override {
+        return m_fileExtensionPriorities.value(supportedFileExtension,
+                SoundSourceProviderPriority::DEFAULT);
+    }
+
+    SoundSourcePointer newSoundSource(const QUrl& url) override {
+        const SoundSourceProviderPointer pProvider =
+                m_pPluginLibrary->getLoadedSoundSourceProvider();
+        if (!pProvider) {
+            return SoundSourcePointer();
+        }
+        return pProvider->newSoundSource(url);
+    }
+
+  private:
+    // The library owns the provider and is never unloaded
+    SoundSourcePluginLibrary* const m_pPluginLibrary;
+    const QString m_name;
+    const QMap<QString, SoundSourceProviderPriority> m_fileExtensionPriorities;
+};
+
 } // anonymous namespace
 
 /*static*/ QMutex SoundSourcePluginLibrary::s_loadedPluginLibrariesMutex;
@@ -33,9 +74,26 @@ const Logger kLogger("SoundSourcePluginLibrary");
     }
 }
 
+/*static*/ SoundSourcePluginLibraryPointer SoundSourcePluginLibrary::loadDeferred(
+        const SoundSourcePluginCache::Entry& cacheEntry) {
+    const QMutexLocker mutexLocker(&s_loadedPluginLibrariesMutex);
+
+    if (s_loadedPluginLibraries.contains(cacheEntry.libFilePath)) {
+        return s_loadedPluginLibraries.value(cacheEntry.libFilePath);
+    }
+    auto pPluginLibrary =
+            std::make_shared<SoundSourcePluginLibrary>(cacheEntry.libFilePath);
+    pPluginLibrary->m_pSoundSourceProvider =
+            std::make_shared<DeferredSoundSourceProvider>(
+                    pPluginLibrary.get(), cacheEntry);
+    s_loadedPluginLibraries.insert(cacheEntry.libFilePath, pPluginLibrary);
+    return pPluginLibrary;
+}
+
 SoundSourcePluginLibrary::SoundSourcePluginLibrary(const QString& libFilePath)
     : m_library(libFilePath),
-      m_apiVersion(0) {
+      m_apiVersion(0),
+      m_deferredLoadFailed(false) {
 }
 
 SoundSourcePluginLibrary::~SoundSourcePluginLibrary() {
@@ -90,10 +148,13 @@ bool SoundSourcePluginLibrary::init() {
         return initFailedForIncompatiblePlugin();
     }
 
-    m_pSoundSourceProvider = SoundSourceProviderPointer(
+    m_pLoadedSoundSourceProvider = SoundSourceProviderPointer(
             (*createSoundSourceProviderFunc)(),
             destroySoundSourceProviderFunc);
-    if (m_pSoundSourceProvider) {
+    if (m_pLoadedSoundSourceProvider) {
+        if (!m_pSoundSourceProvider) {
+            m_pSoundSourceProvider = m_pLoadedSoundSourceProvider;
+        }
         return true;
     } else {
         kLogger.warning() << "Failed to create SoundSource provider for plugin library"
@@ -112,4 +173,14 @@ SoundSourceProviderPointer SoundSourcePluginLibrary::getSoundSourceProvider() co
     return m_pSoundSourceProvider;
 }
 
+SoundSourceProviderPointer SoundSourcePluginLibrary::getLoadedSoundSourceProvider() {
+    const QMutexLocker mutexLocker(&m_deferredLoadMutex);
+    if (!m_pLoadedSoundSourceProvider && !m_deferredLoadFailed) {
+        kLogger.info() << "Loading deferred plugin library"
+                << m_library.fileName();
+        m_deferredLoadFailed = !init();
+    }
+    return m_pLoadedSoundSourceProvider;
+}
+
 } // Mixxx
@@ -2,6 +2,7 @@
 #define MIXXX_SOUNDSOURCEPLUGINLIBRARY_H
 
 #include "sources/soundsourcepluginapi.h"
+#include "sources/soundsourceplugincache.h"
 #include "sources/soundsourceprovider.h"
 
 #include <QMap>
@@ -20,6 +21,13 @@ class SoundSourcePluginLibrary {
 public:
     static SoundSourcePluginLibraryPointer load(const QString& libFilePath);
 
+    // Registers the library with the description from an earlier run
+    // without loading it. The library is loaded when its provider creates
+    // the first SoundSource. If it fails to load, the provider does not
+    // create any SoundSources.
+    static SoundSourcePluginLibraryPointer loadDeferred(
+            const SoundSourcePluginCache::Entry& cacheEntry);
+
     // Use load() instead of this constructor!
     // The constructor has been declared 'public' only for technical reasons.
     explicit SoundSourcePluginLibrary(const QString& libFilePath);
@@ -36,6 +44,10 @@ public:
 
     SoundSourceProviderPointer getSoundSourceProvider() const;
 
+    // Loads a deferred library if it has not been loaded yet and returns
+    // the provider of the plugin, or nullptr if loading failed
+    SoundSourceProviderPointer getLoadedSoundSourceProvider();
+
 protected:
     virtual bool init();
 
@@ -45,6 +57,13 @@ private:
 
     bool initFailedForIncompatiblePlugin() const;
 
+    // Guards loading a deferred library
+    QMutex m_deferredLoadMutex;
+    bool m_deferredLoadFailed;
+
+    // The provider of the plugin once the library has been loaded
+    SoundSourceProviderPointer m_pLoadedSoundSourceProvider;
+
     QLibrary m_library;
 
     int m_apiVersion;
@@ -156,6 +156,12 @@ void SoundSourceProviderRegistry::deregisterPluginLibrary(
     }
 }
 
+QStringList SoundSourceProviderRegistry::getRegisteredFileExtensions() const {
+    QStringList fileExtensions(m_registry.keys());
+    fileExtensions.sort();
+    return fileExtensions;
+}
+
 QList<SoundSourceProviderRegistration>
 SoundSourceProviderRegistry::getRegistrationsForFileExtension(
         const QString& fileExtension) const {
@@ -3,7 +3,7 @@
 
 #include "sources/soundsourcepluginlibrary.h"
 
-#include <QMap>
+#include <QHash>
 
 namespace mixxx {
 
@@ -75,13 +75,13 @@ public:
     void deregisterPluginLibrary(
             const SoundSourcePluginLibraryPointer& pPluginLibrary);
 
-    QStringList getRegisteredFileExtensions() const {
-        return m_registry.keys();
-    }
+    // Sorted alphabetically
+    QStringList getRegisteredFileExtensions() const;
 
     // Returns all registrations for the given file extension.
     // If no providers have been registered for this file extension
-    // an empty list will be returned.
+    // an empty list will be returned. The lists are kept ordered by
+    // priority while registering, so this is a single hash lookup.
     QList<SoundSourceProviderRegistration> getRegistrationsForFileExtension(
             const QString& fileExtension) const;
 
@@ -94,7 +94,7 @@ private:
             QList<SoundSourceProviderRegistration>* pRegistrations,
             SoundSourceProviderRegistration registration);
 
-    typedef QMap<QString, QList<SoundSourceProviderRegistration>> FileExtension2RegistrationList;
+    typedef QHash<QString, QList<SoundSourceProviderRegistration>> FileExtension2RegistrationList;
 
     FileExtension2RegistrationList m_registry;
 };
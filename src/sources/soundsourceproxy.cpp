@@ -1,9 +1,14 @@
 #include <QApplication>
+#include <QCache>
+#include <QDateTime>
 #include <QDesktopServices>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "sources/soundsourceproxy.h"
 
 #include "sources/audiosourcetrackproxy.h"
+#include "sources/soundsourceplugincache.h"
 
 #ifdef __MAD__
 #include "sources/soundsourcemp3.h"
@@ -31,6 +36,7 @@
 #include "util/cmdlineargs.h"
 #include "util/regex.h"
 #include "util/logger.h"
+#include "util/memory.h"
 
 //Static memory allocation
 /*static*/ mixxx::SoundSourceProviderRegistry SoundSourceProxy::s_soundSourceProviders;
@@ -41,6 +47,23 @@ namespace {
 
 const mixxx::Logger kLogger("SoundSourceProxy");
 
+// The provider and mode that have opened a file successfully. The same
+// file is usually opened by several readers shortly after each other,
+// e.g. by the analysis and a deck, and the providers that have failed
+// to open it before don't need to probe it again.
+struct OpenedProvider {
+    QString providerName;
+    mixxx::SoundSource::OpenMode openMode;
+    qint64 fileSize;
+    QDateTime lastModified;
+};
+
+const int kMaxOpenedProviders = 256;
+
+// Keyed by the local file name
+QMutex s_openedProvidersMutex;
+QCache<QString, OpenedProvider> s_openedProviders(kMaxOpenedProviders);
+
 #if (__UNIX__ || __LINUX__ || __APPLE__)
 // Filtering of plugin file names on UNIX systems
 const QStringList SOUND_SOURCE_PLUGIN_FILENAME_PATTERN("libsoundsource*");
@@ -143,7 +166,7 @@ QUrl getCanonicalUrlForTrack(const Track* pTrack) {
 } // anonymous namespace
 
 // static
-void SoundSourceProxy::loadPlugins() {
+void SoundSourceProxy::loadPlugins(const QString& pluginCacheFilePath) {
     // Initialize built-in file types.
     // Fallback providers should be registered before specialized
     // providers to ensure that they are only after the specialized
@@ -183,6 +206,9 @@ void SoundSourceProxy::loadPlugins() {
     // Scan for and initialize all plugins.
     // Loaded plugins will replace any built-in providers
     // that have been registered before (see above)!
+    mixxx::SoundSourcePluginCache pluginCache(pluginCacheFilePath);
+    pluginCache.load();
+    QStringList libFilePaths;
     const QList<QDir> pluginDirs(getSoundSourcePluginDirectories());
     for (const auto& pluginDir: pluginDirs) {
         kLogger.debug() << "Loading SoundSource plugins" << pluginDir.path();
@@ -190,17 +216,32 @@ void SoundSourceProxy::loadPlugins() {
                 SOUND_SOURCE_PLUGIN_FILENAME_PATTERN,
                 QDir::Files | QDir::NoDotAndDotDot));
         for (const auto& file: files) {
-            const QString libFilePath(pluginDir.filePath(file));
+            const QFileInfo libFileInfo(pluginDir.filePath(file));
+            const QString libFilePath(libFileInfo.absoluteFilePath());
+            libFilePaths.append(libFilePath);
+            const mixxx::SoundSourcePluginCache::Entry* pCacheEntry =
+                    pluginCache.find(libFileInfo);
+            if (pCacheEntry) {
+                s_soundSourceProviders.registerPluginLibrary(
+                        mixxx::SoundSourcePluginLibrary::loadDeferred(*pCacheEntry));
+                continue;
+            }
             mixxx::SoundSourcePluginLibraryPointer pPluginLibrary(
                     mixxx::SoundSourcePluginLibrary::load(libFilePath));
             if (pPluginLibrary) {
                 s_soundSourceProviders.registerPluginLibrary(pPluginLibrary);
+                pluginCache.insert(libFileInfo,
+                        pPluginLibrary->getSoundSourceProvider());
             } else {
                 kLogger.warning() << "Failed to load SoundSource plugin"
                         << libFilePath;
             }
         }
     }
+    pluginCache.retain(libFilePaths);
+    if (pluginCache.isModified()) {
+        pluginCache.save();
+    }
 
     const QStringList supportedFileExtensions(
             s_soundSourceProviders.getRegisteredFileExtensions());
@@ -266,7 +307,13 @@ bool SoundSourceProxy::isFileSupported(const QFileInfo& fileInfo) {
 
 // static
 bool SoundSourceProxy::isFileNameSupported(const QString& fileName) {
-    return fileName.contains(getSupportedFileNamesRegex());
+    // Called for every file while scanning the library, looking up the
+    // extension is much cheaper than matching the regex
+    const int dotIndex = fileName.lastIndexOf('.');
+    if (dotIndex < 0) {
+        return false;
+    }
+    return isFileExtensionSupported(fileName.mid(dotIndex + 1).toLower());
 }
 
 // static
@@ -299,19 +346,12 @@ SoundSourceProxy::findSoundSourceProviderRegistrations(
 }
 
 //static
-Track::ExportMetadataResult
-SoundSourceProxy::exportTrackMetadataBeforeSaving(Track* pTrack) {
-    DEBUG_ASSERT(pTrack);
-    mixxx::MetadataSourcePointer pMetadataSource =
-            SoundSourceProxy(pTrack).m_pSoundSource;
-    if (pMetadataSource) {
-        return pTrack->exportMetadata(pMetadataSource);
-    } else {
-        kLogger.warning()
-                << "Unable to export track metadata into file"
-                << pTrack->getLocation();
-        return Track::ExportMetadataResult::Skipped;
+mixxx::MetadataSourcePointer SoundSourceProxy::openMetadataSource(
+        const QString& canonicalLocation) {
+    if (canonicalLocation.isEmpty()) {
+        return mixxx::MetadataSourcePointer();
     }
+    return SoundSourceProxy(QUrl::fromLocalFile(canonicalLocation)).m_pSoundSource;
 }
 
 SoundSourceProxy::SoundSourceProxy(
@@ -332,6 +372,15 @@ SoundSourceProxy::SoundSourceProxy(
     initSoundSource();
 }
 
+SoundSourceProxy::SoundSourceProxy(
+        const QUrl& url)
+    : m_pTrack(TrackPointer()), // the track object has been destroyed
+      m_url(url),
+      m_soundSourceProviderRegistrations(findSoundSourceProviderRegistrations(m_url)),
+      m_soundSourceProviderRegistrationIndex(0) {
+    initSoundSource();
+}
+
 mixxx::SoundSourceProviderPointer SoundSourceProxy::getSoundSourceProvider() const {
     DEBUG_ASSERT(0 <= m_soundSourceProviderRegistrationIndex);
     if (m_soundSourceProviderRegistrations.size() > m_soundSourceProviderRegistrationIndex) {
@@ -414,7 +463,8 @@ namespace {
 } // anonymous namespace
 
 void SoundSourceProxy::updateTrackFromSource(
-        ImportTrackMetadataMode importTrackMetadataMode) const {
+        ImportTrackMetadataMode importTrackMetadataMode,
+        ImportCoverImageMode importCoverImageMode) const {
     DEBUG_ASSERT(m_pTrack);
 
     if (getUrl().isEmpty()) {
@@ -466,11 +516,15 @@ void SoundSourceProxy::updateTrackFromSource(
         // object has just been created.
         pCoverImg = &coverImg;
     }
+    if (importCoverImageMode == ImportCoverImageMode::Deferred) {
+        pCoverImg = nullptr;
+    }
 
     // Parse the tags stored in the audio file
     const auto metadataImported =
             m_pSoundSource->importTrackMetadataAndCoverImage(
-                    &trackMetadata, pCoverImg);
+                    &trackMetadata, pCoverImg,
+                    mixxx::MetadataSource::IMPORT_ALL_FIELDS);
     if (metadataImported.first != mixxx::MetadataSource::ImportResult::Succeeded) {
         kLogger.warning() << "Failed to parse track metadata and/or cover art from file"
                    << getUrl().toString();
@@ -538,9 +592,12 @@ void SoundSourceProxy::updateTrackFromSource(
     }
 }
 
-mixxx::MetadataSource::ImportResult SoundSourceProxy::importTrackMetadata(mixxx::TrackMetadata* pTrackMetadata) const {
+mixxx::MetadataSource::ImportResult SoundSourceProxy::importTrackMetadata(
+        mixxx::TrackMetadata* pTrackMetadata,
+        mixxx::MetadataSource::ImportFields importFields) const {
     if (m_pSoundSource) {
-        return m_pSoundSource->importTrackMetadataAndCoverImage(pTrackMetadata, nullptr).first;
+        return m_pSoundSource->importTrackMetadataAndCoverImage(
+                pTrackMetadata, nullptr, importFields).first;
     } else {
         return mixxx::MetadataSource::ImportResult::Unavailable;
     }
@@ -549,7 +606,9 @@ mixxx::MetadataSource::ImportResult SoundSourceProxy::importTrackMetadata(mixxx:
 QImage SoundSourceProxy::importCoverImage() const {
     if (m_pSoundSource) {
         QImage coverImg;
-        if (m_pSoundSource->importTrackMetadataAndCoverImage(nullptr, &coverImg).first ==
+        // Without the audio properties
+        if (m_pSoundSource->importTrackMetadataAndCoverImage(
+                nullptr, &coverImg, 0).first ==
                 mixxx::MetadataSource::ImportResult::Succeeded) {
             return coverImg;
         }
@@ -558,9 +617,61 @@ QImage SoundSourceProxy::importCoverImage() const {
     return QImage();
 }
 
+bool SoundSourceProxy::restoreOpenedProvider(
+        mixxx::SoundSource::OpenMode* pOpenMode) {
+    const QFileInfo fileInfo(m_url.toLocalFile());
+    OpenedProvider openedProvider;
+    {
+        const QMutexLocker locked(&s_openedProvidersMutex);
+        const OpenedProvider* pOpenedProvider =
+                s_openedProviders.object(fileInfo.absoluteFilePath());
+        if (!pOpenedProvider) {
+            return false;
+        }
+        openedProvider = *pOpenedProvider;
+    }
+    if ((openedProvider.fileSize != fileInfo.size()) ||
+            (openedProvider.lastModified != fileInfo.lastModified())) {
+        return false;
+    }
+    for (int i = m_soundSourceProviderRegistrationIndex;
+            i < m_soundSourceProviderRegistrations.size(); ++i) {
+        if (m_soundSourceProviderRegistrations[i].getProvider()->getName() ==
+                openedProvider.providerName) {
+            if (i != m_soundSourceProviderRegistrationIndex) {
+                closeAudioSource();
+                m_pSoundSource = mixxx::SoundSourcePointer();
+                m_soundSourceProviderRegistrationIndex = i;
+                initSoundSource();
+            }
+            *pOpenMode = openedProvider.openMode;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SoundSourceProxy::storeOpenedProvider(
+        mixxx::SoundSource::OpenMode openMode) const {
+    const QFileInfo fileInfo(m_url.toLocalFile());
+    auto pOpenedProvider = std::make_unique<OpenedProvider>();
+    pOpenedProvider->providerName = getSoundSourceProvider()->getName();
+    pOpenedProvider->openMode = openMode;
+    pOpenedProvider->fileSize = fileInfo.size();
+    pOpenedProvider->lastModified = fileInfo.lastModified();
+    const QMutexLocker locked(&s_openedProvidersMutex);
+    s_openedProviders.insert(fileInfo.absoluteFilePath(),
+            pOpenedProvider.release());
+}
+
 mixxx::AudioSourcePointer SoundSourceProxy::openAudioSource(const mixxx::AudioSource::OpenParams& params) {
     DEBUG_ASSERT(m_pTrack);
     auto openMode = mixxx::SoundSource::OpenMode::Strict;
+    if (m_url.isLocalFile() && restoreOpenedProvider(&openMode)) {
+        kLogger.debug() << "Reusing provider"
+                << getSoundSourceProvider()->getName()
+                << "of the previous open";
+    }
     while (m_pSoundSource && !m_pAudioSource) {
         kLogger.debug() << "Opening file"
                 << getUrl().toString()
@@ -593,6 +704,9 @@ mixxx::AudioSourcePointer SoundSourceProxy::openAudioSource(const mixxx::AudioSo
         if ((openResult == mixxx::SoundSource::OpenResult::Succeeded) && m_pSoundSource->verifyReadable()) {
             m_pAudioSource = mixxx::AudioSourceTrackProxy::create(m_pTrack, m_pSoundSource);
             DEBUG_ASSERT(m_pAudioSource);
+            if (m_url.isLocalFile()) {
+                storeOpenedProvider(openMode);
+            }
             if (m_pAudioSource->frameIndexRange().empty()) {
                 kLogger.warning() << "File is empty"
                            << getUrl().toString();
@@ -14,7 +14,11 @@ class SoundSourceProxy {
     // loads all SoundSource plugins with additional providers. This
     // function is not thread-safe and must be called only once
     // upon startup of the application.
-    static void loadPlugins();
+    //
+    // With a cache file the plugins that have not changed since the
+    // last run are registered from their description in the file and
+    // only loaded once a file of their type is opened.
+    static void loadPlugins(const QString& pluginCacheFilePath = QString());
 
     static QStringList getSupportedFileExtensions() {
         return s_soundSourceProviders.getRegisteredFileExtensions();
@@ -61,6 +65,15 @@ class SoundSourceProxy {
         Default = Once,
     };
 
+    enum class ImportCoverImageMode {
+        // Import the cover image together with the track metadata.
+        Immediately,
+        // Skip the cover image, which leaves the cover art of new track
+        // objects unknown until it is guessed in a separate pass. This
+        // avoids decoding the image while the track is imported.
+        Deferred,
+    };
+
     // Updates file type, metadata, and cover image of the track object
     // from the source file according to the given mode.
     //
@@ -82,11 +95,17 @@ class SoundSourceProxy {
     // properly. The application log will contain warning messages for a detailed
     // analysis in case unexpected behavior has been reported.
     void updateTrackFromSource(
-            ImportTrackMetadataMode importTrackMetadataMode = ImportTrackMetadataMode::Default) const;
+            ImportTrackMetadataMode importTrackMetadataMode = ImportTrackMetadataMode::Default,
+            ImportCoverImageMode importCoverImageMode = ImportCoverImageMode::Immediately) const;
 
     // Parse only the metadata from the file without modifying
-    // the referenced track.
-    mixxx::MetadataSource::ImportResult importTrackMetadata(mixxx::TrackMetadata* pTrackMetadata) const;
+    // the referenced track. Only the selected fields are imported,
+    // e.g. the tags without scanning the audio stream for the
+    // audio properties.
+    mixxx::MetadataSource::ImportResult importTrackMetadata(
+            mixxx::TrackMetadata* pTrackMetadata,
+            mixxx::MetadataSource::ImportFields importFields =
+                    mixxx::MetadataSource::IMPORT_ALL_FIELDS) const;
 
     // Parse only the cover image from the file without modifying
     // the referenced track.
@@ -105,13 +124,18 @@ class SoundSourceProxy {
     static QStringList s_supportedFileNamePatterns;
     static QRegExp s_supportedFileNamesRegex;
 
-    friend class TrackDAO;
-    static Track::ExportMetadataResult exportTrackMetadataBeforeSaving(Track* pTrack);
+    // Opens the file of a track that has already been destroyed for
+    // exporting its metadata. Returns a null pointer on failure.
+    friend class TrackMetadataExportQueue;
+    static mixxx::MetadataSourcePointer openMetadataSource(
+            const QString& canonicalLocation);
 
     // Special case: Construction from a plain TIO pointer is needed
     // for writing metadata immediately before the TIO is destroyed.
     explicit SoundSourceProxy(
             const Track* pTrack);
+    explicit SoundSourceProxy(
+            const QUrl& url);
 
     const TrackPointer m_pTrack;
 
@@ -126,6 +150,11 @@ class SoundSourceProxy {
 
     void initSoundSource();
 
+    // Switches to the provider that has opened the unmodified file
+    // before, if any, and returns its open mode
+    bool restoreOpenedProvider(mixxx::SoundSource::OpenMode* pOpenMode);
+    void storeOpenedProvider(mixxx::SoundSource::OpenMode openMode) const;
+
     // This pointer must stay in this class together with
     // the corresponding track pointer. Don't pass it around!!
     mixxx::SoundSourcePointer m_pSoundSource;
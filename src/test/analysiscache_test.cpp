@@ -0,0 +1,79 @@
+#include <QTemporaryDir>
+
+#include "test/mixxxtest.h"
+
+#include "analyzer/analysiscache.h"
+#include "track/keyfactory.h"
+
+namespace {
+
+const QString kFingerprint = QStringLiteral("0123456789abcdef");
+
+class AnalysisCacheTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_cacheDir.isValid());
+        AnalysisCache::setDirectory(m_cacheDir.path());
+    }
+
+    void TearDown() override {
+        AnalysisCache::setDirectory(QString());
+    }
+
+    static TrackPointer makeAnalyzedTrack() {
+        TrackPointer pTrack(Track::newTemporary());
+        pTrack->setKeys(KeyFactory::makeBasicKeys(
+                mixxx::track::io::key::A_MINOR,
+                mixxx::track::io::key::ANALYZER));
+        pTrack->setReplayGain(mixxx::ReplayGain(0.5, 0.9f));
+        return pTrack;
+    }
+
+    QTemporaryDir m_cacheDir;
+};
+
+TEST_F(AnalysisCacheTest, storeAndLoad) {
+    AnalysisCache::store(kFingerprint, *makeAnalyzedTrack());
+
+    TrackPointer pTrack(Track::newTemporary());
+    ASSERT_TRUE(AnalysisCache::load(kFingerprint, pTrack.get()));
+    EXPECT_EQ(mixxx::track::io::key::A_MINOR, pTrack->getKeys().getGlobalKey());
+    EXPECT_EQ(mixxx::ReplayGain(0.5, 0.9f), pTrack->getReplayGain());
+}
+
+TEST_F(AnalysisCacheTest, keepsResultsOfTheTrack) {
+    AnalysisCache::store(kFingerprint, *makeAnalyzedTrack());
+
+    TrackPointer pTrack(Track::newTemporary());
+    pTrack->setReplayGain(mixxx::ReplayGain(2.0, 0.5f));
+    ASSERT_TRUE(AnalysisCache::load(kFingerprint, pTrack.get()));
+    EXPECT_EQ(mixxx::ReplayGain(2.0, 0.5f), pTrack->getReplayGain());
+    EXPECT_TRUE(pTrack->getKeys().isValid());
+}
+
+TEST_F(AnalysisCacheTest, storeKeepsMissingResults) {
+    AnalysisCache::store(kFingerprint, *makeAnalyzedTrack());
+    // Without keys
+    TrackPointer pStored(Track::newTemporary());
+    pStored->setReplayGain(mixxx::ReplayGain(2.0, 0.5f));
+    AnalysisCache::store(kFingerprint, *pStored);
+
+    TrackPointer pTrack(Track::newTemporary());
+    ASSERT_TRUE(AnalysisCache::load(kFingerprint, pTrack.get()));
+    EXPECT_EQ(mixxx::ReplayGain(2.0, 0.5f), pTrack->getReplayGain());
+    EXPECT_EQ(mixxx::track::io::key::A_MINOR, pTrack->getKeys().getGlobalKey());
+}
+
+TEST_F(AnalysisCacheTest, disabled) {
+    AnalysisCache::setDirectory(QString());
+    AnalysisCache::store(kFingerprint, *makeAnalyzedTrack());
+    TrackPointer pTrack(Track::newTemporary());
+    EXPECT_FALSE(AnalysisCache::load(kFingerprint, pTrack.get()));
+}
+
+TEST_F(AnalysisCacheTest, unknownFingerprint) {
+    TrackPointer pTrack(Track::newTemporary());
+    EXPECT_FALSE(AnalysisCache::load(kFingerprint, pTrack.get()));
+}
+
+} // namespace
@@ -0,0 +1,570 @@
+// Benchmarks of the analyzers and the accuracy of their results. Run the
+// benchmarks with
+//   mixxx-test --benchmark --benchmark_filter=Analy
+// or with "scons benchmark" like the other benchmarks. All benchmarks
+// report the analyzed frames as items, so the items per second divided by
+// the sample rate in the label is the realtime factor.
+//
+// The corpus consists of synthetic signals and of the same reference
+// recording in the formats of the decoders. AnalyzerBaselineTest compares
+// the results of each analyzer with the baselines in
+// src/test/analyzer_baselines/, named like the signal. Like the reference
+// buffers of the signal path tests, the actual results are written next to
+// a baseline that does not match, and next to a missing one to record it.
+
+#include <gtest/gtest.h>
+#include <benchmark/benchmark.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QMap>
+#include <QTextStream>
+#include <QUrl>
+#include <QtDebug>
+
+#include <cmath>
+#include <vector>
+
+#ifdef __VAMP__
+#include "analyzer/analyzerbeats.h"
+#include "analyzer/analyzerkey.h"
+#endif
+#include "analyzer/analyzerloudness.h"
+#include "analyzer/analyzerpipeline.h"
+#include "analyzer/analyzerqueue.h"
+#include "analyzer/analyzerwaveform.h"
+#include "database/mixxxdb.h"
+#include "library/dao/analysisdao.h"
+#include "mixer/playerinfo.h"
+#include "preferences/replaygainsettings.h"
+#include "preferences/waveformsettings.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "sources/soundsourceflac.h"
+#include "sources/soundsourceoggvorbis.h"
+#ifdef __FFMPEGFILE__
+#include "sources/soundsourceffmpeg.h"
+#endif
+#ifdef __MAD__
+#include "sources/soundsourcemp3.h"
+#endif
+#include "test/mixxxtest.h"
+#include "track/beat_preferences.h"
+#include "track/key_preferences.h"
+#include "track/keyutils.h"
+#include "track/track.h"
+#include "util/math.h"
+#include "util/memory.h"
+#include "util/samplebuffer.h"
+
+namespace {
+
+// Like AnalyzerQueue
+const mixxx::AudioSignal::ChannelCount kAnalysisChannels(2);
+const SINT kAnalysisFramesPerBlock = 4096;
+const SINT kAnalysisSamplesPerBlock = kAnalysisFramesPerBlock * kAnalysisChannels;
+
+const int kSyntheticSampleRate = 44100;
+
+QDir testDir() {
+    return QDir(QDir::currentPath() + "/src/test");
+}
+
+// Interleaved stereo samples
+struct TestSignal {
+    QString name;
+    int sampleRate;
+    std::vector<CSAMPLE> samples;
+};
+
+// Kicks at 128 BPM over a sustained A minor triad
+TestSignal clickTrack() {
+    const double kBpm = 128.0;
+    const double kSeconds = 30.0;
+    const double kTriad[] = {220.0, 261.63, 329.63};
+    TestSignal signal{"Click128AMinor", kSyntheticSampleRate, {}};
+    const SINT frames = static_cast<SINT>(kSeconds * kSyntheticSampleRate);
+    const double framesPerBeat = 60.0 * kSyntheticSampleRate / kBpm;
+    signal.samples.resize(frames * kAnalysisChannels);
+    for (SINT i = 0; i < frames; ++i) {
+        const double time = static_cast<double>(i) / kSyntheticSampleRate;
+        double value = 0;
+        for (double frequency : kTriad) {
+            value += 0.1 * std::sin(2 * M_PI * frequency * time);
+        }
+        // A pitch sweep from 150 Hz to 50 Hz that decays within 50 ms
+        const double beatTime = std::fmod(static_cast<double>(i), framesPerBeat) /
+                kSyntheticSampleRate;
+        if (beatTime < 0.05) {
+            const double frequency = 50.0 + 100.0 * (1.0 - beatTime / 0.05);
+            value += 0.7 * std::exp(-beatTime * 60.0) *
+                    std::sin(2 * M_PI * frequency * beatTime);
+        }
+        signal.samples[2 * i] = signal.samples[2 * i + 1] =
+                static_cast<CSAMPLE>(value);
+    }
+    return signal;
+}
+
+// The first test signal of EBU Tech 3341, which is -23 LUFS
+TestSignal sineTone() {
+    const double kSeconds = 20.0;
+    const double kAmplitude = db2ratio(-23.0);
+    TestSignal signal{"Sine1kHz", kSyntheticSampleRate, {}};
+    const SINT frames = static_cast<SINT>(kSeconds * kSyntheticSampleRate);
+    signal.samples.resize(frames * kAnalysisChannels);
+    for (SINT i = 0; i < frames; ++i) {
+        signal.samples[2 * i] = signal.samples[2 * i + 1] =
+                static_cast<CSAMPLE>(kAmplitude *
+                        std::sin(2 * M_PI * 1000.0 * i / kSyntheticSampleRate));
+    }
+    return signal;
+}
+
+template<typename T>
+mixxx::SoundSourcePointer newSoundSource(const QUrl& url) {
+    return std::make_shared<T>(url);
+}
+
+struct Decoder {
+    const char* name;
+    const char* fileName;
+    mixxx::SoundSourcePointer (*create)(const QUrl& url);
+};
+
+// The same recording in each format
+const Decoder kDecoders[] = {
+#ifdef __MAD__
+    {"SoundSourceMp3", "id3-test-data/cover-test-png.mp3",
+            newSoundSource<mixxx::SoundSourceMp3>},
+#endif
+#ifdef __FFMPEGFILE__
+    {"SoundSourceFFmpeg", "id3-test-data/cover-test.m4a",
+            newSoundSource<mixxx::SoundSourceFFmpeg>},
+#endif
+    {"SoundSourceFLAC", "id3-test-data/cover-test.flac",
+            newSoundSource<mixxx::SoundSourceFLAC>},
+    {"SoundSourceOggVorbis", "id3-test-data/cover-test.ogg",
+            newSoundSource<mixxx::SoundSourceOggVorbis>},
+};
+const int kDecoderCount = sizeof(kDecoders) / sizeof(kDecoders[0]);
+
+QString decoderFilePath(const Decoder& decoder) {
+    return testDir().absoluteFilePath(decoder.fileName);
+}
+
+mixxx::AudioSourcePointer openDecoder(const Decoder& decoder) {
+    mixxx::SoundSourcePointer pSoundSource =
+            decoder.create(QUrl::fromLocalFile(decoderFilePath(decoder)));
+    mixxx::AudioSource::OpenParams openParams;
+    openParams.setChannelCount(kAnalysisChannels);
+    openParams.setSequentialAccess(true);
+    if (pSoundSource->open(mixxx::AudioSource::OpenMode::Strict, openParams) !=
+            mixxx::AudioSource::OpenResult::Succeeded) {
+        qWarning() << decoder.name << "failed to open" << decoder.fileName;
+        return mixxx::AudioSourcePointer();
+    }
+    return pSoundSource;
+}
+
+// Decodes the whole file in blocks like AnalyzerQueue, and appends the
+// samples if pSamples is not null. Returns the number of frames.
+SINT decode(mixxx::AudioSourcePointer pAudioSource,
+        mixxx::SampleBuffer* pSampleBuffer,
+        std::vector<CSAMPLE>* pSamples) {
+    mixxx::AudioSourceStereoProxy audioSourceProxy(
+            pAudioSource, kAnalysisFramesPerBlock);
+    mixxx::IndexRange remainingFrames = pAudioSource->frameIndexRange();
+    SINT decodedFrames = 0;
+    while (!remainingFrames.empty()) {
+        const auto readableSampleFrames = audioSourceProxy.readSampleFrames(
+                mixxx::WritableSampleFrames(
+                        remainingFrames.splitAndShrinkFront(math_min(
+                                kAnalysisFramesPerBlock, remainingFrames.length())),
+                        mixxx::SampleBuffer::WritableSlice(*pSampleBuffer)));
+        if (readableSampleFrames.frameLength() == 0) {
+            break;
+        }
+        decodedFrames += readableSampleFrames.frameLength();
+        if (pSamples) {
+            pSamples->insert(pSamples->end(),
+                    readableSampleFrames.readableData(),
+                    readableSampleFrames.readableData() +
+                            readableSampleFrames.readableLength());
+        }
+    }
+    return decodedFrames;
+}
+
+// The synthetic signals followed by the decoded files, which are decoded
+// once
+const TestSignal& corpusSignal(int index) {
+    static std::vector<TestSignal> s_signals;
+    if (s_signals.empty()) {
+        s_signals.push_back(clickTrack());
+        s_signals.push_back(sineTone());
+        mixxx::SampleBuffer sampleBuffer(kAnalysisSamplesPerBlock);
+        for (const auto& decoder : kDecoders) {
+            TestSignal signal{decoder.name, kSyntheticSampleRate, {}};
+            mixxx::AudioSourcePointer pAudioSource = openDecoder(decoder);
+            if (pAudioSource) {
+                signal.sampleRate = pAudioSource->sampleRate();
+                decode(pAudioSource, &sampleBuffer, &signal.samples);
+            }
+            s_signals.push_back(std::move(signal));
+        }
+    }
+    return s_signals[index];
+}
+const int kCorpusSize = 2 + kDecoderCount;
+
+double waveformSummaryMean(const Track& track) {
+    ConstWaveformPointer pWaveform = track.getWaveformSummary();
+    if (!pWaveform || pWaveform->getDataSize() == 0) {
+        return 0;
+    }
+    double sum = 0;
+    for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+        sum += pWaveform->getAll(i);
+    }
+    return sum / pWaveform->getDataSize();
+}
+
+// How an analyzer is created and which of its results is compared with
+// the baselines. A negative tolerance compares the text of the result.
+struct AnalyzerCase {
+    const char* name;
+    const char* resultName;
+    double tolerance;
+    int replayGainVersion;
+    std::unique_ptr<Analyzer> (*create)(
+            const UserSettingsPointer& pConfig, AnalysisDao* pAnalysisDao);
+    QString (*result)(const Track& track);
+};
+
+const AnalyzerCase kAnalyzerCases[] = {
+    {"AnalyzerWaveform", "waveform_summary_mean", 1.0, 2,
+            [](const UserSettingsPointer&, AnalysisDao* pAnalysisDao) {
+                return std::unique_ptr<Analyzer>(
+                        std::make_unique<AnalyzerWaveform>(pAnalysisDao));
+            },
+            [](const Track& track) {
+                return track.getWaveformSummary()
+                        ? QString::number(waveformSummaryMean(track), 'f', 2)
+                        : QString();
+            }},
+#ifdef __VAMP__
+    {"AnalyzerBeats", "bpm", 0.5, 2,
+            [](const UserSettingsPointer& pConfig, AnalysisDao*) {
+                return std::unique_ptr<Analyzer>(
+                        std::make_unique<AnalyzerBeats>(pConfig));
+            },
+            [](const Track& track) {
+                return track.getBeats()
+                        ? QString::number(track.getBpm(), 'f', 2) : QString();
+            }},
+    {"AnalyzerKey", "key", -1.0, 2,
+            [](const UserSettingsPointer& pConfig, AnalysisDao*) {
+                return std::unique_ptr<Analyzer>(
+                        std::make_unique<AnalyzerKey>(pConfig));
+            },
+            [](const Track& track) {
+                return track.getKeys().isValid()
+                        ? KeyUtils::keyToString(track.getKeys().getGlobalKey(),
+                                KeyUtils::TRADITIONAL)
+                        : QString();
+            }},
+#endif
+    {"AnalyzerLoudness1", "replaygain1_db", 0.2, 1,
+            [](const UserSettingsPointer& pConfig, AnalysisDao*) {
+                return std::unique_ptr<Analyzer>(
+                        std::make_unique<AnalyzerLoudness>(pConfig));
+            },
+            [](const Track& track) {
+                return track.getReplayGain().hasRatio()
+                        ? QString::number(ratio2db(track.getReplayGain().getRatio()), 'f', 2)
+                        : QString();
+            }},
+    {"AnalyzerLoudness2", "replaygain2_db", 0.2, 2,
+            [](const UserSettingsPointer& pConfig, AnalysisDao*) {
+                return std::unique_ptr<Analyzer>(
+                        std::make_unique<AnalyzerLoudness>(pConfig));
+            },
+            [](const Track& track) {
+                return track.getReplayGain().hasRatio()
+                        ? QString::number(ratio2db(track.getReplayGain().getRatio()), 'f', 2)
+                        : QString();
+            }},
+};
+const int kAnalyzerCaseCount = sizeof(kAnalyzerCases) / sizeof(kAnalyzerCases[0]);
+
+// Analyzes the signal like AnalyzerQueue, returns false if none of the
+// analyzers needed to process it
+bool analyze(const std::vector<Analyzer*>& analyzers,
+        const TestSignal& signal, const TrackPointer& pTrack) {
+    const int totalSamples = static_cast<int>(signal.samples.size());
+    bool processTrack = false;
+    for (Analyzer* pAnalyzer : analyzers) {
+        // Make sure not to short-circuit initialize(...)
+        if (pAnalyzer->initialize(pTrack, signal.sampleRate, totalSamples)) {
+            processTrack = true;
+        }
+    }
+    if (!processTrack) {
+        return false;
+    }
+    AnalyzerPipeline pipeline(analyzers);
+    // Only full blocks, like AnalyzerQueue
+    for (int offset = 0; offset + kAnalysisSamplesPerBlock <= totalSamples;
+            offset += kAnalysisSamplesPerBlock) {
+        pipeline.process(signal.samples.data() + offset, kAnalysisSamplesPerBlock);
+    }
+    pipeline.drain();
+    for (Analyzer* pAnalyzer : analyzers) {
+        pAnalyzer->finalize(pTrack);
+    }
+    return true;
+}
+
+class AnalyzerBaselineTest : public MixxxTest {
+  protected:
+    AnalyzerBaselineTest()
+            : m_analysisDao(config()) {
+        // The results are not stored
+        WaveformSettings(config()).setWaveformCachingEnabled(false);
+        ReplayGainSettings replayGainSettings(config());
+        replayGainSettings.setReplayGainAnalyzerEnabled(true);
+        replayGainSettings.setReplayGainAnalyzerVersion(2);
+        config()->set(ConfigKey(BPM_CONFIG_KEY, BPM_DETECTION_ENABLED), ConfigValue(1));
+        config()->set(ConfigKey(BPM_CONFIG_KEY, BPM_FIXED_TEMPO_ASSUMPTION), ConfigValue(1));
+        config()->set(ConfigKey(BPM_CONFIG_KEY, BPM_FIXED_TEMPO_OFFSET_CORRECTION), ConfigValue(1));
+        config()->set(ConfigKey(BPM_CONFIG_KEY, BPM_RANGE_START), ConfigValue(70));
+        config()->set(ConfigKey(BPM_CONFIG_KEY, BPM_RANGE_END), ConfigValue(140));
+        config()->set(ConfigKey(VAMP_CONFIG_KEY, VAMP_ANALYZER_BEAT_LIBRARY),
+                ConfigValue("libmixxxminimal"));
+        config()->set(ConfigKey(VAMP_CONFIG_KEY, VAMP_ANALYZER_BEAT_PLUGIN_ID),
+                ConfigValue("qm-tempotracker:0"));
+        config()->set(ConfigKey(KEY_CONFIG_KEY, KEY_DETECTION_ENABLED), ConfigValue(1));
+    }
+
+  public:
+    using MixxxTest::config;
+
+    std::unique_ptr<Analyzer> createAnalyzer(const AnalyzerCase& analyzerCase) {
+        ReplayGainSettings(config()).setReplayGainAnalyzerVersion(
+                analyzerCase.replayGainVersion);
+        return analyzerCase.create(config(), &m_analysisDao);
+    }
+
+    // All analyzers of AnalyzerQueue, with ReplayGain 2.0
+    std::vector<std::unique_ptr<Analyzer>> createAllAnalyzers() {
+        ReplayGainSettings(config()).setReplayGainAnalyzerVersion(2);
+        std::vector<std::unique_ptr<Analyzer>> analyzers;
+        for (const auto& analyzerCase : kAnalyzerCases) {
+            // Only one AnalyzerLoudness, like AnalyzerQueue
+            if (analyzerCase.replayGainVersion != 2) {
+                continue;
+            }
+            analyzers.push_back(analyzerCase.create(config(), &m_analysisDao));
+        }
+        return analyzers;
+    }
+
+  protected:
+    typedef QMap<QString, QString> AnalysisResults;
+
+    // Runs each analyzer on its own
+    AnalysisResults analyzeSignal(const TestSignal& signal) {
+        AnalysisResults results;
+        for (const auto& analyzerCase : kAnalyzerCases) {
+            std::unique_ptr<Analyzer> pAnalyzer = createAnalyzer(analyzerCase);
+            TrackPointer pTrack = Track::newTemporary();
+            pTrack->setSampleRate(signal.sampleRate);
+            if (!analyze({pAnalyzer.get()}, signal, pTrack)) {
+                continue;
+            }
+            const QString result = analyzerCase.result(*pTrack);
+            if (!result.isEmpty()) {
+                results[analyzerCase.resultName] = result;
+            }
+        }
+        return results;
+    }
+
+    void expectResultsMatchBaseline(const QString& name,
+            const AnalysisResults& results) {
+        const QString path = testDir().absoluteFilePath("analyzer_baselines/" + name);
+        QFile baseline(path);
+        bool pass = true;
+        const bool exists = baseline.open(QFile::ReadOnly | QFile::Text);
+        if (exists) {
+            QTextStream in(&baseline);
+            while (!in.atEnd()) {
+                const QString line = in.readLine().trimmed();
+                if (line.isEmpty()) {
+                    continue;
+                }
+                const QString resultName = line.section(' ', 0, 0);
+                const QString expected = line.section(' ', 1);
+                if (!results.contains(resultName)) {
+                    // E.g. the Vamp plugins are not installed
+                    qWarning() << name << resultName
+                               << "was not analyzed, skipping its baseline";
+                    continue;
+                }
+                const QString actual = results[resultName];
+                bool match = actual == expected;
+                for (const auto& analyzerCase : kAnalyzerCases) {
+                    if (resultName == analyzerCase.resultName &&
+                            analyzerCase.tolerance >= 0) {
+                        match = std::fabs(actual.toDouble() - expected.toDouble()) <=
+                                analyzerCase.tolerance;
+                    }
+                }
+                if (!match) {
+                    qWarning() << "Baseline check of" << name << "failed for"
+                               << resultName << ":" << expected << "vs" << actual;
+                    pass = false;
+                }
+            }
+        }
+        if (!pass || !exists) {
+            qWarning() << (exists ? "Results do not match" : "No baseline for")
+                       << name << ", actual results written to"
+                       << "analyzer_baselines/" + name + ".actual";
+            QFile actual(path + ".actual");
+            ASSERT_TRUE(actual.open(QFile::WriteOnly | QFile::Text));
+            QTextStream out(&actual);
+            for (auto it = results.constBegin(); it != results.constEnd(); ++it) {
+                out << it.key() << ' ' << it.value() << '\n';
+            }
+        }
+        // A missing baseline is only recorded
+        EXPECT_TRUE(pass);
+    }
+
+    AnalysisDao m_analysisDao;
+};
+
+TEST_F(AnalyzerBaselineTest, SyntheticSignals) {
+    for (int i = 0; i < 2; ++i) {
+        const TestSignal& signal = corpusSignal(i);
+        expectResultsMatchBaseline(signal.name, analyzeSignal(signal));
+    }
+}
+
+TEST_F(AnalyzerBaselineTest, ReferenceFiles) {
+    for (int i = 2; i < kCorpusSize; ++i) {
+        const TestSignal& signal = corpusSignal(i);
+        if (signal.samples.empty()) {
+            qWarning() << "Skipping the baseline of" << signal.name;
+            continue;
+        }
+        expectResultsMatchBaseline(signal.name, analyzeSignal(signal));
+    }
+}
+
+// Provides the configured analyzers outside of a test
+class AnalyzerBenchmarkEnvironment : public AnalyzerBaselineTest {
+  private:
+    void TestBody() override {}
+};
+
+QString realtimeLabel(const QString& name, int sampleRate) {
+    return QString("%1 at %2 Hz").arg(name, QString::number(sampleRate));
+}
+
+static void DecoderArguments(benchmark::internal::Benchmark* b) {
+    for (int decoder = 0; decoder < kDecoderCount; ++decoder) {
+        b->Arg(decoder);
+    }
+}
+
+static void AnalyzerArguments(benchmark::internal::Benchmark* b) {
+    for (int analyzer = 0; analyzer < kAnalyzerCaseCount; ++analyzer) {
+        for (int signal = 0; signal < kCorpusSize; ++signal) {
+            b->ArgPair(analyzer, signal);
+        }
+    }
+}
+
+static void BM_Decoder(benchmark::State& state) {
+    const Decoder& decoder = kDecoders[state.range_x()];
+    const TestSignal& signal = corpusSignal(2 + state.range_x());
+    mixxx::SampleBuffer sampleBuffer(kAnalysisSamplesPerBlock);
+    SINT frames = 0;
+    while (state.KeepRunning()) {
+        mixxx::AudioSourcePointer pAudioSource = openDecoder(decoder);
+        if (pAudioSource) {
+            frames += decode(pAudioSource, &sampleBuffer, nullptr);
+        }
+    }
+    state.SetItemsProcessed(frames);
+    state.SetLabel(realtimeLabel(decoder.name, signal.sampleRate).toStdString());
+}
+BENCHMARK(BM_Decoder)->Apply(DecoderArguments)->UseRealTime();
+
+// Each analyzer on its own on the decoded signals
+static void BM_Analyzer(benchmark::State& state) {
+    AnalyzerBenchmarkEnvironment environment;
+    const AnalyzerCase& analyzerCase = kAnalyzerCases[state.range_x()];
+    const TestSignal& signal = corpusSignal(state.range_y());
+    std::unique_ptr<Analyzer> pAnalyzer = environment.createAnalyzer(analyzerCase);
+    while (state.KeepRunning()) {
+        TrackPointer pTrack = Track::newTemporary();
+        pTrack->setSampleRate(signal.sampleRate);
+        analyze({pAnalyzer.get()}, signal, pTrack);
+    }
+    state.SetItemsProcessed(state.iterations() * (signal.samples.size() / 2));
+    state.SetLabel(realtimeLabel(
+            QString("%1 %2").arg(analyzerCase.name, signal.name),
+            signal.sampleRate).toStdString());
+}
+BENCHMARK(BM_Analyzer)->Apply(AnalyzerArguments)->UseRealTime();
+
+// All analyzers of AnalyzerQueue in one pipeline on the decoded signals
+static void BM_AnalyzerPipeline(benchmark::State& state) {
+    AnalyzerBenchmarkEnvironment environment;
+    const TestSignal& signal = corpusSignal(state.range_x());
+    std::vector<std::unique_ptr<Analyzer>> pAnalyzers =
+            environment.createAllAnalyzers();
+    std::vector<Analyzer*> analyzers;
+    for (const auto& pAnalyzer : pAnalyzers) {
+        analyzers.push_back(pAnalyzer.get());
+    }
+    while (state.KeepRunning()) {
+        TrackPointer pTrack = Track::newTemporary();
+        pTrack->setSampleRate(signal.sampleRate);
+        analyze(analyzers, signal, pTrack);
+    }
+    state.SetItemsProcessed(state.iterations() * (signal.samples.size() / 2));
+    state.SetLabel(realtimeLabel(signal.name, signal.sampleRate).toStdString());
+}
+BENCHMARK(BM_AnalyzerPipeline)->DenseRange(0, kCorpusSize - 1)->UseRealTime();
+
+// The files analyzed by an AnalyzerQueue with one worker, including the
+// decoding. The decoder is the one that SoundSourceProxy picks for the
+// file type.
+static void BM_AnalyzerQueue(benchmark::State& state) {
+    AnalyzerBenchmarkEnvironment environment;
+    ReplayGainSettings(environment.config()).setReplayGainAnalyzerVersion(2);
+    const Decoder& decoder = kDecoders[state.range_x()];
+    const TestSignal& signal = corpusSignal(2 + state.range_x());
+    // Created on this thread before the workers use it
+    PlayerInfo::instance();
+    MixxxDb mixxxDb(environment.config());
+    AnalyzerQueue queue(mixxxDb.connectionPool(), environment.config());
+    QEventLoop eventLoop;
+    QObject::connect(&queue, SIGNAL(queueEmpty()), &eventLoop, SLOT(quit()));
+    while (state.KeepRunning()) {
+        queue.queueAnalyseTrack(
+                Track::newTemporary(QFileInfo(decoderFilePath(decoder))));
+        eventLoop.exec();
+    }
+    state.SetItemsProcessed(state.iterations() * (signal.samples.size() / 2));
+    state.SetLabel(realtimeLabel(decoder.fileName, signal.sampleRate).toStdString());
+}
+BENCHMARK(BM_AnalyzerQueue)->Apply(DecoderArguments)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "analyzer/analyzerpipeline.h"
+#include "util/math.h"
+
+namespace {
+
+// Records the samples it gets
+class RecordingAnalyzer : public Analyzer {
+  public:
+    explicit RecordingAnalyzer(InputFormat inputFormat)
+            : m_inputFormat(inputFormat) {
+    }
+
+    bool initialize(TrackPointer, int, int) override {
+        return true;
+    }
+    bool isDisabledOrLoadStoredSuccess(TrackPointer) const override {
+        return false;
+    }
+    void process(const CSAMPLE* pIn, const int iLen) override {
+        m_samples.insert(m_samples.end(), pIn, pIn + iLen);
+    }
+    void cleanup(TrackPointer) override {
+    }
+    void finalize(TrackPointer) override {
+    }
+    InputFormat inputFormat() const override {
+        return m_inputFormat;
+    }
+
+    std::vector<CSAMPLE> m_samples;
+
+  private:
+    const InputFormat m_inputFormat;
+};
+
+TEST(AnalyzerPipelineTest, ConvertsEachFormat) {
+    RecordingAnalyzer stereo(Analyzer::InputFormat::Stereo);
+    RecordingAnalyzer mono(Analyzer::InputFormat::Mono);
+    RecordingAnalyzer monoHalfRate(Analyzer::InputFormat::MonoHalfRate);
+    AnalyzerPipeline pipeline({&stereo, &mono, &monoHalfRate});
+
+    const CSAMPLE block[] = {1, 3, 5, 7};
+    const int kNumBlocks = 100;
+    for (int i = 0; i < kNumBlocks; ++i) {
+        pipeline.process(block, 4);
+    }
+    pipeline.drain();
+
+    ASSERT_EQ(size_t(4 * kNumBlocks), stereo.m_samples.size());
+    ASSERT_EQ(size_t(2 * kNumBlocks), mono.m_samples.size());
+    ASSERT_EQ(size_t(kNumBlocks), monoHalfRate.m_samples.size());
+    for (int i = 0; i < kNumBlocks; ++i) {
+        EXPECT_EQ(CSAMPLE(5), stereo.m_samples[4 * i + 2]);
+        EXPECT_EQ(CSAMPLE(2), mono.m_samples[2 * i]);
+        EXPECT_EQ(CSAMPLE(6), mono.m_samples[2 * i + 1]);
+        EXPECT_EQ(CSAMPLE(4), monoHalfRate.m_samples[i]);
+    }
+}
+
+TEST(AnalyzerPipelineTest, DecimatesBlocksOfAnySize) {
+    RecordingAnalyzer monoQuarterRate(Analyzer::InputFormat::MonoQuarterRate);
+    AnalyzerPipeline pipeline({&monoQuarterRate});
+
+    // DC in the left channel only
+    std::vector<CSAMPLE> leftOnly(2 * 1001);
+    for (size_t i = 0; i < leftOnly.size(); i += 2) {
+        leftOnly[i] = 1.0f;
+    }
+    const int kNumBlocks = 8;
+    for (int i = 0; i < kNumBlocks; ++i) {
+        pipeline.process(leftOnly.data(), leftOnly.size());
+    }
+    pipeline.drain();
+
+    // Every fourth of the 8008 frames
+    ASSERT_EQ(size_t(2002), monoQuarterRate.m_samples.size());
+    for (size_t i = 100; i < monoQuarterRate.m_samples.size(); ++i) {
+        EXPECT_NEAR(0.5f, monoQuarterRate.m_samples[i], 1e-4f);
+    }
+}
+
+TEST(AnalyzerPipelineTest, DecimationRemovesAliases) {
+    RecordingAnalyzer monoQuarterRate(Analyzer::InputFormat::MonoQuarterRate);
+    AnalyzerPipeline pipeline({&monoQuarterRate});
+
+    // A tone at 0.3 of the sample rate would alias to 0.05
+    std::vector<CSAMPLE> block(2 * 4096);
+    for (size_t i = 0; i < block.size() / 2; ++i) {
+        block[2 * i] = block[2 * i + 1] =
+                static_cast<CSAMPLE>(std::sin(2 * M_PI * 0.3 * i));
+    }
+    pipeline.process(block.data(), block.size());
+    pipeline.drain();
+
+    ASSERT_EQ(size_t(1024), monoQuarterRate.m_samples.size());
+    for (size_t i = 100; i < monoQuarterRate.m_samples.size(); ++i) {
+        EXPECT_GT(1e-3f, std::fabs(monoQuarterRate.m_samples[i]));
+    }
+}
+
+TEST(AnalyzerPipelineTest, CancelDropsQueuedBlocks) {
+    RecordingAnalyzer stereo(Analyzer::InputFormat::Stereo);
+    AnalyzerPipeline pipeline({&stereo});
+
+    const CSAMPLE block[] = {1, 2};
+    for (int i = 0; i < AnalyzerPipeline::kMaxQueuedBlocks; ++i) {
+        pipeline.process(block, 2);
+    }
+    pipeline.cancel();
+    const size_t processed = stereo.m_samples.size();
+    EXPECT_LE(processed, size_t(2 * AnalyzerPipeline::kMaxQueuedBlocks));
+
+    // Blocks that are queued after cancelling are processed again
+    pipeline.process(block, 2);
+    pipeline.drain();
+    EXPECT_EQ(processed + 2, stereo.m_samples.size());
+}
+
+} // anonymous namespace
@@ -39,13 +39,20 @@ class FakeDeck : public BaseTrackPlayer {
             : BaseTrackPlayer(NULL, group),
               playposition(ConfigKey(group, "playposition"), 0.0, 1.0, true),
               play(ConfigKey(group, "play")),
-              repeat(ConfigKey(group, "repeat")) {
+              repeat(ConfigKey(group, "repeat")),
+              trackSamples(ConfigKey(group, "track_samples")),
+              trackSampleRate(ConfigKey(group, "track_samplerate")),
+              prefetchPosition(ConfigKey(group, "prefetch_position")),
+              prefetchLength(ConfigKey(group, "prefetch_length")) {
         play.setButtonMode(ControlPushButton::TOGGLE);
         repeat.setButtonMode(ControlPushButton::TOGGLE);
+        prefetchPosition.set(-1.0);
     }
 
     void fakeTrackLoadedEvent(TrackPointer pTrack) {
         loadedTrack = pTrack;
+        trackSampleRate.set(44100);
+        trackSamples.set(pTrack->getDuration() * 44100 * 2);
         emit(newTrackLoaded(pTrack));
     }
 
@@ -81,6 +88,10 @@ class FakeDeck : public BaseTrackPlayer {
     ControlLinPotmeter playposition;
     ControlPushButton play;
     ControlPushButton repeat;
+    ControlObject trackSamples;
+    ControlObject trackSampleRate;
+    ControlObject prefetchPosition;
+    ControlObject prefetchLength;
 };
 
 class MockPlayerManager : public PlayerManagerInterface {
@@ -566,6 +577,10 @@ TEST_F(AutoDJProcessorTest, EnabledSuccess_PlayingDeck2) {
     EXPECT_DOUBLE_EQ(1.0, master.crossfader.get());
     EXPECT_DOUBLE_EQ(0.0, deck1.play.get());
     EXPECT_DOUBLE_EQ(1.0, deck2.play.get());
+
+    // The beginning of the track on deck 1 is prefetched for the transition.
+    EXPECT_DOUBLE_EQ(0.0, deck1.prefetchPosition.get());
+    EXPECT_LT(0.0, deck1.prefetchLength.get());
 }
 
 TEST_F(AutoDJProcessorTest, EnabledSuccess_PlayingDeck2_TrackLoadFailed) {
@@ -294,4 +294,82 @@ TEST_F(BeatMapTest, TestBpmAround) {
     EXPECT_DOUBLE_EQ(filebpm, pMap->getBpmAroundPosition(1 * approx_beat_length, 4));
 }
 
+TEST_F(BeatMapTest, CursorMatchesLookupWithoutCursor) {
+    const double bpm = 60.0;
+    m_pTrack->setBpm(bpm);
+    m_pTrack->setSampleRate(m_iSampleRate);
+    double beatLengthFrames = getBeatLengthFrames(bpm);
+    double beatLengthSamples = getBeatLengthSamples(bpm);
+    const int numBeats = 100;
+    QVector<double> beats = createBeatVector(7, numBeats, beatLengthFrames);
+    auto pMap = std::make_unique<BeatMap>(*m_pTrack, 0, beats);
+
+    BeatCursor cursor;
+    // Play forward, then seek backward and forward again
+    QVector<double> positions;
+    for (double position = -beatLengthSamples;
+            position < (numBeats + 1) * beatLengthSamples;
+            position += beatLengthSamples / 7) {
+        positions.append(position);
+    }
+    positions.append(50 * beatLengthSamples);
+    positions.append(3 * beatLengthSamples);
+    positions.append(90 * beatLengthSamples);
+
+    for (double position : positions) {
+        double prevBeat, nextBeat;
+        double cursorPrevBeat, cursorNextBeat;
+        bool found = pMap->findPrevNextBeats(position, &prevBeat, &nextBeat);
+        EXPECT_EQ(found, pMap->findPrevNextBeats(position, &cursorPrevBeat,
+                                                 &cursorNextBeat, &cursor));
+        EXPECT_DOUBLE_EQ(prevBeat, cursorPrevBeat);
+        EXPECT_DOUBLE_EQ(nextBeat, cursorNextBeat);
+        EXPECT_DOUBLE_EQ(pMap->findClosestBeat(position),
+                         pMap->findClosestBeat(position, &cursor));
+        for (int n : {-3, -1, 1, 2}) {
+            EXPECT_DOUBLE_EQ(pMap->findNthBeat(position, n),
+                             pMap->findNthBeat(position, n, &cursor));
+        }
+    }
+}
+
+TEST_F(BeatMapTest, CompactSerialization) {
+    const double bpm = 60.0;
+    m_pTrack->setSampleRate(m_iSampleRate);
+    double beatLengthFrames = getBeatLengthFrames(bpm);
+    // A constant tempo followed by a few irregular beats
+    QVector<double> beats = createBeatVector(7, 100, beatLengthFrames);
+    beats << beats.last() + 101 << beats.last() + 203 << beats.last() + 297;
+    auto pMap = std::make_unique<BeatMap>(*m_pTrack, 0, beats);
+
+    mixxx::track::io::BeatMap legacyMap;
+    for (double beat : beats) {
+        legacyMap.add_beat()->set_frame_position(beat);
+    }
+    std::string legacyOutput;
+    legacyMap.SerializeToString(&legacyOutput);
+    const QByteArray legacyByteArray(legacyOutput.data(), legacyOutput.length());
+
+    const QByteArray byteArray = pMap->toByteArray();
+    EXPECT_LT(byteArray.size(), legacyByteArray.size() / 4);
+
+    for (const QByteArray& input : {byteArray, legacyByteArray}) {
+        auto pLoadedMap = std::make_unique<BeatMap>(*m_pTrack, 0, input);
+        // Available before the beats are decoded
+        EXPECT_DOUBLE_EQ(pMap->getBpm(), pLoadedMap->getBpm());
+        EXPECT_EQ(byteArray, pLoadedMap->toByteArray());
+        for (double beat : beats) {
+            EXPECT_DOUBLE_EQ(pMap->findNextBeat(beat * 2 - 1),
+                             pLoadedMap->findNextBeat(beat * 2 - 1));
+        }
+        EXPECT_DOUBLE_EQ(pMap->getBpmAroundPosition(50 * beatLengthFrames, 4),
+                         pLoadedMap->getBpmAroundPosition(50 * beatLengthFrames, 4));
+    }
+
+    // A damaged byte array has no beats
+    BeatMap damagedMap(*m_pTrack, 0, byteArray.left(byteArray.size() - 1));
+    EXPECT_EQ(-1, damagedMap.findNextBeat(0));
+    EXPECT_EQ(-1, damagedMap.getBpm());
+}
+
 }  // namespace
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <QSqlError>
+#include <QSqlQuery>
+
+#include "test/mixxxtest.h"
+
+#include "database/mixxxdb.h"
+#include "util/db/cachedsqlquery.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/db/dbconnectionpooled.h"
+
+
+class CachedSqlQueryTest : public MixxxTest {
+  protected:
+    CachedSqlQueryTest()
+            : m_mixxxDb(config()),
+              m_pooler(m_mixxxDb.connectionPool()),
+              m_database(mixxx::DbConnectionPooled(m_mixxxDb.connectionPool())) {
+        QSqlQuery query(m_database);
+        query.exec("CREATE TABLE test (value INTEGER)");
+        query.exec("INSERT INTO test (value) VALUES (1)");
+        query.exec("INSERT INTO test (value) VALUES (2)");
+    }
+
+    int countValues(const QVariant& value) {
+        CachedSqlQuery query(m_database,
+                "SELECT COUNT(*) FROM test WHERE value IS :value");
+        query.bindValue(":value", value);
+        EXPECT_TRUE(query.exec());
+        EXPECT_TRUE(query.next());
+        return query.value(0).toInt();
+    }
+
+    const MixxxDb m_mixxxDb;
+    const mixxx::DbConnectionPooler m_pooler;
+    QSqlDatabase m_database;
+};
+
+TEST_F(CachedSqlQueryTest, ReuseStatement) {
+    EXPECT_EQ(1, countValues(1));
+    EXPECT_EQ(1, countValues(2));
+    EXPECT_EQ(0, countValues(3));
+}
+
+TEST_F(CachedSqlQueryTest, ResetBoundValues) {
+    EXPECT_EQ(1, countValues(1));
+    // Not bound by the next borrower
+    CachedSqlQuery query(m_database,
+            "SELECT COUNT(*) FROM test WHERE value IS :value");
+    ASSERT_TRUE(query.exec());
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(0, query.value(0).toInt());
+}
+
+TEST_F(CachedSqlQueryTest, NestedStatement) {
+    CachedSqlQuery outer(m_database, "SELECT value FROM test ORDER BY value");
+    ASSERT_TRUE(outer.exec());
+    int rows = 0;
+    while (outer.next()) {
+        // The same statement while it is still lent
+        CachedSqlQuery inner(m_database, "SELECT value FROM test ORDER BY value");
+        ASSERT_TRUE(inner.exec());
+        ASSERT_TRUE(inner.next());
+        EXPECT_EQ(1, inner.value(0).toInt());
+        EXPECT_EQ(++rows, outer.value(0).toInt());
+    }
+    EXPECT_EQ(2, rows);
+}
+
+TEST_F(CachedSqlQueryTest, InvalidStatement) {
+    CachedSqlQuery query(m_database, "SELECT value FROM missing");
+    EXPECT_TRUE(query.lastError().isValid());
+    EXPECT_FALSE(query.exec());
+}
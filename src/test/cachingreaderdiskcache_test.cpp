@@ -0,0 +1,105 @@
+#include <QTemporaryDir>
+#include <QtDebug>
+
+#include "test/mixxxtest.h"
+
+#include "engine/cachingreaderchunk.h"
+#include "engine/cachingreaderdiskcache.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "sources/soundsourceproxy.h"
+#include "util/samplebuffer.h"
+
+namespace {
+
+const QDir kTestDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+
+class CachingReaderDiskCacheTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_cacheDir.isValid());
+        m_pTrack = Track::newTemporary(kTestDir.absoluteFilePath("cover-test.wav"));
+    }
+
+    mixxx::AudioSourcePointer openDecoder() {
+        mixxx::AudioSource::OpenParams params;
+        params.setChannelCount(CachingReaderChunk::kChannels);
+        return SoundSourceProxy(m_pTrack).openAudioSource(params);
+    }
+
+    // Reads all frames as a stereo signal
+    static mixxx::SampleBuffer readAll(
+            const mixxx::AudioSourcePointer& pAudioSource) {
+        mixxx::SampleBuffer tempBuffer(
+                pAudioSource->frames2samples(pAudioSource->frameLength()));
+        mixxx::AudioSourceStereoProxy proxy(pAudioSource,
+                mixxx::SampleBuffer::WritableSlice(tempBuffer));
+        mixxx::SampleBuffer result(
+                CachingReaderChunk::frames2samples(pAudioSource->frameLength()));
+        const auto readable = proxy.readSampleFrames(
+                mixxx::WritableSampleFrames(
+                        pAudioSource->frameIndexRange(),
+                        mixxx::SampleBuffer::WritableSlice(result)));
+        EXPECT_EQ(pAudioSource->frameIndexRange(), readable.frameIndexRange());
+        return result;
+    }
+
+    QTemporaryDir m_cacheDir;
+    TrackPointer m_pTrack;
+};
+
+TEST_F(CachingReaderDiskCacheTest, WriteAndRead) {
+    CachingReaderDiskCache cache(m_cacheDir.path(), 64);
+    EXPECT_FALSE(cache.openAudioSource(m_pTrack));
+
+    auto pDecoder = openDecoder();
+    ASSERT_TRUE(pDecoder);
+    mixxx::SampleBuffer tempBuffer(
+            pDecoder->frames2samples(CachingReaderChunk::kFrames));
+    cache.startWriting(m_pTrack, pDecoder, pDecoder->frameIndexRange());
+    // The entry must not be visible before it is complete
+    EXPECT_FALSE(cache.openAudioSource(m_pTrack));
+    while (cache.writeNextSampleFrames(
+            mixxx::SampleBuffer::WritableSlice(tempBuffer))) {
+    }
+
+    auto pCached = cache.openAudioSource(m_pTrack);
+    ASSERT_TRUE(pCached);
+    EXPECT_EQ(pDecoder->frameIndexRange(), pCached->frameIndexRange());
+    EXPECT_EQ(pDecoder->sampleRate(), pCached->sampleRate());
+    EXPECT_EQ(CachingReaderChunk::kChannels, pCached->channelCount());
+
+    const mixxx::SampleBuffer expected = readAll(pDecoder);
+    const mixxx::SampleBuffer actual = readAll(pCached);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (SINT i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i], actual[i]) << "sample " << i;
+    }
+}
+
+TEST_F(CachingReaderDiskCacheTest, CancelWriting) {
+    CachingReaderDiskCache cache(m_cacheDir.path(), 64);
+    auto pDecoder = openDecoder();
+    ASSERT_TRUE(pDecoder);
+    mixxx::SampleBuffer tempBuffer(
+            pDecoder->frames2samples(CachingReaderChunk::kFrames));
+    cache.startWriting(m_pTrack, pDecoder, pDecoder->frameIndexRange());
+    cache.writeNextSampleFrames(mixxx::SampleBuffer::WritableSlice(tempBuffer));
+    cache.cancelWriting();
+    EXPECT_FALSE(cache.writeNextSampleFrames(
+            mixxx::SampleBuffer::WritableSlice(tempBuffer)));
+    EXPECT_FALSE(cache.openAudioSource(m_pTrack));
+    EXPECT_TRUE(QDir(m_cacheDir.path()).entryList(QDir::Files).isEmpty());
+}
+
+TEST_F(CachingReaderDiskCacheTest, TooLargeForLimit) {
+    CachingReaderDiskCache cache(m_cacheDir.path(), 0);
+    auto pDecoder = openDecoder();
+    ASSERT_TRUE(pDecoder);
+    mixxx::SampleBuffer tempBuffer(
+            pDecoder->frames2samples(CachingReaderChunk::kFrames));
+    cache.startWriting(m_pTrack, pDecoder, pDecoder->frameIndexRange());
+    EXPECT_FALSE(cache.writeNextSampleFrames(
+            mixxx::SampleBuffer::WritableSlice(tempBuffer)));
+}
+
+} // anonymous namespace
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "engine/cachingreaderpreload.h"
+
+namespace {
+
+const int kMaxMiBs = 16;
+const QString kLocation = "/music/oneshot.wav";
+
+// An empty range is complete right away
+const mixxx::IndexRange kFrameIndexRange = mixxx::IndexRange::forward(0, 0);
+
+TEST(CachingReaderPreloadTest, SharedBetweenPlayers) {
+    bool fill = false;
+    CachingReaderPreload* pFirst = CachingReaderPreload::acquire(
+            kLocation, kFrameIndexRange, kMaxMiBs, nullptr, &fill);
+    ASSERT_TRUE(pFirst);
+    EXPECT_TRUE(fill);
+    EXPECT_EQ(CachingReaderPreload::State::Filling, pFirst->state());
+
+    CachingReaderPreload* pSecond = CachingReaderPreload::acquire(
+            kLocation, kFrameIndexRange, kMaxMiBs, nullptr, &fill);
+    EXPECT_EQ(pFirst, pSecond);
+    EXPECT_FALSE(fill);
+
+    pFirst->finish();
+    EXPECT_EQ(CachingReaderPreload::State::Complete, pSecond->state());
+
+    // Another range of the same file is not shared
+    CachingReaderPreload* pOther = CachingReaderPreload::acquire(
+            kLocation, mixxx::IndexRange::forward(1, 0), kMaxMiBs, nullptr, &fill);
+    EXPECT_NE(pFirst, pOther);
+    EXPECT_TRUE(fill);
+    CachingReaderPreload::release(pOther, nullptr);
+
+    CachingReaderPreload::release(pFirst, nullptr);
+    CachingReaderPreload::release(pSecond, nullptr);
+
+    // The last reference is gone, the next player starts over
+    CachingReaderPreload* pNew = CachingReaderPreload::acquire(
+            kLocation, kFrameIndexRange, kMaxMiBs, nullptr, &fill);
+    EXPECT_TRUE(fill);
+    CachingReaderPreload::release(pNew, nullptr);
+}
+
+TEST(CachingReaderPreloadTest, AbandonedIsNotShared) {
+    bool fill = false;
+    CachingReaderPreload* pFirst = CachingReaderPreload::acquire(
+            kLocation, kFrameIndexRange, kMaxMiBs, nullptr, &fill);
+    CachingReaderPreload* pWaiting = CachingReaderPreload::acquire(
+            kLocation, kFrameIndexRange, kMaxMiBs, nullptr, &fill);
+    pFirst->abandon();
+    EXPECT_EQ(CachingReaderPreload::State::Abandoned, pWaiting->state());
+
+    CachingReaderPreload* pNew = CachingReaderPreload::acquire(
+            kLocation, kFrameIndexRange, kMaxMiBs, nullptr, &fill);
+    EXPECT_NE(pFirst, pNew);
+    EXPECT_TRUE(fill);
+
+    CachingReaderPreload::release(pNew, nullptr);
+    CachingReaderPreload::release(pWaiting, nullptr);
+    CachingReaderPreload::release(pFirst, nullptr);
+}
+
+}  // namespace
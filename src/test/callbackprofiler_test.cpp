@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <QVector>
+
+#include "engine/callbackprofiler.h"
+#include "util/duration.h"
+
+namespace {
+
+const qint64 kSleepNanos = 2000000;
+
+void sleepMillis(int millis) {
+    QThread::usleep(millis * 1000);
+}
+
+int histogramTotal(const CallbackProfiler& profiler, int stage) {
+    int total = 0;
+    for (int bucket = 0; bucket < CallbackProfiler::kHistogramBuckets; ++bucket) {
+        total += profiler.histogramCount(stage, bucket);
+    }
+    return total;
+}
+
+TEST(CallbackProfilerTest, DisabledIsNeverActive) {
+    CallbackProfiler profiler(false);
+    profiler.startCallback();
+    EXPECT_FALSE(profiler.isActive());
+    {
+        ScopedCallbackStage stage(&profiler, CallbackProfiler::CHANNELS);
+    }
+    profiler.finishCallback(mixxx::Duration::fromNanos(0));
+    EXPECT_EQ(0, histogramTotal(profiler, CallbackProfiler::NUM_STAGES));
+    EXPECT_EQ(0, profiler.deadlineMissCount());
+}
+
+TEST(CallbackProfilerTest, NestedStagesAreExclusive) {
+    CallbackProfiler profiler(true);
+    profiler.registerChannel(0, "[Channel1]");
+
+    profiler.startCallback();
+    EXPECT_TRUE(profiler.isActive());
+    {
+        ScopedCallbackStage channels(&profiler, CallbackProfiler::CHANNELS);
+        sleepMillis(2);
+        {
+            ScopedCallbackStage effects(&profiler, CallbackProfiler::EFFECTS);
+            sleepMillis(2);
+        }
+        profiler.setSlowestChannel(0, kSleepNanos);
+    }
+    profiler.finishCallback(mixxx::Duration::fromMillis(1));
+    EXPECT_FALSE(profiler.isActive());
+
+    ASSERT_EQ(1, profiler.deadlineMissCount());
+    QVector<CallbackProfiler::DeadlineMiss> misses;
+    profiler.getDeadlineMisses(&misses);
+    ASSERT_EQ(1, misses.size());
+    const CallbackProfiler::DeadlineMiss& miss = misses[0];
+
+    qint64 sumNanos = 0;
+    for (int stage = 0; stage < CallbackProfiler::NUM_STAGES; ++stage) {
+        sumNanos += miss.stageNanos[stage];
+    }
+    EXPECT_EQ(miss.totalNanos, sumNanos);
+    EXPECT_LE(kSleepNanos, miss.stageNanos[CallbackProfiler::CHANNELS]);
+    EXPECT_LE(kSleepNanos, miss.stageNanos[CallbackProfiler::EFFECTS]);
+    EXPECT_EQ(1000000, miss.budgetNanos);
+    EXPECT_EQ(QString("[Channel1]"), profiler.channelGroup(miss.slowestChannel));
+
+    for (int stage = 0; stage <= CallbackProfiler::NUM_STAGES; ++stage) {
+        EXPECT_EQ(1, histogramTotal(profiler, stage));
+    }
+}
+
+TEST(CallbackProfilerTest, KeepsLastDeadlineMisses) {
+    CallbackProfiler profiler(true);
+    const int kCallbacks = CallbackProfiler::kDeadlineMissCount + 3;
+    for (int i = 0; i < kCallbacks; ++i) {
+        profiler.startCallback();
+        // Increasing budgets that are all missed
+        profiler.finishCallback(mixxx::Duration::fromNanos(-kCallbacks + i));
+    }
+    // Within the budget
+    profiler.startCallback();
+    profiler.finishCallback(mixxx::Duration::fromSeconds(1));
+
+    EXPECT_EQ(kCallbacks, profiler.deadlineMissCount());
+    QVector<CallbackProfiler::DeadlineMiss> misses;
+    profiler.getDeadlineMisses(&misses);
+    ASSERT_EQ(CallbackProfiler::kDeadlineMissCount, misses.size());
+    for (int i = 0; i < misses.size(); ++i) {
+        EXPECT_EQ(-1 - i, misses[i].budgetNanos);
+    }
+}
+
+}  // namespace
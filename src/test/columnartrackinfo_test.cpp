@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDateTime>
+
+#include "library/columnartrackinfo.h"
+
+namespace {
+
+TEST(ColumnarTrackInfoTest, typedColumns) {
+    ColumnarTrackInfo info(3);
+    const int row1 = info.insert(TrackId(1));
+    const int row2 = info.insert(TrackId(2));
+    EXPECT_EQ(row1, info.row(TrackId(1)));
+    EXPECT_EQ(-1, info.row(TrackId(3)));
+    EXPECT_EQ(2, info.size());
+
+    info.setValue(row1, 0, QVariant(qlonglong(42)));
+    info.setValue(row1, 1, QVariant(128.5));
+    info.setValue(row1, 2, QVariant(QString("Artist")));
+    info.setValue(row2, 0, QVariant(QVariant::String));
+    info.setValue(row2, 2, QVariant(QString("Artist")));
+
+    EXPECT_EQ(QVariant(qlonglong(42)), info.value(row1, 0));
+    EXPECT_EQ(QVariant(128.5), info.value(row1, 1));
+    EXPECT_EQ(QVariant(QString("Artist")), info.value(row1, 2));
+    EXPECT_TRUE(info.value(row2, 0).isNull());
+    EXPECT_TRUE(info.value(row2, 1).isNull());
+    EXPECT_EQ(42.0, info.toDouble(row1, 0));
+    EXPECT_EQ(0.0, info.toDouble(row2, 1));
+    EXPECT_EQ(QString("Artist"), info.toString(row2, 2));
+    EXPECT_FALSE(info.value(row1, 3).isValid());
+}
+
+TEST(ColumnarTrackInfoTest, mixedTypes) {
+    ColumnarTrackInfo info(1);
+    const int row1 = info.insert(TrackId(1));
+    const int row2 = info.insert(TrackId(2));
+    const int row3 = info.insert(TrackId(3));
+
+    // Integers and doubles are stored as doubles
+    info.setValue(row1, 0, QVariant(qlonglong(180)));
+    info.setValue(row2, 0, QVariant(180.5));
+    EXPECT_DOUBLE_EQ(180.0, info.value(row1, 0).toDouble());
+    EXPECT_DOUBLE_EQ(180.5, info.value(row2, 0).toDouble());
+
+    // All others are kept as they are
+    info.setValue(row3, 0, QVariant(QString("text")));
+    EXPECT_DOUBLE_EQ(180.0, info.value(row1, 0).toDouble());
+    EXPECT_DOUBLE_EQ(180.5, info.value(row2, 0).toDouble());
+    EXPECT_EQ(QVariant(QString("text")), info.value(row3, 0));
+}
+
+TEST(ColumnarTrackInfoTest, reusesRemovedRows) {
+    ColumnarTrackInfo info(1);
+    const int row1 = info.insert(TrackId(1));
+    info.setValue(row1, 0, QVariant(1));
+    info.insert(TrackId(2));
+    info.remove(TrackId(1));
+    EXPECT_FALSE(info.contains(TrackId(1)));
+    EXPECT_EQ(1, info.size());
+
+    const int row3 = info.insert(TrackId(3));
+    EXPECT_EQ(row1, row3);
+    EXPECT_TRUE(info.value(row3, 0).isNull());
+}
+
+TEST(ColumnarTrackInfoTest, writeAndRead) {
+    ColumnarTrackInfo info(3);
+    const int row1 = info.insert(TrackId(1));
+    const int row2 = info.insert(TrackId(2));
+    info.insert(TrackId(3));
+    info.setValue(row1, 0, QVariant(qlonglong(42)));
+    info.setValue(row1, 1, QVariant(QString("Artist")));
+    info.setValue(row2, 1, QVariant(QString("Artist")));
+    info.setValue(row2, 2, QVariant(QDateTime(QDate(2017, 1, 2))));
+    info.remove(TrackId(3));
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadWrite);
+    QDataStream stream(&buffer);
+    info.write(&stream);
+
+    buffer.seek(0);
+    ColumnarTrackInfo readInfo(3);
+    ASSERT_TRUE(readInfo.read(&stream));
+    EXPECT_EQ(2, readInfo.size());
+    EXPECT_EQ(row2, readInfo.row(TrackId(2)));
+    EXPECT_EQ(QVariant(qlonglong(42)), readInfo.value(row1, 0));
+    EXPECT_TRUE(readInfo.value(row2, 0).isNull());
+    EXPECT_EQ(QString("Artist"), readInfo.toString(row2, 1));
+    EXPECT_EQ(QVariant(QDateTime(QDate(2017, 1, 2))), readInfo.value(row2, 2));
+    // The row of the removed track is reused
+    EXPECT_EQ(2, readInfo.insert(TrackId(4)));
+
+    // Another number of columns
+    buffer.seek(0);
+    ColumnarTrackInfo otherInfo(2);
+    EXPECT_FALSE(otherInfo.read(&stream));
+    EXPECT_EQ(0, otherInfo.size());
+}
+
+} // anonymous namespace
@@ -139,4 +139,18 @@ TEST_F(ConfigObjectTest, Save) {
     }
 }
 
+TEST_F(ConfigObjectTest, RequestSave) {
+    const QString filename = getTestDataDir().filePath("requestsave.cfg");
+    auto ck = ConfigKey("[Test]", "requested");
+    {
+        UserSettings settings(filename);
+        settings.setValue(ck, 7);
+        // The request is still pending when the settings are deleted, which
+        // writes it before the values are gone
+        settings.requestSave();
+    }
+    UserSettings settings(filename);
+    EXPECT_EQ(7, settings.getValue<int>(ck, -1));
+}
+
 }  // namespace
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include "control/controlinputtime.h"
+#include "util/time.h"
+
+namespace {
+
+const SINT kBufferFrames = 256;
+
+class ControlInputTimeTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        // Callbacks started 4 and 2 ms ago
+        m_nowNanos = 100000000;
+        mixxx::Time::setTestMode(true);
+        mixxx::Time::setTestElapsedTime(mixxx::Duration::fromNanos(m_nowNanos));
+        m_previousNanos = m_nowNanos - 4000000;
+        m_currentNanos = m_nowNanos - 2000000;
+        ControlInputTime::engineCallbackStarted(
+                mixxx::Duration::fromNanos(m_previousNanos));
+        ControlInputTime::engineCallbackStarted(
+                mixxx::Duration::fromNanos(m_currentNanos));
+    }
+
+    void TearDown() override {
+        mixxx::Time::setTestMode(false);
+    }
+
+    qint64 m_nowNanos;
+    qint64 m_previousNanos;
+    qint64 m_currentNanos;
+};
+
+TEST_F(ControlInputTimeTest, NoScope) {
+    EXPECT_EQ(0, ControlInputTime::currentNanos());
+    EXPECT_EQ(0, ControlInputTime::frameOffsetInCallback(
+            ControlInputTime::currentNanos(), kBufferFrames));
+}
+
+TEST_F(ControlInputTimeTest, InputDuringPreviousPeriod) {
+    const qint64 inputNanos = m_previousNanos + 500000;
+    {
+        ControlInputTime::Scope scope(mixxx::Duration::fromNanos(inputNanos));
+        EXPECT_EQ(inputNanos, ControlInputTime::currentNanos());
+        // A quarter into the period
+        EXPECT_EQ(kBufferFrames / 4, ControlInputTime::frameOffsetInCallback(
+                ControlInputTime::currentNanos(), kBufferFrames));
+    }
+    EXPECT_EQ(0, ControlInputTime::currentNanos());
+}
+
+TEST_F(ControlInputTimeTest, InputOutsidePreviousPeriod) {
+    // Since the start of the current callback
+    EXPECT_EQ(0, ControlInputTime::frameOffsetInCallback(
+            m_currentNanos + 1000, kBufferFrames));
+    // Before the previous callback
+    EXPECT_EQ(0, ControlInputTime::frameOffsetInCallback(
+            m_previousNanos - 1000, kBufferFrames));
+}
+
+TEST_F(ControlInputTimeTest, TimestampOfOtherClock) {
+    // Timestamps in the future are replaced by the time of the scope
+    ControlInputTime::Scope scope(
+            mixxx::Duration::fromNanos(m_nowNanos + 1000000000));
+    EXPECT_EQ(m_nowNanos, ControlInputTime::currentNanos());
+}
+
+}  // namespace
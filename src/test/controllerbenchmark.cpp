@@ -0,0 +1,388 @@
+// Benchmarks of the controller mappings in res/controllers. Run them with
+//   mixxx-test --benchmark --benchmark_filter=Controller
+// or with "scons benchmark" like the other benchmarks, and add the name of
+// a preset to the filter to benchmark a single mapping.
+//
+// Each MIDI preset is loaded with its scripts into a controller that sends
+// its output nowhere, next to decks with all their controls. The input is
+// replayed from streams that are generated from the input mappings of the
+// preset: jog wheel sweeps, pad drumming and fader moves. The engine side
+// of the mapping is measured by changing the controls that mappings
+// typically connect to, which runs the connection callbacks and the output
+// mappings. The benchmarks report the messages or control changes as
+// items, and the label shows the percentiles of the time of each one and
+// the output that it caused.
+
+#include <benchmark/benchmark.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QRegExp>
+#include <QStringList>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "controllers/controllerpresetfilehandler.h"
+#include "controllers/defs_controllers.h"
+#include "controllers/midi/midicontroller.h"
+#include "controllers/midi/midicontrollerpreset.h"
+#include "controllers/midi/midiutils.h"
+#include "test/signalpathtest.h"
+#include "util/performancetimer.h"
+#include "util/time.h"
+
+namespace {
+
+// The number of messages of each input stream
+const int kStreamLength = 1024;
+
+enum Stream {
+    JOG_WHEEL = 0,
+    PADS,
+    FADERS,
+    NUM_STREAMS
+};
+
+const char* kStreamNames[NUM_STREAMS] = {
+    "jog wheel",
+    "pads",
+    "faders",
+};
+
+// Matched against the group, control and description of the input
+// mappings to find the mappings of each stream
+const char* kStreamPatterns[NUM_STREAMS] = {
+    "jog|wheel|scratch|platter",
+    "hotcue|pad|sampler|beatloop|roll",
+    "volume|fader|rate|pitch|tempo|filter|eq|gain|knob|parameter",
+};
+
+// The controls of each deck that mappings connect to for their feedback,
+// changed by BM_ControllerConnections
+const char* kDeckFeedbackControls[] = {
+    "VuMeter",
+    "playposition",
+    "beat_active",
+    "play_indicator",
+    "cue_indicator",
+    "hotcue_1_enabled",
+    "loop_enabled",
+};
+
+QString presetDirectory() {
+    return QDir::currentPath() + "/res/controllers";
+}
+
+// The MIDI presets in res/controllers, sorted by name
+const QStringList& midiPresetFiles() {
+    static QStringList s_files = QDir(presetDirectory()).entryList(
+            QStringList() << "*" MIDI_PRESET_EXTENSION, QDir::Files, QDir::Name);
+    return s_files;
+}
+
+struct MidiMessage {
+    unsigned char status;
+    unsigned char control;
+    unsigned char value;
+};
+
+// A MIDI controller that counts its output instead of sending it
+class BenchmarkMidiController : public MidiController {
+  public:
+    BenchmarkMidiController()
+            : m_outputMessages(0),
+              m_outputBytes(0) {
+        setDeviceName("Benchmark Controller");
+        setOutputDevice(true);
+        setInputDevice(true);
+    }
+    ~BenchmarkMidiController() override {
+        if (getEngine() != nullptr) {
+            stopEngine();
+        }
+    }
+
+    // Loads the preset and its scripts and initializes them, returns false
+    // if the scripts fail to load
+    bool loadPreset(const ControllerPreset& preset) {
+        setPreset(preset);
+        startEngine();
+        bool result = false;
+        // applyPreset() is only accessible to the ControllerManager
+        QMetaObject::invokeMethod(this, "applyPreset", Qt::DirectConnection,
+                Q_RETURN_ARG(bool, result),
+                Q_ARG(QList<QString>, QList<QString>() << presetDirectory()),
+                Q_ARG(bool, true));
+        return result;
+    }
+
+    const MidiControllerPreset& midiPreset() const {
+        return m_midiPreset;
+    }
+
+    void receive(const MidiMessage& message) {
+        MidiController::receive(message.status, message.control,
+                message.value, mixxx::Time::elapsed());
+    }
+
+    void visit(const MidiControllerPreset* preset) override {
+        m_midiPreset = *preset;
+        MidiController::visit(preset);
+    }
+
+    void resetOutput() {
+        m_outputMessages = 0;
+        m_outputBytes = 0;
+    }
+    qint64 outputMessages() const {
+        return m_outputMessages;
+    }
+    qint64 outputBytes() const {
+        return m_outputBytes;
+    }
+
+  protected:
+    void sendShortMsgNow(unsigned char status, unsigned char byte1,
+                         unsigned char byte2) override {
+        Q_UNUSED(status);
+        Q_UNUSED(byte1);
+        Q_UNUSED(byte2);
+        ++m_outputMessages;
+        m_outputBytes += 3;
+    }
+
+  private:
+    int open() override {
+        return 0;
+    }
+    int close() override {
+        return 0;
+    }
+    void send(QByteArray data) override {
+        ++m_outputMessages;
+        m_outputBytes += data.size();
+    }
+    bool isPolling() const override {
+        return false;
+    }
+
+    MidiControllerPreset m_midiPreset;
+    qint64 m_outputMessages;
+    qint64 m_outputBytes;
+};
+
+// Replays the stream from the input mappings of the preset that match its
+// pattern, an empty stream if there are none
+std::vector<MidiMessage> inputStream(const MidiControllerPreset& preset,
+        Stream stream) {
+    const QRegExp pattern(kStreamPatterns[stream], Qt::CaseInsensitive);
+    std::vector<MidiMessage> keys;
+    for (const auto& mapping : preset.inputMappings) {
+        const QString name = mapping.control.group + ' ' +
+                mapping.control.item + ' ' + mapping.description;
+        // The faders do not include the jog wheels, e.g. "jog_pitch"
+        if (pattern.indexIn(name) == -1 || (stream == FADERS &&
+                QRegExp(kStreamPatterns[JOG_WHEEL],
+                        Qt::CaseInsensitive).indexIn(name) != -1)) {
+            continue;
+        }
+        const unsigned char opCode = MidiUtils::opCodeFromStatus(
+                mapping.key.status);
+        const bool isNote = opCode == MIDI_NOTE_ON;
+        const bool isControl = opCode == MIDI_CC || opCode == MIDI_PITCH_BEND;
+        if ((stream == PADS && !isNote) || (stream != PADS && !isControl)) {
+            continue;
+        }
+        MidiMessage key = {mapping.key.status, mapping.key.control, 0};
+        keys.push_back(key);
+    }
+
+    std::vector<MidiMessage> messages;
+    if (keys.empty()) {
+        return messages;
+    }
+    messages.reserve(kStreamLength);
+    for (int i = 0; i < kStreamLength; ++i) {
+        MidiMessage message = keys[(i / 2) % keys.size()];
+        switch (stream) {
+        case JOG_WHEEL:
+            // Relative ticks forward and back, as most jog wheels send them
+            message.value = (i / 64) % 2 == 0 ? 0x41 : 0x3F;
+            break;
+        case PADS:
+            // Pressed and released, released with a velocity of 0
+            message.value = i % 2 == 0 ? 0x7F : 0x00;
+            break;
+        default:
+            // Moved up and down through the full range
+            message.value = static_cast<unsigned char>(
+                    std::abs(127 - (i % 254)));
+            break;
+        }
+        messages.push_back(message);
+    }
+    return messages;
+}
+
+QString timeLabel(std::vector<double>* pMicros) {
+    if (pMicros->empty()) {
+        return QString();
+    }
+    std::sort(pMicros->begin(), pMicros->end());
+    QStringList percentiles;
+    for (int percentile : {50, 90, 99}) {
+        const size_t index = std::min(pMicros->size() - 1,
+                pMicros->size() * percentile / 100);
+        percentiles << QString("p%1 %2 us").arg(
+                QString::number(percentile),
+                QString::number((*pMicros)[index], 'f', 1));
+    }
+    return percentiles.join(" ");
+}
+
+QString outputLabel(const BenchmarkMidiController& controller, qint64 items) {
+    if (items <= 0) {
+        return QString();
+    }
+    return QString("out %1 msg %2 B per item").arg(
+            QString::number(double(controller.outputMessages()) / items, 'f', 2),
+            QString::number(double(controller.outputBytes()) / items, 'f', 1));
+}
+
+// Decks with all their controls and a controller with the preset of the
+// benchmark
+class ControllerBenchmarkEnvironment : public BaseSignalPathTest {
+  public:
+    explicit ControllerBenchmarkEnvironment(const QString& presetFile)
+            : m_loaded(false) {
+        const QString presetPath = presetDirectory() + "/" + presetFile;
+        ControllerPresetPointer pPreset = ControllerPresetFileHandler::loadPreset(
+                presetPath, QStringList() << presetDirectory());
+        if (pPreset) {
+            m_loaded = m_controller.loadPreset(*pPreset);
+        }
+        // The output of the init functions of the scripts is not measured
+        QCoreApplication::processEvents();
+        m_controller.resetOutput();
+    }
+
+    bool isLoaded() const {
+        return m_loaded;
+    }
+
+    BenchmarkMidiController* controller() {
+        return &m_controller;
+    }
+
+  private:
+    void TestBody() override {}
+
+    bool m_loaded;
+    BenchmarkMidiController m_controller;
+};
+
+QString presetName(const QString& presetFile) {
+    return presetFile.left(presetFile.size() - int(strlen(MIDI_PRESET_EXTENSION)));
+}
+
+static void MidiPresetArguments(benchmark::internal::Benchmark* b) {
+    for (int preset = 0; preset < midiPresetFiles().size(); ++preset) {
+        for (int stream = 0; stream < NUM_STREAMS; ++stream) {
+            b->ArgPair(preset, stream);
+        }
+    }
+}
+
+static void MidiPresetOnlyArguments(benchmark::internal::Benchmark* b) {
+    for (int preset = 0; preset < midiPresetFiles().size(); ++preset) {
+        b->Arg(preset);
+    }
+}
+
+// The script dispatch and the mappings of each input message of a stream
+static void BM_ControllerInput(benchmark::State& state) {
+    const QString presetFile = midiPresetFiles().at(state.range_x());
+    const Stream stream = static_cast<Stream>(state.range_y());
+    ControllerBenchmarkEnvironment environment(presetFile);
+    BenchmarkMidiController* pController = environment.controller();
+    const std::vector<MidiMessage> messages =
+            inputStream(pController->midiPreset(), stream);
+    const QString name = QString("%1 %2").arg(
+            presetName(presetFile), kStreamNames[stream]);
+    if (!environment.isLoaded() || messages.empty()) {
+        while (state.KeepRunning()) {
+        }
+        state.SetLabel(QString("%1 %2").arg(name, environment.isLoaded()
+                ? "has no mappings" : "failed to load").toStdString());
+        return;
+    }
+
+    std::vector<double> messageMicros;
+    PerformanceTimer timer;
+    while (state.KeepRunning()) {
+        for (const auto& message : messages) {
+            timer.start();
+            pController->receive(message);
+            messageMicros.push_back(timer.elapsed().toDoubleMicros());
+        }
+        // Timers of the scripts and queued output
+        QCoreApplication::processEvents();
+    }
+    const qint64 items = state.iterations() * messages.size();
+    state.SetItemsProcessed(items);
+    state.SetLabel(QString("%1 %2 %3").arg(name, timeLabel(&messageMicros),
+            outputLabel(*pController, items)).toStdString());
+}
+BENCHMARK(BM_ControllerInput)->Apply(MidiPresetArguments)->UseRealTime();
+
+// The connection callbacks and output mappings that run when the feedback
+// controls of the decks change
+static void BM_ControllerConnections(benchmark::State& state) {
+    const QString presetFile = midiPresetFiles().at(state.range_x());
+    ControllerBenchmarkEnvironment environment(presetFile);
+    BenchmarkMidiController* pController = environment.controller();
+    if (!environment.isLoaded()) {
+        while (state.KeepRunning()) {
+        }
+        state.SetLabel(QString("%1 failed to load").arg(
+                presetName(presetFile)).toStdString());
+        return;
+    }
+
+    std::vector<ControlObject*> controls;
+    for (const char* group : {"[Channel1]", "[Channel2]", "[Channel3]"}) {
+        for (const char* item : kDeckFeedbackControls) {
+            ControlObject* pControl = ControlObject::getControl(
+                    ConfigKey(group, item), false);
+            if (pControl != nullptr) {
+                controls.push_back(pControl);
+            }
+        }
+    }
+
+    std::vector<double> changeMicros;
+    PerformanceTimer timer;
+    int iteration = 0;
+    while (state.KeepRunning()) {
+        // Alternates the binary controls and moves the others
+        const double value = (iteration++ % 2) == 0 ? 1.0 : 0.5;
+        for (ControlObject* pControl : controls) {
+            timer.start();
+            pControl->set(value);
+            QCoreApplication::processEvents();
+            changeMicros.push_back(timer.elapsed().toDoubleMicros());
+        }
+    }
+    const qint64 items = state.iterations() * controls.size();
+    state.SetItemsProcessed(items);
+    state.SetLabel(QString("%1 %2 %3").arg(presetName(presetFile),
+            timeLabel(&changeMicros),
+            outputLabel(*pController, items)).toStdString());
+}
+BENCHMARK(BM_ControllerConnections)->Apply(MidiPresetOnlyArguments)->UseRealTime();
+
+} // anonymous namespace
@@ -43,6 +43,23 @@ TEST_F(ControllerEngineTest, commonScriptHasNoErrors) {
     EXPECT_FALSE(cEngine->hasErrors(commonScript));
 }
 
+TEST_F(ControllerEngineTest, wrapFunctionCodes) {
+    auto co = std::make_unique<ControlObject>(ConfigKey("[Test]", "co"));
+    cEngine->wrapFunctionCodes(QStringList()
+            << "function() { engine.setValue('[Test]', 'co', 1.0); }"
+            << "function() { engine.setValue('[Test]', 'co', 2.0); }", 0);
+    EXPECT_EQ(2, cEngine->m_scriptWrappedFunctionCache.size());
+    EXPECT_TRUE(execute("function() { engine.setValue('[Test]', 'co', 2.0); }"));
+    EXPECT_DOUBLE_EQ(2.0, co->get());
+
+    // A syntax error in one snippet does not fail the others
+    cEngine->wrapFunctionCodes(QStringList()
+            << "function() { engine.setValue('[Test]', 'co', 3.0); }"
+            << "function() {", 0);
+    EXPECT_TRUE(execute("function() { engine.setValue('[Test]', 'co', 3.0); }"));
+    EXPECT_DOUBLE_EQ(3.0, co->get());
+}
+
 TEST_F(ControllerEngineTest, setValue) {
     auto co = std::make_unique<ControlObject>(ConfigKey("[Test]", "co"));
     EXPECT_TRUE(execute("function() { engine.setValue('[Test]', 'co', 1.0); }"));
@@ -588,3 +605,35 @@ TEST_F(ControllerEngineTest, connectionExecutesWithCorrectThisObject) {
     // The counter should have been incremented exactly once.
     EXPECT_DOUBLE_EQ(1.0, pass->get());
 }
+
+TEST_F(ControllerEngineTest, connectionsAreDispatchedInBatches) {
+    // Test that the connections of all controls that changed before the
+    // controller thread got to them are called once with the latest value,
+    // and that an exception of one callback does not stop the others.
+    auto co1 = std::make_unique<ControlObject>(ConfigKey("[Test]", "co1"));
+    auto co2 = std::make_unique<ControlObject>(ConfigKey("[Test]", "co2"));
+    auto counter = std::make_unique<ControlObject>(ConfigKey("[Test]", "counter"));
+    auto pass = std::make_unique<ControlObject>(ConfigKey("[Test]", "passed"));
+
+    ScopedTemporaryFile script(makeTemporaryFile(
+        "engine.makeConnection('[Test]', 'co1', function (value, group, item) {"
+        "  var counter = engine.getValue('[Test]', 'counter');"
+        "  engine.setValue('[Test]', 'counter', counter + 1);"
+        "  throw item;"
+        "});"
+        "engine.makeConnection('[Test]', 'co2', function (value, group, item) {"
+        "  if (group === '[Test]' && item === 'co2') {"
+        "    engine.setValue('[Test]', 'passed', value);"
+        "  }"
+        "});"));
+
+    cEngine->evaluate(script->fileName());
+    EXPECT_FALSE(cEngine->hasErrors(script->fileName()));
+    co1->set(1.0);
+    co1->set(2.0);
+    co2->set(3.0);
+    co2->set(4.0);
+    application()->processEvents();
+    EXPECT_DOUBLE_EQ(1.0, counter->get());
+    EXPECT_DOUBLE_EQ(4.0, pass->get());
+}
@@ -0,0 +1,54 @@
+#include "test/mixxxtest.h"
+
+#include "controllers/controllerdebug.h"
+#include "controllers/controllerlatency.h"
+#include "util/time.h"
+
+namespace {
+
+class ControllerLatencyTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        ControllerDebug::enable();
+        mixxx::Time::setTestMode(true);
+    }
+
+    void TearDown() override {
+        mixxx::Time::setTestMode(false);
+    }
+
+    static void setElapsedMillis(double millis) {
+        mixxx::Time::setTestElapsedTime(mixxx::Duration::fromSeconds(millis / 1000));
+    }
+
+    ControllerLatency m_latency;
+};
+
+TEST_F(ControllerLatencyTest, percentiles) {
+    // 9 messages with a driver latency of 1 ms and one with 10 ms
+    for (int i = 0; i < 10; ++i) {
+        const double receivedMillis = 1000.0 + i * 100;
+        setElapsedMillis(receivedMillis + (i == 9 ? 10.0 : 1.0));
+        m_latency.inputReceived("Test",
+                mixxx::Duration::fromSeconds(receivedMillis / 1000));
+        m_latency.inputHandled();
+    }
+    const mixxx::Duration bucket = mixxx::Duration::fromNanos(
+            ControllerLatency::kHistogramBucketNanos);
+    EXPECT_GE(mixxx::Duration::fromMillis(1) + bucket,
+            m_latency.percentile(ControllerLatency::DRIVER, 0.5));
+    EXPECT_LT(mixxx::Duration::fromMillis(1),
+            m_latency.percentile(ControllerLatency::DRIVER, 0.9));
+    EXPECT_LT(mixxx::Duration::fromMillis(10),
+            m_latency.percentile(ControllerLatency::DRIVER, 0.99));
+
+    // The output is measured from the oldest input that has not been
+    // answered yet. Longer latencies than the histogram are counted by its
+    // last bucket.
+    setElapsedMillis(2000.0);
+    m_latency.outputSent();
+    EXPECT_EQ(bucket * ControllerLatency::kHistogramBuckets,
+            m_latency.percentile(ControllerLatency::OUTPUT, 0.5));
+}
+
+} // anonymous namespace
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+
+#include "controllers/controlleroutputwriter.h"
+
+namespace {
+
+// Blocks in the first write until it is released, like a slow device
+class FakeOutputWriter : public ControllerOutputWriter {
+  public:
+    ~FakeOutputWriter() override {
+        stop();
+    }
+
+    QList<QByteArray> reports() {
+        QMutexLocker locker(&m_mutex);
+        return m_reports;
+    }
+
+    QSemaphore m_firstWriteStarted;
+    QSemaphore m_releaseFirstWrite;
+
+  protected:
+    void write(const QByteArray& report) override {
+        bool first;
+        {
+            QMutexLocker locker(&m_mutex);
+            first = m_reports.isEmpty();
+            m_reports.append(report);
+        }
+        if (first) {
+            m_firstWriteStarted.release();
+            m_releaseFirstWrite.acquire();
+        }
+    }
+
+  private:
+    QMutex m_mutex;
+    QList<QByteArray> m_reports;
+};
+
+TEST(ControllerOutputWriterTest, mergesAndSkipsReports) {
+    FakeOutputWriter writer;
+    writer.start();
+    writer.enqueue(1, QByteArray("a1"));
+    writer.m_firstWriteStarted.acquire();
+
+    // Merged while the device is busy
+    writer.enqueue(1, QByteArray("b1"));
+    writer.enqueue(2, QByteArray("a2"));
+    writer.enqueue(1, QByteArray("c1"));
+    // Unchanged
+    writer.enqueue(2, QByteArray("a2"));
+    writer.m_releaseFirstWrite.release();
+    writer.stop();
+
+    EXPECT_EQ(QList<QByteArray>() << "a1" << "c1" << "a2", writer.reports());
+}
+
+} // anonymous namespace
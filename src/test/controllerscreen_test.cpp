@@ -0,0 +1,77 @@
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+
+#include "test/mixxxtest.h"
+
+#include "controllers/controlleroutputwriter.h"
+#include "controllers/controllerscreen.h"
+
+namespace {
+
+class RecordingOutputWriter : public ControllerOutputWriter {
+  public:
+    ~RecordingOutputWriter() override {
+        stop();
+    }
+
+    // Waits until the enqueued messages have been written
+    QList<QByteArray> takeMessages() {
+        stop();
+        QMutexLocker locker(&m_mutex);
+        QList<QByteArray> messages;
+        messages.swap(m_messages);
+        return messages;
+    }
+
+  protected:
+    void write(const QByteArray& message) override {
+        QMutexLocker locker(&m_mutex);
+        m_messages.append(message);
+    }
+
+  private:
+    QMutex m_mutex;
+    QList<QByteArray> m_messages;
+};
+
+class ControllerScreenTest : public MixxxTest {
+  protected:
+    static ControllerScreenRenderer::Frame makeFrame(const QRect& rect,
+                                                     const QColor& color) {
+        ControllerScreenRenderer::Frame frame;
+        frame.header = QByteArray("\x84", 1);
+        frame.tileSize = QSize(32, 32);
+        {
+            QPainter painter(&frame.picture);
+            painter.fillRect(rect, color);
+        }
+        return frame;
+    }
+};
+
+TEST_F(ControllerScreenTest, rendersChangedTiles) {
+    RecordingOutputWriter writer;
+    ControllerScreenRenderer renderer(&writer, 0x10000, 64, 48,
+            ControllerScreen::PixelFormat::RGB565_BE, 30);
+
+    // The tiles at the bottom are cut off
+    EXPECT_EQ(4, renderer.render(makeFrame(QRect(0, 0, 64, 48), Qt::white)));
+    EXPECT_EQ(0, renderer.render(makeFrame(QRect(0, 0, 64, 48), Qt::white)));
+    EXPECT_EQ(1, renderer.render(makeFrame(QRect(40, 40, 2, 2), Qt::red)));
+
+    writer.start();
+    const QList<QByteArray> messages = writer.takeMessages();
+    ASSERT_EQ(5, messages.size());
+    // Header, x, y, width, height
+    const QByteArray lastTile = messages.last();
+    EXPECT_EQ(QByteArray("\x84\x00\x20\x00\x20\x00\x20\x00\x10", 9),
+              lastTile.left(9));
+    ASSERT_EQ(9 + 32 * 16 * 2, lastTile.size());
+    // The pixel at (40, 40) is red, most significant byte first
+    const int offset = 9 + ((40 - 32) * 32 + (40 - 32)) * 2;
+    EXPECT_EQ(static_cast<char>(0xF8), lastTile.at(offset));
+    EXPECT_EQ(static_cast<char>(0x00), lastTile.at(offset + 1));
+}
+
+} // anonymous namespace
@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include <QtDebug>
 
+#include "control/controlcoalescer.h"
 #include "control/controlobject.h"
+#include "control/controlproxy.h"
 #include "util/memory.h"
 #include "test/mixxxtest.h"
 
@@ -49,6 +51,86 @@ TEST_F(ControlObjectTest, AliasRetrieval) {
     EXPECT_EQ(ControlObject::getControl(ckAlias), co.get());
 }
 
+TEST_F(ControlObjectTest, getControlByHandle) {
+    ControlHandle handle1 = ControlObject::getHandle(ck1);
+    ControlHandle handle2 = ControlObject::getHandle(ck2);
+    ASSERT_TRUE(handle1.valid());
+    ASSERT_TRUE(handle2.valid());
+    EXPECT_NE(handle1, handle2);
+    EXPECT_EQ(handle1, ControlObject::getHandle(ck1));
+    EXPECT_EQ(co1.get(), ControlObject::getControl(handle1));
+    EXPECT_EQ(co2.get(), ControlObject::getControl(handle2));
+
+    // The handle stays the same when the control is created again
+    co2.reset();
+    EXPECT_EQ((ControlObject*)nullptr, ControlObject::getControl(handle2));
+    co2 = std::make_unique<ControlObject>(ck2);
+    EXPECT_EQ(handle2, ControlObject::getHandle(ck2));
+    EXPECT_EQ(co2.get(), ControlObject::getControl(handle2));
+
+    EXPECT_FALSE(ControlObject::getHandle(ConfigKey()).valid());
+    EXPECT_EQ((ControlObject*)nullptr, ControlObject::getControl(ControlHandle()));
+}
+
+TEST_F(ControlObjectTest, HandleBeforeCreation) {
+    ConfigKey ck("[Test]", "handle_before_creation");
+    ControlHandle handle = ControlObject::getHandle(ck);
+    ASSERT_TRUE(handle.valid());
+    EXPECT_EQ((ControlObject*)nullptr, ControlObject::getControl(handle));
+    ControlObject co(ck);
+    EXPECT_EQ(&co, ControlObject::getControl(handle));
+}
+
+TEST_F(ControlObjectTest, AliasHandle) {
+    ConfigKey ck("[Microphone1]", "pregain");
+    ConfigKey ckAlias("[Microphone]", "pregain");
+    auto co = std::make_unique<ControlObject>(ck);
+    ControlDoublePrivate::insertAlias(ckAlias, ck);
+
+    ControlHandle aliasHandle = ControlObject::getHandle(ckAlias);
+    EXPECT_NE(ControlObject::getHandle(ck), aliasHandle);
+    EXPECT_EQ(co.get(), ControlObject::getControl(aliasHandle));
+    co.reset();
+    EXPECT_EQ((ControlObject*)nullptr, ControlObject::getControl(aliasHandle));
+}
+
+TEST_F(ControlObjectTest, ValueOfRecreatedControl) {
+    co2->set(2.0);
+    co2.reset();
+    // The new control of the key starts with its default value, not the
+    // value left by the deleted one
+    co2 = std::make_unique<ControlObject>(ck2, true, false, false, 5.0);
+    EXPECT_DOUBLE_EQ(5.0, co2->get());
+    co2->set(6.0);
+    EXPECT_DOUBLE_EQ(6.0, co2->get());
+    EXPECT_DOUBLE_EQ(0.0, co1->get());
+}
+
+TEST_F(ControlObjectTest, SharedGroupName) {
+    // Both controls are in [Channel1], their keys refer to the same string
+    EXPECT_EQ(co1->getKey().group.constData(), co2->getKey().group.constData());
+}
+
+TEST_F(ControlObjectTest, CoalescedConnection) {
+    ControlCoalescer coalescer;
+    ControlProxy source(ck1);
+    ControlProxy target(ck2);
+    ASSERT_TRUE(source.connectValueChangedCoalesced(&target, SLOT(set(double))));
+
+    co1->set(1.0);
+    co1->set(2.0);
+    co1->set(3.0);
+    EXPECT_DOUBLE_EQ(0.0, co2->get());
+
+    coalescer.flush();
+    EXPECT_DOUBLE_EQ(3.0, co2->get());
+
+    // Nothing is delivered if the control has not changed since
+    co2->set(0.0);
+    coalescer.flush();
+    EXPECT_DOUBLE_EQ(0.0, co2->get());
+}
+
 TEST_F(ControlObjectTest, Persistence_NotPresent) {
     ConfigKey ck("[Test]", "persist");
     ASSERT_FALSE(m_pConfig->exists(ck));
@@ -0,0 +1,62 @@
+#include <QDir>
+#include <QTemporaryDir>
+
+#include "test/mixxxtest.h"
+
+#include "library/coverthumbnailcache.h"
+
+namespace {
+
+class CoverThumbnailCacheTest : public MixxxTest {
+  protected:
+    static CoverInfo makeCoverInfo(const QString& coverLocation) {
+        CoverInfo info;
+        info.type = CoverInfo::FILE;
+        info.source = CoverInfo::GUESSED;
+        info.coverLocation = coverLocation;
+        info.trackLocation = "/music/album/track.mp3";
+        info.hash = 1234;
+        return info;
+    }
+
+    static QImage makeImage(int width) {
+        // With an alpha channel the entry is stored losslessly
+        QImage image(width, width, QImage::Format_ARGB32);
+        image.fill(QColor(10, 20, 30, 40));
+        return image;
+    }
+
+    QTemporaryDir m_cacheDir;
+};
+
+TEST_F(CoverThumbnailCacheTest, saveAndLoad) {
+    ASSERT_TRUE(m_cacheDir.isValid());
+    CoverThumbnailCache cache(m_cacheDir.path(), 1);
+    const CoverInfo info = makeCoverInfo("cover.png");
+    EXPECT_TRUE(cache.load(info, 64).isNull());
+
+    cache.save(info, 64, makeImage(64));
+    const QImage image = cache.load(info, 64);
+    ASSERT_FALSE(image.isNull());
+    EXPECT_EQ(makeImage(64).convertToFormat(image.format()), image);
+
+    // Other widths and covers with the same hash have their own entries
+    EXPECT_TRUE(cache.load(info, 128).isNull());
+    EXPECT_TRUE(cache.load(makeCoverInfo("folder.png"), 64).isNull());
+    // The tracks of a folder share the entries of its cover file
+    CoverInfo otherTrackInfo = info;
+    otherTrackInfo.trackLocation = "/music/album/other.mp3";
+    EXPECT_FALSE(cache.load(otherTrackInfo, 64).isNull());
+}
+
+TEST_F(CoverThumbnailCacheTest, evictLeastRecentlyUsed) {
+    ASSERT_TRUE(m_cacheDir.isValid());
+    CoverThumbnailCache cache(m_cacheDir.path(), 0);
+    const CoverInfo info = makeCoverInfo("cover.png");
+    cache.save(info, 64, makeImage(64));
+    cache.evictLeastRecentlyUsed();
+    EXPECT_TRUE(cache.load(info, 64).isNull());
+    EXPECT_TRUE(QDir(m_cacheDir.path()).entryList(QDir::Files).isEmpty());
+}
+
+} // anonymous namespace
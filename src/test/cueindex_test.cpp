@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "test/mixxxtest.h"
+#include "track/cueindex.h"
+#include "track/track.h"
+
+namespace {
+
+class CueIndexTest : public MixxxTest {
+  protected:
+    CueIndexTest()
+            : m_pTrack(Track::newTemporary()) {
+    }
+
+    CuePointer addCue(double position, int hotCue = -1) {
+        CuePointer pCue = m_pTrack->createAndAddCue();
+        pCue->setType(Cue::CUE);
+        pCue->setPosition(position);
+        pCue->setHotCue(hotCue);
+        return pCue;
+    }
+
+    TrackPointer m_pTrack;
+};
+
+TEST_F(CueIndexTest, FindNeighbours) {
+    addCue(3000.0, 1);
+    addCue(1000.0);
+    const CuePointer pHotCue = addCue(2000.0, 0);
+
+    const TrackEngineSnapshotPointer pSnapshot = m_pTrack->getEngineSnapshot();
+    const CueIndex& index = pSnapshot->cueIndex;
+    ASSERT_EQ(3, index.entries().size());
+    EXPECT_DOUBLE_EQ(1000.0, index.entries().first().position);
+
+    EXPECT_DOUBLE_EQ(2000.0, index.findNext(1000.0)->position);
+    EXPECT_DOUBLE_EQ(1000.0, index.findPrevious(2000.0)->position);
+    EXPECT_EQ(nullptr, index.findNext(3000.0));
+    EXPECT_EQ(nullptr, index.findPrevious(1000.0));
+
+    EXPECT_DOUBLE_EQ(1000.0, index.findClosest(1400.0)->position);
+    EXPECT_DOUBLE_EQ(2000.0, index.findClosest(1400.0,
+            CueIndex::Filter::HotCues)->position);
+    EXPECT_DOUBLE_EQ(2000.0, index.findClosest(2000.0)->position);
+
+    ASSERT_NE(nullptr, index.findHotCue(0));
+    EXPECT_EQ(pHotCue, index.findHotCue(0)->pCue);
+    EXPECT_EQ(nullptr, index.findHotCue(2));
+}
+
+TEST_F(CueIndexTest, FollowsMovedCue) {
+    const CuePointer pCue = addCue(1000.0, 0);
+    addCue(2000.0, 1);
+
+    pCue->setPosition(3000.0);
+
+    const TrackEngineSnapshotPointer pSnapshot = m_pTrack->getEngineSnapshot();
+    const CueIndex& index = pSnapshot->cueIndex;
+    EXPECT_DOUBLE_EQ(2000.0, index.entries().first().position);
+    EXPECT_DOUBLE_EQ(3000.0, index.findHotCue(0)->position);
+}
+
+} // anonymous namespace
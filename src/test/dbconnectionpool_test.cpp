@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <QSqlQuery>
+
+#include <thread>
+
 #include "test/mixxxtest.h"
 
 #include "database/mixxxdb.h"
@@ -35,3 +39,31 @@ TEST_F(DbConnectionPoolTest, MoveSemantics) {
     EXPECT_TRUE(p1.isPooling());
     EXPECT_FALSE(p2.isPooling());
 }
+
+TEST_F(DbConnectionPoolTest, ReadOnlyConnection) {
+    const mixxx::DbConnectionPooler writer(m_mixxxDb.connectionPool());
+    const QSqlDatabase writerDatabase =
+            mixxx::DbConnectionPooled(m_mixxxDb.connectionPool());
+    QSqlQuery query(writerDatabase);
+    ASSERT_TRUE(query.exec("PRAGMA journal_mode"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ("wal", query.value(0).toString());
+    ASSERT_TRUE(query.exec("CREATE TABLE test (value INTEGER)"));
+    ASSERT_TRUE(query.exec("INSERT INTO test (value) VALUES (1)"));
+
+    // Connections are thread-local
+    bool selected = false;
+    bool inserted = true;
+    std::thread reader([this, &selected, &inserted] {
+        const mixxx::DbConnectionPooler pooler(
+                m_mixxxDb.connectionPool(), mixxx::DbConnection::Mode::ReadOnly);
+        QSqlQuery query(mixxx::DbConnectionPooled(m_mixxxDb.connectionPool()));
+        selected = query.exec("SELECT value FROM test") && query.next();
+        inserted = query.exec("INSERT INTO test (value) VALUES (2)");
+    });
+    reader.join();
+    EXPECT_TRUE(selected);
+    EXPECT_FALSE(inserted);
+
+    EXPECT_TRUE(mixxx::DbConnection::checkpointWriteAheadLog(writerDatabase));
+}
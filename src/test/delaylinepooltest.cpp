@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include "effects/delaylinepool.h"
+
+namespace {
+
+const SINT kSize = 1234;
+
+class DelayLinePoolTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        DelayLinePool::reclaim();
+    }
+    void TearDown() override {
+        DelayLinePool::reclaim();
+    }
+};
+
+TEST_F(DelayLinePoolTest, LeasedBuffersAreCleared) {
+    DelayLine delayLine(kSize);
+    ASSERT_EQ(kSize, delayLine.size());
+    for (SINT i = 0; i < kSize; ++i) {
+        delayLine[i] = 1;
+    }
+    const CSAMPLE* pData = delayLine.data();
+    delayLine = DelayLine();
+    EXPECT_EQ(kSize, DelayLinePool::idleSamples());
+
+    DelayLine reused(kSize);
+    EXPECT_EQ(pData, reused.data());
+    EXPECT_EQ(0, DelayLinePool::idleSamples());
+    for (SINT i = 0; i < kSize; ++i) {
+        EXPECT_EQ(0, reused[i]);
+    }
+}
+
+TEST_F(DelayLinePoolTest, OnlyReusesMatchingSize) {
+    {
+        DelayLine delayLine(kSize);
+    }
+    DelayLine other(kSize * 2);
+    EXPECT_EQ(kSize * 2, other.size());
+    EXPECT_EQ(kSize, DelayLinePool::idleSamples());
+}
+
+TEST_F(DelayLinePoolTest, KeepsLimitedIdleSamples) {
+    const SINT kLargeSize = DelayLinePool::kMaxIdleSamples / 2 + 1;
+    {
+        DelayLine first(kLargeSize);
+        DelayLine second(kLargeSize);
+    }
+    EXPECT_EQ(kLargeSize, DelayLinePool::idleSamples());
+    DelayLinePool::reclaim();
+    EXPECT_EQ(0, DelayLinePool::idleSamples());
+}
+
+}  // namespace
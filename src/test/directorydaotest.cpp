@@ -153,6 +153,12 @@ TEST_F(DirectoryDAOTest, relocateDirTest) {
     EXPECT_EQ(2, dirs.size());
     qSort(dirs);
     EXPECT_THAT(dirs, ElementsAre(test2, testnew));
+
+    QSet<QString> locations = trackDAO.getTrackLocations();
+    EXPECT_TRUE(locations.contains(testnew + "/a" + m_supportedFileExt));
+    EXPECT_TRUE(locations.contains(testnew + "/b" + m_supportedFileExt));
+    EXPECT_TRUE(locations.contains(test2 + "/c" + m_supportedFileExt));
+    EXPECT_FALSE(locations.contains(testdir + "/a" + m_supportedFileExt));
 }
 
 }  // namespace
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "soundio/driftresampler.h"
+
+namespace {
+
+const int kChannels = 2;
+const SINT kFrames = 64;
+
+std::vector<CSAMPLE> ramp(SINT frames, CSAMPLE start) {
+    std::vector<CSAMPLE> samples(frames * kChannels);
+    for (SINT i = 0; i < frames; ++i) {
+        samples[i * kChannels] = start + i;
+        samples[i * kChannels + 1] = -(start + i);
+    }
+    return samples;
+}
+
+TEST(DriftResamplerTest, UnityRatioPassesThrough) {
+    DriftResampler resampler(kChannels, kFrames);
+    std::vector<CSAMPLE> output(kFrames * kChannels);
+    SINT written = 0;
+    for (int chunk = 0; chunk < 3; ++chunk) {
+        std::vector<CSAMPLE> input = ramp(kFrames, chunk * kFrames);
+        SINT frames = resampler.process(input.data(), kFrames,
+                output.data(), kFrames);
+        // Two frames are held back for the interpolation
+        EXPECT_EQ(chunk == 0 ? kFrames - 2 : kFrames, frames);
+        for (SINT i = 0; i < frames; ++i) {
+            EXPECT_FLOAT_EQ(written + i, output[i * kChannels]);
+            EXPECT_FLOAT_EQ(-(written + i), output[i * kChannels + 1]);
+        }
+        written += frames;
+    }
+}
+
+TEST(DriftResamplerTest, FullFifoIsDrained) {
+    DriftResampler resampler(kChannels, kFrames);
+    for (int i = 0; i < 1000; ++i) {
+        resampler.updateRatio(2 * kFrames, kFrames, kFrames);
+    }
+    EXPECT_LT(1.0, resampler.ratio());
+    EXPECT_GE(1.0 + DriftResampler::kMaxDeviation, resampler.ratio());
+
+    // Interpolates the linear ramp exactly at the fractional positions
+    SINT consumed = 0;
+    SINT written = 0;
+    std::vector<CSAMPLE> output(kFrames * kChannels);
+    for (int chunk = 0; chunk < 100; ++chunk) {
+        SINT required = resampler.inputFramesRequired(kFrames);
+        std::vector<CSAMPLE> input = ramp(required, consumed);
+        ASSERT_EQ(kFrames, resampler.process(input.data(), required,
+                output.data(), kFrames));
+        for (SINT i = 0; i < kFrames; ++i) {
+            EXPECT_NEAR((written + i) * resampler.ratio(),
+                    output[i * kChannels], 1e-2);
+        }
+        consumed += required;
+        written += kFrames;
+    }
+    EXPECT_LT(written, consumed);
+}
+
+TEST(DriftResamplerTest, EmptyFifoIsFilled) {
+    DriftResampler resampler(kChannels, kFrames);
+    for (int i = 0; i < 1000; ++i) {
+        resampler.updateRatio(0, kFrames, kFrames);
+    }
+    EXPECT_GT(1.0, resampler.ratio());
+    EXPECT_LE(1.0 - DriftResampler::kMaxDeviation, resampler.ratio());
+
+    SINT written = 0;
+    std::vector<CSAMPLE> output(2 * kFrames * kChannels);
+    for (int chunk = 0; chunk < 100; ++chunk) {
+        std::vector<CSAMPLE> input = ramp(kFrames, chunk * kFrames);
+        written += resampler.process(input.data(), kFrames,
+                output.data(), 2 * kFrames);
+    }
+    EXPECT_LT(100 * kFrames, written);
+}
+
+}  // namespace
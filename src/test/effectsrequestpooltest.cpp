@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include "effects/effectsrequestpool.h"
+
+namespace {
+
+TEST(EffectsRequestPoolTest, ReusesReleasedRequests) {
+    EffectsRequestPool pool(2, 1);
+    EffectsRequest* pRequest1 = pool.newRequest();
+    EffectsRequest* pRequest2 = pool.newRequest();
+    EXPECT_EQ(0, pool.freeRequestCount());
+
+    pRequest1->type = EffectsRequest::SET_EFFECT_PARAMETERS;
+    pRequest1->request_id = 42;
+    pool.release(pRequest1);
+    EXPECT_EQ(1, pool.freeRequestCount());
+
+    // Released requests are reset before they are handed out again
+    EffectsRequest* pRequest3 = pool.newRequest();
+    EXPECT_EQ(pRequest1, pRequest3);
+    EXPECT_EQ(EffectsRequest::NUM_REQUEST_TYPES, pRequest3->type);
+    EXPECT_EQ(-1, pRequest3->request_id);
+    EXPECT_EQ(2, pool.allocatedRequestCount());
+
+    pool.release(pRequest2);
+    pool.release(pRequest3);
+}
+
+TEST(EffectsRequestPoolTest, GrowsWhenExhausted) {
+    EffectsRequestPool pool(1, 0);
+    EffectsRequest* pRequest1 = pool.newRequest();
+    EffectsRequest* pRequest2 = pool.newRequest();
+    EXPECT_NE(pRequest1, pRequest2);
+    EXPECT_EQ(2, pool.allocatedRequestCount());
+
+    pool.release(pRequest1);
+    pool.release(pRequest2);
+    EXPECT_EQ(2, pool.freeRequestCount());
+}
+
+TEST(EffectsRequestPoolTest, ReleasesAttachedBatch) {
+    EffectsRequestPool pool(1, 1);
+    EffectParameterBatch* pBatch = pool.newBatch();
+    pBatch->count = 3;
+
+    EffectsRequest* pRequest = pool.newRequest();
+    pRequest->type = EffectsRequest::SET_PARAMETER_PARAMETERS_BATCH;
+    pRequest->SetParameterParametersBatch.pBatch = pBatch;
+    pool.release(pRequest);
+
+    EffectParameterBatch* pReusedBatch = pool.newBatch();
+    EXPECT_EQ(pBatch, pReusedBatch);
+    EXPECT_EQ(0, pReusedBatch->count);
+    EXPECT_EQ(1, pool.allocatedBatchCount());
+    pool.releaseBatch(pReusedBatch);
+}
+
+}  // namespace
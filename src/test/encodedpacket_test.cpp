@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "encoder/encodedpacket.h"
+
+namespace {
+
+TEST(EncodedPacketTest, recycleWhenReleased) {
+    EncodedPacketPool pool;
+    EncodedPacketPointer pPacket = pool.acquire(100);
+    ASSERT_TRUE(static_cast<bool>(pPacket));
+    EXPECT_LE(100, pPacket->capacity());
+    EXPECT_EQ(0, pPacket->size());
+    EncodedPacket* pFirst = pPacket.get();
+
+    EncodedPacketPointer pCopy = pPacket;
+    pPacket.reset();
+    EXPECT_EQ(0, pool.freeCount());
+    pCopy.reset();
+    EXPECT_EQ(1, pool.freeCount());
+
+    // The buffer is reused and grows if needed
+    pPacket = pool.acquire(200);
+    EXPECT_EQ(pFirst, pPacket.get());
+    EXPECT_LE(200, pPacket->capacity());
+    EXPECT_EQ(0, pool.freeCount());
+}
+
+TEST(EncodedPacketTest, copy) {
+    EncodedPacketPool pool;
+    const unsigned char header[] = {1, 2};
+    const unsigned char body[] = {3, 4, 5};
+    EncodedPacketPointer pPacket = pool.copy(header, body, 2, 3);
+    ASSERT_EQ(5, pPacket->size());
+    const unsigned char expected[] = {1, 2, 3, 4, 5};
+    EXPECT_EQ(0, std::memcmp(expected, pPacket->data(), 5));
+
+    pPacket = pool.copy(nullptr, body, 0, 3);
+    EXPECT_EQ(3, pPacket->size());
+    EXPECT_EQ(0, std::memcmp(body, pPacket->data(), 3));
+}
+
+} // anonymous namespace
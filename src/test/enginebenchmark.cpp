@@ -0,0 +1,347 @@
+// Benchmarks of the engine under load. Run them with
+//   mixxx-test --benchmark --benchmark_format=json
+// or with "scons benchmark", which writes the JSON results to
+// mixxx-benchmark.json for comparing them between revisions. All benchmarks
+// report the processed frames as items, so the items per second divided by
+// the sample rate is the realtime factor.
+
+#include <benchmark/benchmark.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QTest>
+#include <QVector>
+
+#include <vector>
+
+#include "control/controlobject.h"
+#include "effects/effect.h"
+#include "effects/effectchain.h"
+#include "effects/effectchainslot.h"
+#include "effects/effectrack.h"
+#include "effects/effectsmanager.h"
+#include "effects/native/nativebackend.h"
+#include "engine/cachingreader.h"
+#include "engine/channelmixer.h"
+#include "engine/enginebuffer.h"
+#include "engine/enginebufferscalelinear.h"
+#include "engine/enginebufferscalerubberband.h"
+#include "engine/enginebufferscalest.h"
+#include "engine/enginedeck.h"
+#include "engine/enginemaster.h"
+#include "engine/engineworkerscheduler.h"
+#include "engine/readaheadmanager.h"
+#include "mixer/deck.h"
+#include "test/mixxxtest.h"
+#include "track/track.h"
+#include "util/math.h"
+#include "util/memory.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+#include "waveform/guitick.h"
+
+namespace {
+
+const SINT kSampleRate = 44100;
+const SINT kFramesPerBuffer = 1024;
+
+QString testTrackLocation() {
+    return QDir::currentPath() + "/src/test/sine-30.wav";
+}
+
+// Provides the config of a MixxxTest outside of a test
+class BenchmarkEnvironment : public MixxxTest {
+  public:
+    using MixxxTest::config;
+
+  private:
+    void TestBody() override {}
+};
+
+// A mixing engine with playing decks that each send their signal through the
+// given number of effect units, like in BaseSignalPathTest
+class EngineMasterSetup : public BenchmarkEnvironment {
+  public:
+    EngineMasterSetup(int numDecks, int numEffectUnits) {
+        m_pGuiTick = std::make_unique<GuiTick>();
+        m_pNumDecks = std::make_unique<ControlObject>(
+                ConfigKey("[Master]", "num_decks"));
+        m_pEffectsManager = std::make_unique<EffectsManager>(
+                nullptr, config(), &m_channelHandleFactory);
+        m_pEffectsManager->addEffectsBackend(
+                new NativeBackend(m_pEffectsManager.get()));
+        m_pEngineMaster = std::make_unique<EngineMaster>(config(), "[Master]",
+                m_pEffectsManager.get(), &m_channelHandleFactory, false);
+        m_pEngineMaster->onOutputConnected(
+                AudioOutput(AudioOutput::MASTER, 0, 2));
+
+        for (int i = 0; i < numDecks; ++i) {
+            const QString group = QString("[Channel%1]").arg(i + 1);
+            Deck* pDeck = new Deck(nullptr, config(), m_pEngineMaster.get(),
+                    m_pEffectsManager.get(), EngineChannel::CENTER, group);
+            pDeck->setupEqControls();
+            m_decks.append(pDeck);
+            m_pNumDecks->set(m_decks.size());
+        }
+
+        addEffectUnits(numEffectUnits);
+
+        TrackPointer pTrack(Track::newTemporary(testTrackLocation()));
+        for (Deck* pDeck : m_decks) {
+            loadTrack(pDeck, pTrack);
+            const QString group = pDeck->getGroup();
+            ControlObject::set(ConfigKey(group, "repeat"), 1.0);
+            ControlObject::set(ConfigKey(group, "play"), 1.0);
+        }
+        // Let the effects and the decks settle before measuring
+        for (int i = 0; i < 10; ++i) {
+            process();
+            waitForWorkers();
+        }
+    }
+
+    ~EngineMasterSetup() override {
+        qDeleteAll(m_decks);
+        m_chains.clear();
+        m_pEngineMaster.reset();
+        m_pEffectsManager.reset();
+    }
+
+    void process() {
+        m_pEngineMaster->process(kFramesPerBuffer * 2);
+    }
+
+    // Waits until the readers have read what the last buffer has asked for,
+    // like a sound card that never underflows
+    void waitForWorkers() {
+        QCoreApplication::processEvents();
+        while (!m_pEngineMaster->workersIdle()) {
+            QThread::usleep(10);
+        }
+    }
+
+  private:
+    void addEffectUnits(int numEffectUnits) {
+        StandardEffectRackPointer pRack =
+                m_pEffectsManager->addStandardEffectRack();
+        const int numUnits = math_min(numEffectUnits,
+                static_cast<int>(pRack->numEffectChainSlots()));
+        for (int i = 0; i < numUnits; ++i) {
+            EffectChainPointer pChain(new EffectChain(m_pEffectsManager.get(),
+                    QString("org.mixxx.benchmark.chain%1").arg(i)));
+            for (const char* effectId : { "org.mixxx.effects.filter",
+                    "org.mixxx.effects.echo", "org.mixxx.effects.reverb" }) {
+                EffectPointer pEffect =
+                        m_pEffectsManager->instantiateEffect(effectId);
+                if (pEffect) {
+                    pEffect->setEnabled(true);
+                    pChain->addEffect(pEffect);
+                }
+            }
+            pRack->getEffectChainSlot(i)->loadEffectChainToSlot(pChain);
+            pChain->setEnabled(true);
+            for (Deck* pDeck : m_decks) {
+                pChain->enableForInputChannel(ChannelHandleAndGroup(
+                        pDeck->getEngineDeck()->getHandle(),
+                        pDeck->getGroup()));
+            }
+            m_chains.append(pChain);
+        }
+    }
+
+    void loadTrack(Deck* pDeck, TrackPointer pTrack) {
+        pDeck->slotLoadTrack(pTrack, false);
+        EngineBuffer* pEngineBuffer = pDeck->getEngineDeck()->getEngineBuffer();
+        while (!pEngineBuffer->isTrackLoaded()) {
+            process();
+            QCoreApplication::processEvents();
+            QTest::qSleep(1); // millis
+        }
+    }
+
+    ChannelHandleFactory m_channelHandleFactory;
+    std::unique_ptr<GuiTick> m_pGuiTick;
+    std::unique_ptr<ControlObject> m_pNumDecks;
+    std::unique_ptr<EffectsManager> m_pEffectsManager;
+    std::unique_ptr<EngineMaster> m_pEngineMaster;
+    QVector<Deck*> m_decks;
+    QVector<EffectChainPointer> m_chains;
+};
+
+static void BM_EngineMasterProcess(benchmark::State& state) {
+    const int numDecks = state.range_x();
+    const int numEffectUnits = state.range_y();
+    EngineMasterSetup setup(numDecks, numEffectUnits);
+    state.SetLabel(QString("%1 decks, %2 effect units")
+            .arg(numDecks).arg(numEffectUnits).toStdString());
+
+    while (state.KeepRunning()) {
+        setup.process();
+        state.PauseTiming();
+        setup.waitForWorkers();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * kFramesPerBuffer);
+}
+
+static void EngineMasterArguments(benchmark::internal::Benchmark* b) {
+    for (int numDecks : { 2, 4, 8 }) {
+        for (int numEffectUnits : { 0, 1, 4 }) {
+            b->ArgPair(numDecks, numEffectUnits);
+        }
+    }
+}
+BENCHMARK(BM_EngineMasterProcess)->Apply(EngineMasterArguments);
+
+// Sequential reads of a decoded track, the time of decoding is excluded
+static void BM_CachingReaderRead(benchmark::State& state) {
+    const SINT frames = state.range_x();
+    const bool reverse = state.range_y() != 0;
+    BenchmarkEnvironment environment;
+    EngineWorkerScheduler scheduler;
+    scheduler.start(QThread::HighPriority);
+    CachingReader reader("[Channel1]", environment.config());
+    reader.setScheduler(&scheduler);
+
+    SINT trackFrames = 0;
+    QObject::connect(&reader, &CachingReader::trackLoaded,
+            [&trackFrames](TrackPointer, int, int iNumSamples) {
+                trackFrames = iNumSamples / 2;
+            });
+    reader.newTrack(TrackPointer(Track::newTemporary(testTrackLocation())));
+    while (trackFrames <= 0) {
+        scheduler.runWorkers();
+        QTest::qSleep(1); // millis
+        reader.process();
+    }
+
+    mixxx::SampleBuffer buffer(frames * 2);
+    SINT frame = reverse ? trackFrames - frames : 0;
+    HintVector hints;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        hints.resize(0);
+        Hint hint;
+        hint.frame = frame;
+        hint.frameCount = reverse ? Hint::kFrameCountBackward
+                : Hint::kFrameCountForward;
+        hint.priority = Hint::kPriorityPlayPosition;
+        hints.append(hint);
+        reader.hintAndMaybeWake(hints);
+        scheduler.runWorkers();
+        while (!scheduler.workersIdle()) {
+            QThread::usleep(10);
+        }
+        reader.process();
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(
+                reader.read(frame * 2, frames * 2, reverse, buffer.data()));
+
+        frame += reverse ? -frames : frames;
+        if (frame < 0 || frame + frames > trackFrames) {
+            frame = reverse ? trackFrames - frames : 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * frames);
+}
+BENCHMARK(BM_CachingReaderRead)
+        ->ArgPair(256, 0)->ArgPair(1024, 0)->ArgPair(4096, 0)
+        ->ArgPair(1024, 1);
+
+// Returns a sine wave in both channels without touching a file
+class ReadAheadManagerSine : public ReadAheadManager {
+  public:
+    ReadAheadManagerSine()
+            : m_iFramesRead(0) {
+    }
+
+    SINT getNextSamples(double dRate, CSAMPLE* buffer,
+            SINT requested_samples) override {
+        Q_UNUSED(dRate);
+        for (SINT i = 0; i < requested_samples; i += 2) {
+            buffer[i] = buffer[i + 1] = static_cast<CSAMPLE>(
+                    sin(2.0 * M_PI * 440.0 * m_iFramesRead++ / kSampleRate));
+        }
+        return requested_samples;
+    }
+
+  private:
+    SINT m_iFramesRead;
+};
+
+// The rate is given in percent. The pitch is kept like with keylock, which
+// the linear scaler ignores.
+template<typename Scaler>
+static void BM_EngineBufferScale(benchmark::State& state) {
+    double tempoRatio = state.range_x() / 100.0;
+    double pitchRatio = 1.0;
+    ReadAheadManagerSine readAhead;
+    Scaler scaler(&readAhead);
+    scaler.setSampleRate(kSampleRate);
+    scaler.setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+
+    mixxx::SampleBuffer buffer(kFramesPerBuffer * 2);
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+                scaler.scaleBuffer(buffer.data(), buffer.size()));
+    }
+    state.SetItemsProcessed(state.iterations() * kFramesPerBuffer);
+}
+
+static void ScaleRates(benchmark::internal::Benchmark* b) {
+    for (int ratePercent : { 50, 92, 100, 108, 200 }) {
+        b->Arg(ratePercent);
+    }
+}
+BENCHMARK_TEMPLATE(BM_EngineBufferScale, EngineBufferScaleLinear)
+        ->Apply(ScaleRates);
+BENCHMARK_TEMPLATE(BM_EngineBufferScale, EngineBufferScaleST)
+        ->Apply(ScaleRates);
+BENCHMARK_TEMPLATE(BM_EngineBufferScale, EngineBufferScaleRubberBand)
+        ->Apply(ScaleRates);
+
+// Mixes the given number of channels without effects, with ramping gains
+static void BM_ChannelMixer(benchmark::State& state) {
+    const int numChannels = state.range_x();
+    BenchmarkEnvironment environment;
+    ChannelHandleFactory channelHandleFactory;
+    EffectsManager effectsManager(nullptr, environment.config(),
+            &channelHandleFactory);
+    const ChannelHandle outputHandle =
+            channelHandleFactory.getOrCreateHandle("[Master]");
+
+    std::vector<mixxx::SampleBuffer> buffers;
+    buffers.reserve(numChannels);
+    std::vector<std::unique_ptr<EngineMaster::ChannelInfo>> channels;
+    QVarLengthArray<EngineMaster::ChannelInfo*, kPreallocatedChannels> activeChannels;
+    QVarLengthArray<EngineMaster::GainCache, kPreallocatedChannels> gainCache(numChannels);
+    for (int i = 0; i < numChannels; ++i) {
+        buffers.emplace_back(kFramesPerBuffer * 2);
+        buffers.back().fill(0.1f);
+        auto pChannelInfo = std::make_unique<EngineMaster::ChannelInfo>(i);
+        pChannelInfo->m_handle = channelHandleFactory.getOrCreateHandle(
+                QString("[Channel%1]").arg(i + 1));
+        pChannelInfo->m_pBuffer = buffers.back().data();
+        activeChannels.append(pChannelInfo.get());
+        channels.push_back(std::move(pChannelInfo));
+        gainCache[i].m_gain = 0;
+        gainCache[i].m_fadeout = false;
+    }
+
+    EngineMaster::PflGainCalculator gainCalculator;
+    mixxx::SampleBuffer output(kFramesPerBuffer * 2);
+    int iteration = 0;
+    while (state.KeepRunning()) {
+        // A changing gain, so the gains are ramped like while fading
+        gainCalculator.setGain((iteration++ % 2) ? 1.0 : 0.5);
+        ChannelMixer::applyEffectsAndMixChannels(gainCalculator,
+                &activeChannels, &gainCache, output.data(), outputHandle,
+                output.size(), kSampleRate,
+                effectsManager.getEngineEffectsManager());
+    }
+    state.SetItemsProcessed(state.iterations() * kFramesPerBuffer);
+}
+BENCHMARK(BM_ChannelMixer)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16)->Arg(32);
+
+} // anonymous namespace
@@ -263,6 +263,38 @@ TEST_F(EngineBufferScaleLinearTest, TestHalfSpeedSmoothlyDoublesSamples) {
     SampleUtil::free(pOutput);
 }
 
+TEST_F(EngineBufferScaleLinearTest, TestSteadyRateInterpolatesRamp) {
+    SetRateNoLerp(1.25);
+
+    // A ramp on the first channel and a negative ramp on the second
+    // channel, which is long enough to never be repeated by the mock
+    const int kFrames = kiLinearScaleReadAheadLength;
+    QVector<CSAMPLE> readBuffer(2 * kFrames);
+    for (int i = 0; i < kFrames; ++i) {
+        readBuffer[2 * i] = i;
+        readBuffer[2 * i + 1] = -i;
+    }
+    m_pReadAheadMock->setReadBuffer(readBuffer.data(), readBuffer.size());
+
+    // Tell the RAMAN mock to invoke getNextSamplesFake
+    EXPECT_CALL(*m_pReadAheadMock, getNextSamples(_, _, _))
+            .WillRepeatedly(Invoke(m_pReadAheadMock, &ReadAheadManagerMock::getNextSamplesFake));
+
+    // Spans several reads of the internal buffer
+    const int kOutputSize = 2048;
+    CSAMPLE* pOutput = SampleUtil::alloc(kOutputSize);
+    int outputFrame = 0;
+    for (int call = 0; call < 4; ++call) {
+        m_pScaler->scaleBuffer(pOutput, kOutputSize);
+        for (int i = 0; i < kOutputSize; i += 2, ++outputFrame) {
+            EXPECT_NEAR(outputFrame * 1.25, pOutput[i], 1e-3);
+            EXPECT_NEAR(-outputFrame * 1.25, pOutput[i + 1], 1e-3);
+        }
+    }
+
+    SampleUtil::free(pOutput);
+}
+
 TEST_F(EngineBufferScaleLinearTest, TestRepeatedScaleCalls) {
     SetRateNoLerp(0.5);
 
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <QtDebug>
+
+#include "engine/enginebufferscalerubberbandthreaded.h"
+#include "engine/readaheadmanager.h"
+#include "test/mixxxtest.h"
+#include "util/math.h"
+#include "util/sample.h"
+#include "util/types.h"
+
+namespace {
+
+// Returns a sine wave in both channels
+class ReadAheadManagerSine : public ReadAheadManager {
+  public:
+    ReadAheadManagerSine()
+            : m_iFramesRead(0) {
+    }
+
+    SINT getNextSamples(double dRate, CSAMPLE* buffer,
+            SINT requested_samples) override {
+        Q_UNUSED(dRate);
+        for (SINT i = 0; i < requested_samples; i += 2) {
+            buffer[i] = buffer[i + 1] = static_cast<CSAMPLE>(
+                    sin(2.0 * M_PI * 440.0 * m_iFramesRead++ / 44100.0));
+        }
+        return requested_samples;
+    }
+
+    SINT getFramesRead() const {
+        return m_iFramesRead;
+    }
+
+  private:
+    SINT m_iFramesRead;
+};
+
+class EngineBufferScaleRubberBandThreadedTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_pScaler = new EngineBufferScaleRubberBandThreaded(&m_readAhead);
+        m_pScaler->setSampleRate(44100);
+    }
+
+    void TearDown() override {
+        delete m_pScaler;
+    }
+
+    void setTempo(double tempoRatio) {
+        double pitchRatio = 1.0;
+        m_pScaler->setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+    }
+
+    // Processes the given number of buffers, giving the worker some time
+    // to catch up after each. Returns the frames read.
+    double processBuffers(int count, CSAMPLE* pBuffer, SINT iBufferSize) {
+        double framesRead = 0.0;
+        for (int i = 0; i < count; ++i) {
+            framesRead += m_pScaler->scaleBuffer(pBuffer, iBufferSize);
+            QThread::msleep(2);
+        }
+        return framesRead;
+    }
+
+    static void expectNotSilent(CSAMPLE* pBuffer, SINT iBufferSize) {
+        CSAMPLE absL;
+        CSAMPLE absR;
+        SampleUtil::sumAbsPerChannel(&absL, &absR, pBuffer, iBufferSize);
+        EXPECT_LT(0.0, absL);
+        EXPECT_LT(0.0, absR);
+    }
+
+    ReadAheadManagerSine m_readAhead;
+    EngineBufferScaleRubberBandThreaded* m_pScaler;
+};
+
+TEST_F(EngineBufferScaleRubberBandThreadedTest, ScalesAhead) {
+    const SINT kBufferSize = 512;
+    CSAMPLE buffer[kBufferSize];
+    setTempo(1.0);
+
+    const int kBufferCount = 200;
+    const double framesRead = processBuffers(kBufferCount, buffer, kBufferSize);
+    expectNotSilent(buffer, kBufferSize);
+
+    // The input is read ahead of what has been consumed, but only by a few
+    // buffers and the latency of RubberBand.
+    const double framesPlayed = kBufferCount * kBufferSize / 2;
+    EXPECT_LE(framesRead, m_readAhead.getFramesRead());
+    EXPECT_NEAR(framesPlayed, framesRead, kBufferSize / 2);
+    EXPECT_GT(framesPlayed + 16384, m_readAhead.getFramesRead());
+}
+
+TEST_F(EngineBufferScaleRubberBandThreadedTest, ClearWhilePlaying) {
+    const SINT kBufferSize = 512;
+    CSAMPLE buffer[kBufferSize];
+    setTempo(1.5);
+    processBuffers(50, buffer, kBufferSize);
+    m_pScaler->clear();
+    setTempo(-0.5);
+    processBuffers(50, buffer, kBufferSize);
+    expectNotSilent(buffer, kBufferSize);
+}
+
+}  // namespace
@@ -0,0 +1,148 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <QVector>
+
+#include "engine/enginebufferscalesinc.h"
+#include "engine/readaheadmanager.h"
+#include "test/mixxxtest.h"
+#include "util/math.h"
+#include "util/sample.h"
+#include "util/types.h"
+
+using ::testing::StrictMock;
+using ::testing::Invoke;
+using ::testing::_;
+
+namespace {
+
+const SINT kOutputSamples = 2048;
+
+class ReadAheadManagerMock : public ReadAheadManager {
+  public:
+    ReadAheadManagerMock()
+            : ReadAheadManager(),
+              m_iSamplesRead(0) {
+    }
+
+    SINT getNextSamplesFake(double dRate, CSAMPLE* buffer, SINT requested_samples) {
+        Q_UNUSED(dRate);
+        // You forgot to set the mock read buffer.
+        EXPECT_FALSE(m_readBuffer.isEmpty());
+        for (SINT i = 0; i < requested_samples; ++i) {
+            buffer[i] = m_readBuffer.isEmpty() ? 0 :
+                    m_readBuffer[(m_iSamplesRead + i) % m_readBuffer.size()];
+        }
+        m_iSamplesRead += requested_samples;
+        return requested_samples;
+    }
+
+    void setReadBuffer(const QVector<CSAMPLE>& readBuffer) {
+        m_readBuffer = readBuffer;
+    }
+
+    MOCK_METHOD3(getNextSamples, SINT(double dRate, CSAMPLE* buffer, SINT requested_samples));
+
+    QVector<CSAMPLE> m_readBuffer;
+    SINT m_iSamplesRead;
+};
+
+class EngineBufferScaleSincTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_pReadAheadMock = new StrictMock<ReadAheadManagerMock>();
+        m_pScaler = new EngineBufferScaleSinc(m_pReadAheadMock);
+        // Tell the RAMAN mock to invoke getNextSamplesFake
+        EXPECT_CALL(*m_pReadAheadMock, getNextSamples(_, _, _))
+                .WillRepeatedly(Invoke(m_pReadAheadMock,
+                        &ReadAheadManagerMock::getNextSamplesFake));
+    }
+
+    void TearDown() override {
+        delete m_pScaler;
+        delete m_pReadAheadMock;
+    }
+
+    void SetRateNoLerp(double rate) {
+        double tempoRatio = rate;
+        double pitchRatio = rate;
+        m_pScaler->setSampleRate(44100);
+        // Set it twice to prevent rate LERP'ing
+        m_pScaler->setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+        m_pScaler->setScaleParameters(1.0, &tempoRatio, &pitchRatio);
+    }
+
+    StrictMock<ReadAheadManagerMock>* m_pReadAheadMock;
+    EngineBufferScaleSinc* m_pScaler;
+};
+
+TEST_F(EngineBufferScaleSincTest, UnityRateIsSamplePerfect) {
+    SetRateNoLerp(1.0);
+
+    QVector<CSAMPLE> readBuffer;
+    for (int i = 0; i < 1000; ++i) {
+        readBuffer.push_back(i);
+    }
+    m_pReadAheadMock->setReadBuffer(readBuffer);
+
+    QVector<CSAMPLE> output(kOutputSamples);
+    for (int buffer = 0; buffer < 3; ++buffer) {
+        EXPECT_DOUBLE_EQ(kOutputSamples / 2,
+                m_pScaler->scaleBuffer(output.data(), kOutputSamples));
+        for (int i = 0; i < kOutputSamples; ++i) {
+            EXPECT_FLOAT_EQ(
+                    readBuffer[(buffer * kOutputSamples + i) % readBuffer.size()],
+                    output[i]);
+        }
+    }
+}
+
+TEST_F(EngineBufferScaleSincTest, ScaleConstant) {
+    for (auto quality : {EngineBufferScaleSinc::Quality::Medium,
+                EngineBufferScaleSinc::Quality::High}) {
+        m_pScaler->setQuality(quality);
+        m_pScaler->clear();
+        SetRateNoLerp(1.08);
+        m_pReadAheadMock->setReadBuffer(QVector<CSAMPLE>(1, 0.5f));
+
+        QVector<CSAMPLE> output(kOutputSamples);
+        // Skip the silence before the first frame
+        m_pScaler->scaleBuffer(output.data(), kOutputSamples);
+        EXPECT_NEAR(1.08 * kOutputSamples / 2,
+                m_pScaler->scaleBuffer(output.data(), kOutputSamples), 1e-6);
+        for (int i = 0; i < kOutputSamples; ++i) {
+            EXPECT_NEAR(0.5f, output[i], 1e-5);
+        }
+    }
+}
+
+TEST_F(EngineBufferScaleSincTest, ScaleSine) {
+    // A sine of 1 kHz at 44.1 kHz in both channels
+    const double omega = 2 * M_PI * 1000 / 44100;
+    QVector<CSAMPLE> readBuffer;
+    for (int frame = 0; frame < 44100; ++frame) {
+        readBuffer.push_back(sin(omega * frame));
+        readBuffer.push_back(sin(omega * frame));
+    }
+    m_pReadAheadMock->setReadBuffer(readBuffer);
+
+    const double rate = 1.08;
+    SetRateNoLerp(rate);
+    QVector<CSAMPLE> output(kOutputSamples);
+    for (int buffer = 0; buffer < 4; ++buffer) {
+        m_pScaler->scaleBuffer(output.data(), kOutputSamples);
+        for (int i = 0; i < kOutputSamples / 2; ++i) {
+            const int frame = buffer * kOutputSamples / 2 + i;
+            if (frame < 32) {
+                // Silence before the first frame
+                continue;
+            }
+            const CSAMPLE expected = sin(omega * frame * rate);
+            EXPECT_NEAR(expected, output[2 * i], 1e-3);
+            EXPECT_NEAR(expected, output[2 * i + 1], 1e-3);
+        }
+    }
+}
+
+}  // namespace
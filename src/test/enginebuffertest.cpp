@@ -11,6 +11,7 @@
 #include "test/mockedenginebackendtest.h"
 #include "test/mixxxtest.h"
 #include "test/signalpathtest.h"
+#include "track/beatfactory.h"
 
 // Incase any of the test in this file fail. You can use the audioplot.py tool
 // in the scripts folder to visually compare the results of the enginebuffer
@@ -200,6 +201,23 @@ TEST_F(EngineBufferTest, ResetPitchAdjustUsesLinear) {
     EXPECT_EQ(m_pMockScaleVinyl1, m_pChannel1->getEngineBuffer()->m_pScale);
 }
 
+TEST_F(EngineBufferTest, BeatSnapshotMatchesQuantizeControl) {
+    m_pTrack1->setBeats(BeatFactory::makeBeatGrid(*m_pTrack1, 120, 0.0));
+    ControlObject::set(ConfigKey(m_sGroup1, "play"), 1.0);
+    for (int i = 0; i < 20; ++i) {
+        ProcessBuffer();
+        const BeatSnapshot& snapshot =
+                m_pChannel1->getEngineBuffer()->getBeatSnapshot();
+        ASSERT_TRUE(snapshot.hasBeatContext());
+        EXPECT_LE(snapshot.prevBeat, snapshot.position);
+        EXPECT_GE(snapshot.nextBeat, snapshot.position);
+        EXPECT_DOUBLE_EQ(ControlObject::get(ConfigKey(m_sGroup1, "beat_prev")),
+                snapshot.prevBeat);
+        EXPECT_DOUBLE_EQ(ControlObject::get(ConfigKey(m_sGroup1, "beat_next")),
+                snapshot.nextBeat);
+    }
+}
+
 TEST_F(EngineBufferE2ETest, SoundTouchCrashTest) {
     // Soundtouch has a bug where a pitch value of zero causes an infinite loop
     // and crash.
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <QAtomicInt>
+#include <QtDebug>
+
+#include "engine/enginechannelthreadpool.h"
+
+namespace {
+
+const int kMaxTasks = 64;
+
+class CountingTask : public EngineChannelThreadPool::Task {
+  public:
+    void reset() {
+        for (int i = 0; i < kMaxTasks; ++i) {
+            m_calls[i].store(0);
+        }
+    }
+
+    void run(int index) override {
+        m_calls[index].fetchAndAddRelease(1);
+    }
+
+    int calls(int index) const {
+        return m_calls[index].loadAcquire();
+    }
+
+  private:
+    QAtomicInt m_calls[kMaxTasks];
+};
+
+class EngineChannelThreadPoolTest : public testing::TestWithParam<int> {
+};
+
+TEST_P(EngineChannelThreadPoolTest, RunsEachTaskOnce) {
+    EngineChannelThreadPool pool(GetParam());
+    EXPECT_EQ(GetParam(), pool.numWorkers());
+    CountingTask task;
+    // Repeat to catch workers that are still busy from the previous run
+    for (int repeat = 0; repeat < 100; ++repeat) {
+        for (int count = 0; count <= kMaxTasks; ++count) {
+            task.reset();
+            pool.run(&task, count);
+            for (int i = 0; i < kMaxTasks; ++i) {
+                ASSERT_EQ(i < count ? 1 : 0, task.calls(i))
+                        << "count " << count << " index " << i;
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(NumWorkers, EngineChannelThreadPoolTest,
+        testing::Values(0, 1, 3));
+
+} // namespace
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <QVector>
+
+#include "engine/enginedelaycompensation.h"
+
+namespace {
+
+const int kBufferSize = 64;
+
+TEST(EngineDelayCompensationTest, NoDelayPassesThrough) {
+    EngineDelayCompensation delay;
+    QVector<CSAMPLE> buffer(kBufferSize);
+    for (int i = 0; i < kBufferSize; ++i) {
+        buffer[i] = i;
+    }
+    delay.process(buffer.data(), kBufferSize);
+    for (int i = 0; i < kBufferSize; ++i) {
+        EXPECT_FLOAT_EQ(i, buffer[i]);
+    }
+}
+
+TEST(EngineDelayCompensationTest, DelaysImpulse) {
+    const int delayFrames = 40;
+    EngineDelayCompensation delay;
+    delay.setDelayFrames(delayFrames);
+    delay.clear();
+    ASSERT_EQ(delayFrames, delay.delayFrames());
+
+    QVector<CSAMPLE> buffer(kBufferSize, 0.0f);
+    buffer[0] = 1.0f;
+    buffer[1] = -1.0f;
+    delay.process(buffer.data(), kBufferSize);
+    for (int i = 0; i < kBufferSize; ++i) {
+        EXPECT_FLOAT_EQ(0.0f, buffer[i]);
+    }
+
+    buffer.fill(0.0f);
+    delay.process(buffer.data(), kBufferSize);
+    // The impulse is 40 frames late, 8 frames into the second buffer
+    const int impulseFrame = delayFrames - kBufferSize / 2;
+    for (int i = 0; i < kBufferSize / 2; ++i) {
+        if (i == impulseFrame) {
+            EXPECT_FLOAT_EQ(1.0f, buffer[i * 2]);
+            EXPECT_FLOAT_EQ(-1.0f, buffer[i * 2 + 1]);
+        } else {
+            EXPECT_FLOAT_EQ(0.0f, buffer[i * 2]);
+            EXPECT_FLOAT_EQ(0.0f, buffer[i * 2 + 1]);
+        }
+    }
+}
+
+TEST(EngineDelayCompensationTest, ClampsDelay) {
+    EngineDelayCompensation delay;
+    delay.setDelayFrames(EngineDelayCompensation::kMaxDelayFrames + 100);
+    EXPECT_EQ(EngineDelayCompensation::kMaxDelayFrames, delay.delayFrames());
+    delay.setDelayFrames(-1);
+    EXPECT_EQ(0, delay.delayFrames());
+}
+
+}  // namespace
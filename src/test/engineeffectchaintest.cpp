@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <QScopedPointer>
+
+#include "engine/channelhandle.h"
+#include "engine/effects/engineeffectchain.h"
+#include "engine/effects/message.h"
+
+namespace {
+
+class EngineEffectChainTest : public testing::Test {
+  protected:
+    EngineEffectChainTest()
+            : m_master(m_factory.getOrCreateHandle("[Master]"), "[Master]"),
+              m_channel1(m_factory.getOrCreateHandle("[Channel1]"), "[Channel1]"),
+              m_channel2(m_factory.getOrCreateHandle("[Channel2]"), "[Channel2]") {
+        QPair<EffectsRequestPipe*, EffectsResponsePipe*> pipes =
+                TwoWayMessagePipe<EffectsRequest*, EffectsResponse>::makeTwoWayMessagePipe(
+                        16, 16, false, false);
+        m_pRequestPipe.reset(pipes.first);
+        m_pResponsePipe.reset(pipes.second);
+
+        QSet<ChannelHandleAndGroup> inputChannels;
+        inputChannels << m_channel1 << m_channel2;
+        QSet<ChannelHandleAndGroup> outputChannels;
+        outputChannels << m_master;
+        m_pChain.reset(new EngineEffectChain("org.mixxx.test.chain",
+                                             inputChannels, outputChannels));
+    }
+
+    void enableForInputChannel(const ChannelHandleAndGroup& channel) {
+        EffectsRequest request;
+        request.type = EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL;
+        request.pTargetChain = m_pChain.data();
+        request.EnableInputChannelForChain.pChannelHandle = &channel.handle();
+        request.EnableInputChannelForChain.pEffectStatesMapArray = &m_states;
+        EXPECT_TRUE(m_pChain->processEffectsRequest(request,
+                                                    m_pResponsePipe.data()));
+    }
+
+    ChannelHandleFactory m_factory;
+    ChannelHandleAndGroup m_master;
+    ChannelHandleAndGroup m_channel1;
+    ChannelHandleAndGroup m_channel2;
+    EffectStatesMapArray m_states;
+    QScopedPointer<EffectsRequestPipe> m_pRequestPipe;
+    QScopedPointer<EffectsResponsePipe> m_pResponsePipe;
+    QScopedPointer<EngineEffectChain> m_pChain;
+};
+
+TEST_F(EngineEffectChainTest, NumActiveInputChannels) {
+    EXPECT_EQ(0, m_pChain->numActiveInputChannels());
+    enableForInputChannel(m_channel1);
+    EXPECT_EQ(1, m_pChain->numActiveInputChannels());
+    enableForInputChannel(m_channel2);
+    EXPECT_EQ(2, m_pChain->numActiveInputChannels());
+}
+
+TEST_F(EngineEffectChainTest, CrossfadeFromReplacedChain) {
+    QSet<ChannelHandleAndGroup> inputChannels;
+    inputChannels << m_channel1 << m_channel2;
+    QSet<ChannelHandleAndGroup> outputChannels;
+    outputChannels << m_master;
+    EngineEffectChain stagedChain("org.mixxx.test.chain2",
+                                  inputChannels, outputChannels);
+    stagedChain.enableStagedInputChannel(m_channel1.handle());
+    stagedChain.prepareCrossfade();
+    EXPECT_EQ(1, stagedChain.numActiveInputChannels());
+    EXPECT_FALSE(stagedChain.isActive(m_channel2.handle(), m_master.handle()));
+
+    // The replaced chain is processed until the crossfade has finished
+    enableForInputChannel(m_channel2);
+    stagedChain.startCrossfade(m_pChain.data());
+    EXPECT_EQ(2, stagedChain.numActiveInputChannels());
+    EXPECT_TRUE(stagedChain.isActive(m_channel2.handle(), m_master.handle()));
+
+    stagedChain.finishCrossfade();
+    EXPECT_EQ(1, stagedChain.numActiveInputChannels());
+    EXPECT_FALSE(stagedChain.isActive(m_channel2.handle(), m_master.handle()));
+}
+
+}  // namespace
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <QVector>
+
+#include "engine/enginefilterbessel8.h"
+#include "engine/enginefiltercoefficientcache.h"
+#include "engine/enginefilterlinkwitzriley8.h"
+
+namespace {
+
+const int kSampleRate = 44100;
+const int kBufferSize = 1024;
+
+class EngineFilterIIRTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        m_input.resize(kBufferSize);
+        for (int i = 0; i < kBufferSize; ++i) {
+            // Something noisy with a different signal on each channel
+            m_input[i] = static_cast<CSAMPLE>(((i * 7919) % 2001) - 1000) / 1000.0f;
+        }
+    }
+
+    QVector<CSAMPLE> m_input;
+};
+
+TEST_F(EngineFilterIIRTest, ChannelsAreIndependent) {
+    EngineFilterBessel8Low stereo(kSampleRate, 500);
+    EngineFilterBessel8Low leftOnly(kSampleRate, 500);
+    stereo.assumeSettled();
+    leftOnly.assumeSettled();
+
+    QVector<CSAMPLE> left(m_input);
+    for (int i = 1; i < kBufferSize; i += 2) {
+        left[i] = 0;
+    }
+
+    QVector<CSAMPLE> stereoOut(kBufferSize);
+    QVector<CSAMPLE> leftOut(kBufferSize);
+    stereo.process(m_input.constData(), stereoOut.data(), kBufferSize);
+    leftOnly.process(left.constData(), leftOut.data(), kBufferSize);
+
+    for (int i = 0; i < kBufferSize; i += 2) {
+        EXPECT_FLOAT_EQ(stereoOut[i], leftOut[i]);
+        EXPECT_FLOAT_EQ(0.0f, leftOut[i + 1]);
+    }
+}
+
+TEST_F(EngineFilterIIRTest, ProcessPairMatchesProcess) {
+    EngineFilterLinkwitzRiley8Low low(kSampleRate, 300);
+    EngineFilterLinkwitzRiley8High high(kSampleRate, 3000);
+    EngineFilterLinkwitzRiley8Low pairLow(kSampleRate, 300);
+    EngineFilterLinkwitzRiley8High pairHigh(kSampleRate, 3000);
+
+    QVector<CSAMPLE> lowOut(kBufferSize);
+    QVector<CSAMPLE> highOut(kBufferSize);
+    QVector<CSAMPLE> pairLowOut(kBufferSize);
+    QVector<CSAMPLE> pairHighOut(kBufferSize);
+
+    // The first buffer ramps after the coefficients have been set, the
+    // second one takes the single pass.
+    for (int buffer = 0; buffer < 2; ++buffer) {
+        low.process(m_input.constData(), lowOut.data(), kBufferSize);
+        high.process(m_input.constData(), highOut.data(), kBufferSize);
+        pairLow.processPair(m_input.constData(), pairLowOut.data(),
+                &pairHigh, m_input.constData(), pairHighOut.data(),
+                kBufferSize);
+        for (int i = 0; i < kBufferSize; ++i) {
+            EXPECT_EQ(lowOut[i], pairLowOut[i]);
+            EXPECT_EQ(highOut[i], pairHighOut[i]);
+        }
+    }
+}
+
+TEST_F(EngineFilterIIRTest, SharedCoefficientsMatchDesign) {
+    EngineFilterCoefficientCache::clear();
+    EngineFilterBessel8Low designed(kSampleRate, 500);
+    EXPECT_EQ(0, EngineFilterCoefficientCache::hitCount());
+    EXPECT_EQ(1, EngineFilterCoefficientCache::missCount());
+
+    // The second filter copies the coefficients of the first one
+    EngineFilterBessel8Low cached(kSampleRate, 500);
+    EXPECT_EQ(1, EngineFilterCoefficientCache::hitCount());
+    EXPECT_EQ(1, EngineFilterCoefficientCache::missCount());
+    designed.assumeSettled();
+    cached.assumeSettled();
+
+    QVector<CSAMPLE> designedOut(kBufferSize);
+    QVector<CSAMPLE> cachedOut(kBufferSize);
+    designed.process(m_input.constData(), designedOut.data(), kBufferSize);
+    cached.process(m_input.constData(), cachedOut.data(), kBufferSize);
+    for (int i = 0; i < kBufferSize; ++i) {
+        EXPECT_EQ(designedOut[i], cachedOut[i]);
+    }
+
+    // A different corner is designed again
+    cached.setFrequencyCorners(kSampleRate, 600);
+    EXPECT_EQ(2, EngineFilterCoefficientCache::missCount());
+}
+
+}  // namespace
@@ -89,6 +89,37 @@ TEST_F(EngineMasterTest, SingleChannelOutputWorks) {
     assertHeadphoneBufferMatchesGolden(testName);
 }
 
+TEST_F(EngineMasterTest, SingleChannelOutputRendersIntoDeviceBuffer) {
+    EngineChannelMock* pChannel = new EngineChannelMock(
+            "[Test1]", EngineChannel::CENTER, m_pEngineMaster);
+    m_pEngineMaster->addChannel(pChannel);
+
+    CSAMPLE* pChannelBuffer = const_cast<CSAMPLE*>(m_pEngineMaster->getChannelBuffer("[Test1]"));
+    SampleUtil::fill(pChannelBuffer, 0.1f, MAX_BUFFER_LEN);
+
+    EXPECT_CALL(*pChannel, isActive())
+            .Times(1)
+            .WillOnce(Return(true));
+    EXPECT_CALL(*pChannel, isMasterEnabled())
+            .Times(1)
+            .WillOnce(Return(true));
+    EXPECT_CALL(*pChannel, isPflEnabled())
+            .Times(1)
+            .WillOnce(Return(false));
+    EXPECT_CALL(*pChannel, process(_, MAX_BUFFER_LEN))
+            .Times(1)
+            .WillOnce(Return());
+
+    CSAMPLE* pDeviceBuffer = SampleUtil::alloc(MAX_BUFFER_LEN);
+    ASSERT_TRUE(m_pEngineMaster->processInto(
+            MAX_BUFFER_LEN, AudioPath::MASTER, pDeviceBuffer));
+
+    // The device buffer holds what would be in the master buffer
+    assertBufferMatchesReference(pDeviceBuffer, MAX_BUFFER_LEN,
+            "SingleChannelOutputWorks-master");
+    SampleUtil::free(pDeviceBuffer);
+}
+
 TEST_F(EngineMasterTest, SingleChannelPFLOutputWorks) {
     const QString testName = "SingleChannelPFLOutputWorks";
 
@@ -392,4 +423,24 @@ TEST_F(EngineMasterTest, ThreeChannelPFLOutputWorks) {
     assertHeadphoneBufferMatchesGolden(testName);
 }
 
+TEST_F(EngineMasterTest, BusesWithoutConsumerAreSkipped) {
+    ControlProxy skippedBuses("[Master]", "skipped_buses");
+
+    // No microphones are configured
+    m_pEngineMaster->process(MAX_BUFFER_LEN);
+    EXPECT_EQ(EngineMaster::SKIPPED_TALKOVER, skippedBuses.get());
+
+    // Without the master mix and bus outputs nothing needs the crossfader
+    // buses
+    ControlObject::set(ConfigKey("[Master]", "enabled"), 0.0);
+    m_pEngineMaster->process(MAX_BUFFER_LEN);
+    EXPECT_EQ(EngineMaster::SKIPPED_TALKOVER |
+            EngineMaster::SKIPPED_CROSSFADER_BUSES, skippedBuses.get());
+
+    m_pEngineMaster->onOutputConnected(
+            AudioOutput(AudioPath::BUS, 0, 2, EngineChannel::LEFT));
+    m_pEngineMaster->process(MAX_BUFFER_LEN);
+    EXPECT_EQ(EngineMaster::SKIPPED_TALKOVER, skippedBuses.get());
+}
+
 }  // namespace
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <QVector>
+
+#include "engine/enginesidechaincompressor.h"
+
+namespace {
+
+const int kBufferSize = 1026;
+
+class EngineSideChainCompressorTest : public testing::Test {
+  protected:
+    EngineSideChainCompressorTest()
+            : m_compressor("[Test]") {
+        m_compressor.setParameters(0.5, 0.8, 100, 1000);
+    }
+
+    EngineSideChainCompressor m_compressor;
+};
+
+TEST_F(EngineSideChainCompressorTest, KeyBelowThreshold) {
+    QVector<CSAMPLE> key(kBufferSize, 0.4f);
+    // Only one channel above the threshold
+    key[kBufferSize - 2] = 0.55f;
+    m_compressor.clearKeys();
+    m_compressor.processKey(key.constData(), kBufferSize);
+    EXPECT_DOUBLE_EQ(1.0, m_compressor.calculateCompressedGain(kBufferSize / 2));
+}
+
+TEST_F(EngineSideChainCompressorTest, KeyAboveThresholdInLastFrame) {
+    QVector<CSAMPLE> key(kBufferSize, 0.0f);
+    key[kBufferSize - 2] = 0.6f;
+    key[kBufferSize - 1] = 0.6f;
+    m_compressor.clearKeys();
+    m_compressor.processKey(key.constData(), kBufferSize);
+    EXPECT_LT(m_compressor.calculateCompressedGain(kBufferSize / 2), 1.0);
+}
+
+}  // namespace
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <QList>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+
+#include "engine/engineworker.h"
+#include "engine/engineworkerpool.h"
+
+namespace {
+
+// Logs its name for each step of work
+class LoggingWorker : public EngineWorker {
+  public:
+    LoggingWorker(EngineWorkerPool* pPool, Priority priority, char name,
+            QList<char>* pLog, QMutex* pLogMutex)
+            : EngineWorker(priority, pPool),
+              m_name(name),
+              m_pLog(pLog),
+              m_pLogMutex(pLogMutex),
+              m_steps(0) {
+    }
+
+    void addSteps(int steps) {
+        m_steps.fetchAndAddOrdered(steps);
+    }
+
+    bool runOnce() override {
+        if (m_steps.loadAcquire() <= 0) {
+            return false;
+        }
+        QMutexLocker locker(m_pLogMutex);
+        m_pLog->append(m_name);
+        return m_steps.fetchAndAddOrdered(-1) > 1;
+    }
+
+  private:
+    const char m_name;
+    QList<char>* const m_pLog;
+    QMutex* const m_pLogMutex;
+    QAtomicInt m_steps;
+};
+
+// Keeps the only thread of the pool busy until it is released
+class BlockingWorker : public EngineWorker {
+  public:
+    explicit BlockingWorker(EngineWorkerPool* pPool)
+            : EngineWorker(Priority::High, pPool) {
+    }
+
+    bool runOnce() override {
+        m_started.release();
+        m_release.acquire();
+        return false;
+    }
+
+    QSemaphore m_started;
+    QSemaphore m_release;
+};
+
+class EngineWorkerPoolTest : public testing::Test {
+  protected:
+    EngineWorkerPoolTest()
+            : m_pool(1),
+              m_blocker(&m_pool) {
+    }
+
+    ~EngineWorkerPoolTest() override {
+        m_blocker.quitWait();
+    }
+
+    // Makes the workers that are woken up meanwhile queue behind each other
+    void blockPool() {
+        m_blocker.wake();
+        m_blocker.m_started.acquire();
+    }
+
+    QList<char> waitForLog(int size) {
+        for (int i = 0; i < 5000; ++i) {
+            {
+                QMutexLocker locker(&m_logMutex);
+                if (m_log.size() >= size) {
+                    return m_log;
+                }
+            }
+            QThread::msleep(1);
+        }
+        QMutexLocker locker(&m_logMutex);
+        return m_log;
+    }
+
+    EngineWorkerPool m_pool;
+    BlockingWorker m_blocker;
+    QList<char> m_log;
+    QMutex m_logMutex;
+};
+
+TEST_F(EngineWorkerPoolTest, ServesHigherPriorityFirst) {
+    LoggingWorker low(&m_pool, EngineWorker::Priority::Low, 'L',
+            &m_log, &m_logMutex);
+    LoggingWorker normal(&m_pool, EngineWorker::Priority::Normal, 'N',
+            &m_log, &m_logMutex);
+    LoggingWorker high(&m_pool, EngineWorker::Priority::High, 'H',
+            &m_log, &m_logMutex);
+    low.addSteps(1);
+    normal.addSteps(1);
+    high.addSteps(1);
+
+    blockPool();
+    low.wake();
+    normal.wake();
+    high.wake();
+    m_blocker.m_release.release();
+
+    EXPECT_EQ(QList<char>({ 'H', 'N', 'L' }), waitForLog(3));
+    low.quitWait();
+    normal.quitWait();
+    high.quitWait();
+}
+
+TEST_F(EngineWorkerPoolTest, TakesTurnsWithinPriority) {
+    LoggingWorker first(&m_pool, EngineWorker::Priority::High, 'A',
+            &m_log, &m_logMutex);
+    LoggingWorker second(&m_pool, EngineWorker::Priority::High, 'B',
+            &m_log, &m_logMutex);
+    first.addSteps(3);
+    second.addSteps(2);
+
+    blockPool();
+    first.wake();
+    second.wake();
+    m_blocker.m_release.release();
+
+    EXPECT_EQ(QList<char>({ 'A', 'B', 'A', 'B', 'A' }), waitForLog(5));
+    first.quitWait();
+    second.quitWait();
+}
+
+TEST_F(EngineWorkerPoolTest, NotRunAfterQuitWait) {
+    LoggingWorker worker(&m_pool, EngineWorker::Priority::High, 'W',
+            &m_log, &m_logMutex);
+    worker.addSteps(1);
+
+    blockPool();
+    worker.wake();
+    worker.quitWait();
+    m_blocker.m_release.release();
+    worker.wake();
+
+    // Whatever runs after the worker, it has not been run
+    LoggingWorker marker(&m_pool, EngineWorker::Priority::Low, 'M',
+            &m_log, &m_logMutex);
+    marker.addSteps(1);
+    marker.wake();
+    EXPECT_EQ(QList<char>({ 'M' }), waitForLog(1));
+    marker.quitWait();
+}
+
+} // namespace
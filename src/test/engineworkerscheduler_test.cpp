@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "engine/engineworker.h"
+#include "engine/engineworkerscheduler.h"
+
+namespace {
+
+// Does the work of the test instead of a thread of its own
+class ManualWorker : public EngineWorker {
+  public:
+    bool runOnce() override {
+        return false;
+    }
+    int takeWorkRequests() const {
+        return workRequests();
+    }
+    void finishWork(int requests) {
+        workDone(requests);
+    }
+};
+
+TEST(EngineWorkerSchedulerTest, IdleWhenAllRequestsAreDone) {
+    EngineWorkerScheduler scheduler;
+    ManualWorker worker1;
+    ManualWorker worker2;
+    worker1.setScheduler(&scheduler);
+    worker2.setScheduler(&scheduler);
+    EXPECT_TRUE(scheduler.workersIdle());
+
+    EXPECT_TRUE(worker1.workReady());
+    EXPECT_TRUE(worker2.workReady());
+    EXPECT_FALSE(scheduler.workersIdle());
+
+    worker1.finishWork(worker1.takeWorkRequests());
+    EXPECT_FALSE(scheduler.workersIdle());
+    worker2.finishWork(worker2.takeWorkRequests());
+    EXPECT_TRUE(scheduler.workersIdle());
+
+    // Finding no work again is not counted twice
+    worker2.finishWork(worker2.takeWorkRequests());
+    EXPECT_TRUE(scheduler.workersIdle());
+}
+
+TEST(EngineWorkerSchedulerTest, RequestsDuringWorkArePending) {
+    EngineWorkerScheduler scheduler;
+    ManualWorker worker;
+    worker.setScheduler(&scheduler);
+
+    worker.workReady();
+    const int requests = worker.takeWorkRequests();
+    // The engine asks for more while the worker is busy with the first
+    worker.workReady();
+    worker.finishWork(requests);
+    EXPECT_FALSE(scheduler.workersIdle());
+
+    worker.finishWork(worker.takeWorkRequests());
+    EXPECT_TRUE(scheduler.workersIdle());
+}
+
+TEST(EngineWorkerSchedulerTest, NoSchedulerNoRequests) {
+    ManualWorker worker;
+    EXPECT_FALSE(worker.workReady());
+    EXPECT_EQ(0, worker.takeWorkRequests());
+}
+
+} // namespace
@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include <QObject>
+
+#include "util/eventloopprofiler.h"
+
+namespace {
+
+TEST(EventLoopProfilerTest, DescribeEvent) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
+    EXPECT_EQ(QString("Timer QObject"),
+            EventLoopProfiler::describeEvent(QEvent::Timer, "QObject", QString()));
+    EXPECT_EQ(QString("MetaCall WWidget \"PlayButton\""),
+            EventLoopProfiler::describeEvent(QEvent::MetaCall, "WWidget", "PlayButton"));
+#endif
+    EXPECT_EQ(QString("Event%1 QObject").arg(QEvent::User + 1),
+            EventLoopProfiler::describeEvent(
+                    static_cast<QEvent::Type>(QEvent::User + 1), "QObject", QString()));
+}
+
+TEST(EventLoopProfilerTest, DeletedTarget) {
+    EventLoopProfiler::setEnabled(true, mixxx::Duration::fromNanos(0));
+    QObject* pTarget = new QObject;
+    QEvent event(QEvent::DeferredDelete);
+    {
+        EventLoopProfiler::ScopedDispatch dispatch(pTarget, &event);
+        delete pTarget;
+    }
+    EventLoopProfiler::setEnabled(false);
+    EXPECT_FALSE(EventLoopProfiler::isEnabled());
+}
+
+} // anonymous namespace
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include <QHash>
+
+#include "control/internedconfigkey.h"
+
+namespace {
+
+TEST(InternedConfigKeyTest, EqualKeysShareEntry) {
+    const InternedConfigKey key1(ConfigKey("[Channel1]", "play"));
+    const InternedConfigKey key2(ConfigKey(QString("[Channel%1]").arg(1), "play"));
+    const InternedConfigKey key3(ConfigKey("[Channel2]", "play"));
+    EXPECT_EQ(key1, key2);
+    EXPECT_NE(key1, key3);
+    EXPECT_EQ(key1.hash(), key2.hash());
+    EXPECT_EQ(qHash(ConfigKey("[Channel1]", "play")), key1.hash());
+    EXPECT_EQ(&key1.key(), &key2.key());
+    // The keys of different controls share the item string
+    EXPECT_EQ(key1.key().item.constData(), key3.key().item.constData());
+}
+
+TEST(InternedConfigKeyTest, Literal) {
+    constexpr ConfigKeyLiteral kLiteral("[Master]", "crossfader");
+    const InternedConfigKey key(kLiteral);
+    EXPECT_EQ(InternedConfigKey(ConfigKey("[Master]", "crossfader")), key);
+    EXPECT_EQ(ConfigKey("[Master]", "crossfader"), key.key());
+}
+
+TEST(InternedConfigKeyTest, Null) {
+    const InternedConfigKey key;
+    EXPECT_TRUE(key.isNull());
+    EXPECT_TRUE(key.key().isNull());
+    EXPECT_NE(InternedConfigKey(ConfigKey()), key);
+}
+
+}  // namespace
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "engine/cachingreader.h"
+#include "engine/jumptargetbuffers.h"
+#include "test/mixxxtest.h"
+#include "util/sample.h"
+
+namespace {
+
+// Each sample holds its own index, until the cache is lost
+class IndexReader : public CachingReader {
+  public:
+    IndexReader()
+            : CachingReader("[test]", UserSettingsPointer()),
+              m_bCached(true) {
+    }
+
+    void setCached(bool cached) {
+        m_bCached = cached;
+    }
+
+    SINT read(SINT startSample, SINT numSamples, bool reverse,
+            CSAMPLE* buffer) override {
+        if (!m_bCached) {
+            return 0;
+        }
+        const SINT firstSample = reverse ? startSample - numSamples : startSample;
+        for (SINT i = 0; i < numSamples; ++i) {
+            buffer[i] = firstSample + i;
+        }
+        if (reverse) {
+            SampleUtil::reverse(buffer, numSamples);
+        }
+        return numSamples;
+    }
+
+  private:
+    bool m_bCached;
+};
+
+class JumpTargetBuffersTest : public MixxxTest {
+  protected:
+    static Hint makeHint(SINT frame, int priority) {
+        Hint hint;
+        hint.frame = frame;
+        hint.frameCount = Hint::kFrameCountForward;
+        hint.priority = priority;
+        return hint;
+    }
+
+    IndexReader m_reader;
+    CSAMPLE m_buffer[64];
+};
+
+TEST_F(JumpTargetBuffersTest, ReadsTargetAfterCacheLoss) {
+    JumpTargetBuffers targets(2);
+    HintVector hints;
+    hints.append(makeHint(10000, Hint::kPriorityCue));
+    targets.update(hints, &m_reader);
+    m_reader.setCached(false);
+
+    // The crossfade before the target and the samples after it
+    ASSERT_EQ(64, targets.read(20000 - 32, 64, false, m_buffer));
+    EXPECT_EQ(20000 - 32, m_buffer[0]);
+    EXPECT_EQ(20000 + 31, m_buffer[63]);
+
+    // In reverse the samples end at the start sample
+    ASSERT_EQ(64, targets.read(20000, 64, true, m_buffer));
+    EXPECT_EQ(20000 - 2, m_buffer[0]);
+    EXPECT_EQ(20000 - 1, m_buffer[1]);
+
+    // Out of the buffer
+    EXPECT_EQ(0, targets.read(
+            (10000 + JumpTargetBuffers::kFramesAfter) * 2 - 32, 64,
+            false, m_buffer));
+    EXPECT_EQ(0, targets.read(0, 64, false, m_buffer));
+}
+
+TEST_F(JumpTargetBuffersTest, PrefersLoopOverCues) {
+    JumpTargetBuffers targets(1);
+    HintVector hints;
+    hints.append(makeHint(10000, Hint::kPriorityCue));
+    hints.append(makeHint(50000, Hint::kPriorityLoop));
+    targets.update(hints, &m_reader);
+    m_reader.setCached(false);
+
+    EXPECT_EQ(64, targets.read(100000, 64, false, m_buffer));
+    EXPECT_EQ(0, targets.read(20000, 64, false, m_buffer));
+}
+
+TEST_F(JumpTargetBuffersTest, RefillsFromCacheOnly) {
+    JumpTargetBuffers targets(1);
+    HintVector hints;
+    hints.append(makeHint(10000, Hint::kPriorityCue));
+    m_reader.setCached(false);
+    targets.update(hints, &m_reader);
+    EXPECT_EQ(0, targets.read(20000, 64, false, m_buffer));
+
+    m_reader.setCached(true);
+    targets.update(hints, &m_reader);
+    m_reader.setCached(false);
+    EXPECT_EQ(64, targets.read(20000, 64, false, m_buffer));
+
+    targets.clear();
+    EXPECT_EQ(0, targets.read(20000, 64, false, m_buffer));
+}
+
+} // namespace
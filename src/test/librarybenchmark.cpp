@@ -0,0 +1,623 @@
+// Benchmarks of the library on synthetic databases of 100k to 1M tracks,
+// with thousands of crates and playlists. Run them with
+//   mixxx-test --benchmark --benchmark_filter=Library
+// or with "scons benchmark" like the other benchmarks. The tracks get
+// artists, titles and genres that are reused like in real collections: a
+// few artists and genres make up most of the tracks.
+//
+// Generating the larger databases takes a while and is not measured. The
+// database of the most recent size is kept for the following benchmarks,
+// which are therefore registered with the sizes in ascending order.
+
+#include <benchmark/benchmark.h>
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QSet>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QtDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "library/basetrackcache.h"
+#include "library/crate/cratestorage.h"
+#include "library/dao/playlistdao.h"
+#include "library/dao/trackdao.h"
+#include "library/dao/trackschema.h"
+#include "library/queryutil.h"
+#include "library/searchquery.h"
+#include "library/searchqueryparser.h"
+#include "test/librarytest.h"
+#include "track/keyutils.h"
+#include "track/track.h"
+#include "util/db/sqltransaction.h"
+#include "util/memory.h"
+
+namespace {
+
+const int kLibrarySizes[] = {100000, 500000, 1000000};
+// 1000 to 10000 crates and 500 to 5000 playlists
+const int kTracksPerCrate = 100;
+const int kTracksPerPlaylist = 200;
+const int kSeed = 4711;
+
+const char* const kWords[] = {
+    "love", "night", "dance", "deep", "light", "heart", "dream", "fire",
+    "summer", "city", "rain", "gold", "shadow", "river", "electric", "soul",
+    "blue", "midnight", "machine", "echo", "paradise", "storm", "velvet",
+    "sky", "ocean", "desire", "frequency", "motion", "silver", "future",
+    "memory", "sunrise", "underground", "rhythm", "jungle", "crystal",
+    "horizon", "voodoo", "planet", "wild", "gravity", "neon", "tokyo",
+    "berlin", "detroit", "chicago", "ibiza", "garden", "mirror", "tiger",
+    "phoenix", "saturday", "fever", "magic", "system", "signal", "pulse",
+    "desert", "islands", "lonely", "forever", "tonight", "breathe", "higher",
+};
+const int kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+const char* const kFirstNames[] = {
+    "John", "Maria", "David", "Anna", "Carl", "Lena", "Marco", "Sofia",
+    "Kenji", "Aisha", "Pedro", "Nina", "Oscar", "Ines", "Viktor", "Yuki",
+};
+const int kFirstNameCount = sizeof(kFirstNames) / sizeof(kFirstNames[0]);
+
+// In the order of their frequency
+const char* const kGenres[] = {
+    "House", "Techno", "Deep House", "Pop", "Rock", "Hip-Hop", "Drum & Bass",
+    "Tech House", "Trance", "Electronica", "Disco", "Funk", "Soul", "Dubstep",
+    "Minimal", "Progressive House", "Jazz", "Reggae", "Breaks", "Ambient",
+    "R&B", "Latin", "Garage", "Electro", "Hardstyle", "Classical",
+};
+const int kGenreCount = sizeof(kGenres) / sizeof(kGenres[0]);
+
+const char* const kTitleSuffixes[] = {
+    " (Original Mix)", " (Extended Mix)", " (Radio Edit)", " (Dub)",
+    " (Remix)", " (Instrumental)", " (Club Mix)", " (Live)",
+};
+const int kTitleSuffixCount = sizeof(kTitleSuffixes) / sizeof(kTitleSuffixes[0]);
+
+// Picks an index of [0, count) whose frequency decreases like the ranks of
+// a Zipf distribution
+int pickZipf(std::mt19937* pRandom, int count) {
+    std::uniform_real_distribution<double> logRank(0.0, std::log(count + 1.0));
+    return std::min(count - 1,
+            static_cast<int>(std::exp(logRank(*pRandom))) - 1);
+}
+
+int pickUniform(std::mt19937* pRandom, int first, int last) {
+    return std::uniform_int_distribution<int>(first, last)(*pRandom);
+}
+
+QString capitalized(const char* word) {
+    QString result(word);
+    result[0] = result[0].toUpper();
+    return result;
+}
+
+QString artistName(int artist) {
+    const QString word = capitalized(kWords[(artist / 5) % kWordCount]);
+    const QString number = artist >= 5 * kWordCount
+            ? QString(" %1").arg(artist / (5 * kWordCount)) : QString();
+    switch (artist % 5) {
+    case 0:
+        return QString("%1 %2%3").arg(kFirstNames[artist % kFirstNameCount],
+                word, number);
+    case 1:
+        return QString("The %1s%2").arg(word, number);
+    case 2:
+        return QString("DJ %1%2").arg(word, number);
+    case 3:
+        return QString("%1 & %2%3").arg(kFirstNames[(artist / 3) % kFirstNameCount],
+                word, number);
+    default:
+        return QString("%1 Collective%2").arg(word, number);
+    }
+}
+
+QString phrase(std::mt19937* pRandom, int minWords, int maxWords) {
+    QStringList words;
+    const int count = pickUniform(pRandom, minWords, maxWords);
+    for (int i = 0; i < count; ++i) {
+        words << capitalized(kWords[pickZipf(pRandom, kWordCount)]);
+    }
+    return words.join(" ");
+}
+
+// A library with the given number of tracks in the database of a
+// LibraryTest, outside of a test
+class SyntheticLibrary : public LibraryTest {
+  public:
+    explicit SyntheticLibrary(int numTracks)
+            : m_numTracks(numTracks),
+              m_random(kSeed) {
+        qDebug() << "Generating a library of" << numTracks << "tracks";
+        SqlTransaction transaction(dbConnection());
+        generateTracks();
+        generateCrates(numTracks / kTracksPerCrate);
+        generatePlaylists(numTracks / kTracksPerPlaylist);
+        transaction.commit();
+        m_trackIdSet = QSet<TrackId>::fromList(m_trackIds);
+    }
+
+    using LibraryTest::collection;
+
+    int numTracks() const {
+        return m_numTracks;
+    }
+
+    const QList<TrackId>& trackIds() const {
+        return m_trackIds;
+    }
+    const QSet<TrackId>& trackIdSet() const {
+        return m_trackIdSet;
+    }
+
+    std::mt19937* random() {
+        return &m_random;
+    }
+
+    // The cache of the view of the library like in MixxxLibraryFeature,
+    // with its index built
+    BaseTrackCache* trackCache() {
+        if (!m_pTrackCache) {
+            createTrackCache();
+        }
+        return m_pTrackCache.get();
+    }
+
+  private:
+    void TestBody() override {}
+
+    void generateTracks();
+    void generateCrates(int numCrates);
+    void generatePlaylists(int numPlaylists);
+    void createTrackCache();
+
+    // A sample of count distinct tracks
+    QList<TrackId> pickTracks(int count);
+
+    const int m_numTracks;
+    std::mt19937 m_random;
+    QList<TrackId> m_trackIds;
+    QSet<TrackId> m_trackIdSet;
+    std::unique_ptr<BaseTrackCache> m_pTrackCache;
+};
+
+void SyntheticLibrary::generateTracks() {
+    QSqlQuery locationQuery(dbConnection());
+    locationQuery.prepare("INSERT INTO track_locations "
+            "(location, filename, directory, filesize, fs_deleted, "
+            "needs_verification) VALUES (?, ?, ?, ?, 0, 0)");
+    QSqlQuery trackQuery(dbConnection());
+    trackQuery.prepare("INSERT INTO library "
+            "(artist, title, album, album_artist, year, genre, tracknumber, "
+            "location, comment, duration, bitrate, samplerate, bpm, key, "
+            "key_id, filetype, timesplayed, played, rating, mixxx_deleted) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, 0)");
+
+    // About 10 tracks per artist, but most tracks are by the few artists
+    // of the lowest ranks
+    const int numArtists = std::max(1, m_numTracks / 10);
+    std::normal_distribution<double> bpmDistribution(124.0, 18.0);
+    std::normal_distribution<double> durationDistribution(330.0, 90.0);
+    std::exponential_distribution<double> ageDistribution(0.12);
+    const int kBitrates[] = {128, 192, 256, 320, 320, 1411};
+
+    m_trackIds.reserve(m_numTracks);
+    for (int i = 0; i < m_numTracks; ++i) {
+        const int artist = pickZipf(&m_random, numArtists);
+        const QString artistText = artistName(artist);
+        const int albumNumber = pickUniform(&m_random, 1, 8);
+        const QString album = QString("%1 %2").arg(
+                capitalized(kWords[(artist + albumNumber) % kWordCount]),
+                capitalized(kWords[(artist * 7 + albumNumber) % kWordCount]));
+        QString title = phrase(&m_random, 1, 5);
+        if (pickUniform(&m_random, 0, 4) == 0) {
+            title += kTitleSuffixes[pickZipf(&m_random, kTitleSuffixCount)];
+        }
+        const int trackNumber = pickUniform(&m_random, 1, 14);
+        const bool lossless = pickUniform(&m_random, 0, 9) == 0;
+        const QString fileName = QString("%1 - %2 - %3.%4").arg(
+                QString::number(trackNumber), title, QString::number(i),
+                lossless ? "flac" : "mp3");
+        const QString directory = QString("/music/%1/%2").arg(artistText, album);
+
+        locationQuery.addBindValue(directory + "/" + fileName);
+        locationQuery.addBindValue(fileName);
+        locationQuery.addBindValue(directory);
+        locationQuery.addBindValue(pickUniform(&m_random, 3000000, 60000000));
+        if (!locationQuery.exec()) {
+            LOG_FAILED_QUERY(locationQuery);
+            return;
+        }
+
+        const int keyId = pickUniform(&m_random, 1, 24);
+        trackQuery.addBindValue(artistText);
+        trackQuery.addBindValue(title);
+        trackQuery.addBindValue(album);
+        trackQuery.addBindValue(
+                pickUniform(&m_random, 0, 2) == 0 ? artistText : QString());
+        trackQuery.addBindValue(QString::number(
+                std::max(1960, 2018 - static_cast<int>(ageDistribution(m_random)))));
+        trackQuery.addBindValue(kGenres[pickZipf(&m_random, kGenreCount)]);
+        trackQuery.addBindValue(QString::number(trackNumber));
+        trackQuery.addBindValue(locationQuery.lastInsertId());
+        trackQuery.addBindValue(
+                pickUniform(&m_random, 0, 9) == 0 ? phrase(&m_random, 2, 8) : QString());
+        trackQuery.addBindValue(
+                std::max(60.0, durationDistribution(m_random)));
+        trackQuery.addBindValue(lossless ? kBitrates[5]
+                : kBitrates[pickUniform(&m_random, 0, 4)]);
+        trackQuery.addBindValue(44100);
+        trackQuery.addBindValue(
+                std::min(200.0, std::max(60.0, bpmDistribution(m_random))));
+        trackQuery.addBindValue(KeyUtils::keyToString(
+                static_cast<mixxx::track::io::key::ChromaticKey>(keyId)));
+        trackQuery.addBindValue(keyId);
+        trackQuery.addBindValue(lossless ? "flac" : "mp3");
+        const int timesPlayed = pickZipf(&m_random, 50);
+        trackQuery.addBindValue(timesPlayed);
+        trackQuery.addBindValue(timesPlayed > 0 ? 1 : 0);
+        trackQuery.addBindValue(pickUniform(&m_random, 0, 5));
+        if (!trackQuery.exec()) {
+            LOG_FAILED_QUERY(trackQuery);
+            return;
+        }
+        m_trackIds.append(TrackId(trackQuery.lastInsertId()));
+    }
+}
+
+QList<TrackId> SyntheticLibrary::pickTracks(int count) {
+    QSet<TrackId> picked;
+    QList<TrackId> tracks;
+    count = std::min(count, m_trackIds.size());
+    while (tracks.size() < count) {
+        const TrackId trackId =
+                m_trackIds[pickUniform(&m_random, 0, m_trackIds.size() - 1)];
+        if (!picked.contains(trackId)) {
+            picked.insert(trackId);
+            tracks.append(trackId);
+        }
+    }
+    return tracks;
+}
+
+void SyntheticLibrary::generateCrates(int numCrates) {
+    QSqlQuery crateQuery(dbConnection());
+    crateQuery.prepare("INSERT INTO crates (name) VALUES (?)");
+    QSqlQuery crateTrackQuery(dbConnection());
+    crateTrackQuery.prepare(
+            "INSERT INTO crate_tracks (crate_id, track_id) VALUES (?, ?)");
+    for (int i = 0; i < numCrates; ++i) {
+        crateQuery.addBindValue(QString("%1 %2").arg(
+                phrase(&m_random, 1, 3), QString::number(i)));
+        if (!crateQuery.exec()) {
+            LOG_FAILED_QUERY(crateQuery);
+            return;
+        }
+        const QVariant crateId = crateQuery.lastInsertId();
+        // Mostly small crates, a few with 1000 tracks
+        for (const auto& trackId : pickTracks(10 + pickZipf(&m_random, 990))) {
+            crateTrackQuery.addBindValue(crateId);
+            crateTrackQuery.addBindValue(trackId.toVariant());
+            if (!crateTrackQuery.exec()) {
+                LOG_FAILED_QUERY(crateTrackQuery);
+                return;
+            }
+        }
+    }
+}
+
+void SyntheticLibrary::generatePlaylists(int numPlaylists) {
+    QSqlQuery playlistQuery(dbConnection());
+    playlistQuery.prepare("INSERT INTO Playlists "
+            "(name, position, hidden, date_created, date_modified) "
+            "VALUES (?, ?, ?, CURRENT_TIMESTAMP, CURRENT_TIMESTAMP)");
+    QSqlQuery playlistTrackQuery(dbConnection());
+    playlistTrackQuery.prepare("INSERT INTO PlaylistTracks "
+            "(playlist_id, track_id, position) VALUES (?, ?, ?)");
+    for (int i = 0; i < numPlaylists; ++i) {
+        playlistQuery.addBindValue(QString("%1 %2").arg(
+                phrase(&m_random, 1, 3), QString::number(i)));
+        playlistQuery.addBindValue(i + 1);
+        // Most of them are the history of the sets that were played
+        playlistQuery.addBindValue(pickUniform(&m_random, 0, 2) == 0
+                ? PlaylistDAO::PLHT_NOT_HIDDEN : PlaylistDAO::PLHT_SET_LOG);
+        if (!playlistQuery.exec()) {
+            LOG_FAILED_QUERY(playlistQuery);
+            return;
+        }
+        const QVariant playlistId = playlistQuery.lastInsertId();
+        int position = 0;
+        for (const auto& trackId : pickTracks(10 + pickZipf(&m_random, 290))) {
+            playlistTrackQuery.addBindValue(playlistId);
+            playlistTrackQuery.addBindValue(trackId.toVariant());
+            playlistTrackQuery.addBindValue(++position);
+            if (!playlistTrackQuery.exec()) {
+                LOG_FAILED_QUERY(playlistTrackQuery);
+                return;
+            }
+        }
+    }
+}
+
+void SyntheticLibrary::createTrackCache() {
+    const QString tableName = "library_cache_view";
+    QStringList columns;
+    columns << LIBRARYTABLE_ID
+            << LIBRARYTABLE_PLAYED
+            << LIBRARYTABLE_TIMESPLAYED
+            << LIBRARYTABLE_ALBUMARTIST
+            << LIBRARYTABLE_ALBUM
+            << LIBRARYTABLE_ARTIST
+            << LIBRARYTABLE_TITLE
+            << LIBRARYTABLE_YEAR
+            << LIBRARYTABLE_RATING
+            << LIBRARYTABLE_GENRE
+            << LIBRARYTABLE_COMPOSER
+            << LIBRARYTABLE_GROUPING
+            << LIBRARYTABLE_TRACKNUMBER
+            << LIBRARYTABLE_KEY
+            << LIBRARYTABLE_KEY_ID
+            << LIBRARYTABLE_BPM
+            << LIBRARYTABLE_BPM_LOCK
+            << LIBRARYTABLE_DURATION
+            << LIBRARYTABLE_BITRATE
+            << LIBRARYTABLE_REPLAYGAIN
+            << LIBRARYTABLE_FILETYPE
+            << LIBRARYTABLE_DATETIMEADDED
+            << "location"
+            << "fs_deleted"
+            << LIBRARYTABLE_COMMENT
+            << LIBRARYTABLE_MIXXXDELETED
+            << LIBRARYTABLE_COVERART_SOURCE
+            << LIBRARYTABLE_COVERART_TYPE
+            << LIBRARYTABLE_COVERART_LOCATION
+            << LIBRARYTABLE_COVERART_HASH;
+    QStringList qualifiedColumns;
+    for (const auto& column : columns) {
+        qualifiedColumns << (column == "location" || column == "fs_deleted"
+                ? "track_locations." : "library.") + column;
+    }
+    QSqlQuery query(dbConnection());
+    if (!query.exec(QString(
+            "CREATE TEMPORARY VIEW IF NOT EXISTS %1 AS "
+            "SELECT %2 FROM library "
+            "INNER JOIN track_locations ON library.location = track_locations.id")
+                    .arg(tableName, qualifiedColumns.join(",")))) {
+        LOG_FAILED_QUERY(query);
+    }
+    m_pTrackCache = std::make_unique<BaseTrackCache>(
+            collection(), tableName, LIBRARYTABLE_ID, columns, true);
+    m_pTrackCache->buildIndex();
+}
+
+std::unique_ptr<SyntheticLibrary> s_pSyntheticLibrary;
+
+void destroySyntheticLibrary() {
+    s_pSyntheticLibrary.reset();
+}
+
+SyntheticLibrary* syntheticLibrary(int numTracks) {
+    if (s_pSyntheticLibrary && s_pSyntheticLibrary->numTracks() == numTracks) {
+        return s_pSyntheticLibrary.get();
+    }
+    if (!s_pSyntheticLibrary) {
+        // Destroyed with the application, whose database connections
+        // don't outlive it
+        qAddPostRoutine(destroySyntheticLibrary);
+    }
+    // There is only one TrackCache
+    s_pSyntheticLibrary.reset();
+    s_pSyntheticLibrary = std::make_unique<SyntheticLibrary>(numTracks);
+    return s_pSyntheticLibrary.get();
+}
+
+static void LibrarySizes(benchmark::internal::Benchmark* b) {
+    for (int size : kLibrarySizes) {
+        b->Arg(size);
+    }
+}
+
+// The queries of the search box. The terms %1 and %2 are replaced by
+// different words in each iteration, because the results of the recent
+// text filters are kept.
+struct SearchCase {
+    const char* query;
+    const char* sortColumn;
+    Qt::SortOrder sortOrder;
+};
+
+const SearchCase kSearchCases[] = {
+    {"", "artist", Qt::AscendingOrder},
+    {"%1", "artist", Qt::AscendingOrder},
+    {"%1 %2", "title", Qt::AscendingOrder},
+    {"artist:%1 bpm:>120", "bpm", Qt::DescendingOrder},
+    {"bpm:120-130 key:8A", "bpm", Qt::AscendingOrder},
+    {"genre:house year:>2010 -%1", "year", Qt::DescendingOrder},
+    {"~key:8A ~bpm:124", "key", Qt::AscendingOrder},
+};
+const int kSearchCaseCount = sizeof(kSearchCases) / sizeof(kSearchCases[0]);
+
+QString searchQuery(const SearchCase& searchCase, int iteration) {
+    QString query(searchCase.query);
+    if (query.contains("%2")) {
+        return query.arg(kWords[iteration % kWordCount],
+                kWords[(iteration / kWordCount + 1) % kWordCount]);
+    }
+    if (query.contains("%1")) {
+        return query.arg(kWords[iteration % kWordCount]);
+    }
+    return query;
+}
+
+static void LibrarySizesAndSearchCases(benchmark::internal::Benchmark* b) {
+    for (int size : kLibrarySizes) {
+        for (int searchCase = 0; searchCase < kSearchCaseCount; ++searchCase) {
+            b->ArgPair(size, searchCase);
+        }
+    }
+}
+
+static void BM_BaseTrackCacheBuildIndex(benchmark::State& state) {
+    SyntheticLibrary* pLibrary = syntheticLibrary(state.range_x());
+    BaseTrackCache* pTrackCache = pLibrary->trackCache();
+    while (state.KeepRunning()) {
+        pTrackCache->buildIndex();
+    }
+    state.SetItemsProcessed(state.iterations() * pLibrary->numTracks());
+}
+BENCHMARK(BM_BaseTrackCacheBuildIndex)->Apply(LibrarySizes);
+
+static void BM_BaseTrackCacheFilterAndSort(benchmark::State& state) {
+    SyntheticLibrary* pLibrary = syntheticLibrary(state.range_x());
+    BaseTrackCache* pTrackCache = pLibrary->trackCache();
+    const SearchCase& searchCase = kSearchCases[state.range_y()];
+    const QList<SortColumn> sortColumns{SortColumn(
+            pTrackCache->fieldIndex(searchCase.sortColumn), searchCase.sortOrder)};
+    const QString orderBy = QString("ORDER BY %1 %2").arg(
+            searchCase.sortColumn,
+            searchCase.sortOrder == Qt::AscendingOrder ? "ASC" : "DESC");
+    QHash<TrackId, int> trackToIndex;
+    int iteration = 0;
+    while (state.KeepRunning()) {
+        trackToIndex.clear();
+        pTrackCache->filterAndSort(pLibrary->trackIdSet(),
+                searchQuery(searchCase, iteration++), QString(), orderBy,
+                sortColumns, 0, &trackToIndex);
+    }
+    state.SetItemsProcessed(state.iterations() * pLibrary->numTracks());
+    state.SetLabel(searchCase.query);
+}
+BENCHMARK(BM_BaseTrackCacheFilterAndSort)->Apply(LibrarySizesAndSearchCases);
+
+static void BM_SearchQueryParserParse(benchmark::State& state) {
+    // The queries are only translated to SQL, which does not depend on
+    // the size of the library
+    SyntheticLibrary* pLibrary = syntheticLibrary(kLibrarySizes[0]);
+    SearchQueryParser parser(pLibrary->collection());
+    const SearchCase& searchCase = kSearchCases[state.range_x()];
+    const QStringList searchColumns{"artist", "album", "album_artist",
+            "location", "grouping", "comment", "title", "genre"};
+    int iteration = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(parser.parseQuery(
+                searchQuery(searchCase, iteration++), searchColumns,
+                "mixxx_deleted=0")->toSql());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(searchCase.query);
+}
+BENCHMARK(BM_SearchQueryParserParse)->DenseRange(0, kSearchCaseCount - 1);
+
+// Appends the tracks to a new playlist, like dropping them on a playlist
+static void BM_PlaylistDAOAppendTracks(benchmark::State& state) {
+    SyntheticLibrary* pLibrary = syntheticLibrary(state.range_x());
+    PlaylistDAO& playlistDao = pLibrary->collection()->getPlaylistDAO();
+    const int numTracks = state.range_y();
+    const QList<TrackId> trackIds = pLibrary->trackIds().mid(
+            pLibrary->numTracks() / 2, numTracks);
+    int iteration = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        const int playlistId = playlistDao.createPlaylist(
+                QString("Benchmark %1").arg(iteration++));
+        state.ResumeTiming();
+        playlistDao.appendTracksToPlaylist(trackIds, playlistId);
+        state.PauseTiming();
+        playlistDao.deletePlaylist(playlistId);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * numTracks);
+}
+BENCHMARK(BM_PlaylistDAOAppendTracks)
+        ->ArgPair(kLibrarySizes[0], 100)->ArgPair(kLibrarySizes[0], 5000)
+        ->ArgPair(kLibrarySizes[1], 100)->ArgPair(kLibrarySizes[1], 5000)
+        ->ArgPair(kLibrarySizes[2], 100)->ArgPair(kLibrarySizes[2], 5000);
+
+// Inserts the tracks into the middle of a playlist of 1000 tracks, which
+// moves the tracks after them
+static void BM_PlaylistDAOInsertTracks(benchmark::State& state) {
+    SyntheticLibrary* pLibrary = syntheticLibrary(state.range_x());
+    PlaylistDAO& playlistDao = pLibrary->collection()->getPlaylistDAO();
+    const int numTracks = state.range_y();
+    const QList<TrackId> playlistTrackIds = pLibrary->trackIds().mid(0, 1000);
+    const QList<TrackId> trackIds = pLibrary->trackIds().mid(
+            pLibrary->numTracks() / 2, numTracks);
+    int iteration = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        const int playlistId = playlistDao.createPlaylist(
+                QString("Benchmark %1").arg(iteration++));
+        playlistDao.appendTracksToPlaylist(playlistTrackIds, playlistId);
+        state.ResumeTiming();
+        playlistDao.insertTracksIntoPlaylist(trackIds, playlistId, 500);
+        state.PauseTiming();
+        playlistDao.deletePlaylist(playlistId);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * numTracks);
+}
+BENCHMARK(BM_PlaylistDAOInsertTracks)
+        ->ArgPair(kLibrarySizes[0], 100)->ArgPair(kLibrarySizes[0], 5000)
+        ->ArgPair(kLibrarySizes[1], 100)->ArgPair(kLibrarySizes[1], 5000)
+        ->ArgPair(kLibrarySizes[2], 100)->ArgPair(kLibrarySizes[2], 5000);
+
+// Reads the summaries of all crates, like the crate sidebar
+static void BM_CrateStorageSelectCrateSummaries(benchmark::State& state) {
+    SyntheticLibrary* pLibrary = syntheticLibrary(state.range_x());
+    const CrateStorage& crates = pLibrary->collection()->crates();
+    int numCrates = 0;
+    while (state.KeepRunning()) {
+        CrateSummarySelectResult summaries(crates.selectCrateSummaries());
+        CrateSummary summary;
+        numCrates = 0;
+        while (summaries.populateNext(&summary)) {
+            ++numCrates;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numCrates);
+}
+BENCHMARK(BM_CrateStorageSelectCrateSummaries)->Apply(LibrarySizes);
+
+// Imports batches of new tracks in one transaction like the library
+// scanner. The imported tracks stay in the library, so this is registered
+// last.
+static void BM_TrackDAOBulkImport(benchmark::State& state) {
+    SyntheticLibrary* pLibrary = syntheticLibrary(state.range_x());
+    TrackDAO& trackDao = pLibrary->collection()->getTrackDAO();
+    const int numTracks = state.range_y();
+    int iteration = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        QList<TrackPointer> tracks;
+        tracks.reserve(numTracks);
+        for (int i = 0; i < numTracks; ++i) {
+            TrackPointer pTrack = Track::newTemporary(QFileInfo(
+                    QString("/import/%1/%2.mp3").arg(
+                            QString::number(iteration), QString::number(i))));
+            pTrack->setArtist(artistName(pickZipf(pLibrary->random(), 1000)));
+            pTrack->setTitle(phrase(pLibrary->random(), 1, 5));
+            pTrack->setGenre(kGenres[pickZipf(pLibrary->random(), kGenreCount)]);
+            pTrack->setBpm(pickUniform(pLibrary->random(), 80, 170));
+            tracks.append(pTrack);
+        }
+        ++iteration;
+        state.ResumeTiming();
+        trackDao.addTracksPrepare(true);
+        trackDao.addTracksAddResolvedTracks(tracks, false);
+        trackDao.addTracksFinish();
+        state.PauseTiming();
+        tracks.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * numTracks);
+}
+BENCHMARK(BM_TrackDAOBulkImport)
+        ->ArgPair(kLibrarySizes[0], 1000)
+        ->ArgPair(kLibrarySizes[1], 1000)
+        ->ArgPair(kLibrarySizes[2], 1000);
+
+}  // namespace
@@ -0,0 +1,40 @@
+#include <QDir>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+#include "library/scanner/librarywatcher.h"
+
+namespace {
+
+TEST(LibraryWatcherTest, changesWhileNotWatched) {
+    QTemporaryDir dir;
+    ASSERT_TRUE(QDir(dir.path()).mkdir("unchanged"));
+    const QString unchangedPath = dir.path() + "/unchanged";
+    const QString removedPath = dir.path() + "/removed";
+
+    LibraryWatcher watcher(16);
+    watcher.watchDirectories(QStringList() << unchangedPath << removedPath,
+            QDateTime::currentDateTime().addDays(1));
+    EXPECT_TRUE(watcher.isComplete());
+    EXPECT_EQ(QSet<QString>() << removedPath,
+            watcher.takeChangedDirectories());
+    EXPECT_TRUE(watcher.takeChangedDirectories().isEmpty());
+
+    // Directories that are already watched are not checked again
+    const QString modifiedPath = dir.path();
+    watcher.watchDirectories(QStringList() << unchangedPath << modifiedPath,
+            QDateTime::currentDateTime().addDays(-1));
+    EXPECT_EQ(QSet<QString>() << modifiedPath,
+            watcher.takeChangedDirectories());
+}
+
+TEST(LibraryWatcherTest, tooManyDirectories) {
+    QTemporaryDir dir;
+    LibraryWatcher watcher(1);
+    watcher.watchDirectories(QStringList() << dir.path() << dir.path() + "/x",
+            QDateTime());
+    EXPECT_FALSE(watcher.isComplete());
+}
+
+} // anonymous namespace
@@ -2,18 +2,51 @@
 
 #include "mixxxtest.h"
 #include "util/console.h"
+#include "util/realtimesafety.h"
 #include "errordialoghandler.h"
 
+namespace {
+
+// Fails the tests that block the audio callback thread, for
+// --realtimeSafety, e.g. with the engine tests
+//   mixxx-test --realtimeSafety --gtest_filter=EngineBufferTest*:EngineMasterTest*:SignalPathTest*
+class RealtimeSafetyListener : public testing::EmptyTestEventListener {
+  public:
+    RealtimeSafetyListener()
+            : m_countAtStart(0) {
+    }
+
+    void OnTestStart(const testing::TestInfo& testInfo) override {
+        Q_UNUSED(testInfo);
+        m_countAtStart = RealtimeSafety::totalCount();
+    }
+
+    void OnTestEnd(const testing::TestInfo& testInfo) override {
+        Q_UNUSED(testInfo);
+        const qint64 violations = RealtimeSafety::totalCount() - m_countAtStart;
+        EXPECT_EQ(0, violations)
+                << "real-time safety violations on the audio callback thread,"
+                << " see the log for their stack traces";
+    }
+
+  private:
+    qint64 m_countAtStart;
+};
+
+} // anonymous namespace
+
 int main(int argc, char **argv) {
     Console console;
     // We never want to popup error dialogs when running tests.
     ErrorDialogHandler::setEnabled(false);
 
     bool run_benchmarks = false;
+    bool realtimeSafety = false;
     for (int i = 0; i < argc; ++i) {
         if (strcmp(argv[i], "--benchmark") == 0) {
             run_benchmarks = true;
-            break;
+        } else if (strcmp(argv[i], "--realtimeSafety") == 0) {
+            realtimeSafety = true;
         }
     }
 
@@ -21,6 +54,11 @@ int main(int argc, char **argv) {
         benchmark::Initialize(&argc, argv);
     } else {
         testing::InitGoogleTest(&argc, argv);
+        if (realtimeSafety) {
+            RealtimeSafety::setEnabled(true);
+            testing::UnitTest::GetInstance()->listeners().Append(
+                    new RealtimeSafetyListener);
+        }
     }
 
     // Otherwise, run the test suite:
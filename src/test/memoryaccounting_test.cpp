@@ -0,0 +1,26 @@
+#include <gtest/gtest.h>
+
+#include "util/memoryaccounting.h"
+
+namespace {
+
+const MemoryAccounting::Category kCategory =
+        MemoryAccounting::Category::SkinPixmaps;
+
+TEST(MemoryAccountingTest, AccountFollowsLifetime) {
+    const qint64 initialBytes = MemoryAccounting::bytes(kCategory);
+    {
+        MemoryAccount account(kCategory, 100);
+        EXPECT_EQ(initialBytes + 100, MemoryAccounting::bytes(kCategory));
+        account.setBytes(40);
+        EXPECT_EQ(initialBytes + 40, MemoryAccounting::bytes(kCategory));
+
+        MemoryAccount copy(account);
+        EXPECT_EQ(initialBytes + 80, MemoryAccounting::bytes(kCategory));
+        copy = MemoryAccount(kCategory, 10);
+        EXPECT_EQ(initialBytes + 50, MemoryAccounting::bytes(kCategory));
+    }
+    EXPECT_EQ(initialBytes, MemoryAccounting::bytes(kCategory));
+}
+
+} // anonymous namespace
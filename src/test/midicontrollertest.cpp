@@ -1,4 +1,5 @@
 #include <QScopedPointer>
+#include <QThread>
 
 #include <gmock/gmock.h>
 
@@ -17,9 +18,9 @@ class MockMidiController : public MidiController {
 
     MOCK_METHOD0(open, int());
     MOCK_METHOD0(close, int());
-    MOCK_METHOD3(sendShortMsg, void(unsigned char status,
-                                    unsigned char byte1,
-                                    unsigned char byte2));
+    MOCK_METHOD3(sendShortMsgNow, void(unsigned char status,
+                                       unsigned char byte1,
+                                       unsigned char byte2));
     MOCK_METHOD1(send, void(QByteArray data));
     MOCK_CONST_METHOD0(isPolling, bool());
 };
@@ -523,3 +524,48 @@ TEST_F(MidiControllerTest, ReceiveMessage_PotMeterCO_14BitPitchBend) {
     receive(MIDI_PITCH_BEND | channel, 0x01, 0x40);
     EXPECT_LT(kMiddleValue, potmeter.get());
 }
+
+TEST_F(MidiControllerTest, ReceiveMessage_SeveralMappingsOfOneMessage) {
+    ConfigKey key1("[Channel1]", "hotcue_1_activate");
+    ConfigKey key2("[Channel2]", "hotcue_1_activate");
+    ControlPushButton cpb1(key1);
+    ControlPushButton cpb2(key2);
+
+    unsigned char channel = 0x01;
+    unsigned char control = 0x10;
+
+    addMapping(MidiInputMapping(MidiKey(MIDI_NOTE_ON | channel, control),
+                                MidiOptions(), key1));
+    addMapping(MidiInputMapping(MidiKey(MIDI_NOTE_ON | channel, control),
+                                MidiOptions(), key2));
+    loadPreset(m_preset);
+
+    receive(MIDI_NOTE_ON | channel, control, 0x7F);
+    EXPECT_LT(0.0, cpb1.get());
+    EXPECT_LT(0.0, cpb2.get());
+    // Other channels and controls are not mapped
+    receive(MIDI_NOTE_ON | channel, control, 0x00);
+    receive(MIDI_NOTE_ON | (channel + 1), control, 0x7F);
+    receive(MIDI_NOTE_ON | channel, control + 1, 0x7F);
+    EXPECT_DOUBLE_EQ(0.0, cpb1.get());
+    EXPECT_DOUBLE_EQ(0.0, cpb2.get());
+}
+
+TEST_F(MidiControllerTest, SendShortMsg_Coalesced) {
+    unsigned char channel = 0x01;
+    unsigned char control = 0x10;
+    EXPECT_CALL(*m_pController, sendShortMsgNow(MIDI_NOTE_ON | channel, control, 0x7F))
+            .Times(1);
+    EXPECT_CALL(*m_pController, sendShortMsgNow(MIDI_NOTE_OFF | channel, control, 0x00))
+            .Times(1);
+
+    // The first message is sent right away, the same value is dropped
+    m_pController->sendShortMsg(MIDI_NOTE_ON | channel, control, 0x7F);
+    m_pController->sendShortMsg(MIDI_NOTE_ON | channel, control, 0x7F);
+    // Only the last value of the note is sent with the next frame
+    m_pController->sendShortMsg(MIDI_NOTE_ON | channel, control, 0x40);
+    m_pController->sendShortMsg(MIDI_NOTE_OFF | channel, control, 0x00);
+
+    QThread::msleep(2 * 1000 / MidiOutputScheduler::kDefaultFramesPerSecond);
+    application()->processEvents();
+}
@@ -0,0 +1,89 @@
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "test/mixxxtest.h"
+
+#include "sources/mp3seekframecache.h"
+
+namespace {
+
+using mixxx::Mp3SeekFrameCache;
+
+class Mp3SeekFrameCacheTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_cacheDir.isValid());
+        ASSERT_TRUE(m_fileDir.isValid());
+        m_filePath = m_fileDir.filePath("mix.mp3");
+        writeFile(QByteArray(100000, 'x'));
+        Mp3SeekFrameCache::setDirectory(m_cacheDir.path());
+    }
+
+    void TearDown() override {
+        Mp3SeekFrameCache::setDirectory(QString());
+    }
+
+    void writeFile(const QByteArray& data) {
+        QFile file(m_filePath);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(data.size(), file.write(data));
+    }
+
+    static Mp3SeekFrameCache::Entry makeEntry(SINT seekFrameCount) {
+        Mp3SeekFrameCache::Entry entry;
+        entry.sampleRate = 44100;
+        entry.streamChannelCount = 2;
+        entry.bitrate = 320;
+        for (SINT i = 0; i < seekFrameCount; ++i) {
+            Mp3SeekFrameCache::SeekFrame seekFrame;
+            seekFrame.frameIndex = i * 1152;
+            seekFrame.byteOffset = i * 4;
+            entry.seekFrames.push_back(seekFrame);
+        }
+        entry.frameIndexMax = seekFrameCount * 1152;
+        return entry;
+    }
+
+    QTemporaryDir m_cacheDir;
+    QTemporaryDir m_fileDir;
+    QString m_filePath;
+};
+
+TEST_F(Mp3SeekFrameCacheTest, StoreAndLoad) {
+    Mp3SeekFrameCache::Entry loaded;
+    EXPECT_FALSE(Mp3SeekFrameCache::load(QFileInfo(m_filePath), &loaded));
+
+    const auto entry = makeEntry(Mp3SeekFrameCache::kMinSeekFrameCount);
+    Mp3SeekFrameCache::store(QFileInfo(m_filePath), entry);
+    ASSERT_TRUE(Mp3SeekFrameCache::load(QFileInfo(m_filePath), &loaded));
+    EXPECT_EQ(entry.sampleRate, loaded.sampleRate);
+    EXPECT_EQ(entry.streamChannelCount, loaded.streamChannelCount);
+    EXPECT_EQ(entry.bitrate, loaded.bitrate);
+    EXPECT_EQ(entry.frameIndexMax, loaded.frameIndexMax);
+    ASSERT_EQ(entry.seekFrames.size(), loaded.seekFrames.size());
+    for (size_t i = 0; i < entry.seekFrames.size(); ++i) {
+        EXPECT_EQ(entry.seekFrames[i].frameIndex, loaded.seekFrames[i].frameIndex);
+        EXPECT_EQ(entry.seekFrames[i].byteOffset, loaded.seekFrames[i].byteOffset);
+    }
+}
+
+TEST_F(Mp3SeekFrameCacheTest, ShortFilesAreOnlyKeptInMemory) {
+    Mp3SeekFrameCache::store(QFileInfo(m_filePath),
+            makeEntry(Mp3SeekFrameCache::kMinSeekFrameCount - 1));
+    Mp3SeekFrameCache::Entry loaded;
+    EXPECT_TRUE(Mp3SeekFrameCache::load(QFileInfo(m_filePath), &loaded));
+    EXPECT_EQ(Mp3SeekFrameCache::kMinSeekFrameCount - 1,
+            SINT(loaded.seekFrames.size()));
+    EXPECT_TRUE(QDir(m_cacheDir.path()).entryList(QDir::Files).isEmpty());
+}
+
+TEST_F(Mp3SeekFrameCacheTest, ModifiedFileIsNotLoaded) {
+    Mp3SeekFrameCache::store(QFileInfo(m_filePath),
+            makeEntry(Mp3SeekFrameCache::kMinSeekFrameCount));
+    writeFile(QByteArray(100001, 'x'));
+    Mp3SeekFrameCache::Entry loaded;
+    EXPECT_FALSE(Mp3SeekFrameCache::load(QFileInfo(m_filePath), &loaded));
+}
+
+} // anonymous namespace
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "engine/sidechain/networkjitterbuffer.h"
+
+namespace {
+
+const int kChannels = 2;
+const double kSampleRate = 44100;
+const int kPacketFrames = NetworkAudioPacket::kDefaultFrames;
+const SINT kReadFrames = kPacketFrames;
+
+qint64 packetTimeUs(int index) {
+    return static_cast<qint64>(index * kPacketFrames * 1000000.0 / kSampleRate);
+}
+
+NetworkAudioPacket makePacket(int index, qint64 arrivalTimeUs) {
+    NetworkAudioPacket packet;
+    packet.sequence = index;
+    packet.timestampFrames = static_cast<qint64>(index) * kPacketFrames;
+    packet.sampleRate = static_cast<quint32>(kSampleRate);
+    packet.channels = kChannels;
+    packet.frames = kPacketFrames;
+    packet.arrivalTimeUs = arrivalTimeUs;
+    for (int i = 0; i < kPacketFrames * kChannels; ++i) {
+        packet.samples[i] = 1.0f;
+    }
+    return packet;
+}
+
+class NetworkJitterBufferTest : public testing::Test {
+  protected:
+    NetworkJitterBufferTest()
+            : m_jitterBuffer(kChannels, kReadFrames),
+              m_output(kReadFrames * kChannels) {
+        m_jitterBuffer.reset(kSampleRate);
+        m_jitterBuffer.setMaxLatencyFrames(8 * kPacketFrames);
+    }
+
+    // Returns the number of silent frames
+    int read() {
+        m_jitterBuffer.read(m_output.data(), kReadFrames);
+        int silentFrames = 0;
+        for (SINT i = 0; i < kReadFrames; ++i) {
+            if (m_output[i * kChannels] == 0.0f) {
+                ++silentFrames;
+            }
+        }
+        return silentFrames;
+    }
+
+    NetworkJitterBuffer m_jitterBuffer;
+    std::vector<CSAMPLE> m_output;
+};
+
+TEST(NetworkAudioPacketTest, serialize) {
+    NetworkAudioPacket packet = makePacket(3, 0);
+    for (int i = 0; i < kPacketFrames * kChannels; ++i) {
+        packet.samples[i] = i * 0.01f - 0.5f;
+    }
+    const int size = NetworkAudioPacket::serializedSize(kPacketFrames, kChannels);
+    std::vector<char> datagram(size);
+    ASSERT_EQ(size, packet.serialize(datagram.data()));
+
+    NetworkAudioPacket received;
+    ASSERT_TRUE(received.deserialize(datagram.data(), size));
+    EXPECT_EQ(packet.sequence, received.sequence);
+    EXPECT_EQ(packet.timestampFrames, received.timestampFrames);
+    EXPECT_EQ(packet.sampleRate, received.sampleRate);
+    EXPECT_EQ(kChannels, received.channels);
+    EXPECT_EQ(kPacketFrames, received.frames);
+    for (int i = 0; i < kPacketFrames * kChannels; ++i) {
+        EXPECT_EQ(packet.samples[i], received.samples[i]);
+    }
+
+    EXPECT_FALSE(received.deserialize(datagram.data(), size - 1));
+    datagram[0] = 'x';
+    EXPECT_FALSE(received.deserialize(datagram.data(), size));
+}
+
+TEST_F(NetworkJitterBufferTest, silenceUntilBuffered) {
+    EXPECT_EQ(kReadFrames, read());
+    EXPECT_FALSE(m_jitterBuffer.isPlaying());
+
+    // One packet for the read and one for the packet size
+    m_jitterBuffer.insert(makePacket(0, packetTimeUs(0)));
+    EXPECT_EQ(kReadFrames, read());
+    EXPECT_FALSE(m_jitterBuffer.isPlaying());
+
+    m_jitterBuffer.insert(makePacket(1, packetTimeUs(1)));
+    EXPECT_EQ(2 * kPacketFrames, m_jitterBuffer.targetFrames());
+    EXPECT_EQ(0, read());
+    EXPECT_TRUE(m_jitterBuffer.isPlaying());
+}
+
+TEST_F(NetworkJitterBufferTest, reorderAndConcealLoss) {
+    // Every second packet is delayed until the next one has arrived
+    m_jitterBuffer.insert(makePacket(0, packetTimeUs(0)));
+    read();
+    int silentFrames = 0;
+    for (int index = 1; index < 40; index += 2) {
+        if (index != 9) {
+            m_jitterBuffer.insert(makePacket(index + 1, packetTimeUs(index + 1)));
+            m_jitterBuffer.insert(makePacket(index, packetTimeUs(index + 1)));
+        } else {
+            // Lost
+            m_jitterBuffer.insert(makePacket(index + 1, packetTimeUs(index + 1)));
+        }
+        if (m_jitterBuffer.isPlaying()) {
+            silentFrames += read() + read();
+        } else {
+            read();
+            read();
+        }
+    }
+    EXPECT_TRUE(m_jitterBuffer.isPlaying());
+    // The delay of a packet is buffered
+    EXPECT_EQ(3 * kPacketFrames, m_jitterBuffer.targetFrames());
+    EXPECT_EQ(1, m_jitterBuffer.lostPackets());
+    EXPECT_EQ(0, m_jitterBuffer.latePackets());
+    EXPECT_EQ(0, m_jitterBuffer.underflows());
+    EXPECT_NEAR(kPacketFrames, silentFrames, 4);
+}
+
+TEST_F(NetworkJitterBufferTest, underflow) {
+    for (int index = 0; index < 10; ++index) {
+        m_jitterBuffer.insert(makePacket(index, packetTimeUs(index)));
+        read();
+    }
+    EXPECT_TRUE(m_jitterBuffer.isPlaying());
+    // The sender stops
+    for (int i = 0; i < 4; ++i) {
+        read();
+    }
+    EXPECT_FALSE(m_jitterBuffer.isPlaying());
+    EXPECT_EQ(1, m_jitterBuffer.underflows());
+    EXPECT_EQ(kReadFrames, read());
+}
+
+} // anonymous namespace
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include "library/parserm3u.h"
+
+namespace {
+
+void createFile(const QString& filePath) {
+    QFile file(filePath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+}
+
+TEST(ParserM3uTest, ResolveLocations) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const QDir dir(tempDir.path());
+    ASSERT_TRUE(dir.mkdir("music"));
+
+    // More locations than are checked by a single task
+    QStringList expected;
+    QFile playlist(dir.filePath("playlist.m3u"));
+    ASSERT_TRUE(playlist.open(QIODevice::WriteOnly | QIODevice::Text));
+    QTextStream out(&playlist);
+    out << "#EXTM3U\n";
+    for (int i = 0; i < 200; ++i) {
+        const QString fileName = QString("music/%1.mp3").arg(i);
+        out << "#EXTINF\n";
+        if (i % 3 == 0) {
+            // Missing
+            out << fileName << "\n";
+            continue;
+        }
+        createFile(dir.filePath(fileName));
+        if (i % 3 == 1) {
+            out << dir.filePath(fileName) << "\n";
+        } else {
+            out << fileName << "\n";
+        }
+        expected.append(dir.filePath(fileName));
+    }
+    out.flush();
+    playlist.close();
+
+    const QList<QString> locations = ParserM3u().parse(playlist.fileName());
+    EXPECT_EQ(expected, QStringList(locations));
+}
+
+} // anonymous namespace
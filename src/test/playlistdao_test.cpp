@@ -0,0 +1,122 @@
+#include <QSqlQuery>
+
+#include "test/librarytest.h"
+
+#include "library/dao/playlistdao.h"
+
+namespace {
+
+class PlaylistDAOTest : public LibraryTest {
+  protected:
+    PlaylistDAOTest()
+            : m_playlistDao(collection()->getPlaylistDAO()),
+              m_playlistId(m_playlistDao.createPlaylist("test")) {
+    }
+
+    static QList<TrackId> trackIds(int first, int last) {
+        QList<TrackId> trackIds;
+        for (int i = first; i <= last; ++i) {
+            trackIds.append(TrackId(i));
+        }
+        return trackIds;
+    }
+
+    // The track ids in the order of their positions, which must be
+    // contiguous
+    QList<TrackId> getTracksByPosition() const {
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT track_id, position FROM PlaylistTracks "
+                      "WHERE playlist_id=:id ORDER BY position");
+        query.bindValue(":id", m_playlistId);
+        EXPECT_TRUE(query.exec());
+        QList<TrackId> trackIds;
+        while (query.next()) {
+            trackIds.append(TrackId(query.value(0)));
+            EXPECT_EQ(trackIds.size(), query.value(1).toInt());
+        }
+        return trackIds;
+    }
+
+    // The track count and duration that are maintained by the triggers
+    QPair<int, double> getSummary() const {
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT track_count, track_duration FROM playlist_summaries "
+                      "WHERE playlist_id=:id");
+        query.bindValue(":id", m_playlistId);
+        EXPECT_TRUE(query.exec());
+        EXPECT_TRUE(query.next());
+        return qMakePair(query.value(0).toInt(), query.value(1).toDouble());
+    }
+
+    PlaylistDAO& m_playlistDao;
+    const int m_playlistId;
+};
+
+TEST_F(PlaylistDAOTest, insertTracks) {
+    ASSERT_TRUE(m_playlistDao.appendTracksToPlaylist(trackIds(1, 3), m_playlistId));
+    EXPECT_EQ(2, m_playlistDao.insertTracksIntoPlaylist(
+            QList<TrackId>() << TrackId(4) << TrackId() << TrackId(5),
+            m_playlistId, 2));
+    EXPECT_EQ(QList<TrackId>() << TrackId(1) << TrackId(4) << TrackId(5)
+            << TrackId(2) << TrackId(3), getTracksByPosition());
+    EXPECT_TRUE(m_playlistDao.isTrackInPlaylist(TrackId(4), m_playlistId));
+}
+
+TEST_F(PlaylistDAOTest, removeTracks) {
+    // More tracks than rows per statement
+    ASSERT_TRUE(m_playlistDao.appendTracksToPlaylist(trackIds(1, 1200), m_playlistId));
+    QList<int> positions;
+    for (int position = 2; position <= 1200; position += 2) {
+        positions.append(position);
+    }
+    m_playlistDao.removeTracksFromPlaylist(m_playlistId, positions);
+
+    QList<TrackId> remainingTrackIds;
+    for (int i = 1; i <= 1200; i += 2) {
+        remainingTrackIds.append(TrackId(i));
+    }
+    EXPECT_EQ(remainingTrackIds, getTracksByPosition());
+    EXPECT_FALSE(m_playlistDao.isTrackInPlaylist(TrackId(2), m_playlistId));
+}
+
+TEST_F(PlaylistDAOTest, shuffleTracks) {
+    ASSERT_TRUE(m_playlistDao.appendTracksToPlaylist(trackIds(1, 20), m_playlistId));
+    QList<int> positions;
+    QHash<int, TrackId> allIds;
+    for (int position = 1; position <= 20; ++position) {
+        positions.append(position);
+        allIds.insert(position, TrackId(position));
+    }
+    m_playlistDao.shuffleTracks(m_playlistId, positions, allIds);
+
+    QList<TrackId> shuffledTrackIds = getTracksByPosition();
+    qSort(shuffledTrackIds);
+    EXPECT_EQ(trackIds(1, 20), shuffledTrackIds);
+}
+
+TEST_F(PlaylistDAOTest, summary) {
+    QSqlQuery query(dbConnection());
+    for (int i = 1; i <= 3; ++i) {
+        ASSERT_TRUE(query.exec(QString(
+                "INSERT INTO library (id, duration, mixxx_deleted) "
+                "VALUES (%1, %2, 0)").arg(i).arg(i * 100)));
+    }
+    EXPECT_EQ(qMakePair(0, 0.0), getSummary());
+
+    ASSERT_TRUE(m_playlistDao.appendTracksToPlaylist(
+            trackIds(1, 3) << TrackId(3), m_playlistId));
+    EXPECT_EQ(qMakePair(4, 900.0), getSummary());
+
+    // Hidden tracks are not counted
+    ASSERT_TRUE(query.exec("UPDATE library SET mixxx_deleted=1 WHERE id=3"));
+    EXPECT_EQ(qMakePair(2, 300.0), getSummary());
+    ASSERT_TRUE(query.exec("UPDATE library SET mixxx_deleted=0, duration=50 WHERE id=3"));
+    EXPECT_EQ(qMakePair(4, 400.0), getSummary());
+
+    m_playlistDao.removeTrackFromPlaylist(m_playlistId, TrackId(3));
+    EXPECT_EQ(qMakePair(2, 300.0), getSummary());
+    ASSERT_TRUE(query.exec("DELETE FROM library WHERE id=1"));
+    EXPECT_EQ(qMakePair(1, 200.0), getSummary());
+}
+
+} // anonymous namespace
@@ -25,8 +25,8 @@ class MockPortMidiController : public PortMidiController {
     ~MockPortMidiController() override {
     }
 
-    void sendShortMsg(unsigned char status, unsigned char byte1, unsigned char byte2) {
-        PortMidiController::sendShortMsg(status, byte1, byte2);
+    void sendShortMsgNow(unsigned char status, unsigned char byte1, unsigned char byte2) {
+        PortMidiController::sendShortMsgNow(status, byte1, byte2);
     }
 
     void sendSysexMsg(QList<int> data, unsigned int length) {
@@ -76,6 +76,7 @@ class PortMidiControllerTest : public MixxxTest {
                                                        0, 0));
         m_pController->setPortMidiInputDevice(m_mockInput);
         m_pController->setPortMidiOutputDevice(m_mockOutput);
+        m_pController->setInputThreadEnabled(false);
     }
 
     void openDevice() {
@@ -163,9 +164,9 @@ TEST_F(PortMidiControllerTest, WriteShort) {
             .InSequence(output)
             .WillOnce(Return(pmNoError));
 
-    m_pController->sendShortMsg(0x90, 0x3C, 0x40);
-    m_pController->sendShortMsg(0xFF, 0xFF, 0xFF);
-    m_pController->sendShortMsg(0x80, 0x3C, 0x40);
+    m_pController->sendShortMsgNow(0x90, 0x3C, 0x40);
+    m_pController->sendShortMsgNow(0xFF, 0xFF, 0xFF);
+    m_pController->sendShortMsgNow(0x80, 0x3C, 0x40);
 };
 
 TEST_F(PortMidiControllerTest, WriteSysex) {
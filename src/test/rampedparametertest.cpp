@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "util/rampedparameter.h"
+
+namespace {
+
+const SINT kFrames = 8;
+
+TEST(RampedParameterTest, RampsToTarget) {
+    RampedParameter parameter(0, kFrames);
+    const CSAMPLE_GAIN* pFrames = parameter.ramp(1, kFrames);
+    EXPECT_TRUE(parameter.isRamping());
+    for (SINT i = 0; i < kFrames; ++i) {
+        EXPECT_FLOAT_EQ(static_cast<CSAMPLE_GAIN>(i + 1) / kFrames, pFrames[i]);
+    }
+    EXPECT_EQ(1, pFrames[kFrames - 1]);
+    EXPECT_EQ(1, parameter.value());
+}
+
+TEST(RampedParameterTest, ConstantAfterRamp) {
+    RampedParameter parameter(0, kFrames);
+    parameter.ramp(0.5, kFrames);
+    const CSAMPLE_GAIN* pFrames = parameter.ramp(0.5, kFrames);
+    EXPECT_FALSE(parameter.isRamping());
+    for (SINT i = 0; i < kFrames; ++i) {
+        EXPECT_EQ(0.5, pFrames[i]);
+    }
+}
+
+TEST(RampedParameterTest, ResetDoesNotRamp) {
+    RampedParameter parameter(1, kFrames);
+    parameter.reset(0);
+    const CSAMPLE_GAIN* pFrames = parameter.ramp(0, kFrames);
+    EXPECT_FALSE(parameter.isRamping());
+    for (SINT i = 0; i < kFrames; ++i) {
+        EXPECT_EQ(0, pFrames[i]);
+    }
+}
+
+TEST(RampedParameterTest, GrowsForLargerBuffers) {
+    RampedParameter parameter(0, kFrames);
+    const SINT kLargerFrames = kFrames * 4;
+    const CSAMPLE_GAIN* pFrames = parameter.ramp(1, kLargerFrames);
+    EXPECT_FLOAT_EQ(1.0f / kLargerFrames, pFrames[0]);
+    EXPECT_EQ(1, pFrames[kLargerFrames - 1]);
+}
+
+TEST(RampedParameterTest, CrossfadeStereo) {
+    CSAMPLE dry[kFrames * 2];
+    CSAMPLE output[kFrames * 2];
+    for (SINT i = 0; i < kFrames * 2; ++i) {
+        dry[i] = 1;
+        output[i] = -1;
+    }
+    RampedParameter wetGain(0, kFrames);
+    const CSAMPLE_GAIN* pWetGains = wetGain.ramp(1, kFrames);
+    RampedParameter::crossfadeStereo(output, dry, pWetGains, kFrames);
+    for (SINT i = 0; i < kFrames; ++i) {
+        const CSAMPLE expected = 1 - 2 * pWetGains[i];
+        EXPECT_FLOAT_EQ(expected, output[i * 2]);
+        EXPECT_FLOAT_EQ(expected, output[i * 2 + 1]);
+    }
+    EXPECT_FLOAT_EQ(-1, output[kFrames * 2 - 1]);
+}
+
+}  // namespace
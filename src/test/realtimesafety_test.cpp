@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "util/mutex.h"
+#include "util/realtimesafety.h"
+
+namespace {
+
+const RealtimeSafety::Violation kLock = RealtimeSafety::Violation::Lock;
+
+class RealtimeSafetyTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        // The violations of this test would fail it with --realtimeSafety
+        m_bSkip = RealtimeSafety::isEnabled();
+        RealtimeSafety::setEnabled(!m_bSkip);
+    }
+
+    void TearDown() override {
+        if (!m_bSkip) {
+            RealtimeSafety::setEnabled(false);
+        }
+    }
+
+    bool m_bSkip;
+};
+
+TEST_F(RealtimeSafetyTest, LockOnRealtimeThread) {
+    if (m_bSkip) {
+        return;
+    }
+    MMutex mutex;
+    const qint64 initialCount = RealtimeSafety::count(kLock);
+
+    // Not marked
+    EXPECT_FALSE(RealtimeSafety::isRealtimeThread());
+    mutex.lock();
+    mutex.unlock();
+    EXPECT_EQ(initialCount, RealtimeSafety::count(kLock));
+
+    {
+        RealtimeThreadScope realtimeThread;
+        EXPECT_TRUE(RealtimeSafety::isRealtimeThread());
+        // Does not block
+        ASSERT_TRUE(mutex.tryLock());
+        mutex.unlock();
+        EXPECT_EQ(initialCount, RealtimeSafety::count(kLock));
+
+        MMutexLocker locker(&mutex);
+        EXPECT_EQ(initialCount + 1, RealtimeSafety::count(kLock));
+    }
+    EXPECT_FALSE(RealtimeSafety::isRealtimeThread());
+}
+
+TEST_F(RealtimeSafetyTest, Disabled) {
+    if (m_bSkip) {
+        return;
+    }
+    RealtimeSafety::setEnabled(false);
+    MReadWriteLock lock;
+    const qint64 initialCount = RealtimeSafety::count(kLock);
+    RealtimeThreadScope realtimeThread;
+    lock.lockForWrite();
+    lock.unlock();
+    EXPECT_EQ(initialCount, RealtimeSafety::count(kLock));
+}
+
+} // anonymous namespace
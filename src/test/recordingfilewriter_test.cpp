@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "engine/sidechain/recordingfilewriter.h"
+
+namespace {
+
+QByteArray readFile(const QString& fileName) {
+    QFile file(fileName);
+    EXPECT_TRUE(file.open(QIODevice::ReadOnly));
+    return file.readAll();
+}
+
+TEST(RecordingFileWriterTest, writeAndUpdateHeader) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const QString fileName = QDir(tempDir.path()).filePath("recording.wav");
+    // More than one batch
+    const QByteArray body(3 * 1024 * 1024 + 17, 'b');
+    {
+        RecordingFileWriter writer;
+        ASSERT_TRUE(writer.open(fileName));
+        writer.write("HEAD", 4);
+        writer.write(body.constData(), body.size());
+        EXPECT_EQ(4 + body.size(), writer.size());
+        // Like the encoders that update the header when they are finished
+        writer.seek(0);
+        writer.write("head", 4);
+        EXPECT_EQ(4, writer.pos());
+        EXPECT_EQ(4 + body.size(), writer.size());
+        writer.close();
+        EXPECT_FALSE(writer.isOpen());
+    }
+    EXPECT_EQ(QByteArray("head") + body, readFile(fileName));
+}
+
+TEST(RecordingFileWriterTest, splitFiles) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const QString firstFileName = QDir(tempDir.path()).filePath("first.mp3");
+    const QString secondFileName = QDir(tempDir.path()).filePath("second.mp3");
+    {
+        RecordingFileWriter writer;
+        ASSERT_TRUE(writer.open(firstFileName));
+        writer.write("first", 5);
+        // Closes the first file in the background
+        ASSERT_TRUE(writer.open(secondFileName));
+        EXPECT_EQ(0, writer.size());
+        writer.write("second", 6);
+    }
+    EXPECT_EQ(QByteArray("first"), readFile(firstFileName));
+    EXPECT_EQ(QByteArray("second"), readFile(secondFileName));
+}
+
+} // anonymous namespace
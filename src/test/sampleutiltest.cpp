@@ -5,6 +5,9 @@
 #include <QList>
 #include <QPair>
 
+#include <cmath>
+#include <vector>
+
 #include "util/sample.h"
 #include "util/timer.h"
 
@@ -341,6 +344,28 @@ TEST_F(SampleUtilTest, sumAbsPerChannel) {
     }
 }
 
+TEST_F(SampleUtilTest, levelsPerChannel) {
+    for (int i = 0; i < evenBuffers.size(); ++i) {
+        int j = evenBuffers[i];
+        CSAMPLE* buffer = buffers[j];
+        int size = sizes[j];
+        FillBuffer(buffer, 1.0f, size);
+        SampleUtil::applyAlternatingGain(buffer, 1.0, -2.0, size);
+        SampleUtil::ChannelLevels left;
+        SampleUtil::ChannelLevels right;
+        SampleUtil::CLIP_STATUS clipping =
+                SampleUtil::levelsPerChannel(&left, &right, buffer, size);
+        EXPECT_FLOAT_EQ(size / 2, left.sumAbs);
+        EXPECT_FLOAT_EQ(size / 2, left.sumSquares);
+        EXPECT_FLOAT_EQ(1.0f, left.peak);
+        EXPECT_FLOAT_EQ(size, right.sumAbs);
+        EXPECT_FLOAT_EQ(2 * size, right.sumSquares);
+        EXPECT_FLOAT_EQ(2.0f, right.peak);
+        EXPECT_EQ(static_cast<int>(SampleUtil::CLIPPING_RIGHT),
+                static_cast<int>(clipping));
+    }
+}
+
 TEST_F(SampleUtilTest, interleaveBuffer) {
     for (int i = 0; i < buffers.size(); ++i) {
         CSAMPLE* buffer = buffers[i];
@@ -435,6 +460,170 @@ TEST_F(SampleUtilTest, copyReverse) {
     }
 }
 
+const SampleUtil::Kernel kAllKernels[] = {
+    SampleUtil::Kernel::Scalar,
+    SampleUtil::Kernel::SSE2,
+    SampleUtil::Kernel::AVX2,
+    SampleUtil::Kernel::NEON,
+};
+
+// Restores the kernel that has been selected at startup
+class ScopedKernel {
+  public:
+    explicit ScopedKernel(SampleUtil::Kernel kernel)
+            : m_previous(SampleUtil::activeKernel()),
+              m_selected(SampleUtil::setKernel(kernel)) {
+    }
+    ~ScopedKernel() {
+        SampleUtil::setKernel(m_previous);
+    }
+    bool selected() const {
+        return m_selected;
+    }
+
+  private:
+    const SampleUtil::Kernel m_previous;
+    const bool m_selected;
+};
+
+TEST_F(SampleUtilTest, scalarKernelIsAlwaysSupported) {
+    EXPECT_TRUE(SampleUtil::isKernelSupported(SampleUtil::Kernel::Scalar));
+    EXPECT_TRUE(SampleUtil::isKernelSupported(SampleUtil::activeKernel()));
+}
+
+TEST_F(SampleUtilTest, kernelsMatchScalarKernel) {
+    // Sizes that are not a multiple of any vector width exercise the
+    // scalar remainder loops of the kernels.
+    const int kSizes[] = { 0, 1, 2, 3, 7, 8, 15, 16, 17, 63, 64, 66, 1027 };
+    for (int size : kSizes) {
+        // Offset the buffers by one sample to test unaligned access
+        std::vector<CSAMPLE> src1(size + 1);
+        std::vector<CSAMPLE> src2(size + 1);
+        for (int j = 0; j <= size; ++j) {
+            // Includes out of range values for clamping and clip detection
+            src1[j] = 1.5f * std::sin(0.1f * j);
+            src2[j] = 0.5f * std::cos(0.3f * j);
+        }
+        const CSAMPLE* pSrc1 = &src1[1];
+        const CSAMPLE* pSrc2 = &src2[1];
+
+        std::vector<CSAMPLE> expected[6];
+        std::vector<SAMPLE> expectedS16;
+        CSAMPLE expectedAbsL = 0;
+        CSAMPLE expectedAbsR = 0;
+        CSAMPLE expectedMaxL = 0;
+        CSAMPLE expectedMaxR = 0;
+        SampleUtil::CLIP_STATUS expectedClipping;
+        SampleUtil::ChannelLevels expectedLevels[2];
+
+        for (const auto kernel : kAllKernels) {
+            ScopedKernel scopedKernel(kernel);
+            if (!scopedKernel.selected()) {
+                continue;
+            }
+            SCOPED_TRACE(SampleUtil::kernelName(kernel));
+
+            std::vector<CSAMPLE> results[6];
+            for (auto& result : results) {
+                result.assign(2 * size + 1, 0.0f);
+            }
+            std::copy(pSrc1, pSrc1 + size, results[0].begin() + 1);
+            SampleUtil::applyRampingGain(&results[0][1], 0.3f, 0.9f, size);
+            SampleUtil::copyWithRampingGain(&results[1][1], pSrc1,
+                    0.9f, 0.1f, size);
+            std::copy(pSrc2, pSrc2 + size, results[2].begin() + 1);
+            SampleUtil::addWithRampingGain(&results[2][1], pSrc1,
+                    0.2f, 0.7f, size);
+            SampleUtil::copyClampBuffer(&results[3][1], pSrc1, size);
+            SampleUtil::interleaveBuffer(&results[4][1], pSrc1, pSrc2, size);
+            SampleUtil::copyMonoToDualMono(&results[5][1], pSrc1, size);
+
+            // Only convert values in the valid range. Out of range values
+            // saturate with the vectorized kernels.
+            std::vector<SAMPLE> resultS16(size + 1);
+            SampleUtil::convertFloat32ToS16(&resultS16[1], pSrc2, size);
+
+            CSAMPLE absL = 0;
+            CSAMPLE absR = 0;
+            const SampleUtil::CLIP_STATUS clipping =
+                    SampleUtil::sumAbsPerChannel(&absL, &absR, pSrc1, size);
+
+            // Starts above some of the peaks
+            CSAMPLE maxL = 0.5f;
+            CSAMPLE maxR = 0.5f;
+            SampleUtil::maxAbsPerChannel(&maxL, &maxR, pSrc1, size);
+
+            SampleUtil::ChannelLevels levels[2];
+            const SampleUtil::CLIP_STATUS levelsClipping =
+                    SampleUtil::levelsPerChannel(
+                            &levels[0], &levels[1], pSrc1, size);
+            // The fused pass detects the same clipping
+            EXPECT_EQ(static_cast<int>(clipping),
+                    static_cast<int>(levelsClipping));
+
+            if (kernel == SampleUtil::Kernel::Scalar) {
+                for (int j = 0; j < 6; ++j) {
+                    expected[j] = results[j];
+                }
+                expectedS16 = resultS16;
+                expectedAbsL = absL;
+                expectedAbsR = absR;
+                expectedMaxL = maxL;
+                expectedMaxR = maxR;
+                expectedClipping = clipping;
+                expectedLevels[0] = levels[0];
+                expectedLevels[1] = levels[1];
+                continue;
+            }
+            for (int j = 0; j < 6; ++j) {
+                ASSERT_EQ(expected[j].size(), results[j].size());
+                for (size_t k = 0; k < results[j].size(); ++k) {
+                    EXPECT_FLOAT_EQ(expected[j][k], results[j][k]);
+                }
+            }
+            EXPECT_EQ(expectedS16, resultS16);
+            // The summation order differs
+            EXPECT_NEAR(expectedAbsL, absL, 1e-4 * size);
+            EXPECT_NEAR(expectedAbsR, absR, 1e-4 * size);
+            EXPECT_EQ(expectedMaxL, maxL);
+            EXPECT_EQ(expectedMaxR, maxR);
+            EXPECT_EQ(static_cast<int>(expectedClipping),
+                    static_cast<int>(clipping));
+            for (int channel = 0; channel < 2; ++channel) {
+                EXPECT_NEAR(expectedLevels[channel].sumAbs,
+                        levels[channel].sumAbs, 1e-4 * size);
+                EXPECT_NEAR(expectedLevels[channel].sumSquares,
+                        levels[channel].sumSquares, 1e-4 * size);
+                EXPECT_EQ(expectedLevels[channel].peak, levels[channel].peak);
+            }
+        }
+    }
+}
+
+TEST_F(SampleUtilTest, copyDownmixToStereo) {
+    // L R C LFE Ls Rs
+    const CSAMPLE kFrames[] = {
+        1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+        0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+    };
+    CSAMPLE stereo[8];
+    SampleUtil::copyDownmixToStereo(stereo, kFrames, 4, 6);
+    // Full scale stays full scale
+    EXPECT_FLOAT_EQ(1.0f, stereo[0]);
+    EXPECT_FLOAT_EQ(1.0f, stereo[1]);
+    // No LFE
+    EXPECT_FLOAT_EQ(0.0f, stereo[2]);
+    EXPECT_FLOAT_EQ(0.0f, stereo[3]);
+    // The front channels stay on their side
+    EXPECT_LT(0.0f, stereo[4]);
+    EXPECT_FLOAT_EQ(0.0f, stereo[5]);
+    // The surround channels are weaker
+    EXPECT_FLOAT_EQ(0.0f, stereo[6]);
+    EXPECT_FLOAT_EQ(0.70710678f * stereo[4], stereo[7]);
+}
+
 static void BM_MemCpy(benchmark::State& state) {
     size_t size = state.range_x();
     CSAMPLE* buffer = SampleUtil::alloc(size);
@@ -621,4 +810,141 @@ static void BM_Copy2WithRampingGain(benchmark::State& state) {
 }
 BENCHMARK(BM_Copy2WithRampingGain)->Range(64, 4096);
 
+// Runs the kernel benchmarks for range_x = Kernel and range_y = number
+// of samples, for all kernels supported by this CPU.
+static void KernelArguments(benchmark::internal::Benchmark* b) {
+    for (const auto kernel : kAllKernels) {
+        if (!SampleUtil::isKernelSupported(kernel)) {
+            continue;
+        }
+        for (int size = 64; size <= 4096; size *= 4) {
+            b->ArgPair(static_cast<int>(kernel), size);
+        }
+    }
+}
+
+static void BM_ApplyRampingGain(benchmark::State& state) {
+    ScopedKernel scopedKernel(static_cast<SampleUtil::Kernel>(state.range_x()));
+    state.SetLabel(SampleUtil::kernelName(SampleUtil::activeKernel()));
+    size_t size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.5f, size);
+
+    while(state.KeepRunning()) {
+        SampleUtil::applyRampingGain(buffer, 1.0f, 0.99f, size);
+    }
+
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_ApplyRampingGain)->Apply(KernelArguments);
+
+static void BM_CopyWithRampingGain(benchmark::State& state) {
+    ScopedKernel scopedKernel(static_cast<SampleUtil::Kernel>(state.range_x()));
+    state.SetLabel(SampleUtil::kernelName(SampleUtil::activeKernel()));
+    size_t size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.5f, size);
+
+    while(state.KeepRunning()) {
+        SampleUtil::copyWithRampingGain(buffer, buffer2, 1.1f, 1.2f, size);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+}
+BENCHMARK(BM_CopyWithRampingGain)->Apply(KernelArguments);
+
+static void BM_AddWithRampingGain(benchmark::State& state) {
+    ScopedKernel scopedKernel(static_cast<SampleUtil::Kernel>(state.range_x()));
+    state.SetLabel(SampleUtil::kernelName(SampleUtil::activeKernel()));
+    size_t size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.5f, size);
+
+    while(state.KeepRunning()) {
+        SampleUtil::addWithRampingGain(buffer, buffer2, 0.0f, 0.001f, size);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+}
+BENCHMARK(BM_AddWithRampingGain)->Apply(KernelArguments);
+
+static void BM_CopyClampBuffer(benchmark::State& state) {
+    ScopedKernel scopedKernel(static_cast<SampleUtil::Kernel>(state.range_x()));
+    state.SetLabel(SampleUtil::kernelName(SampleUtil::activeKernel()));
+    size_t size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 1.5f, size);
+
+    while(state.KeepRunning()) {
+        SampleUtil::copyClampBuffer(buffer, buffer2, size);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+}
+BENCHMARK(BM_CopyClampBuffer)->Apply(KernelArguments);
+
+static void BM_InterleaveBuffer(benchmark::State& state) {
+    ScopedKernel scopedKernel(static_cast<SampleUtil::Kernel>(state.range_x()));
+    state.SetLabel(SampleUtil::kernelName(SampleUtil::activeKernel()));
+    size_t size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size * 2);
+    SampleUtil::fill(buffer, 0.0f, size * 2);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.5f, size);
+    CSAMPLE* buffer3 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer3, -0.5f, size);
+
+    while(state.KeepRunning()) {
+        SampleUtil::interleaveBuffer(buffer, buffer2, buffer3, size);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+    SampleUtil::free(buffer3);
+}
+BENCHMARK(BM_InterleaveBuffer)->Apply(KernelArguments);
+
+static void BM_ConvertFloat32ToS16(benchmark::State& state) {
+    ScopedKernel scopedKernel(static_cast<SampleUtil::Kernel>(state.range_x()));
+    state.SetLabel(SampleUtil::kernelName(SampleUtil::activeKernel()));
+    size_t size = state.range_y();
+    SAMPLE* buffer = new SAMPLE[size];
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.5f, size);
+
+    while(state.KeepRunning()) {
+        SampleUtil::convertFloat32ToS16(buffer, buffer2, size);
+    }
+
+    delete[] buffer;
+    SampleUtil::free(buffer2);
+}
+BENCHMARK(BM_ConvertFloat32ToS16)->Apply(KernelArguments);
+
+static void BM_SumAbsPerChannel(benchmark::State& state) {
+    ScopedKernel scopedKernel(static_cast<SampleUtil::Kernel>(state.range_x()));
+    state.SetLabel(SampleUtil::kernelName(SampleUtil::activeKernel()));
+    size_t size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.5f, size);
+    CSAMPLE fAbsL = 0;
+    CSAMPLE fAbsR = 0;
+
+    while(state.KeepRunning()) {
+        SampleUtil::sumAbsPerChannel(&fAbsL, &fAbsR, buffer, size);
+    }
+
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_SumAbsPerChannel)->Apply(KernelArguments);
+
 }  // namespace
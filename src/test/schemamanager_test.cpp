@@ -126,3 +126,36 @@ TEST_F(SchemaManagerTest, FailedUpgrade) {
             MixxxDb::kDefaultSchemaFile, MixxxDb::kRequiredSchemaVersion);
     EXPECT_EQ(SchemaManager::Result::UpgradeFailed, result);
 }
+
+TEST_F(SchemaManagerTest, FullTextSearchFollowsTheLibrary) {
+    SchemaManager schemaManager(dbConnection());
+    SchemaManager::Result result = schemaManager.upgradeToSchemaVersion(
+            MixxxDb::kDefaultSchemaFile, MixxxDb::kRequiredSchemaVersion);
+    ASSERT_EQ(SchemaManager::Result::UpgradeSucceeded, result);
+    if (!dbConnection().tables().contains("library_fts")) {
+        // The optional migration needs FTS5 with the trigram tokenizer
+        return;
+    }
+
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec(
+            "INSERT INTO track_locations (id, location) "
+            "VALUES (1, '/music/Daft Punk - One More Time.mp3')"));
+    ASSERT_TRUE(query.exec(
+            "INSERT INTO library (id, artist, title, location) "
+            "VALUES (1, 'Daft Punk', 'One More Time', 1)"));
+    const QString match =
+            "SELECT rowid FROM library_fts WHERE library_fts MATCH '%1'";
+    ASSERT_TRUE(query.exec(match.arg("{artist} : \"daft\"")));
+    EXPECT_TRUE(query.next());
+
+    ASSERT_TRUE(query.exec("UPDATE library SET artist = 'Stardust' WHERE id = 1"));
+    ASSERT_TRUE(query.exec(match.arg("{artist} : \"daft\"")));
+    EXPECT_FALSE(query.next());
+    ASSERT_TRUE(query.exec(match.arg("{location} : \"punk\"")));
+    EXPECT_TRUE(query.next());
+
+    ASSERT_TRUE(query.exec("DELETE FROM library WHERE id = 1"));
+    ASSERT_TRUE(query.exec(match.arg("{location} : \"punk\"")));
+    EXPECT_FALSE(query.next());
+}
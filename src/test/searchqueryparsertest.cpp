@@ -23,10 +23,15 @@ class SearchQueryParserTest : public LibraryTest {
 
     SearchQueryParser m_parser;
 
-    // The expected query to be returned by CrateFilterNode
-    const QString m_crateFilterQuery =
-        "id IN (SELECT DISTINCT track_id FROM crate_tracks"
-        " JOIN crates ON crate_id=id WHERE name LIKE '%%1%' ORDER BY track_id)";
+    // The expected query for the tracks of the crate filters, which are
+    // selected before the query is executed
+    static QString trackIdsQuery(const QList<TrackId>& trackIds) {
+        QStringList idStrings;
+        for (const auto& trackId : trackIds) {
+            idStrings << trackId.toString();
+        }
+        return QString("id IN (%1)").arg(idStrings.join(","));
+    }
 };
 
 TEST_F(SearchQueryParserTest, EmptySearch) {
@@ -705,7 +710,7 @@ TEST_F(SearchQueryParserTest, CrateFilter) {
     EXPECT_FALSE(pQuery->match(pTrackB));
 
     EXPECT_STREQ(
-                 qPrintable(m_crateFilterQuery.arg(searchTerm)),
+                 qPrintable(trackIdsQuery(trackIds)),
                  qPrintable(pQuery->toSql()));
 }
 
@@ -758,7 +763,7 @@ TEST_F(SearchQueryParserTest, CrateFilterQuote){
     EXPECT_FALSE(pQuery->match(pTrackB));
 
     EXPECT_STREQ(
-                 qPrintable(m_crateFilterQuery.arg(searchTerm)),
+                 qPrintable(trackIdsQuery(trackIds)),
                  qPrintable(pQuery->toSql()));
 }
 
@@ -805,7 +810,7 @@ TEST_F(SearchQueryParserTest, CrateFilterWithOther){
     EXPECT_FALSE(pQuery->match(pTrackB));
 
     EXPECT_STREQ(
-                 qPrintable("(" + m_crateFilterQuery.arg(searchTerm) +
+                 qPrintable("(" + trackIdsQuery(trackIds) +
                             ") AND ((artist LIKE '%asdf%') OR (album_artist LIKE '%asdf%'))"),
                  qPrintable(pQuery->toSql()));
 }
@@ -855,8 +860,7 @@ TEST_F(SearchQueryParserTest, CrateFilterWithCrateFilterAndNegation){
     EXPECT_FALSE(pQueryA->match(pTrackB));
 
     EXPECT_STREQ(
-                 qPrintable("(" + m_crateFilterQuery.arg(searchTermA) +
-                            ") AND (" + m_crateFilterQuery.arg(searchTermB) + ")"),
+                 qPrintable(trackIdsQuery(trackIdsB)),
                  qPrintable(pQueryA->toSql()));
 
     // parse again to test negation
@@ -867,7 +871,6 @@ TEST_F(SearchQueryParserTest, CrateFilterWithCrateFilterAndNegation){
     EXPECT_TRUE(pQueryB->match(pTrackB));
 
     EXPECT_STREQ(
-                 qPrintable("(" + m_crateFilterQuery.arg(searchTermA) +
-                            ") AND (NOT (" + m_crateFilterQuery.arg(searchTermB) + "))"),
+                 qPrintable(trackIdsQuery(QList<TrackId>() << trackBId)),
                  qPrintable(pQueryB->toSql()));
 }
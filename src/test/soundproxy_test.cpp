@@ -215,6 +215,20 @@ TEST_F(SoundSourceProxyTest, readArtist) {
     EXPECT_EQ("Test Artist", trackMetadata.getTrackInfo().getArtist());
 }
 
+TEST_F(SoundSourceProxyTest, readTagsOnly) {
+    auto pTrack = Track::newTemporary(
+            kTestDir.absoluteFilePath("artist.mp3"));
+    SoundSourceProxy proxy(pTrack);
+    mixxx::TrackMetadata trackMetadata;
+    EXPECT_EQ(mixxx::MetadataSource::ImportResult::Succeeded,
+            proxy.importTrackMetadata(&trackMetadata,
+                    mixxx::MetadataSource::IMPORT_TAGS));
+    EXPECT_EQ("Test Artist", trackMetadata.getTrackInfo().getArtist());
+    // The audio properties have not been imported
+    EXPECT_FALSE(trackMetadata.getSampleRate().valid());
+    EXPECT_FALSE(trackMetadata.getChannels().valid());
+}
+
 TEST_F(SoundSourceProxyTest, TOAL_TPE2) {
     auto pTrack = Track::newTemporary(
             kTestDir.absoluteFilePath("TOAL_TPE2.mp3"));
@@ -0,0 +1,99 @@
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+#include "sources/soundsourceplugincache.h"
+
+namespace mixxx {
+
+namespace {
+
+class TestSoundSourceProvider: public SoundSourceProvider {
+  public:
+    QString getName() const override {
+        return "Test";
+    }
+
+    QStringList getSupportedFileExtensions() const override {
+        return QStringList() << "ext1" << "ext2";
+    }
+
+    SoundSourceProviderPriority getPriorityHint(
+            const QString& supportedFileExtension) const override {
+        return supportedFileExtension == "ext1" ?
+                SoundSourceProviderPriority::HIGHER :
+                SoundSourceProviderPriority::LOWEST;
+    }
+
+    SoundSourcePointer newSoundSource(const QUrl& /*url*/) override {
+        return SoundSourcePointer();
+    }
+};
+
+class SoundSourcePluginCacheTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+        m_cacheFilePath = m_dir.filePath("plugins.cache");
+        m_libFilePath = m_dir.filePath("libtest.so");
+        writeLibFile(QByteArray(1000, 'x'));
+    }
+
+    void writeLibFile(const QByteArray& data) {
+        QFile file(m_libFilePath);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(data.size(), file.write(data));
+    }
+
+    QTemporaryDir m_dir;
+    QString m_cacheFilePath;
+    QString m_libFilePath;
+};
+
+TEST_F(SoundSourcePluginCacheTest, SaveAndLoad) {
+    SoundSourcePluginCache cache(m_cacheFilePath);
+    EXPECT_FALSE(cache.load());
+    cache.insert(QFileInfo(m_libFilePath),
+            std::make_shared<TestSoundSourceProvider>());
+    EXPECT_TRUE(cache.isModified());
+    ASSERT_TRUE(cache.save());
+
+    SoundSourcePluginCache loaded(m_cacheFilePath);
+    ASSERT_TRUE(loaded.load());
+    EXPECT_FALSE(loaded.isModified());
+    const SoundSourcePluginCache::Entry* pEntry =
+            loaded.find(QFileInfo(m_libFilePath));
+    ASSERT_NE(nullptr, pEntry);
+    EXPECT_EQ(QString("Test"), pEntry->providerName);
+    ASSERT_EQ(2, pEntry->fileExtensionPriorities.size());
+    EXPECT_EQ(SoundSourceProviderPriority::HIGHER,
+            pEntry->fileExtensionPriorities.value("ext1"));
+    EXPECT_EQ(SoundSourceProviderPriority::LOWEST,
+            pEntry->fileExtensionPriorities.value("ext2"));
+}
+
+TEST_F(SoundSourcePluginCacheTest, ModifiedLibraryIsNotFound) {
+    SoundSourcePluginCache cache(m_cacheFilePath);
+    cache.insert(QFileInfo(m_libFilePath),
+            std::make_shared<TestSoundSourceProvider>());
+    writeLibFile(QByteArray(1001, 'x'));
+    EXPECT_EQ(nullptr, cache.find(QFileInfo(m_libFilePath)));
+}
+
+TEST_F(SoundSourcePluginCacheTest, RemovedLibraryIsDropped) {
+    SoundSourcePluginCache cache(m_cacheFilePath);
+    cache.insert(QFileInfo(m_libFilePath),
+            std::make_shared<TestSoundSourceProvider>());
+    ASSERT_TRUE(cache.save());
+
+    SoundSourcePluginCache loaded(m_cacheFilePath);
+    ASSERT_TRUE(loaded.load());
+    loaded.retain(QStringList());
+    EXPECT_TRUE(loaded.isModified());
+    EXPECT_EQ(nullptr, loaded.find(QFileInfo(m_libFilePath)));
+}
+
+} // anonymous namespace
+
+} // namespace mixxx
@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+
+#include "util/db/sqlqueryprofiler.h"
+#include "util/stat.h"
+
+namespace {
+
+TEST(SqlQueryProfilerTest, NormalizeStatement) {
+    EXPECT_EQ(QString("SELECT id FROM library WHERE location=? AND id IN (?,...)"),
+            SqlQueryProfiler::normalizeStatement(
+                    "SELECT id FROM library\n  WHERE location='it''s' AND id IN (1, 2,3)"));
+    // Placeholders and names with digits are kept
+    EXPECT_EQ(QString("UPDATE t1 SET bpm=? WHERE id=:id"),
+            SqlQueryProfiler::normalizeStatement("UPDATE t1 SET bpm=128.5 WHERE id=:id"));
+}
+
+TEST(SqlQueryProfilerTest, Percentiles) {
+    Stat stat;
+    stat.m_compute = Stat::PERCENTILES;
+    EXPECT_EQ(0.0, stat.percentile(0.99));
+    StatReport report;
+    for (int i = 100; i >= 1; --i) {
+        report.value = i;
+        stat.processReport(report);
+    }
+    EXPECT_EQ(50.0, stat.percentile(0.5));
+    EXPECT_EQ(99.0, stat.percentile(0.99));
+    EXPECT_EQ(100.0, stat.percentile(1.0));
+}
+
+} // anonymous namespace
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <QTextStream>
+
+#include "util/statsmetrics.h"
+
+namespace {
+
+StatReport reportOf(Stat::StatType type, double value) {
+    StatReport report;
+    report.tag = nullptr;
+    report.time = 0;
+    report.type = type;
+    report.compute = Stat::COUNT;
+    report.value = value;
+    return report;
+}
+
+QString writeMetrics(const StatsMetrics& metrics) {
+    QString text;
+    QTextStream out(&text);
+    metrics.write(&out);
+    out.flush();
+    return text;
+}
+
+TEST(StatsMetricsTest, CounterIsSummedPerThread) {
+    StatsMetrics metrics;
+    metrics.processReport(reportOf(Stat::COUNTER, 2), "Cache misses", "Engine");
+    metrics.processReport(reportOf(Stat::COUNTER, 3), "Cache misses", "Engine");
+    metrics.processReport(reportOf(Stat::COUNTER, 1), "Cache misses", "Main");
+
+    const QString text = writeMetrics(metrics);
+    EXPECT_TRUE(text.contains(
+            "mixxx_counter_total{tag=\"Cache misses\",thread=\"Engine\"} 5\n"));
+    EXPECT_TRUE(text.contains(
+            "mixxx_counter_total{tag=\"Cache misses\",thread=\"Main\"} 1\n"));
+    EXPECT_TRUE(text.endsWith("# EOF\n"));
+}
+
+TEST(StatsMetricsTest, DurationHistogramIsCumulative) {
+    StatsMetrics metrics;
+    // 3 ms and 30 ms
+    metrics.processReport(reportOf(Stat::DURATION_NANOSEC, 3e6),
+            "[Channel1] process", "Engine");
+    metrics.processReport(reportOf(Stat::DURATION_NANOSEC, 3e7),
+            "[Channel1] process", "Engine");
+
+    const QString text = writeMetrics(metrics);
+    const QString labels =
+            "tag=\"[Channel1] process\",thread=\"Engine\",group=\"[Channel1]\"";
+    EXPECT_TRUE(text.contains(
+            "mixxx_duration_seconds_bucket{" + labels + ",le=\"0.002\"} 0\n"));
+    EXPECT_TRUE(text.contains(
+            "mixxx_duration_seconds_bucket{" + labels + ",le=\"0.005\"} 1\n"));
+    EXPECT_TRUE(text.contains(
+            "mixxx_duration_seconds_bucket{" + labels + ",le=\"0.05\"} 2\n"));
+    EXPECT_TRUE(text.contains(
+            "mixxx_duration_seconds_bucket{" + labels + ",le=\"+Inf\"} 2\n"));
+    EXPECT_TRUE(text.contains(
+            "mixxx_duration_seconds_count{" + labels + "} 2\n"));
+    EXPECT_TRUE(text.contains(
+            "mixxx_duration_seconds_sum{" + labels + "} 0.033\n"));
+}
+
+TEST(StatsMetricsTest, LabelValuesAreEscaped) {
+    StatsMetrics metrics;
+    metrics.processReport(reportOf(Stat::EVENT, 0), "say \"hi\"\\", "Main");
+
+    EXPECT_TRUE(writeMetrics(metrics).contains(
+            "mixxx_events_total{tag=\"say \\\"hi\\\"\\\\\",thread=\"Main\"} 1\n"));
+}
+
+} // anonymous namespace
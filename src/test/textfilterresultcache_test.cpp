@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include "library/textfilterresultcache.h"
+
+namespace {
+
+TrackIdSet setOf(const QList<int>& ids) {
+    TrackIdSet trackIds;
+    for (int id : ids) {
+        trackIds.insert(TrackId(id));
+    }
+    return trackIds;
+}
+
+TEST(TextFilterResultCacheTest, findSuperset) {
+    const QStringList columns = QStringList() << "artist" << "title";
+    TextFilterResultCache cache(2);
+    cache.insert(columns, "abc", setOf(QList<int>() << 1 << 2 << 3));
+    cache.insert(columns, "abcd", setOf(QList<int>() << 1 << 2));
+
+    TrackIdSet trackIds;
+    bool exact = true;
+    // The smallest result whose term is contained
+    EXPECT_TRUE(cache.findSuperset(columns, "abcde", &trackIds, &exact));
+    EXPECT_FALSE(exact);
+    EXPECT_EQ(setOf(QList<int>() << 1 << 2).toTrackIds(), trackIds.toTrackIds());
+    EXPECT_TRUE(cache.findSuperset(columns, "xabcx", &trackIds, &exact));
+    EXPECT_FALSE(exact);
+    EXPECT_EQ(3, trackIds.size());
+    EXPECT_TRUE(cache.findSuperset(columns, "abc", &trackIds, &exact));
+    EXPECT_TRUE(exact);
+    EXPECT_FALSE(cache.findSuperset(columns, "ab", &trackIds, &exact));
+    EXPECT_FALSE(cache.findSuperset(QStringList() << "artist", "abcd",
+            &trackIds, &exact));
+
+    // "abc" has been used more recently than "abcd"
+    cache.insert(columns, "xyz", TrackIdSet());
+    EXPECT_TRUE(cache.findSuperset(columns, "abcd", &trackIds, &exact));
+    EXPECT_FALSE(exact);
+
+    cache.clear();
+    EXPECT_FALSE(cache.findSuperset(columns, "abc", &trackIds, &exact));
+}
+
+} // anonymous namespace
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <QList>
+
+#include "util/threadroles.h"
+
+namespace {
+
+using mixxx::ThreadPolicy;
+using mixxx::ThreadRole;
+using mixxx::ThreadRoles;
+
+TEST(ThreadRolesTest, ParseCpuList) {
+    QList<int> cpus;
+    EXPECT_TRUE(ThreadRoles::parseCpuList("0,2-3", &cpus));
+    EXPECT_EQ(QList<int>({ 0, 2, 3 }), cpus);
+
+    EXPECT_TRUE(ThreadRoles::parseCpuList(" 1 , 1-2 ", &cpus));
+    EXPECT_EQ(QList<int>({ 1, 2 }), cpus);
+
+    EXPECT_TRUE(ThreadRoles::parseCpuList("", &cpus));
+    EXPECT_TRUE(cpus.isEmpty());
+}
+
+TEST(ThreadRolesTest, ParseMalformedCpuList) {
+    QList<int> cpus;
+    EXPECT_FALSE(ThreadRoles::parseCpuList("3-1", &cpus));
+    EXPECT_FALSE(ThreadRoles::parseCpuList("a", &cpus));
+    EXPECT_FALSE(ThreadRoles::parseCpuList("1-2-3", &cpus));
+    EXPECT_FALSE(ThreadRoles::parseCpuList("-1", &cpus));
+}
+
+TEST(ThreadRolesTest, DefaultPolicyLeavesThreadAlone) {
+    const ThreadPolicy previous = ThreadRoles::policy(ThreadRole::Analyzer);
+    ThreadRoles::setPolicy(ThreadRole::Analyzer, ThreadPolicy());
+    EXPECT_TRUE(ThreadRoles::applyToCurrentThread(ThreadRole::Analyzer));
+    ThreadRoles::setPolicy(ThreadRole::Analyzer, previous);
+}
+
+} // namespace
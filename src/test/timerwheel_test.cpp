@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include "util/timerwheel.h"
+
+namespace {
+
+QVector<int> advance(TimerWheel* pWheel, qint64 tick) {
+    QVector<int> expiredIds;
+    pWheel->advance(tick, &expiredIds);
+    return expiredIds;
+}
+
+TEST(TimerWheelTest, oneShotTimer) {
+    TimerWheel wheel;
+    const int id = wheel.start(3, true);
+    EXPECT_LT(0, id);
+    EXPECT_TRUE(advance(&wheel, 2).isEmpty());
+    EXPECT_EQ(QVector<int>() << id, advance(&wheel, 3));
+    // Expired but not stopped
+    EXPECT_TRUE(wheel.isActive(id));
+    EXPECT_TRUE(advance(&wheel, 100).isEmpty());
+    EXPECT_TRUE(wheel.stop(id));
+    EXPECT_FALSE(wheel.stop(id));
+    EXPECT_TRUE(wheel.isEmpty());
+}
+
+TEST(TimerWheelTest, periodicTimerDoesNotDrift) {
+    TimerWheel wheel;
+    const int id = wheel.start(10, false);
+    EXPECT_EQ(QVector<int>() << id, advance(&wheel, 10));
+    // Late by 5 ticks
+    EXPECT_EQ(QVector<int>() << id, advance(&wheel, 25));
+    EXPECT_EQ(QVector<int>() << id, advance(&wheel, 30));
+    EXPECT_EQ(QVector<int>() << id << id, advance(&wheel, 50));
+}
+
+TEST(TimerWheelTest, timersAcrossLevels) {
+    TimerWheel wheel;
+    // Spread over all levels and across the wrap-around of the finer ones
+    const QVector<int> intervals = QVector<int>() << 1 << 63 << 64 << 65
+            << 4095 << 4096 << 4097 << 100000 << 300000 << 20000000;
+    QVector<int> ids;
+    for (int interval : intervals) {
+        ids.append(wheel.start(interval, true));
+    }
+    qint64 tick = 0;
+    for (int i = 0; i < intervals.size(); ++i) {
+        EXPECT_TRUE(advance(&wheel, intervals[i] - 1).isEmpty()) << intervals[i];
+        EXPECT_EQ(QVector<int>() << ids[i], advance(&wheel, intervals[i]))
+                << intervals[i];
+        EXPECT_TRUE(wheel.stop(ids[i]));
+        tick = intervals[i];
+    }
+    EXPECT_EQ(20000000, tick);
+    EXPECT_TRUE(wheel.isEmpty());
+}
+
+TEST(TimerWheelTest, stoppedTimerIdsAreNotReused) {
+    TimerWheel wheel;
+    const int id = wheel.start(5, false);
+    EXPECT_TRUE(wheel.stop(id));
+    // Reuses the entry of the stopped timer
+    const int otherId = wheel.start(5, false);
+    EXPECT_EQ(TimerWheel::indexOf(id), TimerWheel::indexOf(otherId));
+    EXPECT_NE(id, otherId);
+    EXPECT_FALSE(wheel.stop(id));
+    EXPECT_TRUE(wheel.isActive(otherId));
+    EXPECT_EQ(1, wheel.poolSize());
+}
+
+TEST(TimerWheelTest, idleWheelJumpsToTick) {
+    TimerWheel wheel;
+    EXPECT_TRUE(advance(&wheel, 1000000000).isEmpty());
+    EXPECT_EQ(1000000000, wheel.currentTick());
+    const int id = wheel.start(2, true);
+    EXPECT_EQ(QVector<int>() << id, advance(&wheel, 1000000002));
+}
+
+} // anonymous namespace
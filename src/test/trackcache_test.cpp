@@ -0,0 +1,65 @@
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "test/librarytest.h"
+
+namespace {
+
+class TrackCacheTest : public LibraryTest {
+  protected:
+    QFileInfo createFile(const QString& fileName) {
+        QFile file(m_dir.filePath(fileName));
+        EXPECT_TRUE(file.open(QIODevice::WriteOnly));
+        return QFileInfo(file.fileName());
+    }
+
+    QTemporaryDir m_tempDir;
+    const QDir m_dir = QDir(m_tempDir.path());
+};
+
+TEST_F(TrackCacheTest, resolveAcrossShards) {
+    ASSERT_TRUE(m_tempDir.isValid());
+    // Enough tracks to fill all shards
+    QList<TrackPointer> tracks;
+    for (int i = 0; i < 64; ++i) {
+        const QFileInfo fileInfo = createFile(QString("track%1.mp3").arg(i));
+        TrackCacheResolver cacheResolver(TrackCache::instance().resolve(fileInfo));
+        EXPECT_EQ(TrackCacheLookupResult::MISS,
+                cacheResolver.getTrackCacheLookupResult());
+        ASSERT_TRUE(cacheResolver.getTrack());
+        cacheResolver.updateTrackId(TrackId(i + 1));
+        tracks.append(cacheResolver.getTrack());
+    }
+    EXPECT_EQ(tracks.size(), TrackCache::instance().lookupAll().size());
+
+    for (int i = 0; i < tracks.size(); ++i) {
+        EXPECT_EQ(tracks[i],
+                TrackCache::instance().lookupById(TrackId(i + 1)).getTrack());
+        // By location without the id
+        const TrackPointer pTrack = TrackCache::instance().resolve(
+                QFileInfo(tracks[i]->getLocation())).getTrack();
+        EXPECT_EQ(tracks[i], pTrack);
+    }
+
+    // Released tracks are evicted
+    tracks.clear();
+    EXPECT_TRUE(TrackCache::instance().lookupAll().isEmpty());
+    EXPECT_FALSE(TrackCache::instance().lookupById(TrackId(1)).getTrack());
+}
+
+TEST_F(TrackCacheTest, updateTrackIds) {
+    ASSERT_TRUE(m_tempDir.isValid());
+    const TrackPointer pTrack = TrackCache::instance().resolve(
+            createFile("track.mp3")).getTrack();
+    ASSERT_TRUE(pTrack);
+    EXPECT_FALSE(TrackCache::instance().lookupById(TrackId(42)).getTrack());
+
+    TrackCache::instance().updateTrackIds(
+            QList<QPair<TrackPointer, TrackId>>() << qMakePair(pTrack, TrackId(42)));
+    EXPECT_EQ(TrackId(42), pTrack->getId());
+    EXPECT_EQ(pTrack, TrackCache::instance().lookupById(TrackId(42)).getTrack());
+    EXPECT_EQ(pTrack, TrackCache::instance().resolve(
+            TrackId(42), QFileInfo(pTrack->getLocation())).getTrack());
+}
+
+} // anonymous namespace
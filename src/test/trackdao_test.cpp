@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <QTemporaryDir>
+
 #include "test/librarytest.h"
 
 using ::testing::UnorderedElementsAre;
@@ -47,3 +49,130 @@ TEST_F(TrackDAOTest, detectMovedTracks) {
     QSet<QString> trackLocations = trackDAO.getTrackLocations();
     EXPECT_THAT(trackLocations, UnorderedElementsAre(newFile));
 }
+
+TEST_F(TrackDAOTest, addTracksAddFiles) {
+    TrackDAO& trackDAO = collection()->getTrackDAO();
+    const QDir testDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+    const QFileInfo existingFile(testDir.absoluteFilePath("artist.mp3"));
+    const QFileInfo newFile(testDir.absoluteFilePath("cover-test-png.mp3"));
+    const QFileInfo unsupportedFile(testDir.absoluteFilePath("README"));
+
+    trackDAO.addTracksPrepare();
+    const TrackPointer pExistingTrack = trackDAO.addTracksAddFile(existingFile, false);
+    trackDAO.addTracksFinish(false);
+    ASSERT_TRUE(pExistingTrack);
+
+    trackDAO.addTracksPrepare(true);
+    const QList<TrackPointer> tracks = trackDAO.addTracksAddFiles(
+            QList<QFileInfo>() << newFile << unsupportedFile << newFile << existingFile,
+            false);
+    trackDAO.addTracksFinish(false);
+
+    ASSERT_EQ(4, tracks.size());
+    ASSERT_TRUE(tracks[0]);
+    EXPECT_TRUE(tracks[0]->getId().isValid());
+    EXPECT_FALSE(tracks[0]->isDirty());
+    EXPECT_EQ(tracks[0]->getId(), trackDAO.getTrackId(newFile.absoluteFilePath()));
+    EXPECT_FALSE(tracks[1]);
+    // The same file is only added once
+    EXPECT_EQ(tracks[0], tracks[2]);
+    // Tracks that are cached with their id are skipped like by
+    // addTracksAddFile()
+    EXPECT_FALSE(tracks[3]);
+    EXPECT_NE(pExistingTrack->getId(), tracks[0]->getId());
+}
+
+TEST_F(TrackDAOTest, detectDeferredCoverArt) {
+    TrackDAO& trackDAO = collection()->getTrackDAO();
+    const QDir testDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+    const QFileInfo file(testDir.absoluteFilePath("cover-test-png.mp3"));
+
+    trackDAO.addTracksPrepare(true);
+    const QList<TrackPointer> tracks = trackDAO.addTracksAddFiles(
+            QList<QFileInfo>() << file, false, true);
+    trackDAO.addTracksFinish(false);
+    ASSERT_EQ(1, tracks.size());
+    ASSERT_TRUE(tracks[0]);
+    EXPECT_EQ(CoverInfo::UNKNOWN, tracks[0]->getCoverInfo().source);
+    EXPECT_EQ(QStringList() << file.absolutePath(),
+            trackDAO.getDirectoriesOfTracksWithoutCover());
+
+    QSet<TrackId> tracksChanged;
+    trackDAO.detectCoverArtForTracksInDirectory(file.absolutePath(), &tracksChanged);
+    EXPECT_EQ(QSet<TrackId>() << tracks[0]->getId(), tracksChanged);
+    EXPECT_TRUE(trackDAO.getDirectoriesOfTracksWithoutCover().isEmpty());
+}
+
+TEST_F(TrackDAOTest, getTracks) {
+    TrackDAO& trackDAO = collection()->getTrackDAO();
+
+    QString cachedFile(QDir::tempPath() + "/cached.mp3");
+    QString loadedFile(QDir::tempPath() + "/loaded.mp3");
+
+    TrackPointer pCachedTrack = Track::newTemporary(cachedFile);
+    TrackPointer pLoadedTrack = Track::newTemporary(loadedFile);
+    pLoadedTrack->setDuration(135);
+
+    trackDAO.addTracksPrepare();
+    TrackId cachedId = trackDAO.addTracksAddTrack(pCachedTrack, false);
+    TrackId loadedId = trackDAO.addTracksAddTrack(pLoadedTrack, false);
+    trackDAO.addTracksFinish(false);
+    ASSERT_TRUE(cachedId.isValid());
+    ASSERT_TRUE(loadedId.isValid());
+
+    // Loaded again from the database
+    pLoadedTrack.reset();
+
+    const QList<TrackPointer> tracks = trackDAO.getTracks(
+            QList<TrackId>() << loadedId << TrackId(12345) << cachedId << loadedId);
+    ASSERT_EQ(3, tracks.size());
+    EXPECT_EQ(loadedId, tracks[0]->getId());
+    EXPECT_EQ(loadedFile, tracks[0]->getLocation());
+    EXPECT_EQ(135, tracks[0]->getDuration());
+    EXPECT_EQ(pCachedTrack, tracks[1]);
+    EXPECT_EQ(tracks[0], tracks[2]);
+}
+
+TEST_F(TrackDAOTest, verifyRemainingTracks) {
+    TrackDAO& trackDAO = collection()->getTrackDAO();
+
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    QStringList existingFiles;
+    QStringList missingFiles;
+    // Enough files for listing the directory
+    for (int i = 0; i < 6; ++i) {
+        const QString fileName(tempDir.path() + QString("/%1.mp3").arg(i));
+        if (i % 2 == 0) {
+            QFile file(fileName);
+            ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+            existingFiles.append(fileName);
+        } else {
+            missingFiles.append(fileName);
+        }
+    }
+
+    trackDAO.addTracksPrepare();
+    for (const auto& fileName: existingFiles + missingFiles) {
+        ASSERT_TRUE(trackDAO.addTracksAddTrack(
+                Track::newTemporary(fileName), false).isValid());
+    }
+    trackDAO.addTracksFinish(false);
+
+    trackDAO.invalidateTrackLocationsInLibrary();
+    bool cancel = false;
+    ASSERT_TRUE(trackDAO.verifyRemainingTracks(QStringList(), &cancel));
+
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec(
+            "SELECT location, fs_deleted, needs_verification FROM track_locations"));
+    int rows = 0;
+    while (query.next()) {
+        const QString location(query.value(0).toString());
+        EXPECT_EQ(missingFiles.contains(location) ? 1 : 0, query.value(1).toInt())
+                << location.toStdString();
+        EXPECT_EQ(0, query.value(2).toInt());
+        ++rows;
+    }
+    EXPECT_EQ(6, rows);
+}
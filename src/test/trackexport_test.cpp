@@ -297,3 +297,43 @@ TEST_F(TrackExporterTest, MungeFilename) {
     // Remove the track we created.
     tempPath.remove("cover-test.ogg");
 }
+
+TEST_F(TrackExporterTest, ParallelStreamsSkipUpToDate) {
+    QFileInfo fileinfo1(m_testDataDir.filePath("cover-test.ogg"));
+    TrackPointer track1(Track::newTemporary(fileinfo1));
+    QFileInfo fileinfo2(m_testDataDir.filePath("cover-test.flac"));
+    TrackPointer track2(Track::newTemporary(fileinfo2));
+    QFileInfo fileinfo3(m_testDataDir.filePath("cover-test.m4a"));
+    TrackPointer track3(Track::newTemporary(fileinfo3));
+
+    QList<TrackPointer> tracks;
+    tracks.append(track1);
+    tracks.append(track2);
+    tracks.append(track3);
+    TrackExportWorker worker(m_exportDir.canonicalPath(), tracks);
+    worker.setCopyStreams(2);
+    m_answerer.reset(new FakeOverwriteAnswerer(&worker));
+
+    worker.run();
+    EXPECT_TRUE(worker.wait(10000));
+
+    EXPECT_EQ(3, m_answerer->currentProgress());
+    EXPECT_EQ(3, m_answerer->currentProgressCount());
+    EXPECT_EQ(fileinfo1.size(),
+            QFileInfo(m_exportDir.filePath("cover-test.ogg")).size());
+    EXPECT_EQ(fileinfo2.size(),
+            QFileInfo(m_exportDir.filePath("cover-test.flac")).size());
+    EXPECT_EQ(fileinfo3.size(),
+            QFileInfo(m_exportDir.filePath("cover-test.m4a")).size());
+
+    // Exporting again does not ask about the files, which are up to date.
+    // The answerer fails on any question.
+    TrackExportWorker worker2(m_exportDir.canonicalPath(), tracks);
+    m_answerer.reset(new FakeOverwriteAnswerer(&worker2));
+
+    worker2.run();
+    EXPECT_TRUE(worker2.wait(10000));
+
+    EXPECT_EQ(3, m_answerer->currentProgress());
+    EXPECT_EQ(3, m_answerer->currentProgressCount());
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include "library/trackidset.h"
+
+namespace {
+
+TrackIdSet rangeOf(int first, int last, int step = 1) {
+    TrackIdSet trackIds;
+    for (int id = first; id <= last; id += step) {
+        trackIds.insert(TrackId(id));
+    }
+    return trackIds;
+}
+
+TEST(TrackIdSetTest, insertAndContains) {
+    TrackIdSet trackIds;
+    EXPECT_TRUE(trackIds.isEmpty());
+    trackIds.insert(TrackId(70000));
+    trackIds.insert(TrackId(3));
+    trackIds.insert(TrackId(3));
+    trackIds.insert(TrackId());
+    EXPECT_EQ(2, trackIds.size());
+    EXPECT_TRUE(trackIds.contains(TrackId(3)));
+    EXPECT_TRUE(trackIds.contains(TrackId(70000)));
+    EXPECT_FALSE(trackIds.contains(TrackId(4)));
+    EXPECT_EQ(QVector<TrackId>() << TrackId(3) << TrackId(70000),
+            trackIds.toTrackIds());
+    EXPECT_EQ(QString("3,70000"), trackIds.toSqlList());
+}
+
+TEST(TrackIdSetTest, combinesSparseAndDenseChunks) {
+    // Dense enough for a bitmap
+    const TrackIdSet even = rangeOf(0, 20000, 2);
+    const TrackIdSet sparse = rangeOf(0, 20000, 1000);
+
+    TrackIdSet intersection = even;
+    intersection &= sparse;
+    EXPECT_EQ(sparse.size(), intersection.size());
+    EXPECT_TRUE(intersection.contains(TrackId(19000)));
+
+    TrackIdSet odd = rangeOf(1, 20000, 2);
+    TrackIdSet all = even;
+    all |= odd;
+    EXPECT_EQ(20001, all.size());
+    all -= odd;
+    EXPECT_EQ(even.size(), all.size());
+    EXPECT_EQ(even.toTrackIds(), all.toTrackIds());
+
+    odd &= even;
+    EXPECT_TRUE(odd.isEmpty());
+
+    TrackIdSet rest = even;
+    rest -= rangeOf(0, 19990, 2);
+    EXPECT_EQ(QVector<TrackId>() << TrackId(19992) << TrackId(19994)
+            << TrackId(19996) << TrackId(19998) << TrackId(20000),
+            rest.toTrackIds());
+}
+
+} // anonymous namespace
@@ -0,0 +1,61 @@
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "library/trackkeyindex.h"
+
+using mixxx::track::io::key::ChromaticKey;
+
+namespace {
+
+class TrackKeyIndexTest : public testing::Test {
+  protected:
+    // Adds a track with the key in its own row
+    void setKey(int trackId, ChromaticKey key) {
+        auto it = m_rows.constFind(TrackId(trackId));
+        if (it == m_rows.constEnd()) {
+            it = m_rows.insert(TrackId(trackId), m_keys.size());
+            m_keys.append(key);
+        } else {
+            m_keys[it.value()] = key;
+        }
+        m_index.invalidate(TrackId(trackId));
+    }
+
+    QVector<TrackId> select(KeyUtils::KeyMask keys) {
+        m_index.update(m_rows, [this](int row) {
+            return m_keys[row];
+        });
+        QVector<TrackId> trackIds = m_index.select(keys);
+        std::sort(trackIds.begin(), trackIds.end());
+        return trackIds;
+    }
+
+    QHash<TrackId, int> m_rows;
+    QVector<ChromaticKey> m_keys;
+    TrackKeyIndex m_index;
+};
+
+TEST_F(TrackKeyIndexTest, selectsCompatibleKeys) {
+    setKey(1, mixxx::track::io::key::C_MAJOR);
+    setKey(2, mixxx::track::io::key::A_MINOR);
+    setKey(3, mixxx::track::io::key::D_MAJOR);
+    setKey(4, mixxx::track::io::key::INVALID);
+    const KeyUtils::KeyMask keys =
+            KeyUtils::getCompatibleKeysMask(mixxx::track::io::key::C_MAJOR);
+    EXPECT_EQ(QVector<TrackId>() << TrackId(1) << TrackId(2), select(keys));
+
+    // Changed and removed tracks
+    setKey(3, mixxx::track::io::key::G_MAJOR);
+    m_rows.remove(TrackId(2));
+    m_index.invalidate(TrackId(2));
+    EXPECT_EQ(QVector<TrackId>() << TrackId(1) << TrackId(3), select(keys));
+    EXPECT_EQ(QVector<TrackId>() << TrackId(4),
+            select(KeyUtils::keyToMask(mixxx::track::io::key::INVALID)));
+
+    // Rebuilt from all rows
+    m_index.invalidateAll();
+    EXPECT_EQ(QVector<TrackId>() << TrackId(1) << TrackId(3), select(keys));
+}
+
+} // anonymous namespace
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryFile>
+
+#include <taglib/mpegfile.h>
+
+#include "library/trackmetadataexportqueue.h"
+#include "test/mixxxtest.h"
+#include "track/trackmetadatataglib.h"
+
+namespace {
+
+const QDir kTestDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+
+class TrackMetadataExportQueueTest : public MixxxTest {
+  protected:
+    TrackMetadataExportQueueTest()
+            : m_trackInUse(false),
+              m_queue([this](TrackId) { return m_trackInUse; }) {
+        QTemporaryFile tmpFile("trackmetadataexportqueue_XXXXXX.mp3");
+        tmpFile.open();
+        m_fileName = tmpFile.fileName();
+        tmpFile.close();
+        QFile::remove(m_fileName);
+        EXPECT_TRUE(QFile::copy(kTestDir.absoluteFilePath("empty.mp3"), m_fileName));
+    }
+    ~TrackMetadataExportQueueTest() override {
+        QFile::remove(m_fileName);
+    }
+
+    QString titleOfFile() const {
+        TagLib::MPEG::File file(TAGLIB_FILENAME_FROM_QSTRING(m_fileName));
+        return file.tag() ? QString::fromUtf8(file.tag()->title().toCString(true)) : QString();
+    }
+
+    bool m_trackInUse;
+    TrackMetadataExportQueue m_queue;
+    QString m_fileName;
+};
+
+TEST_F(TrackMetadataExportQueueTest, ExportAfterTrackIsDeleted) {
+    // The file is written while the track is in use only when flushing
+    m_trackInUse = true;
+    const TrackId trackId(1);
+    {
+        TrackPointer pTrack = Track::newDummy(QFileInfo(m_fileName), trackId);
+        pTrack->setTitle("first title");
+        pTrack->markForMetadataExport();
+        m_queue.enqueue(pTrack.get());
+        // Merged with the pending export
+        pTrack->setTitle("queued title");
+        m_queue.enqueue(pTrack.get());
+    }
+    m_queue.flush();
+
+    EXPECT_EQ("queued title", titleOfFile());
+    EXPECT_EQ(QList<TrackId>() << trackId, m_queue.takeExportedTrackIds());
+    EXPECT_TRUE(m_queue.takeExportedTrackIds().isEmpty());
+}
+
+TEST_F(TrackMetadataExportQueueTest, SkipUnsynchronizedTrack) {
+    {
+        TrackPointer pTrack = Track::newDummy(QFileInfo(m_fileName), TrackId(1));
+        pTrack->setTitle("title");
+        // Neither imported from nor explicitly exported into the file
+        m_queue.enqueue(pTrack.get());
+    }
+    m_queue.flush();
+
+    EXPECT_TRUE(titleOfFile().isEmpty());
+    EXPECT_TRUE(m_queue.takeExportedTrackIds().isEmpty());
+}
+
+} // anonymous namespace
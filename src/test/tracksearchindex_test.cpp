@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include "library/tracksearchindex.h"
+
+namespace {
+
+class TrackSearchIndexTest : public testing::Test {
+  protected:
+    QVector<TrackId> find(const QString& term) const {
+        return m_index.findCandidates(term);
+    }
+
+    TrackSearchIndex m_index;
+};
+
+TEST_F(TrackSearchIndexTest, findsAllTrigrams) {
+    m_index.update(TrackId(1), QStringList() << "Daft Punk" << "Around the World");
+    m_index.update(TrackId(2), QStringList() << "Björk" << "Army of Me");
+    m_index.update(TrackId(3), QStringList() << "Punkadelic" << "");
+
+    EXPECT_EQ(QVector<TrackId>() << TrackId(1) << TrackId(3), find("punk"));
+    EXPECT_EQ(QVector<TrackId>() << TrackId(1), find("the world"));
+    // Folded like the LIKE operator
+    EXPECT_EQ(QVector<TrackId>() << TrackId(2), find("bjork"));
+    EXPECT_TRUE(find("techno").isEmpty());
+}
+
+TEST_F(TrackSearchIndexTest, noTrigramsAcrossValues) {
+    m_index.update(TrackId(1), QStringList() << "ab" << "cd");
+    EXPECT_TRUE(find("abc").isEmpty());
+}
+
+TEST_F(TrackSearchIndexTest, updateAndRemove) {
+    m_index.update(TrackId(1), QStringList() << "Old Title");
+    m_index.update(TrackId(2), QStringList() << "Other Title");
+    m_index.update(TrackId(1), QStringList() << "New Title");
+    EXPECT_TRUE(find("old").isEmpty());
+    EXPECT_EQ(QVector<TrackId>() << TrackId(1), find("new"));
+    EXPECT_EQ(QVector<TrackId>() << TrackId(2) << TrackId(1), find("title"));
+
+    m_index.remove(TrackId(2));
+    EXPECT_EQ(1, m_index.size());
+    EXPECT_EQ(QVector<TrackId>() << TrackId(1), find("title"));
+}
+
+TEST_F(TrackSearchIndexTest, compaction) {
+    for (int i = 0; i < 5000; ++i) {
+        m_index.update(TrackId(i % 3 + 1), QStringList() << QString("Title %1").arg(i));
+    }
+    EXPECT_EQ(3, m_index.size());
+    EXPECT_EQ(QVector<TrackId>() << TrackId(3) << TrackId(1) << TrackId(2),
+            find("title"));
+    EXPECT_EQ(QVector<TrackId>() << TrackId(2), find("4999"));
+}
+
+} // anonymous namespace
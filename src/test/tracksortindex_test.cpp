@@ -0,0 +1,89 @@
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+#include "library/tracksortindex.h"
+
+namespace {
+
+class TrackSortIndexTest : public testing::Test {
+  protected:
+    // Adds a track with the value in its own row
+    void setValue(int trackId, int value) {
+        auto it = m_rows.constFind(TrackId(trackId));
+        if (it == m_rows.constEnd()) {
+            it = m_rows.insert(TrackId(trackId), m_values.size());
+            m_values.append(value);
+        } else {
+            m_values[it.value()] = value;
+        }
+        m_index.invalidate(TrackId(trackId));
+    }
+
+    void update() {
+        m_index.update(m_rows, [this](int row1, int row2) {
+            return m_values[row1] - m_values[row2];
+        });
+    }
+
+    QHash<TrackId, int> m_rows;
+    QVector<int> m_values;
+    TrackSortIndex m_index;
+};
+
+TEST_F(TrackSortIndexTest, sortsAndMerges) {
+    setValue(1, 30);
+    setValue(2, 10);
+    setValue(3, 20);
+    update();
+    EXPECT_EQ(QVector<TrackId>() << TrackId(2) << TrackId(3) << TrackId(1),
+            m_index.sortedTrackIds());
+
+    // Changed and removed tracks
+    setValue(2, 40);
+    m_rows.remove(TrackId(3));
+    m_index.invalidate(TrackId(3));
+    update();
+    EXPECT_EQ(QVector<TrackId>() << TrackId(1) << TrackId(2),
+            m_index.sortedTrackIds());
+}
+
+TEST_F(TrackSortIndexTest, select) {
+    setValue(1, 30);
+    setValue(2, 10);
+    setValue(3, 20);
+    update();
+    const QSet<TrackId> trackIds = QSet<TrackId>() << TrackId(1) << TrackId(2);
+    EXPECT_EQ(QVector<TrackId>() << TrackId(2) << TrackId(1),
+            m_index.select(trackIds, Qt::AscendingOrder));
+    EXPECT_EQ(QVector<TrackId>() << TrackId(1) << TrackId(2),
+            m_index.select(trackIds, Qt::DescendingOrder));
+    // Tracks that are not indexed follow
+    EXPECT_EQ(QVector<TrackId>() << TrackId(3) << TrackId(4),
+            m_index.select(QSet<TrackId>() << TrackId(3) << TrackId(4),
+                    Qt::AscendingOrder));
+}
+
+TEST_F(TrackSortIndexTest, restoredOrderIsVerified) {
+    QTemporaryDir dir;
+    const QString filePath = dir.path() + "/sort.index";
+    setValue(1, 10);
+    setValue(2, 20);
+    update();
+    ASSERT_TRUE(TrackSortIndex::writeFile(filePath, QList<TrackSortIndex>() << m_index));
+
+    QList<TrackSortIndex> indexes = TrackSortIndex::readFile(filePath);
+    ASSERT_EQ(1, indexes.size());
+    EXPECT_EQ(m_index.sortedTrackIds(), indexes.first().sortedTrackIds());
+
+    // The values have changed while the order was stored
+    m_index = indexes.first();
+    m_values[m_rows.value(TrackId(1))] = 30;
+    m_rows.insert(TrackId(3), m_values.size());
+    m_values.append(0);
+    update();
+    EXPECT_EQ(QVector<TrackId>() << TrackId(3) << TrackId(2) << TrackId(1),
+            m_index.sortedTrackIds());
+}
+
+} // anonymous namespace
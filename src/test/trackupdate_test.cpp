@@ -142,3 +142,20 @@ TEST_F(TrackUpdateTest, parseModifiedDirtyAgain) {
     EXPECT_NE(trackMetadataBefore, trackMetadataAfter);
     EXPECT_EQ(coverInfoBefore, coverInfoAfter);
 }
+
+TEST_F(TrackUpdateTest, engineSnapshotFollowsUpdates) {
+    auto pTrack = newTestTrackParsed();
+    const TrackEngineSnapshotPointer pBefore = pTrack->getEngineSnapshot();
+    ASSERT_TRUE(pBefore != nullptr);
+    EXPECT_EQ(pTrack->getSampleRate(), pBefore->sampleRate);
+
+    pTrack->setBpm(120.0);
+    pTrack->setCuePoint(1000.0);
+
+    const TrackEngineSnapshotPointer pAfter = pTrack->getEngineSnapshot();
+    EXPECT_GT(pAfter->version, pBefore->version);
+    EXPECT_EQ(pTrack->getBeats(), pAfter->pBeats);
+    EXPECT_DOUBLE_EQ(1000.0, pAfter->cuePoint);
+    // A snapshot that has been taken never changes
+    EXPECT_NE(1000.0, pBefore->cuePoint);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <QAtomicInt>
+#include <QThread>
+
+#include "util/triplebuffer.h"
+
+namespace {
+
+// Torn reads show up as a value whose halves do not match
+struct Pair {
+    Pair()
+            : first(0),
+              second(0) {
+    }
+    Pair(int value)
+            : first(value),
+              second(-value) {
+    }
+    int first;
+    int second;
+};
+
+const int kNumWrites = 200000;
+
+class WriterThread : public QThread {
+  public:
+    explicit WriterThread(TripleBuffer<Pair>* pBuffer)
+            : m_pBuffer(pBuffer) {
+    }
+
+  protected:
+    void run() override {
+        for (int i = 1; i <= kNumWrites; ++i) {
+            m_pBuffer->write(Pair(i));
+        }
+    }
+
+  private:
+    TripleBuffer<Pair>* const m_pBuffer;
+};
+
+class ReaderThread : public QThread {
+  public:
+    explicit ReaderThread(const TripleBuffer<Pair>* pBuffer)
+            : m_pBuffer(pBuffer),
+              m_bConsistent(true) {
+    }
+
+    bool isConsistent() const {
+        return m_bConsistent;
+    }
+
+  protected:
+    void run() override {
+        int last = 0;
+        while (last < kNumWrites) {
+            const Pair pair = m_pBuffer->read();
+            if (pair.first != -pair.second || pair.first < last) {
+                m_bConsistent = false;
+                return;
+            }
+            last = pair.first;
+        }
+    }
+
+  private:
+    const TripleBuffer<Pair>* const m_pBuffer;
+    bool m_bConsistent;
+};
+
+TEST(TripleBufferTest, ReadsLastWrite) {
+    TripleBuffer<Pair> buffer;
+    EXPECT_EQ(0, buffer.read().first);
+    for (int i = 1; i <= 5; ++i) {
+        buffer.write(Pair(i));
+        EXPECT_EQ(i, buffer.read().first);
+        EXPECT_EQ(-i, buffer.read().second);
+    }
+}
+
+TEST(TripleBufferTest, ConcurrentReadersSeeCompleteValues) {
+    TripleBuffer<Pair> buffer;
+    ReaderThread reader1(&buffer);
+    ReaderThread reader2(&buffer);
+    WriterThread writer(&buffer);
+    reader1.start();
+    reader2.start();
+    writer.start();
+    writer.wait();
+    reader1.wait();
+    reader2.wait();
+    EXPECT_TRUE(reader1.isConsistent());
+    EXPECT_TRUE(reader2.isConsistent());
+}
+
+} // namespace
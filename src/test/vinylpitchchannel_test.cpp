@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include "engine/vinylpitchchannel.h"
+
+namespace {
+
+VinylPitchSample sampleAt(qint64 millis, double rate) {
+    VinylPitchSample sample;
+    sample.time = mixxx::Duration::fromMillis(millis);
+    sample.rate = rate;
+    return sample;
+}
+
+TEST(VinylPitchChannelTest, NoRateBeforePublish) {
+    VinylPitchChannel channel;
+    double rate = 0.0;
+    EXPECT_FALSE(channel.rateAt(mixxx::Duration::fromMillis(10), &rate));
+}
+
+TEST(VinylPitchChannelTest, ExtrapolateForOneInterval) {
+    VinylPitchChannel channel;
+    channel.publish(sampleAt(1000, 1.0));
+    channel.publish(sampleAt(1010, 1.1));
+
+    double rate = 0.0;
+    EXPECT_TRUE(channel.rateAt(mixxx::Duration::fromMillis(1010), &rate));
+    EXPECT_DOUBLE_EQ(1.1, rate);
+    EXPECT_TRUE(channel.rateAt(mixxx::Duration::fromMillis(1015), &rate));
+    EXPECT_NEAR(1.15, rate, 1e-9);
+    // Not beyond the interval between the samples
+    EXPECT_TRUE(channel.rateAt(mixxx::Duration::fromMillis(1050), &rate));
+    EXPECT_NEAR(1.2, rate, 1e-9);
+}
+
+TEST(VinylPitchChannelTest, OutdatedOrReset) {
+    VinylPitchChannel channel;
+    channel.publish(sampleAt(1000, 1.0));
+
+    double rate = 0.0;
+    EXPECT_TRUE(channel.rateAt(mixxx::Duration::fromMillis(1050), &rate));
+    EXPECT_DOUBLE_EQ(1.0, rate);
+    EXPECT_FALSE(channel.rateAt(mixxx::Duration::fromMillis(1200), &rate));
+
+    channel.reset();
+    EXPECT_FALSE(channel.rateAt(mixxx::Duration::fromMillis(1000), &rate));
+}
+
+} // anonymous namespace
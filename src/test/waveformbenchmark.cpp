@@ -0,0 +1,387 @@
+// Benchmarks of the waveform widgets, which render a frame of all decks
+// offscreen like WaveformWidgetFactory::render() does on screen. Run them
+// with
+//   mixxx-test --benchmark --benchmark_filter=Waveform
+// or with "scons benchmark" like the other benchmarks. The software widgets
+// paint into a QImage and the OpenGL widgets into a QGLFramebufferObject of
+// the size of the widget. Each frame of an OpenGL widget is finished with
+// glFinish(), so the frame time includes the time of the GPU and the
+// numbers of different GPUs can be compared. The label reports the
+// percentiles of the frame time and the OpenGL renderer.
+//
+// The decks play a synthetic track of 5 minutes at 128 BPM. The widget
+// types that WaveformWidgetFactory does not offer on this system, e.g.
+// without OpenGL shaders, are skipped.
+
+#include <gtest/gtest.h>
+#include <benchmark/benchmark.h>
+
+#include <QCoreApplication>
+#include <QDomDocument>
+#include <QGLFramebufferObject>
+#include <QGLWidget>
+#include <QImage>
+#include <QPainter>
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "skin/skincontext.h"
+#include "test/mixxxtest.h"
+#include "track/beatfactory.h"
+#include "track/track.h"
+#include "util/memory.h"
+#include "util/performancetimer.h"
+#include "waveform/sharedglcontext.h"
+#include "waveform/waveform.h"
+#include "waveform/waveformwidgetfactory.h"
+#include "waveform/widgets/waveformwidgetabstract.h"
+
+namespace {
+
+const int kSampleRate = 44100;
+const int kTrackSeconds = 300;
+const int kTrackSamples = kSampleRate * kTrackSeconds * 2;
+const double kBpm = 128.0;
+// Like AnalyzerWaveform
+const int kVisualSampleRate = 441;
+// The frame rate the play position advances with
+const int kFrameRate = 60;
+
+const int kMaxDecks = 4;
+const char* const kGroups[kMaxDecks] = {
+    "[Channel1]", "[Channel2]", "[Channel3]", "[Channel4]",
+};
+
+// A skin with the colors that most skins use
+const char* const kSkinNode =
+        "<Visual>"
+        "<BgColor>#000000</BgColor>"
+        "<SignalColor>#00A2FF</SignalColor>"
+        "<SignalLowColor>#FF2200</SignalLowColor>"
+        "<SignalMidColor>#FFBA00</SignalMidColor>"
+        "<SignalHighColor>#FFFFFF</SignalHighColor>"
+        "<BeatColor>#FFFFFF</BeatColor>"
+        "<AxesColor>#808080</AxesColor>"
+        "<PlayPosColor>#FF0000</PlayPosColor>"
+        "<EndOfTrackColor>#EA0000</EndOfTrackColor>"
+        "</Visual>";
+
+struct WidgetCase {
+    const char* name;
+    WaveformWidgetType::Type type;
+    bool openGl;
+};
+
+const WidgetCase kWidgetCases[] = {
+    {"Software", WaveformWidgetType::SoftwareWaveform, false},
+    {"HSV", WaveformWidgetType::HSVWaveform, false},
+    {"RGB", WaveformWidgetType::RGBWaveform, false},
+    {"RasterRGB", WaveformWidgetType::RasterRGBWaveform, false},
+    {"QtSimple", WaveformWidgetType::QtSimpleWaveform, true},
+    {"Qt", WaveformWidgetType::QtWaveform, true},
+    {"GLSimple", WaveformWidgetType::GLSimpleWaveform, true},
+    {"GLFiltered", WaveformWidgetType::GLFilteredWaveform, true},
+    {"GLRGB", WaveformWidgetType::GLRGBWaveform, true},
+    {"GLSLFiltered", WaveformWidgetType::GLSLFilteredWaveform, true},
+    {"GLSLRGB", WaveformWidgetType::GLSLRGBWaveform, true},
+};
+const int kWidgetCaseCount = sizeof(kWidgetCases) / sizeof(kWidgetCases[0]);
+
+struct Configuration {
+    int width;
+    int height;
+    int zoom;
+    int decks;
+};
+
+// Each dimension is varied on its own from the first configuration
+const Configuration kConfigurations[] = {
+    {1200, 150, 3, 2},
+    // Sizes
+    {600, 100, 3, 2},
+    {1920, 250, 3, 2},
+    // Zoom levels
+    {1200, 150, 1, 2},
+    {1200, 150, 10, 2},
+    // Deck counts
+    {1200, 150, 3, 1},
+    {1200, 150, 3, 4},
+};
+const int kConfigurationCount =
+        sizeof(kConfigurations) / sizeof(kConfigurations[0]);
+
+// A kick on each beat in the low band over a mid band that swells every
+// bar and a noisy high band
+ConstWaveformPointer syntheticWaveform() {
+    WaveformPointer pWaveform(new Waveform(
+            kSampleRate, kTrackSamples, kVisualSampleRate, -1));
+    WaveformData* pData = pWaveform->data();
+    const double visualFramesPerBeat =
+            kVisualSampleRate * 60.0 / kBpm;
+    unsigned int noise = 1;
+    for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+        const double frame = i / 2;
+        const double beatPhase =
+                std::fmod(frame, visualFramesPerBeat) / visualFramesPerBeat;
+        const double barPhase = std::fmod(frame, 4 * visualFramesPerBeat) /
+                (4 * visualFramesPerBeat);
+        noise = noise * 1103515245 + 12345;
+        const unsigned char low = static_cast<unsigned char>(
+                255 * std::exp(-8.0 * beatPhase));
+        const unsigned char mid = static_cast<unsigned char>(
+                60 + 120 * std::sin(M_PI * barPhase));
+        const unsigned char high = static_cast<unsigned char>(
+                40 + (noise >> 16) % 80);
+        pData[i].filtered.low = low;
+        pData[i].filtered.mid = mid;
+        pData[i].filtered.high = high;
+        pData[i].filtered.all = std::max(low, std::max(mid, high));
+    }
+    pWaveform->setCompletion(pWaveform->getDataSize());
+    pWaveform->buildLevels();
+    return pWaveform;
+}
+
+// Created once like in MixxxMainWindow, before the first widget
+WaveformWidgetFactory* waveformWidgetFactory() {
+    static WaveformWidgetFactory* s_pFactory = nullptr;
+    if (!s_pFactory) {
+        s_pFactory = WaveformWidgetFactory::createInstance();
+        if (s_pFactory->isOpenGLAvailable()) {
+            static QGLWidget* s_pContextWidget = new QGLWidget();
+            SharedGLContext::setWidget(s_pContextWidget);
+        }
+        qAddPostRoutine(WaveformWidgetFactory::destroy);
+    }
+    return s_pFactory;
+}
+
+bool isAvailable(const WidgetCase& widgetCase) {
+    for (const auto& handle : waveformWidgetFactory()->getAvailableTypes()) {
+        if (handle.getType() == widgetCase.type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QString frameTimeLabel(std::vector<double>* pFrameMillis) {
+    if (pFrameMillis->empty()) {
+        return QString();
+    }
+    std::sort(pFrameMillis->begin(), pFrameMillis->end());
+    QStringList percentiles;
+    for (int percentile : {50, 90, 99}) {
+        const size_t index = std::min(pFrameMillis->size() - 1,
+                pFrameMillis->size() * percentile / 100);
+        percentiles << QString("p%1 %2 ms").arg(
+                QString::number(percentile),
+                QString::number((*pFrameMillis)[index], 'f', 3));
+    }
+    return percentiles.join(" ");
+}
+
+// The decks of a frame with their controls and the target they are
+// rendered into
+class WaveformBenchmarkEnvironment : public MixxxTest {
+  public:
+    WaveformBenchmarkEnvironment(const WidgetCase& widgetCase,
+                                 const Configuration& configuration)
+            : m_widgetCase(widgetCase),
+              m_configuration(configuration),
+              m_pTrack(Track::newTemporary()) {
+        m_pTrack->setSampleRate(kSampleRate);
+        m_pTrack->setDuration(static_cast<double>(kTrackSeconds));
+        m_pTrack->setWaveform(syntheticWaveform());
+        m_pTrack->setBeats(BeatFactory::makeBeatGrid(*m_pTrack, kBpm, 0.0));
+
+        QDomDocument document;
+        document.setContent(QString(kSkinNode));
+        SkinContext context(config(), QString());
+
+        for (int i = 0; i < configuration.decks; ++i) {
+            addDeck(kGroups[i], document.documentElement(), context);
+        }
+    }
+
+    ~WaveformBenchmarkEnvironment() override {
+        for (auto& deck : m_decks) {
+            if (deck.pFramebuffer) {
+                makeCurrent(deck);
+                deck.pFramebuffer.reset();
+            }
+            delete deck.pWidget;
+        }
+    }
+
+    bool isValid() const {
+        for (const auto& deck : m_decks) {
+            if (!deck.pWidget ||
+                    (m_widgetCase.openGl && !deck.pFramebuffer)) {
+                return false;
+            }
+        }
+        return !m_decks.empty();
+    }
+
+    QString renderer() const {
+        if (!m_widgetCase.openGl || m_decks.empty()) {
+            return "QImage";
+        }
+        makeCurrent(m_decks.front());
+        return QString(reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    }
+
+    // Advances the play positions by one frame and renders all decks
+    void renderFrame() {
+        for (size_t i = 0; i < m_decks.size(); ++i) {
+            // The decks play in different places of the track
+            m_playPositions[kGroups[i]] = 0.1 +
+                    std::fmod(0.2 * i + static_cast<double>(m_frame) /
+                            (kFrameRate * kTrackSeconds), 0.8);
+        }
+        ++m_frame;
+        for (auto& deck : m_decks) {
+            deck.pWidget->preRender(m_playPositions);
+        }
+        for (auto& deck : m_decks) {
+            if (deck.pFramebuffer) {
+                makeCurrent(deck);
+                {
+                    QPainter painter(deck.pFramebuffer.get());
+                    deck.pWidget->draw(&painter, nullptr);
+                }
+                glFinish();
+            } else {
+                QPainter painter(&deck.image);
+                deck.pWidget->draw(&painter, nullptr);
+            }
+        }
+    }
+
+  private:
+    struct Deck {
+        WaveformWidgetAbstract* pWidget;
+        std::unique_ptr<QGLFramebufferObject> pFramebuffer;
+        QImage image;
+    };
+
+    void TestBody() override {}
+
+    void addDeck(const char* group, const QDomNode& node,
+                 const SkinContext& context) {
+        // Set by EngineBuffer and the rate and gain controls
+        addControl(group, "track_samples", kTrackSamples);
+        addControl(group, "track_samplerate", kSampleRate);
+        addControl(group, "play", 1.0);
+        addControl(group, "rate", 0.0);
+        addControl(group, "rateRange", 0.08);
+        addControl(group, "rate_dir", 1.0);
+        addControl(group, "total_gain", 0.5);
+
+        Deck deck;
+        deck.pWidget = waveformWidgetFactory()->createUnmanagedWaveformWidget(
+                m_widgetCase.type, group);
+        m_decks.push_back(std::move(deck));
+        Deck& added = m_decks.back();
+        if (!added.pWidget) {
+            return;
+        }
+        const int width = m_configuration.width;
+        const int height = m_configuration.height;
+        if (m_widgetCase.openGl) {
+            makeCurrent(added);
+            added.pFramebuffer = std::make_unique<QGLFramebufferObject>(
+                    width, height, QGLFramebufferObject::CombinedDepthStencil);
+            if (!added.pFramebuffer->isValid()) {
+                added.pFramebuffer.reset();
+            }
+        } else {
+            added.image = QImage(width, height,
+                    QImage::Format_ARGB32_Premultiplied);
+        }
+        added.pWidget->setup(node, context);
+        added.pWidget->resize(width, height);
+        added.pWidget->setZoom(m_configuration.zoom);
+        added.pWidget->setDisplayBeatGrid(true);
+        added.pWidget->setTrack(m_pTrack);
+    }
+
+    void addControl(const char* group, const char* item, double value) {
+        m_controls.push_back(std::make_unique<ControlObject>(
+                ConfigKey(group, item)));
+        m_controls.back()->set(value);
+    }
+
+    static void makeCurrent(const Deck& deck) {
+        QGLWidget* pGlWidget = dynamic_cast<QGLWidget*>(deck.pWidget->getWidget());
+        if (pGlWidget) {
+            pGlWidget->makeCurrent();
+        }
+    }
+
+    const WidgetCase& m_widgetCase;
+    const Configuration& m_configuration;
+    TrackPointer m_pTrack;
+    std::vector<std::unique_ptr<ControlObject>> m_controls;
+    std::vector<Deck> m_decks;
+    QHash<QString, double> m_playPositions;
+    int m_frame = 0;
+};
+
+static void WaveformArguments(benchmark::internal::Benchmark* b) {
+    for (int widgetCase = 0; widgetCase < kWidgetCaseCount; ++widgetCase) {
+        for (int configuration = 0; configuration < kConfigurationCount;
+                ++configuration) {
+            b->ArgPair(widgetCase, configuration);
+        }
+    }
+}
+
+// One frame of all decks per iteration
+static void BM_WaveformWidgetRender(benchmark::State& state) {
+    const WidgetCase& widgetCase = kWidgetCases[state.range_x()];
+    const Configuration& configuration = kConfigurations[state.range_y()];
+    const QString name = QString("%1 %2x%3 zoom %4 %5 decks").arg(
+            widgetCase.name,
+            QString::number(configuration.width),
+            QString::number(configuration.height),
+            QString::number(configuration.zoom),
+            QString::number(configuration.decks));
+    if (!isAvailable(widgetCase)) {
+        while (state.KeepRunning()) {
+        }
+        state.SetLabel(QString("%1 not available").arg(name).toStdString());
+        return;
+    }
+
+    WaveformBenchmarkEnvironment environment(widgetCase, configuration);
+    if (!environment.isValid()) {
+        while (state.KeepRunning()) {
+        }
+        state.SetLabel(QString("%1 failed to initialize").arg(name).toStdString());
+        return;
+    }
+    // Uploads the textures and compiles the shaders
+    environment.renderFrame();
+
+    std::vector<double> frameMillis;
+    frameMillis.reserve(100000);
+    PerformanceTimer timer;
+    while (state.KeepRunning()) {
+        timer.start();
+        environment.renderFrame();
+        frameMillis.push_back(timer.elapsed().toDoubleMillis());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(QString("%1, %2, %3").arg(
+            name, frameTimeLabel(&frameMillis),
+            environment.renderer()).toStdString());
+}
+BENCHMARK(BM_WaveformWidgetRender)->Apply(WaveformArguments)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "waveform/waveform.h"
+
+namespace {
+
+class WaveformTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_dir.isValid());
+    }
+
+    QString filePath() const {
+        return m_dir.path() + "/waveform";
+    }
+
+    static Waveform* makeWaveform() {
+        Waveform* pWaveform = new Waveform(44100, 44100 * 30, 441, -1);
+        WaveformData* pData = pWaveform->data();
+        for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+            pData[i].filtered.low = i % 251;
+            pData[i].filtered.mid = i % 241;
+            pData[i].filtered.high = i % 239;
+            pData[i].filtered.all = i % 233;
+        }
+        pWaveform->setCompletion(pWaveform->getDataSize());
+        return pWaveform;
+    }
+
+    QTemporaryDir m_dir;
+};
+
+TEST_F(WaveformTest, mappedFileRoundTrip) {
+    std::unique_ptr<Waveform> pWritten(makeWaveform());
+    ASSERT_TRUE(pWritten->writeMappedFile(filePath()));
+
+    Waveform mapped;
+    ASSERT_TRUE(mapped.readMappedFile(filePath()));
+    EXPECT_TRUE(mapped.isValid());
+    EXPECT_EQ(Waveform::SaveState::Saved, mapped.saveState());
+    EXPECT_EQ(pWritten->getDataSize(), mapped.getDataSize());
+    EXPECT_EQ(pWritten->getDataSize(), mapped.getCompletion());
+    EXPECT_EQ(pWritten->getTextureStride(), mapped.getTextureStride());
+    EXPECT_EQ(pWritten->getTextureSize(), mapped.getTextureSize());
+    EXPECT_DOUBLE_EQ(pWritten->getAudioVisualRatio(), mapped.getAudioVisualRatio());
+    for (int i = 0; i < mapped.getDataSize(); ++i) {
+        ASSERT_EQ(pWritten->get(i).m_i, mapped.get(i).m_i) << i;
+    }
+    // The padding of the texture reads as zero
+    EXPECT_EQ(0, mapped.data()[mapped.getTextureSize() - 1].m_i);
+}
+
+TEST_F(WaveformTest, rejectsOtherFiles) {
+    std::unique_ptr<Waveform> pWritten(makeWaveform());
+    QFile file(filePath());
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(qCompress(pWritten->toByteArray()));
+    file.close();
+
+    Waveform mapped;
+    EXPECT_FALSE(mapped.readMappedFile(filePath()));
+    EXPECT_FALSE(mapped.isValid());
+}
+
+TEST_F(WaveformTest, rejectsTruncatedFiles) {
+    std::unique_ptr<Waveform> pWritten(makeWaveform());
+    ASSERT_TRUE(pWritten->writeMappedFile(filePath()));
+    QFile file(filePath());
+    ASSERT_TRUE(file.resize(file.size() / 2));
+
+    Waveform mapped;
+    EXPECT_FALSE(mapped.readMappedFile(filePath()));
+    EXPECT_FALSE(mapped.isValid());
+}
+
+TEST_F(WaveformTest, levelsKeepTheMaximum) {
+    std::unique_ptr<Waveform> pWaveform(makeWaveform());
+    ASSERT_EQ(1, pWaveform->getLevelCount());
+    pWaveform->buildLevels();
+    ASSERT_LT(1, pWaveform->getLevelCount());
+
+    for (int level = 1; level < pWaveform->getLevelCount(); ++level) {
+        const WaveformData* pBelow = pWaveform->getLevelData(level - 1);
+        const int belowSize = pWaveform->getLevelDataSize(level - 1);
+        const WaveformData* pData = pWaveform->getLevelData(level);
+        const int dataSize = pWaveform->getLevelDataSize(level);
+        ASSERT_EQ(0, dataSize % 2);
+        ASSERT_EQ((belowSize / 2 + 1) / 2 * 2, dataSize);
+        for (int i = 0; i < dataSize; ++i) {
+            const int first = 2 * i - i % 2;
+            unsigned char low = pBelow[first].filtered.low;
+            unsigned char all = pBelow[first].filtered.all;
+            if (first + 2 < belowSize) {
+                low = std::max(low, pBelow[first + 2].filtered.low);
+                all = std::max(all, pBelow[first + 2].filtered.all);
+            }
+            ASSERT_EQ(low, pData[i].filtered.low) << level << " " << i;
+            ASSERT_EQ(all, pData[i].filtered.all) << level << " " << i;
+        }
+    }
+}
+
+TEST_F(WaveformTest, levelForSamplesPerPixel) {
+    std::unique_ptr<Waveform> pWaveform(makeWaveform());
+    pWaveform->buildLevels();
+    EXPECT_EQ(0, pWaveform->getLevelForSamplesPerPixel(0.5));
+    EXPECT_EQ(0, pWaveform->getLevelForSamplesPerPixel(2.0));
+    EXPECT_EQ(1, pWaveform->getLevelForSamplesPerPixel(4.0));
+    EXPECT_EQ(3, pWaveform->getLevelForSamplesPerPixel(17.0));
+    EXPECT_EQ(pWaveform->getLevelCount() - 1,
+            pWaveform->getLevelForSamplesPerPixel(1e9));
+}
+
+TEST_F(WaveformTest, mappedFileKeepsTheLevels) {
+    std::unique_ptr<Waveform> pWritten(makeWaveform());
+    pWritten->buildLevels();
+    ASSERT_TRUE(pWritten->writeMappedFile(filePath()));
+
+    Waveform mapped;
+    ASSERT_TRUE(mapped.readMappedFile(filePath()));
+    ASSERT_EQ(pWritten->getLevelCount(), mapped.getLevelCount());
+    const int level = mapped.getLevelCount() - 1;
+    ASSERT_EQ(pWritten->getLevelDataSize(level), mapped.getLevelDataSize(level));
+    for (int i = 0; i < mapped.getLevelDataSize(level); ++i) {
+        ASSERT_EQ(pWritten->getLevelData(level)[i].m_i,
+                mapped.getLevelData(level)[i].m_i) << i;
+    }
+}
+
+} // anonymous namespace
@@ -5,7 +5,12 @@
  *      Author: vittorio
  */
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 #include <QtDebug>
+#include <QtEndian>
 #include <QtGlobal>
 #include <QMutexLocker>
 
@@ -29,15 +34,129 @@ bool BeatLessThan(const Beat& beat1, const Beat& beat2) {
     return beat1.frame_position() < beat2.frame_position();
 }
 
+// During playback a lookup is at most this many beats away from the previous
+// one. Farther jumps, e.g. seeks, fall back to a binary search.
+const int kMaxCursorSteps = 4;
+
+namespace {
+
+// The compact format starts with a magic number, which a serialized protobuf
+// BeatMap never starts with, and the version of the format:
+//   magic[4] version[1] beatCount[varint] lastFrame[varint] bpm[8]
+// The beats follow, each as the distance to the previous one with its flags:
+//   token[varint] = zigzag(distance) << kTokenFlagBits | flags
+// The token of a run is followed by the number of beats that have the same
+// distance and flags, so the beats of a constant tempo take a few bytes.
+const char kCompactMagic[4] = { 'M', 'X', 'B', 'M' };
+const quint8 kCompactFormatVersion = 1;
+
+const int kTokenFlagBits = 4;
+const quint64 kRunFlag = 0x1;
+const quint64 kDisabledFlag = 0x2;
+const int kSourceShift = 2;
+const quint64 kSourceMask = 0x3;
+
+// Shorter runs are stored as single beats
+const int kMinRunLength = 3;
+
+struct CompactHeader {
+    int beatCount;
+    double lastFrame;
+    double bpm;
+};
+
+quint64 zigzagEncode(qint64 value) {
+    return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+}
+
+qint64 zigzagDecode(quint64 value) {
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+void appendVarint(QByteArray* pBytes, quint64 value) {
+    while (value >= 0x80) {
+        pBytes->append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    pBytes->append(static_cast<char>(value));
+}
+
+bool readVarint(const QByteArray& bytes, int* pOffset, quint64* pValue) {
+    quint64 value = 0;
+    for (int shift = 0; shift < 64 && *pOffset < bytes.size(); shift += 7) {
+        const quint8 byte = static_cast<quint8>(bytes[(*pOffset)++]);
+        value |= static_cast<quint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *pValue = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+void appendDouble(QByteArray* pBytes, double value) {
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const quint64 littleEndianBits = qToLittleEndian(bits);
+    pBytes->append(reinterpret_cast<const char*>(&littleEndianBits),
+            sizeof(littleEndianBits));
+}
+
+bool readDouble(const QByteArray& bytes, int* pOffset, double* pValue) {
+    quint64 littleEndianBits;
+    if (*pOffset + static_cast<int>(sizeof(littleEndianBits)) > bytes.size()) {
+        return false;
+    }
+    std::memcpy(&littleEndianBits, bytes.constData() + *pOffset,
+            sizeof(littleEndianBits));
+    *pOffset += sizeof(littleEndianBits);
+    const quint64 bits = qFromLittleEndian(littleEndianBits);
+    std::memcpy(pValue, &bits, sizeof(bits));
+    return true;
+}
+
+bool isCompact(const QByteArray& byteArray) {
+    return byteArray.startsWith(
+            QByteArray::fromRawData(kCompactMagic, sizeof(kCompactMagic)));
+}
+
+bool readCompactHeader(const QByteArray& byteArray, int* pOffset,
+        CompactHeader* pHeader) {
+    *pOffset = sizeof(kCompactMagic);
+    if (*pOffset >= byteArray.size() ||
+            static_cast<quint8>(byteArray[*pOffset]) != kCompactFormatVersion) {
+        return false;
+    }
+    ++*pOffset;
+    quint64 beatCount;
+    quint64 lastFrame;
+    if (!readVarint(byteArray, pOffset, &beatCount) ||
+            beatCount > static_cast<quint64>(std::numeric_limits<int>::max()) ||
+            !readVarint(byteArray, pOffset, &lastFrame) ||
+            !readDouble(byteArray, pOffset, &pHeader->bpm)) {
+        return false;
+    }
+    pHeader->beatCount = static_cast<int>(beatCount);
+    pHeader->lastFrame = zigzagDecode(lastFrame);
+    return true;
+}
+
+quint64 beatFlags(const Beat& beat) {
+    quint64 flags = static_cast<quint64>(beat.source()) << kSourceShift;
+    if (!beat.enabled()) {
+        flags |= kDisabledFlag;
+    }
+    return flags;
+}
+
+} // anonymous namespace
+
 class BeatMapIterator : public BeatIterator {
   public:
-    BeatMapIterator(BeatList::const_iterator start, BeatList::const_iterator end)
+    BeatMapIterator(std::vector<double>::const_iterator start,
+                    std::vector<double>::const_iterator end)
             : m_currentBeat(start),
               m_endBeat(end) {
-        // Advance to the first enabled beat.
-        while (m_currentBeat != m_endBeat && !m_currentBeat->enabled()) {
-            ++m_currentBeat;
-        }
     }
 
     virtual bool hasNext() const {
@@ -45,17 +164,12 @@ class BeatMapIterator : public BeatIterator {
     }
 
     virtual double next() {
-        double beat = framesToSamples(m_currentBeat->frame_position());
-        ++m_currentBeat;
-        while (m_currentBeat != m_endBeat && !m_currentBeat->enabled()) {
-            ++m_currentBeat;
-        }
-        return beat;
+        return *m_currentBeat++ * kFrameSize;
     }
 
   private:
-    BeatList::const_iterator m_currentBeat;
-    BeatList::const_iterator m_endBeat;
+    std::vector<double>::const_iterator m_currentBeat;
+    std::vector<double>::const_iterator m_endBeat;
 };
 
 BeatMap::BeatMap(const Track& track, SINT iSampleRate)
@@ -89,23 +203,51 @@ BeatMap::BeatMap (const BeatMap& other)
           m_iSampleRate(other.m_iSampleRate),
           m_dCachedBpm(other.m_dCachedBpm),
           m_dLastFrame(other.m_dLastFrame),
-          m_beats(other.m_beats) {
+          m_encodedBeats(other.m_encodedBeats),
+          m_beats(other.m_beats),
+          m_beatFrames(other.m_beatFrames) {
     moveToThread(other.thread());
 }
 
 QByteArray BeatMap::toByteArray() const {
     QMutexLocker locker(&m_mutex);
-    // No guarantees BeatLists are made of a data type which located adjacent
-    // items in adjacent memory locations.
-    mixxx::track::io::BeatMap map;
-
-    for (int i = 0; i < m_beats.size(); ++i) {
-        map.add_beat()->CopyFrom(m_beats[i]);
+    if (!m_encodedBeats.isEmpty()) {
+        // Unchanged since it has been read
+        return m_encodedBeats;
+    }
+
+    QByteArray byteArray(kCompactMagic, sizeof(kCompactMagic));
+    byteArray.append(static_cast<char>(kCompactFormatVersion));
+    appendVarint(&byteArray, m_beats.size());
+    appendVarint(&byteArray, zigzagEncode(
+            m_beats.isEmpty() ? 0 : m_beats.last().frame_position()));
+    appendDouble(&byteArray, m_dCachedBpm);
+
+    qint64 previousFrame = 0;
+    int index = 0;
+    while (index < m_beats.size()) {
+        const Beat& beat = m_beats[index];
+        const qint64 distance = beat.frame_position() - previousFrame;
+        const quint64 flags = beatFlags(beat);
+        int runLength = 1;
+        while (index + runLength < m_beats.size() &&
+                m_beats[index + runLength].frame_position() -
+                        m_beats[index + runLength - 1].frame_position() == distance &&
+                beatFlags(m_beats[index + runLength]) == flags) {
+            ++runLength;
+        }
+        const quint64 token = (zigzagEncode(distance) << kTokenFlagBits) | flags;
+        if (runLength >= kMinRunLength) {
+            appendVarint(&byteArray, token | kRunFlag);
+            appendVarint(&byteArray, runLength);
+        } else {
+            runLength = 1;
+            appendVarint(&byteArray, token);
+        }
+        index += runLength;
+        previousFrame = m_beats[index - 1].frame_position();
     }
-
-    std::string output;
-    map.SerializeToString(&output);
-    return QByteArray(output.data(), output.length());
+    return byteArray;
 }
 
 BeatsPointer BeatMap::clone() const {
@@ -115,6 +257,23 @@ BeatsPointer BeatMap::clone() const {
 }
 
 bool BeatMap::readByteArray(const QByteArray& byteArray) {
+    if (isCompact(byteArray)) {
+        int offset;
+        CompactHeader header;
+        if (!readCompactHeader(byteArray, &offset, &header)) {
+            qWarning() << "ERROR: Could not read the header of a BeatMap of size"
+                    << byteArray.size();
+            return false;
+        }
+        if (header.beatCount > 0) {
+            m_dCachedBpm = header.bpm;
+            m_dLastFrame = header.lastFrame;
+            m_encodedBeats = byteArray;
+        }
+        return true;
+    }
+
+    // The protobuf BeatMap of older versions
     mixxx::track::io::BeatMap map;
     if (!map.ParseFromArray(byteArray.constData(), byteArray.size())) {
         qDebug() << "ERROR: Could not parse BeatMap from QByteArray of size"
@@ -129,6 +288,64 @@ bool BeatMap::readByteArray(const QByteArray& byteArray) {
     return true;
 }
 
+void BeatMap::decodeBeats() const {
+    if (m_encodedBeats.isEmpty()) {
+        return;
+    }
+    QByteArray encodedBeats;
+    encodedBeats.swap(m_encodedBeats);
+
+    int offset;
+    CompactHeader header;
+    bool valid = readCompactHeader(encodedBeats, &offset, &header);
+    DEBUG_ASSERT(valid);
+    m_beats.reserve(header.beatCount);
+    qint64 frame = 0;
+    while (valid && m_beats.size() < header.beatCount) {
+        quint64 token;
+        quint64 runLength = 1;
+        if (!readVarint(encodedBeats, &offset, &token) ||
+                ((token & kRunFlag) &&
+                        !readVarint(encodedBeats, &offset, &runLength))) {
+            valid = false;
+            break;
+        }
+        const qint64 distance = zigzagDecode(token >> kTokenFlagBits);
+        const int source = static_cast<int>((token >> kSourceShift) & kSourceMask);
+        if (runLength > static_cast<quint64>(header.beatCount - m_beats.size()) ||
+                !mixxx::track::io::Source_IsValid(source) ||
+                qAbs(distance) > std::numeric_limits<qint32>::max()) {
+            valid = false;
+            break;
+        }
+        const qint64 lastFrame = frame + distance * static_cast<qint64>(runLength);
+        if (lastFrame < std::numeric_limits<qint32>::min() ||
+                lastFrame > std::numeric_limits<qint32>::max()) {
+            valid = false;
+            break;
+        }
+        Beat beat;
+        if (token & kDisabledFlag) {
+            beat.set_enabled(false);
+        }
+        if (source != mixxx::track::io::ANALYZER) {
+            beat.set_source(static_cast<mixxx::track::io::Source>(source));
+        }
+        // A run of a constant tempo
+        for (quint64 i = 0; i < runLength; ++i) {
+            frame += distance;
+            beat.set_frame_position(frame);
+            m_beats.append(beat);
+        }
+    }
+    if (!valid || offset != encodedBeats.size()) {
+        qWarning() << "ERROR: Could not decode the beats of a BeatMap of size"
+                << encodedBeats.size();
+        m_beats.clear();
+    }
+    updateBeatFrames();
+}
+
 void BeatMap::createFromBeatVector(const QVector<double>& beats) {
     if (beats.isEmpty()) {
        return;
@@ -166,7 +383,8 @@ void BeatMap::setSubVersion(QString subVersion) {
 }
 
 bool BeatMap::isValid() const {
-    return m_iSampleRate > 0 && m_beats.size() > 0;
+    return m_iSampleRate > 0 &&
+            (m_beats.size() > 0 || !m_encodedBeats.isEmpty());
 }
 
 double BeatMap::findNextBeat(double dSamples) const {
@@ -178,13 +396,17 @@ double BeatMap::findPrevBeat(double dSamples) const {
 }
 
 double BeatMap::findClosestBeat(double dSamples) const {
+    return findClosestBeat(dSamples, nullptr);
+}
+
+double BeatMap::findClosestBeat(double dSamples, BeatCursor* pCursor) const {
     QMutexLocker locker(&m_mutex);
     if (!isValid()) {
         return -1;
     }
     double prevBeat;
     double nextBeat;
-    findPrevNextBeats(dSamples, &prevBeat, &nextBeat);
+    findPrevNextBeats(dSamples, &prevBeat, &nextBeat, pCursor);
     if (prevBeat == -1) {
         // If both values are -1, we correctly return -1.
         return nextBeat;
@@ -194,199 +416,170 @@ double BeatMap::findClosestBeat(double dSamples) const {
     return (nextBeat - dSamples > dSamples - prevBeat) ? prevBeat : nextBeat;
 }
 
-double BeatMap::findNthBeat(double dSamples, int n) const {
-    QMutexLocker locker(&m_mutex);
-
-    if (!isValid() || n == 0) {
-        return -1;
+int BeatMap::lowerBoundBeatIndex(double dFrame, BeatCursor* pCursor) const {
+    const int size = static_cast<int>(m_beatFrames.size());
+    if (pCursor) {
+        int index = math_clamp(pCursor->m_index, 0, size);
+        for (int step = 0; step < kMaxCursorSteps; ++step) {
+            if (index > 0 && m_beatFrames[index - 1] >= dFrame) {
+                --index;
+            } else if (index < size && m_beatFrames[index] < dFrame) {
+                ++index;
+            } else {
+                pCursor->m_index = index;
+                return index;
+            }
+        }
+    }
+    const int index = static_cast<int>(std::lower_bound(
+            m_beatFrames.begin(), m_beatFrames.end(), dFrame) - m_beatFrames.begin());
+    if (pCursor) {
+        pCursor->m_index = index;
     }
+    return index;
+}
+
+void BeatMap::findBeatIndices(double dSamples, BeatCursor* pCursor,
+                              int* pPrevIndex, int* pNextIndex,
+                              int* pOnBeatIndex) const {
+    *pPrevIndex = -1;
+    *pNextIndex = -1;
+    *pOnBeatIndex = -1;
 
-    Beat beat;
     // Reduce sample offset to a frame offset.
-    beat.set_frame_position(samplesToFrames(dSamples));
+    const double dFrame = samplesToFrames(dSamples);
 
-    // it points at the first occurence of beat or the next largest beat
-    BeatList::const_iterator it =
-            qLowerBound(m_beats.begin(), m_beats.end(), beat, BeatLessThan);
+    // index points at the first occurence of the frame or the next largest beat
+    int index = lowerBoundBeatIndex(dFrame, pCursor);
 
     // If the position is within 1/10th of a second of the next or previous
     // beat, pretend we are on that beat.
     const double kFrameEpsilon = 0.1 * m_iSampleRate;
 
     // Back-up by one.
-    if (it != m_beats.begin()) {
-        --it;
+    if (index > 0) {
+        --index;
     }
 
     // Scan forward to find whether we are on a beat.
-    BeatList::const_iterator on_beat = m_beats.end();
-    BeatList::const_iterator previous_beat = m_beats.end();
-    BeatList::const_iterator next_beat = m_beats.end();
-    for (; it != m_beats.end(); ++it) {
-        qint32 delta = it->frame_position() - beat.frame_position();
+    const int size = static_cast<int>(m_beatFrames.size());
+    for (; index < size; ++index) {
+        const double delta = m_beatFrames[index] - dFrame;
 
         // We are "on" this beat.
-        if (abs(delta) < kFrameEpsilon) {
-            on_beat = it;
+        if (fabs(delta) < kFrameEpsilon) {
+            *pOnBeatIndex = index;
             break;
         }
 
         if (delta < 0) {
             // If we are not on the beat and delta < 0 then this beat comes
             // before our current position.
-            previous_beat = it;
+            *pPrevIndex = index;
         } else {
             // If we are past the beat and we aren't on it then this beat comes
             // after our current position.
-            next_beat = it;
+            *pNextIndex = index;
             // Stop because we have everything we need now.
             break;
         }
     }
+}
+
+double BeatMap::findNthBeat(double dSamples, int n) const {
+    return findNthBeat(dSamples, n, nullptr);
+}
+
+double BeatMap::findNthBeat(double dSamples, int n, BeatCursor* pCursor) const {
+    QMutexLocker locker(&m_mutex);
+    decodeBeats();
+
+    if (!isValid() || n == 0) {
+        return -1;
+    }
+
+    int prevIndex;
+    int nextIndex;
+    int onBeatIndex;
+    findBeatIndices(dSamples, pCursor, &prevIndex, &nextIndex, &onBeatIndex);
 
     // If we are within epsilon samples of a beat then the immediately next and
     // previous beats are the beat we are on.
-    if (on_beat != m_beats.end()) {
-        next_beat = on_beat;
-        previous_beat = on_beat;
+    if (onBeatIndex != -1) {
+        nextIndex = onBeatIndex;
+        prevIndex = onBeatIndex;
     }
 
-    if (n > 0) {
-        for (; next_beat != m_beats.end(); ++next_beat) {
-            if (!next_beat->enabled()) {
-                continue;
-            }
-            if (n == 1) {
-                // Return a sample offset
-                return framesToSamples(next_beat->frame_position());
-            }
-            --n;
-        }
-    } else if (n < 0 && previous_beat != m_beats.end()) {
-        for (; true; --previous_beat) {
-            if (previous_beat->enabled()) {
-                if (n == -1) {
-                    // Return a sample offset
-                    return framesToSamples(previous_beat->frame_position());
-                }
-                ++n;
-            }
-
-            // Don't step before the start of the list.
-            if (previous_beat == m_beats.begin()) {
-                break;
-            }
-        }
+    int index = -1;
+    if (n > 0 && nextIndex != -1) {
+        index = nextIndex + n - 1;
+    } else if (n < 0 && prevIndex != -1) {
+        index = prevIndex + n + 1;
     }
-    return -1;
+    if (index < 0 || index >= static_cast<int>(m_beatFrames.size())) {
+        return -1;
+    }
+    // Return a sample offset
+    return framesToSamples(m_beatFrames[index]);
 }
 
 bool BeatMap::findPrevNextBeats(double dSamples,
                                 double* dpPrevBeatSamples,
                                 double* dpNextBeatSamples) const {
+    return findPrevNextBeats(dSamples, dpPrevBeatSamples, dpNextBeatSamples,
+                             nullptr);
+}
+
+bool BeatMap::findPrevNextBeats(double dSamples,
+                                double* dpPrevBeatSamples,
+                                double* dpNextBeatSamples,
+                                BeatCursor* pCursor) const {
     QMutexLocker locker(&m_mutex);
+    decodeBeats();
 
+    *dpPrevBeatSamples = -1;
+    *dpNextBeatSamples = -1;
     if (!isValid()) {
-        *dpPrevBeatSamples = -1;
-        *dpNextBeatSamples = -1;
         return false;
     }
 
-    Beat beat;
-    // Reduce sample offset to a frame offset.
-    beat.set_frame_position(samplesToFrames(dSamples));
-
-    // it points at the first occurence of beat or the next largest beat
-    BeatList::const_iterator it =
-            qLowerBound(m_beats.begin(), m_beats.end(), beat, BeatLessThan);
-
-    // If the position is within 1/10th of a second of the next or previous
-    // beat, pretend we are on that beat.
-    const double kFrameEpsilon = 0.1 * m_iSampleRate;
-
-    // Back-up by one.
-    if (it != m_beats.begin()) {
-        --it;
-    }
-
-    // Scan forward to find whether we are on a beat.
-    BeatList::const_iterator on_beat = m_beats.end();
-    BeatList::const_iterator previous_beat = m_beats.end();
-    BeatList::const_iterator next_beat = m_beats.end();
-    for (; it != m_beats.end(); ++it) {
-        qint32 delta = it->frame_position() - beat.frame_position();
-
-        // We are "on" this beat.
-        if (abs(delta) < kFrameEpsilon) {
-            on_beat = it;
-            break;
-        }
+    int prevIndex;
+    int nextIndex;
+    int onBeatIndex;
+    findBeatIndices(dSamples, pCursor, &prevIndex, &nextIndex, &onBeatIndex);
 
-        if (delta < 0) {
-            // If we are not on the beat and delta < 0 then this beat comes
-            // before our current position.
-            previous_beat = it;
-        } else {
-            // If we are past the beat and we aren't on it then this beat comes
-            // after our current position.
-            next_beat = it;
-            // Stop because we have everything we need now.
-            break;
-        }
+    // If we are within epsilon samples of a beat then the immediately
+    // previous beat is the beat we are on.
+    if (onBeatIndex != -1) {
+        prevIndex = onBeatIndex;
+        nextIndex = onBeatIndex + 1;
     }
 
-    // If we are within epsilon samples of a beat then the immediately next and
-    // previous beats are the beat we are on.
-    if (on_beat != m_beats.end()) {
-        previous_beat = on_beat;
-        next_beat = on_beat + 1;
+    if (nextIndex != -1 && nextIndex < static_cast<int>(m_beatFrames.size())) {
+        *dpNextBeatSamples = framesToSamples(m_beatFrames[nextIndex]);
     }
-
-    *dpPrevBeatSamples = -1;
-    *dpNextBeatSamples = -1;
-
-    for (; next_beat != m_beats.end(); ++next_beat) {
-        if (!next_beat->enabled()) {
-            continue;
-        }
-        *dpNextBeatSamples = framesToSamples(next_beat->frame_position());
-        break;
-    }
-    if (previous_beat != m_beats.end()) {
-        for (; true; --previous_beat) {
-            if (previous_beat->enabled()) {
-                *dpPrevBeatSamples = framesToSamples(previous_beat->frame_position());
-                break;
-            }
-
-            // Don't step before the start of the list.
-            if (previous_beat == m_beats.begin()) {
-                break;
-            }
-        }
+    if (prevIndex != -1) {
+        *dpPrevBeatSamples = framesToSamples(m_beatFrames[prevIndex]);
     }
     return *dpPrevBeatSamples != -1 && *dpNextBeatSamples != -1;
 }
 
 std::unique_ptr<BeatIterator> BeatMap::findBeats(double startSample, double stopSample) const {
     QMutexLocker locker(&m_mutex);
+    decodeBeats();
     //startSample and stopSample are sample offsets, converting them to
     //frames
     if (!isValid() || startSample > stopSample) {
         return std::unique_ptr<BeatIterator>();
     }
 
-    Beat startBeat, stopBeat;
-    startBeat.set_frame_position(samplesToFrames(startSample));
-    stopBeat.set_frame_position(samplesToFrames(stopSample));
+    std::vector<double>::const_iterator curBeat = std::lower_bound(
+            m_beatFrames.begin(), m_beatFrames.end(),
+            samplesToFrames(startSample));
 
-    BeatList::const_iterator curBeat =
-            qLowerBound(m_beats.begin(), m_beats.end(),
-                        startBeat, BeatLessThan);
-
-    BeatList::const_iterator lastBeat =
-            qUpperBound(m_beats.begin(), m_beats.end(),
-                        stopBeat, BeatLessThan);
+    std::vector<double>::const_iterator lastBeat = std::upper_bound(
+            m_beatFrames.begin(), m_beatFrames.end(),
+            samplesToFrames(stopSample));
 
     if (curBeat >= lastBeat) {
         return std::unique_ptr<BeatIterator>();
@@ -406,6 +599,11 @@ bool BeatMap::hasBeatInRange(double startSample, double stopSample) const {
     return false;
 }
 
+void BeatMap::prepareCalculations() const {
+    QMutexLocker locker(&m_mutex);
+    decodeBeats();
+}
+
 double BeatMap::getBpm() const {
     QMutexLocker locker(&m_mutex);
     if (!isValid())
@@ -415,6 +613,7 @@ double BeatMap::getBpm() const {
 
 double BeatMap::getBpmRange(double startSample, double stopSample) const {
     QMutexLocker locker(&m_mutex);
+    decodeBeats();
     if (!isValid())
         return -1;
     Beat startBeat, stopBeat;
@@ -425,6 +624,7 @@ double BeatMap::getBpmRange(double startSample, double stopSample) const {
 
 double BeatMap::getBpmAroundPosition(double curSample, int n) const {
     QMutexLocker locker(&m_mutex);
+    decodeBeats();
     if (!isValid())
         return -1;
 
@@ -456,6 +656,7 @@ double BeatMap::getBpmAroundPosition(double curSample, int n) const {
 
 void BeatMap::addBeat(double dBeatSample) {
     QMutexLocker locker(&m_mutex);
+    decodeBeats();
     Beat beat;
     beat.set_frame_position(samplesToFrames(dBeatSample));
     BeatList::iterator it = qLowerBound(
@@ -474,6 +675,7 @@ void BeatMap::addBeat(double dBeatSample) {
 
 void BeatMap::removeBeat(double dBeatSample) {
     QMutexLocker locker(&m_mutex);
+    decodeBeats();
     Beat beat;
     beat.set_frame_position(samplesToFrames(dBeatSample));
     BeatList::iterator it = qLowerBound(
@@ -492,6 +694,7 @@ void BeatMap::removeBeat(double dBeatSample) {
 
 void BeatMap::moveBeat(double dBeatSample, double dNewBeatSample) {
     QMutexLocker locker(&m_mutex);
+    decodeBeats();
     Beat beat, newBeat;
     beat.set_frame_position(samplesToFrames(dBeatSample));
     newBeat.set_frame_position(samplesToFrames(dNewBeatSample));
@@ -522,6 +725,7 @@ void BeatMap::moveBeat(double dBeatSample, double dNewBeatSample) {
 
 void BeatMap::translate(double dNumSamples) {
     QMutexLocker locker(&m_mutex);
+    decodeBeats();
     // Converting to frame offset
     if (!isValid()) {
         return;
@@ -546,6 +750,7 @@ void BeatMap::translate(double dNumSamples) {
 void BeatMap::scale(enum BPMScale scale) {
 
     QMutexLocker locker(&m_mutex);
+    decodeBeats();
     if (!isValid() || m_beats.isEmpty()) {
         return;
     }
@@ -715,7 +920,20 @@ void BeatMap::setBpm(double dBpm) {
      */
 }
 
+void BeatMap::updateBeatFrames() const {
+    m_beatFrames.clear();
+    m_beatFrames.reserve(m_beats.size());
+    for (const Beat& beat : m_beats) {
+        if (beat.enabled()) {
+            m_beatFrames.push_back(beat.frame_position());
+        }
+    }
+}
+
 void BeatMap::onBeatlistChanged() {
+    DEBUG_ASSERT(m_encodedBeats.isEmpty());
+    updateBeatFrames();
+
     if (!isValid()) {
         m_dLastFrame = 0;
         m_dCachedBpm = 0;
@@ -732,18 +950,18 @@ double BeatMap::calculateBpm(const Beat& startBeat, const Beat& stopBeat) const
         return -1;
     }
 
-    BeatList::const_iterator curBeat =
-            qLowerBound(m_beats.begin(), m_beats.end(), startBeat, BeatLessThan);
+    std::vector<double>::const_iterator curBeat = std::lower_bound(
+            m_beatFrames.begin(), m_beatFrames.end(),
+            static_cast<double>(startBeat.frame_position()));
 
-    BeatList::const_iterator lastBeat =
-            qUpperBound(m_beats.begin(), m_beats.end(), stopBeat, BeatLessThan);
+    std::vector<double>::const_iterator lastBeat = std::upper_bound(
+            m_beatFrames.begin(), m_beatFrames.end(),
+            static_cast<double>(stopBeat.frame_position()));
 
     QVector<double> beatvect;
+    beatvect.reserve(lastBeat - curBeat);
     for (; curBeat != lastBeat; ++curBeat) {
-        const Beat& beat = *curBeat;
-        if (beat.enabled()) {
-            beatvect.append(beat.frame_position());
-        }
+        beatvect.append(*curBeat);
     }
 
     if (beatvect.isEmpty()) {
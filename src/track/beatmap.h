@@ -8,6 +8,8 @@
 #ifndef BEATMAP_H_
 #define BEATMAP_H_
 
+#include <vector>
+
 #include <QObject>
 #include <QMutex>
 
@@ -15,6 +17,8 @@
 #include "track/beats.h"
 #include "proto/beats.pb.h"
 
+// The version of the beat detection that produced a map. The format of the
+// serialization is independent of it, see toByteArray().
 #define BEAT_MAP_VERSION "BeatMap-1.0"
 
 typedef QList<mixxx::track::io::Beat> BeatList;
@@ -47,6 +51,8 @@ class BeatMap : public QObject, public Beats {
                 BEATSCAP_MOVEBEAT;
     }
 
+    // Writes the compact format, see beatmap.cpp. The byte array
+    // constructor also reads the protobuf BeatMap of older versions.
     virtual QByteArray toByteArray() const;
     BeatsPointer clone() const;
     virtual QString getVersion() const;
@@ -64,6 +70,14 @@ class BeatMap : public QObject, public Beats {
                                    double* dpNextBeatSamples) const;
     virtual double findClosestBeat(double dSamples) const;
     virtual double findNthBeat(double dSamples, int n) const;
+    double findNthBeat(double dSamples, int n,
+                       BeatCursor* pCursor) const override;
+    bool findPrevNextBeats(double dSamples,
+                           double* dpPrevBeatSamples,
+                           double* dpNextBeatSamples,
+                           BeatCursor* pCursor) const override;
+    double findClosestBeat(double dSamples,
+                           BeatCursor* pCursor) const override;
     virtual std::unique_ptr<BeatIterator> findBeats(double startSample, double stopSample) const;
     virtual bool hasBeatInRange(double startSample, double stopSample) const;
 
@@ -71,6 +85,8 @@ class BeatMap : public QObject, public Beats {
     virtual double getBpmRange(double startSample, double stopSample) const;
     virtual double getBpmAroundPosition(double curSample, int n) const;
 
+    void prepareCalculations() const override;
+
     ////////////////////////////////////////////////////////////////////////////
     // Beat mutations
     ////////////////////////////////////////////////////////////////////////////
@@ -87,10 +103,25 @@ class BeatMap : public QObject, public Beats {
 
   private:
     BeatMap(const BeatMap& other);
+    // Only reads the header of the compact format. The beats are decoded
+    // by decodeBeats() when they are needed.
     bool readByteArray(const QByteArray& byteArray);
+    // Must be called with m_mutex locked before the beats are accessed
+    void decodeBeats() const;
+    void updateBeatFrames() const;
     void createFromBeatVector(const QVector<double>& beats);
     void onBeatlistChanged();
 
+    // Returns the index in m_beatFrames of the first beat at or after
+    // dFrame, starting the search from pCursor if given.
+    int lowerBoundBeatIndex(double dFrame, BeatCursor* pCursor) const;
+    // Finds the indices in m_beatFrames of the beats before and after
+    // dSamples and of the beat that dSamples is on, if any. Each index
+    // is -1 if there is no such beat.
+    void findBeatIndices(double dSamples, BeatCursor* pCursor,
+                         int* pPrevIndex, int* pNextIndex,
+                         int* pOnBeatIndex) const;
+
     double calculateBpm(const mixxx::track::io::Beat& startBeat,
                         const mixxx::track::io::Beat& stopBeat) const;
     // For internal use only.
@@ -108,7 +139,13 @@ class BeatMap : public QObject, public Beats {
     SINT m_iSampleRate;
     double m_dCachedBpm;
     double m_dLastFrame;
-    BeatList m_beats;
+    // The compact serialization of the beats while they have not been
+    // decoded. The BPM and the last frame have been read from its header.
+    mutable QByteArray m_encodedBeats;
+    mutable BeatList m_beats;
+    // The frame positions of the enabled beats in m_beats. Searching this
+    // is much faster than searching the protobuf messages of m_beats.
+    mutable std::vector<double> m_beatFrames;
 };
 
 #endif /* BEATMAP_H_ */
@@ -22,6 +22,25 @@ class BeatIterator {
     virtual double next() = 0;
 };
 
+// A BeatCursor remembers where the last lookup with it ended up in the beats of
+// a Beats object. During playback consecutive lookups are close to each other,
+// so a Beats implementation that has to search for the position can start
+// from the last one instead of searching all beats again. The cursor is only a
+// hint: Using it with a different Beats object or after the beats have been
+// changed gives the same results as without a cursor. A cursor must not be
+// used by multiple threads at the same time.
+class BeatCursor {
+  public:
+    BeatCursor()
+            : m_index(0) {
+    }
+
+  private:
+    int m_index;
+
+    friend class BeatMap;
+};
+
 // Beats is a pure abstract base class for BPM and beat management classes. It
 // provides a specification of all methods a beat-manager class must provide, as
 // well as a capability model for representing optional features.
@@ -104,6 +123,27 @@ class Beats {
     // then dSamples is returned. If no beat can be found, returns -1.
     virtual double findNthBeat(double dSamples, int n) const = 0;
 
+    // The same as the functions above, but using and updating pCursor to
+    // speed up repeated lookups near the same position. The default
+    // implementations ignore the cursor.
+    virtual double findNthBeat(double dSamples, int n,
+                               BeatCursor* pCursor) const {
+        Q_UNUSED(pCursor);
+        return findNthBeat(dSamples, n);
+    }
+    virtual bool findPrevNextBeats(double dSamples,
+                                   double* dpPrevBeatSamples,
+                                   double* dpNextBeatSamples,
+                                   BeatCursor* pCursor) const {
+        Q_UNUSED(pCursor);
+        return findPrevNextBeats(dSamples, dpPrevBeatSamples, dpNextBeatSamples);
+    }
+    virtual double findClosestBeat(double dSamples,
+                                   BeatCursor* pCursor) const {
+        Q_UNUSED(pCursor);
+        return findClosestBeat(dSamples);
+    }
+
     int numBeatsInRange(double dStartSample, double dEndSample);
 
     // Find the sample N beats away from dSample. The number of beats may be
@@ -137,6 +177,12 @@ class Beats {
         return kMaxBpm;
     }
 
+    // Prepares everything that the beat calculations need, so the first of
+    // them, e.g. in the engine, does not have to. The default implementation
+    // does nothing.
+    virtual void prepareCalculations() const {
+    }
+
     ////////////////////////////////////////////////////////////////////////////
     // Beat mutations
     ////////////////////////////////////////////////////////////////////////////
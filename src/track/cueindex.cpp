@@ -0,0 +1,108 @@
+#include "track/cueindex.h"
+
+#include <algorithm>
+
+namespace {
+
+bool isBefore(const CueIndex::Entry& entry, double position) {
+    return entry.position < position;
+}
+
+bool isAfter(double position, const CueIndex::Entry& entry) {
+    return position < entry.position;
+}
+
+} // anonymous namespace
+
+CueIndex::CueIndex(const QList<CuePointer>& cuePoints) {
+    m_entries.reserve(cuePoints.size());
+    for (const auto& pCue : cuePoints) {
+        if (!pCue) {
+            continue;
+        }
+        Entry entry;
+        entry.position = pCue->getPosition();
+        entry.type = pCue->getType();
+        entry.hotCue = pCue->getHotCue();
+        entry.pCue = pCue;
+        m_entries.append(entry);
+    }
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+            [](const Entry& lhs, const Entry& rhs) {
+                return lhs.position < rhs.position;
+            });
+    for (int i = 0; i < m_entries.size(); ++i) {
+        const int hotCue = m_entries[i].hotCue;
+        if (hotCue < 0) {
+            continue;
+        }
+        while (m_hotCueEntries.size() <= hotCue) {
+            m_hotCueEntries.append(-1);
+        }
+        m_hotCueEntries[hotCue] = i;
+    }
+}
+
+// static
+bool CueIndex::matches(const Entry& entry, Filter filter) {
+    switch (filter) {
+    case Filter::HotCues:
+        return entry.type == Cue::CUE && entry.hotCue >= 0;
+    case Filter::All:
+        break;
+    }
+    return true;
+}
+
+const CueIndex::Entry* CueIndex::findNext(double position, Filter filter) const {
+    auto it = std::upper_bound(
+            m_entries.begin(), m_entries.end(), position, isAfter);
+    for (; it != m_entries.end(); ++it) {
+        if (matches(*it, filter)) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+const CueIndex::Entry* CueIndex::findPrevious(double position, Filter filter) const {
+    auto it = std::lower_bound(
+            m_entries.begin(), m_entries.end(), position, isBefore);
+    while (it != m_entries.begin()) {
+        --it;
+        if (matches(*it, filter)) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+const CueIndex::Entry* CueIndex::findClosest(double position, Filter filter) const {
+    const Entry* pPrevious = findPrevious(position, filter);
+    // Including a cue at the position itself
+    const Entry* pNext = nullptr;
+    auto it = std::lower_bound(
+            m_entries.begin(), m_entries.end(), position, isBefore);
+    for (; it != m_entries.end(); ++it) {
+        if (matches(*it, filter)) {
+            pNext = &*it;
+            break;
+        }
+    }
+    if (!pPrevious) {
+        return pNext;
+    }
+    if (!pNext) {
+        return pPrevious;
+    }
+    return (position - pPrevious->position) <= (pNext->position - position) ?
+            pPrevious : pNext;
+}
+
+const CueIndex::Entry* CueIndex::findHotCue(int hotCue) const {
+    if (hotCue < 0 || hotCue >= m_hotCueEntries.size()) {
+        return nullptr;
+    }
+    const int index = m_hotCueEntries[hotCue];
+    return index >= 0 ? &m_entries[index] : nullptr;
+}
@@ -0,0 +1,59 @@
+#ifndef TRACK_CUEINDEX_H
+#define TRACK_CUEINDEX_H
+
+#include <QList>
+#include <QVector>
+
+#include "library/dao/cue.h"
+
+// The cues of a track sorted by their position, so the next, previous and
+// closest cue of a position are found by a binary search. The index is
+// immutable and built by Track whenever a cue has changed, see
+// TrackEngineSnapshot::cueIndex. The positions and hotcue numbers are copied,
+// so queries neither lock the cues nor allocate.
+class CueIndex {
+  public:
+    struct Entry {
+        double position;
+        Cue::CueType type;
+        // -1 if the cue is not a hotcue
+        int hotCue;
+        CuePointer pCue;
+    };
+
+    // Selects the cues that are considered by a query
+    enum class Filter {
+        All,
+        // Cues of type Cue::CUE with a hotcue number
+        HotCues,
+    };
+
+    CueIndex() = default;
+    explicit CueIndex(const QList<CuePointer>& cuePoints);
+
+    bool isEmpty() const {
+        return m_entries.isEmpty();
+    }
+    // Sorted by ascending position
+    const QVector<Entry>& entries() const {
+        return m_entries;
+    }
+
+    // The cue after the position, or null if there is none
+    const Entry* findNext(double position, Filter filter = Filter::All) const;
+    // The cue before the position, or null if there is none
+    const Entry* findPrevious(double position, Filter filter = Filter::All) const;
+    // The cue nearest to the position, or null if there is none
+    const Entry* findClosest(double position, Filter filter = Filter::All) const;
+    // The cue with the hotcue number, or null if it is not set
+    const Entry* findHotCue(int hotCue) const;
+
+  private:
+    static bool matches(const Entry& entry, Filter filter);
+
+    QVector<Entry> m_entries;
+    // The indices of m_entries by hotcue number, -1 if not set
+    QVector<int> m_hotCueEntries;
+};
+
+#endif // TRACK_CUEINDEX_H
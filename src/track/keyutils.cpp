@@ -89,75 +89,129 @@ const ChromaticKey s_letterToMajorKey[] = {
     mixxx::track::io::key::G_MAJOR
 };
 
-static const int s_sortKeysCircleOfFifths[] = {
-    0, // INVALID
-    1, // C_MAJOR
-    15, // D_FLAT_MAJOR
-    5, // D_MAJOR
-    19, // E_FLAT_MAJOR
-    9, // E_MAJOR
-    23, // F_MAJOR
-    13, // F_SHARP_MAJOR
-    3, // G_MAJOR
-    17, // A_FLAT_MAJOR
-    7, // A_MAJOR
-    21, // B_FLAT_MAJOR
-    11, // B_MAJOR
-    20, // C_MINOR
-    10, // C_SHARP_MINOR
-    24, // D_MINOR
-    14, // E_FLAT_MINOR
-    4, // E_MINOR
-    18, // F_MINOR
-    8, // F_SHARP_MINOR
-    22, // G_MINOR
-    12, // G_SHARP_MINOR
-    2, // A_MINOR
-    16, // B_FLAT_MINOR
-    6, // B_MINOR
-};
+// The tables of the keys are built at compile time from the position of each
+// key on the Circle of Fifths, which OpenKey notation encodes: the OpenKey
+// number is the radial of the circle and major/minor is the outer/inner ring.
+namespace {
 
-static const int s_sortKeysCircleOfFifthsLancelot[] = {
-    0, // INVALID
-    16, // C_MAJOR
-    6, // D_FLAT_MAJOR
-    20, // D_MAJOR
-    10, // E_FLAT_MAJOR
-    24, // E_MAJOR
-    14, // F_MAJOR
-    4, // F_SHARP_MAJOR
-    18, // G_MAJOR
-    8, // A_FLAT_MAJOR
-    22, // A_MAJOR
-    12, // B_FLAT_MAJOR
-    2, // B_MAJOR
-    9, // C_MINOR
-    23, // C_SHARP_MINOR
-    13, // D_MINOR
-    3, // E_FLAT_MINOR
-    17, // E_MINOR
-    7, // F_MINOR
-    21, // F_SHARP_MINOR
-    11, // G_MINOR
-    1, // G_SHARP_MINOR
-    15, // A_MINOR
-    5, // B_FLAT_MINOR
-    19, // B_MINOR
-};
+const int kNumKeys = mixxx::track::io::key::B_MINOR + 1;
 
-QMutex KeyUtils::s_notationMutex;
-QMap<ChromaticKey, QString> KeyUtils::s_notation;
-QMap<QString, ChromaticKey> KeyUtils::s_reverseNotation;
+constexpr bool isMajorKey(int key) {
+    return key >= mixxx::track::io::key::C_MAJOR &&
+            key <= mixxx::track::io::key::B_MAJOR;
+}
+
+// The 0-indexed tonic of the key or of its relative major key
+constexpr int majorTonicOfKey(int key) {
+    return isMajorKey(key) ? key - mixxx::track::io::key::C_MAJOR :
+            (key - mixxx::track::io::key::C_MINOR + 3) % 12;
+}
+
+// Each step on the circle is a perfect 5th, i.e. 7 semitones
+constexpr int openKeyNumberOfKey(int key) {
+    return key == mixxx::track::io::key::INVALID ? 0 :
+            majorTonicOfKey(key) * 7 % 12 + 1;
+}
+
+constexpr int keyOfOpenKeyNumber(int openKeyNumber, bool major) {
+    return major ? (openKeyNumber - 1) * 7 % 12 + mixxx::track::io::key::C_MAJOR :
+            ((openKeyNumber - 1) * 7 % 12 + 9) % 12 + mixxx::track::io::key::C_MINOR;
+}
 
 // Lancelot notation is OpenKey notation rotated counter-clockwise by 5.
-inline int openKeyNumberToLancelotNumber(const int okNumber)  {
-    int lancelotNumber = okNumber - 5;
-    if (lancelotNumber < 1) {
-        lancelotNumber += 12;
-    }
-    return lancelotNumber;
+constexpr int lancelotNumberOfKey(int key) {
+    return key == mixxx::track::io::key::INVALID ? 0 :
+            (openKeyNumberOfKey(key) + 6) % 12 + 1;
+}
+
+constexpr int nextOpenKeyNumber(int openKeyNumber) {
+    return openKeyNumber % 12 + 1;
+}
+
+constexpr int previousOpenKeyNumber(int openKeyNumber) {
+    return (openKeyNumber + 10) % 12 + 1;
 }
 
+constexpr KeyUtils::KeyMask maskOfKey(int key) {
+    return KeyUtils::KeyMask(1) << key;
+}
+
+// The compatible keys of particular key are:
+// * The key itself.
+// * The relative major/minor key, on the same radial of the circle.
+// * The perfect 4th (sub-dominant) and the perfect 5th (dominant) keys,
+//   on the adjacent radials.
+constexpr KeyUtils::KeyMask compatibleKeysOfKey(int key) {
+    return key == mixxx::track::io::key::INVALID ? 0 :
+            maskOfKey(key) |
+            maskOfKey(keyOfOpenKeyNumber(openKeyNumberOfKey(key), !isMajorKey(key))) |
+            maskOfKey(keyOfOpenKeyNumber(
+                    nextOpenKeyNumber(openKeyNumberOfKey(key)), isMajorKey(key))) |
+            maskOfKey(keyOfOpenKeyNumber(
+                    previousOpenKeyNumber(openKeyNumberOfKey(key)), isMajorKey(key)));
+}
+
+// The keys are sorted along the circle, the major key of a radial first.
+// With Lancelot notation the minor key comes first.
+constexpr int circleOfFifthsOrderOfKey(int key) {
+    return key == mixxx::track::io::key::INVALID ? 0 :
+            2 * (openKeyNumberOfKey(key) - 1) + (isMajorKey(key) ? 1 : 2);
+}
+
+constexpr int circleOfFifthsLancelotOrderOfKey(int key) {
+    return key == mixxx::track::io::key::INVALID ? 0 :
+            2 * (lancelotNumberOfKey(key) - 1) + (isMajorKey(key) ? 2 : 1);
+}
+
+static_assert(openKeyNumberOfKey(mixxx::track::io::key::F_SHARP_MINOR) == 4,
+        "Wrong OpenKey number");
+static_assert(keyOfOpenKeyNumber(7, false) == mixxx::track::io::key::E_FLAT_MINOR,
+        "Wrong key of OpenKey number");
+static_assert(lancelotNumberOfKey(mixxx::track::io::key::B_MAJOR) == 1,
+        "Wrong Lancelot number");
+static_assert(compatibleKeysOfKey(mixxx::track::io::key::C_MAJOR) ==
+        (maskOfKey(mixxx::track::io::key::C_MAJOR) |
+                maskOfKey(mixxx::track::io::key::A_MINOR) |
+                maskOfKey(mixxx::track::io::key::G_MAJOR) |
+                maskOfKey(mixxx::track::io::key::F_MAJOR)),
+        "Wrong compatible keys");
+static_assert(circleOfFifthsOrderOfKey(mixxx::track::io::key::C_MINOR) == 20 &&
+        circleOfFifthsLancelotOrderOfKey(mixxx::track::io::key::C_MINOR) == 9,
+        "Wrong sort order");
+static_assert(sizeof(KeyUtils::KeyMask) * 8 >= kNumKeys,
+        "KeyMask is too small");
+
+} // anonymous namespace
+
+// Expands to the table of f(key) for all keys
+#define KEY_TABLE(f) \
+{ \
+    f(0), f(1), f(2), f(3), f(4), f(5), f(6), f(7), \
+    f(8), f(9), f(10), f(11), f(12), f(13), f(14), f(15), \
+    f(16), f(17), f(18), f(19), f(20), f(21), f(22), f(23), \
+    f(24) }
+
+static const int s_sortKeysCircleOfFifths[kNumKeys] =
+        KEY_TABLE(circleOfFifthsOrderOfKey);
+
+static const int s_sortKeysCircleOfFifthsLancelot[kNumKeys] =
+        KEY_TABLE(circleOfFifthsLancelotOrderOfKey);
+
+const int KeyUtils::s_openKeyNumbers[kNumKeys] =
+        KEY_TABLE(openKeyNumberOfKey);
+
+const int KeyUtils::s_lancelotNumbers[kNumKeys] =
+        KEY_TABLE(lancelotNumberOfKey);
+
+const KeyUtils::KeyMask KeyUtils::s_compatibleKeys[kNumKeys] =
+        KEY_TABLE(compatibleKeysOfKey);
+
+#undef KEY_TABLE
+
+QMutex KeyUtils::s_notationMutex;
+QMap<ChromaticKey, QString> KeyUtils::s_notation;
+QMap<QString, ChromaticKey> KeyUtils::s_reverseNotation;
+
 // Lancelot notation is OpenKey notation rotated counter-clockwise by 5.
 inline int lancelotNumberToOpenKeyNumber(const int lancelotNumber)  {
     int okNumber = lancelotNumber + 5;
@@ -218,7 +272,7 @@ QString KeyUtils::keyToString(ChromaticKey key,
         return QString::number(number) + (major ? "d" : "m");
     } else if (notation == LANCELOT) {
         bool major = keyIsMajor(key);
-        int number = openKeyNumberToLancelotNumber(keyToOpenKeyNumber(key));
+        int number = keyToLancelotNumber(key);
         return QString::number(number) + (major ? "B" : "A");
     } else if (notation == TRADITIONAL) {
         return s_traditionalKeyNames[static_cast<int>(key)];
@@ -511,38 +565,12 @@ int KeyUtils::shortestStepsToCompatibleKey(
 QList<mixxx::track::io::key::ChromaticKey> KeyUtils::getCompatibleKeys(
         mixxx::track::io::key::ChromaticKey key) {
     QList<mixxx::track::io::key::ChromaticKey> compatible;
-    if (!ChromaticKey_IsValid(key) || key == mixxx::track::io::key::INVALID) {
-        return compatible;
+    const KeyMask compatibleKeys = getCompatibleKeysMask(key);
+    for (int i = mixxx::track::io::key::C_MAJOR; i < kNumKeys; ++i) {
+        if (compatibleKeys & maskOfKey(i)) {
+            compatible << static_cast<ChromaticKey>(i);
+        }
     }
-
-    // We know the key is in the set of valid values. Save whether or not the
-    // value is minor.
-    bool major = keyIsMajor(key);
-    int openKeyNumber = KeyUtils::keyToOpenKeyNumber(key);
-
-    // The compatible keys of particular key are:
-    // * The relative major/minor key.
-    // * The perfect 4th (sub-dominant) key.
-    // * The perfect 5th (dominant) key.
-    //
-    // The Circle of Fifths is a handy tool that encodes this compatibility.
-    // Keys on the same radial of the circle are compatible and adjacent keys on
-    // the circle are compatible. OpenKey notation encodes the Circle of
-    // Fifths. The OpenKey number represents the radial on the circle and
-    // major/minor determines whether you are on the inner or outer ring of the
-    // radial.
-
-    // The key is compatible with tracks in the same key.
-    compatible << key;
-
-    // The relative major/minor key is compatible.
-    compatible << openKeyNumberToKey(openKeyNumber, !major);
-
-    // The perfect 4th and perfect 5th are compatible.
-    compatible << openKeyNumberToKey(
-            openKeyNumber == 12 ? 1 : openKeyNumber + 1, major);
-    compatible << openKeyNumberToKey(
-            openKeyNumber == 1 ? 12 : openKeyNumber - 1, major);
     return compatible;
 }
 
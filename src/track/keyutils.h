@@ -110,52 +110,44 @@ class KeyUtils {
     static mixxx::track::io::key::ChromaticKey openKeyNumberToKey(int openKeyNumber, bool major);
 
     static inline int keyToOpenKeyNumber(mixxx::track::io::key::ChromaticKey key) {
-        switch (key) {
-            case mixxx::track::io::key::C_MAJOR:
-            case mixxx::track::io::key::A_MINOR:
-                return 1;
-            case mixxx::track::io::key::G_MAJOR:
-            case mixxx::track::io::key::E_MINOR:
-                return 2;
-            case mixxx::track::io::key::D_MAJOR:
-            case mixxx::track::io::key::B_MINOR:
-                return 3;
-            case mixxx::track::io::key::A_MAJOR:
-            case mixxx::track::io::key::F_SHARP_MINOR:
-                return 4;
-            case mixxx::track::io::key::E_MAJOR:
-            case mixxx::track::io::key::C_SHARP_MINOR:
-                return 5;
-            case mixxx::track::io::key::B_MAJOR:
-            case mixxx::track::io::key::G_SHARP_MINOR:
-                return 6;
-            case mixxx::track::io::key::F_SHARP_MAJOR:
-            case mixxx::track::io::key::E_FLAT_MINOR:
-                return 7;
-            case mixxx::track::io::key::D_FLAT_MAJOR:
-            case mixxx::track::io::key::B_FLAT_MINOR:
-                return 8;
-            case mixxx::track::io::key::A_FLAT_MAJOR:
-            case mixxx::track::io::key::F_MINOR:
-                return 9;
-            case mixxx::track::io::key::E_FLAT_MAJOR:
-            case mixxx::track::io::key::C_MINOR:
-                return 10;
-            case mixxx::track::io::key::B_FLAT_MAJOR:
-            case mixxx::track::io::key::G_MINOR:
-                return 11;
-            case mixxx::track::io::key::F_MAJOR:
-            case mixxx::track::io::key::D_MINOR:
-                return 12;
-            default:
-                return 0;
-        }
+        return mixxx::track::io::key::ChromaticKey_IsValid(key) ?
+                s_openKeyNumbers[static_cast<int>(key)] : 0;
+    }
+
+    static inline int keyToLancelotNumber(mixxx::track::io::key::ChromaticKey key) {
+        return mixxx::track::io::key::ChromaticKey_IsValid(key) ?
+                s_lancelotNumbers[static_cast<int>(key)] : 0;
+    }
+
+    // A set of keys with the bit (1 << key) for each key
+    typedef quint32 KeyMask;
+
+    static inline KeyMask keyToMask(mixxx::track::io::key::ChromaticKey key) {
+        return mixxx::track::io::key::ChromaticKey_IsValid(key) ?
+                KeyMask(1) << static_cast<int>(key) : 0;
+    }
+
+    // The keys of getCompatibleKeys() as a mask
+    static inline KeyMask getCompatibleKeysMask(
+            mixxx::track::io::key::ChromaticKey key) {
+        return mixxx::track::io::key::ChromaticKey_IsValid(key) ?
+                s_compatibleKeys[static_cast<int>(key)] : 0;
+    }
+
+    static inline bool isCompatibleKey(mixxx::track::io::key::ChromaticKey key,
+                                       mixxx::track::io::key::ChromaticKey otherKey) {
+        return (getCompatibleKeysMask(key) & keyToMask(otherKey)) != 0;
     }
 
     static int keyToCircleOfFifthsOrder(mixxx::track::io::key::ChromaticKey key,
                                         KeyNotation notation);
 
   private:
+    // Indexed by the key, see keyutils.cpp
+    static const int s_openKeyNumbers[];
+    static const int s_lancelotNumbers[];
+    static const KeyMask s_compatibleKeys[];
+
     static QMutex s_notationMutex;
     static QMap<mixxx::track::io::key::ChromaticKey, QString> s_notation;
     static QMap<QString, mixxx::track::io::key::ChromaticKey> s_reverseNotation;
@@ -59,11 +59,15 @@ Track::Track(
         TrackId trackId)
         : m_fileInfo(fileInfo),
           m_pSecurityToken(openSecurityToken(m_fileInfo, pSecurityToken)),
-          m_qMutex(QMutex::Recursive),
+          m_qMutex("Track", QMutex::Recursive),
           m_record(trackId),
           m_bDirty(false),
           m_bMarkedForMetadataExport(false),
-          m_analyzerProgress(-1) {
+          m_analyzerProgress(-1),
+          m_engineSnapshotVersion(0),
+          m_memoryAccount(MemoryAccounting::Category::TrackCache,
+                  sizeof(Track)) {
+    publishEngineSnapshot();
 }
 
 //static
@@ -100,7 +104,7 @@ void Track::setTrackMetadata(
 
     {
         // enter locking scope
-        QMutexLocker lock(&m_qMutex);
+        MMutexLocker lock(&m_qMutex);
 
         bool modified = compareAndSet(
                 &m_record.refMetadataSynchronized(),
@@ -139,7 +143,7 @@ void Track::getTrackMetadata(
         mixxx::TrackMetadata* pTrackMetadata,
         bool* pMetadataSynchronized) const {
     DEBUG_ASSERT(pTrackMetadata);
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     *pTrackMetadata = m_record.getMetadata();
     if (pMetadataSynchronized != nullptr) {
         *pMetadataSynchronized = m_record.getMetadataSynchronized();
@@ -150,7 +154,7 @@ void Track::getTrackRecord(
         mixxx::TrackRecord* pTrackRecord,
         bool* pDirty) const {
     DEBUG_ASSERT(pTrackRecord);
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     *pTrackRecord = m_record;
     if (pDirty != nullptr) {
         *pDirty = m_bDirty;
@@ -161,7 +165,7 @@ QString Track::getLocation() const {
     // Copying QFileInfo is thread-safe due to "implicit sharing"
     // (copy-on write). But operating on a single instance of QFileInfo
     // might not be thread-safe due to internal caching!
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return TrackRef::location(m_fileInfo);
 }
 
@@ -169,7 +173,7 @@ QString Track::getCanonicalLocation() const {
     // Copying QFileInfo is thread-safe due to "implicit sharing"
     // (copy-on write). But operating on a single instance of QFileInfo
     // might not be thread-safe due to internal caching!
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return TrackRef::canonicalLocation(m_fileInfo);
 }
 
@@ -177,7 +181,7 @@ QString Track::getDirectory() const {
     // Copying QFileInfo is thread-safe due to "implicit sharing"
     // (copy-on write). But operating on a single instance of QFileInfo
     // might not be thread-safe due to internal caching!
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_fileInfo.absolutePath();
 }
 
@@ -185,7 +189,7 @@ QString Track::getFileName() const {
     // Copying QFileInfo is thread-safe due to "implicit sharing"
     // (copy-on write). But operating on a single instance of QFileInfo
     // might not be thread-safe due to internal caching!
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_fileInfo.fileName();
 }
 
@@ -193,7 +197,7 @@ int Track::getFileSize() const {
     // Copying QFileInfo is thread-safe due to "implicit sharing"
     // (copy-on write). But operating on a single instance of QFileInfo
     // might not be thread-safe due to internal caching!
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_fileInfo.size();
 }
 
@@ -201,7 +205,7 @@ QDateTime Track::getFileModifiedTime() const {
     // Copying QFileInfo is thread-safe due to "implicit sharing"
     // (copy-on write). But operating on a single instance of QFileInfo
     // might not be thread-safe due to internal caching!
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_fileInfo.lastModified();
 }
 
@@ -209,7 +213,7 @@ QDateTime Track::getFileCreationTime() const {
     // Copying QFileInfo is thread-safe due to "implicit sharing"
     // (copy-on write). But operating on a single instance of QFileInfo
     // might not be thread-safe due to internal caching!
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_fileInfo.created();
 }
 
@@ -217,7 +221,7 @@ bool Track::exists() const {
     // Copying QFileInfo is thread-safe due to "implicit sharing"
     // (copy-on write). But operating on a single instance of QFileInfo
     // might not be thread-safe due to internal caching!
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     // return here a fresh calculated value to be sure
     // the file is not deleted or gone with an USB-Stick
     // because it will probably stop the Auto-DJ
@@ -225,12 +229,12 @@ bool Track::exists() const {
 }
 
 mixxx::ReplayGain Track::getReplayGain() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getTrackInfo().getReplayGain();
 }
 
 void Track::setReplayGain(const mixxx::ReplayGain& replayGain) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refMetadata().refTrackInfo().refReplayGain(), replayGain)) {
         markDirtyAndUnlock(&lock);
         emit(ReplayGainUpdated(replayGain));
@@ -239,7 +243,7 @@ void Track::setReplayGain(const mixxx::ReplayGain& replayGain) {
 
 double Track::getBpm() const {
     double bpm = mixxx::Bpm::kValueUndefined;
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (m_pBeats) {
         // BPM from beat grid overrides BPM from metadata
         // Reason: The BPM value in the metadata might be imprecise,
@@ -260,7 +264,7 @@ double Track::setBpm(double bpmValue) {
         return bpmValue;
     }
 
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
 
     if (!m_pBeats) {
         // No beat grid available -> create and initialize
@@ -288,11 +292,11 @@ QString Track::getBpmText() const {
 }
 
 void Track::setBeats(BeatsPointer pBeats) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     setBeatsAndUnlock(&lock, pBeats);
 }
 
-void Track::setBeatsAndUnlock(QMutexLocker* pLock, BeatsPointer pBeats) {
+void Track::setBeatsAndUnlock(MMutexLocker* pLock, BeatsPointer pBeats) {
     // This whole method is not so great. The fact that Beats is an ABC is
     // limiting with respect to QObject and signals/slots.
 
@@ -328,12 +332,12 @@ void Track::setBeatsAndUnlock(QMutexLocker* pLock, BeatsPointer pBeats) {
 }
 
 BeatsPointer Track::getBeats() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_pBeats;
 }
 
 void Track::slotBeatsUpdated() {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
 
     auto bpmValue = mixxx::Bpm::kValueUndefined;
     if (m_pBeats) {
@@ -347,19 +351,19 @@ void Track::slotBeatsUpdated() {
 }
 
 void Track::setMetadataSynchronized(bool metadataSynchronized) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refMetadataSynchronized(), metadataSynchronized)) {
         markDirtyAndUnlock(&lock);
     }
 }
 
 bool Track::isMetadataSynchronized() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadataSynchronized();
 }
 
 QString Track::getInfo() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (m_record.getMetadata().getTrackInfo().getArtist().trimmed().isEmpty()) {
         return m_record.getMetadata().getTrackInfo().getTitle();
     } else {
@@ -368,17 +372,17 @@ QString Track::getInfo() const {
 }
 
 QDateTime Track::getDateAdded() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getDateAdded();
 }
 
 void Track::setDateAdded(const QDateTime& dateAdded) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.setDateAdded(dateAdded);
 }
 
 void Track::setDuration(mixxx::Duration duration) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refMetadata().refDuration(), duration)) {
         markDirtyAndUnlock(&lock);
     }
@@ -389,7 +393,7 @@ void Track::setDuration(double duration) {
 }
 
 double Track::getDuration(DurationRounding rounding) const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     switch (rounding) {
     case DurationRounding::SECONDS:
         return std::round(m_record.getMetadata().getDuration().toDoubleSeconds());
@@ -412,12 +416,12 @@ QString Track::getDurationText(mixxx::Duration::Precision precision) const {
 }
 
 QString Track::getTitle() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getTrackInfo().getTitle();
 }
 
 void Track::setTitle(const QString& s) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     QString trimmed(s.trimmed());
     if (compareAndSet(&m_record.refMetadata().refTrackInfo().refTitle(), trimmed)) {
         markDirtyAndUnlock(&lock);
@@ -425,12 +429,12 @@ void Track::setTitle(const QString& s) {
 }
 
 QString Track::getArtist() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getTrackInfo().getArtist();
 }
 
 void Track::setArtist(const QString& s) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     QString trimmed(s.trimmed());
     if (compareAndSet(&m_record.refMetadata().refTrackInfo().refArtist(), trimmed)) {
         markDirtyAndUnlock(&lock);
@@ -438,12 +442,12 @@ void Track::setArtist(const QString& s) {
 }
 
 QString Track::getAlbum() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getAlbumInfo().getTitle();
 }
 
 void Track::setAlbum(const QString& s) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     QString trimmed(s.trimmed());
     if (compareAndSet(&m_record.refMetadata().refAlbumInfo().refTitle(), trimmed)) {
         markDirtyAndUnlock(&lock);
@@ -451,12 +455,12 @@ void Track::setAlbum(const QString& s) {
 }
 
 QString Track::getAlbumArtist()  const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getAlbumInfo().getArtist();
 }
 
 void Track::setAlbumArtist(const QString& s) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     QString trimmed(s.trimmed());
     if (compareAndSet(&m_record.refMetadata().refAlbumInfo().refArtist(), trimmed)) {
         markDirtyAndUnlock(&lock);
@@ -464,12 +468,12 @@ void Track::setAlbumArtist(const QString& s) {
 }
 
 QString Track::getYear()  const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getTrackInfo().getYear();
 }
 
 void Track::setYear(const QString& s) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     QString trimmed(s.trimmed());
     if (compareAndSet(&m_record.refMetadata().refTrackInfo().refYear(), trimmed)) {
         markDirtyAndUnlock(&lock);
@@ -477,12 +481,12 @@ void Track::setYear(const QString& s) {
 }
 
 QString Track::getGenre() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getTrackInfo().getGenre();
 }
 
 void Track::setGenre(const QString& s) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     QString trimmed(s.trimmed());
     if (compareAndSet(&m_record.refMetadata().refTrackInfo().refGenre(), trimmed)) {
         markDirtyAndUnlock(&lock);
@@ -490,12 +494,12 @@ void Track::setGenre(const QString& s) {
 }
 
 QString Track::getComposer() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getTrackInfo().getComposer();
 }
 
 void Track::setComposer(const QString& s) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     QString trimmed(s.trimmed());
     if (compareAndSet(&m_record.refMetadata().refTrackInfo().refComposer(), trimmed)) {
         markDirtyAndUnlock(&lock);
@@ -503,12 +507,12 @@ void Track::setComposer(const QString& s) {
 }
 
 QString Track::getGrouping()  const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getTrackInfo().getGrouping();
 }
 
 void Track::setGrouping(const QString& s) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     QString trimmed(s.trimmed());
     if (compareAndSet(&m_record.refMetadata().refTrackInfo().refGrouping(), trimmed)) {
         markDirtyAndUnlock(&lock);
@@ -516,17 +520,17 @@ void Track::setGrouping(const QString& s) {
 }
 
 QString Track::getTrackNumber()  const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getTrackInfo().getTrackNumber();
 }
 
 QString Track::getTrackTotal()  const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getTrackInfo().getTrackTotal();
 }
 
 void Track::setTrackNumber(const QString& s) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     QString trimmed(s.trimmed());
     if (compareAndSet(&m_record.refMetadata().refTrackInfo().refTrackNumber(), trimmed)) {
         markDirtyAndUnlock(&lock);
@@ -534,7 +538,7 @@ void Track::setTrackNumber(const QString& s) {
 }
 
 void Track::setTrackTotal(const QString& s) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     QString trimmed(s.trimmed());
     if (compareAndSet(&m_record.refMetadata().refTrackInfo().refTrackTotal(), trimmed)) {
         markDirtyAndUnlock(&lock);
@@ -542,19 +546,19 @@ void Track::setTrackTotal(const QString& s) {
 }
 
 PlayCounter Track::getPlayCounter() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getPlayCounter();
 }
 
 void Track::setPlayCounter(const PlayCounter& playCounter) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refPlayCounter(), playCounter)) {
         markDirtyAndUnlock(&lock);
     }
 }
 
 void Track::updatePlayCounter(bool bPlayed) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     PlayCounter playCounter(m_record.getPlayCounter());
     playCounter.setPlayedAndUpdateTimesPlayed(bPlayed);
     if (compareAndSet(&m_record.refPlayCounter(), playCounter)) {
@@ -563,55 +567,55 @@ void Track::updatePlayCounter(bool bPlayed) {
 }
 
 QString Track::getComment() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getTrackInfo().getComment();
 }
 
 void Track::setComment(const QString& s) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refMetadata().refTrackInfo().refComment(), s)) {
         markDirtyAndUnlock(&lock);
     }
 }
 
 QString Track::getType() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getFileType();
 }
 
 void Track::setType(const QString& sType) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refFileType(), sType)) {
         markDirtyAndUnlock(&lock);
     }
 }
 
 void Track::setSampleRate(int iSampleRate) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refMetadata().refSampleRate(), mixxx::AudioSignal::SampleRate(iSampleRate))) {
         markDirtyAndUnlock(&lock);
     }
 }
 
 int Track::getSampleRate() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getSampleRate();
 }
 
 void Track::setChannels(int iChannels) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refMetadata().refChannels(), mixxx::AudioSignal::ChannelCount(iChannels))) {
         markDirtyAndUnlock(&lock);
     }
 }
 
 int Track::getChannels() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getChannels();
 }
 
 int Track::getBitrate() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getMetadata().getBitrate();
 }
 
@@ -620,19 +624,19 @@ QString Track::getBitrateText() const {
 }
 
 void Track::setBitrate(int iBitrate) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refMetadata().refBitrate(), mixxx::AudioSource::Bitrate(iBitrate))) {
         markDirtyAndUnlock(&lock);
     }
 }
 
 TrackId Track::getId() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getId();
 }
 
 void Track::initId(TrackId id) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     // The track's id must be set only once and immediately after
     // the object has been created.
     VERIFY_OR_DEBUG_ASSERT(!m_record.getId().isValid() || (m_record.getId() == id)) {
@@ -646,14 +650,14 @@ void Track::initId(TrackId id) {
 }
 
 void Track::setURL(const QString& url) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refUrl(), url)) {
         markDirtyAndUnlock(&lock);
     }
 }
 
 QString Track::getURL() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getUrl();
 }
 
@@ -689,7 +693,7 @@ int Track::getAnalyzerProgress() const {
 }
 
 void Track::setCuePoint(double cue) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refCuePoint(), cue)) {
         // Store the cue point in a load cue
         CuePointer pLoadCue;
@@ -718,7 +722,7 @@ void Track::setCuePoint(double cue) {
 }
 
 double Track::getCuePoint() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getCuePoint();
 }
 
@@ -728,7 +732,7 @@ void Track::slotCueUpdated() {
 }
 
 CuePointer Track::createAndAddCue() {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     CuePointer pCue(new Cue(m_record.getId()));
     connect(pCue.get(), SIGNAL(updated()),
             this, SLOT(slotCueUpdated()));
@@ -739,7 +743,7 @@ CuePointer Track::createAndAddCue() {
 }
 
 void Track::removeCue(const CuePointer& pCue) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     disconnect(pCue.get(), 0, this, 0);
     m_cuePoints.removeOne(pCue);
     markDirtyAndUnlock(&lock);
@@ -747,7 +751,7 @@ void Track::removeCue(const CuePointer& pCue) {
 }
 
 void Track::removeCuesOfType(Cue::CueType type) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     bool dirty = false;
     QMutableListIterator<CuePointer> it(m_cuePoints);
     while (it.hasNext()) {
@@ -766,13 +770,13 @@ void Track::removeCuesOfType(Cue::CueType type) {
 }
 
 QList<CuePointer> Track::getCuePoints() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_cuePoints;
 }
 
 void Track::setCuePoints(const QList<CuePointer>& cuePoints) {
     //qDebug() << "setCuePoints" << cuePoints.length();
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     // disconnect existing cue points
     for (const auto& pCue: m_cuePoints) {
         disconnect(pCue.get(), 0, this, 0);
@@ -788,21 +792,47 @@ void Track::setCuePoints(const QList<CuePointer>& cuePoints) {
 }
 
 void Track::markDirty() {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
+    // Called when a cue has been modified
+    publishEngineSnapshot();
     setDirtyAndUnlock(&lock, true);
 }
 
 void Track::markClean() {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     setDirtyAndUnlock(&lock, false);
 }
 
-void Track::markDirtyAndUnlock(QMutexLocker* pLock, bool bDirty) {
+void Track::markDirtyAndUnlock(MMutexLocker* pLock, bool bDirty) {
+    // All modifications end here, including those of the beats and cues
+    publishEngineSnapshot();
     bool result = m_bDirty || bDirty;
     setDirtyAndUnlock(pLock, result);
 }
 
-void Track::setDirtyAndUnlock(QMutexLocker* pLock, bool bDirty) {
+void Track::publishEngineSnapshot() {
+    auto pSnapshot = std::make_shared<TrackEngineSnapshot>();
+    pSnapshot->version = ++m_engineSnapshotVersion;
+    pSnapshot->sampleRate = m_record.getMetadata().getSampleRate();
+    pSnapshot->duration =
+            m_record.getMetadata().getDuration().toDoubleSeconds();
+    pSnapshot->bpm = mixxx::Bpm::kValueUndefined;
+    if (m_pBeats) {
+        const double beatsBpm = m_pBeats->getBpm();
+        if (mixxx::Bpm::isValidValue(beatsBpm)) {
+            pSnapshot->bpm = beatsBpm;
+        }
+    }
+    pSnapshot->pBeats = m_pBeats;
+    pSnapshot->cuePoint = m_record.getCuePoint();
+    pSnapshot->cueIndex = CueIndex(m_cuePoints);
+    pSnapshot->replayGain =
+            m_record.getMetadata().getTrackInfo().getReplayGain();
+    pSnapshot->key = m_record.getGlobalKey();
+    m_engineSnapshot.setValue(std::move(pSnapshot));
+}
+
+void Track::setDirtyAndUnlock(MMutexLocker* pLock, bool bDirty) {
     const bool dirtyChanged = m_bDirty != bDirty;
     m_bDirty = bDirty;
 
@@ -823,31 +853,31 @@ void Track::setDirtyAndUnlock(QMutexLocker* pLock, bool bDirty) {
 }
 
 bool Track::isDirty() {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_bDirty;
 }
 
 
 void Track::markForMetadataExport() {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_bMarkedForMetadataExport, true)) {
         markDirtyAndUnlock(&lock);
     }
 }
 
 int Track::getRating() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getRating();
 }
 
 void Track::setRating (int rating) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refRating(), rating)) {
         markDirtyAndUnlock(&lock);
     }
 }
 
-void Track::afterKeysUpdated(QMutexLocker* pLock) {
+void Track::afterKeysUpdated(MMutexLocker* pLock) {
     // New key might be INVALID. We don't care.
     mixxx::track::io::key::ChromaticKey newKey = m_record.getGlobalKey();
     markDirtyAndUnlock(pLock);
@@ -856,62 +886,62 @@ void Track::afterKeysUpdated(QMutexLocker* pLock) {
 }
 
 void Track::setKeys(const Keys& keys) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     m_record.setKeys(keys);
     afterKeysUpdated(&lock);
 }
 
 void Track::resetKeys() {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     m_record.resetKeys();
     afterKeysUpdated(&lock);
 }
 
 Keys Track::getKeys() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getKeys();
 }
 
 void Track::setKey(mixxx::track::io::key::ChromaticKey key,
                    mixxx::track::io::key::Source keySource) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (m_record.updateGlobalKey(key, keySource)) {
         afterKeysUpdated(&lock);
     }
 }
 
 mixxx::track::io::key::ChromaticKey Track::getKey() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getGlobalKey();
 }
 
 QString Track::getKeyText() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getGlobalKeyText();
 }
 
 void Track::setKeyText(const QString& keyText,
                        mixxx::track::io::key::Source keySource) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (m_record.updateGlobalKeyText(keyText, keySource)) {
         afterKeysUpdated(&lock);
     }
 }
 
 void Track::setBpmLocked(bool bpmLocked) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refBpmLocked(), bpmLocked)) {
         markDirtyAndUnlock(&lock);
     }
 }
 
 bool Track::isBpmLocked() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getBpmLocked();
 }
 
 void Track::setCoverInfo(const CoverInfoRelative& coverInfoRelative) {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     if (compareAndSet(&m_record.refCoverInfo(), coverInfoRelative)) {
         markDirtyAndUnlock(&lock);
         emit(coverArtUpdated());
@@ -920,7 +950,7 @@ void Track::setCoverInfo(const CoverInfoRelative& coverInfoRelative) {
 
 void Track::setCoverInfo(const CoverInfo& coverInfo) {
     CoverInfoRelative coverInfoRelative(coverInfo);
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     DEBUG_ASSERT(coverInfo.trackLocation == m_fileInfo.absoluteFilePath());
     if (compareAndSet(&m_record.refCoverInfo(), coverInfoRelative)) {
         markDirtyAndUnlock(&lock);
@@ -933,27 +963,20 @@ void Track::setCoverInfo(const CoverArt& coverArt) {
 }
 
 CoverInfo Track::getCoverInfo() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return CoverInfo(m_record.getCoverInfo(), m_fileInfo.absoluteFilePath());
 }
 
 quint16 Track::getCoverHash() const {
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     return m_record.getCoverInfo().hash;
 }
 
-Track::ExportMetadataResult Track::exportMetadata(
-        mixxx::MetadataSourcePointer pMetadataSource) {
-    VERIFY_OR_DEBUG_ASSERT(pMetadataSource) {
-        kLogger.warning()
-                << "Cannot export track metadata:"
-                << getLocation();
-        return ExportMetadataResult::Failed;
-    }
+Track::MetadataExportSnapshot Track::takeMetadataExportSnapshot() {
     // Locking shouldn't be necessary here, because this function will
     // be called after all references to the object have been dropped.
     // But it doesn't hurt much, so let's play it safe ;)
-    QMutexLocker lock(&m_qMutex);
+    MMutexLocker lock(&m_qMutex);
     // Discard the values of all currently unsupported fields that are
     // not stored in the library, yet. Those fields are already imported
     // from file tags, but the database schema needs to be extended for
@@ -966,18 +989,42 @@ Track::ExportMetadataResult Track::exportMetadata(
     // repeatedly indicate that values have changed only due to
     // rounding errors.
     m_record.refMetadata().normalizeBeforeExport();
-    if (!m_bMarkedForMetadataExport) {
+    MetadataExportSnapshot snapshot;
+    snapshot.metadata = m_record.getMetadata();
+    if (m_pBeats) {
+        snapshot.beatsBpm = getActualBpm(mixxx::Bpm(), m_pBeats);
+    }
+    snapshot.markedForMetadataExport = m_bMarkedForMetadataExport;
+    snapshot.metadataSynchronized = m_record.getMetadataSynchronized();
+    // The track's metadata will be exported instantly or by the queue. The
+    // export should only be tried once so we reset the marker flag.
+    m_bMarkedForMetadataExport = false;
+    return snapshot;
+}
+
+//static
+Track::ExportMetadataResult Track::exportMetadata(
+        const MetadataExportSnapshot& snapshot,
+        mixxx::MetadataSourcePointer pMetadataSource,
+        const QString& location) {
+    VERIFY_OR_DEBUG_ASSERT(pMetadataSource) {
+        kLogger.warning()
+                << "Cannot export track metadata:"
+                << location;
+        return ExportMetadataResult::Failed;
+    }
+    if (!snapshot.markedForMetadataExport) {
         // Perform some consistency checks if metadata is exported
         // implicitly after a track has been modified and NOT explicitly
         // requested by a user as indicated by this flag.
-        if (!m_record.getMetadataSynchronized()) {
+        if (!snapshot.metadataSynchronized) {
             // If the metadata has never been imported from file tags it
             // must be exported explicitly once. This ensures that we don't
             // overwrite existing file tags with completely different
             // information.
             kLogger.debug()
                     << "Skip exporting of unsynchronized track metadata:"
-                    << getLocation();
+                    << location;
             return ExportMetadataResult::Skipped;
         }
         // Check if the metadata has actually been modified. Otherwise
@@ -990,8 +1037,12 @@ Track::ExportMetadataResult Track::exportMetadata(
         // We could take this time stamp and the file's last modification
         // time stamp into // account and might decide to skip importing
         // the metadata again.
+        // The audio properties are excluded from the comparison below and
+        // are not imported.
         mixxx::TrackMetadata importedFromFile;
-        if ((pMetadataSource->importTrackMetadataAndCoverImage(&importedFromFile, nullptr).first ==
+        if ((pMetadataSource->importTrackMetadataAndCoverImage(
+                &importedFromFile, nullptr,
+                mixxx::MetadataSource::IMPORT_TAGS).first ==
                 mixxx::MetadataSource::ImportResult::Succeeded)) {
             // Discard the values of all currently unsupported fields that are
             // not stored in the library, yet. We have done the same with the track's
@@ -1002,8 +1053,8 @@ Track::ExportMetadataResult Track::exportMetadata(
             // importing the track's metadata in order to preserve the more accurate
             // bpm value stored by Mixxx. Again, this is necessary to make the tags
             // comparable.
-            auto actualBpm =
-                    getActualBpm(importedFromFile.getTrackInfo().getBpm(), m_pBeats);
+            auto actualBpm = snapshot.beatsBpm.hasValue() ?
+                    snapshot.beatsBpm : importedFromFile.getTrackInfo().getBpm();
             // All imported floating point values are already properly rounded, because
             // they have just been imported. But the imported bpm value might have been
             // replaced by a more accurate bpm value, that also needs to be rounded before
@@ -1017,12 +1068,12 @@ Track::ExportMetadataResult Track::exportMetadata(
             // comparison function that excludes all read-only audio properties which
             // are stored in file tags, but may not be accurate. They can't be written
             // anyway, so we must not take them into account here.
-            if (!m_record.getMetadata().hasBeenModifiedAfterImport(importedFromFile))  {
+            if (!snapshot.metadata.hasBeenModifiedAfterImport(importedFromFile))  {
                 // The file tags are in-sync with the track's metadata and don't need
                 // to be updated.
                 kLogger.debug()
                         << "Skip exporting of unmodified track metadata into file:"
-                        << getLocation();
+                        << location;
                 return ExportMetadataResult::Skipped;
             }
         } else {
@@ -1033,34 +1084,23 @@ Track::ExportMetadataResult Track::exportMetadata(
             kLogger.warning()
                     << "Skip exporting of track metadata after import failed."
                     << "Export of metadata must be triggered explicitly for this file:"
-                    << getLocation();
+                    << location;
             return ExportMetadataResult::Skipped;
         }
         // ...by continuing the file tags will be updated
     }
-    // The track's metadata will be exported instantly. The export should
-    // only be tried once so we reset the marker flag.
-    m_bMarkedForMetadataExport = false;
     const auto trackMetadataExported =
-            pMetadataSource->exportTrackMetadata(m_record.getMetadata());
+            pMetadataSource->exportTrackMetadata(snapshot.metadata);
     if (trackMetadataExported.first == mixxx::MetadataSource::ExportResult::Succeeded) {
-        // After successfully exporting the metadata we record the fact
-        // that now the file tags and the track's metadata are in sync.
-        // This information (flag or time stamp) is stored in the database.
-        // The database update will follow immediately after returning from
-        // this operation!
-        // TODO(XXX): Replace bool with QDateTime
         DEBUG_ASSERT(!trackMetadataExported.second.isNull());
-        //pTrack->setMetadataSynchronized(trackMetadataExported.second);
-        m_record.setMetadataSynchronized(!trackMetadataExported.second.isNull());
         kLogger.debug()
                 << "Exported track metadata:"
-                << getLocation();
+                << location;
         return ExportMetadataResult::Succeeded;
     } else {
         kLogger.warning()
                 << "Failed to export track metadata:"
-                << getLocation();
+                << location;
         return ExportMetadataResult::Failed;
     }
 }
@@ -6,10 +6,14 @@
 #include <QMutex>
 #include <QObject>
 
+#include "control/controlvalue.h"
 #include "library/dao/cue.h"
 #include "track/beats.h"
+#include "track/trackenginesnapshot.h"
 #include "track/trackrecord.h"
 #include "util/memory.h"
+#include "util/memoryaccounting.h"
+#include "util/mutex.h"
 #include "util/sandbox.h"
 #include "waveform/waveform.h"
 
@@ -255,6 +259,12 @@ class Track : public QObject {
     // Get the track's Beats list
     BeatsPointer getBeats() const;
 
+    // The most recent snapshot of the properties that the engine reads.
+    // Wait-free, may be called from the engine thread.
+    TrackEngineSnapshotPointer getEngineSnapshot() const {
+        return m_engineSnapshot.getValue();
+    }
+
     // Set the track's Beats
     void setBeats(BeatsPointer beats);
 
@@ -331,12 +341,14 @@ class Track : public QObject {
     // Set whether the TIO is dirty or not and unlock before emitting
     // any signals. This must only be called from member functions
     // while the TIO is locked.
-    void markDirtyAndUnlock(QMutexLocker* pLock, bool bDirty = true);
-    void setDirtyAndUnlock(QMutexLocker* pLock, bool bDirty);
+    void markDirtyAndUnlock(MMutexLocker* pLock, bool bDirty = true);
+    void setDirtyAndUnlock(MMutexLocker* pLock, bool bDirty);
+    // Replaces the engine snapshot, must be called while locked
+    void publishEngineSnapshot();
 
-    void setBeatsAndUnlock(QMutexLocker* pLock, BeatsPointer pBeats);
+    void setBeatsAndUnlock(MMutexLocker* pLock, BeatsPointer pBeats);
 
-    void afterKeysUpdated(QMutexLocker* pLock);
+    void afterKeysUpdated(MMutexLocker* pLock);
 
     enum class DurationRounding {
         SECONDS, // rounded to full seconds
@@ -349,8 +361,25 @@ class Track : public QObject {
         Failed,
         Skipped,
     };
-    ExportMetadataResult exportMetadata(
-            mixxx::MetadataSourcePointer pMetadataSource);
+
+    // The state of the track that decides if and what is exported into
+    // the file tags. It is taken when the track is saved, so the export
+    // can be done later by TrackMetadataExportQueue, after the track object
+    // has been deleted.
+    struct MetadataExportSnapshot {
+        mixxx::TrackMetadata metadata;
+        // The bpm of the beats, which replaces the imprecise bpm of the
+        // file tags for the comparison. No value without beats.
+        mixxx::Bpm beatsBpm;
+        bool markedForMetadataExport = false;
+        bool metadataSynchronized = false;
+    };
+    // The export is only tried once, so this resets the explicit request
+    MetadataExportSnapshot takeMetadataExportSnapshot();
+    static ExportMetadataResult exportMetadata(
+            const MetadataExportSnapshot& snapshot,
+            mixxx::MetadataSourcePointer pMetadataSource,
+            const QString& location);
 
     // The file
     const QFileInfo m_fileInfo;
@@ -358,7 +387,7 @@ class Track : public QObject {
     const SecurityTokenPointer m_pSecurityToken;
 
     // Mutex protecting access to object
-    mutable QMutex m_qMutex;
+    mutable MMutex m_qMutex;
 
     mixxx::TrackRecord m_record;
 
@@ -382,10 +411,18 @@ class Track : public QObject {
 
     QAtomicInt m_analyzerProgress; // in 0.1%
 
+    // Only written while locked
+    ControlValueAtomic<TrackEngineSnapshotPointer> m_engineSnapshot;
+    quint64 m_engineSnapshotVersion;
+
+    // The track object itself, the waveforms are accounted separately
+    MemoryAccount m_memoryAccount;
+
     friend class TrackDAO;
     friend class TrackCache;
     friend class TrackCacheResolver;
     friend class SoundSourceProxy;
+    friend class TrackMetadataExportQueue;
 };
 
 typedef std::weak_ptr<Track> TrackWeakPointer;
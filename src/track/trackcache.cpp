@@ -2,6 +2,7 @@
 
 #include "util/assert.h"
 #include "util/logger.h"
+#include "util/performancetimer.h"
 #include "util/stat.h"
 
 
@@ -22,6 +23,11 @@ const QString kEraseByCanonicalLocationCounter("TrackCache::eraseByCanonicalLoca
 
 const QString kEvictCounter("TrackCache::evict");
 
+// How often and how long a thread waited for a shard that was locked by
+// another thread
+const QString kContendedLockCounter("TrackCache::contendedLock");
+const QString kContendedLockDuration("TrackCache::contendedLockDuration");
+
 inline
 TrackRef createTrackRef(const Track& track) {
     return TrackRef::fromFileInfo(track.getFileInfo(), track.getId());
@@ -31,26 +37,29 @@ TrackRef createTrackRef(const Track& track) {
 
 TrackCacheLocker::TrackCacheLocker()
         : m_pCacheMutex(nullptr),
+          m_shard(-1),
           m_lookupResult(TrackCacheLookupResult::NONE) {
-    lockCache();
-    // Verify consistency after the cache has been locked
-    DEBUG_ASSERT(TrackCache::instance().verifyConsistency());
 }
 
 TrackCacheLocker::TrackCacheLocker(
         TrackCacheLocker&& moveable)
         : m_pCacheMutex(std::move(moveable.m_pCacheMutex)),
+          m_shard(std::move(moveable.m_shard)),
           m_lookupResult(std::move(moveable.m_lookupResult)),
           m_trackRef(std::move(moveable.m_trackRef)),
           m_pTrack(std::move(moveable.m_pTrack)) {
     moveable.m_pCacheMutex = nullptr;
+    moveable.m_shard = -1;
 }
 
 TrackCacheLocker& TrackCacheLocker::operator=(
         TrackCacheLocker&& moveable) {
     if (this != &moveable) {
+        unlockCache();
         m_pCacheMutex = std::move(moveable.m_pCacheMutex);
         moveable.m_pCacheMutex = nullptr;
+        m_shard = std::move(moveable.m_shard);
+        moveable.m_shard = -1;
         m_lookupResult = std::move(moveable.m_lookupResult);
         m_trackRef = std::move(moveable.m_trackRef);
         m_pTrack = std::move(moveable.m_pTrack);
@@ -64,10 +73,12 @@ TrackCacheLocker::TrackCacheLocker(
         TrackRef trackRef,
         TrackPointer pTrack)
         : m_pCacheMutex(moveable.m_pCacheMutex),
+          m_shard(moveable.m_shard),
           m_lookupResult(lookupResult),
           m_trackRef(std::move(trackRef)),
           m_pTrack(std::move(pTrack)) {
     moveable.m_pCacheMutex = nullptr;
+    moveable.m_shard = -1;
     // Class invariants
     DEBUG_ASSERT((TrackCacheLookupResult::NONE != m_lookupResult) || !m_pTrack);
 }
@@ -76,19 +87,31 @@ TrackCacheLocker::~TrackCacheLocker() {
     unlockCache();
 }
 
-void TrackCacheLocker::lockCache() {
+void TrackCacheLocker::lockShard(int shard) {
     DEBUG_ASSERT(nullptr == m_pCacheMutex);
-    QMutex* pCacheMutex = &TrackCache::instance().m_mutex;
-    pCacheMutex->lock();
+    DEBUG_ASSERT((shard >= 0) && (shard < TrackCache::kShardCount));
+    MMutex* pCacheMutex = &TrackCache::instance().m_shards[shard].mutex;
+    if (!pCacheMutex->tryLock()) {
+        PerformanceTimer timer;
+        timer.start();
+        pCacheMutex->lock();
+        Stat::track(kContendedLockCounter, Stat::COUNTER, kStatCounterFlags, 1);
+        Stat::track(kContendedLockDuration, Stat::DURATION_NANOSEC,
+                kStatCounterFlags, timer.elapsed().toIntegerNanos());
+    }
     m_pCacheMutex = pCacheMutex;
+    m_shard = shard;
+    // Verify consistency after the shard has been locked
+    DEBUG_ASSERT(TrackCache::instance().verifyConsistency(m_shard));
 }
 
 void TrackCacheLocker::unlockCache() {
     if (nullptr != m_pCacheMutex) {
-        // Verify consistency before unlocking the cache
-        DEBUG_ASSERT(TrackCache::instance().verifyConsistency());
+        // Verify consistency before unlocking the shard
+        DEBUG_ASSERT(TrackCache::instance().verifyConsistency(m_shard));
         m_pCacheMutex->unlock();
         m_pCacheMutex = nullptr;
+        m_shard = -1;
     }
 }
 
@@ -113,6 +136,7 @@ void TrackCacheResolver::updateTrackId(TrackId trackId) {
     DEBUG_ASSERT(m_pTrack);
     DEBUG_ASSERT(trackId.isValid());
     m_trackRef = TrackCache::instance().updateTrackIdInternal(
+            m_shard,
             m_pTrack,
             m_trackRef,
             trackId);
@@ -149,23 +173,48 @@ void TrackCache::deleter(Track* pTrack) {
 
 TrackCache::TrackCache(TrackCacheEvictor* pEvictor)
     : m_pEvictor(pEvictor),
-      m_mutex(QMutex::Recursive) {
+      m_shardsOfTracksMutex("TrackCache shardsOfTracks") {
     DEBUG_ASSERT(m_pEvictor != nullptr);
-    DEBUG_ASSERT(verifyConsistency());
 }
 
 TrackCache::~TrackCache() {
-    DEBUG_ASSERT(verifyConsistency());
     // Verify that the cache is empty upon destruction
-    DEBUG_ASSERT(m_tracksById.empty());
-    DEBUG_ASSERT(m_tracksByCanonicalLocation.empty());
+    for (const auto& shard : m_shards) {
+        DEBUG_ASSERT(shard.tracksById.empty());
+        DEBUG_ASSERT(shard.tracksByCanonicalLocation.empty());
+    }
+    DEBUG_ASSERT(m_shardsOfTrackIds.empty());
+    DEBUG_ASSERT(m_shardsOfTracks.empty());
+}
+
+//static
+int TrackCache::shardForTrackRef(const TrackRef& trackRef) {
+    DEBUG_ASSERT(trackRef.isValid());
+    const uint hash = trackRef.hasCanonicalLocation() ?
+            qHash(trackRef.getCanonicalLocation()) :
+            qHash(trackRef.getId());
+    return hash % kShardCount;
 }
 
-bool TrackCache::verifyConsistency() const {
-    VERIFY_OR_DEBUG_ASSERT(m_tracksById.keys().size() == m_tracksById.uniqueKeys().size()) {
+int TrackCache::shardOfTrackId(const TrackId& trackId) const {
+    MMutexLocker locker(&m_shardsOfTracksMutex);
+    return m_shardsOfTrackIds.value(trackId, -1);
+}
+
+int TrackCache::shardOfTrack(const Track* pTrack) const {
+    MMutexLocker locker(&m_shardsOfTracksMutex);
+    return m_shardsOfTracks.value(pTrack, -1);
+}
+
+bool TrackCache::verifyConsistency(int shardIndex) const {
+    const Shard& shard = m_shards[shardIndex];
+    const TracksById& tracksById = shard.tracksById;
+    const TracksByCanonicalLocation& tracksByCanonicalLocation =
+            shard.tracksByCanonicalLocation;
+    VERIFY_OR_DEBUG_ASSERT(tracksById.keys().size() == tracksById.uniqueKeys().size()) {
         return false;
     }
-    for (TracksById::const_iterator i(m_tracksById.begin()); i != m_tracksById.end(); ++i) {
+    for (TracksById::const_iterator i(tracksById.begin()); i != tracksById.end(); ++i) {
         const TrackRef trackRef((*i).ref);
         const TrackId trackId(trackRef.getId());
         VERIFY_OR_DEBUG_ASSERT(trackId.isValid()) {
@@ -177,18 +226,24 @@ bool TrackCache::verifyConsistency() const {
         VERIFY_OR_DEBUG_ASSERT(createTrackRef(*(*i).plainPtr) == trackRef) {
             return false;
         }
-        VERIFY_OR_DEBUG_ASSERT(1 == m_tracksById.count(trackId)) {
+        VERIFY_OR_DEBUG_ASSERT(1 == tracksById.count(trackId)) {
+            return false;
+        }
+        VERIFY_OR_DEBUG_ASSERT(shardOfTrackId(trackId) == shardIndex) {
+            return false;
+        }
+        VERIFY_OR_DEBUG_ASSERT(shardOfTrack((*i).plainPtr) == shardIndex) {
             return false;
         }
         const QString canonicalLocation(trackRef.getCanonicalLocation());
         if (!canonicalLocation.isEmpty()) {
             VERIFY_OR_DEBUG_ASSERT(
-                    1 == m_tracksByCanonicalLocation.count(canonicalLocation)) {
+                    1 == tracksByCanonicalLocation.count(canonicalLocation)) {
                 return false;
             }
             TracksByCanonicalLocation::const_iterator j(
-                    m_tracksByCanonicalLocation.find(canonicalLocation));
-            VERIFY_OR_DEBUG_ASSERT(m_tracksByCanonicalLocation.end() != j) {
+                    tracksByCanonicalLocation.find(canonicalLocation));
+            VERIFY_OR_DEBUG_ASSERT(tracksByCanonicalLocation.end() != j) {
                 return false;
             }
             VERIFY_OR_DEBUG_ASSERT((*j).ref == trackRef) {
@@ -196,7 +251,7 @@ bool TrackCache::verifyConsistency() const {
             }
         }
     }
-    for (TracksByCanonicalLocation::const_iterator i(m_tracksByCanonicalLocation.begin()); i != m_tracksByCanonicalLocation.end(); ++i) {
+    for (TracksByCanonicalLocation::const_iterator i(tracksByCanonicalLocation.begin()); i != tracksByCanonicalLocation.end(); ++i) {
         const TrackRef trackRef((*i).ref);
         const TrackId trackId(trackRef.getId());
         const QString canonicalLocation(trackRef.getCanonicalLocation());
@@ -209,13 +264,16 @@ bool TrackCache::verifyConsistency() const {
         VERIFY_OR_DEBUG_ASSERT(createTrackRef(*(*i).plainPtr) == trackRef) {
             return false;
         }
-        VERIFY_OR_DEBUG_ASSERT(1 == m_tracksByCanonicalLocation.count(canonicalLocation)) {
+        VERIFY_OR_DEBUG_ASSERT(1 == tracksByCanonicalLocation.count(canonicalLocation)) {
+            return false;
+        }
+        VERIFY_OR_DEBUG_ASSERT(shardOfTrack((*i).plainPtr) == shardIndex) {
             return false;
         }
         TracksById::const_iterator j(
-                m_tracksById.find(trackId));
+                tracksById.find(trackId));
         VERIFY_OR_DEBUG_ASSERT(
-                (m_tracksById.end() == j) || ((*j).ref == trackRef)) {
+                (tracksById.end() == j) || ((*j).ref == trackRef)) {
             return false;
         }
     }
@@ -226,22 +284,37 @@ TrackCacheLocker TrackCache::lookupById(
         const TrackId& trackId) const {
     TrackCacheLocker cacheLocker;
     if (trackId.isValid()) {
-        const TrackPointer pTrack(lookupInternal(trackId));
-        if (pTrack) {
-            cacheLocker.m_lookupResult = TrackCacheLookupResult::HIT;
-            cacheLocker.m_trackRef = createTrackRef(*pTrack);
-            cacheLocker.m_pTrack = pTrack;
-        } else {
-            cacheLocker.m_lookupResult = TrackCacheLookupResult::MISS;
+        cacheLocker.m_lookupResult = TrackCacheLookupResult::MISS;
+        for (;;) {
+            const int shard = shardOfTrackId(trackId);
+            if (shard < 0) {
+                break;
+            }
+            cacheLocker.lockShard(shard);
+            // The track might have been evicted and cached again in
+            // another shard while waiting
+            if (shardOfTrackId(trackId) != shard) {
+                cacheLocker.unlockCache();
+                continue;
+            }
+            const TrackPointer pTrack(lookupInternal(shard, trackId));
+            if (pTrack) {
+                cacheLocker.m_lookupResult = TrackCacheLookupResult::HIT;
+                cacheLocker.m_trackRef = createTrackRef(*pTrack);
+                cacheLocker.m_pTrack = pTrack;
+            }
+            break;
         }
     }
     return std::move(cacheLocker);
 }
 
 TrackPointer TrackCache::lookupInternal(
+        int shard,
         const TrackId& trackId) const {
-    const auto trackById(m_tracksById.find(trackId));
-    if (m_tracksById.end() != trackById) {
+    const TracksById& tracksById = m_shards[shard].tracksById;
+    const auto trackById(tracksById.find(trackId));
+    if (tracksById.end() != trackById) {
         // Cache hit
         return TrackPointer((*trackById).weakPtr);
     } else {
@@ -250,114 +323,98 @@ TrackPointer TrackCache::lookupInternal(
     }
 }
 
-TrackPointer TrackCache::lookupInternal(
-        const TrackRef& trackRef) const {
-    if (trackRef.hasId()) {
-        return lookupInternal(trackRef.getId());
-    } else {
-        const auto trackByCanonicalLocation(
-                m_tracksByCanonicalLocation.find(trackRef.getCanonicalLocation()));
-        if (m_tracksByCanonicalLocation.end() != trackByCanonicalLocation) {
-            // Cache hit
-            return TrackPointer((*trackByCanonicalLocation).weakPtr);
-        } else {
-            // Cache miss
-            return TrackPointer();
+bool TrackCache::resolveByIdInternal(
+        TrackCacheResolver* /*in/out*/ pCacheResolver,
+        const TrackId& /*in*/ trackId) {
+    DEBUG_ASSERT(nullptr != pCacheResolver);
+    const int shard = pCacheResolver->m_shard;
+    kLogger.debug()
+            << "Resolving track by id"
+            << trackId;
+    TracksById& tracksById = m_shards[shard].tracksById;
+    const auto trackById(tracksById.find(trackId));
+    if (tracksById.end() != trackById) {
+        // Cache hit
+        TrackRef resolvedTrackRef((*trackById).ref);
+        TrackPointer pResolvedTrack((*trackById).weakPtr);
+        if (pResolvedTrack) {
+            kLogger.debug()
+                    << "Cache hit - found track by id"
+                    << resolvedTrackRef;
+            *pCacheResolver = TrackCacheResolver(
+                    std::move(*pCacheResolver),
+                    TrackCacheLookupResult::HIT,
+                    resolvedTrackRef,
+                    pResolvedTrack);
+            return true;
+        }
+        // We don't expect that this might ever happen, but let's even
+        // handle this special case!
+        VERIFY_OR_DEBUG_ASSERT(pResolvedTrack) {
+            // Explicitly evict the cached track before the deleter does it
+            kLogger.warning()
+                    << "Cache hit - evicting zombie track"
+                    << resolvedTrackRef;
+            Track* pZombieTrack = (*trackById).plainPtr;
+            // The cache must stay locked after evicting the zombie entry
+            // so we don't pass the locker on!
+            Track* pEvictedTrack = evictInternal(shard, nullptr, resolvedTrackRef);
+            DEBUG_ASSERT((nullptr == pEvictedTrack) ||
+                    (pEvictedTrack == pZombieTrack));
+            // ...and continue like it has not been found
         }
     }
+    return false;
 }
 
-bool TrackCache::resolveInternal(
+bool TrackCache::resolveByCanonicalLocationInternal(
         TrackCacheResolver* /*in/out*/ pCacheResolver,
-        TrackRef* /*out*/ pTrackRef,
-        const TrackId& /*in*/ trackId,
-        const QFileInfo& /*in*/ fileInfo) {
+        const TrackRef& /*in*/ trackRef) {
     DEBUG_ASSERT(nullptr != pCacheResolver);
-    // Primary lookup by id (if available)
-    if (trackId.isValid()) {
-        kLogger.debug()
-                << "Resolving track by id"
-                << trackId;
-        const auto trackById(m_tracksById.find(trackId));
-        if (m_tracksById.end() != trackById) {
-            // Cache hit
-            TrackRef resolvedTrackRef((*trackById).ref);
-            TrackPointer pResolvedTrack((*trackById).weakPtr);
-            if (pResolvedTrack) {
-                kLogger.debug()
-                        << "Cache hit - found track by id"
-                        << resolvedTrackRef;
-                *pCacheResolver = TrackCacheResolver(
-                        std::move(*pCacheResolver),
-                        TrackCacheLookupResult::HIT,
-                        resolvedTrackRef,
-                        pResolvedTrack);
-                return true;
-            }
-            // We don't expect that this might ever happen, but let's even
-            // handle this special case!
-            VERIFY_OR_DEBUG_ASSERT(pResolvedTrack) {
-                // Explicitly evict the cached track before the deleter does it
-                kLogger.warning()
-                        << "Cache hit - evicting zombie track"
-                        << resolvedTrackRef;
-                // The cache must stay locked after evicting the zombie entry
-                // so we don't pass the locker on!
-                Track* pEvictedTrack = evictInternal(nullptr, resolvedTrackRef);
-                DEBUG_ASSERT((nullptr == pEvictedTrack) ||
-                        (pEvictedTrack == (*trackById).plainPtr));
-                // ...and continue like it has not been found
-            }
+    DEBUG_ASSERT(trackRef.hasCanonicalLocation());
+    const int shard = pCacheResolver->m_shard;
+    kLogger.debug()
+            << "Resolving track by canonical location"
+            << trackRef.getCanonicalLocation();
+    TracksByCanonicalLocation& tracksByCanonicalLocation =
+            m_shards[shard].tracksByCanonicalLocation;
+    const auto trackByCanonicalLocation(
+            tracksByCanonicalLocation.find(
+                    trackRef.getCanonicalLocation()));
+    if (tracksByCanonicalLocation.end() != trackByCanonicalLocation) {
+        // Cache hit
+        TrackRef resolvedTrackRef((*trackByCanonicalLocation).ref);
+        TrackPointer pResolvedTrack((*trackByCanonicalLocation).weakPtr);
+        if (pResolvedTrack) {
+            kLogger.debug()
+                    << "Cache hit - found track by canonical location"
+                    << resolvedTrackRef;
+            // Consistency: Resolving by id  must return the same result!
+            DEBUG_ASSERT(!resolvedTrackRef.hasId() ||
+                    (lookupInternal(shard, resolvedTrackRef.getId()) == pResolvedTrack));
+            *pCacheResolver = TrackCacheResolver(
+                    std::move(*pCacheResolver),
+                    TrackCacheLookupResult::HIT,
+                    resolvedTrackRef,
+                    pResolvedTrack);
+            return true;
         }
-    }
-    // Secondary lookup by canonical location
-    // The TrackRef is constructed now after the lookup by ID failed to
-    // avoid calculating the canonical file path if it is not needed.
-    TrackRef trackRef(TrackRef::fromFileInfo(fileInfo, trackId));
-    if (trackRef.hasCanonicalLocation()) {
-        kLogger.debug()
-                << "Resolving track by canonical location"
-                << trackRef.getCanonicalLocation();
-        const auto trackByCanonicalLocation(
-                m_tracksByCanonicalLocation.find(
-                        trackRef.getCanonicalLocation()));
-        if (m_tracksByCanonicalLocation.end() != trackByCanonicalLocation) {
-            // Cache hit
-            TrackRef resolvedTrackRef((*trackByCanonicalLocation).ref);
-            TrackPointer pResolvedTrack((*trackByCanonicalLocation).weakPtr);
-            if (pResolvedTrack) {
-                kLogger.debug()
-                        << "Cache hit - found track by canonical location"
-                        << resolvedTrackRef;
-                // Consistency: Resolving by id  must return the same result!
-                DEBUG_ASSERT(!resolvedTrackRef.hasId() ||
-                        (lookupInternal(resolvedTrackRef.getId()) == pResolvedTrack));
-                *pCacheResolver = TrackCacheResolver(
-                        std::move(*pCacheResolver),
-                        TrackCacheLookupResult::HIT,
-                        resolvedTrackRef,
-                        pResolvedTrack);
-                return true;
-            }
-            // We don't expect that this might ever happen, but let's even
-            // handle this special case!
-            VERIFY_OR_DEBUG_ASSERT(pResolvedTrack) {
-                // Explicitly evict the cached track before the deleter does it.
-                kLogger.warning()
-                        << "Cache hit - evicting zombie track"
-                        << resolvedTrackRef;
-                // The cache must stay locked after evicting the zombie entry
-                // so we don't pass the locker on!
-                Track* pEvictedTrack = evictInternal(nullptr, resolvedTrackRef);
-                DEBUG_ASSERT((nullptr == pEvictedTrack) ||
-                        (pEvictedTrack == (*trackByCanonicalLocation).plainPtr));
-                // ...and continue like it has not been found
-            }
+        // We don't expect that this might ever happen, but let's even
+        // handle this special case!
+        VERIFY_OR_DEBUG_ASSERT(pResolvedTrack) {
+            // Explicitly evict the cached track before the deleter does it.
+            kLogger.warning()
+                    << "Cache hit - evicting zombie track"
+                    << resolvedTrackRef;
+            Track* pZombieTrack = (*trackByCanonicalLocation).plainPtr;
+            // The cache must stay locked after evicting the zombie entry
+            // so we don't pass the locker on!
+            Track* pEvictedTrack = evictInternal(shard, nullptr, resolvedTrackRef);
+            DEBUG_ASSERT((nullptr == pEvictedTrack) ||
+                    (pEvictedTrack == pZombieTrack));
+            // ...and continue like it has not been found
         }
     }
-    if (nullptr != pTrackRef) {
-        *pTrackRef = trackRef;
-    }
     return false;
 }
 
@@ -365,12 +422,24 @@ TrackCacheResolver TrackCache::resolve(
         const TrackId& trackId,
         const QFileInfo& fileInfo,
         const SecurityTokenPointer& pSecurityToken) {
-    TrackRef trackRef;
     TrackCacheResolver cacheResolver;
-    if (resolveInternal(&cacheResolver, &trackRef, trackId, fileInfo)) {
-        DEBUG_ASSERT(cacheResolver.getTrackCacheLookupResult() == TrackCacheLookupResult::HIT);
-        return cacheResolver;
+    // Primary lookup by id (if available)
+    if (trackId.isValid()) {
+        const int shard = shardOfTrackId(trackId);
+        if (shard >= 0) {
+            cacheResolver.lockShard(shard);
+            if ((shardOfTrackId(trackId) == shard) &&
+                    resolveByIdInternal(&cacheResolver, trackId)) {
+                DEBUG_ASSERT(cacheResolver.getTrackCacheLookupResult() == TrackCacheLookupResult::HIT);
+                return cacheResolver;
+            }
+            cacheResolver.unlockCache();
+        }
     }
+    // Secondary lookup by canonical location
+    // The TrackRef is constructed now after the lookup by ID failed to
+    // avoid calculating the canonical file path if it is not needed.
+    TrackRef trackRef(TrackRef::fromFileInfo(fileInfo, trackId));
     if (!trackRef.isValid()) {
         DEBUG_ASSERT(cacheResolver.getTrackCacheLookupResult() == TrackCacheLookupResult::NONE);
         kLogger.warning()
@@ -378,6 +447,27 @@ TrackCacheResolver TrackCache::resolve(
                 << trackRef;
         return cacheResolver;
     }
+    const int shard = shardForTrackRef(trackRef);
+    cacheResolver.lockShard(shard);
+    if (trackId.isValid()) {
+        // Another thread might have cached the track by id in the meantime
+        const int shardOfId = shardOfTrackId(trackId);
+        if (shardOfId == shard) {
+            if (resolveByIdInternal(&cacheResolver, trackId)) {
+                DEBUG_ASSERT(cacheResolver.getTrackCacheLookupResult() == TrackCacheLookupResult::HIT);
+                return cacheResolver;
+            }
+        } else if (shardOfId >= 0) {
+            // Only one shard may be locked at a time
+            cacheResolver.unlockCache();
+            return resolve(trackId, fileInfo, pSecurityToken);
+        }
+    }
+    if (trackRef.hasCanonicalLocation() &&
+            resolveByCanonicalLocationInternal(&cacheResolver, trackRef)) {
+        DEBUG_ASSERT(cacheResolver.getTrackCacheLookupResult() == TrackCacheLookupResult::HIT);
+        return cacheResolver;
+    }
     kLogger.debug()
             << "Cache miss - inserting new track into cache"
             << trackRef;
@@ -389,14 +479,21 @@ TrackCacheResolver TrackCache::resolve(
             deleter);
     DEBUG_ASSERT(createTrackRef(*pTrack) == trackRef);
     const Item item(trackRef, pTrack);
+    {
+        MMutexLocker locker(&m_shardsOfTracksMutex);
+        m_shardsOfTracks.insert(pTrack.get(), shard);
+        if (trackRef.hasId()) {
+            m_shardsOfTrackIds.insert(trackRef.getId(), shard);
+        }
+    }
     if (trackRef.hasId()) {
-        m_tracksById.insert(
+        m_shards[shard].tracksById.insert(
                 trackRef.getId(),
                 item);
         Stat::track(kInsertByIdCounter, Stat::COUNTER, kStatCounterFlags, 1);
     }
     if (trackRef.hasCanonicalLocation()) {
-        m_tracksByCanonicalLocation.insert(
+        m_shards[shard].tracksByCanonicalLocation.insert(
                 trackRef.getCanonicalLocation(),
                 item);
         Stat::track(kInsertByCanonicalLocationCounter, Stat::COUNTER, kStatCounterFlags, 1);
@@ -409,18 +506,23 @@ TrackCacheResolver TrackCache::resolve(
 }
 
 TrackRef TrackCache::updateTrackIdInternal(
+        int shard,
         const TrackPointer& pTrack,
         const TrackRef& trackRef,
         TrackId trackId) {
     DEBUG_ASSERT(trackId.isValid());
     if (trackRef.getId() != trackId) {
-        DEBUG_ASSERT(m_tracksById.end() == m_tracksById.find(trackId));
+        DEBUG_ASSERT(shardOfTrackId(trackId) < 0);
         TrackRef trackRefWithId(trackRef, trackId);
         Item item(trackRefWithId, pTrack);
-        m_tracksById.insert(
+        {
+            MMutexLocker locker(&m_shardsOfTracksMutex);
+            m_shardsOfTrackIds.insert(trackId, shard);
+        }
+        m_shards[shard].tracksById.insert(
                 item.ref.getId(),
                 item);
-        m_tracksByCanonicalLocation.insert(
+        m_shards[shard].tracksByCanonicalLocation.insert(
                 item.ref.getCanonicalLocation(),
                 item);
         return trackRefWithId;
@@ -431,28 +533,41 @@ TrackRef TrackCache::updateTrackIdInternal(
 void TrackCache::evict(
         Track* pTrack) {
     DEBUG_ASSERT(pTrack != nullptr);
+    // The shard stays the same while the track is cached
+    const int shard = shardOfTrack(pTrack);
+    if (shard < 0) {
+        kLogger.debug()
+                << "Uncached track cannot be evicted"
+                << pTrack->m_fileInfo.absoluteFilePath();
+        return;
+    }
     const auto trackRef = TrackRef::fromFileInfo(
             pTrack->m_fileInfo,
             pTrack->m_record.getId());
     TrackCacheLocker cacheLocker;
-    Track* pEvictedTrack = evictInternal(&cacheLocker, trackRef);
+    cacheLocker.lockShard(shard);
+    Track* pEvictedTrack = evictInternal(shard, &cacheLocker, trackRef);
     // The cache might have been unlocked during the callback!
     DEBUG_ASSERT((nullptr == pEvictedTrack) || (pEvictedTrack == pTrack));
 }
 
 TrackCache::Item TrackCache::purgeInternal(
+        int shard,
         const TrackRef& trackRef) {
     kLogger.debug()
             << "Purging track"
             << trackRef;
 
+    TracksById& tracksById = m_shards[shard].tracksById;
+    TracksByCanonicalLocation& tracksByCanonicalLocation =
+            m_shards[shard].tracksByCanonicalLocation;
     Item purgedItem;
     DEBUG_ASSERT(!purgedItem.ref.isValid());
     if (trackRef.hasId()) {
-        const auto trackById(m_tracksById.find(trackRef.getId()));
-        if (m_tracksById.end() != trackById) {
+        const auto trackById(tracksById.find(trackRef.getId()));
+        if (tracksById.end() != trackById) {
             purgedItem = *trackById;
-            m_tracksById.erase(trackById);
+            tracksById.erase(trackById);
             Stat::track(kEraseByIdCounter, Stat::COUNTER, kStatCounterFlags, 1);
         }
     }
@@ -465,8 +580,8 @@ TrackCache::Item TrackCache::purgeInternal(
                     purgedItem.ref.getCanonicalLocation() :
                     trackRef.getCanonicalLocation());
     const auto trackByCanonicalLocation(
-            m_tracksByCanonicalLocation.find(canonicalLocation));
-    if (m_tracksByCanonicalLocation.end() != trackByCanonicalLocation) {
+            tracksByCanonicalLocation.find(canonicalLocation));
+    if (tracksByCanonicalLocation.end() != trackByCanonicalLocation) {
         if (purgedItem.ref.hasCanonicalLocation()) {
             DEBUG_ASSERT(purgedItem == *trackByCanonicalLocation);
         } else {
@@ -480,24 +595,32 @@ TrackCache::Item TrackCache::purgeInternal(
                 !purgedItem.ref.hasId() ||
                 (trackRef.getId() == purgedItem.ref.getId()));
             if (!trackRef.hasId() && purgedItem.ref.hasId()) {
-                m_tracksById.remove(purgedItem.ref.getId());
+                tracksById.remove(purgedItem.ref.getId());
             }
         }
-        m_tracksByCanonicalLocation.erase(trackByCanonicalLocation);
+        tracksByCanonicalLocation.erase(trackByCanonicalLocation);
         Stat::track(kEraseByCanonicalLocationCounter, Stat::COUNTER, kStatCounterFlags, 1);
     }
+    if (nullptr != purgedItem.plainPtr) {
+        MMutexLocker locker(&m_shardsOfTracksMutex);
+        m_shardsOfTracks.remove(purgedItem.plainPtr);
+        if (purgedItem.ref.hasId()) {
+            m_shardsOfTrackIds.remove(purgedItem.ref.getId());
+        }
+    }
     return purgedItem;
 }
 
 Track* TrackCache::evictInternal(
+        int shard,
         TrackCacheLocker* pCacheLocker,
         const TrackRef& trackRef) {
     kLogger.debug()
             << "Evicting track"
             << trackRef;
 
-    const Item purgedItem = purgeInternal(trackRef);
-    DEBUG_ASSERT(verifyConsistency());
+    const Item purgedItem = purgeInternal(shard, trackRef);
+    DEBUG_ASSERT(verifyConsistency(shard));
     if (nullptr != purgedItem.plainPtr) {
         // It can produce dangerous signal loops if the track is still
         // sending signals while being saved! All references to this
@@ -523,21 +646,83 @@ Track* TrackCache::evictInternal(
     return purgedItem.plainPtr;
 }
 
+QHash<TrackId, TrackPointer> TrackCache::lookupByIds(
+        const QList<TrackId>& trackIds) const {
+    QMap<int, QList<TrackId>> trackIdsByShard;
+    {
+        MMutexLocker locker(&m_shardsOfTracksMutex);
+        for (const auto& trackId : trackIds) {
+            const int shard = m_shardsOfTrackIds.value(trackId, -1);
+            if (shard >= 0) {
+                trackIdsByShard[shard].append(trackId);
+            }
+        }
+    }
+    QHash<TrackId, TrackPointer> tracks;
+    tracks.reserve(trackIds.size());
+    for (auto i = trackIdsByShard.constBegin(); i != trackIdsByShard.constEnd(); ++i) {
+        TrackCacheLocker cacheLocker;
+        cacheLocker.lockShard(i.key());
+        for (const auto& trackId : i.value()) {
+            // Tracks that have been evicted or cached again in another
+            // shard meanwhile are not found
+            const TrackPointer pTrack(lookupInternal(i.key(), trackId));
+            if (pTrack) {
+                tracks.insert(trackId, pTrack);
+            }
+        }
+    }
+    return tracks;
+}
+
 QList<TrackPointer> TrackCache::lookupAll() const {
     QList<TrackPointer> allTracks;
-    TrackCacheLocker cacheLocker;
-    QList<Item> cacheItems(
-            m_tracksByCanonicalLocation.values());
-    allTracks.reserve(cacheItems.size());
-    for (Item cacheItem : cacheItems) {
-        TrackPointer pTrack(cacheItem.weakPtr);
-        if (pTrack) {
-            allTracks.append(pTrack);
+    // One shard after the other
+    for (int shard = 0; shard < kShardCount; ++shard) {
+        TrackCacheLocker cacheLocker;
+        cacheLocker.lockShard(shard);
+        QList<Item> cacheItems(
+                m_shards[shard].tracksByCanonicalLocation.values());
+        allTracks.reserve(allTracks.size() + cacheItems.size());
+        for (Item cacheItem : cacheItems) {
+            TrackPointer pTrack(cacheItem.weakPtr);
+            if (pTrack) {
+                allTracks.append(pTrack);
+            }
         }
     }
     return allTracks;
 }
 
+void TrackCache::updateTrackIds(
+        const QList<QPair<TrackPointer, TrackId>>& tracksWithIds) {
+    for (const auto& trackWithId : tracksWithIds) {
+        const TrackPointer& pTrack = trackWithId.first;
+        DEBUG_ASSERT(pTrack);
+        if (pTrack->getId() == trackWithId.second) {
+            continue;
+        }
+        const int shard = shardOfTrack(pTrack.get());
+        VERIFY_OR_DEBUG_ASSERT(shard >= 0) {
+            kLogger.warning()
+                    << "Cannot change id of uncached track"
+                    << pTrack->getLocation() << "to" << trackWithId.second;
+            continue;
+        }
+        TrackCacheLocker cacheLocker;
+        cacheLocker.lockShard(shard);
+        const TrackRef trackRef(createTrackRef(*pTrack));
+        VERIFY_OR_DEBUG_ASSERT(!trackRef.hasId()) {
+            kLogger.warning()
+                    << "Cannot change id of cached track"
+                    << trackRef << "to" << trackWithId.second;
+            continue;
+        }
+        updateTrackIdInternal(shard, pTrack, trackRef, trackWithId.second);
+        pTrack->initId(trackWithId.second);
+    }
+}
+
 void TrackCache::evictAll() {
     QList<TrackPointer> allTracks(lookupAll());
     for (const TrackPointer& pTrack : allTracks) {
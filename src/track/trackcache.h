@@ -6,9 +6,12 @@
 #include <QHash>
 #include <QList>
 #include <QMap>
+#include <QMutex>
+#include <QPair>
 
 #include "track/track.h"
 #include "track/trackref.h"
+#include "util/mutex.h"
 
 
 enum class TrackCacheLookupResult {
@@ -44,7 +47,7 @@ public:
 private:
     friend class TrackCache;
 
-    void lockCache();
+    void lockShard(int shard);
 
 protected:
     TrackCacheLocker();
@@ -56,7 +59,9 @@ protected:
 
     TrackCacheLocker& operator=(TrackCacheLocker&&);
 
-    QMutex* m_pCacheMutex;
+    // The mutex of the locked shard of the cache
+    MMutex* m_pCacheMutex;
+    int m_shard;
 
     TrackCacheLookupResult m_lookupResult;
 
@@ -121,6 +126,17 @@ protected:
     virtual ~TrackCacheEvictor() {}
 };
 
+// The cache is divided into shards that are locked independently. A track
+// stays in the shard of the canonical location (or the id if it has none)
+// it has been cached with, and a TrackCacheLocker only locks the shard of
+// its track. Threads that resolve or evict different tracks rarely wait for
+// each other, e.g. the GUI looking up tracks while the scanner imports the
+// metadata of new ones. The statistics count how often a shard was locked
+// by another thread.
+//
+// While a shard is locked other tracks should neither be resolved nor
+// released: a thread that waits for a second shard might deadlock with
+// another thread that is doing the same the other way round.
 class TrackCache {
 public:
     static void createInstance(TrackCacheEvictor* pEvictor);
@@ -134,17 +150,30 @@ public:
 
     // Lookup an existing Track object in the cache.
     //
-    // NOTE: The TrackCache is locked during the lifetime of the
-    // result object. It should be destroyed ASAP to reduce lock
-    // contention!
+    // NOTE: The shard of the track is locked during the lifetime of the
+    // result object if it has been found. It should be destroyed ASAP to
+    // reduce lock contention!
     TrackCacheLocker lookupById(
             const TrackId& trackId) const;
 
+    // Lookup the cached tracks of many ids at once. Each shard is only
+    // locked once and not during the lifetime of the result. Ids that
+    // are not cached are omitted.
+    QHash<TrackId, TrackPointer> lookupByIds(
+            const QList<TrackId>& trackIds) const;
+
     QList<TrackPointer> lookupAll() const;
 
+    // Returns true if a track object exists, e.g. because the track is
+    // loaded into a deck. Unlike lookupById() this neither locks a shard nor
+    // creates a reference that might evict the track when released.
+    bool isCached(const TrackId& trackId) const {
+        return shardOfTrackId(trackId) >= 0;
+    }
+
     // Lookup an existing or create a new Track object.
     //
-    // NOTE: The TrackCache is locked during the lifetime of the
+    // NOTE: The shard of the track is locked during the lifetime of the
     // result object. It should be destroyed ASAP to reduce lock
     // contention!
     TrackCacheResolver resolve(
@@ -157,6 +186,14 @@ public:
             const QFileInfo& fileInfo,
             const SecurityTokenPointer& pSecurityToken = SecurityTokenPointer());
 
+    // Updates the ids of resolved tracks without an id after they have
+    // been added to the database. Other than with
+    // TrackCacheResolver::updateTrackId() the cache does not need to stay
+    // locked since the tracks have been resolved, which allows to update
+    // many tracks at once.
+    void updateTrackIds(
+            const QList<QPair<TrackPointer, TrackId>>& tracksWithIds);
+
     void evictAll();
 
 private:
@@ -202,46 +239,76 @@ private:
         Track* plainPtr;
     };
 
+    typedef QHash<TrackId, Item> TracksById;
+    typedef QMap<QString, Item> TracksByCanonicalLocation;
+
+    class Shard final {
+    public:
+        Shard()
+            : mutex("TrackCache shard", QMutex::Recursive) {
+        }
+
+        mutable MMutex mutex;
+        TracksById tracksById;
+        TracksByCanonicalLocation tracksByCanonicalLocation;
+    };
+
+    static const int kShardCount = 16;
+
     explicit TrackCache(TrackCacheEvictor* pEvictor);
     ~TrackCache();
 
     // This function should only be called DEBUG_ASSERT statements
-    // to verify the class invariants during development.
-    bool verifyConsistency() const;
+    // to verify the class invariants during development. The shard
+    // must be locked.
+    bool verifyConsistency(int shard) const;
+
+    static int shardForTrackRef(const TrackRef& trackRef);
+    // Returns -1 if the track is not cached
+    int shardOfTrackId(const TrackId& trackId) const;
+    int shardOfTrack(const Track* pTrack) const;
 
     TrackPointer lookupInternal(
+            int shard,
             const TrackId& trackId) const;
-    TrackPointer lookupInternal(
-            const TrackRef& trackRef) const;
 
-    bool resolveInternal(
+    // Resolves a track by id in the locked shard of the resolver
+    bool resolveByIdInternal(
             TrackCacheResolver* pCacheResolver,
-            TrackRef* pTrackRef,
-            const TrackId& trackId,
-            const QFileInfo& fileInfo);
+            const TrackId& trackId);
+    // Resolves a track by canonical location in the locked shard of the
+    // resolver
+    bool resolveByCanonicalLocationInternal(
+            TrackCacheResolver* pCacheResolver,
+            const TrackRef& trackRef);
 
     TrackRef updateTrackIdInternal(
+            int shard,
             const TrackPointer& pTrack,
             const TrackRef& trackRef,
             TrackId trackId);
 
     Item purgeInternal(
+            int shard,
             const TrackRef& trackRef);
 
     void evict(
             Track* pTrack);
     Track* evictInternal(
+            int shard,
             TrackCacheLocker* /*nullable*/ pCacheLocker,
             const TrackRef& trackRef);
 
     TrackCacheEvictor* m_pEvictor;
 
-    mutable QMutex m_mutex;
+    Shard m_shards[kShardCount];
 
-    typedef QHash<TrackId, Item> TracksById;
-    TracksById m_tracksById;
-    typedef QMap<QString, Item> TracksByCanonicalLocation;
-    TracksByCanonicalLocation m_tracksByCanonicalLocation;
+    // The shards of the cached tracks by id and by object, for the lookups
+    // by id and the eviction. The mutex is only locked for accessing them
+    // and never while waiting for a shard.
+    mutable MMutex m_shardsOfTracksMutex;
+    QHash<TrackId, int> m_shardsOfTrackIds;
+    QHash<const Track*, int> m_shardsOfTracks;
 };
 
 
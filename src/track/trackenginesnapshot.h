@@ -0,0 +1,46 @@
+#ifndef TRACK_TRACKENGINESNAPSHOT_H
+#define TRACK_TRACKENGINESNAPSHOT_H
+
+#include <memory>
+
+#include <QtGlobal>
+
+#include "proto/keys.pb.h"
+#include "track/beats.h"
+#include "track/cueindex.h"
+#include "track/replaygain.h"
+
+// An immutable copy of the properties of a Track that the engine reads while
+// the track is playing. Track publishes a new snapshot whenever one of its
+// properties has changed, e.g. when the analyzer has set a new beat grid or a
+// cue has been edited, and the engine picks it up once per callback without
+// locking the track, see Track::getEngineSnapshot().
+struct TrackEngineSnapshot {
+    TrackEngineSnapshot()
+            : version(0),
+              sampleRate(0),
+              duration(0.0),
+              bpm(0.0),
+              cuePoint(0.0),
+              key(mixxx::track::io::key::INVALID) {
+    }
+
+    // Increases with every snapshot of the same track
+    quint64 version;
+    int sampleRate;
+    // In seconds
+    double duration;
+    double bpm;
+    BeatsPointer pBeats;
+    double cuePoint;
+    // The positions of the cues are copied into the index. The cues
+    // themselves lock when they are accessed, so the engine thread should
+    // only compare them.
+    CueIndex cueIndex;
+    mixxx::ReplayGain replayGain;
+    mixxx::track::io::key::ChromaticKey key;
+};
+
+typedef std::shared_ptr<const TrackEngineSnapshot> TrackEngineSnapshotPointer;
+
+#endif // TRACK_TRACKENGINESNAPSHOT_H
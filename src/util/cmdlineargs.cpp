@@ -10,10 +10,19 @@ CmdlineArgs::CmdlineArgs()
     : m_startInFullscreen(false), // Initialize vars
       m_midiDebug(false),
       m_developer(false),
+      m_profileLocks(false),
+      m_realtimeSafety(false),
+      m_profileSql(false),
+      m_slowSqlMillis(0),
+      m_profileEventLoop(false),
+      m_slowEventMillis(0),
       m_safeMode(false),
       m_debugAssertBreak(false),
       m_settingsPathSet(false),
       m_logLevel(mixxx::LogLevel::Default),
+      m_renderDuration(0.0),
+      m_renderAutoDJ(false),
+      m_startupBenchmarkTracks(0),
 // We are not ready to switch to XDG folders under Linux, so keeping $HOME/.mixxx as preferences folder. see lp:1463273
 #ifdef __LINUX__
     m_settingsPath(QDir::homePath().append("/").append(SETTINGS_PATH)) {
@@ -55,6 +64,42 @@ bool CmdlineArgs::Parse(int &argc, char **argv) {
         } else if (argv[i] == QString("--timelinePath") && i+1 < argc) {
             m_timelinePath = QString::fromLocal8Bit(argv[i+1]);
             i++;
+        } else if (argv[i] == QString("--metricsPath") && i+1 < argc) {
+            m_metricsPath = QString::fromLocal8Bit(argv[i+1]);
+            i++;
+        } else if (argv[i] == QString("--flightRecorderPath") && i+1 < argc) {
+            m_flightRecorderPath = QString::fromLocal8Bit(argv[i+1]);
+            i++;
+        } else if (argv[i] == QString("--render") && i+1 < argc) {
+            m_renderPath = QString::fromLocal8Bit(argv[i+1]);
+            i++;
+        } else if (argv[i] == QString("--renderDuration") && i+1 < argc) {
+            m_renderDuration = QString::fromLocal8Bit(argv[i+1]).toDouble();
+            i++;
+        } else if (argv[i] == QString("--renderAutoDJ")) {
+            m_renderAutoDJ = true;
+        } else if (argv[i] == QString("--analyze")) {
+            m_analyzeMode = "unanalyzed";
+            if (i+1 < argc && (argv[i+1] == QString("all") ||
+                    argv[i+1] == QString("unanalyzed"))) {
+                m_analyzeMode = argv[i+1];
+                i++;
+            }
+        } else if (argv[i] == QString("--analyzePath") && i+1 < argc) {
+            m_analyzePath = QString::fromLocal8Bit(argv[i+1]);
+            if (m_analyzeMode.isEmpty()) {
+                m_analyzeMode = "unanalyzed";
+            }
+            i++;
+        } else if (argv[i] == QString("--skin") && i+1 < argc) {
+            m_skin = QString::fromLocal8Bit(argv[i+1]);
+            i++;
+        } else if (argv[i] == QString("--startupBenchmark") && i+1 < argc) {
+            m_startupBenchmarkPath = QString::fromLocal8Bit(argv[i+1]);
+            i++;
+        } else if (argv[i] == QString("--startupBenchmarkTracks") && i+1 < argc) {
+            m_startupBenchmarkTracks = qMax(0, QString(argv[i+1]).toInt());
+            i++;
         } else if (argv[i] == QString("--logLevel") && i+1 < argc) {
             logLevelSet = true;
             auto level = QLatin1String(argv[i+1]);
@@ -76,6 +121,26 @@ warnings and errors to the console unless this is set properly.\n", stdout);
         } else if (QString::fromLocal8Bit(argv[i]).contains("--midiDebug", Qt::CaseInsensitive) ||
                    QString::fromLocal8Bit(argv[i]).contains("--controllerDebug", Qt::CaseInsensitive)) {
             m_midiDebug = true;
+        } else if (argv[i] == QString("--profileLocks")) {
+            m_profileLocks = true;
+        } else if (argv[i] == QString("--realtimeSafety")) {
+            m_realtimeSafety = true;
+        } else if (argv[i] == QString("--profileSql")) {
+            m_profileSql = true;
+            bool ok = false;
+            const int millis = i+1 < argc ? QString(argv[i+1]).toInt(&ok) : 0;
+            if (ok && millis > 0) {
+                m_slowSqlMillis = millis;
+                i++;
+            }
+        } else if (argv[i] == QString("--profileEventLoop")) {
+            m_profileEventLoop = true;
+            bool ok = false;
+            const int millis = i+1 < argc ? QString(argv[i+1]).toInt(&ok) : 0;
+            if (ok && millis > 0) {
+                m_slowEventMillis = millis;
+                i++;
+            }
         } else if (QString::fromLocal8Bit(argv[i]).contains("--developer", Qt::CaseInsensitive)) {
             m_developer = true;
         } else if (QString::fromLocal8Bit(argv[i]).contains("--safeMode", Qt::CaseInsensitive)) {
@@ -133,6 +198,43 @@ void CmdlineArgs::printUsage() {
 --developer             Enables developer-mode. Includes extra log info,\n\
                         stats on performance, and a Developer tools menu.\n\
 \n\
+--timelinePath FILE     Records the startup phases and the traced events\n\
+                        of all threads and writes them into FILE on exit.\n\
+                        A FILE ending with .json is written in the Chrome\n\
+                        trace event format for chrome://tracing and\n\
+                        Perfetto, any other FILE as CSV.\n\
+\n\
+--metricsPath FILE      Writes the stats of all threads into FILE every\n\
+                        few seconds in the OpenMetrics text format, e.g.\n\
+                        for the textfile collector of the Prometheus\n\
+                        node exporter.\n\
+\n\
+--profileLocks          Measures the wait and hold times of the named\n\
+                        locks, e.g. of the tracks and the controls, and\n\
+                        reports them as stats for --developer,\n\
+                        --timelinePath or --metricsPath.\n\
+\n\
+--realtimeSafety        Logs the allocations, locks and sleeps on the\n\
+                        audio callback thread with their stack traces.\n\
+                        Allocations and system calls are only seen by\n\
+                        builds with rtsafety=1.\n\
+\n\
+--profileSql [MS]       Measures the execution times and the rows of the\n\
+                        SQL statements of the library and reports them\n\
+                        as stats for --developer or --metricsPath.\n\
+                        Statements that take longer than MS (default 20)\n\
+                        milliseconds are logged with their query plan.\n\
+\n\
+--profileEventLoop [MS] Measures the latency of the GUI event loop and\n\
+                        the event handlers that take longer than MS\n\
+                        (default 20) milliseconds, and reports them as\n\
+                        stats for --developer or --metricsPath.\n\
+\n\
+--flightRecorderPath DIR Keeps the last seconds of the traced events of\n\
+                        all threads in memory and writes them into DIR\n\
+                        after each xrun or when requested by the control\n\
+                        [Master],flight_recorder_dump.\n\
+\n\
 --safeMode              Enables safe-mode. Disables OpenGL waveforms,\n\
                         and spinning vinyl widgets. Try this option if\n\
                         Mixxx is crashing on startup.\n\
@@ -142,6 +244,39 @@ void CmdlineArgs::printUsage() {
 \n\
 -f, --fullScreen        Starts Mixxx in full-screen mode\n\
 \n\
+--render FILE           Renders the mix offline into FILE as fast as\n\
+                        possible instead of playing it on the sound\n\
+                        card. The format is chosen by the extension of\n\
+                        FILE. All decks with a track are started, and\n\
+                        the rendering ends when no deck plays anymore.\n\
+\n\
+--renderAutoDJ          Enables Auto DJ instead of starting the decks\n\
+                        when rendering, to render the Auto DJ queue.\n\
+\n\
+--renderDuration SECS   Stops rendering after SECS seconds.\n\
+\n\
+--analyze [MODE]        Analyzes the library without opening a window\n\
+                        and quits when done. MODE is 'unanalyzed'\n\
+                        (default) for the tracks without beats, key or\n\
+                        waveform, or 'all' to check every track and\n\
+                        redo the analyses that are outdated.\n\
+\n\
+--analyzePath PATH      Only analyzes the tracks below PATH. Implies\n\
+                        --analyze.\n\
+\n\
+--skin NAME             Starts with the skin NAME instead of the\n\
+                        configured skin.\n\
+\n\
+--startupBenchmark FILE Measures the phases of the startup and the\n\
+                        resident memory after the startup, after loading\n\
+                        the given music files into 4 decks and after a\n\
+                        library scan, writes the results into FILE as\n\
+                        JSON ('-' for the standard output) and quits.\n\
+                        Use a separate --settingsPath.\n\
+\n\
+--startupBenchmarkTracks N Adds N synthetic tracks to an empty library\n\
+                        before the library is set up.\n\
+\n\
 --logLevel LEVEL        Sets the verbosity of command line logging\n\
                         critical - Critical/Fatal only\n\
                         warning  - Above + Warnings\n\
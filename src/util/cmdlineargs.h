@@ -36,6 +36,32 @@ class CmdlineArgs final {
     const QString& getResourcePath() const { return m_resourcePath; }
     const QString& getPluginPath() const { return m_pluginPath; }
     const QString& getTimelinePath() const { return m_timelinePath; }
+    bool getMetricsEnabled() const { return !m_metricsPath.isEmpty(); }
+    const QString& getMetricsPath() const { return m_metricsPath; }
+    bool getProfileLocks() const { return m_profileLocks; }
+    bool getRealtimeSafety() const { return m_realtimeSafety; }
+    bool getProfileSql() const { return m_profileSql; }
+    // Slower statements are logged with their query plan, 0 for the default
+    int getSlowSqlMillis() const { return m_slowSqlMillis; }
+    bool getProfileEventLoop() const { return m_profileEventLoop; }
+    // Slower event handlers are logged, 0 for the default
+    int getSlowEventMillis() const { return m_slowEventMillis; }
+    bool getFlightRecorderEnabled() const { return !m_flightRecorderPath.isEmpty(); }
+    const QString& getFlightRecorderPath() const { return m_flightRecorderPath; }
+    bool getRenderEnabled() const { return !m_renderPath.isEmpty(); }
+    const QString& getRenderPath() const { return m_renderPath; }
+    double getRenderDuration() const { return m_renderDuration; }
+    bool getRenderAutoDJ() const { return m_renderAutoDJ; }
+    bool getAnalyzeEnabled() const { return !m_analyzeMode.isEmpty(); }
+    // "all" or "unanalyzed"
+    const QString& getAnalyzeMode() const { return m_analyzeMode; }
+    const QString& getAnalyzePath() const { return m_analyzePath; }
+    // Overrides the configured skin, empty if not set
+    const QString& getSkin() const { return m_skin; }
+    bool getStartupBenchmarkEnabled() const { return !m_startupBenchmarkPath.isEmpty(); }
+    const QString& getStartupBenchmarkPath() const { return m_startupBenchmarkPath; }
+    // The number of synthetic tracks in the library, 0 for none
+    int getStartupBenchmarkTracks() const { return m_startupBenchmarkTracks; }
 
   private:
     CmdlineArgs();
@@ -44,15 +70,31 @@ class CmdlineArgs final {
     bool m_startInFullscreen;       // Start in fullscreen mode
     bool m_midiDebug;
     bool m_developer; // Developer Mode
+    bool m_profileLocks;
+    bool m_realtimeSafety;
+    bool m_profileSql;
+    int m_slowSqlMillis;
+    bool m_profileEventLoop;
+    int m_slowEventMillis;
     bool m_safeMode;
     bool m_debugAssertBreak;
     bool m_settingsPathSet; // has --settingsPath been set on command line ?
     mixxx::LogLevel m_logLevel; // Level of logging message verbosity
+    double m_renderDuration; // Seconds to render, 0 until nothing plays
+    bool m_renderAutoDJ;
+    int m_startupBenchmarkTracks;
     QString m_locale;
     QString m_settingsPath;
     QString m_resourcePath;
     QString m_pluginPath;
     QString m_timelinePath;
+    QString m_metricsPath;
+    QString m_flightRecorderPath;
+    QString m_renderPath; // Render offline into this file
+    QString m_analyzeMode; // Analyze the library without a GUI
+    QString m_analyzePath; // Only analyze tracks below this path
+    QString m_skin;
+    QString m_startupBenchmarkPath; // Write the startup benchmark into this file
 };
 
 #endif /* CMDLINEARGS_H */
@@ -0,0 +1,128 @@
+#include "util/db/cachedsqlquery.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlError>
+
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SqlStatementCache");
+
+struct Entry {
+    Entry() : lastUse(0) {}
+    QSqlQuery query;
+    // Expired while the statement is not lent
+    std::weak_ptr<void> pToken;
+    quint64 lastUse;
+};
+
+struct ConnectionStatements {
+    ConnectionStatements() : useCount(0) {}
+    QHash<QString, Entry> entries;
+    quint64 useCount;
+};
+
+// The connections are used by different threads, but each of them only by
+// one thread at a time
+QMutex s_mutex;
+QHash<QString, ConnectionStatements> s_connections;
+
+QSqlQuery prepareQuery(QSqlDatabase database, const QString& statement) {
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.prepare(statement)) {
+        kLogger.warning()
+                << "Failed to prepare"
+                << statement
+                << ":"
+                << query.lastError();
+    }
+    return query;
+}
+
+// Makes room for another statement unless all statements are lent
+bool evictLeastRecentlyUsed(ConnectionStatements* pStatements) {
+    auto leastRecentlyUsed = pStatements->entries.end();
+    for (auto it = pStatements->entries.begin();
+            it != pStatements->entries.end(); ++it) {
+        if (it->pToken.expired() &&
+                (leastRecentlyUsed == pStatements->entries.end() ||
+                        it->lastUse < leastRecentlyUsed->lastUse)) {
+            leastRecentlyUsed = it;
+        }
+    }
+    if (leastRecentlyUsed == pStatements->entries.end()) {
+        return false;
+    }
+    pStatements->entries.erase(leastRecentlyUsed);
+    return true;
+}
+
+std::shared_ptr<void> lendQuery(const QSqlQuery& query) {
+    // The deleter keeps a copy that shares the prepared statement
+    return std::shared_ptr<void>(nullptr, [query](void*) mutable {
+        query.finish();
+    });
+}
+
+} // anonymous namespace
+
+// static
+const int SqlStatementCache::kMaxStatements = 128;
+
+// static
+SqlStatementCache::Lease SqlStatementCache::acquire(
+        QSqlDatabase database, const QString& statement) {
+    Lease lease;
+    QMutexLocker locker(&s_mutex);
+    ConnectionStatements& statements = s_connections[database.connectionName()];
+    auto it = statements.entries.find(statement);
+    if (it == statements.entries.end()) {
+        if (statements.entries.size() >= kMaxStatements &&
+                !evictLeastRecentlyUsed(&statements)) {
+            locker.unlock();
+            lease.query = prepareQuery(database, statement);
+            return lease;
+        }
+        QSqlQuery query = prepareQuery(database, statement);
+        if (query.lastError().isValid()) {
+            // Not cached, the error is reported with every attempt
+            lease.query = query;
+            return lease;
+        }
+        it = statements.entries.insert(statement, Entry());
+        it->query = query;
+    } else if (!it->pToken.expired()) {
+        // Still lent
+        locker.unlock();
+        lease.query = prepareQuery(database, statement);
+        return lease;
+    } else if (it->query.lastError().isValid()) {
+        // The error of the last execution would be reported to the next
+        // borrower until the statement is executed again
+        it->query = prepareQuery(database, statement);
+        if (it->query.lastError().isValid()) {
+            lease.query = it->query;
+            statements.entries.erase(it);
+            return lease;
+        }
+    } else {
+        for (int i = 0; i < it->query.boundValues().size(); ++i) {
+            it->query.bindValue(i, QVariant());
+        }
+    }
+    it->lastUse = ++statements.useCount;
+    lease.query = it->query;
+    lease.pToken = lendQuery(it->query);
+    it->pToken = lease.pToken;
+    return lease;
+}
+
+// static
+void SqlStatementCache::clear(const QSqlDatabase& database) {
+    QMutexLocker locker(&s_mutex);
+    s_connections.remove(database.connectionName());
+}
@@ -0,0 +1,72 @@
+#ifndef MIXXX_CACHEDSQLQUERY_H
+#define MIXXX_CACHEDSQLQUERY_H
+
+#include <memory>
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+// Keeps the prepared statements of each database connection, so that a
+// statement that is executed over and over, e.g. for every track that is
+// saved, is parsed and planned by SQLite only once.
+//
+// A cached query is handed out as a copy that shares the prepared statement.
+// It is lent until the last copy of the query has been destroyed: then the
+// statement is finished, i.e. reset by SQLite, which ends its read
+// transaction. A statement that is still lent, e.g. to an enclosing loop of
+// the caller, is prepared again without the cache.
+//
+// All queries are forward-only. Only statements without variable parts
+// should be cached, formatted lists of values or ids would crowd out the
+// other statements.
+class SqlStatementCache {
+  public:
+    // The number of statements per connection
+    static const int kMaxStatements;
+
+    struct Lease {
+        QSqlQuery query;
+        // The statement is finished when the last copy is destroyed
+        std::shared_ptr<void> pToken;
+    };
+
+    // Returns a forward-only query of the connection that is prepared with
+    // the statement, or a query with an error if the statement is invalid.
+    // The values that have been bound by the last borrower are reset to
+    // NULL, like those of a newly prepared query.
+    static Lease acquire(QSqlDatabase database, const QString& statement);
+
+    // Drops the statements of a connection before it is closed
+    static void clear(const QSqlDatabase& database);
+
+  private:
+    SqlStatementCache() = delete;
+};
+
+// A QSqlQuery that is prepared from the SqlStatementCache of its connection.
+// Replaces the prepare() of a new query:
+//
+//     CachedSqlQuery query(m_database,
+//             "UPDATE library SET played=:played WHERE id=:id");
+//     query.bindValue(":played", played);
+//     ...
+//
+// Please note that preparing another statement with the same object works,
+// but that statement is not cached.
+class CachedSqlQuery : public QSqlQuery {
+  public:
+    CachedSqlQuery(QSqlDatabase database, const QString& statement)
+            : CachedSqlQuery(SqlStatementCache::acquire(database, statement)) {
+    }
+
+  private:
+    explicit CachedSqlQuery(const SqlStatementCache::Lease& lease)
+            : QSqlQuery(lease.query),
+              m_pToken(lease.pToken) {
+    }
+
+    std::shared_ptr<void> m_pToken;
+};
+
+#endif // MIXXX_CACHEDSQLQUERY_H
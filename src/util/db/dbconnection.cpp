@@ -1,4 +1,5 @@
 #include <QSqlDriver>
+#include <QSqlQuery>
 #include <QSqlError>
 
 #ifdef __SQLITE3__
@@ -7,9 +8,11 @@
 
 #include "util/db/dbconnection.h"
 
+#include "util/db/cachedsqlquery.h"
 #include "util/db/sqllikewildcards.h"
 #include "util/memory.h"
 #include "util/logger.h"
+#include "util/performancetimer.h"
 #include "util/assert.h"
 
 
@@ -40,9 +43,15 @@ QSqlDatabase createDatabase(
 
 QSqlDatabase cloneDatabase(
         const QSqlDatabase& database,
-        const QString connectionName) {
+        const QString connectionName,
+        DbConnection::Mode mode) {
     DEBUG_ASSERT(!database.isOpen());
-    return QSqlDatabase::cloneDatabase(database, connectionName);
+    QSqlDatabase clone = QSqlDatabase::cloneDatabase(database, connectionName);
+    if (mode == DbConnection::Mode::ReadOnly &&
+            clone.driverName() == "QSQLITE") {
+        clone.setConnectOptions("QSQLITE_OPEN_READONLY");
+    }
+    return clone;
 }
 
 void removeDatabase(
@@ -293,18 +302,57 @@ bool initDatabase(QSqlDatabase database) {
     return true;
 }
 
+// The log is not deleted when the last connection is closed. Its size is
+// limited after each checkpoint.
+const qint64 kJournalSizeLimit = 64 * 1024 * 1024;
+
+bool initJournal(QSqlDatabase database, DbConnection::Mode mode) {
+    DEBUG_ASSERT(database.isOpen());
+    if (database.driverName() != "QSQLITE" ||
+            mode == DbConnection::Mode::ReadOnly) {
+        // The journal mode is persistent and read-only connections
+        // cannot change it
+        return true;
+    }
+    QSqlQuery query(database);
+    if (!query.exec("PRAGMA journal_mode = WAL") || !query.next()) {
+        kLogger.warning()
+                << "Failed to enable the write-ahead log"
+                << query.lastError();
+        return false; // abort
+    }
+    // The journal mode of in-memory databases cannot be changed
+    const QString journalMode = query.value(0).toString();
+    if (journalMode.compare("wal", Qt::CaseInsensitive) != 0) {
+        kLogger.info()
+                << "Using journal mode"
+                << journalMode
+                << "instead of the write-ahead log";
+    }
+    if (!query.exec(QString("PRAGMA journal_size_limit = %1").arg(
+            kJournalSizeLimit))) {
+        kLogger.warning()
+                << "Failed to limit the size of the journal"
+                << query.lastError();
+    }
+    return true;
+}
+
 } // anonymous namespace
 
 DbConnection::DbConnection(
         const Params& params,
         const QString& connectionName)
-    : m_sqlDatabase(createDatabase(params, connectionName)) {
+    : m_sqlDatabase(createDatabase(params, connectionName)),
+      m_mode(Mode::ReadWrite) {
 }
 
 DbConnection::DbConnection(
         const DbConnection& prototype,
-        const QString& connectionName)
-    : m_sqlDatabase(cloneDatabase(prototype.m_sqlDatabase, connectionName)) {
+        const QString& connectionName,
+        Mode mode)
+    : m_sqlDatabase(cloneDatabase(prototype.m_sqlDatabase, connectionName, mode)),
+      m_mode(mode) {
 }
 
 DbConnection::~DbConnection() {
@@ -330,6 +378,10 @@ bool DbConnection::open() {
         m_sqlDatabase.close();
         return false; // abort
     }
+    if (!initJournal(m_sqlDatabase, m_mode)) {
+        m_sqlDatabase.close();
+        return false; // abort
+    }
     return true;
 }
 
@@ -346,10 +398,59 @@ void DbConnection::close() {
         kLogger.debug()
             << "Closing database connection:"
             << *this;
+        SqlStatementCache::clear(m_sqlDatabase);
         m_sqlDatabase.close();
     }
 }
 
+//static
+bool DbConnection::checkpointWriteAheadLog(QSqlDatabase database) {
+    if (database.driverName() != "QSQLITE") {
+        return true;
+    }
+    QSqlQuery query(database);
+    // Returns whether the checkpoint was blocked, the number of pages in
+    // the log and the number of pages that have been copied
+    if (!query.exec("PRAGMA wal_checkpoint(TRUNCATE)") || !query.next()) {
+        kLogger.warning()
+                << "Failed to checkpoint the write-ahead log"
+                << query.lastError();
+        return false;
+    }
+    if (query.value(0).toInt() != 0) {
+        kLogger.info()
+                << "Checkpoint of the write-ahead log is blocked by other connections";
+        return false;
+    }
+    kLogger.debug()
+            << "Copied"
+            << query.value(2).toInt()
+            << "pages from the write-ahead log";
+    return true;
+}
+
+//static
+bool DbConnection::optimize(QSqlDatabase database) {
+    if (database.driverName() != "QSQLITE") {
+        return true;
+    }
+    PerformanceTimer timer;
+    timer.start();
+    QSqlQuery query(database);
+    // Analyzes only the tables whose statistics are outdated or missing.
+    // SQLite before 3.18 ignores the unknown pragma.
+    if (!query.exec("PRAGMA optimize")) {
+        kLogger.warning()
+                << "Failed to optimize the database"
+                << query.lastError();
+        return false;
+    }
+    kLogger.debug()
+            << "Optimized the database in"
+            << timer.elapsed().debugMillisWithUnit();
+    return true;
+}
+
 //static
 QString DbConnection::collateLexicographically(const QString& orderByQuery) {
 #ifdef __SQLITE3__
@@ -372,6 +473,12 @@ int DbConnection::likeCompareLatinLow(
             esc);
 }
 
+//static
+QString DbConnection::toLatinLow(QString string) {
+    makeLatinLow(string.data(), string.length());
+    return string;
+}
+
 QDebug operator<<(QDebug debug, const DbConnection& connection) {
     return debug
             << connection.name()
@@ -22,6 +22,10 @@ class DbConnection final {
         QString* string,
         QChar esc);
 
+    // Folds the string in the same way as the LIKE operator does, i.e.
+    // into lower case without diacritics
+    static QString toLatinLow(QString string);
+
     struct Params {
         QString type;
         QString hostName;
@@ -30,13 +34,32 @@ class DbConnection final {
         QString password;
     };
 
+    // The database is written in write-ahead log mode (SQLite3), i.e.
+    // readers neither block nor are blocked by the single writer. Read-only
+    // connections are meant for threads that only query the database.
+    enum class Mode {
+        ReadWrite,
+        ReadOnly,
+    };
+
+    // Copies the contents of the write-ahead log back into the database
+    // file and truncates the log (SQLite3), e.g. after large updates.
+    // Fails while other connections are reading or writing.
+    static bool checkpointWriteAheadLog(QSqlDatabase database);
+
+    // Updates the statistics of the query planner for the tables that have
+    // changed much since they have been analyzed (SQLite3), e.g. after a
+    // scan or while the library is idle
+    static bool optimize(QSqlDatabase database);
+
     // All constructors are reserved for DbConnectionPool!!
     DbConnection(
             const Params& params,
             const QString& connectionName);
     DbConnection(
             const DbConnection& prototype,
-            const QString& connectionName);
+            const QString& connectionName,
+            Mode mode = Mode::ReadWrite);
     ~DbConnection();
 
     QString name() const {
@@ -61,6 +84,7 @@ class DbConnection final {
     DbConnection(const DbConnection&&) = delete;
 
     QSqlDatabase m_sqlDatabase;
+    Mode m_mode;
 };
 
 } // namespace mixxx
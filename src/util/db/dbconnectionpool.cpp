@@ -11,7 +11,7 @@ const Logger kLogger("DbConnectionPool");
 
 } // anonymous namespace
 
-bool DbConnectionPool::createThreadLocalConnection() {
+bool DbConnectionPool::createThreadLocalConnection(DbConnection::Mode mode) {
     VERIFY_OR_DEBUG_ASSERT(!m_threadLocalConnections.hasLocalData()) {
         DEBUG_ASSERT(m_threadLocalConnections.localData());
         kLogger.critical()
@@ -25,7 +25,7 @@ bool DbConnectionPool::createThreadLocalConnection() {
             QString("%1-%2").arg(
                     m_prototypeConnection.name(),
                     QString::number(connectionIndex));
-    auto pConnection = std::make_unique<DbConnection>(m_prototypeConnection, indexedConnectionName);
+    auto pConnection = std::make_unique<DbConnection>(m_prototypeConnection, indexedConnectionName, mode);
     if (!pConnection->open()) {
         kLogger.critical()
                 << "Failed to open thread-local database connection"
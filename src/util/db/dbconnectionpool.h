@@ -36,7 +36,8 @@ class DbConnectionPool final {
     // Prefer to use DbConnectionPooler instead of the
     // following functions. Only if there is no appropriate
     // scoping possible then use these functions directly.
-    bool createThreadLocalConnection();
+    bool createThreadLocalConnection(
+            DbConnection::Mode mode = DbConnection::Mode::ReadWrite);
     void destroyThreadLocalConnection();
 
   private:
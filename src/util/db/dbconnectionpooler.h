@@ -17,10 +17,14 @@ namespace mixxx {
 // should never happen! Therefore this class should always be allocated
 // on the stack and not dynamically on the heap so that it cannot outlive
 // the corresponding thread.
+//
+// Threads that only query the database should pool a read-only
+// connection, which reads concurrently with the writing connections.
 class DbConnectionPooler final {
   public:
     explicit DbConnectionPooler(
-            DbConnectionPoolPtr pDbConnectionPool = DbConnectionPoolPtr());
+            DbConnectionPoolPtr pDbConnectionPool = DbConnectionPoolPtr(),
+            DbConnection::Mode mode = DbConnection::Mode::ReadWrite);
     DbConnectionPooler(const DbConnectionPooler&) = delete;
 #if !defined(_MSC_VER) || _MSC_VER > 1900
     DbConnectionPooler(DbConnectionPooler&&) = default;
@@ -2,6 +2,7 @@
 
 #include <QSqlRecord>
 
+#include "util/db/sqlqueryprofiler.h"
 #include "util/performancetimer.h"
 #include "util/logger.h"
 #include "util/assert.h"
@@ -34,9 +35,31 @@ bool prepareQuery(QSqlQuery& query, const QString& statement) {
 
 FwdSqlQuery::FwdSqlQuery(
         QSqlDatabase database,
-        const QString& statement)
-    : QSqlQuery(database),
-      m_prepared(prepareQuery(*this, statement)) {
+        const QString& statement,
+        Caching caching)
+    : FwdSqlQuery(
+            database,
+            statement,
+            caching,
+            (caching == Caching::Enabled)
+                    ? SqlStatementCache::acquire(database, statement)
+                    : SqlStatementCache::Lease{QSqlQuery(database), nullptr}) {
+}
+
+FwdSqlQuery::FwdSqlQuery(
+        QSqlDatabase database,
+        const QString& statement,
+        Caching caching,
+        const SqlStatementCache::Lease& lease)
+    : QSqlQuery(lease.query),
+      m_database(database),
+      m_pStatementToken(lease.pToken),
+      m_prepared((caching == Caching::Enabled)
+              ? !lease.query.lastError().isValid()
+              : prepareQuery(*this, statement)) {
+    if (m_prepared && SqlQueryProfiler::isEnabled()) {
+        m_profiledStatement = SqlQueryProfiler::normalizeStatement(statement);
+    }
     if (!m_prepared) {
         DEBUG_ASSERT(!database.isOpen() || hasError());
         kLogger.critical()
@@ -50,11 +73,17 @@ FwdSqlQuery::FwdSqlQuery(
 bool FwdSqlQuery::execPrepared() {
     DEBUG_ASSERT(isPrepared());
     DEBUG_ASSERT(!hasError());
+    const bool profiled = !m_profiledStatement.isEmpty();
     PerformanceTimer timer;
-    if (kLogger.traceEnabled()) {
+    if (kLogger.traceEnabled() || profiled) {
         timer.start();
     }
+    m_rowsRead = 0;
     if (exec()) {
+        if (profiled) {
+            SqlQueryProfiler::reportExecution(
+                    m_database, *this, m_profiledStatement, timer.elapsed());
+        }
         if (kLogger.traceEnabled()) {
             if (kLogger.traceEnabled()) {
                 kLogger.tracePerformance(
@@ -79,6 +108,19 @@ bool FwdSqlQuery::execPrepared() {
     }
 }
 
+bool FwdSqlQuery::nextProfiled() {
+    if (QSqlQuery::next()) {
+        ++m_rowsRead;
+        return true;
+    }
+    // Results that are not read until their end are not reported
+    if (m_rowsRead >= 0) {
+        SqlQueryProfiler::reportRows(m_profiledStatement, m_rowsRead);
+        m_rowsRead = -1;
+    }
+    return false;
+}
+
 DbFieldIndex FwdSqlQuery::fieldIndex(const QString& fieldName) const {
     DEBUG_ASSERT(!hasError());
     DEBUG_ASSERT(isSelect());
@@ -6,6 +6,7 @@
 #include <QSqlRecord>
 #include <QSqlError>
 
+#include "util/db/cachedsqlquery.h"
 #include "util/db/dbid.h"
 #include "util/db/dbfieldindex.h"
 
@@ -36,9 +37,18 @@ class FwdSqlQuery: protected QSqlQuery {
     friend class FwdSqlQuerySelectResult;
 
   public:
+    enum class Caching {
+        Disabled,
+        // The statement is prepared from the SqlStatementCache of the
+        // connection, intended for statements that are executed over
+        // and over without variable parts.
+        Enabled,
+    };
+
     FwdSqlQuery(
             QSqlDatabase database,
-            const QString& statement);
+            const QString& statement,
+            Caching caching = Caching::Disabled);
 
     bool isPrepared() const {
         return m_prepared;
@@ -94,7 +104,10 @@ class FwdSqlQuery: protected QSqlQuery {
     bool next() {
         DEBUG_ASSERT(!hasError());
         DEBUG_ASSERT(isSelect());
-        return QSqlQuery::next();
+        if (m_profiledStatement.isEmpty()) {
+            return QSqlQuery::next();
+        }
+        return nextProfiled();
     }
 
     DbFieldIndex fieldIndex(const QString& fieldName) const;
@@ -109,8 +122,23 @@ class FwdSqlQuery: protected QSqlQuery {
 
   private:
     FwdSqlQuery() = default; // hidden
+    FwdSqlQuery(
+            QSqlDatabase database,
+            const QString& statement,
+            Caching caching,
+            const SqlStatementCache::Lease& lease);
+
+    bool nextProfiled();
 
+    QSqlDatabase m_database;
+    // Lends the cached statement until the last copy of the query
+    // has been destroyed
+    std::shared_ptr<void> m_pStatementToken;
     bool m_prepared;
+    // The normalized statement if the query is profiled, see
+    // SqlQueryProfiler
+    QString m_profiledStatement;
+    int m_rowsRead = 0;
 };
 
 
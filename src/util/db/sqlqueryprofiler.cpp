@@ -0,0 +1,116 @@
+#include "util/db/sqlqueryprofiler.h"
+
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegExp>
+#include <QSet>
+#include <QSqlRecord>
+#include <QStringList>
+
+#include "util/logger.h"
+#include "util/stat.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SqlQueryProfiler");
+
+const Stat::ComputeFlags kDurationFlags = Stat::COUNT | Stat::SUM |
+        Stat::AVERAGE | Stat::MAX | Stat::PERCENTILES;
+const Stat::ComputeFlags kRowsFlags = Stat::COUNT | Stat::SUM |
+        Stat::AVERAGE | Stat::MAX;
+
+// The slow statements whose query plan has already been logged
+QMutex s_loggedStatementsMutex;
+QSet<QString> s_loggedStatements;
+
+} // anonymous namespace
+
+// static
+const mixxx::Duration SqlQueryProfiler::kDefaultSlowThreshold =
+        mixxx::Duration::fromMillis(20);
+
+// static
+bool SqlQueryProfiler::s_bEnabled = false;
+
+// static
+mixxx::Duration SqlQueryProfiler::s_slowThreshold =
+        SqlQueryProfiler::kDefaultSlowThreshold;
+
+// static
+void SqlQueryProfiler::setEnabled(bool enabled,
+        mixxx::Duration slowThreshold) {
+    s_slowThreshold = slowThreshold;
+    s_bEnabled = enabled;
+}
+
+// static
+QString SqlQueryProfiler::normalizeStatement(const QString& statement) {
+    // Not static, QRegExp is not thread-safe
+    const QRegExp stringLiteral("'([^']|'')*'");
+    const QRegExp numberLiteral("\\b\\d+(\\.\\d+)?\\b");
+    const QRegExp valueList("\\(\\s*\\?(\\s*,\\s*\\?)+\\s*\\)");
+    const QRegExp whitespace("\\s+");
+    QString normalized = statement;
+    normalized.replace(stringLiteral, "?");
+    normalized.replace(numberLiteral, "?");
+    // IN clauses with a different number of values
+    normalized.replace(valueList, "(?,...)");
+    normalized.replace(whitespace, " ");
+    return normalized.trimmed();
+}
+
+// static
+void SqlQueryProfiler::reportExecution(QSqlDatabase database,
+        const QSqlQuery& query, const QString& normalizedStatement,
+        mixxx::Duration duration) {
+    Stat::track(QString("SQL %1").arg(normalizedStatement),
+            Stat::DURATION_NANOSEC, kDurationFlags, duration.toIntegerNanos());
+    if (duration < s_slowThreshold) {
+        return;
+    }
+    QMutexLocker locker(&s_loggedStatementsMutex);
+    if (s_loggedStatements.contains(normalizedStatement)) {
+        return;
+    }
+    s_loggedStatements.insert(normalizedStatement);
+    locker.unlock();
+    kLogger.warning()
+            << "Slow statement took"
+            << duration.formatMillisWithUnit()
+            << ":" << query.lastQuery();
+    logQueryPlan(database, query);
+}
+
+// static
+void SqlQueryProfiler::reportRows(const QString& normalizedStatement, int rows) {
+    Stat::track(QString("SQL %1 rows").arg(normalizedStatement),
+            Stat::UNSPECIFIED, kRowsFlags, rows);
+}
+
+// static
+void SqlQueryProfiler::logQueryPlan(QSqlDatabase database,
+        const QSqlQuery& query) {
+    // Not a FwdSqlQuery, which would profile itself
+    QSqlQuery explain(database);
+    if (!explain.prepare("EXPLAIN QUERY PLAN " + query.lastQuery())) {
+        return;
+    }
+    QMapIterator<QString, QVariant> boundValue(query.boundValues());
+    while (boundValue.hasNext()) {
+        boundValue.next();
+        explain.bindValue(boundValue.key(), boundValue.value());
+    }
+    if (!explain.exec()) {
+        return;
+    }
+    // The last column, named "detail" since SQLite 3.24
+    int detailColumn = explain.record().indexOf("detail");
+    if (detailColumn < 0) {
+        detailColumn = explain.record().count() - 1;
+    }
+    while (explain.next()) {
+        kLogger.warning()
+                << "Query plan:" << explain.value(detailColumn).toString();
+    }
+}
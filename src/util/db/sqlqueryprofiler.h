@@ -0,0 +1,48 @@
+#ifndef MIXXX_SQLQUERYPROFILER_H
+#define MIXXX_SQLQUERYPROFILER_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+#include "util/duration.h"
+
+// Measures the statements that are executed by FwdSqlQuery and reports them
+// to the StatsManager, enabled by --profileSql. The reports of a statement
+// are merged regardless of its values, see normalizeStatement():
+//   "SQL <statement>"      - the execution time with its 99th percentile
+//   "SQL <statement> rows" - the rows that have been read from each result
+// The StatsManager records the calling thread of each report.
+//
+// The first execution of a statement that takes longer than the threshold
+// is logged together with its query plan, which shows the tables that are
+// scanned without an index.
+class SqlQueryProfiler {
+  public:
+    static void setEnabled(bool enabled,
+            mixxx::Duration slowThreshold = kDefaultSlowThreshold);
+    static bool isEnabled() {
+        return s_bEnabled;
+    }
+
+    static const mixxx::Duration kDefaultSlowThreshold;
+
+    // Replaces the literals and the lists of values by placeholders and
+    // the whitespace by single spaces
+    static QString normalizeStatement(const QString& statement);
+
+    // The query has just been executed
+    static void reportExecution(QSqlDatabase database,
+            const QSqlQuery& query, const QString& normalizedStatement,
+            mixxx::Duration duration);
+    // All rows of the result have been read
+    static void reportRows(const QString& normalizedStatement, int rows);
+
+  private:
+    static void logQueryPlan(QSqlDatabase database, const QSqlQuery& query);
+
+    static bool s_bEnabled;
+    static mixxx::Duration s_slowThreshold;
+};
+
+#endif // MIXXX_SQLQUERYPROFILER_H
@@ -10,7 +10,9 @@
 class Event {
   public:
     Event()
-            : m_type(Stat::UNSPECIFIED) {
+            : m_type(Stat::UNSPECIFIED),
+              m_threadId(0),
+              m_value(0.0) {
     }
 
     typedef Stat::StatType EventType;
@@ -18,6 +20,10 @@ class Event {
     QString m_tag;
     EventType m_type;
     mixxx::Duration m_time;
+    // Numbered in the order the threads have reported their first stat
+    int m_threadId;
+    // The increment of a COUNTER
+    double m_value;
 
     static bool event(const QString& tag, Event::EventType type = Stat::EVENT) {
         return Stat::track(tag, type, Stat::experimentFlags(Stat::COUNT), 0.0);
@@ -0,0 +1,118 @@
+#include "util/eventloopprofiler.h"
+
+#include <QMetaEnum>
+
+#include "util/logger.h"
+#include "util/stat.h"
+
+namespace {
+
+const mixxx::Logger kLogger("EventLoopProfiler");
+
+const int kWatchdogIntervalMillis = 10;
+
+const Stat::ComputeFlags kDurationFlags = Stat::COUNT | Stat::SUM |
+        Stat::AVERAGE | Stat::MAX | Stat::PERCENTILES;
+
+} // anonymous namespace
+
+// static
+const mixxx::Duration EventLoopProfiler::kDefaultSlowThreshold =
+        mixxx::Duration::fromMillis(20);
+
+// static
+EventLoopProfiler* EventLoopProfiler::s_pInstance = nullptr;
+// static
+qint64 EventLoopProfiler::s_nestedNanos = 0;
+// static
+int EventLoopProfiler::s_dispatchDepth = 0;
+
+// static
+void EventLoopProfiler::setEnabled(bool enabled,
+        mixxx::Duration slowThreshold) {
+    delete s_pInstance;
+    s_pInstance = nullptr;
+    if (enabled) {
+        s_pInstance = new EventLoopProfiler(slowThreshold);
+    }
+}
+
+EventLoopProfiler::EventLoopProfiler(mixxx::Duration slowThreshold)
+        : m_slowThreshold(slowThreshold) {
+    m_watchdog.setTimerType(Qt::PreciseTimer);
+    m_watchdog.setInterval(kWatchdogIntervalMillis);
+    connect(&m_watchdog, SIGNAL(timeout()),
+            this, SLOT(slotWatchdog()));
+    m_sinceWatchdog.start();
+    m_watchdog.start();
+}
+
+void EventLoopProfiler::slotWatchdog() {
+    const mixxx::Duration interval = m_sinceWatchdog.restart();
+    const qint64 latencyNanos = interval.toIntegerNanos() -
+            mixxx::Duration::fromMillis(kWatchdogIntervalMillis).toIntegerNanos();
+    Stat::track("GUI event loop latency", Stat::DURATION_NANOSEC,
+            kDurationFlags, latencyNanos > 0 ? latencyNanos : 0);
+}
+
+void EventLoopProfiler::reportSlowEvent(const QString& description,
+        mixxx::Duration duration) {
+    Stat::track(QString("GUI event %1").arg(description),
+            Stat::DURATION_NANOSEC, kDurationFlags, duration.toIntegerNanos());
+    if (m_loggedEvents.contains(description)) {
+        return;
+    }
+    m_loggedEvents.insert(description);
+    kLogger.warning()
+            << "Slow event handler took"
+            << duration.formatMillisWithUnit()
+            << ":" << description;
+}
+
+// static
+QString EventLoopProfiler::describeEvent(QEvent::Type type,
+        const char* className, const QString& objectName) {
+    QString typeName;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
+    typeName = QString::fromLatin1(
+            QMetaEnum::fromType<QEvent::Type>().valueToKey(type));
+#endif
+    if (typeName.isEmpty()) {
+        typeName = QString("Event%1").arg(static_cast<int>(type));
+    }
+    QString description = QString("%1 %2").arg(
+            typeName, QString::fromLatin1(className));
+    if (!objectName.isEmpty()) {
+        description += QString(" \"%1\"").arg(objectName);
+    }
+    return description;
+}
+
+EventLoopProfiler::ScopedDispatch::ScopedDispatch(QObject* pTarget,
+        QEvent* pEvent)
+        : m_type(pEvent->type()),
+          m_className(pTarget->metaObject()->className()),
+          m_objectName(pTarget->objectName()),
+          m_parentNestedNanos(s_nestedNanos) {
+    s_nestedNanos = 0;
+    ++s_dispatchDepth;
+    m_timer.start();
+}
+
+EventLoopProfiler::ScopedDispatch::~ScopedDispatch() {
+    const qint64 nanos = m_timer.elapsed().toIntegerNanos();
+    const qint64 ownNanos = nanos - s_nestedNanos;
+    s_nestedNanos = m_parentNestedNanos + nanos;
+    if (--s_dispatchDepth == 0) {
+        s_nestedNanos = 0;
+        Stat::track("GUI event dispatch", Stat::DURATION_NANOSEC,
+                kDurationFlags, nanos);
+    }
+    // Disabled while the event was dispatched
+    if (s_pInstance &&
+            ownNanos >= s_pInstance->m_slowThreshold.toIntegerNanos()) {
+        s_pInstance->reportSlowEvent(
+                describeEvent(m_type, m_className, m_objectName),
+                mixxx::Duration::fromNanos(ownNanos));
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef UTIL_EVENTLOOPPROFILER_H
+#define UTIL_EVENTLOOPPROFILER_H
+
+#include <QEvent>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+#include "util/duration.h"
+#include "util/performancetimer.h"
+
+// Measures how responsive the event loop of the GUI thread is and which
+// event handlers keep it busy, enabled by --profileEventLoop. It reports to
+// the StatsManager:
+//   "GUI event loop latency"  - how late a timer fires that should fire every
+//                               10 ms, with its 99th percentile
+//   "GUI event dispatch"      - the time of each event the loop dispatches
+//   "GUI event <description>" - the handlers of the events that took longer
+//                               than the threshold, e.g.
+//                               "GUI event MetaCall WTrackTableView"
+// The time of a handler excludes the nested events that it sends, e.g. to
+// the children of a widget, so a slow paint event is accounted to the
+// widget that paints slowly. The first slow occurrence of each description
+// is logged.
+//
+// MixxxApplication::notify() measures the events with a ScopedDispatch.
+class EventLoopProfiler : public QObject {
+    Q_OBJECT
+  public:
+    // Must be called from the GUI thread, which runs the watchdog timer
+    static void setEnabled(bool enabled,
+            mixxx::Duration slowThreshold = kDefaultSlowThreshold);
+    static bool isEnabled() {
+        return s_pInstance != nullptr;
+    }
+
+    static const mixxx::Duration kDefaultSlowThreshold;
+
+    // e.g. "MetaCall WTrackTableView" or "Paint WWidget \"PlayButton\""
+    static QString describeEvent(QEvent::Type type,
+            const char* className, const QString& objectName);
+
+    // Measures the dispatch of one event on the GUI thread. The target may
+    // be deleted by the handler, e.g. for QEvent::DeferredDelete.
+    class ScopedDispatch {
+      public:
+        ScopedDispatch(QObject* pTarget, QEvent* pEvent);
+        ~ScopedDispatch();
+
+      private:
+        const QEvent::Type m_type;
+        const char* const m_className;
+        const QString m_objectName;
+        const qint64 m_parentNestedNanos;
+        PerformanceTimer m_timer;
+    };
+
+  private slots:
+    void slotWatchdog();
+
+  private:
+    explicit EventLoopProfiler(mixxx::Duration slowThreshold);
+
+    void reportSlowEvent(const QString& description, mixxx::Duration duration);
+
+    static EventLoopProfiler* s_pInstance;
+    // The time of the events that the dispatched events have sent
+    static qint64 s_nestedNanos;
+    static int s_dispatchDepth;
+
+    const mixxx::Duration m_slowThreshold;
+    QTimer m_watchdog;
+    PerformanceTimer m_sinceWatchdog;
+    QSet<QString> m_loggedEvents;
+};
+
+#endif // UTIL_EVENTLOOPPROFILER_H
@@ -2,20 +2,35 @@
 #define FIFO_H
 
 #include <QtDebug>
+#include <QAtomicInt>
 #include <QMutex>
 #include <QScopedPointer>
 #include <QSharedPointer>
 
-#include "pa_ringbuffer.h"
+#include "pa_ringbuffer.h" // ring_buffer_size_t
 #include "util/class.h"
 #include "util/math.h"
 #include "util/reference.h"
 
+// A lock-free single-producer single-consumer ring buffer. The read and
+// write indices are kept on separate cache lines, so that the producer and
+// the consumer do not invalidate each other's cache line with every access.
+// All functions transfer as many items as possible with at most two
+// contiguous copies. DataType must be trivially copyable.
+//
+// The index arithmetic follows the PortAudio ring buffer (pa_ringbuffer.c)
+// that has been used before: The indices run modulo twice the size to tell
+// a full from an empty buffer.
 template <class DataType>
 class FIFO {
   public:
     explicit FIFO(int size)
-            : m_data(NULL) {
+            : m_data(nullptr),
+              m_size(0),
+              m_smallMask(0),
+              m_bigMask(0),
+              m_writeIndex(0),
+              m_readIndex(0) {
         size = roundUpToPowerOf2(size);
         // If we can't represent the next higher power of 2 then bail.
         if (size < 0) {
@@ -23,23 +38,46 @@ class FIFO {
         }
         m_data = new DataType[size];
         memset(m_data, 0, sizeof(DataType) * size);
-        PaUtil_InitializeRingBuffer(
-                &m_ringBuffer, sizeof(DataType), size, m_data);
+        m_size = size;
+        m_smallMask = size - 1;
+        m_bigMask = size * 2 - 1;
     }
     virtual ~FIFO() {
         delete [] m_data;
     }
     int readAvailable() const {
-        return PaUtil_GetRingBufferReadAvailable(&m_ringBuffer);
+        return (m_writeIndex.loadAcquire() - m_readIndex.loadAcquire()) & m_bigMask;
     }
     int writeAvailable() const {
-        return PaUtil_GetRingBufferWriteAvailable(&m_ringBuffer);
+        return m_size - readAvailable();
     }
     int read(DataType* pData, int count) {
-        return PaUtil_ReadRingBuffer(&m_ringBuffer, pData, count);
+        DataType* dataPtr1;
+        ring_buffer_size_t size1;
+        DataType* dataPtr2;
+        ring_buffer_size_t size2;
+        const int numRead = aquireReadRegions(count,
+                &dataPtr1, &size1, &dataPtr2, &size2);
+        memcpy(pData, dataPtr1, sizeof(DataType) * size1);
+        if (size2 > 0) {
+            memcpy(pData + size1, dataPtr2, sizeof(DataType) * size2);
+        }
+        releaseReadRegions(numRead);
+        return numRead;
     }
     int write(const DataType* pData, int count) {
-        return PaUtil_WriteRingBuffer(&m_ringBuffer, pData, count);
+        DataType* dataPtr1;
+        ring_buffer_size_t size1;
+        DataType* dataPtr2;
+        ring_buffer_size_t size2;
+        const int numWritten = aquireWriteRegions(count,
+                &dataPtr1, &size1, &dataPtr2, &size2);
+        memcpy(dataPtr1, pData, sizeof(DataType) * size1);
+        if (size2 > 0) {
+            memcpy(dataPtr2, pData + size1, sizeof(DataType) * size2);
+        }
+        releaseWriteRegions(numWritten);
+        return numWritten;
     }
     void writeBlocking(const DataType* pData, int count) {
         int written = 0;
@@ -49,32 +87,84 @@ class FIFO {
             written += i;
         }
     }
+    // Only to be called by the producer. Returns the number of items that
+    // can be written into the returned regions.
     int aquireWriteRegions(int count,
             DataType** dataPtr1, ring_buffer_size_t* sizePtr1,
             DataType** dataPtr2, ring_buffer_size_t* sizePtr2) {
-        return PaUtil_GetRingBufferWriteRegions(&m_ringBuffer, count,
-                (void**)dataPtr1, sizePtr1, (void**)dataPtr2, sizePtr2);
+        const int writeIndex = m_writeIndex.load();
+        // Acquire: The consumer has finished reading the free items
+        const int available = m_size -
+                ((writeIndex - m_readIndex.loadAcquire()) & m_bigMask);
+        return getRegions(writeIndex, math_min(count, available),
+                dataPtr1, sizePtr1, dataPtr2, sizePtr2);
     }
     int releaseWriteRegions(int count) {
-        return PaUtil_AdvanceRingBufferWriteIndex(&m_ringBuffer, count);
+        const int writeIndex = (m_writeIndex.load() + count) & m_bigMask;
+        // Release: Publish the written items
+        m_writeIndex.storeRelease(writeIndex);
+        return writeIndex;
     }
+    // Only to be called by the consumer. Returns the number of items that
+    // can be read from the returned regions.
     int aquireReadRegions(int count,
             DataType** dataPtr1, ring_buffer_size_t* sizePtr1,
             DataType** dataPtr2, ring_buffer_size_t* sizePtr2) {
-        return PaUtil_GetRingBufferReadRegions(&m_ringBuffer, count,
-                (void**)dataPtr1, sizePtr1, (void**)dataPtr2, sizePtr2);
+        const int readIndex = m_readIndex.load();
+        // Acquire: The producer has finished writing the available items
+        const int available =
+                (m_writeIndex.loadAcquire() - readIndex) & m_bigMask;
+        return getRegions(readIndex, math_min(count, available),
+                dataPtr1, sizePtr1, dataPtr2, sizePtr2);
     }
     int releaseReadRegions(int count) {
-        return PaUtil_AdvanceRingBufferReadIndex(&m_ringBuffer, count);
+        const int readIndex = (m_readIndex.load() + count) & m_bigMask;
+        // Release: The items have been read before they are freed
+        m_readIndex.storeRelease(readIndex);
+        return readIndex;
     }
     int flushReadData(int count) {
         int flush = math_min(readAvailable(), count);
-        return PaUtil_AdvanceRingBufferReadIndex(&m_ringBuffer, flush);
+        return releaseReadRegions(flush);
     }
 
   private:
+    // Typical size of a cache line
+    static constexpr int kCacheLineSize = 64;
+
+    int getRegions(int index, int count,
+            DataType** dataPtr1, ring_buffer_size_t* sizePtr1,
+            DataType** dataPtr2, ring_buffer_size_t* sizePtr2) const {
+        index &= m_smallMask;
+        if (index + count > m_size) {
+            // Two regions that wrap around the end of the buffer
+            const int firstHalf = m_size - index;
+            *dataPtr1 = m_data + index;
+            *sizePtr1 = firstHalf;
+            *dataPtr2 = m_data;
+            *sizePtr2 = count - firstHalf;
+        } else {
+            *dataPtr1 = m_data + index;
+            *sizePtr1 = count;
+            *dataPtr2 = nullptr;
+            *sizePtr2 = 0;
+        }
+        return count;
+    }
+
     DataType* m_data;
-    PaUtilRingBuffer m_ringBuffer;
+    int m_size;
+    int m_smallMask;
+    int m_bigMask;
+
+    // Only written by the producer
+    char m_padding1[kCacheLineSize];
+    QAtomicInt m_writeIndex;
+    // Only written by the consumer
+    char m_padding2[kCacheLineSize - sizeof(QAtomicInt)];
+    QAtomicInt m_readIndex;
+    char m_padding3[kCacheLineSize - sizeof(QAtomicInt)];
+
     DISALLOW_COPY_AND_ASSIGN(FIFO<DataType>);
 };
 
@@ -0,0 +1,98 @@
+#include "util/fifowakeup.h"
+
+#include <QtDebug>
+
+#ifdef __LINUX__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#endif
+
+FIFOWakeup::FIFOWakeup()
+        : m_state(kIdle) {
+#ifdef __LINUX__
+    m_eventFd = eventfd(0, EFD_CLOEXEC);
+    if (m_eventFd < 0) {
+        qWarning() << "FIFOWakeup: Failed to create eventfd" << errno;
+    }
+#endif
+}
+
+FIFOWakeup::~FIFOWakeup() {
+#ifdef __LINUX__
+    if (m_eventFd >= 0) {
+        close(m_eventFd);
+    }
+#endif
+}
+
+void FIFOWakeup::wake() {
+    if (m_state.fetchAndStoreRelease(kWakePending) == kConsumerWaiting) {
+        post();
+    }
+}
+
+bool FIFOWakeup::wait(int timeoutMillis) {
+    if (m_state.testAndSetAcquire(kWakePending, kIdle)) {
+        return true;
+    }
+    if (!m_state.testAndSetOrdered(kIdle, kConsumerWaiting)) {
+        // Woken in between
+        m_state.fetchAndStoreAcquire(kIdle);
+        return true;
+    }
+    const bool posted = sleep(timeoutMillis);
+    if (m_state.testAndSetOrdered(kConsumerWaiting, kIdle)) {
+        // Timed out without a wake()
+        return false;
+    }
+    m_state.fetchAndStoreAcquire(kIdle);
+    if (!posted) {
+        // The producer has switched the state right after the timeout and
+        // is about to post, consume it to keep the next wait() blocking.
+        sleep(-1);
+    }
+    return true;
+}
+
+#ifdef __LINUX__
+
+bool FIFOWakeup::sleep(int timeoutMillis) {
+    struct pollfd pfd;
+    pfd.fd = m_eventFd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int result;
+    do {
+        result = poll(&pfd, 1, timeoutMillis);
+    } while (result < 0 && errno == EINTR);
+    if (result <= 0) {
+        return false;
+    }
+    uint64_t value;
+    if (read(m_eventFd, &value, sizeof(value)) != sizeof(value)) {
+        qWarning() << "FIFOWakeup: Failed to read eventfd" << errno;
+    }
+    return true;
+}
+
+void FIFOWakeup::post() {
+    const uint64_t value = 1;
+    if (write(m_eventFd, &value, sizeof(value)) != sizeof(value)) {
+        qWarning() << "FIFOWakeup: Failed to write eventfd" << errno;
+    }
+}
+
+#else
+
+bool FIFOWakeup::sleep(int timeoutMillis) {
+    return m_semaphore.tryAcquire(1, timeoutMillis);
+}
+
+void FIFOWakeup::post() {
+    m_semaphore.release();
+}
+
+#endif
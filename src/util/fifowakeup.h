@@ -0,0 +1,51 @@
+#ifndef FIFOWAKEUP_H
+#define FIFOWAKEUP_H
+
+#include <QAtomicInt>
+#ifndef __LINUX__
+#include <QSemaphore>
+#endif
+
+#include "util/class.h"
+
+// Lets the single consumer of one or more FIFOs sleep until a producer
+// has written to them. Unlike QWaitCondition::wakeAll() the producer side
+// does not take a lock and only makes a system call if the consumer is
+// actually sleeping, so wake() may be called from the engine thread.
+//
+// A wake() that happens while the consumer is not waiting is remembered,
+// the next wait() returns immediately.
+class FIFOWakeup {
+  public:
+    FIFOWakeup();
+    virtual ~FIFOWakeup();
+
+    // May be called from any thread
+    void wake();
+
+    // Only to be called by the consumer. Returns false if the timeout
+    // in milliseconds expired, a negative timeout waits forever.
+    bool wait(int timeoutMillis = -1);
+
+  private:
+    // Blocks until post() or the timeout
+    bool sleep(int timeoutMillis);
+    void post();
+
+    enum State {
+        kConsumerWaiting = -1,
+        kIdle = 0,
+        kWakePending = 1,
+    };
+    QAtomicInt m_state;
+
+#ifdef __LINUX__
+    int m_eventFd;
+#else
+    QSemaphore m_semaphore;
+#endif
+
+    DISALLOW_COPY_AND_ASSIGN(FIFOWakeup);
+};
+
+#endif /* FIFOWAKEUP_H */
@@ -0,0 +1,185 @@
+#include "util/fileprefetcher.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+#include <QStorageInfo>
+#endif
+
+#ifdef __WINDOWS__
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#endif
+
+#include "util/logger.h"
+#include "util/math.h"
+#include "util/stat.h"
+
+namespace {
+
+const mixxx::Logger kLogger("FilePrefetcher");
+
+// A read of a chunk that takes longer than this is most likely waiting
+// for the storage, decoding alone takes a fraction of it
+const mixxx::Duration kSlowReadDuration = mixxx::Duration::fromMillis(20);
+
+const Stat::ComputeFlags kThroughputStatFlags = Stat::experimentFlags(
+        Stat::COUNT | Stat::AVERAGE | Stat::MIN | Stat::MAX);
+const Stat::ComputeFlags kSlowReadsStatFlags = Stat::experimentFlags(
+        Stat::COUNT | Stat::SUM);
+
+#ifdef __WINDOWS__
+// The most that is read by a single overlapped read
+const qint64 kMaxOverlappedReadBytes = 1024 * 1024;
+#endif
+
+QString deviceOfFile(const QString& filePath) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+    const QStorageInfo storageInfo(filePath);
+    if (storageInfo.isValid()) {
+        return storageInfo.rootPath();
+    }
+#endif
+    return QFileInfo(filePath).absolutePath();
+}
+
+} // anonymous namespace
+
+FilePrefetcher::FilePrefetcher()
+        : m_fileSize(0),
+#ifdef __WINDOWS__
+          m_handle(INVALID_HANDLE_VALUE),
+          m_pOverlapped(nullptr),
+          m_readPending(false) {
+#else
+          m_fd(-1) {
+#endif
+}
+
+FilePrefetcher::~FilePrefetcher() {
+    close();
+}
+
+bool FilePrefetcher::open(const QString& filePath) {
+    close();
+#ifdef __WINDOWS__
+    m_handle = CreateFileW(
+            reinterpret_cast<LPCWSTR>(filePath.utf16()),
+            GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_FLAG_OVERLAPPED,
+            nullptr);
+    if (m_handle == INVALID_HANDLE_VALUE) {
+        kLogger.warning() << "Failed to open" << filePath
+                << GetLastError();
+        return false;
+    }
+    m_pOverlapped = new OVERLAPPED();
+#else
+    m_fd = ::open(QFile::encodeName(filePath).constData(), O_RDONLY);
+    if (m_fd < 0) {
+        kLogger.warning() << "Failed to open" << filePath
+                << QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+#endif
+    m_fileSize = QFileInfo(filePath).size();
+    m_device = deviceOfFile(filePath);
+    m_throughputStatKey = QString("FilePrefetcher %1 read KiB/s").arg(m_device);
+    m_slowReadsStatKey = QString("FilePrefetcher %1 slow reads").arg(m_device);
+    return true;
+}
+
+void FilePrefetcher::close() {
+#ifdef __WINDOWS__
+    if (m_handle != INVALID_HANDLE_VALUE) {
+        LPOVERLAPPED pOverlapped = static_cast<LPOVERLAPPED>(m_pOverlapped);
+        if (m_readPending) {
+            // The scratch buffer must stay valid until the read is done
+            CancelIoEx(m_handle, pOverlapped);
+            DWORD bytesRead;
+            GetOverlappedResult(m_handle, pOverlapped, &bytesRead, TRUE);
+            m_readPending = false;
+        }
+        CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
+        delete pOverlapped;
+        m_pOverlapped = nullptr;
+    }
+#else
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    m_fileSize = 0;
+}
+
+bool FilePrefetcher::isOpen() const {
+#ifdef __WINDOWS__
+    return m_handle != INVALID_HANDLE_VALUE;
+#else
+    return m_fd >= 0;
+#endif
+}
+
+void FilePrefetcher::prefetch(qint64 offset, qint64 length) {
+    if (!isOpen()) {
+        return;
+    }
+    offset = math_clamp(offset, qint64(0), m_fileSize);
+    length = math_min(length, m_fileSize - offset);
+    if (length <= 0) {
+        return;
+    }
+#ifdef __WINDOWS__
+    LPOVERLAPPED pOverlapped = static_cast<LPOVERLAPPED>(m_pOverlapped);
+    if (m_readPending) {
+        if (!HasOverlappedIoCompleted(pOverlapped)) {
+            return;
+        }
+        m_readPending = false;
+    }
+    length = math_min(length, kMaxOverlappedReadBytes);
+    if (m_scratchBuffer.size() < size_t(length)) {
+        m_scratchBuffer.resize(kMaxOverlappedReadBytes);
+    }
+    ZeroMemory(pOverlapped, sizeof(OVERLAPPED));
+    pOverlapped->Offset = DWORD(offset & 0xFFFFFFFF);
+    pOverlapped->OffsetHigh = DWORD(offset >> 32);
+    if (ReadFile(m_handle, m_scratchBuffer.data(), DWORD(length),
+                nullptr, pOverlapped)) {
+        // Completed right away from the cache
+        return;
+    }
+    if (GetLastError() == ERROR_IO_PENDING) {
+        m_readPending = true;
+    }
+#elif defined(__APPLE__)
+    struct radvisory advisory;
+    advisory.ra_offset = offset;
+    advisory.ra_count = int(math_min(length, qint64(INT_MAX)));
+    fcntl(m_fd, F_RDADVISE, &advisory);
+#else
+    posix_fadvise(m_fd, offset, length, POSIX_FADV_WILLNEED);
+#endif
+}
+
+void FilePrefetcher::reportRead(qint64 bytes, mixxx::Duration duration) {
+    if (!isOpen() || bytes <= 0 || duration <= mixxx::Duration()) {
+        return;
+    }
+    Stat::track(m_throughputStatKey, Stat::UNSPECIFIED, kThroughputStatFlags,
+            bytes / 1024.0 / duration.toDoubleSeconds());
+    if (duration > kSlowReadDuration) {
+        Stat::track(m_slowReadsStatKey, Stat::COUNTER, kSlowReadsStatFlags, 1.0);
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef FILEPREFETCHER_H
+#define FILEPREFETCHER_H
+
+#include <QString>
+
+#include <vector>
+
+#include "util/class.h"
+#include "util/duration.h"
+
+// Asks the operating system to read a part of a file into its page cache
+// in the background, so the decoder that reads it synchronously a little
+// later does not wait for the storage. This matters for files on network
+// shares and slow USB sticks, where every read that misses the page cache
+// stalls the reader for milliseconds.
+//
+// On Windows an overlapped read of the range into a scratch buffer is
+// started, otherwise posix_fadvise() or its macOS equivalent is used. At
+// most one read is in flight on Windows, further requests are dropped
+// until it has completed.
+//
+// Also reports the read throughput of the device the file is stored on to
+// the stats, see reportRead().
+//
+// Not thread-safe, owned and used by a single reader thread.
+class FilePrefetcher {
+  public:
+    FilePrefetcher();
+    virtual ~FilePrefetcher();
+
+    // Opens a separate handle of the file. Returns false if the file
+    // cannot be opened, prefetch() does nothing then.
+    bool open(const QString& filePath);
+    void close();
+
+    bool isOpen() const;
+
+    // 0 if not open
+    qint64 fileSize() const {
+        return m_fileSize;
+    }
+
+    // Returns immediately. The range is clipped to the file.
+    void prefetch(qint64 offset, qint64 length);
+
+    // Reports that the decoder has read about the given number of bytes
+    // from the file in the given time. The throughput and slow reads are
+    // tracked per device.
+    void reportRead(qint64 bytes, mixxx::Duration duration);
+
+  private:
+    qint64 m_fileSize;
+    // The mount point of the file, or its directory if unknown
+    QString m_device;
+    QString m_throughputStatKey;
+    QString m_slowReadsStatKey;
+
+#ifdef __WINDOWS__
+    void* m_handle;
+    void* m_pOverlapped;
+    std::vector<char> m_scratchBuffer;
+    bool m_readPending;
+#else
+    int m_fd;
+#endif
+
+    DISALLOW_COPY_AND_ASSIGN(FilePrefetcher);
+};
+
+#endif // FILEPREFETCHER_H
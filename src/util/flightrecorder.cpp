@@ -0,0 +1,270 @@
+#include "util/flightrecorder.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include "control/controlpushbutton.h"
+#include "util/cmdlineargs.h"
+#include "util/logger.h"
+#include "util/time.h"
+
+namespace {
+
+const mixxx::Logger kLogger("FlightRecorder");
+
+// About 128 kB per thread, which covers several seconds of the engine
+// thread
+const int kRingSizeBits = 12;
+const quint64 kRingSize = 1 << kRingSizeBits;
+const quint64 kRingMask = kRingSize - 1;
+
+// The records after the request are part of the dump
+const unsigned long kPostTriggerMillis = 500;
+// Limits the dumps of an installation that keeps running into xruns
+const int kMinDumpIntervalMillis = 10000;
+
+QString escapeJson(const char* name) {
+    QString escaped;
+    for (const QChar& c : QString::fromUtf8(name)) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c.unicode() < 0x20) {
+            escaped += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // anonymous namespace
+
+// static
+bool FlightRecorder::s_bEnabled = false;
+
+FlightRecorder::Ring::Ring(int threadId, const QString& threadName)
+        : m_threadId(threadId),
+          m_threadName(threadName),
+          m_records(new Record[kRingSize]),
+          m_count(0) {
+}
+
+void FlightRecorder::Ring::append(const Record& record) {
+    // Only the owning thread writes
+    const quint64 count = m_count.load(std::memory_order_relaxed);
+    m_records[count & kRingMask] = record;
+    m_count.store(count + 1, std::memory_order_release);
+}
+
+QList<FlightRecorder::Record> FlightRecorder::Ring::snapshot() const {
+    const quint64 countBefore = m_count.load(std::memory_order_acquire);
+    const quint64 first = countBefore > kRingSize ? countBefore - kRingSize : 0;
+    QList<Record> records;
+    records.reserve(static_cast<int>(countBefore - first));
+    for (quint64 i = first; i < countBefore; ++i) {
+        records.append(m_records[i & kRingMask]);
+    }
+    // The writer has continued meanwhile and the slot it writes next might
+    // be torn
+    const quint64 countAfter = m_count.load(std::memory_order_acquire);
+    if (countAfter + 1 > first + kRingSize) {
+        const quint64 overwritten = countAfter + 1 - kRingSize - first;
+        records.erase(records.begin(), records.begin() +
+                static_cast<int>(std::min<quint64>(overwritten, records.size())));
+    }
+    return records;
+}
+
+FlightRecorder::FlightRecorder()
+        : m_dirPath(CmdlineArgs::Instance().getFlightRecorderPath()),
+          m_pDumpButton(std::make_unique<ControlPushButton>(
+                  ConfigKey("[Master]", "flight_recorder_dump"))),
+          m_pDumpReason(nullptr),
+          m_quit(false),
+          m_dumped(false) {
+    setObjectName("FlightRecorder");
+    connect(m_pDumpButton.get(), SIGNAL(valueChanged(double)),
+            this, SLOT(slotDump(double)),
+            Qt::DirectConnection);
+    s_bEnabled = !m_dirPath.isEmpty();
+    if (s_bEnabled) {
+        kLogger.info() << "Writing dumps into" << m_dirPath;
+        start(QThread::LowPriority);
+    }
+}
+
+FlightRecorder::~FlightRecorder() {
+    s_bEnabled = false;
+    m_quit = true;
+    m_wakeup.wake();
+    wait();
+}
+
+// static
+void FlightRecorder::record(Phase phase, const char* name, qint64 arg) {
+    FlightRecorder* pRecorder = instance();
+    if (!pRecorder) {
+        return;
+    }
+    Ring* pRing = pRecorder->ringForThread();
+    Record record;
+    record.time = mixxx::Time::elapsed().toIntegerNanos();
+    record.name = name;
+    record.arg = arg;
+    record.phase = phase;
+    pRing->append(record);
+}
+
+// static
+void FlightRecorder::requestDump(const char* reason) {
+    if (!s_bEnabled) {
+        return;
+    }
+    FlightRecorder* pRecorder = instance();
+    if (!pRecorder) {
+        return;
+    }
+    instant(reason);
+    // Keeps the first reason of a dump that is pending
+    const char* pExpected = nullptr;
+    pRecorder->m_pDumpReason.compare_exchange_strong(pExpected, reason);
+    pRecorder->m_wakeup.wake();
+}
+
+void FlightRecorder::slotDump(double v) {
+    if (v > 0) {
+        requestDump("flight_recorder_dump");
+    }
+}
+
+FlightRecorder::Ring* FlightRecorder::ringForThread() {
+    if (m_threadRings.hasLocalData()) {
+        return m_threadRings.localData().get();
+    }
+    // Allocated once per thread on its first record
+    QThread* pThread = QThread::currentThread();
+    QString threadName = pThread->objectName();
+    if (QCoreApplication::instance() &&
+            pThread == QCoreApplication::instance()->thread()) {
+        threadName = "Main";
+    }
+    QMutexLocker locker(&m_ringsLock);
+    const int threadId = m_rings.size();
+    if (threadName.isEmpty()) {
+        threadName = QString("Thread %1").arg(threadId);
+    }
+    auto pRing = std::make_shared<Ring>(threadId, threadName);
+    m_rings.append(pRing);
+    locker.unlock();
+    m_threadRings.setLocalData(pRing);
+    return pRing.get();
+}
+
+void FlightRecorder::run() {
+    while (!m_quit) {
+        m_wakeup.wait();
+        const char* reason = m_pDumpReason.load();
+        if (m_quit || !reason) {
+            continue;
+        }
+        if (m_dumped &&
+                m_lastDump.elapsed().toIntegerMillis() < kMinDumpIntervalMillis) {
+            m_pDumpReason = nullptr;
+            continue;
+        }
+        // Includes the recovery after an xrun
+        QThread::msleep(kPostTriggerMillis);
+        m_pDumpReason = nullptr;
+        writeDump(reason);
+        m_lastDump.start();
+        m_dumped = true;
+    }
+}
+
+void FlightRecorder::writeDump(const char* reason) {
+    if (!QDir().mkpath(m_dirPath)) {
+        kLogger.warning() << "Failed to create directory" << m_dirPath;
+        return;
+    }
+    const QString filePath = QDir(m_dirPath).filePath(
+            QString("flightrecorder_%1_%2.json").arg(
+                    QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"),
+                    QString::fromUtf8(reason)));
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        kLogger.warning() << "Failed to open" << filePath;
+        return;
+    }
+    QTextStream out(&file);
+    writeTraceEvents(&out);
+    out.flush();
+    if (!file.commit()) {
+        kLogger.warning() << "Failed to write" << filePath << file.errorString();
+        return;
+    }
+    kLogger.info() << "Dumped the recent traces into" << filePath;
+}
+
+void FlightRecorder::writeTraceEvents(QTextStream* pOut) {
+    QTextStream& out = *pOut;
+    const QString pid = QString::number(QCoreApplication::applicationPid());
+
+    QMutexLocker locker(&m_ringsLock);
+    const QList<std::shared_ptr<Ring>> rings = m_rings;
+    locker.unlock();
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& pRing : rings) {
+        if (!first) {
+            out << ",\n";
+        }
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":" << pRing->m_threadId
+            << ",\"args\":{\"name\":\""
+            << escapeJson(pRing->m_threadName.toUtf8().constData()) << "\"}}";
+
+        // The begin of the oldest ends may have been overwritten
+        int depth = 0;
+        for (const Record& record : pRing->snapshot()) {
+            QString phase;
+            switch (record.phase) {
+            case Phase::Begin:
+                ++depth;
+                phase = "B";
+                break;
+            case Phase::End:
+                if (depth == 0) {
+                    continue;
+                }
+                --depth;
+                phase = "E";
+                break;
+            case Phase::Instant:
+                phase = "i";
+                break;
+            }
+            out << ",\n{\"name\":\"" << escapeJson(record.name)
+                << "\",\"ph\":\"" << phase
+                << "\",\"ts\":" << QString::number(record.time / 1000.0, 'f', 3)
+                << ",\"pid\":" << pid
+                << ",\"tid\":" << pRing->m_threadId;
+            if (record.phase == Phase::Instant) {
+                out << ",\"s\":\"t\"";
+            }
+            if (record.arg != 0) {
+                out << ",\"args\":{\"arg\":" << record.arg << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+}
@@ -0,0 +1,123 @@
+#ifndef UTIL_FLIGHTRECORDER_H
+#define UTIL_FLIGHTRECORDER_H
+
+#include <atomic>
+#include <memory>
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QThreadStorage>
+
+#include "util/fifowakeup.h"
+#include "util/memory.h"
+#include "util/performancetimer.h"
+#include "util/singleton.h"
+
+class ControlPushButton;
+class QTextStream;
+
+// Records the traces and timers of all threads into small per-thread ring
+// buffers with a cost low enough to stay enabled during a gig, and dumps
+// the last seconds before an xrun or on demand as a Chrome trace file.
+//
+// A record only holds the time, the address of the name and an integer
+// argument. The name must be a string literal or otherwise outlive the
+// recorder, so it is never copied. Each thread writes only into its own
+// ring without any lock, the background thread of the recorder reads all
+// rings while writing a dump.
+//
+// Enabled by --flightRecorderPath DIR, the dumps are written into DIR.
+// [Master],flight_recorder_dump requests a dump, e.g. from a controller.
+class FlightRecorder : public QThread, public Singleton<FlightRecorder> {
+    Q_OBJECT
+  public:
+    FlightRecorder();
+    ~FlightRecorder() override;
+
+    static bool isEnabled() {
+        return s_bEnabled;
+    }
+
+    static void begin(const char* name, qint64 arg = 0) {
+        if (s_bEnabled) {
+            record(Phase::Begin, name, arg);
+        }
+    }
+    static void end(const char* name) {
+        if (s_bEnabled) {
+            record(Phase::End, name, 0);
+        }
+    }
+    static void instant(const char* name, qint64 arg = 0) {
+        if (s_bEnabled) {
+            record(Phase::Instant, name, arg);
+        }
+    }
+
+    // Requests a dump of the recent records, may be called from any thread
+    // including the engine. The dump includes a short time after the
+    // request and requests that follow soon after a dump are dropped.
+    static void requestDump(const char* reason);
+
+  private slots:
+    void slotDump(double v);
+
+  private:
+    enum class Phase {
+        Begin,
+        End,
+        Instant,
+    };
+
+    struct Record {
+        qint64 time;
+        const char* name;
+        qint64 arg;
+        Phase phase;
+    };
+
+    class Ring {
+      public:
+        Ring(int threadId, const QString& threadName);
+
+        void append(const Record& record);
+        // The records that have not been overwritten meanwhile, the oldest
+        // first
+        QList<Record> snapshot() const;
+
+        const int m_threadId;
+        const QString m_threadName;
+
+      private:
+        std::unique_ptr<Record[]> m_records;
+        std::atomic<quint64> m_count;
+    };
+
+    static void record(Phase phase, const char* name, qint64 arg);
+    Ring* ringForThread();
+
+    void run() override;
+    void writeDump(const char* reason);
+    void writeTraceEvents(QTextStream* pOut);
+
+    static bool s_bEnabled;
+
+    const QString m_dirPath;
+    std::unique_ptr<ControlPushButton> m_pDumpButton;
+
+    FIFOWakeup m_wakeup;
+    std::atomic<const char*> m_pDumpReason;
+    std::atomic<bool> m_quit;
+    PerformanceTimer m_lastDump;
+    bool m_dumped;
+
+    // Guards m_rings, the rings are kept after their threads have finished
+    QMutex m_ringsLock;
+    QList<std::shared_ptr<Ring>> m_rings;
+    QThreadStorage<std::shared_ptr<Ring>> m_threadRings;
+};
+
+#endif // UTIL_FLIGHTRECORDER_H
@@ -0,0 +1,77 @@
+#include "util/lockprofiler.h"
+
+#include <QFileInfo>
+#include <QString>
+
+#include "util/performancetimer.h"
+#include "util/stat.h"
+
+namespace {
+
+const Stat::ComputeFlags kDurationFlags = Stat::COUNT | Stat::SUM |
+        Stat::AVERAGE | Stat::MAX | Stat::MIN | Stat::SAMPLE_VARIANCE;
+const Stat::ComputeFlags kCounterFlags = Stat::COUNT | Stat::SUM;
+
+} // anonymous namespace
+
+// static
+bool LockProfiler::s_bEnabled = false;
+
+// static
+void LockProfiler::lock(QMutex* pMutex, const char* name,
+                        const char* file, int line) {
+    if (pMutex->tryLock()) {
+        return;
+    }
+    PerformanceTimer timer;
+    timer.start();
+    pMutex->lock();
+    reportWait(name, file, line, timer.elapsed());
+}
+
+// static
+void LockProfiler::lockForRead(QReadWriteLock* pLock, const char* name,
+                               const char* file, int line) {
+    if (pLock->tryLockForRead()) {
+        return;
+    }
+    PerformanceTimer timer;
+    timer.start();
+    pLock->lockForRead();
+    reportWait(name, file, line, timer.elapsed());
+}
+
+// static
+void LockProfiler::lockForWrite(QReadWriteLock* pLock, const char* name,
+                                const char* file, int line) {
+    if (pLock->tryLockForWrite()) {
+        return;
+    }
+    PerformanceTimer timer;
+    timer.start();
+    pLock->lockForWrite();
+    reportWait(name, file, line, timer.elapsed());
+}
+
+// static
+void LockProfiler::reportHold(const char* name, mixxx::Duration hold) {
+    Stat::track(QString("Lock %1 hold").arg(name),
+            Stat::DURATION_NANOSEC, kDurationFlags, hold.toIntegerNanos());
+}
+
+// static
+void LockProfiler::reportWait(const char* name, const char* file, int line,
+                              mixxx::Duration wait) {
+    // Reported while the lock is held, which delays the other waiters
+    // slightly but keeps the order of the reports
+    Stat::track(QString("Lock %1 contended").arg(name),
+            Stat::COUNTER, kCounterFlags, 1);
+    Stat::track(QString("Lock %1 wait").arg(name),
+            Stat::DURATION_NANOSEC, kDurationFlags, wait.toIntegerNanos());
+    if (file) {
+        Stat::track(QString("Lock %1 wait at %2:%3").arg(
+                        name, QFileInfo(QString::fromUtf8(file)).fileName(),
+                        QString::number(line)),
+                Stat::DURATION_NANOSEC, kDurationFlags, wait.toIntegerNanos());
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef UTIL_LOCKPROFILER_H
+#define UTIL_LOCKPROFILER_H
+
+#include <QMutex>
+#include <QReadWriteLock>
+
+#include "util/duration.h"
+
+// The location of the caller of a lock function, if the compiler supports
+// it for default arguments
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_FILE) && __has_builtin(__builtin_LINE)
+#define MIXXX_LOCK_CALLER_FILE __builtin_FILE()
+#define MIXXX_LOCK_CALLER_LINE __builtin_LINE()
+#endif
+#elif defined(__GNUC__) && !defined(__clang__)
+#define MIXXX_LOCK_CALLER_FILE __builtin_FILE()
+#define MIXXX_LOCK_CALLER_LINE __builtin_LINE()
+#endif
+#ifndef MIXXX_LOCK_CALLER_FILE
+#define MIXXX_LOCK_CALLER_FILE nullptr
+#define MIXXX_LOCK_CALLER_LINE 0
+#endif
+
+// Measures the contention of the named locks of util/mutex.h and reports it
+// to the StatsManager, enabled by --profileLocks. For each lock name:
+//   "Lock <name> contended"            - the number of blocking acquires
+//   "Lock <name> wait"                 - the time waited for the lock
+//   "Lock <name> wait at <file>:<line>" - the same by acquiring location
+//   "Lock <name> hold"                 - the time a locker held the lock
+// An acquire that does not block only costs a failed check of the flag
+// when disabled and a tryLock() when enabled.
+class LockProfiler {
+  public:
+    static void setEnabled(bool enabled) {
+        s_bEnabled = enabled;
+    }
+    static bool isEnabled() {
+        return s_bEnabled;
+    }
+
+    static void lock(QMutex* pMutex, const char* name,
+                     const char* file, int line);
+    static void lockForRead(QReadWriteLock* pLock, const char* name,
+                            const char* file, int line);
+    static void lockForWrite(QReadWriteLock* pLock, const char* name,
+                             const char* file, int line);
+
+    static void reportHold(const char* name, mixxx::Duration hold);
+
+  private:
+    static void reportWait(const char* name, const char* file, int line,
+                           mixxx::Duration wait);
+
+    static bool s_bEnabled;
+};
+
+#endif // UTIL_LOCKPROFILER_H
@@ -0,0 +1,27 @@
+#include "util/memoryaccounting.h"
+
+// static
+std::atomic<qint64> MemoryAccounting::s_bytes[MemoryAccounting::kCategoryCount];
+
+// static
+QString MemoryAccounting::categoryName(Category category) {
+    switch (category) {
+    case Category::CachingReaderChunks:
+        return "caching_reader_chunks";
+    case Category::CachingReaderPreloads:
+        return "caching_reader_preloads";
+    case Category::Waveforms:
+        return "waveforms";
+    case Category::CoverArt:
+        return "cover_art";
+    case Category::TrackCache:
+        return "track_cache";
+    case Category::BaseTrackCache:
+        return "base_track_cache";
+    case Category::EffectStates:
+        return "effect_states";
+    case Category::SkinPixmaps:
+        return "skin_pixmaps";
+    }
+    return QString();
+}
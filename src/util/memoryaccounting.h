@@ -0,0 +1,90 @@
+#ifndef UTIL_MEMORYACCOUNTING_H
+#define UTIL_MEMORYACCOUNTING_H
+
+#include <atomic>
+
+#include <QString>
+#include <QtGlobal>
+
+// The live totals of the memory that the big consumers have allocated, as
+// reported by their explicit accounting hooks. The totals are an estimate of
+// the payload, e.g. the sample data or the pixels, and ignore the overhead
+// of the allocator and of the containers.
+//
+// All functions are lock-free and may be called from any thread.
+class MemoryAccounting {
+  public:
+    enum class Category {
+        CachingReaderChunks,
+        CachingReaderPreloads,
+        Waveforms,
+        CoverArt,
+        TrackCache,
+        BaseTrackCache,
+        EffectStates,
+        SkinPixmaps,
+    };
+    static const int kCategoryCount = static_cast<int>(Category::SkinPixmaps) + 1;
+
+    static void add(Category category, qint64 bytes) {
+        s_bytes[static_cast<int>(category)].fetch_add(
+                bytes, std::memory_order_relaxed);
+    }
+    static void subtract(Category category, qint64 bytes) {
+        add(category, -bytes);
+    }
+
+    static qint64 bytes(Category category) {
+        return s_bytes[static_cast<int>(category)].load(
+                std::memory_order_relaxed);
+    }
+
+    // A name that is suitable for a stat or metric label, e.g. "waveforms"
+    static QString categoryName(Category category);
+
+  private:
+    static std::atomic<qint64> s_bytes[kCategoryCount];
+};
+
+// The memory of one object that is accounted for in a category until it is
+// destroyed, e.g. as a member of the object.
+class MemoryAccount {
+  public:
+    explicit MemoryAccount(MemoryAccounting::Category category,
+                           qint64 bytes = 0)
+            : m_category(category),
+              m_bytes(bytes) {
+        MemoryAccounting::add(m_category, m_bytes);
+    }
+    MemoryAccount(const MemoryAccount& other)
+            : m_category(other.m_category),
+              m_bytes(other.m_bytes) {
+        MemoryAccounting::add(m_category, m_bytes);
+    }
+    ~MemoryAccount() {
+        MemoryAccounting::subtract(m_category, m_bytes);
+    }
+
+    // Replaces the accounted size, e.g. after a container has been resized
+    void setBytes(qint64 bytes) {
+        MemoryAccounting::add(m_category, bytes - m_bytes);
+        m_bytes = bytes;
+    }
+    qint64 bytes() const {
+        return m_bytes;
+    }
+
+    MemoryAccount& operator=(const MemoryAccount& other) {
+        MemoryAccounting::subtract(m_category, m_bytes);
+        m_category = other.m_category;
+        m_bytes = other.m_bytes;
+        MemoryAccounting::add(m_category, m_bytes);
+        return *this;
+    }
+
+  private:
+    MemoryAccounting::Category m_category;
+    qint64 m_bytes;
+};
+
+#endif // UTIL_MEMORYACCOUNTING_H
@@ -4,20 +4,41 @@
 // Thread annotation aware variants of locks, read-write locks and scoped
 // lockers. This allows us to use Clang thread safety analysis in Mixxx.
 // See: http://clang.llvm.org/docs/ThreadSafetyAnalysis.html
+//
+// The contention of a lock that is constructed with a name is measured when
+// the LockProfiler is enabled. The hold time is only measured by the scoped
+// lockers. All acquires that may block are checked by RealtimeSafety.
 
 #include <QMutex>
 #include <QReadWriteLock>
 #include <QMutexLocker>
 
+#include "util/lockprofiler.h"
+#include "util/performancetimer.h"
+#include "util/realtimesafety.h"
 #include "util/thread_annotations.h"
 
 class CAPABILITY("mutex") MMutex {
   public:
     MMutex(QMutex::RecursionMode mode = QMutex::NonRecursive)
-            : m_mutex(mode) {
+            : m_mutex(mode),
+              m_name(nullptr) {
+    }
+    explicit MMutex(const char* name,
+                    QMutex::RecursionMode mode = QMutex::NonRecursive)
+            : m_mutex(mode),
+              m_name(name) {
     }
 
-    inline void lock() ACQUIRE() { m_mutex.lock(); }
+    inline void lock(const char* file = MIXXX_LOCK_CALLER_FILE,
+                     int line = MIXXX_LOCK_CALLER_LINE) ACQUIRE() {
+        RealtimeSafety::check(RealtimeSafety::Violation::Lock);
+        if (m_name && LockProfiler::isEnabled()) {
+            LockProfiler::lock(&m_mutex, m_name, file, line);
+        } else {
+            m_mutex.lock();
+        }
+    }
     inline void unlock() RELEASE() { m_mutex.unlock(); }
     inline bool tryLock() TRY_ACQUIRE(true) {
         return m_mutex.tryLock();
@@ -25,21 +46,44 @@ class CAPABILITY("mutex") MMutex {
 
   private:
     QMutex m_mutex;
+    const char* const m_name;
     friend class MMutexLocker;
 };
 
 class CAPABILITY("mutex") MReadWriteLock {
   public:
     MReadWriteLock(QReadWriteLock::RecursionMode mode = QReadWriteLock::NonRecursive)
-            : m_lock(mode) {
+            : m_lock(mode),
+              m_name(nullptr) {
+    }
+    explicit MReadWriteLock(const char* name,
+            QReadWriteLock::RecursionMode mode = QReadWriteLock::NonRecursive)
+            : m_lock(mode),
+              m_name(name) {
     }
 
-    void lockForRead() ACQUIRE_SHARED() { m_lock.lockForRead(); }
+    void lockForRead(const char* file = MIXXX_LOCK_CALLER_FILE,
+                     int line = MIXXX_LOCK_CALLER_LINE) ACQUIRE_SHARED() {
+        RealtimeSafety::check(RealtimeSafety::Violation::Lock);
+        if (m_name && LockProfiler::isEnabled()) {
+            LockProfiler::lockForRead(&m_lock, m_name, file, line);
+        } else {
+            m_lock.lockForRead();
+        }
+    }
     bool tryLockForRead() TRY_ACQUIRE_SHARED(true) {
         return m_lock.tryLockForRead();
     }
 
-    void lockForWrite() ACQUIRE() { m_lock.lockForWrite(); }
+    void lockForWrite(const char* file = MIXXX_LOCK_CALLER_FILE,
+                      int line = MIXXX_LOCK_CALLER_LINE) ACQUIRE() {
+        RealtimeSafety::check(RealtimeSafety::Violation::Lock);
+        if (m_name && LockProfiler::isEnabled()) {
+            LockProfiler::lockForWrite(&m_lock, m_name, file, line);
+        } else {
+            m_lock.lockForWrite();
+        }
+    }
     bool tryLockForWrite() TRY_ACQUIRE(true) {
         return m_lock.tryLockForWrite();
     }
@@ -48,42 +92,119 @@ class CAPABILITY("mutex") MReadWriteLock {
 
   private:
     QReadWriteLock m_lock;
+    const char* const m_name;
     friend class MWriteLocker;
     friend class MReadLocker;
 };
 
+// Reports the time between acquiring and releasing a named lock
+class MLockHoldTimer {
+  public:
+    MLockHoldTimer()
+            : m_name(nullptr) {
+    }
+
+    void start(const char* name) {
+        if (name && LockProfiler::isEnabled()) {
+            m_name = name;
+            m_timer.start();
+        }
+    }
+
+    void report() {
+        if (m_name) {
+            LockProfiler::reportHold(m_name, m_timer.elapsed());
+            m_name = nullptr;
+        }
+    }
+
+  private:
+    const char* m_name;
+    PerformanceTimer m_timer;
+};
+
 class SCOPED_CAPABILITY MMutexLocker {
   public:
-    MMutexLocker(MMutex* mu) ACQUIRE(mu) : m_locker(&mu->m_mutex) {}
-    ~MMutexLocker() RELEASE() {}
+    MMutexLocker(MMutex* mu,
+                 const char* file = MIXXX_LOCK_CALLER_FILE,
+                 int line = MIXXX_LOCK_CALLER_LINE) ACQUIRE(mu)
+            : m_pMutex(mu),
+              m_locked(true) {
+        mu->lock(file, line);
+        m_holdTimer.start(mu->m_name);
+    }
+    ~MMutexLocker() RELEASE() {
+        unlock();
+    }
 
-    inline void unlock() RELEASE() { m_locker.unlock(); }
+    inline void unlock() RELEASE() {
+        if (m_locked) {
+            m_locked = false;
+            m_holdTimer.report();
+            m_pMutex->unlock();
+        }
+    }
 
   private:
-    QMutexLocker m_locker;
+    MMutex* const m_pMutex;
+    bool m_locked;
+    MLockHoldTimer m_holdTimer;
 };
 
 class SCOPED_CAPABILITY MWriteLocker {
   public:
-    MWriteLocker(MReadWriteLock* mu) ACQUIRE(mu) : m_locker(&mu->m_lock) {}
-    ~MWriteLocker() RELEASE() {}
+    MWriteLocker(MReadWriteLock* mu,
+                 const char* file = MIXXX_LOCK_CALLER_FILE,
+                 int line = MIXXX_LOCK_CALLER_LINE) ACQUIRE(mu)
+            : m_pLock(mu),
+              m_locked(true) {
+        mu->lockForWrite(file, line);
+        m_holdTimer.start(mu->m_name);
+    }
+    ~MWriteLocker() RELEASE() {
+        unlock();
+    }
 
-    inline void unlock() RELEASE() { m_locker.unlock(); }
+    inline void unlock() RELEASE() {
+        if (m_locked) {
+            m_locked = false;
+            m_holdTimer.report();
+            m_pLock->unlock();
+        }
+    }
 
   private:
-    QWriteLocker m_locker;
+    MReadWriteLock* const m_pLock;
+    bool m_locked;
+    MLockHoldTimer m_holdTimer;
 };
 
 class SCOPED_CAPABILITY MReadLocker {
   public:
-    MReadLocker(MReadWriteLock* mu) ACQUIRE_SHARED(mu)
-            : m_locker(&mu->m_lock) {}
-    ~MReadLocker() RELEASE() {}
+    MReadLocker(MReadWriteLock* mu,
+                const char* file = MIXXX_LOCK_CALLER_FILE,
+                int line = MIXXX_LOCK_CALLER_LINE) ACQUIRE_SHARED(mu)
+            : m_pLock(mu),
+              m_locked(true) {
+        mu->lockForRead(file, line);
+        m_holdTimer.start(mu->m_name);
+    }
+    ~MReadLocker() RELEASE() {
+        unlock();
+    }
 
-    inline void unlock() RELEASE() { m_locker.unlock(); }
+    inline void unlock() RELEASE() {
+        if (m_locked) {
+            m_locked = false;
+            m_holdTimer.report();
+            m_pLock->unlock();
+        }
+    }
 
   private:
-    QReadLocker m_locker;
+    MReadWriteLock* const m_pLock;
+    bool m_locked;
+    MLockHoldTimer m_holdTimer;
 };
 
 #endif /* UTIL_MUTEX_H */
@@ -0,0 +1,58 @@
+#include "util/rampedparameter.h"
+
+#include "util/assert.h"
+#include "util/sample.h"
+
+RampedParameter::RampedParameter(CSAMPLE_GAIN initial, SINT framesPerBuffer)
+        : m_frames(framesPerBuffer),
+          m_constantFrames(0),
+          m_value(initial),
+          m_bRamping(false) {
+}
+
+const CSAMPLE_GAIN* RampedParameter::ramp(CSAMPLE_GAIN target, SINT numFrames) {
+    VERIFY_OR_DEBUG_ASSERT(numFrames > 0) {
+        m_bRamping = false;
+        return m_frames.data();
+    }
+    if (numFrames > m_frames.size()) {
+        // Only happens if the buffer size has been increased after the
+        // EffectState has been created
+        mixxx::SampleBuffer(numFrames).swap(m_frames);
+        m_constantFrames = 0;
+    }
+    CSAMPLE_GAIN* pFrames = m_frames.data();
+    if (target == m_value) {
+        m_bRamping = false;
+        if (m_constantFrames < numFrames) {
+            SampleUtil::fill(pFrames, m_value, numFrames);
+            m_constantFrames = numFrames;
+        }
+        return pFrames;
+    }
+
+    const CSAMPLE_GAIN start = m_value;
+    const CSAMPLE_GAIN delta = (target - start) / numFrames;
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        pFrames[i] = start + delta * (i + 1);
+    }
+    // Make sure the ramp ends exactly at the target despite rounding
+    pFrames[numFrames - 1] = target;
+
+    m_value = target;
+    m_constantFrames = 0;
+    m_bRamping = true;
+    return pFrames;
+}
+
+// static
+void RampedParameter::crossfadeStereo(CSAMPLE* pOutput, const CSAMPLE* pDry,
+        const CSAMPLE_GAIN* pWetGains, SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        const CSAMPLE_GAIN wet = pWetGains[i];
+        pOutput[i * 2] = pDry[i * 2] * (1 - wet) + pOutput[i * 2] * wet;
+        pOutput[i * 2 + 1] = pDry[i * 2 + 1] * (1 - wet) + pOutput[i * 2 + 1] * wet;
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef MIXXX_UTIL_RAMPEDPARAMETER_H
+#define MIXXX_UTIL_RAMPEDPARAMETER_H
+
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+// The per-frame values of an effect parameter that is ramped linearly from
+// its value in the previous buffer to its new value over the length of a
+// buffer, to avoid clicks when the parameter is changed.
+//
+// Unlike RampingValue, which computes the next value inside of the
+// processing loop, the values for the whole buffer are precomputed in a
+// single loop that the compiler can vectorize, and the processing loop only
+// reads them. This also removes the ramp from the dependency chain of
+// recursive processing loops.
+//
+// The first frame of a buffer holds the value after one step and the last
+// frame holds the new value, like it was done by the effects before.
+class RampedParameter {
+  public:
+    // framesPerBuffer should be the buffer size of the EffectState that
+    // owns the parameter, so that ramp() does not need to allocate.
+    RampedParameter(CSAMPLE_GAIN initial, SINT framesPerBuffer);
+
+    // Computes the values for the next numFrames frames, ramping from the
+    // previous value to target. Returns the array of values, which stays
+    // valid until the next call.
+    const CSAMPLE_GAIN* ramp(CSAMPLE_GAIN target, SINT numFrames);
+
+    // Sets the value without ramping, e.g. so that the next ramp() after an
+    // effect has been disabled starts again from zero.
+    void reset(CSAMPLE_GAIN value) {
+        m_value = value;
+        m_constantFrames = 0;
+        m_bRamping = false;
+    }
+
+    // The value at the end of the last ramp
+    CSAMPLE_GAIN value() const {
+        return m_value;
+    }
+
+    // True if the value changed during the last ramp
+    bool isRamping() const {
+        return m_bRamping;
+    }
+
+    const CSAMPLE_GAIN* frames() const {
+        return m_frames.data();
+    }
+
+    CSAMPLE_GAIN operator[](SINT frame) const {
+        return m_frames[frame];
+    }
+
+    // pOutput = pDry * (1 - pWetGains) + pOutput * pWetGains for every frame
+    // of the interleaved stereo buffers, where pOutput holds the wet signal.
+    // The effect chain never processes effects in place, so pDry and pOutput
+    // are distinct buffers.
+    static void crossfadeStereo(CSAMPLE* pOutput, const CSAMPLE* pDry,
+            const CSAMPLE_GAIN* pWetGains, SINT numFrames);
+
+  private:
+    mixxx::SampleBuffer m_frames;
+    // The number of frames at the start of m_frames that hold m_value,
+    // which do not need to be filled again while the value is constant
+    SINT m_constantFrames;
+    CSAMPLE_GAIN m_value;
+    bool m_bRamping;
+};
+
+#endif // MIXXX_UTIL_RAMPEDPARAMETER_H
@@ -0,0 +1,347 @@
+#include "util/realtimesafety.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtDebug>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#define MIXXX_HAVE_BACKTRACE
+#endif
+
+#ifdef MIXXX_REALTIME_SAFETY_HOOKS
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+#ifndef __WINDOWS__
+#include <dlfcn.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+#endif
+
+#include "util/counter.h"
+
+namespace {
+
+const int kMaxFrames = 32;
+// record() and check()
+const int kSkippedFrames = 2;
+
+struct Occurrence {
+    Occurrence()
+            : violation(RealtimeSafety::Violation::Allocation),
+              count(0) {
+    }
+    RealtimeSafety::Violation violation;
+    qint64 count;
+};
+
+// Keyed by the return addresses of the stack trace
+typedef QHash<QByteArray, Occurrence> OccurrenceHash;
+
+// Function statics, allocations are checked before main()
+QMutex* occurrencesMutex() {
+    static QMutex s_mutex;
+    return &s_mutex;
+}
+
+OccurrenceHash* occurrences() {
+    static OccurrenceHash s_occurrences;
+    return &s_occurrences;
+}
+
+Counter* violationCounter(RealtimeSafety::Violation violation) {
+    static Counter s_counters[RealtimeSafety::kViolationCount] = {
+        Counter("RealtimeSafety allocation"),
+        Counter("RealtimeSafety deallocation"),
+        Counter("RealtimeSafety lock"),
+        Counter("RealtimeSafety wait"),
+        Counter("RealtimeSafety sleep"),
+    };
+    return &s_counters[static_cast<int>(violation)];
+}
+
+void logStackTrace(const QByteArray& frames) {
+#ifdef MIXXX_HAVE_BACKTRACE
+    void* const* ppFrames = reinterpret_cast<void* const*>(frames.constData());
+    const int frameCount = frames.size() / static_cast<int>(sizeof(void*));
+    char** symbols = backtrace_symbols(ppFrames, frameCount);
+    if (!symbols) {
+        return;
+    }
+    for (int i = 0; i < frameCount; ++i) {
+        qWarning() << "    " << symbols[i];
+    }
+    free(symbols);
+#else
+    Q_UNUSED(frames);
+#endif
+}
+
+} // anonymous namespace
+
+// static
+bool RealtimeSafety::s_bEnabled = false;
+// static
+thread_local int RealtimeSafety::s_realtimeDepth = 0;
+// static
+thread_local bool RealtimeSafety::s_bRecording = false;
+// static
+std::atomic<qint64> RealtimeSafety::s_counts[RealtimeSafety::kViolationCount];
+
+// static
+qint64 RealtimeSafety::totalCount() {
+    qint64 total = 0;
+    for (int i = 0; i < kViolationCount; ++i) {
+        total += count(static_cast<Violation>(i));
+    }
+    return total;
+}
+
+// static
+QString RealtimeSafety::violationName(Violation violation) {
+    switch (violation) {
+    case Violation::Allocation:
+        return "allocation";
+    case Violation::Deallocation:
+        return "deallocation";
+    case Violation::Lock:
+        return "lock";
+    case Violation::Wait:
+        return "wait";
+    case Violation::Sleep:
+        return "sleep";
+    }
+    return QString();
+}
+
+// static
+void RealtimeSafety::record(Violation violation) {
+    s_bRecording = true;
+    s_counts[static_cast<int>(violation)].fetch_add(
+            1, std::memory_order_relaxed);
+    violationCounter(violation)->increment();
+
+    QByteArray frames;
+#ifdef MIXXX_HAVE_BACKTRACE
+    void* buffer[kMaxFrames];
+    const int frameCount = backtrace(buffer, kMaxFrames);
+    if (frameCount > kSkippedFrames) {
+        frames = QByteArray(reinterpret_cast<const char*>(buffer + kSkippedFrames),
+                (frameCount - kSkippedFrames) * static_cast<int>(sizeof(void*)));
+    }
+#endif
+
+    bool first;
+    {
+        QMutexLocker locker(occurrencesMutex());
+        Occurrence& occurrence = (*occurrences())[frames];
+        occurrence.violation = violation;
+        first = occurrence.count++ == 0;
+    }
+    if (first) {
+        qWarning() << "RealtimeSafety:" << violationName(violation)
+                   << "on the audio callback thread";
+        logStackTrace(frames);
+    }
+    s_bRecording = false;
+}
+
+// static
+void RealtimeSafety::logReport() {
+    const bool recording = s_bRecording;
+    s_bRecording = true;
+    qDebug() << "RealtimeSafety:" << totalCount()
+             << "violations on the audio callback thread";
+    for (int i = 0; i < kViolationCount; ++i) {
+        const Violation violation = static_cast<Violation>(i);
+        if (count(violation) > 0) {
+            qDebug() << "    " << violationName(violation) << count(violation);
+        }
+    }
+    OccurrenceHash copy;
+    {
+        QMutexLocker locker(occurrencesMutex());
+        copy = *occurrences();
+    }
+    for (auto it = copy.constBegin(); it != copy.constEnd(); ++it) {
+        qWarning() << "RealtimeSafety:" << it.value().count << "times"
+                   << violationName(it.value().violation) << "at";
+        logStackTrace(it.key());
+    }
+    s_bRecording = recording;
+}
+
+#ifdef MIXXX_REALTIME_SAFETY_HOOKS
+
+// The definitions below replace the ones of the C and C++ libraries in the
+// whole process, see the rtsafety option of build/features.py.
+
+#if defined(__GLIBC__)
+// The allocator of glibc is called directly, so the operator new and delete
+// of libstdc++ and the allocations of Qt are seen as well
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Allocation);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Allocation);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Allocation);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Allocation);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** pPtr, size_t alignment, size_t size) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Allocation);
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *pPtr = ptr;
+    return 0;
+}
+
+void free(void* ptr) {
+    if (ptr) {
+        RealtimeSafety::check(RealtimeSafety::Violation::Deallocation);
+    }
+    __libc_free(ptr);
+}
+} // extern "C"
+
+#else
+// Only the allocations of C++ code are seen, not the ones of Qt's
+// containers that use malloc() directly
+
+void* operator new(std::size_t size) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Allocation);
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr) {
+        RealtimeSafety::check(RealtimeSafety::Violation::Deallocation);
+    }
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    operator delete(ptr);
+}
+#endif
+
+#ifndef __WINDOWS__
+namespace {
+
+// Resolved on first use without a function static, whose guard may lock
+template <typename Function>
+Function nextFunction(std::atomic<Function>* pFunction, const char* name,
+                      const char* version = nullptr) {
+    Function function = pFunction->load(std::memory_order_relaxed);
+    if (!function) {
+#ifdef __GLIBC__
+        if (version) {
+            function = reinterpret_cast<Function>(
+                    dlvsym(RTLD_NEXT, name, version));
+        }
+#else
+        Q_UNUSED(version);
+#endif
+        if (!function) {
+            function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+        }
+        pFunction->store(function, std::memory_order_relaxed);
+    }
+    return function;
+}
+
+typedef int (*PthreadMutexLock)(pthread_mutex_t*);
+typedef int (*PthreadCondWait)(pthread_cond_t*, pthread_mutex_t*);
+typedef int (*PthreadCondTimedWait)(pthread_cond_t*, pthread_mutex_t*,
+                                    const struct timespec*);
+typedef int (*NanoSleep)(const struct timespec*, struct timespec*);
+typedef int (*USleep)(useconds_t);
+typedef unsigned int (*SleepFunction)(unsigned int);
+
+std::atomic<PthreadMutexLock> s_pthreadMutexLock(nullptr);
+std::atomic<PthreadCondWait> s_pthreadCondWait(nullptr);
+std::atomic<PthreadCondTimedWait> s_pthreadCondTimedWait(nullptr);
+std::atomic<NanoSleep> s_nanoSleep(nullptr);
+std::atomic<USleep> s_uSleep(nullptr);
+std::atomic<SleepFunction> s_sleep(nullptr);
+
+#if defined(__GLIBC__) && defined(__x86_64__)
+// The condition variables of LinuxThreads were replaced in glibc 2.3.2,
+// dlsym() returns the old ones
+const char* const kPthreadCondVersion = "GLIBC_2.3.2";
+#else
+const char* const kPthreadCondVersion = nullptr;
+#endif
+
+} // anonymous namespace
+
+extern "C" {
+int pthread_mutex_lock(pthread_mutex_t* pMutex) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Lock);
+    return nextFunction(&s_pthreadMutexLock, "pthread_mutex_lock")(pMutex);
+}
+
+int pthread_cond_wait(pthread_cond_t* pCond, pthread_mutex_t* pMutex) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Wait);
+    return nextFunction(&s_pthreadCondWait, "pthread_cond_wait",
+            kPthreadCondVersion)(pCond, pMutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* pCond, pthread_mutex_t* pMutex,
+                           const struct timespec* pTime) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Wait);
+    return nextFunction(&s_pthreadCondTimedWait, "pthread_cond_timedwait",
+            kPthreadCondVersion)(pCond, pMutex, pTime);
+}
+
+int nanosleep(const struct timespec* pRequest, struct timespec* pRemaining) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Sleep);
+    return nextFunction(&s_nanoSleep, "nanosleep")(pRequest, pRemaining);
+}
+
+int usleep(useconds_t micros) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Sleep);
+    return nextFunction(&s_uSleep, "usleep")(micros);
+}
+
+unsigned int sleep(unsigned int seconds) {
+    RealtimeSafety::check(RealtimeSafety::Violation::Sleep);
+    return nextFunction(&s_sleep, "sleep")(seconds);
+}
+} // extern "C"
+#endif // __WINDOWS__
+
+#endif // MIXXX_REALTIME_SAFETY_HOOKS
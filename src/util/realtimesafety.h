@@ -0,0 +1,85 @@
+#ifndef UTIL_REALTIMESAFETY_H
+#define UTIL_REALTIMESAFETY_H
+
+#include <atomic>
+
+#include <QString>
+#include <QtGlobal>
+
+// Detects calls that may block the audio callback thread, enabled by
+// --realtimeSafety. The engine marks the thread with a RealtimeThreadScope
+// while it renders a callback, and every violation on a marked thread is
+// counted and recorded with its stack trace. The first occurrence of each
+// stack trace is logged as a warning, logReport() lists all of them.
+//
+// The locks of util/mutex.h are always checked. Builds with rtsafety=1
+// also intercept malloc() and free() with their variants, blocking pthread
+// calls and the sleep functions, see realtimesafety.cpp. QMutex does not
+// lock through pthread on Linux, only its uses by way of MMutex are seen.
+//
+// The checks of threads that are not marked only cost a thread-local load.
+class RealtimeSafety {
+  public:
+    enum class Violation {
+        Allocation,
+        Deallocation,
+        Lock,
+        Wait,
+        Sleep,
+    };
+    static const int kViolationCount = static_cast<int>(Violation::Sleep) + 1;
+
+    static void setEnabled(bool enabled) {
+        s_bEnabled = enabled;
+    }
+    static bool isEnabled() {
+        return s_bEnabled;
+    }
+
+    static bool isRealtimeThread() {
+        return s_realtimeDepth > 0;
+    }
+
+    // Records the violation if the calling thread is marked
+    static inline void check(Violation violation) {
+        if (s_bEnabled && s_realtimeDepth > 0 && !s_bRecording) {
+            record(violation);
+        }
+    }
+
+    static qint64 count(Violation violation) {
+        return s_counts[static_cast<int>(violation)].load(
+                std::memory_order_relaxed);
+    }
+    // The sum of the counts of all violations
+    static qint64 totalCount();
+
+    static QString violationName(Violation violation);
+
+    // Logs the counts and the stack traces of all recorded violations
+    static void logReport();
+
+  private:
+    static void record(Violation violation);
+
+    friend class RealtimeThreadScope;
+
+    static bool s_bEnabled;
+    static thread_local int s_realtimeDepth;
+    // Suspends the checks while a violation is recorded, which allocates
+    static thread_local bool s_bRecording;
+    static std::atomic<qint64> s_counts[kViolationCount];
+};
+
+// Marks the calling thread as the audio callback thread while in scope
+class RealtimeThreadScope {
+  public:
+    RealtimeThreadScope() {
+        ++RealtimeSafety::s_realtimeDepth;
+    }
+    ~RealtimeThreadScope() {
+        --RealtimeSafety::s_realtimeDepth;
+    }
+};
+
+#endif // UTIL_REALTIMESAFETY_H
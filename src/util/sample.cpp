@@ -1,6 +1,7 @@
 #include <cstdlib>
 
 #include "util/sample.h"
+#include "util/samplekernels.h"
 #include "util/math.h"
 
 #ifdef __WINDOWS__
@@ -26,6 +27,249 @@ static inline bool useAlignedAlloc() {
             sizeof(CSAMPLE*) == sizeof(size_t));
 }
 
+namespace {
+
+// The scalar reference implementations of the SampleUtil kernels. They are
+// used on CPUs without any of the instruction sets of util/samplekernels_*.cpp
+// and rely on auto-vectorization.
+
+void applyRampingGainScalar(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN start_gain, CSAMPLE_GAIN gain_delta,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
+        // a loop counter i += 2 prevents vectorizing.
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+void copyWithRampingGainScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN start_gain, CSAMPLE_GAIN gain_delta,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED only with "int i"
+    for (int i = 0; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
+        pDest[i * 2] = pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+    }
+}
+
+void addWithRampingGainScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN start_gain, CSAMPLE_GAIN gain_delta,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+void copyClampBufferScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc, SINT iNumSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < iNumSamples; ++i) {
+        pDest[i] = SampleUtil::clampSample(pSrc[i]);
+    }
+}
+
+void interleaveBufferScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+void copyMonoToDualMonoScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc, SINT numFrames) {
+    // forward loop
+    // note: LOOP VECTORIZED
+    for (SINT i = 0; i < numFrames; ++i) {
+        const CSAMPLE s = pSrc[i];
+        pDest[i * 2] = s;
+        pDest[i * 2 + 1] = s;
+    }
+}
+
+void convertFloat32ToS16Scalar(SAMPLE* pDest, const CSAMPLE* pSrc,
+        SINT numSamples) {
+    DEBUG_ASSERT(-SAMPLE_MIN >= SAMPLE_MAX);
+    const CSAMPLE kConversionFactor = -SAMPLE_MIN;
+    // note: LOOP VECTORIZED only with "int i"
+    for (int i = 0; i < numSamples; ++i) {
+        pDest[i] = SAMPLE(pSrc[i] * kConversionFactor);
+    }
+}
+
+SampleUtil::CLIP_STATUS sumAbsPerChannelScalar(CSAMPLE* pfAbsL,
+        CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numFrames) {
+    CSAMPLE fAbsL = CSAMPLE_ZERO;
+    CSAMPLE fAbsR = CSAMPLE_ZERO;
+    CSAMPLE clippedL = 0;
+    CSAMPLE clippedR = 0;
+
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL += absl > CSAMPLE_PEAK ? 1 : 0;
+        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        // Replacing the code with a bool clipped will prevent vetorizing
+        clippedR += absr > CSAMPLE_PEAK ? 1 : 0;
+    }
+
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
+    if (clippedL > 0) {
+        clipping |= SampleUtil::CLIPPING_LEFT;
+    }
+    if (clippedR > 0) {
+        clipping |= SampleUtil::CLIPPING_RIGHT;
+    }
+    return clipping;
+}
+
+void maxAbsPerChannelScalar(CSAMPLE* pfMaxL, CSAMPLE* pfMaxR,
+        const CSAMPLE* pBuffer, SINT numFrames) {
+    CSAMPLE fMaxL = *pfMaxL;
+    CSAMPLE fMaxR = *pfMaxR;
+    for (SINT i = 0; i < numFrames; ++i) {
+        const CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fMaxL = absl > fMaxL ? absl : fMaxL;
+        const CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fMaxR = absr > fMaxR ? absr : fMaxR;
+    }
+    *pfMaxL = fMaxL;
+    *pfMaxR = fMaxR;
+}
+
+void levelsPerChannelScalar(SampleUtil::ChannelLevels* pLeft,
+        SampleUtil::ChannelLevels* pRight, const CSAMPLE* pBuffer,
+        SINT numFrames) {
+    CSAMPLE fAbsL = CSAMPLE_ZERO;
+    CSAMPLE fAbsR = CSAMPLE_ZERO;
+    CSAMPLE fSquaresL = CSAMPLE_ZERO;
+    CSAMPLE fSquaresR = CSAMPLE_ZERO;
+    CSAMPLE fPeakL = CSAMPLE_ZERO;
+    CSAMPLE fPeakR = CSAMPLE_ZERO;
+    for (SINT i = 0; i < numFrames; ++i) {
+        const CSAMPLE l = pBuffer[i * 2];
+        const CSAMPLE absl = fabs(l);
+        fAbsL += absl;
+        fSquaresL += l * l;
+        fPeakL = absl > fPeakL ? absl : fPeakL;
+        const CSAMPLE r = pBuffer[i * 2 + 1];
+        const CSAMPLE absr = fabs(r);
+        fAbsR += absr;
+        fSquaresR += r * r;
+        fPeakR = absr > fPeakR ? absr : fPeakR;
+    }
+    pLeft->sumAbs = fAbsL;
+    pLeft->sumSquares = fSquaresL;
+    pLeft->peak = fPeakL;
+    pRight->sumAbs = fAbsR;
+    pRight->sumSquares = fSquaresR;
+    pRight->peak = fPeakR;
+}
+
+const mixxx::SampleKernels kScalarKernels = {
+    SampleUtil::Kernel::Scalar,
+    applyRampingGainScalar,
+    copyWithRampingGainScalar,
+    addWithRampingGainScalar,
+    copyClampBufferScalar,
+    interleaveBufferScalar,
+    copyMonoToDualMonoScalar,
+    convertFloat32ToS16Scalar,
+    sumAbsPerChannelScalar,
+    maxAbsPerChannelScalar,
+    levelsPerChannelScalar,
+};
+
+const mixxx::SampleKernels* kernelsFor(SampleUtil::Kernel kernel) {
+    switch (kernel) {
+    case SampleUtil::Kernel::Scalar:
+        return &kScalarKernels;
+    case SampleUtil::Kernel::SSE2:
+        return mixxx::sampleKernelsSSE2();
+    case SampleUtil::Kernel::AVX2:
+        return mixxx::sampleKernelsAVX2();
+    case SampleUtil::Kernel::NEON:
+        return mixxx::sampleKernelsNEON();
+    }
+    return nullptr;
+}
+
+// Constant initialized, i.e. valid even for calls from static initializers
+// that run before the CPU detection below.
+const mixxx::SampleKernels* s_pKernels = &kScalarKernels;
+
+// Selects the best kernel for this CPU during static initialization.
+class KernelSelector {
+  public:
+    KernelSelector() {
+        const SampleUtil::Kernel kPreferred[] = {
+            SampleUtil::Kernel::AVX2,
+            SampleUtil::Kernel::SSE2,
+            SampleUtil::Kernel::NEON,
+        };
+        for (const auto kernel: kPreferred) {
+            if (SampleUtil::setKernel(kernel)) {
+                return;
+            }
+        }
+    }
+};
+
+const KernelSelector s_kernelSelector;
+
+} // anonymous namespace
+
+// static
+SampleUtil::Kernel SampleUtil::activeKernel() {
+    return s_pKernels->kernel;
+}
+
+// static
+bool SampleUtil::isKernelSupported(Kernel kernel) {
+    return kernelsFor(kernel) != nullptr;
+}
+
+// static
+bool SampleUtil::setKernel(Kernel kernel) {
+    const mixxx::SampleKernels* pKernels = kernelsFor(kernel);
+    if (pKernels == nullptr) {
+        return false;
+    }
+    s_pKernels = pKernels;
+    return true;
+}
+
+// static
+const char* SampleUtil::kernelName(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Scalar:
+        return "Scalar";
+    case Kernel::SSE2:
+        return "SSE2";
+    case Kernel::AVX2:
+        return "AVX2";
+    case Kernel::NEON:
+        return "NEON";
+    }
+    return "Unknown";
+}
+
 // static
 CSAMPLE* SampleUtil::alloc(SINT size) {
     // To speed up vectorization we align our sample buffers to 16-byte (128
@@ -120,13 +364,8 @@ void SampleUtil::applyRampingGain(CSAMPLE* pBuffer, CSAMPLE_GAIN old_gain,
             / CSAMPLE_GAIN(numSamples / 2);
     if (gain_delta) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            // a loop counter i += 2 prevents vectorizing.
-            pBuffer[i * 2] *= gain;
-            pBuffer[i * 2 + 1] *= gain;
-        }
+        s_pKernels->applyRampingGain(pBuffer, start_gain, gain_delta,
+                numSamples / 2);
     } else {
         // note: LOOP VECTORIZED.
         for (int i = 0; i < numSamples; ++i) {
@@ -170,7 +409,7 @@ void SampleUtil::applyRampingAlternatingGain(CSAMPLE* pBuffer,
         }
     } else {
         // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples; ++i) {
+        for (int i = 0; i < numSamples / 2; ++i) {
             pBuffer[i * 2] *= gain1Old;
         }
     }
@@ -186,7 +425,7 @@ void SampleUtil::applyRampingAlternatingGain(CSAMPLE* pBuffer,
         }
     } else {
         // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples; ++i) {
+        for (int i = 0; i < numSamples / 2; ++i) {
             pBuffer[i * 2 + 1] *= gain2Old;
         }
     }
@@ -228,12 +467,8 @@ void SampleUtil::addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
             / CSAMPLE_GAIN(numSamples / 2);
     if (gain_delta) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] += pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
-        }
+        s_pKernels->addWithRampingGain(pDest, pSrc, start_gain, gain_delta,
+                numSamples / 2);
     } else {
         // note: LOOP VECTORIZED.
         for (int i = 0; i < numSamples; ++i) {
@@ -321,12 +556,8 @@ void SampleUtil::copyWithRampingGain(CSAMPLE* M_RESTRICT pDest,
             / CSAMPLE_GAIN(numSamples / 2);
     if (gain_delta) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED only with "int i"
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] = pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
-        }
+        s_pKernels->copyWithRampingGain(pDest, pSrc, start_gain, gain_delta,
+                numSamples / 2);
     } else {
         // note: LOOP VECTORIZED.
         for (SINT i = 0; i < numSamples; ++i) {
@@ -356,64 +587,50 @@ void SampleUtil::convertS16ToFloat32(CSAMPLE* M_RESTRICT pDest,
 //static
 void SampleUtil::convertFloat32ToS16(SAMPLE* pDest, const CSAMPLE* pSrc,
         SINT numSamples) {
-    DEBUG_ASSERT(-SAMPLE_MIN >= SAMPLE_MAX);
-    const CSAMPLE kConversionFactor = -SAMPLE_MIN;
-    // note: LOOP VECTORIZED only with "int i"
-    for (int i = 0; i < numSamples; ++i) {
-        pDest[i] = SAMPLE(pSrc[i] * kConversionFactor);
-    }
+    s_pKernels->convertFloat32ToS16(pDest, pSrc, numSamples);
 }
 
 // static
 SampleUtil::CLIP_STATUS SampleUtil::sumAbsPerChannel(CSAMPLE* pfAbsL,
         CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numSamples) {
-    CSAMPLE fAbsL = CSAMPLE_ZERO;
-    CSAMPLE fAbsR = CSAMPLE_ZERO;
-    CSAMPLE clippedL = 0;
-    CSAMPLE clippedR = 0;
+    return s_pKernels->sumAbsPerChannel(pfAbsL, pfAbsR, pBuffer,
+            numSamples / 2);
+}
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples / 2; ++i) {
-        CSAMPLE absl = fabs(pBuffer[i * 2]);
-        fAbsL += absl;
-        clippedL += absl > CSAMPLE_PEAK ? 1 : 0;
-        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
-        fAbsR += absr;
-        // Replacing the code with a bool clipped will prevent vetorizing
-        clippedR += absr > CSAMPLE_PEAK ? 1 : 0;
-    }
+// static
+void SampleUtil::maxAbsPerChannel(CSAMPLE* pfMaxL, CSAMPLE* pfMaxR,
+        const CSAMPLE* pBuffer, SINT numSamples) {
+    s_pKernels->maxAbsPerChannel(pfMaxL, pfMaxR, pBuffer, numSamples / 2);
+}
 
-    *pfAbsL = fAbsL;
-    *pfAbsR = fAbsR;
-    SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
-    if (clippedL > 0) {
-        clipping |= SampleUtil::CLIPPING_LEFT;
-    }
-    if (clippedR > 0) {
-        clipping |= SampleUtil::CLIPPING_RIGHT;
+// static
+SampleUtil::CLIP_STATUS SampleUtil::levelsPerChannel(ChannelLevels* pLeft,
+        ChannelLevels* pRight, const CSAMPLE* pBuffer, SINT numSamples) {
+    s_pKernels->levelsPerChannel(pLeft, pRight, pBuffer, numSamples / 2);
+    // The peaks ignore NaN samples, just like the comparison with
+    // CSAMPLE_PEAK in sumAbsPerChannel()
+    CLIP_STATUS clipping = NO_CLIPPING;
+    if (pLeft->peak > CSAMPLE_PEAK) {
+        clipping |= CLIPPING_LEFT;
+    }
+    if (pRight->peak > CSAMPLE_PEAK) {
+        clipping |= CLIPPING_RIGHT;
     }
     return clipping;
 }
 
 // static
-void SampleUtil::copyClampBuffer(CSAMPLE* M_RESTRICT pDest,
-        const CSAMPLE* M_RESTRICT pSrc, SINT iNumSamples) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < iNumSamples; ++i) {
-        pDest[i] = clampSample(pSrc[i]);
-    }
+void SampleUtil::copyClampBuffer(CSAMPLE* pDest,
+        const CSAMPLE* pSrc, SINT iNumSamples) {
+    s_pKernels->copyClampBuffer(pDest, pSrc, iNumSamples);
 }
 
 // static
-void SampleUtil::interleaveBuffer(CSAMPLE* M_RESTRICT pDest,
-        const CSAMPLE* M_RESTRICT pSrc1,
-        const CSAMPLE* M_RESTRICT pSrc2,
+void SampleUtil::interleaveBuffer(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1,
+        const CSAMPLE* pSrc2,
         SINT numFrames) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numFrames; ++i) {
-        pDest[2 * i] = pSrc1[i];
-        pDest[2 * i + 1] = pSrc2[i];
-    }
+    s_pKernels->interleaveBuffer(pDest, pSrc1, pSrc2, numFrames);
 }
 
 // static
@@ -472,13 +689,7 @@ void SampleUtil::doubleMonoToDualMono(CSAMPLE* pBuffer, SINT numFrames) {
 // static
 void SampleUtil::copyMonoToDualMono(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc, SINT numFrames) {
-    // forward loop
-    // note: LOOP VECTORIZED
-    for (SINT i = 0; i < numFrames; ++i) {
-        const CSAMPLE s = pSrc[i];
-        pDest[i * 2] = s;
-        pDest[i * 2 + 1] = s;
-    }
+    s_pKernels->copyMonoToDualMono(pDest, pSrc, numFrames);
 }
 
 // static
@@ -520,6 +731,95 @@ void SampleUtil::copyMultiToStereo(
     }
 }
 
+namespace {
+
+// -3 dB for the center and surround channels
+const CSAMPLE kDownmixSideGain = 0.70710678f;
+
+// The number of channels is a template parameter, so the compiler can
+// unroll the matrix of each layout into the loop.
+template<int kChannels, typename DownmixFrame>
+inline void downmixToStereo(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc, SINT numFrames,
+        DownmixFrame downmixFrame) {
+    for (SINT i = 0; i < numFrames; ++i) {
+        downmixFrame(pDest + i * 2, pSrc + i * kChannels);
+    }
+}
+
+} // anonymous namespace
+
+// static
+void SampleUtil::copyDownmixToStereo(
+        CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        SINT numFrames,
+        int numChannels) {
+    DEBUG_ASSERT(numChannels > 2);
+    // Each output channel is normalized by the sum of its coefficients
+    switch (numChannels) {
+    case 3: {
+        // L R C
+        const CSAMPLE kGain = 1.0f / (1.0f + kDownmixSideGain);
+        downmixToStereo<3>(pDest, pSrc, numFrames,
+                [kGain](CSAMPLE* pOut, const CSAMPLE* pIn) {
+                    const CSAMPLE center = kDownmixSideGain * pIn[2];
+                    pOut[0] = kGain * (pIn[0] + center);
+                    pOut[1] = kGain * (pIn[1] + center);
+                });
+        return;
+    }
+    case 4: {
+        // L R Ls Rs
+        const CSAMPLE kGain = 1.0f / (1.0f + kDownmixSideGain);
+        downmixToStereo<4>(pDest, pSrc, numFrames,
+                [kGain](CSAMPLE* pOut, const CSAMPLE* pIn) {
+                    pOut[0] = kGain * (pIn[0] + kDownmixSideGain * pIn[2]);
+                    pOut[1] = kGain * (pIn[1] + kDownmixSideGain * pIn[3]);
+                });
+        return;
+    }
+    case 5: {
+        // L R C Ls Rs
+        const CSAMPLE kGain = 1.0f / (1.0f + 2.0f * kDownmixSideGain);
+        downmixToStereo<5>(pDest, pSrc, numFrames,
+                [kGain](CSAMPLE* pOut, const CSAMPLE* pIn) {
+                    const CSAMPLE center = kDownmixSideGain * pIn[2];
+                    pOut[0] = kGain * (pIn[0] + center + kDownmixSideGain * pIn[3]);
+                    pOut[1] = kGain * (pIn[1] + center + kDownmixSideGain * pIn[4]);
+                });
+        return;
+    }
+    case 6: {
+        // L R C LFE Ls Rs, the LFE channel is dropped
+        const CSAMPLE kGain = 1.0f / (1.0f + 2.0f * kDownmixSideGain);
+        downmixToStereo<6>(pDest, pSrc, numFrames,
+                [kGain](CSAMPLE* pOut, const CSAMPLE* pIn) {
+                    const CSAMPLE center = kDownmixSideGain * pIn[2];
+                    pOut[0] = kGain * (pIn[0] + center + kDownmixSideGain * pIn[4]);
+                    pOut[1] = kGain * (pIn[1] + center + kDownmixSideGain * pIn[5]);
+                });
+        return;
+    }
+    case 8: {
+        // L R C LFE Lb Rb Ls Rs, the LFE channel is dropped
+        const CSAMPLE kGain = 1.0f / (1.0f + 3.0f * kDownmixSideGain);
+        downmixToStereo<8>(pDest, pSrc, numFrames,
+                [kGain](CSAMPLE* pOut, const CSAMPLE* pIn) {
+                    const CSAMPLE center = kDownmixSideGain * pIn[2];
+                    pOut[0] = kGain * (pIn[0] + center +
+                            kDownmixSideGain * (pIn[4] + pIn[6]));
+                    pOut[1] = kGain * (pIn[1] + center +
+                            kDownmixSideGain * (pIn[5] + pIn[7]));
+                });
+        return;
+    }
+    default:
+        // Unknown layout
+        copyMultiToStereo(pDest, pSrc, numFrames, numChannels);
+        return;
+    }
+}
 
 // static
 void SampleUtil::reverse(CSAMPLE* pBuffer, SINT numSamples) {
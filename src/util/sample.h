@@ -21,6 +21,30 @@ class SampleUtil {
     };
     Q_DECLARE_FLAGS(CLIP_STATUS, CLIP_FLAG);
 
+    // The instruction set specific implementations of the hot functions
+    // in the audio callback path. The best kernel supported by the CPU is
+    // selected at startup. The others are mainly useful for tests and
+    // benchmarks.
+    enum class Kernel {
+        Scalar,
+        SSE2,
+        AVX2,
+        NEON,
+    };
+
+    // Returns the kernel that is currently used.
+    static Kernel activeKernel();
+
+    // Returns true if the kernel is compiled in and supported by this CPU.
+    static bool isKernelSupported(Kernel kernel);
+
+    // Switches to the given kernel. Returns false and keeps the active
+    // kernel if the kernel is not supported. Must not be called while the
+    // engine is running.
+    static bool setKernel(Kernel kernel);
+
+    static const char* kernelName(Kernel kernel);
+
     // The PlayPosition, Loops and Cue Points used in the Database and
     // Mixxx CO interface are expressed as a floating point number of stereo samples.
     // This is some legacy, we cannot easily revert.
@@ -202,6 +226,28 @@ class SampleUtil {
     static CLIP_STATUS sumAbsPerChannel(CSAMPLE* pfAbsL, CSAMPLE* pfAbsR,
             const CSAMPLE* pBuffer, SINT numSamples);
 
+    // For each pair of samples in pBuffer (l,r) -- raises pfMaxL to the
+    // absolute value of l and pfMaxR to the absolute value of r if they
+    // are greater, i.e. accumulates the peaks of both channels across
+    // several calls. NaN samples are ignored.
+    static void maxAbsPerChannel(CSAMPLE* pfMaxL, CSAMPLE* pfMaxR,
+            const CSAMPLE* pBuffer, SINT numSamples);
+
+    // The levels of one channel of a buffer, see levelsPerChannel()
+    struct ChannelLevels {
+        CSAMPLE sumAbs;
+        CSAMPLE sumSquares;
+        CSAMPLE peak;
+    };
+
+    // For each pair of samples in pBuffer (l,r) -- stores the sum of the
+    // absolute values, the sum of the squares and the peak absolute value
+    // of l in pLeft and of r in pRight, all in a single pass over the
+    // buffer. NaN samples are ignored for the peaks.
+    // The return value tells whether there is clipping in pBuffer or not.
+    static CLIP_STATUS levelsPerChannel(ChannelLevels* pLeft,
+            ChannelLevels* pRight, const CSAMPLE* pBuffer, SINT numSamples);
+
     // Copies every sample in pSrc to pDest, limiting the values in pDest
     // to the valid range of CSAMPLE. If pDest and pSrc are aliases, will
     // not copy will only clamp. Returns true if any samples in pSrc were
@@ -274,6 +320,17 @@ class SampleUtil {
     static void copyMultiToStereo(CSAMPLE* pDest, const CSAMPLE* pSrc,
             SINT numFrames, int numChannels);
 
+    // Copies and downmixes interleaved multi-channel sample data in pSrc
+    // with numChannels > 2 to stereo samples into pDest. The channels are
+    // expected in the order of WAVE files, i.e. L R C LFE Ls Rs for 5.1.
+    // Quadraphonic, 5.0, 5.1 and 7.1 are mixed with the center and surround
+    // channels at -3 dB and without the LFE channel, other layouts are
+    // stripped like copyMultiToStereo().
+    // pSrc must contain (numFrames * numChannels) samples
+    // (numFrames * 2) samples will be written into pDest
+    static void copyDownmixToStereo(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            SINT numFrames, int numChannels);
+
     // reverses stereo sample in place
     static void reverse(CSAMPLE* pBuffer, SINT numSamples);
 
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "util/sample.h"
+
+namespace mixxx {
+
+// Table of the instruction set specific implementations of the hot
+// SampleUtil functions. SampleUtil selects one of these tables at startup
+// depending on the features of the CPU we are running on and dispatches
+// through it. All implementations have to produce the same results as
+// the scalar reference implementations in util/sample.cpp (within the
+// precision of the floating point summation order).
+//
+// The ramping kernels are only invoked for the ramping case, i.e. after
+// SampleUtil has handled the trivial constant gain cases. They apply the
+// gain (startGain + gainDelta * i) to the frame i of a stereo buffer.
+struct SampleKernels {
+    SampleUtil::Kernel kernel;
+
+    void (*applyRampingGain)(CSAMPLE* pBuffer,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+            SINT numFrames);
+    void (*copyWithRampingGain)(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+            SINT numFrames);
+    void (*addWithRampingGain)(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+            SINT numFrames);
+    void (*copyClampBuffer)(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            SINT numSamples);
+    void (*interleaveBuffer)(CSAMPLE* pDest, const CSAMPLE* pSrc1,
+            const CSAMPLE* pSrc2, SINT numFrames);
+    void (*copyMonoToDualMono)(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            SINT numFrames);
+    void (*convertFloat32ToS16)(SAMPLE* pDest, const CSAMPLE* pSrc,
+            SINT numSamples);
+    SampleUtil::CLIP_STATUS (*sumAbsPerChannel)(CSAMPLE* pfAbsL,
+            CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numFrames);
+    void (*maxAbsPerChannel)(CSAMPLE* pfMaxL, CSAMPLE* pfMaxR,
+            const CSAMPLE* pBuffer, SINT numFrames);
+    void (*levelsPerChannel)(SampleUtil::ChannelLevels* pLeft,
+            SampleUtil::ChannelLevels* pRight, const CSAMPLE* pBuffer,
+            SINT numFrames);
+};
+
+// Each of these returns nullptr if the kernels are not compiled
+// into this binary or if they are not supported by the host CPU.
+const SampleKernels* sampleKernelsSSE2();
+const SampleKernels* sampleKernelsAVX2();
+const SampleKernels* sampleKernelsNEON();
+
+} // namespace mixxx
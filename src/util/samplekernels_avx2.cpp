@@ -0,0 +1,385 @@
+#include "util/samplekernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MIXXX_SAMPLEKERNELS_AVX2
+#endif
+
+#ifdef MIXXX_SAMPLEKERNELS_AVX2
+
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC allows intrinsics for all instruction sets without special
+// compiler flags.
+#define AVX2_TARGET
+#else
+// Only these functions are compiled for AVX2, the rest of Mixxx still
+// runs on any x64 CPU. The kernels are only selected if the CPU and
+// the OS support AVX2 at runtime.
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace {
+
+// Frame indices of a vector of 8 samples, i.e. four stereo frames.
+// See util/samplekernels_sse2.cpp
+AVX2_TARGET
+inline __m256 frameIndices() {
+    return _mm256_set_ps(3.0f, 3.0f, 2.0f, 2.0f, 1.0f, 1.0f, 0.0f, 0.0f);
+}
+
+AVX2_TARGET
+void applyRampingGainAVX2(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m256 start = _mm256_set1_ps(startGain);
+    const __m256 delta = _mm256_set1_ps(gainDelta);
+    const __m256 step = _mm256_set1_ps(4.0f);
+    __m256 index = frameIndices();
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m256 gain = _mm256_add_ps(start, _mm256_mul_ps(delta, index));
+        const __m256 samples = _mm256_loadu_ps(pBuffer + i * 2);
+        _mm256_storeu_ps(pBuffer + i * 2, _mm256_mul_ps(samples, gain));
+        index = _mm256_add_ps(index, step);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+AVX2_TARGET
+void copyWithRampingGainAVX2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m256 start = _mm256_set1_ps(startGain);
+    const __m256 delta = _mm256_set1_ps(gainDelta);
+    const __m256 step = _mm256_set1_ps(4.0f);
+    __m256 index = frameIndices();
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m256 gain = _mm256_add_ps(start, _mm256_mul_ps(delta, index));
+        const __m256 samples = _mm256_loadu_ps(pSrc + i * 2);
+        _mm256_storeu_ps(pDest + i * 2, _mm256_mul_ps(samples, gain));
+        index = _mm256_add_ps(index, step);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] = pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+    }
+}
+
+AVX2_TARGET
+void addWithRampingGainAVX2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m256 start = _mm256_set1_ps(startGain);
+    const __m256 delta = _mm256_set1_ps(gainDelta);
+    const __m256 step = _mm256_set1_ps(4.0f);
+    __m256 index = frameIndices();
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m256 gain = _mm256_add_ps(start, _mm256_mul_ps(delta, index));
+        const __m256 samples = _mm256_mul_ps(_mm256_loadu_ps(pSrc + i * 2), gain);
+        const __m256 dest = _mm256_loadu_ps(pDest + i * 2);
+        _mm256_storeu_ps(pDest + i * 2, _mm256_add_ps(dest, samples));
+        index = _mm256_add_ps(index, step);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+// pDest and pSrc may be aliases, each vector is loaded before it is stored.
+AVX2_TARGET
+void copyClampBufferAVX2(CSAMPLE* pDest, const CSAMPLE* pSrc,
+        SINT numSamples) {
+    const __m256 peak = _mm256_set1_ps(CSAMPLE_PEAK);
+    const __m256 negPeak = _mm256_set1_ps(-CSAMPLE_PEAK);
+    SINT i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m256 samples = _mm256_loadu_ps(pSrc + i);
+        _mm256_storeu_ps(pDest + i,
+                _mm256_max_ps(negPeak, _mm256_min_ps(peak, samples)));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = SampleUtil::clampSample(pSrc[i]);
+    }
+}
+
+AVX2_TARGET
+void interleaveBufferAVX2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        SINT numFrames) {
+    SINT i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m256 left = _mm256_loadu_ps(pSrc1 + i);
+        const __m256 right = _mm256_loadu_ps(pSrc2 + i);
+        // unpack works within the 128 bit lanes:
+        // lo = {L0 R0 L1 R1 | L4 R4 L5 R5}, hi = {L2 R2 L3 R3 | L6 R6 L7 R7}
+        const __m256 lo = _mm256_unpacklo_ps(left, right);
+        const __m256 hi = _mm256_unpackhi_ps(left, right);
+        _mm256_storeu_ps(pDest + i * 2, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(pDest + i * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    for (; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+AVX2_TARGET
+void copyMonoToDualMonoAVX2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc, SINT numFrames) {
+    SINT i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m256 mono = _mm256_loadu_ps(pSrc + i);
+        // Like interleaveBufferAVX2() with the same samples on both sides
+        const __m256 lo = _mm256_unpacklo_ps(mono, mono);
+        const __m256 hi = _mm256_unpackhi_ps(mono, mono);
+        _mm256_storeu_ps(pDest + i * 2, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(pDest + i * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    for (; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc[i];
+        pDest[2 * i + 1] = pSrc[i];
+    }
+}
+
+// Out of range samples saturate at SAMPLE_MIN/SAMPLE_MAX instead of
+// wrapping around.
+AVX2_TARGET
+void convertFloat32ToS16AVX2(SAMPLE* pDest, const CSAMPLE* pSrc,
+        SINT numSamples) {
+    const CSAMPLE kConversionFactor = -SAMPLE_MIN;
+    const __m256 factor = _mm256_set1_ps(kConversionFactor);
+    SINT i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        const __m256i lo = _mm256_cvttps_epi32(
+                _mm256_mul_ps(_mm256_loadu_ps(pSrc + i), factor));
+        const __m256i hi = _mm256_cvttps_epi32(
+                _mm256_mul_ps(_mm256_loadu_ps(pSrc + i + 8), factor));
+        // packs works within the 128 bit lanes, restore the order of the
+        // 64 bit blocks afterwards.
+        const __m256i packed = _mm256_permute4x64_epi64(
+                _mm256_packs_epi32(lo, hi), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDest + i), packed);
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = SAMPLE(pSrc[i] * kConversionFactor);
+    }
+}
+
+AVX2_TARGET
+SampleUtil::CLIP_STATUS sumAbsPerChannelAVX2(CSAMPLE* pfAbsL,
+        CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numFrames) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 peak = _mm256_set1_ps(CSAMPLE_PEAK);
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    __m256 clipped = _mm256_setzero_ps();
+    SINT i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m256 abs0 = _mm256_and_ps(
+                _mm256_loadu_ps(pBuffer + i * 2), absMask);
+        const __m256 abs1 = _mm256_and_ps(
+                _mm256_loadu_ps(pBuffer + i * 2 + 8), absMask);
+        sum0 = _mm256_add_ps(sum0, abs0);
+        sum1 = _mm256_add_ps(sum1, abs1);
+        clipped = _mm256_or_ps(clipped, _mm256_cmp_ps(abs0, peak, _CMP_GT_OQ));
+        clipped = _mm256_or_ps(clipped, _mm256_cmp_ps(abs1, peak, _CMP_GT_OQ));
+    }
+    // The vectors are ordered {L, R, L, R, L, R, L, R}
+    float sums[8];
+    _mm256_storeu_ps(sums, _mm256_add_ps(sum0, sum1));
+    const int clippedMask = _mm256_movemask_ps(clipped);
+    CSAMPLE fAbsL = (sums[0] + sums[2]) + (sums[4] + sums[6]);
+    CSAMPLE fAbsR = (sums[1] + sums[3]) + (sums[5] + sums[7]);
+    bool clippedL = (clippedMask & 0x55) != 0;
+    bool clippedR = (clippedMask & 0xAA) != 0;
+    for (; i < numFrames; ++i) {
+        const CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL |= absl > CSAMPLE_PEAK;
+        const CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        clippedR |= absr > CSAMPLE_PEAK;
+    }
+
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
+    if (clippedL) {
+        clipping |= SampleUtil::CLIPPING_LEFT;
+    }
+    if (clippedR) {
+        clipping |= SampleUtil::CLIPPING_RIGHT;
+    }
+    return clipping;
+}
+
+AVX2_TARGET
+void maxAbsPerChannelAVX2(CSAMPLE* pfMaxL, CSAMPLE* pfMaxR,
+        const CSAMPLE* pBuffer, SINT numFrames) {
+    // _mm256_max_ps(a, b) returns b if a is NaN, like the scalar comparison
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 max0 = _mm256_set_ps(*pfMaxR, *pfMaxL, *pfMaxR, *pfMaxL,
+            *pfMaxR, *pfMaxL, *pfMaxR, *pfMaxL);
+    __m256 max1 = max0;
+    SINT i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m256 abs0 = _mm256_and_ps(
+                _mm256_loadu_ps(pBuffer + i * 2), absMask);
+        const __m256 abs1 = _mm256_and_ps(
+                _mm256_loadu_ps(pBuffer + i * 2 + 8), absMask);
+        max0 = _mm256_max_ps(abs0, max0);
+        max1 = _mm256_max_ps(abs1, max1);
+    }
+    // The vectors are ordered {L, R, L, R, L, R, L, R}
+    float maxs[8];
+    _mm256_storeu_ps(maxs, _mm256_max_ps(max0, max1));
+    CSAMPLE fMaxL = std::max(std::max(maxs[0], maxs[2]),
+            std::max(maxs[4], maxs[6]));
+    CSAMPLE fMaxR = std::max(std::max(maxs[1], maxs[3]),
+            std::max(maxs[5], maxs[7]));
+    for (; i < numFrames; ++i) {
+        const CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fMaxL = absl > fMaxL ? absl : fMaxL;
+        const CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fMaxR = absr > fMaxR ? absr : fMaxR;
+    }
+    *pfMaxL = fMaxL;
+    *pfMaxR = fMaxR;
+}
+
+AVX2_TARGET
+void levelsPerChannelAVX2(SampleUtil::ChannelLevels* pLeft,
+        SampleUtil::ChannelLevels* pRight, const CSAMPLE* pBuffer,
+        SINT numFrames) {
+    // _mm256_max_ps(a, b) returns b if a is NaN, like the scalar comparison
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    __m256 squares0 = _mm256_setzero_ps();
+    __m256 squares1 = _mm256_setzero_ps();
+    __m256 max0 = _mm256_setzero_ps();
+    __m256 max1 = _mm256_setzero_ps();
+    SINT i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m256 samples0 = _mm256_loadu_ps(pBuffer + i * 2);
+        const __m256 samples1 = _mm256_loadu_ps(pBuffer + i * 2 + 8);
+        const __m256 abs0 = _mm256_and_ps(samples0, absMask);
+        const __m256 abs1 = _mm256_and_ps(samples1, absMask);
+        sum0 = _mm256_add_ps(sum0, abs0);
+        sum1 = _mm256_add_ps(sum1, abs1);
+        squares0 = _mm256_add_ps(squares0, _mm256_mul_ps(samples0, samples0));
+        squares1 = _mm256_add_ps(squares1, _mm256_mul_ps(samples1, samples1));
+        max0 = _mm256_max_ps(abs0, max0);
+        max1 = _mm256_max_ps(abs1, max1);
+    }
+    // The vectors are ordered {L, R, L, R, L, R, L, R}
+    float sums[8];
+    _mm256_storeu_ps(sums, _mm256_add_ps(sum0, sum1));
+    float squares[8];
+    _mm256_storeu_ps(squares, _mm256_add_ps(squares0, squares1));
+    float maxs[8];
+    _mm256_storeu_ps(maxs, _mm256_max_ps(max0, max1));
+    CSAMPLE fAbsL = (sums[0] + sums[2]) + (sums[4] + sums[6]);
+    CSAMPLE fAbsR = (sums[1] + sums[3]) + (sums[5] + sums[7]);
+    CSAMPLE fSquaresL = (squares[0] + squares[2]) + (squares[4] + squares[6]);
+    CSAMPLE fSquaresR = (squares[1] + squares[3]) + (squares[5] + squares[7]);
+    CSAMPLE fPeakL = std::max(std::max(maxs[0], maxs[2]),
+            std::max(maxs[4], maxs[6]));
+    CSAMPLE fPeakR = std::max(std::max(maxs[1], maxs[3]),
+            std::max(maxs[5], maxs[7]));
+    for (; i < numFrames; ++i) {
+        const CSAMPLE l = pBuffer[i * 2];
+        const CSAMPLE absl = fabs(l);
+        fAbsL += absl;
+        fSquaresL += l * l;
+        fPeakL = absl > fPeakL ? absl : fPeakL;
+        const CSAMPLE r = pBuffer[i * 2 + 1];
+        const CSAMPLE absr = fabs(r);
+        fAbsR += absr;
+        fSquaresR += r * r;
+        fPeakR = absr > fPeakR ? absr : fPeakR;
+    }
+    pLeft->sumAbs = fAbsL;
+    pLeft->sumSquares = fSquaresL;
+    pLeft->peak = fPeakL;
+    pRight->sumAbs = fAbsR;
+    pRight->sumSquares = fSquaresR;
+    pRight->peak = fPeakR;
+}
+
+bool cpuSupportsAVX2() {
+#ifdef _MSC_VER
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 0);
+    if (cpuInfo[0] < 7) {
+        return false;
+    }
+    __cpuid(cpuInfo, 1);
+    const bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+    const bool avx = (cpuInfo[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) {
+        return false;
+    }
+    // The OS has to save the YMM registers on context switches
+    if ((_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(cpuInfo, 7, 0);
+    return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+    // Also checks that the OS saves the YMM registers.
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+const mixxx::SampleKernels kAVX2Kernels = {
+    SampleUtil::Kernel::AVX2,
+    applyRampingGainAVX2,
+    copyWithRampingGainAVX2,
+    addWithRampingGainAVX2,
+    copyClampBufferAVX2,
+    interleaveBufferAVX2,
+    copyMonoToDualMonoAVX2,
+    convertFloat32ToS16AVX2,
+    sumAbsPerChannelAVX2,
+    maxAbsPerChannelAVX2,
+    levelsPerChannelAVX2,
+};
+
+} // anonymous namespace
+
+namespace mixxx {
+
+const SampleKernels* sampleKernelsAVX2() {
+    static const bool supported = cpuSupportsAVX2();
+    return supported ? &kAVX2Kernels : nullptr;
+}
+
+} // namespace mixxx
+
+#else // MIXXX_SAMPLEKERNELS_AVX2
+
+namespace mixxx {
+
+const SampleKernels* sampleKernelsAVX2() {
+    return nullptr;
+}
+
+} // namespace mixxx
+
+#endif // MIXXX_SAMPLEKERNELS_AVX2
@@ -0,0 +1,319 @@
+#include "util/samplekernels.h"
+
+// NEON is mandatory on AArch64. On 32 bit ARM the kernels are only
+// available if the whole build targets NEON, e.g. with -mfpu=neon.
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MIXXX_SAMPLEKERNELS_NEON
+#endif
+
+#ifdef MIXXX_SAMPLEKERNELS_NEON
+
+#include <arm_neon.h>
+
+namespace {
+
+// Frame indices of a vector of 4 samples, i.e. two stereo frames.
+// See util/samplekernels_sse2.cpp
+inline float32x4_t frameIndices() {
+    const float kIndices[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    return vld1q_f32(kIndices);
+}
+
+void applyRampingGainNEON(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const float32x4_t start = vdupq_n_f32(startGain);
+    const float32x4_t delta = vdupq_n_f32(gainDelta);
+    const float32x4_t step = vdupq_n_f32(2.0f);
+    float32x4_t index = frameIndices();
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        // No fused multiply-add, to get the same results as the scalar code
+        const float32x4_t gain = vaddq_f32(start, vmulq_f32(delta, index));
+        const float32x4_t samples = vld1q_f32(pBuffer + i * 2);
+        vst1q_f32(pBuffer + i * 2, vmulq_f32(samples, gain));
+        index = vaddq_f32(index, step);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+void copyWithRampingGainNEON(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const float32x4_t start = vdupq_n_f32(startGain);
+    const float32x4_t delta = vdupq_n_f32(gainDelta);
+    const float32x4_t step = vdupq_n_f32(2.0f);
+    float32x4_t index = frameIndices();
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const float32x4_t gain = vaddq_f32(start, vmulq_f32(delta, index));
+        const float32x4_t samples = vld1q_f32(pSrc + i * 2);
+        vst1q_f32(pDest + i * 2, vmulq_f32(samples, gain));
+        index = vaddq_f32(index, step);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] = pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+    }
+}
+
+void addWithRampingGainNEON(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const float32x4_t start = vdupq_n_f32(startGain);
+    const float32x4_t delta = vdupq_n_f32(gainDelta);
+    const float32x4_t step = vdupq_n_f32(2.0f);
+    float32x4_t index = frameIndices();
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const float32x4_t gain = vaddq_f32(start, vmulq_f32(delta, index));
+        const float32x4_t samples = vmulq_f32(vld1q_f32(pSrc + i * 2), gain);
+        const float32x4_t dest = vld1q_f32(pDest + i * 2);
+        vst1q_f32(pDest + i * 2, vaddq_f32(dest, samples));
+        index = vaddq_f32(index, step);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+// pDest and pSrc may be aliases, each vector is loaded before it is stored.
+void copyClampBufferNEON(CSAMPLE* pDest, const CSAMPLE* pSrc,
+        SINT numSamples) {
+    const float32x4_t peak = vdupq_n_f32(CSAMPLE_PEAK);
+    const float32x4_t negPeak = vdupq_n_f32(-CSAMPLE_PEAK);
+    SINT i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const float32x4_t samples = vld1q_f32(pSrc + i);
+        vst1q_f32(pDest + i, vmaxq_f32(negPeak, vminq_f32(peak, samples)));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = SampleUtil::clampSample(pSrc[i]);
+    }
+}
+
+void interleaveBufferNEON(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        SINT numFrames) {
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        float32x4x2_t frames;
+        frames.val[0] = vld1q_f32(pSrc1 + i);
+        frames.val[1] = vld1q_f32(pSrc2 + i);
+        vst2q_f32(pDest + i * 2, frames);
+    }
+    for (; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+void copyMonoToDualMonoNEON(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc, SINT numFrames) {
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        float32x4x2_t frames;
+        frames.val[0] = vld1q_f32(pSrc + i);
+        frames.val[1] = frames.val[0];
+        vst2q_f32(pDest + i * 2, frames);
+    }
+    for (; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc[i];
+        pDest[2 * i + 1] = pSrc[i];
+    }
+}
+
+// Out of range samples saturate at SAMPLE_MIN/SAMPLE_MAX instead of
+// wrapping around.
+void convertFloat32ToS16NEON(SAMPLE* pDest, const CSAMPLE* pSrc,
+        SINT numSamples) {
+    const CSAMPLE kConversionFactor = -SAMPLE_MIN;
+    const float32x4_t factor = vdupq_n_f32(kConversionFactor);
+    SINT i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        // vcvtq_s32_f32 truncates towards zero like the scalar cast
+        const int32x4_t lo = vcvtq_s32_f32(vmulq_f32(vld1q_f32(pSrc + i), factor));
+        const int32x4_t hi = vcvtq_s32_f32(vmulq_f32(vld1q_f32(pSrc + i + 4), factor));
+        vst1q_s16(pDest + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = SAMPLE(pSrc[i] * kConversionFactor);
+    }
+}
+
+SampleUtil::CLIP_STATUS sumAbsPerChannelNEON(CSAMPLE* pfAbsL,
+        CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numFrames) {
+    const float32x4_t peak = vdupq_n_f32(CSAMPLE_PEAK);
+    float32x4_t sum0 = vdupq_n_f32(0.0f);
+    float32x4_t sum1 = vdupq_n_f32(0.0f);
+    uint32x4_t clipped = vdupq_n_u32(0);
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const float32x4_t abs0 = vabsq_f32(vld1q_f32(pBuffer + i * 2));
+        const float32x4_t abs1 = vabsq_f32(vld1q_f32(pBuffer + i * 2 + 4));
+        sum0 = vaddq_f32(sum0, abs0);
+        sum1 = vaddq_f32(sum1, abs1);
+        clipped = vorrq_u32(clipped, vcgtq_f32(abs0, peak));
+        clipped = vorrq_u32(clipped, vcgtq_f32(abs1, peak));
+    }
+    // The vectors are ordered {L, R, L, R}
+    float sums[4];
+    vst1q_f32(sums, vaddq_f32(sum0, sum1));
+    uint32_t clippedLanes[4];
+    vst1q_u32(clippedLanes, clipped);
+    CSAMPLE fAbsL = sums[0] + sums[2];
+    CSAMPLE fAbsR = sums[1] + sums[3];
+    bool clippedL = (clippedLanes[0] | clippedLanes[2]) != 0;
+    bool clippedR = (clippedLanes[1] | clippedLanes[3]) != 0;
+    for (; i < numFrames; ++i) {
+        const CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL |= absl > CSAMPLE_PEAK;
+        const CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        clippedR |= absr > CSAMPLE_PEAK;
+    }
+
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
+    if (clippedL) {
+        clipping |= SampleUtil::CLIPPING_LEFT;
+    }
+    if (clippedR) {
+        clipping |= SampleUtil::CLIPPING_RIGHT;
+    }
+    return clipping;
+}
+
+void maxAbsPerChannelNEON(CSAMPLE* pfMaxL, CSAMPLE* pfMaxR,
+        const CSAMPLE* pBuffer, SINT numFrames) {
+    // vmaxq_f32() propagates NaN, so the lanes are selected by comparison
+    // like in the scalar code
+    const float initialMax[4] = { *pfMaxL, *pfMaxR, *pfMaxL, *pfMaxR };
+    float32x4_t max0 = vld1q_f32(initialMax);
+    float32x4_t max1 = max0;
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const float32x4_t abs0 = vabsq_f32(vld1q_f32(pBuffer + i * 2));
+        const float32x4_t abs1 = vabsq_f32(vld1q_f32(pBuffer + i * 2 + 4));
+        max0 = vbslq_f32(vcgtq_f32(abs0, max0), abs0, max0);
+        max1 = vbslq_f32(vcgtq_f32(abs1, max1), abs1, max1);
+    }
+    // The vectors are ordered {L, R, L, R}
+    float maxs[4];
+    vst1q_f32(maxs, vbslq_f32(vcgtq_f32(max0, max1), max0, max1));
+    CSAMPLE fMaxL = std::max(maxs[0], maxs[2]);
+    CSAMPLE fMaxR = std::max(maxs[1], maxs[3]);
+    for (; i < numFrames; ++i) {
+        const CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fMaxL = absl > fMaxL ? absl : fMaxL;
+        const CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fMaxR = absr > fMaxR ? absr : fMaxR;
+    }
+    *pfMaxL = fMaxL;
+    *pfMaxR = fMaxR;
+}
+
+void levelsPerChannelNEON(SampleUtil::ChannelLevels* pLeft,
+        SampleUtil::ChannelLevels* pRight, const CSAMPLE* pBuffer,
+        SINT numFrames) {
+    // vmaxq_f32() propagates NaN, so the lanes are selected by comparison
+    // like in the scalar code
+    float32x4_t sum0 = vdupq_n_f32(0.0f);
+    float32x4_t sum1 = vdupq_n_f32(0.0f);
+    float32x4_t squares0 = vdupq_n_f32(0.0f);
+    float32x4_t squares1 = vdupq_n_f32(0.0f);
+    float32x4_t max0 = vdupq_n_f32(0.0f);
+    float32x4_t max1 = vdupq_n_f32(0.0f);
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const float32x4_t samples0 = vld1q_f32(pBuffer + i * 2);
+        const float32x4_t samples1 = vld1q_f32(pBuffer + i * 2 + 4);
+        const float32x4_t abs0 = vabsq_f32(samples0);
+        const float32x4_t abs1 = vabsq_f32(samples1);
+        sum0 = vaddq_f32(sum0, abs0);
+        sum1 = vaddq_f32(sum1, abs1);
+        squares0 = vmlaq_f32(squares0, samples0, samples0);
+        squares1 = vmlaq_f32(squares1, samples1, samples1);
+        max0 = vbslq_f32(vcgtq_f32(abs0, max0), abs0, max0);
+        max1 = vbslq_f32(vcgtq_f32(abs1, max1), abs1, max1);
+    }
+    // The vectors are ordered {L, R, L, R}
+    float sums[4];
+    vst1q_f32(sums, vaddq_f32(sum0, sum1));
+    float squares[4];
+    vst1q_f32(squares, vaddq_f32(squares0, squares1));
+    float maxs[4];
+    vst1q_f32(maxs, vbslq_f32(vcgtq_f32(max0, max1), max0, max1));
+    CSAMPLE fAbsL = sums[0] + sums[2];
+    CSAMPLE fAbsR = sums[1] + sums[3];
+    CSAMPLE fSquaresL = squares[0] + squares[2];
+    CSAMPLE fSquaresR = squares[1] + squares[3];
+    CSAMPLE fPeakL = std::max(maxs[0], maxs[2]);
+    CSAMPLE fPeakR = std::max(maxs[1], maxs[3]);
+    for (; i < numFrames; ++i) {
+        const CSAMPLE l = pBuffer[i * 2];
+        const CSAMPLE absl = fabs(l);
+        fAbsL += absl;
+        fSquaresL += l * l;
+        fPeakL = absl > fPeakL ? absl : fPeakL;
+        const CSAMPLE r = pBuffer[i * 2 + 1];
+        const CSAMPLE absr = fabs(r);
+        fAbsR += absr;
+        fSquaresR += r * r;
+        fPeakR = absr > fPeakR ? absr : fPeakR;
+    }
+    pLeft->sumAbs = fAbsL;
+    pLeft->sumSquares = fSquaresL;
+    pLeft->peak = fPeakL;
+    pRight->sumAbs = fAbsR;
+    pRight->sumSquares = fSquaresR;
+    pRight->peak = fPeakR;
+}
+
+const mixxx::SampleKernels kNEONKernels = {
+    SampleUtil::Kernel::NEON,
+    applyRampingGainNEON,
+    copyWithRampingGainNEON,
+    addWithRampingGainNEON,
+    copyClampBufferNEON,
+    interleaveBufferNEON,
+    copyMonoToDualMonoNEON,
+    convertFloat32ToS16NEON,
+    sumAbsPerChannelNEON,
+    maxAbsPerChannelNEON,
+    levelsPerChannelNEON,
+};
+
+} // anonymous namespace
+
+namespace mixxx {
+
+const SampleKernels* sampleKernelsNEON() {
+    return &kNEONKernels;
+}
+
+} // namespace mixxx
+
+#else // MIXXX_SAMPLEKERNELS_NEON
+
+namespace mixxx {
+
+const SampleKernels* sampleKernelsNEON() {
+    return nullptr;
+}
+
+} // namespace mixxx
+
+#endif // MIXXX_SAMPLEKERNELS_NEON
@@ -0,0 +1,357 @@
+#include "util/samplekernels.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define MIXXX_SAMPLEKERNELS_SSE2
+#endif
+
+#ifdef MIXXX_SAMPLEKERNELS_SSE2
+
+#include <emmintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC allows intrinsics for all instruction sets without special
+// compiler flags.
+#define SSE2_TARGET
+#else
+// Allow the intrinsics even if the whole build does not target SSE2,
+// e.g. 32 bit builds with optimize=legacy. The kernels are only
+// selected if the CPU supports SSE2 at runtime.
+#define SSE2_TARGET __attribute__((target("sse2")))
+#endif
+
+namespace {
+
+// Gains of the two frames in a vector of 4 samples:
+// {g(i), g(i), g(i + 1), g(i + 1)} with g(i) = startGain + gainDelta * i.
+// The frame index is counted in floating point, which is exact for all
+// buffer sizes we use and yields the same results as the scalar code.
+SSE2_TARGET
+inline __m128 frameIndices() {
+    return _mm_set_ps(1.0f, 1.0f, 0.0f, 0.0f);
+}
+
+SSE2_TARGET
+void applyRampingGainSSE2(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m128 start = _mm_set1_ps(startGain);
+    const __m128 delta = _mm_set1_ps(gainDelta);
+    const __m128 step = _mm_set1_ps(2.0f);
+    __m128 index = frameIndices();
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const __m128 gain = _mm_add_ps(start, _mm_mul_ps(delta, index));
+        const __m128 samples = _mm_loadu_ps(pBuffer + i * 2);
+        _mm_storeu_ps(pBuffer + i * 2, _mm_mul_ps(samples, gain));
+        index = _mm_add_ps(index, step);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+SSE2_TARGET
+void copyWithRampingGainSSE2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m128 start = _mm_set1_ps(startGain);
+    const __m128 delta = _mm_set1_ps(gainDelta);
+    const __m128 step = _mm_set1_ps(2.0f);
+    __m128 index = frameIndices();
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const __m128 gain = _mm_add_ps(start, _mm_mul_ps(delta, index));
+        const __m128 samples = _mm_loadu_ps(pSrc + i * 2);
+        _mm_storeu_ps(pDest + i * 2, _mm_mul_ps(samples, gain));
+        index = _mm_add_ps(index, step);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] = pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+    }
+}
+
+SSE2_TARGET
+void addWithRampingGainSSE2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m128 start = _mm_set1_ps(startGain);
+    const __m128 delta = _mm_set1_ps(gainDelta);
+    const __m128 step = _mm_set1_ps(2.0f);
+    __m128 index = frameIndices();
+    SINT i = 0;
+    for (; i + 2 <= numFrames; i += 2) {
+        const __m128 gain = _mm_add_ps(start, _mm_mul_ps(delta, index));
+        const __m128 samples = _mm_mul_ps(_mm_loadu_ps(pSrc + i * 2), gain);
+        const __m128 dest = _mm_loadu_ps(pDest + i * 2);
+        _mm_storeu_ps(pDest + i * 2, _mm_add_ps(dest, samples));
+        index = _mm_add_ps(index, step);
+    }
+    for (; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+// pDest and pSrc may be aliases, each vector is loaded before it is stored.
+SSE2_TARGET
+void copyClampBufferSSE2(CSAMPLE* pDest, const CSAMPLE* pSrc,
+        SINT numSamples) {
+    const __m128 peak = _mm_set1_ps(CSAMPLE_PEAK);
+    const __m128 negPeak = _mm_set1_ps(-CSAMPLE_PEAK);
+    SINT i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const __m128 samples = _mm_loadu_ps(pSrc + i);
+        _mm_storeu_ps(pDest + i,
+                _mm_max_ps(negPeak, _mm_min_ps(peak, samples)));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = SampleUtil::clampSample(pSrc[i]);
+    }
+}
+
+SSE2_TARGET
+void interleaveBufferSSE2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        SINT numFrames) {
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m128 left = _mm_loadu_ps(pSrc1 + i);
+        const __m128 right = _mm_loadu_ps(pSrc2 + i);
+        _mm_storeu_ps(pDest + i * 2, _mm_unpacklo_ps(left, right));
+        _mm_storeu_ps(pDest + i * 2 + 4, _mm_unpackhi_ps(left, right));
+    }
+    for (; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+SSE2_TARGET
+void copyMonoToDualMonoSSE2(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc, SINT numFrames) {
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m128 mono = _mm_loadu_ps(pSrc + i);
+        _mm_storeu_ps(pDest + i * 2, _mm_unpacklo_ps(mono, mono));
+        _mm_storeu_ps(pDest + i * 2 + 4, _mm_unpackhi_ps(mono, mono));
+    }
+    for (; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc[i];
+        pDest[2 * i + 1] = pSrc[i];
+    }
+}
+
+// Out of range samples saturate at SAMPLE_MIN/SAMPLE_MAX instead of
+// wrapping around.
+SSE2_TARGET
+void convertFloat32ToS16SSE2(SAMPLE* pDest, const CSAMPLE* pSrc,
+        SINT numSamples) {
+    const CSAMPLE kConversionFactor = -SAMPLE_MIN;
+    const __m128 factor = _mm_set1_ps(kConversionFactor);
+    SINT i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m128i lo = _mm_cvttps_epi32(
+                _mm_mul_ps(_mm_loadu_ps(pSrc + i), factor));
+        const __m128i hi = _mm_cvttps_epi32(
+                _mm_mul_ps(_mm_loadu_ps(pSrc + i + 4), factor));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i),
+                _mm_packs_epi32(lo, hi));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = SAMPLE(pSrc[i] * kConversionFactor);
+    }
+}
+
+SSE2_TARGET
+SampleUtil::CLIP_STATUS sumAbsPerChannelSSE2(CSAMPLE* pfAbsL,
+        CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numFrames) {
+    // Summing two separate accumulators hides the latency of the adds.
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 peak = _mm_set1_ps(CSAMPLE_PEAK);
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    __m128 clipped = _mm_setzero_ps();
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m128 abs0 = _mm_and_ps(_mm_loadu_ps(pBuffer + i * 2), absMask);
+        const __m128 abs1 = _mm_and_ps(_mm_loadu_ps(pBuffer + i * 2 + 4), absMask);
+        sum0 = _mm_add_ps(sum0, abs0);
+        sum1 = _mm_add_ps(sum1, abs1);
+        clipped = _mm_or_ps(clipped, _mm_cmpgt_ps(abs0, peak));
+        clipped = _mm_or_ps(clipped, _mm_cmpgt_ps(abs1, peak));
+    }
+    // The vectors are ordered {L, R, L, R}
+    float sums[4];
+    _mm_storeu_ps(sums, _mm_add_ps(sum0, sum1));
+    const int clippedMask = _mm_movemask_ps(clipped);
+    CSAMPLE fAbsL = sums[0] + sums[2];
+    CSAMPLE fAbsR = sums[1] + sums[3];
+    bool clippedL = (clippedMask & 0x5) != 0;
+    bool clippedR = (clippedMask & 0xA) != 0;
+    for (; i < numFrames; ++i) {
+        const CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL |= absl > CSAMPLE_PEAK;
+        const CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        clippedR |= absr > CSAMPLE_PEAK;
+    }
+
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
+    if (clippedL) {
+        clipping |= SampleUtil::CLIPPING_LEFT;
+    }
+    if (clippedR) {
+        clipping |= SampleUtil::CLIPPING_RIGHT;
+    }
+    return clipping;
+}
+
+SSE2_TARGET
+void maxAbsPerChannelSSE2(CSAMPLE* pfMaxL, CSAMPLE* pfMaxR,
+        const CSAMPLE* pBuffer, SINT numFrames) {
+    // _mm_max_ps(a, b) returns b if a is NaN, like the scalar comparison
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 max0 = _mm_set_ps(*pfMaxR, *pfMaxL, *pfMaxR, *pfMaxL);
+    __m128 max1 = max0;
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m128 abs0 = _mm_and_ps(_mm_loadu_ps(pBuffer + i * 2), absMask);
+        const __m128 abs1 = _mm_and_ps(_mm_loadu_ps(pBuffer + i * 2 + 4), absMask);
+        max0 = _mm_max_ps(abs0, max0);
+        max1 = _mm_max_ps(abs1, max1);
+    }
+    // The vectors are ordered {L, R, L, R}
+    float maxs[4];
+    _mm_storeu_ps(maxs, _mm_max_ps(max0, max1));
+    CSAMPLE fMaxL = std::max(maxs[0], maxs[2]);
+    CSAMPLE fMaxR = std::max(maxs[1], maxs[3]);
+    for (; i < numFrames; ++i) {
+        const CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fMaxL = absl > fMaxL ? absl : fMaxL;
+        const CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fMaxR = absr > fMaxR ? absr : fMaxR;
+    }
+    *pfMaxL = fMaxL;
+    *pfMaxR = fMaxR;
+}
+
+SSE2_TARGET
+void levelsPerChannelSSE2(SampleUtil::ChannelLevels* pLeft,
+        SampleUtil::ChannelLevels* pRight, const CSAMPLE* pBuffer,
+        SINT numFrames) {
+    // _mm_max_ps(a, b) returns b if a is NaN, like the scalar comparison
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    __m128 squares0 = _mm_setzero_ps();
+    __m128 squares1 = _mm_setzero_ps();
+    __m128 max0 = _mm_setzero_ps();
+    __m128 max1 = _mm_setzero_ps();
+    SINT i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m128 samples0 = _mm_loadu_ps(pBuffer + i * 2);
+        const __m128 samples1 = _mm_loadu_ps(pBuffer + i * 2 + 4);
+        const __m128 abs0 = _mm_and_ps(samples0, absMask);
+        const __m128 abs1 = _mm_and_ps(samples1, absMask);
+        sum0 = _mm_add_ps(sum0, abs0);
+        sum1 = _mm_add_ps(sum1, abs1);
+        squares0 = _mm_add_ps(squares0, _mm_mul_ps(samples0, samples0));
+        squares1 = _mm_add_ps(squares1, _mm_mul_ps(samples1, samples1));
+        max0 = _mm_max_ps(abs0, max0);
+        max1 = _mm_max_ps(abs1, max1);
+    }
+    // The vectors are ordered {L, R, L, R}
+    float sums[4];
+    _mm_storeu_ps(sums, _mm_add_ps(sum0, sum1));
+    float squares[4];
+    _mm_storeu_ps(squares, _mm_add_ps(squares0, squares1));
+    float maxs[4];
+    _mm_storeu_ps(maxs, _mm_max_ps(max0, max1));
+    CSAMPLE fAbsL = sums[0] + sums[2];
+    CSAMPLE fAbsR = sums[1] + sums[3];
+    CSAMPLE fSquaresL = squares[0] + squares[2];
+    CSAMPLE fSquaresR = squares[1] + squares[3];
+    CSAMPLE fPeakL = std::max(maxs[0], maxs[2]);
+    CSAMPLE fPeakR = std::max(maxs[1], maxs[3]);
+    for (; i < numFrames; ++i) {
+        const CSAMPLE l = pBuffer[i * 2];
+        const CSAMPLE absl = fabs(l);
+        fAbsL += absl;
+        fSquaresL += l * l;
+        fPeakL = absl > fPeakL ? absl : fPeakL;
+        const CSAMPLE r = pBuffer[i * 2 + 1];
+        const CSAMPLE absr = fabs(r);
+        fAbsR += absr;
+        fSquaresR += r * r;
+        fPeakR = absr > fPeakR ? absr : fPeakR;
+    }
+    pLeft->sumAbs = fAbsL;
+    pLeft->sumSquares = fSquaresL;
+    pLeft->peak = fPeakL;
+    pRight->sumAbs = fAbsR;
+    pRight->sumSquares = fSquaresR;
+    pRight->peak = fPeakR;
+}
+
+bool cpuSupportsSSE2() {
+#if defined(__x86_64__) || defined(_M_X64)
+    // SSE2 is a core part of x64
+    return true;
+#elif defined(_MSC_VER)
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 1);
+    return (cpuInfo[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+const mixxx::SampleKernels kSSE2Kernels = {
+    SampleUtil::Kernel::SSE2,
+    applyRampingGainSSE2,
+    copyWithRampingGainSSE2,
+    addWithRampingGainSSE2,
+    copyClampBufferSSE2,
+    interleaveBufferSSE2,
+    copyMonoToDualMonoSSE2,
+    convertFloat32ToS16SSE2,
+    sumAbsPerChannelSSE2,
+    maxAbsPerChannelSSE2,
+    levelsPerChannelSSE2,
+};
+
+} // anonymous namespace
+
+namespace mixxx {
+
+const SampleKernels* sampleKernelsSSE2() {
+    static const bool supported = cpuSupportsSSE2();
+    return supported ? &kSSE2Kernels : nullptr;
+}
+
+} // namespace mixxx
+
+#else // MIXXX_SAMPLEKERNELS_SSE2
+
+namespace mixxx {
+
+const SampleKernels* sampleKernelsSSE2() {
+    return nullptr;
+}
+
+} // namespace mixxx
+
+#endif // MIXXX_SAMPLEKERNELS_SSE2
@@ -0,0 +1,214 @@
+#include "util/startupbenchmark.h"
+
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTextStream>
+#include <QtDebug>
+
+#if defined(__LINUX__)
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+#include "util/db/sqltransaction.h"
+#include "util/memoryaccounting.h"
+#include "util/time.h"
+#include "util/version.h"
+
+QList<StartupBenchmark::Record> StartupBenchmark::s_phases;
+QList<StartupBenchmark::Record> StartupBenchmark::s_milestones;
+
+namespace {
+
+const char* const kGenres[] = {
+    "House", "Techno", "Drum & Bass", "Hip Hop", "Pop", "Rock", "Jazz",
+    "Disco", "Trance", "Dubstep", "Funk", "Soul",
+};
+const int kGenreCount = sizeof(kGenres) / sizeof(kGenres[0]);
+
+QString escapeJson(QString text) {
+    return text.replace('\\', "\\\\").replace('"', "\\\"");
+}
+
+QString millis(mixxx::Duration duration) {
+    return QString::number(duration.toDoubleMillis(), 'f', 3);
+}
+
+} // anonymous namespace
+
+// static
+void StartupBenchmark::recordPhase(const QString& phase,
+                                   mixxx::Duration duration) {
+    Record record;
+    record.name = phase;
+    record.duration = duration;
+    record.elapsed = mixxx::Time::elapsed();
+    record.residentBytes = residentBytes();
+    record.timedOut = false;
+    s_phases.append(record);
+}
+
+// static
+void StartupBenchmark::recordMilestone(const QString& name,
+                                       mixxx::Duration duration,
+                                       bool timedOut) {
+    Record record;
+    record.name = name;
+    record.duration = duration;
+    record.elapsed = mixxx::Time::elapsed();
+    record.residentBytes = residentBytes();
+    for (int i = 0; i < MemoryAccounting::kCategoryCount; ++i) {
+        record.accountedBytes.append(MemoryAccounting::bytes(
+                static_cast<MemoryAccounting::Category>(i)));
+    }
+    record.timedOut = timedOut;
+    s_milestones.append(record);
+    qDebug() << "Startup benchmark:" << name << "after"
+             << duration.debugMillisWithUnit() << "with"
+             << record.residentBytes / (1024 * 1024) << "MiB resident";
+}
+
+// static
+int StartupBenchmark::generateLibrary(QSqlDatabase database, int numTracks) {
+    QSqlQuery countQuery("SELECT COUNT(*) FROM library", database);
+    if (!countQuery.next() || countQuery.value(0).toInt() > 0) {
+        return 0;
+    }
+
+    SqlTransaction transaction(database);
+    QSqlQuery locationQuery(database);
+    locationQuery.prepare("INSERT INTO track_locations "
+            "(location, filename, directory, filesize, fs_deleted, "
+            "needs_verification) VALUES (?, ?, ?, ?, 0, 0)");
+    QSqlQuery trackQuery(database);
+    trackQuery.prepare("INSERT INTO library "
+            "(artist, title, album, year, genre, tracknumber, location, "
+            "duration, bitrate, samplerate, bpm, filetype, mixxx_deleted) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, 'mp3', 0)");
+
+    // The same library for every run, about 10 tracks per album and 5
+    // albums per artist
+    for (int i = 0; i < numTracks; ++i) {
+        const QString artist = QString("Artist %1").arg(i / 50);
+        const QString album = QString("Album %1").arg(i / 10);
+        const QString fileName = QString("%1 - Track %2.mp3").arg(
+                QString::number(i % 10 + 1), QString::number(i));
+        const QString directory = QString("/startupbenchmark/%1/%2").arg(
+                artist, album);
+
+        locationQuery.addBindValue(directory + "/" + fileName);
+        locationQuery.addBindValue(fileName);
+        locationQuery.addBindValue(directory);
+        locationQuery.addBindValue(8000000 + (i * 7919) % 4000000);
+        if (!locationQuery.exec()) {
+            qWarning() << "Failed to generate the library:"
+                       << locationQuery.lastError();
+            return i;
+        }
+
+        trackQuery.addBindValue(artist);
+        trackQuery.addBindValue(QString("Track %1").arg(i));
+        trackQuery.addBindValue(album);
+        trackQuery.addBindValue(QString::number(1980 + (i / 10) % 40));
+        trackQuery.addBindValue(kGenres[(i / 10) % kGenreCount]);
+        trackQuery.addBindValue(QString::number(i % 10 + 1));
+        trackQuery.addBindValue(locationQuery.lastInsertId());
+        trackQuery.addBindValue(180 + (i * 31) % 300);
+        trackQuery.addBindValue(320);
+        trackQuery.addBindValue(44100);
+        trackQuery.addBindValue(90.0 + (i * 13) % 90);
+        if (!trackQuery.exec()) {
+            qWarning() << "Failed to generate the library:"
+                       << trackQuery.lastError();
+            return i;
+        }
+    }
+    transaction.commit();
+    return numTracks;
+}
+
+// static
+qint64 StartupBenchmark::residentBytes() {
+#if defined(__LINUX__)
+    // The second field is the resident set size in pages
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+    bool ok = false;
+    const qint64 pages = fields[1].toLongLong(&ok);
+    return ok ? pages * sysconf(_SC_PAGESIZE) : -1;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+            reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return -1;
+    }
+    return info.resident_size;
+#else
+    return -1;
+#endif
+}
+
+// static
+bool StartupBenchmark::write(const QString& path) {
+    QFile file;
+    bool opened;
+    if (path == "-") {
+        opened = file.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    } else {
+        file.setFileName(path);
+        opened = file.open(QIODevice::WriteOnly | QIODevice::Text);
+    }
+    if (!opened) {
+        qWarning() << "Could not open the startup benchmark results for writing:"
+                   << path;
+        return false;
+    }
+
+    const CmdlineArgs& args = CmdlineArgs::Instance();
+    QTextStream out(&file);
+    out << "{\n"
+        << "\"version\":\"" << escapeJson(Version::version()) << "\",\n"
+        << "\"revision\":\"" << escapeJson(Version::developmentRevision()) << "\",\n"
+        << "\"skin\":\"" << escapeJson(args.getSkin()) << "\",\n"
+        << "\"tracks\":" << args.getStartupBenchmarkTracks() << ",\n"
+        << "\"phases\":[";
+    for (int i = 0; i < s_phases.size(); ++i) {
+        const Record& phase = s_phases[i];
+        out << (i > 0 ? ",\n" : "\n")
+            << "{\"name\":\"" << escapeJson(phase.name)
+            << "\",\"durationMs\":" << millis(phase.duration)
+            << ",\"elapsedMs\":" << millis(phase.elapsed)
+            << ",\"residentBytes\":" << phase.residentBytes << "}";
+    }
+    out << "],\n\"milestones\":[";
+    for (int i = 0; i < s_milestones.size(); ++i) {
+        const Record& milestone = s_milestones[i];
+        out << (i > 0 ? ",\n" : "\n")
+            << "{\"name\":\"" << escapeJson(milestone.name)
+            << "\",\"durationMs\":" << millis(milestone.duration)
+            << ",\"elapsedMs\":" << millis(milestone.elapsed)
+            << ",\"timedOut\":" << (milestone.timedOut ? "true" : "false")
+            << ",\"residentBytes\":" << milestone.residentBytes
+            << ",\"accountedBytes\":{";
+        for (int j = 0; j < milestone.accountedBytes.size(); ++j) {
+            out << (j > 0 ? "," : "") << "\""
+                << MemoryAccounting::categoryName(
+                        static_cast<MemoryAccounting::Category>(j))
+                << "\":" << milestone.accountedBytes[j];
+        }
+        out << "}}";
+    }
+    out << "]\n}\n";
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
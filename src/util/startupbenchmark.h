@@ -0,0 +1,62 @@
+#ifndef UTIL_STARTUPBENCHMARK_H
+#define UTIL_STARTUPBENCHMARK_H
+
+#include <QList>
+#include <QString>
+
+#include "util/cmdlineargs.h"
+#include "util/duration.h"
+
+class QSqlDatabase;
+
+// Records the startup of Mixxx for --startupBenchmark: the duration of the
+// phases of the startup as traced by PhaseTrace and the resident memory
+// after them and after the milestones of the benchmark, i.e. after the
+// startup, after loading the decks and after a library scan. The results
+// are written as JSON to compare builds with each other.
+//
+// All functions must be called from the main thread.
+class StartupBenchmark {
+  public:
+    static bool isEnabled() {
+        return CmdlineArgs::Instance().getStartupBenchmarkEnabled();
+    }
+
+    // Called by PhaseTrace when a phase of the startup ends
+    static void recordPhase(const QString& phase, mixxx::Duration duration);
+    // Records the end of a step of the benchmark that took duration, e.g.
+    // "decks" after all decks have loaded their tracks. A step that has
+    // timed out is recorded with its timeout.
+    static void recordMilestone(const QString& name, mixxx::Duration duration,
+                                bool timedOut = false);
+
+    // Inserts the given number of tracks into the library of database,
+    // with generated metadata and locations of files that do not exist.
+    // A library that already has tracks is left as it is, e.g. by an
+    // earlier run with the same settings. Returns the number of tracks
+    // that have been inserted.
+    static int generateLibrary(QSqlDatabase database, int numTracks);
+
+    // The resident set size of the process in bytes, -1 if unknown
+    static qint64 residentBytes();
+
+    // Writes the results to path, to the standard output for "-"
+    static bool write(const QString& path);
+
+  private:
+    struct Record {
+        QString name;
+        mixxx::Duration duration;
+        // Since Mixxx has been started
+        mixxx::Duration elapsed;
+        qint64 residentBytes;
+        // Of each category of MemoryAccounting, only for the milestones
+        QList<qint64> accountedBytes;
+        bool timedOut;
+    };
+
+    static QList<Record> s_phases;
+    static QList<Record> s_milestones;
+};
+
+#endif /* UTIL_STARTUPBENCHMARK_H */
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <limits>
 
 #include <QStringList>
@@ -65,11 +66,23 @@ void Stat::processReport(const StatReport& report) {
         m_histogram[report.value] += 1.0;
     }
 
-    if (m_compute & Stat::VALUES) {
+    if (m_compute & (Stat::VALUES | Stat::PERCENTILES)) {
         m_values.push_back(report.value);
     }
 }
 
+double Stat::percentile(double fraction) const {
+    if (m_values.isEmpty()) {
+        return 0.0;
+    }
+    QVector<double> values = m_values;
+    const int index = math_clamp(
+            static_cast<int>(ceil(fraction * values.size())) - 1,
+            0, values.size() - 1);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
 QDebug operator<<(QDebug dbg, const Stat &stat) {
     QStringList stats;
     if (stat.m_compute & Stat::COUNT) {
@@ -122,6 +135,11 @@ QDebug operator<<(QDebug dbg, const Stat &stat) {
         // TODO(rryan): implement
     }
 
+    if (stat.m_compute & Stat::PERCENTILES) {
+        stats << "median=" + QString::number(stat.percentile(0.5)) + stat.valueUnits();
+        stats << "p99=" + QString::number(stat.percentile(0.99)) + stat.valueUnits();
+    }
+
     if (stat.m_compute & Stat::HISTOGRAM) {
         QStringList histogram;
         for (QMap<double, double>::const_iterator it = stat.m_histogram.begin();
@@ -74,6 +74,9 @@ class Stat {
         STATS_EXPERIMENT  = 0x0800,
         // Used for marking stats recorded in BASE mode.
         STATS_BASE        = 0x1000,
+        // The median and the 99th percentile. O(1) in time, O(n) in space
+        // where n is the # of reports. Use carefully!
+        PERCENTILES       = 0x2000,
     };
     typedef int ComputeFlags;
 
@@ -106,6 +109,10 @@ class Stat {
         return m_report_count > 1 ? m_variance_sk / (m_report_count - 1) : 0.0;
     }
 
+    // The value below which the fraction of the reports lies, e.g. 0.99,
+    // or 0 without reports. Needs the VALUES or PERCENTILES flag.
+    double percentile(double fraction) const;
+
     QString m_tag;
     StatType m_type;
     ComputeFlags m_compute;
@@ -1,8 +1,10 @@
 #include <QtDebug>
+#include <QCoreApplication>
 #include <QMutexLocker>
 #include <QTextStream>
 #include <QFile>
 #include <QMetaType>
+#include <QSaveFile>
 
 #include "util/statsmanager.h"
 #include "util/compatibility.h"
@@ -11,13 +13,19 @@
 // In practice we process stats pipes about once a minute @1ms latency.
 const int kStatsPipeSize = 1 << 10;
 const int kProcessLength = kStatsPipeSize * 4 / 5;
+// The number of reports that are taken from a pipe at once
+const int kReadBatchSize = 64;
+// The interval of writing the metrics file, which is read by the monitoring
+// independently
+const int kMetricsIntervalMillis = 10000;
 
 // static
 bool StatsManager::s_bStatsManagerEnabled = false;
 
-StatsPipe::StatsPipe(StatsManager* pManager)
+StatsPipe::StatsPipe(StatsManager* pManager, int threadId)
         : FIFO<StatReport>(kStatsPipeSize),
-          m_pManager(pManager) {
+          m_pManager(pManager),
+          m_threadId(threadId) {
     qRegisterMetaType<Stat>("Stat");
 }
 
@@ -39,7 +47,7 @@ StatsManager::StatsManager()
 StatsManager::~StatsManager() {
     s_bStatsManagerEnabled = false;
     m_quit = 1;
-    m_statsPipeCondition.wakeAll();
+    m_statsPipeWakeup.wake();
     wait();
     qDebug() << "StatsManager shutdown report:";
     qDebug() << "=====================================";
@@ -74,6 +82,9 @@ StatsManager::~StatsManager() {
     if (CmdlineArgs::Instance().getTimelineEnabled()) {
         writeTimeline(CmdlineArgs::Instance().getTimelinePath());
     }
+    if (CmdlineArgs::Instance().getMetricsEnabled()) {
+        writeMetrics(CmdlineArgs::Instance().getMetricsPath());
+    }
 }
 
 class OrderByTime {
@@ -102,6 +113,31 @@ QString humanizeNanos(qint64 nanos) {
     return QString("%1ns").arg(QString::number(nanos));
 }
 
+namespace {
+
+QString escapeJson(const QString& string) {
+    QString escaped;
+    escaped.reserve(string.size());
+    for (const QChar& c : string) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c.unicode() < 0x20) {
+            escaped += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// The trace timestamps are microseconds
+QString traceTimestamp(const mixxx::Duration& time) {
+    return QString::number(time.toIntegerNanos() / 1000.0, 'f', 3);
+}
+
+} // anonymous namespace
+
 void StatsManager::writeTimeline(const QString& filename) {
     QFile timeline(filename);
     if (!timeline.open(QIODevice::WriteOnly | QIODevice::Text)) {
@@ -116,7 +152,14 @@ void StatsManager::writeTimeline(const QString& filename) {
     }
 
     // Sort by time.
-    qSort(m_events.begin(), m_events.end(), OrderByTime());
+    qStableSort(m_events.begin(), m_events.end(), OrderByTime());
+
+    QTextStream out(&timeline);
+    if (filename.endsWith(".json", Qt::CaseInsensitive)) {
+        writeTraceEvents(&out);
+        timeline.close();
+        return;
+    }
 
     mixxx::Duration last_time = m_events[0].m_time;
 
@@ -124,7 +167,6 @@ void StatsManager::writeTimeline(const QString& filename) {
     QMap<QString, qint64> endTimes;
     QMap<QString, Stat> tagStats;
 
-    QTextStream out(&timeline);
     foreach (const Event& event, m_events) {
         qint64 last_start = startTimes.value(event.m_tag, -1);
         qint64 last_end = endTimes.value(event.m_tag, -1);
@@ -162,6 +204,80 @@ void StatsManager::writeTimeline(const QString& filename) {
     timeline.close();
 }
 
+void StatsManager::writeTraceEvents(QTextStream* pOut) {
+    QTextStream& out = *pOut;
+    const QString pid = QString::number(QCoreApplication::applicationPid());
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    QMutexLocker locker(&m_statsPipeLock);
+    const QList<QString> threadNames = m_threadNames;
+    locker.unlock();
+    for (int i = 0; i < threadNames.size(); ++i) {
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":" << i
+            << ",\"args\":{\"name\":\"" << escapeJson(threadNames[i]) << "\"}},\n";
+        out << "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":" << i
+            << ",\"args\":{\"sort_index\":" << i << "}},\n";
+    }
+
+    // Counters are shown with their total
+    QMap<QString, double> counterValues;
+    bool first = true;
+    foreach (const Event& event, m_events) {
+        QString phase;
+        QString args;
+        switch (event.m_type) {
+        case Stat::EVENT_START:
+            phase = "B";
+            break;
+        case Stat::EVENT_END:
+            phase = "E";
+            break;
+        case Stat::COUNTER: {
+            phase = "C";
+            double& value = counterValues[event.m_tag];
+            value += event.m_value;
+            args = QString(",\"args\":{\"value\":%1}").arg(value);
+            break;
+        }
+        default:
+            // An instant event of its thread
+            phase = "i";
+            args = ",\"s\":\"t\"";
+            break;
+        }
+        if (!first) {
+            out << ",\n";
+        }
+        first = false;
+        out << "{\"name\":\"" << escapeJson(event.m_tag)
+            << "\",\"ph\":\"" << phase
+            << "\",\"ts\":" << traceTimestamp(event.m_time)
+            << ",\"pid\":" << pid
+            << ",\"tid\":" << event.m_threadId
+            << args << "}";
+    }
+    out << "\n]}\n";
+}
+
+void StatsManager::writeMetrics(const QString& filename) {
+    // The monitoring never reads a partially written file
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Could not open metrics file for writing:"
+                   << file.fileName();
+        return;
+    }
+    QTextStream out(&file);
+    m_metrics.write(&out);
+    out.flush();
+    if (!file.commit()) {
+        qWarning() << "Could not write metrics file:" << file.fileName()
+                   << file.errorString();
+    }
+}
+
 void StatsManager::onStatsPipeDestroyed(StatsPipe* pPipe) {
     QMutexLocker locker(&m_statsPipeLock);
     processIncomingStatReports();
@@ -172,10 +288,22 @@ StatsPipe* StatsManager::getStatsPipeForThread() {
     if (m_threadStatsPipes.hasLocalData()) {
         return m_threadStatsPipes.localData();
     }
-    StatsPipe* pResult = new StatsPipe(this);
-    m_threadStatsPipes.setLocalData(pResult);
+    QThread* pThread = QThread::currentThread();
+    QString threadName = pThread->objectName();
+    if (QCoreApplication::instance() &&
+            pThread == QCoreApplication::instance()->thread()) {
+        threadName = "Main";
+    }
     QMutexLocker locker(&m_statsPipeLock);
+    const int threadId = m_threadNames.size();
+    if (threadName.isEmpty()) {
+        threadName = QString("Thread %1").arg(threadId);
+    }
+    m_threadNames.append(threadName);
+    StatsPipe* pResult = new StatsPipe(this, threadId);
     m_statsPipes.push_back(pResult);
+    locker.unlock();
+    m_threadStatsPipes.setLocalData(pResult);
     return pResult;
 }
 
@@ -187,7 +315,7 @@ bool StatsManager::maybeWriteReport(const StatReport& report) {
     bool success = pStatsPipe->write(&report, 1) == 1;
     int space = pStatsPipe->writeAvailable();
     if (space < kProcessLength) {
-        m_statsPipeCondition.wakeAll();
+        m_statsPipeWakeup.wake();
     }
     static bool warnedAboutOverflow = false;
     if (!success && !warnedAboutOverflow) {
@@ -199,56 +327,77 @@ bool StatsManager::maybeWriteReport(const StatReport& report) {
 }
 
 void StatsManager::processIncomingStatReports() {
-    StatReport report;
+    StatReport reports[kReadBatchSize];
     foreach (StatsPipe* pStatsPipe, m_statsPipes) {
-        while (pStatsPipe->read(&report, 1) == 1) {
-            QString tag = QString::fromUtf8(report.tag);
-            Stat& info = m_stats[tag];
-            info.m_tag = tag;
-            info.m_type = report.type;
-            info.m_compute = report.compute;
-            info.processReport(report);
-            emit(statUpdated(info));
-
-            if (report.compute & Stat::STATS_EXPERIMENT) {
-                Stat& experiment = m_experimentStats[tag];
-                experiment.m_tag = tag;
-                experiment.m_type = report.type;
-                experiment.m_compute = report.compute;
-                experiment.processReport(report);
-            } else if (report.compute & Stat::STATS_BASE) {
-                Stat& base = m_baseStats[tag];
-                base.m_tag = tag;
-                base.m_type = report.type;
-                base.m_compute = report.compute;
-                base.processReport(report);
-            }
-
-            if (CmdlineArgs::Instance().getTimelineEnabled() &&
-                    (report.type == Stat::EVENT ||
-                     report.type == Stat::EVENT_START ||
-                     report.type == Stat::EVENT_END)) {
-                Event event;
-                event.m_tag = tag;
-                event.m_type = report.type;
-                event.m_time = mixxx::Duration::fromNanos(report.time);
-                m_events.append(event);
+        int count;
+        while ((count = pStatsPipe->read(reports, kReadBatchSize)) > 0) {
+            for (int i = 0; i < count; ++i) {
+                const StatReport& report = reports[i];
+                QString tag = QString::fromUtf8(report.tag);
+                Stat& info = m_stats[tag];
+                info.m_tag = tag;
+                info.m_type = report.type;
+                info.m_compute = report.compute;
+                info.processReport(report);
+                emit(statUpdated(info));
+
+                if (report.compute & Stat::STATS_EXPERIMENT) {
+                    Stat& experiment = m_experimentStats[tag];
+                    experiment.m_tag = tag;
+                    experiment.m_type = report.type;
+                    experiment.m_compute = report.compute;
+                    experiment.processReport(report);
+                } else if (report.compute & Stat::STATS_BASE) {
+                    Stat& base = m_baseStats[tag];
+                    base.m_tag = tag;
+                    base.m_type = report.type;
+                    base.m_compute = report.compute;
+                    base.processReport(report);
+                }
+
+                if (CmdlineArgs::Instance().getTimelineEnabled() &&
+                        (report.type == Stat::EVENT ||
+                         report.type == Stat::EVENT_START ||
+                         report.type == Stat::EVENT_END ||
+                         report.type == Stat::COUNTER)) {
+                    Event event;
+                    event.m_tag = tag;
+                    event.m_type = report.type;
+                    event.m_time = mixxx::Duration::fromNanos(report.time);
+                    event.m_threadId = pStatsPipe->threadId();
+                    event.m_value = report.value;
+                    m_events.append(event);
+                }
+
+                if (CmdlineArgs::Instance().getMetricsEnabled()) {
+                    m_metrics.processReport(report, tag,
+                            m_threadNames.value(pStatsPipe->threadId()));
+                }
+                free(report.tag);
             }
-            free(report.tag);
         }
     }
 }
 
 void StatsManager::run() {
     qDebug() << "StatsManager thread starting up.";
+    const bool metricsEnabled = CmdlineArgs::Instance().getMetricsEnabled();
+    m_metricsTimer.start();
     while (true) {
+        // Wakes up for the metrics even if no pipe is about to overflow
+        m_statsPipeWakeup.wait(metricsEnabled ? kMetricsIntervalMillis : -1);
         m_statsPipeLock.lock();
-        m_statsPipeCondition.wait(&m_statsPipeLock);
         // We want to process reports even when we are about to quit since we
         // want to print the most accurate stat report on shutdown.
         processIncomingStatReports();
         m_statsPipeLock.unlock();
 
+        if (metricsEnabled &&
+                m_metricsTimer.elapsed().toIntegerMillis() >= kMetricsIntervalMillis) {
+            writeMetrics(CmdlineArgs::Instance().getMetricsPath());
+            m_metricsTimer.restart();
+        }
+
         if (load_atomic(m_emitAllStats) == 1) {
             for (QMap<QString, Stat>::const_iterator it = m_stats.begin();
                  it != m_stats.end(); ++it) {
@@ -8,23 +8,32 @@
 #include <QAtomicInt>
 #include <QtDebug>
 #include <QMutex>
-#include <QWaitCondition>
 #include <QThreadStorage>
 #include <QList>
 
 #include "util/fifo.h"
+#include "util/fifowakeup.h"
+#include "util/performancetimer.h"
 #include "util/singleton.h"
 #include "util/stat.h"
+#include "util/statsmetrics.h"
 #include "util/event.h"
 
+class QTextStream;
 class StatsManager;
 
 class StatsPipe : public FIFO<StatReport> {
   public:
-    StatsPipe(StatsManager* pManager);
+    StatsPipe(StatsManager* pManager, int threadId);
     virtual ~StatsPipe();
+
+    int threadId() const {
+        return m_threadId;
+    }
+
   private:
     StatsManager* m_pManager;
+    const int m_threadId;
 };
 
 class StatsManager : public QThread, public Singleton<StatsManager> {
@@ -44,7 +53,7 @@ class StatsManager : public QThread, public Singleton<StatsManager> {
     }
 
     void updateStats() {
-        m_statsPipeCondition.wakeAll();
+        m_statsPipeWakeup.wake();
     }
 
   signals:
@@ -58,6 +67,10 @@ class StatsManager : public QThread, public Singleton<StatsManager> {
     StatsPipe* getStatsPipeForThread();
     void onStatsPipeDestroyed(StatsPipe* pPipe);
     void writeTimeline(const QString& filename);
+    // The Chrome trace event format, see writeTimeline()
+    void writeTraceEvents(QTextStream* pOut);
+    // Replaces the file of --metricsPath
+    void writeMetrics(const QString& filename);
 
     QAtomicInt m_emitAllStats;
     QAtomicInt m_quit;
@@ -65,11 +78,18 @@ class StatsManager : public QThread, public Singleton<StatsManager> {
     QMap<QString, Stat> m_baseStats;
     QMap<QString, Stat> m_experimentStats;
     QList<Event> m_events;
+    StatsMetrics m_metrics;
+    PerformanceTimer m_metricsTimer;
 
-    QWaitCondition m_statsPipeCondition;
+    // Writing threads wake up the manager before their pipes overflow
+    FIFOWakeup m_statsPipeWakeup;
+    // Guards m_statsPipes
     QMutex m_statsPipeLock;
     QList<StatsPipe*> m_statsPipes;
     QThreadStorage<StatsPipe*> m_threadStatsPipes;
+    // The names of the threads that have reported stats by thread id, also
+    // guarded by m_statsPipeLock
+    QList<QString> m_threadNames;
 
     friend class StatsPipe;
 };
@@ -0,0 +1,174 @@
+#include "util/statsmetrics.h"
+
+#include <QRegExp>
+#include <QTextStream>
+
+#include "util/memoryaccounting.h"
+
+namespace {
+
+// Escapes a label value, see the OpenMetrics text format
+QString escapeLabelValue(const QString& value) {
+    QString escaped;
+    escaped.reserve(value.size());
+    for (const QChar& c : value) {
+        if (c == '\\') {
+            escaped += "\\\\";
+        } else if (c == '"') {
+            escaped += "\\\"";
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+QString labelsOf(const QString& tag, const QString& threadName) {
+    QString labels = QString("tag=\"%1\",thread=\"%2\"")
+            .arg(escapeLabelValue(tag), escapeLabelValue(threadName));
+    // e.g. the deck of a timer
+    QRegExp groupRx("\\[[A-Za-z0-9_]+\\]");
+    if (groupRx.indexIn(tag) >= 0) {
+        labels += QString(",group=\"%1\"").arg(escapeLabelValue(groupRx.cap(0)));
+    }
+    return labels;
+}
+
+QString formatNumber(double value) {
+    return QString::number(value, 'g', 15);
+}
+
+} // anonymous namespace
+
+StatsMetrics::Series::Series()
+        : type(Stat::UNSPECIFIED),
+          count(0),
+          sum(0),
+          lastValue(0),
+          bucketCounts(durationBuckets().size() + 1, 0.0) {
+}
+
+StatsMetrics::StatsMetrics() {
+}
+
+// static
+const QVector<double>& StatsMetrics::durationBuckets() {
+    // From 10 us up to 10 s, dense around the audio callback periods
+    static const QVector<double> kBuckets = {
+        0.00001, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.002, 0.005,
+        0.01, 0.02, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 10.0,
+    };
+    return kBuckets;
+}
+
+// static
+double StatsMetrics::toSeconds(Stat::StatType type, double value) {
+    switch (type) {
+    case Stat::DURATION_NANOSEC:
+        return value / 1e9;
+    case Stat::DURATION_MSEC:
+        return value / 1e3;
+    default:
+        return value;
+    }
+}
+
+void StatsMetrics::processReport(const StatReport& report, const QString& tag,
+                                 const QString& threadName) {
+    Series& series = m_series[qMakePair(tag, threadName)];
+    series.type = report.type;
+    series.count += 1;
+    switch (report.type) {
+    case Stat::DURATION_NANOSEC:
+    case Stat::DURATION_MSEC:
+    case Stat::DURATION_SEC: {
+        const double seconds = toSeconds(report.type, report.value);
+        series.sum += seconds;
+        const QVector<double>& buckets = durationBuckets();
+        int bucket = 0;
+        while (bucket < buckets.size() && seconds > buckets[bucket]) {
+            ++bucket;
+        }
+        series.bucketCounts[bucket] += 1;
+        break;
+    }
+    default:
+        series.sum += report.value;
+        break;
+    }
+    series.lastValue = report.value;
+}
+
+void StatsMetrics::write(QTextStream* pOut) const {
+    QTextStream& out = *pOut;
+
+    out << "# TYPE mixxx_counter counter\n"
+        << "# HELP mixxx_counter The sum of the increments of a Counter.\n";
+    for (auto it = m_series.constBegin(); it != m_series.constEnd(); ++it) {
+        if (it->type == Stat::COUNTER) {
+            out << "mixxx_counter_total{"
+                << labelsOf(it.key().first, it.key().second) << "} "
+                << formatNumber(it->sum) << "\n";
+        }
+    }
+
+    out << "# TYPE mixxx_duration_seconds histogram\n"
+        << "# UNIT mixxx_duration_seconds seconds\n"
+        << "# HELP mixxx_duration_seconds The durations measured by a timer.\n";
+    const QVector<double>& buckets = durationBuckets();
+    for (auto it = m_series.constBegin(); it != m_series.constEnd(); ++it) {
+        if (it->type != Stat::DURATION_NANOSEC &&
+                it->type != Stat::DURATION_MSEC &&
+                it->type != Stat::DURATION_SEC) {
+            continue;
+        }
+        const QString labels = labelsOf(it.key().first, it.key().second);
+        double cumulativeCount = 0;
+        for (int i = 0; i < buckets.size(); ++i) {
+            cumulativeCount += it->bucketCounts[i];
+            out << "mixxx_duration_seconds_bucket{" << labels
+                << ",le=\"" << QString::number(buckets[i]) << "\"} "
+                << formatNumber(cumulativeCount) << "\n";
+        }
+        out << "mixxx_duration_seconds_bucket{" << labels << ",le=\"+Inf\"} "
+            << formatNumber(it->count) << "\n"
+            << "mixxx_duration_seconds_count{" << labels << "} "
+            << formatNumber(it->count) << "\n"
+            << "mixxx_duration_seconds_sum{" << labels << "} "
+            << formatNumber(it->sum) << "\n";
+    }
+
+    out << "# TYPE mixxx_events counter\n"
+        << "# HELP mixxx_events The number of traced events.\n";
+    for (auto it = m_series.constBegin(); it != m_series.constEnd(); ++it) {
+        if (it->type == Stat::EVENT || it->type == Stat::EVENT_START ||
+                it->type == Stat::EVENT_END) {
+            out << "mixxx_events_total{"
+                << labelsOf(it.key().first, it.key().second) << "} "
+                << formatNumber(it->count) << "\n";
+        }
+    }
+
+    out << "# TYPE mixxx_value gauge\n"
+        << "# HELP mixxx_value The last reported value of a stat.\n";
+    for (auto it = m_series.constBegin(); it != m_series.constEnd(); ++it) {
+        if (it->type == Stat::UNSPECIFIED) {
+            out << "mixxx_value{"
+                << labelsOf(it.key().first, it.key().second) << "} "
+                << formatNumber(it->lastValue) << "\n";
+        }
+    }
+
+    out << "# TYPE mixxx_memory_bytes gauge\n"
+        << "# UNIT mixxx_memory_bytes bytes\n"
+        << "# HELP mixxx_memory_bytes The accounted memory of a subsystem.\n";
+    for (int i = 0; i < MemoryAccounting::kCategoryCount; ++i) {
+        const auto category = static_cast<MemoryAccounting::Category>(i);
+        out << "mixxx_memory_bytes{category=\""
+            << MemoryAccounting::categoryName(category) << "\"} "
+            << MemoryAccounting::bytes(category) << "\n";
+    }
+    out << "# EOF\n";
+}
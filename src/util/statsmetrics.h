@@ -0,0 +1,56 @@
+#ifndef STATSMETRICS_H
+#define STATSMETRICS_H
+
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include "util/stat.h"
+
+class QTextStream;
+
+// Aggregates the stat reports of all threads for monitoring in the
+// OpenMetrics text format that Prometheus scrapes, e.g. from the textfile
+// collector of the node exporter.
+//
+// All stats share a few metric families and are told apart by their labels,
+// so the tags need not be valid metric names:
+//   mixxx_counter_total{tag,thread}      - the sum of a Counter
+//   mixxx_duration_seconds{tag,thread}   - a histogram of a timer
+//   mixxx_events_total{tag,thread}       - the number of traced events
+//   mixxx_value{tag,thread}              - the last value of any other stat
+//   mixxx_memory_bytes{category}         - the totals of MemoryAccounting
+// A tag that contains a group like [Channel1] also gets a group label.
+//
+// Not thread-safe, owned by the StatsManager thread.
+class StatsMetrics {
+  public:
+    StatsMetrics();
+
+    void processReport(const StatReport& report, const QString& tag,
+                       const QString& threadName);
+
+    void write(QTextStream* pOut) const;
+
+    // The upper bounds of the histogram buckets in seconds
+    static const QVector<double>& durationBuckets();
+
+  private:
+    struct Series {
+        Series();
+        Stat::StatType type;
+        double count;
+        double sum;
+        double lastValue;
+        // Not cumulative, one per bucket and the last one for +Inf
+        QVector<double> bucketCounts;
+    };
+
+    static double toSeconds(Stat::StatType type, double value);
+
+    // Ordered by tag and thread for a stable output
+    QMap<QPair<QString, QString>, Series> m_series;
+};
+
+#endif /* STATSMETRICS_H */
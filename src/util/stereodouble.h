@@ -0,0 +1,155 @@
+#ifndef MIXXX_UTIL_STEREODOUBLE_H
+#define MIXXX_UTIL_STEREODOUBLE_H
+
+#include "util/types.h"
+
+// The vector registers are only used where they are part of the baseline
+// instruction set and the heap is aligned to 16 bytes, so that classes with
+// StereoDouble members can be allocated with plain new.
+#if defined(__x86_64__) || defined(_M_X64)
+#define MIXXX_STEREODOUBLE_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#define MIXXX_STEREODOUBLE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace mixxx {
+
+// The left and right sample of a stereo frame in double precision, held in a
+// single vector register where available. Recursive filters that process
+// both channels with the same coefficients can use it to compute the two
+// independent recurrences with one instruction stream. The operations
+// are the same as for two separate doubles, so the results are identical to
+// processing each channel on its own.
+class StereoDouble {
+  public:
+    // Uninitialized like a double, so that arrays of it can be cleared with
+    // memset() and copied with memcpy()
+    StereoDouble() = default;
+
+    static StereoDouble zero() {
+        return StereoDouble(0.0, 0.0);
+    }
+
+    // Reads the interleaved frame pFrame[0], pFrame[1]
+    static StereoDouble fromFrame(const CSAMPLE* pFrame) {
+#if defined(MIXXX_STEREODOUBLE_NEON)
+        return StereoDouble(vcvt_f64_f32(vld1_f32(pFrame)));
+#else
+        return StereoDouble(pFrame[0], pFrame[1]);
+#endif
+    }
+
+    // Writes the interleaved frame pFrame[0], pFrame[1]
+    void toFrame(CSAMPLE* pFrame) const {
+#if defined(MIXXX_STEREODOUBLE_SSE2)
+        _mm_storel_pi(reinterpret_cast<__m64*>(pFrame), _mm_cvtpd_ps(m_value));
+#elif defined(MIXXX_STEREODOUBLE_NEON)
+        vst1_f32(pFrame, vcvt_f32_f64(m_value));
+#else
+        pFrame[0] = static_cast<CSAMPLE>(m_left);
+        pFrame[1] = static_cast<CSAMPLE>(m_right);
+#endif
+    }
+
+#if defined(MIXXX_STEREODOUBLE_SSE2)
+    StereoDouble(double left, double right)
+            : m_value(_mm_set_pd(right, left)) {
+    }
+
+    StereoDouble operator+(const StereoDouble& other) const {
+        return StereoDouble(_mm_add_pd(m_value, other.m_value));
+    }
+    StereoDouble operator-(const StereoDouble& other) const {
+        return StereoDouble(_mm_sub_pd(m_value, other.m_value));
+    }
+    StereoDouble operator-() const {
+        // Flip the sign bits like a scalar negation
+        return StereoDouble(_mm_xor_pd(m_value, _mm_set1_pd(-0.0)));
+    }
+    StereoDouble operator*(double factor) const {
+        return StereoDouble(_mm_mul_pd(m_value, _mm_set1_pd(factor)));
+    }
+    StereoDouble operator*(const StereoDouble& other) const {
+        return StereoDouble(_mm_mul_pd(m_value, other.m_value));
+    }
+
+  private:
+    explicit StereoDouble(__m128d value)
+            : m_value(value) {
+    }
+
+    __m128d m_value;
+#elif defined(MIXXX_STEREODOUBLE_NEON)
+    StereoDouble(double left, double right)
+            : m_value(vcombine_f64(vdup_n_f64(left), vdup_n_f64(right))) {
+    }
+
+    StereoDouble operator+(const StereoDouble& other) const {
+        return StereoDouble(vaddq_f64(m_value, other.m_value));
+    }
+    StereoDouble operator-(const StereoDouble& other) const {
+        return StereoDouble(vsubq_f64(m_value, other.m_value));
+    }
+    StereoDouble operator-() const {
+        return StereoDouble(vnegq_f64(m_value));
+    }
+    StereoDouble operator*(double factor) const {
+        return StereoDouble(vmulq_n_f64(m_value, factor));
+    }
+    StereoDouble operator*(const StereoDouble& other) const {
+        return StereoDouble(vmulq_f64(m_value, other.m_value));
+    }
+
+  private:
+    explicit StereoDouble(float64x2_t value)
+            : m_value(value) {
+    }
+
+    float64x2_t m_value;
+#else
+    StereoDouble(double left, double right)
+            : m_left(left),
+              m_right(right) {
+    }
+
+    StereoDouble operator+(const StereoDouble& other) const {
+        return StereoDouble(m_left + other.m_left, m_right + other.m_right);
+    }
+    StereoDouble operator-(const StereoDouble& other) const {
+        return StereoDouble(m_left - other.m_left, m_right - other.m_right);
+    }
+    StereoDouble operator-() const {
+        return StereoDouble(-m_left, -m_right);
+    }
+    StereoDouble operator*(double factor) const {
+        return StereoDouble(m_left * factor, m_right * factor);
+    }
+    StereoDouble operator*(const StereoDouble& other) const {
+        return StereoDouble(m_left * other.m_left, m_right * other.m_right);
+    }
+
+  private:
+    double m_left;
+    double m_right;
+#endif
+
+  public:
+    StereoDouble& operator+=(const StereoDouble& other) {
+        *this = *this + other;
+        return *this;
+    }
+    StereoDouble& operator-=(const StereoDouble& other) {
+        *this = *this - other;
+        return *this;
+    }
+};
+
+inline StereoDouble operator*(double factor, const StereoDouble& value) {
+    return value * factor;
+}
+
+} // namespace mixxx
+
+#endif // MIXXX_UTIL_STEREODOUBLE_H
@@ -0,0 +1,404 @@
+#include "util/threadroles.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QThread>
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(__LINUX__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "util/rlimit.h"
+#elif defined(__WINDOWS__)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <pthread/qos.h>
+#endif
+
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("ThreadRoles");
+
+const QString kConfigGroup = QStringLiteral("[ThreadRoles]");
+
+const int kNumRoles = static_cast<int>(ThreadRole::Controller) + 1;
+
+QMutex s_mutex;
+ThreadPolicy s_policies[kNumRoles];
+
+const char* const kSchedulingNames[] = {
+    "default",
+    "normal",
+    "batch",
+    "idle",
+    "realtime",
+};
+
+bool parseScheduling(const QString& name, ThreadPolicy::Scheduling* pScheduling) {
+    for (size_t i = 0; i < sizeof(kSchedulingNames) / sizeof(kSchedulingNames[0]); ++i) {
+        if (name == QLatin1String(kSchedulingNames[i])) {
+            *pScheduling = static_cast<ThreadPolicy::Scheduling>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+#if defined(__LINUX__)
+
+bool setNiceness(int priority, QString* pError) {
+    // On Linux the niceness of a thread id only applies to that thread
+    const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    if (setpriority(PRIO_PROCESS, tid, math_clamp(priority, -20, 19)) != 0) {
+        *pError = QString("setting the niceness %1 failed: %2")
+                .arg(priority).arg(QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+bool applyScheduling(const ThreadPolicy& policy, QString* pError) {
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    int schedPolicy = SCHED_OTHER;
+    switch (policy.scheduling) {
+    case ThreadPolicy::Scheduling::Default:
+        return true;
+    case ThreadPolicy::Scheduling::Normal:
+        break;
+    case ThreadPolicy::Scheduling::Batch:
+        schedPolicy = SCHED_BATCH;
+        break;
+    case ThreadPolicy::Scheduling::Idle:
+        schedPolicy = SCHED_IDLE;
+        break;
+    case ThreadPolicy::Scheduling::Realtime:
+        schedPolicy = SCHED_FIFO;
+        param.sched_priority = math_clamp(policy.priority,
+                sched_get_priority_min(SCHED_FIFO),
+                sched_get_priority_max(SCHED_FIFO));
+        break;
+    }
+    const int error = pthread_setschedparam(pthread_self(), schedPolicy, &param);
+    if (error != 0) {
+        *pError = QString("setting the scheduling policy failed: %1")
+                .arg(QString::fromLocal8Bit(strerror(error)));
+        if (schedPolicy == SCHED_FIFO) {
+            *pError += QString(", the real-time priority limit is %1")
+                    .arg(RLimit::getCurRtPrio());
+        }
+        return false;
+    }
+    if (schedPolicy == SCHED_OTHER || schedPolicy == SCHED_BATCH) {
+        return setNiceness(policy.priority, pError);
+    }
+    return true;
+}
+
+bool applyAffinity(const QList<int>& cpus, QString* pError) {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int cpu : cpus) {
+        if (cpu >= CPU_SETSIZE) {
+            *pError = QString("CPU %1 is out of range").arg(cpu);
+            return false;
+        }
+        CPU_SET(cpu, &cpuSet);
+    }
+    const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    if (error != 0) {
+        *pError = QString("setting the CPU affinity failed: %1")
+                .arg(QString::fromLocal8Bit(strerror(error)));
+        return false;
+    }
+    return true;
+}
+
+#elif defined(__WINDOWS__)
+
+// avrt.dll is loaded at runtime, so Mixxx does not depend on it
+typedef HANDLE (WINAPI *AvSetMmThreadCharacteristicsWFunction)(LPCWSTR, LPDWORD);
+typedef BOOL (WINAPI *AvSetMmThreadPriorityFunction)(HANDLE, int);
+const int kAvrtPriorityHigh = 1;
+const int kAvrtPriorityCritical = 2;
+
+bool joinMmcssProAudio(int priority, QString* pError) {
+    HMODULE hAvrt = LoadLibraryW(L"avrt.dll");
+    if (!hAvrt) {
+        *pError = "MMCSS is not available";
+        return false;
+    }
+    auto avSetMmThreadCharacteristics =
+            reinterpret_cast<AvSetMmThreadCharacteristicsWFunction>(
+                    GetProcAddress(hAvrt, "AvSetMmThreadCharacteristicsW"));
+    auto avSetMmThreadPriority =
+            reinterpret_cast<AvSetMmThreadPriorityFunction>(
+                    GetProcAddress(hAvrt, "AvSetMmThreadPriority"));
+    if (!avSetMmThreadCharacteristics || !avSetMmThreadPriority) {
+        *pError = "MMCSS is not available";
+        return false;
+    }
+    // The library stays loaded for as long as the thread is registered
+    DWORD taskIndex = 0;
+    HANDLE hTask = avSetMmThreadCharacteristics(L"Pro Audio", &taskIndex);
+    if (!hTask) {
+        *pError = QString("joining the MMCSS task Pro Audio failed: error %1")
+                .arg(GetLastError());
+        return false;
+    }
+    if (!avSetMmThreadPriority(hTask,
+            priority >= 90 ? kAvrtPriorityCritical : kAvrtPriorityHigh)) {
+        *pError = QString("setting the MMCSS priority failed: error %1")
+                .arg(GetLastError());
+        return false;
+    }
+    return true;
+}
+
+bool applyScheduling(const ThreadPolicy& policy, QString* pError) {
+    int threadPriority = THREAD_PRIORITY_NORMAL;
+    switch (policy.scheduling) {
+    case ThreadPolicy::Scheduling::Default:
+        return true;
+    case ThreadPolicy::Scheduling::Normal:
+        // Like the niceness, negative values raise the priority
+        if (policy.priority < 0) {
+            threadPriority = THREAD_PRIORITY_ABOVE_NORMAL;
+        } else if (policy.priority > 0) {
+            threadPriority = THREAD_PRIORITY_BELOW_NORMAL;
+        }
+        break;
+    case ThreadPolicy::Scheduling::Batch:
+        threadPriority = THREAD_PRIORITY_BELOW_NORMAL;
+        break;
+    case ThreadPolicy::Scheduling::Idle:
+        threadPriority = THREAD_PRIORITY_IDLE;
+        break;
+    case ThreadPolicy::Scheduling::Realtime:
+        if (joinMmcssProAudio(policy.priority, pError)) {
+            return true;
+        }
+        // Still better than nothing, but reported
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+        return false;
+    }
+    if (!SetThreadPriority(GetCurrentThread(), threadPriority)) {
+        *pError = QString("setting the thread priority failed: error %1")
+                .arg(GetLastError());
+        return false;
+    }
+    return true;
+}
+
+bool applyAffinity(const QList<int>& cpus, QString* pError) {
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+        if (cpu >= static_cast<int>(sizeof(mask) * 8)) {
+            *pError = QString("CPU %1 is out of range").arg(cpu);
+            return false;
+        }
+        mask |= static_cast<DWORD_PTR>(1) << cpu;
+    }
+    if (!SetThreadAffinityMask(GetCurrentThread(), mask)) {
+        *pError = QString("setting the CPU affinity failed: error %1")
+                .arg(GetLastError());
+        return false;
+    }
+    return true;
+}
+
+#elif defined(__APPLE__)
+
+bool applyScheduling(const ThreadPolicy& policy, QString* pError) {
+    qos_class_t qosClass = QOS_CLASS_DEFAULT;
+    switch (policy.scheduling) {
+    case ThreadPolicy::Scheduling::Default:
+        return true;
+    case ThreadPolicy::Scheduling::Normal:
+        qosClass = policy.priority < 0 ? QOS_CLASS_USER_INITIATED : QOS_CLASS_DEFAULT;
+        break;
+    case ThreadPolicy::Scheduling::Batch:
+        qosClass = QOS_CLASS_UTILITY;
+        break;
+    case ThreadPolicy::Scheduling::Idle:
+        qosClass = QOS_CLASS_BACKGROUND;
+        break;
+    case ThreadPolicy::Scheduling::Realtime:
+        qosClass = QOS_CLASS_USER_INTERACTIVE;
+        break;
+    }
+    const int error = pthread_set_qos_class_self_np(qosClass, 0);
+    if (error != 0) {
+        *pError = QString("setting the QoS class failed: %1")
+                .arg(QString::fromLocal8Bit(strerror(error)));
+        return false;
+    }
+    return true;
+}
+
+bool applyAffinity(const QList<int>& cpus, QString* pError) {
+    Q_UNUSED(cpus);
+    *pError = "CPU affinity is not supported on macOS";
+    return false;
+}
+
+#else
+
+bool applyScheduling(const ThreadPolicy& policy, QString* pError) {
+    if (policy.scheduling == ThreadPolicy::Scheduling::Default) {
+        return true;
+    }
+    *pError = "scheduling policies are not supported on this platform";
+    return false;
+}
+
+bool applyAffinity(const QList<int>& cpus, QString* pError) {
+    Q_UNUSED(cpus);
+    *pError = "CPU affinity is not supported on this platform";
+    return false;
+}
+
+#endif
+
+} // anonymous namespace
+
+// static
+void ThreadRoles::configure(UserSettingsPointer pConfig) {
+    for (int i = 0; i < kNumRoles; ++i) {
+        const ThreadRole role = static_cast<ThreadRole>(i);
+        const QString name = roleName(role);
+        ThreadPolicy policy;
+
+        const QString scheduling = pConfig->getValueString(
+                ConfigKey(kConfigGroup, name + "_scheduling"));
+        if (!scheduling.isEmpty() &&
+                !parseScheduling(scheduling, &policy.scheduling)) {
+            kLogger.warning() << "Unknown scheduling" << scheduling
+                              << "for" << name;
+        }
+        policy.priority = pConfig->getValue(
+                ConfigKey(kConfigGroup, name + "_priority"), 0);
+        const QString cpus = pConfig->getValueString(
+                ConfigKey(kConfigGroup, name + "_cpus"));
+        if (!parseCpuList(cpus, &policy.cpus)) {
+            kLogger.warning() << "Invalid list of CPUs" << cpus
+                              << "for" << name;
+            policy.cpus.clear();
+        }
+        setPolicy(role, policy);
+    }
+}
+
+// static
+ThreadPolicy ThreadRoles::policy(ThreadRole role) {
+    QMutexLocker locker(&s_mutex);
+    return s_policies[static_cast<int>(role)];
+}
+
+// static
+void ThreadRoles::setPolicy(ThreadRole role, const ThreadPolicy& policy) {
+    QMutexLocker locker(&s_mutex);
+    s_policies[static_cast<int>(role)] = policy;
+}
+
+// static
+bool ThreadRoles::applyToCurrentThread(ThreadRole role) {
+    const ThreadPolicy threadPolicy = policy(role);
+    if (threadPolicy.scheduling == ThreadPolicy::Scheduling::Default &&
+            threadPolicy.cpus.isEmpty()) {
+        return true;
+    }
+
+    bool success = true;
+    QString error;
+    if (!applyScheduling(threadPolicy, &error)) {
+        kLogger.warning() << "Could not apply the scheduling"
+                          << kSchedulingNames[static_cast<int>(threadPolicy.scheduling)]
+                          << "with priority" << threadPolicy.priority
+                          << "to the" << roleName(role) << "thread"
+                          << QThread::currentThread()->objectName()
+                          << "-" << error;
+        success = false;
+    }
+    if (!threadPolicy.cpus.isEmpty() &&
+            !applyAffinity(threadPolicy.cpus, &error)) {
+        kLogger.warning() << "Could not pin the" << roleName(role)
+                          << "thread" << QThread::currentThread()->objectName()
+                          << "to the CPUs" << threadPolicy.cpus
+                          << "-" << error;
+        success = false;
+    }
+    if (success) {
+        kLogger.info() << "Applied the scheduling"
+                       << kSchedulingNames[static_cast<int>(threadPolicy.scheduling)]
+                       << "with priority" << threadPolicy.priority
+                       << "and the CPUs" << threadPolicy.cpus
+                       << "to the" << roleName(role) << "thread"
+                       << QThread::currentThread()->objectName();
+    }
+    return success;
+}
+
+// static
+QString ThreadRoles::roleName(ThreadRole role) {
+    switch (role) {
+    case ThreadRole::AudioCallback:
+        return "audio_callback";
+    case ThreadRole::EngineHelper:
+        return "engine_helper";
+    case ThreadRole::EngineWorker:
+        return "engine_worker";
+    case ThreadRole::Analyzer:
+        return "analyzer";
+    case ThreadRole::LibraryScanner:
+        return "library_scanner";
+    case ThreadRole::LibraryQuery:
+        return "library_query";
+    case ThreadRole::CoverLoader:
+        return "cover_loader";
+    case ThreadRole::VSync:
+        return "vsync";
+    case ThreadRole::Controller:
+        return "controller";
+    }
+    return QString();
+}
+
+// static
+bool ThreadRoles::parseCpuList(const QString& cpuList, QList<int>* pCpus) {
+    pCpus->clear();
+    const QStringList ranges = cpuList.split(',', QString::SkipEmptyParts);
+    for (const QString& range : ranges) {
+        const QStringList bounds = range.trimmed().split('-');
+        if (bounds.size() > 2) {
+            return false;
+        }
+        bool firstOk = false;
+        bool lastOk = false;
+        const int first = bounds.first().trimmed().toInt(&firstOk);
+        const int last = bounds.last().trimmed().toInt(&lastOk);
+        if (!firstOk || !lastOk || first < 0 || last < first) {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            if (!pCpus->contains(cpu)) {
+                pCpus->append(cpu);
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace mixxx
@@ -0,0 +1,89 @@
+#ifndef MIXXX_UTIL_THREADROLES_H
+#define MIXXX_UTIL_THREADROLES_H
+
+#include <QList>
+#include <QString>
+
+#include "preferences/usersettings.h"
+
+namespace mixxx {
+
+// The kinds of threads that get a scheduling policy of their own
+enum class ThreadRole {
+    // The thread that runs the engine callback of the clock reference
+    // sound device
+    AudioCallback = 0,
+    // The threads of the EngineChannelThreadPool
+    EngineHelper,
+    // The threads of the EngineWorkerPool, e.g. the track readers
+    EngineWorker,
+    Analyzer,
+    LibraryScanner,
+    // The thread that executes the queries of the library views
+    LibraryQuery,
+    // The threads that load the covers for the library and decks
+    CoverLoader,
+    VSync,
+    Controller,
+};
+
+struct ThreadPolicy {
+    enum class Scheduling {
+        // Leaves the thread as it has been created, e.g. by PortAudio
+        Default,
+        // Time sharing, the priority is the niceness from -20 to 19 on
+        // Linux and mapped to the nearest thread priority elsewhere
+        Normal,
+        // Time sharing for CPU bound work, e.g. SCHED_BATCH on Linux
+        Batch,
+        // Only runs when nothing else wants to
+        Idle,
+        // SCHED_FIFO with the priority from 1 to 99 on Linux, MMCSS "Pro
+        // Audio" on Windows and the user interactive QoS class on macOS
+        Realtime,
+    };
+
+    ThreadPolicy()
+            : scheduling(Scheduling::Default),
+              priority(0) {
+    }
+
+    Scheduling scheduling;
+    int priority;
+    // Empty for any CPU
+    QList<int> cpus;
+};
+
+// The registry of the scheduling policies for each ThreadRole. The threads
+// apply the policy of their role when they start. The policies are read
+// from the [ThreadRoles] config group, e.g. for pinning the audio callback
+// to an isolated core and keeping the library scanner off it
+//   audio_callback_scheduling realtime
+//   audio_callback_priority 80
+//   audio_callback_cpus 3
+//   library_scanner_scheduling idle
+//   library_scanner_cpus 0-2
+// Without a config all threads are left as they are.
+class ThreadRoles {
+  public:
+    // Reads the policies of all roles. Must be called before the threads
+    // are started.
+    static void configure(UserSettingsPointer pConfig);
+
+    static ThreadPolicy policy(ThreadRole role);
+    static void setPolicy(ThreadRole role, const ThreadPolicy& policy);
+
+    // Applies the policy of the role to the calling thread. Logs a warning
+    // and returns false if a part of it could not be applied, e.g. because
+    // the user is not allowed to use real-time scheduling.
+    static bool applyToCurrentThread(ThreadRole role);
+
+    static QString roleName(ThreadRole role);
+
+    // Parses a list of CPUs like "0,2-3". Returns false if it is malformed.
+    static bool parseCpuList(const QString& cpuList, QList<int>* pCpus);
+};
+
+}  // namespace mixxx
+
+#endif // MIXXX_UTIL_THREADROLES_H
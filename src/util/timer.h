@@ -9,6 +9,7 @@
 #include "util/performancetimer.h"
 #include "util/cmdlineargs.h"
 #include "util/duration.h"
+#include "util/flightrecorder.h"
 
 const Stat::ComputeFlags kDefaultComputeFlags = Stat::COUNT | Stat::SUM | Stat::AVERAGE |
         Stat::MAX | Stat::MIN | Stat::SAMPLE_VARIANCE;
@@ -56,7 +57,9 @@ class ScopedTimer {
     ScopedTimer(const char* key, int i,
                 Stat::ComputeFlags compute = kDefaultComputeFlags)
             : m_pTimer(NULL),
-              m_cancel(false) {
+              m_cancel(false),
+              m_flightRecorderKey(NULL) {
+        beginFlightRecord(key, i);
         if (CmdlineArgs::Instance().getDeveloper()) {
             initialize(QString(key), QString::number(i), compute);
         }
@@ -65,7 +68,9 @@ class ScopedTimer {
     ScopedTimer(const char* key, const char *arg = NULL,
                 Stat::ComputeFlags compute = kDefaultComputeFlags)
             : m_pTimer(NULL),
-              m_cancel(false) {
+              m_cancel(false),
+              m_flightRecorderKey(NULL) {
+        beginFlightRecord(key, 0);
         if (CmdlineArgs::Instance().getDeveloper()) {
             initialize(QString(key), arg ? QString(arg) : QString(), compute);
         }
@@ -74,13 +79,18 @@ class ScopedTimer {
     ScopedTimer(const char* key, const QString& arg,
                 Stat::ComputeFlags compute = kDefaultComputeFlags)
             : m_pTimer(NULL),
-              m_cancel(false) {
+              m_cancel(false),
+              m_flightRecorderKey(NULL) {
+        beginFlightRecord(key, 0);
         if (CmdlineArgs::Instance().getDeveloper()) {
             initialize(QString(key), arg, compute);
         }
     }
 
     virtual ~ScopedTimer() {
+        if (m_flightRecorderKey) {
+            FlightRecorder::end(m_flightRecorderKey);
+        }
         if (m_pTimer) {
             if (!m_cancel) {
                 m_pTimer->elapsed(true);
@@ -105,9 +115,18 @@ class ScopedTimer {
         m_cancel = true;
     }
   private:
+    // Only the key is recorded, the string argument would have to be copied
+    void beginFlightRecord(const char* key, int i) {
+        if (FlightRecorder::isEnabled()) {
+            m_flightRecorderKey = key;
+            FlightRecorder::begin(key, i);
+        }
+    }
+
     Timer* m_pTimer;
     char m_timerMem[sizeof(Timer)];
     bool m_cancel;
+    const char* m_flightRecorderKey;
 };
 
 // A timer that provides a similar API to QTimer but uses the GuiTick 50ms
@@ -0,0 +1,160 @@
+#include "util/timerwheel.h"
+
+#include "util/assert.h"
+#include "util/math.h"
+
+namespace {
+
+// The generation is kept in the bits above the index, so that the ids
+// remain positive
+const int kMaxGeneration = 0x7FFF;
+
+} // anonymous namespace
+
+TimerWheel::TimerWheel()
+        : m_freeTimers(kNone),
+          m_activeTimers(0),
+          m_scheduledTimers(0),
+          m_generation(0),
+          m_currentTick(0) {
+    for (int i = 0; i < kLevels * kSlots; ++i) {
+        m_slots[i] = kNone;
+    }
+}
+
+int TimerWheel::start(int intervalTicks, bool oneShot) {
+    int index = m_freeTimers;
+    if (index != kNone) {
+        m_freeTimers = m_timers[index].next;
+    } else {
+        if (m_timers.size() >= kIndexMask) {
+            return 0;
+        }
+        index = m_timers.size();
+        m_timers.append(Timer());
+    }
+    if (++m_generation > kMaxGeneration) {
+        m_generation = 1;
+    }
+    Timer& timer = m_timers[index];
+    timer.id = (m_generation << kIndexBits) | (index + 1);
+    timer.intervalTicks = math_max(intervalTicks, 1);
+    timer.dueTick = m_currentTick + timer.intervalTicks;
+    timer.oneShot = oneShot;
+    timer.slot = kNone;
+    ++m_activeTimers;
+    schedule(index);
+    return timer.id;
+}
+
+bool TimerWheel::stop(int id) {
+    if (!isActive(id)) {
+        return false;
+    }
+    const int index = indexOf(id);
+    Timer& timer = m_timers[index];
+    if (timer.slot != kNone) {
+        unschedule(index);
+    }
+    timer.id = 0;
+    timer.next = m_freeTimers;
+    m_freeTimers = index;
+    --m_activeTimers;
+    return true;
+}
+
+bool TimerWheel::isActive(int id) const {
+    const int index = indexOf(id);
+    return id > 0 && index >= 0 && index < m_timers.size() &&
+            m_timers[index].id == id;
+}
+
+void TimerWheel::advance(qint64 tick, QVector<int>* pExpiredIds) {
+    while (m_currentTick < tick) {
+        if (m_scheduledTimers == 0) {
+            m_currentTick = tick;
+            return;
+        }
+        ++m_currentTick;
+        // Move the timers of the next slot of the coarser levels down
+        // whenever a level has wrapped around
+        for (int level = 1; level < kLevels; ++level) {
+            const int shift = kSlotBits * level;
+            if ((m_currentTick & ((qint64(1) << shift) - 1)) != 0) {
+                break;
+            }
+            cascade(level);
+        }
+
+        int* pSlot = &m_slots[m_currentTick & kSlotMask];
+        int index = *pSlot;
+        *pSlot = kNone;
+        while (index != kNone) {
+            Timer& timer = m_timers[index];
+            const int next = timer.next;
+            DEBUG_ASSERT(timer.dueTick <= m_currentTick);
+            timer.slot = kNone;
+            --m_scheduledTimers;
+            pExpiredIds->append(timer.id);
+            if (!timer.oneShot) {
+                timer.dueTick += timer.intervalTicks;
+                schedule(index);
+            }
+            index = next;
+        }
+    }
+}
+
+void TimerWheel::schedule(int index) {
+    Timer& timer = m_timers[index];
+    DEBUG_ASSERT(timer.slot == kNone);
+    qint64 dueTick = math_max(timer.dueTick, m_currentTick);
+    qint64 delta = dueTick - m_currentTick;
+    if (delta > kMaxDelta) {
+        // Rescheduled when the slot has been reached
+        delta = kMaxDelta;
+        dueTick = m_currentTick + delta;
+    }
+    int level = 0;
+    while (level < kLevels - 1 &&
+            delta >= (qint64(1) << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+    timer.slot = level * kSlots +
+            static_cast<int>((dueTick >> (kSlotBits * level)) & kSlotMask);
+    timer.prev = kNone;
+    timer.next = m_slots[timer.slot];
+    if (timer.next != kNone) {
+        m_timers[timer.next].prev = index;
+    }
+    m_slots[timer.slot] = index;
+    ++m_scheduledTimers;
+}
+
+void TimerWheel::unschedule(int index) {
+    Timer& timer = m_timers[index];
+    if (timer.prev != kNone) {
+        m_timers[timer.prev].next = timer.next;
+    } else {
+        m_slots[timer.slot] = timer.next;
+    }
+    if (timer.next != kNone) {
+        m_timers[timer.next].prev = timer.prev;
+    }
+    timer.slot = kNone;
+    --m_scheduledTimers;
+}
+
+void TimerWheel::cascade(int level) {
+    int* pSlot = &m_slots[level * kSlots +
+            ((m_currentTick >> (kSlotBits * level)) & kSlotMask)];
+    int index = *pSlot;
+    *pSlot = kNone;
+    while (index != kNone) {
+        const int next = m_timers[index].next;
+        m_timers[index].slot = kNone;
+        --m_scheduledTimers;
+        schedule(index);
+        index = next;
+    }
+}
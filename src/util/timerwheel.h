@@ -0,0 +1,109 @@
+#ifndef UTIL_TIMERWHEEL_H
+#define UTIL_TIMERWHEEL_H
+
+#include <QVector>
+
+#include "util/class.h"
+
+// A hierarchical timer wheel that keeps many timers with an interval of a
+// number of ticks. The caller advances the wheel with a single periodic
+// tick and receives the ids of the expired timers.
+//
+// Each of the levels has 64 slots. A slot of level n spans 64^n ticks, so
+// the timers that expire soon are kept in the finest level and the others
+// are moved down a level whenever the finer level has wrapped around. All
+// operations are O(1) per timer besides this cascade. The timers are kept
+// in intrusive lists of a pool that is only grown when more timers run at
+// the same time than ever before, so starting and stopping a timer does
+// not allocate memory.
+//
+// The ids are positive and include a generation count, so that the id of
+// a stopped timer does not refer to a timer that reused its entry.
+//
+// The wheel is not thread-safe.
+class TimerWheel {
+  public:
+    TimerWheel();
+
+    // The tick of the wheel. The timers expire when the wheel has been
+    // advanced to the tick at which they are due.
+    qint64 currentTick() const {
+        return m_currentTick;
+    }
+
+    bool isEmpty() const {
+        return m_activeTimers == 0;
+    }
+
+    // Starts a timer that expires intervalTicks (at least 1) after the
+    // current tick and after every further interval unless oneShot is set.
+    // Returns the id of the timer.
+    int start(int intervalTicks, bool oneShot);
+
+    // Returns false if there is no timer with the id.
+    bool stop(int id);
+
+    // Returns true if the timer has been started and not been stopped. An
+    // expired one-shot timer remains active until it is stopped.
+    bool isActive(int id) const;
+
+    // The index of the timer in the pool for keeping data per timer, which
+    // is in the range [0, poolSize())
+    static int indexOf(int id) {
+        return (id & kIndexMask) - 1;
+    }
+
+    int poolSize() const {
+        return m_timers.size();
+    }
+
+    // Advances the wheel to the tick and appends the ids of the timers that
+    // expired in the order in which they were due. Periodic timers are
+    // rescheduled relative to the tick at which they were due, so that they
+    // do not drift if the wheel is advanced late. A wheel without timers
+    // jumps to the tick immediately.
+    void advance(qint64 tick, QVector<int>* pExpiredIds);
+
+  private:
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+    static constexpr int kSlotMask = kSlots - 1;
+    static constexpr int kLevels = 4;
+    // Timers that are due later than this are kept in the coarsest level
+    // and put back into the wheel when their slot has been reached
+    static constexpr qint64 kMaxDelta =
+            (qint64(1) << (kSlotBits * kLevels)) - 1;
+    static constexpr int kIndexBits = 16;
+    static constexpr int kIndexMask = (1 << kIndexBits) - 1;
+    static constexpr int kNone = -1;
+
+    struct Timer {
+        qint64 dueTick;
+        int intervalTicks;
+        int id;
+        // Links of the list of a slot or of the free list
+        int prev;
+        int next;
+        // kNone if the timer is not scheduled
+        int slot;
+        bool oneShot;
+    };
+
+    void schedule(int index);
+    void unschedule(int index);
+    void cascade(int level);
+
+    QVector<Timer> m_timers;
+    // The heads of the lists of the slots of all levels
+    int m_slots[kLevels * kSlots];
+    int m_freeTimers;
+    int m_activeTimers;
+    // The active timers that are in a slot
+    int m_scheduledTimers;
+    int m_generation;
+    qint64 m_currentTick;
+
+    DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+#endif // UTIL_TIMERWHEEL_H
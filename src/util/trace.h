@@ -7,7 +7,9 @@
 #include "util/cmdlineargs.h"
 #include "util/duration.h"
 #include "util/event.h"
+#include "util/flightrecorder.h"
 #include "util/performancetimer.h"
+#include "util/startupbenchmark.h"
 #include "util/stat.h"
 
 class Trace {
@@ -15,8 +17,9 @@ class Trace {
     Trace(const char* tag, const char* arg=NULL,
           bool writeToStdout=false, bool time=true)
             : m_writeToStdout(writeToStdout),
-              m_time(time) {
-        if (writeToStdout || CmdlineArgs::Instance().getDeveloper()) {
+              m_time(time),
+              m_flightRecorderTag(beginFlightRecord(tag, 0)) {
+        if (writeToStdout || isEnabled()) {
             initialize(tag, arg);
         }
     }
@@ -24,8 +27,9 @@ class Trace {
     Trace(const char* tag, int arg,
           bool writeToStdout=false, bool time=true)
             : m_writeToStdout(writeToStdout),
-              m_time(time) {
-        if (writeToStdout || CmdlineArgs::Instance().getDeveloper()) {
+              m_time(time),
+              m_flightRecorderTag(beginFlightRecord(tag, arg)) {
+        if (writeToStdout || isEnabled()) {
             initialize(tag, QString::number(arg));
         }
     }
@@ -33,13 +37,17 @@ class Trace {
     Trace(const char* tag, const QString& arg,
           bool writeToStdout=false, bool time=true)
             : m_writeToStdout(writeToStdout),
-              m_time(time) {
-        if (writeToStdout || CmdlineArgs::Instance().getDeveloper()) {
+              m_time(time),
+              m_flightRecorderTag(beginFlightRecord(tag, 0)) {
+        if (writeToStdout || isEnabled()) {
             initialize(tag, arg);
         }
     }
 
     virtual ~Trace() {
+        if (m_flightRecorderTag) {
+            FlightRecorder::end(m_flightRecorderTag);
+        }
         // Proxy for whether initialize was called.
         if (m_tag.isEmpty()) {
             return;
@@ -69,7 +77,22 @@ class Trace {
         }
     }
 
+    // Traces are recorded in developer mode and for the timeline
+    static bool isEnabled() {
+        return CmdlineArgs::Instance().getDeveloper() ||
+                CmdlineArgs::Instance().getTimelineEnabled();
+    }
+
   private:
+    // Only the tag is recorded, a string argument would have to be copied
+    static const char* beginFlightRecord(const char* tag, int arg) {
+        if (!FlightRecorder::isEnabled()) {
+            return NULL;
+        }
+        FlightRecorder::begin(tag, arg);
+        return tag;
+    }
+
     void initialize(const QString& key, const QString& arg) {
         if (arg.isEmpty()) {
             m_tag = key;
@@ -88,6 +111,7 @@ class Trace {
 
     QString m_tag;
     const bool m_writeToStdout, m_time;
+    const char* const m_flightRecorderTag;
     PerformanceTimer m_timer;
 
 };
@@ -101,4 +125,53 @@ class DebugTrace : public Trace {
     }
 };
 
+// Traces the consecutive phases of a long function, e.g. the startup, as
+// events that are nested into the trace of the function. next() ends the
+// current phase and starts the following one, the last phase ends with the
+// PhaseTrace. The phases are also timed for --startupBenchmark.
+class PhaseTrace {
+  public:
+    explicit PhaseTrace(const char* tag)
+            : m_tag(tag),
+              m_enabled(Trace::isEnabled()),
+              m_benchmark(StartupBenchmark::isEnabled()) {
+    }
+    ~PhaseTrace() {
+        endPhase();
+    }
+
+    void next(const char* phase) {
+        endPhase();
+        if (m_enabled || m_benchmark) {
+            m_phase = QString("%1 %2").arg(m_tag, phase);
+        }
+        if (m_enabled) {
+            Event::start(m_phase);
+        }
+        if (m_benchmark) {
+            m_timer.start();
+        }
+    }
+
+  private:
+    void endPhase() {
+        if (m_phase.isEmpty()) {
+            return;
+        }
+        if (m_enabled) {
+            Event::end(m_phase);
+        }
+        if (m_benchmark) {
+            StartupBenchmark::recordPhase(m_phase, m_timer.elapsed());
+        }
+        m_phase.clear();
+    }
+
+    const QString m_tag;
+    const bool m_enabled;
+    const bool m_benchmark;
+    QString m_phase;
+    PerformanceTimer m_timer;
+};
+
 #endif /* UTIL_TRACE_H */
@@ -0,0 +1,82 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+#include <QAtomicInt>
+
+#include "util/class.h"
+
+// A value that is written by a single thread and read by any number of
+// threads without locks. The writer fills the slot after the one that has
+// been published last and publishes it when it is complete, so a reader
+// that is interrupted while copying the latest value is only overtaken
+// after two more writes. Each slot has a sequence number that is odd while
+// the slot is written, a reader that has been overtaken notices it and
+// copies the latest value again.
+//
+// Unlike ControlValueAtomic the readers do not write to shared memory, so
+// many readers that poll the value in each frame do not contend with each
+// other or with the writer.
+template<typename T>
+class TripleBuffer {
+  public:
+    TripleBuffer()
+            : m_publishedIndex(0),
+              m_writeIndex(0) {
+    }
+
+    // WARNING: Must only be called from a single thread at a time.
+    void write(const T& value) {
+        const int index = (m_writeIndex + 1) % kNumSlots;
+        Slot& slot = m_slots[index];
+        const int sequence = slot.m_sequence.load();
+        slot.m_sequence.store(sequence + 1);
+        // The value must not become visible before the odd sequence
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.m_value = value;
+        slot.m_sequence.storeRelease(sequence + 2);
+        m_publishedIndex.storeRelease(index);
+        m_writeIndex = index;
+    }
+
+    // Returns the value of the last write(), or a default-constructed value
+    // before the first one.
+    T read() const {
+        while (true) {
+            const Slot& slot = m_slots[m_publishedIndex.loadAcquire()];
+            const int sequence = slot.m_sequence.loadAcquire();
+            if (sequence & 1) {
+                // Overtaken twice since loading the index
+                continue;
+            }
+            T value = slot.m_value;
+            // The value must be copied before the sequence is checked again
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.m_sequence.load() == sequence) {
+                return value;
+            }
+        }
+    }
+
+  private:
+    static const int kNumSlots = 3;
+
+    struct Slot {
+        Slot()
+                : m_value(T()),
+                  m_sequence(0) {
+        }
+        T m_value;
+        QAtomicInt m_sequence;
+    };
+
+    Slot m_slots[kNumSlots];
+    QAtomicInt m_publishedIndex;
+    // Only used by the writer
+    int m_writeIndex;
+
+    DISALLOW_COPY_AND_ASSIGN(TripleBuffer);
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,268 @@
+#include "vinylcontrol/timecodelookupcache.h"
+
+#include <cstring>
+
+#include <QDir>
+#include <QFile>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrentRun>
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+#include <QSaveFile>
+#endif
+
+#include "util/assert.h"
+#include "util/logger.h"
+#include "util/memory.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+const mixxx::Logger kLogger("TimecodeLookupCache");
+
+// Identifies the format of the cache files. The tables are written in the
+// memory layout of the machine, so the header also contains the sizes.
+const char kMagic[8] = { 'M', 'X', 'L', 'U', 'T', 'B', 'L', '1' };
+
+const int kHashes = 1 << LUT_HASH_BITS;
+const slot_no_t kNoSlot = static_cast<slot_no_t>(-1);
+
+struct CacheFileHeader {
+    char magic[8];
+    quint32 bits;
+    quint32 seed;
+    quint32 taps;
+    quint32 length;
+    quint32 hashes;
+    quint32 slotSize;
+};
+// The slots that follow the header must be aligned
+static_assert(sizeof(CacheFileHeader) % 8 == 0,
+        "Unaligned size of CacheFileHeader");
+
+struct Entry {
+    Entry() : refCount(0) {}
+    int refCount;
+    // The mapped cache file of the table, or null if the table has been
+    // built by xwax
+    std::shared_ptr<QFile> pFile;
+};
+
+QMutex s_mutex;
+QHash<timecode_def*, Entry> s_entries;
+QString s_cacheDirPath;
+QFuture<void> s_preparation;
+
+CacheFileHeader headerOf(const timecode_def* pDefinition) {
+    CacheFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.bits = pDefinition->bits;
+    header.seed = pDefinition->seed;
+    header.taps = pDefinition->taps;
+    header.length = pDefinition->length;
+    header.hashes = kHashes;
+    header.slotSize = sizeof(slot);
+    return header;
+}
+
+qint64 cacheFileSize(const timecode_def* pDefinition) {
+    return sizeof(CacheFileHeader) +
+            sizeof(slot) * static_cast<qint64>(pDefinition->length) +
+            sizeof(slot_no_t) * static_cast<qint64>(kHashes);
+}
+
+QString cacheFilePath(const timecode_def* pDefinition) {
+    return QDir(s_cacheDirPath).filePath(
+            QString("timecode_%1.lut").arg(pDefinition->name));
+}
+
+// A damaged file must not let a lookup read beyond the tables
+bool verifySlotNumbers(const slot_no_t* pSlotNumbers, int count,
+        unsigned int length) {
+    for (int i = 0; i < count; ++i) {
+        if (pSlotNumbers[i] != kNoSlot && pSlotNumbers[i] >= length) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool mapCacheFile(timecode_def* pDefinition, Entry* pEntry) {
+    if (s_cacheDirPath.isEmpty()) {
+        return false;
+    }
+    auto pFile = std::make_shared<QFile>(cacheFilePath(pDefinition));
+    if (!pFile->exists()) {
+        return false;
+    }
+    if (!pFile->open(QIODevice::ReadOnly) ||
+            pFile->size() != cacheFileSize(pDefinition)) {
+        kLogger.warning()
+                << "Ignoring invalid cache file" << pFile->fileName();
+        return false;
+    }
+    uchar* pData = pFile->map(0, pFile->size());
+    if (!pData) {
+        kLogger.warning()
+                << "Failed to map cache file" << pFile->fileName()
+                << pFile->errorString();
+        return false;
+    }
+    const CacheFileHeader expectedHeader = headerOf(pDefinition);
+    if (std::memcmp(pData, &expectedHeader, sizeof(expectedHeader)) != 0) {
+        kLogger.warning()
+                << "Ignoring outdated cache file" << pFile->fileName();
+        return false;
+    }
+    slot* pSlots = reinterpret_cast<slot*>(pData + sizeof(CacheFileHeader));
+    slot_no_t* pTable = reinterpret_cast<slot_no_t*>(
+            pData + sizeof(CacheFileHeader) + sizeof(slot) * pDefinition->length);
+    bool valid = verifySlotNumbers(pTable, kHashes, pDefinition->length);
+    for (unsigned int i = 0; valid && i < pDefinition->length; ++i) {
+        valid = verifySlotNumbers(&pSlots[i].next, 1, pDefinition->length);
+    }
+    if (!valid) {
+        kLogger.warning()
+                << "Ignoring damaged cache file" << pFile->fileName();
+        return false;
+    }
+    // The mapped memory is read-only, but xwax only writes into a table
+    // while building it
+    timecoder_set_lookup(pDefinition, pSlots, pTable);
+    pEntry->pFile = pFile;
+    return true;
+}
+
+bool writeTables(QIODevice* pDevice, const timecode_def* pDefinition) {
+    const CacheFileHeader header = headerOf(pDefinition);
+    const qint64 slotsSize = sizeof(slot) * static_cast<qint64>(pDefinition->length);
+    const qint64 tableSize = sizeof(slot_no_t) * static_cast<qint64>(kHashes);
+    return pDevice->write(reinterpret_cast<const char*>(&header),
+                   sizeof(header)) == sizeof(header) &&
+            pDevice->write(reinterpret_cast<const char*>(pDefinition->lut.slot),
+                   slotsSize) == slotsSize &&
+            pDevice->write(reinterpret_cast<const char*>(pDefinition->lut.table),
+                   tableSize) == tableSize;
+}
+
+void saveCacheFile(const timecode_def* pDefinition) {
+    if (s_cacheDirPath.isEmpty() || !QDir().mkpath(s_cacheDirPath)) {
+        return;
+    }
+    const QString filePath = cacheFilePath(pDefinition);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+    // Replaces the file only after all tables have been written
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) ||
+            !writeTables(&file, pDefinition) || !file.commit()) {
+        kLogger.warning()
+                << "Failed to write cache file" << filePath
+                << file.errorString();
+    }
+#else
+    const QString tempFilePath = filePath + ".tmp";
+    QFile file(tempFilePath);
+    bool written = file.open(QIODevice::WriteOnly) &&
+            writeTables(&file, pDefinition);
+    file.close();
+    if (written) {
+        // QFile::rename() does not replace an existing file
+        QFile::remove(filePath);
+        written = QFile::rename(tempFilePath, filePath);
+    }
+    if (!written) {
+        kLogger.warning()
+                << "Failed to write cache file" << filePath
+                << file.errorString();
+        QFile::remove(tempFilePath);
+    }
+#endif
+}
+
+void prepareTimecodes(const QStringList& timecodes) {
+    for (const auto& timecode : timecodes) {
+        // A table that is missing in the cache is built and written, the
+        // memory is freed again unless a deck has acquired it meanwhile
+        TimecodeLookupCache::release(
+                TimecodeLookupCache::acquire(timecode.toLatin1().constData()));
+    }
+}
+
+} // anonymous namespace
+
+// static
+void TimecodeLookupCache::setCacheDirectory(const QString& dirPath) {
+    QMutexLocker locker(&s_mutex);
+    s_cacheDirPath = dirPath;
+}
+
+// static
+timecode_def* TimecodeLookupCache::acquire(const char* timecode) {
+    QMutexLocker locker(&s_mutex);
+    timecode_def* pDefinition = timecoder_get_definition_by_name(timecode);
+    if (!pDefinition) {
+        return nullptr;
+    }
+    Entry entry = s_entries.value(pDefinition);
+    if (entry.refCount == 0 && !pDefinition->lookup &&
+            !mapCacheFile(pDefinition, &entry)) {
+        PerformanceTimer timer;
+        timer.start();
+        if (timecoder_build_lookup(pDefinition) == -1) {
+            kLogger.warning()
+                    << "Failed to build the lookup table of" << timecode;
+            return nullptr;
+        }
+        kLogger.info()
+                << "Built the lookup table of" << timecode << "in"
+                << timer.elapsed().debugMillisWithUnit();
+        saveCacheFile(pDefinition);
+    }
+    ++entry.refCount;
+    s_entries.insert(pDefinition, entry);
+    return pDefinition;
+}
+
+// static
+void TimecodeLookupCache::release(timecode_def* pDefinition) {
+    if (!pDefinition) {
+        return;
+    }
+    QMutexLocker locker(&s_mutex);
+    auto it = s_entries.find(pDefinition);
+    VERIFY_OR_DEBUG_ASSERT(it != s_entries.end() && it->refCount > 0) {
+        return;
+    }
+    if (--it->refCount > 0) {
+        return;
+    }
+    // Frees a built table before the mapped file is closed
+    timecoder_clear_lookup(pDefinition);
+    s_entries.erase(it);
+}
+
+// static
+void TimecodeLookupCache::prepareInBackground(const QStringList& timecodes) {
+    QMutexLocker locker(&s_mutex);
+    if (s_cacheDirPath.isEmpty() || timecodes.isEmpty()) {
+        // Nothing would be kept for later
+        return;
+    }
+    locker.unlock();
+    // Follows a preparation that is still running
+    waitForPreparation();
+    locker.relock();
+    s_preparation = QtConcurrent::run(&prepareTimecodes, timecodes);
+}
+
+// static
+void TimecodeLookupCache::waitForPreparation() {
+    QMutexLocker locker(&s_mutex);
+    QFuture<void> preparation = s_preparation;
+    locker.unlock();
+    preparation.waitForFinished();
+}
@@ -0,0 +1,45 @@
+#ifndef VINYLCONTROL_TIMECODELOOKUPCACHE_H
+#define VINYLCONTROL_TIMECODELOOKUPCACHE_H
+
+#include <QString>
+#include <QStringList>
+
+#ifdef _MSC_VER
+#include "timecoder.h"
+#else
+extern "C" {
+#include "timecoder.h"
+}
+#endif
+
+// Shares the lookup tables of the xwax timecode definitions between all
+// vinyl control decks. Building the table of a long timecode takes a
+// noticeable time and several MB, so it is written to a cache file once
+// and mapped into memory when it is used again. A table is freed when the
+// last deck that uses it has released it.
+//
+// All functions are thread-safe.
+class TimecodeLookupCache {
+  public:
+    // The directory of the cache files. Without a directory the tables
+    // are built every time they are acquired.
+    static void setCacheDirectory(const QString& dirPath);
+
+    // Returns the definition with its lookup table, or null if the
+    // definition does not exist or the table could not be built. Blocks
+    // while the table is loaded or built.
+    static timecode_def* acquire(const char* timecode);
+    static void release(timecode_def* pDefinition);
+
+    // Writes the cache files of the timecodes that are missing in a
+    // thread of the global thread pool, so enabling vinyl control only
+    // needs to map the file later.
+    static void prepareInBackground(const QStringList& timecodes);
+    // Waits until the background preparation has finished
+    static void waitForPreparation();
+
+  private:
+    TimecodeLookupCache() = delete;
+};
+
+#endif // VINYLCONTROL_TIMECODELOOKUPCACHE_H
@@ -4,12 +4,15 @@
  * @date April 15, 2011
  */
 
+#include <QDir>
+
 #include "control/controlobject.h"
 #include "control/controlproxy.h"
 #include "mixer/playermanager.h"
 #include "soundio/soundmanager.h"
 #include "util/timer.h"
 #include "vinylcontrol/defs_vinylcontrol.h"
+#include "vinylcontrol/timecodelookupcache.h"
 #include "vinylcontrol/vinylcontrol.h"
 #include "vinylcontrol/vinylcontrolprocessor.h"
 #include "vinylcontrol/vinylcontrolxwax.h"
@@ -34,6 +37,26 @@ VinylControlManager::VinylControlManager(QObject* pParent,
 
     connect(&m_vinylControlEnabledMapper, SIGNAL(mapped(int)),
             this, SLOT(slotVinylControlEnabledChanged(int)));
+
+    // Build the lookup tables of the configured timecodes that are not
+    // cached yet now, so they do not need to be built when vinyl control is
+    // enabled for a deck
+    TimecodeLookupCache::setCacheDirectory(
+            QDir(pConfig->getSettingsPath()).filePath("timecodecache"));
+    QStringList timecodes;
+    for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
+        const QString vinylType = pConfig->getValueString(
+                ConfigKey(kVCGroup.arg(i + 1), "vinylcontrol_vinyl_type"));
+        if (vinylType.isEmpty()) {
+            continue;
+        }
+        const QString timecode =
+                VinylControlXwax::timecodeForVinylType(vinylType);
+        if (!timecodes.contains(timecode)) {
+            timecodes.append(timecode);
+        }
+    }
+    TimecodeLookupCache::prepareInBackground(timecodes);
 }
 
 VinylControlManager::~VinylControlManager() {
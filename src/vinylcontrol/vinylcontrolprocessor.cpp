@@ -1,4 +1,5 @@
 #include <QMutexLocker>
+#include <QSemaphore>
 
 #include "vinylcontrol/vinylcontrolprocessor.h"
 
@@ -8,17 +9,63 @@
 #include "util/sample.h"
 #include "util/timer.h"
 #include "vinylcontrol/defs_vinylcontrol.h"
+#include "vinylcontrol/timecodelookupcache.h"
 #include "vinylcontrol/vinylcontrol.h"
 #include "vinylcontrol/vinylcontrolxwax.h"
 
 #define SIGNAL_QUALITY_FIFO_SIZE 256
 #define SAMPLE_PIPE_FIFO_SIZE 65536
 
+// Decodes the samples of one deck as soon as the engine callback has written
+// them into the sample pipe of the deck.
+class VinylControlProcessor::DeckThread : public QThread {
+  public:
+    DeckThread(VinylControlProcessor* pProcessor, int index)
+            : m_pProcessor(pProcessor),
+              m_index(index),
+              m_pWorkBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
+              m_bQuit(false) {
+        start(QThread::HighPriority);
+    }
+    ~DeckThread() override {
+        m_bQuit = true;
+        wake();
+        wait();
+        SampleUtil::free(m_pWorkBuffer);
+    }
+
+    // Called by the engine callback, unlike a wait condition a wake-up
+    // can't get lost
+    void wake() {
+        m_samplesAvailable.release();
+    }
+
+  private:
+    void run() override {
+        QThread::currentThread()->setObjectName(
+                QString("VinylControlDeck %1").arg(m_index + 1));
+        while (!m_bQuit) {
+            m_samplesAvailable.acquire();
+            // All samples are read at once
+            m_samplesAvailable.tryAcquire(m_samplesAvailable.available());
+            if (m_bQuit) {
+                break;
+            }
+            m_pProcessor->processDeck(m_index, m_pWorkBuffer);
+        }
+    }
+
+    VinylControlProcessor* const m_pProcessor;
+    const int m_index;
+    CSAMPLE* const m_pWorkBuffer;
+    QSemaphore m_samplesAvailable;
+    volatile bool m_bQuit;
+};
+
 VinylControlProcessor::VinylControlProcessor(QObject* pParent, UserSettingsPointer pConfig)
         : QThread(pParent),
           m_pConfig(pConfig),
           m_pToggle(new ControlPushButton(ConfigKey(VINYL_PREF_KEY, "Toggle"))),
-          m_pWorkBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
           m_processorsLock(QMutex::Recursive),
           m_processors(kMaximumVinylControlInputs, NULL),
           m_signalQualityFifo(SIGNAL_QUALITY_FIFO_SIZE),
@@ -31,18 +78,23 @@ VinylControlProcessor::VinylControlProcessor(QObject* pParent, UserSettingsPoint
 
     for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
         m_samplePipes[i] = new FIFO<CSAMPLE>(SAMPLE_PIPE_FIFO_SIZE);
+        m_deckThreads[i] = new DeckThread(this, i);
     }
 
     start(QThread::HighPriority);
 }
 
 VinylControlProcessor::~VinylControlProcessor() {
-    m_bQuit = true;
-    m_samplesAvailableSignal.wakeAll();
+    shutdown();
     wait();
 
+    // The deck threads are stopped before their processors are deleted
+    for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
+        delete m_deckThreads[i];
+        m_deckThreads[i] = NULL;
+    }
+
     delete m_pToggle;
-    SampleUtil::free(m_pWorkBuffer);
 
     {
         QMutexLocker locker(&m_processorsLock);
@@ -56,9 +108,9 @@ VinylControlProcessor::~VinylControlProcessor() {
         }
     }
 
-    // xwax has a global LUT that we need to free after we've shut down our
-    // vinyl control threads because it's not thread-safe.
-    VinylControlXwax::freeLUTs();
+    // The lookup tables have been released by the decks, but they might
+    // still be prepared in the background.
+    TimecodeLookupCache::waitForPreparation();
 }
 
 void VinylControlProcessor::setSignalQualityReporting(bool enable) {
@@ -66,73 +118,85 @@ void VinylControlProcessor::setSignalQualityReporting(bool enable) {
 }
 
 void VinylControlProcessor::shutdown() {
+    QMutexLocker locker(&m_requestMutex);
     m_bQuit = true;
-    m_samplesAvailableSignal.wakeAll();
+    m_requestSignal.wakeAll();
 }
 
 void VinylControlProcessor::requestReloadConfig() {
+    QMutexLocker locker(&m_requestMutex);
     m_bReloadConfig = true;
-    m_samplesAvailableSignal.wakeAll();
+    m_requestSignal.wakeAll();
 }
 
 void VinylControlProcessor::run() {
     unsigned static id = 0; //the id of this thread, for debugging purposes //XXX copypasta (should factor this out somehow), -kousu 2/2009
     QThread::currentThread()->setObjectName(QString("VinylControlProcessor %1").arg(++id));
 
+    QMutexLocker locker(&m_requestMutex);
     while (!m_bQuit) {
-        Event::start("VinylControlProcessor");
         if (m_bReloadConfig) {
-            reloadConfig();
             m_bReloadConfig = false;
+            locker.unlock();
+            reloadConfig();
+            locker.relock();
+            continue;
         }
+        // Wait for a request from the main thread.
+        m_requestSignal.wait(&m_requestMutex);
+    }
+}
 
-        for (int i = 0; i < kMaximumVinylControlInputs; ++i) {
-            QMutexLocker locker(&m_processorsLock);
-            VinylControl* pProcessor = m_processors[i];
-            locker.unlock();
-            FIFO<CSAMPLE>* pSamplePipe = m_samplePipes[i];
-
-            if (pSamplePipe->readAvailable() > 0) {
-                int samplesRead = pSamplePipe->read(m_pWorkBuffer, MAX_BUFFER_LEN);
-
-                if (samplesRead % 2 != 0) {
-                    qWarning() << "VinylControlProcessor received non-even number of samples via sample FIFO.";
-                    samplesRead--;
-                }
-                int framesRead = samplesRead / 2;
-
-                if (pProcessor) {
-                    pProcessor->analyzeSamples(m_pWorkBuffer, framesRead);
-                } else {
-                    // Samples are being written to a non-existent processor. Warning?
-                    qWarning() << "Samples written to non-existent VinylControl processor:" << i;
-                }
-            }
+void VinylControlProcessor::processDeck(int index, CSAMPLE* pWorkBuffer) {
+    QMutexLocker deckLocker(&m_deckLocks[index]);
+    Event::start("VinylControlProcessor");
+    QMutexLocker locker(&m_processorsLock);
+    VinylControl* pProcessor = m_processors[index];
+    locker.unlock();
+    FIFO<CSAMPLE>* pSamplePipe = m_samplePipes[index];
 
-            // TODO(rryan) define a time-based update rate. This will update way
-            // too quickly.
-            if (pProcessor && m_bReportSignalQuality) {
-                VinylSignalQualityReport report;
-                if (pProcessor->writeQualityReport(&report)) {
-                    report.processor = i;
-                    if (m_signalQualityFifo.write(&report, 1) != 1) {
-                        qWarning() << "VinylControlProcessor could not write signal quality report for VC index:" << i;
-                    }
-                }
-            }
+    while (pSamplePipe->readAvailable() > 0) {
+        int samplesRead = pSamplePipe->read(pWorkBuffer, MAX_BUFFER_LEN);
+
+        if (samplesRead % 2 != 0) {
+            qWarning() << "VinylControlProcessor received non-even number of samples via sample FIFO.";
+            samplesRead--;
         }
+        int framesRead = samplesRead / 2;
 
-        if (m_bQuit) {
-            break;
+        if (pProcessor) {
+            pProcessor->analyzeSamples(pWorkBuffer, framesRead);
+        } else {
+            // Samples are being written to a non-existent processor. Warning?
+            qWarning() << "Samples written to non-existent VinylControl processor:" << index;
         }
+    }
 
-        // Wait for a signal from the main thread or engine thread that we
-        // should wake up and process input.
-        Event::end("VinylControlProcessor");
-        m_waitForSampleMutex.lock();
-        m_samplesAvailableSignal.wait(&m_waitForSampleMutex);
-        m_waitForSampleMutex.unlock();
+    // TODO(rryan) define a time-based update rate. This will update way
+    // too quickly.
+    if (pProcessor && m_bReportSignalQuality) {
+        VinylSignalQualityReport report;
+        if (pProcessor->writeQualityReport(&report)) {
+            report.processor = index;
+            QMutexLocker fifoLocker(&m_signalQualityFifoLock);
+            if (m_signalQualityFifo.write(&report, 1) != 1) {
+                qWarning() << "VinylControlProcessor could not write signal quality report for VC index:" << index;
+            }
+        }
     }
+    Event::end("VinylControlProcessor");
+}
+
+void VinylControlProcessor::replaceProcessor(int index, VinylControl* pNew) {
+    QMutexLocker locker(&m_processorsLock);
+    VinylControl* pCurrent = m_processors.at(index);
+    m_processors.replace(index, pNew);
+    locker.unlock();
+    // The deck thread picks up the new processor the next time. Delete
+    // outside of the critical section to avoid deadlocks.
+    QMutexLocker deckLocker(&m_deckLocks[index]);
+    deckLocker.unlock();
+    delete pCurrent;
 }
 
 void VinylControlProcessor::reloadConfig() {
@@ -144,12 +208,10 @@ void VinylControlProcessor::reloadConfig() {
             continue;
         }
 
-        VinylControl *pNew = new VinylControlXwax(
-            m_pConfig, kVCGroup.arg(i + 1));
-        m_processors.replace(i, pNew);
         locker.unlock();
-        // Delete outside of the critical section to avoid deadlocks.
-        delete pCurrent;
+
+        replaceProcessor(i, new VinylControlXwax(
+            m_pConfig, kVCGroup.arg(i + 1)));
     }
 }
 
@@ -166,15 +228,8 @@ void VinylControlProcessor::onInputConfigured(AudioInput input) {
         return;
     }
 
-    VinylControl *pNew = new VinylControlXwax(
-        m_pConfig, kVCGroup.arg(index + 1));
-
-    QMutexLocker locker(&m_processorsLock);
-    VinylControl* pCurrent = m_processors.at(index);
-    m_processors.replace(index, pNew);
-    locker.unlock();
-    // Delete outside of the critical section to avoid deadlocks.
-    delete pCurrent;
+    replaceProcessor(index, new VinylControlXwax(
+        m_pConfig, kVCGroup.arg(index + 1)));
 }
 
 void VinylControlProcessor::onInputUnconfigured(AudioInput input) {
@@ -191,12 +246,7 @@ void VinylControlProcessor::onInputUnconfigured(AudioInput input) {
         return;
     }
 
-    QMutexLocker locker(&m_processorsLock);
-    VinylControl* pVC = m_processors.at(index);
-    m_processors.replace(index, NULL);
-    locker.unlock();
-    // Delete outside of the critical section to avoid deadlocks.
-    delete pVC;
+    replaceProcessor(index, NULL);
 }
 
 bool VinylControlProcessor::deckConfigured(int index) const {
@@ -235,7 +285,7 @@ void VinylControlProcessor::receiveBuffer(AudioInput input,
                    << "VCIndex:" << vcIndex;
     }
 
-    m_samplesAvailableSignal.wakeAll();
+    m_deckThreads[vcIndex]->wake();
 }
 
 void VinylControlProcessor::toggleDeck(double value) {
@@ -19,6 +19,10 @@ class ControlPushButton;
 // the engine callback and feeding those samples to the VinylControl
 // classes. The most important thing is that the connection between the engine
 // callback and VinylControlProcessor (the receiveBuffer method) is lock-free.
+//
+// The timecode of each deck is decoded by a thread of its own, so the pitch
+// of a deck is not delayed by decoding the other decks. The
+// VinylControlProcessor thread itself only reloads the configuration.
 class VinylControlProcessor : public QThread, public AudioDestination {
     Q_OBJECT
   public:
@@ -63,7 +67,14 @@ class VinylControlProcessor : public QThread, public AudioDestination {
     void toggleDeck(double value);
 
   private:
+    class DeckThread;
+
     void reloadConfig();
+    // Called by the DeckThread of the deck
+    void processDeck(int index, CSAMPLE* pWorkBuffer);
+    // Deletes the previous processor after the deck thread has finished
+    // with it
+    void replaceProcessor(int index, VinylControl* pNew);
 
     UserSettingsPointer m_pConfig;
     ControlPushButton* m_pToggle;
@@ -71,12 +82,17 @@ class VinylControlProcessor : public QThread, public AudioDestination {
     // callback to the processor thread. There is a maximum of
     // kMaximumVinylControlInputs pipes.
     FIFO<CSAMPLE>* m_samplePipes[kMaximumVinylControlInputs];
-    CSAMPLE* m_pWorkBuffer;
-    QWaitCondition m_samplesAvailableSignal;
-    QMutex m_waitForSampleMutex;
+    DeckThread* m_deckThreads[kMaximumVinylControlInputs];
+    // Held by a deck thread while it uses the processor of the deck
+    QMutex m_deckLocks[kMaximumVinylControlInputs];
+    // Wakes the VinylControlProcessor thread for reloading or quitting
+    QWaitCondition m_requestSignal;
+    QMutex m_requestMutex;
     QMutex m_processorsLock;
     QVector<VinylControl*> m_processors;
     FIFO<VinylSignalQualityReport> m_signalQualityFifo;
+    // The reports of the deck threads are written one by one into the fifo
+    QMutex m_signalQualityFifoLock;
     volatile bool m_bReportSignalQuality;
     volatile bool m_bQuit;
     volatile bool m_bReloadConfig;
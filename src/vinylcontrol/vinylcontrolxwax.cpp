@@ -23,11 +23,13 @@
 #include <limits.h>
 
 #include "vinylcontrol/vinylcontrolxwax.h"
+#include "util/time.h"
 #include "util/timer.h"
 #include "control/controlproxy.h"
 #include "control/controlobject.h"
 #include "util/math.h"
 #include "util/defs.h"
+#include "vinylcontrol/timecodelookupcache.h"
 
 /****** TODO *******
    Stuff to maybe implement here
@@ -41,14 +43,12 @@
 // Sample threshold below which we consider there to be no signal.
 const double kMinSignal = 75.0 / SAMPLE_MAX;
 
-bool VinylControlXwax::s_bLUTInitialized = false;
-QMutex VinylControlXwax::s_xwaxLUTMutex;
+// The part of the pitch ring that is averaged with a perfect signal
+const double kMinPitchRingFraction = 0.25;
 
 VinylControlXwax::VinylControlXwax(UserSettingsPointer pConfig, QString group)
         : VinylControl(pConfig, group),
           m_dVinylPositionOld(0.0),
-          m_pWorkBuffer(new short[MAX_BUFFER_LEN]),
-          m_workBufferSize(MAX_BUFFER_LEN),
           m_iQualPos(0),
           m_iQualFilled(0),
           m_iPosition(-1),
@@ -74,7 +74,9 @@ VinylControlXwax::VinylControlXwax(UserSettingsPointer pConfig, QString group)
           m_dLastTrackSelectPos(0.0),
           m_dCurTrackSelectPos(0.0),
           m_dDriftAmt(0.0),
-          m_dUiUpdateTime(-1.0) {
+          m_dUiUpdateTime(-1.0),
+          m_pTimecodeDefinition(NULL),
+          m_pPitchChannel(VinylPitchChannel::forGroup(group)) {
     // TODO(rryan): Should probably live in VinylControlManager since it's not
     // specific to a VC deck.
     signalenabled->slotSet(m_pConfig->getValueString(
@@ -86,31 +88,12 @@ VinylControlXwax::VinylControlXwax(UserSettingsPointer pConfig, QString group)
     QString strVinylSpeed = m_pConfig->getValueString(
         ConfigKey(group,"vinylcontrol_speed_type"));
 
-    // libxwax indexes by C-strings so we pass libxwax string literals so we
-    // don't have to deal with freeing the strings later
-    char* timecode = NULL;
-
-
-    if (strVinylType == MIXXX_VINYL_SERATOCV02VINYLSIDEA) {
-        timecode = (char*)"serato_2a";
-    }
-    else if (strVinylType == MIXXX_VINYL_SERATOCV02VINYLSIDEB) {
-        timecode = (char*)"serato_2b";
-    } else if (strVinylType == MIXXX_VINYL_SERATOCD) {
-        timecode = (char*)"serato_cd";
+    const char* timecode = timecodeForVinylType(strVinylType);
+    if (strVinylType == MIXXX_VINYL_SERATOCD) {
         m_bCDControl = true;
         // Set up very sensitive steady monitors for CDJs.
         m_pSteadySubtle = new SteadyPitch(0.06, true);
         m_pSteadyGross = new SteadyPitch(0.25, true);
-    } else if (strVinylType == MIXXX_VINYL_TRAKTORSCRATCHSIDEA) {
-        timecode = (char*)"traktor_a";
-    } else if (strVinylType == MIXXX_VINYL_TRAKTORSCRATCHSIDEB) {
-        timecode = (char*)"traktor_b";
-    } else if (strVinylType == MIXXX_VINYL_MIXVIBESDVS) {
-        timecode = (char*)"mixvibes_v2";
-    } else {
-        qDebug() << "Unknown vinyl type, defaulting to serato_2a";
-        timecode = (char*)"serato_2a";
     }
 
     // If we didn't set up the steady monitors already (not CDJ), do it now.
@@ -122,11 +105,12 @@ VinylControlXwax::VinylControlXwax(UserSettingsPointer pConfig, QString group)
     }
 
 
-    timecode_def* tc_def = timecoder_find_definition(timecode);
-    if (tc_def == NULL) {
+    // The lookup table is shared with the other decks and mapped from the
+    // cache file if it has been built before
+    m_pTimecodeDefinition = TimecodeLookupCache::acquire(timecode);
+    if (m_pTimecodeDefinition == NULL) {
         qDebug() << "Error finding timecode definition for " << timecode << ", defaulting to serato_2a";
-        timecode = (char*)"serato_2a";
-        tc_def = timecoder_find_definition(timecode);
+        m_pTimecodeDefinition = TimecodeLookupCache::acquire("serato_2a");
     }
 
     double speed = 1.0;
@@ -147,25 +131,19 @@ VinylControlXwax::VinylControlXwax(UserSettingsPointer pConfig, QString group)
         ConfigKey("[Soundcard]","Samplerate")).toULong();
 
     // Set pitch ring size to 1/4 of one revolution -- a full revolution adds
-    // too much stickiness to the pitch.
+    // too much stickiness to the pitch. With a clean signal only a part of it
+    // is averaged, see pitchRingWindow().
     m_iPitchRingSize = static_cast<int>(60000 / (rpm * latency * 4));
     m_pPitchRing = new double[m_iPitchRingSize];
 
     qDebug() << "Xwax Vinyl control starting with a sample rate of:" << iSampleRate;
-    qDebug() << "Building timecode lookup tables for" << strVinylType << "with speed" << strVinylSpeed;
-
-    // Initialize the timecoder structure. Use the static mutex so that we only
-    // do this once across the VinylControlXwax instances.
-    s_xwaxLUTMutex.lock();
+    qDebug() << "Using timecode lookup tables for" << strVinylType << "with speed" << strVinylSpeed;
 
-    timecoder_init(&timecoder, tc_def, speed, iSampleRate, /* phono */ false);
+    // Initialize the timecoder structure. The lookup table has already been
+    // built by TimecodeLookupCache.
+    timecoder_init(&timecoder, m_pTimecodeDefinition, speed, iSampleRate, /* phono */ false);
     timecoder_monitor_init(&timecoder, MIXXX_VINYL_SCOPE_SIZE);
-    //Note that timecoder_init will not double-malloc the LUTs, and after this we are guaranteed
-    //that the LUT has been generated unless we ran out of memory.
-    s_bLUTInitialized = true;
     m_uiSafeZone = timecoder_get_safe(&timecoder);
-    //}
-    s_xwaxLUTMutex.unlock();
 
     qDebug() << "Starting vinyl control xwax thread";
 }
@@ -174,27 +152,36 @@ VinylControlXwax::~VinylControlXwax() {
     delete m_pSteadySubtle;
     delete m_pSteadyGross;
     delete [] m_pPitchRing;
-    delete [] m_pWorkBuffer;
 
     // Cleanup xwax nicely
     timecoder_monitor_clear(&timecoder);
     timecoder_clear(&timecoder);
+    // Frees the lookup table if no other deck uses it
+    TimecodeLookupCache::release(m_pTimecodeDefinition);
 
-    // TODO(rryan): This looks wrong. freeLUTs is called later by
-    // VinylControlProcessor so we are probably leaking the LUTs.
-    s_bLUTInitialized = false;
-
+    m_pPitchChannel->reset();
     m_pVCRate->set(0.0);
 }
 
 //static
-void VinylControlXwax::freeLUTs() {
-    s_xwaxLUTMutex.lock(); //Static mutex! We don't want two threads doing this!
-    if (s_bLUTInitialized) {
-        timecoder_free_lookup(); //Frees all the LUTs in xwax.
-        s_bLUTInitialized = false;
-    }
-    s_xwaxLUTMutex.unlock();
+const char* VinylControlXwax::timecodeForVinylType(const QString& vinylType) {
+    // libxwax indexes by C-strings so we pass libxwax string literals so we
+    // don't have to deal with freeing the strings later
+    if (vinylType == MIXXX_VINYL_SERATOCV02VINYLSIDEA) {
+        return "serato_2a";
+    } else if (vinylType == MIXXX_VINYL_SERATOCV02VINYLSIDEB) {
+        return "serato_2b";
+    } else if (vinylType == MIXXX_VINYL_SERATOCD) {
+        return "serato_cd";
+    } else if (vinylType == MIXXX_VINYL_TRAKTORSCRATCHSIDEA) {
+        return "traktor_a";
+    } else if (vinylType == MIXXX_VINYL_TRAKTORSCRATCHSIDEB) {
+        return "traktor_b";
+    } else if (vinylType == MIXXX_VINYL_MIXVIBESDVS) {
+        return "mixvibes_v2";
+    }
+    qDebug() << "Unknown vinyl type, defaulting to serato_2a";
+    return "serato_2a";
 }
 
 
@@ -212,37 +199,16 @@ bool VinylControlXwax::writeQualityReport(VinylSignalQualityReport* pReport) {
 void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
     ScopedTimer t("VinylControlXwax::analyzeSamples");
     CSAMPLE gain = m_pVinylControlInputGain->get();
-    const int kChannels = 2;
 
     // We only support amplifying with the VC pre-amp.
     if (gain < 1.0f) {
         gain = 1.0f;
     }
 
-    size_t samplesSize = nFrames * kChannels;
-
-    if (samplesSize > m_workBufferSize) {
-        delete [] m_pWorkBuffer;
-        m_pWorkBuffer = new short[samplesSize];
-        m_workBufferSize = samplesSize;
-    }
-
-    // Convert CSAMPLE samples to shorts, preventing overflow.
-    for (int i = 0; i < static_cast<int>(samplesSize); ++i) {
-        CSAMPLE sample = pSamples[i] * gain * SAMPLE_MAX;
-
-        if (sample > SAMPLE_MAX) {
-            m_pWorkBuffer[i] = SAMPLE_MAX;
-        } else if (sample < SAMPLE_MIN) {
-            m_pWorkBuffer[i] = SAMPLE_MIN;
-        } else {
-            m_pWorkBuffer[i] = static_cast<short>(sample);
-        }
-    }
-
-    // Submit the samples to the xwax timecode processor. The size argument is
-    // in stereo frames.
-    timecoder_submit(&timecoder, m_pWorkBuffer, nFrames);
+    // Submit the samples to the xwax timecode processor. They are scaled
+    // and clamped to the range of shorts while decoding. The size argument
+    // is in stereo frames.
+    timecoder_submit_float(&timecoder, pSamples, nFrames, gain);
 
     bool bHaveSignal = fabs(pSamples[0]) + fabs(pSamples[1]) > kMinSignal;
     //qDebug() << "signal?" << bHaveSignal;
@@ -401,7 +367,7 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
                         m_bTrackSelectMode = true;
                         togglePlayButton(false);
                         resetSteadyPitch(0.0, 0.0);
-                        m_pVCRate->set(0.0);
+                        setRate(0.0);
                     }
                     doTrackSelection(true, dVinylPitch, m_iPosition);
                 }
@@ -445,7 +411,7 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
         // or 1 (plays back at that rate)
 
         double newScratch = reportedPlayButton ? calcRateRatio() : 0.0;
-        m_pVCRate->set(newScratch);
+        setRate(newScratch);
 
         // is there any reason we'd need to do anything else?
         return;
@@ -514,7 +480,7 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
                 //end of track, force stop
                 togglePlayButton(false);
                 resetSteadyPitch(0.0, 0.0);
-                m_pVCRate->set(0.0);
+                setRate(0.0);
                 m_iPitchRingPos = 0;
                 m_iPitchRingFilled = 0;
                 return;
@@ -541,7 +507,7 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
                 //end of track, force stop
                 togglePlayButton(false);
                 resetSteadyPitch(0.0, 0.0);
-                m_pVCRate->set(0.0);
+                setRate(0.0);
                 m_iPitchRingPos = 0;
                 m_iPitchRingFilled = 0;
                 return;
@@ -580,10 +546,15 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
         //only smooth when we have good position (no smoothing for scratching)
         double averagePitch = 0.0;
         if (m_iPosition != -1 && reportedPlayButton) {
-            for (int i = 0; i < m_iPitchRingFilled; ++i) {
-                averagePitch += m_pPitchRing[i];
+            // A clean signal needs less smoothing, so the rate follows
+            // the record faster
+            const int window = math_min(m_iPitchRingFilled,
+                    pitchRingWindow());
+            for (int i = 1; i <= window; ++i) {
+                averagePitch += m_pPitchRing[
+                        (m_iPitchRingPos - i + m_iPitchRingSize) % m_iPitchRingSize];
             }
-            averagePitch /= m_iPitchRingFilled;
+            averagePitch /= window;
             // Round out some of the noise
             averagePitch = round(averagePitch * 10000.0);
             averagePitch /= 10000.0;
@@ -591,7 +562,7 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
             averagePitch = dVinylPitch;
         }
 
-        m_pVCRate->set(averagePitch + dDriftControl);
+        setRate(averagePitch + dDriftControl);
         if (uiUpdateTime(filePosition)) {
             double true_pitch = averagePitch + dDriftControl;
             double pitch_difference = true_pitch - m_dDisplayPitch;
@@ -646,7 +617,7 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
             //We are not playing any more
             togglePlayButton(false);
             resetSteadyPitch(0.0, 0.0);
-            m_pVCRate->set(0.0);
+            setRate(0.0);
             //resetSteadyPitch(dVinylPitch, filePosition);
             // Notify the UI that the timecode quality is garbage/missing.
             m_fTimecodeQuality = 0.0f;
@@ -660,6 +631,24 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
     }
 }
 
+void VinylControlXwax::setRate(double rate) {
+    m_pVCRate->set(rate);
+
+    VinylPitchSample sample;
+    sample.time = mixxx::Time::elapsed();
+    sample.rate = rate;
+    sample.position = m_dVinylPosition;
+    sample.hasPosition = m_iPosition != -1;
+    m_pPitchChannel->publish(sample);
+}
+
+int VinylControlXwax::pitchRingWindow() const {
+    // From the whole ring for a poor signal down to a quarter of it
+    const double fraction = 1.0 - (1.0 - kMinPitchRingFraction) *
+            math_clamp(static_cast<double>(m_fTimecodeQuality), 0.0, 1.0);
+    return math_max(1, static_cast<int>(round(m_iPitchRingSize * fraction)));
+}
+
 void VinylControlXwax::enableRecordEndMode() {
     qDebug() << "record end, setting constant mode";
     vinylStatus->slotSet(VINYL_STATUS_WARNING);
@@ -674,7 +663,7 @@ void VinylControlXwax::enableConstantMode() {
     togglePlayButton(true);
     double rate = m_pVCRate->get();
     m_pRateSlider->set(m_pRateDir->get() * (fabs(rate) - 1.0) / m_pRateRange->get());
-    m_pVCRate->set(rate);
+    setRate(rate);
 }
 
 void VinylControlXwax::enableConstantMode(double rate) {
@@ -683,7 +672,7 @@ void VinylControlXwax::enableConstantMode(double rate) {
     mode->slotSet((double)m_iVCMode);
     togglePlayButton(true);
     m_pRateSlider->set(m_pRateDir->get() * (fabs(rate) - 1.0) / m_pRateRange->get());
-    m_pVCRate->set(rate);
+    setRate(rate);
 }
 
 void VinylControlXwax::disableRecordEndMode() {
@@ -786,7 +775,7 @@ bool VinylControlXwax::checkEnabled(bool was, bool is) {
         //This allows for single-deck control, dj handoffs, etc.
 
         togglePlayButton(playButton->get() || fabs(m_pVCRate->get()) > 0.05);
-        m_pVCRate->set(calcRateRatio());
+        setRate(calcRateRatio());
         resetSteadyPitch(0.0, 0.0);
         m_bForceResync = true;
         if (!was)
@@ -3,6 +3,7 @@
 
 #include <QTime>
 
+#include "engine/vinylpitchchannel.h"
 #include "soundio/soundmanagerutil.h"
 #include "vinylcontrol/vinylcontrol.h"
 #include "vinylcontrol/steadypitch.h"
@@ -25,7 +26,8 @@ class VinylControlXwax : public VinylControl {
     VinylControlXwax(UserSettingsPointer pConfig, QString group);
     virtual ~VinylControlXwax();
 
-    static void freeLUTs();
+    // The name of the xwax timecode definition
+    static const char* timecodeForVinylType(const QString& vinylType);
     void analyzeSamples(CSAMPLE* pSamples, size_t nFrames);
 
     virtual bool writeQualityReport(VinylSignalQualityReport* qualityReportFifo);
@@ -47,6 +49,11 @@ class VinylControlXwax : public VinylControl {
     bool uiUpdateTime(double time);
     void establishQuality(bool quality_sample);
     double calcRateRatio() const;
+    // Sets the vinylcontrol_rate and passes it on to the engine
+    void setRate(double rate);
+    // The number of the latest pitch ring entries that are averaged,
+    // depending on the timecode quality
+    int pitchRingWindow() const;
 
     // Cache the position of the end of record
     unsigned int m_uiSafeZone;
@@ -54,10 +61,6 @@ class VinylControlXwax : public VinylControl {
     // The position read last time it was polled.
     double m_dVinylPositionOld;
 
-    // Scratch buffer for CSAMPLE -> short conversions.
-    short* m_pWorkBuffer;
-    size_t m_workBufferSize;
-
     // Signal quality ring buffer.
     // TODO(XXX): Replace with CircularBuffer instead of handling the ring logic
     // in VinylControlXwax.
@@ -136,9 +139,11 @@ class VinylControlXwax : public VinylControl {
     // Contains information that xwax's code needs internally about the timecode
     // and how to process it.
     struct timecoder timecoder;
-    // Static mutex that protects our creation/destruction of the xwax LUTs
-    static QMutex s_xwaxLUTMutex;
-    static bool s_bLUTInitialized;
+    // Acquired from TimecodeLookupCache
+    timecode_def* m_pTimecodeDefinition;
+
+    // Shared with the RateControl of the deck
+    std::shared_ptr<VinylPitchChannel> m_pPitchChannel;
 };
 
 #endif
@@ -0,0 +1,16 @@
+#include "waveform/renderers/gllinebatch.h"
+
+void GLLineBatch::draw() const {
+#ifndef __OPENGLES__
+    if (m_vertices.empty()) {
+        return;
+    }
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, m_vertices.data());
+    glColorPointer(4, GL_FLOAT, 0, m_colors.data());
+    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(m_vertices.size() / 2));
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+#endif
+}
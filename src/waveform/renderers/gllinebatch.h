@@ -0,0 +1,50 @@
+#ifndef GLLINEBATCH_H
+#define GLLINEBATCH_H
+
+#include <qgl.h>
+
+#include <vector>
+
+// Collects the lines of a frame to draw them with a single glDrawArrays()
+// call. The per-column lines of the signal renderers cost a driver call for
+// each vertex and color between glBegin() and glEnd(), which adds up to
+// several thousand calls per deck and frame. The arrays keep their capacity
+// from frame to frame.
+class GLLineBatch {
+  public:
+    GLLineBatch() {
+        setColor(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    void clear() {
+        m_vertices.clear();
+        m_colors.clear();
+    }
+
+    // The color of the following lines
+    void setColor(float red, float green, float blue, float alpha) {
+        m_color[0] = red;
+        m_color[1] = green;
+        m_color[2] = blue;
+        m_color[3] = alpha;
+    }
+
+    void addLine(float x1, float y1, float x2, float y2) {
+        m_vertices.push_back(x1);
+        m_vertices.push_back(y1);
+        m_vertices.push_back(x2);
+        m_vertices.push_back(y2);
+        m_colors.insert(m_colors.end(), m_color, m_color + 4);
+        m_colors.insert(m_colors.end(), m_color, m_color + 4);
+    }
+
+    // Draws the lines with the current matrices and line width
+    void draw() const;
+
+  private:
+    std::vector<GLfloat> m_vertices;
+    std::vector<GLfloat> m_colors;
+    GLfloat m_color[4];
+};
+
+#endif // GLLINEBATCH_H
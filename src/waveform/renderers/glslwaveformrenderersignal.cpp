@@ -10,8 +10,6 @@ GLSLWaveformRendererSignal::GLSLWaveformRendererSignal(WaveformWidgetRenderer* w
                                                        bool rgbShader)
         : WaveformRendererSignalBase(waveformWidgetRenderer),
           m_unitQuadListId(-1),
-          m_textureId(0),
-          m_loadedWaveform(0),
           m_frameBuffersValid(false),
           m_framebuffer(NULL),
           m_bDumpPng(false),
@@ -21,10 +19,6 @@ GLSLWaveformRendererSignal::GLSLWaveformRendererSignal(WaveformWidgetRenderer* w
 }
 
 GLSLWaveformRendererSignal::~GLSLWaveformRendererSignal() {
-    if (m_textureId) {
-        glDeleteTextures(1,&m_textureId);
-    }
-
     if (m_frameShaderProgram) {
         m_frameShaderProgram->removeAllShaders();
         delete m_frameShaderProgram;
@@ -84,56 +78,21 @@ bool GLSLWaveformRendererSignal::loadShaders() {
 bool GLSLWaveformRendererSignal::loadTexture() {
     TrackPointer trackInfo = m_waveformRenderer->getTrackInfo();
     ConstWaveformPointer waveform;
-    int dataSize = 0;
-    const WaveformData* data = NULL;
-
     if (trackInfo) {
         waveform = trackInfo->getWaveform();
-        if (waveform) {
-            dataSize = waveform->getDataSize();
-            if (dataSize > 1) {
-                data = waveform->data();
-            }
-        }
     }
 
-    glEnable(GL_TEXTURE_2D);
-
-    if (m_textureId == 0) {
-        glGenTextures(1, &m_textureId);
-
-        int error = glGetError();
-        if (error)
-            qDebug() << "GLSLWaveformRendererSignal::loadTexture - m_textureId" << m_textureId << "error" << error;
+    if (waveform.isNull() || waveform->getDataSize() <= 1 ||
+            waveform->data() == NULL) {
+        m_pTexture.reset();
+        return true;
     }
-
-    glBindTexture(GL_TEXTURE_2D, m_textureId);
-
-    int error = glGetError();
-    if (error)
-        qDebug() << "GLSLWaveformRendererSignal::loadTexture - bind error" << error;
-
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-
-    if (waveform != NULL && data != NULL) {
-        // Waveform ensures that getTextureSize is a multiple of
-        // getTextureStride so there is no rounding here.
-        int textureWidth = waveform->getTextureStride();
-        int textureHeigth = waveform->getTextureSize() / waveform->getTextureStride();
-
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureHeigth, 0,
-                     GL_RGBA, GL_UNSIGNED_BYTE, data);
-        int error = glGetError();
-        if (error)
-            qDebug() << "GLSLWaveformRendererSignal::loadTexture - glTexImage2D error" << error;
-    } else {
-        glDeleteTextures(1,&m_textureId);
-        m_textureId = 0;
+    if (!m_pTexture || m_pTexture->waveform() != waveform) {
+        m_pTexture = GLSLWaveformTexture::forWaveform(waveform);
     }
-
-    glDisable(GL_TEXTURE_2D);
-
+    // Uploads what has been analyzed since the last call, possibly by
+    // another renderer of the same waveform
+    m_pTexture->update();
     return true;
 }
 
@@ -198,8 +157,6 @@ void GLSLWaveformRendererSignal::createFrameBuffers()
 }
 
 bool GLSLWaveformRendererSignal::onInit() {
-    m_loadedWaveform = 0;
-
     if (!m_frameShaderProgram)
         m_frameShaderProgram = new QGLShaderProgram();
 
@@ -245,7 +202,6 @@ void GLSLWaveformRendererSignal::onResize() {
 }
 
 void GLSLWaveformRendererSignal::slotWaveformUpdated() {
-    m_loadedWaveform = 0;
     loadTexture();
 }
 
@@ -277,12 +233,10 @@ void GLSLWaveformRendererSignal::draw(QPainter* painter, QPaintEvent* /*event*/)
     // save the GL state set for QPainter
     painter->beginNativePainting();
 
-    //NOTE: (vRince) completion can change during loadTexture
-    //do not remove currenCompletion temp variable !
-    const int currentCompletion = waveform->getCompletion();
-    if (m_loadedWaveform < currentCompletion) {
-        loadTexture();
-        m_loadedWaveform = currentCompletion;
+    loadTexture();
+    if (!m_pTexture) {
+        painter->endNativePainting();
+        return;
     }
 
     // Per-band gain from the EQ knobs.
@@ -353,7 +307,7 @@ void GLSLWaveformRendererSignal::draw(QPainter* painter, QPaintEvent* /*event*/)
         m_frameShaderProgram->setUniformValue("highColor", highColor);
 
         glEnable(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, m_textureId);
+        glBindTexture(GL_TEXTURE_2D, m_pTexture->id());
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
@@ -6,6 +6,8 @@
 #include <QtOpenGL>
 
 #include "track/track.h"
+#include "util/memory.h"
+#include "waveform/renderers/glslwaveformtexture.h"
 #include "waveformrenderersignalbase.h"
 
 class GLSLWaveformRendererSignal : public QObject, public WaveformRendererSignalBase {
@@ -34,10 +36,10 @@ class GLSLWaveformRendererSignal : public QObject, public WaveformRendererSignal
     void createFrameBuffers();
 
     GLint m_unitQuadListId;
-    GLuint m_textureId;
+    // Shared with the other renderers of the waveform
+    std::shared_ptr<GLSLWaveformTexture> m_pTexture;
 
     TrackPointer m_loadedTrack;
-    int m_loadedWaveform;
 
     //Frame buffer for two pass rendering
     bool m_frameBuffersValid;
@@ -0,0 +1,91 @@
+#include "waveform/renderers/glslwaveformtexture.h"
+
+#include <QHash>
+#include <QtDebug>
+
+#include "util/math.h"
+
+namespace {
+
+// The textures that are held by a renderer
+QHash<const Waveform*, std::weak_ptr<GLSLWaveformTexture>> s_textures;
+
+} // anonymous namespace
+
+// static
+std::shared_ptr<GLSLWaveformTexture> GLSLWaveformTexture::forWaveform(
+        ConstWaveformPointer pWaveform) {
+    std::shared_ptr<GLSLWaveformTexture> pTexture =
+            s_textures.value(pWaveform.data()).lock();
+    if (!pTexture) {
+        pTexture = std::shared_ptr<GLSLWaveformTexture>(
+                new GLSLWaveformTexture(pWaveform));
+        s_textures.insert(pWaveform.data(), pTexture);
+    }
+    return pTexture;
+}
+
+GLSLWaveformTexture::GLSLWaveformTexture(ConstWaveformPointer pWaveform)
+        : m_pWaveform(pWaveform),
+          m_id(0),
+          m_uploadedCompletion(0) {
+    glEnable(GL_TEXTURE_2D);
+    glGenTextures(1, &m_id);
+    int error = glGetError();
+    if (error) {
+        qDebug() << "GLSLWaveformTexture - glGenTextures error" << error;
+    }
+    glBindTexture(GL_TEXTURE_2D, m_id);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+    // Waveform ensures that getTextureSize is a multiple of
+    // getTextureStride so there is no rounding here.
+    const int textureWidth = m_pWaveform->getTextureStride();
+    const int textureHeight = m_pWaveform->getTextureSize() / textureWidth;
+    // The whole texture is uploaded once, including the part that is not
+    // analyzed yet and still zero
+    m_uploadedCompletion = math_min(
+            m_pWaveform->getCompletion(), m_pWaveform->getDataSize());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureHeight, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, m_pWaveform->data());
+    error = glGetError();
+    if (error) {
+        qDebug() << "GLSLWaveformTexture - glTexImage2D error" << error;
+    }
+    glDisable(GL_TEXTURE_2D);
+}
+
+GLSLWaveformTexture::~GLSLWaveformTexture() {
+    s_textures.remove(m_pWaveform.data());
+    if (m_id) {
+        glDeleteTextures(1, &m_id);
+    }
+}
+
+void GLSLWaveformTexture::update() {
+    // The completion can change while the rows are uploaded
+    const int completion = math_min(
+            m_pWaveform->getCompletion(), m_pWaveform->getDataSize());
+    if (completion <= m_uploadedCompletion) {
+        return;
+    }
+    const int textureWidth = m_pWaveform->getTextureStride();
+    // The row that was incomplete at the last update is uploaded again
+    const int firstRow = m_uploadedCompletion / textureWidth;
+    const int lastRow = (completion - 1) / textureWidth;
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, m_id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow,
+                    textureWidth, lastRow - firstRow + 1,
+                    GL_RGBA, GL_UNSIGNED_BYTE,
+                    m_pWaveform->data() + firstRow * textureWidth);
+    int error = glGetError();
+    if (error) {
+        qDebug() << "GLSLWaveformTexture - glTexSubImage2D error" << error;
+    }
+    glDisable(GL_TEXTURE_2D);
+
+    m_uploadedCompletion = completion;
+}
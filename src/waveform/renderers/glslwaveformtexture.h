@@ -0,0 +1,48 @@
+#ifndef GLSLWAVEFORMTEXTURE_H
+#define GLSLWAVEFORMTEXTURE_H
+
+#include <QtOpenGL>
+
+#include "util/class.h"
+#include "util/memory.h"
+#include "waveform/waveform.h"
+
+// The texture that holds the data of a waveform for the GLSL renderers.
+// All waveform widgets share their GL context (see SharedGLContext), so
+// the renderers of all widgets that show the same waveform share one
+// texture. While the waveform is analyzed, only the rows that have been
+// completed since the last update are uploaded.
+//
+// Only used from the GUI thread with the shared context current.
+class GLSLWaveformTexture {
+  public:
+    // Returns the texture of the waveform, which is created if no
+    // renderer holds it yet
+    static std::shared_ptr<GLSLWaveformTexture> forWaveform(
+            ConstWaveformPointer pWaveform);
+    ~GLSLWaveformTexture();
+
+    const ConstWaveformPointer& waveform() const {
+        return m_pWaveform;
+    }
+    GLuint id() const {
+        return m_id;
+    }
+
+    // Uploads the rows of the texture that have been completed since the
+    // last update
+    void update();
+
+  private:
+    explicit GLSLWaveformTexture(ConstWaveformPointer pWaveform);
+
+    // Keeps the waveform and therefore the key of the texture alive
+    const ConstWaveformPointer m_pWaveform;
+    GLuint m_id;
+    // The completion of the waveform that has been uploaded
+    int m_uploadedCompletion;
+
+    DISALLOW_COPY_AND_ASSIGN(GLSLWaveformTexture);
+};
+
+#endif // GLSLWAVEFORMTEXTURE_H
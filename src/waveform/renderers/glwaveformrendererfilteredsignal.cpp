@@ -35,13 +35,10 @@ void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*ev
         return;
     }
 
-    const int dataSize = waveform->getDataSize();
-    if (dataSize <= 1) {
-        return;
-    }
-
-    const WaveformData* data = waveform->data();
-    if (data == NULL) {
+    // The level of detail that matches the zoom
+    int dataSize = 0;
+    const WaveformData* data = getLevelOfDetail(*waveform, &dataSize);
+    if (dataSize <= 1 || data == NULL) {
         return;
     }
 
@@ -102,40 +99,36 @@ void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*ev
         glLineWidth(1.1);
         glEnable(GL_LINE_SMOOTH);
 
-        glBegin(GL_LINES); {
-            for (int visualIndex = firstVisualIndex;
-                 visualIndex < lastVisualIndex;
-                 visualIndex += 2) {
+        m_lines.clear();
+        for (int visualIndex = firstVisualIndex;
+             visualIndex < lastVisualIndex;
+             visualIndex += 2) {
 
-                if (visualIndex < 0)
-                    continue;
+            if (visualIndex < 0)
+                continue;
 
-                if (visualIndex > dataSize - 1)
-                    break;
+            if (visualIndex > dataSize - 1)
+                break;
 
-                maxLow[0] = (float)data[visualIndex].filtered.low;
-                maxMid[0] = (float)data[visualIndex].filtered.mid;
-                maxHigh[0] = (float)data[visualIndex].filtered.high;
-                maxLow[1] = (float)data[visualIndex+1].filtered.low;
-                maxMid[1] = (float)data[visualIndex+1].filtered.mid;
-                maxHigh[1] = (float)data[visualIndex+1].filtered.high;
+            maxLow[0] = (float)data[visualIndex].filtered.low;
+            maxMid[0] = (float)data[visualIndex].filtered.mid;
+            maxHigh[0] = (float)data[visualIndex].filtered.high;
+            maxLow[1] = (float)data[visualIndex+1].filtered.low;
+            maxMid[1] = (float)data[visualIndex+1].filtered.mid;
+            maxHigh[1] = (float)data[visualIndex+1].filtered.high;
 
-                meanIndex = visualIndex;
+            meanIndex = visualIndex;
 
-                glColor4f(m_lowColor_r, m_lowColor_g, m_lowColor_b, 0.8);
-                glVertex2f(meanIndex,lowGain*maxLow[0]);
-                glVertex2f(meanIndex,-1.f*lowGain*maxLow[1]);
+            m_lines.setColor(m_lowColor_r, m_lowColor_g, m_lowColor_b, 0.8);
+            m_lines.addLine(meanIndex,lowGain*maxLow[0], meanIndex,-1.f*lowGain*maxLow[1]);
 
-                glColor4f(m_midColor_r, m_midColor_g, m_midColor_b, 0.85);
-                glVertex2f(meanIndex,midGain*maxMid[0]);
-                glVertex2f(meanIndex,-1.f*midGain*maxMid[1]);
+            m_lines.setColor(m_midColor_r, m_midColor_g, m_midColor_b, 0.85);
+            m_lines.addLine(meanIndex,midGain*maxMid[0], meanIndex,-1.f*midGain*maxMid[1]);
 
-                glColor4f(m_highColor_r, m_highColor_g, m_highColor_b, 0.9);
-                glVertex2f(meanIndex,highGain*maxHigh[0]);
-                glVertex2f(meanIndex,-1.f*highGain*maxHigh[1]);
-            }
+            m_lines.setColor(m_highColor_r, m_highColor_g, m_highColor_b, 0.9);
+            m_lines.addLine(meanIndex,highGain*maxHigh[0], meanIndex,-1.f*highGain*maxHigh[1]);
         }
-        glEnd();
+        m_lines.draw();
     } else { //top || bottom
         glMatrixMode(GL_PROJECTION);
         glPushMatrix();
@@ -158,38 +151,34 @@ void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*ev
         glLineWidth(1.1);
         glEnable(GL_LINE_SMOOTH);
 
-        glBegin(GL_LINES); {
-            for (int visualIndex = firstVisualIndex;
-                 visualIndex < lastVisualIndex;
-                 visualIndex += 2) {
-
-                if (visualIndex < 0)
-                    continue;
-
-                if (visualIndex > dataSize - 1)
-                    break;
-
-                maxLow[0] = (float)data[visualIndex].filtered.low;
-                maxLow[1] = (float)data[visualIndex+1].filtered.low;
-                maxMid[0] = (float)data[visualIndex].filtered.mid;
-                maxMid[1] = (float)data[visualIndex+1].filtered.mid;
-                maxHigh[0] = (float)data[visualIndex].filtered.high;
-                maxHigh[1] = (float)data[visualIndex+1].filtered.high;
-
-                glColor4f(m_lowColor_r, m_lowColor_g, m_lowColor_b, 0.8);
-                glVertex2f(float(visualIndex),0.f);
-                glVertex2f(float(visualIndex),lowGain*math_max(maxLow[0],maxLow[1]));
-
-                glColor4f(m_midColor_r, m_midColor_g, m_midColor_b, 0.85);
-                glVertex2f(float(visualIndex),0.f);
-                glVertex2f(float(visualIndex),midGain*math_max(maxMid[0],maxMid[1]));
-
-                glColor4f(m_highColor_r, m_highColor_g, m_highColor_b, 0.9);
-                glVertex2f(float(visualIndex),0.f);
-                glVertex2f(float(visualIndex),highGain*math_max(maxHigh[0],maxHigh[1]));
-            }
+        m_lines.clear();
+        for (int visualIndex = firstVisualIndex;
+             visualIndex < lastVisualIndex;
+             visualIndex += 2) {
+
+            if (visualIndex < 0)
+                continue;
+
+            if (visualIndex > dataSize - 1)
+                break;
+
+            maxLow[0] = (float)data[visualIndex].filtered.low;
+            maxLow[1] = (float)data[visualIndex+1].filtered.low;
+            maxMid[0] = (float)data[visualIndex].filtered.mid;
+            maxMid[1] = (float)data[visualIndex+1].filtered.mid;
+            maxHigh[0] = (float)data[visualIndex].filtered.high;
+            maxHigh[1] = (float)data[visualIndex+1].filtered.high;
+
+            m_lines.setColor(m_lowColor_r, m_lowColor_g, m_lowColor_b, 0.8);
+            m_lines.addLine(float(visualIndex),0.f, float(visualIndex),lowGain*math_max(maxLow[0],maxLow[1]));
+
+            m_lines.setColor(m_midColor_r, m_midColor_g, m_midColor_b, 0.85);
+            m_lines.addLine(float(visualIndex),0.f, float(visualIndex),midGain*math_max(maxMid[0],maxMid[1]));
+
+            m_lines.setColor(m_highColor_r, m_highColor_g, m_highColor_b, 0.9);
+            m_lines.addLine(float(visualIndex),0.f, float(visualIndex),highGain*math_max(maxHigh[0],maxHigh[1]));
         }
-        glEnd();
+        m_lines.draw();
     }
 
     //DEBUG
@@ -2,6 +2,7 @@
 #define GLWAVEFROMRENDERERFILTEREDSIGNAL_H
 
 #include "waveformrenderersignalbase.h"
+#include "waveform/renderers/gllinebatch.h"
 
 class ControlObject;
 
@@ -12,6 +13,9 @@ class GLWaveformRendererFilteredSignal : public WaveformRendererSignalBase {
 
     virtual void onSetup(const QDomNode &node);
     virtual void draw(QPainter* painter, QPaintEvent* event);
+
+  private:
+    GLLineBatch m_lines;
 };
 
 #endif // GLWAVEFROMRENDERERFILTEREDSIGNAL_H
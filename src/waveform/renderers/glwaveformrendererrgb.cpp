@@ -31,13 +31,10 @@ void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
         return;
     }
 
-    const int dataSize = waveform->getDataSize();
-    if (dataSize <= 1) {
-        return;
-    }
-
-    const WaveformData* data = waveform->data();
-    if (data == NULL) {
+    // The level of detail that matches the zoom
+    int dataSize = 0;
+    const WaveformData* data = getLevelOfDetail(*waveform, &dataSize);
+    if (dataSize <= 1 || data == NULL) {
         return;
     }
 
@@ -94,50 +91,46 @@ void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
         glLineWidth(2.0);
         glEnable(GL_LINE_SMOOTH);
 
-        glBegin(GL_LINES); {
-            for (int visualIndex = firstVisualIndex;
-                 visualIndex < lastVisualIndex;
-                 visualIndex += 2) {
-
-                if (visualIndex < 0) {
-                    continue;
-                }
-
-                if (visualIndex > dataSize - 1) {
-                    break;
-                }
-
-                float left_low    = lowGain  * (float) data[visualIndex].filtered.low;
-                float left_mid    = midGain  * (float) data[visualIndex].filtered.mid;
-                float left_high   = highGain * (float) data[visualIndex].filtered.high;
-                float left_all    = sqrtf(left_low * left_low + left_mid * left_mid + left_high * left_high) * kHeightScaleFactor;
-                float left_red    = left_low  * m_rgbLowColor_r + left_mid  * m_rgbMidColor_r + left_high  * m_rgbHighColor_r;
-                float left_green  = left_low  * m_rgbLowColor_g + left_mid  * m_rgbMidColor_g + left_high  * m_rgbHighColor_g;
-                float left_blue   = left_low  * m_rgbLowColor_b + left_mid  * m_rgbMidColor_b + left_high  * m_rgbHighColor_b;
-                float left_max    = math_max3(left_red, left_green, left_blue);
-                if (left_max > 0.0f) {  // Prevent division by zero
-                    glColor4f(left_red / left_max, left_green / left_max, left_blue / left_max, 0.8f);
-                    glVertex2f(visualIndex, 0.0f);
-                    glVertex2f(visualIndex, left_all);
-                }
-
-                float right_low   = lowGain  * (float) data[visualIndex+1].filtered.low;
-                float right_mid   = midGain  * (float) data[visualIndex+1].filtered.mid;
-                float right_high  = highGain * (float) data[visualIndex+1].filtered.high;
-                float right_all   = sqrtf(right_low * right_low + right_mid * right_mid + right_high * right_high) * kHeightScaleFactor;
-                float right_red   = right_low * m_rgbLowColor_r + right_mid * m_rgbMidColor_r + right_high * m_rgbHighColor_r;
-                float right_green = right_low * m_rgbLowColor_g + right_mid * m_rgbMidColor_g + right_high * m_rgbHighColor_g;
-                float right_blue  = right_low * m_rgbLowColor_b + right_mid * m_rgbMidColor_b + right_high * m_rgbHighColor_b;
-                float right_max   = math_max3(right_red, right_green, right_blue);
-                if (right_max > 0.0f) {  // Prevent division by zero
-                    glColor4f(right_red / right_max, right_green / right_max, right_blue / right_max, 0.8f);
-                    glVertex2f(visualIndex, 0.0f);
-                    glVertex2f(visualIndex, -1.0f * right_all);
-                }
+        m_lines.clear();
+        for (int visualIndex = firstVisualIndex;
+             visualIndex < lastVisualIndex;
+             visualIndex += 2) {
+
+            if (visualIndex < 0) {
+                continue;
             }
-        }
 
-        glEnd();
+            if (visualIndex > dataSize - 1) {
+                break;
+            }
+
+            float left_low    = lowGain  * (float) data[visualIndex].filtered.low;
+            float left_mid    = midGain  * (float) data[visualIndex].filtered.mid;
+            float left_high   = highGain * (float) data[visualIndex].filtered.high;
+            float left_all    = sqrtf(left_low * left_low + left_mid * left_mid + left_high * left_high) * kHeightScaleFactor;
+            float left_red    = left_low  * m_rgbLowColor_r + left_mid  * m_rgbMidColor_r + left_high  * m_rgbHighColor_r;
+            float left_green  = left_low  * m_rgbLowColor_g + left_mid  * m_rgbMidColor_g + left_high  * m_rgbHighColor_g;
+            float left_blue   = left_low  * m_rgbLowColor_b + left_mid  * m_rgbMidColor_b + left_high  * m_rgbHighColor_b;
+            float left_max    = math_max3(left_red, left_green, left_blue);
+            if (left_max > 0.0f) {  // Prevent division by zero
+                m_lines.setColor(left_red / left_max, left_green / left_max, left_blue / left_max, 0.8f);
+                m_lines.addLine(visualIndex, 0.0f, visualIndex, left_all);
+            }
+
+            float right_low   = lowGain  * (float) data[visualIndex+1].filtered.low;
+            float right_mid   = midGain  * (float) data[visualIndex+1].filtered.mid;
+            float right_high  = highGain * (float) data[visualIndex+1].filtered.high;
+            float right_all   = sqrtf(right_low * right_low + right_mid * right_mid + right_high * right_high) * kHeightScaleFactor;
+            float right_red   = right_low * m_rgbLowColor_r + right_mid * m_rgbMidColor_r + right_high * m_rgbHighColor_r;
+            float right_green = right_low * m_rgbLowColor_g + right_mid * m_rgbMidColor_g + right_high * m_rgbHighColor_g;
+            float right_blue  = right_low * m_rgbLowColor_b + right_mid * m_rgbMidColor_b + right_high * m_rgbHighColor_b;
+            float right_max   = math_max3(right_red, right_green, right_blue);
+            if (right_max > 0.0f) {  // Prevent division by zero
+                m_lines.setColor(right_red / right_max, right_green / right_max, right_blue / right_max, 0.8f);
+                m_lines.addLine(visualIndex, 0.0f, visualIndex, -1.0f * right_all);
+            }
+        }
+        m_lines.draw();
 
     } else {  // top || bottom
         glMatrixMode(GL_PROJECTION);
@@ -162,39 +155,36 @@ void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
         glLineWidth(2.0);
         glEnable(GL_LINE_SMOOTH);
 
-        glBegin(GL_LINES); {
-            for (int visualIndex = firstVisualIndex;
-                 visualIndex < lastVisualIndex;
-                 visualIndex += 2) {
-
-                if (visualIndex < 0) {
-                    continue;
-                }
-
-                if (visualIndex > dataSize - 1) {
-                    break;
-                }
-
-                float low  = lowGain  * (float) math_max(data[visualIndex].filtered.low,  data[visualIndex+1].filtered.low);
-                float mid  = midGain  * (float) math_max(data[visualIndex].filtered.mid,  data[visualIndex+1].filtered.mid);
-                float high = highGain * (float) math_max(data[visualIndex].filtered.high, data[visualIndex+1].filtered.high);
-
-                float all = sqrtf(low * low + mid * mid + high * high) * kHeightScaleFactor;
-
-                float red   = low * m_rgbLowColor_r + mid * m_rgbMidColor_r + high * m_rgbHighColor_r;
-                float green = low * m_rgbLowColor_g + mid * m_rgbMidColor_g + high * m_rgbHighColor_g;
-                float blue  = low * m_rgbLowColor_b + mid * m_rgbMidColor_b + high * m_rgbHighColor_b;
-
-                float max = math_max3(red, green, blue);
-                if (max > 0.0f) {  // Prevent division by zero
-                    glColor4f(red / max, green / max, blue / max, 0.9f);
-                    glVertex2f(float(visualIndex), 0.0f);
-                    glVertex2f(float(visualIndex), all);
-                }
+        m_lines.clear();
+        for (int visualIndex = firstVisualIndex;
+             visualIndex < lastVisualIndex;
+             visualIndex += 2) {
+
+            if (visualIndex < 0) {
+                continue;
             }
-        }
 
-        glEnd();
+            if (visualIndex > dataSize - 1) {
+                break;
+            }
+
+            float low  = lowGain  * (float) math_max(data[visualIndex].filtered.low,  data[visualIndex+1].filtered.low);
+            float mid  = midGain  * (float) math_max(data[visualIndex].filtered.mid,  data[visualIndex+1].filtered.mid);
+            float high = highGain * (float) math_max(data[visualIndex].filtered.high, data[visualIndex+1].filtered.high);
+
+            float all = sqrtf(low * low + mid * mid + high * high) * kHeightScaleFactor;
+
+            float red   = low * m_rgbLowColor_r + mid * m_rgbMidColor_r + high * m_rgbHighColor_r;
+            float green = low * m_rgbLowColor_g + mid * m_rgbMidColor_g + high * m_rgbHighColor_g;
+            float blue  = low * m_rgbLowColor_b + mid * m_rgbMidColor_b + high * m_rgbHighColor_b;
+
+            float max = math_max3(red, green, blue);
+            if (max > 0.0f) {  // Prevent division by zero
+                m_lines.setColor(red / max, green / max, blue / max, 0.9f);
+                m_lines.addLine(float(visualIndex), 0.0f, float(visualIndex), all);
+            }
+        }
+        m_lines.draw();
     }
 
     glPopMatrix();
@@ -2,6 +2,7 @@
 #define GLWAVEFORMRENDERERRGB_H
 
 #include "waveformrenderersignalbase.h"
+#include "waveform/renderers/gllinebatch.h"
 
 class ControlObject;
 
@@ -14,6 +15,8 @@ class GLWaveformRendererRGB : public WaveformRendererSignalBase {
     virtual void draw(QPainter* painter, QPaintEvent* event);
 
   private:
+    GLLineBatch m_lines;
+
     DISALLOW_COPY_AND_ASSIGN(GLWaveformRendererRGB);
 };
 
@@ -37,13 +37,10 @@ void GLWaveformRendererSimpleSignal::draw(QPainter* painter, QPaintEvent* /*even
         return;
     }
 
-    const int dataSize = waveform->getDataSize();
-    if (dataSize <= 1) {
-        return;
-    }
-
-    const WaveformData* data = waveform->data();
-    if (data == NULL) {
+    // The level of detail that matches the zoom
+    int dataSize = 0;
+    const WaveformData* data = getLevelOfDetail(*waveform, &dataSize);
+    if (dataSize <= 1 || data == NULL) {
         return;
     }
 
@@ -100,25 +97,23 @@ void GLWaveformRendererSimpleSignal::draw(QPainter* painter, QPaintEvent* /*even
         glLineWidth(1.1);
         glEnable(GL_LINE_SMOOTH);
 
-        glBegin(GL_LINES); {
-            for (int visualIndex = firstVisualIndex;
-                 visualIndex < lastVisualIndex;
-                 visualIndex += 2) {
-
-                if (visualIndex < 0)
-                    continue;
-
-                if (visualIndex > dataSize - 1)
-                    break;
-
-                maxAll[0] = (float)data[visualIndex].filtered.all;
-                maxAll[1] = (float)data[visualIndex+1].filtered.all;
-                glColor4f(m_signalColor_r, m_signalColor_g, m_signalColor_b, 0.9);
-                glVertex2f(visualIndex,maxAll[0]);
-                glVertex2f(visualIndex,-1.f*maxAll[1]);
-            }
+        m_lines.clear();
+        for (int visualIndex = firstVisualIndex;
+             visualIndex < lastVisualIndex;
+             visualIndex += 2) {
+
+            if (visualIndex < 0)
+                continue;
+
+            if (visualIndex > dataSize - 1)
+                break;
+
+            maxAll[0] = (float)data[visualIndex].filtered.all;
+            maxAll[1] = (float)data[visualIndex+1].filtered.all;
+            m_lines.setColor(m_signalColor_r, m_signalColor_g, m_signalColor_b, 0.9);
+            m_lines.addLine(visualIndex,maxAll[0], visualIndex,-1.f*maxAll[1]);
         }
-        glEnd();
+        m_lines.draw();
     } else { //top || bottom
         glMatrixMode(GL_PROJECTION);
         glPushMatrix();
@@ -141,25 +136,23 @@ void GLWaveformRendererSimpleSignal::draw(QPainter* painter, QPaintEvent* /*even
         glLineWidth(1.1);
         glEnable(GL_LINE_SMOOTH);
 
-        glBegin(GL_LINES); {
-            for (int visualIndex = firstVisualIndex;
-                 visualIndex < lastVisualIndex;
-                 visualIndex += 2) {
-
-                if (visualIndex < 0)
-                    continue;
-
-                if (visualIndex > dataSize - 1)
-                    break;
-
-                maxAll[0] = (float)data[visualIndex].filtered.all;
-                maxAll[1] = (float)data[visualIndex+1].filtered.all;
-                glColor4f(m_signalColor_r, m_signalColor_g, m_signalColor_b, 0.8);
-                glVertex2f(float(visualIndex),0.f);
-                glVertex2f(float(visualIndex),math_max(maxAll[0],maxAll[1]));
-            }
+        m_lines.clear();
+        for (int visualIndex = firstVisualIndex;
+             visualIndex < lastVisualIndex;
+             visualIndex += 2) {
+
+            if (visualIndex < 0)
+                continue;
+
+            if (visualIndex > dataSize - 1)
+                break;
+
+            maxAll[0] = (float)data[visualIndex].filtered.all;
+            maxAll[1] = (float)data[visualIndex+1].filtered.all;
+            m_lines.setColor(m_signalColor_r, m_signalColor_g, m_signalColor_b, 0.8);
+            m_lines.addLine(float(visualIndex),0.f, float(visualIndex),math_max(maxAll[0],maxAll[1]));
         }
-        glEnd();
+        m_lines.draw();
     }
     glPopMatrix();
     glMatrixMode(GL_PROJECTION);
@@ -106,13 +106,10 @@ int QtWaveformRendererFilteredSignal::buildPolygon() {
         return 0;
     }
 
-    const int dataSize = waveform->getDataSize();
-    if (dataSize <= 1) {
-        return 0;
-    }
-
-    const WaveformData* data = waveform->data();
-    if (data == NULL) {
+    // The level of detail that matches the zoom
+    int dataSize = 0;
+    const WaveformData* data = getLevelOfDetail(*waveform, &dataSize);
+    if (dataSize <= 1 || data == NULL) {
         return 0;
     }
 
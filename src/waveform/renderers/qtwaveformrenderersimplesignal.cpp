@@ -48,13 +48,10 @@ void QtWaveformRendererSimpleSignal::draw(QPainter* painter, QPaintEvent* /*even
         return;
     }
 
-    const int dataSize = waveform->getDataSize();
-    if (dataSize <= 1) {
-        return;
-    }
-
-    const WaveformData* data = waveform->data();
-    if (data == NULL) {
+    // The level of detail that matches the zoom
+    int dataSize = 0;
+    const WaveformData* data = getLevelOfDetail(*waveform, &dataSize);
+    if (dataSize <= 1 || data == NULL) {
         return;
     }
 
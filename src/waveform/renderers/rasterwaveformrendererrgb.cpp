@@ -0,0 +1,280 @@
+#include "rasterwaveformrendererrgb.h"
+
+#include <cstring>
+
+#include "waveformwidgetrenderer.h"
+#include "waveform/waveform.h"
+#include "track/track.h"
+#include "util/math.h"
+
+namespace {
+
+// The offset of a frame that scrolled by whole columns differs from a
+// multiple of the gain by the rounding of the play position only
+const double kScrollTolerance = 0.01;
+
+} // anonymous namespace
+
+RasterWaveformRendererRGB::RasterWaveformRendererRGB(
+        WaveformWidgetRenderer* waveformWidgetRenderer)
+        : WaveformRendererSignalBase(waveformWidgetRenderer),
+          m_imageData(NULL),
+          m_imageDataSize(0),
+          m_imageCompletion(0),
+          m_imageOffset(0.0),
+          m_imageGain(0.0),
+          m_imageAllGain(0.0) {
+    // Built on the first draw()
+    m_tableGains[0] = m_tableGains[1] = m_tableGains[2] = -1.0;
+}
+
+RasterWaveformRendererRGB::~RasterWaveformRendererRGB() {
+}
+
+void RasterWaveformRendererRGB::onSetup(const QDomNode& /* node */) {
+    setDirty();
+}
+
+void RasterWaveformRendererRGB::onSetTrack() {
+    setDirty();
+}
+
+void RasterWaveformRendererRGB::updateTables(
+        float lowGain, float midGain, float highGain) {
+    if (m_tableGains[0] == lowGain && m_tableGains[1] == midGain &&
+            m_tableGains[2] == highGain) {
+        return;
+    }
+    for (int value = 0; value < 256; ++value) {
+        m_squaredLow[value] = (value * lowGain) * (value * lowGain);
+        m_squaredMid[value] = (value * midGain) * (value * midGain);
+        m_squaredHigh[value] = (value * highGain) * (value * highGain);
+    }
+    m_tableGains[0] = lowGain;
+    m_tableGains[1] = midGain;
+    m_tableGains[2] = highGain;
+    setDirty();
+}
+
+void RasterWaveformRendererRGB::computeColumns(
+        const WaveformData* data, int dataSize,
+        double offset, double gain, int first, int last) {
+    const int breadth = m_waveformRenderer->getBreadth();
+    const float halfBreadth = (float)breadth / 2.0;
+    const float heightFactor = m_imageAllGain * halfBreadth / sqrtf(255 * 255 * 3);
+    const int lastVisualFrame = dataSize / 2 - 1;
+
+    // The colors of the bands weighted by their gains
+    const float lowGain = m_tableGains[0];
+    const float midGain = m_tableGains[1];
+    const float highGain = m_tableGains[2];
+    const float lowR = lowGain * m_rgbLowColor_r;
+    const float lowG = lowGain * m_rgbLowColor_g;
+    const float lowB = lowGain * m_rgbLowColor_b;
+    const float midR = midGain * m_rgbMidColor_r;
+    const float midG = midGain * m_rgbMidColor_g;
+    const float midB = midGain * m_rgbMidColor_b;
+    const float highR = highGain * m_rgbHighColor_r;
+    const float highG = highGain * m_rgbHighColor_g;
+    const float highB = highGain * m_rgbHighColor_b;
+
+    for (int x = first; x < last; ++x) {
+        // Like WaveformRendererRGB
+        const double xVisualSampleIndex = gain * x + offset;
+        const double maxSamplingRange = gain / 2.0;
+        int visualFrameStart = int(xVisualSampleIndex / 2.0 - maxSamplingRange + 0.5);
+        int visualFrameStop = int(xVisualSampleIndex / 2.0 + maxSamplingRange + 0.5);
+        visualFrameStart = math_clamp(visualFrameStart, 0, lastVisualFrame);
+        visualFrameStop = math_clamp(visualFrameStop, 0, lastVisualFrame);
+        const int visualIndexStart = visualFrameStart * 2;
+        const int visualIndexStop = visualFrameStop * 2;
+
+        unsigned char maxLow = 0;
+        unsigned char maxMid = 0;
+        unsigned char maxHigh = 0;
+        float maxAll = 0.;
+        float maxAllNext = 0.;
+        for (int i = visualIndexStart;
+             i >= 0 && i + 1 < dataSize && i + 1 <= visualIndexStop; i += 2) {
+            const WaveformData& waveformData = data[i];
+            const WaveformData& waveformDataNext = data[i + 1];
+            maxLow  = math_max3(maxLow,  waveformData.filtered.low,  waveformDataNext.filtered.low);
+            maxMid  = math_max3(maxMid,  waveformData.filtered.mid,  waveformDataNext.filtered.mid);
+            maxHigh = math_max3(maxHigh, waveformData.filtered.high, waveformDataNext.filtered.high);
+            maxAll = math_max(maxAll,
+                    m_squaredLow[waveformData.filtered.low] +
+                    m_squaredMid[waveformData.filtered.mid] +
+                    m_squaredHigh[waveformData.filtered.high]);
+            maxAllNext = math_max(maxAllNext,
+                    m_squaredLow[waveformDataNext.filtered.low] +
+                    m_squaredMid[waveformDataNext.filtered.mid] +
+                    m_squaredHigh[waveformDataNext.filtered.high]);
+        }
+
+        const float red = maxLow * lowR + maxMid * midR + maxHigh * highR;
+        const float green = maxLow * lowG + maxMid * midG + maxHigh * highG;
+        const float blue = maxLow * lowB + maxMid * midB + maxHigh * highB;
+        const float max = math_max3(red, green, blue);
+        if (max <= 0.0f) {
+            m_columnColors[x] = 0;
+            m_columnTops[x] = 0;
+            m_columnBottoms[x] = 0;
+            continue;
+        }
+        const float scale = 255.0f / max;
+        m_columnColors[x] = qRgb(static_cast<int>(red * scale),
+                static_cast<int>(green * scale), static_cast<int>(blue * scale));
+
+        // The pixels of the line that WaveformRendererRGB draws
+        int top;
+        int bottom;
+        switch (m_alignment) {
+            case Qt::AlignBottom:
+            case Qt::AlignRight:
+                top = breadth - (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext)));
+                bottom = breadth + 1;
+                break;
+            case Qt::AlignTop:
+            case Qt::AlignLeft:
+                top = 0;
+                bottom = (int)(heightFactor * sqrtf(math_max(maxAll, maxAllNext))) + 1;
+                break;
+            default:
+                top = (int)(halfBreadth - heightFactor * sqrtf(maxAll));
+                bottom = (int)(halfBreadth + heightFactor * sqrtf(maxAllNext)) + 1;
+        }
+        m_columnTops[x] = math_clamp(top, 0, breadth);
+        m_columnBottoms[x] = math_clamp(bottom, 0, breadth);
+    }
+}
+
+void RasterWaveformRendererRGB::scrollImage(int shift) {
+    const int length = m_image.width();
+    const int moved = length - std::abs(shift);
+    for (int y = 0; y < m_image.height(); ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(m_image.scanLine(y));
+        if (shift > 0) {
+            std::memmove(line, line + shift, moved * sizeof(QRgb));
+        } else {
+            std::memmove(line - shift, line, moved * sizeof(QRgb));
+        }
+    }
+}
+
+void RasterWaveformRendererRGB::rasterizeColumns(int first, int last) {
+    const QRgb* colors = m_columnColors.data();
+    const int* tops = m_columnTops.data();
+    const int* bottoms = m_columnBottoms.data();
+    for (int y = 0; y < m_image.height(); ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(m_image.scanLine(y));
+        // note: LOOP VECTORIZED.
+        for (int x = first; x < last; ++x) {
+            const QRgb inside = (y >= tops[x]) & (y < bottoms[x]);
+            // Transparent outside of the column
+            line[x] = colors[x] & (0 - inside);
+        }
+    }
+}
+
+void RasterWaveformRendererRGB::draw(QPainter* painter,
+                                     QPaintEvent* /*event*/) {
+    const TrackPointer trackInfo = m_waveformRenderer->getTrackInfo();
+    if (!trackInfo) {
+        return;
+    }
+
+    ConstWaveformPointer waveform = trackInfo->getWaveform();
+    if (waveform.isNull()) {
+        return;
+    }
+
+    // The level of detail that matches the zoom
+    int dataSize = 0;
+    const WaveformData* data = getLevelOfDetail(*waveform, &dataSize);
+    if (dataSize <= 1 || data == NULL) {
+        return;
+    }
+
+    const int length = m_waveformRenderer->getLength();
+    const int breadth = m_waveformRenderer->getBreadth();
+    if (length <= 0 || breadth <= 0) {
+        return;
+    }
+
+    const double firstVisualIndex = m_waveformRenderer->getFirstDisplayedPosition() * dataSize;
+    const double lastVisualIndex = m_waveformRenderer->getLastDisplayedPosition() * dataSize;
+    const double offset = firstVisualIndex;
+    // Represents the # of waveform data points per horizontal pixel.
+    const double gain = (lastVisualIndex - firstVisualIndex) / (double)length;
+
+    // Per-band gain from the EQ knobs.
+    float allGain(1.0), lowGain(1.0), midGain(1.0), highGain(1.0);
+    getGains(&allGain, &lowGain, &midGain, &highGain);
+    updateTables(lowGain, midGain, highGain);
+
+    if (m_image.width() != length || m_image.height() != breadth) {
+        m_image = QImage(length, breadth, QImage::Format_ARGB32_Premultiplied);
+        m_columnColors.resize(length);
+        m_columnTops.resize(length);
+        m_columnBottoms.resize(length);
+        setDirty();
+    }
+    const int completion = waveform->getCompletion();
+    if (data != m_imageData || dataSize != m_imageDataSize ||
+            completion != m_imageCompletion || gain != m_imageGain ||
+            allGain != m_imageAllGain) {
+        setDirty();
+    }
+
+    int shift = 0;
+    if (!isDirty()) {
+        const double columns = (offset - m_imageOffset) / gain;
+        shift = static_cast<int>(round(columns));
+        if (std::abs(columns - shift) > kScrollTolerance ||
+                std::abs(shift) >= length) {
+            setDirty();
+        }
+    }
+
+    if (isDirty()) {
+        m_imageData = data;
+        m_imageDataSize = dataSize;
+        m_imageCompletion = completion;
+        m_imageOffset = offset;
+        m_imageGain = gain;
+        m_imageAllGain = allGain;
+        computeColumns(data, dataSize, offset, gain, 0, length);
+        rasterizeColumns(0, length);
+        setDirty(false);
+    } else if (shift != 0) {
+        // The moved columns keep their offset, which differs from offset by
+        // the tolerance
+        m_imageOffset += shift * gain;
+        scrollImage(shift);
+        const int first = shift > 0 ? length - shift : 0;
+        const int last = shift > 0 ? length : -shift;
+        computeColumns(data, dataSize, m_imageOffset, gain, first, last);
+        rasterizeColumns(first, last);
+    }
+
+    painter->save();
+    painter->setRenderHints(QPainter::Antialiasing, false);
+    painter->setRenderHints(QPainter::HighQualityAntialiasing, false);
+    painter->setRenderHints(QPainter::SmoothPixmapTransform, false);
+    painter->setWorldMatrixEnabled(false);
+    painter->resetTransform();
+
+    // Rotate if drawing vertical waveforms
+    if (m_waveformRenderer->getOrientation() == Qt::Vertical) {
+        painter->setTransform(QTransform(0, 1, 1, 0, 0, 0));
+    }
+
+    // Draw reference line
+    const float halfBreadth = (float)breadth / 2.0;
+    painter->setPen(m_pColors->getAxesColor());
+    painter->drawLine(0, halfBreadth, length, halfBreadth);
+
+    painter->drawImage(0, 0, m_image);
+
+    painter->restore();
+}
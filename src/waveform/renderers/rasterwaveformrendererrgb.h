@@ -0,0 +1,64 @@
+#ifndef RASTERWAVEFORMRENDERERRGB_H
+#define RASTERWAVEFORMRENDERERRGB_H
+
+#include <QImage>
+#include <QRgb>
+
+#include <vector>
+
+#include "util/class.h"
+#include "waveformrenderersignalbase.h"
+
+// Draws the same waveform as WaveformRendererRGB without OpenGL, but
+// rasterizes the columns into the scanlines of an image instead of drawing
+// a line for each of them with QPainter. The squared band values are looked
+// up in tables that are built when the gains change, and the scanlines are
+// filled by loops that the compiler vectorizes.
+//
+// While the track scrolls by whole pixels with the same zoom and gains, the
+// columns of the last frame are moved within the image and only the columns
+// that scroll in are computed and rasterized.
+class RasterWaveformRendererRGB : public WaveformRendererSignalBase {
+  public:
+    explicit RasterWaveformRendererRGB(
+        WaveformWidgetRenderer* waveformWidget);
+    virtual ~RasterWaveformRendererRGB();
+
+    virtual void onSetup(const QDomNode& node);
+    virtual void onSetTrack();
+    virtual void draw(QPainter* painter, QPaintEvent* event);
+
+  private:
+    void updateTables(float lowGain, float midGain, float highGain);
+    // Computes the color and the extent of the columns [first, last)
+    void computeColumns(const WaveformData* data, int dataSize,
+                        double offset, double gain, int first, int last);
+    // Moves the columns of the image by shift columns to the left, or to the
+    // right if shift is negative
+    void scrollImage(int shift);
+    void rasterizeColumns(int first, int last);
+
+    // The squared value of each band with its gain, by the value
+    float m_squaredLow[256];
+    float m_squaredMid[256];
+    float m_squaredHigh[256];
+    float m_tableGains[3];
+
+    QImage m_image;
+    std::vector<QRgb> m_columnColors;
+    // The pixels [top, bottom) of each column are drawn
+    std::vector<int> m_columnTops;
+    std::vector<int> m_columnBottoms;
+
+    // What the image shows unless the renderer is dirty
+    const WaveformData* m_imageData;
+    int m_imageDataSize;
+    int m_imageCompletion;
+    double m_imageOffset;
+    double m_imageGain;
+    float m_imageAllGain;
+
+    DISALLOW_COPY_AND_ASSIGN(RasterWaveformRendererRGB);
+};
+
+#endif // RASTERWAVEFORMRENDERERRGB_H
@@ -2,6 +2,8 @@
 #include <QPaintEvent>
 #include <QPainter>
 
+#include <algorithm>
+
 #include "waveform/renderers/waveformrenderbeat.h"
 
 #include "control/controlobject.h"
@@ -12,7 +14,9 @@
 #include "widget/wwidget.h"
 
 WaveformRenderBeat::WaveformRenderBeat(WaveformWidgetRenderer* waveformWidgetRenderer)
-        : WaveformRendererAbstract(waveformWidgetRenderer) {
+        : WaveformRendererAbstract(waveformWidgetRenderer),
+          m_cachedFirstSample(0.0),
+          m_cachedLastSample(0.0) {
     m_beats.resize(128);
 }
 
@@ -27,6 +31,50 @@ void WaveformRenderBeat::setup(const QDomNode& node, const SkinContext& context)
         m_beatColor.setAlphaF(0.9);
 }
 
+void WaveformRenderBeat::onSetTrack() {
+    m_pCachedBeats.clear();
+    m_cachedBeatSamples.clear();
+
+    TrackPointer trackInfo = m_waveformRenderer->getTrackInfo();
+    if (!trackInfo) {
+        return;
+    }
+    connect(trackInfo.get(), SIGNAL(beatsUpdated()),
+            this, SLOT(slotBeatsUpdated()));
+}
+
+void WaveformRenderBeat::slotBeatsUpdated() {
+    // The grid may have been edited in place
+    setDirty(true);
+}
+
+void WaveformRenderBeat::updateCachedBeats(const BeatsPointer& pBeats,
+        double firstSample, double lastSample) {
+    const double displayedSamples = lastSample - firstSample;
+    // Also refetched after zooming in far to keep the cache small
+    if (!isDirty() && pBeats == m_pCachedBeats &&
+            firstSample >= m_cachedFirstSample &&
+            lastSample <= m_cachedLastSample &&
+            m_cachedLastSample - m_cachedFirstSample <= 5 * displayedSamples) {
+        return;
+    }
+    setDirty(false);
+    m_pCachedBeats = pBeats;
+    // One screen in both directions
+    m_cachedFirstSample = firstSample - displayedSamples;
+    m_cachedLastSample = lastSample + displayedSamples;
+    m_cachedBeatSamples.clear();
+
+    std::unique_ptr<BeatIterator> it(pBeats->findBeats(
+            m_cachedFirstSample, m_cachedLastSample));
+    if (!it) {
+        return;
+    }
+    while (it->hasNext()) {
+        m_cachedBeatSamples.append(it->next());
+    }
+}
+
 void WaveformRenderBeat::draw(QPainter* painter, QPaintEvent* /*event*/) {
     TrackPointer trackInfo = m_waveformRenderer->getTrackInfo();
 
@@ -54,12 +102,17 @@ void WaveformRenderBeat::draw(QPainter* painter, QPaintEvent* /*event*/) {
     //          << "firstDisplayedPosition" << firstDisplayedPosition
     //          << "lastDisplayedPosition" << lastDisplayedPosition;
 
-    std::unique_ptr<BeatIterator> it(trackBeats->findBeats(
-            firstDisplayedPosition * trackSamples,
-            lastDisplayedPosition * trackSamples));
+    const double firstSample = firstDisplayedPosition * trackSamples;
+    const double lastSample = lastDisplayedPosition * trackSamples;
+    updateCachedBeats(trackBeats, firstSample, lastSample);
+
+    const auto first = std::lower_bound(m_cachedBeatSamples.constBegin(),
+            m_cachedBeatSamples.constEnd(), firstSample);
+    const auto last = std::upper_bound(first,
+            m_cachedBeatSamples.constEnd(), lastSample);
 
     // if no beat do not waste time saving/restoring painter
-    if (!it || !it->hasNext()) {
+    if (first == last) {
         return;
     }
 
@@ -76,8 +129,8 @@ void WaveformRenderBeat::draw(QPainter* painter, QPaintEvent* /*event*/) {
 
     int beatCount = 0;
 
-    while (it->hasNext()) {
-        double beatPosition = it->next();
+    for (auto it = first; it != last; ++it) {
+        double beatPosition = *it;
         double xBeatPoint =
                 m_waveformRenderer->transformSamplePositionInRendererWorld(beatPosition);
 
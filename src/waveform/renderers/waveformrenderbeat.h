@@ -2,12 +2,15 @@
 #define WAVEFORMRENDERBEAT_H
 
 #include <QColor>
+#include <QObject>
 
 #include "skin/skincontext.h"
+#include "track/beats.h"
 #include "util/class.h"
 #include "waveform/renderers/waveformrendererabstract.h"
 
-class WaveformRenderBeat : public WaveformRendererAbstract {
+class WaveformRenderBeat : public QObject, public WaveformRendererAbstract {
+    Q_OBJECT
   public:
     explicit WaveformRenderBeat(WaveformWidgetRenderer* waveformWidgetRenderer);
     virtual ~WaveformRenderBeat();
@@ -15,10 +18,28 @@ class WaveformRenderBeat : public WaveformRendererAbstract {
     virtual void setup(const QDomNode& node, const SkinContext& context);
     virtual void draw(QPainter* painter, QPaintEvent* event);
 
+    void onSetTrack() override;
+
+  private slots:
+    void slotBeatsUpdated();
+
   private:
+    // Fetches the beats around the displayed range if the cached beats do
+    // not cover it
+    void updateCachedBeats(const BeatsPointer& pBeats,
+            double firstSample, double lastSample);
+
     QColor m_beatColor;
     QVector<QLineF> m_beats;
 
+    // The sample positions of the beats in a range around the displayed
+    // range, so the iteration over the grid is only repeated when the
+    // grid, the zoom or the displayed range change by a screen
+    BeatsPointer m_pCachedBeats;
+    QVector<double> m_cachedBeatSamples;
+    double m_cachedFirstSample;
+    double m_cachedLastSample;
+
     DISALLOW_COPY_AND_ASSIGN(WaveformRenderBeat);
 };
 
@@ -150,6 +150,21 @@ void WaveformRendererSignalBase::setup(const QDomNode& node,
     onSetup(node);
 }
 
+const WaveformData* WaveformRendererSignalBase::getLevelOfDetail(
+        const Waveform& waveform, int* pDataSize) const {
+    const double displayedSamples = waveform.getDataSize() *
+            (m_waveformRenderer->getLastDisplayedPosition() -
+                    m_waveformRenderer->getFirstDisplayedPosition());
+    const int length = m_waveformRenderer->getLength();
+    // Each level of the bias halves the detail
+    const int bias = WaveformWidgetFactory::instance()->getLevelOfDetailBias();
+    const int level = length > 0 ?
+            waveform.getLevelForSamplesPerPixel(
+                    displayedSamples * (1 << bias) / length) : 0;
+    *pDataSize = waveform.getLevelDataSize(level);
+    return waveform.getLevelData(level);
+}
+
 void WaveformRendererSignalBase::getGains(float* pAllGain, float* pLowGain,
                                           float* pMidGain, float* pHighGain) {
     WaveformWidgetFactory* factory = WaveformWidgetFactory::instance();
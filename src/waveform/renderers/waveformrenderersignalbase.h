@@ -4,6 +4,7 @@
 #include "waveformrendererabstract.h"
 #include "waveformsignalcolors.h"
 #include "skin/skincontext.h"
+#include "waveform/waveform.h"
 
 class ControlObject;
 class ControlProxy;
@@ -25,6 +26,12 @@ public:
     void getGains(float* pAllGain, float* pLowGain, float* pMidGain,
                   float* highGain);
 
+    // Returns the level of detail of waveform that matches the displayed
+    // range, and its size in pDataSize. Zoomed out, the renderers iterate
+    // about as many visual frames as they draw pixels.
+    const WaveformData* getLevelOfDetail(const Waveform& waveform,
+                                         int* pDataSize) const;
+
   protected:
     ControlProxy* m_pEQEnabled;
     ControlProxy* m_pLowFilterControlObject;
@@ -100,12 +100,15 @@ void WaveformRenderMark::slotCuesUpdated() {
         return;
     }
 
-    QList<CuePointer> loadedCues = trackInfo->getCuePoints();
-    for (const CuePointer pCue: loadedCues) {
-        int hotCue = pCue->getHotCue();
+    // The index of the snapshot is shared instead of copying the cue list
+    const TrackEngineSnapshotPointer pTrackSnapshot =
+            trackInfo->getEngineSnapshot();
+    for (const CueIndex::Entry& entry : pTrackSnapshot->cueIndex.entries()) {
+        const int hotCue = entry.hotCue;
         if (hotCue < 0) {
             continue;
         }
+        const CuePointer& pCue = entry.pCue;
 
         QString newLabel = pCue->getLabel();
         QColor newColor = pCue->getColor();
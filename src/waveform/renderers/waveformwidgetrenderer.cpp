@@ -46,6 +46,9 @@ WaveformWidgetRenderer::WaveformWidgetRenderer(const char* group)
       m_scaleFactor(1.0) {
 
     //qDebug() << "WaveformWidgetRenderer";
+    m_drawnFrameState = currentFrameState();
+    // Nothing has been drawn yet
+    m_drawnFrameState.width = -1;
 
 #ifdef WAVEFORMWIDGETRENDERER_DEBUG
     m_timer = new QTime();
@@ -102,7 +105,8 @@ bool WaveformWidgetRenderer::init() {
     return true;
 }
 
-void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
+void WaveformWidgetRenderer::onPreRender(
+        const QHash<QString, double>& playPositions) {
     // For a valid track to render we need
     m_trackSamples = m_pTrackSamplesControlObject->get();
     if (m_trackSamples <= 0.0) {
@@ -135,7 +139,7 @@ void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
     }
 
 
-    double truePlayPos = m_visualPlayPosition->getAtNextVSync(vsyncThread);
+    double truePlayPos = playPositions.value(m_group, -1);
     // m_playPos = -1 happens, when a new track is in buffer but m_visualPlayPosition was not updated
 
     if (m_audioSamplePerPixel && truePlayPos != -1) {
@@ -167,7 +171,35 @@ void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
              */
 }
 
+bool WaveformWidgetRenderer::FrameState::operator==(const FrameState& other) const {
+    return pTrack == other.pTrack &&
+            playPos == other.playPos &&
+            visualSamplePerPixel == other.visualSamplePerPixel &&
+            gain == other.gain &&
+            completion == other.completion &&
+            width == other.width &&
+            height == other.height;
+}
+
+WaveformWidgetRenderer::FrameState WaveformWidgetRenderer::currentFrameState() const {
+    FrameState state;
+    state.pTrack = m_pTrack.get();
+    state.playPos = m_playPos;
+    state.visualSamplePerPixel = m_visualSamplePerPixel;
+    state.gain = m_gain;
+    ConstWaveformPointer pWaveform = m_pTrack ? m_pTrack->getWaveform() : ConstWaveformPointer();
+    state.completion = pWaveform ? pWaveform->getCompletion() : 0;
+    state.width = m_width;
+    state.height = m_height;
+    return state;
+}
+
+bool WaveformWidgetRenderer::isFrameChanged() const {
+    return !(currentFrameState() == m_drawnFrameState);
+}
+
 void WaveformWidgetRenderer::draw(QPainter* painter, QPaintEvent* event) {
+    m_drawnFrameState = currentFrameState();
 
 #ifdef WAVEFORMWIDGETRENDERER_DEBUG
     m_lastSystemFrameTime = m_timer->restart().toIntegerNanos();
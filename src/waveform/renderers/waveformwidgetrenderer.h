@@ -1,6 +1,7 @@
 #ifndef WAVEFORMWIDGETRENDERER_H
 #define WAVEFORMWIDGETRENDERER_H
 
+#include <QHash>
 #include <QPainter>
 #include <QTime>
 #include <QVector>
@@ -33,9 +34,17 @@ class WaveformWidgetRenderer {
     virtual bool onInit() {return true;}
 
     void setup(const QDomNode& node, const SkinContext& context);
-    void onPreRender(VSyncThread* vsyncThread);
+    // Takes the play position from the positions of all decks at the next
+    // VSync, see VisualPlayPosition::getAllAtNextVSync()
+    void onPreRender(const QHash<QString, double>& playPositions);
     void draw(QPainter* painter, QPaintEvent* event);
 
+    // Returns true if the frame after onPreRender() may look different
+    // than the frame that was drawn last. Only the play position, the zoom,
+    // the gain, the size and the analysis progress are compared, so the
+    // frame also needs to be drawn from time to time if this returns false.
+    bool isFrameChanged() const;
+
     inline const char* getGroup() const { return m_group;}
     const TrackPointer getTrackInfo() const { return m_pTrack;}
 
@@ -139,6 +148,21 @@ class WaveformWidgetRenderer {
 #endif
 
 private:
+    struct FrameState {
+        const Track* pTrack;
+        double playPos;
+        double visualSamplePerPixel;
+        double gain;
+        int completion;
+        int width;
+        int height;
+
+        bool operator==(const FrameState& other) const;
+    };
+    FrameState currentFrameState() const;
+
+    FrameState m_drawnFrameState;
+
     DISALLOW_COPY_AND_ASSIGN(WaveformWidgetRenderer);
     friend class WaveformWidgetFactory;
 };
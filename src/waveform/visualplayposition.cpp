@@ -11,6 +11,16 @@
 QMap<QString, QWeakPointer<VisualPlayPosition> > VisualPlayPosition::m_listVisualPlayPosition;
 PerformanceTimer VisualPlayPosition::m_timeInfoTime;
 double VisualPlayPosition::m_dCallbackEntryToDacSecs = 0;
+double VisualPlayPosition::m_dEngineLatencySecs = 0;
+unsigned int VisualPlayPosition::m_callbackCount = 0;
+
+namespace {
+
+// The engine writes the decks shortly after each other, so a deck that has
+// been read before its write in the latest callback is soon up to date
+const int kMaxSnapshotRetries = 2;
+
+} // anonymous namespace
 
 VisualPlayPosition::VisualPlayPosition(const QString& key)
         : m_valid(false),
@@ -30,14 +40,16 @@ void VisualPlayPosition::set(double playPos, double rate,
                              double positionStep, double pSlipPosition) {
     VisualPlayPositionData data;
     data.m_referenceTime = m_timeInfoTime;
-    data.m_callbackEntrytoDac = m_dCallbackEntryToDacSecs * 1000000; // s to µs
+    data.m_callbackCount = m_callbackCount;
+    data.m_callbackEntrytoDac =
+            (m_dCallbackEntryToDacSecs + m_dEngineLatencySecs) * 1000000; // s to µs
     data.m_enginePlayPos = playPos;
     data.m_rate = rate;
     data.m_positionStep = positionStep;
     data.m_pSlipPosition = pSlipPosition;
 
-    // Atomic write
-    m_data.setValue(data);
+    // Lock free write
+    m_data.write(data);
     m_valid = true;
 }
 
@@ -47,26 +59,78 @@ double VisualPlayPosition::getAtNextVSync(VSyncThread* vsyncThread) {
     //return testPos;
 
     if (m_valid) {
-        VisualPlayPositionData data = m_data.getValue();
-        int usRefToVSync = vsyncThread->usFromTimerToNextSync(data.m_referenceTime);
-        int offset = usRefToVSync - data.m_callbackEntrytoDac;
-        double playPos = data.m_enginePlayPos;  // load playPos for the first sample in Buffer
-        // add the offset for the position of the sample that will be transfered to the DAC
-        // When the next display frame is displayed
-        playPos += data.m_positionStep * offset * data.m_rate / m_dAudioBufferSize / 1000;
-        //qDebug() << "playPos" << playPos << offset;
-        return playPos;
+        return playPosAtNextVSync(m_data.read(), vsyncThread);
     }
     return -1;
 }
 
+double VisualPlayPosition::playPosAtNextVSync(
+        const VisualPlayPositionData& data, VSyncThread* vsyncThread) const {
+    int usRefToVSync = vsyncThread->usFromTimerToNextSync(data.m_referenceTime);
+    int offset = usRefToVSync - data.m_callbackEntrytoDac;
+    double playPos = data.m_enginePlayPos;  // load playPos for the first sample in Buffer
+    // add the offset for the position of the sample that will be transfered to the DAC
+    // When the next display frame is displayed
+    playPos += data.m_positionStep * offset * data.m_rate / m_dAudioBufferSize / 1000;
+    //qDebug() << "playPos" << playPos << offset;
+    return playPos;
+}
+
+//static
+void VisualPlayPosition::getAllAtNextVSync(VSyncThread* vsyncThread,
+        QHash<QString, double>* pPositions) {
+    pPositions->clear();
+
+    QList<QSharedPointer<VisualPlayPosition>> positions;
+    QList<VisualPlayPositionData> data;
+    unsigned int latestCallbackCount = 0;
+    for (const auto& weakPosition : m_listVisualPlayPosition) {
+        QSharedPointer<VisualPlayPosition> pPosition = weakPosition.toStrongRef();
+        if (!pPosition) {
+            continue;
+        }
+        if (!pPosition->m_valid) {
+            pPositions->insert(pPosition->m_key, -1);
+            continue;
+        }
+        positions.append(pPosition);
+        data.append(pPosition->m_data.read());
+        if (positions.size() == 1 ||
+                static_cast<int>(
+                        data.last().m_callbackCount - latestCallbackCount) > 0) {
+            latestCallbackCount = data.last().m_callbackCount;
+        }
+    }
+
+    // The decks that have been read before the engine wrote them in the
+    // latest callback are read again
+    for (int retry = 0; retry < kMaxSnapshotRetries; ++retry) {
+        bool consistent = true;
+        for (int i = 0; i < positions.size(); ++i) {
+            if (data[i].m_callbackCount != latestCallbackCount) {
+                data[i] = positions[i]->m_data.read();
+                consistent = consistent &&
+                        data[i].m_callbackCount == latestCallbackCount;
+            }
+        }
+        if (consistent) {
+            break;
+        }
+    }
+
+    for (int i = 0; i < positions.size(); ++i) {
+        pPositions->insert(positions[i]->m_key,
+                positions[i]->playPosAtNextVSync(data[i], vsyncThread));
+    }
+}
+
 void VisualPlayPosition::getPlaySlipAt(int usFromNow, double* playPosition, double* slipPosition) {
     //static double testPos = 0;
     //testPos += 0.000017759; //0.000016608; //  1.46257e-05;
     //return testPos;
 
     if (m_valid) {
-        VisualPlayPositionData data = m_data.getValue();
+        VisualPlayPositionData data = m_data.read();
         int usElapsed = data.m_referenceTime.elapsed().toIntegerMicros();
         int dacFromNow = usElapsed - data.m_callbackEntrytoDac;
         int offset = dacFromNow - usFromNow;
@@ -79,7 +143,7 @@ void VisualPlayPosition::getPlaySlipAt(int usFromNow, double* playPosition, doub
 
 double VisualPlayPosition::getEnginePlayPos() {
     if (m_valid) {
-        VisualPlayPositionData data = m_data.getValue();
+        VisualPlayPositionData data = m_data.read();
         return data.m_enginePlayPos;
     } else {
         return -1;
@@ -106,4 +170,10 @@ void VisualPlayPosition::setCallbackEntryToDacSecs(double secs, const Performanc
     // later correction
     m_timeInfoTime = time;
     m_dCallbackEntryToDacSecs = secs;
+    ++m_callbackCount;
+}
+
+//static
+void VisualPlayPosition::setEngineLatencySecs(double secs) {
+    m_dEngineLatencySecs = secs;
 }
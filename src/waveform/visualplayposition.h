@@ -3,11 +3,12 @@
 
 #include <QMutex>
 #include <QTime>
+#include <QHash>
 #include <QMap>
 #include <QAtomicPointer>
 
 #include "util/performancetimer.h"
-#include "control/controlvalue.h"
+#include "util/triplebuffer.h"
 
 class ControlProxy;
 class VSyncThread;
@@ -29,6 +30,8 @@ class VSyncThread;
 class VisualPlayPositionData {
   public:
     PerformanceTimer m_referenceTime;
+    // Counts the audio callbacks, the same for all decks in one callback
+    unsigned int m_callbackCount;
     int m_callbackEntrytoDac; // Time from Audio Callback Entry to first sample of Buffer is transfered to DAC
     double m_enginePlayPos; // Play position of fist Sample in Buffer
     double m_rate;
@@ -50,6 +53,16 @@ class VisualPlayPosition : public QObject {
     void getPlaySlipAt(int usFromNow, double* playPosition, double* slipPosition);
     double getEnginePlayPos();
 
+    // Fills the positions of all decks at the next VSync into the map by
+    // their group, or -1 for the decks without a valid position. Unlike
+    // calling getAtNextVSync() for each deck, all positions are taken from
+    // the same audio callback, so e.g. the waveforms of synced decks do not
+    // jitter against each other.
+    // WARNING: Not thread safe. This function must only be called from the
+    // main thread.
+    static void getAllAtNextVSync(VSyncThread* vsyncThread,
+            QHash<QString, double>* pPositions);
+
     // WARNING: Not thread safe. This function must only be called from the main
     // thread.
     static QSharedPointer<VisualPlayPosition> getVisualPlayPosition(QString group);
@@ -57,13 +70,21 @@ class VisualPlayPosition : public QObject {
     // This is called by SoundDevicePortAudio just after the callback starts.
     static void setCallbackEntryToDacSecs(double secs, const PerformanceTimer& time);
 
+    // This is called by EngineMaster before the channels are processed with
+    // the latency of the effects on the way to the master output, which
+    // delays the audible position like the sound device does.
+    static void setEngineLatencySecs(double secs);
+
     void setInvalid() { m_valid = false; };
 
   private slots:
     void slotAudioBufferSizeChanged(double size);
 
   private:
-    ControlValueAtomic<VisualPlayPositionData> m_data;
+    double playPosAtNextVSync(const VisualPlayPositionData& data,
+            VSyncThread* vsyncThread) const;
+
+    TripleBuffer<VisualPlayPositionData> m_data;
     ControlProxy* m_audioBufferSize;
     double m_dAudioBufferSize; // Audio buffer size in ms
     bool m_valid;
@@ -72,8 +93,11 @@ class VisualPlayPosition : public QObject {
     static QMap<QString, QWeakPointer<VisualPlayPosition> > m_listVisualPlayPosition;
     // Time info from the Sound device, updated just after audio callback is called
     static double m_dCallbackEntryToDacSecs;
+    // The latency of the effects and the delay compensation of the engine
+    static double m_dEngineLatencySecs;
     // Time stamp for m_timeInfo in main CPU time
     static PerformanceTimer m_timeInfoTime;
+    static unsigned int m_callbackCount;
 };
 
 #endif // VISUALPLAYPOSITION_H
@@ -9,6 +9,7 @@
 #include "util/event.h"
 #include "util/counter.h"
 #include "util/math.h"
+#include "util/threadroles.h"
 #include "waveform/guitick.h"
 
 #if defined(__APPLE__)
@@ -49,6 +50,7 @@ void VSyncThread::stop() {
 void VSyncThread::run() {
     Counter droppedFrames("VsyncThread real time error");
     QThread::currentThread()->setObjectName("VSyncThread");
+    mixxx::ThreadRoles::applyToCurrentThread(mixxx::ThreadRole::VSync);
 
     m_usWaitToSwap = m_usSyncIntervalTime;
     m_timer.start();
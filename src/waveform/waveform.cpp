@@ -1,12 +1,90 @@
+#include <QFile>
+#include <QSaveFile>
 #include <QtDebug>
 
 #include "waveform/waveform.h"
 #include "proto/waveform.pb.h"
+#include "util/assert.h"
+#include "util/math.h"
 
 using namespace mixxx::track;
 
 const int kNumChannels = 2;
 
+namespace {
+
+// "MXWF"
+const quint32 kMappedFileMagic = 0x4d585746;
+// Version 2 appends the levels of detail after the texture
+const quint32 kMappedFileVersion = 2;
+const quint32 kMappedFileVersionWithoutLevels = 1;
+
+// The header of a mapped file, followed by the data of the texture in the
+// layout of WaveformData. The size keeps the data aligned.
+struct MappedFileHeader {
+    quint32 magic;
+    quint32 version;
+    qint32 dataSize;
+    qint32 textureStride;
+    double visualSampleRate;
+    double audioVisualRatio;
+};
+
+// Levels of detail are built while they have at least this many visual
+// frames
+const int kMinLevelFrames = 16;
+
+// The sizes of the levels above level 0 for a waveform of dataSize visual
+// samples. Each level has half of the visual frames of the one below,
+// rounded up.
+std::vector<int> levelDataSizes(int dataSize) {
+    std::vector<int> sizes;
+    int frames = dataSize / 2;
+    while ((frames + 1) / 2 >= kMinLevelFrames) {
+        frames = (frames + 1) / 2;
+        sizes.push_back(frames * 2);
+    }
+    return sizes;
+}
+
+int levelsSize(const std::vector<int>& sizes) {
+    int total = 0;
+    for (int size : sizes) {
+        total += size;
+    }
+    return total;
+}
+
+// Builds all levels after each other into pLevels from the data of level 0
+void buildLevelData(WaveformData* pLevels, const std::vector<int>& sizes,
+        const WaveformData* pData, int dataSize) {
+    const WaveformData* pIn = pData;
+    // Without the odd visual sample at the end
+    int inSize = (dataSize / 2) * 2;
+    for (int size : sizes) {
+        WaveformData* pOut = pLevels;
+        for (int i = 0; i < size; ++i) {
+            // The same channel of the two frames below
+            const int first = 2 * i - (i % 2);
+            const int second = first + 2;
+            WaveformData datum = pIn[first];
+            if (second < inSize) {
+                const WaveformData& next = pIn[second];
+                datum.filtered.low = math_max(datum.filtered.low, next.filtered.low);
+                datum.filtered.mid = math_max(datum.filtered.mid, next.filtered.mid);
+                datum.filtered.high = math_max(datum.filtered.high, next.filtered.high);
+                datum.filtered.all = math_max(datum.filtered.all, next.filtered.all);
+            }
+            pOut[i] = datum;
+        }
+        pIn = pOut;
+        inSize = size;
+        pLevels += size;
+    }
+}
+
+} // anonymous namespace
+
 // Return the smallest power of 2 which is greater than the desired size when
 // squared.
 int computeTextureStride(int size) {
@@ -24,7 +102,10 @@ Waveform::Waveform(const QByteArray data)
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(computeTextureStride(0)),
-          m_completion(-1) {
+          m_completion(-1),
+          m_pData(nullptr),
+          m_levelCount(0),
+          m_memoryAccount(MemoryAccounting::Category::Waveforms) {
     readByteArray(data);
 }
 
@@ -36,7 +117,10 @@ Waveform::Waveform(int audioSampleRate, int audioSamples,
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(1024),
-          m_completion(-1) {
+          m_completion(-1),
+          m_pData(nullptr),
+          m_levelCount(0),
+          m_memoryAccount(MemoryAccounting::Category::Waveforms) {
     int numberOfVisualSamples = 0;
     if (audioSampleRate > 0) {
         if (maxVisualSamples == -1) {
@@ -108,7 +192,7 @@ QByteArray Waveform::toByteArray() const {
 
     int dataSize = getDataSize();
     for (int i = 0; i < dataSize; ++i) {
-        const WaveformData& datum = m_data.at(i);
+        const WaveformData& datum = m_pData[i];
         all->add_value(datum.filtered.all);
         low->add_value(datum.filtered.low);
         mid->add_value(datum.filtered.mid);
@@ -185,29 +269,196 @@ void Waveform::readByteArray(const QByteArray& data) {
     bool mid_valid = mid.units() == io::Waveform::RMS;
     bool high_valid = high.units() == io::Waveform::RMS;
     for (int i = 0; i < dataSize; ++i) {
-        m_data[i].filtered.all = static_cast<unsigned char>(all.value(i));
+        m_pData[i].filtered.all = static_cast<unsigned char>(all.value(i));
         bool use_low = low_valid && i < low.value_size();
         bool use_mid = mid_valid && i < mid.value_size();
         bool use_high = high_valid && i < high.value_size();
-        m_data[i].filtered.low = use_low ? static_cast<unsigned char>(low.value(i)) : 0;
-        m_data[i].filtered.mid = use_mid ? static_cast<unsigned char>(mid.value(i)) : 0;
-        m_data[i].filtered.high = use_high ? static_cast<unsigned char>(high.value(i)) : 0;
+        m_pData[i].filtered.low = use_low ? static_cast<unsigned char>(low.value(i)) : 0;
+        m_pData[i].filtered.mid = use_mid ? static_cast<unsigned char>(mid.value(i)) : 0;
+        m_pData[i].filtered.high = use_high ? static_cast<unsigned char>(high.value(i)) : 0;
     }
     m_completion = dataSize;
     m_saveState = SaveState::Saved;
+    buildLevels();
 }
 
 void Waveform::resize(int size) {
     m_dataSize = size;
     m_textureStride = computeTextureStride(size);
     m_data.resize(m_textureStride * m_textureStride);
+    m_pData = m_data.data();
+    updateMemoryAccount();
 }
 
 void Waveform::assign(int size, int value) {
     m_dataSize = size;
     m_textureStride = computeTextureStride(size);
     m_data.assign(m_textureStride * m_textureStride, value);
+    m_pData = m_data.data();
     m_saveState = SaveState::SavePending;
+    updateMemoryAccount();
+}
+
+void Waveform::updateMemoryAccount() {
+    m_memoryAccount.setBytes(sizeof(WaveformData) *
+            static_cast<qint64>(m_data.capacity() + m_levels.capacity()));
+}
+
+void Waveform::buildLevels() {
+    VERIFY_OR_DEBUG_ASSERT(m_levelCount.loadAcquire() == 0) {
+        return;
+    }
+    const std::vector<int> sizes = levelDataSizes(m_dataSize);
+    m_levels.resize(levelsSize(sizes));
+    buildLevelData(m_levels.data(), sizes, m_pData, m_dataSize);
+    setLevels(m_levels.data(), sizes);
+    updateMemoryAccount();
+}
+
+void Waveform::setLevels(const WaveformData* pLevels, const std::vector<int>& sizes) {
+    m_levelData.clear();
+    m_levelDataSizes = sizes;
+    for (int size : sizes) {
+        m_levelData.push_back(pLevels);
+        pLevels += size;
+    }
+    m_levelCount.storeRelease(static_cast<int>(sizes.size()));
+}
+
+int Waveform::getLevelForSamplesPerPixel(double visualSamplesPerPixel) const {
+    // Two visual samples per frame
+    double framesPerPixel = visualSamplesPerPixel / 2;
+    int level = 0;
+    const int levelCount = getLevelCount();
+    while (level + 1 < levelCount && framesPerPixel >= 2) {
+        framesPerPixel /= 2;
+        ++level;
+    }
+    return level;
+}
+
+QByteArray Waveform::mappedFileHeader() const {
+    MappedFileHeader header;
+    header.magic = kMappedFileMagic;
+    header.version = kMappedFileVersion;
+    header.dataSize = m_dataSize;
+    header.textureStride = m_textureStride;
+    header.visualSampleRate = m_visualSampleRate;
+    header.audioVisualRatio = m_audioVisualRatio;
+    return QByteArray(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+// static
+bool Waveform::isMappedFileHeader(const QByteArray& data) {
+    if (data.size() < mappedFileHeaderSize()) {
+        return false;
+    }
+    const MappedFileHeader* pHeader =
+            reinterpret_cast<const MappedFileHeader*>(data.constData());
+    return pHeader->magic == kMappedFileMagic &&
+            (pHeader->version == kMappedFileVersion ||
+                    pHeader->version == kMappedFileVersionWithoutLevels);
+}
+
+// static
+int Waveform::mappedFileHeaderSize() {
+    return sizeof(MappedFileHeader);
+}
+
+bool Waveform::writeMappedFile(const QString& fileName) const {
+    if (!isValid()) {
+        return false;
+    }
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    const QByteArray header = mappedFileHeader();
+    const qint64 dataBytes = m_dataSize * sizeof(WaveformData);
+    if (file.write(header) != header.size() ||
+            file.write(reinterpret_cast<const char*>(m_pData), dataBytes) != dataBytes) {
+        file.cancelWriting();
+        return false;
+    }
+    // Extends the file to the size of the texture without writing the
+    // padding
+    const qint64 textureEnd = header.size() + getTextureSize() * sizeof(WaveformData);
+    if (!file.resize(textureEnd) || !file.seek(textureEnd)) {
+        file.cancelWriting();
+        return false;
+    }
+    const std::vector<int> sizes = levelDataSizes(m_dataSize);
+    std::vector<WaveformData> levels;
+    const WaveformData* pLevels = nullptr;
+    if (getLevelCount() > 1) {
+        pLevels = getLevelData(1);
+    } else if (!sizes.empty()) {
+        // Not built yet
+        levels.resize(levelsSize(sizes));
+        buildLevelData(levels.data(), sizes, m_pData, m_dataSize);
+        pLevels = levels.data();
+    }
+    const qint64 levelsBytes = levelsSize(sizes) * sizeof(WaveformData);
+    if (levelsBytes > 0 && file.write(
+            reinterpret_cast<const char*>(pLevels), levelsBytes) != levelsBytes) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+bool Waveform::readMappedFile(const QString& fileName) {
+    DEBUG_ASSERT(m_dataSize == 0);
+    auto pFile = std::make_unique<QFile>(fileName);
+    if (!pFile->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray headerData = pFile->read(mappedFileHeaderSize());
+    if (!isMappedFileHeader(headerData)) {
+        return false;
+    }
+    const MappedFileHeader header =
+            *reinterpret_cast<const MappedFileHeader*>(headerData.constData());
+    if (header.dataSize <= 0 ||
+            header.textureStride != computeTextureStride(header.dataSize) ||
+            header.visualSampleRate <= 0 || header.audioVisualRatio <= 0) {
+        qDebug() << "ERROR: Invalid header of mapped waveform" << fileName;
+        return false;
+    }
+    const qint64 textureBytes = static_cast<qint64>(header.textureStride) *
+            header.textureStride * sizeof(WaveformData);
+    const bool withLevels = header.version == kMappedFileVersion;
+    const std::vector<int> sizes = levelDataSizes(header.dataSize);
+    const qint64 levelsBytes = withLevels ?
+            levelsSize(sizes) * sizeof(WaveformData) : 0;
+    const qint64 fileSize = mappedFileHeaderSize() + textureBytes + levelsBytes;
+    if (pFile->size() != fileSize) {
+        qDebug() << "ERROR: Truncated mapped waveform" << fileName
+                 << "of size" << pFile->size() << "instead of" << fileSize;
+        return false;
+    }
+    uchar* pMapped = pFile->map(0, fileSize);
+    if (pMapped == nullptr) {
+        qDebug() << "ERROR: Could not map waveform" << fileName
+                 << pFile->errorString();
+        return false;
+    }
+    // The file stays open while it is mapped
+    m_pMappedFile = std::move(pFile);
+    m_pData = reinterpret_cast<WaveformData*>(pMapped + mappedFileHeaderSize());
+    m_dataSize = header.dataSize;
+    m_textureStride = header.textureStride;
+    m_visualSampleRate = header.visualSampleRate;
+    m_audioVisualRatio = header.audioVisualRatio;
+    m_completion = m_dataSize;
+    m_saveState = SaveState::Saved;
+    if (withLevels) {
+        setLevels(reinterpret_cast<const WaveformData*>(
+                pMapped + mappedFileHeaderSize() + textureBytes), sizes);
+    } else {
+        buildLevels();
+    }
+    return true;
 }
 
 void Waveform::dump() const {
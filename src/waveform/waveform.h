@@ -12,6 +12,10 @@
 
 #include "util/class.h"
 #include "util/compatibility.h"
+#include "util/memory.h"
+#include "util/memoryaccounting.h"
+
+class QFile;
 
 enum FilterIndex { Low = 0, Mid = 1, High = 2, FilterCount = 3};
 enum ChannelIndex { Left = 0, Right = 1, ChannelCount = 2};
@@ -75,6 +79,24 @@ class Waveform {
 
     QByteArray toByteArray() const;
 
+    // Waveforms are also stored uncompressed in a fixed layout that is
+    // mapped into memory when loaded, so they neither need to be
+    // decompressed nor parsed. The padding of the texture is stored as a
+    // hole of the file that takes no space on most file systems.
+    //
+    // Writes the waveform into fileName, replacing the file atomically
+    bool writeMappedFile(const QString& fileName) const;
+    // Maps the waveform in fileName into this empty waveform. Returns
+    // false if the file is not in the mapped format or is damaged.
+    bool readMappedFile(const QString& fileName);
+    // The header of the mapped file of this waveform. AnalysisDao
+    // checksums it instead of the whole file.
+    QByteArray mappedFileHeader() const;
+    // Whether the data at the start of a file is the header of a mapped
+    // waveform
+    static bool isMappedFileHeader(const QByteArray& data);
+    static int mappedFileHeaderSize();
+
     // We do not lock the mutex since m_dataSize and m_visualSampleRate are not
     // changed after the constructor runs.
     bool isValid() const {
@@ -112,39 +134,65 @@ class Waveform {
 
     // We do not lock the mutex since m_data is not resized after the
     // constructor runs.
-    inline int getTextureSize() const { return m_data.size(); }
+    inline int getTextureSize() const { return m_textureStride * m_textureStride; }
 
     // Atomically get the number of data elements in this Waveform. We do not
     // lock the mutex since m_dataSize is not changed after the constructor
     // runs.
     inline int getDataSize() const { return m_dataSize; }
 
-    inline const WaveformData& get(int i) const { return m_data[i];}
-    inline unsigned char getLow(int i) const { return m_data[i].filtered.low;}
-    inline unsigned char getMid(int i) const { return m_data[i].filtered.mid;}
-    inline unsigned char getHigh(int i) const { return m_data[i].filtered.high;}
-    inline unsigned char getAll(int i) const { return m_data[i].filtered.all;}
+    inline const WaveformData& get(int i) const { return m_pData[i];}
+    inline unsigned char getLow(int i) const { return m_pData[i].filtered.low;}
+    inline unsigned char getMid(int i) const { return m_pData[i].filtered.mid;}
+    inline unsigned char getHigh(int i) const { return m_pData[i].filtered.high;}
+    inline unsigned char getAll(int i) const { return m_pData[i].filtered.all;}
 
     // We do not lock the mutex since m_data is not resized after the
-    // constructor runs.
-    WaveformData* data() { return &m_data[0];}
+    // constructor runs. The data of a mapped waveform is read-only.
+    WaveformData* data() { return m_pData;}
 
     // We do not lock the mutex since m_data is not resized after the
     // constructor runs.
-    const WaveformData* data() const { return &m_data[0];}
+    const WaveformData* data() const { return m_pData;}
+
+    // The waveform also holds coarser levels of detail for renderers that
+    // show many visual samples per pixel. Each level halves the number of
+    // visual frames of the previous one and keeps the maximum of each
+    // channel and band, so level 0 is the waveform itself. The levels are
+    // built when the waveform is complete and are empty until then.
+    //
+    // Builds the levels from the complete waveform. Called once, before
+    // the levels are read by other threads.
+    void buildLevels();
+    // The number of levels including level 0
+    int getLevelCount() const {
+        return 1 + m_levelCount.loadAcquire();
+    }
+    // The coarsest level with at least one visual frame per pixel when
+    // visualSamplesPerPixel visual samples of level 0 fall on a pixel
+    int getLevelForSamplesPerPixel(double visualSamplesPerPixel) const;
+    const WaveformData* getLevelData(int level) const {
+        return level == 0 ? m_pData : m_levelData[level - 1];
+    }
+    int getLevelDataSize(int level) const {
+        return level == 0 ? m_dataSize : m_levelDataSizes[level - 1];
+    }
 
     void dump() const;
 
   private:
     void readByteArray(const QByteArray& data);
+    void setLevels(const WaveformData* pLevels, const std::vector<int>& sizes);
     void resize(int size);
     void assign(int size, int value = 0);
-
-    inline WaveformData& at(int i) { return m_data[i];}
-    inline unsigned char& low(int i) { return m_data[i].filtered.low;}
-    inline unsigned char& mid(int i) { return m_data[i].filtered.mid;}
-    inline unsigned char& high(int i) { return m_data[i].filtered.high;}
-    inline unsigned char& all(int i) { return m_data[i].filtered.all;}
+    // A mapped file is not accounted for, it is paged in by the system
+    void updateMemoryAccount();
+
+    inline WaveformData& at(int i) { return m_pData[i];}
+    inline unsigned char& low(int i) { return m_pData[i].filtered.low;}
+    inline unsigned char& mid(int i) { return m_pData[i].filtered.mid;}
+    inline unsigned char& high(int i) { return m_pData[i].filtered.high;}
+    inline unsigned char& all(int i) { return m_pData[i].filtered.all;}
     double getVisualSampleRate() const { return m_visualSampleRate; }
 
     // If stored in the database, the ID of the waveform.
@@ -165,6 +213,18 @@ class Waveform {
     // TODO(XXX): In the future we should switch to QVector and use the raw data
     // pointer when performance matters.
     std::vector<WaveformData> m_data;
+    // The mapped file that holds the data instead of m_data
+    std::unique_ptr<QFile> m_pMappedFile;
+    // Points into m_data or into the mapped file
+    WaveformData* m_pData;
+
+    // The levels of detail above level 0. m_levelCount is stored after the
+    // levels have been built, they are not changed afterwards.
+    std::vector<WaveformData> m_levels;
+    std::vector<const WaveformData*> m_levelData;
+    std::vector<int> m_levelDataSizes;
+    QAtomicInt m_levelCount;
+    MemoryAccount m_memoryAccount;
     // Not allowed to change after the constructor runs.
     double m_visualSampleRate;
     // Not allowed to change after the constructor runs.
@@ -6,7 +6,15 @@
 // static
 Waveform* WaveformFactory::loadWaveformFromAnalysis(
         const AnalysisDao::AnalysisInfo& analysis) {
-    Waveform* pWaveform = new Waveform(analysis.data);
+    Waveform* pWaveform;
+    if (analysis.mappedFileName.isEmpty()) {
+        pWaveform = new Waveform(analysis.data);
+    } else {
+        pWaveform = new Waveform();
+        if (!pWaveform->readMappedFile(analysis.mappedFileName)) {
+            qWarning() << "Failed to map waveform" << analysis.mappedFileName;
+        }
+    }
     pWaveform->setId(analysis.analysisId);
     pWaveform->setVersion(analysis.version);
     pWaveform->setDescription(analysis.description);
@@ -13,6 +13,7 @@
 #include "waveform/widgets/softwarewaveformwidget.h"
 #include "waveform/widgets/hsvwaveformwidget.h"
 #include "waveform/widgets/rgbwaveformwidget.h"
+#include "waveform/widgets/rasterrgbwaveformwidget.h"
 #include "waveform/widgets/glrgbwaveformwidget.h"
 #include "waveform/widgets/glwaveformwidget.h"
 #include "waveform/widgets/glsimplewaveformwidget.h"
@@ -24,11 +25,30 @@
 #include "widget/wwaveformviewer.h"
 #include "waveform/guitick.h"
 #include "waveform/vsyncthread.h"
+#include "waveform/visualplayposition.h"
 #include "util/cmdlineargs.h"
 #include "util/performancetimer.h"
 #include "util/timer.h"
 #include "util/math.h"
 
+namespace {
+
+// The unchanged waveforms of stopped decks are rendered at this rate to
+// catch the state that is not covered by isFrameChanged(), like the EQs
+// and the cue points
+const int kIdleFrameRate = 10;
+// The rate of the widgets that are covered by other windows or minimized
+const int kOffScreenFrameRate = 1;
+
+// The signal renderers use the next coarser level of detail while the
+// rendering of a frame takes more than this part of the frame interval
+const double kRenderBudget = 0.5;
+// and return to the finer level when it takes less than this part
+const double kRenderBudgetRelaxed = 0.2;
+const int kMaxLevelOfDetailBias = 3;
+
+} // anonymous namespace
+
 ///////////////////////////////////////////
 
 WaveformWidgetAbstractHandle::WaveformWidgetAbstractHandle()
@@ -41,7 +61,9 @@ WaveformWidgetAbstractHandle::WaveformWidgetAbstractHandle()
 WaveformWidgetHolder::WaveformWidgetHolder()
     : m_waveformWidget(NULL),
       m_waveformViewer(NULL),
-      m_skinContextCache(UserSettingsPointer(), QString()) {
+      m_skinContextCache(UserSettingsPointer(), QString()),
+      m_skippedFrames(0),
+      m_rendered(false) {
 }
 
 WaveformWidgetHolder::WaveformWidgetHolder(WaveformWidgetAbstract* waveformWidget,
@@ -51,7 +73,9 @@ WaveformWidgetHolder::WaveformWidgetHolder(WaveformWidgetAbstract* waveformWidge
     : m_waveformWidget(waveformWidget),
       m_waveformViewer(waveformViewer),
       m_skinNodeCache(node.cloneNode()),
-      m_skinContextCache(skinContext) {
+      m_skinContextCache(skinContext),
+      m_skippedFrames(0),
+      m_rendered(false) {
 }
 
 ///////////////////////////////////////////
@@ -71,7 +95,10 @@ WaveformWidgetFactory::WaveformWidgetFactory() :
         m_vsyncThread(NULL),
         m_frameCnt(0),
         m_actualFrameRate(0),
-        m_vSyncType(0) {
+        m_vSyncType(0),
+        m_levelOfDetailBias(0),
+        m_renderedFrames(0),
+        m_droppedFrames(0) {
 
     m_visualGain[All] = 1.0;
     m_visualGain[Low] = 1.0;
@@ -494,23 +521,35 @@ void WaveformWidgetFactory::render() {
     if (!m_skipRender) {
         if (m_type) {   // no regular updates for an empty waveform
             // next rendered frame is displayed after next buffer swap and than after VSync
+            // One snapshot of all decks, so all waveforms show the same
+            // audio callback
+            VisualPlayPosition::getAllAtNextVSync(m_vsyncThread, &m_playPositions);
             for (int i = 0; i < m_waveformWidgetHolders.size(); i++) {
                 // Calculate play position for the new Frame in following run
-                m_waveformWidgetHolders[i].m_waveformWidget->preRender(m_vsyncThread);
+                m_waveformWidgetHolders[i].m_waveformWidget->preRender(m_playPositions);
             }
             //qDebug() << "prerender" << m_vsyncThread->elapsed();
 
             // It may happen that there is an artificially delayed due to
             // anti tearing driver settings
             // all render commands are delayed until the swap from the previous run is executed
+            PerformanceTimer timer;
+            timer.start();
             for (int i = 0; i < m_waveformWidgetHolders.size(); i++) {
-                WaveformWidgetAbstract* pWaveformWidget = m_waveformWidgetHolders[i].m_waveformWidget;
-                if (pWaveformWidget->getWidth() > 0 &&
-                        pWaveformWidget->getWidget()->isVisible()) {
-                    (void)pWaveformWidget->render();
+                WaveformWidgetHolder& holder = m_waveformWidgetHolders[i];
+                holder.m_rendered = shouldRender(holder);
+                if (holder.m_rendered) {
+                    (void)holder.m_waveformWidget->render();
+                    holder.m_skippedFrames = 0;
+                } else {
+                    ++holder.m_skippedFrames;
                 }
                 // qDebug() << "render" << i << m_vsyncThread->elapsed();
             }
+            const mixxx::Duration renderTime = timer.elapsed();
+            m_renderTime += renderTime;
+            m_maxRenderTime = math_max(m_maxRenderTime, renderTime);
+            ++m_renderedFrames;
         }
 
         // Notify all other waveform-like widgets (e.g. WSpinny's) that they should
@@ -524,7 +563,9 @@ void WaveformWidgetFactory::render() {
         if (timeCnt > mixxx::Duration::fromSeconds(1)) {
             m_time.start();
             m_frameCnt = m_frameCnt * 1000 / timeCnt.toIntegerMillis(); // latency correction
+            adaptLevelOfDetail(m_vsyncThread->droppedFrames());
             emit(waveformMeasured(m_frameCnt, m_vsyncThread->droppedFrames()));
+            m_maxRenderTime = mixxx::Duration();
             m_frameCnt = 0.0;
         }
     }
@@ -542,7 +583,7 @@ void WaveformWidgetFactory::swap() {
             //qDebug() << "swap() start" << m_vsyncThread->elapsed();
             for (int i = 0; i < m_waveformWidgetHolders.size(); i++) {
                 WaveformWidgetAbstract* pWaveformWidget = m_waveformWidgetHolders[i].m_waveformWidget;
-                if (pWaveformWidget->getWidth() > 0) {
+                if (m_waveformWidgetHolders[i].m_rendered) {
                     QGLWidget* glw = dynamic_cast<QGLWidget*>(pWaveformWidget->getWidget());
                     // Don't swap invalid or invisible widgets. Prevents
                     // continuous log spew of "QOpenGLContext::swapBuffers()
@@ -561,6 +602,50 @@ void WaveformWidgetFactory::swap() {
     m_vsyncThread->vsyncSlotFinished();
 }
 
+bool WaveformWidgetFactory::shouldRender(const WaveformWidgetHolder& holder) const {
+    WaveformWidgetAbstract* pWaveformWidget = holder.m_waveformWidget;
+    QWidget* pWidget = pWaveformWidget->getWidget();
+    if (pWaveformWidget->getWidth() <= 0 || !pWidget->isVisible()) {
+        return false;
+    }
+    int frameRate = m_frameRate;
+    if (pWidget->window()->isMinimized() || pWidget->visibleRegion().isEmpty()) {
+        frameRate = kOffScreenFrameRate;
+    } else if (!pWaveformWidget->isFrameChanged()) {
+        frameRate = kIdleFrameRate;
+    }
+    // Renders every n-th frame
+    return holder.m_skippedFrames + 1 >= m_frameRate / math_max(1, frameRate);
+}
+
+void WaveformWidgetFactory::adaptLevelOfDetail(int droppedFrames) {
+    if (m_renderedFrames > 0) {
+        m_averageRenderTime = mixxx::Duration::fromNanos(
+                m_renderTime.toIntegerNanos() / m_renderedFrames);
+    } else {
+        m_averageRenderTime = mixxx::Duration();
+    }
+    m_renderTime = mixxx::Duration();
+    m_renderedFrames = 0;
+
+    // The detail is reduced before more frames are dropped
+    const double frameIntervalMicros = 1e6 / m_frameRate;
+    const double renderMicros = m_averageRenderTime.toDoubleMicros();
+    if ((renderMicros > frameIntervalMicros * kRenderBudget ||
+            droppedFrames > m_droppedFrames) &&
+            m_levelOfDetailBias < kMaxLevelOfDetailBias) {
+        ++m_levelOfDetailBias;
+        qDebug() << "WaveformWidgetFactory - rendering took"
+                 << m_averageRenderTime.formatMillisWithUnit()
+                 << "reducing the level of detail to" << m_levelOfDetailBias;
+    } else if (renderMicros < frameIntervalMicros * kRenderBudgetRelaxed &&
+            droppedFrames == m_droppedFrames &&
+            m_levelOfDetailBias > 0) {
+        --m_levelOfDetailBias;
+    }
+    m_droppedFrames = droppedFrames;
+}
+
 WaveformWidgetType::Type WaveformWidgetFactory::autoChooseWidgetType() const {
     //default selection
     if (m_openGLAvailable) {
@@ -570,7 +655,8 @@ WaveformWidgetType::Type WaveformWidgetFactory::autoChooseWidgetType() const {
             return WaveformWidgetType::GLRGBWaveform;
         }
     }
-    return WaveformWidgetType::SoftwareWaveform;
+    // Reaches a higher frame rate than the widgets that draw with QPainter
+    return WaveformWidgetType::RasterRGBWaveform;
 }
 
 void WaveformWidgetFactory::evaluateWidgets() {
@@ -608,6 +694,12 @@ void WaveformWidgetFactory::evaluateWidgets() {
             useOpenGLShaders = RGBWaveformWidget::useOpenGLShaders();
             developerOnly = RGBWaveformWidget::developerOnly();
             break;
+        case WaveformWidgetType::RasterRGBWaveform:
+            widgetName = RasterRGBWaveformWidget::getWaveformWidgetName();
+            useOpenGl = RasterRGBWaveformWidget::useOpenGl();
+            useOpenGLShaders = RasterRGBWaveformWidget::useOpenGLShaders();
+            developerOnly = RasterRGBWaveformWidget::developerOnly();
+            break;
         case WaveformWidgetType::QtSimpleWaveform:
             widgetName = QtSimpleWaveformWidget::getWaveformWidgetName();
             useOpenGl = QtSimpleWaveformWidget::useOpenGl();
@@ -696,62 +788,73 @@ WaveformWidgetAbstract* WaveformWidgetFactory::createWaveformWidget(
             type = WaveformWidgetType::EmptyWaveform;
         }
 
-        switch(type) {
-        case WaveformWidgetType::SoftwareWaveform:
-            widget = new SoftwareWaveformWidget(viewer->getGroup(), viewer);
-            break;
-        case WaveformWidgetType::HSVWaveform:
-            widget = new HSVWaveformWidget(viewer->getGroup(), viewer);
-            break;
-        case WaveformWidgetType::RGBWaveform:
-            widget = new RGBWaveformWidget(viewer->getGroup(), viewer);
-            break;
-        case WaveformWidgetType::QtSimpleWaveform:
-            widget = new QtSimpleWaveformWidget(viewer->getGroup(), viewer);
-            break;
-        case WaveformWidgetType::QtWaveform:
-            widget = new QtWaveformWidget(viewer->getGroup(), viewer);
-            break;
-        case WaveformWidgetType::GLSimpleWaveform:
-            widget = new GLSimpleWaveformWidget(viewer->getGroup(), viewer);
-            break;
-        case WaveformWidgetType::GLFilteredWaveform:
-            widget = new GLWaveformWidget(viewer->getGroup(), viewer);
-            break;
-        case WaveformWidgetType::GLRGBWaveform:
-            widget = new GLRGBWaveformWidget(viewer->getGroup(), viewer);
-            break;
-        case WaveformWidgetType::GLSLFilteredWaveform:
-            widget = new GLSLFilteredWaveformWidget(viewer->getGroup(), viewer);
-            break;
-        case WaveformWidgetType::GLSLRGBWaveform:
-            widget = new GLSLRGBWaveformWidget(viewer->getGroup(), viewer);
-            break;
-        case WaveformWidgetType::GLVSyncTest:
-            widget = new GLVSyncTestWidget(viewer->getGroup(), viewer);
-            break;
-        default:
-        //case WaveformWidgetType::SoftwareSimpleWaveform: TODO: (vrince)
-        //case WaveformWidgetType::EmptyWaveform:
-            widget = new EmptyWaveformWidget(viewer->getGroup(), viewer);
-            break;
-        }
-        widget->castToQWidget();
-        if (!widget->isValid()) {
+        widget = createUnmanagedWaveformWidget(type, viewer->getGroup(), viewer);
+        if (!widget) {
             qWarning() << "failed to init WafeformWidget" << type << "fall back to \"Empty\"";
-            delete widget;
-            widget = new EmptyWaveformWidget(viewer->getGroup(), viewer);
-            widget->castToQWidget();
-            if (!widget->isValid()) {
+            widget = createUnmanagedWaveformWidget(
+                    WaveformWidgetType::EmptyWaveform, viewer->getGroup(), viewer);
+            if (!widget) {
                 qWarning() << "failed to init EmptyWaveformWidget";
-                delete widget;
-                widget = NULL;
             }
         }
     }
     return widget;
 }
 
+WaveformWidgetAbstract* WaveformWidgetFactory::createUnmanagedWaveformWidget(
+        WaveformWidgetType::Type type, const char* group, QWidget* parent) {
+    WaveformWidgetAbstract* widget = NULL;
+    switch(type) {
+    case WaveformWidgetType::SoftwareWaveform:
+        widget = new SoftwareWaveformWidget(group, parent);
+        break;
+    case WaveformWidgetType::HSVWaveform:
+        widget = new HSVWaveformWidget(group, parent);
+        break;
+    case WaveformWidgetType::RGBWaveform:
+        widget = new RGBWaveformWidget(group, parent);
+        break;
+    case WaveformWidgetType::RasterRGBWaveform:
+        widget = new RasterRGBWaveformWidget(group, parent);
+        break;
+    case WaveformWidgetType::QtSimpleWaveform:
+        widget = new QtSimpleWaveformWidget(group, parent);
+        break;
+    case WaveformWidgetType::QtWaveform:
+        widget = new QtWaveformWidget(group, parent);
+        break;
+    case WaveformWidgetType::GLSimpleWaveform:
+        widget = new GLSimpleWaveformWidget(group, parent);
+        break;
+    case WaveformWidgetType::GLFilteredWaveform:
+        widget = new GLWaveformWidget(group, parent);
+        break;
+    case WaveformWidgetType::GLRGBWaveform:
+        widget = new GLRGBWaveformWidget(group, parent);
+        break;
+    case WaveformWidgetType::GLSLFilteredWaveform:
+        widget = new GLSLFilteredWaveformWidget(group, parent);
+        break;
+    case WaveformWidgetType::GLSLRGBWaveform:
+        widget = new GLSLRGBWaveformWidget(group, parent);
+        break;
+    case WaveformWidgetType::GLVSyncTest:
+        widget = new GLVSyncTestWidget(group, parent);
+        break;
+    default:
+    //case WaveformWidgetType::SoftwareSimpleWaveform: TODO: (vrince)
+    //case WaveformWidgetType::EmptyWaveform:
+        widget = new EmptyWaveformWidget(group, parent);
+        break;
+    }
+    widget->castToQWidget();
+    if (!widget->isValid()) {
+        delete widget;
+        widget = NULL;
+    }
+    return widget;
+}
+
 int WaveformWidgetFactory::findIndexOf(WWaveformViewer* viewer) const {
     for (int i = 0; i < (int)m_waveformWidgetHolders.size(); i++) {
         if (m_waveformWidgetHolders[i].m_waveformViewer == viewer) {
@@ -1,6 +1,7 @@
 #ifndef WAVEFORMWIDGETFACTORY_H
 #define WAVEFORMWIDGETFACTORY_H
 
+#include <QHash>
 #include <QObject>
 #include <QTime>
 #include <QVector>
@@ -47,6 +48,10 @@ class WaveformWidgetHolder {
     WWaveformViewer* m_waveformViewer;
     QDomNode m_skinNodeCache;
     SkinContext m_skinContextCache;
+    // The frames that were skipped since the widget was rendered last
+    int m_skippedFrames;
+    // Only the rendered widgets are swapped
+    bool m_rendered;
 
     friend class WaveformWidgetFactory;
 };
@@ -96,6 +101,14 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
     void setOverviewNormalized(bool normalize);
     int isOverviewNormalized() const { return m_overviewNormalized;}
 
+    // The number of levels of detail that the signal renderers skip, raised
+    // while the rendering takes longer than the render budget of a frame
+    int getLevelOfDetailBias() const { return m_levelOfDetailBias; }
+    // The time that was spent in rendering the waveforms of a frame during
+    // the last measurement, see waveformMeasured()
+    mixxx::Duration getAverageRenderTime() const { return m_averageRenderTime; }
+    mixxx::Duration getMaxRenderTime() const { return m_maxRenderTime; }
+
     const QVector<WaveformWidgetAbstractHandle> getAvailableTypes() const { return m_waveformWidgetHandles;}
     void getAvailableVSyncTypes(QList<QPair<int, QString > >* list);
     void destroyWidgets();
@@ -110,6 +123,13 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
 
     WaveformWidgetType::Type autoChooseWidgetType() const;
 
+    // Creates a widget of the type for the group that the factory does not
+    // render, e.g. to render it offscreen. Returns NULL if the widget fails
+    // to initialize.
+    WaveformWidgetAbstract* createUnmanagedWaveformWidget(
+            WaveformWidgetType::Type type, const char* group,
+            QWidget* parent = NULL);
+
   signals:
     void waveformUpdateTick();
     void waveformMeasured(float frameRate, int droppedFrames);
@@ -126,6 +146,8 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
 
   private:
     void evaluateWidgets();
+    bool shouldRender(const WaveformWidgetHolder& holder) const;
+    void adaptLevelOfDetail(int droppedFrames);
     WaveformWidgetAbstract* createWaveformWidget(WaveformWidgetType::Type type, WWaveformViewer* viewer);
     int findIndexOf(WWaveformViewer* viewer) const;
 
@@ -154,12 +176,22 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
     bool m_beatGridEnabled;
 
     VSyncThread* m_vsyncThread;
+    // The play positions of all decks for the next VSync, reused for each
+    // frame
+    QHash<QString, double> m_playPositions;
 
     //Debug
     PerformanceTimer m_time;
     float m_frameCnt;
     double m_actualFrameRate;
     int m_vSyncType;
+
+    int m_levelOfDetailBias;
+    int m_renderedFrames;
+    mixxx::Duration m_renderTime;
+    mixxx::Duration m_averageRenderTime;
+    mixxx::Duration m_maxRenderTime;
+    int m_droppedFrames;
 };
 
 #endif // WAVEFORMWIDGETFACTORY_H
@@ -26,8 +26,9 @@ void WaveformWidgetAbstract::release() {
     }
 }
 
-void WaveformWidgetAbstract::preRender(VSyncThread* vsyncThread) {
-    WaveformWidgetRenderer::onPreRender(vsyncThread);
+void WaveformWidgetAbstract::preRender(
+        const QHash<QString, double>& playPositions) {
+    WaveformWidgetRenderer::onPreRender(playPositions);
 }
 
 mixxx::Duration WaveformWidgetAbstract::render() {
@@ -30,7 +30,7 @@ class WaveformWidgetAbstract : public WaveformWidgetRenderer {
     void hold();
     void release();
 
-    virtual void preRender(VSyncThread* vsyncThread);
+    virtual void preRender(const QHash<QString, double>& playPositions);
     virtual mixxx::Duration render();
 
     virtual void resize(int width, int height);
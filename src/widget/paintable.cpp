@@ -2,11 +2,13 @@
 #include "widget/wpixmapstore.h"
 
 #include <QDir>
+#include <QFile>
 #include <QString>
 #include <QtDebug>
 
 #include "util/math.h"
 #include "skin/imgloader.h"
+#include "widget/svgrastercache.h"
 
 // static
 Paintable::DrawMode Paintable::DrawModeFromString(const QString& str) {
@@ -45,8 +47,10 @@ QString Paintable::DrawModeToString(DrawMode mode) {
 }
 
 Paintable::Paintable(const PixmapSource& source, DrawMode mode, double scaleFactor)
-        : m_drawMode(mode),
-          m_source(source) {
+        : m_bImagePending(false),
+          m_drawMode(mode),
+          m_source(source),
+          m_memoryAccount(MemoryAccounting::Category::SkinPixmaps) {
     if (!source.isSVG()) {
         m_pPixmap.reset(WPixmapStore::getPixmapNoCache(source.getPath(), scaleFactor));
     } else {
@@ -68,16 +72,66 @@ Paintable::Paintable(const PixmapSource& source, DrawMode mode, double scaleFact
 #endif
             // The SVG renderer doesn't directly support tiling, so we render
             // it to a pixmap which will then get tiled.
-            QImage copy_buffer(m_pSvg->defaultSize() * scaleFactor, QImage::Format_ARGB32);
-            copy_buffer.fill(0x00000000);  // Transparent black.
-            QPainter painter(&copy_buffer);
-            m_pSvg->render(&painter);
-            WPixmapStore::correctImageColors(&copy_buffer);
+            const QSize size = m_pSvg->defaultSize() * scaleFactor;
+            if (WPixmapStore::willCorrectColors()) {
+                // The color correction of the loader is applied here
+                QImage copy_buffer(size, QImage::Format_ARGB32);
+                copy_buffer.fill(0x00000000);  // Transparent black.
+                QPainter painter(&copy_buffer);
+                m_pSvg->render(&painter);
+                WPixmapStore::correctImageColors(&copy_buffer);
 
-            m_pPixmap.reset(new QPixmap(copy_buffer.size()));
-            m_pPixmap->convertFromImage(copy_buffer);
+                m_pPixmap.reset(new QPixmap(copy_buffer.size()));
+                m_pPixmap->convertFromImage(copy_buffer);
+            } else {
+                // The widgets of the skin are created while the images are
+                // rendered or loaded from the cache, only drawing waits
+                m_pendingImage = SvgRasterCache::render(svgData(), size);
+                m_pendingImageSize = size;
+                m_bImagePending = true;
+            }
         }
     }
+    updateMemoryAccount();
+}
+
+QByteArray Paintable::svgData() const {
+    if (!m_source.getData().isEmpty()) {
+        return m_source.getData();
+    }
+    QFile file(m_source.getPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Paintable: Could not read SVG" << m_source.getPath();
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+QPixmap* Paintable::pixmap() {
+    if (m_bImagePending) {
+        m_bImagePending = false;
+        const QImage image = m_pendingImage.result();
+        m_pendingImage = QFuture<QImage>();
+        if (!image.isNull()) {
+            m_pPixmap.reset(new QPixmap(image.size()));
+            m_pPixmap->convertFromImage(image);
+        }
+        updateMemoryAccount();
+    }
+    return m_pPixmap.data();
+}
+
+void Paintable::updateMemoryAccount() {
+    if (m_bImagePending) {
+        // Rendered as ARGB32
+        m_memoryAccount.setBytes(static_cast<qint64>(
+                m_pendingImageSize.width()) * m_pendingImageSize.height() * 4);
+    } else if (!m_pPixmap.isNull()) {
+        m_memoryAccount.setBytes(static_cast<qint64>(m_pPixmap->width()) *
+                m_pPixmap->height() * m_pPixmap->depth() / 8);
+    } else {
+        m_memoryAccount.setBytes(0);
+    }
 }
 
 bool Paintable::isNull() const {
@@ -85,7 +139,9 @@ bool Paintable::isNull() const {
 }
 
 QSize Paintable::size() const {
-    if (!m_pPixmap.isNull()) {
+    if (m_bImagePending) {
+        return m_pendingImageSize;
+    } else if (!m_pPixmap.isNull()) {
         return m_pPixmap->size();
     } else if (!m_pSvg.isNull()) {
         return m_pSvg->defaultSize();
@@ -94,7 +150,9 @@ QSize Paintable::size() const {
 }
 
 int Paintable::width() const {
-    if (!m_pPixmap.isNull()) {
+    if (m_bImagePending) {
+        return m_pendingImageSize.width();
+    } else if (!m_pPixmap.isNull()) {
         return m_pPixmap->width();
     } else if (!m_pSvg.isNull()) {
         QSize size = m_pSvg->defaultSize();
@@ -104,7 +162,9 @@ int Paintable::width() const {
 }
 
 int Paintable::height() const {
-    if (!m_pPixmap.isNull()) {
+    if (m_bImagePending) {
+        return m_pendingImageSize.height();
+    } else if (!m_pPixmap.isNull()) {
         return m_pPixmap->height();
     } else if (!m_pSvg.isNull()) {
         QSize size = m_pSvg->defaultSize();
@@ -114,7 +174,9 @@ int Paintable::height() const {
 }
 
 QRectF Paintable::rect() const {
-    if (!m_pPixmap.isNull()) {
+    if (m_bImagePending) {
+        return QRectF(QPointF(0, 0), m_pendingImageSize);
+    } else if (!m_pPixmap.isNull()) {
         return m_pPixmap->rect();
     } else if (!m_pSvg.isNull()) {
         return QRectF(QPointF(0, 0), m_pSvg->defaultSize());
@@ -210,18 +272,19 @@ void Paintable::drawInternal(const QRectF& targetRect, QPainter* pPainter,
                              const QRectF& sourceRect) {
     // qDebug() << "Paintable::drawInternal" << DrawModeToString(m_draw_mode)
     //          << targetRect << sourceRect;
-    if (m_pPixmap) {
+    QPixmap* pPixmap = pixmap();
+    if (pPixmap) {
         if (m_drawMode == TILE) {
             // TODO(rryan): Using a source rectangle doesn't make much sense
             // with tiling. Ignore the source rect and tile our natural size
             // across the target rect. What's the right general behavior here?
             // NOTE(rryan): We round our target/source rectangles to the nearest
             // pixel for raster images.
-            pPainter->drawTiledPixmap(targetRect.toRect(), *m_pPixmap, QPoint(0,0));
+            pPainter->drawTiledPixmap(targetRect.toRect(), *pPixmap, QPoint(0,0));
         } else {
             // NOTE(rryan): We round our target/source rectangles to the nearest
             // pixel for raster images.
-            pPainter->drawPixmap(targetRect.toRect(), *m_pPixmap,
+            pPainter->drawPixmap(targetRect.toRect(), *pPixmap,
                                  sourceRect.toRect());
         }
     } else if (m_pSvg) {
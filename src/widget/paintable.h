@@ -2,6 +2,7 @@
 #ifndef PAINTABLE_H
 #define PAINTABLE_H
 
+#include <QFuture>
 #include <QPixmap>
 #include <QHash>
 #include <QSharedPointer>
@@ -14,6 +15,7 @@
 
 #include "skin/imgsource.h"
 #include "skin/pixmapsource.h"
+#include "util/memoryaccounting.h"
 
 // Wrapper around QImage and QSvgRenderer to support rendering SVG images in
 // high fidelity.
@@ -55,11 +57,21 @@ class Paintable {
   private:
     void drawInternal(const QRectF& targetRect, QPainter* pPainter,
                       const QRectF& sourceRect);
+    QByteArray svgData() const;
+    // Waits for the SVG that is rendered in the background, if any
+    QPixmap* pixmap();
+    // Accounts the pixels of the pixmap, including a pending one
+    void updateMemoryAccount();
 
     QScopedPointer<QPixmap> m_pPixmap;
+    QFuture<QImage> m_pendingImage;
+    // The size of the pixmap is known before it has been rendered
+    QSize m_pendingImageSize;
+    bool m_bImagePending;
     QScopedPointer<QSvgRenderer> m_pSvg;
     DrawMode m_drawMode;
     PixmapSource m_source;
+    MemoryAccount m_memoryAccount;
 };
 
 #endif // PAINTABLE
@@ -0,0 +1,97 @@
+#include "widget/svgrastercache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QSvgRenderer>
+#include <QtConcurrentRun>
+#include <QtDebug>
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+#include <QSaveFile>
+#endif
+
+namespace {
+
+QMutex s_mutex;
+QString s_cacheDirPath;
+
+QString cacheFilePath(const QString& cacheDirPath,
+        const QByteArray& svgData, const QSize& size) {
+    const QByteArray hash = QCryptographicHash::hash(
+            svgData, QCryptographicHash::Sha1).toHex();
+    return QDir(cacheDirPath).filePath(QString("%1_%2x%3.png").arg(
+            QString::fromLatin1(hash),
+            QString::number(size.width()),
+            QString::number(size.height())));
+}
+
+void saveCacheFile(const QImage& image, const QString& filePath) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+    // Never leaves a partially written image behind
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) ||
+            !image.save(&file, "PNG") || !file.commit()) {
+        qWarning() << "SvgRasterCache - failed to write cache file" << filePath;
+    }
+#else
+    const QString tempFilePath = filePath + ".tmp";
+    bool written = image.save(tempFilePath, "PNG");
+    if (written) {
+        // QFile::rename() does not replace an existing file
+        QFile::remove(filePath);
+        written = QFile::rename(tempFilePath, filePath);
+    }
+    if (!written) {
+        qWarning() << "SvgRasterCache - failed to write cache file" << filePath;
+        QFile::remove(tempFilePath);
+    }
+#endif
+}
+
+QImage renderImage(const QByteArray& svgData, const QSize& size,
+        const QString& cacheDirPath) {
+    QString filePath;
+    if (!cacheDirPath.isEmpty()) {
+        filePath = cacheFilePath(cacheDirPath, svgData, size);
+        QImage cachedImage(filePath, "PNG");
+        if (cachedImage.size() == size) {
+            return cachedImage.convertToFormat(QImage::Format_ARGB32);
+        }
+    }
+
+    QSvgRenderer renderer(svgData);
+    if (!renderer.isValid() || size.isEmpty()) {
+        return QImage();
+    }
+    QImage image(size, QImage::Format_ARGB32);
+    image.fill(0x00000000);  // Transparent black.
+    QPainter painter(&image);
+    renderer.render(&painter);
+    painter.end();
+
+    if (!filePath.isEmpty() && QDir().mkpath(cacheDirPath)) {
+        saveCacheFile(image, filePath);
+    }
+    return image;
+}
+
+} // anonymous namespace
+
+// static
+void SvgRasterCache::setCacheDirectory(const QString& dirPath) {
+    QMutexLocker locker(&s_mutex);
+    s_cacheDirPath = dirPath;
+}
+
+// static
+QFuture<QImage> SvgRasterCache::render(const QByteArray& svgData,
+        const QSize& size) {
+    QMutexLocker locker(&s_mutex);
+    const QString cacheDirPath = s_cacheDirPath;
+    locker.unlock();
+    return QtConcurrent::run(&renderImage, svgData, size, cacheDirPath);
+}
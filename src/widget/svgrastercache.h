@@ -0,0 +1,31 @@
+#ifndef WIDGET_SVGRASTERCACHE_H
+#define WIDGET_SVGRASTERCACHE_H
+
+#include <QByteArray>
+#include <QFuture>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+// Renders the SVG images that the Paintables draw as pixmaps, i.e. tiled
+// and fixed images, in the global thread pool instead of one after another
+// while the widgets of the skin are created. The rendered images are
+// written to cache files, keyed by a hash of the SVG content and the size
+// that includes the scale factor, so the next launch only loads them.
+//
+// All functions are thread-safe.
+class SvgRasterCache {
+  public:
+    // The directory of the cache files. Without a directory the images are
+    // rendered every time.
+    static void setCacheDirectory(const QString& dirPath);
+
+    // Returns the rendered image with a transparent background, or a null
+    // image if the SVG is invalid
+    static QFuture<QImage> render(const QByteArray& svgData, const QSize& size);
+
+  private:
+    SvgRasterCache() = delete;
+};
+
+#endif // WIDGET_SVGRASTERCACHE_H
@@ -25,6 +25,7 @@ WCoverArt::WCoverArt(QWidget* parent,
           m_pConfig(pConfig),
           m_bEnable(true),
           m_pMenu(new WCoverArtMenu(this)),
+          m_iRequestedCoverWidth(0),
           m_pPlayer(pPlayer),
           m_pDlgFullSize(new DlgCoverArtFullSize(this, pPlayer)) {
     // Accept drops if we have a group to load tracks into.
@@ -54,6 +55,10 @@ WCoverArt::WCoverArt(QWidget* parent,
 }
 
 WCoverArt::~WCoverArt() {
+    CoverArtCache* pCache = CoverArtCache::instance();
+    if (pCache != nullptr) {
+        pCache->cancelRequests(this);
+    }
     delete m_pMenu;
     delete m_pDlgFullSize;
 }
@@ -142,7 +147,9 @@ void WCoverArt::slotReset() {
 
 void WCoverArt::slotTrackCoverArtUpdated() {
     if (m_loadedTrack) {
-        CoverArtCache::requestCover(*m_loadedTrack, this);
+        m_iRequestedCoverWidth = CoverArtCache::thumbnailWidth(size());
+        CoverArtCache::requestCover(*m_loadedTrack, this,
+                m_iRequestedCoverWidth);
     }
 }
 
@@ -220,6 +227,11 @@ void WCoverArt::paintEvent(QPaintEvent* /*unused*/) {
 
 void WCoverArt::resizeEvent(QResizeEvent* /*unused*/) {
     m_loadedCoverScaled = scaledCoverArt(m_loadedCover);
+    // The cover is scaled until the thumbnail for the new size arrives
+    if (m_loadedTrack &&
+            CoverArtCache::thumbnailWidth(size()) != m_iRequestedCoverWidth) {
+        slotTrackCoverArtUpdated();
+    }
     m_defaultCoverScaled = scaledCoverArt(m_defaultCover);
 }
 
@@ -63,6 +63,8 @@ class WCoverArt : public QWidget, public WBaseWidget {
     QPixmap m_defaultCover;
     QPixmap m_defaultCoverScaled;
     CoverInfo m_lastRequestedCover;
+    // The width of the thumbnail of the loaded track, 0 for the full size
+    int m_iRequestedCoverWidth;
     BaseTrackPlayer* m_pPlayer;
     DlgCoverArtFullSize* m_pDlgFullSize;
 };
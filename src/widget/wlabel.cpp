@@ -106,7 +106,16 @@ QString WLabel::text() const {
 }
 
 void WLabel::setText(const QString& text) {
+    // Labels that show control values are set with the same text most of
+    // the time, e.g. while a track plays
+    if (text == m_longText) {
+        return;
+    }
     m_longText = text;
+    updateElidedText();
+}
+
+void WLabel::updateElidedText() {
     if (m_elideMode != Qt::ElideNone) {
         QFontMetrics metrics(font());
         // Measure the text for label width
@@ -134,14 +143,14 @@ bool WLabel::event(QEvent* pEvent) {
             const_cast<QFont&>(fonti).setPixelSize(fonti.pixelSize() * m_scaleFactor);
         }
         // measure text with the new font
-        setText(m_longText);
+        updateElidedText();
     }
     return QLabel::event(pEvent);
 }
 
 void WLabel::resizeEvent(QResizeEvent* event) {
     QLabel::resizeEvent(event);
-    setText(m_longText);
+    updateElidedText();
 }
 
 void WLabel::fillDebugTooltip(QStringList* debug) {
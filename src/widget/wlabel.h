@@ -43,6 +43,8 @@ class WLabel : public QLabel, public WBaseWidget {
     QColor m_qFgColor;
     QColor m_qBgColor;
   private:
+    void updateElidedText();
+
     QString m_longText;
     Qt::TextElideMode m_elideMode;
     double m_scaleFactor;
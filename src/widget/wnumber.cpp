@@ -19,12 +19,17 @@
 
 WNumber::WNumber(QWidget* pParent)
         : WLabel(pParent),
-          m_iNoDigits(2) {
+          m_iNoDigits(2),
+          m_dShownValue(0.0),
+          m_bValueShown(false) {
 }
 
 void WNumber::setup(const QDomNode& node, const SkinContext& context) {
     WLabel::setup(node, context);
 
+    // WLabel::setup() may replace the text with the one of the skin
+    m_bValueShown = false;
+
     // Number of digits after the decimal.
     context.hasNodeSelectInt(node, "NumberOfDigits", &m_iNoDigits);
 
@@ -38,6 +43,11 @@ void WNumber::onConnectedControlChanged(double dParameter, double dValue) {
 }
 
 void WNumber::setValue(double dValue) {
+    if (m_bValueShown && dValue == m_dShownValue) {
+        return;
+    }
+    m_bValueShown = true;
+    m_dShownValue = dValue;
     if (m_skinText.contains("%1")) {
         setText(m_skinText.arg(QString::number(dValue, 'f', m_iNoDigits)));
     } else {
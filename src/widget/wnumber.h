@@ -38,6 +38,11 @@ class WNumber : public WLabel  {
   protected:
     // Number of digits to round to.
     int m_iNoDigits;
+
+  private:
+    // The value of the text, valid after the first setValue()
+    double m_dShownValue;
+    bool m_bValueShown;
 };
 
 #endif
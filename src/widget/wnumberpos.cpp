@@ -8,13 +8,32 @@
 #include "util/math.h"
 #include "util/duration.h"
 
+namespace {
+
+// The centiseconds that Duration::formatSeconds() shows, which truncates the
+// milliseconds. Negative times are shown with a sign.
+qint64 shownCentiseconds(double dSeconds) {
+    const qint64 centis = static_cast<qint64>(fabs(dSeconds) * 1000) / 10;
+    return dSeconds < 0.0 ? -centis - 1 : centis;
+}
+
+} // anonymous namespace
+
 WNumberPos::WNumberPos(const char* group, QWidget* parent)
         : WNumber(parent),
-          m_dOldTimeElapsed(0.0) {
+          m_dOldTimeElapsed(0.0),
+          m_shownElapsedCentis(0),
+          m_shownRemainingCentis(0),
+          m_shownDisplayMode(TrackTime::DisplayMode::Elapsed),
+          m_bTextShown(false) {
+    // The times change with every callback while the track plays, but the
+    // text only needs to follow once per frame
     m_pTimeElapsed = new ControlProxy(group, "time_elapsed", this);
-    m_pTimeElapsed->connectValueChanged(SLOT(slotSetTimeElapsed(double)));
+    m_pTimeElapsed->connectValueChangedCoalesced(
+            SLOT(slotSetTimeElapsed(double)));
     m_pTimeRemaining = new ControlProxy(group, "time_remaining", this);
-    m_pTimeRemaining->connectValueChanged(SLOT(slotTimeRemainingUpdated(double)));
+    m_pTimeRemaining->connectValueChangedCoalesced(
+            SLOT(slotTimeRemainingUpdated(double)));
 
     m_pShowTrackTimeRemaining = new ControlProxy(
             "[Controls]", "ShowDurationRemaining", this);
@@ -23,6 +42,12 @@ WNumberPos::WNumberPos(const char* group, QWidget* parent)
     slotSetDisplayMode(m_pShowTrackTimeRemaining->get());
 }
 
+void WNumberPos::setup(const QDomNode& node, const SkinContext& context) {
+    // WLabel::setup() may replace the text with the one of the skin
+    m_bTextShown = false;
+    WNumber::setup(node, context);
+}
+
 void WNumberPos::mousePressEvent(QMouseEvent* pEvent) {
     bool leftClick = pEvent->buttons() & Qt::LeftButton;
 
@@ -51,6 +76,19 @@ void WNumberPos::setValue(double dValue) {
 
 void WNumberPos::slotSetTimeElapsed(double dTimeElapsed) {
     double dTimeRemaining = m_pTimeRemaining->get();
+    m_dOldTimeElapsed = dTimeElapsed;
+
+    const qint64 elapsedCentis = shownCentiseconds(dTimeElapsed);
+    const qint64 remainingCentis = shownCentiseconds(dTimeRemaining);
+    if (m_bTextShown && elapsedCentis == m_shownElapsedCentis &&
+            remainingCentis == m_shownRemainingCentis &&
+            m_displayMode == m_shownDisplayMode) {
+        return;
+    }
+    m_bTextShown = true;
+    m_shownElapsedCentis = elapsedCentis;
+    m_shownRemainingCentis = remainingCentis;
+    m_shownDisplayMode = m_displayMode;
 
     if (m_displayMode == TrackTime::DisplayMode::Elapsed) {
         if (dTimeElapsed >= 0.0) {
@@ -78,7 +116,6 @@ void WNumberPos::slotSetTimeElapsed(double dTimeElapsed) {
                         dTimeRemaining, mixxx::Duration::Precision::CENTISECONDS));
         }
     }
-    m_dOldTimeElapsed = dTimeElapsed;
 }
 
 // m_pTimeElapsed is not updated when paused at the beginning of a track,
@@ -15,6 +15,8 @@ class WNumberPos : public WNumber {
   public:
     explicit WNumberPos(const char *group, QWidget *parent=nullptr);
 
+    void setup(const QDomNode& node, const SkinContext& context) override;
+
   protected:
     void mousePressEvent(QMouseEvent* pEvent) override;
 
@@ -29,6 +31,12 @@ class WNumberPos : public WNumber {
     TrackTime::DisplayMode m_displayMode;
 
     double m_dOldTimeElapsed;
+    // The centiseconds and the mode of the text, to skip formatting the
+    // same text again
+    qint64 m_shownElapsedCentis;
+    qint64 m_shownRemainingCentis;
+    TrackTime::DisplayMode m_shownDisplayMode;
+    bool m_bTextShown;
     ControlProxy* m_pTimeElapsed;
     ControlProxy* m_pTimeRemaining;
     ControlProxy* m_pShowTrackTimeRemaining;
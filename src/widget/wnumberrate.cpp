@@ -17,21 +17,34 @@
 #include "util/math.h"
 
 WNumberRate::WNumberRate(const char * group, QWidget * parent)
-        : WNumber(parent) {
+        : WNumber(parent),
+          m_dShownRate(0.0),
+          m_bRateShown(false) {
     m_pRateRangeControl = new ControlProxy(group, "rateRange", this);
-    m_pRateRangeControl->connectValueChanged(SLOT(setValue(double)));
+    m_pRateRangeControl->connectValueChangedCoalesced(SLOT(setValue(double)));
     m_pRateDirControl = new ControlProxy(group, "rate_dir", this);
-    m_pRateDirControl->connectValueChanged(SLOT(setValue(double)));
+    m_pRateDirControl->connectValueChangedCoalesced(SLOT(setValue(double)));
     m_pRateControl = new ControlProxy(group, "rate", this);
-    m_pRateControl->connectValueChanged(SLOT(setValue(double)));
+    m_pRateControl->connectValueChangedCoalesced(SLOT(setValue(double)));
     // Initialize the widget.
     setValue(0);
 }
 
+void WNumberRate::setup(const QDomNode& node, const SkinContext& context) {
+    // WLabel::setup() may replace the text with the one of the skin
+    m_bRateShown = false;
+    WNumber::setup(node, context);
+}
+
 void WNumberRate::setValue(double /*dValue*/) {
     double vsign = m_pRateControl->get() *
             m_pRateRangeControl->get() *
             m_pRateDirControl->get();
+    if (m_bRateShown && vsign == m_dShownRate) {
+        return;
+    }
+    m_bRateShown = true;
+    m_dShownRate = vsign;
 
     char sign = '+';
     if (vsign < -0.00000001) {
@@ -21,6 +21,8 @@ class WNumberRate : public WNumber {
   public:
     explicit WNumberRate(const char *group, QWidget *parent=nullptr);
 
+    void setup(const QDomNode& node, const SkinContext& context) override;
+
   private slots:
     void setValue(double dValue) override;
 
@@ -29,6 +31,9 @@ class WNumberRate : public WNumber {
     ControlProxy* m_pRateControl;
     ControlProxy* m_pRateRangeControl;
     ControlProxy* m_pRateDirControl;
+    // The rate of the text, valid after the first setValue()
+    double m_dShownRate;
+    bool m_bRateShown;
 };
 
 #endif
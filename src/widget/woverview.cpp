@@ -19,6 +19,8 @@
 #include <QPixmap>
 #include <QUrl>
 #include <QMimeData>
+#include <QCache>
+#include <QtConcurrentRun>
 
 #include "control/controlobject.h"
 #include "control/controlproxy.h"
@@ -33,8 +35,62 @@
 #include "waveform/waveform.h"
 #include "waveform/waveformwidgetfactory.h"
 
-WOverview::WOverview(const char *pGroup, UserSettingsPointer pConfig, QWidget* parent) :
+namespace {
+
+struct CachedOverview {
+    QImage image;
+    float peak;
+};
+
+// The source images of complete waveforms by track, level, drawing function
+// and colors. Overviews of recently loaded tracks are shown again without
+// drawing them, for example when a track is loaded into another deck.
+// Only accessed from the GUI thread.
+const int kOverviewCacheSizeKiB = 16 * 1024;
+QCache<QString, CachedOverview> s_overviewCache(kOverviewCacheSizeKiB);
+
+QImage createSourceImage(int dataSize) {
+    // Waveform pixmap twice the height of the viewport to be scalable
+    // by total_gain
+    // We keep full range waveform data to scale it on paint
+    QImage image(dataSize / 2, 2 * 255, QImage::Format_ARGB32_Premultiplied);
+    image.fill(QColor(0, 0, 0, 0).value());
+    return image;
+}
+
+void drawSourceImagePart(QImage* pImage, WOverview::DrawPartFunction drawPart,
+        const WaveformData* pData, const WaveformSignalColors& signalColors,
+        int begin, int end) {
+    QPainter painter(pImage);
+    painter.translate(0.0, static_cast<double>(pImage->height()) / 2.0);
+    drawPart(&painter, pData, signalColors, begin, end);
+}
+
+// Evaluate waveform ratio peak
+float waveformPeak(const WaveformData* pData, int begin, int end, float peak) {
+    for (int i = begin; i < end; ++i) {
+        peak = math_max(peak, static_cast<float>(pData[i].filtered.all));
+    }
+    return peak;
+}
+
+void removeCachedOverviews(TrackId trackId) {
+    const QString prefix = trackId.toString() + "/";
+    for (const QString& key: s_overviewCache.keys()) {
+        if (key.startsWith(prefix)) {
+            s_overviewCache.remove(key);
+        }
+    }
+}
+
+} // anonymous namespace
+
+WOverview::WOverview(const char *pGroup, UserSettingsPointer pConfig,
+                     DrawPartFunction drawPart, QWidget* parent) :
         WWidget(parent),
+        m_drawPart(drawPart),
+        m_waveformSourceLevel(0),
+        m_bRenderPending(false),
         m_actualCompletion(0),
         m_pixmapDone(false),
         m_waveformPeak(-1.0),
@@ -58,12 +114,26 @@ WOverview::WOverview(const char *pGroup, UserSettingsPointer pConfig, QWidget* p
     m_trackSamplesControl =
             new ControlProxy(m_group, "track_samples", this);
     m_playControl = new ControlProxy(m_group, "play", this);
+    m_preloadProgressControl = new ControlProxy(
+            m_group, "preload_progress", this);
+    m_preloadProgressControl->connectValueChanged(
+            SLOT(onPreloadProgressChange(double)));
+    connect(&m_renderWatcher, SIGNAL(finished()),
+            this, SLOT(slotRenderFinished()));
     setAcceptDrops(true);
 }
 
 void WOverview::setup(const QDomNode& node, const SkinContext& context) {
     m_scaleFactor = context.getScaleFactor();
     m_signalColors.setup(node, context);
+    m_renderKey = QString("%1/%2/%3/%4/%5/%6/%7").arg(
+            QString::number(reinterpret_cast<quintptr>(m_drawPart), 16),
+            m_signalColors.getLowColor().name(QColor::HexArgb),
+            m_signalColors.getMidColor().name(QColor::HexArgb),
+            m_signalColors.getHighColor().name(QColor::HexArgb),
+            m_signalColors.getRgbLowColor().name(QColor::HexArgb),
+            m_signalColors.getRgbMidColor().name(QColor::HexArgb),
+            m_signalColors.getRgbHighColor().name(QColor::HexArgb));
 
     m_qColorBackground = m_signalColors.getBgColor();
 
@@ -170,7 +240,9 @@ void WOverview::slotWaveformSummaryUpdated() {
             }
         }
     } else {
-        // Null waveform pointer means waveform was cleared.
+        // Null waveform pointer means waveform was cleared. It is
+        // analyzed again, so the cached overviews are outdated.
+        removeCachedOverviews(pTrack->getId());
         m_waveformSourceImage = QImage();
         m_dAnalyzerProgress = 1.0;
         m_actualCompletion = 0;
@@ -198,6 +270,198 @@ void WOverview::slotAnalyzerProgress(int progress) {
     }
 }
 
+bool WOverview::drawNextPixmapPart() {
+    ScopedTimer t("WOverview::drawNextPixmapPart");
+
+    //qDebug() << "WOverview::drawNextPixmapPart() - m_waveform" << m_waveform;
+
+    ConstWaveformPointer pWaveform = getWaveform();
+    if (!pWaveform) {
+        return false;
+    }
+
+    const int dataSize = pWaveform->getDataSize();
+    if (dataSize == 0) {
+        return false;
+    }
+
+    // Always multiple of 2
+    const int waveformCompletion = pWaveform->getCompletion();
+    if (m_actualCompletion == 0 && waveformCompletion >= dataSize) {
+        // Draw the complete waveform at once in the background instead of
+        // drawing it here in the GUI thread
+        return renderCompleteWaveform();
+    }
+
+    // Test if there is some new to draw (at least of pixel width)
+    const int completionIncrement = waveformCompletion - m_actualCompletion;
+
+    int visiblePixelIncrement = completionIncrement * length() / dataSize;
+    if (completionIncrement < 2 || visiblePixelIncrement == 0) {
+        return false;
+    }
+
+    const int nextCompletion = m_actualCompletion + completionIncrement;
+
+    if (m_waveformSourceImage.isNull() || m_waveformSourceLevel != 0) {
+        m_waveformSourceImage = createSourceImage(dataSize);
+        m_waveformSourceLevel = 0;
+        m_waveformImageScaled = QImage();
+    }
+
+    //qDebug() << "WOverview::drawNextPixmapPart() - nextCompletion:"
+    //         << nextCompletion
+    //         << "m_actualCompletion:" << m_actualCompletion
+    //         << "waveformCompletion:" << waveformCompletion
+    //         << "completionIncrement:" << completionIncrement;
+
+    drawSourceImagePart(&m_waveformSourceImage, m_drawPart, pWaveform->data(),
+            m_signalColors, m_actualCompletion, nextCompletion);
+    m_waveformPeak = waveformPeak(pWaveform->data(),
+            m_actualCompletion, nextCompletion, m_waveformPeak);
+
+    // Test if the complete waveform is done
+    if (nextCompletion >= dataSize - 2) {
+        m_pixmapDone = true;
+        //qDebug() << "m_waveformPeakRatio" << m_waveformPeak;
+    }
+
+    // Only the newly analyzed part needs to be scaled
+    rescaleSourceColumns(m_actualCompletion / 2, nextCompletion / 2);
+    m_actualCompletion = nextCompletion;
+    return true;
+}
+
+bool WOverview::renderCompleteWaveform() {
+    if (m_renderWatcher.isRunning()) {
+        // Rendered again by slotRenderFinished()
+        m_bRenderPending = true;
+        return false;
+    }
+    m_bRenderPending = false;
+
+    const int level = sourceLevel(*m_pWaveform);
+    QString cacheKey;
+    const TrackId trackId = m_pCurrentTrack ? m_pCurrentTrack->getId() : TrackId();
+    if (trackId.isValid()) {
+        cacheKey = QString("%1/%2/%3/%4").arg(trackId.toString(),
+                QString::number(m_pWaveform->getDataSize()),
+                QString::number(level), m_renderKey);
+        const CachedOverview* pCached = s_overviewCache.object(cacheKey);
+        if (pCached) {
+            setRenderedImage(pCached->image, level, pCached->peak);
+            return true;
+        }
+    }
+
+    Render request;
+    request.pWaveform = m_pWaveform;
+    request.level = level;
+    request.cacheKey = cacheKey;
+    request.peak = -1.0;
+    m_renderWatcher.setFuture(QtConcurrent::run(
+            &WOverview::render, request, m_drawPart, m_signalColors));
+    return false;
+}
+
+// static
+WOverview::Render WOverview::render(Render request, DrawPartFunction drawPart,
+                                    WaveformSignalColors signalColors) {
+    ScopedTimer t("WOverview::render");
+    const WaveformData* pData = request.pWaveform->getLevelData(request.level);
+    const int dataSize = request.pWaveform->getLevelDataSize(request.level);
+    request.image = createSourceImage(dataSize);
+    drawSourceImagePart(&request.image, drawPart, pData, signalColors,
+            0, dataSize);
+    // The levels keep the maximum, so the peak is the one of level 0
+    request.peak = waveformPeak(pData, 0, dataSize, -1.0);
+    return request;
+}
+
+void WOverview::slotRenderFinished() {
+    const Render result = m_renderWatcher.result();
+    if (!result.cacheKey.isEmpty()) {
+        s_overviewCache.insert(result.cacheKey,
+                new CachedOverview{result.image, result.peak},
+                math_max(1, result.image.byteCount() / 1024));
+    }
+
+    // The track may have been replaced while rendering
+    if (m_pWaveform && result.pWaveform == m_pWaveform) {
+        setRenderedImage(result.image, result.level, result.peak);
+        update();
+    }
+
+    if (m_bRenderPending) {
+        m_bRenderPending = false;
+        if (m_pWaveform && m_pWaveform->getCompletion() >= m_pWaveform->getDataSize() &&
+                (m_actualCompletion == 0 ||
+                 m_waveformSourceLevel != sourceLevel(*m_pWaveform))) {
+            if (renderCompleteWaveform()) {
+                update();
+            }
+        }
+    }
+}
+
+void WOverview::setRenderedImage(const QImage& image, int level, float peak) {
+    m_waveformSourceImage = image;
+    m_waveformSourceLevel = level;
+    m_waveformPeak = peak;
+    m_actualCompletion = m_pWaveform->getDataSize();
+    m_pixmapDone = true;
+    m_waveformImageScaled = QImage();
+    m_diffGain = 0;
+}
+
+int WOverview::sourceLevel(const Waveform& waveform) const {
+    return waveform.getLevelForSamplesPerPixel(
+            static_cast<double>(waveform.getDataSize()) / math_max(1, length()));
+}
+
+int WOverview::diffGain() const {
+    WaveformWidgetFactory* widgetFactory = WaveformWidgetFactory::instance();
+    bool normalize = widgetFactory->isOverviewNormalized();
+    if (normalize && m_pixmapDone && m_waveformPeak > 1) {
+        return 255 - m_waveformPeak - 1;
+    } else {
+        const double visualGain = widgetFactory->getVisualGain(WaveformWidgetFactory::All);
+        return 255.0 - 255.0 / visualGain;
+    }
+}
+
+void WOverview::rescaleSourceColumns(int begin, int end) {
+    if (m_waveformImageScaled.isNull() || m_orientation != Qt::Horizontal ||
+            m_diffGain != diffGain()) {
+        m_waveformImageScaled = QImage();
+        m_diffGain = 0;
+        return;
+    }
+
+    const int sourceWidth = m_waveformSourceImage.width();
+    const int scaledWidth = m_waveformImageScaled.width();
+    // Include a column on both sides that is blended with the new columns
+    // by the smooth scaling
+    const int scaledBegin = math_max(0, begin * scaledWidth / sourceWidth - 1);
+    const int scaledEnd = math_min(scaledWidth,
+            (end * scaledWidth + sourceWidth - 1) / sourceWidth + 1);
+    if (scaledEnd <= scaledBegin) {
+        return;
+    }
+    const int sourceBegin = scaledBegin * sourceWidth / scaledWidth;
+    const int sourceEnd = math_min(sourceWidth,
+            (scaledEnd * sourceWidth + scaledWidth - 1) / scaledWidth);
+
+    QRect sourceRect(sourceBegin, m_diffGain, sourceEnd - sourceBegin,
+            m_waveformSourceImage.height() - 2 * m_diffGain);
+    QImage scaledPart = m_waveformSourceImage.copy(sourceRect).scaled(
+            scaledEnd - scaledBegin, m_waveformImageScaled.height(),
+            Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    QPainter painter(&m_waveformImageScaled);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawImage(scaledBegin, 0, scaledPart);
+}
+
 void WOverview::slotTrackLoaded(TrackPointer pTrack) {
     if (m_pCurrentTrack == pTrack) {
         m_trackLoaded = true;
@@ -215,6 +479,7 @@ void WOverview::slotLoadingTrack(TrackPointer pNewTrack, TrackPointer pOldTrack)
     }
 
     m_waveformSourceImage = QImage();
+    m_waveformImageScaled = QImage();
     m_dAnalyzerProgress = 1.0;
     m_actualCompletion = 0;
     m_waveformPeak = -1.0;
@@ -245,6 +510,10 @@ void WOverview::onEndOfTrackChange(double v) {
     update();
 }
 
+void WOverview::onPreloadProgressChange(double /*v*/) {
+    update();
+}
+
 void WOverview::onMarkChanged(double /*v*/) {
     //qDebug() << "WOverview::onMarkChanged()" << v;
     update();
@@ -313,17 +582,8 @@ void WOverview::paintEvent(QPaintEvent * /*unused*/) {
         }
 
         // Draw waveform pixmap
-        WaveformWidgetFactory* widgetFactory = WaveformWidgetFactory::instance();
         if (!m_waveformSourceImage.isNull()) {
-            int diffGain;
-            bool normalize = widgetFactory->isOverviewNormalized();
-            if (normalize && m_pixmapDone && m_waveformPeak > 1) {
-                diffGain = 255 - m_waveformPeak - 1;
-            } else {
-                const double visualGain = widgetFactory->getVisualGain(WaveformWidgetFactory::All);
-                diffGain = 255.0 - 255.0 / visualGain;
-            }
-
+            const int diffGain = this->diffGain();
             if (m_diffGain != diffGain || m_waveformImageScaled.isNull()) {
                 QRect sourceRect(0, diffGain, m_waveformSourceImage.width(),
                     m_waveformSourceImage.height() - 2 * diffGain);
@@ -362,6 +622,20 @@ void WOverview::paintEvent(QPaintEvent * /*unused*/) {
             }
         }
 
+        const double preloadProgress = m_preloadProgressControl->get();
+        if (preloadProgress > 0.0 && preloadProgress < 1.0) {
+            // Paint the progress of decoding the track into memory along
+            // the edge of the overview
+            painter.setPen(QPen(m_signalColors.getAxesColor(), 2 * m_scaleFactor));
+            if (m_orientation == Qt::Horizontal) {
+                painter.drawLine(0, height() - 1,
+                                 preloadProgress * width(), height() - 1);
+            } else {
+                painter.drawLine(width() - 1, 0,
+                                 width() - 1, preloadProgress * height());
+            }
+        }
+
         if (m_dAnalyzerProgress <= 0.5) { // remove text after progress by wf is recognizable
             if (m_trackLoaded) {
                 //: Text on waveform overview when file is cached from source
@@ -571,6 +845,12 @@ void WOverview::resizeEvent(QResizeEvent * /*unused*/) {
 
     m_waveformImageScaled = QImage();
     m_diffGain = 0;
+
+    // The complete waveform is drawn at the level of detail for the size
+    if (m_pixmapDone && m_pWaveform &&
+            m_waveformSourceLevel != sourceLevel(*m_pWaveform)) {
+        renderCompleteWaveform();
+    }
 }
 
 void WOverview::dragEnterEvent(QDragEnterEvent* event) {
@@ -17,6 +17,7 @@
 #include <QPixmap>
 #include <QColor>
 #include <QList>
+#include <QFutureWatcher>
 
 #include "track/track.h"
 #include "widget/wwidget.h"
@@ -33,7 +34,15 @@ class Waveform;
 class WOverview : public WWidget {
     Q_OBJECT
   public:
-    WOverview(const char* pGroup, UserSettingsPointer pConfig, QWidget* parent=nullptr);
+    // Draws the visual samples [begin, end) of pData with a painter that is
+    // translated to the vertical center of the source image. The complete
+    // waveform is drawn on a worker thread, so the function must only use
+    // its arguments.
+    typedef void (*DrawPartFunction)(QPainter* pPainter, const WaveformData* pData,
+            const WaveformSignalColors& signalColors, int begin, int end);
+
+    WOverview(const char* pGroup, UserSettingsPointer pConfig,
+              DrawPartFunction drawPart, QWidget* parent=nullptr);
 
     void setup(const QDomNode& node, const SkinContext& context);
 
@@ -54,11 +63,11 @@ class WOverview : public WWidget {
     void dragEnterEvent(QDragEnterEvent* event) override;
     void dropEvent(QDropEvent* event) override;
 
-    inline int length() {
+    inline int length() const {
         return m_orientation == Qt::Horizontal ? width() : height();
     }
 
-    inline int breadth() {
+    inline int breadth() const {
         return m_orientation == Qt::Horizontal ? height() : width();
     }
 
@@ -66,31 +75,42 @@ class WOverview : public WWidget {
         return m_pWaveform;
     }
 
-    QImage m_waveformSourceImage;
-    QImage m_waveformImageScaled;
-
-    WaveformSignalColors m_signalColors;
-
-    // Hold the last visual sample processed to generate the pixmap
-    int m_actualCompletion;
-
-    bool m_pixmapDone;
-    float m_waveformPeak;
-
-    int m_diffGain;
-
   private slots:
     void onEndOfTrackChange(double v);
+    void onPreloadProgressChange(double v);
 
     void onMarkChanged(double v);
     void onMarkRangeChange(double v);
 
     void slotWaveformSummaryUpdated();
     void slotAnalyzerProgress(int progress);
+    void slotRenderFinished();
 
   private:
+    // A source image of a complete waveform, drawn on a worker thread
+    struct Render {
+        ConstWaveformPointer pWaveform;
+        int level;
+        QString cacheKey;
+        QImage image;
+        float peak;
+    };
+
     // Append the waveform overview pixmap according to available data in waveform
-    virtual bool drawNextPixmapPart() = 0;
+    bool drawNextPixmapPart();
+    // Takes the source image of a complete waveform from the cache or
+    // starts drawing it. Returns true if the source image was replaced.
+    bool renderCompleteWaveform();
+    static Render render(Render request, DrawPartFunction drawPart,
+                         WaveformSignalColors signalColors);
+    void setRenderedImage(const QImage& image, int level, float peak);
+    // The coarsest level of the waveform that still has a visual frame for
+    // each pixel of the widget
+    int sourceLevel(const Waveform& waveform) const;
+    int diffGain() const;
+    // Rescales the source columns [begin, end) into m_waveformImageScaled
+    // or clears it if everything needs to be rescaled
+    void rescaleSourceColumns(int begin, int end);
     void paintText(const QString &text, QPainter *painter);
     inline int valueToPosition(double value) const {
         return static_cast<int>(m_a * value - m_b);
@@ -99,12 +119,36 @@ class WOverview : public WWidget {
         return (static_cast<double>(position) + m_b) / m_a;
     }
 
+    const DrawPartFunction m_drawPart;
+
+    QImage m_waveformSourceImage;
+    QImage m_waveformImageScaled;
+    // The level of the waveform that m_waveformSourceImage shows
+    int m_waveformSourceLevel;
+
+    WaveformSignalColors m_signalColors;
+    // Identifies the drawing function and the colors of the cached images
+    QString m_renderKey;
+    QFutureWatcher<Render> m_renderWatcher;
+    // True if the waveform or the size changed while rendering
+    bool m_bRenderPending;
+
+    // Hold the last visual sample processed to generate the pixmap
+    int m_actualCompletion;
+
+    bool m_pixmapDone;
+    float m_waveformPeak;
+
+    int m_diffGain;
+
     const QString m_group;
     UserSettingsPointer m_pConfig;
     ControlProxy* m_endOfTrackControl;
     bool m_endOfTrack;
     ControlProxy* m_trackSamplesControl;
     ControlProxy* m_playControl;
+    // Progress of decoding the whole track into memory, see CachingReader
+    ControlProxy* m_preloadProgressControl;
 
     // Current active track
     TrackPointer m_pCurrentTrack;
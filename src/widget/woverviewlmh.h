@@ -8,7 +8,9 @@ class WOverviewLMH : public WOverview {
     WOverviewLMH(const char *pGroup, UserSettingsPointer pConfig, QWidget* parent);
 
   private:
-    bool drawNextPixmapPart() override;
+    // See WOverview::DrawPartFunction
+    static void drawPart(QPainter* pPainter, const WaveformData* pData,
+            const WaveformSignalColors& signalColors, int begin, int end);
 };
 
 #endif // WOVERVIEWLMH_H
@@ -2,83 +2,38 @@
 
 #include <QPainter>
 
-#include "util/timer.h"
 #include "util/math.h"
 #include "waveform/waveform.h"
 
 WOverviewRGB::WOverviewRGB(const char* pGroup,
                            UserSettingsPointer pConfig, QWidget* parent)
-        : WOverview(pGroup, pConfig, parent)  {
+        : WOverview(pGroup, pConfig, &WOverviewRGB::drawPart, parent)  {
 }
 
-bool WOverviewRGB::drawNextPixmapPart() {
-    ScopedTimer t("WOverviewRGB::drawNextPixmapPart");
-
-    //qDebug() << "WOverview::drawNextPixmapPart() - m_waveform" << m_waveform;
-
-    int currentCompletion;
-
-    ConstWaveformPointer pWaveform = getWaveform();
-    if (!pWaveform) {
-        return false;
-    }
-
-    const int dataSize = pWaveform->getDataSize();
-    if (dataSize == 0) {
-        return false;
-    }
-
-    if (m_waveformSourceImage.isNull()) {
-        // Waveform pixmap twice the height of the viewport to be scalable
-        // by total_gain
-        // We keep full range waveform data to scale it on paint
-        m_waveformSourceImage = QImage(dataSize / 2, 2 * 255,
-                QImage::Format_ARGB32_Premultiplied);
-        m_waveformSourceImage.fill(QColor(0, 0, 0, 0).value());
-    }
-
-    // Always multiple of 2
-    const int waveformCompletion = pWaveform->getCompletion();
-    // Test if there is some new to draw (at least of pixel width)
-    const int completionIncrement = waveformCompletion - m_actualCompletion;
-
-    int visiblePixelIncrement = completionIncrement * length() / dataSize;
-    if (completionIncrement < 2 || visiblePixelIncrement == 0) {
-        return false;
-    }
-
-    const int nextCompletion = m_actualCompletion + completionIncrement;
-
-    //qDebug() << "WOverview::drawNextPixmapPart() - nextCompletion:"
-    //         << nextCompletion
-    //         << "m_actualCompletion:" << m_actualCompletion
-    //         << "waveformCompletion:" << waveformCompletion
-    //         << "completionIncrement:" << completionIncrement;
-
-    QPainter painter(&m_waveformSourceImage);
-    painter.translate(0.0, static_cast<double>(m_waveformSourceImage.height()) / 2.0);
-
+// static
+void WOverviewRGB::drawPart(QPainter* pPainter, const WaveformData* pData,
+        const WaveformSignalColors& signalColors, int begin, int end) {
     QColor color;
 
     qreal lowColor_r, lowColor_g, lowColor_b;
-    m_signalColors.getRgbLowColor().getRgbF(&lowColor_r, &lowColor_g, &lowColor_b);
+    signalColors.getRgbLowColor().getRgbF(&lowColor_r, &lowColor_g, &lowColor_b);
 
     qreal midColor_r, midColor_g, midColor_b;
-    m_signalColors.getRgbMidColor().getRgbF(&midColor_r, &midColor_g, &midColor_b);
+    signalColors.getRgbMidColor().getRgbF(&midColor_r, &midColor_g, &midColor_b);
 
     qreal highColor_r, highColor_g, highColor_b;
-    m_signalColors.getRgbHighColor().getRgbF(&highColor_r, &highColor_g, &highColor_b);
+    signalColors.getRgbHighColor().getRgbF(&highColor_r, &highColor_g, &highColor_b);
 
-    for (currentCompletion = m_actualCompletion;
-            currentCompletion < nextCompletion; currentCompletion += 2) {
+    for (int currentCompletion = begin;
+            currentCompletion < end; currentCompletion += 2) {
 
-        unsigned char left = pWaveform->getAll(currentCompletion);
-        unsigned char right = pWaveform->getAll(currentCompletion + 1);
+        unsigned char left = pData[currentCompletion].filtered.all;
+        unsigned char right = pData[currentCompletion + 1].filtered.all;
 
         // Retrieve "raw" LMH values from waveform
-        qreal low = static_cast<qreal>(pWaveform->getLow(currentCompletion));
-        qreal mid = static_cast<qreal>(pWaveform->getMid(currentCompletion));
-        qreal high = static_cast<qreal>(pWaveform->getHigh(currentCompletion));
+        qreal low = static_cast<qreal>(pData[currentCompletion].filtered.low);
+        qreal mid = static_cast<qreal>(pData[currentCompletion].filtered.mid);
+        qreal high = static_cast<qreal>(pData[currentCompletion].filtered.high);
 
         // Do matrix multiplication
         qreal red = low * lowColor_r + mid * midColor_r + high * highColor_r;
@@ -89,14 +44,14 @@ bool WOverviewRGB::drawNextPixmapPart() {
         qreal max = math_max3(red, green, blue);
         if (max > 0.0) {
             color.setRgbF(red / max, green / max, blue / max);
-            painter.setPen(color);
-            painter.drawLine(currentCompletion / 2, -left, currentCompletion / 2, 0);
+            pPainter->setPen(color);
+            pPainter->drawLine(currentCompletion / 2, -left, currentCompletion / 2, 0);
         }
 
         // Retrieve "raw" LMH values from waveform
-        low = static_cast<qreal>(pWaveform->getLow(currentCompletion + 1));
-        mid = static_cast<qreal>(pWaveform->getMid(currentCompletion + 1));
-        high = static_cast<qreal>(pWaveform->getHigh(currentCompletion + 1));
+        low = static_cast<qreal>(pData[currentCompletion + 1].filtered.low);
+        mid = static_cast<qreal>(pData[currentCompletion + 1].filtered.mid);
+        high = static_cast<qreal>(pData[currentCompletion + 1].filtered.high);
 
         // Do matrix multiplication
         red = low * lowColor_r + mid * midColor_r + high * highColor_r;
@@ -107,29 +62,8 @@ bool WOverviewRGB::drawNextPixmapPart() {
         max = math_max3(red, green, blue);
         if (max > 0.0) {
             color.setRgbF(red / max, green / max, blue / max);
-            painter.setPen(color);
-            painter.drawLine(currentCompletion / 2, 0, currentCompletion / 2, right);
+            pPainter->setPen(color);
+            pPainter->drawLine(currentCompletion / 2, 0, currentCompletion / 2, right);
         }
     }
-
-    // Evaluate waveform ratio peak
-    for (currentCompletion = m_actualCompletion;
-            currentCompletion < nextCompletion; currentCompletion += 2) {
-        m_waveformPeak = math_max3(
-                m_waveformPeak,
-                static_cast<float>(pWaveform->getAll(currentCompletion)),
-                static_cast<float>(pWaveform->getAll(currentCompletion + 1)));
-    }
-
-    m_actualCompletion = nextCompletion;
-    m_waveformImageScaled = QImage();
-    m_diffGain = 0;
-
-    // Test if the complete waveform is done
-    if (m_actualCompletion >= dataSize - 2) {
-        m_pixmapDone = true;
-        //qDebug() << "m_waveformPeakRatio" << m_waveformPeak;
-    }
-
-    return true;
 }
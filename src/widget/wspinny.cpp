@@ -16,6 +16,28 @@
 #include "widget/wspinny.h"
 #include "wimagestore.h"
 
+namespace {
+
+#ifndef __OPENGLES__
+// Draws the bound texture into the rectangle. The textures are flipped, so
+// the top of the rectangle shows the first row of the image.
+void drawTextureRect(const QRectF& rect) {
+    glBegin(GL_QUADS); {
+        glTexCoord2f(0.0f, 1.0f);
+        glVertex2f(rect.left(), rect.top());
+        glTexCoord2f(1.0f, 1.0f);
+        glVertex2f(rect.right(), rect.top());
+        glTexCoord2f(1.0f, 0.0f);
+        glVertex2f(rect.right(), rect.bottom());
+        glTexCoord2f(0.0f, 0.0f);
+        glVertex2f(rect.left(), rect.bottom());
+    }
+    glEnd();
+}
+#endif
+
+} // anonymous namespace
+
 // The SampleBuffers format enables antialiasing.
 WSpinny::WSpinny(QWidget* parent, const QString& group,
                  UserSettingsPointer pConfig,
@@ -41,11 +63,14 @@ WSpinny::WSpinny(QWidget* parent, const QString& group,
           m_pSignalEnabled(nullptr),
           m_pSlipEnabled(nullptr),
           m_bShowCover(true),
+          m_iRequestedCoverWidth(0),
           m_dInitialPos(0.),
           m_iVinylInput(-1),
           m_bVinylActive(false),
           m_bSignalActive(true),
           m_iVinylScopeSize(0),
+          m_scopeTexture(0),
+          m_bScopeDirty(false),
           m_fAngle(0.0f),
           m_dAngleCurrentPlaypos(-1),
           m_dAngleLastPlaypos(-1),
@@ -97,6 +122,10 @@ WSpinny::WSpinny(QWidget* parent, const QString& group,
 }
 
 WSpinny::~WSpinny() {
+    CoverArtCache* pCache = CoverArtCache::instance();
+    if (pCache != nullptr) {
+        pCache->cancelRequests(this);
+    }
 #ifdef __VINYLCONTROL__
     m_pVCManager->removeSignalQualityListener(this);
 #endif
@@ -104,6 +133,10 @@ WSpinny::~WSpinny() {
     WImageStore::deleteImage(m_pMaskImage);
     WImageStore::deleteImage(m_pFgImage);
     WImageStore::deleteImage(m_pGhostImage);
+    if (m_scopeTexture) {
+        makeCurrent();
+        glDeleteTextures(1, &m_scopeTexture);
+    }
 }
 
 void WSpinny::onVinylSignalQualityUpdate(const VinylSignalQualityReport& report) {
@@ -137,6 +170,7 @@ void WSpinny::onVinylSignalQualityUpdate(const VinylSignalQualityReport& report)
             line++;
         }
     }
+    m_bScopeDirty = true;
     m_bWidgetDirty = true;
 #endif
 }
@@ -277,7 +311,9 @@ void WSpinny::slotLoadingTrack(TrackPointer pNewTrack, TrackPointer pOldTrack) {
 
 void WSpinny::slotTrackCoverArtUpdated() {
     if (m_loadedTrack) {
-        CoverArtCache::requestCover(*m_loadedTrack, this);
+        m_iRequestedCoverWidth = CoverArtCache::thumbnailWidth(size());
+        CoverArtCache::requestCover(*m_loadedTrack, this,
+                m_iRequestedCoverWidth);
     }
 }
 
@@ -325,6 +361,27 @@ void WSpinny::paintEvent(QPaintEvent *e) {
     p.setRenderHint(QPainter::SmoothPixmapTransform);
     p.drawPrimitive(QStyle::PE_Widget, option);
 
+    if (m_dAngleCurrentPlaypos != m_dAngleLastPlaypos) {
+        m_fAngle = calculateAngle(m_dAngleCurrentPlaypos);
+        m_dAngleLastPlaypos = m_dAngleCurrentPlaypos;
+    }
+
+    if (m_dGhostAngleCurrentPlaypos != m_dGhostAngleLastPlaypos) {
+        m_fGhostAngle = calculateAngle(m_dGhostAngleCurrentPlaypos);
+        m_dGhostAngleLastPlaypos = m_dGhostAngleCurrentPlaypos;
+    }
+
+    // The artwork is drawn from cached textures and rotated by the GL
+    // transform unless there is no valid context.
+#ifndef __OPENGLES__
+    if (context()->isValid()) {
+        p.beginNativePainting();
+        drawTextures();
+        p.endNativePainting();
+        return;
+    }
+#endif
+
     if (m_pBgImage) {
         p.drawImage(rect(), *m_pBgImage, m_pBgImage->rect());
     }
@@ -359,16 +416,6 @@ void WSpinny::paintEvent(QPaintEvent *e) {
         p.save();
     }
 
-    if (m_dAngleCurrentPlaypos != m_dAngleLastPlaypos) {
-        m_fAngle = calculateAngle(m_dAngleCurrentPlaypos);
-        m_dAngleLastPlaypos = m_dAngleCurrentPlaypos;
-    }
-
-    if (m_dGhostAngleCurrentPlaypos != m_dGhostAngleLastPlaypos) {
-        m_fGhostAngle = calculateAngle(m_dGhostAngleCurrentPlaypos);
-        m_dGhostAngleLastPlaypos = m_dGhostAngleCurrentPlaypos;
-    }
-
     if (m_pFgImage && !m_pFgImage->isNull()) {
         // Now rotate the image and draw it on the screen.
         p.rotate(m_fAngle);
@@ -389,6 +436,104 @@ void WSpinny::paintEvent(QPaintEvent *e) {
     }
 }
 
+void WSpinny::drawTextures() {
+#ifndef __OPENGLES__
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    // The coordinates of the widget, with the origin at the top left
+    glOrtho(0, width(), height(), 0, -10.0, 10.0);
+
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+    if (m_pBgImage && !m_pBgImage->isNull()) {
+        glBindTexture(GL_TEXTURE_2D, bindTexture(*m_pBgImage));
+        drawTextureRect(rect());
+    }
+
+    if (m_bShowCover && !m_loadedCoverScaled.isNull()) {
+        // Some covers aren't square, so center them.
+        QRect coverRect(QPoint(0, 0), m_loadedCoverScaled.size());
+        coverRect.moveCenter(rect().center());
+        glBindTexture(GL_TEXTURE_2D, bindTexture(m_loadedCoverScaled));
+        drawTextureRect(coverRect);
+    }
+
+    if (m_pMaskImage && !m_pMaskImage->isNull()) {
+        glBindTexture(GL_TEXTURE_2D, bindTexture(*m_pMaskImage));
+        drawTextureRect(rect());
+    }
+
+#ifdef __VINYLCONTROL__
+    // Overlay the signal quality drawing if vinyl is active
+    if (m_bVinylActive && m_bSignalActive && !m_qImage.isNull()) {
+        if (!m_scopeTexture) {
+            glGenTextures(1, &m_scopeTexture);
+            glBindTexture(GL_TEXTURE_2D, m_scopeTexture);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+                         m_iVinylScopeSize, m_iVinylScopeSize, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            m_bScopeDirty = true;
+        } else {
+            glBindTexture(GL_TEXTURE_2D, m_scopeTexture);
+        }
+        if (m_bScopeDirty) {
+            // Like the textures that bindTexture() creates, the rows are
+            // flipped
+            const QImage scope = convertToGLFormat(m_qImage);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
+                            m_iVinylScopeSize, m_iVinylScopeSize,
+                            GL_RGBA, GL_UNSIGNED_BYTE, scope.constBits());
+            m_bScopeDirty = false;
+        }
+        // draw the last good image
+        drawTextureRect(rect());
+    }
+#endif
+
+    // Rotate the coordinate system around the center of the widget, like
+    // the QPainter below.
+    glTranslatef(width() / 2, height() / 2, 0.0f);
+
+    if (m_pFgImage && !m_pFgImage->isNull() && !m_fgImageScaled.isNull()) {
+        glPushMatrix();
+        glRotatef(m_fAngle, 0.0f, 0.0f, 1.0f);
+        QRectF fgRect(QPointF(0, 0), m_fgImageScaled.size());
+        fgRect.moveCenter(QPointF(0, 0));
+        glBindTexture(GL_TEXTURE_2D, bindTexture(m_fgImageScaled));
+        drawTextureRect(fgRect);
+        glPopMatrix();
+    }
+
+    if (m_bGhostPlayback && m_pGhostImage && !m_pGhostImage->isNull() &&
+            !m_ghostImageScaled.isNull()) {
+        glPushMatrix();
+        glRotatef(m_fGhostAngle, 0.0f, 0.0f, 1.0f);
+        QRectF ghostRect(QPointF(0, 0), m_ghostImageScaled.size());
+        ghostRect.moveCenter(QPointF(0, 0));
+        glBindTexture(GL_TEXTURE_2D, bindTexture(m_ghostImageScaled));
+        drawTextureRect(ghostRect);
+        glPopMatrix();
+    }
+
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_BLEND);
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+#endif
+}
+
 QPixmap WSpinny::scaledCoverArt(const QPixmap& normal) {
     if (normal.isNull()) {
         return QPixmap();
@@ -398,6 +543,11 @@ QPixmap WSpinny::scaledCoverArt(const QPixmap& normal) {
 
 void WSpinny::resizeEvent(QResizeEvent* /*unused*/) {
     m_loadedCoverScaled = scaledCoverArt(m_loadedCover);
+    // The cover is scaled until the thumbnail for the new size arrives
+    if (m_loadedTrack &&
+            CoverArtCache::thumbnailWidth(size()) != m_iRequestedCoverWidth) {
+        slotTrackCoverArtUpdated();
+    }
     if (m_pFgImage && !m_pFgImage->isNull()) {
         m_fgImageScaled = m_pFgImage->scaled(
                 size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
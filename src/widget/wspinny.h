@@ -73,6 +73,11 @@ class WSpinny : public QGLWidget, public WBaseWidget, public VinylSignalQualityL
     QPixmap scaledCoverArt(const QPixmap& normal);
 
   private:
+    // Draws the images as textures in the current GL context. The artwork is
+    // uploaded once and stays in the texture cache of the shared context
+    // until the scaled images change.
+    void drawTextures();
+
     QString m_group;
     UserSettingsPointer m_pConfig;
     QImage* m_pBgImage;
@@ -98,6 +103,8 @@ class WSpinny : public QGLWidget, public WBaseWidget, public VinylSignalQualityL
     QPixmap m_loadedCoverScaled;
     CoverInfo m_lastRequestedCover;
     bool m_bShowCover;
+    // The width of the thumbnail of the loaded track, 0 for the full size
+    int m_iRequestedCoverWidth;
 
 
     VinylControlManager* m_pVCManager;
@@ -108,6 +115,10 @@ class WSpinny : public QGLWidget, public WBaseWidget, public VinylSignalQualityL
     bool m_bSignalActive;
     QImage m_qImage;
     int m_iVinylScopeSize;
+    // The scope is uploaded to the texture when it changed since the last
+    // paint and vinyl control is active
+    GLuint m_scopeTexture;
+    bool m_bScopeDirty;
 
     float m_fAngle; //Degrees
     double m_dAngleCurrentPlaypos;
@@ -16,6 +16,7 @@
 #include "widget/wwidget.h"
 #include "library/coverartcache.h"
 #include "library/dlgtrackinfo.h"
+#include "library/basesqltablemodel.h"
 #include "library/librarytablemodel.h"
 #include "library/crate/cratefeaturehelper.h"
 #include "library/dao/trackschema.h"
@@ -50,7 +51,8 @@ WTrackTableView::WTrackTableView(QWidget * parent,
           m_selectionChangedSinceLastGuiTick(true),
           m_loadCachedOnly(false),
           m_bPlaylistMenuLoaded(false),
-          m_bCrateMenuLoaded(false) {
+          m_bCrateMenuLoaded(false),
+          m_bRestoreVScrollBarPosOnLoad(false) {
 
     connect(&m_loadTrackMapper, SIGNAL(mapped(QString)),
             this, SLOT(loadSelectionToGroup(QString)));
@@ -319,6 +321,11 @@ void WTrackTableView::loadTrackModel(QAbstractItemModel *model) {
     setHorizontalHeader(tempHeader);
 
     setModel(model);
+    BaseSqlTableModel* pSqlTableModel = qobject_cast<BaseSqlTableModel*>(model);
+    if (pSqlTableModel) {
+        connect(pSqlTableModel, SIGNAL(loadingChanged(bool)),
+                this, SLOT(slotLoadingChanged(bool)), Qt::UniqueConnection);
+    }
     setHorizontalHeader(header);
     header->setMovable(true);
     header->setClickable(true);
@@ -409,6 +416,24 @@ void WTrackTableView::loadTrackModel(QAbstractItemModel *model) {
     restoreVScrollBarPos(newModel);
     // restoring scrollBar position using model pointer as key
     // scrollbar positions with respect  to different models are backed by map
+    m_bRestoreVScrollBarPosOnLoad = pSqlTableModel && pSqlTableModel->isLoading();
+    slotLoadingChanged(pSqlTableModel && pSqlTableModel->isLoading());
+}
+
+void WTrackTableView::slotLoadingChanged(bool loading) {
+    if (sender() && sender() != model()) {
+        // A model that is not shown
+        return;
+    }
+    if (loading) {
+        viewport()->setCursor(Qt::BusyCursor);
+        return;
+    }
+    viewport()->unsetCursor();
+    if (m_bRestoreVScrollBarPosOnLoad) {
+        m_bRestoreVScrollBarPosOnLoad = false;
+        restoreVScrollBarPos(getTrackModel());
+    }
 }
 
 void WTrackTableView::createActions() {
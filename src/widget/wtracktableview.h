@@ -54,6 +54,7 @@ class WTrackTableView : public WLibraryTableView {
     void slotSendToAutoDJReplace() override;
 
   private slots:
+    void slotLoadingChanged(bool loading);
     void slotRemove();
     void slotHide();
     void slotOpenInFileBrowser();
@@ -212,6 +213,8 @@ class WTrackTableView : public WLibraryTableView {
     bool m_loadCachedOnly;
     bool m_bPlaylistMenuLoaded;
     bool m_bCrateMenuLoaded;
+    // The scroll bar position of the model is restored when its rows arrive
+    bool m_bRestoreVScrollBarPosOnLoad;
     ControlProxy* m_pCOTGuiTick;
 };
 
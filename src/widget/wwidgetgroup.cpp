@@ -200,9 +200,30 @@ void WWidgetGroup::resizeEvent(QResizeEvent* re) {
     QFrame::resizeEvent(re);
 }
 
+void WWidgetGroup::setChildrenBuilder(const std::function<void()>& buildChildren) {
+    m_buildChildren = buildChildren;
+}
+
+void WWidgetGroup::buildChildren() {
+    std::function<void()> buildChildren;
+    buildChildren.swap(m_buildChildren);
+    buildChildren();
+    // Qt would only show the children that are added while the group is
+    // shown with the next event loop iteration
+    for (QObject* pObject : children()) {
+        QWidget* pChild = qobject_cast<QWidget*>(pObject);
+        if (pChild && !pChild->isWindow() &&
+                !pChild->testAttribute(Qt::WA_WState_ExplicitShowHide)) {
+            pChild->show();
+        }
+    }
+}
+
 bool WWidgetGroup::event(QEvent* pEvent) {
     if (pEvent->type() == QEvent::ToolTip) {
         updateTooltip();
+    } else if (pEvent->type() == QEvent::Show && m_buildChildren) {
+        buildChildren();
     }
     return QFrame::event(pEvent);
 }
@@ -1,6 +1,8 @@
 #ifndef WWIDGETGROUP_H
 #define WWIDGETGROUP_H
 
+#include <functional>
+
 #include <QDomNode>
 #include <QFrame>
 #include <QPaintEvent>
@@ -76,6 +78,10 @@ class WWidgetGroup : public QFrame, public WBaseWidget {
             double scaleFactor);
     void addWidget(QWidget* pChild);
 
+    // Builds the children when the group is shown for the first time,
+    // instead of while the skin is loaded
+    void setChildrenBuilder(const std::function<void()>& buildChildren);
+
   signals:
     void highlightChanged(int highlight);
 
@@ -86,6 +92,9 @@ class WWidgetGroup : public QFrame, public WBaseWidget {
     void fillDebugTooltip(QStringList* debug) override;
 
   private:
+    void buildChildren();
+
+    std::function<void()> m_buildChildren;
     // Associated background pixmap
     PaintablePointer m_pPixmapBack;
     PaintablePointer m_pPixmapBackHighlighted;
@@ -56,7 +56,13 @@ GetKeyMode::GetKeyMode( int sampleRate, float tuningFrequency,
     m_SortedBuffer(0),
     m_keyStrengths(0)
 {
+    // The chromagram needs about 5 kHz. Input that has already been
+    // decimated by the host is decimated less.
     m_DecimationFactor = 8;
+    while (m_DecimationFactor > 1 &&
+           sampleRate / (int)m_DecimationFactor < 5000) {
+        m_DecimationFactor /= 2;
+    }
         
     // Chromagram configuration parameters
     m_ChromaConfig.normalise = MathUtilities::NormaliseUnitMax;